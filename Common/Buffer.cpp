@@ -91,6 +91,15 @@ int Buffer::SkipLineCRLF() {
 	}
 }
 
+int Buffer::OffsetToAfterNextEmptyLine() {
+	for (int i = 0; i < (int)data_.size() - 3; i++) {
+		if (data_[i] == '\r' && data_[i + 1] == '\n' && data_[i + 2] == '\r' && data_[i + 3] == '\n') {
+			return i + 4;
+		}
+	}
+	return -1;
+}
+
 int Buffer::OffsetToAfterNextCRLF() {
 	for (int i = 0; i < (int)data_.size() - 1; i++) {
 		if (data_[i] == '\r' && data_[i + 1] == '\n') {
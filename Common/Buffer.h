@@ -40,6 +40,8 @@ class Buffer {
 	// If parsing HTML headers, this indicates that you should probably buffer up
 	// more data.
 	int OffsetToAfterNextCRLF();
+	// Same, but for the next empty line (CRLFCRLF), like the end of HTTP headers.
+	int OffsetToAfterNextEmptyLine();
 
 	// Takers
 
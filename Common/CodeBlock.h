@@ -35,6 +35,11 @@ class CodeBlockCommon {
 		return ptr - region;
 	}
 
+	// On W^X platforms, code is made writable around each write, unless it has a separate writable mapping.
+	bool NeedsProtectionChanges() const {
+		return PlatformIsWXExclusive() && !dualMapped_;
+	}
+
 	virtual const u8 *GetCodePtrFromWritablePtr(u8 *ptr) = 0;
 	virtual u8 *GetWritablePtrFromCodePtr(const u8 *ptr) = 0;
 
@@ -44,6 +49,7 @@ class CodeBlockCommon {
 	// Note: this should be the readable/executable side if writable is a different pointer.
 	u8 *region = nullptr;
 	size_t region_size = 0;
+	bool dualMapped_ = false;
 };
 
 template<class T> class CodeBlock : public CodeBlockCommon, public T {
@@ -62,9 +68,16 @@ template<class T> class CodeBlock : public CodeBlockCommon, public T {
 	// Call this before you generate any code.
 	void AllocCodeSpace(int size) {
 		region_size = size;
-		// The protection will be set to RW if PlatformIsWXExclusive.
-		region = (u8 *)AllocateExecutableMemory(region_size);
-		writableRegion = region;
+		if (PlatformIsWXExclusive()) {
+			// Much cheaper than flipping the protection around every block, where allowed.
+			region = (u8 *)AllocateDualMappedExecutableMemory(region_size, &writableRegion);
+			dualMapped_ = region != nullptr;
+		}
+		if (!dualMapped_) {
+			// The protection will be set to RW if PlatformIsWXExclusive.
+			region = (u8 *)AllocateExecutableMemory(region_size);
+			writableRegion = region;
+		}
 		T::SetCodePointer(region, writableRegion);
 	}
 
@@ -74,13 +87,13 @@ template<class T> class CodeBlock : public CodeBlockCommon, public T {
 		if (!region) {
 			return;
 		}
-		if (PlatformIsWXExclusive()) {
+		if (NeedsProtectionChanges()) {
 			ProtectMemoryPages(region, region_size, MEM_PROT_READ | MEM_PROT_WRITE);
 		}
 		// If not WX Exclusive, no need to call ProtectMemoryPages because we never change the protection from RWX.
 		PoisonMemory(offset);
 		ResetCodePtr(offset);
-		if (PlatformIsWXExclusive()) {
+		if (NeedsProtectionChanges()) {
 			// Need to re-protect the part we didn't clear.
 			ProtectMemoryPages(region, offset, MEM_PROT_READ | MEM_PROT_EXEC);
 		}
@@ -93,7 +106,7 @@ template<class T> class CodeBlock : public CodeBlockCommon, public T {
 		_dbg_assert_msg_(!writeStart_, "Can't nest BeginWrite calls");
 
 		// In case the last block made the current page exec/no-write, let's fix that.
-		if (PlatformIsWXExclusive()) {
+		if (NeedsProtectionChanges()) {
 			writeStart_ = GetCodePtr();
 			ProtectMemoryPages(writeStart_, sizeEstimate, MEM_PROT_READ | MEM_PROT_WRITE);
 		}
@@ -101,7 +114,7 @@ template<class T> class CodeBlock : public CodeBlockCommon, public T {
 
 	void EndWrite() {
 		// OK, we're done. Re-protect the memory we touched.
-		if (PlatformIsWXExclusive() && writeStart_ != nullptr) {
+		if (NeedsProtectionChanges() && writeStart_ != nullptr) {
 			const uint8_t *end = GetCodePtr();
 			ProtectMemoryPages(writeStart_, end - writeStart_, MEM_PROT_READ | MEM_PROT_EXEC);
 			writeStart_ = nullptr;
@@ -110,11 +123,16 @@ template<class T> class CodeBlock : public CodeBlockCommon, public T {
 
 	// Call this when shutting down. Don't rely on the destructor, even though it'll do the job.
 	void FreeCodeSpace() {
-		ProtectMemoryPages(region, region_size, MEM_PROT_READ | MEM_PROT_WRITE);
-		FreeMemoryPages(region, region_size);
+		if (dualMapped_) {
+			FreeDualMappedExecutableMemory(region, writableRegion, region_size);
+		} else {
+			ProtectMemoryPages(region, region_size, MEM_PROT_READ | MEM_PROT_WRITE);
+			FreeMemoryPages(region, region_size);
+		}
 		region = nullptr;
 		writableRegion = nullptr;
 		region_size = 0;
+		dualMapped_ = false;
 	}
 
 	const u8 *GetCodePtr() const override {
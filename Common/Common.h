@@ -94,3 +94,10 @@
 #elif !defined(__GNUC__) && (defined(_M_X64) || defined(_M_IX86))
 # define _M_SSE 0x402
 #endif
+
+// Allows newer instructions than the build targets in a single function.  Only call it after checking cpu_info.
+#if defined(_M_SSE) && defined(__GNUC__)
+#define SSE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SSE_TARGET_AVX2
+#endif
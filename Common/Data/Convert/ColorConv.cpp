@@ -25,6 +25,7 @@
 
 #ifdef _M_SSE
 #include <emmintrin.h>
+#include <immintrin.h>
 #endif
 
 #if _M_SSE >= 0x401
@@ -295,20 +296,56 @@ void ConvertRGBA8888ToRGB888(u8 *dst, const u32 *src, u32 numPixels) {
 	}
 }
 
+#ifdef _M_SSE
+static SSE_TARGET_AVX2 u32 ConvertRGB565ToRGBA8888AVX2(u32 *dst32, const u16 *src, u32 numPixels) {
+	const __m256i mask5 = _mm256_set1_epi16(0x001f);
+	const __m256i mask6 = _mm256_set1_epi16(0x003f);
+	const __m256i mask8 = _mm256_set1_epi16(0x00ff);
+
+	u32 simdable = (numPixels / 16) * 16;
+	for (u32 i = 0; i < simdable; i += 16) {
+		const __m256i c = _mm256_loadu_si256((const __m256i *)(src + i));
+
+		// Swizzle, resulting in RR00 RR00.
+		__m256i r = _mm256_and_si256(c, mask5);
+		r = _mm256_or_si256(_mm256_slli_epi16(r, 3), _mm256_srli_epi16(r, 2));
+		r = _mm256_and_si256(r, mask8);
+
+		// This one becomes 00GG 00GG.
+		__m256i g = _mm256_and_si256(_mm256_srli_epi16(c, 5), mask6);
+		g = _mm256_or_si256(_mm256_slli_epi16(g, 2), _mm256_srli_epi16(g, 4));
+		g = _mm256_slli_epi16(g, 8);
+
+		// Almost done, we aim for BB00 BB00 again here.
+		__m256i b = _mm256_and_si256(_mm256_srli_epi16(c, 11), mask5);
+		b = _mm256_or_si256(_mm256_slli_epi16(b, 3), _mm256_srli_epi16(b, 2));
+		b = _mm256_and_si256(b, mask8);
+
+		// Always set alpha to 00FF 00FF.
+		__m256i a = _mm256_slli_epi16(mask8, 8);
+
+		// Now combine them, RRGG RRGG and BBAA BBAA, and then interleave.
+		const __m256i rg = _mm256_or_si256(r, g);
+		const __m256i ba = _mm256_or_si256(b, a);
+		// Unpacking works within each lane, so put the lanes back in order when storing.
+		const __m256i lo = _mm256_unpacklo_epi16(rg, ba);
+		const __m256i hi = _mm256_unpackhi_epi16(rg, ba);
+		_mm256_storeu_si256((__m256i *)(dst32 + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i *)(dst32 + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+	return simdable;
+}
+#endif
+
 void ConvertRGB565ToRGBA8888(u32 *dst32, const u16 *src, u32 numPixels) {
 #ifdef _M_SSE
+	u32 i = cpu_info.bAVX2 ? ConvertRGB565ToRGBA8888AVX2(dst32, src, numPixels) : 0;
 	const __m128i mask5 = _mm_set1_epi16(0x001f);
 	const __m128i mask6 = _mm_set1_epi16(0x003f);
 	const __m128i mask8 = _mm_set1_epi16(0x00ff);
 
-	const __m128i *srcp = (const __m128i *)src;
-	__m128i *dstp = (__m128i *)dst32;
-	u32 sseChunks = numPixels / 8;
-	if (((intptr_t)src & 0xF) || ((intptr_t)dst32 & 0xF)) {
-		sseChunks = 0;
-	}
-	for (u32 i = 0; i < sseChunks; ++i) {
-		const __m128i c = _mm_load_si128(&srcp[i]);
+	for (; i + 8 <= numPixels; i += 8) {
+		const __m128i c = _mm_loadu_si128((const __m128i *)(src + i));
 
 		// Swizzle, resulting in RR00 RR00.
 		__m128i r = _mm_and_si128(c, mask5);
@@ -331,10 +368,13 @@ void ConvertRGB565ToRGBA8888(u32 *dst32, const u16 *src, u32 numPixels) {
 		// Now combine them, RRGG RRGG and BBAA BBAA, and then interleave.
 		const __m128i rg = _mm_or_si128(r, g);
 		const __m128i ba = _mm_or_si128(b, a);
-		_mm_store_si128(&dstp[i * 2 + 0], _mm_unpacklo_epi16(rg, ba));
-		_mm_store_si128(&dstp[i * 2 + 1], _mm_unpackhi_epi16(rg, ba));
+		_mm_storeu_si128((__m128i *)(dst32 + i), _mm_unpacklo_epi16(rg, ba));
+		_mm_storeu_si128((__m128i *)(dst32 + i + 4), _mm_unpackhi_epi16(rg, ba));
 	}
-	u32 i = sseChunks * 8;
+#elif PPSSPP_ARCH(ARM64)
+	u32 i = ConvertRGB565ToRGBA8888NEON(dst32, src, numPixels);
+#elif PPSSPP_ARCH(ARM_NEON)
+	u32 i = cpu_info.bNEON ? ConvertRGB565ToRGBA8888NEON(dst32, src, numPixels) : 0;
 #else
 	u32 i = 0;
 #endif
@@ -349,19 +389,55 @@ void ConvertRGB565ToRGBA8888(u32 *dst32, const u16 *src, u32 numPixels) {
 	}
 }
 
+#ifdef _M_SSE
+static SSE_TARGET_AVX2 u32 ConvertRGBA5551ToRGBA8888AVX2(u32 *dst32, const u16 *src, u32 numPixels) {
+	const __m256i mask5 = _mm256_set1_epi16(0x001f);
+	const __m256i mask8 = _mm256_set1_epi16(0x00ff);
+
+	u32 simdable = (numPixels / 16) * 16;
+	for (u32 i = 0; i < simdable; i += 16) {
+		const __m256i c = _mm256_loadu_si256((const __m256i *)(src + i));
+
+		// Swizzle, resulting in RR00 RR00.
+		__m256i r = _mm256_and_si256(c, mask5);
+		r = _mm256_or_si256(_mm256_slli_epi16(r, 3), _mm256_srli_epi16(r, 2));
+		r = _mm256_and_si256(r, mask8);
+
+		// This one becomes 00GG 00GG.
+		__m256i g = _mm256_and_si256(_mm256_srli_epi16(c, 5), mask5);
+		g = _mm256_or_si256(_mm256_slli_epi16(g, 3), _mm256_srli_epi16(g, 2));
+		g = _mm256_slli_epi16(g, 8);
+
+		// Almost done, we aim for BB00 BB00 again here.
+		__m256i b = _mm256_and_si256(_mm256_srli_epi16(c, 10), mask5);
+		b = _mm256_or_si256(_mm256_slli_epi16(b, 3), _mm256_srli_epi16(b, 2));
+		b = _mm256_and_si256(b, mask8);
+
+		// 1 bit A to 00AA 00AA.
+		__m256i a = _mm256_srai_epi16(c, 15);
+		a = _mm256_slli_epi16(a, 8);
+
+		// Now combine them, RRGG RRGG and BBAA BBAA, and then interleave.
+		const __m256i rg = _mm256_or_si256(r, g);
+		const __m256i ba = _mm256_or_si256(b, a);
+		// Unpacking works within each lane, so put the lanes back in order when storing.
+		const __m256i lo = _mm256_unpacklo_epi16(rg, ba);
+		const __m256i hi = _mm256_unpackhi_epi16(rg, ba);
+		_mm256_storeu_si256((__m256i *)(dst32 + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i *)(dst32 + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+	return simdable;
+}
+#endif
+
 void ConvertRGBA5551ToRGBA8888(u32 *dst32, const u16 *src, u32 numPixels) {
 #ifdef _M_SSE
+	u32 i = cpu_info.bAVX2 ? ConvertRGBA5551ToRGBA8888AVX2(dst32, src, numPixels) : 0;
 	const __m128i mask5 = _mm_set1_epi16(0x001f);
 	const __m128i mask8 = _mm_set1_epi16(0x00ff);
 
-	const __m128i *srcp = (const __m128i *)src;
-	__m128i *dstp = (__m128i *)dst32;
-	u32 sseChunks = numPixels / 8;
-	if (((intptr_t)src & 0xF) || ((intptr_t)dst32 & 0xF)) {
-		sseChunks = 0;
-	}
-	for (u32 i = 0; i < sseChunks; ++i) {
-		const __m128i c = _mm_load_si128(&srcp[i]);
+	for (; i + 8 <= numPixels; i += 8) {
+		const __m128i c = _mm_loadu_si128((const __m128i *)(src + i));
 
 		// Swizzle, resulting in RR00 RR00.
 		__m128i r = _mm_and_si128(c, mask5);
@@ -385,10 +461,13 @@ void ConvertRGBA5551ToRGBA8888(u32 *dst32, const u16 *src, u32 numPixels) {
 		// Now combine them, RRGG RRGG and BBAA BBAA, and then interleave.
 		const __m128i rg = _mm_or_si128(r, g);
 		const __m128i ba = _mm_or_si128(b, a);
-		_mm_store_si128(&dstp[i * 2 + 0], _mm_unpacklo_epi16(rg, ba));
-		_mm_store_si128(&dstp[i * 2 + 1], _mm_unpackhi_epi16(rg, ba));
+		_mm_storeu_si128((__m128i *)(dst32 + i), _mm_unpacklo_epi16(rg, ba));
+		_mm_storeu_si128((__m128i *)(dst32 + i + 4), _mm_unpackhi_epi16(rg, ba));
 	}
-	u32 i = sseChunks * 8;
+#elif PPSSPP_ARCH(ARM64)
+	u32 i = ConvertRGBA5551ToRGBA8888NEON(dst32, src, numPixels);
+#elif PPSSPP_ARCH(ARM_NEON)
+	u32 i = cpu_info.bNEON ? ConvertRGBA5551ToRGBA8888NEON(dst32, src, numPixels) : 0;
 #else
 	u32 i = 0;
 #endif
@@ -403,18 +482,48 @@ void ConvertRGBA5551ToRGBA8888(u32 *dst32, const u16 *src, u32 numPixels) {
 	}
 }
 
+#ifdef _M_SSE
+static SSE_TARGET_AVX2 u32 ConvertRGBA4444ToRGBA8888AVX2(u32 *dst32, const u16 *src, u32 numPixels) {
+	const __m256i mask4 = _mm256_set1_epi16(0x000f);
+
+	u32 simdable = (numPixels / 16) * 16;
+	for (u32 i = 0; i < simdable; i += 16) {
+		const __m256i c = _mm256_loadu_si256((const __m256i *)(src + i));
+
+		// Let's just grab R000 R000, without swizzling yet.
+		__m256i r = _mm256_and_si256(c, mask4);
+		// And then 00G0 00G0.
+		__m256i g = _mm256_and_si256(_mm256_srli_epi16(c, 4), mask4);
+		g = _mm256_slli_epi16(g, 8);
+		// Now B000 B000.
+		__m256i b = _mm256_and_si256(_mm256_srli_epi16(c, 8), mask4);
+		// And lastly 00A0 00A0.  No mask needed, we have a wall.
+		__m256i a = _mm256_srli_epi16(c, 12);
+		a = _mm256_slli_epi16(a, 8);
+
+		// We swizzle after combining - R0G0 R0G0 and B0A0 B0A0 -> RRGG RRGG and BBAA BBAA.
+		__m256i rg = _mm256_or_si256(r, g);
+		__m256i ba = _mm256_or_si256(b, a);
+		rg = _mm256_or_si256(rg, _mm256_slli_epi16(rg, 4));
+		ba = _mm256_or_si256(ba, _mm256_slli_epi16(ba, 4));
+
+		// Unpacking works within each lane, so put the lanes back in order when storing.
+		const __m256i lo = _mm256_unpacklo_epi16(rg, ba);
+		const __m256i hi = _mm256_unpackhi_epi16(rg, ba);
+		_mm256_storeu_si256((__m256i *)(dst32 + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i *)(dst32 + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+	return simdable;
+}
+#endif
+
 void ConvertRGBA4444ToRGBA8888(u32 *dst32, const u16 *src, u32 numPixels) {
 #ifdef _M_SSE
+	u32 i = cpu_info.bAVX2 ? ConvertRGBA4444ToRGBA8888AVX2(dst32, src, numPixels) : 0;
 	const __m128i mask4 = _mm_set1_epi16(0x000f);
 
-	const __m128i *srcp = (const __m128i *)src;
-	__m128i *dstp = (__m128i *)dst32;
-	u32 sseChunks = numPixels / 8;
-	if (((intptr_t)src & 0xF) || ((intptr_t)dst32 & 0xF)) {
-		sseChunks = 0;
-	}
-	for (u32 i = 0; i < sseChunks; ++i) {
-		const __m128i c = _mm_load_si128(&srcp[i]);
+	for (; i + 8 <= numPixels; i += 8) {
+		const __m128i c = _mm_loadu_si128((const __m128i *)(src + i));
 
 		// Let's just grab R000 R000, without swizzling yet.
 		__m128i r = _mm_and_si128(c, mask4);
@@ -434,10 +543,13 @@ void ConvertRGBA4444ToRGBA8888(u32 *dst32, const u16 *src, u32 numPixels) {
 		ba = _mm_or_si128(ba, _mm_slli_epi16(ba, 4));
 
 		// And then we can store.
-		_mm_store_si128(&dstp[i * 2 + 0], _mm_unpacklo_epi16(rg, ba));
-		_mm_store_si128(&dstp[i * 2 + 1], _mm_unpackhi_epi16(rg, ba));
+		_mm_storeu_si128((__m128i *)(dst32 + i), _mm_unpacklo_epi16(rg, ba));
+		_mm_storeu_si128((__m128i *)(dst32 + i + 4), _mm_unpackhi_epi16(rg, ba));
 	}
-	u32 i = sseChunks * 8;
+#elif PPSSPP_ARCH(ARM64)
+	u32 i = ConvertRGBA4444ToRGBA8888NEON(dst32, src, numPixels);
+#elif PPSSPP_ARCH(ARM_NEON)
+	u32 i = cpu_info.bNEON ? ConvertRGBA4444ToRGBA8888NEON(dst32, src, numPixels) : 0;
 #else
 	u32 i = 0;
 #endif
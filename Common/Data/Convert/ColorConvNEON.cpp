@@ -115,4 +115,66 @@ void ConvertRGB565ToBGR565NEON(u16 *dst, const u16 *src, u32 numPixels) {
 	}
 }
 
+// Converts 8 pixels at a time, and returns how many were done, the rest are left for the caller.
+u32 ConvertRGB565ToRGBA8888NEON(u32 *dst, const u16 *src, u32 numPixels) {
+	u32 simdable = (numPixels / 8) * 8;
+	for (u32 i = 0; i < simdable; i += 8) {
+		uint16x8_t c = vld1q_u16(src + i);
+
+		const uint8x8_t r = vmovn_u16(vandq_u16(c, vdupq_n_u16(0x1F)));
+		const uint8x8_t g = vmovn_u16(vandq_u16(vshrq_n_u16(c, 5), vdupq_n_u16(0x3F)));
+		const uint8x8_t b = vmovn_u16(vshrq_n_u16(c, 11));
+
+		uint8x8x4_t res;
+		res.val[0] = vorr_u8(vshl_n_u8(r, 3), vshr_n_u8(r, 2));
+		res.val[1] = vorr_u8(vshl_n_u8(g, 2), vshr_n_u8(g, 4));
+		res.val[2] = vorr_u8(vshl_n_u8(b, 3), vshr_n_u8(b, 2));
+		res.val[3] = vdup_n_u8(255);
+		vst4_u8((u8 *)(dst + i), res);
+	}
+	return simdable;
+}
+
+u32 ConvertRGBA5551ToRGBA8888NEON(u32 *dst, const u16 *src, u32 numPixels) {
+	u32 simdable = (numPixels / 8) * 8;
+	for (u32 i = 0; i < simdable; i += 8) {
+		uint16x8_t c = vld1q_u16(src + i);
+
+		const uint8x8_t r = vmovn_u16(vandq_u16(c, vdupq_n_u16(0x1F)));
+		const uint8x8_t g = vmovn_u16(vandq_u16(vshrq_n_u16(c, 5), vdupq_n_u16(0x1F)));
+		const uint8x8_t b = vmovn_u16(vandq_u16(vshrq_n_u16(c, 10), vdupq_n_u16(0x1F)));
+
+		uint8x8x4_t res;
+		res.val[0] = vorr_u8(vshl_n_u8(r, 3), vshr_n_u8(r, 2));
+		res.val[1] = vorr_u8(vshl_n_u8(g, 3), vshr_n_u8(g, 2));
+		res.val[2] = vorr_u8(vshl_n_u8(b, 3), vshr_n_u8(b, 2));
+		// The arithmetic shift spreads the top bit to the whole lane.
+		res.val[3] = vmovn_u16(vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(c), 15)));
+		vst4_u8((u8 *)(dst + i), res);
+	}
+	return simdable;
+}
+
+u32 ConvertRGBA4444ToRGBA8888NEON(u32 *dst, const u16 *src, u32 numPixels) {
+	const uint16x8_t mask4 = vdupq_n_u16(0x0F);
+
+	u32 simdable = (numPixels / 8) * 8;
+	for (u32 i = 0; i < simdable; i += 8) {
+		uint16x8_t c = vld1q_u16(src + i);
+
+		const uint8x8_t r = vmovn_u16(vandq_u16(c, mask4));
+		const uint8x8_t g = vmovn_u16(vandq_u16(vshrq_n_u16(c, 4), mask4));
+		const uint8x8_t b = vmovn_u16(vandq_u16(vshrq_n_u16(c, 8), mask4));
+		const uint8x8_t a = vmovn_u16(vshrq_n_u16(c, 12));
+
+		uint8x8x4_t res;
+		res.val[0] = vorr_u8(vshl_n_u8(r, 4), r);
+		res.val[1] = vorr_u8(vshl_n_u8(g, 4), g);
+		res.val[2] = vorr_u8(vshl_n_u8(b, 4), b);
+		res.val[3] = vorr_u8(vshl_n_u8(a, 4), a);
+		vst4_u8((u8 *)(dst + i), res);
+	}
+	return simdable;
+}
+
 #endif // PPSSPP_ARCH(ARM_NEON)
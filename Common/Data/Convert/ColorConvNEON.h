@@ -22,3 +22,8 @@
 void ConvertRGBA4444ToABGR4444NEON(u16 *dst, const u16 *src, u32 numPixels);
 void ConvertRGBA5551ToABGR1555NEON(u16 *dst, const u16 *src, u32 numPixels);
 void ConvertRGB565ToBGR565NEON(u16 *dst, const u16 *src, u32 numPixels);
+
+// These return how many pixels were converted, the rest are left for the caller.
+u32 ConvertRGB565ToRGBA8888NEON(u32 *dst, const u16 *src, u32 numPixels);
+u32 ConvertRGBA5551ToRGBA8888NEON(u32 *dst, const u16 *src, u32 numPixels);
+u32 ConvertRGBA4444ToRGBA8888NEON(u32 *dst, const u16 *src, u32 numPixels);
@@ -57,6 +57,50 @@ bool compress_string(const std::string& str, std::string *dest, int compressionl
 	return true;
 }
 
+namespace {
+
+struct ThreadInflateState {
+	~ThreadInflateState() {
+		if (initialized)
+			inflateEnd(&zs);
+	}
+
+	z_stream zs{};
+	bool initialized = false;
+};
+
+thread_local ThreadInflateState t_inflate;
+
+}  // namespace
+
+bool inflate_buffer(const uint8_t *src, size_t srcSize, uint8_t *dest, size_t destSize, int windowBits, size_t *inUsed, size_t *outSize, uint32_t *check) {
+	ThreadInflateState &state = t_inflate;
+	z_stream &zs = state.zs;
+	if (!state.initialized) {
+		if (inflateInit2(&zs, windowBits) != Z_OK) {
+			ERROR_LOG(IO, "inflateInit2 failed while decompressing.");
+			return false;
+		}
+		state.initialized = true;
+	} else if (inflateReset2(&zs, windowBits) != Z_OK) {
+		return false;
+	}
+
+	zs.next_in = (Bytef *)src;
+	zs.avail_in = (uInt)srcSize;
+	zs.next_out = (Bytef *)dest;
+	zs.avail_out = (uInt)destSize;
+	// With Z_FINISH and the whole output available, zlib skips the sliding window copy entirely.
+	if (inflate(&zs, Z_FINISH) != Z_STREAM_END)
+		return false;
+
+	*inUsed = zs.total_in;
+	*outSize = zs.total_out;
+	if (check)
+		*check = (uint32_t)zs.adler;
+	return true;
+}
+
 /** Decompress an STL string using zlib and return the original data. */
 bool decompress_string(const std::string& str, std::string *dest) {
 	if (!str.size())
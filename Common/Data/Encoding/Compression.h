@@ -1,7 +1,16 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 // inflate/deflate convenience wrapper. Uses zlib.
 bool compress_string(const std::string& str, std::string *dest, int compressionlevel = 9);
 bool decompress_string(const std::string& str, std::string *dest);
+
+// Inflates a complete stream into a buffer known to be big enough, in a single call.
+// windowBits is as for inflateInit2 (negative for raw deflate, +16 for gzip.)  The zlib state is
+// kept per thread and reset between calls, instead of allocated and initialized every time.
+// On success, inUsed/outSize get the bytes consumed and produced, and check (if not null) gets
+// the stream's checksum: CRC-32 of the output for gzip, Adler-32 for zlib, nothing for raw.
+bool inflate_buffer(const uint8_t *src, size_t srcSize, uint8_t *dest, size_t destSize, int windowBits, size_t *inUsed, size_t *outSize, uint32_t *check = nullptr);
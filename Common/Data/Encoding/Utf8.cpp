@@ -27,9 +27,15 @@
 #include <algorithm>
 #include <string>
 
+#include "ppsspp_config.h"
+#include "Common/Common.h"
 #include "Common/Data/Encoding/Utf8.h"
 #include "Common/Data/Encoding/Utf16.h"
 
+#ifdef _M_SSE
+#include <emmintrin.h>
+#endif
+
 // is start of UTF sequence
 inline bool isutf(char c) {
 	return (c & 0xC0) != 0x80;
@@ -207,13 +213,67 @@ int u8_charnum(const char *s, int offset)
 }
 
 /* number of characters */
+static inline bool isplainascii(char c) {
+	// Catches both 0 and 0x80+.
+	return (uint8_t)(c - 1) < 0x7F;
+}
+
+static inline int u8_ascii_stop(const char *s, const char *p) {
+	// A stray continuation byte gets folded into the previous character by u8_nextchar().
+	if (p != s && !isutf(*p))
+		return (int)(p - s) - 1;
+	return (int)(p - s);
+}
+
+int u8_ascii_prefix(const char *s) {
+	const char *p = s;
+	// Go bytewise until aligned, so the wide reads below never cross into the next page.
+	while (((uintptr_t)p & 15) != 0) {
+		if (!isplainascii(*p))
+			return u8_ascii_stop(s, p);
+		p++;
+	}
+
+#ifdef _M_SSE
+	const __m128i zero = _mm_setzero_si128();
+	while (true) {
+		__m128i v = _mm_load_si128((const __m128i *)p);
+		// The top bit is set for 0x80+ already, OR in the zero bytes.
+		u32 stop = _mm_movemask_epi8(_mm_or_si128(v, _mm_cmpeq_epi8(v, zero)));
+		if (stop != 0)
+			return u8_ascii_stop(s, p + LeastSignificantSetBit(stop));
+		p += 16;
+	}
+#else
+	while (true) {
+		uint64_t w;
+		memcpy(&w, p, sizeof(w));
+		// Top bits of bytes that are 0x80+ or zero (may also flag bytes after a zero, which is fine.)
+		uint64_t stop = (w | ((w - 0x0101010101010101ULL) & ~w)) & 0x8080808080808080ULL;
+		if (stop != 0)
+			break;
+		p += 8;
+	}
+	while (isplainascii(*p))
+		p++;
+	return u8_ascii_stop(s, p);
+#endif
+}
+
 int u8_strlen(const char *s)
 {
   int count = 0;
   int i = 0;
 
-  while (u8_nextchar(s, &i) != 0)
+  while (true) {
+    // ASCII runs are one character per byte.
+    int run = u8_ascii_prefix(s + i);
+    count += run;
+    i += run;
+    if (u8_nextchar(s, &i) == 0)
+      break;
     count++;
+  }
 
   return count;
 }
@@ -443,7 +503,8 @@ int UTF8StringNonASCIICount(const char *utf8string) {
 }
 
 bool UTF8StringHasNonASCII(const char *utf8string) {
-	return UTF8StringNonASCIICount(utf8string) > 0;
+	// Only need to find the first one.
+	return utf8string[u8_ascii_prefix(utf8string)] != 0;
 }
 
 #ifdef _WIN32
@@ -23,6 +23,9 @@ uint32_t u8_nextchar(const char *s, int *i);
 uint32_t u8_nextchar_unsafe(const char *s, int *i);
 int u8_wc_toutf8(char *dest, uint32_t ch);
 int u8_strlen(const char *s);
+// Number of plain ASCII bytes (1-0x7F) at the start of s, checked 16 (or 8) at a time.
+// Stops one short before a stray continuation byte, since u8_nextchar() would fold it in.
+int u8_ascii_prefix(const char *s);
 void u8_inc(const char *s, int *i);
 void u8_dec(const char *s, int *i);
 
@@ -149,21 +149,56 @@ static std::string EscapeComments(const std::string &value) {
 	return result;
 }
 
+// Keys are compared case insensitively.
+static std::string IndexKey(const std::string &key) {
+	std::string lower = key;
+	for (char &c : lower) {
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+	}
+	return lower;
+}
+
 void Section::Clear() {
 	lines.clear();
+	keyIndex_.clear();
+	keyIndexValid_ = true;
+}
+
+int Section::FindLine(const char *key) const {
+	if (!keyIndexValid_) {
+		keyIndex_.clear();
+		for (size_t i = 0; i < lines.size(); ++i) {
+			std::string lineKey;
+			ParseLine(lines[i], &lineKey, nullptr, nullptr);
+			if (!lineKey.empty())
+				keyIndex_.emplace(IndexKey(lineKey), i);
+		}
+		keyIndexValid_ = true;
+	}
+
+	auto iter = keyIndex_.find(IndexKey(key));
+	return iter == keyIndex_.end() ? -1 : (int)iter->second;
 }
 
-std::string* Section::GetLine(const char* key, std::string* valueOut, std::string* commentOut)
-{
-	for (std::vector<std::string>::iterator iter = lines.begin(); iter != lines.end(); ++iter)
-	{
-		std::string& line = *iter;
+void Section::AddLine(std::string &&line) {
+	lines.push_back(std::move(line));
+	if (keyIndexValid_) {
 		std::string lineKey;
-		ParseLine(line, &lineKey, valueOut, commentOut);
-		if (!strcasecmp(lineKey.c_str(), key))
-			return &line;
+		ParseLine(lines.back(), &lineKey, nullptr, nullptr);
+		if (!lineKey.empty())
+			keyIndex_.emplace(IndexKey(lineKey), lines.size() - 1);
 	}
-	return 0;
+}
+
+std::string* Section::GetLine(const char* key, std::string* valueOut, std::string* commentOut)
+{
+	int index = FindLine(key);
+	if (index < 0)
+		return nullptr;
+	std::string &line = lines[index];
+	ParseLine(line, nullptr, valueOut, commentOut);
+	return &line;
 }
 
 void Section::Set(const char* key, uint32_t newValue) {
@@ -198,7 +233,7 @@ void Section::Set(const char* key, const char* newValue)
 	else
 	{
 		// The key did not already exist in this section - let's add it.
-		lines.push_back(std::string(key) + " = " + EscapeComments(newValue));
+		AddLine(std::string(key) + " = " + EscapeComments(newValue));
 	}
 }
 
@@ -264,7 +299,7 @@ void Section::Set(const char* key, const std::vector<std::string>& newValues)
 }
 
 void Section::AddComment(const std::string &comment) {
-	lines.push_back("# " + comment);
+	AddLine("# " + comment);
 }
 
 bool Section::Get(const char* key, std::vector<std::string>& values) 
@@ -357,14 +392,7 @@ bool Section::Get(const char* key, double* value, double defaultValue)
 
 bool Section::Exists(const char *key) const
 {
-	for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter)
-	{
-		std::string lineKey;
-		ParseLine(*iter, &lineKey, NULL, NULL);
-		if (!strcasecmp(lineKey.c_str(), key))
-			return true;
-	}
-	return false;
+	return FindLine(key) >= 0;
 }
 
 std::map<std::string, std::string> Section::ToMap() const
@@ -383,16 +411,13 @@ std::map<std::string, std::string> Section::ToMap() const
 
 bool Section::Delete(const char *key)
 {
-	std::string* line = GetLine(key, 0, 0);
-	for (std::vector<std::string>::iterator liter = lines.begin(); liter != lines.end(); ++liter)
-	{
-		if (line == &*liter)
-		{
-			lines.erase(liter);
-			return true;
-		}
-	}
-	return false;
+	int index = FindLine(key);
+	if (index < 0)
+		return false;
+	lines.erase(lines.begin() + index);
+	// The following lines moved, and a later line with the same key may now be the first.
+	keyIndexValid_ = false;
+	return true;
 }
 
 // IniFile
@@ -451,11 +476,9 @@ bool IniFile::Exists(const char* sectionName, const char* key) const
 void IniFile::SetLines(const char* sectionName, const std::vector<std::string> &lines)
 {
 	Section* section = GetOrCreateSection(sectionName);
-	section->lines.clear();
-	for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter)
-	{
-		section->lines.push_back(*iter);
-	}
+	section->Clear();
+	for (const std::string &line : lines)
+		section->AddLine(std::string(line));
 }
 
 bool IniFile::DeleteKey(const char* sectionName, const char* key)
@@ -463,16 +486,7 @@ bool IniFile::DeleteKey(const char* sectionName, const char* key)
 	Section* section = GetSection(sectionName);
 	if (!section)
 		return false;
-	std::string* line = section->GetLine(key, 0, 0);
-	for (std::vector<std::string>::iterator liter = section->lines.begin(); liter != section->lines.end(); ++liter)
-	{
-		if (line == &(*liter))
-		{
-			section->lines.erase(liter);
-			return true;
-		}
-	}
-	return false; //shouldn't happen
+	return section->Delete(key);
 }
 
 // Return a list of all keys in a section
@@ -541,9 +555,7 @@ bool IniFile::Load(const Path &path)
 	if (!File::ReadFileToString(true, path, data)) {
 		return false;
 	}
-	std::stringstream sstream(data);
-	bool success = Load(sstream);
-	return success;
+	return LoadFromString(data);
 }
 
 bool IniFile::LoadFromVFS(const std::string &filename) {
@@ -554,8 +566,20 @@ bool IniFile::LoadFromVFS(const std::string &filename) {
 	std::string str((const char*)data, size);
 	delete [] data;
 
-	std::stringstream sstream(str);
-	return Load(sstream);
+	return LoadFromString(str);
+}
+
+// Splits in place, instead of going through a stream (which was most of the time spent on big files.)
+bool IniFile::LoadFromString(const std::string &data) {
+	size_t pos = 0;
+	while (pos < data.size()) {
+		size_t end = data.find('\n', pos);
+		if (end == data.npos)
+			end = data.size();
+		ProcessLine(data.substr(pos, end - pos));
+		pos = end + 1;
+	}
+	return true;
 }
 
 bool IniFile::Load(std::istream &in) {
@@ -566,69 +590,73 @@ bool IniFile::Load(std::istream &in) {
 	{
 		char templine[MAX_BYTES];
 		in.getline(templine, MAX_BYTES);
-		std::string line = templine;
+		ProcessLine(templine);
+	}
+
+	return true;
+}
+
+void IniFile::ProcessLine(std::string &&line) {
+	// Remove UTF-8 byte order marks.
+	if (line.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+		line.erase(0, 3);
+	}
 
-		// Remove UTF-8 byte order marks.
-		if (line.substr(0, 3) == "\xEF\xBB\xBF") {
-			line = line.substr(3);
-		}
-		 
 #ifndef _WIN32
-		// Check for CRLF eol and convert it to LF
-		if (!line.empty() && line.at(line.size()-1) == '\r') {
-			line.erase(line.size()-1);
-		}
+	// Check for CRLF eol and convert it to LF
+	if (!line.empty() && line.back() == '\r') {
+		line.pop_back();
+	}
 #endif
 
-		if (!line.empty()) {
-			size_t sectionNameEnd = std::string::npos;
-			if (line[0] == '[') {
-				sectionNameEnd = line.find(']');
-			}
+	if (line.empty())
+		return;
 
-			if (sectionNameEnd != std::string::npos) {
-				// New section!
-				std::string sub = line.substr(1, sectionNameEnd - 1);
-				sections.push_back(Section(sub));
-
-				if (sectionNameEnd + 1 < line.size()) {
-					sections[sections.size() - 1].comment = line.substr(sectionNameEnd + 1);
-				}
-			} else {
-				if (sections.empty()) {
-					sections.push_back(Section(""));
-				}
-				sections[sections.size() - 1].lines.push_back(line);
-			}
-		}
+	size_t sectionNameEnd = std::string::npos;
+	if (line[0] == '[') {
+		sectionNameEnd = line.find(']');
 	}
 
-	return true;
+	if (sectionNameEnd != std::string::npos) {
+		// New section!
+		std::string sub = line.substr(1, sectionNameEnd - 1);
+		sections.push_back(Section(sub));
+
+		if (sectionNameEnd + 1 < line.size()) {
+			sections.back().comment = line.substr(sectionNameEnd + 1);
+		}
+	} else {
+		if (sections.empty()) {
+			sections.push_back(Section(""));
+		}
+		sections.back().AddLine(std::move(line));
+	}
 }
 
 bool IniFile::Save(const Path &filename)
 {
-	FILE *file = File::OpenCFile(filename, "w");
-	if (!file) {
-		return false;
-	}
-
 	// UTF-8 byte order mark. To make sure notepad doesn't go nuts.
 	// TODO: Do we still need this? It's annoying.
-	fprintf(file, "\xEF\xBB\xBF");
+	std::string data = "\xEF\xBB\xBF";
 
 	for (const Section &section : sections) {
 		if (!section.name().empty() && (!section.lines.empty() || !section.comment.empty())) {
-			fprintf(file, "[%s]%s\n", section.name().c_str(), section.comment.c_str());
+			data += "[" + section.name() + "]" + section.comment + "\n";
 		}
 
 		for (const std::string &s : section.lines) {
-			fprintf(file, "%s\n", s.c_str());
+			data += s;
+			data += '\n';
 		}
 	}
 
-	fclose(file);
-	return true;
+	// Most saves don't change anything (like closing settings without touching them), and
+	// reading is much cheaper than writing on slow flash storage.
+	std::string existing;
+	if (File::ReadFileToString(true, filename, existing) && existing == data) {
+		return true;
+	}
+	return File::WriteStringToFile(true, data, filename);
 }
 
 bool IniFile::Get(const char* sectionName, const char* key, std::string* value, const char* defaultValue)
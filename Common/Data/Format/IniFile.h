@@ -7,6 +7,7 @@
 #include <istream>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/File/Path.h"
@@ -74,9 +75,18 @@ class Section {
 	}
 
 protected:
+	// Returns the index of the first line with the key, or -1.
+	int FindLine(const char *key) const;
+	void AddLine(std::string &&line);
+
 	std::vector<std::string> lines;
 	std::string name_;
 	std::string comment;
+
+	// Lowercased key to the index of its first line, so lookups don't parse every line of
+	// big sections (like in compat.ini or a texture pack's textures.ini.) Built on the first lookup.
+	mutable std::unordered_map<std::string, size_t> keyIndex_;
+	mutable bool keyIndexValid_ = false;
 };
 
 class IniFile {
@@ -86,6 +96,7 @@ class IniFile {
 	bool Load(std::istream &istream);
 	bool LoadFromVFS(const std::string &filename);
 
+	// Skips the write if the file already has the same contents.
 	bool Save(const Path &path);
 	bool Save(const std::string &filename) { return Save(Path(filename)); }
 
@@ -146,6 +157,9 @@ class IniFile {
 	Section* GetOrCreateSection(const char* section);
 
 private:
+	bool LoadFromString(const std::string &data);
+	void ProcessLine(std::string &&line);
+
 	std::vector<Section> sections;
 
 	const Section* GetSection(const char* section) const;
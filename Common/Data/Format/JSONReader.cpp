@@ -9,12 +9,12 @@ JsonReader::JsonReader(const std::string &filename) {
 	size_t buf_size;
 	buffer_ = (char *)VFSReadFile(filename.c_str(), &buf_size);
 	if (buffer_) {
-		parse();
+		parse(buffer_);
 	} else {
 		// Okay, try to read on the local file system
 		buffer_ = (char *)File::ReadLocalFile(Path(filename), &buf_size);
 		if (buffer_) {
-			parse();
+			parse(buffer_);
 		} else {
 			ERROR_LOG(IO, "Failed to read json file '%s'", filename.c_str());
 		}
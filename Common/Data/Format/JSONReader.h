@@ -42,6 +42,9 @@ struct JsonGet {
 	JsonValue value_;
 };
 
+// Tag for JsonReader, see below.
+struct InPlace {};
+
 // Easy-wrapper
 class JsonReader {
 public:
@@ -50,7 +53,11 @@ class JsonReader {
 		buffer_ = (char *)malloc(size + 1);
 		memcpy(buffer_, data, size);
 		buffer_[size] = 0;
-		parse();
+		parse(buffer_);
+	}
+	// Takes over the string and parses it where it is, so large documents aren't copied.
+	JsonReader(std::string &&data, InPlace) : owned_(std::move(data)) {
+		parse(&owned_[0]);
 	}
 	JsonReader(const JsonNode *node) {
 		ok_ = true;
@@ -69,11 +76,11 @@ class JsonReader {
 	const JsonValue rootValue() const { return root_; }
 
 private:
-	bool parse() {
+	bool parse(char *data) {
 		char *error_pos;
-		int status = jsonParse(buffer_, &error_pos, &root_, alloc_);
+		int status = jsonParse(data, &error_pos, &root_, alloc_);
 		if (status != JSON_OK) {
-			ERROR_LOG(IO, "Error at (%i): %s\n%s\n\n", (int)(error_pos - buffer_), jsonStrError(status), error_pos);
+			ERROR_LOG(IO, "Error at (%i): %s\n%s\n\n", (int)(error_pos - data), jsonStrError(status), error_pos);
 			return false;
 		}
 		ok_ = true;
@@ -81,6 +88,7 @@ class JsonReader {
 	}
 
 	char *buffer_ = nullptr;
+	std::string owned_;
 	JsonAllocator alloc_;
 	JsonValue root_;
 	bool ok_ = false;
@@ -1,5 +1,6 @@
-#include <iomanip>
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <cstring>
 
 #include "Common/Data/Format/JSONReader.h"
@@ -9,21 +10,18 @@ namespace json {
 
 JsonWriter::JsonWriter(int flags) {
 	pretty_ = (flags & PRETTY) != 0;
-	str_.imbue(std::locale::classic());
-	// Let's maximize precision by default.
-	str_.precision(53);
 }
 
 JsonWriter::~JsonWriter() {
 }
 
 void JsonWriter::begin() {
-	str_ << "{";
+	str_ += '{';
 	stack_.push_back(StackEntry(DICT));
 }
 
 void JsonWriter::beginArray() {
-	str_ << "[";
+	str_ += '[';
 	stack_.push_back(StackEntry(ARRAY));
 }
 
@@ -35,7 +33,7 @@ void JsonWriter::beginRaw() {
 void JsonWriter::end() {
 	pop();
 	if (pretty_)
-		str_ << "\n";
+		str_ += '\n';
 }
 
 const char *JsonWriter::indent(int n) const {
@@ -81,141 +79,158 @@ const char *JsonWriter::arrayComma() const {
 	}
 }
 
-void JsonWriter::pushDict() {
-	str_ << arrayComma() << arrayIndent() << "{";
+void JsonWriter::writeArrayPrefix() {
+	str_ += arrayComma();
+	str_ += arrayIndent();
 	stack_.back().first = false;
-	stack_.push_back(StackEntry(DICT));
 }
 
-void JsonWriter::pushDict(const std::string &name) {
-	str_ << comma() << indent() << "\"";
+void JsonWriter::writeKey(const std::string &name, const char *after) {
+	str_ += comma();
+	str_ += indent();
+	str_ += '"';
 	writeEscapedString(name);
-	str_ << (pretty_ ? "\": {" : "\":{");
+	str_ += pretty_ ? "\": " : "\":";
+	str_ += after;
 	stack_.back().first = false;
+}
+
+void JsonWriter::writeNumber(int value) {
+	char temp[16];
+	size_t len = snprintf(temp, sizeof(temp), "%d", value);
+	str_.append(temp, len);
+}
+
+void JsonWriter::writeNumber(uint32_t value) {
+	char temp[16];
+	size_t len = snprintf(temp, sizeof(temp), "%u", value);
+	str_.append(temp, len);
+}
+
+void JsonWriter::writeNumber(double value) {
+	if (!std::isfinite(value)) {
+		str_ += "null";
+		return;
+	}
+
+	// Let's maximize precision.
+	char temp[128];
+	size_t len = snprintf(temp, sizeof(temp), "%.53g", value);
+	len = std::min(len, sizeof(temp) - 1);
+	// Just in case the locale uses a decimal comma.
+	for (size_t i = 0; i < len; ++i) {
+		if (temp[i] == ',')
+			temp[i] = '.';
+	}
+	str_.append(temp, len);
+}
+
+void JsonWriter::pushDict() {
+	writeArrayPrefix();
+	str_ += '{';
+	stack_.push_back(StackEntry(DICT));
+}
+
+void JsonWriter::pushDict(const std::string &name) {
+	writeKey(name, "{");
 	stack_.push_back(StackEntry(DICT));
 }
 
 void JsonWriter::pushArray() {
-	str_ << arrayComma() << arrayIndent() << "[";
-	stack_.back().first = false;
+	writeArrayPrefix();
+	str_ += '[';
 	stack_.push_back(StackEntry(ARRAY));
 }
 
 void JsonWriter::pushArray(const std::string &name) {
-	str_ << comma() << indent() << "\"";
-	writeEscapedString(name);
-	str_ << (pretty_ ? "\": [" : "\":[");
+	writeKey(name, "[");
 	stack_.push_back(StackEntry(ARRAY));
 }
 
 void JsonWriter::writeBool(bool value) {
-	str_ << arrayComma() << arrayIndent() << (value ? "true" : "false");
-	stack_.back().first = false;
+	writeArrayPrefix();
+	str_ += value ? "true" : "false";
 }
 
 void JsonWriter::writeBool(const std::string &name, bool value) {
-	str_ << comma() << indent() << "\"";
-	writeEscapedString(name);
-	str_ << (pretty_ ? "\": " : "\":") << (value ? "true" : "false");
-	stack_.back().first = false;
+	writeKey(name, value ? "true" : "false");
 }
 
 void JsonWriter::writeInt(int value) {
-	str_ << arrayComma() << arrayIndent() << value;
-	stack_.back().first = false;
+	writeArrayPrefix();
+	writeNumber(value);
 }
 
 void JsonWriter::writeInt(const std::string &name, int value) {
-	str_ << comma() << indent() << "\"";
-	writeEscapedString(name);
-	str_ << (pretty_ ? "\": " : "\":") << value;
-	stack_.back().first = false;
+	writeKey(name);
+	writeNumber(value);
 }
 
 void JsonWriter::writeUint(uint32_t value) {
-	str_ << arrayComma() << arrayIndent() << value;
-	stack_.back().first = false;
+	writeArrayPrefix();
+	writeNumber(value);
 }
 
 void JsonWriter::writeUint(const std::string &name, uint32_t value) {
-	str_ << comma() << indent() << "\"";
-	writeEscapedString(name);
-	str_ << (pretty_ ? "\": " : "\":") << value;
-	stack_.back().first = false;
+	writeKey(name);
+	writeNumber(value);
 }
 
 void JsonWriter::writeFloat(double value) {
-	str_ << arrayComma() << arrayIndent();
-	if (std::isfinite(value))
-		str_ << value;
-	else
-		str_ << "null";
-	stack_.back().first = false;
+	writeArrayPrefix();
+	writeNumber(value);
 }
 
 void JsonWriter::writeFloat(const std::string &name, double value) {
-	str_ << comma() << indent() << "\"";
-	writeEscapedString(name);
-	str_ << (pretty_ ? "\": " : "\":");
-	if (std::isfinite(value))
-		str_ << value;
-	else
-		str_ << "null";
-	stack_.back().first = false;
+	writeKey(name);
+	writeNumber(value);
 }
 
 void JsonWriter::writeString(const std::string &value) {
-	str_ << arrayComma() << arrayIndent() << "\"";
+	writeArrayPrefix();
+	str_ += '"';
 	writeEscapedString(value);
-	str_ << "\"";
-	stack_.back().first = false;
+	str_ += '"';
 }
 
 void JsonWriter::writeString(const std::string &name, const std::string &value) {
-	str_ << comma() << indent() << "\"";
-	writeEscapedString(name);
-	str_ << (pretty_ ? "\": \"" : "\":\"");
+	writeKey(name, "\"");
 	writeEscapedString(value);
-	str_ << "\"";
-	stack_.back().first = false;
+	str_ += '"';
 }
 
 void JsonWriter::writeRaw(const std::string &value) {
-	str_ << arrayComma() << arrayIndent() << value;
-	stack_.back().first = false;
+	writeArrayPrefix();
+	str_ += value;
 }
 
 void JsonWriter::writeRaw(const std::string &name, const std::string &value) {
-	str_ << comma() << indent() << "\"";
-	writeEscapedString(name);
-	str_ << (pretty_ ? "\": " : "\":");
-	str_ << value;
-	stack_.back().first = false;
+	writeKey(name);
+	str_ += value;
 }
 
 void JsonWriter::writeNull() {
-	str_ << arrayComma() << arrayIndent() << "null";
-	stack_.back().first = false;
+	writeArrayPrefix();
+	str_ += "null";
 }
 
 void JsonWriter::writeNull(const std::string &name) {
-	str_ << comma() << indent() << "\"";
-	writeEscapedString(name);
-	str_ << (pretty_ ? "\": " : "\":") << "null";
-	stack_.back().first = false;
+	writeKey(name, "null");
 }
 
 void JsonWriter::pop() {
 	BlockType type = stack_.back().type;
 	stack_.pop_back();
-	if (pretty_)
-		str_ << "\n" << indent();
+	if (pretty_) {
+		str_ += '\n';
+		str_ += indent();
+	}
 	switch (type) {
 	case ARRAY:
-		str_ << "]";
+		str_ += ']';
 		break;
 	case DICT:
-		str_ << "}";
+		str_ += '}';
 		break;
 	case RAW:
 		break;
@@ -225,60 +240,40 @@ void JsonWriter::pop() {
 }
 
 void JsonWriter::writeEscapedString(const std::string &str) {
-	size_t pos = 0;
+	const char *p = str.data();
 	const size_t len = str.size();
-
-	auto update = [&](size_t current, size_t skip = 0) {
-		size_t end = current;
-		if (pos < end)
-			str_ << str.substr(pos, end - pos);
-		pos = end + skip;
-	};
+	// Copy runs that need no escaping in one go, most strings are a single run.
+	size_t pos = 0;
 
 	for (size_t i = 0; i < len; ++i) {
-		switch (str[i]) {
-		case '\\':
-		case '"':
-		case '/':
-			update(i);
-			str_ << '\\';
-			break;
-
-		case '\r':
-			update(i, 1);
-			str_ << "\\r";
-			break;
-			break;
-
-		case '\n':
-			update(i, 1);
-			str_ << "\\n";
-			break;
-			break;
-
-		case '\t':
-			update(i, 1);
-			str_ << "\\t";
-			break;
+		const char *escaped = nullptr;
+		char temp[8];
+		switch (p[i]) {
+		case '\\': escaped = "\\\\"; break;
+		case '"': escaped = "\\\""; break;
+		case '/': escaped = "\\/"; break;
+		case '\r': escaped = "\\r"; break;
+		case '\n': escaped = "\\n"; break;
+		case '\t': escaped = "\\t"; break;
 
 		case 1: case 2: case 3: case 4: case 5: case 6: case 7: case 8: case 11:
 		case 12: case 14: case 15: case 16: case 17: case 18: case 19: case 20:
 		case 21: case 22: case 23: case 24: case 25: case 26: case 27: case 28:
 		case 29: case 30: case 31:
-			update(i, 1);
-			str_ << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)str[i] << std::dec << std::setw(0);
+			snprintf(temp, sizeof(temp), "\\u%04x", (int)p[i]);
+			escaped = temp;
 			break;
 
 		default:
-			break;
+			continue;
 		}
-	}
 
-	if (pos != 0) {
-		update(len);
-	} else {
-		str_ << str;
+		str_.append(p + pos, i - pos);
+		str_ += escaped;
+		pos = i + 1;
 	}
+
+	str_.append(p + pos, len - pos);
 }
 
 static void json_stringify_object(JsonWriter &writer, const JsonNode *node);
@@ -1,6 +1,6 @@
 // Minimal-state JSON writer. Consumes almost no memory
-// apart from the string being built-up, which could easily be replaced
-// with a file stream (although I've chosen not to do that just yet).
+// apart from the string being built-up, which is appended to directly
+// and keeps its capacity across clear(), so a writer can be reused.
 //
 // Writes nicely 2-space indented output with correct comma-placement
 // in arrays and dictionaries.
@@ -9,9 +9,9 @@
 //
 // Zero dependencies apart from stdlib (if you remove the vhjson usage.)
 
+#include <cstdint>
 #include <string>
 #include <vector>
-#include <sstream>
 
 struct JsonNode;
 
@@ -45,16 +45,23 @@ class JsonWriter {
 	void writeNull();
 	void writeNull(const std::string &name);
 
-	std::string str() const {
-		return str_.str();
+	// Valid until the next write.
+	const std::string &str() const {
+		return str_;
 	}
 
 	std::string flush() {
-		std::string result = str_.str();
-		str_.str("");
+		std::string result = std::move(str_);
+		str_.clear();
 		return result;
 	}
 
+	// Starts over, keeping the allocated buffer.
+	void clear() {
+		str_.clear();
+		stack_.clear();
+	}
+
 	enum {
 		NORMAL = 0,
 		PRETTY = 1,
@@ -66,6 +73,11 @@ class JsonWriter {
 	const char *arrayComma() const;
 	const char *indent() const;
 	const char *arrayIndent() const;
+	void writeArrayPrefix();
+	void writeKey(const std::string &name, const char *after = "");
+	void writeNumber(int value);
+	void writeNumber(uint32_t value);
+	void writeNumber(double value);
 	void writeEscapedString(const std::string &s);
 
 	enum BlockType {
@@ -79,7 +91,7 @@ class JsonWriter {
 		bool first;
 	};
 	std::vector<StackEntry> stack_;
-	std::ostringstream str_;
+	std::string str_;
 	bool pretty_;
 };
 
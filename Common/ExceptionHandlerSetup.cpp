@@ -97,6 +97,14 @@ void UninstallExceptionHandler() {
 
 #elif defined(__APPLE__)
 
+#if PPSSPP_ARCH(ARM64)
+#define MACH_CONTEXT_STATE ARM_THREAD_STATE64
+#define MACH_CONTEXT_STATE_COUNT ARM_THREAD_STATE64_COUNT
+#else
+#define MACH_CONTEXT_STATE x86_THREAD_STATE64
+#define MACH_CONTEXT_STATE_COUNT x86_THREAD_STATE64_COUNT
+#endif
+
 static void CheckKR(const char* name, kern_return_t kr) {
 	_assert_msg_(kr == 0, "%s failed: kr=%x", name, kr);
 }
@@ -112,7 +120,7 @@ static void ExceptionThread(mach_port_t port) {
 		int64_t code[2];
 		int flavor;
 		mach_msg_type_number_t old_stateCnt;
-		natural_t old_state[x86_THREAD_STATE64_COUNT];
+		natural_t old_state[MACH_CONTEXT_STATE_COUNT];
 		mach_msg_trailer_t trailer;
 	} msg_in;
 
@@ -122,7 +130,7 @@ static void ExceptionThread(mach_port_t port) {
 		kern_return_t RetCode;
 		int flavor;
 		mach_msg_type_number_t new_stateCnt;
-		natural_t new_state[x86_THREAD_STATE64_COUNT];
+		natural_t new_state[MACH_CONTEXT_STATE_COUNT];
 	} msg_out;
 #pragma pack()
 	memset(&msg_in, 0xee, sizeof(msg_in));
@@ -146,9 +154,9 @@ static void ExceptionThread(mach_port_t port) {
 		}
 
 		_assert_msg_(msg_in.Head.msgh_id == 2406, "unknown message received");
-		_assert_msg_(msg_in.flavor == x86_THREAD_STATE64, "unknown flavor %d (expected %d)", msg_in.flavor, x86_THREAD_STATE64);
+		_assert_msg_(msg_in.flavor == MACH_CONTEXT_STATE, "unknown flavor %d (expected %d)", msg_in.flavor, MACH_CONTEXT_STATE);
 
-		x86_thread_state64_t* state = (x86_thread_state64_t*)msg_in.old_state;
+		SContext *state = (SContext *)msg_in.old_state;
 
 		bool ok = g_badAccessHandler((uintptr_t)msg_in.code[1], state);
 
@@ -160,9 +168,9 @@ static void ExceptionThread(mach_port_t port) {
 		msg_out.NDR = msg_in.NDR;
 		if (ok) {
 			msg_out.RetCode = KERN_SUCCESS;
-			msg_out.flavor = x86_THREAD_STATE64;
-			msg_out.new_stateCnt = x86_THREAD_STATE64_COUNT;
-			memcpy(msg_out.new_state, msg_in.old_state, x86_THREAD_STATE64_COUNT * sizeof(natural_t));
+			msg_out.flavor = MACH_CONTEXT_STATE;
+			msg_out.new_stateCnt = MACH_CONTEXT_STATE_COUNT;
+			memcpy(msg_out.new_state, msg_in.old_state, MACH_CONTEXT_STATE_COUNT * sizeof(natural_t));
 		} else {
 			// Pass the exception to the next handler (debugger or crash).
 			msg_out.RetCode = KERN_FAILURE;
@@ -199,7 +207,7 @@ void InstallExceptionHandler(BadAccessHandler badAccessHandler) {
 	// Debuggers set the task port, so we grab the thread port.
 	CheckKR("thread_set_exception_ports",
 		thread_set_exception_ports(mach_thread_self(), EXC_MASK_BAD_ACCESS, port,
-			EXCEPTION_STATE | MACH_EXCEPTION_CODES, x86_THREAD_STATE64));
+			EXCEPTION_STATE | MACH_EXCEPTION_CODES, MACH_CONTEXT_STATE));
 	// ...and get rid of our copy so that MACH_NOTIFY_NO_SENDERS works.
 	CheckKR("mach_port_mod_refs",
 		mach_port_mod_refs(mach_task_self(), port, MACH_PORT_RIGHT_SEND, -1));
@@ -1,3 +1,6 @@
+#include <map>
+#include <mutex>
+
 #include "Common/File/AndroidStorage.h"
 #include "Common/StringUtils.h"
 #include "Common/Log.h"
@@ -31,7 +34,7 @@ void Android_StorageSetNativeActivity(jobject nativeActivity) {
 void Android_RegisterStorageCallbacks(JNIEnv * env, jobject obj) {
 	openContentUri = env->GetMethodID(env->GetObjectClass(obj), "openContentUri", "(Ljava/lang/String;Ljava/lang/String;)I");
 	_dbg_assert_(openContentUri);
-	listContentUriDir = env->GetMethodID(env->GetObjectClass(obj), "listContentUriDir", "(Ljava/lang/String;)[Ljava/lang/String;");
+	listContentUriDir = env->GetMethodID(env->GetObjectClass(obj), "listContentUriDir", "(Ljava/lang/String;)Ljava/lang/String;");
 	_dbg_assert_(listContentUriDir);
 	contentUriCreateDirectory = env->GetMethodID(env->GetObjectClass(obj), "contentUriCreateDirectory", "(Ljava/lang/String;Ljava/lang/String;)I");
 	_dbg_assert_(contentUriCreateDirectory);
@@ -63,6 +66,118 @@ bool Android_IsContentUri(const std::string &filename) {
 	return startsWith(filename, "content://");
 }
 
+// Every query through the Storage Access Framework is slow, and info/exists checks tend to come
+// in bursts for files in the same directory (game browser, savedata, memstick size.) So directory
+// listings are kept for a little while and used to answer those. Our own changes drop the affected
+// directories, anything else only shows up after the timeout.
+static const double LISTING_CACHE_SECONDS = 5.0;
+static const size_t LISTING_CACHE_MAX = 64;
+
+struct CachedListing {
+	double time;
+	std::vector<File::FileInfo> files;
+};
+
+static std::mutex g_listingCacheLock;
+static std::map<std::string, CachedListing> g_listingCache;
+// Directory of the last GetFileInfo/FileExists miss.  A second miss there lists it.
+static std::string g_lastMissDir;
+
+static std::string ListingCacheKey(const std::string &uri) {
+	std::string key = Path(uri).ToString();
+	while (!key.empty() && key.back() == '/')
+		key.pop_back();
+	return key;
+}
+
+static std::string ParentListingCacheKey(const std::string &uri) {
+	Path path(uri);
+	if (!path.CanNavigateUp())
+		return "";
+	return ListingCacheKey(path.NavigateUp().ToString());
+}
+
+static void InvalidateListing(const std::string &uri) {
+	std::lock_guard<std::mutex> guard(g_listingCacheLock);
+	g_listingCache.erase(ListingCacheKey(uri));
+}
+
+static void InvalidateParentListing(const std::string &uri) {
+	std::string key = ParentListingCacheKey(uri);
+	std::lock_guard<std::mutex> guard(g_listingCacheLock);
+	g_listingCache.erase(key);
+	// A directory can also be the one changing.
+	g_listingCache.erase(ListingCacheKey(uri));
+}
+
+void Android_InvalidateStorageCache() {
+	std::lock_guard<std::mutex> guard(g_listingCacheLock);
+	g_listingCache.clear();
+	g_lastMissDir.clear();
+}
+
+static bool FindCachedListing(const std::string &key, std::vector<File::FileInfo> *files) {
+	std::lock_guard<std::mutex> guard(g_listingCacheLock);
+	auto iter = g_listingCache.find(key);
+	if (iter == g_listingCache.end())
+		return false;
+	if (time_now_d() - iter->second.time > LISTING_CACHE_SECONDS) {
+		g_listingCache.erase(iter);
+		return false;
+	}
+	*files = iter->second.files;
+	return true;
+}
+
+static void StoreCachedListing(const std::string &key, const std::vector<File::FileInfo> &files) {
+	std::lock_guard<std::mutex> guard(g_listingCacheLock);
+	if (g_listingCache.size() >= LISTING_CACHE_MAX) {
+		auto oldest = g_listingCache.begin();
+		for (auto iter = g_listingCache.begin(); iter != g_listingCache.end(); ++iter) {
+			if (iter->second.time < oldest->second.time)
+				oldest = iter;
+		}
+		g_listingCache.erase(oldest);
+	}
+	CachedListing &listing = g_listingCache[key];
+	listing.time = time_now_d();
+	listing.files = files;
+}
+
+static std::vector<File::FileInfo> ListContentUriUncached(const std::string &path);
+
+// Returns 1 if found, 0 if the parent listing says it doesn't exist, or -1 if we don't know.
+static int LookupCachedFileInfo(const std::string &fileUri, File::FileInfo *fileInfo) {
+	std::string dirKey = ParentListingCacheKey(fileUri);
+	if (dirKey.empty())
+		return -1;
+
+	std::vector<File::FileInfo> files;
+	if (!FindCachedListing(dirKey, &files)) {
+		{
+			std::lock_guard<std::mutex> guard(g_listingCacheLock);
+			if (g_lastMissDir != dirKey) {
+				g_lastMissDir = dirKey;
+				return -1;
+			}
+		}
+		files = ListContentUriUncached(dirKey);
+		StoreCachedListing(dirKey, files);
+	}
+
+	std::string name = Path(fileUri).GetFilename();
+	for (const File::FileInfo &info : files) {
+		if (info.name == name) {
+			if (fileInfo) {
+				*fileInfo = info;
+				fileInfo->fullName = Path(fileUri);
+			}
+			return 1;
+		}
+	}
+	return 0;
+}
+
 int Android_OpenContentUriFd(const std::string &filename, Android_OpenContentUriMode mode) {
 	if (!g_nativeActivity) {
 		return -1;
@@ -81,6 +196,8 @@ int Android_OpenContentUriFd(const std::string &filename, Android_OpenContentUri
 	case Android_OpenContentUriMode::READ_WRITE: modeStr = "rw"; break;
 	case Android_OpenContentUriMode::READ_WRITE_TRUNCATE: modeStr = "rwt"; break;
 	}
+	if (mode != Android_OpenContentUriMode::READ)
+		InvalidateParentListing(fname);
 	jstring j_filename = env->NewStringUTF(fname.c_str());
 	jstring j_mode = env->NewStringUTF(modeStr);
 	int fd = env->CallIntMethod(g_nativeActivity, openContentUri, j_filename, j_mode);
@@ -92,6 +209,7 @@ StorageError Android_CreateDirectory(const std::string &rootTreeUri, const std::
 		return StorageError::UNKNOWN;
 	}
 	auto env = getEnv();
+	InvalidateListing(rootTreeUri);
 	jstring paramRoot = env->NewStringUTF(rootTreeUri.c_str());
 	jstring paramDirName = env->NewStringUTF(dirName.c_str());
 	return StorageErrorFromInt(env->CallIntMethod(g_nativeActivity, contentUriCreateDirectory, paramRoot, paramDirName));
@@ -102,6 +220,7 @@ StorageError Android_CreateFile(const std::string &parentTreeUri, const std::str
 		return StorageError::UNKNOWN;
 	}
 	auto env = getEnv();
+	InvalidateListing(parentTreeUri);
 	jstring paramRoot = env->NewStringUTF(parentTreeUri.c_str());
 	jstring paramFileName = env->NewStringUTF(fileName.c_str());
 	return StorageErrorFromInt(env->CallIntMethod(g_nativeActivity, contentUriCreateFile, paramRoot, paramFileName));
@@ -112,6 +231,7 @@ StorageError Android_CopyFile(const std::string &fileUri, const std::string &des
 		return StorageError::UNKNOWN;
 	}
 	auto env = getEnv();
+	InvalidateListing(destParentUri);
 	jstring paramFileName = env->NewStringUTF(fileUri.c_str());
 	jstring paramDestParentUri = env->NewStringUTF(destParentUri.c_str());
 	return StorageErrorFromInt(env->CallIntMethod(g_nativeActivity, contentUriCopyFile, paramFileName, paramDestParentUri));
@@ -122,6 +242,9 @@ StorageError Android_MoveFile(const std::string &fileUri, const std::string &src
 		return StorageError::UNKNOWN;
 	}
 	auto env = getEnv();
+	InvalidateParentListing(fileUri);
+	InvalidateListing(srcParentUri);
+	InvalidateListing(destParentUri);
 	jstring paramFileName = env->NewStringUTF(fileUri.c_str());
 	jstring paramSrcParentUri = env->NewStringUTF(srcParentUri.c_str());
 	jstring paramDestParentUri = env->NewStringUTF(destParentUri.c_str());
@@ -133,6 +256,7 @@ StorageError Android_RemoveFile(const std::string &fileUri) {
 		return StorageError::UNKNOWN;
 	}
 	auto env = getEnv();
+	InvalidateParentListing(fileUri);
 	jstring paramFileName = env->NewStringUTF(fileUri.c_str());
 	return StorageErrorFromInt(env->CallIntMethod(g_nativeActivity, contentUriRemoveFile, paramFileName));
 }
@@ -142,6 +266,7 @@ StorageError Android_RenameFileTo(const std::string &fileUri, const std::string
 		return StorageError::UNKNOWN;
 	}
 	auto env = getEnv();
+	InvalidateParentListing(fileUri);
 	jstring paramFileUri = env->NewStringUTF(fileUri.c_str());
 	jstring paramNewName = env->NewStringUTF(newName.c_str());
 	return StorageErrorFromInt(env->CallIntMethod(g_nativeActivity, contentUriRenameFileTo, paramFileUri, paramNewName));
@@ -179,6 +304,10 @@ bool Android_GetFileInfo(const std::string &fileUri, File::FileInfo *fileInfo) {
 	if (!g_nativeActivity) {
 		return false;
 	}
+	int cached = LookupCachedFileInfo(fileUri, fileInfo);
+	if (cached != -1)
+		return cached == 1;
+
 	auto env = getEnv();
 	jstring paramFileUri = env->NewStringUTF(fileUri.c_str());
 
@@ -198,49 +327,70 @@ bool Android_FileExists(const std::string &fileUri) {
 	if (!g_nativeActivity) {
 		return false;
 	}
+	int cached = LookupCachedFileInfo(fileUri, nullptr);
+	if (cached != -1)
+		return cached == 1;
+
 	auto env = getEnv();
 	jstring paramFileUri = env->NewStringUTF(fileUri.c_str());
 	bool exists = env->CallBooleanMethod(g_nativeActivity, contentUriFileExists, paramFileUri);
 	return exists;
 }
 
-std::vector<File::FileInfo> Android_ListContentUri(const std::string &path) {
-	if (!g_nativeActivity) {
-		return std::vector<File::FileInfo>();
-	}
+static std::vector<File::FileInfo> ListContentUriUncached(const std::string &path) {
 	auto env = getEnv();
 
 	double start = time_now_d();
 
 	jstring param = env->NewStringUTF(path.c_str());
-	jobject retval = env->CallObjectMethod(g_nativeActivity, listContentUriDir, param);
+	jstring str = (jstring)env->CallObjectMethod(g_nativeActivity, listContentUriDir, param);
+	env->DeleteLocalRef(param);
 
-	jobjectArray fileList = (jobjectArray)retval;
 	std::vector<File::FileInfo> items;
-	int size = env->GetArrayLength(fileList);
-	for (int i = 0; i < size; i++) {
-		jstring str = (jstring)env->GetObjectArrayElement(fileList, i);
-		const char *charArray = env->GetStringUTFChars(str, 0);
-		if (charArray) {  // paranoia
+	if (!str)
+		return items;
+	const char *charArray = env->GetStringUTFChars(str, 0);
+	if (charArray) {  // paranoia
+		std::vector<std::string> lines;
+		SplitString(charArray, '\n', lines);
+		for (const std::string &line : lines) {
 			File::FileInfo info;
-			if (ParseFileInfo(std::string(charArray), &info)) {
+			if (!line.empty() && ParseFileInfo(line, &info)) {
 				// We can just reconstruct the URI.
 				info.fullName = Path(path) / info.name;
 				items.push_back(info);
 			}
 		}
 		env->ReleaseStringUTFChars(str, charArray);
-		env->DeleteLocalRef(str);
 	}
-	env->DeleteLocalRef(fileList);
+	env->DeleteLocalRef(str);
 
 	double elapsed = time_now_d() - start;
 	if (elapsed > 0.1) {
-		INFO_LOG(FILESYS, "Listing directory on content URI took %0.3f s (%d files)", elapsed, (int)size);
+		INFO_LOG(FILESYS, "Listing directory on content URI took %0.3f s (%d files)", elapsed, (int)items.size());
 	}
 	return items;
 }
 
+std::vector<File::FileInfo> Android_ListContentUri(const std::string &path) {
+	if (!g_nativeActivity) {
+		return std::vector<File::FileInfo>();
+	}
+
+	std::string key = ListingCacheKey(path);
+	std::vector<File::FileInfo> items;
+	if (FindCachedListing(key, &items)) {
+		// The names are the same, but the caller might have spelled the directory differently.
+		for (File::FileInfo &info : items)
+			info.fullName = Path(path) / info.name;
+		return items;
+	}
+
+	items = ListContentUriUncached(path);
+	StoreCachedListing(key, items);
+	return items;
+}
+
 int64_t Android_GetFreeSpaceByContentUri(const std::string &uri) {
 	if (!g_nativeActivity) {
 		return false;
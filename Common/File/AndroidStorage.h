@@ -56,6 +56,8 @@ bool Android_IsExternalStoragePreservedLegacy();
 const char *Android_ErrorToString(StorageError error);
 
 std::vector<File::FileInfo> Android_ListContentUri(const std::string &uri);
+// Forgets the cached directory listings, for when files may have changed outside PPSSPP.
+void Android_InvalidateStorageCache();
 
 void Android_RegisterStorageCallbacks(JNIEnv * env, jobject obj);
 
@@ -81,5 +83,6 @@ inline const char *Android_ErrorToString(StorageError error) { return ""; }
 inline std::vector<File::FileInfo> Android_ListContentUri(const std::string &uri) {
 	return std::vector<File::FileInfo>();
 }
+inline void Android_InvalidateStorageCache() {}
 
 #endif
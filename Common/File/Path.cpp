@@ -16,6 +16,8 @@
 #include <dirent.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <mutex>
+#include <unordered_map>
 #endif
 
 Path::Path(const std::string &str) {
@@ -361,48 +363,118 @@ bool Path::ComputePathTo(const Path &other, std::string &path) const {
 
 #if HOST_IS_CASE_SENSITIVE
 
-static bool FixFilenameCase(const std::string &path, std::string &filename) {
-	// Are we lucky?
-	if (File::Exists(Path(path + filename)))
-		return true;
+// The names in each directory FixFilenameCase has had to scan, by lowercase name, so repeated lookups
+// (often of files that don't exist) don't scan again. A changed mtime means a rescan, but it may
+// only have a resolution of seconds, so our own changes also update the lists (see FixPathCaseNotify*.)
+struct DirCaseNames {
+	int64_t mtime = 0;
+	std::unordered_map<std::string, std::string> names;
+};
 
-	size_t filenameSize = filename.size();  // size in bytes, not characters
-	for (size_t i = 0; i < filenameSize; i++)
-	{
-		filename[i] = tolower(filename[i]);
-	}
+// Plenty for a game's save data directories.
+static const size_t MAX_CASE_CACHE_DIRS = 256;
 
-	//TODO: lookup filename in cache for "path"
-	struct dirent *result = NULL;
+static std::mutex dirCaseLock;
+static std::unordered_map<std::string, DirCaseNames> dirCaseCache;
 
-	DIR *dirp = opendir(path.c_str());
-	if (!dirp)
+static bool DirModifiedTime(const std::string &path, int64_t *mtime) {
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
 		return false;
+#if defined(__APPLE__)
+	*mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+	*mtime = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#else
+	*mtime = (int64_t)st.st_mtime * 1000000000LL;
+#endif
+	return true;
+}
 
-	bool retValue = false;
+static std::string LowerCase(std::string str) {
+	for (char &c : str)
+		c = tolower(c);
+	return str;
+}
 
-	while ((result = readdir(dirp)))
-	{
-		if (strlen(result->d_name) != filenameSize)
-			continue;
+static bool FixFilenameCase(const std::string &path, std::string &filename) {
+	// Are we lucky?
+	if (File::Exists(Path(path) / filename))
+		return true;
 
-		size_t i;
-		for (i = 0; i < filenameSize; i++)
-		{
-			if (filename[i] != tolower(result->d_name[i]))
-				break;
+	int64_t mtime;
+	if (!DirModifiedTime(path, &mtime))
+		return false;
+
+	std::lock_guard<std::mutex> guard(dirCaseLock);
+	auto cached = dirCaseCache.find(path);
+	if (cached == dirCaseCache.end() || cached->second.mtime != mtime) {
+		DIR *dirp = opendir(path.c_str());
+		if (!dirp)
+			return false;
+
+		if (cached == dirCaseCache.end()) {
+			if (dirCaseCache.size() >= MAX_CASE_CACHE_DIRS)
+				dirCaseCache.clear();
+			cached = dirCaseCache.emplace(path, DirCaseNames()).first;
 		}
+		DirCaseNames &dir = cached->second;
+		dir.mtime = mtime;
+		dir.names.clear();
+
+		struct dirent *result = NULL;
+		while ((result = readdir(dirp))) {
+			// If there are several, the last one wins, as it always has.
+			dir.names[LowerCase(result->d_name)] = result->d_name;
+		}
+		closedir(dirp);
+	}
 
-		if (i < filenameSize)
-			continue;
+	auto name = cached->second.names.find(LowerCase(filename));
+	if (name == cached->second.names.end())
+		return false;
+	filename = name->second;
+	return true;
+}
 
-		filename = result->d_name;
-		retValue = true;
+void FixPathCaseNotifyCreated(const Path &path) {
+	std::lock_guard<std::mutex> guard(dirCaseLock);
+	// Directories may have been created all the way down.
+	for (Path cur = path; cur.CanNavigateUp(); cur = cur.NavigateUp()) {
+		std::string dirPath = cur.NavigateUp().ToString();
+		auto cached = dirCaseCache.find(dirPath);
+		if (cached == dirCaseCache.end())
+			continue;
+		std::string name = cur.GetFilename();
+		cached->second.names[LowerCase(name)] = name;
+		// This was our change, no need to rescan for it.
+		DirModifiedTime(dirPath, &cached->second.mtime);
 	}
+}
 
-	closedir(dirp);
+void FixPathCaseNotifyRemoved(const Path &path) {
+	std::lock_guard<std::mutex> guard(dirCaseLock);
+	if (path.CanNavigateUp()) {
+		std::string dirPath = path.NavigateUp().ToString();
+		auto cached = dirCaseCache.find(dirPath);
+		if (cached != dirCaseCache.end()) {
+			auto &names = cached->second.names;
+			auto name = names.find(LowerCase(path.GetFilename()));
+			// Only if it's the same case, otherwise it wasn't what was removed.
+			if (name != names.end() && name->second == path.GetFilename())
+				names.erase(name);
+			DirModifiedTime(dirPath, &cached->second.mtime);
+		}
+	}
 
-	return retValue;
+	// If it was a directory, forget it and everything inside.
+	std::string prefix = path.ToString() + "/";
+	for (auto it = dirCaseCache.begin(); it != dirCaseCache.end(); ) {
+		if (it->first == path.ToString() || startsWith(it->first, prefix))
+			it = dirCaseCache.erase(it);
+		else
+			++it;
+	}
 }
 
 bool FixPathCase(const Path &realBasePath, std::string &path, FixPathCaseBehavior behavior) {
@@ -142,4 +142,9 @@ enum FixPathCaseBehavior {
 
 bool FixPathCase(const Path &basePath, std::string &path, FixPathCaseBehavior behavior);
 
+// Lets FixPathCase know about files and directories we created or removed, so it doesn't need to
+// rescan (or miss it, since directory mtimes can be coarse.)
+void FixPathCaseNotifyCreated(const Path &path);
+void FixPathCaseNotifyRemoved(const Path &path);
+
 #endif
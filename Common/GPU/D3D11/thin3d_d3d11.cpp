@@ -12,6 +12,7 @@
 #include "Common/Data/Convert/SmallDataConvert.h"
 #include "Common/Data/Encoding/Utf8.h"
 #include "Common/Log.h"
+#include "Common/StringUtils.h"
 
 #include <cfloat>
 #include <D3Dcommon.h>
@@ -63,6 +64,7 @@ class D3D11DrawContext : public DrawContext {
 	Buffer *CreateBuffer(size_t size, uint32_t usageFlags) override;
 	Pipeline *CreateGraphicsPipeline(const PipelineDesc &desc) override;
 	Texture *CreateTexture(const TextureDesc &desc) override;
+	bool UpdateTextureRect(Texture *tex, int x, int y, int w, int h, const uint8_t *data) override;
 	ShaderModule *CreateShaderModule(ShaderStage stage, ShaderLanguage language, const uint8_t *data, size_t dataSize, const std::string &tag) override;
 	Framebuffer *CreateFramebuffer(const FramebufferDesc &desc) override;
 
@@ -171,9 +173,22 @@ class D3D11DrawContext : public DrawContext {
 		return stepId_;
 	}
 
+	bool GetGPUTimings(GPUFrameTimings *timings) override {
+		if (lastGpuTimings_.passes.empty())
+			return false;
+		*timings = lastGpuTimings_;
+		return true;
+	}
+
 private:
 	void ApplyCurrentState();
 
+	void BeginGPUTimingFrame();
+	void EndGPUTimingFrame();
+	void WriteTimestamp(const char *description);
+	void ResolveGPUTimings(int frame);
+	void DestroyGPUTimingQueries();
+
 	HWND hWnd_;
 	ID3D11Device *device_;
 	ID3D11DeviceContext *context_;
@@ -224,6 +239,24 @@ class D3D11DrawContext : public DrawContext {
 	// Temporaries
 	ID3D11Texture2D *packTexture_ = nullptr;
 
+	// GPU timing. A timestamp is written at every render target switch, and results are read back
+	// a few frames later when the same slot comes around again.
+	enum {
+		MAX_TIMING_FRAMES = 3,
+		MAX_TIMESTAMP_QUERIES = 128,
+	};
+	struct TimingFrame {
+		ID3D11Query *disjoint = nullptr;
+		ID3D11Query *timestamps[MAX_TIMESTAMP_QUERIES]{};
+		std::vector<std::string> descriptions;
+		bool pending = false;
+	};
+	TimingFrame timingFrames_[MAX_TIMING_FRAMES];
+	int curTimingFrame_ = 0;
+	bool timingActive_ = false;
+	const char *curTimingTag_ = nullptr;
+	GPUFrameTimings lastGpuTimings_;
+
 	// System info
 	D3D_FEATURE_LEVEL featureLevel_;
 	std::string adapterDesc_;
@@ -254,6 +287,7 @@ D3D11DrawContext::D3D11DrawContext(ID3D11Device *device, ID3D11DeviceContext *de
 	caps_.framebufferCopySupported = true;
 	caps_.framebufferDepthBlitSupported = false;
 	caps_.framebufferDepthCopySupported = true;
+	caps_.timestampQueriesSupported = featureLevel_ >= D3D_FEATURE_LEVEL_10_0;
 
 	D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
 	HRESULT result = device_->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
@@ -310,6 +344,7 @@ D3D11DrawContext::D3D11DrawContext(ID3D11Device *device, ID3D11DeviceContext *de
 }
 
 D3D11DrawContext::~D3D11DrawContext() {
+	DestroyGPUTimingQueries();
 	packTexture_->Release();
 
 	// Release references.
@@ -384,9 +419,112 @@ void D3D11DrawContext::HandleEvent(Event ev, int width, int height, void *param1
 }
 
 void D3D11DrawContext::EndFrame() {
+	EndGPUTimingFrame();
 	curPipeline_ = nullptr;
 }
 
+void D3D11DrawContext::BeginGPUTimingFrame() {
+	// In case EndFrame was skipped.
+	EndGPUTimingFrame();
+
+	curTimingFrame_ = (curTimingFrame_ + 1) % MAX_TIMING_FRAMES;
+	TimingFrame &frame = timingFrames_[curTimingFrame_];
+	if (frame.pending) {
+		ResolveGPUTimings(curTimingFrame_);
+		frame.pending = false;
+	}
+
+	timingActive_ = gpuTimingEnabled_ && caps_.timestampQueriesSupported;
+	if (!timingActive_) {
+		lastGpuTimings_ = GPUFrameTimings();
+		return;
+	}
+
+	if (!frame.disjoint) {
+		D3D11_QUERY_DESC desc{ D3D11_QUERY_TIMESTAMP_DISJOINT };
+		HRESULT hr = device_->CreateQuery(&desc, &frame.disjoint);
+		desc.Query = D3D11_QUERY_TIMESTAMP;
+		for (int i = 0; i < MAX_TIMESTAMP_QUERIES && SUCCEEDED(hr); i++) {
+			hr = device_->CreateQuery(&desc, &frame.timestamps[i]);
+		}
+		if (FAILED(hr)) {
+			ERROR_LOG(G3D, "Failed to create timestamp queries, GPU timing disabled");
+			DestroyGPUTimingQueries();
+			caps_.timestampQueriesSupported = false;
+			timingActive_ = false;
+			return;
+		}
+	}
+
+	frame.descriptions.clear();
+	context_->Begin(frame.disjoint);
+	curTimingTag_ = "Begin";
+	WriteTimestamp(curTimingTag_);
+	curTimingTag_ = "(frame start)";
+}
+
+void D3D11DrawContext::EndGPUTimingFrame() {
+	if (!timingActive_)
+		return;
+	TimingFrame &frame = timingFrames_[curTimingFrame_];
+	WriteTimestamp(curTimingTag_);
+	context_->End(frame.disjoint);
+	frame.pending = true;
+	timingActive_ = false;
+}
+
+// D3D11 has no render passes, so the time between two render target switches is blamed on the first one.
+void D3D11DrawContext::WriteTimestamp(const char *description) {
+	TimingFrame &frame = timingFrames_[curTimingFrame_];
+	size_t index = frame.descriptions.size();
+	if (index >= MAX_TIMESTAMP_QUERIES)
+		return;
+	context_->End(frame.timestamps[index]);
+	frame.descriptions.push_back(StringFromFormat("RENDER %s", description));
+}
+
+void D3D11DrawContext::ResolveGPUTimings(int frameIndex) {
+	TimingFrame &frame = timingFrames_[frameIndex];
+	if (frame.descriptions.size() < 2)
+		return;
+
+	// If it's not done by now, we just skip this frame rather than stalling.
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjointData{};
+	if (context_->GetData(frame.disjoint, &disjointData, sizeof(disjointData), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK || disjointData.Disjoint)
+		return;
+
+	std::vector<uint64_t> results(frame.descriptions.size());
+	for (size_t i = 0; i < results.size(); i++) {
+		if (context_->GetData(frame.timestamps[i], &results[i], sizeof(uint64_t), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+			return;
+	}
+
+	double toMs = 1000.0 / (double)disjointData.Frequency;
+	GPUFrameTimings &timings = lastGpuTimings_;
+	timings.totalMs = (double)(results.back() - results[0]) * toMs;
+	timings.cpuMs = 0.0;
+	timings.passes.resize(results.size() - 1);
+	for (size_t i = 0; i < results.size() - 1; i++) {
+		timings.passes[i].name = frame.descriptions[i + 1];
+		timings.passes[i].ms = (double)(results[i + 1] - results[i]) * toMs;
+	}
+}
+
+void D3D11DrawContext::DestroyGPUTimingQueries() {
+	for (TimingFrame &frame : timingFrames_) {
+		if (frame.disjoint)
+			frame.disjoint->Release();
+		frame.disjoint = nullptr;
+		for (ID3D11Query *&query : frame.timestamps) {
+			if (query)
+				query->Release();
+			query = nullptr;
+		}
+		frame.descriptions.clear();
+		frame.pending = false;
+	}
+}
+
 void D3D11DrawContext::SetViewports(int count, Viewport *viewports) {
 	D3D11_VIEWPORT vp[4];
 	for (int i = 0; i < count; i++) {
@@ -735,6 +873,8 @@ class D3D11Texture : public Texture {
 		width_ = desc.width;
 		height_ = desc.height;
 		depth_ = desc.depth;
+		format = desc.format;
+		mipLevels = desc.mipLevels;
 	}
 	~D3D11Texture() {
 		if (tex)
@@ -748,6 +888,8 @@ class D3D11Texture : public Texture {
 	ID3D11Texture2D *tex = nullptr;
 	ID3D11Texture2D *stagingTex = nullptr;
 	ID3D11ShaderResourceView *view = nullptr;
+	DataFormat format;
+	int mipLevels;
 };
 
 Texture *D3D11DrawContext::CreateTexture(const TextureDesc &desc) {
@@ -883,6 +1025,15 @@ Texture *D3D11DrawContext::CreateTexture(const TextureDesc &desc) {
 	return tex;
 }
 
+bool D3D11DrawContext::UpdateTextureRect(Texture *texture, int x, int y, int w, int h, const uint8_t *data) {
+	D3D11Texture *tex = (D3D11Texture *)texture;
+	if (!tex->tex || tex->mipLevels != 1)
+		return false;
+	D3D11_BOX box{ (UINT)x, (UINT)y, 0, (UINT)(x + w), (UINT)(y + h), 1 };
+	context_->UpdateSubresource(tex->tex, 0, &box, data, w * (UINT)DataFormatSizeInBytes(tex->format), 0);
+	return true;
+}
+
 ShaderModule *D3D11DrawContext::CreateShaderModule(ShaderStage stage, ShaderLanguage language, const uint8_t *data, size_t dataSize, const std::string &tag) {
 	if (language != ShaderLanguage::HLSL_D3D11) {
 		ERROR_LOG(G3D, "Unsupported shader language");
@@ -1370,6 +1521,8 @@ void D3D11DrawContext::Clear(int mask, uint32_t colorval, float depthVal, int st
 }
 
 void D3D11DrawContext::BeginFrame() {
+	BeginGPUTimingFrame();
+
 	context_->OMSetRenderTargets(1, &curRenderTargetView_, curDepthStencilView_);
 
 	if (curBlend_ != nullptr) {
@@ -1575,6 +1728,11 @@ bool D3D11DrawContext::CopyFramebufferToMemorySync(Framebuffer *src, int channel
 }
 
 void D3D11DrawContext::BindFramebufferAsRenderTarget(Framebuffer *fbo, const RenderPassInfo &rp, const char *tag) {
+	if (timingActive_) {
+		WriteTimestamp(curTimingTag_);
+		curTimingTag_ = tag ? tag : "(untagged)";
+	}
+
 	// TODO: deviceContext1 can actually discard. Useful on Windows Mobile.
 	if (fbo) {
 		D3D11Framebuffer *fb = (D3D11Framebuffer *)fbo;
@@ -58,6 +58,12 @@ typedef void (EGLAPIENTRYP PFNGLBLITFRAMEBUFFERNVPROC) (
 #endif
 extern PFNGLBLITFRAMEBUFFERNVPROC glBlitFramebufferNV;
 
+extern PFNGLGENQUERIESEXTPROC glGenQueriesEXT;
+extern PFNGLDELETEQUERIESEXTPROC glDeleteQueriesEXT;
+extern PFNGLQUERYCOUNTEREXTPROC glQueryCounterEXT;
+extern PFNGLGETQUERYOBJECTUIVEXTPROC glGetQueryObjectuivEXT;
+extern PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXT;
+
 #if PPSSPP_PLATFORM(IOS)
 extern PFNGLDISCARDFRAMEBUFFEREXTPROC glDiscardFramebufferEXT;
 extern PFNGLGENVERTEXARRAYSOESPROC glGenVertexArraysOES;
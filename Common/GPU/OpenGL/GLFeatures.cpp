@@ -30,6 +30,12 @@ PFNGLGENVERTEXARRAYSOESPROC glGenVertexArraysOES;
 PFNGLBINDVERTEXARRAYOESPROC glBindVertexArrayOES;
 PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOES;
 PFNGLISVERTEXARRAYOESPROC glIsVertexArrayOES;
+
+PFNGLGENQUERIESEXTPROC glGenQueriesEXT;
+PFNGLDELETEQUERIESEXTPROC glDeleteQueriesEXT;
+PFNGLQUERYCOUNTEREXTPROC glQueryCounterEXT;
+PFNGLGETQUERYOBJECTUIVEXTPROC glGetQueryObjectuivEXT;
+PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXT;
 #endif
 #if !PPSSPP_PLATFORM(IOS)
 #include "EGL/egl.h"
@@ -352,6 +358,7 @@ void CheckGLExtensions() {
 	gl_extensions.ARB_blend_func_extended = g_set_gl_extensions.count("GL_ARB_blend_func_extended") != 0;
 	gl_extensions.EXT_blend_func_extended = g_set_gl_extensions.count("GL_EXT_blend_func_extended") != 0;
 	gl_extensions.ARB_conservative_depth = g_set_gl_extensions.count("GL_ARB_conservative_depth") != 0;
+	gl_extensions.ARB_shader_stencil_export = g_set_gl_extensions.count("GL_ARB_shader_stencil_export") != 0;
 	gl_extensions.ARB_shader_image_load_store = (g_set_gl_extensions.count("GL_ARB_shader_image_load_store") != 0) || (g_set_gl_extensions.count("GL_EXT_shader_image_load_store") != 0);
 	gl_extensions.ARB_shading_language_420pack = (g_set_gl_extensions.count("GL_ARB_shading_language_420pack") != 0);
 	gl_extensions.EXT_bgra = g_set_gl_extensions.count("GL_EXT_bgra") != 0;
@@ -370,6 +377,8 @@ void CheckGLExtensions() {
 	gl_extensions.ARB_cull_distance = g_set_gl_extensions.count("GL_ARB_cull_distance") != 0;
 	gl_extensions.ARB_depth_clamp = g_set_gl_extensions.count("GL_ARB_depth_clamp") != 0;
 	gl_extensions.ARB_uniform_buffer_object = g_set_gl_extensions.count("GL_ARB_uniform_buffer_object") != 0;
+	gl_extensions.ARB_get_program_binary = g_set_gl_extensions.count("GL_ARB_get_program_binary") != 0;
+	gl_extensions.ARB_timer_query = g_set_gl_extensions.count("GL_ARB_timer_query") != 0;
 	gl_extensions.ARB_explicit_attrib_location = g_set_gl_extensions.count("GL_ARB_explicit_attrib_location") != 0;
 
 	if (gl_extensions.IsGLES) {
@@ -422,9 +431,20 @@ void CheckGLExtensions() {
 		if (gl_extensions.EXT_discard_framebuffer) {
 			glDiscardFramebufferEXT = (PFNGLDISCARDFRAMEBUFFEREXTPROC)eglGetProcAddress("glDiscardFramebufferEXT");
 		}
+
+		gl_extensions.EXT_disjoint_timer_query = g_set_gl_extensions.count("GL_EXT_disjoint_timer_query") != 0;
+		if (gl_extensions.EXT_disjoint_timer_query) {
+			glGenQueriesEXT = (PFNGLGENQUERIESEXTPROC)eglGetProcAddress("glGenQueriesEXT");
+			glDeleteQueriesEXT = (PFNGLDELETEQUERIESEXTPROC)eglGetProcAddress("glDeleteQueriesEXT");
+			glQueryCounterEXT = (PFNGLQUERYCOUNTEREXTPROC)eglGetProcAddress("glQueryCounterEXT");
+			glGetQueryObjectuivEXT = (PFNGLGETQUERYOBJECTUIVEXTPROC)eglGetProcAddress("glGetQueryObjectuivEXT");
+			glGetQueryObjectui64vEXT = (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+			gl_extensions.EXT_disjoint_timer_query = glGenQueriesEXT && glDeleteQueriesEXT && glQueryCounterEXT && glGetQueryObjectuivEXT && glGetQueryObjectui64vEXT;
+		}
 #else
 		gl_extensions.OES_vertex_array_object = false;
 		gl_extensions.EXT_discard_framebuffer = false;
+		gl_extensions.EXT_disjoint_timer_query = false;
 #endif
 	} else {
 		// Desktops support minmax and subimage unpack (GL_UNPACK_ROW_LENGTH etc)
@@ -525,12 +545,13 @@ void CheckGLExtensions() {
 		if (gl_extensions.VersionGEThan(3, 3)) {
 			gl_extensions.ARB_blend_func_extended = true;
 			gl_extensions.ARB_explicit_attrib_location = true;
+			gl_extensions.ARB_timer_query = true;
 		}
 		if (gl_extensions.VersionGEThan(4, 0)) {
 			// ARB_gpu_shader5 = true;
 		}
 		if (gl_extensions.VersionGEThan(4, 1)) {
-			// ARB_get_program_binary = true;
+			gl_extensions.ARB_get_program_binary = true;
 			// ARB_separate_shader_objects = true;
 			// ARB_shader_precision = true;
 			// ARB_viewport_array = true;
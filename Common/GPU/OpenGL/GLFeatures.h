@@ -61,6 +61,7 @@ struct GLExtensions {
 	bool ARB_shader_image_load_store;
 	bool ARB_shading_language_420pack;
 	bool ARB_conservative_depth;
+	bool ARB_shader_stencil_export;
 	bool ARB_copy_image;
 	bool ARB_vertex_array_object;
 	bool ARB_texture_float;
@@ -69,6 +70,8 @@ struct GLExtensions {
 	bool ARB_cull_distance;
 	bool ARB_depth_clamp;
 	bool ARB_uniform_buffer_object;
+	bool ARB_get_program_binary;
+	bool ARB_timer_query;
 
 	// EXT
 	bool EXT_swap_control_tear;
@@ -85,6 +88,7 @@ struct GLExtensions {
 	bool EXT_draw_instanced;
 	bool EXT_buffer_storage;
 	bool EXT_clip_cull_distance;
+	bool EXT_disjoint_timer_query;  // Only loaded on Android.
 
 	// NV
 	bool NV_copy_image;
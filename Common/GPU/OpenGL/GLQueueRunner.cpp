@@ -10,6 +10,7 @@
 #include "Common/Log.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtils.h"
+#include "Common/TimeUtil.h"
 #include "Common/Data/Convert/SmallDataConvert.h"
 
 #include "Core/Reporting.h"
@@ -67,6 +68,16 @@ void GLQueueRunner::CreateDeviceObjects() {
 	CHECK_GL_ERROR_IF_DEBUG();
 
 	useDebugGroups_ = !gl_extensions.IsGLES && gl_extensions.VersionGEThan(4, 3);
+
+	// Some drivers expose the API but no formats, which means binaries can never be loaded.
+	bool programBinary = false;
+	if (gl_extensions.GLES3 || gl_extensions.ARB_get_program_binary) {
+		GLint numFormats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+		programBinary = numFormats > 0;
+	}
+	supportsProgramBinary_ = programBinary;
+	CHECK_GL_ERROR_IF_DEBUG();
 }
 
 void GLQueueRunner::DestroyDeviceObjects() {
@@ -190,63 +201,74 @@ void GLQueueRunner::RunInitSteps(const std::vector<GLRInitStep> &steps, bool ski
 			GLRProgram *program = step.create_program.program;
 			program->program = glCreateProgram();
 			_assert_msg_(step.create_program.num_shaders > 0, "Can't create a program with zero shaders");
-			bool anyFailed = false;
-			for (int j = 0; j < step.create_program.num_shaders; j++) {
-				_dbg_assert_msg_(step.create_program.shaders[j]->shader, "Can't create a program with a null shader");
-				anyFailed = anyFailed || step.create_program.shaders[j]->failed;
-				glAttachShader(program->program, step.create_program.shaders[j]->shader);
-			}
 
-			for (auto iter : program->semantics_) {
-				glBindAttribLocation(program->program, iter.location, iter.attrib);
-			}
+			if (!LoadProgramBinary(program)) {
+				bool anyFailed = false;
+				for (int j = 0; j < step.create_program.num_shaders; j++) {
+					// Shaders are compiled on first use, so a program loaded from a binary never compiles them.
+					if (!step.create_program.shaders[j]->shader)
+						CompileShader(step.create_program.shaders[j]);
+					_dbg_assert_msg_(step.create_program.shaders[j]->shader, "Can't create a program with a null shader");
+					anyFailed = anyFailed || step.create_program.shaders[j]->failed;
+					glAttachShader(program->program, step.create_program.shaders[j]->shader);
+				}
+
+				for (auto iter : program->semantics_) {
+					glBindAttribLocation(program->program, iter.location, iter.attrib);
+				}
 
 #if !defined(USING_GLES2)
-			if (step.create_program.support_dual_source) {
-				// Dual source alpha
-				glBindFragDataLocationIndexed(program->program, 0, 0, "fragColor0");
-				glBindFragDataLocationIndexed(program->program, 0, 1, "fragColor1");
-			} else if (gl_extensions.VersionGEThan(3, 0, 0)) {
-				glBindFragDataLocation(program->program, 0, "fragColor0");
-			}
+				if (step.create_program.support_dual_source) {
+					// Dual source alpha
+					glBindFragDataLocationIndexed(program->program, 0, 0, "fragColor0");
+					glBindFragDataLocationIndexed(program->program, 0, 1, "fragColor1");
+				} else if (gl_extensions.VersionGEThan(3, 0, 0)) {
+					glBindFragDataLocation(program->program, 0, "fragColor0");
+				}
 #elif !PPSSPP_PLATFORM(IOS)
-			if (gl_extensions.GLES3 && step.create_program.support_dual_source) {
-				glBindFragDataLocationIndexedEXT(program->program, 0, 0, "fragColor0");
-				glBindFragDataLocationIndexedEXT(program->program, 0, 1, "fragColor1");
-			}
+				if (gl_extensions.GLES3 && step.create_program.support_dual_source) {
+					glBindFragDataLocationIndexedEXT(program->program, 0, 0, "fragColor0");
+					glBindFragDataLocationIndexedEXT(program->program, 0, 1, "fragColor1");
+				}
 #endif
-			glLinkProgram(program->program);
-
-			GLint linkStatus = GL_FALSE;
-			glGetProgramiv(program->program, GL_LINK_STATUS, &linkStatus);
-			if (linkStatus != GL_TRUE) {
-				std::string infoLog = GetInfoLog(program->program, glGetProgramiv, glGetProgramInfoLog);
-
-				// TODO: Could be other than vs/fs.  Also, we're assuming order here...
-				GLRShader *vs = step.create_program.shaders[0];
-				GLRShader *fs = step.create_program.num_shaders > 1 ? step.create_program.shaders[1] : nullptr;
-				std::string vsDesc = vs->desc + (vs->failed ? " (failed)" : "");
-				std::string fsDesc = fs ? (fs->desc + (fs->failed ? " (failed)" : "")) : "(none)";
-				const char *vsCode = vs->code.c_str();
-				const char *fsCode = fs ? fs->code.c_str() : "(none)";
-				if (!anyFailed)
-					Reporting::ReportMessage("Error in shader program link: info: %s\nfs: %s\n%s\nvs: %s\n%s", infoLog.c_str(), fsDesc.c_str(), fsCode, vsDesc.c_str(), vsCode);
-
-				ERROR_LOG(G3D, "Could not link program:\n %s", infoLog.c_str());
-				ERROR_LOG(G3D, "VS desc:\n%s", vsDesc.c_str());
-				ERROR_LOG(G3D, "FS desc:\n%s", fsDesc.c_str());
-				ERROR_LOG(G3D, "VS:\n%s\n", vsCode);
-				ERROR_LOG(G3D, "FS:\n%s\n", fsCode);
+				if (program->retrieveBinary_ && supportsProgramBinary_)
+					glProgramParameteri(program->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+				glLinkProgram(program->program);
+
+				GLint linkStatus = GL_FALSE;
+				glGetProgramiv(program->program, GL_LINK_STATUS, &linkStatus);
+				if (linkStatus != GL_TRUE) {
+					std::string infoLog = GetInfoLog(program->program, glGetProgramiv, glGetProgramInfoLog);
+
+					// TODO: Could be other than vs/fs.  Also, we're assuming order here...
+					GLRShader *vs = step.create_program.shaders[0];
+					GLRShader *fs = step.create_program.num_shaders > 1 ? step.create_program.shaders[1] : nullptr;
+					std::string vsDesc = vs->desc + (vs->failed ? " (failed)" : "");
+					std::string fsDesc = fs ? (fs->desc + (fs->failed ? " (failed)" : "")) : "(none)";
+					const char *vsCode = vs->code.c_str();
+					const char *fsCode = fs ? fs->code.c_str() : "(none)";
+					if (!anyFailed)
+						Reporting::ReportMessage("Error in shader program link: info: %s\nfs: %s\n%s\nvs: %s\n%s", infoLog.c_str(), fsDesc.c_str(), fsCode, vsDesc.c_str(), vsCode);
+
+					ERROR_LOG(G3D, "Could not link program:\n %s", infoLog.c_str());
+					ERROR_LOG(G3D, "VS desc:\n%s", vsDesc.c_str());
+					ERROR_LOG(G3D, "FS desc:\n%s", fsDesc.c_str());
+					ERROR_LOG(G3D, "VS:\n%s\n", vsCode);
+					ERROR_LOG(G3D, "FS:\n%s\n", fsCode);
 
 #ifdef _WIN32
-				OutputDebugStringUTF8(infoLog.c_str());
-				if (vsCode)
-					OutputDebugStringUTF8(LineNumberString(vsCode).c_str());
-				if (fsCode)
-					OutputDebugStringUTF8(LineNumberString(fsCode).c_str());
+					OutputDebugStringUTF8(infoLog.c_str());
+					if (vsCode)
+						OutputDebugStringUTF8(LineNumberString(vsCode).c_str());
+					if (fsCode)
+						OutputDebugStringUTF8(LineNumberString(fsCode).c_str());
 #endif
-				CHECK_GL_ERROR_IF_DEBUG();
-				break;
+					CHECK_GL_ERROR_IF_DEBUG();
+					break;
+				}
+
+				if (program->retrieveBinary_ && supportsProgramBinary_)
+					RetrieveProgramBinary(program);
 			}
 
 			glUseProgram(program->program);
@@ -275,44 +297,12 @@ void GLQueueRunner::RunInitSteps(const std::vector<GLRInitStep> &steps, bool ski
 		}
 		case GLRInitStepType::CREATE_SHADER:
 		{
-			CHECK_GL_ERROR_IF_DEBUG();
-			GLuint shader = glCreateShader(step.create_shader.stage);
-			step.create_shader.shader->shader = shader;
-			const char *code = step.create_shader.code;
-			glShaderSource(shader, 1, &code, nullptr);
-			glCompileShader(shader);
-			GLint success = 0;
-			glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-			std::string infoLog = GetInfoLog(shader, glGetShaderiv, glGetShaderInfoLog);
-			if (!success) {
-				std::string errorString = StringFromFormat(
-					"Error in shader compilation for: %s\n"
-					"Info log: %s\n"
-					"Shader source:\n%s\n//END\n\n",
-					step.create_shader.shader->desc.c_str(),
-					infoLog.c_str(),
-					LineNumberString(code).c_str());
-				std::vector<std::string> lines;
-				SplitString(errorString, '\n', lines);
-				for (auto &line : lines) {
-					ERROR_LOG(G3D, "%s", line.c_str());
-				}
-				if (errorCallback_) {
-					std::string desc = StringFromFormat("Shader compilation failed: %s", step.create_shader.stage == GL_VERTEX_SHADER ? "vertex" : "fragment");
-					errorCallback_(desc.c_str(), errorString.c_str(), errorCallbackUserData_);
-				}
-				Reporting::ReportMessage("Error in shader compilation: info: %s\n%s\n%s", infoLog.c_str(), step.create_shader.shader->desc.c_str(), (const char *)code);
-#ifdef SHADERLOG
-				OutputDebugStringUTF8(infoLog.c_str());
-#endif
-				step.create_shader.shader->failed = true;
-				step.create_shader.shader->error = infoLog;  // Hm, we never use this.
-			}
-			// Before we throw away the code, attach it to the shader for debugging.
-			step.create_shader.shader->code = code;
+			// Compiled by the first CREATE_PROGRAM that links from source, see CompileShader().
+			GLRShader *shader = step.create_shader.shader;
+			shader->stage = step.create_shader.stage;
+			shader->code = step.create_shader.code;
 			delete[] step.create_shader.code;
-			step.create_shader.shader->valid = true;
-			CHECK_GL_ERROR_IF_DEBUG();
+			shader->valid = true;
 			break;
 		}
 		case GLRInitStepType::CREATE_INPUT_LAYOUT:
@@ -418,6 +408,82 @@ void GLQueueRunner::RunInitSteps(const std::vector<GLRInitStep> &steps, bool ski
 #endif
 }
 
+void GLQueueRunner::CompileShader(GLRShader *shader) {
+	CHECK_GL_ERROR_IF_DEBUG();
+	shader->shader = glCreateShader(shader->stage);
+	const char *code = shader->code.c_str();
+	glShaderSource(shader->shader, 1, &code, nullptr);
+	glCompileShader(shader->shader);
+	GLint success = 0;
+	glGetShaderiv(shader->shader, GL_COMPILE_STATUS, &success);
+	std::string infoLog = GetInfoLog(shader->shader, glGetShaderiv, glGetShaderInfoLog);
+	if (!success) {
+		std::string errorString = StringFromFormat(
+			"Error in shader compilation for: %s\n"
+			"Info log: %s\n"
+			"Shader source:\n%s\n//END\n\n",
+			shader->desc.c_str(),
+			infoLog.c_str(),
+			LineNumberString(code).c_str());
+		std::vector<std::string> lines;
+		SplitString(errorString, '\n', lines);
+		for (auto &line : lines) {
+			ERROR_LOG(G3D, "%s", line.c_str());
+		}
+		if (errorCallback_) {
+			std::string desc = StringFromFormat("Shader compilation failed: %s", shader->stage == GL_VERTEX_SHADER ? "vertex" : "fragment");
+			errorCallback_(desc.c_str(), errorString.c_str(), errorCallbackUserData_);
+		}
+		Reporting::ReportMessage("Error in shader compilation: info: %s\n%s\n%s", infoLog.c_str(), shader->desc.c_str(), code);
+#ifdef SHADERLOG
+		OutputDebugStringUTF8(infoLog.c_str());
+#endif
+		shader->failed = true;
+		shader->error = infoLog;  // Hm, we never use this.
+	}
+	CHECK_GL_ERROR_IF_DEBUG();
+}
+
+bool GLQueueRunner::LoadProgramBinary(GLRProgram *program) {
+	std::lock_guard<std::mutex> guard(program->binaryLock_);
+	GLRProgramBinary &binary = program->binary_;
+	if (!supportsProgramBinary_ || binary.data.empty())
+		return false;
+
+	glProgramBinary(program->program, binary.format, binary.data.data(), (GLsizei)binary.data.size());
+	GLint linkStatus = GL_FALSE;
+	glGetProgramiv(program->program, GL_LINK_STATUS, &linkStatus);
+	if (linkStatus != GL_TRUE) {
+		// Drivers may reject binaries from older versions of themselves.  Just link from source.
+		// An unknown format is reported as an error, which we don't want to trip the debug checks.
+		while (glGetError() != GL_NO_ERROR)
+			continue;
+		WARN_LOG(G3D, "Program binary rejected by the driver, compiling from source");
+		binary.data.clear();
+		return false;
+	}
+	return true;
+}
+
+void GLQueueRunner::RetrieveProgramBinary(GLRProgram *program) {
+	GLint length = 0;
+	glGetProgramiv(program->program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	GLRProgramBinary binary;
+	binary.data.resize(length);
+	GLsizei written = 0;
+	GLenum format = 0;
+	glGetProgramBinary(program->program, length, &written, &format, binary.data.data());
+	binary.data.resize(written);
+	binary.format = format;
+	CHECK_GL_ERROR_IF_DEBUG();
+
+	std::lock_guard<std::mutex> guard(program->binaryLock_);
+	program->binary_ = std::move(binary);
+}
+
 void GLQueueRunner::InitCreateFramebuffer(const GLRInitStep &step) {
 	GLRFramebuffer *fbo = step.create_framebuffer.framebuffer;
 
@@ -588,7 +654,7 @@ void GLQueueRunner::InitCreateFramebuffer(const GLRInitStep &step) {
 	currentReadHandle_ = fbo->handle;
 }
 
-void GLQueueRunner::RunSteps(const std::vector<GLRStep *> &steps, bool skipGLCalls) {
+void GLQueueRunner::RunSteps(const std::vector<GLRStep *> &steps, bool skipGLCalls, GLQueueProfileContext *profile) {
 	if (skipGLCalls) {
 		// Dry run
 		for (size_t i = 0; i < steps.size(); i++) {
@@ -671,6 +737,7 @@ void GLQueueRunner::RunSteps(const std::vector<GLRStep *> &steps, bool skipGLCal
 	}*/
 
 	CHECK_GL_ERROR_IF_DEBUG();
+	double cpuStartTime = profile ? time_now_d() : 0.0;
 	size_t renderCount = 0;
 	for (size_t i = 0; i < steps.size(); i++) {
 		const GLRStep &step = *steps[i];
@@ -709,11 +776,126 @@ void GLQueueRunner::RunSteps(const std::vector<GLRStep *> &steps, bool skipGLCal
 			glPopDebugGroup();
 #endif
 
+		if (profile && step.stepType != GLRStepType::RENDER_SKIP)
+			WriteTimestamp(profile, StepToString(step));
+
 		delete steps[i];
 	}
+	if (profile)
+		profile->cpuTime += time_now_d() - cpuStartTime;
 	CHECK_GL_ERROR_IF_DEBUG();
 }
 
+// Per query object, so we don't need to keep reallocating.
+static const int MAX_TIMESTAMP_QUERIES = 128;
+
+// Desktop has ARB_timer_query (core in 3.3), GLES needs EXT_disjoint_timer_query which we only load on Android.
+bool GLQueueRunner::TimestampQueriesSupported() {
+#if defined(USING_GLES2) && defined(__ANDROID__)
+	return gl_extensions.EXT_disjoint_timer_query;
+#elif !defined(USING_GLES2)
+	return gl_extensions.ARB_timer_query;
+#else
+	return false;
+#endif
+}
+
+void GLQueueRunner::WriteTimestamp(GLQueueProfileContext *profile, const std::string &description) {
+	size_t index = profile->timestampDescriptions.size();
+	if (index >= MAX_TIMESTAMP_QUERIES)
+		return;
+
+#if defined(USING_GLES2) && defined(__ANDROID__)
+	if (profile->queries.empty()) {
+		profile->queries.resize(MAX_TIMESTAMP_QUERIES);
+		glGenQueriesEXT(MAX_TIMESTAMP_QUERIES, profile->queries.data());
+	}
+	glQueryCounterEXT(profile->queries[index], GL_TIMESTAMP_EXT);
+#elif !defined(USING_GLES2)
+	if (profile->queries.empty()) {
+		profile->queries.resize(MAX_TIMESTAMP_QUERIES);
+		glGenQueries(MAX_TIMESTAMP_QUERIES, profile->queries.data());
+	}
+	glQueryCounter(profile->queries[index], GL_TIMESTAMP);
+#else
+	return;
+#endif
+	profile->timestampDescriptions.push_back(description);
+}
+
+bool GLQueueRunner::ReadTimestamps(GLQueueProfileContext *profile, std::vector<uint64_t> *results) {
+	size_t count = profile->timestampDescriptions.size();
+	if (count == 0 || profile->queries.empty())
+		return false;
+
+	results->resize(count);
+#if defined(USING_GLES2) && defined(__ANDROID__)
+	GLuint available = 0;
+	glGetQueryObjectuivEXT(profile->queries[count - 1], GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+	// Also resets the flag, so we check it even if we'll drop the results anyway.
+	GLint disjoint = 0;
+	glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+	if (!available || disjoint)
+		return false;
+	for (size_t i = 0; i < count; i++) {
+		GLuint64 value = 0;
+		glGetQueryObjectui64vEXT(profile->queries[i], GL_QUERY_RESULT_EXT, &value);
+		(*results)[i] = value;
+	}
+	return true;
+#elif !defined(USING_GLES2)
+	GLuint available = 0;
+	glGetQueryObjectuiv(profile->queries[count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return false;
+	for (size_t i = 0; i < count; i++) {
+		GLuint64 value = 0;
+		glGetQueryObjectui64v(profile->queries[i], GL_QUERY_RESULT, &value);
+		(*results)[i] = value;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+void GLQueueRunner::DestroyTimestampQueries(GLQueueProfileContext *profile) {
+	if (!profile->queries.empty()) {
+#if defined(USING_GLES2) && defined(__ANDROID__)
+		glDeleteQueriesEXT((GLsizei)profile->queries.size(), profile->queries.data());
+#elif !defined(USING_GLES2)
+		glDeleteQueries((GLsizei)profile->queries.size(), profile->queries.data());
+#endif
+	}
+	profile->queries.clear();
+	profile->timestampDescriptions.clear();
+}
+
+std::string GLQueueRunner::StepToString(const GLRStep &step) const {
+	char buffer[256];
+	switch (step.stepType) {
+	case GLRStepType::RENDER:
+		snprintf(buffer, sizeof(buffer), "RENDER %s (draws: %d, fb: %p)", step.tag, step.render.numDraws, step.render.framebuffer);
+		break;
+	case GLRStepType::COPY:
+		snprintf(buffer, sizeof(buffer), "COPY '%s'", step.tag);
+		break;
+	case GLRStepType::BLIT:
+		snprintf(buffer, sizeof(buffer), "BLIT '%s'", step.tag);
+		break;
+	case GLRStepType::READBACK:
+		snprintf(buffer, sizeof(buffer), "READBACK '%s'", step.tag);
+		break;
+	case GLRStepType::READBACK_IMAGE:
+		snprintf(buffer, sizeof(buffer), "READBACK_IMAGE '%s'", step.tag);
+		break;
+	default:
+		buffer[0] = 0;
+		break;
+	}
+	return std::string(buffer);
+}
+
 void GLQueueRunner::LogSteps(const std::vector<GLRStep *> &steps) {
 
 }
@@ -1126,7 +1308,7 @@ void GLQueueRunner::PerformRenderPass(const GLRStep &step, bool first, bool last
 			}
 			int enable = layout->semanticsMask_ & ~attrMask;
 			int disable = (~layout->semanticsMask_) & attrMask;
-			for (int i = 0; i < 7; i++) {  // SEM_MAX
+			for (int i = 0; i < 16; i++) {  // The minimum GL_MAX_VERTEX_ATTRIBS we rely on.
 				if (enable & (1 << i)) {
 					glEnableVertexAttribArray(i);
 				}
@@ -1306,7 +1488,7 @@ void GLQueueRunner::PerformRenderPass(const GLRStep &step, bool first, bool last
 		}
 	}
 
-	for (int i = 0; i < 7; i++) {
+	for (int i = 0; i < 16; i++) {
 		if (attrMask & (1 << i)) {
 			glDisableVertexAttribArray(i);
 		}
@@ -1467,21 +1649,25 @@ void GLQueueRunner::PerformReadback(const GLRStep &pass) {
 		tempBuffer_ = new uint8_t[tempSize];
 		tempBufferSize_ = tempSize;
 	}
-	if (readbackSize > readbackBufferSize_) {
-		delete[] readbackBuffer_;
-		readbackBuffer_ = new uint8_t[readbackSize];
-		readbackBufferSize_ = readbackSize;
+	uint8_t *readbackBuffer = pass.readback.delayed;
+	if (!readbackBuffer) {
+		if (readbackSize > readbackBufferSize_) {
+			delete[] readbackBuffer_;
+			readbackBuffer_ = new uint8_t[readbackSize];
+			readbackBufferSize_ = readbackSize;
+		}
+		readbackBuffer = readbackBuffer_;
 	}
 
-	glReadPixels(rect.x, rect.y, rect.w, rect.h, format, type, convert ? tempBuffer_ : readbackBuffer_);
+	glReadPixels(rect.x, rect.y, rect.w, rect.h, format, type, convert ? tempBuffer_ : readbackBuffer);
 	#ifdef DEBUG_READ_PIXELS
 	LogReadPixelsError(glGetError());
 	#endif
 	if (!gl_extensions.IsGLES || gl_extensions.GLES3) {
 		glPixelStorei(GL_PACK_ROW_LENGTH, 0);
 	}
-	if (convert && tempBuffer_ && readbackBuffer_) {
-		ConvertFromRGBA8888(readbackBuffer_, tempBuffer_, pixelStride, pixelStride, rect.w, rect.h, pass.readback.dstFormat);
+	if (convert && tempBuffer_ && readbackBuffer) {
+		ConvertFromRGBA8888(readbackBuffer, tempBuffer_, pixelStride, pixelStride, rect.w, rect.h, pass.readback.dstFormat);
 	}
 	CHECK_GL_ERROR_IF_DEBUG();
 }
@@ -1559,17 +1745,19 @@ void GLQueueRunner::PerformBindFramebufferAsRenderTarget(const GLRStep &pass) {
 	CHECK_GL_ERROR_IF_DEBUG();
 }
 
-void GLQueueRunner::CopyReadbackBuffer(int width, int height, Draw::DataFormat srcFormat, Draw::DataFormat destFormat, int pixelStride, uint8_t *pixels) {
+void GLQueueRunner::CopyReadbackBuffer(const uint8_t *readback, int width, int height, Draw::DataFormat srcFormat, Draw::DataFormat destFormat, int pixelStride, uint8_t *pixels) {
 	// TODO: Maybe move data format conversion here, and always read back 8888. Drivers
 	// don't usually provide very optimized conversion implementations, though some do.
 	// Just need to be careful about dithering, which may break Danganronpa.
 	int bpp = (int)Draw::DataFormatSizeInBytes(destFormat);
-	if (!readbackBuffer_ || bpp <= 0 || !pixels) {
+	if (!readback)
+		readback = readbackBuffer_;
+	if (!readback || bpp <= 0 || !pixels) {
 		// Something went wrong during the read and no readback buffer was allocated, probably.
 		return;
 	}
 	for (int y = 0; y < height; y++) {
-		memcpy(pixels + y * pixelStride * bpp, readbackBuffer_ + y * width * bpp, width * bpp);
+		memcpy(pixels + y * pixelStride * bpp, readback + y * width * bpp, width * bpp);
 	}
 }
 
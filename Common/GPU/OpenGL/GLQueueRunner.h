@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <string>
 #include <vector>
 #include <unordered_map>
 
@@ -331,6 +333,8 @@ struct GLRStep {
 			GLRFramebuffer *src;
 			GLRect2D srcRect;
 			Draw::DataFormat dstFormat;
+			// If set, read into this (w * h pixels of dstFormat) instead of the sync readback buffer.
+			uint8_t *delayed;
 		} readback;
 		struct {
 			GLRTexture *texture;
@@ -340,6 +344,13 @@ struct GLRStep {
 	};
 };
 
+// Timestamps written between steps for GPU profiling. Only touched on the render thread.
+struct GLQueueProfileContext {
+	std::vector<GLuint> queries;  // Created on first use.
+	std::vector<std::string> timestampDescriptions;
+	double cpuTime = 0.0;
+};
+
 class GLQueueRunner {
 public:
 	GLQueueRunner() {}
@@ -351,9 +362,15 @@ class GLQueueRunner {
 
 	void RunInitSteps(const std::vector<GLRInitStep> &steps, bool skipGLCalls);
 
-	void RunSteps(const std::vector<GLRStep *> &steps, bool skipGLCalls);
+	void RunSteps(const std::vector<GLRStep *> &steps, bool skipGLCalls, GLQueueProfileContext *profile = nullptr);
 	void LogSteps(const std::vector<GLRStep *> &steps);
 
+	static bool TimestampQueriesSupported();
+	void WriteTimestamp(GLQueueProfileContext *profile, const std::string &description);
+	// Returns false if the GPU hasn't finished yet, or the results can't be trusted.
+	bool ReadTimestamps(GLQueueProfileContext *profile, std::vector<uint64_t> *results);
+	void DestroyTimestampQueries(GLQueueProfileContext *profile);
+
 	void CreateDeviceObjects();
 	void DestroyDeviceObjects();
 
@@ -361,7 +378,8 @@ class GLQueueRunner {
 		return (int)depth * 3 + (int)color;
 	}
 
-	void CopyReadbackBuffer(int width, int height, Draw::DataFormat srcFormat, Draw::DataFormat destFormat, int pixelStride, uint8_t *pixels);
+	// Pass nullptr as readback for the sync readback buffer.
+	void CopyReadbackBuffer(const uint8_t *readback, int width, int height, Draw::DataFormat srcFormat, Draw::DataFormat destFormat, int pixelStride, uint8_t *pixels);
 
 	void Resize(int width, int height) {
 		targetWidth_ = width;
@@ -377,8 +395,17 @@ class GLQueueRunner {
 		return it != glStrings_.end() ? it->second : "";
 	}
 
+	bool SupportsProgramBinary() const {
+		return supportsProgramBinary_;
+	}
+
 private:
 	void InitCreateFramebuffer(const GLRInitStep &step);
+	void CompileShader(GLRShader *shader);
+	bool LoadProgramBinary(GLRProgram *program);
+	void RetrieveProgramBinary(GLRProgram *program);
+
+	std::string StepToString(const GLRStep &step) const;
 
 	void PerformBindFramebufferAsRenderTarget(const GLRStep &pass);
 	void PerformRenderPass(const GLRStep &pass, bool first, bool last);
@@ -409,8 +436,8 @@ class GLQueueRunner {
 	int targetWidth_ = 0;
 	int targetHeight_ = 0;
 
-	// Readback buffer. Currently we only support synchronous readback, so we only really need one.
-	// We size it generously.
+	// Readback buffer for synchronous readbacks, so we only really need one. Delayed readbacks
+	// bring their own (see GLRStep::readback.delayed).
 	uint8_t *readbackBuffer_ = nullptr;
 	int readbackBufferSize_ = 0;
 	// Temp buffer for color conversion
@@ -431,6 +458,7 @@ class GLQueueRunner {
 
 	bool sawOutOfMemory_ = false;
 	bool useDebugGroups_ = false;
+	std::atomic<bool> supportsProgramBinary_{};
 
 	ErrorCallbackFn errorCallback_ = nullptr;
 	void *errorCallbackUserData_ = nullptr;
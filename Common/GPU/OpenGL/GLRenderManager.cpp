@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "ppsspp_config.h"
 #include "GLRenderManager.h"
 #include "Common/GPU/OpenGL/GLFeatures.h"
@@ -5,6 +7,8 @@
 #include "Common/Thread/ThreadUtil.h"
 
 #include "Common/Log.h"
+#include "Common/Profiler/FrameTimeline.h"
+#include "Common/Profiler/MemoryUsage.h"
 #include "Common/MemoryUtil.h"
 #include "Common/Math/math_util.h"
 
@@ -119,6 +123,10 @@ GLRenderManager::~GLRenderManager() {
 	for (int i = 0; i < MAX_INFLIGHT_FRAMES; i++) {
 		_assert_(frameData_[i].deleter.IsEmpty());
 		_assert_(frameData_[i].deleter_prev.IsEmpty());
+		for (DelayedReadback *readback : frameData_[i].readbacks) {
+			delete readback;
+		}
+		frameData_[i].readbacks.clear();
 	}
 	// Was anything deleted during shutdown?
 	deleter_.Perform(this, skipGLCalls_);
@@ -147,7 +155,11 @@ void GLRenderManager::ThreadStart(Draw::DrawContext *draw) {
 	// Notes on buffer mapping:
 	// NVIDIA GTX 9xx / 2017-10 drivers - mapping improves speed, basic unmap seems best.
 	// PowerVR GX6xxx / iOS 10.3 - mapping has little improvement, explicit flush is slower.
-	if (mapBuffers) {
+	// Persistent mapping skips the per-frame map/unmap entirely. Desktop only for now, since
+	// mappings on Android can disappear on task switch (see below.)
+	if (hasBufferStorage && !gl_extensions.IsGLES) {
+		bufferStrategy_ = GLBufferStrategy::PERSISTENT;
+	} else if (mapBuffers) {
 		switch (gl_extensions.gpuVendor) {
 		case GPU_VENDOR_NVIDIA:
 			bufferStrategy_ = GLBufferStrategy::FRAME_UNMAP;
@@ -180,6 +192,14 @@ void GLRenderManager::ThreadEnd() {
 
 	// Good point to run all the deleters to get rid of leftover objects.
 	for (int i = 0; i < MAX_INFLIGHT_FRAMES; i++) {
+		if (frameData_[i].fence) {
+			if (!skipGLCalls_)
+				glDeleteSync(frameData_[i].fence);
+			frameData_[i].fence = nullptr;
+			frameData_[i].readyForFence = true;
+		}
+		if (!skipGLCalls_)
+			queueRunner_.DestroyTimestampQueries(&frameData_[i].profile);
 		// Since we're in shutdown, we should skip the GL calls on Android.
 		frameData_[i].deleter.Perform(this, skipGLCalls_);
 		frameData_[i].deleter_prev.Perform(this, skipGLCalls_);
@@ -285,10 +305,14 @@ void GLRenderManager::StopThread() {
 			frameData.steps.clear();
 			frameData.initSteps.clear();
 
-			while (!frameData.readyForFence) {
+			while (!frameData.readyForFence && !frameData.fence) {
 				VLOG("PUSH: Waiting for frame[%d].readyForFence = 1 (stop)", i);
 				frameData.push_condVar.wait(lock);
 			}
+			if (frameData.fence) {
+				// The render thread won't get to check it.  By the time we restart, the GPU is long done.
+				frameData.readyForFence = true;
+			}
 		}
 	} else {
 		INFO_LOG(G3D, "GL submission thread was already paused.");
@@ -397,19 +421,24 @@ void GLRenderManager::BlitFramebuffer(GLRFramebuffer *src, GLRect2D srcRect, GLR
 	steps_.push_back(step);
 }
 
-bool GLRenderManager::CopyFramebufferToMemorySync(GLRFramebuffer *src, int aspectBits, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag) {
-	_assert_(pixels);
-
+void GLRenderManager::PushReadbackStep(GLRFramebuffer *src, int aspectBits, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *delayed, const char *tag) {
 	GLRStep *step = new GLRStep{ GLRStepType::READBACK };
 	step->readback.src = src;
 	step->readback.srcRect = { x, y, w, h };
 	step->readback.aspectMask = aspectBits;
 	step->readback.dstFormat = destFormat;
+	step->readback.delayed = delayed;
 	step->dependencies.insert(src);
 	step->tag = tag;
 	steps_.push_back(step);
 
 	curRenderStep_ = nullptr;
+}
+
+bool GLRenderManager::CopyFramebufferToMemorySync(GLRFramebuffer *src, int aspectBits, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag) {
+	_assert_(pixels);
+
+	PushReadbackStep(src, aspectBits, x, y, w, h, destFormat, nullptr, tag);
 	FlushSync();
 
 	Draw::DataFormat srcFormat;
@@ -424,10 +453,47 @@ bool GLRenderManager::CopyFramebufferToMemorySync(GLRFramebuffer *src, int aspec
 	} else {
 		return false;
 	}
-	queueRunner_.CopyReadbackBuffer(w, h, srcFormat, destFormat, pixelStride, pixels);
+	queueRunner_.CopyReadbackBuffer(nullptr, w, h, srcFormat, destFormat, pixelStride, pixels);
 	return true;
 }
 
+bool GLRenderManager::CopyFramebufferToMemoryAsync(GLRFramebuffer *src, int aspectBits, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag) {
+	_assert_(pixels);
+	// The backbuffer is only read for screenshots, those should see the current frame.
+	if (!src || (aspectBits & (GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT | GL_DEPTH_BUFFER_BIT)) == 0) {
+		return false;
+	}
+
+	FrameData &frameData = frameData_[GetCurFrame()];
+	DelayedReadback *readback = nullptr;
+	for (DelayedReadback *candidate : frameData.readbacks) {
+		if (candidate->src == src && candidate->aspectBits == aspectBits && candidate->x == x && candidate->y == y && candidate->w == w && candidate->h == h && candidate->destFormat == destFormat) {
+			readback = candidate;
+			break;
+		}
+	}
+
+	bool copied = false;
+	if (!readback) {
+		readback = new DelayedReadback{ src, aspectBits, x, y, w, h, destFormat };
+		// The depth readback is always read as floats, so size for at least 4 bytes per pixel.
+		readback->data.resize(std::max(4, (int)Draw::DataFormatSizeInBytes(destFormat)) * w * h);
+		frameData.readbacks.push_back(readback);
+	} else if (readback->used) {
+		// Asked for twice this frame, the data is already stale. Let the caller sync.
+		return false;
+	} else if (readback->hasData) {
+		// Same conversion as the sync path, the render thread already converted to destFormat.
+		queueRunner_.CopyReadbackBuffer(readback->data.data(), w, h, Draw::DataFormat::R8G8B8A8_UNORM, destFormat, pixelStride, pixels);
+		copied = true;
+	}
+
+	readback->used = true;
+	readback->hasData = false;
+	PushReadbackStep(src, aspectBits, x, y, w, h, destFormat, readback->data.data(), tag);
+	return copied;
+}
+
 void GLRenderManager::CopyImageToMemorySync(GLRTexture *texture, int mipLevel, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag) {
 	_assert_(texture);
 	_assert_(pixels);
@@ -441,10 +507,10 @@ void GLRenderManager::CopyImageToMemorySync(GLRTexture *texture, int mipLevel, i
 	curRenderStep_ = nullptr;
 	FlushSync();
 
-	queueRunner_.CopyReadbackBuffer(w, h, Draw::DataFormat::R8G8B8A8_UNORM, destFormat, pixelStride, pixels);
+	queueRunner_.CopyReadbackBuffer(nullptr, w, h, Draw::DataFormat::R8G8B8A8_UNORM, destFormat, pixelStride, pixels);
 }
 
-void GLRenderManager::BeginFrame() {
+void GLRenderManager::BeginFrame(bool enableProfiling) {
 	VLOG("BeginFrame");
 
 #ifdef _DEBUG
@@ -467,6 +533,23 @@ void GLRenderManager::BeginFrame() {
 
 	VLOG("PUSH: Fencing %d", curFrame);
 
+	// Can't set this until after the fence.
+	frameData.profilingEnabled = enableProfiling;
+
+	// Async readbacks nobody asked for again the last time around are dropped, everything else now has data.
+	for (size_t i = 0; i < frameData.readbacks.size(); ) {
+		DelayedReadback *readback = frameData.readbacks[i];
+		if (!readback->used) {
+			delete readback;
+			frameData.readbacks[i] = frameData.readbacks.back();
+			frameData.readbacks.pop_back();
+			continue;
+		}
+		readback->hasData = true;
+		readback->used = false;
+		i++;
+	}
+
 	// glFenceSync(&frameData.fence...)
 
 	// Must be after the fence - this performs deletes.
@@ -512,9 +595,42 @@ void GLRenderManager::BeginSubmitFrame(int frame) {
 	FrameData &frameData = frameData_[frame];
 	if (!frameData.hasBegun) {
 		frameData.hasBegun = true;
+		if (!skipGLCalls_)
+			UpdateProfile(frame);
 	}
 }
 
+// Render thread
+void GLRenderManager::UpdateProfile(int frame) {
+	FrameData &frameData = frameData_[frame];
+	GLQueueProfileContext &profile = frameData.profile;
+
+	// Pull the results from the last time this frame was used, if the GPU is done with them.
+	std::vector<uint64_t> results;
+	if (profile.timestampDescriptions.size() >= 2 && queueRunner_.ReadTimestamps(&profile, &results)) {
+		Draw::GPUFrameTimings timings;
+		// GL timestamps are always in nanoseconds.
+		timings.totalMs = (double)(results.back() - results[0]) * (1.0 / 1000000.0);
+		timings.cpuMs = profile.cpuTime * 1000.0;
+		timings.passes.resize(results.size() - 1);
+		for (size_t i = 0; i < results.size() - 1; i++) {
+			timings.passes[i].name = profile.timestampDescriptions[i + 1];
+			timings.passes[i].ms = (double)(results[i + 1] - results[i]) * (1.0 / 1000000.0);
+		}
+
+		std::lock_guard<std::mutex> guard(profileMutex_);
+		lastGpuTimings_ = std::move(timings);
+	} else if (!frameData.profilingEnabled) {
+		std::lock_guard<std::mutex> guard(profileMutex_);
+		lastGpuTimings_ = Draw::GPUFrameTimings();
+	}
+
+	profile.timestampDescriptions.clear();
+	profile.cpuTime = 0.0;
+	if (frameData.profilingEnabled)
+		queueRunner_.WriteTimestamp(&profile, "Begin");
+}
+
 // Render thread
 void GLRenderManager::Submit(int frame, bool triggerFence) {
 	FrameData &frameData = frameData_[frame];
@@ -523,6 +639,23 @@ void GLRenderManager::Submit(int frame, bool triggerFence) {
 
 	// When !triggerFence, we notify after syncing with Vulkan.
 
+	if (triggerFence && bufferStrategy_ == GLBufferStrategy::PERSISTENT && !skipGLCalls_) {
+		// The emu thread writes straight into this frame's buffers once it's released, so we can only
+		// release it after the GPU is done.  Meanwhile, release the older frames, which should be done by now.
+		{
+			std::unique_lock<std::mutex> lock(frameData.push_mutex);
+			_assert_(frameData.readyForSubmit);
+			frameData.readyForSubmit = false;
+		}
+		WaitForFrameFences(frame);
+		frameData.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		if (inflightFrames_ <= 1) {
+			// Nothing to overlap with.
+			WaitForFrameFences(-1);
+		}
+		return;
+	}
+
 	if (triggerFence) {
 		VLOG("PULL: Frame %d.readyForFence = true", frame);
 
@@ -534,12 +667,32 @@ void GLRenderManager::Submit(int frame, bool triggerFence) {
 	}
 }
 
+// Render thread
+void GLRenderManager::WaitForFrameFences(int exceptFrame) {
+	for (int i = 0; i < MAX_INFLIGHT_FRAMES; i++) {
+		FrameData &frameData = frameData_[i];
+		if (i == exceptFrame || !frameData.fence)
+			continue;
+
+		// Should almost always already be signaled, since it's from an earlier frame.
+		glClientWaitSync(frameData.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ULL);
+		glDeleteSync(frameData.fence);
+
+		VLOG("PULL: Frame %d.readyForFence = true (fenced)", i);
+		std::unique_lock<std::mutex> lock(frameData.push_mutex);
+		frameData.fence = nullptr;
+		frameData.readyForFence = true;
+		frameData.push_condVar.notify_all();
+	}
+}
+
 // Render thread
 void GLRenderManager::EndSubmitFrame(int frame) {
 	FrameData &frameData = frameData_[frame];
 	frameData.hasBegun = false;
 
 	Submit(frame, true);
+	FrameTimeline_End(FrameTimelineLane::RENDER);
 
 	if (!frameData.skipSwap) {
 		if (swapIntervalChanged_) {
@@ -549,7 +702,9 @@ void GLRenderManager::EndSubmitFrame(int frame) {
 			}
 		}
 		if (swapFunction_) {
+			FrameTimeline_Begin(FrameTimelineLane::PRESENT);
 			swapFunction_();
+			FrameTimeline_End(FrameTimelineLane::PRESENT);
 		}
 	} else {
 		frameData.skipSwap = false;
@@ -558,6 +713,7 @@ void GLRenderManager::EndSubmitFrame(int frame) {
 
 // Render thread
 void GLRenderManager::Run(int frame) {
+	FrameTimeline_Begin(FrameTimelineLane::RENDER);
 	BeginSubmitFrame(frame);
 
 	FrameData &frameData = frameData_[frame];
@@ -566,6 +722,8 @@ void GLRenderManager::Run(int frame) {
 	auto &initStepsOnThread = frameData_[frame].initSteps;
 	// queueRunner_.LogSteps(stepsOnThread);
 	queueRunner_.RunInitSteps(initStepsOnThread, skipGLCalls_);
+	if (frameData.profilingEnabled && !skipGLCalls_ && !initStepsOnThread.empty())
+		queueRunner_.WriteTimestamp(&frameData.profile, "Init steps");
 	initStepsOnThread.clear();
 
 	// Run this after RunInitSteps so any fresh GLRBuffers for the pushbuffers can get created.
@@ -576,7 +734,7 @@ void GLRenderManager::Run(int frame) {
 		}
 	}
 
-	queueRunner_.RunSteps(stepsOnThread, skipGLCalls_);
+	queueRunner_.RunSteps(stepsOnThread, skipGLCalls_, frameData.profilingEnabled ? &frameData.profile : nullptr);
 	stepsOnThread.clear();
 
 	if (!skipGLCalls_) {
@@ -597,6 +755,8 @@ void GLRenderManager::Run(int frame) {
 	default:
 		_assert_(false);
 	}
+	// Already ended before the swap for END frames, so this only covers syncs.
+	FrameTimeline_End(FrameTimelineLane::RENDER);
 
 	VLOG("PULL: Finished running frame %d", frame);
 }
@@ -658,6 +818,10 @@ void GLRenderManager::Wipe() {
 		delete step;
 	}
 	steps_.clear();
+	// Wiped readback steps won't fill anything, don't let them count as results.
+	for (DelayedReadback *readback : frameData_[GetCurFrame()].readbacks) {
+		readback->used = false;
+	}
 }
 
 void GLRenderManager::WaitUntilQueueIdle() {
@@ -749,6 +913,8 @@ bool GLPushBuffer::AddBuffer() {
 	if (!info.localMemory)
 		return false;
 	info.buffer = render_->CreateBuffer(target_, size_, GL_DYNAMIC_DRAW);
+	info.size = size_;
+	MemoryUsage_Add(MemoryCategory::PUSH_BUFFERS, info.size);
 	buf_ = buffers_.size();
 	buffers_.push_back(info);
 	return true;
@@ -767,6 +933,7 @@ void GLPushBuffer::Destroy(bool onRenderThread) {
 		}
 
 		FreeAlignedMemory(info.localMemory);
+		MemoryUsage_Add(MemoryCategory::PUSH_BUFFERS, -(int64_t)info.size);
 	}
 	buffers_.clear();
 	buf_ = -1;
@@ -865,6 +1032,10 @@ void GLPushBuffer::MapDevice(GLBufferStrategy strategy) {
 void GLPushBuffer::UnmapDevice() {
 	_dbg_assert_msg_(OnRenderThread(), "UnmapDevice must run on render thread");
 
+	// Stays mapped, frames are fenced instead.
+	if (strategy_ == GLBufferStrategy::PERSISTENT)
+		return;
+
 	for (auto &info : buffers_) {
 		if (info.deviceMemory) {
 			// TODO: Technically this can return false?
@@ -884,6 +1055,11 @@ void *GLRBuffer::Map(GLBufferStrategy strategy) {
 	if ((strategy & GLBufferStrategy::MASK_INVALIDATE) != 0) {
 		access |= GL_MAP_INVALIDATE_BUFFER_BIT;
 	}
+#ifdef GL_MAP_PERSISTENT_BIT
+	if ((strategy & GLBufferStrategy::MASK_PERSISTENT) != 0) {
+		access |= GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	}
+#endif
 
 	void *p = nullptr;
 	bool allowNativeBuffer = strategy != GLBufferStrategy::SUBDATA;
@@ -12,15 +12,12 @@
 #include "Common/GPU/OpenGL/GLCommon.h"
 #include "Common/Data/Convert/SmallDataConvert.h"
 #include "Common/Log.h"
+#include "Common/GPU/thin3d.h"
 #include "GLQueueRunner.h"
 
 class GLRInputLayout;
 class GLPushBuffer;
 
-namespace Draw {
-class DrawContext;
-}
-
 constexpr int MAX_GL_TEXTURE_SLOTS = 8;
 
 class GLRTexture {
@@ -84,6 +81,7 @@ class GLRShader {
 	}
 
 	GLuint shader = 0;
+	GLuint stage = 0;
 	bool valid = false;
 	// Warning: Won't know until a future frame.
 	bool failed = false;
@@ -92,6 +90,12 @@ class GLRShader {
 	std::string error;
 };
 
+// Output of glGetProgramBinary, used for the persistent shader cache.
+struct GLRProgramBinary {
+	uint32_t format = 0;
+	std::vector<uint8_t> data;
+};
+
 class GLRProgram {
 public:
 	~GLRProgram() {
@@ -121,6 +125,12 @@ class GLRProgram {
 	std::vector<Initializer> initialize_;
 	bool use_clip_distance0 = false;
 
+	// If set before linking, we try glProgramBinary before compiling anything.  If retrieveBinary_
+	// is set, it's filled in after a successful link.  The render thread writes it, hence the lock.
+	GLRProgramBinary binary_;
+	bool retrieveBinary_ = false;
+	std::mutex binaryLock_;
+
 	struct UniformInfo {
 		int loc_;
 	};
@@ -148,6 +158,7 @@ enum class GLBufferStrategy {
 
 	MASK_FLUSH = 0x10,
 	MASK_INVALIDATE = 0x20,
+	MASK_PERSISTENT = 0x40,
 
 	// Map/unmap the buffer each frame.
 	FRAME_UNMAP = 1,
@@ -157,6 +168,8 @@ enum class GLBufferStrategy {
 	FLUSH_UNMAP = MASK_FLUSH,
 	// Map/unmap, invalidate on map, and explicit flush.
 	FLUSH_INVALIDATE_UNMAP = MASK_FLUSH | MASK_INVALIDATE,
+	// Map once, persistent and coherent (needs buffer storage.) Frames are fenced instead of unmapped.
+	PERSISTENT = MASK_PERSISTENT,
 };
 
 static inline int operator &(const GLBufferStrategy &lhs, const GLBufferStrategy &rhs) {
@@ -193,8 +206,7 @@ class GLRenderManager;
 // Similar to VulkanPushBuffer but is currently less efficient - it collects all the data in
 // RAM then does a big memcpy/buffer upload at the end of the frame. This is at least a lot
 // faster than the hundreds of buffer uploads or memory array buffers we used before.
-// On modern GL we could avoid the copy using glBufferStorage but not sure it's worth the
-// trouble.
+// With GLBufferStrategy::PERSISTENT (glBufferStorage), writes go straight to mapped memory instead.
 // We need to manage the lifetime of this together with the other resources so its destructor
 // runs on the render thread.
 class GLPushBuffer {
@@ -206,6 +218,7 @@ class GLPushBuffer {
 		uint8_t *localMemory = nullptr;
 		uint8_t *deviceMemory = nullptr;
 		size_t flushOffset = 0;
+		size_t size = 0;
 	};
 
 	GLPushBuffer(GLRenderManager *render, GLuint target, size_t size);
@@ -370,11 +383,19 @@ class GLRenderManager {
 	bool ThreadFrame();  // Returns false to request exiting the loop.
 
 	// Makes sure that the GPU has caught up enough that we can start writing buffers of this frame again.
-	void BeginFrame();
+	void BeginFrame(bool enableProfiling);
 	// Can run on a different thread!
 	void Finish();
 	void Run(int frame);
 
+	bool GetGPUTimings(Draw::GPUFrameTimings *timings) {
+		std::lock_guard<std::mutex> guard(profileMutex_);
+		if (lastGpuTimings_.passes.empty())
+			return false;
+		*timings = lastGpuTimings_;
+		return true;
+	}
+
 	// Zaps queued up commands. Use if you know there's a risk you've queued up stuff that has already been deleted. Can happen during in-game shutdown.
 	void Wipe();
 
@@ -423,10 +444,14 @@ class GLRenderManager {
 	// not be an active render pass.
 	GLRProgram *CreateProgram(
 		std::vector<GLRShader *> shaders, std::vector<GLRProgram::Semantic> semantics, std::vector<GLRProgram::UniformLocQuery> queries,
-		std::vector<GLRProgram::Initializer> initalizers, bool supportDualSource, bool useClipDistance0) {
+		std::vector<GLRProgram::Initializer> initalizers, bool supportDualSource, bool useClipDistance0,
+		const GLRProgramBinary *binary = nullptr, bool retrieveBinary = false) {
 		GLRInitStep step{ GLRInitStepType::CREATE_PROGRAM };
 		_assert_(shaders.size() <= ARRAY_SIZE(step.create_program.shaders));
 		step.create_program.program = new GLRProgram();
+		if (binary)
+			step.create_program.program->binary_ = *binary;
+		step.create_program.program->retrieveBinary_ = retrieveBinary;
 		step.create_program.program->semantics_ = semantics;
 		step.create_program.program->queries_ = queries;
 		step.create_program.program->initialize_ = initalizers;
@@ -516,6 +541,9 @@ class GLRenderManager {
 	void BindFramebufferAsTexture(GLRFramebuffer *fb, int binding, int aspectBit, int attachment);
 
 	bool CopyFramebufferToMemorySync(GLRFramebuffer *src, int aspectBits, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag);
+	// Doesn't wait for the render thread. Writes the result of the same readback issued the last time this frame
+	// slot was used, and queues a new one. Returns false if there was no earlier result, then nothing was written.
+	bool CopyFramebufferToMemoryAsync(GLRFramebuffer *src, int aspectBits, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag);
 	void CopyImageToMemorySync(GLRTexture *texture, int mipLevel, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag);
 
 	void CopyFramebuffer(GLRFramebuffer *src, GLRect2D srcRect, GLRFramebuffer *dst, GLOffset2D dstPos, int aspectMask, const char *tag);
@@ -953,6 +981,20 @@ class GLRenderManager {
 		return queueRunner_.GetGLString(name);
 	}
 
+	// Only valid after the device objects have been created on the render thread.
+	bool SupportsProgramBinary() const {
+		return queueRunner_.SupportsProgramBinary();
+	}
+
+	// Returns false if the program hasn't been linked yet, or has no binary to retrieve.
+	bool GetProgramBinary(GLRProgram *program, GLRProgramBinary *binary) {
+		std::lock_guard<std::mutex> guard(program->binaryLock_);
+		if (program->binary_.data.empty())
+			return false;
+		*binary = program->binary_;
+		return true;
+	}
+
 	// Used during Android-style ugly shutdown. No need to have a way to set it back because we'll be
 	// destroyed.
 	void SetSkipGLCalls() {
@@ -965,15 +1007,34 @@ class GLRenderManager {
 		return renderStepOffset_ + (int)steps_.size();
 	}
 
+	bool IsInRenderPass() const {
+		return curRenderStep_ && curRenderStep_->stepType == GLRStepType::RENDER;
+	}
+
 private:
 	void BeginSubmitFrame(int frame);
 	void EndSubmitFrame(int frame);
+	void UpdateProfile(int frame);
 	void Submit(int frame, bool triggerFence);
+	// Releases every frame with a pending fence except exceptFrame, once its fence signals.
+	void WaitForFrameFences(int exceptFrame);
 
 	// Bad for performance but sometimes necessary for synchronous CPU readbacks (screenshots and whatnot).
 	void FlushSync();
 	void EndSyncFrame(int frame);
 
+	void PushReadbackStep(GLRFramebuffer *src, int aspectBits, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *delayed, const char *tag);
+
+	struct DelayedReadback {
+		GLRFramebuffer *src;
+		int aspectBits;
+		int x, y, w, h;
+		Draw::DataFormat destFormat;
+		std::vector<uint8_t> data;
+		bool hasData;
+		bool used;
+	};
+
 	// When using legacy functionality for push buffers (glBufferData), we need to flush them
 	// before actually making the glDraw* calls. It's best if the render manager handles that.
 	void RegisterPushBuffer(int frame, GLPushBuffer *buffer) {
@@ -994,7 +1055,9 @@ class GLRenderManager {
 		bool skipSwap = false;
 		GLRRunType type = GLRRunType::END;
 
-		// GLuint fence; For future AZDO stuff?
+		// Only with persistent buffers: once signaled, the GPU is done with this frame's push buffers.
+		// Until then, readyForFence stays false.
+		GLsync fence = nullptr;
 		std::vector<GLRStep *> steps;
 		std::vector<GLRInitStep> initSteps;
 
@@ -1005,6 +1068,13 @@ class GLRenderManager {
 		GLDeleter deleter;
 		GLDeleter deleter_prev;
 		std::set<GLPushBuffer *> activePushBuffers;
+
+		// Async readbacks, filled by this frame's steps on the render thread. Only read after readyForFence.
+		std::vector<DelayedReadback *> readbacks;
+
+		// Profiling.
+		GLQueueProfileContext profile;
+		bool profilingEnabled = false;
 	};
 
 	FrameData frameData_[MAX_INFLIGHT_FRAMES];
@@ -1048,6 +1118,10 @@ class GLRenderManager {
 	int targetWidth_ = 0;
 	int targetHeight_ = 0;
 
+	// Written on the render thread when timestamp results come back.
+	std::mutex profileMutex_;
+	Draw::GPUFrameTimings lastGpuTimings_;
+
 #ifdef _DEBUG
 	GLRProgram *curProgram_ = nullptr;
 #endif
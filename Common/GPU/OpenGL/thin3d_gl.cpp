@@ -346,6 +346,7 @@ class OpenGLContext : public DrawContext {
 	ShaderModule *CreateShaderModule(ShaderStage stage, ShaderLanguage language, const uint8_t *data, size_t dataSize, const std::string &tag) override;
 
 	Texture *CreateTexture(const TextureDesc &desc) override;
+	bool UpdateTextureRect(Texture *tex, int x, int y, int w, int h, const uint8_t *data) override;
 	Buffer *CreateBuffer(size_t size, uint32_t usageFlags) override;
 	Framebuffer *CreateFramebuffer(const FramebufferDesc &desc) override;
 
@@ -357,6 +358,7 @@ class OpenGLContext : public DrawContext {
 	void CopyFramebufferImage(Framebuffer *src, int level, int x, int y, int z, Framebuffer *dst, int dstLevel, int dstX, int dstY, int dstZ, int width, int height, int depth, int channelBits, const char *tag) override;
 	bool BlitFramebuffer(Framebuffer *src, int srcX1, int srcY1, int srcX2, int srcY2, Framebuffer *dst, int dstX1, int dstY1, int dstX2, int dstY2, int channelBits, FBBlitFilter filter, const char *tag) override;
 	bool CopyFramebufferToMemorySync(Framebuffer *src, int channelBits, int x, int y, int w, int h, Draw::DataFormat format, void *pixels, int pixelStride, const char *tag) override;
+	bool CopyFramebufferToMemoryAsync(Framebuffer *src, int channelBits, int x, int y, int w, int h, Draw::DataFormat format, void *pixels, int pixelStride, const char *tag) override;
 
 	// These functions should be self explanatory.
 	void BindFramebufferAsRenderTarget(Framebuffer *fbo, const RenderPassInfo &rp, const char *tag) override;
@@ -468,6 +470,10 @@ class OpenGLContext : public DrawContext {
 		return renderManager_.GetCurrentStepId();
 	}
 
+	bool GetGPUTimings(GPUFrameTimings *timings) override {
+		return renderManager_.GetGPUTimings(timings);
+	}
+
 	void InvalidateCachedState() override;
 
 private:
@@ -533,6 +539,7 @@ OpenGLContext::OpenGLContext() {
 	}
 	caps_.framebufferBlitSupported = gl_extensions.NV_framebuffer_blit || gl_extensions.ARB_framebuffer_object;
 	caps_.framebufferDepthBlitSupported = caps_.framebufferBlitSupported;
+	caps_.timestampQueriesSupported = GLQueueRunner::TimestampQueriesSupported();
 	caps_.depthClampSupported = gl_extensions.ARB_depth_clamp;
 	if (gl_extensions.IsGLES) {
 		caps_.clipDistanceSupported = gl_extensions.EXT_clip_cull_distance || gl_extensions.APPLE_clip_distance;
@@ -690,7 +697,7 @@ OpenGLContext::~OpenGLContext() {
 }
 
 void OpenGLContext::BeginFrame() {
-	renderManager_.BeginFrame();
+	renderManager_.BeginFrame(gpuTimingEnabled_ && caps_.timestampQueriesSupported);
 	FrameData &frameData = frameData_[renderManager_.GetCurFrame()];
 	renderManager_.BeginPushBuffer(frameData.push);
 }
@@ -757,6 +764,7 @@ class OpenGLTexture : public Texture {
 	const GLRTexture *GetTex() const {
 		return tex_;
 	}
+	bool UpdateRect(int x, int y, int w, int h, const uint8_t *data);
 
 private:
 	void SetImageData(int x, int y, int z, int width, int height, int depth, int level, int stride, const uint8_t *data, TextureCallback callback);
@@ -811,6 +819,19 @@ OpenGLTexture::~OpenGLTexture() {
 	}
 }
 
+bool OpenGLTexture::UpdateRect(int x, int y, int w, int h, const uint8_t *data) {
+	// A1R5G5B5 is converted on upload, not worth handling here.
+	if (mipLevels_ != 1 || format_ == DataFormat::A1R5G5B5_UNORM_PACK16 || format_ == DataFormat::R5G5B5A1_UNORM_PACK16)
+		return false;
+	size_t size = (size_t)w * h * DataFormatSizeInBytes(format_);
+	uint8_t *texData = new uint8_t[size];
+	memcpy(texData, data, size);
+	// glTexSubImage2D works on the bound texture.
+	render_->BindTexture(0, tex_);
+	render_->TextureSubImage(tex_, 0, x, y, w, h, format_, texData, GLRAllocType::NEW);
+	return true;
+}
+
 class OpenGLFramebuffer : public Framebuffer {
 public:
 	OpenGLFramebuffer(GLRenderManager *render, GLRFramebuffer *framebuffer) : render_(render), framebuffer_(framebuffer) {
@@ -919,11 +940,38 @@ bool OpenGLContext::CopyFramebufferToMemorySync(Framebuffer *src, int channelBit
 	return true;
 }
 
+bool OpenGLContext::CopyFramebufferToMemoryAsync(Framebuffer *src, int channelBits, int x, int y, int w, int h, Draw::DataFormat dataFormat, void *pixels, int pixelStride, const char *tag) {
+	if (gl_extensions.IsGLES && (channelBits & FB_COLOR_BIT) == 0) {
+		// Can't readback depth or stencil on GLES.
+		return false;
+	}
+	OpenGLFramebuffer *fb = (OpenGLFramebuffer *)src;
+	GLuint aspect = 0;
+	if (channelBits & FB_COLOR_BIT)
+		aspect |= GL_COLOR_BUFFER_BIT;
+	if (channelBits & FB_DEPTH_BIT)
+		aspect |= GL_DEPTH_BUFFER_BIT;
+	if (channelBits & FB_STENCIL_BIT)
+		aspect |= GL_STENCIL_BUFFER_BIT;
+	return renderManager_.CopyFramebufferToMemoryAsync(fb ? fb->framebuffer_ : nullptr, aspect, x, y, w, h, dataFormat, (uint8_t *)pixels, pixelStride, tag);
+}
+
 
 Texture *OpenGLContext::CreateTexture(const TextureDesc &desc) {
 	return new OpenGLTexture(&renderManager_, desc);
 }
 
+bool OpenGLContext::UpdateTextureRect(Texture *tex, int x, int y, int w, int h, const uint8_t *data) {
+	// Goes in the command stream, so it's ordered with the draws.
+	if (!renderManager_.IsInRenderPass())
+		return false;
+	OpenGLTexture *glTex = (OpenGLTexture *)tex;
+	if (!glTex->UpdateRect(x, y, w, h, data))
+		return false;
+	boundTextures_[0] = glTex->GetTex();
+	return true;
+}
+
 DepthStencilState *OpenGLContext::CreateDepthStencilState(const DepthStencilStateDesc &desc) {
 	OpenGLDepthStencilState *ds = new OpenGLDepthStencilState();
 	ds->depthTestEnabled = desc.depthTestEnabled;
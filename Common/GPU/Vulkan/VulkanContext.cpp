@@ -8,6 +8,7 @@
 #include "Common/System/System.h"
 #include "Common/System/Display.h"
 #include "Common/Log.h"
+#include "Common/Profiler/MemoryUsage.h"
 #include "Common/GPU/Vulkan/VulkanContext.h"
 #include "Common/GPU/Vulkan/VulkanDebug.h"
 #include "GPU/Common/ShaderCommon.h"
@@ -294,12 +295,35 @@ void VulkanContext::BeginFrame(VkCommandBuffer firstCommandBuffer) {
 	FrameData *frame = &frame_[curFrame_];
 	// Process pending deletes.
 	frame->deleteList.PerformDeletes(device_, allocator_);
+
+	VmaBudget budgets[VK_MAX_MEMORY_HEAPS]{};
+	vmaGetBudget(allocator_, budgets);
+	int64_t allocated = 0;
+	for (uint32_t i = 0; i < memory_properties.memoryHeapCount; ++i)
+		allocated += budgets[i].allocationBytes;
+	MemoryUsage_Set(MemoryCategory::VULKAN_ALLOCATIONS, allocated);
 	// VK_NULL_HANDLE when profiler is disabled.
 	if (firstCommandBuffer) {
 		frame->profiler.BeginFrame(this, firstCommandBuffer);
 	}
 }
 
+VkDeviceSize VulkanContext::GetDeviceLocalMemoryAvailable() const {
+	if (!allocator_)
+		return 0;
+
+	VmaBudget budgets[VK_MAX_MEMORY_HEAPS]{};
+	vmaGetBudget(allocator_, budgets);
+	VkDeviceSize available = 0;
+	for (uint32_t i = 0; i < memory_properties.memoryHeapCount; ++i) {
+		if ((memory_properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) == 0)
+			continue;
+		if (budgets[i].budget > budgets[i].usage)
+			available += budgets[i].budget - budgets[i].usage;
+	}
+	return available;
+}
+
 void VulkanContext::EndFrame() {
 	frame_[curFrame_].deleteList.Take(globalDeleteList_);
 	curFrame_++;
@@ -602,6 +626,19 @@ void VulkanContext::ChooseDevice(int physical_device) {
 
 	GetDeviceLayerExtensionList(nullptr, device_extension_properties_);
 
+	deviceFeatures_.presentId = false;
+	deviceFeatures_.presentWait = false;
+	if (extensionsLookup_.KHR_get_physical_device_properties2 && IsDeviceExtensionAvailable(VK_KHR_PRESENT_ID_EXTENSION_NAME) && IsDeviceExtensionAvailable(VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+		VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR };
+		VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR };
+		presentIdFeatures.pNext = &presentWaitFeatures;
+		VkPhysicalDeviceFeatures2 features2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR };
+		features2.pNext = &presentIdFeatures;
+		vkGetPhysicalDeviceFeatures2KHR(physical_devices_[physical_device_], &features2);
+		deviceFeatures_.presentId = presentIdFeatures.presentId != VK_FALSE;
+		deviceFeatures_.presentWait = presentWaitFeatures.presentWait != VK_FALSE;
+	}
+
 	device_extensions_enabled_.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 }
 
@@ -655,6 +692,14 @@ VkResult VulkanContext::CreateDevice() {
 	}
 	extensionsLookup_.EXT_shader_stencil_export = EnableDeviceExtension(VK_EXT_SHADER_STENCIL_EXPORT_EXTENSION_NAME);
 
+	// Used for the low latency present mode. Both or neither.
+	VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR };
+	VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR };
+	if (deviceFeatures_.presentId && deviceFeatures_.presentWait) {
+		extensionsLookup_.KHR_present_id = EnableDeviceExtension(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+		extensionsLookup_.KHR_present_wait = extensionsLookup_.KHR_present_id && EnableDeviceExtension(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+	}
+
 	VkDeviceCreateInfo device_info{ VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
 	device_info.queueCreateInfoCount = 1;
 	device_info.pQueueCreateInfos = &queue_info;
@@ -663,6 +708,12 @@ VkResult VulkanContext::CreateDevice() {
 	device_info.enabledExtensionCount = (uint32_t)device_extensions_enabled_.size();
 	device_info.ppEnabledExtensionNames = device_info.enabledExtensionCount ? device_extensions_enabled_.data() : nullptr;
 	device_info.pEnabledFeatures = &deviceFeatures_.enabled;
+	if (extensionsLookup_.KHR_present_wait) {
+		presentIdFeatures.presentId = VK_TRUE;
+		presentIdFeatures.pNext = &presentWaitFeatures;
+		presentWaitFeatures.presentWait = VK_TRUE;
+		device_info.pNext = &presentIdFeatures;
+	}
 
 	VkResult res = vkCreateDevice(physical_devices_[physical_device_], &device_info, nullptr, &device_);
 	if (res != VK_SUCCESS) {
@@ -104,11 +104,11 @@ class VulkanDeleteList {
 	void QueueDeleteCommandPool(VkCommandPool &pool) { _dbg_assert_(pool != VK_NULL_HANDLE); cmdPools_.push_back(pool); pool = VK_NULL_HANDLE; }
 	void QueueDeleteDescriptorPool(VkDescriptorPool &pool) { _dbg_assert_(pool != VK_NULL_HANDLE); descPools_.push_back(pool); pool = VK_NULL_HANDLE; }
 	void QueueDeleteShaderModule(VkShaderModule &module) { _dbg_assert_(module != VK_NULL_HANDLE); modules_.push_back(module); module = VK_NULL_HANDLE; }
-	void QueueDeleteBuffer(VkBuffer &buffer) { _dbg_assert_(buffer != VK_NULL_HANDLE); buffers_.push_back(buffer); buffer = VK_NULL_HANDLE; }
+	void QueueDeleteBuffer(VkBuffer &buffer) { _dbg_assert_(buffer != VK_NULL_HANDLE); buffers_.push_back(buffer); buffer = VK_NULL_HANDLE; descriptorDeletes_++; }
 	void QueueDeleteBufferView(VkBufferView &bufferView) { _dbg_assert_(bufferView != VK_NULL_HANDLE); bufferViews_.push_back(bufferView); bufferView = VK_NULL_HANDLE; }
-	void QueueDeleteImageView(VkImageView &imageView) { _dbg_assert_(imageView != VK_NULL_HANDLE); imageViews_.push_back(imageView); imageView = VK_NULL_HANDLE; }
+	void QueueDeleteImageView(VkImageView &imageView) { _dbg_assert_(imageView != VK_NULL_HANDLE); imageViews_.push_back(imageView); imageView = VK_NULL_HANDLE; descriptorDeletes_++; }
 	void QueueDeleteDeviceMemory(VkDeviceMemory &deviceMemory) { _dbg_assert_(deviceMemory != VK_NULL_HANDLE); deviceMemory_.push_back(deviceMemory); deviceMemory = VK_NULL_HANDLE; }
-	void QueueDeleteSampler(VkSampler &sampler) { _dbg_assert_(sampler != VK_NULL_HANDLE); samplers_.push_back(sampler); sampler = VK_NULL_HANDLE; }
+	void QueueDeleteSampler(VkSampler &sampler) { _dbg_assert_(sampler != VK_NULL_HANDLE); samplers_.push_back(sampler); sampler = VK_NULL_HANDLE; descriptorDeletes_++; }
 	void QueueDeletePipeline(VkPipeline &pipeline) { _dbg_assert_(pipeline != VK_NULL_HANDLE); pipelines_.push_back(pipeline); pipeline = VK_NULL_HANDLE; }
 	void QueueDeletePipelineCache(VkPipelineCache &pipelineCache) { _dbg_assert_(pipelineCache != VK_NULL_HANDLE); pipelineCaches_.push_back(pipelineCache); pipelineCache = VK_NULL_HANDLE; }
 	void QueueDeleteRenderPass(VkRenderPass &renderPass) { _dbg_assert_(renderPass != VK_NULL_HANDLE); renderPasses_.push_back(renderPass); renderPass = VK_NULL_HANDLE; }
@@ -122,6 +122,7 @@ class VulkanDeleteList {
 		buffersWithAllocs_.push_back(BufferWithAlloc{ buffer, alloc });
 		buffer = VK_NULL_HANDLE;
 		alloc = VK_NULL_HANDLE;
+		descriptorDeletes_++;
 	}
 	void QueueDeleteImageAllocation(VkImage &image, VmaAllocation &alloc) {
 		_dbg_assert_(image != VK_NULL_HANDLE && alloc != VK_NULL_HANDLE);
@@ -133,6 +134,11 @@ class VulkanDeleteList {
 	void Take(VulkanDeleteList &del);
 	void PerformDeletes(VkDevice device, VmaAllocator allocator);
 
+	// Counts queued deletes of objects that descriptor sets can point to (buffers, image views, samplers).
+	// Once deleted, a handle can be reused by a new object, so descriptor sets cached across frames
+	// must be dropped whenever this changes.
+	uint32_t DescriptorDeletes() const { return descriptorDeletes_; }
+
 private:
 	std::vector<VkCommandPool> cmdPools_;
 	std::vector<VkDescriptorPool> descPools_;
@@ -151,6 +157,7 @@ class VulkanDeleteList {
 	std::vector<VkPipelineLayout> pipelineLayouts_;
 	std::vector<VkDescriptorSetLayout> descSetLayouts_;
 	std::vector<Callback> callbacks_;
+	uint32_t descriptorDeletes_ = 0;
 };
 
 // VulkanContext manages the device and swapchain, and deferred deletion of objects.
@@ -275,6 +282,9 @@ class VulkanContext {
 	struct PhysicalDeviceFeatures {
 		VkPhysicalDeviceFeatures available{};
 		VkPhysicalDeviceFeatures enabled{};
+		// Extension features, only queried when the extensions are available.
+		bool presentId = false;
+		bool presentWait = false;
 	};
 
 	const PhysicalDeviceFeatures &GetDeviceFeatures() const { return deviceFeatures_; }
@@ -338,6 +348,9 @@ class VulkanContext {
 		return allocator_;
 	}
 
+	// How much more device local memory we can probably allocate, according to VMA's budget.
+	VkDeviceSize GetDeviceLocalMemoryAvailable() const;
+
 private:
 	bool ChooseQueue();
 
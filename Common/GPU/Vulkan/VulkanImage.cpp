@@ -138,6 +138,30 @@ void VulkanTexture::UploadMip(VkCommandBuffer cmd, int mip, int mipWidth, int mi
 	vkCmdCopyBufferToImage(cmd, buffer, image_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy_region);
 }
 
+void VulkanTexture::UpdateRect(VkCommandBuffer cmd, int x, int y, int w, int h, VkBuffer buffer, uint32_t offset) {
+	TransitionImageLayout2(cmd, image_, 0, 1, VK_IMAGE_ASPECT_COLOR_BIT,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+	VkBufferImageCopy copy_region{};
+	copy_region.bufferOffset = offset;
+	copy_region.bufferRowLength = (uint32_t)w;
+	copy_region.imageOffset.x = x;
+	copy_region.imageOffset.y = y;
+	copy_region.imageExtent.width = w;
+	copy_region.imageExtent.height = h;
+	copy_region.imageExtent.depth = 1;
+	copy_region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	copy_region.imageSubresource.layerCount = 1;
+	vkCmdCopyBufferToImage(cmd, buffer, image_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy_region);
+
+	TransitionImageLayout2(cmd, image_, 0, 1, VK_IMAGE_ASPECT_COLOR_BIT,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+}
+
 void VulkanTexture::ClearMip(VkCommandBuffer cmd, int mip, uint32_t value) {
 	// Must be in TRANSFER_DST mode.
 	VkClearColorValue clearVal;
@@ -21,6 +21,7 @@
 #include "Common/Math/math_util.h"
 
 #include "Common/Log.h"
+#include "Common/Profiler/MemoryUsage.h"
 #include "Common/TimeUtil.h"
 #include "Common/GPU/Vulkan/VulkanMemory.h"
 
@@ -59,6 +60,9 @@ bool VulkanPushBuffer::AddBuffer() {
 		return false;
 	}
 
+	info.size = size_;
+	MemoryUsage_Add(MemoryCategory::PUSH_BUFFERS, info.size);
+
 	buffers_.push_back(info);
 	buf_ = buffers_.size() - 1;
 	return true;
@@ -68,6 +72,7 @@ void VulkanPushBuffer::Destroy(VulkanContext *vulkan) {
 	_dbg_assert_(!writePtr_);
 	for (BufInfo &info : buffers_) {
 		vulkan->Delete().QueueDeleteBufferAllocation(info.buffer, info.allocation);
+		MemoryUsage_Add(MemoryCategory::PUSH_BUFFERS, -(int64_t)info.size);
 	}
 	buffers_.clear();
 }
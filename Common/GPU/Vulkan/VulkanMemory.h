@@ -31,6 +31,7 @@ class VulkanPushBuffer {
 	struct BufInfo {
 		VkBuffer buffer;
 		VmaAllocation allocation;
+		size_t size;
 	};
 
 public:
@@ -2,6 +2,7 @@
 
 #include "Common/GPU/DataFormat.h"
 #include "Common/Log.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Common/TimeUtil.h"
 #include "VulkanQueueRunner.h"
 #include "VulkanRenderManager.h"
@@ -48,30 +49,85 @@ void VulkanQueueRunner::CreateDeviceObjects() {
 #endif
 }
 
-void VulkanQueueRunner::ResizeReadbackBuffer(VkDeviceSize requiredSize) {
-	if (readbackBuffer_ && requiredSize <= readbackBufferSize_) {
+void CachedReadback::Destroy(VulkanContext *vulkan) {
+	if (buffer) {
+		vulkan->Delete().QueueDeleteBuffer(buffer);
+	}
+	if (memory) {
+		vulkan->Delete().QueueDeleteDeviceMemory(memory);
+	}
+	buffer = VK_NULL_HANDLE;
+	memory = VK_NULL_HANDLE;
+	bufferSize = 0;
+}
+
+VkCommandBuffer VKRSecondaryPools::Allocate(VulkanContext *vulkan, int pool) {
+	if (!pools[pool]) {
+		VkCommandPoolCreateInfo cmd_pool_info = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+		cmd_pool_info.queueFamilyIndex = vulkan->GetGraphicsQueueFamilyIndex();
+		cmd_pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		VkResult res = vkCreateCommandPool(vulkan->GetDevice(), &cmd_pool_info, nullptr, &pools[pool]);
+		_assert_(res == VK_SUCCESS);
+	}
+
+	if (used[pool] == (int)cmds[pool].size()) {
+		VkCommandBufferAllocateInfo cmd_alloc = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+		cmd_alloc.commandPool = pools[pool];
+		cmd_alloc.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		cmd_alloc.commandBufferCount = 1;
+		VkCommandBuffer cmd = VK_NULL_HANDLE;
+		VkResult res = vkAllocateCommandBuffers(vulkan->GetDevice(), &cmd_alloc, &cmd);
+		_assert_(res == VK_SUCCESS);
+		cmds[pool].push_back(cmd);
+	}
+	return cmds[pool][used[pool]++];
+}
+
+void VKRSecondaryPools::Reset(VulkanContext *vulkan) {
+	for (int i = 0; i < MAX_POOLS; i++) {
+		if (used[i] != 0) {
+			vkResetCommandPool(vulkan->GetDevice(), pools[i], 0);
+			used[i] = 0;
+		}
+	}
+}
+
+void VKRSecondaryPools::Destroy(VulkanContext *vulkan) {
+	for (int i = 0; i < MAX_POOLS; i++) {
+		if (pools[i]) {
+			// Frees the buffers allocated from it, too.
+			vkDestroyCommandPool(vulkan->GetDevice(), pools[i], nullptr);
+			pools[i] = VK_NULL_HANDLE;
+		}
+		cmds[i].clear();
+		used[i] = 0;
+	}
+}
+
+void VulkanQueueRunner::ResizeReadbackBuffer(CachedReadback *readback, VkDeviceSize requiredSize) {
+	if (readback->buffer && requiredSize <= readback->bufferSize) {
 		return;
 	}
-	if (readbackMemory_) {
-		vulkan_->Delete().QueueDeleteDeviceMemory(readbackMemory_);
+	if (readback->memory) {
+		vulkan_->Delete().QueueDeleteDeviceMemory(readback->memory);
 	}
-	if (readbackBuffer_) {
-		vulkan_->Delete().QueueDeleteBuffer(readbackBuffer_);
+	if (readback->buffer) {
+		vulkan_->Delete().QueueDeleteBuffer(readback->buffer);
 	}
 
-	readbackBufferSize_ = requiredSize;
+	readback->bufferSize = requiredSize;
 
 	VkDevice device = vulkan_->GetDevice();
 
 	VkBufferCreateInfo buf{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-	buf.size = readbackBufferSize_;
+	buf.size = readback->bufferSize;
 	buf.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 
-	VkResult res = vkCreateBuffer(device, &buf, nullptr, &readbackBuffer_);
+	VkResult res = vkCreateBuffer(device, &buf, nullptr, &readback->buffer);
 	_assert_(res == VK_SUCCESS);
 
 	VkMemoryRequirements reqs{};
-	vkGetBufferMemoryRequirements(device, readbackBuffer_, &reqs);
+	vkGetBufferMemoryRequirements(device, readback->buffer, &reqs);
 
 	VkMemoryAllocateInfo allocInfo{ VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
 	allocInfo.allocationSize = reqs.size;
@@ -92,28 +148,22 @@ void VulkanQueueRunner::ResizeReadbackBuffer(VkDeviceSize requiredSize) {
 		}
 	}
 	_assert_(successTypeReqs != 0);
-	readbackBufferIsCoherent_ = (successTypeReqs & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+	readback->isCoherent = (successTypeReqs & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
 
-	res = vkAllocateMemory(device, &allocInfo, nullptr, &readbackMemory_);
+	res = vkAllocateMemory(device, &allocInfo, nullptr, &readback->memory);
 	if (res != VK_SUCCESS) {
-		readbackMemory_ = VK_NULL_HANDLE;
-		vkDestroyBuffer(device, readbackBuffer_, nullptr);
-		readbackBuffer_ = VK_NULL_HANDLE;
+		readback->memory = VK_NULL_HANDLE;
+		vkDestroyBuffer(device, readback->buffer, nullptr);
+		readback->buffer = VK_NULL_HANDLE;
 		return;
 	}
 	uint32_t offset = 0;
-	vkBindBufferMemory(device, readbackBuffer_, readbackMemory_, offset);
+	vkBindBufferMemory(device, readback->buffer, readback->memory, offset);
 }
 
 void VulkanQueueRunner::DestroyDeviceObjects() {
 	INFO_LOG(G3D, "VulkanQueueRunner::DestroyDeviceObjects");
-	if (readbackMemory_) {
-		vulkan_->Delete().QueueDeleteDeviceMemory(readbackMemory_);
-	}
-	if (readbackBuffer_) {
-		vulkan_->Delete().QueueDeleteBuffer(readbackBuffer_);
-	}
-	readbackBufferSize_ = 0;
+	syncReadback_.Destroy(vulkan_);
 
 	renderPasses_.Iterate([&](const RPKey &rpkey, VkRenderPass rp) {
 		_assert_(rp != VK_NULL_HANDLE);
@@ -354,10 +404,15 @@ void VulkanQueueRunner::PreprocessSteps(std::vector<VKRStep *> &steps) {
 	}
 }
 
-void VulkanQueueRunner::RunSteps(VkCommandBuffer cmd, std::vector<VKRStep *> &steps, QueueProfileContext *profile) {
+void VulkanQueueRunner::RunSteps(VkCommandBuffer cmd, std::vector<VKRStep *> &steps, QueueProfileContext *profile, VKRSecondaryPools *secondaryPools) {
 	if (profile)
 		profile->cpuStartTime = time_now_d();
 
+	// Indexed like steps, VK_NULL_HANDLE for the ones to record inline below.
+	std::vector<VkCommandBuffer> secondaries;
+	if (parallelRecording_ && secondaryPools)
+		RecordSecondaries(steps, secondaryPools, secondaries);
+
 	bool emitLabels = vulkan_->Extensions().EXT_debug_utils;
 	for (size_t i = 0; i < steps.size(); i++) {
 		const VKRStep &step = *steps[i];
@@ -370,7 +425,7 @@ void VulkanQueueRunner::RunSteps(VkCommandBuffer cmd, std::vector<VKRStep *> &st
 
 		switch (step.stepType) {
 		case VKRStepType::RENDER:
-			PerformRenderPass(step, cmd);
+			PerformRenderPass(step, cmd, secondaries.empty() ? VK_NULL_HANDLE : secondaries[i]);
 			break;
 		case VKRStepType::COPY:
 			PerformCopy(step, cmd);
@@ -408,6 +463,63 @@ void VulkanQueueRunner::RunSteps(VkCommandBuffer cmd, std::vector<VKRStep *> &st
 		profile->cpuEndTime = time_now_d();
 }
 
+// Below this, recording on the render thread is cheaper than the handoff to a worker.
+static const size_t MIN_COMMANDS_FOR_SECONDARY = 64;
+
+void VulkanQueueRunner::RecordSecondaries(const std::vector<VKRStep *> &steps, VKRSecondaryPools *pools, std::vector<VkCommandBuffer> &secondaries) {
+	std::vector<int> candidates;
+	for (size_t i = 0; i < steps.size(); i++) {
+		const VKRStep &step = *steps[i];
+		if (step.stepType == VKRStepType::RENDER && step.commands.size() >= MIN_COMMANDS_FOR_SECONDARY)
+			candidates.push_back((int)i);
+	}
+	// A single big pass has nothing to overlap with, just record it inline.
+	if (candidates.size() < 2)
+		return;
+
+	// Render passes are created on demand, so look them up here rather than on the workers.
+	// Only compatibility matters for secondaries, but the real ones are cached anyway.
+	const int count = (int)candidates.size();
+	std::vector<VkRenderPass> renderPasses(count);
+	for (int i = 0; i < count; i++) {
+		const VKRStep &step = *steps[candidates[i]];
+		if (step.render.framebuffer)
+			renderPasses[i] = GetRenderPass(step.render.color, step.render.depth, step.render.stencil);
+		else
+			renderPasses[i] = GetBackbufferRenderPass();
+	}
+
+	secondaries.resize(steps.size(), VK_NULL_HANDLE);
+
+	// Each chunk claims a pool. ParallelRangeLoop makes at most count / minSize chunks, plus
+	// one for the stragglers, so this keeps us within MAX_POOLS.
+	std::atomic<int> nextPool{};
+	const int minSize = (count + VKRSecondaryPools::MAX_POOLS - 2) / (VKRSecondaryPools::MAX_POOLS - 1);
+	ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+		int pool = nextPool++;
+		_assert_(pool < VKRSecondaryPools::MAX_POOLS);
+		for (int i = lower; i < upper; i++) {
+			const VKRStep &step = *steps[candidates[i]];
+			VkCommandBuffer secondary = pools->Allocate(vulkan_, pool);
+
+			VkCommandBufferInheritanceInfo inherit{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO };
+			inherit.renderPass = renderPasses[i];
+			inherit.subpass = 0;
+			inherit.framebuffer = step.render.framebuffer ? step.render.framebuffer->framebuf : backbuffer_;
+
+			VkCommandBufferBeginInfo begin{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+			begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+			begin.pInheritanceInfo = &inherit;
+			VkResult res = vkBeginCommandBuffer(secondary, &begin);
+			_assert_(res == VK_SUCCESS);
+			RecordRenderCommands(step, secondary);
+			vkEndCommandBuffer(secondary);
+
+			secondaries[candidates[i]] = secondary;
+		}
+	}, 0, count, minSize);
+}
+
 void VulkanQueueRunner::ApplyMGSHack(std::vector<VKRStep *> &steps) {
 	// Really need a sane way to express transforms of steps.
 
@@ -708,6 +820,27 @@ void VulkanQueueRunner::ApplyRenderPassMerge(std::vector<VKRStep *> &steps) {
 		const auto &r = step->render;
 		return r.color == VKRRenderPassAction::CLEAR || r.depth == VKRRenderPassAction::CLEAR || r.stencil == VKRRenderPassAction::CLEAR;
 	};
+	// A load op clear only covers the render area, but a clear command covers the whole framebuffer.
+	// So only full size clears can become a command at the start of the merged pass.
+	auto clearToCommand = [](VKRStep *step) {
+		const auto &r = step->render;
+		const VkRect2D &area = r.renderArea;
+		if (area.offset.x != 0 || area.offset.y != 0 || (int)area.extent.width < r.framebuffer->width || (int)area.extent.height < r.framebuffer->height)
+			return false;
+		VkRenderData data{ VKRRenderCommand::CLEAR };
+		data.clear.clearColor = r.clearColor;
+		data.clear.clearZ = r.clearDepth;
+		data.clear.clearStencil = r.clearStencil;
+		data.clear.clearMask = 0;
+		if (r.color == VKRRenderPassAction::CLEAR)
+			data.clear.clearMask |= VK_IMAGE_ASPECT_COLOR_BIT;
+		if (r.depth == VKRRenderPassAction::CLEAR)
+			data.clear.clearMask |= VK_IMAGE_ASPECT_DEPTH_BIT;
+		if (r.stencil == VKRRenderPassAction::CLEAR)
+			data.clear.clearMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+		step->commands.insert(step->commands.begin(), data);
+		return true;
+	};
 
 	// Now, let's go through the steps. If we find one that is rendered to more than once,
 	// we'll scan forward and slurp up any rendering that can be merged across.
@@ -726,7 +859,9 @@ void VulkanQueueRunner::ApplyRenderPassMerge(std::vector<VKRStep *> &steps) {
 				case VKRStepType::RENDER:
 					if (steps[j]->render.framebuffer == fb) {
 						// Prevent Unknown's example case from https://github.com/hrydgard/ppsspp/pull/12242
-						if (renderHasClear(steps[j]) || steps[j]->dependencies.contains(touchedFramebuffers)) {
+						if (steps[j]->dependencies.contains(touchedFramebuffers)) {
+							goto done_fb;
+						} else if (renderHasClear(steps[j]) && !clearToCommand(steps[j])) {
 							goto done_fb;
 						} else {
 							// Safe to merge, great.
@@ -752,8 +887,10 @@ void VulkanQueueRunner::ApplyRenderPassMerge(std::vector<VKRStep *> &steps) {
 					touchedFramebuffers.insert(steps[j]->blit.dst);
 					break;
 				case VKRStepType::READBACK:
-					// Not sure this has much effect, when executed READBACK is always the last step
-					// since we stall the GPU and wait immediately after.
+					// Delayed readbacks don't end the frame, so later rendering can't be moved in front of one.
+					if (steps[j]->readback.src == fb) {
+						goto done_fb;
+					}
 					break;
 				case VKRStepType::RENDER_SKIP:
 				case VKRStepType::READBACK_IMAGE:
@@ -1089,7 +1226,7 @@ void TransitionFromOptimal(VkCommandBuffer cmd, VkImage colorImage, VkImageLayou
 	}
 }
 
-void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer cmd) {
+void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer cmd, VkCommandBuffer secondary) {
 	// TODO: If there are multiple, we can transition them together.
 
 	for (const auto &iter : step.preTransitions) {
@@ -1234,8 +1371,29 @@ void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer c
 
 	// This reads the layout of the color and depth images, and chooses a render pass using them that
 	// will transition to the desired final layout.
-	PerformBindFramebufferAsRenderTarget(step, cmd);
+	if (secondary) {
+		// The commands were already recorded on a worker thread.
+		PerformBindFramebufferAsRenderTarget(step, cmd, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+		vkCmdExecuteCommands(cmd, 1, &secondary);
+	} else {
+		PerformBindFramebufferAsRenderTarget(step, cmd, VK_SUBPASS_CONTENTS_INLINE);
+		RecordRenderCommands(step, cmd);
+	}
+	vkCmdEndRenderPass(cmd);
 
+	VKRFramebuffer *fb = step.render.framebuffer;
+	if (fb) {
+		// If the desired final layout aren't the optimal layout for rendering, transition.
+		TransitionFromOptimal(cmd, fb->color.image, step.render.finalColorLayout, fb->depth.image, step.render.finalDepthStencilLayout);
+
+		fb->color.layout = step.render.finalColorLayout;
+		fb->depth.layout = step.render.finalDepthStencilLayout;
+	}
+}
+
+// Records the contents of a render pass. Doesn't touch any queue runner state except the
+// pipeline compile notifications, so it's safe to run on worker threads.
+void VulkanQueueRunner::RecordRenderCommands(const VKRStep &step, VkCommandBuffer cmd) {
 	int curWidth = step.render.framebuffer ? step.render.framebuffer->width : vulkan_->GetBackbufferWidth();
 	int curHeight = step.render.framebuffer ? step.render.framebuffer->height : vulkan_->GetBackbufferHeight();
 
@@ -1243,6 +1401,8 @@ void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer c
 
 	VkPipeline lastGraphicsPipeline = VK_NULL_HANDLE;
 	VkPipeline lastComputePipeline = VK_NULL_HANDLE;
+	// Set while the bound graphics pipeline is still compiling and we chose not to wait for it.
+	bool skipDraws = false;
 
 	auto &commands = step.commands;
 
@@ -1263,6 +1423,7 @@ void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer c
 		case VKRRenderCommand::BIND_PIPELINE:
 		{
 			VkPipeline pipeline = c.pipeline.pipeline;
+			skipDraws = false;
 			if (pipeline != lastGraphicsPipeline) {
 				vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 				lastGraphicsPipeline = pipeline;
@@ -1277,14 +1438,22 @@ void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer c
 		case VKRRenderCommand::BIND_GRAPHICS_PIPELINE:
 		{
 			VKRGraphicsPipeline *pipeline = c.graphics_pipeline.pipeline;
-			if (pipeline->Pending()) {
+			skipDraws = false;
+			if (pipeline->Pending() && skipPendingPipelines_) {
+				// Drop the draws until the next pipeline bind, better than a hitch.
+				skipDraws = true;
+				break;
+			} else if (pipeline->Pending()) {
 				// Stall processing, waiting for the compile queue to catch up.
 				std::unique_lock<std::mutex> lock(compileDoneMutex_);
-				while (!pipeline->pipeline) {
+				while (pipeline->Pending()) {
 					compileDone_.wait(lock);
 				}
 			}
-			if (pipeline->pipeline != lastGraphicsPipeline && pipeline->pipeline != VK_NULL_HANDLE) {
+			if (pipeline->pipeline == VK_NULL_HANDLE) {
+				// Failed to create, don't draw with whatever was bound before.
+				skipDraws = true;
+			} else if (pipeline->pipeline != lastGraphicsPipeline) {
 				vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->pipeline);
 				lastGraphicsPipeline = pipeline->pipeline;
 				// Reset dynamic state so it gets refreshed with the new pipeline.
@@ -1375,6 +1544,8 @@ void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer c
 			break;
 
 		case VKRRenderCommand::DRAW_INDEXED:
+			if (skipDraws)
+				break;
 			vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, c.drawIndexed.pipelineLayout, 0, 1, &c.drawIndexed.ds, c.drawIndexed.numUboOffsets, c.drawIndexed.uboOffsets);
 			vkCmdBindIndexBuffer(cmd, c.drawIndexed.ibuffer, c.drawIndexed.ioffset, c.drawIndexed.indexType);
 			vkCmdBindVertexBuffers(cmd, 0, 1, &c.drawIndexed.vbuffer, &c.drawIndexed.voffset);
@@ -1382,6 +1553,8 @@ void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer c
 			break;
 
 		case VKRRenderCommand::DRAW:
+			if (skipDraws)
+				break;
 			vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, c.draw.pipelineLayout, 0, 1, &c.draw.ds, c.draw.numUboOffsets, c.draw.uboOffsets);
 			if (c.draw.vbuffer) {
 				vkCmdBindVertexBuffers(cmd, 0, 1, &c.draw.vbuffer, &c.draw.voffset);
@@ -1427,18 +1600,9 @@ void VulkanQueueRunner::PerformRenderPass(const VKRStep &step, VkCommandBuffer c
 			;
 		}
 	}
-	vkCmdEndRenderPass(cmd);
-
-	if (fb) {
-		// If the desired final layout aren't the optimal layout for rendering, transition.
-		TransitionFromOptimal(cmd, fb->color.image, step.render.finalColorLayout, fb->depth.image, step.render.finalDepthStencilLayout);
-
-		fb->color.layout = step.render.finalColorLayout;
-		fb->depth.layout = step.render.finalDepthStencilLayout;
-	}
 }
 
-void VulkanQueueRunner::PerformBindFramebufferAsRenderTarget(const VKRStep &step, VkCommandBuffer cmd) {
+void VulkanQueueRunner::PerformBindFramebufferAsRenderTarget(const VKRStep &step, VkCommandBuffer cmd, VkSubpassContents contents) {
 	VkRenderPass renderPass;
 	int numClearVals = 0;
 	VkClearValue clearVal[2]{};
@@ -1518,7 +1682,7 @@ void VulkanQueueRunner::PerformBindFramebufferAsRenderTarget(const VKRStep &step
 	rp_begin.renderArea = rc;
 	rp_begin.clearValueCount = numClearVals;
 	rp_begin.pClearValues = numClearVals ? clearVal : nullptr;
-	vkCmdBeginRenderPass(cmd, &rp_begin, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdBeginRenderPass(cmd, &rp_begin, contents);
 }
 
 void VulkanQueueRunner::PerformCopy(const VKRStep &step, VkCommandBuffer cmd) {
@@ -1753,7 +1917,8 @@ void VulkanQueueRunner::SetupTransitionToTransferDst(VKRImage &img, VkImageMemor
 }
 
 void VulkanQueueRunner::PerformReadback(const VKRStep &step, VkCommandBuffer cmd) {
-	ResizeReadbackBuffer(sizeof(uint32_t) * step.readback.srcRect.extent.width * step.readback.srcRect.extent.height);
+	CachedReadback *readback = step.readback.delayed ? step.readback.delayed : &syncReadback_;
+	ResizeReadbackBuffer(readback, sizeof(uint32_t) * step.readback.srcRect.extent.width * step.readback.srcRect.extent.height);
 
 	VkBufferImageCopy region{};
 	region.imageOffset = { step.readback.srcRect.offset.x, step.readback.srcRect.offset.y, 0 };
@@ -1797,7 +1962,7 @@ void VulkanQueueRunner::PerformReadback(const VKRStep &step, VkCommandBuffer cmd
 		copyLayout = srcImage->layout;
 	}
 
-	vkCmdCopyImageToBuffer(cmd, image, copyLayout, readbackBuffer_, 1, &region);
+	vkCmdCopyImageToBuffer(cmd, image, copyLayout, readback->buffer, 1, &region);
 
 	// NOTE: Can't read the buffer using the CPU here - need to sync first.
 
@@ -1824,7 +1989,7 @@ void VulkanQueueRunner::PerformReadbackImage(const VKRStep &step, VkCommandBuffe
 	SetupTransitionToTransferSrc(srcImage, barrier, stage, VK_IMAGE_ASPECT_COLOR_BIT);
 	vkCmdPipelineBarrier(cmd, stage, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 
-	ResizeReadbackBuffer(sizeof(uint32_t) * step.readback_image.srcRect.extent.width * step.readback_image.srcRect.extent.height);
+	ResizeReadbackBuffer(&syncReadback_, sizeof(uint32_t) * step.readback_image.srcRect.extent.width * step.readback_image.srcRect.extent.height);
 
 	VkBufferImageCopy region{};
 	region.imageOffset = { step.readback_image.srcRect.offset.x, step.readback_image.srcRect.offset.y, 0 };
@@ -1835,7 +2000,7 @@ void VulkanQueueRunner::PerformReadbackImage(const VKRStep &step, VkCommandBuffe
 	region.bufferOffset = 0;
 	region.bufferRowLength = step.readback_image.srcRect.extent.width;
 	region.bufferImageHeight = step.readback_image.srcRect.extent.height;
-	vkCmdCopyImageToBuffer(cmd, step.readback_image.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuffer_, 1, &region);
+	vkCmdCopyImageToBuffer(cmd, step.readback_image.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, syncReadback_.buffer, 1, &region);
 
 	// Now transfer it back to a texture.
 	TransitionImageLayout2(cmd, step.readback_image.image, 0, 1,
@@ -1848,18 +2013,20 @@ void VulkanQueueRunner::PerformReadbackImage(const VKRStep &step, VkCommandBuffe
 	// Doing that will also act like a heavyweight barrier ensuring that device writes are visible on the host.
 }
 
-void VulkanQueueRunner::CopyReadbackBuffer(int width, int height, Draw::DataFormat srcFormat, Draw::DataFormat destFormat, int pixelStride, uint8_t *pixels) {
-	if (!readbackMemory_)
-		return;  // Something has gone really wrong.
+bool VulkanQueueRunner::CopyReadbackBuffer(CachedReadback *readback, int width, int height, Draw::DataFormat srcFormat, Draw::DataFormat destFormat, int pixelStride, uint8_t *pixels) {
+	if (!readback)
+		readback = &syncReadback_;
+	if (!readback->memory)
+		return false;  // Something has gone really wrong.
 
 	// Read back to the requested address in ram from buffer.
 	void *mappedData;
 	const size_t srcPixelSize = DataFormatSizeInBytes(srcFormat);
 
-	VkResult res = vkMapMemory(vulkan_->GetDevice(), readbackMemory_, 0, width * height * srcPixelSize, 0, &mappedData);
-	if (!readbackBufferIsCoherent_) {
+	VkResult res = vkMapMemory(vulkan_->GetDevice(), readback->memory, 0, width * height * srcPixelSize, 0, &mappedData);
+	if (!readback->isCoherent) {
 		VkMappedMemoryRange range{};
-		range.memory = readbackMemory_;
+		range.memory = readback->memory;
 		range.offset = 0;
 		range.size = width * height * srcPixelSize;
 		vkInvalidateMappedMemoryRanges(vulkan_->GetDevice(), 1, &range);
@@ -1867,7 +2034,7 @@ void VulkanQueueRunner::CopyReadbackBuffer(int width, int height, Draw::DataForm
 
 	if (res != VK_SUCCESS) {
 		ERROR_LOG(G3D, "CopyReadbackBuffer: vkMapMemory failed! result=%d", (int)res);
-		return;
+		return false;
 	}
 
 	// TODO: Perform these conversions in a compute shader on the GPU.
@@ -1891,5 +2058,5 @@ void VulkanQueueRunner::CopyReadbackBuffer(int width, int height, Draw::DataForm
 		ERROR_LOG(G3D, "CopyReadbackBuffer: Unknown format");
 		_assert_msg_(false, "CopyReadbackBuffer: Unknown src format %d", (int)srcFormat);
 	}
-	vkUnmapMemory(vulkan_->GetDevice(), readbackMemory_);
+	vkUnmapMemory(vulkan_->GetDevice(), readback->memory);	return true;
 }
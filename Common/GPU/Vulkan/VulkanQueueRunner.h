@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <mutex>
 #include <condition_variable>
@@ -16,6 +17,33 @@ struct VKRGraphicsPipeline;
 struct VKRComputePipeline;
 struct VKRImage;
 
+// Host visible buffer a readback step copies into. The queue runner owns one for synchronous
+// readbacks, the render manager keeps more around for delayed (async) ones.
+struct CachedReadback {
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDeviceSize bufferSize = 0;
+	bool isCoherent = false;
+
+	void Destroy(VulkanContext *vulkan);
+};
+
+// Command pools for render passes recorded on worker threads, one set per inflight frame.
+// Each worker records from its own pool. They're reset along with the frame's main pool.
+struct VKRSecondaryPools {
+	enum { MAX_POOLS = 8 };
+
+	// Only call from the thread currently owning the pool. Creates the pool on first use.
+	VkCommandBuffer Allocate(VulkanContext *vulkan, int pool);
+	void Reset(VulkanContext *vulkan);
+	void Destroy(VulkanContext *vulkan);
+
+	VkCommandPool pools[MAX_POOLS]{};
+	// Buffers survive pool resets, so they're reused frame to frame.
+	std::vector<VkCommandBuffer> cmds[MAX_POOLS];
+	int used[MAX_POOLS]{};
+};
+
 enum {
 	QUEUE_HACK_MGS2_ACID = 1,
 	QUEUE_HACK_SONIC = 2,
@@ -135,7 +163,6 @@ struct TransitionRequest {
 struct QueueProfileContext {
 	VkQueryPool queryPool;
 	std::vector<std::string> timestampDescriptions;
-	std::string profileSummary;
 	double cpuStartTime;
 	double cpuEndTime;
 };
@@ -185,6 +212,8 @@ struct VKRStep {
 			int aspectMask;
 			VKRFramebuffer *src;
 			VkRect2D srcRect;
+			// If set, copy into this buffer instead of the sync readback buffer. Read after the frame's fence.
+			CachedReadback *delayed;
 		} readback;
 		struct {
 			VkImage image;
@@ -203,7 +232,7 @@ class VulkanQueueRunner {
 	}
 
 	void PreprocessSteps(std::vector<VKRStep *> &steps);
-	void RunSteps(VkCommandBuffer cmd, std::vector<VKRStep *> &steps, QueueProfileContext *profile);
+	void RunSteps(VkCommandBuffer cmd, std::vector<VKRStep *> &steps, QueueProfileContext *profile, VKRSecondaryPools *secondaryPools);
 	void LogSteps(const std::vector<VKRStep *> &steps, bool verbose);
 
 	std::string StepToString(const VKRStep &step) const;
@@ -225,7 +254,8 @@ class VulkanQueueRunner {
 		return (int)depth * 3 + (int)color;
 	}
 
-	void CopyReadbackBuffer(int width, int height, Draw::DataFormat srcFormat, Draw::DataFormat destFormat, int pixelStride, uint8_t *pixels);
+	// Pass nullptr for the sync readback buffer.
+	bool CopyReadbackBuffer(CachedReadback *readback, int width, int height, Draw::DataFormat srcFormat, Draw::DataFormat destFormat, int pixelStride, uint8_t *pixels);
 
 	struct RPKey {
 		VKRRenderPassAction colorLoadAction;
@@ -258,9 +288,22 @@ class VulkanQueueRunner {
 	}
 
 	void NotifyCompileDone() {
+		// Take the lock so a waiter between its check and wait() can't miss this.
+		std::lock_guard<std::mutex> guard(compileDoneMutex_);
 		compileDone_.notify_all();
 	}
 
+	// When set, draws using a graphics pipeline that is still compiling are dropped instead of
+	// stalling the render thread until the compile finishes.
+	void SetSkipPendingPipelines(bool skip) {
+		skipPendingPipelines_ = skip;
+	}
+
+	// When set, big render passes get recorded into secondary command buffers on worker threads.
+	void SetParallelRecording(bool parallel) {
+		parallelRecording_ = parallel;
+	}
+
 	void WaitForCompileNotification() {
 		std::unique_lock<std::mutex> lock(compileDoneMutex_);
 		compileDone_.wait(lock);
@@ -269,8 +312,11 @@ class VulkanQueueRunner {
 private:
 	void InitBackbufferRenderPass();
 
-	void PerformBindFramebufferAsRenderTarget(const VKRStep &pass, VkCommandBuffer cmd);
-	void PerformRenderPass(const VKRStep &pass, VkCommandBuffer cmd);
+	void RecordSecondaries(const std::vector<VKRStep *> &steps, VKRSecondaryPools *pools, std::vector<VkCommandBuffer> &secondaries);
+
+	void PerformBindFramebufferAsRenderTarget(const VKRStep &pass, VkCommandBuffer cmd, VkSubpassContents contents);
+	void PerformRenderPass(const VKRStep &pass, VkCommandBuffer cmd, VkCommandBuffer secondary);
+	void RecordRenderCommands(const VKRStep &pass, VkCommandBuffer cmd);
 	void PerformCopy(const VKRStep &pass, VkCommandBuffer cmd);
 	void PerformBlit(const VKRStep &pass, VkCommandBuffer cmd);
 	void PerformReadback(const VKRStep &pass, VkCommandBuffer cmd);
@@ -282,7 +328,7 @@ class VulkanQueueRunner {
 	void LogReadback(const VKRStep &pass);
 	void LogReadbackImage(const VKRStep &pass);
 
-	void ResizeReadbackBuffer(VkDeviceSize requiredSize);
+	void ResizeReadbackBuffer(CachedReadback *readback, VkDeviceSize requiredSize);
 
 	void ApplyMGSHack(std::vector<VKRStep *> &steps);
 	void ApplySonicHack(std::vector<VKRStep *> &steps);
@@ -305,12 +351,9 @@ class VulkanQueueRunner {
 	// TODO: Create these on demand.
 	DenseHashMap<RPKey, VkRenderPass, (VkRenderPass)VK_NULL_HANDLE> renderPasses_;
 
-	// Readback buffer. Currently we only support synchronous readback, so we only really need one.
-	// We size it generously.
-	VkDeviceMemory readbackMemory_ = VK_NULL_HANDLE;
-	VkBuffer readbackBuffer_ = VK_NULL_HANDLE;
-	VkDeviceSize readbackBufferSize_ = 0;
-	bool readbackBufferIsCoherent_ = false;
+	// Readback buffer for synchronous readbacks, so we only really need one. Delayed readbacks
+	// bring their own (see VKRStep::readback.delayed).
+	CachedReadback syncReadback_;
 
 	// TODO: Enable based on compat.ini.
 	uint32_t hacksEnabled_ = 0;
@@ -318,4 +361,6 @@ class VulkanQueueRunner {
 	// Compile done notifications.
 	std::mutex compileDoneMutex_;
 	std::condition_variable compileDone_;
+	std::atomic<bool> skipPendingPipelines_{};
+	bool parallelRecording_ = false;
 };
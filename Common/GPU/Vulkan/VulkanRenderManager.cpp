@@ -4,12 +4,15 @@
 #include <sstream>
 
 #include "Common/Log.h"
+#include "Common/Profiler/FrameTimeline.h"
 #include "Common/StringUtils.h"
+#include "Common/TimeUtil.h"
 
 #include "Common/GPU/Vulkan/VulkanAlloc.h"
 #include "Common/GPU/Vulkan/VulkanContext.h"
 #include "Common/GPU/Vulkan/VulkanRenderManager.h"
 
+#include "Common/Thread/ParallelLoop.h"
 #include "Common/Thread/ThreadUtil.h"
 
 #if 0 // def _DEBUG
@@ -24,13 +27,22 @@
 
 using namespace PPSSPP_VK;
 
-bool VKRGraphicsPipeline::Create(VulkanContext *vulkan) {
+bool VKRGraphicsPipeline::Create(VulkanContext *vulkan, bool optimizeLater) {
 	if (!desc) {
 		// Already failed to create this one.
 		return false;
 	}
+	if (desc->prepare && !desc->prepare(desc)) {
+		pipeline = VK_NULL_HANDLE;
+		delete desc;
+		desc = nullptr;
+		return false;
+	}
+	if (optimizeLater)
+		desc->pipe.flags |= VK_PIPELINE_CREATE_DISABLE_OPTIMIZATION_BIT;
 	VkPipeline vkpipeline;
 	VkResult result = vkCreateGraphicsPipelines(vulkan->GetDevice(), desc->pipelineCache, 1, &desc->pipe, nullptr, &vkpipeline);
+	desc->pipe.flags &= ~VK_PIPELINE_CREATE_DISABLE_OPTIMIZATION_BIT;
 
 	bool success = true;
 	if (result == VK_INCOMPLETE) {
@@ -46,6 +58,10 @@ bool VKRGraphicsPipeline::Create(VulkanContext *vulkan) {
 		success = false;
 	} else {
 		pipeline = vkpipeline;
+		if (optimizeLater) {
+			// Keep the desc for Optimize().
+			return true;
+		}
 	}
 
 	delete desc;
@@ -53,6 +69,21 @@ bool VKRGraphicsPipeline::Create(VulkanContext *vulkan) {
 	return success;
 }
 
+VkPipeline VKRGraphicsPipeline::Optimize(VulkanContext *vulkan) {
+	VkPipeline replaced = VK_NULL_HANDLE;
+	VkPipeline vkpipeline;
+	VkResult result = vkCreateGraphicsPipelines(vulkan->GetDevice(), desc->pipelineCache, 1, &desc->pipe, nullptr, &vkpipeline);
+	if (result == VK_SUCCESS) {
+		replaced = pipeline.exchange(vkpipeline);
+	} else {
+		// Keep using the unoptimized one.
+		WARN_LOG(G3D, "Failed creating optimized graphics pipeline: result='%s'", VulkanResultToString(result));
+	}
+	delete desc;
+	desc = nullptr;
+	return replaced;
+}
+
 bool VKRComputePipeline::Create(VulkanContext *vulkan) {
 	if (!desc) {
 		// Already failed to create this one.
@@ -261,6 +292,9 @@ bool VulkanRenderManager::CreateBackbuffers() {
 	VkResult res = vkGetSwapchainImagesKHR(vulkan_->GetDevice(), vulkan_->GetSwapchain(), &swapchainImageCount_, nullptr);
 	_dbg_assert_(res == VK_SUCCESS);
 
+	// Present ids from an old swapchain can't be waited on.
+	lastPresentedId_ = 0;
+
 	VkImage *swapchainImages = new VkImage[swapchainImageCount_];
 	res = vkGetSwapchainImagesKHR(vulkan_->GetDevice(), vulkan_->GetSwapchain(), &swapchainImageCount_, swapchainImages);
 	if (res != VK_SUCCESS) {
@@ -354,6 +388,7 @@ void VulkanRenderManager::StopThread() {
 		compileCond_.notify_all();
 		compileThread_.join();
 		INFO_LOG(G3D, "Vulkan compiler thread joined.");
+		FlushRetiredPipelines();
 
 		// Eat whatever has been queued up for this frame if anything.
 		Wipe();
@@ -427,9 +462,15 @@ VulkanRenderManager::~VulkanRenderManager() {
 		vkFreeCommandBuffers(device, frameData_[i].cmdPoolMain, 1, &frameData_[i].mainCmd);
 		vkDestroyCommandPool(device, frameData_[i].cmdPoolInit, nullptr);
 		vkDestroyCommandPool(device, frameData_[i].cmdPoolMain, nullptr);
+		frameData_[i].secondaryPools.Destroy(vulkan_);
 		vkDestroyFence(device, frameData_[i].fence, nullptr);
 		vkDestroyFence(device, frameData_[i].readbackFence, nullptr);
 		vkDestroyQueryPool(device, frameData_[i].profile.queryPool, nullptr);
+		for (DelayedReadback *readback : frameData_[i].readbacks) {
+			readback->readback.Destroy(vulkan_);
+			delete readback;
+		}
+		frameData_[i].readbacks.clear();
 	}
 	queueRunner_.DestroyDeviceObjects();
 }
@@ -438,31 +479,84 @@ void VulkanRenderManager::CompileThreadFunc() {
 	SetCurrentThreadName("ShaderCompile");
 	while (true) {
 		std::vector<CompileQueueEntry> toCompile;
+		VKRGraphicsPipeline *toOptimize = nullptr;
 		{
 			std::unique_lock<std::mutex> lock(compileMutex_);
-			if (compileQueue_.empty()) {
+			if (compileQueue_.empty() && optimizeQueue_.empty()) {
 				compileCond_.wait(lock);
 			}
 			toCompile = std::move(compileQueue_);
 			compileQueue_.clear();
+			// Optimized rebuilds only happen when nothing new is waiting, one at a time.
+			if (toCompile.empty() && !optimizeQueue_.empty() && run_) {
+				toOptimize = optimizeQueue_.front();
+				optimizeQueue_.pop_front();
+				optimizing_ = toOptimize;
+			}
 		}
 		if (!run_) {
 			break;
 		}
-		for (auto &entry : toCompile) {
-			switch (entry.type) {
-			case CompileQueueEntry::Type::GRAPHICS:
-				entry.graphics->Create(vulkan_);
-				break;
-			case CompileQueueEntry::Type::COMPUTE:
-				entry.compute->Create(vulkan_);
-				break;
+		if (toOptimize) {
+			VkPipeline replaced = toOptimize->Optimize(vulkan_);
+			std::unique_lock<std::mutex> lock(compileMutex_);
+			if (replaced != VK_NULL_HANDLE)
+				retiredPipelines_.push_back(replaced);
+			optimizing_ = nullptr;
+			optimizeDone_.notify_all();
+			continue;
+		}
+		const bool optimizeLater = optimizePipelinesLater_;
+		auto compileRange = [&](int l, int h) {
+			for (int i = l; i < h; i++) {
+				CompileQueueEntry &entry = toCompile[i];
+				switch (entry.type) {
+				case CompileQueueEntry::Type::GRAPHICS:
+					if (entry.graphics->Create(vulkan_, optimizeLater) && entry.graphics->desc) {
+						std::unique_lock<std::mutex> lock(compileMutex_);
+						optimizeQueue_.push_back(entry.graphics);
+					}
+					break;
+				case CompileQueueEntry::Type::COMPUTE:
+					entry.compute->Create(vulkan_);
+					break;
+				}
+				// Wake up the render thread as soon as possible, it might be waiting on this one.
+				queueRunner_.NotifyCompileDone();
 			}
+		};
+		if (toCompile.size() > 1) {
+			// Pipeline creation is free-threaded (the VkPipelineCache is internally synchronized), so
+			// spread batches, like the big one from loading the shader cache, over the worker threads.
+			ParallelRangeLoop(&g_threadManager, compileRange, 0, (int)toCompile.size(), 1);
+		} else {
+			compileRange(0, (int)toCompile.size());
 		}
 		queueRunner_.NotifyCompileDone();
 	}
 }
 
+void VulkanRenderManager::CancelPipelineOptimization() {
+	std::unique_lock<std::mutex> lock(compileMutex_);
+	for (VKRGraphicsPipeline *pipeline : optimizeQueue_) {
+		delete pipeline->desc;
+		pipeline->desc = nullptr;
+	}
+	optimizeQueue_.clear();
+	while (optimizing_) {
+		optimizeDone_.wait(lock);
+	}
+}
+
+void VulkanRenderManager::FlushRetiredPipelines() {
+	// Earlier frames may still use these, so they go through the delete queue.
+	std::unique_lock<std::mutex> lock(compileMutex_);
+	for (VkPipeline &pipeline : retiredPipelines_) {
+		vulkan_->Delete().QueueDeletePipeline(pipeline);
+	}
+	retiredPipelines_.clear();
+}
+
 void VulkanRenderManager::DrainCompileQueue() {
 	std::unique_lock<std::mutex> lock(compileMutex_);
 	while (!compileQueue_.empty()) {
@@ -536,16 +630,52 @@ void VulkanRenderManager::BeginFrame(bool enableProfiling, bool enableLogProfile
 	VLOG("PUSH: Fencing %d", curFrame);
 
 	vkWaitForFences(device, 1, &frameData.fence, true, UINT64_MAX);
+	FrameTimeline_Mark(FrameTimelineLane::GPU);
 	vkResetFences(device, 1, &frameData.fence);
 
+	FlushRetiredPipelines();
+
+	if (vulkan_->Extensions().KHR_present_wait) {
+		// Wait for the latest present to actually be shown, so we don't start emulating
+		// a frame that'll sit in the queue. The timeout covers minimized windows and similar.
+		uint64_t waitId = lastPresentedId_;
+		if (lowLatencyPresent_ && waitId != 0) {
+			VkResult res = vkWaitForPresentKHR(device, vulkan_->GetSwapchain(), waitId, 100 * 1000 * 1000);
+			if (res == VK_SUCCESS) {
+				lastPresentLatencyMs_ = (time_now_d() - presentBeginTimes_[waitId % PRESENT_HISTORY]) * 1000.0;
+			}
+		} else {
+			lastPresentLatencyMs_ = 0.0;
+		}
+		frameData.presentId = ++nextPresentId_;
+		presentBeginTimes_[frameData.presentId % PRESENT_HISTORY] = time_now_d();
+	}
+
 	// Can't set this until after the fence.
 	frameData.profilingEnabled_ = enableProfiling;
 	frameData.readbackFenceUsed = false;
 
+	// Async readbacks nobody asked for again the last time around are dropped, everything else now has data.
+	for (size_t i = 0; i < frameData.readbacks.size(); ) {
+		DelayedReadback *readback = frameData.readbacks[i];
+		if (!readback->used) {
+			readback->readback.Destroy(vulkan_);
+			delete readback;
+			frameData.readbacks[i] = frameData.readbacks.back();
+			frameData.readbacks.pop_back();
+			continue;
+		}
+		readback->hasData = readback->readback.buffer != VK_NULL_HANDLE;
+		readback->used = false;
+		i++;
+	}
+
 	uint64_t queryResults[MAX_TIMESTAMP_QUERIES];
 
-	if (frameData.profilingEnabled_) {
-		// Pull the profiling results from last time and produce a summary!
+	if (!frameData.profilingEnabled_) {
+		lastGpuTimings_ = Draw::GPUFrameTimings();
+	} else {
+		// Pull the profiling results from last time.
 		if (!frameData.profile.timestampDescriptions.empty()) {
 			int numQueries = (int)frameData.profile.timestampDescriptions.size();
 			VkResult res = vkGetQueryPoolResults(
@@ -556,25 +686,18 @@ void VulkanRenderManager::BeginFrame(bool enableProfiling, bool enableLogProfile
 				double timestampConversionFactor = (double)vulkan_->GetPhysicalDeviceProperties().properties.limits.timestampPeriod * (1.0 / 1000000.0);
 				int validBits = vulkan_->GetQueueFamilyProperties(vulkan_->GetGraphicsQueueFamilyIndex()).timestampValidBits;
 				uint64_t timestampDiffMask = validBits == 64 ? 0xFFFFFFFFFFFFFFFFULL : ((1ULL << validBits) - 1);
-				std::stringstream str;
 
-				char line[256];
-				snprintf(line, sizeof(line), "Total GPU time: %0.3f ms\n", ((double)((queryResults[numQueries - 1] - queryResults[0]) & timestampDiffMask) * timestampConversionFactor));
-				str << line;
-				snprintf(line, sizeof(line), "Render CPU time: %0.3f ms\n", (frameData.profile.cpuEndTime - frameData.profile.cpuStartTime) * 1000.0);
-				str << line;
+				Draw::GPUFrameTimings &timings = lastGpuTimings_;
+				timings.totalMs = (double)((queryResults[numQueries - 1] - queryResults[0]) & timestampDiffMask) * timestampConversionFactor;
+				timings.cpuMs = (frameData.profile.cpuEndTime - frameData.profile.cpuStartTime) * 1000.0;
+				timings.passes.resize(numQueries - 1);
 				for (int i = 0; i < numQueries - 1; i++) {
 					uint64_t diff = (queryResults[i + 1] - queryResults[i]) & timestampDiffMask;
-					double milliseconds = (double)diff * timestampConversionFactor;
-					snprintf(line, sizeof(line), "%s: %0.3f ms\n", frameData.profile.timestampDescriptions[i + 1].c_str(), milliseconds);
-					str << line;
+					timings.passes[i].name = frameData.profile.timestampDescriptions[i + 1];
+					timings.passes[i].ms = (double)diff * timestampConversionFactor;
 				}
-				frameData.profile.profileSummary = str.str();
-			} else {
-				frameData.profile.profileSummary = "(error getting GPU profile - not ready?)";
 			}
-		} else {
-			frameData.profile.profileSummary = "(no GPU profile data collected)";
+			// Otherwise, not ready. Keep showing the previous results.
 		}
 	}
 
@@ -776,8 +899,7 @@ void VulkanRenderManager::BindFramebufferAsRenderTarget(VKRFramebuffer *fb, VKRR
 	}
 }
 
-bool VulkanRenderManager::CopyFramebufferToMemorySync(VKRFramebuffer *src, VkImageAspectFlags aspectBits, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag) {
-	_dbg_assert_(insideFrame_);
+void VulkanRenderManager::PushReadbackStep(VKRFramebuffer *src, VkImageAspectFlags aspectBits, int x, int y, int w, int h, CachedReadback *delayed, const char *tag) {
 	for (int i = (int)steps_.size() - 1; i >= 0; i--) {
 		if (steps_[i]->stepType == VKRStepType::RENDER && steps_[i]->render.framebuffer == src) {
 			steps_[i]->render.numReads++;
@@ -792,17 +914,18 @@ bool VulkanRenderManager::CopyFramebufferToMemorySync(VKRFramebuffer *src, VkIma
 	step->readback.src = src;
 	step->readback.srcRect.offset = { x, y };
 	step->readback.srcRect.extent = { (uint32_t)w, (uint32_t)h };
+	step->readback.delayed = delayed;
 	step->dependencies.insert(src);
 	step->tag = tag;
 	steps_.push_back(step);
+}
 
-	FlushSync();
-
-	Draw::DataFormat srcFormat = Draw::DataFormat::UNDEFINED;
+bool VulkanRenderManager::GetReadbackSrcFormat(VKRFramebuffer *src, VkImageAspectFlags aspectBits, Draw::DataFormat *srcFormat) {
+	*srcFormat = Draw::DataFormat::UNDEFINED;
 	if (aspectBits & VK_IMAGE_ASPECT_COLOR_BIT) {
 		if (src) {
 			switch (src->color.format) {
-			case VK_FORMAT_R8G8B8A8_UNORM: srcFormat = Draw::DataFormat::R8G8B8A8_UNORM; break;
+			case VK_FORMAT_R8G8B8A8_UNORM: *srcFormat = Draw::DataFormat::R8G8B8A8_UNORM; break;
 			default: _assert_(false);
 			}
 		} else {
@@ -812,8 +935,8 @@ bool VulkanRenderManager::CopyFramebufferToMemorySync(VKRFramebuffer *src, VkIma
 				return false;
 			}
 			switch (vulkan_->GetSwapchainFormat()) {
-			case VK_FORMAT_B8G8R8A8_UNORM: srcFormat = Draw::DataFormat::B8G8R8A8_UNORM; break;
-			case VK_FORMAT_R8G8B8A8_UNORM: srcFormat = Draw::DataFormat::R8G8B8A8_UNORM; break;
+			case VK_FORMAT_B8G8R8A8_UNORM: *srcFormat = Draw::DataFormat::B8G8R8A8_UNORM; break;
+			case VK_FORMAT_R8G8B8A8_UNORM: *srcFormat = Draw::DataFormat::R8G8B8A8_UNORM; break;
 			// NOTE: If you add supported formats here, make sure to also support them in VulkanQueueRunner::CopyReadbackBuffer.
 			default:
 				ERROR_LOG(G3D, "Unsupported backbuffer format for screenshots");
@@ -822,22 +945,74 @@ bool VulkanRenderManager::CopyFramebufferToMemorySync(VKRFramebuffer *src, VkIma
 		}
 	} else if (aspectBits & VK_IMAGE_ASPECT_STENCIL_BIT) {
 		// Copies from stencil are always S8.
-		srcFormat = Draw::DataFormat::S8;
+		*srcFormat = Draw::DataFormat::S8;
 	} else if (aspectBits & VK_IMAGE_ASPECT_DEPTH_BIT) {
 		switch (src->depth.format) {
-		case VK_FORMAT_D24_UNORM_S8_UINT: srcFormat = Draw::DataFormat::D24_S8; break;
-		case VK_FORMAT_D32_SFLOAT_S8_UINT: srcFormat = Draw::DataFormat::D32F; break;
-		case VK_FORMAT_D16_UNORM_S8_UINT: srcFormat = Draw::DataFormat::D16; break;
+		case VK_FORMAT_D24_UNORM_S8_UINT: *srcFormat = Draw::DataFormat::D24_S8; break;
+		case VK_FORMAT_D32_SFLOAT_S8_UINT: *srcFormat = Draw::DataFormat::D32F; break;
+		case VK_FORMAT_D16_UNORM_S8_UINT: *srcFormat = Draw::DataFormat::D16; break;
 		default: _assert_(false);
 		}
 	} else {
 		_assert_(false);
 	}
+	return true;
+}
+
+bool VulkanRenderManager::CopyFramebufferToMemorySync(VKRFramebuffer *src, VkImageAspectFlags aspectBits, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag) {
+	_dbg_assert_(insideFrame_);
+	PushReadbackStep(src, aspectBits, x, y, w, h, nullptr, tag);
+
+	FlushSync();
+
+	Draw::DataFormat srcFormat;
+	if (!GetReadbackSrcFormat(src, aspectBits, &srcFormat)) {
+		return false;
+	}
 	// Need to call this after FlushSync so the pixels are guaranteed to be ready in CPU-accessible VRAM.
-	queueRunner_.CopyReadbackBuffer(w, h, srcFormat, destFormat, pixelStride, pixels);
+	queueRunner_.CopyReadbackBuffer(nullptr, w, h, srcFormat, destFormat, pixelStride, pixels);
 	return true;
 }
 
+bool VulkanRenderManager::CopyFramebufferToMemoryAsync(VKRFramebuffer *src, VkImageAspectFlags aspectBits, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag) {
+	_dbg_assert_(insideFrame_);
+	// The backbuffer is only read for screenshots, those should see the current frame.
+	if (!src) {
+		return false;
+	}
+
+	Draw::DataFormat srcFormat;
+	if (!GetReadbackSrcFormat(src, aspectBits, &srcFormat)) {
+		return false;
+	}
+
+	FrameData &frameData = frameData_[vulkan_->GetCurFrame()];
+	DelayedReadback *readback = nullptr;
+	for (DelayedReadback *candidate : frameData.readbacks) {
+		if (candidate->src == src && candidate->aspectBits == aspectBits && candidate->x == x && candidate->y == y && candidate->w == w && candidate->h == h) {
+			readback = candidate;
+			break;
+		}
+	}
+
+	bool copied = false;
+	if (!readback) {
+		readback = new DelayedReadback{ src, aspectBits, x, y, w, h };
+		frameData.readbacks.push_back(readback);
+	} else if (readback->used) {
+		// Asked for twice this frame, the data is already stale. Let the caller sync.
+		return false;
+	} else if (readback->hasData) {
+		// BeginFrame waited for the fence of the frame that filled this, so it can be read directly.
+		copied = queueRunner_.CopyReadbackBuffer(&readback->readback, w, h, srcFormat, destFormat, pixelStride, pixels);
+	}
+
+	readback->used = true;
+	readback->hasData = false;
+	PushReadbackStep(src, aspectBits, x, y, w, h, &readback->readback, tag);
+	return copied;
+}
+
 void VulkanRenderManager::CopyImageToMemorySync(VkImage image, int mipLevel, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag) {
 	_dbg_assert_(insideFrame_);
 
@@ -854,7 +1029,7 @@ void VulkanRenderManager::CopyImageToMemorySync(VkImage image, int mipLevel, int
 	FlushSync();
 
 	// Need to call this after FlushSync so the pixels are guaranteed to be ready in CPU-accessible VRAM.
-	queueRunner_.CopyReadbackBuffer(w, h, destFormat, destFormat, pixelStride, pixels);
+	queueRunner_.CopyReadbackBuffer(nullptr, w, h, destFormat, destFormat, pixelStride, pixels);
 }
 
 bool VulkanRenderManager::InitBackbufferFramebuffers(int width, int height) {
@@ -1226,6 +1401,10 @@ void VulkanRenderManager::Wipe() {
 		delete step;
 	}
 	steps_.clear();
+	// Wiped readback steps won't fill anything, don't let them count as results.
+	for (DelayedReadback *readback : frameData_[vulkan_->GetCurFrame()].readbacks) {
+		readback->used = false;
+	}
 }
 
 // Can be called multiple times with no bad side effects. This is so that we can either begin a frame the normal way,
@@ -1247,6 +1426,7 @@ void VulkanRenderManager::BeginSubmitFrame(int frame) {
 		}
 
 		vkResetCommandPool(vulkan_->GetDevice(), frameData.cmdPoolMain, 0);
+		frameData.secondaryPools.Reset(vulkan_);
 		VkCommandBufferBeginInfo begin{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
 		begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 		res = vkBeginCommandBuffer(frameData.mainCmd, &begin);
@@ -1329,6 +1509,7 @@ void VulkanRenderManager::EndSubmitFrame(int frame) {
 	frameData.hasBegun = false;
 
 	Submit(frame, true);
+	FrameTimeline_End(FrameTimelineLane::RENDER);
 
 	if (!frameData.skipSwap) {
 		VkSwapchainKHR swapchain = vulkan_->GetSwapchain();
@@ -1339,7 +1520,16 @@ void VulkanRenderManager::EndSubmitFrame(int frame) {
 		present.pWaitSemaphores = &renderingCompleteSemaphore_;
 		present.waitSemaphoreCount = 1;
 
+		VkPresentIdKHR presentId{ VK_STRUCTURE_TYPE_PRESENT_ID_KHR };
+		if (frameData.presentId != 0) {
+			presentId.swapchainCount = 1;
+			presentId.pPresentIds = &frameData.presentId;
+			present.pNext = &presentId;
+		}
+
+		FrameTimeline_Begin(FrameTimelineLane::PRESENT);
 		VkResult res = vkQueuePresentKHR(vulkan_->GetGraphicsQueue(), &present);
+		FrameTimeline_End(FrameTimelineLane::PRESENT);
 		if (res == VK_ERROR_OUT_OF_DATE_KHR) {
 			// We clearly didn't get this in vkAcquireNextImageKHR because of the skipSwap check above.
 			// Do the increment.
@@ -1351,6 +1541,8 @@ void VulkanRenderManager::EndSubmitFrame(int frame) {
 		} else {
 			// Success
 			outOfDateFrames_ = 0;
+			if (frameData.presentId != 0)
+				lastPresentedId_ = frameData.presentId;
 		}
 	} else {
 		// We only get here if vkAcquireNextImage returned VK_ERROR_OUT_OF_DATE.
@@ -1360,6 +1552,7 @@ void VulkanRenderManager::EndSubmitFrame(int frame) {
 }
 
 void VulkanRenderManager::Run(int frame) {
+	FrameTimeline_Begin(FrameTimelineLane::RENDER);
 	BeginSubmitFrame(frame);
 
 	FrameData &frameData = frameData_[frame];
@@ -1367,7 +1560,7 @@ void VulkanRenderManager::Run(int frame) {
 	VkCommandBuffer cmd = frameData.mainCmd;
 	queueRunner_.PreprocessSteps(stepsOnThread);
 	//queueRunner_.LogSteps(stepsOnThread, false);
-	queueRunner_.RunSteps(cmd, stepsOnThread, frameData.profilingEnabled_ ? &frameData.profile : nullptr);
+	queueRunner_.RunSteps(cmd, stepsOnThread, frameData.profilingEnabled_ ? &frameData.profile : nullptr, &frameData.secondaryPools);
 	stepsOnThread.clear();
 
 	switch (frameData.type) {
@@ -1382,6 +1575,8 @@ void VulkanRenderManager::Run(int frame) {
 	default:
 		_dbg_assert_(false);
 	}
+	// Already ended before present for END frames, so this only covers syncs.
+	FrameTimeline_End(FrameTimelineLane::RENDER);
 
 	VLOG("PULL: Finished running frame %d", frame);
 }
@@ -1407,6 +1602,7 @@ void VulkanRenderManager::EndSyncFrame(int frame) {
 		VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
 	};
 	vkResetCommandPool(vulkan_->GetDevice(), frameData.cmdPoolMain, 0);
+	frameData.secondaryPools.Reset(vulkan_);
 	VkResult res = vkBeginCommandBuffer(frameData.mainCmd, &begin);
 	_assert_(res == VK_SUCCESS);
 
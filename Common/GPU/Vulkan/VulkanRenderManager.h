@@ -8,6 +8,8 @@
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <mutex>
 #include <thread>
 #include <queue>
@@ -17,6 +19,7 @@
 #include "Common/Data/Convert/SmallDataConvert.h"
 #include "Common/Math/math_util.h"
 #include "Common/GPU/DataFormat.h"
+#include "Common/GPU/thin3d.h"
 #include "Common/GPU/Vulkan/VulkanQueueRunner.h"
 
 // Forward declaration
@@ -125,11 +128,14 @@ struct VKRGraphicsPipelineDesc {
 	VkPipelineMultisampleStateCreateInfo ms{ VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO };
 	VkPipelineShaderStageCreateInfo shaderStageInfo[2]{};
 	VkPipelineInputAssemblyStateCreateInfo inputAssembly{ VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO };
-	VkVertexInputAttributeDescription attrs[8]{};
+	VkVertexInputAttributeDescription attrs[16]{};
 	VkVertexInputBindingDescription ibd{};
 	VkPipelineVertexInputStateCreateInfo vis{ VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
 	VkPipelineViewportStateCreateInfo views{ VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
 	VkGraphicsPipelineCreateInfo pipe{ VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+	// Optional, runs on the compile thread right before creation. Can fill in things that aren't ready yet,
+	// like shader modules still being compiled. Returning false fails the pipeline.
+	std::function<bool(VKRGraphicsPipelineDesc *)> prepare;
 };
 
 // All the data needed to create a compute pipeline.
@@ -146,7 +152,11 @@ struct VKRGraphicsPipeline {
 	VKRGraphicsPipelineDesc *desc = nullptr;  // While non-zero, is pending and pipeline isn't valid.
 	std::atomic<VkPipeline> pipeline;
 
-	bool Create(VulkanContext *vulkan);
+	// With optimizeLater, the pipeline is first created with optimizations disabled, which is much
+	// faster on many drivers, and desc is kept around for a later Optimize().
+	bool Create(VulkanContext *vulkan, bool optimizeLater = false);
+	// Builds the optimized pipeline and swaps it in. Returns the replaced pipeline, to be deleted later.
+	VkPipeline Optimize(VulkanContext *vulkan);
 	bool Pending() const {
 		return pipeline == VK_NULL_HANDLE && desc != nullptr;
 	}
@@ -217,6 +227,10 @@ class VulkanRenderManager {
 	VkImageView BindFramebufferAsTexture(VKRFramebuffer *fb, int binding, VkImageAspectFlags aspectBits, int attachment);
 
 	bool CopyFramebufferToMemorySync(VKRFramebuffer *src, VkImageAspectFlags aspectBits, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag);
+	// Doesn't stall. Writes the result of the same readback issued the last time this frame slot was used
+	// (so a few frames old), and queues a new one. Returns false if there was no earlier result, then nothing
+	// was written and the caller should use the sync version.
+	bool CopyFramebufferToMemoryAsync(VKRFramebuffer *src, VkImageAspectFlags aspectBits, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag);
 	void CopyImageToMemorySync(VkImage image, int mipLevel, int x, int y, int w, int h, Draw::DataFormat destFormat, uint8_t *pixels, int pixelStride, const char *tag);
 
 	void CopyFramebuffer(VKRFramebuffer *src, VkRect2D srcRect, VKRFramebuffer *dst, VkOffset2D dstPos, VkImageAspectFlags aspectMask, const char *tag);
@@ -433,6 +447,31 @@ class VulkanRenderManager {
 		splitSubmit_ = split;
 	}
 
+	void SetSkipPendingPipelines(bool skip) {
+		queueRunner_.SetSkipPendingPipelines(skip);
+	}
+
+	// New pipelines are first created unoptimized, then rebuilt optimized when the compile thread is idle.
+	void SetOptimizePipelinesLater(bool later) {
+		optimizePipelinesLater_ = later;
+	}
+	// Drops queued optimized rebuilds and waits for one in progress. Call before deleting pipelines.
+	void CancelPipelineOptimization();
+
+	// Waits for the previous present to reach the display before starting a new frame,
+	// so input is sampled as late as possible. Needs KHR_present_wait, otherwise ignored.
+	void SetLowLatencyPresent(bool lowLatency) {
+		lowLatencyPresent_ = lowLatency;
+	}
+	// Time from BeginFrame to the frame reaching the display, 0 if not measured.
+	double GetPresentLatencyMs() const {
+		return lastPresentLatencyMs_;
+	}
+
+	void SetParallelRecording(bool parallel) {
+		queueRunner_.SetParallelRecording(parallel);
+	}
+
 	void SetInflightFrames(int f) {
 		newInflightFrames_ = f < 1 || f > VulkanContext::MAX_INFLIGHT_FRAMES ? VulkanContext::MAX_INFLIGHT_FRAMES : f;
 	}
@@ -446,8 +485,12 @@ class VulkanRenderManager {
 		return &queueRunner_;
 	}
 
-	std::string GetGpuProfileString() const {
-		return frameData_[vulkan_->GetCurFrame()].profile.profileSummary;
+	// The most recent frame with complete timestamp results, updated in BeginFrame.
+	bool GetGPUTimings(Draw::GPUFrameTimings *timings) const {
+		if (lastGpuTimings_.passes.empty())
+			return false;
+		*timings = lastGpuTimings_;
+		return true;
 	}
 
 	bool NeedsSwapchainRecreate() const {
@@ -469,6 +512,19 @@ class VulkanRenderManager {
 	void EndSyncFrame(int frame);
 
 	void StopThread();
+	void FlushRetiredPipelines();
+
+	bool GetReadbackSrcFormat(VKRFramebuffer *src, VkImageAspectFlags aspectBits, Draw::DataFormat *srcFormat);
+	void PushReadbackStep(VKRFramebuffer *src, VkImageAspectFlags aspectBits, int x, int y, int w, int h, CachedReadback *delayed, const char *tag);
+
+	struct DelayedReadback {
+		VKRFramebuffer *src;
+		VkImageAspectFlags aspectBits;
+		int x, y, w, h;
+		CachedReadback readback;
+		bool hasData;
+		bool used;
+	};
 
 	// Permanent objects
 	VkSemaphore acquireSemaphore_;
@@ -496,12 +552,18 @@ class VulkanRenderManager {
 		VkCommandPool cmdPoolMain;
 		VkCommandBuffer initCmd;
 		VkCommandBuffer mainCmd;
+		// Render passes recorded on worker threads, executed from mainCmd.
+		VKRSecondaryPools secondaryPools;
 		bool hasInitCommands = false;
 		std::vector<VKRStep *> steps;
 
+		// Async readbacks, filled by this frame's steps. Only safe to read after the fence.
+		std::vector<DelayedReadback *> readbacks;
+
 		// Swapchain.
 		bool hasBegun = false;
 		uint32_t curSwapchainImage = -1;
+		uint64_t presentId = 0;
 
 		// Profiling.
 		QueueProfileContext profile;
@@ -514,6 +576,17 @@ class VulkanRenderManager {
 
 	int outOfDateFrames_ = 0;
 
+	// Latest results from the profiling timestamps. Main thread only.
+	Draw::GPUFrameTimings lastGpuTimings_;
+
+	// Present ids (KHR_present_id) are assigned on the main thread, set as presented by the render thread.
+	static const int PRESENT_HISTORY = 8;
+	bool lowLatencyPresent_ = false;
+	uint64_t nextPresentId_ = 0;
+	std::atomic<uint64_t> lastPresentedId_{};
+	double presentBeginTimes_[PRESENT_HISTORY]{};
+	double lastPresentLatencyMs_ = 0.0;
+
 	// Submission time state
 
 	// Note: These are raw backbuffer-sized. Rotated.
@@ -551,6 +624,13 @@ class VulkanRenderManager {
 	std::condition_variable compileCond_;
 	std::mutex compileMutex_;
 	std::vector<CompileQueueEntry> compileQueue_;
+	// Pipelines waiting for their optimized rebuild, see SetOptimizePipelinesLater.
+	std::deque<VKRGraphicsPipeline *> optimizeQueue_;
+	VKRGraphicsPipeline *optimizing_ = nullptr;
+	std::condition_variable optimizeDone_;
+	// Replaced unoptimized pipelines, handed to the delete queue in BeginFrame.
+	std::vector<VkPipeline> retiredPipelines_;
+	std::atomic<bool> optimizePipelinesLater_{};
 
 	// Swap chain management
 	struct SwapchainImageData {
@@ -320,6 +320,7 @@ class VKTexture : public Texture {
 	VKTexture(VulkanContext *vulkan, VkCommandBuffer cmd, VulkanPushBuffer *pushBuffer, const TextureDesc &desc)
 		: vulkan_(vulkan), mipLevels_(desc.mipLevels), format_(desc.format) {}
 	bool Create(VkCommandBuffer cmd, VulkanPushBuffer *pushBuffer, const TextureDesc &desc);
+	bool UpdateRect(VkCommandBuffer cmd, VulkanPushBuffer *pushBuffer, int x, int y, int w, int h, const uint8_t *data);
 
 	~VKTexture() {
 		Destroy();
@@ -383,6 +384,7 @@ class VKContext : public DrawContext {
 	ShaderModule *CreateShaderModule(ShaderStage stage, ShaderLanguage language, const uint8_t *data, size_t dataSize, const std::string &tag) override;
 
 	Texture *CreateTexture(const TextureDesc &desc) override;
+	bool UpdateTextureRect(Texture *tex, int x, int y, int w, int h, const uint8_t *data) override;
 	Buffer *CreateBuffer(size_t size, uint32_t usageFlags) override;
 	Framebuffer *CreateFramebuffer(const FramebufferDesc &desc) override;
 
@@ -391,6 +393,7 @@ class VKContext : public DrawContext {
 	void CopyFramebufferImage(Framebuffer *src, int level, int x, int y, int z, Framebuffer *dst, int dstLevel, int dstX, int dstY, int dstZ, int width, int height, int depth, int channelBits, const char *tag) override;
 	bool BlitFramebuffer(Framebuffer *src, int srcX1, int srcY1, int srcX2, int srcY2, Framebuffer *dst, int dstX1, int dstY1, int dstX2, int dstY2, int channelBits, FBBlitFilter filter, const char *tag) override;
 	bool CopyFramebufferToMemorySync(Framebuffer *src, int channelBits, int x, int y, int w, int h, Draw::DataFormat format, void *pixels, int pixelStride, const char *tag) override;
+	bool CopyFramebufferToMemoryAsync(Framebuffer *src, int channelBits, int x, int y, int w, int h, Draw::DataFormat format, void *pixels, int pixelStride, const char *tag) override;
 	DataFormat PreferredFramebufferReadbackFormat(Framebuffer *src) override;
 
 	// These functions should be self explanatory.
@@ -502,6 +505,13 @@ class VKContext : public DrawContext {
 		return renderManager_.GetCurrentStepId();
 	}
 
+	bool GetGPUTimings(GPUFrameTimings *timings) override {
+		return renderManager_.GetGPUTimings(timings);
+	}
+	double GetPresentLatencyMs() override {
+		return renderManager_.GetPresentLatencyMs();
+	}
+
 	void InvalidateCachedState() override;
 
 private:
@@ -770,6 +780,16 @@ bool VKTexture::Create(VkCommandBuffer cmd, VulkanPushBuffer *push, const Textur
 	return true;
 }
 
+bool VKTexture::UpdateRect(VkCommandBuffer cmd, VulkanPushBuffer *push, int x, int y, int w, int h, const uint8_t *data) {
+	if (!vkTex_ || mipLevels_ != 1)
+		return false;
+	size_t size = w * h * DataFormatSizeInBytes(format_);
+	VkBuffer buf;
+	uint32_t offset = push->PushAligned((const void *)data, size, 16, &buf);
+	vkTex_->UpdateRect(cmd, x, y, w, h, buf, offset);
+	return true;
+}
+
 VKContext::VKContext(VulkanContext *vulkan, bool splitSubmit)
 	: vulkan_(vulkan), renderManager_(vulkan) {
 	shaderLanguageDesc_.Init(GLSL_VULKAN);
@@ -789,6 +809,7 @@ VKContext::VKContext(VulkanContext *vulkan, bool splitSubmit)
 	caps_.preferredDepthBufferFormat = DataFormat::D24_S8;  // TODO: Ask vulkan.
 
 	auto deviceProps = vulkan->GetPhysicalDeviceProperties(vulkan_->GetCurrentPhysicalDeviceIndex()).properties;
+	caps_.timestampQueriesSupported = deviceProps.limits.timestampComputeAndGraphics && vulkan->GetQueueFamilyProperties(vulkan->GetGraphicsQueueFamilyIndex()).timestampValidBits != 0;
 	switch (deviceProps.vendorID) {
 	case VULKAN_VENDOR_AMD: caps_.vendor = GPUVendor::VENDOR_AMD; break;
 	case VULKAN_VENDOR_ARM: caps_.vendor = GPUVendor::VENDOR_ARM; break;
@@ -906,8 +927,9 @@ VKContext::~VKContext() {
 }
 
 void VKContext::BeginFrame() {
+	renderManager_.SetLowLatencyPresent(lowLatencyPresent_);
 	// TODO: Bad dependency on g_Config here!
-	renderManager_.BeginFrame(g_Config.bShowGpuProfile, g_Config.bGpuLogProfiler);
+	renderManager_.BeginFrame(gpuTimingEnabled_ && caps_.timestampQueriesSupported, g_Config.bGpuLogProfiler);
 
 	FrameData &frame = frame_[vulkan_->GetCurFrame()];
 	push_ = frame.pushBuffer;
@@ -1200,6 +1222,14 @@ Texture *VKContext::CreateTexture(const TextureDesc &desc) {
 	}
 }
 
+bool VKContext::UpdateTextureRect(Texture *tex, int x, int y, int w, int h, const uint8_t *data) {
+	// Goes in the init command buffer, which runs before this frame's draws.
+	VkCommandBuffer initCmd = renderManager_.GetInitCmd();
+	if (!push_ || !initCmd)
+		return false;
+	return ((VKTexture *)tex)->UpdateRect(initCmd, push_, x, y, w, h, data);
+}
+
 static inline void CopySide(VkStencilOpState &dest, const StencilSide &src) {
 	dest.compareMask = src.compareMask;
 	dest.writeMask = src.writeMask;
@@ -1531,6 +1561,17 @@ bool VKContext::CopyFramebufferToMemorySync(Framebuffer *srcfb, int channelBits,
 	return renderManager_.CopyFramebufferToMemorySync(src ? src->GetFB() : nullptr, aspectMask, x, y, w, h, format, (uint8_t *)pixels, pixelStride, tag);
 }
 
+bool VKContext::CopyFramebufferToMemoryAsync(Framebuffer *srcfb, int channelBits, int x, int y, int w, int h, Draw::DataFormat format, void *pixels, int pixelStride, const char *tag) {
+	VKFramebuffer *src = (VKFramebuffer *)srcfb;
+
+	int aspectMask = 0;
+	if (channelBits & FBChannel::FB_COLOR_BIT) aspectMask |= VK_IMAGE_ASPECT_COLOR_BIT;
+	if (channelBits & FBChannel::FB_DEPTH_BIT) aspectMask |= VK_IMAGE_ASPECT_DEPTH_BIT;
+	if (channelBits & FBChannel::FB_STENCIL_BIT) aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+
+	return renderManager_.CopyFramebufferToMemoryAsync(src ? src->GetFB() : nullptr, aspectMask, x, y, w, h, format, (uint8_t *)pixels, pixelStride, tag);
+}
+
 DataFormat VKContext::PreferredFramebufferReadbackFormat(Framebuffer *src) {
 	if (src) {
 		return DrawContext::PreferredFramebufferReadbackFormat(src);
@@ -528,9 +528,24 @@ struct DeviceCaps {
 	bool framebufferDepthCopySupported;
 	bool framebufferDepthBlitSupported;
 	bool framebufferFetchSupported;
+	bool timestampQueriesSupported;  // GPU timing, see DrawContext::GetGPUTimings().
 	std::string deviceName;  // The device name to use when creating the thin3d context, to get the same one.
 };
 
+// GPU time spent in one step of a frame (usually a render pass, named after its tag.)
+struct GPUPassTiming {
+	std::string name;
+	double ms;
+};
+
+struct GPUFrameTimings {
+	// From the first to the last timestamp of the frame.
+	double totalMs = 0.0;
+	// CPU time spent submitting the frame on the render thread, if the backend has one.
+	double cpuMs = 0.0;
+	std::vector<GPUPassTiming> passes;
+};
+
 // Use to write data directly to texture memory.  initData is the pointer passed in TextureDesc.
 // Important: only write to the provided pointer, don't read from it.
 typedef std::function<bool(uint8_t *data, const uint8_t *initData, uint32_t w, uint32_t h, uint32_t d, uint32_t byteStride, uint32_t sliceByteStride)> TextureCallback;
@@ -605,6 +620,10 @@ class DrawContext {
 	virtual Buffer *CreateBuffer(size_t size, uint32_t usageFlags) = 0;
 	// Does not take ownership over pointed-to initData. After this returns, can dispose of it.
 	virtual Texture *CreateTexture(const TextureDesc &desc) = 0;
+	// Replaces a rectangle of level 0 of a texture without mips, with tightly packed data in the texture's format.
+	// Draws already recorded this frame may see the new data, so only use it for areas they don't sample.
+	// May change the texture bound to slot 0. Returns false if the backend can't, then create a texture instead.
+	virtual bool UpdateTextureRect(Texture *tex, int x, int y, int w, int h, const uint8_t *data) { return false; }
 	// On some hardware, you might get a 24-bit depth buffer even though you only wanted a 16-bit one.
 	virtual Framebuffer *CreateFramebuffer(const FramebufferDesc &desc) = 0;
 
@@ -619,6 +638,11 @@ class DrawContext {
 	virtual bool CopyFramebufferToMemorySync(Framebuffer *src, int channelBits, int x, int y, int w, int h, Draw::DataFormat format, void *pixels, int pixelStride, const char *tag) {
 		return false;
 	}
+	// Doesn't wait for the GPU. Writes the result of the same readback from a few frames back and queues a fresh one.
+	// Returns false if there's no such result yet (or it's not supported), then use CopyFramebufferToMemorySync.
+	virtual bool CopyFramebufferToMemoryAsync(Framebuffer *src, int channelBits, int x, int y, int w, int h, Draw::DataFormat format, void *pixels, int pixelStride, const char *tag) {
+		return false;
+	}
 	virtual DataFormat PreferredFramebufferReadbackFormat(Framebuffer *src) {
 		return DataFormat::R8G8B8A8_UNORM;
 	}
@@ -697,6 +721,30 @@ class DrawContext {
 
 	virtual int GetCurrentStepId() const = 0;
 
+	// Per-pass GPU timings with timestamp queries, when DeviceCaps::timestampQueriesSupported.
+	// Takes effect at the next BeginFrame(). Results lag a few frames behind.
+	void SetGPUTimingEnabled(bool enabled) {
+		gpuTimingEnabled_ = enabled;
+	}
+	// Returns false if timing is off, unsupported, or no frame has completed yet.
+	virtual bool GetGPUTimings(GPUFrameTimings *timings) {
+		return false;
+	}
+
+	// Wait for the previous frame to be displayed before starting the next, trading throughput for
+	// input latency. Vulkan (KHR_present_wait) only, D3D11 decides this when creating the swap chain.
+	void SetLowLatencyPresent(bool enabled) {
+		lowLatencyPresent_ = enabled;
+	}
+	// Measured time from frame start until display, 0 if not measured.
+	virtual double GetPresentLatencyMs() {
+		return presentLatencyMs_;
+	}
+	// For backends where the platform code owns the swap chain.
+	void SetPresentLatencyMs(double ms) {
+		presentLatencyMs_ = ms;
+	}
+
 protected:
 	ShaderModule *vsPresets_[VS_MAX_PRESET];
 	ShaderModule *fsPresets_[FS_MAX_PRESET];
@@ -706,6 +754,10 @@ class DrawContext {
 	int targetWidth_;
 	int targetHeight_;
 
+	bool gpuTimingEnabled_ = false;
+	bool lowLatencyPresent_ = false;
+	double presentLatencyMs_ = 0.0;
+
 	Bugs bugs_;
 };
 
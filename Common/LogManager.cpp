@@ -24,7 +24,9 @@
 #endif
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <ctime>
 
 #include "Common/Data/Encoding/Utf8.h"
 
@@ -33,6 +35,7 @@
 #include "Common/TimeUtil.h"
 #include "Common/File/FileUtil.h"
 #include "Common/StringUtils.h"
+#include "Common/Thread/ThreadUtil.h"
 
 // Don't need to savestate this.
 const char *hleCurrentThreadName = nullptr;
@@ -75,6 +78,44 @@ bool GenericLogEnabled(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type) {
 	return false;
 }
 
+// Single producer (the thread that owns it), single consumer (the log thread.)
+struct LogRing {
+	enum { SIZE = 512, MASK = SIZE - 1 };
+
+	struct Slot {
+		LogMessage message;
+		std::chrono::system_clock::time_point time;
+		// Lets the log thread merge the rings back into (roughly) the order things were logged.
+		uint32_t seq;
+	};
+
+	Slot slots[SIZE];
+	std::atomic<uint32_t> writePos{};
+	std::atomic<uint32_t> readPos{};
+	// Cleared when the owning thread exits, so another thread can take the ring over.
+	std::atomic<bool> inUse{ true };
+};
+
+namespace {
+
+// Bumped for each LogManager, so a thread doesn't keep using a ring from a previous instance.
+std::atomic<int> g_logGeneration;
+
+struct ThreadLogRing {
+	~ThreadLogRing() {
+		if (ring && generation == g_logGeneration.load())
+			ring->inUse.store(false, std::memory_order_release);
+	}
+
+	LogRing *ring = nullptr;
+	int generation = -1;
+};
+
+thread_local ThreadLogRing t_logRing;
+thread_local bool t_isLogThread = false;
+
+}  // namespace
+
 LogManager *LogManager::logManager_ = NULL;
 
 struct LogNameTableEntry {
@@ -118,6 +159,7 @@ static const LogNameTableEntry logTable[] = {
 
 LogManager::LogManager(bool *enabledSetting) {
 	g_bLogEnabledSetting = enabledSetting;
+	g_logGeneration++;
 
 	for (size_t i = 0; i < ARRAY_SIZE(logTable); i++) {
 		_assert_msg_(i == logTable[i].logType, "Bad logtable at %i", (int)i);
@@ -158,6 +200,9 @@ LogManager::LogManager(bool *enabledSetting) {
 }
 
 LogManager::~LogManager() {
+	async_ = false;
+	StopLogThread();
+
 	for (int i = 0; i < LogTypes::NUMBER_OF_LOGS; ++i) {
 #if !defined(MOBILE_DEVICE) || defined(_DEBUG)
 		RemoveListener(fileLog_);
@@ -178,6 +223,11 @@ LogManager::~LogManager() {
 	delete debuggerLog_;
 #endif
 	delete ringLog_;
+
+	for (LogRing *ring : rings_)
+		delete ring;
+	// Threads still holding one of the deleted rings must not touch it on exit.
+	g_logGeneration++;
 }
 
 void LogManager::ChangeFileLog(const char *filename) {
@@ -198,6 +248,7 @@ void LogManager::SaveConfig(Section *section) {
 		section->Set((std::string(log_[i].m_shortName) + "Enabled").c_str(), log_[i].enabled);
 		section->Set((std::string(log_[i].m_shortName) + "Level").c_str(), (int)log_[i].level);
 	}
+	section->Set("AsyncLogging", IsAsync());
 }
 
 void LogManager::LoadConfig(Section *section, bool debugDefaults) {
@@ -209,17 +260,13 @@ void LogManager::LoadConfig(Section *section, bool debugDefaults) {
 		log_[i].enabled = enabled;
 		log_[i].level = (LogTypes::LOG_LEVELS)level;
 	}
-}
 
-void LogManager::Log(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char *file, int line, const char *format, va_list args) {
-	const LogChannel &log = log_[type];
-	if (level > log.level || !log.enabled)
-		return;
-
-	LogMessage message;
-	message.level = level;
-	message.log = log.m_shortName;
+	bool async = false;
+	section->Get("AsyncLogging", &async, false);
+	SetAsync(async);
+}
 
+static const char *ShortenFilename(const char *file) {
 #ifdef _WIN32
 	static const char sep = '\\';
 #else
@@ -233,10 +280,10 @@ void LogManager::Log(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const
 		if (fileshort != file)
 			file = fileshort + 1;
 	}
+	return file;
+}
 
-	std::lock_guard<std::mutex> lk(log_lock_);
-	GetTimeFormatted(message.timestamp);
-
+static void FormatHeader(LogMessage &message, LogTypes::LOG_LEVELS level, const LogChannel &log, const char *file, int line) {
 	if (hleCurrentThreadName) {
 		snprintf(message.header, sizeof(message.header), "%-12.12s %c[%s]: %s:%d",
 			hleCurrentThreadName, level_to_char[(int)level],
@@ -247,7 +294,10 @@ void LogManager::Log(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const
 			file, line, level_to_char[(int)level],
 			log.m_shortName);
 	}
+}
 
+// Reuses the capacity of message.msg, so this doesn't allocate when a ring slot is reused.
+static void FormatMsg(LogMessage &message, const char *format, va_list args) {
 	char msgBuf[1024];
 	va_list args_copy;
 
@@ -262,6 +312,27 @@ void LogManager::Log(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const
 	}
 	message.msg[neededBytes] = '\n';
 	va_end(args_copy);
+}
+
+void LogManager::Log(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char *file, int line, const char *format, va_list args) {
+	const LogChannel &log = log_[type];
+	if (level > log.level || !log.enabled)
+		return;
+
+	file = ShortenFilename(file);
+	if (async_.load(std::memory_order_relaxed)) {
+		LogAsync(level, log, file, line, format, args);
+		return;
+	}
+
+	LogMessage message;
+	message.level = level;
+	message.log = log.m_shortName;
+
+	std::lock_guard<std::mutex> lk(log_lock_);
+	GetTimeFormatted(message.timestamp);
+	FormatHeader(message, level, log, file, line);
+	FormatMsg(message, format, args);
 
 	std::lock_guard<std::mutex> listeners_lock(listeners_lock_);
 	for (auto &iter : listeners_) {
@@ -269,6 +340,177 @@ void LogManager::Log(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const
 	}
 }
 
+// localtime() isn't thread safe, so this is only called on the log thread, and uses the reentrant versions.
+static void FormatTimestamp(std::chrono::system_clock::time_point time, char formattedTime[16]) {
+	time_t sysTime = std::chrono::system_clock::to_time_t(time);
+	int ms = (int)(std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000);
+
+	struct tm localTime;
+#ifdef _WIN32
+	localtime_s(&localTime, &sysTime);
+#else
+	localtime_r(&sysTime, &localTime);
+#endif
+	char tmp[6];
+	strftime(tmp, sizeof(tmp), "%M:%S", &localTime);
+	snprintf(formattedTime, 11, "%s:%03d", tmp, ms);
+}
+
+LogRing *LogManager::GetThreadRing() {
+	int generation = g_logGeneration.load(std::memory_order_relaxed);
+	if (t_logRing.ring && t_logRing.generation == generation)
+		return t_logRing.ring;
+
+	// Only happens once per thread, so the lock is fine here.
+	std::lock_guard<std::mutex> guard(ringsLock_);
+	LogRing *ring = nullptr;
+	for (LogRing *r : rings_) {
+		bool expected = false;
+		if (r->inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+			ring = r;
+			break;
+		}
+	}
+	if (!ring) {
+		ring = new LogRing();
+		rings_.push_back(ring);
+	}
+	t_logRing.ring = ring;
+	t_logRing.generation = generation;
+	return ring;
+}
+
+void LogManager::LogAsync(LogTypes::LOG_LEVELS level, const LogChannel &log, const char *file, int line, const char *format, va_list args) {
+	LogRing *ring = GetThreadRing();
+
+	uint32_t pos = ring->writePos.load(std::memory_order_relaxed);
+	while (pos - ring->readPos.load(std::memory_order_acquire) >= LogRing::SIZE) {
+		// Full. Drop it if a listener logs on the log thread, since nothing else would empty the ring.
+		if (t_isLogThread)
+			return;
+		logThreadCond_.notify_one();
+		std::this_thread::yield();
+	}
+
+	LogRing::Slot &slot = ring->slots[pos & LogRing::MASK];
+	slot.time = std::chrono::system_clock::now();
+	slot.seq = nextSeq_.fetch_add(1, std::memory_order_relaxed);
+	slot.message.level = level;
+	slot.message.log = log.m_shortName;
+	FormatHeader(slot.message, level, log, file, line);
+	FormatMsg(slot.message, format, args);
+	ring->writePos.store(pos + 1, std::memory_order_release);
+
+	// The log thread wakes up by itself every few ms, only hurry it up for errors (which might be
+	// followed by a crash) or when the ring is filling up.
+	if (logThreadSleeping_.load(std::memory_order_relaxed)) {
+		if (level <= LogTypes::LERROR || pos - ring->readPos.load(std::memory_order_relaxed) >= LogRing::SIZE / 2)
+			logThreadCond_.notify_one();
+	}
+}
+
+bool LogManager::DrainRings(std::vector<LogRing *> &rings) {
+	bool any = false;
+	std::lock_guard<std::mutex> listeners_lock(listeners_lock_);
+	while (true) {
+		// Pick the oldest message among the heads of the rings.
+		LogRing *oldest = nullptr;
+		uint32_t oldestSeq = 0;
+		for (LogRing *ring : rings) {
+			uint32_t pos = ring->readPos.load(std::memory_order_relaxed);
+			if (pos == ring->writePos.load(std::memory_order_acquire))
+				continue;
+			uint32_t seq = ring->slots[pos & LogRing::MASK].seq;
+			if (!oldest || (int32_t)(seq - oldestSeq) < 0) {
+				oldest = ring;
+				oldestSeq = seq;
+			}
+		}
+		if (!oldest) {
+			// The file is only flushed per batch here, instead of per message.
+			if (any && fileLog_)
+				fileLog_->Flush();
+			return any;
+		}
+
+		uint32_t pos = oldest->readPos.load(std::memory_order_relaxed);
+		LogRing::Slot &slot = oldest->slots[pos & LogRing::MASK];
+		FormatTimestamp(slot.time, slot.message.timestamp);
+		for (auto &iter : listeners_) {
+			iter->Log(slot.message);
+		}
+		oldest->readPos.store(pos + 1, std::memory_order_release);
+		any = true;
+	}
+}
+
+void LogManager::LogThreadFunc() {
+	SetCurrentThreadName("LogThread");
+	t_isLogThread = true;
+
+	std::vector<LogRing *> rings;
+	while (true) {
+		{
+			std::lock_guard<std::mutex> guard(ringsLock_);
+			rings = rings_;
+		}
+		if (DrainRings(rings))
+			continue;
+
+		std::unique_lock<std::mutex> guard(logThreadLock_);
+		if (logThreadStop_)
+			break;
+		logThreadSleeping_ = true;
+		// Producers skip the lock when notifying, so a wakeup can be missed. The timeout covers that.
+		logThreadCond_.wait_for(guard, std::chrono::milliseconds(10));
+		logThreadSleeping_ = false;
+	}
+}
+
+void LogManager::SetAsync(bool async) {
+	if (async == async_)
+		return;
+	if (async) {
+		logThreadStop_ = false;
+		logThread_ = std::thread([this] { LogThreadFunc(); });
+		async_ = true;
+	} else {
+		async_ = false;
+		StopLogThread();
+	}
+}
+
+void LogManager::StopLogThread() {
+	if (!logThread_.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> guard(logThreadLock_);
+		logThreadStop_ = true;
+	}
+	logThreadCond_.notify_one();
+	// The thread drains everything before checking the stop flag.
+	logThread_.join();
+}
+
+void LogManager::Flush() {
+	if (!logThread_.joinable())
+		return;
+
+	std::vector<std::pair<LogRing *, uint32_t>> targets;
+	{
+		std::lock_guard<std::mutex> guard(ringsLock_);
+		for (LogRing *ring : rings_)
+			targets.push_back(std::make_pair(ring, ring->writePos.load(std::memory_order_acquire)));
+	}
+	logThreadCond_.notify_one();
+	for (auto &target : targets) {
+		while ((int32_t)(target.first->readPos.load(std::memory_order_acquire) - target.second) < 0) {
+			logThreadCond_.notify_one();
+			std::this_thread::yield();
+		}
+	}
+}
+
 bool LogManager::IsEnabled(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type) {
 	LogChannel &log = log_[type];
 	if (level > log.level || !log.enabled)
@@ -318,6 +560,15 @@ void FileLogListener::Log(const LogMessage &message) {
 
 	std::lock_guard<std::mutex> lk(m_log_lock);
 	fprintf(fp_, "%s %s %s", message.timestamp, message.header, message.msg.c_str());
+	if (!t_isLogThread)
+		fflush(fp_);
+}
+
+void FileLogListener::Flush() {
+	if (!IsValid())
+		return;
+
+	std::lock_guard<std::mutex> lk(m_log_lock);
 	fflush(fp_);
 }
 
@@ -19,7 +19,10 @@
 
 #include "ppsspp_config.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 #include <vector>
 #include <cstdarg>
 #include <cstdio>
@@ -56,6 +59,7 @@ class FileLogListener : public LogListener {
 	~FileLogListener();
 
 	void Log(const LogMessage &msg);
+	void Flush();
 
 	bool IsValid() { if (!fp_) return false; else return true; }
 	bool IsEnabled() const { return m_enable; }
@@ -105,6 +109,7 @@ struct LogChannel {
 };
 
 class ConsoleListener;
+struct LogRing;
 
 class LogManager {
 private:
@@ -126,6 +131,24 @@ class LogManager {
 	std::mutex listeners_lock_;
 	std::vector<LogListener*> listeners_;
 
+	// Async mode: each logging thread formats into its own lock-free ring, and the log thread
+	// passes the messages on to the listeners, so slow listeners don't hold up emulation.
+	void LogAsync(LogTypes::LOG_LEVELS level, const LogChannel &log, const char *file, int line, const char *format, va_list args);
+	LogRing *GetThreadRing();
+	bool DrainRings(std::vector<LogRing *> &rings);
+	void LogThreadFunc();
+	void StopLogThread();
+
+	std::atomic<bool> async_{};
+	std::thread logThread_;
+	std::mutex ringsLock_;
+	std::vector<LogRing *> rings_;
+	std::atomic<uint32_t> nextSeq_{};
+	std::mutex logThreadLock_;
+	std::condition_variable logThreadCond_;
+	std::atomic<bool> logThreadSleeping_{};
+	bool logThreadStop_ = false;
+
 public:
 	void AddListener(LogListener *listener);
 	void RemoveListener(LogListener *listener);
@@ -184,6 +207,11 @@ class LogManager {
 
 	void ChangeFileLog(const char *filename);
 
+	void SetAsync(bool async);
+	bool IsAsync() const { return async_; }
+	// Waits until everything logged so far in async mode has reached the listeners.
+	void Flush();
+
 	void SaveConfig(Section *section);
 	void LoadConfig(Section *section, bool debugDefaults);
 };
@@ -66,7 +66,7 @@ typedef CONTEXT SContext;
 
 #endif
 
-#elif PPSSPP_PLATFORM(MAC)
+#elif PPSSPP_PLATFORM(MAC) || PPSSPP_PLATFORM(IOS)
 
 // for modules:
 #define _XOPEN_SOURCE
@@ -98,6 +98,16 @@ typedef x86_thread_state64_t SContext;
 #define CTX_R15 __r15
 #define CTX_RIP __rip
 
+#elif PPSSPP_ARCH(ARM64)
+
+#define MACHINE_CONTEXT_SUPPORTED
+
+typedef arm_thread_state64_t SContext;
+// Only x0-x28, the rest have names.
+#define CTX_REG(x) __x[x]
+#define CTX_SP __sp
+#define CTX_PC __pc
+
 #else
 
 // No context definition for architecture
@@ -6,6 +6,18 @@
 typedef std::pair<uint32_t, uint32_t> ExpressionPair;
 typedef std::vector<ExpressionPair> PostfixExpression;
 
+// Each ExpressionPair in a PostfixExpression is a command and its argument.
+// For EXCOMM_OP, the argument is an ExpressionOpcodeType.
+typedef enum {
+	EXOP_BRACKETL, EXOP_BRACKETR, EXOP_MEML, EXOP_MEMR, EXOP_MEMSIZE, EXOP_SIGNPLUS, EXOP_SIGNMINUS,
+	EXOP_BITNOT, EXOP_LOGNOT, EXOP_MUL, EXOP_DIV, EXOP_MOD, EXOP_ADD, EXOP_SUB,
+	EXOP_SHL, EXOP_SHR, EXOP_GREATEREQUAL, EXOP_GREATER, EXOP_LOWEREQUAL, EXOP_LOWER,
+	EXOP_EQUAL, EXOP_NOTEQUAL, EXOP_BITAND, EXOP_XOR, EXOP_BITOR, EXOP_LOGAND,
+	EXOP_LOGOR, EXOP_TERTIF, EXOP_TERTELSE, EXOP_NUMBER, EXOP_MEM, EXOP_NONE, EXOP_COUNT
+} ExpressionOpcodeType;
+
+typedef enum { EXCOMM_CONST, EXCOMM_CONST_FLOAT, EXCOMM_REF, EXCOMM_OP } ExpressionCommand;
+
 enum ExpressionType
 {
 	EXPR_TYPE_UINT = 0,
@@ -17,6 +17,7 @@
 
 #include "ppsspp_config.h"
 
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
 
@@ -36,12 +37,18 @@
 #ifdef __APPLE__
 #include <sys/types.h>
 #include <sys/mman.h>
+#include <mach/mach.h>
+#include <mach/vm_map.h>
 #include <mach/vm_param.h>
 #endif
 
 #ifndef _WIN32
 #include <unistd.h>
 #endif
+
+#if PPSSPP_PLATFORM(LINUX)
+#include <fcntl.h>
+#endif
 static int hint_location;
 #ifdef __APPLE__
 #define MEM_PAGE_SIZE (PAGE_SIZE)
@@ -205,6 +212,51 @@ void *AllocateExecutableMemory(size_t size) {
 	return ptr;
 }
 
+void *AllocateDualMappedExecutableMemory(size_t size, uint8_t **writable) {
+#if defined(__APPLE__) && PPSSPP_ARCH(ARM64)
+	size = ppsspp_round_page(size);
+	mach_port_t self = mach_task_self();
+	vm_address_t rw = 0;
+	if (vm_allocate(self, &rw, size, VM_FLAGS_ANYWHERE) != KERN_SUCCESS) {
+		ERROR_LOG(MEMMAP, "Failed to allocate dual mapped code memory (%d)", (int)size);
+		return nullptr;
+	}
+
+	vm_address_t rx = 0;
+	vm_prot_t cur_protection = 0;
+	vm_prot_t max_protection = 0;
+	kern_return_t retval = vm_remap(self, &rx, size, 0, VM_FLAGS_ANYWHERE, self, rw, false, &cur_protection, &max_protection, VM_INHERIT_NONE);
+	if (retval != KERN_SUCCESS) {
+		WARN_LOG(MEMMAP, "vm_remap failed (%d), can't dual map code memory", (int)retval);
+		vm_deallocate(self, rw, size);
+		return nullptr;
+	}
+
+	// This is where it fails without the entitlement to run generated code.
+	if (mprotect((void *)rx, size, PROT_READ | PROT_EXEC) != 0) {
+		WARN_LOG(MEMMAP, "Failed to make dual mapped code memory executable: errno=%d", errno);
+		vm_deallocate(self, rx, size);
+		vm_deallocate(self, rw, size);
+		return nullptr;
+	}
+
+	*writable = (uint8_t *)rw;
+	return (void *)rx;
+#else
+	return nullptr;
+#endif
+}
+
+void FreeDualMappedExecutableMemory(void *ptr, void *writable, size_t size) {
+#if defined(__APPLE__) && PPSSPP_ARCH(ARM64)
+	size = ppsspp_round_page(size);
+	if (ptr)
+		vm_deallocate(mach_task_self(), (vm_address_t)ptr, size);
+	if (writable)
+		vm_deallocate(mach_task_self(), (vm_address_t)writable, size);
+#endif
+}
+
 void *AllocateMemoryPages(size_t size, uint32_t memProtFlags) {
 	size = ppsspp_round_page(size);
 #ifdef _WIN32
@@ -342,3 +394,88 @@ int GetMemoryProtectPageSize() {
 #endif
 	return MEM_PAGE_SIZE;
 }
+
+#if PPSSPP_PLATFORM(LINUX)
+// Bit 55 of a /proc/self/pagemap entry.
+static const uint64_t PAGEMAP_SOFT_DIRTY = 1ULL << 55;
+
+static bool WriteClearRefs() {
+	int fd = open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+	// 4 clears the soft-dirty bits only.
+	bool success = write(fd, "4", 1) == 1;
+	close(fd);
+	return success;
+}
+
+static bool ReadPagemap(const void *ptr, size_t size, uint8_t *dirty) {
+	int fd = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+
+	const uintptr_t pageSize = MEM_PAGE_SIZE;
+	const size_t pages = (size + pageSize - 1) / pageSize;
+	off_t offset = (off_t)((uintptr_t)ptr / pageSize) * sizeof(uint64_t);
+	uint64_t entries[512];
+	bool success = true;
+	for (size_t i = 0; i < pages && success; ) {
+		size_t count = std::min(pages - i, ARRAY_SIZE(entries));
+		ssize_t bytes = pread(fd, entries, count * sizeof(uint64_t), offset);
+		if (bytes != (ssize_t)(count * sizeof(uint64_t))) {
+			success = false;
+			break;
+		}
+		for (size_t j = 0; j < count; ++j) {
+			if (entries[j] & PAGEMAP_SOFT_DIRTY)
+				dirty[i + j] = 1;
+		}
+		i += count;
+		offset += bytes;
+	}
+	close(fd);
+	return success;
+}
+#endif
+
+bool DirtyPageTrackingSupported() {
+#if PPSSPP_PLATFORM(LINUX)
+	static int supported = -1;
+	if (supported == -1) {
+		// Kernels without CONFIG_MEM_SOFT_DIRTY accept the reset but never set the bit, so try it.
+		supported = 0;
+		const size_t pageSize = MEM_PAGE_SIZE;
+		volatile uint8_t *page = (volatile uint8_t *)AllocateMemoryPages(pageSize, MEM_PROT_READ | MEM_PROT_WRITE);
+		if (page) {
+			page[0] = 1;
+			uint8_t before = 0, after = 0;
+			if (WriteClearRefs() && ReadPagemap((const void *)page, pageSize, &before)) {
+				page[0] = 2;
+				if (ReadPagemap((const void *)page, pageSize, &after) && before == 0 && after == 1)
+					supported = 1;
+			}
+			FreeMemoryPages((void *)page, pageSize);
+		}
+		INFO_LOG(COMMON, "Dirty page tracking %s", supported ? "available" : "not available");
+	}
+	return supported == 1;
+#else
+	return false;
+#endif
+}
+
+bool ResetDirtyPageTracking() {
+#if PPSSPP_PLATFORM(LINUX)
+	return DirtyPageTrackingSupported() && WriteClearRefs();
+#else
+	return false;
+#endif
+}
+
+bool GetDirtyPages(const void *ptr, size_t size, uint8_t *dirty) {
+#if PPSSPP_PLATFORM(LINUX)
+	return DirtyPageTrackingSupported() && ReadPagemap(ptr, size, dirty);
+#else
+	return false;
+#endif
+}
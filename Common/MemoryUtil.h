@@ -34,6 +34,10 @@ bool PlatformIsWXExclusive();
 // AllocateMemoryPages is simpler and more generic. Note that on W^X platforms, this will return executable but not writable
 // memory!
 void* AllocateExecutableMemory(size_t size);
+// Maps the same code memory twice: executable at the returned pointer, and writable at *writable.
+// Lets W^X platforms write code without changing protection. Returns nullptr if not possible here.
+void *AllocateDualMappedExecutableMemory(size_t size, uint8_t **writable);
+void FreeDualMappedExecutableMemory(void *ptr, void *writable, size_t size);
 void* AllocateMemoryPages(size_t size, uint32_t memProtFlags);
 // Note that on platforms returning PlatformIsWXExclusive, you cannot set a page to be both readable and writable at the same time.
 bool ProtectMemoryPages(const void* ptr, size_t size, uint32_t memProtFlags);
@@ -45,6 +49,14 @@ void FreeAlignedMemory(void* ptr);
 
 int GetMemoryProtectPageSize();
 
+// Kernel side tracking of which pages were written (Linux soft-dirty bits.)  This sees every
+// write, including from other threads and syscalls.  Resetting applies to the whole process.
+bool DirtyPageTrackingSupported();
+bool ResetDirtyPageTracking();
+// ORs 1 into dirty[i] for each page of [ptr, ptr + size) written since the last reset.
+// ptr must be page aligned.  Returns false if it couldn't tell, then assume everything was written.
+bool GetDirtyPages(const void *ptr, size_t size, uint8_t *dirty);
+
 template <typename T>
 class SimpleBuf {
 public:
@@ -21,6 +21,7 @@
 #include <io.h>
 #endif
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
@@ -313,7 +314,7 @@ int Client::SendRequestWithData(const char *method, const RequestParams &req, co
 		"Host: %s\r\n"
 		"User-Agent: %s\r\n"
 		"Accept: %s\r\n"
-		"Connection: close\r\n"
+		"Connection: %s\r\n"
 		"%s"
 		"\r\n";
 
@@ -322,6 +323,7 @@ int Client::SendRequestWithData(const char *method, const RequestParams &req, co
 		host_.c_str(),
 		userAgent_.c_str(),
 		req.acceptMime,
+		keepAlive_ ? "keep-alive" : "close",
 		otherHeaders ? otherHeaders : "");
 	buffer.Append(data);
 	bool flushed = buffer.FlushSocket(sock(), dataTimeout_, progress->cancelled);
@@ -334,21 +336,30 @@ int Client::SendRequestWithData(const char *method, const RequestParams &req, co
 int Client::ReadResponseHeaders(net::Buffer *readbuf, std::vector<std::string> &responseHeaders, RequestProgress *progress) {
 	// Snarf all the data we can into RAM. A little unsafe but hey.
 	static constexpr float CANCEL_INTERVAL = 0.25f;
-	bool ready = false;
 	double endTimeout = time_now_d() + dataTimeout_;
-	while (!ready) {
-		if (progress->cancelled && *progress->cancelled)
+	// With keep-alive, a pipelined response may already be buffered.
+	while (readbuf->OffsetToAfterNextEmptyLine() < 0) {
+		bool ready = false;
+		while (!ready) {
+			if (progress->cancelled && *progress->cancelled)
+				return -1;
+			ready = fd_util::WaitUntilReady(sock(), CANCEL_INTERVAL, false);
+			if (!ready && time_now_d() > endTimeout) {
+				ERROR_LOG(IO, "HTTP headers timed out");
+				return -1;
+			}
+		};
+
+		size_t before = readbuf->size();
+		if (readbuf->Read(sock(), 4096) < 0) {
+			ERROR_LOG(IO, "Failed to read HTTP headers :(");
 			return -1;
-		ready = fd_util::WaitUntilReady(sock(), CANCEL_INTERVAL, false);
-		if (!ready && time_now_d() > endTimeout) {
-			ERROR_LOG(IO, "HTTP headers timed out");
+		}
+		if (readbuf->size() == before) {
+			// Readable, but nothing to read means the connection was closed.
+			ERROR_LOG(IO, "Connection closed while reading HTTP headers");
 			return -1;
 		}
-	};
-	// Let's hope all the headers are available in a single packet...
-	if (readbuf->Read(sock(), 4096) < 0) {
-		ERROR_LOG(IO, "Failed to read HTTP headers :(");
-		return -1;
 	}
 
 	// Grab the first header line that contains the http code.
@@ -356,6 +367,9 @@ int Client::ReadResponseHeaders(net::Buffer *readbuf, std::vector<std::string> &
 	std::string line;
 	readbuf->TakeLineCRLF(&line);
 
+	// HTTP/1.1 keeps the connection open by default, 1.0 doesn't.
+	responseKeepsAlive_ = keepAlive_ && startsWith(line, "HTTP/1.1");
+
 	int code;
 	size_t code_pos = line.find(' ');
 	if (code_pos != line.npos) {
@@ -371,7 +385,7 @@ int Client::ReadResponseHeaders(net::Buffer *readbuf, std::vector<std::string> &
 
 	while (true) {
 		int sz = readbuf->TakeLineCRLF(&line);
-		if (!sz)
+		if (sz <= 0)
 			break;
 		responseHeaders.push_back(line);
 	}
@@ -381,6 +395,15 @@ int Client::ReadResponseHeaders(net::Buffer *readbuf, std::vector<std::string> &
 		return -1;
 	}
 
+	std::string connection;
+	if (keepAlive_ && GetHeaderValue(responseHeaders, "Connection", &connection)) {
+		std::transform(connection.begin(), connection.end(), connection.begin(), tolower);
+		if (connection.find("close") != connection.npos)
+			responseKeepsAlive_ = false;
+		else if (connection.find("keep-alive") != connection.npos)
+			responseKeepsAlive_ = true;
+	}
+
 	return code;
 }
 
@@ -422,6 +445,29 @@ int Client::ReadResponseEntity(net::Buffer *readbuf, const std::vector<std::stri
 		progress->progress = 0.1f;
 	}
 
+	if (keepAlive_ && contentLength && !chunked) {
+		// The connection stays open, so read exactly the entity and leave anything after it (pipelining.)
+		if (!readbuf->ReadAtLeastWithProgress(sock(), contentLength, &progress->progress, &progress->kBps, progress->cancelled))
+			return -1;
+		if (!output->IsVoid()) {
+			readbuf->Take(contentLength, output->Append(contentLength));
+		} else {
+			readbuf->Skip(contentLength);
+		}
+		if (gzip) {
+			std::string compressed, decompressed;
+			output->TakeAll(&compressed);
+			if (!decompress_string(compressed, &decompressed)) {
+				ERROR_LOG(IO, "Error decompressing using zlib");
+				progress->progress = 0.0f;
+				return -1;
+			}
+			output->Append(decompressed);
+		}
+		progress->progress = 1.0f;
+		return 0;
+	}
+
 	if (!contentLength) {
 		// No way to know how far along we are. Let's just not update the progress counter.
 		if (!readbuf->ReadAllWithProgress(sock(), contentLength, nullptr, &progress->kBps, progress->cancelled))
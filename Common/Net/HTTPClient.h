@@ -91,10 +91,22 @@ class Client : public net::Connection {
 		userAgent_ = value;
 	}
 
+	// Ask the server to keep the connection open, so several requests can be sent (and pipelined.)
+	// Responses must then have a Content-Length, and the same readbuf must be used for all of them.
+	void SetKeepAlive(bool keepAlive) {
+		keepAlive_ = keepAlive;
+	}
+	// Whether the server will keep the connection open after the last response read.
+	bool ResponseKeepsAlive() const {
+		return responseKeepsAlive_;
+	}
+
 protected:
 	std::string userAgent_;
 	const char *httpVersion_;
 	double dataTimeout_ = 900.0;
+	bool keepAlive_ = false;
+	bool responseKeepsAlive_ = false;
 };
 
 // Not particularly efficient, but hey - it's a background download, that's pretty cool :P
@@ -36,6 +36,8 @@ class RequestHeader {
 		UNSUPPORTED,
 	};
 	Method method = UNSUPPORTED;
+	// HTTP/1.1 or later, which keeps connections alive unless told otherwise.
+	bool http11 = false;
 	bool ok = false;
 	void ParseHeaders(net::InputSink *sink);
 	bool GetParamValue(const char *param_name, std::string *value) const;
@@ -13,6 +13,9 @@
 
 #else
 
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
 #include <sys/socket.h>       /*  socket definitions        */
 #include <sys/types.h>        /*  socket types              */
 #include <sys/wait.h>         /*  for waitpid()             */
@@ -31,6 +34,7 @@
 #include <algorithm>
 #include <functional>
 
+#include <cerrno>
 #include <cstdio>
 #include <cstdlib>
 #include <thread>
@@ -45,13 +49,27 @@
 
 
 void NewThreadExecutor::Run(std::function<void()> func) {
-	threads_.push_back(std::thread(func));
+	// Reap the connections that have closed, so a long running server doesn't pile up threads.
+	for (auto it = threads_.begin(); it != threads_.end(); ) {
+		if (*it->done) {
+			it->thread.join();
+			it = threads_.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	auto done = std::make_shared<std::atomic<bool>>(false);
+	threads_.push_back(Worker{ std::thread([func, done] {
+		func();
+		*done = true;
+	}), done });
 }
 
 NewThreadExecutor::~NewThreadExecutor() {
 	// If Run was ever called...
-	for (auto &thread : threads_)
-		thread.join();
+	for (auto &worker : threads_)
+		worker.thread.join();
 	threads_.clear();
 }
 
@@ -59,11 +77,24 @@ namespace http {
 
 // Note: charset here helps prevent XSS.
 const char *const DEFAULT_MIME_TYPE = "text/html; charset=utf-8";
+// How long a kept-alive connection may sit idle before we close it.
+static const double KEEP_ALIVE_TIMEOUT = 15.0;
+// Caps the requests per connection, so one client can't hold a thread forever.
+static const int KEEP_ALIVE_MAX_REQUESTS = 1000;
 
 Request::Request(int fd)
 	: fd_(fd) {
 	in_ = new net::InputSink(fd);
 	out_ = new net::OutputSink(fd);
+	ParseHeaders();
+}
+
+Request::Request(int fd, net::InputSink *in, net::OutputSink *out)
+	: in_(in), out_(out), fd_(fd), ownsConnection_(false) {
+	ParseHeaders();
+}
+
+void Request::ParseHeaders() {
 	header_.ParseHeaders(in_);
 
 	if (header_.ok) {
@@ -74,6 +105,9 @@ Request::Request(int fd)
 }
 
 Request::~Request() {
+	if (!ownsConnection_)
+		return;
+
 	Close();
 
 	if (!in_->Empty()) {
@@ -107,12 +141,19 @@ void Request::WriteHttpResponseHeader(const char *ver, int status, int64_t size,
 	default: statusStr = "OK"; break;
 	}
 
+	std::string connection;
+	header_.GetOther("connection", &connection);
+	bool clientKeepsAlive = header_.http11 ? strcasecmp(connection.c_str(), "close") != 0 : strcasecmp(connection.c_str(), "keep-alive") == 0;
+	bool websocket = mimeType && strcmp(mimeType, "websocket") == 0;
+	// We need the length to know where the response ends, and we don't read bodies the handler skipped.
+	keepAlive_ = clientKeepsAlive && !websocket && size >= 0 && header_.content_length <= 0 && !ownsConnection_;
+
 	net::OutputSink *buffer = Out();
 	buffer->Printf("HTTP/%s %03d %s\r\n", ver, status, statusStr);
 	buffer->Push("Server: PPSSPPServer v0.1\r\n");
-	if (!mimeType || strcmp(mimeType, "websocket") != 0) {
+	if (!websocket) {
 		buffer->Printf("Content-Type: %s\r\n", mimeType ? mimeType : DEFAULT_MIME_TYPE);
-		buffer->Push("Connection: close\r\n");
+		buffer->Push(keepAlive_ ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
 	}
 	if (size >= 0) {
 		buffer->Printf("Content-Length: %llu\r\n", size);
@@ -123,6 +164,55 @@ void Request::WriteHttpResponseHeader(const char *ver, int status, int64_t size,
 	buffer->Push("\r\n");
 }
 
+bool Request::WriteFileRange(FILE *fp, int64_t offset, int64_t length) const {
+	// If we stop partway, the client can't tell where the next response would start.
+	bool wasKeepAlive = keepAlive_;
+	keepAlive_ = false;
+	if (!out_->Flush())
+		return false;
+
+#if defined(__linux__)
+	// The kernel copies straight from the page cache to the socket.
+	off_t filePos = (off_t)offset;
+	int64_t left = length;
+	while (left > 0) {
+		ssize_t sent = sendfile(fd_, fileno(fp), &filePos, (size_t)std::min(left, (int64_t)0x40000000));
+		if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+			if (!fd_util::WaitUntilReady(fd_, 5.0, true))
+				return false;
+			continue;
+		}
+		if (sent <= 0)
+			break;
+		left -= sent;
+	}
+	if (left == 0) {
+		keepAlive_ = wasKeepAlive;
+		return true;
+	}
+	// Some files (like on some FUSE filesystems) can't be sent, fall back for the rest.
+	if (left != length)
+		return false;
+#endif
+
+	if (fseek(fp, offset, SEEK_SET) != 0)
+		return false;
+
+	const size_t CHUNK_SIZE = 64 * 1024;
+	std::unique_ptr<char[]> buf(new char[CHUNK_SIZE]);
+	for (int64_t pos = 0; pos < length; pos += CHUNK_SIZE) {
+		size_t chunklen = (size_t)std::min(length - pos, (int64_t)CHUNK_SIZE);
+		if (fread(buf.get(), chunklen, 1, fp) != 1)
+			return false;
+		if (!out_->Push(buf.get(), chunklen))
+			return false;
+	}
+	if (!out_->Flush())
+		return false;
+	keepAlive_ = wasKeepAlive;
+	return true;
+}
+
 void Request::WritePartial() const {
 	_assert_(fd_);
 	out_->Flush();
@@ -135,10 +225,10 @@ void Request::Write() {
 }
 
 void Request::Close() {
-	if (fd_) {
+	// A shared connection is closed by the server once the last request is done.
+	if (fd_ && ownsConnection_)
 		closesocket(fd_);
-		fd_ = 0;
-	}
+	fd_ = 0;
 }
 
 Server::Server(NewThreadExecutor *executor)
@@ -317,18 +407,37 @@ void Server::Stop() {
 }
 
 void Server::HandleConnection(int conn_fd) {
-	Request request(conn_fd);
-	if (!request.IsOK()) {
-		WARN_LOG(IO, "Bad request, ignoring.");
-		return;
+	// These are shared by all the requests on the connection, since a pipelining client
+	// may have sent the next request already, and it'll be sitting in the input buffer.
+	std::unique_ptr<net::InputSink> in(new net::InputSink(conn_fd));
+	std::unique_ptr<net::OutputSink> out(new net::OutputSink(conn_fd));
+
+	for (int count = 0; count < KEEP_ALIVE_MAX_REQUESTS; ++count) {
+		if (count != 0 && in->Empty()) {
+			// Wait for the next request, or for the client to close the connection.
+			if (!fd_util::WaitUntilReady(conn_fd, KEEP_ALIVE_TIMEOUT) || !in->TryFill())
+				break;
+		}
+
+		Request request(conn_fd, in.get(), out.get());
+		if (!request.IsOK()) {
+			if (count == 0)
+				WARN_LOG(IO, "Bad request, ignoring.");
+			break;
+		}
+		HandleRequest(request);
+
+		// TODO: Way to mark the content body as read, read it here if never read.
+		// This allows the handler to stream if need be.
+
+		if (!request.IsOK())
+			break;
+		request.WritePartial();
+		if (!request.KeepsAlive())
+			break;
 	}
-	HandleRequest(request);
-
-	// TODO: Way to mark the content body as read, read it here if never read.
-	// This allows the handler to stream if need be.
 
-	// TODO: Could handle keep alive here.
-	request.Write();
+	closesocket(conn_fd);
 }
 
 void Server::HandleRequest(const Request &request) {
@@ -1,19 +1,29 @@
 #pragma once
 
+#include <atomic>
+#include <cstdio>
 #include <functional>
 #include <map>
+#include <memory>
 #include <thread>
+#include <vector>
 
 #include "Common/Net/HTTPHeaders.h"
 #include "Common/Net/Resolve.h"
 
+// Runs each connection on its own thread, since they block on the network (and with keep-alive,
+// can stay open for a long time.) Threads that finished are joined on the next Run.
 class NewThreadExecutor {
 public:
 	~NewThreadExecutor();
 	void Run(std::function<void()> func);
 
 private:
-	std::vector<std::thread> threads_;
+	struct Worker {
+		std::thread thread;
+		std::shared_ptr<std::atomic<bool>> done;
+	};
+	std::vector<Worker> threads_;
 };
 
 namespace net {
@@ -25,6 +35,8 @@ class OutputSink;
 
 namespace http {
 
+class Server;
+
 class Request {
 public:
 	Request(int fd);
@@ -58,14 +70,28 @@ class Request {
 
 	bool IsOK() const { return fd_ > 0; }
 
-	// If size is negative, no Content-Length: line is written.
+	// If size is negative, no Content-Length: line is written, and the connection is closed after.
 	void WriteHttpResponseHeader(const char *ver, int status, int64_t size = -1, const char *mimeType = nullptr, const char *otherHeaders = nullptr) const;
+	// Sends length bytes of the file from offset as (part of) the body, after anything already written.
+	// Goes straight from the file to the socket where the OS supports it.
+	bool WriteFileRange(FILE *fp, int64_t offset, int64_t length) const;
+
+	// Whether the response allowed the client to send another request on the same connection.
+	bool KeepsAlive() const { return keepAlive_; }
 
 private:
+	friend class Server;
+	// For the requests of a kept-alive connection, which share the sinks and the socket.
+	Request(int fd, net::InputSink *in, net::OutputSink *out);
+	void ParseHeaders();
+
 	net::InputSink *in_;
 	net::OutputSink *out_;
 	RequestHeader header_;
 	int fd_;
+	bool ownsConnection_ = true;
+	// Set by WriteHttpResponseHeader.
+	mutable bool keepAlive_ = false;
 };
 
 // Register handlers on this class to serve stuff.
@@ -95,6 +95,50 @@ bool Buffer::ReadAllWithProgress(int fd, int knownSize, float *progress, float *
 	return true;
 }
 
+bool Buffer::ReadAtLeastWithProgress(int fd, size_t size, float *progress, float *kBps, bool *cancelled) {
+	static constexpr float CANCEL_INTERVAL = 0.25f;
+	std::vector<char> buf;
+	size_t startSize = data_.size();
+	size_t wanted = size > startSize ? size - startSize : 0;
+	buf.resize(std::max((size_t)1024, std::min(wanted, (size_t)65536)));
+
+	double st = time_now_d();
+	while (data_.size() < size) {
+		bool ready = false;
+		while (!ready && cancelled) {
+			if (*cancelled)
+				return false;
+			ready = fd_util::WaitUntilReady(fd, CANCEL_INTERVAL, false);
+		}
+		// Don't read past what we need, the rest may be the next pipelined response.
+		int toRead = (int)std::min(buf.size(), size - data_.size());
+		int retval = recv(fd, &buf[0], toRead, MSG_NOSIGNAL);
+		if (retval == 0) {
+			ERROR_LOG(IO, "Connection closed with %d bytes left to read", (int)(size - data_.size()));
+			return false;
+		} else if (retval < 0) {
+#if PPSSPP_PLATFORM(WINDOWS)
+			if (WSAGetLastError() != WSAEWOULDBLOCK) {
+#else
+			if (errno != EWOULDBLOCK) {
+#endif
+				ERROR_LOG(IO, "Error reading from buffer: %i", retval);
+				return false;
+			}
+
+			// Just try again on a would block error, not a real error.
+			continue;
+		}
+		char *p = Append((size_t)retval);
+		memcpy(p, &buf[0], retval);
+		if (progress && wanted != 0)
+			*progress = (float)(data_.size() - startSize) / (float)wanted;
+		if (kBps)
+			*kBps = (float)((data_.size() - startSize) / (time_now_d() - st)) / 1024.0f;
+	}
+	return true;
+}
+
 int Buffer::Read(int fd, size_t sz) {
 	char buf[1024];
 	int retval;
@@ -9,6 +9,9 @@ class Buffer : public ::Buffer {
 	bool FlushSocket(uintptr_t sock, double timeout, bool *cancelled = nullptr);
 
 	bool ReadAllWithProgress(int fd, int knownSize, float *progress, float *kBps, bool *cancelled);
+	// Like ReadAllWithProgress, but stops once the buffer holds size bytes (for keep-alive connections.)
+	// Fails if the connection closes first.
+	bool ReadAtLeastWithProgress(int fd, size_t size, float *progress, float *kBps, bool *cancelled);
 
 	// < 0: error
 	// >= 0: number of bytes read
@@ -0,0 +1,137 @@
+#include <cstdio>
+#include <mutex>
+
+#include "Common/Data/Format/JSONWriter.h"
+#include "Common/Profiler/FrameTimeline.h"
+#include "Common/TimeUtil.h"
+
+// A few seconds of frames. Must be a power of 2.
+#define MAX_TIMELINE_SPANS 512
+
+std::atomic<bool> g_frameTimelineEnabled;
+
+struct TimelineLane {
+	std::mutex lock;
+	FrameTimelineSpan spans[MAX_TIMELINE_SPANS];
+	uint32_t writePos = 0;
+	// Start of the span in progress, or 0.0.
+	double pendingStart = 0.0;
+};
+
+static TimelineLane lanes[(int)FrameTimelineLane::COUNT];
+
+static const char *const laneNames[] = {
+	"Emu",
+	"Flip",
+	"Render",
+	"GPU",
+	"Present",
+};
+
+static void AddSpan(TimelineLane &lane, double start, double end) {
+	lane.spans[lane.writePos & (MAX_TIMELINE_SPANS - 1)] = FrameTimelineSpan{ start, end };
+	lane.writePos++;
+}
+
+void FrameTimeline_SetEnabled(bool enabled) {
+	if (enabled == g_frameTimelineEnabled.load())
+		return;
+
+	// Start over, so a gap doesn't show up as one very long frame.
+	for (TimelineLane &lane : lanes) {
+		std::lock_guard<std::mutex> guard(lane.lock);
+		lane.writePos = 0;
+		lane.pendingStart = 0.0;
+	}
+	g_frameTimelineEnabled = enabled;
+}
+
+void FrameTimeline_Begin(FrameTimelineLane laneId) {
+	if (!FrameTimeline_IsEnabled())
+		return;
+	TimelineLane &lane = lanes[(int)laneId];
+	std::lock_guard<std::mutex> guard(lane.lock);
+	lane.pendingStart = time_now_d();
+}
+
+void FrameTimeline_End(FrameTimelineLane laneId) {
+	if (!FrameTimeline_IsEnabled())
+		return;
+	TimelineLane &lane = lanes[(int)laneId];
+	std::lock_guard<std::mutex> guard(lane.lock);
+	// Might've been enabled in the middle.
+	if (lane.pendingStart != 0.0)
+		AddSpan(lane, lane.pendingStart, time_now_d());
+	lane.pendingStart = 0.0;
+}
+
+void FrameTimeline_Mark(FrameTimelineLane laneId) {
+	if (!FrameTimeline_IsEnabled())
+		return;
+	TimelineLane &lane = lanes[(int)laneId];
+	std::lock_guard<std::mutex> guard(lane.lock);
+	double now = time_now_d();
+	AddSpan(lane, now, now);
+}
+
+const char *FrameTimeline_GetLaneName(FrameTimelineLane lane) {
+	return laneNames[(int)lane];
+}
+
+std::vector<FrameTimelineSpan> FrameTimeline_GetSpans(FrameTimelineLane laneId, double since) {
+	std::vector<FrameTimelineSpan> result;
+	TimelineLane &lane = lanes[(int)laneId];
+	std::lock_guard<std::mutex> guard(lane.lock);
+	uint32_t start = lane.writePos > MAX_TIMELINE_SPANS ? lane.writePos - MAX_TIMELINE_SPANS : 0;
+	for (uint32_t pos = start; pos < lane.writePos; ++pos) {
+		const FrameTimelineSpan &span = lane.spans[pos & (MAX_TIMELINE_SPANS - 1)];
+		if (span.end >= since)
+			result.push_back(span);
+	}
+	return result;
+}
+
+std::string FrameTimeline_ExportChromeTrace() {
+	json::JsonWriter writer;
+	writer.begin();
+	writer.writeString("displayTimeUnit", "ms");
+	writer.pushArray("traceEvents");
+
+	char ts[32];
+	for (int i = 0; i < (int)FrameTimelineLane::COUNT; ++i) {
+		std::vector<FrameTimelineSpan> spans = FrameTimeline_GetSpans((FrameTimelineLane)i, 0.0);
+
+		writer.pushDict();
+		writer.writeString("name", "thread_name");
+		writer.writeString("ph", "M");
+		writer.writeInt("pid", 1);
+		writer.writeInt("tid", i + 1);
+		writer.pushDict("args");
+		writer.writeString("name", laneNames[i]);
+		writer.pop();
+		writer.pop();
+
+		for (const FrameTimelineSpan &span : spans) {
+			writer.pushDict();
+			writer.writeString("name", laneNames[i]);
+			// Microseconds. writeFloat would print every digit of the double.
+			snprintf(ts, sizeof(ts), "%.3f", span.start * 1000000.0);
+			writer.writeRaw("ts", ts);
+			if (span.end == span.start) {
+				writer.writeString("ph", "i");
+				writer.writeString("s", "t");
+			} else {
+				writer.writeString("ph", "X");
+				snprintf(ts, sizeof(ts), "%.3f", (span.end - span.start) * 1000000.0);
+				writer.writeRaw("dur", ts);
+			}
+			writer.writeInt("pid", 1);
+			writer.writeInt("tid", i + 1);
+			writer.pop();
+		}
+	}
+
+	writer.pop();
+	writer.end();
+	return writer.str();
+}
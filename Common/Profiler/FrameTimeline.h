@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+// Records when each stage of recent frames ran, to see whether the emu thread, the render thread,
+// the GPU or present is holding things up. Always compiled in, but does nothing until enabled.
+
+enum class FrameTimelineLane {
+	// Emu thread, from the end of frame throttling to the next __DisplayFlip.
+	EMU,
+	// __DisplayFlip handing a frame over for display (instant.)
+	FLIP,
+	// Render thread executing and submitting a frame (or a part of one, on sync.)
+	RENDER,
+	// A frame's fence was seen signalled. This is when we noticed, not when the GPU finished (instant.)
+	GPU,
+	// The present or swap call.
+	PRESENT,
+
+	COUNT,
+};
+
+struct FrameTimelineSpan {
+	double start;
+	// Same as start for instant events.
+	double end;
+};
+
+extern std::atomic<bool> g_frameTimelineEnabled;
+
+inline bool FrameTimeline_IsEnabled() {
+	return g_frameTimelineEnabled.load(std::memory_order_relaxed);
+}
+void FrameTimeline_SetEnabled(bool enabled);
+
+void FrameTimeline_Begin(FrameTimelineLane lane);
+void FrameTimeline_End(FrameTimelineLane lane);
+void FrameTimeline_Mark(FrameTimelineLane lane);
+
+const char *FrameTimeline_GetLaneName(FrameTimelineLane lane);
+// Spans that ended at or after since (time_now_d() time), oldest first.
+std::vector<FrameTimelineSpan> FrameTimeline_GetSpans(FrameTimelineLane lane, double since);
+// Everything recorded, in the Chrome trace event format, with a "thread" per lane.
+std::string FrameTimeline_ExportChromeTrace();
@@ -0,0 +1,65 @@
+#include <atomic>
+
+#include "Common/Profiler/MemoryUsage.h"
+
+struct MemoryCounter {
+	std::atomic<int64_t> current;
+	std::atomic<int64_t> peak;
+};
+
+static MemoryCounter counters[(int)MemoryCategory::COUNT];
+
+static const char *const categoryNames[] = {
+	"Texture cache",
+	"Texture replacements",
+	"Vertex cache",
+	"Push buffers",
+	"Vulkan allocations",
+	"JIT code",
+	"Rewind states",
+	"Game info",
+};
+
+static void UpdatePeak(MemoryCounter &counter, int64_t value) {
+	int64_t peak = counter.peak.load(std::memory_order_relaxed);
+	while (value > peak && !counter.peak.compare_exchange_weak(peak, value, std::memory_order_relaxed)) {
+		// peak was reloaded, try again.
+	}
+}
+
+void MemoryUsage_Add(MemoryCategory cat, int64_t delta) {
+	MemoryCounter &counter = counters[(int)cat];
+	int64_t value = counter.current.fetch_add(delta, std::memory_order_relaxed) + delta;
+	UpdatePeak(counter, value);
+}
+
+void MemoryUsage_Set(MemoryCategory cat, int64_t bytes) {
+	MemoryCounter &counter = counters[(int)cat];
+	counter.current.store(bytes, std::memory_order_relaxed);
+	UpdatePeak(counter, bytes);
+}
+
+int64_t MemoryUsage_Get(MemoryCategory cat) {
+	return counters[(int)cat].current.load(std::memory_order_relaxed);
+}
+
+const char *MemoryUsage_GetName(MemoryCategory cat) {
+	return categoryNames[(int)cat];
+}
+
+std::vector<MemoryUsageStat> MemoryUsage_GetStats() {
+	std::vector<MemoryUsageStat> stats;
+	for (int i = 0; i < (int)MemoryCategory::COUNT; ++i) {
+		MemoryUsageStat stat;
+		stat.name = categoryNames[i];
+		stat.current = counters[i].current.load(std::memory_order_relaxed);
+		stat.peak = counters[i].peak.load(std::memory_order_relaxed);
+		stats.push_back(stat);
+	}
+	return stats;
+}
+
+void MemoryUsage_ResetPeaks() {
+	for (MemoryCounter &counter : counters)
+		counter.peak.store(counter.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
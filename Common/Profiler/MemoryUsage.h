@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Rough byte counts of the big caches and pools, to see what's eating memory on low-RAM devices.
+// Owners either adjust their count as they allocate and free, or set it periodically (usually per frame.)
+// Categories can overlap: the Vulkan vertex cache is also a push buffer, and everything on Vulkan is
+// part of the Vulkan allocations.
+
+enum class MemoryCategory {
+	TEXTURE_CACHE,
+	TEXTURE_REPLACEMENTS,
+	VERTEX_CACHE,
+	PUSH_BUFFERS,
+	VULKAN_ALLOCATIONS,
+	JIT_CODE,
+	REWIND_STATES,
+	GAME_INFO,
+
+	COUNT,
+};
+
+struct MemoryUsageStat {
+	const char *name;
+	int64_t current;
+	int64_t peak;
+};
+
+void MemoryUsage_Add(MemoryCategory cat, int64_t delta);
+void MemoryUsage_Set(MemoryCategory cat, int64_t bytes);
+int64_t MemoryUsage_Get(MemoryCategory cat);
+
+const char *MemoryUsage_GetName(MemoryCategory cat);
+// All categories, in enum order.
+std::vector<MemoryUsageStat> MemoryUsage_GetStats();
+// Sets each peak to the current value.
+void MemoryUsage_ResetPeaks();
@@ -11,6 +11,8 @@
 
 #include "Common/Render/DrawBuffer.h"
 
+#include "Common/Data/Format/JSONWriter.h"
+#include "Common/StringUtils.h"
 #include "Common/TimeUtil.h"
 #include "Common/Profiler/Profiler.h"
 #include "Common/Log.h"
@@ -24,6 +26,8 @@
 #define MAX_THREADS 4     // Can be any number, represents concurrent threads calling the profiler.
 #endif
 #define HISTORY_SIZE 128 // Must be power of 2
+#define TRACE_BUFFER_SIZE 16384  // Events kept per thread, must be power of 2.
+#define MAX_TRACE_THREADS 32      // Buffers are only reused past this many threads.
 
 #ifndef _DEBUG
 // If the compiler can collapse identical strings, we don't even need the strcmp.
@@ -264,3 +268,175 @@ void Profiler_GetHistory(int category, int thread, float *data, int count) {
 		data[i] = history[MAX_THREADS * x + thread].time_taken[category];
 	}
 }
+
+// Scope tracing. Each thread only writes to its own buffer, so recording is just a couple of stores.
+// Readers check the write position again after copying, and drop anything that may have been overwritten.
+
+struct TraceEvent {
+	const char *name;
+	double time;
+	bool begin;
+};
+
+struct TraceBuffer {
+	TraceEvent events[TRACE_BUFFER_SIZE];
+	std::atomic<uint32_t> writePos{};
+	std::atomic<uint32_t> clearPos{};
+	std::atomic<const char *> threadName{};
+	bool inUse = false;  // Protected by traceBuffersLock.
+	int threadId = 0;
+};
+
+std::atomic<bool> g_profilerTracing;
+static std::mutex traceBuffersLock;
+static std::vector<TraceBuffer *> traceBuffers;
+static double traceStartTime;
+
+struct TraceThreadState {
+	~TraceThreadState() {
+		// Let a later thread reuse the buffer. What's in it stays exportable until then.
+		if (buffer) {
+			std::lock_guard<std::mutex> guard(traceBuffersLock);
+			buffer->inUse = false;
+		}
+	}
+
+	TraceBuffer *buffer = nullptr;
+	const char *name = nullptr;
+};
+
+#if MAX_THREADS > 1
+static thread_local TraceThreadState traceThread;
+
+static TraceBuffer *internal_profiler_trace_buffer() {
+	TraceBuffer *buffer = traceThread.buffer;
+	if (buffer)
+		return buffer;
+
+	std::lock_guard<std::mutex> guard(traceBuffersLock);
+	if (traceBuffers.size() < MAX_TRACE_THREADS) {
+		buffer = new TraceBuffer();
+		buffer->threadId = (int)traceBuffers.size() + 1;
+		traceBuffers.push_back(buffer);
+	} else {
+		// Out of buffers, take over one from a thread that has exited.
+		for (TraceBuffer *b : traceBuffers) {
+			if (!b->inUse) {
+				buffer = b;
+				break;
+			}
+		}
+		if (!buffer)
+			return nullptr;
+	}
+	buffer->inUse = true;
+	// Don't mix up events from the thread that used this buffer before.
+	buffer->clearPos = buffer->writePos.load();
+	buffer->threadName = traceThread.name;
+	traceThread.buffer = buffer;
+	return buffer;
+}
+
+static void internal_profiler_trace_record(const char *name, bool begin) {
+	TraceBuffer *buffer = internal_profiler_trace_buffer();
+	if (!buffer)
+		return;
+	uint32_t pos = buffer->writePos.load(std::memory_order_relaxed);
+	TraceEvent &ev = buffer->events[pos & (TRACE_BUFFER_SIZE - 1)];
+	ev.name = name;
+	ev.time = time_now_d();
+	ev.begin = begin;
+	buffer->writePos.store(pos + 1, std::memory_order_release);
+}
+
+void internal_profiler_trace_begin(const char *name) {
+	internal_profiler_trace_record(name, true);
+}
+
+void internal_profiler_trace_end(const char *name) {
+	internal_profiler_trace_record(name, false);
+}
+
+void Profiler_SetThreadName(const char *name) {
+	traceThread.name = name;
+	if (traceThread.buffer)
+		traceThread.buffer->threadName = name;
+}
+
+void Profiler_SetTracing(bool enable) {
+	if (enable && traceStartTime == 0.0)
+		traceStartTime = time_now_d();
+	g_profilerTracing = enable;
+}
+#else
+// No thread_local, so tracing can't be turned on.
+void internal_profiler_trace_begin(const char *name) {}
+void internal_profiler_trace_end(const char *name) {}
+void Profiler_SetThreadName(const char *name) {}
+void Profiler_SetTracing(bool enable) {}
+#endif
+
+void Profiler_ClearTrace() {
+	std::lock_guard<std::mutex> guard(traceBuffersLock);
+	for (TraceBuffer *b : traceBuffers)
+		b->clearPos = b->writePos.load();
+}
+
+std::string Profiler_ExportChromeTrace() {
+	std::vector<TraceEvent> events;
+	json::JsonWriter writer;
+	writer.begin();
+	writer.writeString("displayTimeUnit", "ms");
+	writer.pushArray("traceEvents");
+
+	std::lock_guard<std::mutex> guard(traceBuffersLock);
+	for (TraceBuffer *b : traceBuffers) {
+		uint32_t end = b->writePos.load(std::memory_order_acquire);
+		uint32_t start = b->clearPos.load();
+		if (end - start > TRACE_BUFFER_SIZE)
+			start = end - TRACE_BUFFER_SIZE;
+
+		events.clear();
+		for (uint32_t pos = start; pos != end; ++pos)
+			events.push_back(b->events[pos & (TRACE_BUFFER_SIZE - 1)]);
+
+		// The thread may have kept going while we copied, skip what it overwrote.
+		uint32_t after = b->writePos.load(std::memory_order_acquire);
+		size_t skip = after - start > TRACE_BUFFER_SIZE ? std::min((size_t)(after - start - TRACE_BUFFER_SIZE), events.size()) : 0;
+
+		const char *threadName = b->threadName.load();
+		writer.pushDict();
+		writer.writeString("name", "thread_name");
+		writer.writeString("ph", "M");
+		writer.writeInt("pid", 1);
+		writer.writeInt("tid", b->threadId);
+		writer.pushDict("args");
+		writer.writeString("name", threadName ? threadName : StringFromFormat("Thread %d", b->threadId));
+		writer.pop();
+		writer.pop();
+
+		// An end without its begin (lost to wraparound) would confuse the viewers.
+		int depth = 0;
+		char ts[32];
+		for (size_t i = skip; i < events.size(); ++i) {
+			const TraceEvent &ev = events[i];
+			if (!ev.begin && depth == 0)
+				continue;
+			depth += ev.begin ? 1 : -1;
+
+			writer.pushDict();
+			writer.writeString("name", ev.name);
+			writer.writeString("ph", ev.begin ? "B" : "E");
+			// Microseconds. writeFloat would print every digit of the double.
+			snprintf(ts, sizeof(ts), "%.3f", (ev.time - traceStartTime) * 1000000.0);
+			writer.writeRaw("ts", ts);
+			writer.writeInt("pid", 1);
+			writer.writeInt("tid", b->threadId);
+			writer.pop();
+		}
+	}
+
+	writer.pop();
+	writer.end();
+	return writer.str();
+}
@@ -1,9 +1,46 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <string>
 
 // #define USE_PROFILER
 
+// Scope tracing is always compiled in, but does nothing but check a flag until turned on at runtime.
+// Each thread records begin/end events into its own ring buffer, which can then be exported
+// as Chrome trace / Perfetto JSON.
+extern std::atomic<bool> g_profilerTracing;
+
+void internal_profiler_trace_begin(const char *name);
+void internal_profiler_trace_end(const char *name);
+
+// Names must be string literals or otherwise live until the end of the process.
+void Profiler_SetThreadName(const char *name);
+
+void Profiler_SetTracing(bool enable);
+inline bool Profiler_IsTracing() {
+	return g_profilerTracing.load(std::memory_order_relaxed);
+}
+// Forgets everything recorded so far. Tracing stays on if it was on.
+void Profiler_ClearTrace();
+// Returns the most recent events of all threads in the Chrome trace event format.
+std::string Profiler_ExportChromeTrace();
+
+class ProfileTraceScope {
+public:
+	ProfileTraceScope(const char *name) : name_(Profiler_IsTracing() ? name : nullptr) {
+		if (name_)
+			internal_profiler_trace_begin(name_);
+	}
+	~ProfileTraceScope() {
+		// If tracing was turned on in the middle, we don't record a lone end.
+		if (name_)
+			internal_profiler_trace_end(name_);
+	}
+private:
+	const char *name_;
+};
+
 #ifdef USE_PROFILER
 
 class DrawBuffer;
@@ -24,13 +61,14 @@ void Profiler_GetHistory(int category, int thread, float *data, int count);
 
 class ProfileThis {
 public:
-	ProfileThis(const char *category) {
+	ProfileThis(const char *category) : trace_(category) {
 		cat_ = internal_profiler_enter(category, &thread_);
 	}
 	~ProfileThis() {
 		internal_profiler_leave(thread_, cat_);
 	}
 private:
+	ProfileTraceScope trace_;
 	int cat_;
 	int thread_;
 };
@@ -42,7 +80,7 @@ class ProfileThis {
 #else
 
 #define PROFILE_INIT()
-#define PROFILE_THIS_SCOPE(cat)
+#define PROFILE_THIS_SCOPE(cat) ProfileTraceScope _profile_scoped(cat);
 #define PROFILE_END_FRAME()
 
 #endif
@@ -1,5 +1,8 @@
 #include "ppsspp_config.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "Common/System/Display.h"
 #include "Common/GPU/thin3d.h"
 #include "Common/Data/Hash/Hash.h"
@@ -17,6 +20,185 @@ TextDrawer::TextDrawer(Draw::DrawContext *draw) : draw_(draw) {
 	dpiScale_ = CalculateDPIScale();
 }
 TextDrawer::~TextDrawer() {
+	ClearAtlas();
+}
+
+enum {
+	ATLAS_PAGE_SIZE = 1024,
+	ATLAS_MAX_PAGES = 4,
+	// Bigger strings get their own texture, they'd waste too much of a shelf.
+	ATLAS_MAX_STRING_WIDTH = 512,
+	ATLAS_MAX_STRING_HEIGHT = 128,
+	// Transparent texels around each string, so linear filtering doesn't pick up neighbors.
+	ATLAS_BORDER = 1,
+};
+
+// Transparent white, so filtering at the edges doesn't darken the text.
+static uint32_t AtlasBorderValue(Draw::DataFormat format) {
+	switch (format) {
+	case Draw::DataFormat::A4R4G4B4_UNORM_PACK16: return 0x0FFF;
+	case Draw::DataFormat::R4G4B4A4_UNORM_PACK16:
+	case Draw::DataFormat::B4G4R4A4_UNORM_PACK16: return 0xFFF0;
+	case Draw::DataFormat::R8G8B8A8_UNORM: return 0x00FFFFFF;
+	default: return 0;
+	}
+}
+
+void TextDrawer::CreateEntryTexture(TextStringEntry &entry, Draw::DataFormat texFormat, const std::vector<uint8_t> &bitmapData) {
+	entry.texture = nullptr;
+	entry.atlasPage = -1;
+	if (AllocateInAtlas(entry, texFormat, bitmapData))
+		return;
+
+	Draw::TextureDesc desc{};
+	desc.type = Draw::TextureType::LINEAR2D;
+	desc.format = texFormat;
+	desc.width = entry.bmWidth;
+	desc.height = entry.bmHeight;
+	desc.depth = 1;
+	desc.mipLevels = 1;
+	desc.tag = "TextDrawer";
+	desc.initData.push_back(&bitmapData[0]);
+	entry.texture = draw_->CreateTexture(desc);
+}
+
+void TextDrawer::ReleaseEntryTexture(TextStringEntry &entry) {
+	if (entry.atlasPage >= 0) {
+		// The page itself is owned by the atlas.
+		if (entry.atlasPage < (int)atlasPages_.size())
+			FreeInPage(atlasPages_[entry.atlasPage], entry.atlasY);
+		entry.atlasPage = -1;
+	} else if (entry.texture) {
+		entry.texture->Release();
+	}
+	entry.texture = nullptr;
+}
+
+void TextDrawer::DrawEntry(DrawBuffer &target, const TextStringEntry &entry, int w, int h, float x1, float y1, float x2, float y2, uint32_t color) {
+	if (!entry.texture)
+		return;
+	draw_->BindTexture(0, entry.texture);
+
+	float u1 = 0.0f, v1 = 0.0f;
+	float u2 = w / (float)entry.bmWidth;
+	float v2 = h / (float)entry.bmHeight;
+	if (entry.atlasPage >= 0) {
+		u1 = entry.atlasX / (float)ATLAS_PAGE_SIZE;
+		v1 = entry.atlasY / (float)ATLAS_PAGE_SIZE;
+		u2 = (entry.atlasX + w) / (float)ATLAS_PAGE_SIZE;
+		v2 = (entry.atlasY + h) / (float)ATLAS_PAGE_SIZE;
+	}
+	target.DrawTexRect(x1, y1, x2, y2, u1, v1, u2, v2, color);
+	target.Flush(true);
+}
+
+void TextDrawer::ClearAtlas() {
+	for (AtlasPage &page : atlasPages_) {
+		if (page.texture)
+			page.texture->Release();
+	}
+	atlasPages_.clear();
+}
+
+bool TextDrawer::AllocateInPage(AtlasPage &page, int w, int h, int *x, int *y) {
+	// Best fit among the shelves that are tall enough, but not wastefully so.
+	AtlasShelf *best = nullptr;
+	for (AtlasShelf &shelf : page.shelves) {
+		if (shelf.height < h || shelf.height > h + h / 2 + 2 || shelf.x + w > ATLAS_PAGE_SIZE)
+			continue;
+		if (!best || shelf.height < best->height)
+			best = &shelf;
+	}
+	if (!best) {
+		if (page.nextShelfY + h > ATLAS_PAGE_SIZE)
+			return false;
+		page.shelves.push_back(AtlasShelf{ page.nextShelfY, h, 0, 0 });
+		page.nextShelfY += h;
+		best = &page.shelves.back();
+	}
+
+	*x = best->x;
+	*y = best->y;
+	best->x += w;
+	best->count++;
+	return true;
+}
+
+void TextDrawer::FreeInPage(AtlasPage &page, int y) {
+	for (AtlasShelf &shelf : page.shelves) {
+		if (y >= shelf.y && y < shelf.y + shelf.height) {
+			if (--shelf.count == 0)
+				shelf.x = 0;
+			break;
+		}
+	}
+}
+
+bool TextDrawer::AllocateInAtlas(TextStringEntry &entry, Draw::DataFormat texFormat, const std::vector<uint8_t> &bitmapData) {
+	if (atlasUnsupported_ || entry.bmWidth > ATLAS_MAX_STRING_WIDTH || entry.bmHeight > ATLAS_MAX_STRING_HEIGHT)
+		return false;
+
+	const int w = entry.bmWidth + ATLAS_BORDER * 2;
+	const int h = entry.bmHeight + ATLAS_BORDER * 2;
+	int page = -1, x = 0, y = 0;
+	for (int i = 0; i < (int)atlasPages_.size(); ++i) {
+		if (atlasPages_[i].format == texFormat && AllocateInPage(atlasPages_[i], w, h, &x, &y)) {
+			page = i;
+			break;
+		}
+	}
+
+	const size_t pixelSize = DataFormatSizeInBytes(texFormat);
+	if (page == -1) {
+		if (atlasPages_.size() >= ATLAS_MAX_PAGES)
+			return false;
+
+		// Start out fully transparent, the unused parts are never sampled anyway.
+		std::vector<uint8_t> zeroes(ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * pixelSize);
+		Draw::TextureDesc desc{};
+		desc.type = Draw::TextureType::LINEAR2D;
+		desc.format = texFormat;
+		desc.width = ATLAS_PAGE_SIZE;
+		desc.height = ATLAS_PAGE_SIZE;
+		desc.depth = 1;
+		desc.mipLevels = 1;
+		desc.tag = "TextDrawerAtlas";
+		desc.initData.push_back(&zeroes[0]);
+		Draw::Texture *texture = draw_->CreateTexture(desc);
+		if (!texture)
+			return false;
+
+		atlasPages_.push_back(AtlasPage{ texture, texFormat, {}, 0 });
+		page = (int)atlasPages_.size() - 1;
+		AllocateInPage(atlasPages_.back(), w, h, &x, &y);
+	}
+
+	// Add the border around the bitmap.
+	std::vector<uint8_t> data(w * h * pixelSize);
+	const uint32_t border = AtlasBorderValue(texFormat);
+	for (size_t i = 0; i < data.size(); i += pixelSize)
+		memcpy(&data[i], &border, pixelSize);
+	const size_t srcStride = entry.bmWidth * pixelSize;
+	for (int row = 0; row < entry.bmHeight; ++row)
+		memcpy(&data[((row + ATLAS_BORDER) * w + ATLAS_BORDER) * pixelSize], &bitmapData[row * srcStride], srcStride);
+
+	AtlasPage &atlasPage = atlasPages_[page];
+	if (!draw_->UpdateTextureRect(atlasPage.texture, x, y, w, h, &data[0])) {
+		FreeInPage(atlasPage, y);
+		// If it never worked, the backend can't do it, so stick to individual textures.
+		if (!atlasWorks_) {
+			atlasUnsupported_ = true;
+			ClearAtlas();
+		}
+		return false;
+	}
+	atlasWorks_ = true;
+
+	entry.texture = atlasPage.texture;
+	entry.atlasPage = page;
+	entry.atlasX = x + ATLAS_BORDER;
+	entry.atlasY = y + ATLAS_BORDER;
+	return true;
 }
 
 float TextDrawerWordWrapper::MeasureWidth(const char *str, size_t bytes) {
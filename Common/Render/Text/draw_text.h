@@ -3,8 +3,8 @@
 // Uses system fonts to draw text. 
 // Platform support will be added over time, initially just Win32.
 
-// Caches strings in individual textures. Might later combine them into a big one
-// with dynamically allocated space but too much trouble for now.
+// Caches strings as bitmaps, packed into shared atlas textures when the backend can update
+// textures (see DrawContext::UpdateTextureRect), otherwise in individual textures.
 
 #pragma once
 
@@ -12,6 +12,7 @@
 
 #include <memory>
 #include <cstdint>
+#include <vector>
 
 #include "Common/Data/Text/WrapText.h"
 #include "Common/Render/DrawBuffer.h"
@@ -28,6 +29,10 @@ struct TextStringEntry {
 	int bmWidth;
 	int bmHeight;
 	int lastUsedFrame;
+	// If >= 0, texture is this atlas page, and the bitmap is at atlasX, atlasY.
+	int atlasPage = -1;
+	int atlasX = 0;
+	int atlasY = 0;
 };
 
 struct TextMeasureEntry {
@@ -69,6 +74,16 @@ class TextDrawer {
 	virtual void ClearCache() = 0;
 	void WrapString(std::string &out, const char *str, float maxWidth, int flags);
 
+	// Makes the texture of a new string from its bitmap. Strings that fit go into a shared atlas,
+	// so scrolling through lists doesn't keep creating and destroying textures.
+	void CreateEntryTexture(TextStringEntry &entry, Draw::DataFormat texFormat, const std::vector<uint8_t> &bitmapData);
+	// Frees the texture, or the atlas space, of a string.
+	void ReleaseEntryTexture(TextStringEntry &entry);
+	// Draws the top left w x h texels of the string's bitmap to the rectangle.
+	void DrawEntry(DrawBuffer &target, const TextStringEntry &entry, int w, int h, float x1, float y1, float x2, float y2, uint32_t color);
+	// Call after releasing all strings.
+	void ClearAtlas();
+
 	struct CacheKey {
 		bool operator < (const CacheKey &other) const {
 			if (fontHash < other.fontHash)
@@ -86,6 +101,29 @@ class TextDrawer {
 	float fontScaleY_ = 1.0f;
 	float dpiScale_ = 1.0f;
 	bool ignoreGlobalDpi_ = false;
+
+private:
+	struct AtlasShelf {
+		int y;
+		int height;
+		// Next free position. Freed space is only reused once the whole shelf is empty.
+		int x;
+		int count;
+	};
+	struct AtlasPage {
+		Draw::Texture *texture;
+		Draw::DataFormat format;
+		std::vector<AtlasShelf> shelves;
+		int nextShelfY;
+	};
+
+	bool AllocateInAtlas(TextStringEntry &entry, Draw::DataFormat texFormat, const std::vector<uint8_t> &bitmapData);
+	bool AllocateInPage(AtlasPage &page, int w, int h, int *x, int *y);
+	void FreeInPage(AtlasPage &page, int y);
+
+	std::vector<AtlasPage> atlasPages_;
+	bool atlasUnsupported_ = false;
+	bool atlasWorks_ = false;
 };
 
 class TextDrawerWordWrapper : public WordWrapper {
@@ -242,43 +242,25 @@ void TextDrawerAndroid::DrawString(DrawBuffer &target, const char *str, float x,
 
 		entry = new TextStringEntry();
 
-		TextureDesc desc{};
 		std::vector<uint8_t> bitmapData;
 		DrawStringBitmap(bitmapData, *entry, texFormat, text.c_str(), align);
-		desc.initData.push_back(&bitmapData[0]);
-
-		desc.type = TextureType::LINEAR2D;
-		desc.format = texFormat;
-		desc.width = entry->bmWidth;
-		desc.height = entry->bmHeight;
-		desc.depth = 1;
-		desc.mipLevels = 1;
-		desc.generateMips = false;
-		desc.tag = "TextDrawer";
-		entry->texture = draw_->CreateTexture(desc);
+		CreateEntryTexture(*entry, texFormat, bitmapData);
 		cache_[key] = std::unique_ptr<TextStringEntry>(entry);
 	}
 
-	if (entry->texture) {
-		draw_->BindTexture(0, entry->texture);
-	}
-
 	float w = entry->bmWidth * fontScaleX_ * dpiScale_;
 	float h = entry->bmHeight * fontScaleY_ * dpiScale_;
 	DrawBuffer::DoAlign(align, &x, &y, &w, &h);
-	if (entry->texture) {
-		target.DrawTexRect(x, y, x + w, y + h, 0.0f, 0.0f, 1.0f, 1.0f, color);
-		target.Flush(true);
-	}
+	DrawEntry(target, *entry, entry->bmWidth, entry->bmHeight, x, y, x + w, y + h, color);
 }
 
 void TextDrawerAndroid::ClearCache() {
 	for (auto &iter : cache_) {
-		if (iter.second->texture)
-			iter.second->texture->Release();
+		ReleaseEntryTexture(*iter.second);
 	}
 	cache_.clear();
 	sizeCache_.clear();
+	ClearAtlas();
 }
 
 void TextDrawerAndroid::OncePerFrame() {
@@ -297,8 +279,7 @@ void TextDrawerAndroid::OncePerFrame() {
 	if (frameCount_ % 23 == 0) {
 		for (auto iter = cache_.begin(); iter != cache_.end();) {
 			if (frameCount_ - iter->second->lastUsedFrame > 100) {
-				if (iter->second->texture)
-					iter->second->texture->Release();
+				ReleaseEntryTexture(*iter->second);
 				cache_.erase(iter++);
 			} else {
 				iter++;
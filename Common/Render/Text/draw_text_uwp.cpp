@@ -464,36 +464,16 @@ void TextDrawerUWP::DrawString(DrawBuffer &target, const char *str, float x, flo
 
 		// Convert the bitmap to a Thin3D compatible array of 16-bit pixels. Can't use a single channel format
 		// because we need white. Well, we could using swizzle, but not all our backends support that.
-		TextureDesc desc{};
 		std::vector<uint8_t> bitmapData;
 		DrawStringBitmap(bitmapData, *entry, texFormat, str, align);
-		desc.initData.push_back(&bitmapData[0]);
-
-		desc.type = TextureType::LINEAR2D;
-		desc.format = texFormat;
-		desc.width = entry->bmWidth;
-		desc.height = entry->bmHeight;
-		desc.depth = 1;
-		desc.mipLevels = 1;
-		desc.tag = "TextDrawer";
-		entry->texture = draw_->CreateTexture(desc);
+		CreateEntryTexture(*entry, texFormat, bitmapData);
 		cache_[key] = std::unique_ptr<TextStringEntry>(entry);
 	}
 
-	if (entry->texture) {
-		draw_->BindTexture(0, entry->texture);
-	}
-
-	// Okay, the texture is bound, let's draw.
 	float w = entry->width * fontScaleX_ * dpiScale_;
 	float h = entry->height * fontScaleY_ * dpiScale_;
-	float u = entry->width / (float)entry->bmWidth;
-	float v = entry->height / (float)entry->bmHeight;
 	DrawBuffer::DoAlign(align, &x, &y, &w, &h);
-	if (entry->texture) {
-		target.DrawTexRect(x, y, x + w, y + h, 0.0f, 0.0f, u, v, color);
-		target.Flush(true);
-	}
+	DrawEntry(target, *entry, entry->width, entry->height, x, y, x + w, y + h, color);
 }
 
 void TextDrawerUWP::RecreateFonts() {
@@ -505,11 +485,11 @@ void TextDrawerUWP::RecreateFonts() {
 
 void TextDrawerUWP::ClearCache() {
 	for (auto &iter : cache_) {
-		if (iter.second->texture)
-			iter.second->texture->Release();
+		ReleaseEntryTexture(*iter.second);
 	}
 	cache_.clear();
 	sizeCache_.clear();
+	ClearAtlas();
 }
 
 void TextDrawerUWP::OncePerFrame() {
@@ -526,8 +506,7 @@ void TextDrawerUWP::OncePerFrame() {
 	if (frameCount_ % 23 == 0) {
 		for (auto iter = cache_.begin(); iter != cache_.end();) {
 			if (frameCount_ - iter->second->lastUsedFrame > 100) {
-				if (iter->second->texture)
-					iter->second->texture->Release();
+				ReleaseEntryTexture(*iter->second);
 				cache_.erase(iter++);
 			} else {
 				iter++;
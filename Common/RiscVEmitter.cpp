@@ -0,0 +1,413 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+
+#include <cstring>
+
+#include "Common/CommonTypes.h"
+#include "Common/Log.h"
+#include "Common/MemoryUtil.h"
+#include "Common/RiscVEmitter.h"
+
+namespace RiscVGen {
+
+enum Opcode32 {
+	LOAD = 0x03,
+	LOAD_FP = 0x07,
+	MISC_MEM = 0x0F,
+	OP_IMM = 0x13,
+	AUIPC_OP = 0x17,
+	OP_IMM_32 = 0x1B,
+	STORE = 0x23,
+	STORE_FP = 0x27,
+	OP = 0x33,
+	LUI_OP = 0x37,
+	OP_32 = 0x3B,
+	OP_FP = 0x53,
+	BRANCH = 0x63,
+	JALR_OP = 0x67,
+	JAL_OP = 0x6F,
+	SYSTEM = 0x73,
+};
+
+static inline u32 EncodeReg(RiscVReg reg) {
+	_dbg_assert_msg_(reg != INVALID_REG, "Invalid register");
+	return (u32)reg & 0x1F;
+}
+
+static inline bool FitsSigned(s64 value, int bits) {
+	s64 limit = (s64)1 << (bits - 1);
+	return value >= -limit && value < limit;
+}
+
+static inline u32 EncodeI(u32 opcode, RiscVReg rd, u32 funct3, RiscVReg rs1, s32 simm12) {
+	_assert_msg_(FitsSigned(simm12, 12), "I-type immediate out of range: %d", simm12);
+	return ((u32)simm12 << 20) | (EncodeReg(rs1) << 15) | (funct3 << 12) | (EncodeReg(rd) << 7) | opcode;
+}
+
+static inline u32 EncodeS(u32 opcode, u32 funct3, RiscVReg rs1, RiscVReg rs2, s32 simm12) {
+	_assert_msg_(FitsSigned(simm12, 12), "S-type immediate out of range: %d", simm12);
+	u32 imm = (u32)simm12;
+	return (((imm >> 5) & 0x7F) << 25) | (EncodeReg(rs2) << 20) | (EncodeReg(rs1) << 15) | (funct3 << 12) | ((imm & 0x1F) << 7) | opcode;
+}
+
+static inline u32 EncodeR(u32 opcode, RiscVReg rd, u32 funct3, RiscVReg rs1, RiscVReg rs2, u32 funct7) {
+	return (funct7 << 25) | (EncodeReg(rs2) << 20) | (EncodeReg(rs1) << 15) | (funct3 << 12) | (EncodeReg(rd) << 7) | opcode;
+}
+
+static inline u32 EncodeB(u32 funct3, RiscVReg rs1, RiscVReg rs2, s64 offset) {
+	_assert_msg_(FitsSigned(offset, 13) && (offset & 1) == 0, "Branch offset out of range: %lld", (long long)offset);
+	u32 imm = (u32)offset;
+	return (((imm >> 12) & 1) << 31) | (((imm >> 5) & 0x3F) << 25) | (EncodeReg(rs2) << 20) | (EncodeReg(rs1) << 15) | (funct3 << 12) | (((imm >> 1) & 0xF) << 8) | (((imm >> 11) & 1) << 7) | BRANCH;
+}
+
+static inline u32 EncodeJ(RiscVReg rd, s64 offset) {
+	_assert_msg_(FitsSigned(offset, 21) && (offset & 1) == 0, "Jump offset out of range: %lld", (long long)offset);
+	u32 imm = (u32)offset;
+	return (((imm >> 20) & 1) << 31) | (((imm >> 1) & 0x3FF) << 21) | (((imm >> 11) & 1) << 20) | (((imm >> 12) & 0xFF) << 12) | (EncodeReg(rd) << 7) | JAL_OP;
+}
+
+static inline u32 FloatFormat(int bits) {
+	_assert_msg_(bits == 32 || bits == 64, "Unsupported float size %d", bits);
+	return bits == 64 ? 1 : 0;
+}
+
+RiscVEmitter::RiscVEmitter(const u8 *codePtr, u8 *writablePtr) {
+	SetCodePointer(codePtr, writablePtr);
+}
+
+void RiscVEmitter::SetCodePointer(const u8 *ptr, u8 *writePtr) {
+	m_code = ptr;
+	m_writable = writePtr;
+	m_lastCacheFlushEnd = ptr;
+}
+
+const u8 *RiscVEmitter::GetCodePointer() const {
+	return m_code;
+}
+
+u8 *RiscVEmitter::GetWritableCodePtr() {
+	return m_writable;
+}
+
+void RiscVEmitter::ReserveCodeSpace(u32 bytes) {
+	for (u32 i = 0; i < bytes / 4; i++)
+		EBREAK();
+}
+
+const u8 *RiscVEmitter::AlignCode16() {
+	int c = int((u64)m_code & 15);
+	if (c)
+		ReserveCodeSpace(16 - c);
+	return m_code;
+}
+
+const u8 *RiscVEmitter::AlignCodePage() {
+	int page_size = GetMemoryProtectPageSize();
+	int c = int((u64)m_code & (page_size - 1));
+	if (c)
+		ReserveCodeSpace(page_size - c);
+	return m_code;
+}
+
+void RiscVEmitter::FlushIcache() {
+	FlushIcacheSection(m_lastCacheFlushEnd, m_code);
+	m_lastCacheFlushEnd = m_code;
+}
+
+void RiscVEmitter::FlushIcacheSection(const u8 *start, const u8 *end) {
+#if PPSSPP_ARCH(RISCV64)
+	// This is a syscall on Linux, which takes care of the other harts too (FENCE.I only covers this one.)
+	__builtin___clear_cache((char *)start, (char *)end);
+#endif
+}
+
+void RiscVEmitter::SetJumpTarget(const FixupBranch &branch) {
+	s64 offset = (s64)(m_code - branch.ptr);
+	u8 *writable = (u8 *)branch.ptr + (m_writable - m_code);
+
+	u32 inst;
+	memcpy(&inst, writable, sizeof(inst));
+	switch (branch.type) {
+	case FixupBranchType::B:
+		// Keep funct3, rs1, and rs2.
+		inst = EncodeB((inst >> 12) & 7, (RiscVReg)((inst >> 15) & 0x1F), (RiscVReg)((inst >> 20) & 0x1F), offset);
+		break;
+	case FixupBranchType::J:
+		inst = EncodeJ((RiscVReg)((inst >> 7) & 0x1F), offset);
+		break;
+	}
+	memcpy(writable, &inst, sizeof(inst));
+}
+
+bool RiscVEmitter::BInRange(const void *func) const {
+	return FitsSigned((s64)((const u8 *)func - m_code), 13);
+}
+
+bool RiscVEmitter::JInRange(const void *func) const {
+	return FitsSigned((s64)((const u8 *)func - m_code), 21);
+}
+
+void RiscVEmitter::LUI(RiscVReg rd, s32 simm32) {
+	_assert_msg_((simm32 & 0xFFF) == 0, "LUI immediate has low bits set: %08x", simm32);
+	Write32((u32)simm32 | (EncodeReg(rd) << 7) | LUI_OP);
+}
+
+void RiscVEmitter::AUIPC(RiscVReg rd, s32 simm32) {
+	_assert_msg_((simm32 & 0xFFF) == 0, "AUIPC immediate has low bits set: %08x", simm32);
+	Write32((u32)simm32 | (EncodeReg(rd) << 7) | AUIPC_OP);
+}
+
+void RiscVEmitter::JAL(RiscVReg rd, const void *dst) {
+	Write32(EncodeJ(rd, (s64)((const u8 *)dst - m_code)));
+}
+
+FixupBranch RiscVEmitter::JAL(RiscVReg rd) {
+	FixupBranch branch{ m_code, FixupBranchType::J };
+	Write32(EncodeJ(rd, 0));
+	return branch;
+}
+
+void RiscVEmitter::JALR(RiscVReg rd, RiscVReg rs1, s32 simm12) {
+	Write32(EncodeI(JALR_OP, rd, 0, rs1, simm12));
+}
+
+void RiscVEmitter::EmitBranch(u32 funct3, RiscVReg rs1, RiscVReg rs2, const void *dst) {
+	Write32(EncodeB(funct3, rs1, rs2, (s64)((const u8 *)dst - m_code)));
+}
+
+FixupBranch RiscVEmitter::EmitBranch(u32 funct3, RiscVReg rs1, RiscVReg rs2) {
+	FixupBranch branch{ m_code, FixupBranchType::B };
+	Write32(EncodeB(funct3, rs1, rs2, 0));
+	return branch;
+}
+
+void RiscVEmitter::BEQ(RiscVReg rs1, RiscVReg rs2, const void *dst) { EmitBranch(0, rs1, rs2, dst); }
+void RiscVEmitter::BNE(RiscVReg rs1, RiscVReg rs2, const void *dst) { EmitBranch(1, rs1, rs2, dst); }
+void RiscVEmitter::BLT(RiscVReg rs1, RiscVReg rs2, const void *dst) { EmitBranch(4, rs1, rs2, dst); }
+void RiscVEmitter::BGE(RiscVReg rs1, RiscVReg rs2, const void *dst) { EmitBranch(5, rs1, rs2, dst); }
+void RiscVEmitter::BLTU(RiscVReg rs1, RiscVReg rs2, const void *dst) { EmitBranch(6, rs1, rs2, dst); }
+void RiscVEmitter::BGEU(RiscVReg rs1, RiscVReg rs2, const void *dst) { EmitBranch(7, rs1, rs2, dst); }
+FixupBranch RiscVEmitter::BEQ(RiscVReg rs1, RiscVReg rs2) { return EmitBranch(0, rs1, rs2); }
+FixupBranch RiscVEmitter::BNE(RiscVReg rs1, RiscVReg rs2) { return EmitBranch(1, rs1, rs2); }
+FixupBranch RiscVEmitter::BLT(RiscVReg rs1, RiscVReg rs2) { return EmitBranch(4, rs1, rs2); }
+FixupBranch RiscVEmitter::BGE(RiscVReg rs1, RiscVReg rs2) { return EmitBranch(5, rs1, rs2); }
+FixupBranch RiscVEmitter::BLTU(RiscVReg rs1, RiscVReg rs2) { return EmitBranch(6, rs1, rs2); }
+FixupBranch RiscVEmitter::BGEU(RiscVReg rs1, RiscVReg rs2) { return EmitBranch(7, rs1, rs2); }
+
+void RiscVEmitter::EmitLoad(u32 funct3, RiscVReg rd, RiscVReg addr, s32 simm12) {
+	Write32(EncodeI(LOAD, rd, funct3, addr, simm12));
+}
+
+void RiscVEmitter::EmitStore(u32 funct3, RiscVReg rs2, RiscVReg addr, s32 simm12) {
+	Write32(EncodeS(STORE, funct3, addr, rs2, simm12));
+}
+
+void RiscVEmitter::LB(RiscVReg rd, RiscVReg addr, s32 simm12) { EmitLoad(0, rd, addr, simm12); }
+void RiscVEmitter::LH(RiscVReg rd, RiscVReg addr, s32 simm12) { EmitLoad(1, rd, addr, simm12); }
+void RiscVEmitter::LW(RiscVReg rd, RiscVReg addr, s32 simm12) { EmitLoad(2, rd, addr, simm12); }
+void RiscVEmitter::LD(RiscVReg rd, RiscVReg addr, s32 simm12) { EmitLoad(3, rd, addr, simm12); }
+void RiscVEmitter::LBU(RiscVReg rd, RiscVReg addr, s32 simm12) { EmitLoad(4, rd, addr, simm12); }
+void RiscVEmitter::LHU(RiscVReg rd, RiscVReg addr, s32 simm12) { EmitLoad(5, rd, addr, simm12); }
+void RiscVEmitter::LWU(RiscVReg rd, RiscVReg addr, s32 simm12) { EmitLoad(6, rd, addr, simm12); }
+void RiscVEmitter::SB(RiscVReg rs2, RiscVReg addr, s32 simm12) { EmitStore(0, rs2, addr, simm12); }
+void RiscVEmitter::SH(RiscVReg rs2, RiscVReg addr, s32 simm12) { EmitStore(1, rs2, addr, simm12); }
+void RiscVEmitter::SW(RiscVReg rs2, RiscVReg addr, s32 simm12) { EmitStore(2, rs2, addr, simm12); }
+void RiscVEmitter::SD(RiscVReg rs2, RiscVReg addr, s32 simm12) { EmitStore(3, rs2, addr, simm12); }
+
+void RiscVEmitter::EmitOpImm(u32 opcode, u32 funct3, RiscVReg rd, RiscVReg rs1, s32 simm12) {
+	Write32(EncodeI(opcode, rd, funct3, rs1, simm12));
+}
+
+void RiscVEmitter::EmitShiftImm(u32 opcode, u32 funct3, u32 funct6, RiscVReg rd, RiscVReg rs1, u32 shamt, u32 maxShift) {
+	_assert_msg_(shamt < maxShift, "Shift out of range: %d", shamt);
+	Write32((funct6 << 26) | (shamt << 20) | (EncodeReg(rs1) << 15) | (funct3 << 12) | (EncodeReg(rd) << 7) | opcode);
+}
+
+void RiscVEmitter::ADDI(RiscVReg rd, RiscVReg rs1, s32 simm12) { EmitOpImm(OP_IMM, 0, rd, rs1, simm12); }
+void RiscVEmitter::SLTI(RiscVReg rd, RiscVReg rs1, s32 simm12) { EmitOpImm(OP_IMM, 2, rd, rs1, simm12); }
+void RiscVEmitter::SLTIU(RiscVReg rd, RiscVReg rs1, s32 simm12) { EmitOpImm(OP_IMM, 3, rd, rs1, simm12); }
+void RiscVEmitter::XORI(RiscVReg rd, RiscVReg rs1, s32 simm12) { EmitOpImm(OP_IMM, 4, rd, rs1, simm12); }
+void RiscVEmitter::ORI(RiscVReg rd, RiscVReg rs1, s32 simm12) { EmitOpImm(OP_IMM, 6, rd, rs1, simm12); }
+void RiscVEmitter::ANDI(RiscVReg rd, RiscVReg rs1, s32 simm12) { EmitOpImm(OP_IMM, 7, rd, rs1, simm12); }
+void RiscVEmitter::SLLI(RiscVReg rd, RiscVReg rs1, u32 shamt) { EmitShiftImm(OP_IMM, 1, 0x00, rd, rs1, shamt, 64); }
+void RiscVEmitter::SRLI(RiscVReg rd, RiscVReg rs1, u32 shamt) { EmitShiftImm(OP_IMM, 5, 0x00, rd, rs1, shamt, 64); }
+void RiscVEmitter::SRAI(RiscVReg rd, RiscVReg rs1, u32 shamt) { EmitShiftImm(OP_IMM, 5, 0x10, rd, rs1, shamt, 64); }
+
+void RiscVEmitter::EmitOp(u32 opcode, u32 funct7, u32 funct3, RiscVReg rd, RiscVReg rs1, RiscVReg rs2) {
+	Write32(EncodeR(opcode, rd, funct3, rs1, rs2, funct7));
+}
+
+void RiscVEmitter::ADD(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x00, 0, rd, rs1, rs2); }
+void RiscVEmitter::SUB(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x20, 0, rd, rs1, rs2); }
+void RiscVEmitter::SLL(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x00, 1, rd, rs1, rs2); }
+void RiscVEmitter::SLT(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x00, 2, rd, rs1, rs2); }
+void RiscVEmitter::SLTU(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x00, 3, rd, rs1, rs2); }
+void RiscVEmitter::XOR(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x00, 4, rd, rs1, rs2); }
+void RiscVEmitter::SRL(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x00, 5, rd, rs1, rs2); }
+void RiscVEmitter::SRA(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x20, 5, rd, rs1, rs2); }
+void RiscVEmitter::OR(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x00, 6, rd, rs1, rs2); }
+void RiscVEmitter::AND(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x00, 7, rd, rs1, rs2); }
+
+void RiscVEmitter::ADDIW(RiscVReg rd, RiscVReg rs1, s32 simm12) { EmitOpImm(OP_IMM_32, 0, rd, rs1, simm12); }
+void RiscVEmitter::SLLIW(RiscVReg rd, RiscVReg rs1, u32 shamt) { EmitShiftImm(OP_IMM_32, 1, 0x00, rd, rs1, shamt, 32); }
+void RiscVEmitter::SRLIW(RiscVReg rd, RiscVReg rs1, u32 shamt) { EmitShiftImm(OP_IMM_32, 5, 0x00, rd, rs1, shamt, 32); }
+void RiscVEmitter::SRAIW(RiscVReg rd, RiscVReg rs1, u32 shamt) { EmitShiftImm(OP_IMM_32, 5, 0x10, rd, rs1, shamt, 32); }
+void RiscVEmitter::ADDW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP_32, 0x00, 0, rd, rs1, rs2); }
+void RiscVEmitter::SUBW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP_32, 0x20, 0, rd, rs1, rs2); }
+void RiscVEmitter::SLLW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP_32, 0x00, 1, rd, rs1, rs2); }
+void RiscVEmitter::SRLW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP_32, 0x00, 5, rd, rs1, rs2); }
+void RiscVEmitter::SRAW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP_32, 0x20, 5, rd, rs1, rs2); }
+
+void RiscVEmitter::FENCE() {
+	// fence rw, rw
+	Write32((0x3 << 24) | (0x3 << 20) | MISC_MEM);
+}
+
+void RiscVEmitter::FENCE_I() {
+	Write32((1 << 12) | MISC_MEM);
+}
+
+void RiscVEmitter::ECALL() {
+	Write32(SYSTEM);
+}
+
+void RiscVEmitter::EBREAK() {
+	Write32((1 << 20) | SYSTEM);
+}
+
+void RiscVEmitter::MUL(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x01, 0, rd, rs1, rs2); }
+void RiscVEmitter::MULH(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x01, 1, rd, rs1, rs2); }
+void RiscVEmitter::MULHSU(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x01, 2, rd, rs1, rs2); }
+void RiscVEmitter::MULHU(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x01, 3, rd, rs1, rs2); }
+void RiscVEmitter::DIV(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x01, 4, rd, rs1, rs2); }
+void RiscVEmitter::DIVU(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x01, 5, rd, rs1, rs2); }
+void RiscVEmitter::REM(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x01, 6, rd, rs1, rs2); }
+void RiscVEmitter::REMU(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP, 0x01, 7, rd, rs1, rs2); }
+void RiscVEmitter::MULW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP_32, 0x01, 0, rd, rs1, rs2); }
+void RiscVEmitter::DIVW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP_32, 0x01, 4, rd, rs1, rs2); }
+void RiscVEmitter::DIVUW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP_32, 0x01, 5, rd, rs1, rs2); }
+void RiscVEmitter::REMW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP_32, 0x01, 6, rd, rs1, rs2); }
+void RiscVEmitter::REMUW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitOp(OP_32, 0x01, 7, rd, rs1, rs2); }
+
+void RiscVEmitter::FL(int bits, RiscVReg rd, RiscVReg addr, s32 simm12) {
+	_dbg_assert_msg_(IsFPR(rd), "FL needs an FPR");
+	Write32(EncodeI(LOAD_FP, rd, bits == 64 ? 3 : 2, addr, simm12));
+}
+
+void RiscVEmitter::FS(int bits, RiscVReg rs2, RiscVReg addr, s32 simm12) {
+	_dbg_assert_msg_(IsFPR(rs2), "FS needs an FPR");
+	Write32(EncodeS(STORE_FP, bits == 64 ? 3 : 2, addr, rs2, simm12));
+}
+
+void RiscVEmitter::EmitFPOp(u32 funct5, int bits, u32 funct3, RiscVReg rd, RiscVReg rs1, RiscVReg rs2) {
+	Write32(EncodeR(OP_FP, rd, funct3, rs1, rs2, (funct5 << 2) | FloatFormat(bits)));
+}
+
+void RiscVEmitter::FADD(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2, Round rm) { EmitFPOp(0x00, bits, (u32)rm, rd, rs1, rs2); }
+void RiscVEmitter::FSUB(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2, Round rm) { EmitFPOp(0x01, bits, (u32)rm, rd, rs1, rs2); }
+void RiscVEmitter::FMUL(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2, Round rm) { EmitFPOp(0x02, bits, (u32)rm, rd, rs1, rs2); }
+void RiscVEmitter::FDIV(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2, Round rm) { EmitFPOp(0x03, bits, (u32)rm, rd, rs1, rs2); }
+void RiscVEmitter::FSQRT(int bits, RiscVReg rd, RiscVReg rs1, Round rm) { EmitFPOp(0x0B, bits, (u32)rm, rd, rs1, F0); }
+void RiscVEmitter::FSGNJ(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitFPOp(0x04, bits, 0, rd, rs1, rs2); }
+void RiscVEmitter::FSGNJN(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitFPOp(0x04, bits, 1, rd, rs1, rs2); }
+void RiscVEmitter::FSGNJX(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitFPOp(0x04, bits, 2, rd, rs1, rs2); }
+void RiscVEmitter::FMIN(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitFPOp(0x05, bits, 0, rd, rs1, rs2); }
+void RiscVEmitter::FMAX(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitFPOp(0x05, bits, 1, rd, rs1, rs2); }
+void RiscVEmitter::FEQ(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitFPOp(0x14, bits, 2, rd, rs1, rs2); }
+void RiscVEmitter::FLT(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitFPOp(0x14, bits, 1, rd, rs1, rs2); }
+void RiscVEmitter::FLE(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2) { EmitFPOp(0x14, bits, 0, rd, rs1, rs2); }
+void RiscVEmitter::FCLASS(int bits, RiscVReg rd, RiscVReg rs1) { EmitFPOp(0x1C, bits, 1, rd, rs1, X0); }
+
+void RiscVEmitter::FCVT_TO_INT(int intbits, bool isUnsigned, int bits, RiscVReg rd, RiscVReg rs1, Round rm) {
+	// The rs2 field picks the integer type: W, WU, L, LU.
+	RiscVReg type = (RiscVReg)((intbits == 64 ? 2 : 0) | (isUnsigned ? 1 : 0));
+	EmitFPOp(0x18, bits, (u32)rm, rd, rs1, type);
+}
+
+void RiscVEmitter::FCVT_FROM_INT(int bits, int intbits, bool isUnsigned, RiscVReg rd, RiscVReg rs1, Round rm) {
+	RiscVReg type = (RiscVReg)((intbits == 64 ? 2 : 0) | (isUnsigned ? 1 : 0));
+	EmitFPOp(0x1A, bits, (u32)rm, rd, rs1, type);
+}
+
+void RiscVEmitter::FCVT(int tobits, int frombits, RiscVReg rd, RiscVReg rs1, Round rm) {
+	_assert_msg_(tobits != frombits, "FCVT between the same sizes");
+	EmitFPOp(0x08, tobits, (u32)rm, rd, rs1, (RiscVReg)FloatFormat(frombits));
+}
+
+void RiscVEmitter::FMV_TO_INT(int bits, RiscVReg rd, RiscVReg rs1) {
+	EmitFPOp(0x1C, bits, 0, rd, rs1, X0);
+}
+
+void RiscVEmitter::FMV_FROM_INT(int bits, RiscVReg rd, RiscVReg rs1) {
+	EmitFPOp(0x1E, bits, 0, rd, rs1, X0);
+}
+
+void RiscVEmitter::LI(RiscVReg rd, s64 value) {
+	if (FitsSigned(value, 32)) {
+		// ADDI sign extends, so round the upper part up when bit 11 is set.
+		s32 lo12 = (s32)(((value & 0xFFF) ^ 0x800) - 0x800);
+		s32 hi20 = (s32)(((u64)value + 0x800) & 0xFFFFF000);
+		if (hi20 != 0) {
+			LUI(rd, hi20);
+			// ADDIW, because near 0x7FFFFFFF the LUI value is negative and this must wrap back.
+			if (lo12 != 0)
+				ADDIW(rd, rd, lo12);
+		} else {
+			ADDI(rd, R_ZERO, lo12);
+		}
+		return;
+	}
+
+	// Build the upper part without its trailing zeros, then shift it into place.
+	s32 lo12 = (s32)(((value & 0xFFF) ^ 0x800) - 0x800);
+	u64 hi52 = ((u64)value + 0x800) >> 12;
+	int shift = 12;
+	while ((hi52 & 1) == 0) {
+		hi52 >>= 1;
+		shift++;
+	}
+	// Sign extend from the bits that are left.
+	s64 upper = (s64)(hi52 << shift) >> shift;
+	LI(rd, upper);
+	SLLI(rd, rd, shift);
+	if (lo12 != 0)
+		ADDI(rd, rd, lo12);
+}
+
+void RiscVEmitter::QuickJAL(RiscVReg scratchreg, const void *func) {
+	if (JInRange(func)) {
+		JAL(R_RA, func);
+	} else {
+		LI(scratchreg, func);
+		JALR(R_RA, scratchreg, 0);
+	}
+}
+
+void RiscVCodeBlock::PoisonMemory(int offset) {
+	// So we can adjust region to writable space.  Might be zero.
+	ptrdiff_t writable = m_writable - m_code;
+
+	u32 *ptr = (u32 *)(region + offset + writable);
+	u32 *maxptr = (u32 *)(region + region_size - offset + writable);
+	// EBREAK.
+	while (ptr < maxptr)
+		*ptr++ = 0x00100073;
+}
+
+}  // namespace RiscVGen
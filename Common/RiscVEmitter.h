@@ -0,0 +1,293 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <cstdint>
+
+#include "Common/CodeBlock.h"
+#include "Common/Common.h"
+
+// Emitter for RV64G (I, M, F, D.)  Compressed instructions aren't used, every instruction is 4 bytes.
+
+namespace RiscVGen {
+
+enum RiscVReg {
+	X0 = 0, X1, X2, X3, X4, X5, X6, X7,
+	X8, X9, X10, X11, X12, X13, X14, X15,
+	X16, X17, X18, X19, X20, X21, X22, X23,
+	X24, X25, X26, X27, X28, X29, X30, X31,
+
+	F0 = 0x20, F1, F2, F3, F4, F5, F6, F7,
+	F8, F9, F10, F11, F12, F13, F14, F15,
+	F16, F17, F18, F19, F20, F21, F22, F23,
+	F24, F25, F26, F27, F28, F29, F30, F31,
+
+	INVALID_REG = 0xFFFFFFFF,
+
+	// ABI names.
+	R_ZERO = X0,
+	R_RA = X1,
+	R_SP = X2,
+	R_GP = X3,
+	R_TP = X4,
+	T0 = X5, T1 = X6, T2 = X7,
+	S0 = X8, S1 = X9,
+	A0 = X10, A1, A2, A3, A4, A5, A6, A7,
+	S2 = X18, S3, S4, S5, S6, S7, S8, S9, S10, S11,
+	T3 = X28, T4, T5, T6,
+
+	FT0 = F0, FT1, FT2, FT3, FT4, FT5, FT6, FT7,
+	FS0 = F8, FS1,
+	FA0 = F10, FA1, FA2, FA3, FA4, FA5, FA6, FA7,
+	FS2 = F18, FS3, FS4, FS5, FS6, FS7, FS8, FS9, FS10, FS11,
+	FT8 = F28, FT9, FT10, FT11,
+};
+
+inline bool IsGPR(RiscVReg reg) {
+	return reg < F0;
+}
+
+inline bool IsFPR(RiscVReg reg) {
+	return reg >= F0 && reg <= F31;
+}
+
+// Floating point rounding modes, DYNAMIC uses the one in fcsr.
+enum class Round {
+	NEAREST_EVEN = 0,
+	TOZERO = 1,
+	DOWN = 2,
+	UP = 3,
+	NEAREST_MAX = 4,
+	DYNAMIC = 7,
+};
+
+enum class FixupBranchType {
+	// Conditional branches, +/- 4 KB.
+	B,
+	// JAL, +/- 1 MB.
+	J,
+};
+
+struct FixupBranch {
+	// Pointer to executable code address.
+	const u8 *ptr;
+	FixupBranchType type;
+};
+
+class RiscVEmitter {
+public:
+	RiscVEmitter() {}
+	RiscVEmitter(const u8 *codePtr, u8 *writablePtr);
+	virtual ~RiscVEmitter() {}
+
+	void SetCodePointer(const u8 *ptr, u8 *writePtr);
+	const u8 *GetCodePointer() const;
+	u8 *GetWritableCodePtr();
+
+	void ReserveCodeSpace(u32 bytes);
+	const u8 *AlignCode16();
+	const u8 *AlignCodePage();
+	void FlushIcache();
+	void FlushIcacheSection(const u8 *start, const u8 *end);
+
+	void SetJumpTarget(const FixupBranch &branch);
+	bool BInRange(const void *func) const;
+	bool JInRange(const void *func) const;
+
+	// RV32I / RV64I.
+	void LUI(RiscVReg rd, s32 simm32);
+	void AUIPC(RiscVReg rd, s32 simm32);
+
+	void JAL(RiscVReg rd, const void *dst);
+	FixupBranch JAL(RiscVReg rd);
+	void JALR(RiscVReg rd, RiscVReg rs1, s32 simm12);
+
+	void BEQ(RiscVReg rs1, RiscVReg rs2, const void *dst);
+	void BNE(RiscVReg rs1, RiscVReg rs2, const void *dst);
+	void BLT(RiscVReg rs1, RiscVReg rs2, const void *dst);
+	void BGE(RiscVReg rs1, RiscVReg rs2, const void *dst);
+	void BLTU(RiscVReg rs1, RiscVReg rs2, const void *dst);
+	void BGEU(RiscVReg rs1, RiscVReg rs2, const void *dst);
+	FixupBranch BEQ(RiscVReg rs1, RiscVReg rs2);
+	FixupBranch BNE(RiscVReg rs1, RiscVReg rs2);
+	FixupBranch BLT(RiscVReg rs1, RiscVReg rs2);
+	FixupBranch BGE(RiscVReg rs1, RiscVReg rs2);
+	FixupBranch BLTU(RiscVReg rs1, RiscVReg rs2);
+	FixupBranch BGEU(RiscVReg rs1, RiscVReg rs2);
+
+	void LB(RiscVReg rd, RiscVReg addr, s32 simm12);
+	void LH(RiscVReg rd, RiscVReg addr, s32 simm12);
+	void LW(RiscVReg rd, RiscVReg addr, s32 simm12);
+	void LD(RiscVReg rd, RiscVReg addr, s32 simm12);
+	void LBU(RiscVReg rd, RiscVReg addr, s32 simm12);
+	void LHU(RiscVReg rd, RiscVReg addr, s32 simm12);
+	void LWU(RiscVReg rd, RiscVReg addr, s32 simm12);
+	void SB(RiscVReg rs2, RiscVReg addr, s32 simm12);
+	void SH(RiscVReg rs2, RiscVReg addr, s32 simm12);
+	void SW(RiscVReg rs2, RiscVReg addr, s32 simm12);
+	void SD(RiscVReg rs2, RiscVReg addr, s32 simm12);
+
+	void ADDI(RiscVReg rd, RiscVReg rs1, s32 simm12);
+	void SLTI(RiscVReg rd, RiscVReg rs1, s32 simm12);
+	void SLTIU(RiscVReg rd, RiscVReg rs1, s32 simm12);
+	void XORI(RiscVReg rd, RiscVReg rs1, s32 simm12);
+	void ORI(RiscVReg rd, RiscVReg rs1, s32 simm12);
+	void ANDI(RiscVReg rd, RiscVReg rs1, s32 simm12);
+	void SLLI(RiscVReg rd, RiscVReg rs1, u32 shamt);
+	void SRLI(RiscVReg rd, RiscVReg rs1, u32 shamt);
+	void SRAI(RiscVReg rd, RiscVReg rs1, u32 shamt);
+
+	void ADD(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void SUB(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void SLL(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void SLT(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void SLTU(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void XOR(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void SRL(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void SRA(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void OR(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void AND(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+
+	// 32-bit operations, the result is sign extended to 64 bits.
+	void ADDIW(RiscVReg rd, RiscVReg rs1, s32 simm12);
+	void SLLIW(RiscVReg rd, RiscVReg rs1, u32 shamt);
+	void SRLIW(RiscVReg rd, RiscVReg rs1, u32 shamt);
+	void SRAIW(RiscVReg rd, RiscVReg rs1, u32 shamt);
+	void ADDW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void SUBW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void SLLW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void SRLW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void SRAW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+
+	void FENCE();
+	void FENCE_I();
+	void ECALL();
+	void EBREAK();
+
+	// M.
+	void MUL(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void MULH(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void MULHSU(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void MULHU(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void DIV(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void DIVU(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void REM(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void REMU(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void MULW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void DIVW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void DIVUW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void REMW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void REMUW(RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+
+	// F and D.  bits is 32 for single, 64 for double.
+	void FL(int bits, RiscVReg rd, RiscVReg addr, s32 simm12);
+	void FS(int bits, RiscVReg rs2, RiscVReg addr, s32 simm12);
+	void FADD(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2, Round rm = Round::DYNAMIC);
+	void FSUB(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2, Round rm = Round::DYNAMIC);
+	void FMUL(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2, Round rm = Round::DYNAMIC);
+	void FDIV(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2, Round rm = Round::DYNAMIC);
+	void FSQRT(int bits, RiscVReg rd, RiscVReg rs1, Round rm = Round::DYNAMIC);
+	void FSGNJ(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void FSGNJN(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void FSGNJX(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void FMIN(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void FMAX(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void FEQ(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void FLT(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void FLE(int bits, RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void FCLASS(int bits, RiscVReg rd, RiscVReg rs1);
+	// Float to integer, intbits is 32 or 64.
+	void FCVT_TO_INT(int intbits, bool isUnsigned, int bits, RiscVReg rd, RiscVReg rs1, Round rm = Round::DYNAMIC);
+	void FCVT_FROM_INT(int bits, int intbits, bool isUnsigned, RiscVReg rd, RiscVReg rs1, Round rm = Round::DYNAMIC);
+	// Between single and double.
+	void FCVT(int tobits, int frombits, RiscVReg rd, RiscVReg rs1, Round rm = Round::DYNAMIC);
+	// Raw bit moves between a GPR and an FPR.
+	void FMV_TO_INT(int bits, RiscVReg rd, RiscVReg rs1);
+	void FMV_FROM_INT(int bits, RiscVReg rd, RiscVReg rs1);
+
+	// Pseudo instructions.
+	void NOP() {
+		ADDI(R_ZERO, R_ZERO, 0);
+	}
+	void MV(RiscVReg rd, RiscVReg rs) {
+		ADDI(rd, rs, 0);
+	}
+	void NOT(RiscVReg rd, RiscVReg rs) {
+		XORI(rd, rs, -1);
+	}
+	void NEG(RiscVReg rd, RiscVReg rs) {
+		SUB(rd, R_ZERO, rs);
+	}
+	void SEXT_W(RiscVReg rd, RiscVReg rs) {
+		ADDIW(rd, rs, 0);
+	}
+	void RET() {
+		JALR(R_ZERO, R_RA, 0);
+	}
+	void J(const void *dst) {
+		JAL(R_ZERO, dst);
+	}
+	FixupBranch J() {
+		return JAL(R_ZERO);
+	}
+	void JR(RiscVReg rs) {
+		JALR(R_ZERO, rs, 0);
+	}
+
+	// Loads any 64-bit constant, in at most 8 instructions (usually 1-2.)
+	void LI(RiscVReg rd, s64 value);
+	template <typename T>
+	void LI(RiscVReg rd, const T *ptr) {
+		LI(rd, (s64)(intptr_t)ptr);
+	}
+
+	// Uses JAL when in range, otherwise the scratch register.
+	void QuickJAL(RiscVReg scratchreg, const void *func);
+	template <typename T>
+	void QuickCallFunction(RiscVReg scratchreg, T func) {
+		QuickJAL(scratchreg, (const void *)func);
+	}
+
+protected:
+	inline void Write32(u32 value) {
+		*(u32 *)m_writable = value;
+		m_code += 4;
+		m_writable += 4;
+	}
+
+	const u8 *m_code = nullptr;
+	u8 *m_writable = nullptr;
+	const u8 *m_lastCacheFlushEnd = nullptr;
+
+private:
+	void EmitBranch(u32 funct3, RiscVReg rs1, RiscVReg rs2, const void *dst);
+	FixupBranch EmitBranch(u32 funct3, RiscVReg rs1, RiscVReg rs2);
+	void EmitLoad(u32 funct3, RiscVReg rd, RiscVReg addr, s32 simm12);
+	void EmitStore(u32 funct3, RiscVReg rs2, RiscVReg addr, s32 simm12);
+	void EmitOpImm(u32 opcode, u32 funct3, RiscVReg rd, RiscVReg rs1, s32 simm12);
+	void EmitShiftImm(u32 opcode, u32 funct3, u32 funct6, RiscVReg rd, RiscVReg rs1, u32 shamt, u32 maxShift);
+	void EmitOp(u32 opcode, u32 funct7, u32 funct3, RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+	void EmitFPOp(u32 funct5, int bits, u32 funct3, RiscVReg rd, RiscVReg rs1, RiscVReg rs2);
+};
+
+class RiscVCodeBlock : public CodeBlock<RiscVEmitter> {
+private:
+	void PoisonMemory(int offset) override;
+};
+
+}  // namespace RiscVGen
@@ -15,8 +15,10 @@
 // Official SVN repository and contact information can be found at
 // http://code.google.com/p/dolphin-emu/
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 #include <snappy-c.h>
 #include <zstd.h>
 
@@ -24,14 +26,243 @@
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/File/FileUtil.h"
 #include "Common/StringUtils.h"
+#include "Common/Swap.h"
+#include "Common/Thread/ParallelLoop.h"
 
 enum class SerializeCompressType {
 	NONE = 0,
 	SNAPPY = 1,
 	ZSTD = 2,
+	// Independent zstd frames, so they can be (de)compressed in parallel.
+	ZSTD_CHUNKED = 3,
 };
 
-static constexpr SerializeCompressType SAVE_TYPE = SerializeCompressType::ZSTD;
+static constexpr SerializeCompressType SAVE_TYPE = SerializeCompressType::ZSTD_CHUNKED;
+
+// ZSTD_CHUNKED layout: u32 chunkSize, u32 chunkCount, u32 compressedSize[chunkCount], then the frames in order.
+static const size_t ZSTD_CHUNK_SIZE = 1024 * 1024;
+
+static size_t ZstdChunkedHeaderSize(size_t chunkCount) {
+	return sizeof(u32_le) * (2 + chunkCount);
+}
+
+static size_t ZstdChunkedBound(size_t sz) {
+	const size_t chunkCount = (sz + ZSTD_CHUNK_SIZE - 1) / ZSTD_CHUNK_SIZE;
+	return ZstdChunkedHeaderSize(chunkCount) + chunkCount * ZSTD_compressBound(ZSTD_CHUNK_SIZE);
+}
+
+// Returns the frame size, or 0 on failure.
+static size_t ZstdCompressChunk(ZSTD_CCtx *ctx, u8 *dest, size_t destSize, const u8 *src, size_t sz) {
+	ZSTD_CCtx_reset(ctx, ZSTD_reset_session_and_parameters);
+	ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
+	ZSTD_CCtx_setParameter(ctx, ZSTD_c_checksumFlag, 1);
+	ZSTD_CCtx_setPledgedSrcSize(ctx, sz);
+	size_t result = ZSTD_compress2(ctx, dest, destSize, src, sz);
+	return ZSTD_isError(result) ? 0 : result;
+}
+
+// dest must have ZstdChunkedBound(sz) bytes.  Returns the size used, or 0 on failure.
+static size_t ZstdChunkedCompress(u8 *dest, const u8 *src, size_t sz) {
+	const size_t chunkCount = (sz + ZSTD_CHUNK_SIZE - 1) / ZSTD_CHUNK_SIZE;
+	const size_t headerSize = ZstdChunkedHeaderSize(chunkCount);
+	const size_t slotSize = ZSTD_compressBound(ZSTD_CHUNK_SIZE);
+	u32_le *header = (u32_le *)dest;
+	header[0] = (u32)ZSTD_CHUNK_SIZE;
+	header[1] = (u32)chunkCount;
+
+	// Each chunk first goes into its own worst case sized slot, then they're packed together.
+	std::vector<size_t> sizes(chunkCount);
+	ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+		ZSTD_CCtx *ctx = ZSTD_createCCtx();
+		for (int i = l; i < h; ++i) {
+			const size_t offset = i * ZSTD_CHUNK_SIZE;
+			const size_t chunkSize = std::min(ZSTD_CHUNK_SIZE, sz - offset);
+			if (!ctx) {
+				// Zero marks failure, a frame is never empty.
+				sizes[i] = 0;
+				continue;
+			}
+			sizes[i] = ZstdCompressChunk(ctx, dest + headerSize + i * slotSize, slotSize, src + offset, chunkSize);
+		}
+		ZSTD_freeCCtx(ctx);
+	}, 0, (int)chunkCount, 1);
+
+	size_t pos = headerSize;
+	for (size_t i = 0; i < chunkCount; ++i) {
+		if (sizes[i] == 0 || sizes[i] > 0xFFFFFFFF)
+			return 0;
+		header[2 + i] = (u32)sizes[i];
+		memmove(dest + pos, dest + headerSize + i * slotSize, sizes[i]);
+		pos += sizes[i];
+	}
+	return pos;
+}
+
+static bool ZstdChunkedDecompress(u8 *dest, size_t destSize, const u8 *src, size_t srcSize) {
+	if (srcSize < ZstdChunkedHeaderSize(0))
+		return false;
+	const u32_le *header = (const u32_le *)src;
+	const size_t chunkSize = header[0];
+	const size_t chunkCount = header[1];
+	const size_t headerSize = ZstdChunkedHeaderSize(chunkCount);
+	if (chunkSize == 0 || chunkCount != (destSize + chunkSize - 1) / chunkSize || headerSize > srcSize)
+		return false;
+
+	std::vector<size_t> offsets(chunkCount + 1);
+	offsets[0] = headerSize;
+	for (size_t i = 0; i < chunkCount; ++i) {
+		offsets[i + 1] = offsets[i] + header[2 + i];
+		if (offsets[i + 1] > srcSize)
+			return false;
+	}
+
+	std::vector<u8> failed(chunkCount);
+	ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+		for (int i = l; i < h; ++i) {
+			const size_t offset = i * chunkSize;
+			const size_t expected = std::min(chunkSize, destSize - offset);
+			size_t status = ZSTD_decompress(dest + offset, expected, src + offsets[i], offsets[i + 1] - offsets[i]);
+			failed[i] = ZSTD_isError(status) || status != expected;
+		}
+	}, 0, (int)chunkCount, 1);
+
+	return std::find(failed.begin(), failed.end(), 1) == failed.end();
+}
+
+void SerializeGather::Begin(const u8 *base) {
+	base_ = base;
+	externalSize_ = 0;
+	blocks_.clear();
+	pieces_.clear();
+	frames_.clear();
+	failed_ = false;
+}
+
+void SerializeGather::Add(const u8 *inlinePos, const void *data, size_t size) {
+	const u8 *src = (const u8 *)data;
+	const size_t pos = (inlinePos - base_) + externalSize_;
+	const size_t end = pos + size;
+	blocks_.push_back(Block{ (size_t)(inlinePos - base_), pos });
+	externalSize_ += size;
+
+	// Chunks entirely inside the block are compressed now, the edges are kept for Finish().
+	const size_t firstFull = (pos + ZSTD_CHUNK_SIZE - 1) / ZSTD_CHUNK_SIZE;
+	const size_t lastFull = end / ZSTD_CHUNK_SIZE;
+	if (firstFull >= lastFull) {
+		if (size != 0)
+			pieces_.push_back(Piece{ pos, std::vector<u8>(src, src + size) });
+		return;
+	}
+
+	const size_t headEnd = firstFull * ZSTD_CHUNK_SIZE;
+	const size_t tailStart = lastFull * ZSTD_CHUNK_SIZE;
+	if (headEnd != pos)
+		pieces_.push_back(Piece{ pos, std::vector<u8>(src, src + (headEnd - pos)) });
+	if (tailStart != end)
+		pieces_.push_back(Piece{ tailStart, std::vector<u8>(src + (tailStart - pos), src + size) });
+
+	frames_.resize(lastFull);
+	ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+		ZSTD_CCtx *ctx = ZSTD_createCCtx();
+		std::vector<u8> scratch(ZSTD_compressBound(ZSTD_CHUNK_SIZE));
+		for (int i = l; i < h; ++i) {
+			size_t result = ctx ? ZstdCompressChunk(ctx, &scratch[0], scratch.size(), src + (i * ZSTD_CHUNK_SIZE - pos), ZSTD_CHUNK_SIZE) : 0;
+			frames_[i].assign(scratch.begin(), scratch.begin() + result);
+		}
+		ZSTD_freeCCtx(ctx);
+	}, (int)firstFull, (int)lastFull, 1);
+
+	// A frame is never empty, so that marks failure.
+	for (size_t i = firstFull; i < lastFull; ++i)
+		failed_ = failed_ || frames_[i].empty();
+}
+
+bool SerializeGather::Finish(const u8 *inlineData, size_t inlineSize, u8 *&out, size_t &outSize) {
+	if (failed_)
+		return false;
+
+	struct Segment {
+		size_t pos;
+		size_t size;
+		const u8 *src;
+	};
+
+	// Everything not already compressed, in stream order.
+	std::vector<Segment> segments;
+	size_t prev = 0;
+	for (const Block &block : blocks_) {
+		if (block.inlinePos != prev)
+			segments.push_back(Segment{ block.pos - (block.inlinePos - prev), block.inlinePos - prev, inlineData + prev });
+		prev = block.inlinePos;
+	}
+	if (inlineSize != prev)
+		segments.push_back(Segment{ prev + externalSize_, inlineSize - prev, inlineData + prev });
+	for (const Piece &piece : pieces_)
+		segments.push_back(Segment{ piece.pos, piece.data.size(), piece.data.data() });
+	std::sort(segments.begin(), segments.end(), [](const Segment &a, const Segment &b) {
+		return a.pos < b.pos;
+	});
+
+	const size_t total = inlineSize + externalSize_;
+	const size_t chunkCount = (total + ZSTD_CHUNK_SIZE - 1) / ZSTD_CHUNK_SIZE;
+	frames_.resize(chunkCount);
+
+	ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+		ZSTD_CCtx *ctx = nullptr;
+		std::vector<u8> staging;
+		std::vector<u8> scratch;
+		for (int i = l; i < h; ++i) {
+			if (!frames_[i].empty())
+				continue;
+			if (!ctx) {
+				ctx = ZSTD_createCCtx();
+				staging.resize(ZSTD_CHUNK_SIZE);
+				scratch.resize(ZSTD_compressBound(ZSTD_CHUNK_SIZE));
+			}
+
+			const size_t start = i * ZSTD_CHUNK_SIZE;
+			const size_t chunkSize = std::min(ZSTD_CHUNK_SIZE, total - start);
+			auto it = std::upper_bound(segments.begin(), segments.end(), start, [](size_t v, const Segment &seg) {
+				return v < seg.pos;
+			});
+			if (it != segments.begin())
+				--it;
+			for (; it != segments.end() && it->pos < start + chunkSize; ++it) {
+				const size_t from = std::max(start, it->pos);
+				const size_t to = std::min(start + chunkSize, it->pos + it->size);
+				if (from < to)
+					memcpy(&staging[from - start], it->src + (from - it->pos), to - from);
+			}
+
+			size_t result = ctx ? ZstdCompressChunk(ctx, &scratch[0], scratch.size(), &staging[0], chunkSize) : 0;
+			frames_[i].assign(scratch.begin(), scratch.begin() + result);
+		}
+		ZSTD_freeCCtx(ctx);
+	}, 0, (int)chunkCount, 1);
+
+	outSize = ZstdChunkedHeaderSize(chunkCount);
+	for (const auto &frame : frames_) {
+		if (frame.empty() || frame.size() > 0xFFFFFFFF)
+			return false;
+		outSize += frame.size();
+	}
+	out = (u8 *)malloc(outSize);
+	if (!out)
+		return false;
+
+	u32_le *header = (u32_le *)out;
+	header[0] = (u32)ZSTD_CHUNK_SIZE;
+	header[1] = (u32)chunkCount;
+	size_t pos = ZstdChunkedHeaderSize(chunkCount);
+	for (size_t i = 0; i < chunkCount; ++i) {
+		header[2 + i] = (u32)frames_[i].size();
+		memcpy(out + pos, frames_[i].data(), frames_[i].size());
+		pos += frames_[i].size();
+		// Release as we go to keep the peak down.
+		std::vector<u8>().swap(frames_[i]);
+	}
+	return true;
+}
 
 PointerWrapSection PointerWrap::Section(const char *title, int ver) {
 	return Section(title, ver, ver);
@@ -106,6 +337,14 @@ void PointerWrap::DoVoid(void *data, int size) {
 	(*ptr) += size;
 }
 
+void PointerWrap::DoExternalVoid(void *data, size_t size) {
+	if (gather && mode == MODE_WRITE) {
+		gather->Add(*ptr, data, size);
+	} else if (!gather || mode != MODE_MEASURE) {
+		DoVoid(data, (int)size);
+	}
+}
+
 // Not exactly sane but might catch some corrupt files.
 const int MAX_SANE_STRING_LENGTH = 1024 * 1024;
 
@@ -327,6 +566,8 @@ CChunkFileReader::Error CChunkFileReader::LoadFile(const Path &filename, std::st
 			if (success) {
 				uncomp_size = status;
 			}
+		} else if (SerializeCompressType(header.Compress) == SerializeCompressType::ZSTD_CHUNKED) {
+			success = ZstdChunkedDecompress(uncomp_buffer, uncomp_size, buffer, sz);
 		} else {
 			ERROR_LOG(SAVESTATE, "ChunkReader: Unexpected compression type %d", header.Compress);
 		}
@@ -359,7 +600,7 @@ CChunkFileReader::Error CChunkFileReader::LoadFile(const Path &filename, std::st
 }
 
 // Takes ownership of buffer.
-CChunkFileReader::Error CChunkFileReader::SaveFile(const Path &filename, const std::string &title, const char *gitVersion, u8 *buffer, size_t sz) {
+CChunkFileReader::Error CChunkFileReader::SaveFile(const Path &filename, const std::string &title, const char *gitVersion, u8 *buffer, size_t sz, SerializeGather *gather) {
 	INFO_LOG(SAVESTATE, "ChunkReader: Writing %s", filename.c_str());
 
 	File::IOFile pFile(filename, "wb");
@@ -369,65 +610,84 @@ CChunkFileReader::Error CChunkFileReader::SaveFile(const Path &filename, const s
 		return ERROR_BAD_FILE;
 	}
 
-	// Make sure we can allocate a buffer to compress before compressing.
 	size_t write_len;
-	SerializeCompressType usedType = SAVE_TYPE;
-	switch (usedType) {
-	case SerializeCompressType::NONE:
-		write_len = 0;
-		break;
-	case SerializeCompressType::SNAPPY:
-		write_len = snappy_max_compressed_length(sz);
-		break;
-	case SerializeCompressType::ZSTD:
-		write_len = ZSTD_compressBound(sz);
-		break;
-	}
-	u8 *compressed_buffer = write_len == 0 ? nullptr : (u8 *)malloc(write_len);
 	u8 *write_buffer = buffer;
-	if (!compressed_buffer) {
-		if (write_len != 0)
-			ERROR_LOG(SAVESTATE, "ChunkReader: Unable to allocate compressed buffer");
-		// We'll save uncompressed.  Better than not saving...
-		write_len = sz;
-		usedType = SerializeCompressType::NONE;
+	SerializeCompressType usedType = SAVE_TYPE;
+	if (gather && !gather->Empty()) {
+		// The gathered blocks only exist compressed, so there's no uncompressed fallback here.
+		bool success = gather->Finish(buffer, sz, write_buffer, write_len);
+		free(buffer);
+		if (!success) {
+			ERROR_LOG(SAVESTATE, "ChunkReader: Compression failed");
+			return ERROR_BAD_ALLOC;
+		}
+		usedType = SerializeCompressType::ZSTD_CHUNKED;
+		sz += gather->ExternalSize();
 	} else {
-		bool success = true;
+		// Make sure we can allocate a buffer to compress before compressing.
 		switch (usedType) {
 		case SerializeCompressType::NONE:
-			_assert_(false);
+			write_len = 0;
 			break;
 		case SerializeCompressType::SNAPPY:
-			success = snappy_compress((const char *)buffer, sz, (char *)compressed_buffer, &write_len) == SNAPPY_OK;
+			write_len = snappy_max_compressed_length(sz);
 			break;
 		case SerializeCompressType::ZSTD:
-			{
-				auto ctx = ZSTD_createCCtx();
-				if (!ctx) {
-					success = false;
-				} else {
-					// TODO: If free disk space is low, we could max this out to 22?
-					ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
-					ZSTD_CCtx_setParameter(ctx, ZSTD_c_checksumFlag, 1);
-					ZSTD_CCtx_setPledgedSrcSize(ctx, sz);
-					write_len = ZSTD_compress2(ctx, compressed_buffer, write_len, buffer, sz);
-					success = !ZSTD_isError(write_len);
-				}
-				ZSTD_freeCCtx(ctx);
-			}
+			write_len = ZSTD_compressBound(sz);
+			break;
+		case SerializeCompressType::ZSTD_CHUNKED:
+			write_len = ZstdChunkedBound(sz);
 			break;
 		}
-
-		if (success) {
-			free(buffer);
-			write_buffer = compressed_buffer;
-		} else {
-			ERROR_LOG(SAVESTATE, "ChunkReader: Compression failed");
-			free(compressed_buffer);
-
-			// We can still save uncompressed.
+		u8 *compressed_buffer = write_len == 0 ? nullptr : (u8 *)malloc(write_len);
+		if (!compressed_buffer) {
+			if (write_len != 0)
+				ERROR_LOG(SAVESTATE, "ChunkReader: Unable to allocate compressed buffer");
+			// We'll save uncompressed.  Better than not saving...
 			write_len = sz;
 			usedType = SerializeCompressType::NONE;
+		} else {
+			bool success = true;
+			switch (usedType) {
+			case SerializeCompressType::NONE:
+				_assert_(false);
+				break;
+			case SerializeCompressType::SNAPPY:
+				success = snappy_compress((const char *)buffer, sz, (char *)compressed_buffer, &write_len) == SNAPPY_OK;
+				break;
+			case SerializeCompressType::ZSTD:
+				{
+					auto ctx = ZSTD_createCCtx();
+					if (!ctx) {
+						success = false;
+					} else {
+						// TODO: If free disk space is low, we could max this out to 22?
+						ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
+						ZSTD_CCtx_setParameter(ctx, ZSTD_c_checksumFlag, 1);
+						ZSTD_CCtx_setPledgedSrcSize(ctx, sz);
+						write_len = ZSTD_compress2(ctx, compressed_buffer, write_len, buffer, sz);
+						success = !ZSTD_isError(write_len);
+					}
+					ZSTD_freeCCtx(ctx);
+				}
+				break;
+			case SerializeCompressType::ZSTD_CHUNKED:
+				write_len = ZstdChunkedCompress(compressed_buffer, buffer, sz);
+				success = write_len != 0;
+				break;
+			}
+
+			if (success) {
+				free(buffer);
+				write_buffer = compressed_buffer;
+			} else {
+				ERROR_LOG(SAVESTATE, "ChunkReader: Compression failed");
+				free(compressed_buffer);
+
+				// We can still save uncompressed.
+				write_len = sz;
+				usedType = SerializeCompressType::NONE;
+			}
 		}
 	}
 
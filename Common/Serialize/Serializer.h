@@ -49,6 +49,44 @@ struct LinkedListItem : public T
 
 class PointerWrap;
 
+// Large blocks (like RAM) that MODE_WRITE references instead of copying into the state buffer.
+// They're compressed as ZSTD_CHUNKED frames right away, since the memory may change after DoState.
+class SerializeGather
+{
+public:
+	// Must be called with the buffer before the MODE_WRITE pass.
+	void Begin(const u8 *base);
+	void Add(const u8 *inlinePos, const void *data, size_t size);
+
+	bool Empty() const {
+		return blocks_.empty();
+	}
+	size_t ExternalSize() const {
+		return externalSize_;
+	}
+
+	// Produces the compressed stream of the inline data with the blocks spliced in.  out is malloc()ed.
+	bool Finish(const u8 *inlineData, size_t inlineSize, u8 *&out, size_t &outSize);
+
+private:
+	struct Block {
+		size_t inlinePos;
+		size_t pos;
+	};
+	struct Piece {
+		size_t pos;
+		std::vector<u8> data;
+	};
+
+	const u8 *base_ = nullptr;
+	size_t externalSize_ = 0;
+	std::vector<Block> blocks_;
+	std::vector<Piece> pieces_;
+	// Compressed chunks that lay entirely within a block.  Empty if not compressed yet.
+	std::vector<std::vector<u8>> frames_;
+	bool failed_ = false;
+};
+
 class PointerWrapSection
 {
 public:
@@ -93,6 +131,8 @@ class PointerWrap
 	u8 **ptr;
 	Mode mode;
 	Error error = ERROR_NONE;
+	// If set, DoExternalVoid() doesn't take space in the buffer when measuring or writing.
+	SerializeGather *gather = nullptr;
 
 	PointerWrap(u8 **ptr_, Mode mode_) : ptr(ptr_), mode(mode_) {}
 	PointerWrap(unsigned char **ptr_, int mode_) : ptr((u8**)ptr_), mode((Mode)mode_) {}
@@ -116,6 +156,8 @@ class PointerWrap
 	// Same as DoVoid, except doesn't advance pointer if it doesn't match on read.
 	bool ExpectVoid(void *data, int size);
 	void DoVoid(void *data, int size);
+	// For big blocks of memory that stay unchanged until the state is written.
+	void DoExternalVoid(void *data, size_t size);
 
 	void DoMarker(const char *prevName, u32 arbitraryNumber = 0x42);
 
@@ -150,20 +192,24 @@ class CChunkFileReader
 	}
 
 	template<class T>
-	static size_t MeasurePtr(T &_class)
+	static size_t MeasurePtr(T &_class, SerializeGather *gather = nullptr)
 	{
 		u8 *ptr = 0;
 		PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+		p.gather = gather;
 		_class.DoState(p);
 		return (size_t)ptr;
 	}
 
 	// Expects ptr to have at least MeasurePtr bytes at ptr.
 	template<class T>
-	static Error SavePtr(u8 *ptr, T &_class, size_t expected_size)
+	static Error SavePtr(u8 *ptr, T &_class, size_t expected_size, SerializeGather *gather = nullptr)
 	{
 		const u8 *expected_end = ptr + expected_size;
 		PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+		if (gather)
+			gather->Begin(ptr);
+		p.gather = gather;
 		_class.DoState(p);
 
 		if (p.error != p.ERROR_FAILURE && (expected_end == ptr || expected_size == 0)) {
@@ -197,16 +243,19 @@ class CChunkFileReader
 	template<class T>
 	static Error Save(const Path &filename, const std::string &title, const char *gitVersion, T& _class)
 	{
-		// Get data
-		size_t const sz = MeasurePtr(_class);
+		// Get data.  Large blocks go straight to the compressor rather than into buffer.
+		SerializeGather gather;
+		size_t const sz = MeasurePtr(_class, &gather);
 		u8 *buffer = (u8 *)malloc(sz);
-		if (!buffer)
+		if (!buffer && sz != 0)
 			return ERROR_BAD_ALLOC;
-		Error error = SavePtr(buffer, _class, sz);
+		Error error = SavePtr(buffer, _class, sz, &gather);
 
 		// SaveFile takes ownership of buffer
 		if (error == ERROR_NONE)
-			error = SaveFile(filename, title, gitVersion, buffer, sz);
+			error = SaveFile(filename, title, gitVersion, buffer, sz, &gather);
+		else
+			free(buffer);
 		return error;
 	}
 	
@@ -236,6 +285,9 @@ class CChunkFileReader
 
 	static Error GetFileTitle(const Path &filename, std::string *title);
 
+	// Compresses and writes out a buffer from SavePtr.  Takes ownership of buffer, which must be from malloc().
+	static Error SaveFile(const Path &filename, const std::string &title, const char *gitVersion, u8 *buffer, size_t sz, SerializeGather *gather = nullptr);
+
 private:
 	struct SChunkHeader
 	{
@@ -253,6 +305,5 @@ class CChunkFileReader
 	};
 
 	static Error LoadFile(const Path &filename, std::string *gitVersion, u8 *&buffer, size_t &sz, std::string *failureReason);
-	static Error SaveFile(const Path &filename, const std::string &title, const char *gitVersion, u8 *buffer, size_t sz);
 	static Error LoadFileHeader(File::IOFile &pFile, SChunkHeader &header, std::string *title);
 };
@@ -2,7 +2,6 @@
 #include <cstring>
 
 #include "Common/Thread/ParallelLoop.h"
-#include "Common/CPUDetect.h"
 
 class LoopRangeTask : public Task {
 public:
@@ -13,6 +12,10 @@ class LoopRangeTask : public Task {
 		return TaskType::CPU_COMPUTE;
 	}
 
+	TaskPriority Priority() const override {
+		return TaskPriority::CRITICAL;
+	}
+
 	void Run() override {
 		loop_(lower_, upper_);
 		counter_->Count();
@@ -83,27 +86,6 @@ WaitableCounter *ParallelRangeLoopWaitable(ThreadManager *threadMan, const std::
 	}
 }
 
-void ParallelRangeLoop(ThreadManager *threadMan, const std::function<void(int, int)> &loop, int lower, int upper, int minSize) {
-	if (cpu_info.num_cores == 1 || (minSize >= (upper - lower) && upper > lower)) {
-		// "Optimization" for single-core devices, or minSize larger than the range.
-		// No point in adding threading overhead, let's just do it inline (since this is the blocking variant).
-		loop(lower, upper);
-		return;
-	}
-
-	if (minSize < 1) {
-		// There's no obvious value to default to.
-		minSize = 1;
-	}
-
-	WaitableCounter *counter = ParallelRangeLoopWaitable(threadMan, loop, lower, upper, minSize);
-	// TODO: Optimize using minSize. We'll just compute whether there's a remainer, remove it from the call to ParallelRangeLoopWaitable,
-	// and process the remainder right here. If there's no remainer, we'll steal a whole chunk.
-	if (counter) {
-		counter->WaitAndRelease();
-	}
-}
-
 // NOTE: Supports a max of 2GB.
 void ParallelMemcpy(ThreadManager *threadMan, void *dst, const void *src, size_t bytes) {
 	// This threshold can probably be a lot bigger.
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <mutex>
 #include <condition_variable>
@@ -38,8 +39,79 @@ struct WaitableCounter : public Waitable {
 // Note that upper bounds are non-inclusive: range is [lower, upper)
 WaitableCounter *ParallelRangeLoopWaitable(ThreadManager *threadMan, const std::function<void(int, int)> &loop, int lower, int upper, int minSize);
 
+// A slice of a ParallelRangeLoop, kept on the caller's stack.
+template <typename F>
+class InlineLoopRangeTask : public Task {
+public:
+	TaskType Type() const override {
+		return TaskType::CPU_COMPUTE;
+	}
+
+	// The caller blocks until all slices are done.
+	TaskPriority Priority() const override {
+		return TaskPriority::CRITICAL;
+	}
+
+	bool DeleteAfterRun() const override {
+		return false;
+	}
+
+	void Run() override {
+		(*loop_)(lower_, upper_);
+		// The caller may return as soon as this counts, so it must be the last use of this.
+		counter_->Count();
+	}
+
+	const F *loop_ = nullptr;
+	WaitableCounter *counter_ = nullptr;
+	int lower_ = 0;
+	int upper_ = 0;
+};
+
 // Note that upper bounds are non-inclusive: range is [lower, upper)
-void ParallelRangeLoop(ThreadManager *threadMan, const std::function<void(int, int)> &loop, int lower, int upper, int minSize);
+// Blocks until done. Nothing is allocated and the loop isn't wrapped in a std::function,
+// and the calling thread runs the last slice itself instead of just waiting.
+template <typename F>
+void ParallelRangeLoop(ThreadManager *threadMan, const F &loop, int lower, int upper, int minSize) {
+	// Looper threads are capped at 16, see ThreadManager.
+	static constexpr int MAX_SLICES = 16;
+
+	const int range = upper - lower;
+	if (range <= 0) {
+		return;
+	}
+	if (minSize < 1) {
+		// There's no obvious value to default to.
+		minSize = 1;
+	}
+
+	int numSlices = std::min(std::min(threadMan->GetNumLooperThreads(), range / minSize), MAX_SLICES);
+	if (numSlices <= 1) {
+		// Single core, or minSize covers the range. No point in adding threading overhead.
+		loop(lower, upper);
+		return;
+	}
+
+	InlineLoopRangeTask<F> tasks[MAX_SLICES - 1];
+	WaitableCounter counter(numSlices - 1);
+
+	// Split evenly, the remainder goes one each to the first slices.
+	const int sliceSize = range / numSlices;
+	const int remainder = range % numSlices;
+	int start = lower;
+	for (int i = 0; i < numSlices - 1; i++) {
+		const int end = start + sliceSize + (i < remainder ? 1 : 0);
+		tasks[i].loop_ = &loop;
+		tasks[i].counter_ = &counter;
+		tasks[i].lower_ = start;
+		tasks[i].upper_ = end;
+		threadMan->EnqueueTaskOnThread(i, &tasks[i]);
+		start = end;
+	}
+
+	loop(start, upper);
+	counter.Wait();
+}
 
 // Common utilities for large (!) memory copies.
 // Will only fall back to threads if it seems to make sense.
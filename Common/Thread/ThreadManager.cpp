@@ -18,20 +18,54 @@
 // * Parallel compute-limited loops should use as many threads as there are cores.
 //   They should always be scheduled to the first N threads.
 // * For some tasks, splitting the input values up linearly between the threads
-//   is not fair. However, we ignore that for now.
+//   is not fair. To even that out, idle threads steal queued tasks from busy threads
+//   of the same type (compute or I/O.)
+// * Idle compute threads spin briefly before sleeping, since parallel loops tend to
+//   come in bursts and waking a sleeping thread costs far more than the task itself.
 
 const int MAX_CORES_TO_USE = 16;
 const int MIN_IO_BLOCKING_THREADS = 4;
+const int COMPUTE_SPIN_COUNT = 64;
 
 struct GlobalThreadContext {
 	std::mutex mutex; // associated with each respective condition variable
-	std::deque<Task *> compute_queue;
+	// One queue per priority. The sizes are totals.
+	std::deque<Task *> compute_queue[(size_t)TaskPriority::COUNT];
 	std::atomic<int> compute_queue_size;
-	std::deque<Task *> io_queue;
+	std::deque<Task *> io_queue[(size_t)TaskPriority::COUNT];
 	std::atomic<int> io_queue_size;
 	std::vector<ThreadContext *> threads_;
+	// Empty unless the CPU has cores of different capacity.
+	std::vector<int> bigCores;
 
 	std::atomic<int> roundRobin;
+
+	// Both must be called with mutex locked.
+	void Push(Task *task) {
+		size_t priority = (size_t)task->Priority();
+		if (task->Type() == TaskType::CPU_COMPUTE) {
+			compute_queue[priority].push_back(task);
+			compute_queue_size++;
+		} else if (task->Type() == TaskType::IO_BLOCKING) {
+			io_queue[priority].push_back(task);
+			io_queue_size++;
+		} else {
+			_assert_(false);
+		}
+	}
+
+	Task *Pop(bool isCompute) {
+		auto &queues = isCompute ? compute_queue : io_queue;
+		for (auto &queue : queues) {
+			if (!queue.empty()) {
+				Task *task = queue.front();
+				queue.pop_front();
+				(isCompute ? compute_queue_size : io_queue_size)--;
+				return task;
+			}
+		}
+		return nullptr;
+	}
 };
 
 struct ThreadContext {
@@ -41,8 +75,13 @@ struct ThreadContext {
 	std::atomic<int> queue_size;
 	int index;
 	TaskType type;
+	// Restricted to GlobalThreadContext::bigCores.
+	bool bigCore;
 	std::atomic<bool> cancelled;
+	// Set while waiting on cond, so enqueuers can skip the lock and notify otherwise.
+	std::atomic<bool> parked;
 	std::atomic<Task *> private_single;
+	// The owner takes from the front, thieves from the back.
 	std::deque<Task *> private_queue;
 };
 
@@ -77,14 +116,19 @@ void ThreadManager::Teardown() {
 		};
 
 		std::unique_lock<std::mutex> lock(global_->mutex);
-		while (!drainQueue(global_->compute_queue, global_->compute_queue_size))
-			continue;
-		while (!drainQueue(global_->io_queue, global_->io_queue_size))
-			continue;
+		for (size_t i = 0; i < (size_t)TaskPriority::COUNT; i++) {
+			while (!drainQueue(global_->compute_queue[i], global_->compute_queue_size))
+				continue;
+			while (!drainQueue(global_->io_queue[i], global_->io_queue_size))
+				continue;
+		}
 	}
 
+	// Join them all before deleting any, the others might still be looking for tasks to steal.
 	for (ThreadContext *&threadCtx : global_->threads_) {
 		threadCtx->thread.join();
+	}
+	for (ThreadContext *&threadCtx : global_->threads_) {
 		// TODO: Is it better to just delete these?
 		TeardownTask(threadCtx->private_single, true);
 		for (Task *task : threadCtx->private_queue) {
@@ -110,28 +154,49 @@ bool ThreadManager::TeardownTask(Task *task, bool enqueue) {
 	}
 
 	if (enqueue) {
-		if (task->Type() == TaskType::CPU_COMPUTE) {
-			global_->compute_queue.push_back(task);
-			global_->compute_queue_size++;
-		} else if (task->Type() == TaskType::CPU_COMPUTE) {
-			global_->io_queue.push_back(task);
-			global_->io_queue_size++;
-		} else {
-			_assert_(false);
-		}
+		global_->Push(task);
 	}
 	return false;
 }
 
+// Takes a task that was queued on another thread of the same type. Never waits for a lock.
+static Task *StealTask(GlobalThreadContext *global, ThreadContext *thread) {
+	for (ThreadContext *victim : global->threads_) {
+		if (victim == thread || victim->type != thread->type || victim->queue_size.load() == 0)
+			continue;
+
+		Task *task = victim->private_single.exchange(nullptr);
+		if (!task) {
+			std::unique_lock<std::mutex> lock(victim->mutex, std::try_to_lock);
+			if (lock.owns_lock() && !victim->private_queue.empty()) {
+				task = victim->private_queue.back();
+				victim->private_queue.pop_back();
+			}
+		}
+		if (task) {
+			victim->queue_size--;
+			thread->queue_size++;
+			return task;
+		}
+	}
+	return nullptr;
+}
+
 static void WorkerThreadFunc(GlobalThreadContext *global, ThreadContext *thread) {
 	char threadName[16];
 	snprintf(threadName, sizeof(threadName), "PoolWorker %d", thread->index);
 	SetCurrentThreadName(threadName);
+	if (thread->bigCore)
+		SetCurrentThreadAffinity(global->bigCores);
 
 	const bool isCompute = thread->type == TaskType::CPU_COMPUTE;
 	const auto global_queue_size = [isCompute, &global]() -> int {
 		return isCompute ? global->compute_queue_size.load() : global->io_queue_size.load();
 	};
+	// While idle, queue_size only counts tasks queued on this thread.
+	const auto has_work = [&]() -> bool {
+		return thread->queue_size.load() > 0 || global_queue_size() > 0 || thread->cancelled;
+	};
 
 	while (!thread->cancelled) {
 		Task *task = thread->private_single.exchange(nullptr);
@@ -140,21 +205,25 @@ static void WorkerThreadFunc(GlobalThreadContext *global, ThreadContext *thread)
 		if (!task && global_queue_size() > 0) {
 			// Grab one from the global queue if there is any.
 			std::unique_lock<std::mutex> lock(global->mutex);
-			auto &queue = isCompute ? global->compute_queue : global->io_queue;
-			auto &queue_size = isCompute ? global->compute_queue_size : global->io_queue_size;
-
-			if (!queue.empty()) {
-				task = queue.front();
-				queue.pop_front();
-				queue_size--;
-
+			task = global->Pop(isCompute);
+			if (task) {
 				// We are processing one now, so mark that.
 				thread->queue_size++;
 			}
 		}
 
+		if (!task && thread->queue_size.load() == 0) {
+			task = StealTask(global, thread);
+			if (!task && isCompute) {
+				for (int i = 0; i < COMPUTE_SPIN_COUNT && !has_work(); ++i)
+					std::this_thread::yield();
+			}
+		}
+
 		if (!task) {
 			std::unique_lock<std::mutex> lock(thread->mutex);
+			// Must be set before checking single, see EnqueueTaskOnThread.
+			thread->parked = true;
 			// We must check both queue and single again, while locked.
 			bool wait = true;
 			if (!thread->private_queue.empty()) {
@@ -169,12 +238,15 @@ static void WorkerThreadFunc(GlobalThreadContext *global, ThreadContext *thread)
 
 			if (wait)
 				thread->cond.wait(lock);
+			thread->parked = false;
 		}
 		// The task itself takes care of notifying anyone waiting on it. Not the
 		// responsibility of the ThreadManager (although it could be!).
 		if (task) {
+			const bool deleteTask = task->DeleteAfterRun();
 			task->Run();
-			delete task;
+			if (deleteTask)
+				delete task;
 
 			// Reduce the queue size once complete.
 			thread->queue_size--;
@@ -192,17 +264,26 @@ void ThreadManager::Init(int numRealCores, int numLogicalCoresPerCpu) {
 	int numThreads = numComputeThreads_ + std::max(MIN_IO_BLOCKING_THREADS, numComputeThreads_);
 	numThreads_ = numThreads;
 
-	INFO_LOG(SYSTEM, "ThreadManager::Init(compute threads: %d, all: %d)", numComputeThreads_, numThreads_);
+	global_->bigCores = GetBigCores();
+	const int numBigThreads = std::min((int)global_->bigCores.size(), numComputeThreads_);
 
+	INFO_LOG(SYSTEM, "ThreadManager::Init(compute threads: %d, all: %d, on big cores: %d)", numComputeThreads_, numThreads_, numBigThreads);
+
+	// Workers look at each other to steal tasks, so all contexts must exist before any starts.
 	for (int i = 0; i < numThreads; i++) {
 		ThreadContext *thread = new ThreadContext();
 		thread->cancelled.store(false);
+		thread->parked.store(false);
+		thread->queue_size.store(0);
 		thread->private_single.store(nullptr);
 		thread->type = i < numComputeThreads_ ? TaskType::CPU_COMPUTE : TaskType::IO_BLOCKING;
-		thread->thread = std::thread(&WorkerThreadFunc, global_, thread);
+		thread->bigCore = i < numBigThreads;
 		thread->index = i;
 		global_->threads_.push_back(thread);
 	}
+	for (ThreadContext *thread : global_->threads_) {
+		thread->thread = std::thread(&WorkerThreadFunc, global_, thread);
+	}
 }
 
 void ThreadManager::EnqueueTask(Task *task) {
@@ -220,9 +301,12 @@ void ThreadManager::EnqueueTask(Task *task) {
 		maxThread = numThreads_;
 	}
 
-	// Find a thread with no outstanding work.
+	// Find a thread with no outstanding work. Background work looks from the end, so the
+	// first threads (on the big cores, if any) stay free for more urgent tasks.
 	_assert_(maxThread <= global_->threads_.size());
-	for (int threadNum = minThread; threadNum < maxThread; threadNum++) {
+	const bool background = task->Priority() == TaskPriority::BACKGROUND;
+	for (int i = 0; i < maxThread - minThread; i++) {
+		int threadNum = background ? maxThread - 1 - i : minThread + i;
 		ThreadContext *thread = global_->threads_[threadNum];
 		if (thread->queue_size.load() == 0) {
 			std::unique_lock<std::mutex> lock(thread->mutex);
@@ -238,15 +322,7 @@ void ThreadManager::EnqueueTask(Task *task) {
 	// Not particularly scientific, but hopefully we should not run into this too much.
 	{
 		std::unique_lock<std::mutex> lock(global_->mutex);
-		if (task->Type() == TaskType::CPU_COMPUTE) {
-			global_->compute_queue.push_back(task);
-			global_->compute_queue_size++;
-		} else if (task->Type() == TaskType::IO_BLOCKING) {
-			global_->io_queue.push_back(task);
-			global_->io_queue_size++;
-		} else {
-			_assert_(false);
-		}
+		global_->Push(task);
 	}
 
 	int chosenIndex = global_->roundRobin++;
@@ -262,15 +338,20 @@ void ThreadManager::EnqueueTaskOnThread(int threadNum, Task *task) {
 	_assert_msg_(threadNum >= 0 && threadNum < (int)global_->threads_.size(), "Bad threadnum or not initialized");
 	ThreadContext *thread = global_->threads_[threadNum];
 
+	// Whether we get single or will have to wait, increase the queue counter.
+	// Done first so a thief never sees the task without the count.
+	thread->queue_size++;
+
 	// Try first atomically, as highest priority.
 	Task *expected = nullptr;
 	bool queued = thread->private_single.compare_exchange_weak(expected, task);
-	// Whether we got that or will have to wait, increase the queue counter.
-	thread->queue_size++;
 
 	if (queued) {
-		std::unique_lock<std::mutex> lock(thread->mutex);
-		thread->cond.notify_one();
+		// The worker sets parked before its last check of single, so if it's not parked it will see the task.
+		if (thread->parked) {
+			std::unique_lock<std::mutex> lock(thread->mutex);
+			thread->cond.notify_one();
+		}
 	} else {
 		std::unique_lock<std::mutex> lock(thread->mutex);
 		thread->private_queue.push_back(task);
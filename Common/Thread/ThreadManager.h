@@ -10,13 +10,26 @@ enum class TaskType {
 	IO_BLOCKING,
 };
 
+// Tasks waiting in the shared queues run in this order. CRITICAL is for work something is
+// blocked on right now (like a shader compile on a miss), BACKGROUND for anything that can wait.
+enum class TaskPriority {
+	CRITICAL,
+	NORMAL,
+	BACKGROUND,
+	COUNT,
+};
+
 // Implement this to make something that you can run on the thread manager.
 class Task {
 public:
 	virtual ~Task() {}
 	virtual TaskType Type() const = 0;
+	virtual TaskPriority Priority() const { return TaskPriority::NORMAL; }
 	virtual void Run() = 0;
 	virtual bool Cancellable() { return false; }
+	// If false, the ThreadManager neither deletes the task nor touches it after Run() returns,
+	// so it can live on the stack of a thread that waits for it.
+	virtual bool DeleteAfterRun() const { return true; }
 	virtual void Cancel() {}
 	virtual uint64_t id() { return 0; }
 };
@@ -42,8 +55,8 @@ class ThreadManager {
 	~ThreadManager();
 
 	// The distinction here is to be able to take hyper-threading into account.
-	// It gets even trickier when you think about mobile chips with BIG/LITTLE, but we'll
-	// just ignore it and let the OS handle it.
+	// On big.LITTLE chips, the first compute threads are kept on the big cores where
+	// the kernel tells us which those are. CRITICAL tasks prefer those threads.
 	void Init(int numCores, int numLogicalCoresPerCpu);
 	void EnqueueTask(Task *task);
 	void EnqueueTaskOnThread(int threadNum, Task *task);
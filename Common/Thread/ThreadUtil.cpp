@@ -16,10 +16,13 @@
 
 #endif
 
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
 #include <cstdint>
 
 #include "Common/Log.h"
+#include "Common/Profiler/Profiler.h"
 #include "Common/Thread/ThreadUtil.h"
 #include "Common/Data/Encoding/Utf8.h"
 
@@ -34,6 +37,10 @@
 #include <sys/syscall.h>
 #endif
 
+#if PPSSPP_PLATFORM(ANDROID) || PPSSPP_PLATFORM(LINUX)
+#include <sched.h>
+#endif
+
 #if defined(__DragonFly__) || defined(__FreeBSD__) || defined(__OpenBSD__)
 #include <pthread_np.h>
 #elif defined(__NetBSD__)
@@ -116,6 +123,8 @@ void SetCurrentThreadName(const char* threadName) {
 	pthread_setname_np(pthread_self(), "%s", (void*)threadName);
 #endif
 
+	Profiler_SetThreadName(threadName);
+
 	// Set the locally known threadname using a thread local variable.
 #ifdef TLS_SUPPORTED
 	curThreadName = threadName;
@@ -182,6 +191,51 @@ void SetCurrentThreadNameThroughException(const char *threadName) {
 }
 #endif
 
+std::vector<int> GetBigCores() {
+	std::vector<int> bigCores;
+#if PPSSPP_PLATFORM(ANDROID) || PPSSPP_PLATFORM(LINUX)
+	int numCores = (int)sysconf(_SC_NPROCESSORS_CONF);
+	std::vector<int> capacity;
+	int maxCapacity = 0;
+	int minCapacity = 0x7FFFFFFF;
+	for (int i = 0; i < numCores; i++) {
+		char path[128];
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpu_capacity", i);
+		FILE *f = fopen(path, "r");
+		if (!f)
+			return bigCores;
+		int value = 0;
+		bool valid = fscanf(f, "%d", &value) == 1;
+		fclose(f);
+		if (!valid)
+			return bigCores;
+		capacity.push_back(value);
+		maxCapacity = std::max(maxCapacity, value);
+		minCapacity = std::min(minCapacity, value);
+	}
+
+	if (maxCapacity != minCapacity) {
+		for (int i = 0; i < numCores; i++) {
+			if (capacity[i] == maxCapacity)
+				bigCores.push_back(i);
+		}
+	}
+#endif
+	return bigCores;
+}
+
+bool SetCurrentThreadAffinity(const std::vector<int> &cores) {
+#if PPSSPP_PLATFORM(ANDROID) || PPSSPP_PLATFORM(LINUX)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int core : cores)
+		CPU_SET(core, &set);
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
 void AssertCurrentThreadName(const char *threadName) {
 #ifdef TLS_SUPPORTED
 	if (strcmp(curThreadName, threadName) != 0) {
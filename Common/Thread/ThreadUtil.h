@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mutex>
+#include <vector>
 
 // Note that name must be a global string that lives until the end of the process,
 // for AssertCurrentThreadName to work.
@@ -10,3 +11,9 @@ void AssertCurrentThreadName(const char *threadName);
 // Just gets a cheap thread identifier so that you can see different threads in debug output,
 // exactly what it is is badly specified and not useful for anything.
 int GetCurrentThreadIdForDebug();
+
+// The logical cores with the highest capacity on a big.LITTLE style CPU, as reported by the kernel.
+// Empty if all cores are equal or it's not known (only Linux and Android report it.)
+std::vector<int> GetBigCores();
+// Restricts the current thread to the given logical cores. Returns false if not supported.
+bool SetCurrentThreadAffinity(const std::vector<int> &cores);
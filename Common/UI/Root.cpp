@@ -24,6 +24,9 @@ static std::mutex eventMutex_;
 static std::function<void(UISound)> soundCallback;
 static bool soundEnabled = true;
 
+// Views may be modified from other threads, like download callbacks.
+static std::atomic<int> layoutGeneration;
+
 struct DispatchQueueItem {
 	Event *e;
 	EventParams params;
@@ -44,6 +47,10 @@ void EventTriggered(Event *e, EventParams params) {
 }
 
 void DispatchEvents() {
+	if (hasDispatchQueue) {
+		// Handlers can change anything.
+		InvalidateLayout();
+	}
 	while (hasDispatchQueue) {
 		DispatchQueueItem item;
 		{
@@ -86,6 +93,14 @@ void RemoveQueuedEventsByEvent(Event *event) {
 	}
 }
 
+void InvalidateLayout() {
+	layoutGeneration++;
+}
+
+int GetLayoutGeneration() {
+	return layoutGeneration;
+}
+
 View *GetFocusedView() {
 	return focusedView;
 }
@@ -207,6 +222,7 @@ bool IsScrollKey(const KeyInput &input) {
 }
 
 bool KeyEvent(const KeyInput &key, ViewGroup *root) {
+	InvalidateLayout();
 	bool retval = false;
 	// Ignore repeats for focus moves.
 	if ((key.flags & (KEY_DOWN | KEY_IS_REPEAT)) == KEY_DOWN) {
@@ -284,6 +300,7 @@ static void ProcessHeldKeys(ViewGroup *root) {
 }
 
 bool TouchEvent(const TouchInput &touch, ViewGroup *root) {
+	InvalidateLayout();
 	focusForced = false;
 	root->Touch(touch);
 	if ((touch.flags & TOUCH_DOWN) && !focusForced) {
@@ -378,6 +395,7 @@ bool AxisEvent(const AxisInput &axis, ViewGroup *root) {
 	}
 	}
 
+	InvalidateLayout();
 	root->Axis(axis);
 	return true;
 }
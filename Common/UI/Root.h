@@ -19,6 +19,11 @@ void RemoveQueuedEventsByView(View * v);
 void EventTriggered(Event *e, EventParams params);
 void DispatchEvents();
 
+// Bumped by anything that can change the measured size or position of views: input, events,
+// and setters like SetText or SetVisibility. Screens only lay out their views again when it changes.
+void InvalidateLayout();
+int GetLayoutGeneration();
+
 class ViewGroup;
 
 void LayoutViewHierarchy(const UIContext &dc, ViewGroup *root, bool ignoreInsets);
@@ -44,6 +44,7 @@ void UIScreen::DoRecreateViews() {
 			defaultView->SetFocus();
 		}
 		recreateViews_ = false;
+		layoutGeneration_ = -1;
 
 		if (persisting && root_ != nullptr) {
 			root_->PersistData(UI::PERSIST_RESTORE, "root", persisted);
@@ -112,7 +113,7 @@ void UIScreen::render() {
 
 	if (root_) {
 		UIContext *uiContext = screenManager()->getUIContext();
-		UI::LayoutViewHierarchy(*uiContext, root_, ignoreInsets_);
+		LayoutViews();
 
 		uiContext->PushTransform({translation_, scale_, alpha_});
 
@@ -125,6 +126,23 @@ void UIScreen::render() {
 	}
 }
 
+void UIScreen::LayoutViews() {
+	if (!root_)
+		return;
+
+	const UIContext &dc = *screenManager()->getUIContext();
+	Bounds bounds = ignoreInsets_ ? dc.GetBounds() : dc.GetLayoutBounds();
+	bool boundsChanged = bounds.x != layoutBounds_.x || bounds.y != layoutBounds_.y || bounds.w != layoutBounds_.w || bounds.h != layoutBounds_.h;
+	// Read before layout, in case laying out invalidates it again.
+	int generation = UI::GetLayoutGeneration();
+	if (generation == layoutGeneration_ && !boundsChanged)
+		return;
+
+	UI::LayoutViewHierarchy(dc, root_, ignoreInsets_);
+	layoutGeneration_ = generation;
+	layoutBounds_ = bounds;
+}
+
 TouchInput UIScreen::transformTouch(const TouchInput &touch) {
 	TouchInput updated = touch;
 
@@ -435,12 +453,15 @@ void PopupMultiChoice::UpdateText() {
 	if (!choices_)
 		return;
 	auto category = GetI18NCategory(category_);
+	std::string oldText = valueText_;
 	// Clamp the value to be safe.
 	if (*value_ < minVal_ || *value_ > minVal_ + numChoices_ - 1) {
 		valueText_ = "(invalid choice)";  // Shouldn't happen. Should be no need to translate this.
 	} else {
 		valueText_ = category ? category->T(choices_[*value_ - minVal_]) : choices_[*value_ - minVal_];
 	}
+	if (valueText_ != oldText)
+		InvalidateLayout();
 }
 
 void PopupMultiChoice::ChoiceCallback(int num) {
@@ -43,6 +43,8 @@ class UIScreen : public Screen {
 	virtual void DrawBackground(UIContext &dc) {}
 
 	virtual void RecreateViews() override { recreateViews_ = true; }
+	// Measures and lays out root_, unless nothing changed since the last time.
+	void LayoutViews();
 
 	UI::ViewGroup *root_ = nullptr;
 	Vec3 translation_ = Vec3(0.0f);
@@ -54,6 +56,8 @@ class UIScreen : public Screen {
 	void DoRecreateViews();
 
 	bool recreateViews_ = true;
+	int layoutGeneration_ = -1;
+	Bounds layoutBounds_;
 };
 
 class UIDialogScreen : public UIScreen {
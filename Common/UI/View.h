@@ -366,6 +366,7 @@ class LayoutParams {
 };
 
 View *GetFocusedView();
+void InvalidateLayout();
 
 class Tween;
 class CallbackColorTween;
@@ -417,7 +418,7 @@ class View {
 	// Called when the layout is done.
 	void SetBounds(Bounds bounds) { bounds_ = bounds; }
 	virtual const LayoutParams *GetLayoutParams() const { return layoutParams_.get(); }
-	virtual void ReplaceLayoutParams(LayoutParams *newLayoutParams) { layoutParams_.reset(newLayoutParams); }
+	virtual void ReplaceLayoutParams(LayoutParams *newLayoutParams) { layoutParams_.reset(newLayoutParams); InvalidateLayout(); }
 	const Bounds &GetBounds() const { return bounds_; }
 
 	virtual bool SetFocus();
@@ -458,7 +459,11 @@ class View {
 		enabledMeansDisabled_ = true;
 	}
 
-	virtual void SetVisibility(Visibility visibility) { visibility_ = visibility; }
+	virtual void SetVisibility(Visibility visibility) {
+		if (visibility != visibility_)
+			InvalidateLayout();
+		visibility_ = visibility;
+	}
 	Visibility GetVisibility() const { return visibility_; }
 
 	const std::string &Tag() const { return tag_; }
@@ -785,12 +790,16 @@ class InfoItem : public Item {
 	bool CanBeFocused() const override { return true; }
 
 	void SetText(const std::string &text) {
+		if (text != text_)
+			InvalidateLayout();
 		text_ = text;
 	}
 	const std::string &GetText() const {
 		return text_;
 	}
 	void SetRightText(const std::string &text) {
+		if (text != rightText_)
+			InvalidateLayout();
 		rightText_ = text;
 	}
 	void SetChoiceStyle(bool choiceStyle) {
@@ -913,7 +922,11 @@ class TextView : public InertView {
 	void GetContentDimensionsBySpec(const UIContext &dc, MeasureSpec horiz, MeasureSpec vert, float &w, float &h) const override;
 	void Draw(UIContext &dc) override;
 
-	void SetText(const std::string &text) { text_ = text; }
+	void SetText(const std::string &text) {
+		if (text != text_)
+			InvalidateLayout();
+		text_ = text;
+	}
 	const std::string &GetText() const { return text_; }
 	std::string DescribeText() const override { return GetText(); }
 	void SetSmall(bool small) { small_ = small; }
@@ -940,7 +953,7 @@ class TextView : public InertView {
 class TextEdit : public View {
 public:
 	TextEdit(const std::string &text, const std::string &title, const std::string &placeholderText, LayoutParams *layoutParams = nullptr);
-	void SetText(const std::string &text) { text_ = text; scrollPos_ = 0; caret_ = (int)text_.size(); }
+	void SetText(const std::string &text) { text_ = text; scrollPos_ = 0; caret_ = (int)text_.size(); InvalidateLayout(); }
 	void SetTextColor(uint32_t color) { textColor_ = color; hasTextColor_ = true; }
 	const std::string &GetText() const { return text_; }
 	void SetMaxLen(size_t maxLen) { maxLen_ = maxLen; }
@@ -52,6 +52,7 @@ void ViewGroup::RemoveSubview(View *view) {
 		if (views_[i] == view) {
 			views_.erase(views_.begin() + i);
 			delete view;
+			InvalidateLayout();
 			return;
 		}
 	}
@@ -72,6 +73,7 @@ void ViewGroup::Clear() {
 		views_[i] = nullptr;
 	}
 	views_.clear();
+	InvalidateLayout();
 }
 
 void ViewGroup::PersistData(PersistStatus status, std::string anonId, PersistMap &storage) {
@@ -1139,6 +1141,9 @@ void ScrollView::Update() {
 
 	if (oldPos != scrollPos_)
 		orientation_ == ORIENT_HORIZONTAL ? lastScrollPosX = scrollPos_ : lastScrollPosY = scrollPos_;
+	// Layout places the contents, so it has to run again while scrolling.
+	if (ClampedScrollPos(scrollPos_) != layoutScrollPos_)
+		InvalidateLayout();
 
 	// We load some lists asynchronously, so don't update the position until it's loaded.
 	if (rememberPos_ && ClampedScrollPos(scrollPos_) != ClampedScrollPos(*rememberPos_)) {
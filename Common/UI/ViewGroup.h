@@ -51,6 +51,7 @@ class ViewGroup : public View {
 	T *Add(T *view) {
 		std::lock_guard<std::mutex> guard(modifyLock_);
 		views_.push_back(view);
+		InvalidateLayout();
 		return view;
 	}
 
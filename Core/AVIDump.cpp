@@ -11,6 +11,10 @@
 #include <string>
 #include <cstdint>
 #include <sstream>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #ifdef USE_FFMPEG
 
@@ -26,6 +30,7 @@ extern "C" {
 #include "Common/Data/Convert/ColorConv.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/Path.h"
+#include "Common/Thread/ThreadUtil.h"
 
 #include "Core/Config.h"
 #include "Core/AVIDump.h"
@@ -61,7 +66,21 @@ static bool s_start_dumping = false;
 static int s_current_width;
 static int s_current_height;
 static int s_file_index = 0;
-static GPUDebugBuffer buf;
+
+// Frames are read back on the emu thread, but converted and encoded on a worker.
+struct QueuedFrame {
+	GPUDebugBuffer buf;
+	u32 w;
+	u32 h;
+};
+// Enough to ride out a slow keyframe without holding lots of memory.  If the encoder
+// can't keep up at all, AddFrame() waits rather than dropping frames from the file.
+static const size_t MAX_QUEUED_FRAMES = 8;
+static std::thread s_encode_thread;
+static std::mutex s_queue_lock;
+static std::condition_variable s_queue_cond;
+static std::deque<QueuedFrame> s_queue;
+static bool s_encode_running = false;
 
 static void InitAVCodec() {
 	static bool first_run = true;
@@ -84,9 +103,35 @@ bool AVIDump::Start(int w, int h)
 
 	InitAVCodec();
 	bool success = CreateAVI();
-	if (!success)
+	if (!success) {
 		CloseFile();
-	return success;
+		return false;
+	}
+
+	s_encode_running = true;
+	s_encode_thread = std::thread(&AVIDump::EncodeThread);
+	return true;
+}
+
+void AVIDump::EncodeThread() {
+	SetCurrentThreadName("AVIDump");
+
+	std::unique_lock<std::mutex> guard(s_queue_lock);
+	while (true) {
+		s_queue_cond.wait(guard, [] { return !s_queue.empty() || !s_encode_running; });
+		if (s_queue.empty())
+			break;
+
+		QueuedFrame frame = std::move(s_queue.front());
+		s_queue.pop_front();
+		// Let AddFrame() know there's room again.
+		s_queue_cond.notify_all();
+
+		guard.unlock();
+		CheckResolution(frame.w, frame.h);
+		EncodeFrame(frame.buf, frame.w, frame.h);
+		guard.lock();
+	}
 }
 
 bool AVIDump::CreateAVI() {
@@ -189,18 +234,34 @@ static void PreparePacket(AVPacket* pkt) {
 #endif
 
 void AVIDump::AddFrame() {
-	u32 w = 0;
-	u32 h = 0;
+	if (!s_encode_running)
+		return;
+
+	// Only the readback has to happen here, everything else is done on the encode thread.
+	QueuedFrame frame{};
 	if (g_Config.bDumpVideoOutput) {
-		gpuDebug->GetOutputFramebuffer(buf);
-		w = buf.GetStride();
-		h = buf.GetHeight();
+		gpuDebug->GetOutputFramebuffer(frame.buf);
+		frame.w = frame.buf.GetStride();
+		frame.h = frame.buf.GetHeight();
 	} else {
-		gpuDebug->GetCurrentFramebuffer(buf, GPU_DBG_FRAMEBUF_RENDER);
-		w = PSP_CoreParameter().renderWidth;
-		h = PSP_CoreParameter().renderHeight;
+		gpuDebug->GetCurrentFramebuffer(frame.buf, GPU_DBG_FRAMEBUF_RENDER);
+		frame.w = PSP_CoreParameter().renderWidth;
+		frame.h = PSP_CoreParameter().renderHeight;
 	}
-	CheckResolution(w, h);
+
+	std::unique_lock<std::mutex> guard(s_queue_lock);
+	s_queue_cond.wait(guard, [] { return s_queue.size() < MAX_QUEUED_FRAMES; });
+	s_queue.push_back(std::move(frame));
+	s_queue_cond.notify_all();
+}
+
+void AVIDump::EncodeFrame(const GPUDebugBuffer &buf, u32 w, u32 h) {
+#ifdef USE_FFMPEG
+	// Could happen if reopening after a resolution change failed.
+	if (!s_codec_context || !s_src_frame)
+		return;
+#endif
+
 	u8 *flipbuffer = nullptr;
 	const u8 *buffer = ConvertBufferToScreenshot(buf, false, flipbuffer, w, h);
 
@@ -272,9 +333,20 @@ void AVIDump::AddFrame() {
 }
 
 void AVIDump::Stop() {
-#ifdef USE_FFMPEG
+	if (s_encode_thread.joinable()) {
+		// The thread drains anything still queued before exiting.
+		{
+			std::lock_guard<std::mutex> guard(s_queue_lock);
+			s_encode_running = false;
+			s_queue_cond.notify_all();
+		}
+		s_encode_thread.join();
+	}
+	s_encode_running = false;
 
-	av_write_trailer(s_format_context);
+#ifdef USE_FFMPEG
+	if (s_format_context)
+		av_write_trailer(s_format_context);
 	CloseFile();
 	s_file_index = 0;
 #endif
@@ -320,14 +392,20 @@ void AVIDump::CheckResolution(int width, int height) {
 	// was dumped, then create a new file accordingly. However, is it possible for the width and height
 	// to have a value of zero. If this is the case, simply keep the last known resolution of the video
 	// for the added frame.
+	// This runs on the encode thread, so only swap the file, not the thread.
 	if ((width != s_current_width || height != s_current_height) && (width > 0 && height > 0))
 	{
-		int temp_file_index = s_file_index;
-		Stop();
-		s_file_index = temp_file_index + 1;
-		Start(width, height);
+		if (s_format_context)
+			av_write_trailer(s_format_context);
+		CloseFile();
+		s_file_index++;
+
+		s_width = width;
+		s_height = height;
 		s_current_width = width;
 		s_current_height = height;
+		if (!CreateAVI())
+			CloseFile();
 	}
 #endif // USE_FFMPEG
 }
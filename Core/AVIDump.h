@@ -7,12 +7,16 @@
 
 #include "Common/CommonTypes.h"
 
+class GPUDebugBuffer;
+
 class AVIDump
 {
 private:
 	static bool CreateAVI();
 	static void CloseFile();
 	static void CheckResolution(int width, int height);
+	static void EncodeFrame(const GPUDebugBuffer &buf, u32 w, u32 h);
+	static void EncodeThread();
 
 public:
 	static bool Start(int w, int h);
@@ -533,10 +533,12 @@ static ConfigSetting generalSettings[] = {
 	ConfigSetting("SaveLoadResetsAVdumping", &g_Config.bSaveLoadResetsAVdumping, false),
 	ConfigSetting("StateSlot", &g_Config.iCurrentStateSlot, 0, true, true),
 	ConfigSetting("EnableStateUndo", &g_Config.bEnableStateUndo, &DefaultEnableStateUndo, true, true),
+	ConfigSetting("AsyncSaveState", &g_Config.bAsyncSaveState, false, true, true),
 	ConfigSetting("StateLoadUndoGame", &g_Config.sStateLoadUndoGame, "NA", true, false),
 	ConfigSetting("StateUndoLastSaveGame", &g_Config.sStateUndoLastSaveGame, "NA", true, false),
 	ConfigSetting("StateUndoLastSaveSlot", &g_Config.iStateUndoLastSaveSlot, -5, true, false), // Start with an "invalid" value
 	ConfigSetting("RewindFlipFrequency", &g_Config.iRewindFlipFrequency, 0, true, true),
+	ConfigSetting("RunAheadFrames", &g_Config.iRunAheadFrames, 0, true, true),
 
 	ConfigSetting("ShowOnScreenMessage", &g_Config.bShowOnScreenMessages, true, true, false),
 	ConfigSetting("ShowRegionOnGameIcon", &g_Config.bShowRegionOnGameIcon, false),
@@ -563,8 +565,12 @@ static ConfigSetting generalSettings[] = {
 
 	// "default" means let emulator decide, "" means disable.
 	ConfigSetting("ReportingHost", &g_Config.sReportHost, "default"),
+	ConfigSetting("ReportPerfStats", &g_Config.bReportPerfStats, false, true, false),
 	ConfigSetting("AutoSaveSymbolMap", &g_Config.bAutoSaveSymbolMap, false, true, true),
 	ConfigSetting("CacheFullIsoInRam", &g_Config.bCacheFullIsoInRam, false, true, true),
+	ConfigSetting("RamCacheFillRate", &g_Config.iRamCacheFillRate, 0, true, true),
+	ConfigSetting("SharedInstanceCache", &g_Config.bSharedInstanceCache, false, true, false),
+	ConfigSetting("MemoryMapIso", &g_Config.bMemoryMapIso, true, true, false),
 	ConfigSetting("RemoteISOPort", &g_Config.iRemoteISOPort, 0, true, false),
 	ConfigSetting("LastRemoteISOServer", &g_Config.sLastRemoteISOServer, ""),
 	ConfigSetting("LastRemoteISOPort", &g_Config.iLastRemoteISOPort, 0),
@@ -590,6 +596,7 @@ static ConfigSetting generalSettings[] = {
 #endif
 	ConfigSetting("PauseWhenMinimized", &g_Config.bPauseWhenMinimized, false, true, true),
 	ConfigSetting("DumpDecryptedEboots", &g_Config.bDumpDecryptedEboot, false, true, true),
+	ConfigSetting("CacheDecryptedModules", &g_Config.bCacheDecryptedModules, true, true, true),
 	ConfigSetting("FullscreenOnDoubleclick", &g_Config.bFullscreenOnDoubleclick, true, false, false),
 
 	ReportedConfigSetting("MemStickInserted", &g_Config.bMemStickInserted, true, true, true),
@@ -611,6 +618,10 @@ static ConfigSetting cpuSettings[] = {
 	ConfigSetting("HideSlowWarnings", &g_Config.bHideSlowWarnings, false, true, false),
 	ConfigSetting("HideStateWarnings", &g_Config.bHideStateWarnings, false, true, false),
 	ConfigSetting("PreloadFunctions", &g_Config.bPreloadFunctions, false, true, true),
+	ConfigSetting("IRBlockCache", &g_Config.bIRBlockCache, false, true, true),
+	ConfigSetting("IRTieredCompile", &g_Config.bIRTieredCompile, false, true, true),
+	ConfigSetting("IRTraceBlocks", &g_Config.bIRTraceBlocks, false, true, true),
+	ConfigSetting("IRNativeJit", &g_Config.bIRNativeJit, false, true, true),
 	ConfigSetting("JitDisableFlags", &g_Config.uJitDisableFlags, (uint32_t)0, true, true),
 	ReportedConfigSetting("CPUSpeed", &g_Config.iLockedCPUSpeed, 0, true, true),
 
@@ -817,6 +828,8 @@ static int FastForwardModeFromString(const std::string &s) {
 		return (int)FastForwardMode::CONTINUOUS;
 	if (!strcasecmp(s.c_str(), "SKIP_FLIP"))
 		return (int)FastForwardMode::SKIP_FLIP;
+	if (!strcasecmp(s.c_str(), "TURBO"))
+		return (int)FastForwardMode::TURBO;
 	return DefaultFastForwardMode();
 }
 
@@ -826,6 +839,8 @@ std::string FastForwardModeToString(int v) {
 		return "CONTINUOUS";
 	case FastForwardMode::SKIP_FLIP:
 		return "SKIP_FLIP";
+	case FastForwardMode::TURBO:
+		return "TURBO";
 	}
 	return "CONTINUOUS";
 }
@@ -850,6 +865,7 @@ static ConfigSetting graphicsSettings[] = {
 	ConfigSetting("SoftwareRendererJit", &g_Config.bSoftwareRenderingJit, true, true, true),
 	ReportedConfigSetting("HardwareTransform", &g_Config.bHardwareTransform, true, true, true),
 	ReportedConfigSetting("SoftwareSkinning", &g_Config.bSoftwareSkinning, true, true, true),
+	ReportedConfigSetting("BatchMaterialColors", &g_Config.bBatchMaterialColors, false, true, true),
 	ReportedConfigSetting("TextureFiltering", &g_Config.iTexFiltering, 1, true, true),
 	ReportedConfigSetting("BufferFiltering", &g_Config.iBufFilter, SCALE_LINEAR, true, true),
 	ReportedConfigSetting("InternalResolution", &g_Config.iInternalResolution, &DefaultInternalResolution, true, true),
@@ -858,6 +874,7 @@ static ConfigSetting graphicsSettings[] = {
 	ReportedConfigSetting("FrameSkip", &g_Config.iFrameSkip, 0, true, true),
 	ReportedConfigSetting("FrameSkipType", &g_Config.iFrameSkipType, 0, true, true),
 	ReportedConfigSetting("AutoFrameSkip", &g_Config.bAutoFrameSkip, false, true, true),
+	ReportedConfigSetting("PerformanceGovernor", &g_Config.bPerformanceGovernor, false, true, true),
 	ConfigSetting("FrameRate", &g_Config.iFpsLimit1, 0, true, true),
 	ConfigSetting("FrameRate2", &g_Config.iFpsLimit2, -1, true, true),
 	ConfigSetting("UnthrottlingMode", &g_Config.iFastForwardMode, &DefaultFastForwardMode, &FastForwardModeToString, &FastForwardModeFromString, true, true),
@@ -869,8 +886,11 @@ static ConfigSetting graphicsSettings[] = {
 	ConfigSetting("AnisotropyLevel", &g_Config.iAnisotropyLevel, 4, true, true),
 
 	ReportedConfigSetting("VertexDecCache", &g_Config.bVertexCache, false, true, true),
+	ReportedConfigSetting("DecodedVertexCacheSizeMB", &g_Config.iDecodedVertexCacheSizeMB, 0, true, true),
 	ReportedConfigSetting("TextureBackoffCache", &g_Config.bTextureBackoffCache, false, true, true),
+	ReportedConfigSetting("TexturePageTracking", &g_Config.bTexturePageTracking, false, true, true),
 	ReportedConfigSetting("TextureSecondaryCache", &g_Config.bTextureSecondaryCache, false, true, true),
+	ReportedConfigSetting("TextureCacheBudgetMB", &g_Config.iTextureCacheBudgetMB, 0, true, true),
 	ReportedConfigSetting("VertexDecJit", &g_Config.bVertexDecoderJit, &DefaultCodeGen, false),
 
 #ifndef MOBILE_DEVICE
@@ -895,7 +915,9 @@ static ConfigSetting graphicsSettings[] = {
 	ReportedConfigSetting("TexScalingType", &g_Config.iTexScalingType, 0, true, true),
 	ReportedConfigSetting("TexDeposterize", &g_Config.bTexDeposterize, false, true, true),
 	ReportedConfigSetting("TexHardwareScaling", &g_Config.bTexHardwareScaling, false, true, true),
+	ReportedConfigSetting("TexScalingGPU", &g_Config.bTexScalingGPU, true, true, true),
 	ConfigSetting("VSyncInterval", &g_Config.bVSync, false, true, true),
+	ConfigSetting("LowLatencyPresent", &g_Config.bLowLatencyPresent, false, true, true),
 	ReportedConfigSetting("BloomHack", &g_Config.iBloomHack, 0, true, true),
 
 	// Not really a graphics setting...
@@ -906,6 +928,7 @@ static ConfigSetting graphicsSettings[] = {
 
 	ReportedConfigSetting("MemBlockTransferGPU", &g_Config.bBlockTransferGPU, true, true, true),
 	ReportedConfigSetting("DisableSlowFramebufEffects", &g_Config.bDisableSlowFramebufEffects, false, true, true),
+	ReportedConfigSetting("AsyncReadbacks", &g_Config.bAsyncReadbacks, false, true, true),
 	ReportedConfigSetting("FragmentTestCache", &g_Config.bFragmentTestCache, true, true, true),
 
 	ConfigSetting("GfxDebugOutput", &g_Config.bGfxDebugOutput, false, false, false),
@@ -916,6 +939,14 @@ static ConfigSetting graphicsSettings[] = {
 	ConfigSetting("RenderDuplicateFrames", &g_Config.bRenderDuplicateFrames, false, true, true),
 
 	ConfigSetting("ShaderCache", &g_Config.bShaderCache, true, false, false),  // Doesn't save. Ini-only.
+	ConfigSetting("SkipPendingPipelines", &g_Config.bSkipPendingPipelines, false, true, true),
+	ConfigSetting("FastPipelineCreation", &g_Config.bFastPipelineCreation, true, true, true),
+	ConfigSetting("ThreadedGE", &g_Config.bThreadedGE, false, true, true),
+	ConfigSetting("DisplayListCache", &g_Config.bDisplayListCache, false, true, true),
+	ConfigSetting("ParallelCmdRecording", &g_Config.bParallelCmdRecording, false, true, true),
+	ReportedConfigSetting("GPUVertexDecode", &g_Config.bGPUVertexDecode, false, true, true),
+	ReportedConfigSetting("ShaderDepalTextures", &g_Config.bShaderDepalTextures, false, true, true),
+	ReportedConfigSetting("BlockTransferDeferDownload", &g_Config.bBlockTransferDeferDownload, false, true, true),
 	ConfigSetting("GpuLogProfiler", &g_Config.bGpuLogProfiler, false, true, false),
 
 	ConfigSetting(false),
@@ -925,6 +956,10 @@ static ConfigSetting soundSettings[] = {
 	ConfigSetting("Enable", &g_Config.bEnableSound, true, true, true),
 	ConfigSetting("AudioBackend", &g_Config.iAudioBackend, 0, true, true),
 	ConfigSetting("ExtraAudioBuffering", &g_Config.bExtraAudioBuffering, false, true, false),
+	ConfigSetting("SincAudioResampler", &g_Config.bSincAudioResampler, false, true, false),
+	ConfigSetting("LowLatencyAudio", &g_Config.bLowLatencyAudio, false, true, false),
+	ConfigSetting("AudioDecodeAhead", &g_Config.bAudioDecodeAhead, false, true, true),
+	ConfigSetting("HardwareVideoDecode", &g_Config.bHardwareVideoDecode, false, true, true),
 	ConfigSetting("GlobalVolume", &g_Config.iGlobalVolume, VOLUME_FULL, true, true),
 	ConfigSetting("ReverbVolume", &g_Config.iReverbVolume, VOLUME_FULL, true, true),
 	ConfigSetting("AltSpeedVolume", &g_Config.iAltSpeedVolume, -1, true, true),
@@ -1146,7 +1181,10 @@ static ConfigSetting debuggerSettings[] = {
 	ConfigSetting("ShowDeveloperMenu", &g_Config.bShowDeveloperMenu, false),
 	ConfigSetting("ShowAllocatorDebug", &g_Config.bShowAllocatorDebug, false, false),
 	ConfigSetting("ShowGpuProfile", &g_Config.bShowGpuProfile, false, false),
+	ConfigSetting("ShowFrameTimeline", &g_Config.bShowFrameTimeline, false, false),
 	ConfigSetting("SkipDeadbeefFilling", &g_Config.bSkipDeadbeefFilling, false),
+	ConfigSetting("HLETrace", &g_Config.bHLETrace, false),
+	ConfigSetting("HLETraceEntries", &g_Config.iHLETraceEntries, 65536),
 	ConfigSetting("FuncHashMap", &g_Config.bFuncHashMap, false),
 	ConfigSetting("MemInfoDetailed", &g_Config.bDebugMemInfoDetailed, false),
 	ConfigSetting("DrawFrameGraph", &g_Config.bDrawFrameGraph, false),
@@ -1574,7 +1612,7 @@ void Config::DownloadCompletedCallback(http::Download &download) {
 		return;
 	}
 
-	json::JsonReader reader(data.c_str(), data.size());
+	json::JsonReader reader(std::move(data), json::InPlace());
 	const json::JsonGet root = reader.root();
 	if (!root) {
 		ERROR_LOG(LOADER, "Failed to parse json");
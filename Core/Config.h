@@ -87,6 +87,7 @@ struct Config {
 	bool bSaveLoadResetsAVdumping;
 	bool bEnableLogging;
 	bool bDumpDecryptedEboot;
+	bool bCacheDecryptedModules;
 	bool bFullscreenOnDoubleclick;
 
 	// These four are Win UI only
@@ -115,6 +116,10 @@ struct Config {
 	bool bHideSlowWarnings;
 	bool bHideStateWarnings;
 	bool bPreloadFunctions;
+	bool bIRBlockCache;
+	bool bIRTieredCompile;
+	bool bIRTraceBlocks;
+	bool bIRNativeJit;
 	uint32_t uJitDisableFlags;
 
 	bool bSeparateSASThread;
@@ -122,6 +127,10 @@ struct Config {
 	int iLockedCPUSpeed;
 	bool bAutoSaveSymbolMap;
 	bool bCacheFullIsoInRam;
+	// In MB/s, 0 for as fast as the disk allows.
+	int iRamCacheFillRate;
+	bool bSharedInstanceCache;
+	bool bMemoryMapIso;
 	int iRemoteISOPort;
 	std::string sLastRemoteISOServer;
 	int iLastRemoteISOPort;
@@ -137,6 +146,8 @@ struct Config {
 	int iInternalScreenRotation;  // The internal screen rotation angle. Useful for vertical SHMUPs and similar.
 
 	std::string sReportHost;
+	// Also collect per game performance stats and send them to the report host, in batches.
+	bool bReportPerfStats;
 	std::vector<std::string> recentIsos;
 	std::vector<std::string> vPinnedPaths;
 	std::string sLanguageIni;
@@ -158,6 +169,7 @@ struct Config {
 	bool bSoftwareRenderingJit;
 	bool bHardwareTransform; // only used in the GLES backend
 	bool bSoftwareSkinning;  // may speed up some games
+	bool bBatchMaterialColors;
 	bool bVendorBugChecksEnabled;
 
 	int iRenderingMode; // 0 = non-buffered rendering 1 = buffered rendering
@@ -171,10 +183,12 @@ struct Config {
 	bool bSustainedPerformanceMode;  // Android: Slows clocks down to avoid overheating/speed fluctuations.
 	bool bIgnoreScreenInsets;  // Android: Center screen disregarding insets if this is enabled.
 	bool bVSync;
+	bool bLowLatencyPresent;  // Vulkan/D3D11: wait for the previous frame to be displayed before starting the next.
 	int iFrameSkip;
 	int iFrameSkipType;
 	int iFastForwardMode; // See FastForwardMode in ConfigValues.h.
 	bool bAutoFrameSkip;
+	bool bPerformanceGovernor;
 
 	bool bEnableCardboardVR; // Cardboard Master Switch
 	int iCardboardScreenSize; // Screen Size (in %)
@@ -187,8 +201,11 @@ struct Config {
 	int iWindowHeight;
 
 	bool bVertexCache;
+	int iDecodedVertexCacheSizeMB;
 	bool bTextureBackoffCache;
+	bool bTexturePageTracking;
 	bool bTextureSecondaryCache;
+	int iTextureCacheBudgetMB;  // 0 = automatic, from the device's memory budget where available.
 	bool bVertexDecoderJit;
 	bool bFullScreen;
 	bool bFullScreenMulti;
@@ -203,13 +220,16 @@ struct Config {
 	int iTexScalingType; // 0 = xBRZ, 1 = Hybrid
 	bool bTexDeposterize;
 	bool bTexHardwareScaling;
+	bool bTexScalingGPU;
 	int iFpsLimit1;
 	int iFpsLimit2;
 	int iMaxRecent;
 	int iCurrentStateSlot;
 	int iRewindFlipFrequency;
+	int iRunAheadFrames;  // Frames to emulate ahead of what the game has seen, to hide its input lag. 0 = off.
 	bool bUISound;
 	bool bEnableStateUndo;
+	bool bAsyncSaveState;
 	std::string sStateLoadUndoGame;
 	std::string sStateUndoLastSaveGame;
 	int iStateUndoLastSaveSlot;
@@ -222,10 +242,19 @@ struct Config {
 	int iBloomHack; //0 = off, 1 = safe, 2 = balanced, 3 = aggressive
 	bool bBlockTransferGPU;
 	bool bDisableSlowFramebufEffects;
+	bool bAsyncReadbacks;
 	bool bFragmentTestCache;
 	int iSplineBezierQuality; // 0 = low , 1 = Intermediate , 2 = High
 	bool bHardwareTessellation;
 	bool bShaderCache;  // Hidden ini-only setting, useful for debugging shader compile times.
+	bool bSkipPendingPipelines;
+	bool bFastPipelineCreation;  // Vulkan: create pipelines unoptimized first, optimize in the background.
+	bool bThreadedGE;
+	bool bDisplayListCache;
+	bool bParallelCmdRecording;  // Vulkan: record big render passes on worker threads.
+	bool bGPUVertexDecode;
+	bool bShaderDepalTextures;  // Vulkan: apply the CLUT of paletted textures in the fragment shader.
+	bool bBlockTransferDeferDownload;  // Block transfers from a framebuffer to elsewhere in VRAM blit into a new framebuffer instead of reading back.
 
 	std::vector<std::string> vPostShaderNames; // Off for chain end (only Off for no shader)
 	std::map<std::string, float> mPostShaderSetting;
@@ -243,6 +272,10 @@ struct Config {
 	int iReverbVolume;
 	int iAltSpeedVolume;
 	bool bExtraAudioBuffering;  // For bluetooth
+	bool bSincAudioResampler;
+	bool bLowLatencyAudio;
+	bool bAudioDecodeAhead;
+	bool bHardwareVideoDecode;
 	std::string sAudioDevice;
 	bool bAutoAudioDevice;
 
@@ -289,6 +322,7 @@ struct Config {
 	bool bShowDebugStats;
 	bool bShowAudioDebug;
 	bool bShowGpuProfile;
+	bool bShowFrameTimeline;
 
 	//Analog stick tilting
 	//the base x and y tilt. this inclination is treated as (0,0) and the tilt input
@@ -489,6 +523,9 @@ struct Config {
 	bool bShowAllocatorDebug;
 	// Double edged sword: much easier debugging, but not accurate.
 	bool bSkipDeadbeefFilling;
+	// Keeps a binary trace of recent syscalls in the dump directory, see HLETrace.h.
+	bool bHLETrace;
+	int iHLETraceEntries;
 	bool bFuncHashMap;
 	bool bDebugMemInfoDetailed;
 	bool bDrawFrameGraph;
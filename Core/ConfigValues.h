@@ -121,6 +121,8 @@ enum class AutoLoadSaveState {
 enum class FastForwardMode {
 	CONTINUOUS = 0,
 	SKIP_FLIP = 2,
+	// Like SKIP_FLIP, but frames that won't be shown also skip drawing to the display framebuffer.
+	TURBO = 3,
 };
 
 enum class BackgroundAnimation {
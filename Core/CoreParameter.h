@@ -64,11 +64,15 @@ struct CoreParameter {
 	bool printfEmuLog;  // writes "emulator:" logging to stdout
 	std::string *collectEmuLog = nullptr;
 	bool headLess;   // Try to avoid messageboxes etc
+	// Headless benchmark run. GE dump replays keep looping instead of stopping after one frame.
+	bool benchmark = false;
 
 	// Internal PSP rendering resolution and scale factor.
 	int renderScaleFactor;
 	int renderWidth;
 	int renderHeight;
+	// Steps the performance governor took the resolution down from the configured one.
+	int renderScaleDrop = 0;
 
 	// Actual output resolution in pixels.
 	int pixelWidth;
@@ -84,6 +88,11 @@ struct CoreParameter {
 	bool freezeNext = false;
 	bool frozen = false;
 
+	// Run-ahead, see PSP_RunLoopWhileStateRunAhead().  Hidden frames aren't copied to the screen,
+	// speculative ones are thrown away again so they also skip audio output and frame timing.
+	bool runAheadHidden = false;
+	bool runAheadSpeculative = false;
+
 	FileLoader *mountIsoLoader = nullptr;
 
 	Compatibility compat;
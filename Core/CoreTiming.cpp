@@ -15,10 +15,12 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <atomic>
 #include <cstdio>
 #include <mutex>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/Profiler/Profiler.h"
@@ -30,8 +32,11 @@
 #include "Core/Config.h"
 #include "Core/HLE/sceKernelThread.h"
 #include "Core/HLE/sceDisplay.h"
+#include "Core/MemFault.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/Reporting.h"
+#include "GPU/GPU.h"
+#include "GPU/GPUInterface.h"
 
 static const int initialHz = 222000000;
 int CPU_HZ = 222000000;
@@ -62,12 +67,28 @@ struct BaseEvent {
 
 typedef LinkedListItem<BaseEvent> Event;
 
-Event *first;
+// The main queue is a binary heap of slots into queuedEvents, ordered by time.
+struct QueuedEvent {
+	BaseEvent event;
+	// Events at the same time run in the order they were scheduled.
+	u64 order;
+	int heapIndex;
+};
+
+static std::vector<QueuedEvent> queuedEvents;
+static std::vector<int> freeQueuedEvents;
+static std::vector<int> eventHeap;
+// For UnscheduleEvent(), keyed by userdata and type.
+static std::unordered_multimap<u64, int> eventsByKey;
+// Per event type, so IsScheduled() is cheap.
+static std::vector<int> scheduledCounts;
+static u64 nextEventOrder;
+
+// Threadsafe events are queued here first, and then moved into the main queue.
 Event *tsFirst;
 Event *tsLast;
 
-// event pools
-Event *eventPool = 0;
+// event pool
 Event *eventTsPool = 0;
 int allocatedTsEvents = 0;
 // Optimization to skip MoveEvents when possible.
@@ -130,16 +151,6 @@ u64 GetGlobalTimeUs() {
 	return lastGlobalTimeUs + usSinceLast;
 }
 
-Event* GetNewEvent()
-{
-	if(!eventPool)
-		return new Event;
-
-	Event* ev = eventPool;
-	eventPool = ev->next;
-	return ev;
-}
-
 Event* GetNewTsEvent()
 {
 	allocatedTsEvents++;
@@ -152,12 +163,6 @@ Event* GetNewTsEvent()
 	return ev;
 }
 
-void FreeEvent(Event* ev)
-{
-	ev->next = eventPool;
-	eventPool = ev;
-}
-
 void FreeTsEvent(Event* ev)
 {
 	ev->next = eventTsPool;
@@ -208,7 +213,7 @@ void RestoreRegisterEvent(int &event_type, const char *name, TimedCallback callb
 }
 
 void UnregisterAllEvents() {
-	_dbg_assert_msg_(first == nullptr, "Unregistering events with events pending - this isn't good.");
+	_dbg_assert_msg_(eventHeap.empty(), "Unregistering events with events pending - this isn't good.");
 	event_types.clear();
 	usedEventTypes.clear();
 	restoredEventTypes.clear();
@@ -233,13 +238,6 @@ void Shutdown()
 	ClearPendingEvents();
 	UnregisterAllEvents();
 
-	while(eventPool)
-	{
-		Event *ev = eventPool;
-		eventPool = ev->next;
-		delete ev;
-	}
-
 	std::lock_guard<std::mutex> lk(externalEventLock);
 	while(eventTsPool)
 	{
@@ -292,32 +290,116 @@ void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata)
 		ScheduleEvent_Threadsafe(0, event_type, userdata);
 }
 
-void ClearPendingEvents()
-{
-	while (first)
-	{
-		Event *e = first->next;
-		FreeEvent(first);
-		first = e;
+static inline u64 EventKey(int event_type, u64 userdata) {
+	return userdata ^ ((u64)event_type << 48);
+}
+
+static inline bool EventBefore(int a, int b) {
+	const QueuedEvent &ea = queuedEvents[a];
+	const QueuedEvent &eb = queuedEvents[b];
+	if (ea.event.time != eb.event.time)
+		return ea.event.time < eb.event.time;
+	return ea.order < eb.order;
+}
+
+static inline void HeapSet(size_t pos, int slot) {
+	eventHeap[pos] = slot;
+	queuedEvents[slot].heapIndex = (int)pos;
+}
+
+static void HeapSiftUp(size_t pos) {
+	int slot = eventHeap[pos];
+	while (pos > 0) {
+		size_t parent = (pos - 1) / 2;
+		if (!EventBefore(slot, eventHeap[parent]))
+			break;
+		HeapSet(pos, eventHeap[parent]);
+		pos = parent;
 	}
+	HeapSet(pos, slot);
 }
 
-void AddEventToQueue(Event* ne)
-{
-	Event* prev = NULL;
-	Event** pNext = &first;
-	for(;;)
-	{
-		Event*& next = *pNext;
-		if(!next || ne->time < next->time)
-		{
-			ne->next = next;
-			next = ne;
+static void HeapSiftDown(size_t pos) {
+	int slot = eventHeap[pos];
+	size_t size = eventHeap.size();
+	while (true) {
+		size_t child = pos * 2 + 1;
+		if (child >= size)
+			break;
+		if (child + 1 < size && EventBefore(eventHeap[child + 1], eventHeap[child]))
+			child++;
+		if (!EventBefore(eventHeap[child], slot))
+			break;
+		HeapSet(pos, eventHeap[child]);
+		pos = child;
+	}
+	HeapSet(pos, slot);
+}
+
+static void AddEventToQueue(const BaseEvent &ev) {
+	int slot;
+	if (!freeQueuedEvents.empty()) {
+		slot = freeQueuedEvents.back();
+		freeQueuedEvents.pop_back();
+	} else {
+		slot = (int)queuedEvents.size();
+		queuedEvents.push_back(QueuedEvent());
+	}
+
+	QueuedEvent &qe = queuedEvents[slot];
+	qe.event = ev;
+	qe.order = nextEventOrder++;
+	eventHeap.push_back(slot);
+	HeapSiftUp(eventHeap.size() - 1);
+
+	eventsByKey.insert(std::make_pair(EventKey(ev.type, ev.userdata), slot));
+	if (ev.type >= (int)scheduledCounts.size())
+		scheduledCounts.resize(ev.type + 1);
+	scheduledCounts[ev.type]++;
+}
+
+static void RemoveQueuedEvent(int slot) {
+	const BaseEvent &ev = queuedEvents[slot].event;
+	auto range = eventsByKey.equal_range(EventKey(ev.type, ev.userdata));
+	for (auto it = range.first; it != range.second; ++it) {
+		if (it->second == slot) {
+			eventsByKey.erase(it);
 			break;
 		}
-		prev = next;
-		pNext = &prev->next;
 	}
+	scheduledCounts[ev.type]--;
+
+	size_t pos = queuedEvents[slot].heapIndex;
+	int last = eventHeap.back();
+	eventHeap.pop_back();
+	if (pos < eventHeap.size()) {
+		HeapSet(pos, last);
+		if (pos > 0 && EventBefore(last, eventHeap[(pos - 1) / 2]))
+			HeapSiftUp(pos);
+		else
+			HeapSiftDown(pos);
+	}
+	freeQueuedEvents.push_back(slot);
+}
+
+static const BaseEvent *FirstEvent() {
+	return eventHeap.empty() ? nullptr : &queuedEvents[eventHeap[0]].event;
+}
+
+// All pending events in the order they'll run.
+static std::vector<int> SortedEvents() {
+	std::vector<int> sorted = eventHeap;
+	std::sort(sorted.begin(), sorted.end(), &EventBefore);
+	return sorted;
+}
+
+void ClearPendingEvents()
+{
+	queuedEvents.clear();
+	freeQueuedEvents.clear();
+	eventHeap.clear();
+	eventsByKey.clear();
+	scheduledCounts.clear();
 }
 
 // This must be run ONLY from within the cpu thread
@@ -325,54 +407,35 @@ void AddEventToQueue(Event* ne)
 // than Advance
 void ScheduleEvent(s64 cyclesIntoFuture, int event_type, u64 userdata)
 {
-	Event *ne = GetNewEvent();
-	ne->userdata = userdata;
-	ne->type = event_type;
-	ne->time = GetTicks() + cyclesIntoFuture;
-	AddEventToQueue(ne);
+	BaseEvent ev;
+	ev.userdata = userdata;
+	ev.type = event_type;
+	ev.time = GetTicks() + cyclesIntoFuture;
+	AddEventToQueue(ev);
 }
 
 // Returns cycles left in timer.
 s64 UnscheduleEvent(int event_type, u64 userdata)
 {
 	s64 result = 0;
-	if (!first)
-		return result;
-	while(first)
-	{
-		if (first->type == event_type && first->userdata == userdata)
-		{
-			result = first->time - GetTicks();
-
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-	if (!first)
-		return result;
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type && ptr->userdata == userdata)
-		{
-			result = ptr->time - GetTicks();
-
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
+	int lastSlot = -1;
+	auto range = eventsByKey.equal_range(EventKey(event_type, userdata));
+	std::vector<int> matches;
+	for (auto it = range.first; it != range.second; ++it) {
+		const BaseEvent &ev = queuedEvents[it->second].event;
+		if (ev.type == event_type && ev.userdata == userdata)
+			matches.push_back(it->second);
+	}
+
+	for (int slot : matches) {
+		// Like the old list walk, report the last one that would have run.
+		if (lastSlot == -1 || EventBefore(lastSlot, slot)) {
+			lastSlot = slot;
+			result = queuedEvents[slot].event.time - GetTicks();
 		}
 	}
+	for (int slot : matches)
+		RemoveQueuedEvent(slot);
 
 	return result;
 }
@@ -434,52 +497,20 @@ void RegisterMHzChangeCallback(MHzChangeCallback callback) {
 
 bool IsScheduled(int event_type)
 {
-	if (!first)
-		return false;
-	Event *e = first;
-	while (e) {
-		if (e->type == event_type)
-			return true;
-		e = e->next;
-	}
-	return false;
+	return event_type >= 0 && event_type < (int)scheduledCounts.size() && scheduledCounts[event_type] > 0;
 }
 
 void RemoveEvent(int event_type)
 {
-	if (!first)
+	if (!IsScheduled(event_type))
 		return;
-	while(first)
-	{
-		if (first->type == event_type)
-		{
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-	if (!first)
-		return;
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type)
-		{
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
-		}
+	std::vector<int> matches;
+	for (int slot : eventHeap) {
+		if (queuedEvents[slot].event.type == event_type)
+			matches.push_back(slot);
 	}
+	for (int slot : matches)
+		RemoveQueuedEvent(slot);
 }
 
 void RemoveThreadsafeEvent(int event_type)
@@ -536,16 +567,14 @@ void RemoveAllEvents(int event_type)
 //This raise only the events required while the fifo is processing data
 void ProcessFifoWaitEvents()
 {
-	while (first)
+	while (!eventHeap.empty())
 	{
-		if (first->time <= (s64)GetTicks())
+		if (FirstEvent()->time <= (s64)GetTicks())
 		{
-//			LOG(CPU, "[Scheduler] %s		 (%lld, %lld) ",
-//				first->name ? first->name : "?", (u64)GetTicks(), (u64)first->time);
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(GetTicks() - evt->time));
-			FreeEvent(evt);
+			// Remove it first, the callback may well schedule it again.
+			BaseEvent evt = *FirstEvent();
+			RemoveQueuedEvent(eventHeap[0]);
+			event_types[evt.type].callback(evt.userdata, (int)(GetTicks() - evt.time));
 		}
 		else
 		{
@@ -563,20 +592,11 @@ void MoveEvents()
 	while (tsFirst)
 	{
 		Event *next = tsFirst->next;
-		AddEventToQueue(tsFirst);
+		AddEventToQueue(*tsFirst);
+		FreeTsEvent(tsFirst);
 		tsFirst = next;
 	}
 	tsLast = NULL;
-
-	// Move free events to threadsafe pool
-	while(allocatedTsEvents > 0 && eventPool)
-	{
-		Event *ev = eventPool;
-		eventPool = ev->next;
-		ev->next = eventTsPool;
-		eventTsPool = ev;
-		allocatedTsEvents--;
-	}
 }
 
 void ForceCheck()
@@ -595,6 +615,10 @@ void ForceCheck()
 
 void Advance() {
 	PROFILE_THIS_SCOPE("advance");
+	// Events may touch GE state, so a threaded GE must be done with its lists first.
+	if (gpu)
+		gpu->SyncThread();
+
 	int cyclesExecuted = slicelength - currentMIPS->downcount;
 	globalTimer += cyclesExecuted;
 	currentMIPS->downcount = slicelength;
@@ -602,7 +626,10 @@ void Advance() {
 	if (hasTsEvents.load(std::memory_order_acquire))
 		MoveEvents();
 	ProcessFifoWaitEvents();
+	// Report memchecks caught by page protection, and protect those pages again.
+	Memory::MemFault_ProcessWatches();
 
+	const BaseEvent *first = FirstEvent();
 	if (!first) {
 		// This should never happen in PPSSPP.
 		// WARN_LOG_REPORT(TIME, "WARNING - no events in queue. Setting currentMIPS->downcount to 10000");
@@ -623,14 +650,27 @@ void Advance() {
 }
 
 void LogPendingEvents() {
-	Event *ptr = first;
-	while (ptr) {
-		//INFO_LOG(CPU, "PENDING: Now: %lld Pending: %lld Type: %d", globalTimer, ptr->time, ptr->type);
-		ptr = ptr->next;
+	for (int slot : SortedEvents()) {
+		const BaseEvent &ev = queuedEvents[slot].event;
+		DEBUG_LOG(CPU, "PENDING: Now: %lld Pending: %lld Type: %d", (long long)globalTimer, (long long)ev.time, ev.type);
 	}
 }
 
 void Idle(int maxIdle) {
+	const BaseEvent *first = FirstEvent();
+	if (first && maxIdle == 0) {
+		// Nothing can run before the next event, so stretch the slice to reach it directly
+		// rather than going through Advance() once per slice just to idle again.
+		s64 gap = (s64)first->time - (s64)GetTicks();
+		if (gap > MAX_SLICE_LENGTH)
+			gap = MAX_SLICE_LENGTH;
+		if (gap > currentMIPS->downcount) {
+			int extra = (int)gap - currentMIPS->downcount;
+			slicelength += extra;
+			currentMIPS->downcount += extra;
+		}
+	}
+
 	int cyclesDown = currentMIPS->downcount;
 	if (maxIdle != 0 && cyclesDown > maxIdle)
 		cyclesDown = maxIdle;
@@ -656,14 +696,13 @@ void Idle(int maxIdle) {
 }
 
 std::string GetScheduledEventsSummary() {
-	Event *ptr = first;
 	std::string text = "Scheduled events\n";
 	text.reserve(1000);
-	while (ptr) {
+	for (int slot : SortedEvents()) {
+		const BaseEvent *ptr = &queuedEvents[slot].event;
 		unsigned int t = ptr->type;
 		if (t >= event_types.size()) {
 			_dbg_assert_msg_(false, "Invalid event type %d", t);
-			ptr = ptr->next;
 			continue;
 		}
 		const char *name = event_types[t].name;
@@ -672,7 +711,6 @@ std::string GetScheduledEventsSummary() {
 		char temp[512];
 		sprintf(temp, "%s : %i %08x%08x\n", name, (int)ptr->time, (u32)(ptr->userdata >> 32), (u32)(ptr->userdata));
 		text += temp;
-		ptr = ptr->next;
 	}
 	return text;
 }
@@ -692,6 +730,36 @@ void Event_DoStateOld(PointerWrap &p, BaseEvent *ev)
 	usedEventTypes.insert(ev->type);
 }
 
+// Uses the same format as DoLinkedList(), which the queue used to be saved with.
+static void EventQueue_DoState(PointerWrap &p, void (*doEvent)(PointerWrap &p, BaseEvent *ev)) {
+	if (p.mode == PointerWrap::MODE_READ) {
+		ClearPendingEvents();
+		while (true) {
+			u8 shouldExist = 0;
+			Do(p, shouldExist);
+			if (shouldExist != 1) {
+				if (shouldExist != 0) {
+					WARN_LOG(SAVESTATE, "Savestate failure: incorrect item marker %d", shouldExist);
+					p.SetError(p.ERROR_FAILURE);
+				}
+				break;
+			}
+			BaseEvent ev;
+			doEvent(p, &ev);
+			AddEventToQueue(ev);
+		}
+	} else {
+		for (int slot : SortedEvents()) {
+			u8 shouldExist = 1;
+			Do(p, shouldExist);
+			BaseEvent ev = queuedEvents[slot].event;
+			doEvent(p, &ev);
+		}
+		u8 shouldExist = 0;
+		Do(p, shouldExist);
+	}
+}
+
 void DoState(PointerWrap &p) {
 	std::lock_guard<std::mutex> lk(externalEventLock);
 
@@ -718,10 +786,10 @@ void DoState(PointerWrap &p) {
 	restoredEventTypes.clear();
 
 	if (s >= 3) {
-		DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, Event_DoState>(p, first, (Event **) NULL);
+		EventQueue_DoState(p, &Event_DoState);
 		DoLinkedList<BaseEvent, GetNewTsEvent, FreeTsEvent, Event_DoState>(p, tsFirst, &tsLast);
 	} else {
-		DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, Event_DoStateOld>(p, first, (Event **) NULL);
+		EventQueue_DoState(p, &Event_DoStateOld);
 		DoLinkedList<BaseEvent, GetNewTsEvent, FreeTsEvent, Event_DoStateOld>(p, tsFirst, &tsLast);
 	}
 
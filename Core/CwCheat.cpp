@@ -393,6 +393,7 @@ void CWCheatEngine::ParseCheats() {
 	// TODO: Report errors.
 
 	cheats_ = parser.GetCheats();
+	CompileCheats();
 }
 
 u32 CWCheatEngine::GetAddress(u32 value) {
@@ -496,6 +497,18 @@ struct CheatOperation {
 	};
 };
 
+struct CheatProgramOp {
+	CheatOperation op;
+	// First line after the op, where pointer commands read their extra lines from.
+	uint32_t line;
+	// Indices into program_ to continue at normally, and when a condition fails.
+	uint32_t next;
+	uint32_t skip;
+};
+
+CWCheatEngine::~CWCheatEngine() {
+}
+
 CheatOperation CWCheatEngine::InterpretNextCwCheat(const CheatCode &cheat, size_t &i) {
 	const CheatLine &line1 = cheat.lines[i++];
 	const uint32_t &arg = line1.part2;
@@ -799,15 +812,139 @@ CheatOperation CWCheatEngine::InterpretNextOp(const CheatCode &cheat, size_t &i)
 	}
 }
 
+void CWCheatEngine::CompileCheats() {
+	program_.clear();
+	programStarts_.clear();
+
+	struct Decoded {
+		CheatOperation op;
+		size_t line;
+		size_t next;
+		size_t skip;
+	};
+	std::vector<Decoded> decoded;
+	std::vector<int> opAtLine;
+
+	for (const CheatCode &cheat : cheats_) {
+		programStarts_.push_back(program_.size());
+
+		// Skips count lines, not ops, and may land in the middle of a multi-line op, which the
+		// old interpreter then decoded from there.  So decode every line that can start an op.
+		const size_t numLines = cheat.lines.size();
+		const size_t end = numLines;
+		decoded.clear();
+		opAtLine.assign(numLines, -1);
+		std::vector<size_t> pending{ 0 };
+		while (!pending.empty()) {
+			size_t start = pending.back();
+			pending.pop_back();
+			if (start >= numLines || opAtLine[start] != -1)
+				continue;
+
+			size_t i = start;
+			Decoded d{ InterpretNextOp(cheat, i) };
+			d.line = i;
+			d.next = i;
+			d.skip = i;
+			switch (d.op.op) {
+			case CheatOp::Invalid:
+				d.next = end;
+				d.skip = end;
+				break;
+			case CheatOp::Assert:
+				d.skip = end;
+				break;
+			case CheatOp::IfEqual:
+			case CheatOp::IfNotEqual:
+			case CheatOp::IfLess:
+			case CheatOp::IfGreater:
+			case CheatOp::IfPressed:
+			case CheatOp::IfNotPressed:
+				d.skip = d.op.ifTypes.skip < numLines - i ? i + d.op.ifTypes.skip : end;
+				break;
+			case CheatOp::IfAddrEqual:
+			case CheatOp::IfAddrNotEqual:
+			case CheatOp::IfAddrLess:
+			case CheatOp::IfAddrGreater:
+				d.skip = d.op.ifAddrTypes.skip < numLines - i ? i + d.op.ifAddrTypes.skip : end;
+				break;
+			case CheatOp::CwCheatPointerCommands:
+				// Already validated to stay within the lines.
+				if (d.op.pointerCommands.count > 0)
+					d.next = i + d.op.pointerCommands.count;
+				d.skip = d.next;
+				break;
+			default:
+				break;
+			}
+
+			opAtLine[start] = (int)decoded.size();
+			decoded.push_back(d);
+			pending.push_back(d.next);
+			if (d.skip != d.next)
+				pending.push_back(d.skip);
+		}
+
+		// Lay the ops out in line order, so the common path just walks forward.
+		size_t base = program_.size();
+		std::vector<uint32_t> indexAtLine(numLines + 1, (uint32_t)(base + decoded.size()));
+		uint32_t index = (uint32_t)base;
+		for (size_t line = 0; line < numLines; ++line) {
+			if (opAtLine[line] != -1)
+				indexAtLine[line] = index++;
+		}
+		program_.resize(index);
+		for (size_t line = 0; line < numLines; ++line) {
+			if (opAtLine[line] == -1)
+				continue;
+			const Decoded &d = decoded[opAtLine[line]];
+			CheatProgramOp &op = program_[indexAtLine[line]];
+			op.op = d.op;
+			op.line = (uint32_t)d.line;
+			op.next = indexAtLine[d.next];
+			op.skip = indexAtLine[d.skip];
+		}
+	}
+	programStarts_.push_back(program_.size());
+}
+
+// Whether writing val would leave memory as it is.  Words holding a JIT block or replacement
+// read back as the emuhack, so those always count as changed.
+static bool WriteIsNoop(u32 addr, int sz, u32 val) {
+	if ((addr & (sz - 1)) != 0)
+		return false;
+	u32 word = Memory::Read_U32(addr & ~3);
+	if (MIPS_IS_EMUHACK(word))
+		return false;
+	if (sz == 1)
+		return Memory::Read_U8(addr) == (u8)val;
+	else if (sz == 2)
+		return Memory::Read_U16(addr) == (u16)val;
+	return word == val;
+}
+
+void CWCheatEngine::WriteIfChanged(u32 addr, int sz, u32 val) {
+	// Most cheats write the same value every time, and invalidating the JIT for it isn't free.
+	if (Memory::IsValidAddress(addr) && WriteIsNoop(addr, sz, val))
+		return;
+
+	InvalidateICache(addr, 4);
+	if (sz == 1)
+		Memory::Write_U8((u8)val, addr);
+	else if (sz == 2)
+		Memory::Write_U16((u16)val, addr);
+	else if (sz == 4)
+		Memory::Write_U32((u32)val, addr);
+}
+
 void CWCheatEngine::ApplyMemoryOperator(const CheatOperation &op, uint32_t(*oper)(uint32_t, uint32_t)) {
 	if (Memory::IsValidAddress(op.addr)) {
-		InvalidateICache(op.addr, 4);
 		if (op.sz == 1)
-			Memory::Write_U8((u8)oper(Memory::Read_U8(op.addr), op.val), op.addr);
+			WriteIfChanged(op.addr, op.sz, oper(Memory::Read_U8(op.addr), op.val));
 		else if (op.sz == 2)
-			Memory::Write_U16((u16)oper(Memory::Read_U16(op.addr), op.val),op. addr);
+			WriteIfChanged(op.addr, op.sz, oper(Memory::Read_U16(op.addr), op.val));
 		else if (op.sz == 4)
-			Memory::Write_U32((u32)oper(Memory::Read_U32(op.addr), op.val), op.addr);
+			WriteIfChanged(op.addr, op.sz, oper(Memory::Read_U32(op.addr), op.val));
 	}
 }
 
@@ -850,25 +987,17 @@ bool CWCheatEngine::TestIfAddr(const CheatOperation &op, bool(*oper)(int, int))
 	return false;
 }
 
-void CWCheatEngine::ExecuteOp(const CheatOperation &op, const CheatCode &cheat, size_t &i) {
+bool CWCheatEngine::ExecuteOp(const CheatOperation &op, const CheatCode &cheat, size_t nextLine) {
 	switch (op.op) {
 	case CheatOp::Invalid:
-		i = cheat.lines.size();
-		break;
+		return false;
 
 	case CheatOp::Noop:
 		break;
 
 	case CheatOp::Write:
-		if (Memory::IsValidAddress(op.addr)) {
-			InvalidateICache(op.addr, 4);
-			if (op.sz == 1)
-				Memory::Write_U8((u8)op.val, op.addr);
-			else if (op.sz == 2)
-				Memory::Write_U16((u16)op.val, op.addr);
-			else if (op.sz == 4)
-				Memory::Write_U32((u32)op.val, op.addr);
-		}
+		if (Memory::IsValidAddress(op.addr))
+			WriteIfChanged(op.addr, op.sz, op.val);
 		break;
 
 	case CheatOp::Add:
@@ -903,19 +1032,11 @@ void CWCheatEngine::ExecuteOp(const CheatOperation &op, const CheatCode &cheat,
 
 	case CheatOp::MultiWrite:
 		if (Memory::IsValidAddress(op.addr)) {
-			InvalidateICache(op.addr, op.multiWrite.count * op.multiWrite.step + op.sz);
-
 			uint32_t data = op.val;
 			uint32_t addr = op.addr;
 			for (uint32_t a = 0; a < op.multiWrite.count; a++) {
-				if (Memory::IsValidAddress(addr)) {
-					if (op.sz == 1)
-						Memory::Write_U8((u8)data, addr);
-					else if (op.sz == 2)
-						Memory::Write_U16((u16)data, addr);
-					else if (op.sz == 4)
-						Memory::Write_U32((u32)data, addr);
-				}
+				if (Memory::IsValidAddress(addr))
+					WriteIfChanged(addr, op.sz, data);
 				addr += op.multiWrite.step;
 				data += op.multiWrite.add;
 			}
@@ -1002,59 +1123,34 @@ void CWCheatEngine::ExecuteOp(const CheatOperation &op, const CheatCode &cheat,
 	case CheatOp::Assert:
 		if (Memory::IsValidAddress(op.addr)) {
 			InvalidateICache(op.addr, 4);
-			if (Memory::Read_U32(op.addr) != op.val) {
-				i = cheat.lines.size();
-			}
+			if (Memory::Read_U32(op.addr) != op.val)
+				return false;
 		}
 		break;
 
 	case CheatOp::IfEqual:
-		if (!TestIf(op, [](int a, int b) { return a == b; })) {
-			i += (size_t)op.ifTypes.skip;
-		}
-		break;
+		return TestIf(op, [](int a, int b) { return a == b; });
 
 	case CheatOp::IfNotEqual:
-		if (!TestIf(op, [](int a, int b) { return a != b; })) {
-			i += (size_t)op.ifTypes.skip;
-		}
-		break;
+		return TestIf(op, [](int a, int b) { return a != b; });
 
 	case CheatOp::IfLess:
-		if (!TestIf(op, [](int a, int b) { return a < b; })) {
-			i += (size_t)op.ifTypes.skip;
-		}
-		break;
+		return TestIf(op, [](int a, int b) { return a < b; });
 
 	case CheatOp::IfGreater:
-		if (!TestIf(op, [](int a, int b) { return a > b; })) {
-			i += (size_t)op.ifTypes.skip;
-		}
-		break;
+		return TestIf(op, [](int a, int b) { return a > b; });
 
 	case CheatOp::IfAddrEqual:
-		if (!TestIfAddr(op, [](int a, int b) { return a == b; })) {
-			i += (size_t)op.ifAddrTypes.skip;
-		}
-		break;
+		return TestIfAddr(op, [](int a, int b) { return a == b; });
 
 	case CheatOp::IfAddrNotEqual:
-		if (!TestIfAddr(op, [](int a, int b) { return a != b; })) {
-			i += (size_t)op.ifAddrTypes.skip;
-		}
-		break;
+		return TestIfAddr(op, [](int a, int b) { return a != b; });
 
 	case CheatOp::IfAddrLess:
-		if (!TestIfAddr(op, [](int a, int b) { return a < b; })) {
-			i += (size_t)op.ifAddrTypes.skip;
-		}
-		break;
+		return TestIfAddr(op, [](int a, int b) { return a < b; });
 
 	case CheatOp::IfAddrGreater:
-		if (!TestIfAddr(op, [](int a, int b) { return a > b; })) {
-			i += (size_t)op.ifAddrTypes.skip;
-		}
-		break;
+		return TestIfAddr(op, [](int a, int b) { return a > b; });
 
 	case CheatOp::IfPressed:
 		// Button	Code
@@ -1078,16 +1174,10 @@ void CWCheatEngine::ExecuteOp(const CheatOperation &op, const CheatCode &cheat,
 		// VOLUME DOWN	0x00200000
 		// SCREEN	0x00400000
 		// NOTE		0x00800000
-		if ((__CtrlPeekButtons() & op.val) != op.val) {
-			i += (size_t)op.ifTypes.skip;
-		}
-		break;
+		return (__CtrlPeekButtons() & op.val) == op.val;
 
 	case CheatOp::IfNotPressed:
-		if ((__CtrlPeekButtons() & op.val) == op.val) {
-			i += (size_t)op.ifTypes.skip;
-		}
-		break;
+		return (__CtrlPeekButtons() & op.val) != op.val;
 
 	case CheatOp::CwCheatPointerCommands:
 		{
@@ -1095,6 +1185,7 @@ void CWCheatEngine::ExecuteOp(const CheatOperation &op, const CheatCode &cheat,
 			u32 base = Memory::Read_U32(op.addr + op.pointerCommands.baseOffset);
 			u32 val = op.val;
 			int type = op.pointerCommands.type;
+			size_t i = nextLine;
 			for (int a = 0; a < op.pointerCommands.count; ++a) {
 				const CheatLine &line = cheat.lines[i++];
 				switch (line.part1 >> 28) {
@@ -1153,28 +1244,22 @@ void CWCheatEngine::ExecuteOp(const CheatOperation &op, const CheatCode &cheat,
 
 			switch (type) {
 			case 0: // 8 bit write
-				InvalidateICache(base + op.pointerCommands.offset, 4);
-				Memory::Write_U8((u8)val, base + op.pointerCommands.offset);
+				WriteIfChanged(base + op.pointerCommands.offset, 1, val);
 				break;
 			case 1: // 16-bit write
-				InvalidateICache(base + op.pointerCommands.offset, 4);
-				Memory::Write_U16((u16)val, base + op.pointerCommands.offset);
+				WriteIfChanged(base + op.pointerCommands.offset, 2, val);
 				break;
 			case 2: // 32-bit write
-				InvalidateICache(base + op.pointerCommands.offset, 4);
-				Memory::Write_U32((u32)val, base + op.pointerCommands.offset);
+				WriteIfChanged(base + op.pointerCommands.offset, 4, val);
 				break;
 			case 3: // 8 bit inverse write
-				InvalidateICache(base - op.pointerCommands.offset, 4);
-				Memory::Write_U8((u8)val, base - op.pointerCommands.offset);
+				WriteIfChanged(base - op.pointerCommands.offset, 1, val);
 				break;
 			case 4: // 16-bit inverse write
-				InvalidateICache(base - op.pointerCommands.offset, 4);
-				Memory::Write_U16((u16)val, base - op.pointerCommands.offset);
+				WriteIfChanged(base - op.pointerCommands.offset, 2, val);
 				break;
 			case 5: // 32-bit inverse write
-				InvalidateICache(base - op.pointerCommands.offset, 4);
-				Memory::Write_U32((u32)val, base - op.pointerCommands.offset);
+				WriteIfChanged(base - op.pointerCommands.offset, 4, val);
 				break;
 			case -1: // Operation already performed, nothing to do
 				break;
@@ -1185,14 +1270,20 @@ void CWCheatEngine::ExecuteOp(const CheatOperation &op, const CheatCode &cheat,
 	default:
 		_assert_(false);
 	}
+	return true;
 }
 
 void CWCheatEngine::Run() {
-	for (CheatCode cheat : cheats_) {
-		// InterpretNextOp and ExecuteOp move i.
-		for (size_t i = 0; i < cheat.lines.size(); ) {
-			CheatOperation op = InterpretNextOp(cheat, i);
-			ExecuteOp(op, cheat, i);
+	if (programStarts_.size() != cheats_.size() + 1)
+		CompileCheats();
+
+	for (size_t c = 0; c < cheats_.size(); ++c) {
+		const CheatCode &cheat = cheats_[c];
+		size_t pc = programStarts_[c];
+		const size_t end = programStarts_[c + 1];
+		while (pc < end) {
+			const CheatProgramOp &op = program_[pc];
+			pc = ExecuteOp(op.op, cheat, op.line) ? op.next : op.skip;
 		}
 	}
 }
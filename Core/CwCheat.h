@@ -43,10 +43,12 @@ struct CheatFileInfo {
 };
 
 struct CheatOperation;
+struct CheatProgramOp;
 
 class CWCheatEngine {
 public:
 	CWCheatEngine(const std::string &gameID);
+	~CWCheatEngine();
 	std::vector<CheatFileInfo> FileInfo();
 	void ParseCheats();
 	void CreateCheatFile();
@@ -61,12 +63,18 @@ class CWCheatEngine {
 	CheatOperation InterpretNextCwCheat(const CheatCode &cheat, size_t &i);
 	CheatOperation InterpretNextTempAR(const CheatCode &cheat, size_t &i);
 
-	void ExecuteOp(const CheatOperation &op, const CheatCode &cheat, size_t &i);
+	void CompileCheats();
+	// Returns false when a condition failed or the cheat should stop.
+	bool ExecuteOp(const CheatOperation &op, const CheatCode &cheat, size_t nextLine);
+	void WriteIfChanged(u32 addr, int sz, u32 val);
 	void ApplyMemoryOperator(const CheatOperation &op, uint32_t(*oper)(uint32_t, uint32_t));
 	bool TestIf(const CheatOperation &op, bool(*oper)(int a, int b));
 	bool TestIfAddr(const CheatOperation &op, bool(*oper)(int a, int b));
 
 	std::vector<CheatCode> cheats_;
+	// All cheats decoded up front. Cheat c runs from programStarts_[c] up to programStarts_[c + 1].
+	std::vector<CheatProgramOp> program_;
+	std::vector<size_t> programStarts_;
 	std::string gameID_;
 	Path filename_;
 };
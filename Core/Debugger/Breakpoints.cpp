@@ -24,6 +24,7 @@
 #include "Core/Debugger/Breakpoints.h"
 #include "Core/Debugger/SymbolMap.h"
 #include "Core/Host.h"
+#include "Core/MemFault.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/MIPSAnalyst.h"
 #include "Core/MIPS/MIPSDebugInterface.h"
@@ -31,6 +32,8 @@
 #include "Core/CoreTiming.h"
 
 std::atomic<bool> anyMemChecks_(false);
+// Whether the memchecks are caught by protecting their pages, see MemFault.cpp.
+static std::atomic<bool> memChecksByFault_(false);
 
 static std::mutex breakPointsMutex_;
 std::vector<BreakPoint> CBreakPoints::breakPoints_;
@@ -330,6 +333,15 @@ BreakPointCond *CBreakPoints::GetBreakPointCondition(u32 addr)
 	return NULL;
 }
 
+bool CBreakPoints::GetBreakPointCondition(u32 addr, BreakPointCond &cond) {
+	std::lock_guard<std::mutex> guard(breakPointsMutex_);
+	size_t bp = FindBreakpoint(addr);
+	if (bp == INVALID_BREAKPOINT || !breakPoints_[bp].hasCond)
+		return false;
+	cond = breakPoints_[bp].cond;
+	return true;
+}
+
 void CBreakPoints::ChangeBreakPointLogFormat(u32 addr, const std::string &fmt) {
 	std::unique_lock<std::mutex> guard(breakPointsMutex_);
 	size_t bp = FindBreakpoint(addr, true, false);
@@ -629,7 +641,27 @@ bool CBreakPoints::HasMemChecks()
 	return !memChecks_.empty();
 }
 
+bool CBreakPoints::HasJitMemChecks() {
+	return !memChecksByFault_ && HasMemChecks();
+}
+
+void CBreakPoints::UpdateMemCheckWatches() {
+	std::vector<Memory::MemFaultWatch> watches;
+	for (const MemCheck &check : GetMemChecks()) {
+		Memory::MemFaultWatch watch{ check.start, check.end };
+		watch.read = (check.cond & MEMCHECK_READ) != 0;
+		watch.write = (check.cond & MEMCHECK_WRITE) != 0;
+		watch.onChange = (check.cond & MEMCHECK_WRITE_ONCHANGE) != 0;
+		watches.push_back(watch);
+	}
+	memChecksByFault_ = Memory::MemFault_SetWatches(watches) && !watches.empty();
+}
+
 void CBreakPoints::Update(u32 addr) {
+	// Before the JIT recompiles, so it knows whether it still needs to check accesses.
+	if (addr == 0)
+		UpdateMemCheckWatches();
+
 	if (MIPSComp::jit) {
 		bool resume = false;
 		if (Core_IsStepping() == false) {
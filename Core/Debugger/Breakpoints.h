@@ -115,7 +115,8 @@ struct MemCheck {
 
 // BreakPoints cannot overlap, only one is allowed per address.
 // MemChecks can overlap, as long as their ends are different.
-// WARNING: MemChecks are not used in the interpreter or HLE currently.
+// MemChecks in RAM are caught by protecting their pages where the platform allows, which
+// also covers the interpreter.  Otherwise, only the JIT checks them, and HLE reports its own.
 class CBreakPoints
 {
 public:
@@ -137,6 +138,8 @@ class CBreakPoints
 	static void ChangeBreakPointAddCond(u32 addr, const BreakPointCond &cond);
 	static void ChangeBreakPointRemoveCond(u32 addr);
 	static BreakPointCond *GetBreakPointCondition(u32 addr);
+	// Copies the condition, for use off the CPU thread (e.g. by the JIT.)  False if there's none.
+	static bool GetBreakPointCondition(u32 addr, BreakPointCond &cond);
 
 	static void ChangeBreakPointLogFormat(u32 addr, const std::string &fmt);
 
@@ -168,6 +171,8 @@ class CBreakPoints
 	static const std::vector<BreakPoint> GetBreakpoints();
 
 	static bool HasMemChecks();
+	// Whether JIT'd loads and stores need to check memchecks themselves.
+	static bool HasJitMemChecks();
 
 	static void Update(u32 addr = 0);
 
@@ -179,6 +184,7 @@ class CBreakPoints
 	// Finds exactly, not using a range check.
 	static size_t FindMemCheck(u32 start, u32 end);
 	static MemCheck *GetMemCheckLocked(u32 address, int size);
+	static void UpdateMemCheckWatches();
 
 	static std::vector<BreakPoint> breakPoints_;
 	static u32 breakSkipFirstAt_;
@@ -15,6 +15,9 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <mutex>
 
 #include <cstring>
@@ -77,18 +80,68 @@ struct PendingNotifyMem {
 	uint32_t size;
 	uint64_t ticks;
 	uint32_t pc;
+	// Order across all threads, since each queues separately.
+	uint32_t seq;
+	// For copies, the tag gets the source's tag appended when applied.
+	uint32_t copySrc;
 	char tag[128];
 };
 
-static constexpr size_t MAX_PENDING_NOTIFIES = 512;
+static constexpr uint32_t NO_COPY_SRC = 0xFFFFFFFF;
+
+// Each thread queues to its own list, so notifying only takes an uncontended lock.
+struct PendingNotifyQueue {
+	std::mutex lock;
+	std::vector<PendingNotifyMem> items;
+	// Protected by queuesMutex.  Free queues are reused by new threads.
+	bool inUse = false;
+};
+
+struct PendingNotifyQueueRef {
+	~PendingNotifyQueueRef();
+	PendingNotifyQueue *queue = nullptr;
+};
+
+// Queues are normally applied once per frame, this just keeps memory in check.
+static constexpr size_t MAX_PENDING_NOTIFIES = 8192;
 static MemSlabMap allocMap;
 static MemSlabMap suballocMap;
 static MemSlabMap writeMap;
 static MemSlabMap textureMap;
-static std::vector<PendingNotifyMem> pendingNotifies;
-static std::mutex pendingMutex;
+static std::mutex mapMutex;
+static std::vector<std::unique_ptr<PendingNotifyQueue>> pendingQueues;
+static std::mutex queuesMutex;
+static std::atomic<uint32_t> pendingSeq;
+static thread_local PendingNotifyQueueRef localQueue;
 static int detailedOverride;
 
+PendingNotifyQueueRef::~PendingNotifyQueueRef() {
+	if (queue) {
+		// Anything left is still applied on the next flush.
+		std::lock_guard<std::mutex> guard(queuesMutex);
+		queue->inUse = false;
+	}
+}
+
+static PendingNotifyQueue *GetLocalQueue() {
+	if (!localQueue.queue) {
+		std::lock_guard<std::mutex> guard(queuesMutex);
+		for (auto &queue : pendingQueues) {
+			if (!queue->inUse) {
+				localQueue.queue = queue.get();
+				break;
+			}
+		}
+		if (!localQueue.queue) {
+			pendingQueues.push_back(std::unique_ptr<PendingNotifyQueue>(new PendingNotifyQueue()));
+			localQueue.queue = pendingQueues.back().get();
+			localQueue.queue->items.reserve(MAX_PENDING_NOTIFIES);
+		}
+		localQueue.queue->inUse = true;
+	}
+	return localQueue.queue;
+}
+
 MemSlabMap::MemSlabMap() {
 	Reset();
 }
@@ -100,6 +153,13 @@ MemSlabMap::~MemSlabMap() {
 bool MemSlabMap::Mark(uint32_t addr, uint32_t size, uint64_t ticks, uint32_t pc, bool allocated, const char *tag) {
 	uint32_t end = addr + size;
 	Slab *slab = FindSlab(addr);
+	// The same range often gets marked the same way again, which wouldn't change anything but ticks.
+	if (slab != nullptr && slab->end >= end && slab->allocated == allocated && (pc == 0 || slab->pc == pc) && (!tag || strcmp(slab->tag, tag) == 0)) {
+		if (pc != 0)
+			slab->ticks = ticks;
+		return true;
+	}
+
 	Slab *firstMatch = nullptr;
 	while (slab != nullptr && slab->start < end) {
 		if (slab->start < addr)
@@ -347,61 +407,110 @@ void MemSlabMap::FillHeads(Slab *slab) {
 	}
 }
 
-void FlushPendingMemInfo() {
-	std::lock_guard<std::mutex> guard(pendingMutex);
-	for (auto info : pendingNotifies) {
-		if (info.flags & MemBlockFlags::ALLOC) {
-			allocMap.Mark(info.start, info.size, info.ticks, info.pc, true, info.tag);
-		} else if (info.flags & MemBlockFlags::FREE) {
-			// Maintain the previous allocation tag for debugging.
-			allocMap.Mark(info.start, info.size, info.ticks, 0, false, nullptr);
-			suballocMap.Mark(info.start, info.size, info.ticks, 0, false, nullptr);
-		}
-		if (info.flags & MemBlockFlags::SUB_ALLOC) {
-			suballocMap.Mark(info.start, info.size, info.ticks, info.pc, true, info.tag);
-		} else if (info.flags & MemBlockFlags::SUB_FREE) {
-			// Maintain the previous allocation tag for debugging.
-			suballocMap.Mark(info.start, info.size, info.ticks, 0, false, nullptr);
-		}
-		if (info.flags & MemBlockFlags::TEXTURE) {
-			textureMap.Mark(info.start, info.size, info.ticks, info.pc, true, info.tag);
-		}
-		if (info.flags & MemBlockFlags::WRITE) {
+static std::string GetMemWriteTagAtLocked(uint32_t start, uint32_t size);
+
+static void ApplyPendingMemInfo(const PendingNotifyMem &info) {
+	if (info.flags & MemBlockFlags::ALLOC) {
+		allocMap.Mark(info.start, info.size, info.ticks, info.pc, true, info.tag);
+	} else if (info.flags & MemBlockFlags::FREE) {
+		// Maintain the previous allocation tag for debugging.
+		allocMap.Mark(info.start, info.size, info.ticks, 0, false, nullptr);
+		suballocMap.Mark(info.start, info.size, info.ticks, 0, false, nullptr);
+	}
+	if (info.flags & MemBlockFlags::SUB_ALLOC) {
+		suballocMap.Mark(info.start, info.size, info.ticks, info.pc, true, info.tag);
+	} else if (info.flags & MemBlockFlags::SUB_FREE) {
+		// Maintain the previous allocation tag for debugging.
+		suballocMap.Mark(info.start, info.size, info.ticks, 0, false, nullptr);
+	}
+	if (info.flags & MemBlockFlags::TEXTURE) {
+		textureMap.Mark(info.start, info.size, info.ticks, info.pc, true, info.tag);
+	}
+	if (info.flags & MemBlockFlags::WRITE) {
+		if (info.copySrc != NO_COPY_SRC) {
+			// Everything queued before the copy is applied by now, so this is the tag it had at the time.
+			std::string tag = std::string(info.tag) + "/" + GetMemWriteTagAtLocked(info.copySrc, info.size);
+			if (tag.size() >= sizeof(info.tag))
+				tag.resize(sizeof(info.tag) - 1);
+			writeMap.Mark(info.start, info.size, info.ticks, info.pc, true, tag.c_str());
+		} else {
 			writeMap.Mark(info.start, info.size, info.ticks, info.pc, true, info.tag);
 		}
 	}
-	pendingNotifies.clear();
 }
 
-void NotifyMemInfoPC(MemBlockFlags flags, uint32_t start, uint32_t size, uint32_t pc, const char *tagStr, size_t strLength) {
-	if (size == 0) {
-		return;
+// Caller must hold mapMutex.
+static void FlushPendingMemInfoLocked() {
+	std::vector<PendingNotifyMem> merged;
+	bool multipleQueues;
+	{
+		std::lock_guard<std::mutex> guard(queuesMutex);
+		multipleQueues = pendingQueues.size() > 1;
+		for (auto &queue : pendingQueues) {
+			std::lock_guard<std::mutex> queueGuard(queue->lock);
+			merged.insert(merged.end(), queue->items.begin(), queue->items.end());
+			queue->items.clear();
+		}
 	}
-	// Clear the uncached and kernel bits.
-	start &= ~0xC0000000;
 
+	if (multipleQueues) {
+		// Wrapping is fine, only the difference matters.
+		std::stable_sort(merged.begin(), merged.end(), [](const PendingNotifyMem &a, const PendingNotifyMem &b) {
+			return (int32_t)(a.seq - b.seq) < 0;
+		});
+	}
+	for (const auto &info : merged)
+		ApplyPendingMemInfo(info);
+}
+
+void FlushPendingMemInfo() {
+	std::lock_guard<std::mutex> guard(mapMutex);
+	FlushPendingMemInfoLocked();
+}
+
+static void QueueMemInfo(MemBlockFlags flags, uint32_t start, uint32_t size, uint32_t pc, const char *tagStr, size_t strLength, uint32_t copySrc) {
 	bool needFlush = false;
 	// When the setting is off, we skip smaller info to keep things fast.
 	if (size >= 0x100 || MemBlockInfoDetailed()) {
-		PendingNotifyMem info{ flags, start, size };
-		info.ticks = CoreTiming::GetTicks();
-		info.pc = pc;
-
 		size_t copyLength = strLength;
-		if (copyLength >= sizeof(info.tag)) {
-			copyLength = sizeof(info.tag) - 1;
+		if (copyLength >= sizeof(PendingNotifyMem::tag)) {
+			copyLength = sizeof(PendingNotifyMem::tag) - 1;
 		}
-		memcpy(info.tag, tagStr, copyLength);
-		info.tag[copyLength] = 0;
 
-		std::lock_guard<std::mutex> guard(pendingMutex);
-		pendingNotifies.push_back(info);
-		needFlush = pendingNotifies.size() > MAX_PENDING_NOTIFIES;
+		PendingNotifyQueue *queue = GetLocalQueue();
+		std::lock_guard<std::mutex> guard(queue->lock);
+		PendingNotifyMem *last = queue->items.empty() ? nullptr : &queue->items.back();
+		// Loops writing a buffer piece by piece can just extend the last one.
+		bool sameSource = last && (copySrc == NO_COPY_SRC ? last->copySrc == NO_COPY_SRC : last->copySrc != NO_COPY_SRC && last->copySrc + last->size == copySrc);
+		if (sameSource && last->flags == flags && last->pc == pc && last->start + last->size == start && memcmp(last->tag, tagStr, copyLength) == 0 && last->tag[copyLength] == 0) {
+			last->size += size;
+			last->ticks = CoreTiming::GetTicks();
+		} else {
+			PendingNotifyMem info{ flags, start, size };
+			info.ticks = CoreTiming::GetTicks();
+			info.pc = pc;
+			info.seq = pendingSeq++;
+			info.copySrc = copySrc;
+			memcpy(info.tag, tagStr, copyLength);
+			info.tag[copyLength] = 0;
+
+			queue->items.push_back(info);
+			needFlush = queue->items.size() > MAX_PENDING_NOTIFIES;
+		}
 	}
 
 	if (needFlush) {
 		FlushPendingMemInfo();
 	}
+}
+
+void NotifyMemInfoPC(MemBlockFlags flags, uint32_t start, uint32_t size, uint32_t pc, const char *tagStr, size_t strLength) {
+	if (size == 0) {
+		return;
+	}
+	// Clear the uncached and kernel bits.
+	start &= ~0xC0000000;
+	QueueMemInfo(flags, start, size, pc, tagStr, strLength, NO_COPY_SRC);
 
 	if (!(flags & MemBlockFlags::SKIP_MEMCHECK)) {
 		if (flags & MemBlockFlags::WRITE) {
@@ -412,12 +521,30 @@ void NotifyMemInfoPC(MemBlockFlags flags, uint32_t start, uint32_t size, uint32_
 	}
 }
 
+void NotifyMemInfoCopy(uint32_t destPtr, uint32_t srcPtr, uint32_t size, const char *prefix, size_t prefixLength) {
+	if (size == 0) {
+		return;
+	}
+
+	if (CBreakPoints::HasMemChecks()) {
+		// Memchecks log the tag right away, so it has to be complete now.
+		const std::string tag = std::string(prefix, prefixLength) + "/" + GetMemWriteTagAt(srcPtr, size);
+		NotifyMemInfo(MemBlockFlags::READ, srcPtr, size, tag.c_str(), tag.size());
+		NotifyMemInfo(MemBlockFlags::WRITE, destPtr, size, tag.c_str(), tag.size());
+		return;
+	}
+
+	// Reads are only for memchecks, and looking up the source tag now would flush the queue on every copy.
+	QueueMemInfo(MemBlockFlags::WRITE, destPtr & ~0xC0000000, size, currentMIPS->pc, prefix, prefixLength, srcPtr & ~0xC0000000);
+}
+
 void NotifyMemInfo(MemBlockFlags flags, uint32_t start, uint32_t size, const char *str, size_t strLength) {
 	NotifyMemInfoPC(flags, start, size, currentMIPS->pc, str, strLength);
 }
 
 std::vector<MemBlockInfo> FindMemInfo(uint32_t start, uint32_t size) {
-	FlushPendingMemInfo();
+	std::lock_guard<std::mutex> guard(mapMutex);
+	FlushPendingMemInfoLocked();
 	start &= ~0xC0000000;
 
 	std::vector<MemBlockInfo> results;
@@ -428,8 +555,7 @@ std::vector<MemBlockInfo> FindMemInfo(uint32_t start, uint32_t size) {
 	return results;
 }
 
-std::vector<MemBlockInfo> FindMemInfoByFlag(MemBlockFlags flags, uint32_t start, uint32_t size) {
-	FlushPendingMemInfo();
+static std::vector<MemBlockInfo> FindMemInfoByFlagLocked(MemBlockFlags flags, uint32_t start, uint32_t size) {
 	start &= ~0xC0000000;
 
 	std::vector<MemBlockInfo> results;
@@ -444,32 +570,48 @@ std::vector<MemBlockInfo> FindMemInfoByFlag(MemBlockFlags flags, uint32_t start,
 	return results;
 }
 
-std::string GetMemWriteTagAt(uint32_t start, uint32_t size) {
-	std::vector<MemBlockInfo> memRangeInfo = FindMemInfoByFlag(MemBlockFlags::WRITE, start, size);
+std::vector<MemBlockInfo> FindMemInfoByFlag(MemBlockFlags flags, uint32_t start, uint32_t size) {
+	std::lock_guard<std::mutex> guard(mapMutex);
+	FlushPendingMemInfoLocked();
+	return FindMemInfoByFlagLocked(flags, start, size);
+}
+
+static std::string GetMemWriteTagAtLocked(uint32_t start, uint32_t size) {
+	std::vector<MemBlockInfo> memRangeInfo = FindMemInfoByFlagLocked(MemBlockFlags::WRITE, start, size);
 	for (auto range : memRangeInfo) {
 		return range.tag;
 	}
 
 	// Fall back to alloc and texture, especially for VRAM.  We prefer write above.
-	memRangeInfo = FindMemInfoByFlag(MemBlockFlags::ALLOC | MemBlockFlags::TEXTURE, start, size);
+	memRangeInfo = FindMemInfoByFlagLocked(MemBlockFlags::ALLOC | MemBlockFlags::TEXTURE, start, size);
 	for (auto range : memRangeInfo) {
 		return range.tag;
 	}
 	return "none";
 }
 
+std::string GetMemWriteTagAt(uint32_t start, uint32_t size) {
+	std::lock_guard<std::mutex> guard(mapMutex);
+	FlushPendingMemInfoLocked();
+	return GetMemWriteTagAtLocked(start, size);
+}
+
 void MemBlockInfoInit() {
-	std::lock_guard<std::mutex> guard(pendingMutex);
-	pendingNotifies.reserve(MAX_PENDING_NOTIFIES);
+	GetLocalQueue();
 }
 
 void MemBlockInfoShutdown() {
-	std::lock_guard<std::mutex> guard(pendingMutex);
+	std::lock_guard<std::mutex> guard(mapMutex);
 	allocMap.Reset();
 	suballocMap.Reset();
 	writeMap.Reset();
 	textureMap.Reset();
-	pendingNotifies.clear();
+
+	std::lock_guard<std::mutex> queuesGuard(queuesMutex);
+	for (auto &queue : pendingQueues) {
+		std::lock_guard<std::mutex> queueGuard(queue->lock);
+		queue->items.clear();
+	}
 }
 
 void MemBlockInfoDoState(PointerWrap &p) {
@@ -477,7 +619,8 @@ void MemBlockInfoDoState(PointerWrap &p) {
 	if (!s)
 		return;
 
-	FlushPendingMemInfo();
+	std::lock_guard<std::mutex> guard(mapMutex);
+	FlushPendingMemInfoLocked();
 	allocMap.DoState(p);
 	suballocMap.DoState(p);
 	writeMap.DoState(p);
@@ -63,11 +63,23 @@ inline void NotifyMemInfo(MemBlockFlags flags, uint32_t start, uint32_t size, co
 	NotifyMemInfo(flags, start, size, str, strlen(str));
 }
 
+// Records a copy as a write tagged "prefix/<tag of the source>".  The source tag is looked up when the
+// queue is applied, so copies don't have to flush it each time like GetMemWriteTagAt() does.
+void NotifyMemInfoCopy(uint32_t destPtr, uint32_t srcPtr, uint32_t size, const char *prefix, size_t prefixLength);
+
+template<size_t count>
+inline void NotifyMemInfoCopy(uint32_t destPtr, uint32_t srcPtr, uint32_t size, const char(&prefix)[count]) {
+	NotifyMemInfoCopy(destPtr, srcPtr, size, prefix, count - 1);
+}
+
 std::vector<MemBlockInfo> FindMemInfo(uint32_t start, uint32_t size);
 std::vector<MemBlockInfo> FindMemInfoByFlag(MemBlockFlags flags, uint32_t start, uint32_t size);
 
 std::string GetMemWriteTagAt(uint32_t start, uint32_t size);
 
+// Applies queued notifications, done once per frame and before lookups.
+void FlushPendingMemInfo();
+
 void MemBlockInfoInit();
 void MemBlockInfoShutdown();
 void MemBlockInfoDoState(PointerWrap &p);
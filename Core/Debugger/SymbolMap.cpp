@@ -55,6 +55,7 @@ void SymbolMap::SortSymbols() {
 
 void SymbolMap::Clear() {
 	std::lock_guard<std::recursive_mutex> guard(lock_);
+	activeSnapshotDirty_ = true;
 	functions.clear();
 	labels.clear();
 	data.clear();
@@ -376,20 +377,20 @@ u32 SymbolMap::GetNextSymbolAddress(u32 address, SymbolType symmask) {
 }
 
 std::string SymbolMap::GetDescription(unsigned int address) {
-	std::lock_guard<std::recursive_mutex> guard(lock_);
-	const char* labelName = NULL;
+	std::shared_ptr<const ActiveSnapshot> snapshot = GetActiveSnapshot();
+	const std::string *labelName = nullptr;
 
-	u32 funcStart = GetFunctionStart(address);
+	u32 funcStart = snapshot->FunctionStart(address);
 	if (funcStart != INVALID_ADDRESS) {
-		labelName = GetLabelName(funcStart);
+		labelName = snapshot->LabelName(funcStart);
 	} else {
 		u32 dataStart = GetDataStart(address);
 		if (dataStart != INVALID_ADDRESS)
-			labelName = GetLabelName(dataStart);
+			labelName = snapshot->LabelName(dataStart);
 	}
 
-	if (labelName != NULL)
-		return labelName;
+	if (labelName != nullptr)
+		return *labelName;
 
 	char descriptionTemp[256];
 	sprintf(descriptionTemp, "(%08x)", address);
@@ -529,6 +530,7 @@ std::vector<LoadedModuleInfo> SymbolMap::getAllModules() const {
 
 void SymbolMap::AddFunction(const char* name, u32 address, u32 size, int moduleIndex) {
 	std::lock_guard<std::recursive_mutex> guard(lock_);
+	activeSnapshotDirty_ = true;
 
 	if (moduleIndex == -1) {
 		moduleIndex = GetModuleIndex(address);
@@ -578,35 +580,64 @@ void SymbolMap::AddFunction(const char* name, u32 address, u32 size, int moduleI
 }
 
 u32 SymbolMap::GetFunctionStart(u32 address) {
-	if (activeNeedUpdate_)
-		UpdateActiveSymbols();
+	return GetActiveSnapshot()->FunctionStart(address);
+}
 
-	std::lock_guard<std::recursive_mutex> guard(lock_);
-	auto it = activeFunctions.upper_bound(address);
-	if (it == activeFunctions.end()) {
-		// check last element
-		auto rit = activeFunctions.rbegin();
-		if (rit != activeFunctions.rend()) {
-			u32 start = rit->first;
-			u32 size = rit->second.size;
-			if (start <= address && start+size > address)
-				return start;
+std::shared_ptr<const SymbolMap::ActiveSnapshot> SymbolMap::GetActiveSnapshot() {
+	if (activeNeedUpdate_ || activeSnapshotDirty_) {
+		std::lock_guard<std::recursive_mutex> guard(lock_);
+		if (activeNeedUpdate_)
+			UpdateActiveSymbols();
+
+		if (activeSnapshotDirty_) {
+			auto snapshot = std::make_shared<ActiveSnapshot>();
+			snapshot->functions.reserve(activeFunctions.size());
+			for (const auto &it : activeFunctions)
+				snapshot->functions.push_back({ it.first, it.second.size });
+			snapshot->labels.reserve(activeLabels.size());
+			for (const auto &it : activeLabels)
+				snapshot->labels.push_back({ it.first, it.second.name });
+
+			std::atomic_store(&activeSnapshot_, std::shared_ptr<const ActiveSnapshot>(snapshot));
+			activeSnapshotDirty_ = false;
 		}
-		// otherwise there's no function that contains this address
-		return INVALID_ADDRESS;
 	}
 
-	if (it != activeFunctions.begin()) {
-		it--;
-		u32 start = it->first;
-		u32 size = it->second.size;
-		if (start <= address && start+size > address)
-			return start;
-	}
+	return std::atomic_load(&activeSnapshot_);
+}
+
+u32 SymbolMap::ActiveSnapshot::FunctionStart(u32 address) const {
+	// Only the last function starting at or before the address can contain it.
+	auto it = std::upper_bound(functions.begin(), functions.end(), address, [](u32 addr, const Function &func) {
+		return addr < func.start;
+	});
+	if (it == functions.begin())
+		return INVALID_ADDRESS;
 
+	--it;
+	if (address - it->start < it->size)
+		return it->start;
 	return INVALID_ADDRESS;
 }
 
+u32 SymbolMap::ActiveSnapshot::FunctionSize(u32 startAddress) const {
+	auto it = std::lower_bound(functions.begin(), functions.end(), startAddress, [](const Function &func, u32 addr) {
+		return func.start < addr;
+	});
+	if (it == functions.end() || it->start != startAddress)
+		return INVALID_ADDRESS;
+	return it->size;
+}
+
+const std::string *SymbolMap::ActiveSnapshot::LabelName(u32 address) const {
+	auto it = std::lower_bound(labels.begin(), labels.end(), address, [](const Label &label, u32 addr) {
+		return label.addr < addr;
+	});
+	if (it == labels.end() || it->addr != address)
+		return nullptr;
+	return &it->name;
+}
+
 u32 SymbolMap::FindPossibleFunctionAtAfter(u32 address) {
 	if (activeNeedUpdate_)
 		UpdateActiveSymbols();
@@ -646,12 +677,7 @@ u32 SymbolMap::GetFunctionSize(u32 startAddress) {
 		return func->second.size;
 	}
 
-	std::lock_guard<std::recursive_mutex> guard(lock_);
-	auto it = activeFunctions.find(startAddress);
-	if (it == activeFunctions.end())
-		return INVALID_ADDRESS;
-
-	return it->second.size;
+	return GetActiveSnapshot()->FunctionSize(startAddress);
 }
 
 u32 SymbolMap::GetFunctionModuleAddress(u32 startAddress) {
@@ -698,6 +724,7 @@ void SymbolMap::AssignFunctionIndices() {
 void SymbolMap::UpdateActiveSymbols() {
 	// return;   (slow in debug mode)
 	std::lock_guard<std::recursive_mutex> guard(lock_);
+	activeSnapshotDirty_ = true;
 
 	activeFunctions.clear();
 	activeLabels.clear();
@@ -749,6 +776,7 @@ bool SymbolMap::SetFunctionSize(u32 startAddress, u32 newSize) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
+	activeSnapshotDirty_ = true;
 
 	auto funcInfo = activeFunctions.find(startAddress);
 	if (funcInfo != activeFunctions.end()) {
@@ -770,6 +798,7 @@ bool SymbolMap::RemoveFunction(u32 startAddress, bool removeName) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
+	activeSnapshotDirty_ = true;
 
 	auto it = activeFunctions.find(startAddress);
 	if (it == activeFunctions.end())
@@ -799,6 +828,7 @@ bool SymbolMap::RemoveFunction(u32 startAddress, bool removeName) {
 
 void SymbolMap::AddLabel(const char* name, u32 address, int moduleIndex) {
 	std::lock_guard<std::recursive_mutex> guard(lock_);
+	activeSnapshotDirty_ = true;
 
 	if (moduleIndex == -1) {
 		moduleIndex = GetModuleIndex(address);
@@ -850,6 +880,7 @@ void SymbolMap::SetLabelName(const char* name, u32 address) {
 		UpdateActiveSymbols();
 
 	std::lock_guard<std::recursive_mutex> guard(lock_);
+	activeSnapshotDirty_ = true;
 	auto labelInfo = activeLabels.find(address);
 	if (labelInfo == activeLabels.end()) {
 		AddLabel(name, address);
@@ -892,11 +923,11 @@ const char *SymbolMap::GetLabelNameRel(u32 relAddress, int moduleIndex) const {
 }
 
 std::string SymbolMap::GetLabelString(u32 address) {
-	std::lock_guard<std::recursive_mutex> guard(lock_);
-	const char *label = GetLabelName(address);
-	if (label == NULL)
+	std::shared_ptr<const ActiveSnapshot> snapshot = GetActiveSnapshot();
+	const std::string *label = snapshot->LabelName(address);
+	if (label == nullptr)
 		return "";
-	return label;
+	return *label;
 }
 
 bool SymbolMap::GetLabelValue(const char* name, u32& dest) {
@@ -17,9 +17,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <set>
 #include <map>
+#include <memory>
 #include <string>
 #include <mutex>
 
@@ -153,11 +155,36 @@ class SymbolMap {
 		char name[128];
 	};
 
+	// Sorted flat copy of the active functions and labels, for the frequent lookups from
+	// stack walking and disassembly.  Replaced as a whole when dirty, so readers skip lock_.
+	struct ActiveSnapshot {
+		struct Function {
+			u32 start;
+			u32 size;
+		};
+		struct Label {
+			u32 addr;
+			std::string name;
+		};
+
+		u32 FunctionStart(u32 address) const;
+		u32 FunctionSize(u32 startAddress) const;
+		const std::string *LabelName(u32 address) const;
+
+		std::vector<Function> functions;
+		std::vector<Label> labels;
+	};
+
+	std::shared_ptr<const ActiveSnapshot> GetActiveSnapshot();
+
 	// These are flattened, read-only copies of the actual data in active modules only.
 	std::map<u32, const FunctionEntry> activeFunctions;
 	std::map<u32, const LabelEntry> activeLabels;
 	std::map<u32, const DataEntry> activeData;
 	bool activeNeedUpdate_ = false;
+	// Set (under lock_) whenever activeFunctions or activeLabels change.
+	std::atomic<bool> activeSnapshotDirty_{ true };
+	std::shared_ptr<const ActiveSnapshot> activeSnapshot_;
 
 	// This is indexed by the end address of the module.
 	std::map<u32, const ModuleEntry> activeModuleEnds;
@@ -43,6 +43,9 @@
 // At start, please send a "version" event.  See WebSocket/GameSubscriber.cpp for more details.
 //
 // For other events, look inside Core/Debugger/WebSocket/ for details on each event.
+//
+// High rate spontaneous events (logs, stepping) are JSON text frames by default.  Use a
+// "broadcast.config" event to batch them or switch to binary frames, see below.
 
 #include "Core/Debugger/WebSocket/GameBroadcaster.h"
 #include "Core/Debugger/WebSocket/InputBroadcaster.h"
@@ -60,6 +63,7 @@
 #include "Core/Debugger/WebSocket/InputSubscriber.h"
 #include "Core/Debugger/WebSocket/MemoryInfoSubscriber.h"
 #include "Core/Debugger/WebSocket/MemorySubscriber.h"
+#include "Core/Debugger/WebSocket/ProfilerSubscriber.h"
 #include "Core/Debugger/WebSocket/ReplaySubscriber.h"
 #include "Core/Debugger/WebSocket/SteppingSubscriber.h"
 
@@ -76,6 +80,7 @@ static const std::vector<SubscriberInit> subscribers({
 	&WebSocketInputInit,
 	&WebSocketMemoryInfoInit,
 	&WebSocketMemoryInit,
+	&WebSocketProfilerInit,
 	&WebSocketReplayInit,
 	&WebSocketSteppingInit,
 });
@@ -118,6 +123,36 @@ static void WebSocketNotifyLifecycle(CoreLifecycle stage) {
 	}
 }
 
+// Configure spontaneous events for this connection (broadcast.config)
+//
+// Parameters:
+//  - binary: optional boolean, true to send log and stepping events as binary frames.
+//  - batch: optional boolean, true to send one log.batch event per update instead of each log event.
+//  - maxPerSecond: optional unsigned integer, rate limit for log events (0 for no limit.)
+//
+// Response (same event name):
+//  - binary, batch, maxPerSecond: the settings now in effect.
+static void WebSocketBroadcastConfig(DebuggerBroadcastConfig &config, DebuggerRequest &req) {
+	bool binary = config.binary;
+	if (!req.ParamBool("binary", &binary, DebuggerParamType::OPTIONAL))
+		return;
+	bool batch = config.batch;
+	if (!req.ParamBool("batch", &batch, DebuggerParamType::OPTIONAL))
+		return;
+	uint32_t maxPerSecond = config.maxPerSecond;
+	if (!req.ParamU32("maxPerSecond", &maxPerSecond, false, DebuggerParamType::OPTIONAL))
+		return;
+
+	config.binary = binary;
+	config.batch = batch;
+	config.maxPerSecond = maxPerSecond;
+
+	JsonWriter &json = req.Respond();
+	json.writeBool("binary", config.binary);
+	json.writeBool("batch", config.batch);
+	json.writeUint("maxPerSecond", config.maxPerSecond);
+}
+
 static void SetupDebuggerLock() {
 	if (!lifecycleLockSetup) {
 		Core_ListenLifecycle(&WebSocketNotifyLifecycle);
@@ -139,12 +174,17 @@ void HandleDebuggerRequest(const http::Request &request) {
 	InputBroadcaster input;
 	SteppingBroadcaster stepping;
 
+	DebuggerBroadcastConfig broadcastConfig;
+
 	std::unordered_map<std::string, DebuggerEventHandler> eventHandlers;
 	std::vector<DebuggerSubscriber *> subscriberData;
 	for (auto init : subscribers) {
 		std::lock_guard<std::mutex> guard(lifecycleLock);
 		subscriberData.push_back(init(eventHandlers));
 	}
+	eventHandlers["broadcast.config"] = [&](DebuggerRequest &req) {
+		WebSocketBroadcastConfig(broadcastConfig, req);
+	};
 
 	// There's a tradeoff between responsiveness to incoming events, and polling for changes.
 	int highActivity = 0;
@@ -182,9 +222,9 @@ void HandleDebuggerRequest(const http::Request &request) {
 	while (ws->Process(highActivity ? 1.0f / 1000.0f : 1.0f / 60.0f)) {
 		std::lock_guard<std::mutex> guard(lifecycleLock);
 		// These send events that aren't just responses to requests.
-		logger.Broadcast(ws);
+		logger.Broadcast(ws, broadcastConfig);
 		game.Broadcast(ws);
-		stepping.Broadcast(ws);
+		stepping.Broadcast(ws, broadcastConfig);
 		input.Broadcast(ws);
 
 		for (size_t i = 0; i < subscribers.size(); ++i) {
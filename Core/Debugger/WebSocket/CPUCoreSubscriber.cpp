@@ -22,6 +22,7 @@
 #include "Core/Debugger/WebSocket/CPUCoreSubscriber.h"
 #include "Core/Debugger/WebSocket/WebSocketUtils.h"
 #include "Core/HLE/sceKernelThread.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSDebugInterface.h"
 
@@ -34,6 +35,7 @@ DebuggerSubscriber *WebSocketCPUCoreInit(DebuggerEventHandlerMap &map) {
 	map["cpu.getReg"] = &WebSocketCPUGetReg;
 	map["cpu.setReg"] = &WebSocketCPUSetReg;
 	map["cpu.evaluate"] = &WebSocketCPUEvaluate;
+	map["cpu.jit.profile"] = &WebSocketCPUJitProfile;
 
 	return nullptr;
 }
@@ -410,3 +412,50 @@ void WebSocketCPUEvaluate(DebuggerRequest &req) {
 	json.writeUint("uintValue", val);
 	json.writeString("floatValue", RegValueAsFloat(val));
 }
+
+// Count jit block executions and list the hottest blocks (cpu.jit.profile)
+//
+// Parameters:
+//  - enable: optional boolean to start or stop counting.  Changing this clears the jit cache.
+//  - count: optional number of blocks to list, default 50.
+//
+// Response (same event name):
+//  - enabled: boolean, whether execution counts are being collected.
+//  - blocks: array of objects, hottest first, each with:
+//     - address: number of the block's first MIPS instruction.
+//     - count: number of times the block was entered since it was compiled.
+//     - codeSize: bytes of host code (or IR) generated for the block.
+//     - disasm: array of MIPS disassembly strings for the block.
+void WebSocketCPUJitProfile(DebuggerRequest &req) {
+	if (!MIPSComp::jit) {
+		return req.Fail("CPU not started or not using a jit");
+	}
+
+	bool enable = MIPSComp::jitBlockProfiling;
+	if (!req.ParamBool("enable", &enable, DebuggerParamType::OPTIONAL))
+		return;
+	uint32_t count = 50;
+	if (!req.ParamU32("count", &count, false, DebuggerParamType::OPTIONAL))
+		return;
+
+	if (enable != MIPSComp::jitBlockProfiling)
+		MIPSComp::SetJitBlockProfiling(enable);
+
+	std::vector<MIPSComp::JitBlockProfileEntry> entries = MIPSComp::GetJitBlockProfile((int)count);
+
+	JsonWriter &json = req.Respond();
+	json.writeBool("enabled", MIPSComp::jitBlockProfiling);
+	json.pushArray("blocks");
+	for (const auto &entry : entries) {
+		json.pushDict();
+		json.writeUint("address", entry.address);
+		json.writeFloat("count", (double)entry.count);
+		json.writeUint("codeSize", entry.codeSize);
+		json.pushArray("disasm");
+		for (const std::string &line : entry.disasm)
+			json.writeString(line);
+		json.pop();
+		json.pop();
+	}
+	json.pop();
+}
@@ -49,7 +49,8 @@ WebSocketGPURecordState::~WebSocketGPURecordState() {
 
 // Begin recording (gpu.record.dump)
 //
-// No parameters.
+// Parameters:
+//  - frames: optional number of frames to record, default 1.  More than one streams to disk while recording.
 //
 // Response (same event name):
 //  - uri: data: URI containing debug dump data.
@@ -59,7 +60,12 @@ void WebSocketGPURecordState::Dump(DebuggerRequest &req) {
 	if (!PSP_IsInited())
 		return req.Fail("CPU not started");
 
-	if (!GPURecord::Activate())
+	uint32_t frames = 1;
+	if (!req.ParamU32("frames", &frames, false, DebuggerParamType::OPTIONAL))
+		return;
+
+	bool activated = frames > 1 ? GPURecord::ActivateStreaming((int)frames) : GPURecord::Activate();
+	if (!activated)
 		return req.Fail("Recording already in progress");
 
 	pending_ = true;
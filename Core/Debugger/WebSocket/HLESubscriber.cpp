@@ -25,6 +25,7 @@
 #include "Core/MIPS/MIPSAnalyst.h"
 #include "Core/MIPS/MIPSDebugInterface.h"
 #include "Core/MIPS/MIPSStackWalk.h"
+#include "Core/HLE/HLE.h"
 #include "Core/HLE/sceKernelThread.h"
 
 DebuggerSubscriber *WebSocketHLEInit(DebuggerEventHandlerMap &map) {
@@ -37,6 +38,8 @@ DebuggerSubscriber *WebSocketHLEInit(DebuggerEventHandlerMap &map) {
 	map["hle.func.rename"] = &WebSocketHLEFuncRename;
 	map["hle.module.list"] = &WebSocketHLEModuleList;
 	map["hle.backtrace"] = &WebSocketHLEBacktrace;
+	map["hle.stats.enable"] = &WebSocketHLEStatsEnable;
+	map["hle.stats.get"] = &WebSocketHLEStatsGet;
 
 	return nullptr;
 }
@@ -489,3 +492,67 @@ void WebSocketHLEBacktrace(DebuggerRequest &req) {
 	}
 	json.pop();
 }
+
+// Enable or disable per-function HLE stats (hle.stats.enable)
+//
+// While enabled, every syscall goes through the slower dispatch path.  Counting starts the next frame.
+//
+// Parameters:
+//  - enabled: boolean, whether to collect stats.
+//  - reset: optional boolean, true to clear previously collected stats.
+//
+// Response (same event name) with no extra data.
+void WebSocketHLEStatsEnable(DebuggerRequest &req) {
+	bool enabled = false;
+	if (!req.ParamBool("enabled", &enabled))
+		return;
+	bool reset = false;
+	if (!req.ParamBool("reset", &reset, DebuggerParamType::OPTIONAL))
+		return;
+
+	if (reset)
+		hleResetFunctionStats();
+	hleSetFunctionStatsEnabled(enabled);
+	req.Respond();
+}
+
+// Retrieve per-function HLE stats (hle.stats.get)
+//
+// Parameters:
+//  - reset: optional boolean, true to clear the stats after retrieving them.
+//
+// Response (same event name):
+//  - enabled: boolean, whether stats are being collected.
+//  - functions: array of objects, slowest total time first, each with properties:
+//     - module: string module name, e.g. 'sceIo'.
+//     - name: string function name.
+//     - nid: unsigned integer function id.
+//     - calls: number of times the function was called.
+//     - totalMicros: number, host microseconds spent in the function.
+//     - maxMicros: number, slowest single call in host microseconds.
+//     - cycles: number, emulated cycles eaten by the function.
+void WebSocketHLEStatsGet(DebuggerRequest &req) {
+	bool reset = false;
+	if (!req.ParamBool("reset", &reset, DebuggerParamType::OPTIONAL))
+		return;
+
+	std::vector<HLEFunctionStats> stats = hleGetFunctionStats();
+	if (reset)
+		hleResetFunctionStats();
+
+	JsonWriter &json = req.Respond();
+	json.writeBool("enabled", hleFunctionStatsEnabled());
+	json.pushArray("functions");
+	for (const HLEFunctionStats &s : stats) {
+		json.pushDict();
+		json.writeString("module", s.moduleName);
+		json.writeString("name", s.func->name);
+		json.writeUint("nid", s.func->ID);
+		json.writeFloat("calls", (double)s.calls);
+		json.writeFloat("totalMicros", s.totalTime * 1000000.0);
+		json.writeFloat("maxMicros", s.maxTime * 1000000.0);
+		json.writeFloat("cycles", (double)s.cycles);
+		json.pop();
+	}
+	json.pop();
+}
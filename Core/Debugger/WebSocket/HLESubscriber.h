@@ -30,3 +30,5 @@ void WebSocketHLEFuncRemove(DebuggerRequest &req);
 void WebSocketHLEFuncRename(DebuggerRequest &req);
 void WebSocketHLEModuleList(DebuggerRequest &req);
 void WebSocketHLEBacktrace(DebuggerRequest &req);
+void WebSocketHLEStatsEnable(DebuggerRequest &req);
+void WebSocketHLEStatsGet(DebuggerRequest &req);
@@ -110,9 +110,67 @@ struct DebuggerLogEvent {
 //  - message: actual log message as a string.
 //  - level: number severity level (1 = highest.)
 //  - channel: string describing log channel / grouping.
-void LogBroadcaster::Broadcast(net::WebSocketServer *ws) {
+
+// Batch of log messages (log.batch)
+//
+// Sent unexpectedly instead of log, if enabled using broadcast.config, with these properties:
+//  - messages: array of objects, each with the same properties as log (except event.)
+//  - dropped: number of messages dropped by the rate limit since the last batch.
+
+// Binary batch of log messages ("LOGB" binary frame)
+//
+// Sent unexpectedly instead of log, if enabled using broadcast.config.  Little endian:
+//  - "LOGB", u32 count of messages.
+//  - u32 dropped messages (rate limit) since the last batch.
+//  - Per message: u8 level, u8 length + channel, u8 length + timestamp, u8 length + header, u32 length + message.
+void LogBroadcaster::Broadcast(net::WebSocketServer *ws, const DebuggerBroadcastConfig &config) {
 	auto messages = listener_->GetMessages();
-	for (auto msg : messages) {
-		ws->Send(DebuggerLogEvent{msg});
+	if (messages.empty())
+		return;
+
+	// Keep the newest messages when over the limit.
+	uint32_t allowed = limiter_.Allow((uint32_t)messages.size(), config.maxPerSecond);
+	size_t skip = messages.size() - allowed;
+	dropped_ += (uint32_t)skip;
+	if (allowed == 0)
+		return;
+
+	if (config.binary) {
+		DebuggerBinaryWriter w("LOGB");
+		w.SetCount(allowed);
+		w.WriteU32(dropped_);
+		for (size_t i = skip; i < messages.size(); ++i) {
+			const LogMessage &l = messages[i];
+			w.WriteU8((uint8_t)l.level);
+			w.WriteShortString(l.log);
+			w.WriteShortString(l.timestamp);
+			w.WriteShortString(l.header);
+			w.WriteString(l.msg);
+		}
+		ws->Send(w.Data());
+	} else if (config.batch) {
+		JsonWriter j;
+		j.begin();
+		j.writeString("event", "log.batch");
+		j.writeUint("dropped", dropped_);
+		j.pushArray("messages");
+		for (size_t i = skip; i < messages.size(); ++i) {
+			const LogMessage &l = messages[i];
+			j.pushDict();
+			j.writeString("timestamp", l.timestamp);
+			j.writeString("header", l.header);
+			j.writeString("message", l.msg);
+			j.writeInt("level", l.level);
+			j.writeString("channel", l.log);
+			j.pop();
+		}
+		j.pop();
+		j.end();
+		ws->Send(j.str());
+	} else {
+		for (size_t i = skip; i < messages.size(); ++i) {
+			ws->Send(DebuggerLogEvent{messages[i]});
+		}
 	}
+	dropped_ = 0;
 }
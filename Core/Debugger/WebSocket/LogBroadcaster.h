@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "Core/Debugger/WebSocket/WebSocketUtils.h"
+
 namespace net {
 class WebSocketServer;
 }
@@ -28,8 +30,10 @@ struct LogBroadcaster {
 	LogBroadcaster();
 	~LogBroadcaster();
 
-	void Broadcast(net::WebSocketServer *ws);
+	void Broadcast(net::WebSocketServer *ws, const DebuggerBroadcastConfig &config);
 
 private:
 	DebuggerLogListener *listener_;
+	DebuggerRateLimiter limiter_;
+	uint32_t dropped_ = 0;
 };
@@ -171,9 +171,16 @@ void WebSocketMemoryReadU32(DebuggerRequest &req) {
 //  - address: unsigned integer address for the start of the memory range.
 //  - size: unsigned integer specifying size of memory range.
 //  - replacements: optional, false to ignore PPSSPP replacements in MIPS code.
+//  - binary: optional, true to receive a "MEMR" binary frame instead of base64 JSON.
 //
 // Response (same event name):
 //  - base64: base64 encode of binary data.
+//
+// Binary response ("MEMR" binary frame), little endian:
+//  - "MEMR", u32 count (always 1.)
+//  - u32 address, u32 size.
+//  - u32 length + ticket, as JSON text (empty if no ticket was sent.)
+//  - size bytes of memory.
 void WebSocketMemoryRead(DebuggerRequest &req) {
 	uint32_t addr;
 	if (!req.ParamU32("address", &addr))
@@ -184,6 +191,9 @@ void WebSocketMemoryRead(DebuggerRequest &req) {
 	bool replacements = true;
 	if (!req.ParamBool("replacements", &replacements, DebuggerParamType::OPTIONAL))
 		return;
+	bool binary = false;
+	if (!req.ParamBool("binary", &binary, DebuggerParamType::OPTIONAL))
+		return;
 
 	auto memLock = LockMemoryAndCPU(addr, replacements);
 	if (!currentDebugMIPS->isAlive() || !Memory::IsActive())
@@ -194,6 +204,18 @@ void WebSocketMemoryRead(DebuggerRequest &req) {
 	else if (!Memory::IsValidRange(addr, size))
 		return req.Fail("Invalid size");
 
+	if (binary) {
+		const JsonNode *ticket = req.data.get("ticket");
+		DebuggerBinaryWriter w("MEMR");
+		w.SetCount(1);
+		w.WriteU32(addr);
+		w.WriteU32(size);
+		w.WriteString(ticket ? json_stringify(ticket) : "");
+		w.WriteBytes(Memory::GetPointerUnchecked(addr), size);
+		req.RespondBinary(w.Data());
+		return;
+	}
+
 	JsonWriter &json = req.Respond();
 	// Start a value without any actual data yet...
 	json.writeRaw("base64", "");
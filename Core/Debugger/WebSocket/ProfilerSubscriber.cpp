@@ -0,0 +1,112 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "Common/Profiler/MemoryUsage.h"
+#include "Common/Profiler/Profiler.h"
+#include "Core/Debugger/WebSocket/ProfilerSubscriber.h"
+#include "Core/Debugger/WebSocket/WebSocketUtils.h"
+
+static void WebSocketProfilerTraceStart(DebuggerRequest &req);
+static void WebSocketProfilerTraceStop(DebuggerRequest &req);
+static void WebSocketProfilerTraceGet(DebuggerRequest &req);
+static void WebSocketProfilerMemoryUsage(DebuggerRequest &req);
+
+DebuggerSubscriber *WebSocketProfilerInit(DebuggerEventHandlerMap &map) {
+	map["profiler.trace.start"] = &WebSocketProfilerTraceStart;
+	map["profiler.trace.stop"] = &WebSocketProfilerTraceStop;
+	map["profiler.trace.get"] = &WebSocketProfilerTraceGet;
+	map["profiler.memoryUsage"] = &WebSocketProfilerMemoryUsage;
+
+	return nullptr;
+}
+
+// Start recording profiler scopes (profiler.trace.start)
+//
+// Works on release builds too. Each thread keeps only its most recent events.
+//
+// Parameters:
+//  - clear: optional boolean, false to keep previously recorded events.  Defaults to true.
+//
+// Response (same event name) with no extra data.
+static void WebSocketProfilerTraceStart(DebuggerRequest &req) {
+	bool clear = true;
+	if (!req.ParamBool("clear", &clear, DebuggerParamType::OPTIONAL))
+		return;
+
+	if (clear)
+		Profiler_ClearTrace();
+	Profiler_SetTracing(true);
+	req.Respond();
+}
+
+// Stop recording profiler scopes (profiler.trace.stop)
+//
+// Recorded events are kept, use profiler.trace.get to retrieve them.
+//
+// No parameters.
+//
+// Response (same event name) with no extra data.
+static void WebSocketProfilerTraceStop(DebuggerRequest &req) {
+	Profiler_SetTracing(false);
+	req.Respond();
+}
+
+// Retrieve recorded profiler scopes (profiler.trace.get)
+//
+// No parameters.
+//
+// Response (same event name):
+//  - tracing: boolean, whether events are still being recorded.
+//  - trace: object in the Chrome trace event format, can be loaded in chrome://tracing or Perfetto.
+static void WebSocketProfilerTraceGet(DebuggerRequest &req) {
+	JsonWriter &json = req.Respond();
+	json.writeBool("tracing", Profiler_IsTracing());
+	json.writeRaw("trace", Profiler_ExportChromeTrace());
+}
+
+// Retrieve memory used by caches and pools (profiler.memoryUsage)
+//
+// Some are only updated once per frame, and categories can overlap.
+//
+// Parameters:
+//  - resetPeaks: optional boolean, true to reset peaks to current values after responding.  Defaults to false.
+//
+// Response (same event name):
+//  - categories: array of objects:
+//     - name: string, description of the category.
+//     - current: number of bytes currently used.
+//     - peak: highest number of bytes used since startup or the last reset.
+static void WebSocketProfilerMemoryUsage(DebuggerRequest &req) {
+	bool resetPeaks = false;
+	if (!req.ParamBool("resetPeaks", &resetPeaks, DebuggerParamType::OPTIONAL))
+		return;
+
+	JsonWriter &json = req.Respond();
+	json.pushArray("categories");
+	for (const MemoryUsageStat &stat : MemoryUsage_GetStats()) {
+		json.pushDict();
+		json.writeString("name", stat.name);
+		// Doubles are exact well past any realistic size.
+		json.writeFloat("current", (double)stat.current);
+		json.writeFloat("peak", (double)stat.peak);
+		json.pop();
+	}
+	json.pop();
+
+	if (resetPeaks)
+		MemoryUsage_ResetPeaks();
+}
@@ -52,14 +52,39 @@ struct CPUSteppingEvent {
 // CPU has resumed from stepping (cpu.resume)
 //
 // Sent unexpectedly with no other properties.
-void SteppingBroadcaster::Broadcast(net::WebSocketServer *ws) {
+
+// Binary stepping state change ("STEP" binary frame)
+//
+// Sent unexpectedly instead of cpu.stepping and cpu.resume, if enabled using broadcast.config.  Little endian:
+//  - "STEP", u32 count (always 1.)
+//  - u8 1 for cpu.stepping, 0 for cpu.resume.
+//  - u32 pc, u64 ticks, u32 relatedAddress, u8 length + reason.  Zero for cpu.resume.
+static std::vector<uint8_t> CPUSteppingBinaryEvent(bool stepping, const SteppingReason *reason) {
+	DebuggerBinaryWriter w("STEP");
+	w.SetCount(1);
+	w.WriteU8(stepping ? 1 : 0);
+	w.WriteU32(stepping ? currentMIPS->pc : 0);
+	w.WriteU64(stepping ? CoreTiming::GetTicks() : 0);
+	w.WriteU32(reason ? reason->relatedAddress : 0);
+	w.WriteShortString(reason && reason->reason ? reason->reason : "");
+	return w.Data();
+}
+
+void SteppingBroadcaster::Broadcast(net::WebSocketServer *ws, const DebuggerBroadcastConfig &config) {
 	if (PSP_IsInited()) {
 		int steppingCounter = Core_GetSteppingCounter();
 		// We ignore CORE_POWERDOWN as a stepping state.
 		if (coreState == CORE_STEPPING && steppingCounter != lastCounter_) {
-			ws->Send(CPUSteppingEvent(Core_GetSteppingReason()));
+			const SteppingReason &reason = Core_GetSteppingReason();
+			if (config.binary)
+				ws->Send(CPUSteppingBinaryEvent(true, &reason));
+			else
+				ws->Send(CPUSteppingEvent(reason));
 		} else if (prevState_ == CORE_STEPPING && coreState != CORE_STEPPING && Core_IsActive()) {
-			ws->Send(R"({"event":"cpu.resume"})");
+			if (config.binary)
+				ws->Send(CPUSteppingBinaryEvent(false, nullptr));
+			else
+				ws->Send(R"({"event":"cpu.resume"})");
 		}
 		lastCounter_ = steppingCounter;
 		prevState_ = coreState;
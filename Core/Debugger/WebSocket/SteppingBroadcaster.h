@@ -18,6 +18,7 @@
 #pragma once
 
 #include "Core/Core.h"
+#include "Core/Debugger/WebSocket/WebSocketUtils.h"
 
 namespace net {
 class WebSocketServer;
@@ -29,7 +30,7 @@ struct SteppingBroadcaster {
 		prevState_ = coreState;
 	}
 
-	void Broadcast(net::WebSocketServer *ws);
+	void Broadcast(net::WebSocketServer *ws, const DebuggerBroadcastConfig &config);
 
 private:
 	CoreState prevState_;
@@ -15,11 +15,13 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
 #include "Common/Data/Text/Parsers.h"
 #include "Common/StringUtils.h"
+#include "Common/TimeUtil.h"
 #include "Core/Debugger/WebSocket/WebSocketUtils.h"
 #include "Core/MemMap.h"
 
@@ -53,6 +55,12 @@ bool DebuggerRequest::Finish() {
 	return responseSent_;
 }
 
+void DebuggerRequest::RespondBinary(const std::vector<uint8_t> &payload) {
+	_assert_(!responseBegun_);
+	ws->Send(payload);
+	responseSent_ = true;
+}
+
 void DebuggerRequest::Flush() {
 	ws->AddFragment(false, writer_.flush());
 	responsePartial_ = true;
@@ -286,3 +294,60 @@ uint32_t RoundMemAddressUp(uint32_t addr) {
 		return PSP_GetScratchpadMemoryBase();
 	return addr;
 }
+
+uint32_t DebuggerRateLimiter::Allow(uint32_t count, uint32_t maxPerSecond) {
+	if (maxPerSecond == 0)
+		return count;
+
+	double now = time_now_d();
+	if (lastTime_ == 0.0)
+		tokens_ = maxPerSecond;
+	else
+		tokens_ = std::min((double)maxPerSecond, tokens_ + (now - lastTime_) * maxPerSecond);
+	lastTime_ = now;
+
+	uint32_t allowed = std::min(count, (uint32_t)tokens_);
+	tokens_ -= allowed;
+	return allowed;
+}
+
+DebuggerBinaryWriter::DebuggerBinaryWriter(const char type[4]) {
+	WriteBytes(type, 4);
+	WriteU32(0);
+}
+
+void DebuggerBinaryWriter::WriteU16(uint16_t v) {
+	WriteU8(v & 0xFF);
+	WriteU8(v >> 8);
+}
+
+void DebuggerBinaryWriter::WriteU32(uint32_t v) {
+	WriteU16(v & 0xFFFF);
+	WriteU16(v >> 16);
+}
+
+void DebuggerBinaryWriter::WriteU64(uint64_t v) {
+	WriteU32((uint32_t)v);
+	WriteU32((uint32_t)(v >> 32));
+}
+
+void DebuggerBinaryWriter::WriteBytes(const void *p, size_t sz) {
+	const uint8_t *data = (const uint8_t *)p;
+	buf_.insert(buf_.end(), data, data + sz);
+}
+
+void DebuggerBinaryWriter::WriteShortString(const std::string &str) {
+	size_t sz = std::min(str.size(), (size_t)255);
+	WriteU8((uint8_t)sz);
+	WriteBytes(str.data(), sz);
+}
+
+void DebuggerBinaryWriter::WriteString(const std::string &str) {
+	WriteU32((uint32_t)str.size());
+	WriteBytes(str.data(), str.size());
+}
+
+void DebuggerBinaryWriter::SetCount(uint32_t count) {
+	for (int i = 0; i < 4; ++i)
+		buf_[4 + i] = (uint8_t)(count >> (i * 8));
+}
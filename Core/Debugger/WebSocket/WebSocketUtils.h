@@ -19,7 +19,9 @@
 
 #include "ppsspp_config.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "Common/Log.h"
 #include "Common/Data/Format/JSONReader.h"
@@ -89,6 +91,8 @@ struct DebuggerRequest {
 	bool ParamString(const char *name, std::string *out, DebuggerParamType type = DebuggerParamType::REQUIRED);
 
 	JsonWriter &Respond();
+	// Responds with a binary frame instead of JSON (see DebuggerBinaryWriter.)
+	void RespondBinary(const std::vector<uint8_t> &payload);
 	void Flush();
 	bool Finish();
 
@@ -107,6 +111,54 @@ class DebuggerSubscriber {
 	virtual void Broadcast(net::WebSocketServer *ws) {}
 };
 
+// Per connection settings for spontaneous high rate events, changed by broadcast.config.
+struct DebuggerBroadcastConfig {
+	// Send log and stepping events as binary frames (see DebuggerBinaryWriter.)
+	bool binary = false;
+	// Combine all log events from one Broadcast() into a single frame.
+	bool batch = false;
+	// Maximum log events per second, 0 for no limit.  Excess events are dropped and counted.
+	uint32_t maxPerSecond = 0;
+};
+
+// Token bucket limiting events per second, refilled continuously.
+class DebuggerRateLimiter {
+public:
+	// Returns how many of count events may be sent now.
+	uint32_t Allow(uint32_t count, uint32_t maxPerSecond);
+
+private:
+	double tokens_ = 0.0;
+	double lastTime_ = 0.0;
+};
+
+// Builds compact binary frames.  All values are little endian.
+// Each frame starts with a four character type (e.g. "LOGB") and a u32 record count.
+class DebuggerBinaryWriter {
+public:
+	DebuggerBinaryWriter(const char type[4]);
+
+	void WriteU8(uint8_t v) {
+		buf_.push_back(v);
+	}
+	void WriteU16(uint16_t v);
+	void WriteU32(uint32_t v);
+	void WriteU64(uint64_t v);
+	void WriteBytes(const void *p, size_t sz);
+	// Prefixed by a u8 length, truncated if needed.
+	void WriteShortString(const std::string &str);
+	// Prefixed by a u32 length.
+	void WriteString(const std::string &str);
+
+	void SetCount(uint32_t count);
+	const std::vector<uint8_t> &Data() const {
+		return buf_;
+	}
+
+private:
+	std::vector<uint8_t> buf_;
+};
+
 typedef std::function<void(DebuggerRequest &req)> DebuggerEventHandler;
 typedef std::unordered_map<std::string, DebuggerEventHandler> DebuggerEventHandlerMap;
 
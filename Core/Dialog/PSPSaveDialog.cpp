@@ -1190,6 +1190,8 @@ int PSPSaveDialog::Shutdown(bool force) {
 
 	JoinIOThread();
 	ioThreadStatus = SAVEIO_NONE;
+	if (force)
+		SavedataParam::WaitForPendingWrites();
 
 	PSPDialog::Shutdown(force);
 	if (!force) {
@@ -1202,6 +1204,7 @@ int PSPSaveDialog::Shutdown(bool force) {
 
 void PSPSaveDialog::DoState(PointerWrap &p) {
 	JoinIOThread();
+	SavedataParam::WaitForPendingWrites();
 	PSPDialog::DoState(p);
 
 	auto s = p.Section("PSPSaveDialog", 1, 2);
@@ -37,6 +37,12 @@
 #include "Core/Util/PPGeDraw.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "Common/Thread/ThreadUtil.h"
 
 static const std::string ICON0_FILENAME = "ICON0.PNG";
 static const std::string ICON1_FILENAME = "ICON1.PMF";
@@ -95,6 +101,87 @@ namespace
 		return result == dataSize;
 	}
 
+	// Host writes of savedata happen in the background, in order, so saving doesn't stall the game.
+	// Anything that reads savedata back waits for them first (see SavedataParam::WaitForPendingWrites.)
+	struct PendingSaveWrite {
+		std::string filename;
+		std::vector<u8> data;
+	};
+
+	std::mutex pendingWritesLock;
+	std::condition_variable pendingWritesCond;
+	std::deque<PendingSaveWrite> pendingWrites;
+	std::thread pendingWritesThread;
+	bool pendingWritesRunning = false;
+
+	bool CommitPSPFile(const PendingSaveWrite &write) {
+		// Write next to the real file and swap it in, so a crash mid-write can't leave a truncated save.
+		const std::string tempFilename = write.filename + ".ppssppnew";
+		if (!WritePSPFile(tempFilename, (u8 *)write.data.data(), (SceSize)write.data.size())) {
+			pspFileSystem.RemoveFile(tempFilename);
+			return false;
+		}
+		if (pspFileSystem.RenameFile(tempFilename, write.filename) == 0)
+			return true;
+		// Not all hosts replace on rename (e.g. Android content URIs.)
+		pspFileSystem.RemoveFile(write.filename);
+		if (pspFileSystem.RenameFile(tempFilename, write.filename) == 0)
+			return true;
+		pspFileSystem.RemoveFile(tempFilename);
+		return false;
+	}
+
+	void PendingWritesThread() {
+		SetCurrentThreadName("SaveWrite");
+
+		std::unique_lock<std::mutex> guard(pendingWritesLock);
+		while (!pendingWrites.empty()) {
+			// Leave it in the queue while writing, so it can still be peeked at.
+			const PendingSaveWrite &write = pendingWrites.front();
+			guard.unlock();
+			bool success = CommitPSPFile(write);
+			if (!success) {
+				ERROR_LOG(SCEUTILITY, "Error writing file %s", write.filename.c_str());
+				auto err = GetI18NCategory("Error");
+				host->NotifyUserMessage(err->T("Unable to write savedata, disk may be full"));
+			}
+			guard.lock();
+			pendingWrites.pop_front();
+		}
+		pendingWritesRunning = false;
+		pendingWritesCond.notify_all();
+	}
+
+	void QueuePSPFile(const std::string &filename, std::vector<u8> &&data) {
+		std::lock_guard<std::mutex> guard(pendingWritesLock);
+		pendingWrites.push_back({ filename, std::move(data) });
+		if (!pendingWritesRunning) {
+			// The previous thread (if any) has already drained the queue.
+			if (pendingWritesThread.joinable())
+				pendingWritesThread.join();
+			pendingWritesRunning = true;
+			pendingWritesThread = std::thread(&PendingWritesThread);
+		}
+	}
+
+	void QueuePSPFile(const std::string &filename, const u8 *data, SceSize dataSize) {
+		QueuePSPFile(filename, std::vector<u8>(data, data + dataSize));
+	}
+
+	// Reads the latest contents of a file, including writes that haven't reached the host yet.
+	bool ReadPendingOrPSPFile(const std::string &filename, std::vector<u8> &data) {
+		{
+			std::lock_guard<std::mutex> guard(pendingWritesLock);
+			for (auto it = pendingWrites.rbegin(); it != pendingWrites.rend(); ++it) {
+				if (it->filename == filename) {
+					data = it->data;
+					return true;
+				}
+			}
+		}
+		return pspFileSystem.ReadEntireFile(filename, data) >= 0;
+	}
+
 	bool PSPMatch(std::string text, std::string regexp)
 	{
 		if(text.empty() && regexp.empty())
@@ -323,6 +410,7 @@ bool SavedataParam::Delete(SceUtilitySavedataParam* param, int saveId) {
 	if (!param) {
 		return false;
 	}
+	WaitForPendingWrites();
 
 	// Sanity check, preventing full delete of savedata/ in MGS PW demo (!)
 	if (!strlen(param->gameName) && param->mode != SCE_UTILITY_SAVEDATA_TYPE_LISTALLDELETE) {
@@ -348,6 +436,7 @@ int SavedataParam::DeleteData(SceUtilitySavedataParam* param) {
 	if (!param) {
 		return SCE_UTILITY_SAVEDATA_ERROR_RW_FILE_NOT_FOUND;
 	}
+	WaitForPendingWrites();
 
 	std::string subFolder = GetGameName(param) + GetSaveName(param);
 	std::string fileName = GetFileName(param);
@@ -380,6 +469,13 @@ int SavedataParam::DeleteData(SceUtilitySavedataParam* param) {
 	return 0;
 }
 
+void SavedataParam::WaitForPendingWrites() {
+	std::unique_lock<std::mutex> guard(pendingWritesLock);
+	pendingWritesCond.wait(guard, [] { return !pendingWritesRunning; });
+	if (pendingWritesThread.joinable())
+		pendingWritesThread.join();
+}
+
 int SavedataParam::Save(SceUtilitySavedataParam* param, const std::string &saveDirName, bool secureMode) {
 	if (!param) {
 		return SCE_UTILITY_SAVEDATA_ERROR_SAVE_MS_NOSPACE;
@@ -456,7 +552,7 @@ int SavedataParam::Save(SceUtilitySavedataParam* param, const std::string &saveD
 	std::string sfopath = dirPath + "/" + SFO_FILENAME;
 	{
 		std::vector<u8> sfoData;
-		if (pspFileSystem.ReadEntireFile(sfopath, sfoData) >= 0)
+		if (ReadPendingOrPSPFile(sfopath, sfoData))
 			sfoFile.ReadSFO(sfoData);
 	}
 
@@ -514,7 +610,7 @@ int SavedataParam::Save(SceUtilitySavedataParam* param, const std::string &saveD
 		if(offset >= 0)
 			UpdateHash(sfoData, (int)sfoSize, offset, DetermineCryptMode(param));
 	}
-	WritePSPFile(sfopath, sfoData, (SceSize)sfoSize);
+	QueuePSPFile(sfopath, sfoData, (SceSize)sfoSize);
 	delete[] sfoData;
 
 	if(param->dataBuf.IsValid())	// Can launch save without save data in mode 13
@@ -545,11 +641,15 @@ int SavedataParam::Save(SceUtilitySavedataParam* param, const std::string &saveD
 		if (fileName == "") {
 			delete[] cryptedData;
 		} else {
-			if (!WritePSPFile(filePath, data_, saveSize)) {
-				ERROR_LOG(SCEUTILITY, "Error writing file %s", filePath.c_str());
+			// The write itself happens later, so check up front that it will fit.
+			PSPFileInfo oldInfo = pspFileSystem.GetFileInfo(filePath);
+			u64 reusedSize = oldInfo.exists ? oldInfo.size : 0;
+			if (MemoryStick_FreeSpace() + reusedSize < saveSize) {
+				ERROR_LOG(SCEUTILITY, "Not enough space to write file %s", filePath.c_str());
 				delete[] cryptedData;
 				return SCE_UTILITY_SAVEDATA_ERROR_SAVE_MS_NOSPACE;
 			}
+			QueuePSPFile(filePath, data_, saveSize);
 			delete[] cryptedData;
 		}	
 	}
@@ -559,25 +659,25 @@ int SavedataParam::Save(SceUtilitySavedataParam* param, const std::string &saveD
 	if (param->icon0FileData.buf.IsValid())
 	{
 		std::string icon0path = dirPath + "/" + ICON0_FILENAME;
-		WritePSPFile(icon0path, param->icon0FileData.buf, param->icon0FileData.size);
+		QueuePSPFile(icon0path, param->icon0FileData.buf, param->icon0FileData.size);
 	}
 	// SAVE ICON1
 	if (param->icon1FileData.buf.IsValid())
 	{
 		std::string icon1path = dirPath + "/" + ICON1_FILENAME;
-		WritePSPFile(icon1path, param->icon1FileData.buf, param->icon1FileData.size);
+		QueuePSPFile(icon1path, param->icon1FileData.buf, param->icon1FileData.size);
 	}
 	// SAVE PIC1
 	if (param->pic1FileData.buf.IsValid())
 	{
 		std::string pic1path = dirPath + "/" + PIC1_FILENAME;
-		WritePSPFile(pic1path, param->pic1FileData.buf, param->pic1FileData.size);
+		QueuePSPFile(pic1path, param->pic1FileData.buf, param->pic1FileData.size);
 	}
 	// Save SND
 	if (param->snd0FileData.buf.IsValid())
 	{
 		std::string snd0path = dirPath + "/" + SND0_FILENAME;
-		WritePSPFile(snd0path, param->snd0FileData.buf, param->snd0FileData.size);
+		QueuePSPFile(snd0path, param->snd0FileData.buf, param->snd0FileData.size);
 	}
 	return 0;
 }
@@ -586,6 +686,7 @@ int SavedataParam::Load(SceUtilitySavedataParam *param, const std::string &saveD
 	if (!param) {
 		return SCE_UTILITY_SAVEDATA_ERROR_LOAD_NO_DATA;
 	}
+	WaitForPendingWrites();
 
 	bool isRWMode = param->mode == SCE_UTILITY_SAVEDATA_TYPE_READDATA || param->mode == SCE_UTILITY_SAVEDATA_TYPE_READDATASECURE;
 
@@ -1068,6 +1169,7 @@ std::string SavedataParam::GetSpaceText(u64 size, bool roundUp)
 
 int SavedataParam::GetSizes(SceUtilitySavedataParam *param)
 {
+	WaitForPendingWrites();
 	if (!param) {
 		return SCE_UTILITY_SAVEDATA_ERROR_SIZES_NO_DATA;
 	}
@@ -1164,6 +1266,7 @@ int SavedataParam::GetSizes(SceUtilitySavedataParam *param)
 
 bool SavedataParam::GetList(SceUtilitySavedataParam *param)
 {
+	WaitForPendingWrites();
 	if (!param) {
 		return false;
 	}
@@ -1223,6 +1326,7 @@ bool SavedataParam::GetList(SceUtilitySavedataParam *param)
 
 int SavedataParam::GetFilesList(SceUtilitySavedataParam *param)
 {
+	WaitForPendingWrites();
 	if (!param)	{
 		return SCE_UTILITY_SAVEDATA_ERROR_RW_BAD_STATUS;
 	}
@@ -1338,6 +1442,7 @@ int SavedataParam::GetFilesList(SceUtilitySavedataParam *param)
 
 bool SavedataParam::GetSize(SceUtilitySavedataParam *param)
 {
+	WaitForPendingWrites();
 	if (!param)
 	{
 		return false;
@@ -1433,6 +1538,7 @@ void SavedataParam::Clear()
 
 int SavedataParam::SetPspParam(SceUtilitySavedataParam *param)
 {
+	WaitForPendingWrites();
 	pspParam = param;
 	if (!pspParam) {
 		Clear();
@@ -1876,6 +1982,7 @@ void SavedataParam::DoState(PointerWrap &p)
 
 int SavedataParam::GetSaveCryptMode(SceUtilitySavedataParam* param, const std::string &saveDirName)
 {
+	WaitForPendingWrites();
 	ParamSFOData sfoFile;
 	std::string dirPath = GetSaveFilePath(param, GetSaveDir(param, saveDirName));
 	std::string sfopath = dirPath + "/" + SFO_FILENAME;
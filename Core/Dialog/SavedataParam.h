@@ -304,6 +304,8 @@ class SavedataParam
 	SavedataParam();
 
 	static void Init();
+	// Blocks until savedata written by Save() has reached the host.
+	static void WaitForPendingWrites();
 	std::string GetSaveFilePath(const SceUtilitySavedataParam *param, int saveId = -1) const;
 	std::string GetSaveFilePath(const SceUtilitySavedataParam *param, const std::string &saveDir) const;
 	std::string GetSaveDirName(const SceUtilitySavedataParam *param, int saveId = -1) const;
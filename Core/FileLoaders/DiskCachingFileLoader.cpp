@@ -30,6 +30,8 @@
 #include "Common/File/Path.h"
 #include "Common/Log.h"
 #include "Common/CommonWindows.h"
+#include "Common/Thread/ThreadUtil.h"
+#include "Common/TimeUtil.h"
 #include "Core/FileLoaders/DiskCachingFileLoader.h"
 #include "Core/System.h"
 
@@ -63,11 +65,17 @@ void DiskCachingFileLoader::Prepare() {
 }
 
 DiskCachingFileLoader::~DiskCachingFileLoader() {
+	StopPrefetch();
 	if (filesize_ > 0) {
 		ShutdownCache();
 	}
 }
 
+void DiskCachingFileLoader::Cancel() {
+	prefetchCancel_ = true;
+	ProxiedFileLoader::Cancel();
+}
+
 bool DiskCachingFileLoader::Exists() {
 	Prepare();
 	return ProxiedFileLoader::Exists();
@@ -142,6 +150,39 @@ void DiskCachingFileLoader::InitCache() {
 
 	cache_ = entry;
 	cache_->AddRef();
+
+	// Only worth it for the game itself, not for e.g. reading an icon in the game list.
+	if ((PSP_IsIniting() || PSP_IsInited()) && cache_->ClaimPrefetch()) {
+		StartPrefetch();
+	}
+}
+
+void DiskCachingFileLoader::StartPrefetch() {
+	prefetchCancel_ = false;
+	prefetchThread_ = std::thread([this] {
+		SetCurrentThreadName("DiskCachePrefetch");
+
+		size_t orderPos = 0;
+		while (!prefetchCancel_) {
+			DiskCachingFileLoaderCache::PrefetchResult result = cache_->Prefetch(backend_, orderPos);
+			if (result == DiskCachingFileLoaderCache::PrefetchResult::DONE) {
+				break;
+			}
+			if (result == DiskCachingFileLoaderCache::PrefetchResult::WAIT) {
+				// The game hasn't caught up yet.
+				sleep_ms(10);
+			}
+		}
+	});
+}
+
+void DiskCachingFileLoader::StopPrefetch() {
+	if (!prefetchThread_.joinable()) {
+		return;
+	}
+	prefetchCancel_ = true;
+	prefetchThread_.join();
+	cache_->ReleasePrefetch();
 }
 
 void DiskCachingFileLoader::ShutdownCache() {
@@ -202,6 +243,8 @@ void DiskCachingFileLoaderCache::ShutdownCache() {
 			failed = true;
 		} else if (fwrite(&index_[0], sizeof(BlockInfo), indexCount_, f_) != indexCount_) {
 			failed = true;
+		} else if (!WriteAccessOrder()) {
+			failed = true;
 		} else if (fflush(f_) != 0) {
 			failed = true;
 		}
@@ -216,6 +259,8 @@ void DiskCachingFileLoaderCache::ShutdownCache() {
 
 	index_.clear();
 	blockIndexLookup_.clear();
+	accessOrder_.clear();
+	accessOrderPos_.clear();
 	cacheSize_ = 0;
 }
 
@@ -232,6 +277,10 @@ size_t DiskCachingFileLoaderCache::ReadFromCache(s64 pos, size_t bytes, void *da
 	size_t offset = (size_t)(pos - (cacheStartPos * (u64)blockSize_));
 	u8 *p = (u8 *)data;
 
+	for (s64 i = cacheStartPos; i <= cacheEndPos; ++i) {
+		RecordAccess((u32)i);
+	}
+
 	for (s64 i = cacheStartPos; i <= cacheEndPos; ++i) {
 		auto &info = index_[i];
 		if (info.block == INVALID_BLOCK) {
@@ -397,6 +446,75 @@ void DiskCachingFileLoaderCache::RebalanceGenerations() {
 	oldestGeneration_ = 0;
 }
 
+void DiskCachingFileLoaderCache::RecordAccess(u32 indexPos) {
+	u32 &pos = accessOrderPos_[indexPos];
+	if (pos == INVALID_INDEX) {
+		pos = (u32)accessOrder_.size();
+		accessOrder_.push_back(indexPos);
+	}
+	gameOrderPos_ = std::max(gameOrderPos_, (size_t)pos);
+}
+
+bool DiskCachingFileLoaderCache::ClaimPrefetch() {
+	std::lock_guard<std::mutex> guard(lock_);
+	// Nothing to go on for the first boot.
+	if (!f_ || prefetchClaimed_ || accessOrder_.empty()) {
+		return false;
+	}
+	prefetchClaimed_ = true;
+	return true;
+}
+
+void DiskCachingFileLoaderCache::ReleasePrefetch() {
+	std::lock_guard<std::mutex> guard(lock_);
+	prefetchClaimed_ = false;
+}
+
+DiskCachingFileLoaderCache::PrefetchResult DiskCachingFileLoaderCache::Prefetch(FileLoader *backend, size_t &orderPos) {
+	u32 indexPos;
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		if (!f_) {
+			return PrefetchResult::DONE;
+		}
+
+		while (orderPos < accessOrder_.size() && index_[accessOrder_[orderPos]].block != INVALID_BLOCK) {
+			++orderPos;
+		}
+		if (orderPos >= accessOrder_.size()) {
+			return PrefetchResult::DONE;
+		}
+		if (orderPos > gameOrderPos_ + PREFETCH_AHEAD_BLOCKS) {
+			return PrefetchResult::WAIT;
+		}
+		// This is only a guess, so never push out blocks to make room for it.
+		if (cacheSize_ >= maxBlocks_) {
+			return PrefetchResult::DONE;
+		}
+		indexPos = accessOrder_[orderPos];
+	}
+
+	// The backend is likely slow (that's why we're here), so don't block the game's reads meanwhile.
+	u8 *buf = new u8[blockSize_];
+	size_t readBytes = backend->ReadAt((s64)indexPos * (u64)blockSize_, blockSize_, buf, FileLoader::Flags::NONE);
+
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		auto &info = index_[indexPos];
+		// The game may have read it itself while we were busy.
+		if (f_ && info.block == INVALID_BLOCK && readBytes != 0 && cacheSize_ < maxBlocks_) {
+			info.block = AllocateBlock(indexPos);
+			WriteBlockData(info, buf);
+			WriteIndexData(indexPos, info);
+			++cacheSize_;
+		}
+	}
+	delete [] buf;
+
+	++orderPos;
+	return PrefetchResult::FETCHED;
+}
+
 u32 DiskCachingFileLoaderCache::AllocateBlock(u32 indexPos) {
 	for (size_t i = 0; i < blockIndexLookup_.size(); ++i) {
 		if (blockIndexLookup_[i] == INVALID_INDEX) {
@@ -435,8 +553,8 @@ ::Path DiskCachingFileLoaderCache::MakeCacheFilePath(const Path &filename) {
 }
 
 s64 DiskCachingFileLoaderCache::GetBlockOffset(u32 block) {
-	// This is where the blocks start.
-	s64 blockOffset = (s64)sizeof(FileHeader) + (s64)indexCount_ * (s64)sizeof(BlockInfo);
+	// This is where the blocks start, after the index and access order.
+	s64 blockOffset = (s64)sizeof(FileHeader) + (s64)indexCount_ * (s64)sizeof(BlockInfo) + (s64)(indexCount_ + 1) * (s64)sizeof(u32_le);
 	// Now to the actual block.
 	return blockOffset + (s64)block * (s64)blockSize_;
 }
@@ -581,6 +699,10 @@ void DiskCachingFileLoaderCache::LoadCacheIndex() {
 		CloseFileHandle();
 		return;
 	}
+	LoadAccessOrder();
+	if (!f_) {
+		return;
+	}
 
 	// Now let's set some values we need.
 	oldestGeneration_ = std::numeric_limits<u16>::max();
@@ -607,6 +729,43 @@ void DiskCachingFileLoaderCache::LoadCacheIndex() {
 	}
 }
 
+void DiskCachingFileLoaderCache::LoadAccessOrder() {
+	// Right after the index, which we just read.
+	u32_le orderCount;
+	if (fread(&orderCount, sizeof(orderCount), 1, f_) != 1 || orderCount > indexCount_) {
+		CloseFileHandle();
+		return;
+	}
+
+	accessOrder_.resize(orderCount);
+	accessOrderPos_.clear();
+	accessOrderPos_.resize(indexCount_, INVALID_INDEX);
+	gameOrderPos_ = 0;
+	if (orderCount != 0 && fread(&accessOrder_[0], sizeof(u32_le), orderCount, f_) != orderCount) {
+		CloseFileHandle();
+		return;
+	}
+
+	for (size_t i = 0; i < accessOrder_.size(); ++i) {
+		const u32 indexPos = accessOrder_[i];
+		if (indexPos >= indexCount_ || accessOrderPos_[indexPos] != INVALID_INDEX) {
+			// Corrupt, just keep what we had so far.
+			accessOrder_.resize(i);
+			break;
+		}
+		accessOrderPos_[indexPos] = (u32)i;
+	}
+}
+
+bool DiskCachingFileLoaderCache::WriteAccessOrder() {
+	// Assumes the file position is right after the index.
+	u32_le orderCount = (u32)accessOrder_.size();
+	if (fwrite(&orderCount, sizeof(orderCount), 1, f_) != 1) {
+		return false;
+	}
+	return orderCount == 0 || fwrite(&accessOrder_[0], sizeof(u32_le), orderCount, f_) == orderCount;
+}
+
 void DiskCachingFileLoaderCache::CreateCacheFile(const Path &path) {
 	maxBlocks_ = DetermineMaxBlocks();
 	if (maxBlocks_ < MAX_BLOCKS_LOWER_BOUND) {
@@ -656,6 +815,17 @@ void DiskCachingFileLoaderCache::CreateCacheFile(const Path &path) {
 		CloseFileHandle();
 		return;
 	}
+
+	// Reserve room for the access order, it's filled in on shutdown.
+	accessOrder_.clear();
+	accessOrderPos_.clear();
+	accessOrderPos_.resize(indexCount_, INVALID_INDEX);
+	gameOrderPos_ = 0;
+	std::vector<u32_le> emptyOrder(indexCount_ + 1, 0);
+	if (fwrite(&emptyOrder[0], sizeof(u32_le), emptyOrder.size(), f_) != emptyOrder.size()) {
+		CloseFileHandle();
+		return;
+	}
 	if (fflush(f_) != 0) {
 		CloseFileHandle();
 		return;
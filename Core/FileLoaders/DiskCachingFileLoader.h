@@ -17,9 +17,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <map>
 #include <mutex>
+#include <thread>
 
 #include "Common/Common.h"
 #include "Common/File/Path.h"
@@ -42,17 +44,24 @@ class DiskCachingFileLoader : public ProxiedFileLoader {
 	}
 	size_t ReadAt(s64 absolutePos, size_t bytes, void *data, Flags flags = Flags::NONE) override;
 
+	void Cancel() override;
+
 	static std::vector<Path> GetCachedPathsInUse();
 
 private:
 	void Prepare();
 	void InitCache();
 	void ShutdownCache();
+	void StartPrefetch();
+	void StopPrefetch();
 
 	std::once_flag preparedFlag_;
 	s64 filesize_ = 0;
 	DiskCachingFileLoaderCache *cache_ = nullptr;
 
+	std::thread prefetchThread_;
+	std::atomic<bool> prefetchCancel_{};
+
 	// We don't support concurrent disk cache access (we use memory cached indexes.)
 	// So we have to ensure there's only one of these per.
 	static std::map<Path, DiskCachingFileLoaderCache *> caches_;
@@ -86,12 +95,26 @@ class DiskCachingFileLoaderCache {
 
 	bool HasData() const;
 
+	enum class PrefetchResult {
+		FETCHED,
+		WAIT,
+		DONE,
+	};
+
+	// Only one loader may prefetch into a cache at a time.
+	bool ClaimPrefetch();
+	void ReleasePrefetch();
+	// Caches the next block from a previous boot's access order, if the game is getting close to it.
+	// orderPos is the prefetcher's position in that order, start at 0.
+	PrefetchResult Prefetch(FileLoader *backend, size_t &orderPos);
+
 private:
 	void InitCache(const Path &path);
 	void ShutdownCache();
 	bool MakeCacheSpaceFor(size_t blocks);
 	void RebalanceGenerations();
 	u32 AllocateBlock(u32 indexPos);
+	void RecordAccess(u32 indexPos);
 
 	struct BlockInfo;
 	bool ReadBlockData(u8 *dest, BlockInfo &info, size_t offset, size_t size);
@@ -103,6 +126,8 @@ class DiskCachingFileLoaderCache {
 	std::string MakeCacheFilename(const Path &path);
 	bool LoadCacheFile(const Path &path);
 	void LoadCacheIndex();
+	void LoadAccessOrder();
+	bool WriteAccessOrder();
 	void CreateCacheFile(const Path &path);
 	bool LockCacheFile(bool lockStatus);
 	bool RemoveCacheFile(const Path &path);
@@ -124,13 +149,18 @@ class DiskCachingFileLoaderCache {
 	//   32 (fileoffset - headersize) / blockSize -> -1=not present
 	//   16 generation?
 	//   16 hits?
+	// 32 orderCount
+	// order[filesize / blockSize] <-- ~250 KB for 4GB
+	//   32 index of the Nth distinct block the game read, first orderCount used
 	// blocks[up to maxBlocks]
 	//   8 * blockSize
 
 	enum {
-		CACHE_VERSION = 3,
+		CACHE_VERSION = 4,
 		DEFAULT_BLOCK_SIZE = 65536,
 		MAX_BLOCKS_PER_READ = 16,
+		// How far ahead of the game (in recorded blocks) to prefetch.
+		PREFETCH_AHEAD_BLOCKS = 256, // 16 MB
 		MAX_BLOCKS_LOWER_BOUND = 256, // 16 MB
 		MAX_BLOCKS_UPPER_BOUND = 8192, // 512 MB
 		INVALID_BLOCK = 0xFFFFFFFF,
@@ -174,6 +204,14 @@ class DiskCachingFileLoaderCache {
 	std::vector<BlockInfo> index_;
 	std::vector<u32> blockIndexLookup_;
 
+	// Distinct blocks in the order the game first read them, kept across boots.
+	std::vector<u32_le> accessOrder_;
+	// Position of each index entry in accessOrder_, or INVALID_INDEX.
+	std::vector<u32> accessOrderPos_;
+	// Furthest position in accessOrder_ the game has read this boot.
+	size_t gameOrderPos_ = 0;
+	bool prefetchClaimed_ = false;
+
 	FILE *f_ = nullptr;
 	int fd_ = 0;
 
@@ -30,6 +30,7 @@ HTTPFileLoader::HTTPFileLoader(const ::Path &filename)
 void HTTPFileLoader::Prepare() {
 	std::call_once(preparedFlag_, [this](){
 		client_.SetUserAgent(StringFromFormat("PPSSPP/%s", PPSSPP_GIT_VERSION));
+		client_.SetKeepAlive(true);
 
 		std::vector<std::string> responseHeaders;
 		Url resourceURL = url_;
@@ -102,8 +103,12 @@ void HTTPFileLoader::Prepare() {
 			}
 		}
 
-		// TODO: Keepalive instead.
-		Disconnect();
+		// Reuse the connection for the reads, if the server lets us.
+		if (!client_.ResponseKeepsAlive()) {
+			keepAlive_ = false;
+			client_.SetKeepAlive(false);
+			Disconnect();
+		}
 
 		if (!acceptsRange) {
 			WARN_LOG(LOADER, "HTTP server did not advertise support for range requests.");
@@ -187,32 +192,128 @@ size_t HTTPFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, Flags f
 		return 0;
 	}
 
-	Connect();
-	if (!connected_) {
-		return 0;
+	// Reads are coalesced into aligned blocks, so small and nearby reads share round trips.
+	u8 *dest = (u8 *)data;
+	s64 pos = absolutePos;
+	while (pos < absoluteEnd) {
+		s64 block = pos / FETCH_SIZE;
+		const std::vector<u8> *buf = FetchBlock(block);
+		size_t offset = (size_t)(pos - block * FETCH_SIZE);
+		if (!buf || offset >= buf->size()) {
+			break;
+		}
+
+		size_t toCopy = (size_t)std::min((s64)(buf->size() - offset), absoluteEnd - pos);
+		memcpy(dest, buf->data() + offset, toCopy);
+		dest += toCopy;
+		pos += toCopy;
+	}
+
+	size_t readBytes = (size_t)(pos - absolutePos);
+	filepos_ = absolutePos + readBytes;
+	return readBytes;
+}
+
+const std::vector<u8> *HTTPFileLoader::FetchBlock(s64 block) {
+	auto cached = blocks_.find(block);
+	if (cached != blocks_.end()) {
+		return &cached->second;
+	}
+
+	// A kept alive connection may have been closed by the server meanwhile, so retry once.
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		if (std::find(inflight_.begin(), inflight_.end(), block) == inflight_.end()) {
+			// We seeked away from the readahead.  Reconnecting is cheaper than waiting for it.
+			if (!inflight_.empty()) {
+				Disconnect();
+			}
+			Connect();
+			if (!connected_) {
+				latestError_ = "Could not connect (refused to connect)";
+				return nullptr;
+			}
+			if (!SendRangeRequest(block)) {
+				Disconnect();
+				continue;
+			}
+		}
+
+		// Keep a few requests in flight, so sequential reads don't wait a round trip each.
+		SendReadahead(block);
+
+		// Responses arrive in the order the requests were sent.
+		while (!inflight_.empty()) {
+			s64 next = inflight_.front();
+			std::vector<u8> data;
+			if (!ReadRangeResponse(next, data)) {
+				Disconnect();
+				break;
+			}
+
+			inflight_.pop_front();
+			CacheBlock(next, std::move(data));
+			if (!keepAlive_) {
+				Disconnect();
+			}
+			if (next == block) {
+				return &blocks_[block];
+			}
+		}
 	}
 
+	return nullptr;
+}
+
+bool HTTPFileLoader::SendRangeRequest(s64 block) {
+	s64 start = block * FETCH_SIZE;
+	s64 end = std::min(start + (s64)FETCH_SIZE, filesize_);
+
 	char requestHeaders[4096];
 	// Note that the Range header is *inclusive*.
 	snprintf(requestHeaders, sizeof(requestHeaders),
-		"Range: bytes=%lld-%lld\r\n", absolutePos, absoluteEnd - 1);
+		"Range: bytes=%lld-%lld\r\n", start, end - 1);
 
 	http::RequestParams req(url_.Resource(), "*/*");
 	int err = client_.SendRequest("GET", req, requestHeaders, &progress_);
 	if (err < 0) {
 		latestError_ = "Invalid response reading data";
-		Disconnect();
-		return 0;
+		return false;
 	}
 
-	net::Buffer readbuf;
+	inflight_.push_back(block);
+	return true;
+}
+
+void HTTPFileLoader::SendReadahead(s64 block) {
+	if (!keepAlive_ || !connected_) {
+		return;
+	}
+
+	s64 lastBlock = (filesize_ - 1) / FETCH_SIZE;
+	for (s64 next = block + 1; next <= block + PIPELINE_DEPTH && next <= lastBlock; ++next) {
+		if (inflight_.size() >= PIPELINE_DEPTH) {
+			break;
+		}
+		if (blocks_.count(next) || std::find(inflight_.begin(), inflight_.end(), next) != inflight_.end()) {
+			continue;
+		}
+		// If this fails, we'll notice when reading the responses.
+		if (!SendRangeRequest(next)) {
+			break;
+		}
+	}
+}
+
+bool HTTPFileLoader::ReadRangeResponse(s64 block, std::vector<u8> &data) {
+	s64 start = block * FETCH_SIZE;
+	s64 end = std::min(start + (s64)FETCH_SIZE, filesize_);
+
 	std::vector<std::string> responseHeaders;
-	int code = client_.ReadResponseHeaders(&readbuf, responseHeaders, &progress_);
+	int code = client_.ReadResponseHeaders(&readbuf_, responseHeaders, &progress_);
 	if (code != 206) {
 		ERROR_LOG(LOADER, "HTTP server did not respond with range, received code=%03d", code);
 		latestError_ = "Invalid response reading data";
-		Disconnect();
-		return 0;
+		return false;
 	}
 
 	// TODO: Expire cache via ETag, etc.
@@ -225,10 +326,10 @@ size_t HTTPFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, Flags f
 			std::string lowerHeader = header;
 			std::transform(lowerHeader.begin(), lowerHeader.end(), lowerHeader.begin(), tolower);
 			if (sscanf(lowerHeader.c_str(), "content-range: bytes %lld-%lld/%lld", &first, &last, &total) >= 2) {
-				if (first == absolutePos && last == absoluteEnd - 1) {
+				if (first == start && last == end - 1) {
 					supportedResponse = true;
 				} else {
-					ERROR_LOG(LOADER, "Unexpected HTTP range: got %lld-%lld, wanted %lld-%lld.", first, last, absolutePos, absoluteEnd - 1);
+					ERROR_LOG(LOADER, "Unexpected HTTP range: got %lld-%lld, wanted %lld-%lld.", first, last, start, end - 1);
 				}
 			} else {
 				ERROR_LOG(LOADER, "Unexpected HTTP range response: %s", header.c_str());
@@ -238,25 +339,41 @@ size_t HTTPFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, Flags f
 
 	// TODO: Would be nice to read directly.
 	net::Buffer output;
-	int res = client_.ReadResponseEntity(&readbuf, responseHeaders, &output, &progress_);
+	int res = client_.ReadResponseEntity(&readbuf_, responseHeaders, &output, &progress_);
 	if (res != 0) {
+		// A partial response would put the following pipelined responses out of sync.
 		ERROR_LOG(LOADER, "Unable to read HTTP response entity: %d", res);
-		// Let's take anything we got anyway.  Not worse than returning nothing?
+		latestError_ = "Invalid response reading data";
+		return false;
 	}
 
-	// TODO: Keepalive instead.
-	Disconnect();
+	if (!client_.ResponseKeepsAlive() && keepAlive_) {
+		INFO_LOG(LOADER, "HTTP server closes connections, each read will reconnect");
+		keepAlive_ = false;
+		client_.SetKeepAlive(false);
+	}
 
-	if (!supportedResponse) {
+	if (!supportedResponse || (s64)output.size() != end - start) {
 		ERROR_LOG(LOADER, "HTTP server did not respond with the range we wanted.");
 		latestError_ = "Invalid response reading data";
-		return 0;
+		return false;
 	}
 
-	size_t readBytes = output.size();
-	output.Take(readBytes, (char *)data);
-	filepos_ = absolutePos + readBytes;
-	return readBytes;
+	data.resize(output.size());
+	output.Take(output.size(), (char *)&data[0]);
+	return true;
+}
+
+void HTTPFileLoader::CacheBlock(s64 block, std::vector<u8> &&data) {
+	if (blocks_.count(block) == 0) {
+		blockOrder_.push_back(block);
+	}
+	blocks_[block] = std::move(data);
+
+	while (blocks_.size() > MAX_CACHED_BLOCKS) {
+		blocks_.erase(blockOrder_.front());
+		blockOrder_.pop_front();
+	}
 }
 
 void HTTPFileLoader::Connect() {
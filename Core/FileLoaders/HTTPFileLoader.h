@@ -17,11 +17,14 @@
 
 #pragma once
 
+#include <deque>
+#include <map>
 #include <mutex>
 #include <vector>
 
 #include "Common/File/Path.h"
 #include "Common/Net/HTTPClient.h"
+#include "Common/Net/NetBuffer.h"
 #include "Common/Net/Resolve.h"
 #include "Common/Net/URL.h"
 #include "Common/CommonTypes.h"
@@ -65,8 +68,32 @@ class HTTPFileLoader : public FileLoader {
 			client_.Disconnect();
 		}
 		connected_ = false;
+		// Anything still in flight is lost with the connection.
+		inflight_.clear();
+		readbuf_.clear();
 	}
 
+	// Reads go through aligned blocks, fetched with pipelined range requests on a kept alive connection.
+	const std::vector<u8> *FetchBlock(s64 block);
+	bool SendRangeRequest(s64 block);
+	void SendReadahead(s64 block);
+	bool ReadRangeResponse(s64 block, std::vector<u8> &data);
+	void CacheBlock(s64 block, std::vector<u8> &&data);
+
+	enum {
+		FETCH_SIZE = 256 * 1024,
+		PIPELINE_DEPTH = 4,
+		MAX_CACHED_BLOCKS = 16,
+	};
+
+	std::map<s64, std::vector<u8>> blocks_;
+	std::deque<s64> blockOrder_;
+	// Requested blocks, in the order the responses will arrive.
+	std::deque<s64> inflight_;
+	net::Buffer readbuf_;
+	// Cleared if the server won't keep connections open, then each request uses its own connection.
+	bool keepAlive_ = true;
+
 	s64 filesize_ = 0;
 	s64 filepos_ = 0;
 	Url url_;
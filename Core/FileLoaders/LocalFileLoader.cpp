@@ -15,7 +15,9 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 
 #include "ppsspp_config.h"
 
@@ -33,8 +35,20 @@
 #include "Common/CommonWindows.h"
 #else
 #include <fcntl.h>
+#include <unistd.h>
 #endif
 
+// Mapping a whole ISO needs a lot of address space, so only on 64-bit.
+#if PPSSPP_ARCH(64BIT) && !PPSSPP_PLATFORM(SWITCH) && !PPSSPP_PLATFORM(UWP)
+#define LOCAL_FILE_MAPPING 1
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+#endif
+
+// Smaller reads than this are left to the normal page fault read-ahead.
+static const size_t MAPPED_PREFETCH_MIN = 64 * 1024;
+
 #ifndef _WIN32
 
 void LocalFileLoader::DetectSizeFd() {
@@ -50,7 +64,7 @@ void LocalFileLoader::DetectSizeFd() {
 }
 #endif
 
-LocalFileLoader::LocalFileLoader(const Path &filename)
+LocalFileLoader::LocalFileLoader(const Path &filename, bool allowMapping)
 	: filesize_(0), filename_(filename) {
 	if (filename.empty()) {
 		ERROR_LOG(FILESYS, "LocalFileLoader can't load empty filenames");
@@ -80,6 +94,8 @@ LocalFileLoader::LocalFileLoader(const Path &filename)
 	}
 
 	DetectSizeFd();
+	if (allowMapping)
+		MapFile();
 
 #else // _WIN32
 
@@ -102,10 +118,13 @@ LocalFileLoader::LocalFileLoader(const Path &filename)
 	}
 	filesize_ = end_offset.QuadPart;
 	SetFilePointerEx(handle_, zero, nullptr, FILE_BEGIN);
+	if (allowMapping)
+		MapFile();
 #endif // _WIN32
 }
 
 LocalFileLoader::~LocalFileLoader() {
+	UnmapFile();
 #ifndef _WIN32
 	if (fd_ != -1) {
 		close(fd_);
@@ -152,6 +171,75 @@ s64 LocalFileLoader::FileSize() {
 	return filesize_;
 }
 
+void LocalFileLoader::MapFile() {
+#ifdef LOCAL_FILE_MAPPING
+	// Content URIs can live on removable storage, where a mapping turns errors into crashes.
+	if (isOpenedByFd_ || filesize_ == 0)
+		return;
+
+#ifndef _WIN32
+	void *ptr = mmap(nullptr, (size_t)filesize_, PROT_READ, MAP_SHARED, fd_, 0);
+	if (ptr == MAP_FAILED) {
+		WARN_LOG(FILESYS, "Failed to map %s, reading normally", filename_.c_str());
+		return;
+	}
+	// Games seek around a lot, so don't let the kernel read far ahead on every fault.
+	// Large reads ask for their range explicitly instead, see PrefetchMapped().
+	madvise(ptr, (size_t)filesize_, MADV_RANDOM);
+	mapped_ = (const u8 *)ptr;
+#else
+	mapping_ = CreateFileMapping(handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping_ == nullptr) {
+		WARN_LOG(FILESYS, "Failed to map %s, reading normally", filename_.c_str());
+		return;
+	}
+	mapped_ = (const u8 *)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+	if (!mapped_) {
+		WARN_LOG(FILESYS, "Failed to map view of %s, reading normally", filename_.c_str());
+		CloseHandle(mapping_);
+		mapping_ = nullptr;
+	}
+#endif
+#endif
+}
+
+void LocalFileLoader::UnmapFile() {
+#ifdef LOCAL_FILE_MAPPING
+	if (!mapped_)
+		return;
+#ifndef _WIN32
+	munmap((void *)mapped_, (size_t)filesize_);
+#else
+	UnmapViewOfFile(mapped_);
+	CloseHandle(mapping_);
+	mapping_ = nullptr;
+#endif
+	mapped_ = nullptr;
+#endif
+}
+
+void LocalFileLoader::PrefetchMapped(s64 absolutePos, size_t bytes) {
+#ifdef LOCAL_FILE_MAPPING
+	if (bytes < MAPPED_PREFETCH_MIN)
+		return;
+#ifndef _WIN32
+	static const uintptr_t pageMask = (uintptr_t)sysconf(_SC_PAGESIZE) - 1;
+	uintptr_t start = (uintptr_t)(mapped_ + absolutePos) & ~pageMask;
+	uintptr_t end = (uintptr_t)(mapped_ + absolutePos + bytes);
+	madvise((void *)start, end - start, MADV_WILLNEED);
+#else
+	// PrefetchVirtualMemory is Windows 8+, just let the faults do the reading there.
+#endif
+#endif
+}
+
+const u8 *LocalFileLoader::GetPointer(s64 absolutePos, size_t bytes) {
+	if (!mapped_ || absolutePos < 0 || (u64)absolutePos + bytes > filesize_)
+		return nullptr;
+	PrefetchMapped(absolutePos, bytes);
+	return mapped_ + absolutePos;
+}
+
 size_t LocalFileLoader::ReadAt(s64 absolutePos, size_t bytes, size_t count, void *data, Flags flags) {
 	if (bytes == 0)
 		return 0;
@@ -161,6 +249,15 @@ size_t LocalFileLoader::ReadAt(s64 absolutePos, size_t bytes, size_t count, void
 		return 0;
 	}
 
+	if (mapped_) {
+		if (absolutePos < 0 || (u64)absolutePos >= filesize_)
+			return 0;
+		count = std::min(count, (size_t)((filesize_ - absolutePos) / bytes));
+		PrefetchMapped(absolutePos, bytes * count);
+		memcpy(data, mapped_ + absolutePos, bytes * count);
+		return count;
+	}
+
 #if PPSSPP_PLATFORM(SWITCH)
 	// Toolchain has no fancy IO API.  We must lock.
 	std::lock_guard<std::mutex> guard(readLock_);
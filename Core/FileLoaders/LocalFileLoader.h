@@ -29,7 +29,7 @@ typedef void *HANDLE;
 
 class LocalFileLoader : public FileLoader {
 public:
-	LocalFileLoader(const Path &filename);
+	LocalFileLoader(const Path &filename, bool allowMapping = false);
 	virtual ~LocalFileLoader();
 
 	virtual bool Exists() override;
@@ -39,14 +39,22 @@ class LocalFileLoader : public FileLoader {
 		return filename_;
 	}
 	virtual size_t ReadAt(s64 absolutePos, size_t bytes, size_t count, void *data, Flags flags = Flags::NONE) override;
+	const u8 *GetPointer(s64 absolutePos, size_t bytes) override;
 
 private:
+	void MapFile();
+	void UnmapFile();
+	void PrefetchMapped(s64 absolutePos, size_t bytes);
+
 #ifndef _WIN32
 	void DetectSizeFd();
 	int fd_ = -1;
 #else
 	HANDLE handle_ = 0;
+	HANDLE mapping_ = 0;
 #endif
+	// Whole file mapped read-only, or nullptr when reading through the handle.
+	const u8 *mapped_ = nullptr;
 	u64 filesize_ = 0;
 	Path filename_;
 	std::mutex readLock_;
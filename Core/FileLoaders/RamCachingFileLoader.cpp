@@ -22,10 +22,20 @@
 
 #include "Common/Thread/ThreadUtil.h"
 #include "Common/TimeUtil.h"
+#include "Core/Config.h"
 #include "Core/FileLoaders/RamCachingFileLoader.h"
 
 #include "Common/Log.h"
 
+// After the game's last read, wait this long before the read-ahead touches the disk again.
+static const double FOREGROUND_QUIET_SECONDS = 0.005;
+
+// Only one game is loaded at a time, so the stats just follow the latest cache.
+static std::atomic<u32> statBlocks;
+static std::atomic<u32> statBlocksFilled;
+static std::atomic<u64> statHits;
+static std::atomic<u64> statMisses;
+
 // Takes ownership of backend.
 RamCachingFileLoader::RamCachingFileLoader(FileLoader *backend)
 	: ProxiedFileLoader(backend) {
@@ -72,15 +82,24 @@ size_t RamCachingFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, F
 		readSize = backend_->ReadAt(absolutePos, bytes, data, flags);
 	} else {
 		readSize = ReadFromCache(absolutePos, bytes, data);
-		// While in case the cache size is too small for the entire read.
-		while (readSize < bytes) {
-			SaveIntoCache(absolutePos + readSize, bytes - readSize, flags);
-			size_t bytesFromCache = ReadFromCache(absolutePos + readSize, bytes - readSize, (u8 *)data + readSize);
-			readSize += bytesFromCache;
-			if (bytesFromCache == 0) {
-				// We can't read any more.
-				break;
+		if (readSize < bytes) {
+			statMisses++;
+			// The read-ahead thread checks this before each read, so we get the disk next.
+			foregroundReads_++;
+			// While in case the cache size is too small for the entire read.
+			while (readSize < bytes) {
+				SaveIntoCache(absolutePos + readSize, bytes - readSize, flags);
+				size_t bytesFromCache = ReadFromCache(absolutePos + readSize, bytes - readSize, (u8 *)data + readSize);
+				readSize += bytesFromCache;
+				if (bytesFromCache == 0) {
+					// We can't read any more.
+					break;
+				}
 			}
+			lastForegroundTime_ = time_now_d();
+			foregroundReads_--;
+		} else {
+			statHits++;
 		}
 
 		StartReadAhead(absolutePos + readSize);
@@ -98,6 +117,11 @@ void RamCachingFileLoader::InitCache() {
 	}
 	aheadRemaining_ = blockCount;
 	blocks_.resize(blockCount);
+
+	statBlocks = blockCount;
+	statBlocksFilled = 0;
+	statHits = 0;
+	statMisses = 0;
 }
 
 void RamCachingFileLoader::ShutdownCache() {
@@ -113,6 +137,7 @@ void RamCachingFileLoader::ShutdownCache() {
 
 	std::lock_guard<std::mutex> guard(blocksMutex_);
 	blocks_.clear();
+	statBlocks = 0;
 	if (cache_ != nullptr) {
 		free(cache_);
 		cache_ = nullptr;
@@ -205,6 +230,7 @@ void RamCachingFileLoader::SaveIntoCache(s64 pos, size_t bytes, Flags flags) {
 		if (aheadRemaining_ != 0) {
 			aheadRemaining_ -= blocksRead;
 		}
+		statBlocksFilled += blocksRead;
 	}
 }
 
@@ -214,7 +240,15 @@ void RamCachingFileLoader::StartReadAhead(s64 pos) {
 	}
 
 	std::lock_guard<std::mutex> guard(blocksMutex_);
-	aheadPos_ = pos;
+	u32 block = (u32)(pos >> BLOCK_SHIFT);
+	if (block < blocks_.size() && (accessPointCount_ == 0 || accessPoints_[0] != block)) {
+		// Keep it at the front, most recent first.
+		int count = std::min(accessPointCount_ + 1, (int)MAX_ACCESS_POINTS);
+		for (int i = count - 1; i > 0; --i)
+			accessPoints_[i] = accessPoints_[i - 1];
+		accessPoints_[0] = block;
+		accessPointCount_ = count;
+	}
 	if (aheadThreadRunning_) {
 		// Already going.
 		return;
@@ -227,7 +261,13 @@ void RamCachingFileLoader::StartReadAhead(s64 pos) {
 	aheadThread_ = std::thread([this] {
 		SetCurrentThreadName("FileLoaderReadAhead");
 
+		double rateStart = time_now_d();
+		s64 rateBytes = 0;
 		while (aheadRemaining_ != 0 && !aheadCancel_) {
+			WaitForFillTurn(rateStart, rateBytes);
+			if (aheadCancel_)
+				break;
+
 			// Where should we look?
 			const u32 cacheStartPos = NextAheadBlock();
 			if (cacheStartPos == 0xFFFFFFFF) {
@@ -242,6 +282,7 @@ void RamCachingFileLoader::StartReadAhead(s64 pos) {
 			for (u32 i = cacheStartPos; i <= cacheEndPos; ++i) {
 				if (blocks_[i] == 0) {
 					SaveIntoCache((u64)i << BLOCK_SHIFT, BLOCK_SIZE * BLOCK_READAHEAD, Flags::NONE);
+					rateBytes += BLOCK_SIZE * BLOCK_READAHEAD;
 					break;
 				}
 			}
@@ -251,19 +292,68 @@ void RamCachingFileLoader::StartReadAhead(s64 pos) {
 	});
 }
 
+void RamCachingFileLoader::WaitForFillTurn(double &rateStart, s64 &rateBytes) {
+	bool paused = false;
+	while (!aheadCancel_) {
+		if (foregroundReads_ != 0 || time_now_d() - lastForegroundTime_ < FOREGROUND_QUIET_SECONDS) {
+			paused = true;
+			sleep_ms(1);
+			continue;
+		}
+		if (paused) {
+			// Don't catch up on the fill rate for the time we spent waiting.
+			rateStart = time_now_d();
+			rateBytes = 0;
+			paused = false;
+		}
+
+		int rateMB = g_Config.iRamCacheFillRate;
+		if (rateMB <= 0)
+			break;
+		double allowed = (time_now_d() - rateStart) * rateMB * 1024.0 * 1024.0;
+		if ((double)rateBytes <= allowed)
+			break;
+		sleep_ms(1);
+	}
+}
+
 u32 RamCachingFileLoader::NextAheadBlock() {
 	std::lock_guard<std::mutex> guard(blocksMutex_);
 
-	// If we had an aheadPos_ set, start reading from there and go forward.
-	u32 startFrom = (u32)(aheadPos_ >> BLOCK_SHIFT);
-	// But next time, start from the beginning again.
-	aheadPos_ = 0;
+	// Fill the holes just after where the game has been reading first, the most recent first.
+	for (int p = 0; p < accessPointCount_; ++p) {
+		u32 end = std::min(accessPoints_[p] + (u32)ACCESS_POINT_BLOCKS, (u32)blocks_.size());
+		for (u32 i = accessPoints_[p]; i < end; ++i) {
+			if (blocks_[i] == 0) {
+				return i;
+			}
+		}
+	}
 
-	for (u32 i = startFrom; i < blocks_.size(); ++i) {
+	// Then everything else, continuing where we left off.
+	u32 count = (u32)blocks_.size();
+	for (u32 n = 0; n < count; ++n) {
+		u32 i = fillCursor_ + n < count ? fillCursor_ + n : fillCursor_ + n - count;
 		if (blocks_[i] == 0) {
+			fillCursor_ = i;
 			return i;
 		}
 	}
 
 	return 0xFFFFFFFF;
 }
+
+void RamCachingFileLoader::GetDebugStats(char *buf, size_t bufSize) {
+	u32 blocks = statBlocks;
+	if (blocks == 0) {
+		if (bufSize > 0)
+			buf[0] = '\0';
+		return;
+	}
+	u64 hits = statHits;
+	u64 total = hits + statMisses;
+	snprintf(buf, bufSize, "RAM cache: %0.1f%% filled, %0.1f%% hits (%llu reads)\n",
+		statBlocksFilled * 100.0 / blocks,
+		total == 0 ? 0.0 : hits * 100.0 / total,
+		(unsigned long long)total);
+}
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <mutex>
 #include <thread>
@@ -41,6 +42,9 @@ class RamCachingFileLoader : public ProxiedFileLoader {
 
 	void Cancel() override;
 
+	// Fill progress and hit rate of the active cache, for the dev stats.  Empty if none.
+	static void GetDebugStats(char *buf, size_t bufSize);
+
 private:
 	void InitCache();
 	void ShutdownCache();
@@ -49,12 +53,18 @@ class RamCachingFileLoader : public ProxiedFileLoader {
 	void SaveIntoCache(s64 pos, size_t bytes, Flags flags);
 	void StartReadAhead(s64 pos);
 	u32 NextAheadBlock();
+	// Blocks the read-ahead thread while the game is reading, and to respect the fill rate.
+	void WaitForFillTurn(double &rateStart, s64 &rateBytes);
 
 	enum {
 		BLOCK_SIZE = 65536,
 		BLOCK_SHIFT = 16,
 		MAX_BLOCKS_PER_READ = 16,
 		BLOCK_READAHEAD = 4,
+		// How many recent read positions to fill around first.
+		MAX_ACCESS_POINTS = 4,
+		// How far past an access point to look for holes, before filling linearly.
+		ACCESS_POINT_BLOCKS = 64,
 	};
 
 	s64 filesize_ = 0;
@@ -65,7 +75,14 @@ class RamCachingFileLoader : public ProxiedFileLoader {
 	std::vector<u8> blocks_;
 	std::mutex blocksMutex_;
 	u32 aheadRemaining_;
-	s64 aheadPos_;
+	// Most recent first.  Blocks just after where the game read are likely next.
+	u32 accessPoints_[MAX_ACCESS_POINTS]{};
+	int accessPointCount_ = 0;
+	// Where the linear fill continues from once the access points are filled.
+	u32 fillCursor_ = 0;
+	// Reads the game is waiting on.  The read-ahead thread stays out of the way meanwhile.
+	std::atomic<int> foregroundReads_{};
+	std::atomic<double> lastForegroundTime_{};
 	std::thread aheadThread_;
 	bool aheadThreadRunning_ = false;
 	bool aheadCancel_ = false;
@@ -0,0 +1,511 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <algorithm>
+#include <cstring>
+
+#include "zlib.h"
+#include "ext/xxhash.h"
+
+#include "Common/File/DirListing.h"
+#include "Common/File/FileUtil.h"
+#include "Common/Log.h"
+#include "Common/StringUtils.h"
+#include "Common/Swap.h"
+#include "Core/FileLoaders/ZipFileLoader.h"
+#include "Core/System.h"
+
+// Distance between inflate checkpoints, in uncompressed bytes. Each costs up to 32 KB before
+// compressing the window, and a random read inflates half this on average.
+static const u64 CHECKPOINT_SPAN = 1024 * 1024;
+static const size_t WINDOW_SIZE = 32768;
+static const size_t IN_CHUNK_SIZE = 65536;
+static const size_t OUT_CHUNK_SIZE = 65536;
+
+static const u32 INDEX_MAGIC = 0x58495a50;  // PZIX
+static const u32 INDEX_VERSION = 1;
+
+struct ZipIndexHeader {
+	u32_le magic;
+	u32_le version;
+	u64_le zipSize;
+	u64_le zipMtime;
+	u64_le dataOffset;
+	u64_le uncompressedSize;
+	u32_le complete;
+	u32_le count;
+};
+
+struct ZipIndexPoint {
+	u64_le out;
+	u64_le in;
+	u32_le bits;
+	u32_le windowSize;
+};
+
+static u16 Read16(const u8 *p) {
+	return p[0] | (p[1] << 8);
+}
+
+static u32 Read32(const u8 *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((u32)p[3] << 24);
+}
+
+static u64 Read64(const u8 *p) {
+	return Read32(p) | ((u64)Read32(p + 4) << 32);
+}
+
+ZipFileLoader::ZipFileLoader(FileLoader *backend) : ProxiedFileLoader(backend) {
+	if (!backend_->Exists() || backend_->IsDirectory() || !FindEntry()) {
+		method_ = Method::NONE;
+		return;
+	}
+
+	if (method_ == Method::DEFLATED) {
+		strm_ = new z_stream{};
+		if (inflateInit2(strm_, -MAX_WBITS) != Z_OK) {
+			ERROR_LOG(LOADER, "Unable to init inflate for zipped game");
+			delete strm_;
+			strm_ = nullptr;
+			method_ = Method::NONE;
+			return;
+		}
+		inBuffer_.resize(IN_CHUNK_SIZE);
+		outBuffer_.resize(OUT_CHUNK_SIZE);
+		history_.resize(WINDOW_SIZE);
+	}
+}
+
+ZipFileLoader::~ZipFileLoader() {
+	if (strm_) {
+		if (indexDirty_)
+			SaveIndex();
+		inflateEnd(strm_);
+		delete strm_;
+	}
+}
+
+bool ZipFileLoader::FindEntry() {
+	s64 zipSize = backend_->FileSize();
+	if (zipSize < 22)
+		return false;
+
+	// The end of central directory record is at the end, before a comment of up to 64 KB.
+	size_t tailSize = (size_t)std::min(zipSize, (s64)(65535 + 22));
+	std::vector<u8> tail(tailSize);
+	if (backend_->ReadAt(zipSize - tailSize, tailSize, &tail[0]) != tailSize)
+		return false;
+	s64 eocd = -1;
+	for (s64 i = (s64)tailSize - 22; i >= 0; --i) {
+		if (!memcmp(&tail[i], "PK\x05\x06", 4)) {
+			eocd = i;
+			break;
+		}
+	}
+	if (eocd < 0)
+		return false;
+
+	u64 numEntries = Read16(&tail[eocd + 10]);
+	u64 dirSize = Read32(&tail[eocd + 12]);
+	u64 dirOffset = Read32(&tail[eocd + 16]);
+	if (numEntries == 0xFFFF || dirSize == 0xFFFFFFFF || dirOffset == 0xFFFFFFFF) {
+		// Zip64, which any zipped ISO over 4 GB needs. The locator is just before the record.
+		if (eocd < 20 || memcmp(&tail[eocd - 20], "PK\x06\x07", 4) != 0)
+			return false;
+		u8 record[56];
+		if (backend_->ReadAt(Read64(&tail[eocd - 20 + 8]), sizeof(record), record) != sizeof(record))
+			return false;
+		if (memcmp(record, "PK\x06\x06", 4) != 0)
+			return false;
+		numEntries = Read64(record + 32);
+		dirSize = Read64(record + 40);
+		dirOffset = Read64(record + 48);
+	}
+	if (dirOffset + dirSize > (u64)zipSize || dirSize > 64 * 1024 * 1024)
+		return false;
+
+	std::vector<u8> dir((size_t)dirSize);
+	if (dirSize == 0 || backend_->ReadAt(dirOffset, (size_t)dirSize, &dir[0]) != dirSize)
+		return false;
+
+	u64 bestSize = 0;
+	u64 bestCompressed = 0;
+	u64 bestHeader = 0;
+	u16 bestMethod = 0;
+	size_t pos = 0;
+	for (u64 i = 0; i < numEntries && pos + 46 <= dir.size(); ++i) {
+		const u8 *entry = &dir[pos];
+		if (memcmp(entry, "PK\x01\x02", 4) != 0)
+			return false;
+		u16 flags = Read16(entry + 8);
+		u16 method = Read16(entry + 10);
+		u64 compressed = Read32(entry + 20);
+		u64 uncompressed = Read32(entry + 24);
+		u16 nameLen = Read16(entry + 28);
+		u16 extraLen = Read16(entry + 30);
+		u16 commentLen = Read16(entry + 32);
+		u64 header = Read32(entry + 42);
+		if (pos + 46 + nameLen + extraLen > dir.size())
+			return false;
+
+		// Same rules as DetectZipFileContents: a memstick game wins, and an ISO must be at most one folder down.
+		std::string name((const char *)entry + 46, nameLen);
+		std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) {
+			return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+		});
+		if (name.find("eboot.pbp") != std::string::npos)
+			return false;
+
+		if (endsWith(name, ".iso") || endsWith(name, ".cso")) {
+			// Zip64 sizes follow in the extra field, in this order, for just the fields that overflowed.
+			const u8 *extra = entry + 46 + nameLen;
+			for (size_t e = 0; e + 4 <= extraLen; ) {
+				u16 id = Read16(extra + e);
+				u16 size = Read16(extra + e + 2);
+				if (id == 0x0001) {
+					size_t f = e + 4;
+					if (uncompressed == 0xFFFFFFFF && f + 8 <= e + 4 + size) {
+						uncompressed = Read64(extra + f);
+						f += 8;
+					}
+					if (compressed == 0xFFFFFFFF && f + 8 <= e + 4 + size) {
+						compressed = Read64(extra + f);
+						f += 8;
+					}
+					if (header == 0xFFFFFFFF && f + 8 <= e + 4 + size) {
+						header = Read64(extra + f);
+					}
+				}
+				e += 4 + size;
+			}
+
+			bool encrypted = (flags & 1) != 0;
+			bool supported = method == 0 || method == 8;
+			if (std::count(name.begin(), name.end(), '/') <= 1 && !encrypted && supported && uncompressed > bestSize) {
+				bestSize = uncompressed;
+				bestCompressed = compressed;
+				bestHeader = header;
+				bestMethod = method;
+			}
+		}
+		pos += 46 + nameLen + extraLen + commentLen;
+	}
+	if (bestSize == 0)
+		return false;
+
+	u8 local[30];
+	if (backend_->ReadAt(bestHeader, sizeof(local), local) != sizeof(local) || memcmp(local, "PK\x03\x04", 4) != 0)
+		return false;
+	dataOffset_ = bestHeader + sizeof(local) + Read16(local + 26) + Read16(local + 28);
+	compressedSize_ = bestCompressed;
+	uncompressedSize_ = bestSize;
+	if (dataOffset_ + compressedSize_ > zipSize)
+		return false;
+
+	if (bestMethod == 0) {
+		if (compressedSize_ != uncompressedSize_)
+			return false;
+		method_ = Method::STORED;
+	} else {
+		method_ = Method::DEFLATED;
+	}
+	return true;
+}
+
+bool ZipFileLoader::Exists() {
+	return HasGame() && backend_->Exists();
+}
+
+bool ZipFileLoader::ExistsFast() {
+	return HasGame() && backend_->ExistsFast();
+}
+
+bool ZipFileLoader::IsDirectory() {
+	return false;
+}
+
+s64 ZipFileLoader::FileSize() {
+	return uncompressedSize_;
+}
+
+size_t ZipFileLoader::ReadAt(s64 absolutePos, size_t bytes, void *data, Flags flags) {
+	if (absolutePos < 0 || absolutePos >= uncompressedSize_)
+		return 0;
+	bytes = (size_t)std::min((s64)bytes, uncompressedSize_ - absolutePos);
+
+	switch (method_) {
+	case Method::STORED:
+		return backend_->ReadAt(dataOffset_ + absolutePos, bytes, data, flags);
+	case Method::DEFLATED:
+		return ReadDeflated(absolutePos, bytes, (u8 *)data);
+	default:
+		return 0;
+	}
+}
+
+const u8 *ZipFileLoader::GetPointer(s64 absolutePos, size_t bytes) {
+	if (method_ != Method::STORED || absolutePos < 0 || absolutePos + (s64)bytes > uncompressedSize_)
+		return nullptr;
+	return backend_->GetPointer(dataOffset_ + absolutePos, bytes);
+}
+
+size_t ZipFileLoader::ReadDeflated(s64 pos, size_t bytes, u8 *data) {
+	std::lock_guard<std::mutex> guard(lock_);
+	// Not loaded up front, the game list creates loaders just to peek at a few blocks.
+	if (index_.empty()) {
+		LoadIndex();
+	}
+
+	size_t done = 0;
+	while (done < bytes) {
+		u64 want = pos + done;
+		if (want >= outBufferPos_ && want < outBufferPos_ + outBufferLen_) {
+			size_t offset = (size_t)(want - outBufferPos_);
+			size_t len = std::min(bytes - done, outBufferLen_ - offset);
+			memcpy(data + done, &outBuffer_[offset], len);
+			done += len;
+			continue;
+		}
+
+		// Keep inflating if we're headed that way anyway, otherwise restart at the closest checkpoint.
+		auto next = std::upper_bound(index_.begin(), index_.end(), want, [](u64 out, const Checkpoint &point) {
+			return out < point.out;
+		});
+		const Checkpoint &point = *(next - 1);
+		if (!streamActive_ || want < streamOut_ || point.out > streamOut_) {
+			StartAt(point);
+		}
+		if (!InflateChunk())
+			break;
+	}
+	return done;
+}
+
+void ZipFileLoader::StartAt(const Checkpoint &point) {
+	inflateReset(strm_);
+	strm_->avail_in = 0;
+	streamActive_ = true;
+	streamEnd_ = false;
+	streamIn_ = point.in;
+	streamOut_ = point.out;
+	outBufferLen_ = 0;
+	historyStart_ = point.out;
+
+	if (point.bits) {
+		u8 partial = 0;
+		backend_->ReadAt(dataOffset_ + point.in - 1, 1, &partial);
+		inflatePrime(strm_, point.bits, partial >> (8 - point.bits));
+	}
+	if (!point.window.empty()) {
+		u8 window[WINDOW_SIZE];
+		uLongf windowSize = sizeof(window);
+		if (uncompress(window, &windowSize, &point.window[0], (uLong)point.window.size()) == Z_OK) {
+			inflateSetDictionary(strm_, window, windowSize);
+			historyStart_ = point.out - windowSize;
+			streamOut_ = historyStart_;
+			AppendHistory(window, windowSize);
+		}
+	}
+}
+
+bool ZipFileLoader::InflateChunk() {
+	if (streamEnd_)
+		return false;
+
+	outBufferPos_ = streamOut_;
+	outBufferLen_ = 0;
+	while (outBufferLen_ < outBuffer_.size()) {
+		// Once all input is in, inflate may still have output pending.
+		if (strm_->avail_in == 0 && streamIn_ < (u64)compressedSize_) {
+			size_t len = (size_t)std::min((u64)inBuffer_.size(), compressedSize_ - streamIn_);
+			if (backend_->ReadAt(dataOffset_ + streamIn_, len, &inBuffer_[0]) != len) {
+				ERROR_LOG(LOADER, "Unable to read compressed data from zip");
+				streamActive_ = false;
+				outBufferLen_ = 0;
+				return false;
+			}
+			strm_->next_in = &inBuffer_[0];
+			strm_->avail_in = (uInt)len;
+			streamIn_ += len;
+		}
+
+		u8 *out = &outBuffer_[outBufferLen_];
+		strm_->next_out = out;
+		strm_->avail_out = (uInt)(outBuffer_.size() - outBufferLen_);
+		// Z_BLOCK stops at each deflate block boundary, the only places we can resume from.
+		int ret = inflate(strm_, Z_BLOCK);
+		size_t produced = strm_->next_out - out;
+		AppendHistory(out, produced);
+		outBufferLen_ += produced;
+
+		if (ret == Z_STREAM_END) {
+			streamEnd_ = true;
+			if (!indexComplete_) {
+				indexComplete_ = true;
+				indexDirty_ = true;
+			}
+			break;
+		}
+		if (ret != Z_OK && (ret != Z_BUF_ERROR || produced == 0)) {
+			ERROR_LOG(LOADER, "Inflate failed in zipped game: %d", ret);
+			streamActive_ = false;
+			outBufferLen_ = 0;
+			return false;
+		}
+
+		bool blockEnd = (strm_->data_type & 128) != 0 && (strm_->data_type & 64) == 0;
+		if (blockEnd && !indexComplete_ && streamOut_ >= index_.back().out + CHECKPOINT_SPAN) {
+			AddCheckpoint();
+		}
+	}
+
+	if (indexDirty_ && indexComplete_) {
+		SaveIndex();
+	}
+	return outBufferLen_ != 0;
+}
+
+void ZipFileLoader::AppendHistory(const u8 *data, size_t len) {
+	streamOut_ += len;
+	if (len > WINDOW_SIZE) {
+		data += len - WINDOW_SIZE;
+		len = WINDOW_SIZE;
+	}
+	size_t start = (size_t)((streamOut_ - len) % WINDOW_SIZE);
+	size_t first = std::min(len, WINDOW_SIZE - start);
+	memcpy(&history_[start], data, first);
+	memcpy(&history_[0], data + first, len - first);
+}
+
+void ZipFileLoader::AddCheckpoint() {
+	Checkpoint point;
+	point.out = streamOut_;
+	point.in = streamIn_ - strm_->avail_in;
+	point.bits = strm_->data_type & 7;
+
+	size_t windowSize = (size_t)std::min((u64)WINDOW_SIZE, streamOut_ - historyStart_);
+	u8 window[WINDOW_SIZE];
+	size_t start = (size_t)((streamOut_ - windowSize) % WINDOW_SIZE);
+	size_t first = std::min(windowSize, WINDOW_SIZE - start);
+	memcpy(window, &history_[start], first);
+	memcpy(window + first, &history_[0], windowSize - first);
+
+	// Windows are usually text-like game data, this cuts the index to about a third.
+	uLongf compressedSize = compressBound((uLong)windowSize);
+	point.window.resize(compressedSize);
+	compress2(&point.window[0], &compressedSize, window, (uLong)windowSize, Z_BEST_SPEED);
+	point.window.resize(compressedSize);
+
+	index_.push_back(std::move(point));
+	indexDirty_ = true;
+}
+
+Path ZipFileLoader::MakeIndexFilename() const {
+	std::string path = backend_->GetPath().ToString();
+	u64 hash = XXH3_64bits(path.data(), path.size());
+	return GetSysDirectory(DIRECTORY_APP_CACHE) / "zipindex" / StringFromFormat("%016llx.zidx", (unsigned long long)hash);
+}
+
+void ZipFileLoader::LoadIndex() {
+	// Reading always starts from the first checkpoint, at the beginning of the entry.
+	index_.clear();
+	index_.push_back(Checkpoint{ 0, 0, 0 });
+	indexComplete_ = false;
+
+	File::FileInfo zipInfo;
+	if (!File::GetFileInfo(backend_->GetPath(), &zipInfo))
+		return;
+
+	FILE *f = File::OpenCFile(MakeIndexFilename(), "rb");
+	if (!f)
+		return;
+
+	ZipIndexHeader header;
+	bool valid = fread(&header, sizeof(header), 1, f) == 1;
+	valid = valid && header.magic == INDEX_MAGIC && header.version == INDEX_VERSION;
+	valid = valid && header.zipSize == zipInfo.size && header.zipMtime == zipInfo.mtime;
+	valid = valid && header.dataOffset == (u64)dataOffset_ && header.uncompressedSize == (u64)uncompressedSize_;
+
+	std::vector<Checkpoint> points;
+	for (u32 i = 0; valid && i < header.count; ++i) {
+		ZipIndexPoint info;
+		valid = fread(&info, sizeof(info), 1, f) == 1;
+		if (!valid || info.bits > 7 || info.windowSize > compressBound(WINDOW_SIZE) || (!points.empty() && info.out <= points.back().out)) {
+			valid = false;
+			break;
+		}
+		Checkpoint point;
+		point.out = info.out;
+		point.in = info.in;
+		point.bits = info.bits;
+		point.window.resize(info.windowSize);
+		valid = info.windowSize == 0 || fread(&point.window[0], info.windowSize, 1, f) == 1;
+		points.push_back(std::move(point));
+	}
+	fclose(f);
+
+	if (valid && !points.empty() && points[0].out == 0) {
+		index_ = std::move(points);
+		indexComplete_ = header.complete != 0;
+		INFO_LOG(LOADER, "Loaded zip seek index with %d checkpoints", (int)index_.size());
+	}
+}
+
+void ZipFileLoader::SaveIndex() {
+	indexDirty_ = false;
+
+	File::FileInfo zipInfo;
+	if (!File::GetFileInfo(backend_->GetPath(), &zipInfo))
+		return;
+
+	Path filename = MakeIndexFilename();
+	File::CreateFullPath(filename.NavigateUp());
+	// Write to a temp file first, so a crash doesn't leave half an index.
+	Path tempFilename = filename.WithExtraExtension(".tmp");
+	FILE *f = File::OpenCFile(tempFilename, "wb");
+	if (!f) {
+		WARN_LOG(LOADER, "Unable to save zip seek index");
+		return;
+	}
+
+	ZipIndexHeader header;
+	header.magic = INDEX_MAGIC;
+	header.version = INDEX_VERSION;
+	header.zipSize = zipInfo.size;
+	header.zipMtime = zipInfo.mtime;
+	header.dataOffset = dataOffset_;
+	header.uncompressedSize = uncompressedSize_;
+	header.complete = indexComplete_ ? 1 : 0;
+	header.count = (u32)index_.size();
+	bool success = fwrite(&header, sizeof(header), 1, f) == 1;
+
+	for (const Checkpoint &point : index_) {
+		ZipIndexPoint info;
+		info.out = point.out;
+		info.in = point.in;
+		info.bits = point.bits;
+		info.windowSize = (u32)point.window.size();
+		success = success && fwrite(&info, sizeof(info), 1, f) == 1;
+		success = success && (point.window.empty() || fwrite(&point.window[0], point.window.size(), 1, f) == 1);
+	}
+	fclose(f);
+
+	if (!success || !File::Rename(tempFilename, filename)) {
+		WARN_LOG(LOADER, "Unable to save zip seek index");
+		File::Delete(tempFilename);
+	}
+}
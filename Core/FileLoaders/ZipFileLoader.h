@@ -0,0 +1,110 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/Loaders.h"
+
+typedef struct z_stream_s z_stream;
+
+// Presents the ISO or CSO inside a ZIP file, so zipped games can be played without extracting them.
+// Stored entries are passed straight through to the backend (so mapped reads stay zero copy.)
+// Deflated entries get a seek index of inflate checkpoints, built as the entry is read and kept
+// on disk, so random reads only need to inflate from the nearest checkpoint.
+class ZipFileLoader : public ProxiedFileLoader {
+public:
+	ZipFileLoader(FileLoader *backend);
+	~ZipFileLoader() override;
+
+	// False if the zip doesn't hold a single game image we can read, then it should be installed instead.
+	bool HasGame() const {
+		return method_ != Method::NONE;
+	}
+
+	bool Exists() override;
+	bool ExistsFast() override;
+	bool IsDirectory() override;
+	s64 FileSize() override;
+
+	size_t ReadAt(s64 absolutePos, size_t bytes, size_t count, void *data, Flags flags = Flags::NONE) override {
+		return ReadAt(absolutePos, bytes * count, data, flags) / bytes;
+	}
+	size_t ReadAt(s64 absolutePos, size_t bytes, void *data, Flags flags = Flags::NONE) override;
+	const u8 *GetPointer(s64 absolutePos, size_t bytes) override;
+
+private:
+	enum class Method {
+		NONE,
+		STORED,
+		DEFLATED,
+	};
+
+	struct Checkpoint {
+		// Position in the uncompressed entry.
+		u64 out;
+		// Compressed bytes consumed, relative to the start of the entry data.
+		u64 in;
+		// Bits of the byte at in - 1 that are still unused.
+		u32 bits;
+		// The 32 KB of output before this point, zlib compressed.
+		std::vector<u8> window;
+	};
+
+	bool FindEntry();
+	size_t ReadDeflated(s64 pos, size_t bytes, u8 *data);
+	void StartAt(const Checkpoint &point);
+	bool InflateChunk();
+	void AddCheckpoint();
+	void AppendHistory(const u8 *data, size_t len);
+
+	Path MakeIndexFilename() const;
+	void LoadIndex();
+	void SaveIndex();
+
+	Method method_ = Method::NONE;
+	s64 dataOffset_ = 0;
+	s64 compressedSize_ = 0;
+	s64 uncompressedSize_ = 0;
+
+	std::mutex lock_;
+	std::vector<Checkpoint> index_;
+	bool indexComplete_ = false;
+	bool indexDirty_ = false;
+
+	z_stream *strm_ = nullptr;
+	bool streamActive_ = false;
+	bool streamEnd_ = false;
+	// Compressed position of the next input read, relative to the entry data.
+	u64 streamIn_ = 0;
+	// Uncompressed position of the next output.
+	u64 streamOut_ = 0;
+	std::vector<u8> inBuffer_;
+
+	// Most recently inflated data, reads hit this when sequential.
+	std::vector<u8> outBuffer_;
+	u64 outBufferPos_ = 0;
+	size_t outBufferLen_ = 0;
+
+	// Ring of the last 32 KB of output, for new checkpoints. Valid from historyStart_ up to streamOut_.
+	std::vector<u8> history_;
+	u64 historyStart_ = 0;
+};
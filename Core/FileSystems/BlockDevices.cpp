@@ -19,12 +19,20 @@
 #include <cstring>
 #include <algorithm>
 
+#include <zstd.h>
+
+#include "Common/Data/Encoding/Compression.h"
 #include "Common/Data/Text/I18n.h"
 #include "Common/File/FileUtil.h"
+#include "Common/File/Path.h"
 #include "Common/Log.h"
+#include "Common/StringUtils.h"
 #include "Common/Swap.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "Core/Config.h"
 #include "Core/Loaders.h"
 #include "Core/Host.h"
+#include "Core/Instance.h"
 #include "Core/FileSystems/BlockDevices.h"
 
 extern "C"
@@ -32,18 +40,23 @@ extern "C"
 #include "zlib.h"
 #include "ext/libkirk/amctrl.h"
 #include "ext/libkirk/kirk_engine.h"
+#include "ext/xxhash.h"
 };
 
 std::mutex NPDRMDemoBlockDevice::mutex_;
 
+static bool IsZstdSeekable(FileLoader *fileLoader);
+
 BlockDevice *constructBlockDevice(FileLoader *fileLoader) {
 	// Check for CISO
 	if (!fileLoader->Exists())
 		return nullptr;
 	char buffer[4]{};
 	size_t size = fileLoader->ReadAt(0, 1, 4, buffer);
-	if (size == 4 && !memcmp(buffer, "CISO", 4))
+	if (size == 4 && (!memcmp(buffer, "CISO", 4) || !memcmp(buffer, "ZISO", 4)))
 		return new CISOFileBlockDevice(fileLoader);
+	if (IsZstdSeekable(fileLoader))
+		return new ZstdSeekableBlockDevice(fileLoader);
 	if (size == 4 && !memcmp(buffer, "\x00PBP", 4)) {
 		uint32_t psarOffset = 0;
 		size = fileLoader->ReadAt(0x24, 1, 4, &psarOffset);
@@ -109,7 +122,7 @@ bool FileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
 // compressed ISO(9660) header format
 typedef struct ciso_header
 {
-	unsigned char magic[4];         // +00 : 'C','I','S','O'
+	unsigned char magic[4];         // +00 : 'C','I','S','O' (or 'Z','I','S','O' for LZ4)
 	u32_le header_size;             // +04 : header size (==0x18)
 	u64_le total_bytes;             // +08 : number of original data size
 	u32_le block_size;              // +10 : number of compressed block size
@@ -133,6 +146,80 @@ typedef struct ciso_header
 // TODO: Need much better error handling.
 
 static const u32 CSO_READ_BUFFER_SIZE = 256 * 1024;
+// When reads are sequential, decompress this much past the end of each read into the frame cache.
+static const u32 CSO_READ_AHEAD_BYTES = 64 * 1024;
+// Room for the read-ahead plus the partial frames at either end of a read, and some reuse.
+static const u32 CSO_FRAME_CACHE_EXTRA = 8;
+// Below this many frames, decompressing on the calling thread is faster than waking workers.
+static const int CSO_PARALLEL_MIN_FRAMES = 8;
+// NPDRM blocks are usually 32KB, each one costs a full decrypt and often an LZRC decompress.
+static const u32 NPDRM_READ_AHEAD_BLOCKS = 4;
+static const u32 NPDRM_BLOCK_CACHE_EXTRA = 4;
+
+// Decodes a raw LZ4 block (no frame header), as used by ZSO and CSO v2.  Returns bytes written or -1.
+static int Lz4DecompressBlock(const u8 *src, u32 srcSize, u8 *dest, u32 destSize) {
+	const u8 *ip = src;
+	const u8 *const iend = src + srcSize;
+	u8 *op = dest;
+	u8 *const oend = dest + destSize;
+
+	while (ip < iend) {
+		const u8 token = *ip++;
+
+		size_t litLen = token >> 4;
+		if (litLen == 15) {
+			u8 b;
+			do {
+				if (ip >= iend)
+					return -1;
+				b = *ip++;
+				litLen += b;
+			} while (b == 255);
+		}
+		if ((size_t)(iend - ip) < litLen || (size_t)(oend - op) < litLen)
+			return -1;
+		memcpy(op, ip, litLen);
+		ip += litLen;
+		op += litLen;
+
+		// The last sequence is only literals.
+		if (ip >= iend)
+			break;
+
+		if (iend - ip < 2)
+			return -1;
+		const size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > (size_t)(op - dest))
+			return -1;
+
+		size_t matchLen = token & 15;
+		if (matchLen == 15) {
+			u8 b;
+			do {
+				if (ip >= iend)
+					return -1;
+				b = *ip++;
+				matchLen += b;
+			} while (b == 255);
+		}
+		matchLen += 4;
+		if ((size_t)(oend - op) < matchLen)
+			return -1;
+
+		const u8 *match = op - offset;
+		if (offset >= matchLen) {
+			memcpy(op, match, matchLen);
+			op += matchLen;
+		} else {
+			// Overlapping, this repeats the last offset bytes.
+			for (size_t i = 0; i < matchLen; ++i)
+				*op++ = *match++;
+		}
+	}
+
+	return (int)(op - dest);
+}
 
 CISOFileBlockDevice::CISOFileBlockDevice(FileLoader *fileLoader)
 	: fileLoader_(fileLoader)
@@ -141,7 +228,8 @@ CISOFileBlockDevice::CISOFileBlockDevice(FileLoader *fileLoader)
 
 	CISO_H hdr;
 	size_t readSize = fileLoader->ReadAt(0, sizeof(CISO_H), 1, &hdr);
-	if (readSize != 1 || memcmp(hdr.magic, "CISO", 4) != 0) {
+	lz4_ = readSize == 1 && memcmp(hdr.magic, "ZISO", 4) == 0;
+	if (readSize != 1 || (memcmp(hdr.magic, "CISO", 4) != 0 && !lz4_)) {
 		WARN_LOG(LOADER, "Invalid CSO!");
 	}
 	if (hdr.ver > 1) {
@@ -173,6 +261,15 @@ CISOFileBlockDevice::CISOFileBlockDevice(FileLoader *fileLoader)
 	zlibBuffer = new u8[frameSize + (1 << indexShift)];
 	zlibBufferFrame = numFrames;
 
+	readAheadFrames_ = std::max(CSO_READ_AHEAD_BYTES / std::max(frameSize, (u32)0x800), (u32)1);
+	frameCache_.resize(readAheadFrames_ + CSO_FRAME_CACHE_EXTRA);
+	frameCacheData_ = new u8[frameCache_.size() * frameSize];
+	for (size_t i = 0; i < frameCache_.size(); ++i) {
+		frameCache_[i].frame = 0xFFFFFFFF;
+		frameCache_[i].lastUse = 0;
+		frameCache_[i].data = frameCacheData_ + i * frameSize;
+	}
+
 	const u32 indexSize = numFrames + 1;
 	const size_t headerEnd = hdr.ver > 1 ? (size_t)hdr.header_size : sizeof(hdr);
 
@@ -208,13 +305,88 @@ CISOFileBlockDevice::CISOFileBlockDevice(FileLoader *fileLoader)
 			expectedFileSize, fileSize, fileLoader->GetPath().c_str());
 		NotifyReadError();
 	}
+
+	if (g_Config.bSharedInstanceCache) {
+		// Other instances of the same image should land on the same name.
+		std::string key = StringFromFormat("%s:%lld", fileLoader->GetPath().ToString().c_str(), (long long)fileSize);
+		u64 hash = XXH3_64bits(key.data(), key.size());
+		sharedCache_ = SharedFrameCache::Open(StringFromFormat("%016llx", (unsigned long long)hash), frameSize, numFrames);
+	}
 }
 
 CISOFileBlockDevice::~CISOFileBlockDevice()
 {
+	delete sharedCache_;
 	delete [] index;
 	delete [] readBuffer;
 	delete [] zlibBuffer;
+	delete [] frameCacheData_;
+}
+
+bool CISOFileBlockDevice::IsFramePlain(u32 frame) const {
+	const u32 idx = index[frame];
+	if (ver_ >= 2) {
+		// CSO v2+ requires blocks be uncompressed if large enough to be.  High bit means LZ4.
+		const u64 readPos = (u64)(idx & 0x7FFFFFFF) << indexShift;
+		const u64 readEnd = (u64)(index[frame + 1] & 0x7FFFFFFF) << indexShift;
+		return readEnd - readPos >= frameSize;
+	}
+	return (idx & 0x80000000) != 0;
+}
+
+bool CISOFileBlockDevice::DecompressFrame(u32 frame, const u8 *src, u32 srcSize, u8 *dest) const {
+	if (IsFramePlain(frame)) {
+		const u32 copySize = std::min(srcSize, frameSize);
+		memcpy(dest, src, copySize);
+		if (copySize < frameSize)
+			memset(dest + copySize, 0, frameSize - copySize);
+		return true;
+	}
+
+	if (lz4_ || (ver_ >= 2 && (index[frame] & 0x80000000) != 0)) {
+		int outSize = Lz4DecompressBlock(src, srcSize, dest, frameSize);
+		// Only the last frame may be short.
+		if (outSize < 0 || ((u32)outSize != frameSize && frame != numFrames - 1)) {
+			ERROR_LOG(LOADER, "Frame %d: LZ4 decompression failed (%d)", frame, outSize);
+			return false;
+		}
+		if ((u32)outSize < frameSize)
+			memset(dest + outSize, 0, frameSize - outSize);
+		return true;
+	}
+
+	size_t inUsed = 0, outSize = 0;
+	if (!inflate_buffer(src, srcSize, dest, frameSize, -15, &inUsed, &outSize)) {
+		ERROR_LOG(LOADER, "Inflate frame %d: failed\n", frame);
+		return false;
+	}
+	if (outSize != frameSize) {
+		ERROR_LOG(LOADER, "Inflate frame %d: block size error %d != %d\n", frame, (u32)outSize, frameSize);
+		return false;
+	}
+	return true;
+}
+
+// Callers must hold cacheLock_.
+u8 *CISOFileBlockDevice::FindCachedFrame(u32 frame) {
+	for (CachedFrame &entry : frameCache_) {
+		if (entry.frame == frame) {
+			entry.lastUse = ++frameCacheUse_;
+			return entry.data;
+		}
+	}
+	return nullptr;
+}
+
+u8 *CISOFileBlockDevice::AllocCachedFrame(u32 frame) {
+	CachedFrame *oldest = &frameCache_[0];
+	for (CachedFrame &entry : frameCache_) {
+		if (entry.lastUse < oldest->lastUse)
+			oldest = &entry;
+	}
+	oldest->frame = frame;
+	oldest->lastUse = ++frameCacheUse_;
+	return oldest->data;
 }
 
 bool CISOFileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
@@ -229,19 +401,24 @@ bool CISOFileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 	const u32 idx = index[frameNumber];
 	const u32 indexPos = idx & 0x7FFFFFFF;
 	const u32 nextIndexPos = index[frameNumber + 1] & 0x7FFFFFFF;
-	z_stream z;
 
 	const u64 compressedReadPos = (u64)indexPos << indexShift;
 	const u64 compressedReadEnd = (u64)nextIndexPos << indexShift;
 	const size_t compressedReadSize = (size_t)(compressedReadEnd - compressedReadPos);
 	const u32 compressedOffset = (blockNumber & ((1 << blockShift) - 1)) * GetBlockSize();
 
-	bool plain = (idx & 0x80000000) != 0;
-	if (ver_ >= 2) {
-		// CSO v2+ requires blocks be uncompressed if large enough to be.  High bit means other things.
-		plain = compressedReadSize >= frameSize;
+	if (!uncached) {
+		std::lock_guard<std::mutex> guard(cacheLock_);
+		const u8 *cached = FindCachedFrame(frameNumber);
+		if (cached) {
+			memcpy(outPtr, cached + compressedOffset, GetBlockSize());
+			return true;
+		}
 	}
-	if (plain) {
+
+	// readBuffer and zlibBuffer are shared, reads can come from several threads.
+	std::lock_guard<std::mutex> guard(readLock_);
+	if (IsFramePlain(frameNumber)) {
 		int readSize = (u32)fileLoader_->ReadAt(compressedReadPos + compressedOffset, 1, GetBlockSize(), outPtr, flags);
 		if (readSize < GetBlockSize())
 			memset(outPtr + readSize, 0, GetBlockSize() - readSize);
@@ -249,37 +426,23 @@ bool CISOFileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 		// We already have it.  Just apply the offset and copy.
 		memcpy(outPtr, zlibBuffer + compressedOffset, GetBlockSize());
 	} else {
-		const u32 readSize = (u32)fileLoader_->ReadAt(compressedReadPos, 1, compressedReadSize, readBuffer, flags);
+		u8 *dest = frameSize == (u32)GetBlockSize() ? outPtr : zlibBuffer;
+		if (!sharedCache_ || !sharedCache_->Read(frameNumber, dest)) {
+			const u8 *src = fileLoader_->GetPointer(compressedReadPos, compressedReadSize);
+			u32 readSize = (u32)compressedReadSize;
+			if (!src) {
+				readSize = (u32)fileLoader_->ReadAt(compressedReadPos, 1, compressedReadSize, readBuffer, flags);
+				src = readBuffer;
+			}
 
-		z.zalloc = Z_NULL;
-		z.zfree = Z_NULL;
-		z.opaque = Z_NULL;
-		if (inflateInit2(&z, -15) != Z_OK) {
-			ERROR_LOG(LOADER, "GetBlockSize() ERROR: %s\n", (z.msg) ? z.msg : "?");
-			NotifyReadError();
-			return false;
-		}
-		z.avail_in = readSize;
-		z.next_out = frameSize == (u32)GetBlockSize() ? outPtr : zlibBuffer;
-		z.avail_out = frameSize;
-		z.next_in = readBuffer;
-
-		int status = inflate(&z, Z_FINISH);
-		if (status != Z_STREAM_END) {
-			ERROR_LOG(LOADER, "block %d: inflate : %s[%d]\n", blockNumber, (z.msg) ? z.msg : "error", status);
-			NotifyReadError();
-			inflateEnd(&z);
-			memset(outPtr, 0, GetBlockSize());
-			return false;
-		}
-		if (z.total_out != frameSize) {
-			ERROR_LOG(LOADER, "block %d: block size error %d != %d\n", blockNumber, (u32)z.total_out, frameSize);
-			NotifyReadError();
-			inflateEnd(&z);
-			memset(outPtr, 0, GetBlockSize());
-			return false;
+			if (!DecompressFrame(frameNumber, src, readSize, dest)) {
+				NotifyReadError();
+				memset(outPtr, 0, GetBlockSize());
+				return false;
+			}
+			if (sharedCache_)
+				sharedCache_->Write(frameNumber, dest);
 		}
-		inflateEnd(&z);
 
 		if (frameSize != (u32)GetBlockSize()) {
 			zlibBufferFrame = frameNumber;
@@ -290,98 +453,445 @@ bool CISOFileBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 }
 
 bool CISOFileBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
-	if (count == 1) {
-		return ReadBlock(minBlock, outPtr);
-	}
 	if (minBlock >= numBlocks) {
 		memset(outPtr, 0, GetBlockSize() * count);
 		return false;
 	}
 
 	const u32 lastBlock = std::min(minBlock + count, numBlocks) - 1;
-	const u32 missingBlocks = (lastBlock + 1 - minBlock) - count;
-	if (lastBlock < minBlock + count) {
+	bool sequential;
+	{
+		std::lock_guard<std::mutex> guard(readLock_);
+		// Sequential if this starts in the frame right after the last read ended.
+		sequential = (minBlock >> blockShift) == nextSequentialFrame_;
+		if (count != 1 || sequential)
+			nextSequentialFrame_ = (lastBlock + 1) >> blockShift;
+	}
+	if (count == 1 && !sequential) {
+		return ReadBlock(minBlock, outPtr);
+	}
+
+	const u32 missingBlocks = count - (lastBlock + 1 - minBlock);
+	if (missingBlocks != 0) {
 		memset(outPtr + GetBlockSize() * (count - missingBlocks), 0, GetBlockSize() * missingBlocks);
 	}
 
-	const u32 minFrameNumber = minBlock >> blockShift;
-	const u32 lastFrameNumber = lastBlock >> blockShift;
-	const u32 afterLastIndexPos = index[lastFrameNumber + 1] & 0x7FFFFFFF;
-	const u64 totalReadEnd = (u64)afterLastIndexPos << indexShift;
+	return ReadFramesCached(minBlock, lastBlock, sequential ? readAheadFrames_ : 0, outPtr);
+}
 
-	z_stream z;
-	z.zalloc = Z_NULL;
-	z.zfree = Z_NULL;
-	z.opaque = Z_NULL;
-	if (inflateInit2(&z, -15) != Z_OK) {
-		ERROR_LOG(LOADER, "Unable to initialize inflate: %s\n", (z.msg) ? z.msg : "?");
-		return false;
-	}
+bool CISOFileBlockDevice::ReadFramesCached(u32 minBlock, u32 lastBlock, u32 readAheadFrames, u8 *outPtr) {
+	std::lock_guard<std::mutex> guard(cacheLock_);
 
-	u64 readBufferStart = 0;
-	u64 readBufferEnd = 0;
-	u32 block = minBlock;
+	const u32 blockSize = GetBlockSize();
 	const u32 blocksPerFrame = 1 << blockShift;
-	for (u32 frame = minFrameNumber; frame <= lastFrameNumber; ++frame) {
-		const u32 idx = index[frame];
-		const u32 indexPos = idx & 0x7FFFFFFF;
-		const u32 nextIndexPos = index[frame + 1] & 0x7FFFFFFF;
-
-		const u64 frameReadPos = (u64)indexPos << indexShift;
-		const u64 frameReadEnd = (u64)nextIndexPos << indexShift;
-		const u32 frameReadSize = (u32)(frameReadEnd - frameReadPos);
-		const u32 frameBlockOffset = block & ((1 << blockShift) - 1);
-		const u32 frameBlocks = std::min(lastBlock - block + 1, blocksPerFrame - frameBlockOffset);
-
-		if (frameReadEnd > readBufferEnd) {
-			const s64 maxNeeded = totalReadEnd - frameReadPos;
-			const size_t chunkSize = (size_t)std::min(maxNeeded, (s64)std::max(frameReadSize, CSO_READ_BUFFER_SIZE));
-
-			const u32 readSize = (u32)fileLoader_->ReadAt(frameReadPos, 1, chunkSize, readBuffer);
-			if (readSize < chunkSize) {
-				memset(readBuffer + readSize, 0, chunkSize - readSize);
-			}
+	const u32 minFrame = minBlock >> blockShift;
+	const u32 lastFrame = lastBlock >> blockShift;
+	const u32 endFrame = std::min(lastFrame + readAheadFrames, numFrames - 1);
+
+	// Copies the part of a frame's blocks that was asked for.
+	auto copyOut = [&](u32 frame, const u8 *frameData) {
+		const u32 frameFirstBlock = frame << blockShift;
+		const u32 copyFirst = std::max(frameFirstBlock, minBlock);
+		const u32 copyLast = std::min(frameFirstBlock + blocksPerFrame - 1, lastBlock);
+		u8 *dest = outPtr + (copyFirst - minBlock) * blockSize;
+		if (frameData)
+			memcpy(dest, frameData + (copyFirst - frameFirstBlock) * blockSize, (copyLast - copyFirst + 1) * blockSize);
+		else
+			memset(dest, 0, (copyLast - copyFirst + 1) * blockSize);
+	};
+
+	// Frames wholly inside the read go straight to outPtr, the rest (start, end, read-ahead) via the cache.
+	// Cache hits are copied right away, later allocations may reuse their slot.
+	struct FrameJob {
+		u32 frame;
+		u8 *dest;
+		bool partial;
+		bool ok;
+	};
+	std::vector<FrameJob> jobs;
+	jobs.reserve(endFrame - minFrame + 1);
+	for (u32 frame = minFrame; frame <= endFrame; ++frame) {
+		const u32 frameFirstBlock = frame << blockShift;
+		const u32 frameLastBlock = frameFirstBlock + blocksPerFrame - 1;
+		const u8 *cached = FindCachedFrame(frame);
+		if (cached) {
+			if (frame <= lastFrame)
+				copyOut(frame, cached);
+			continue;
+		}
+		FrameJob job;
+		if (frameFirstBlock >= minBlock && frameLastBlock <= lastBlock) {
+			job = { frame, outPtr + (frameFirstBlock - minBlock) * blockSize, false, true };
+		} else {
+			// Only partial and read-ahead frames land here, and that's fewer than the cache holds.
+			job = { frame, AllocCachedFrame(frame), frame <= lastFrame, true };
+		}
+		// Plain frames are just a copy anyway, don't bother sharing those.
+		if (sharedCache_ && !IsFramePlain(frame) && sharedCache_->Read(frame, job.dest)) {
+			if (job.partial)
+				copyOut(frame, job.dest);
+			continue;
+		}
+		jobs.push_back(job);
+	}
 
-			readBufferStart = frameReadPos;
-			readBufferEnd = frameReadPos + readSize;
+	if (!jobs.empty()) {
+		// One read covering all of them.  Any cached frames in between are just skipped over.
+		const u64 readPos = (u64)(index[jobs.front().frame] & 0x7FFFFFFF) << indexShift;
+		const u64 readEnd = (u64)(index[jobs.back().frame + 1] & 0x7FFFFFFF) << indexShift;
+		const size_t readSize = (size_t)(readEnd - readPos);
+		// Decompress straight out of the file if the loader has it mapped.
+		const u8 *readData = fileLoader_->GetPointer(readPos, readSize);
+		if (!readData) {
+			readAheadBuffer_.resize(readSize);
+			const size_t bytesRead = fileLoader_->ReadAt(readPos, 1, readSize, readAheadBuffer_.data());
+			if (bytesRead < readSize)
+				memset(readAheadBuffer_.data() + bytesRead, 0, readSize - bytesRead);
+			readData = readAheadBuffer_.data();
 		}
 
-		u8 *rawBuffer = &readBuffer[frameReadPos - readBufferStart];
-		const int plain = idx & 0x80000000;
-		if (plain) {
-			memcpy(outPtr, rawBuffer + frameBlockOffset * GetBlockSize(), frameBlocks * GetBlockSize());
+		auto decompressJobs = [&](int l, int h) {
+			for (int i = l; i < h; ++i) {
+				FrameJob &job = jobs[i];
+				const u64 framePos = (u64)(index[job.frame] & 0x7FFFFFFF) << indexShift;
+				const u64 frameEnd = (u64)(index[job.frame + 1] & 0x7FFFFFFF) << indexShift;
+				const u8 *src = readData + (framePos - readPos);
+				job.ok = DecompressFrame(job.frame, src, (u32)(frameEnd - framePos), job.dest);
+				if (job.ok && sharedCache_ && !IsFramePlain(job.frame))
+					sharedCache_->Write(job.frame, job.dest);
+			}
+		};
+		if ((int)jobs.size() >= CSO_PARALLEL_MIN_FRAMES) {
+			ParallelRangeLoop(&g_threadManager, decompressJobs, 0, (int)jobs.size(), CSO_PARALLEL_MIN_FRAMES / 2);
 		} else {
-			z.avail_in = frameReadSize;
-			z.next_out = frameBlocks == blocksPerFrame ? outPtr : zlibBuffer;
-			z.avail_out = frameSize;
-			z.next_in = rawBuffer;
-
-			int status = inflate(&z, Z_FINISH);
-			if (status != Z_STREAM_END) {
-				ERROR_LOG(LOADER, "Inflate frame %d: failed - %s[%d]\n", frame, (z.msg) ? z.msg : "error", status);
-				NotifyReadError();
-				memset(outPtr, 0, frameBlocks * GetBlockSize());
-			} else if (z.total_out != frameSize) {
-				ERROR_LOG(LOADER, "Inflate frame %d: block size error %d != %d\n", frame, (u32)z.total_out, frameSize);
-				NotifyReadError();
-				memset(outPtr, 0, frameBlocks * GetBlockSize());
-			} else if (frameBlocks != blocksPerFrame) {
-				memcpy(outPtr, zlibBuffer + frameBlockOffset * GetBlockSize(), frameBlocks * GetBlockSize());
-				// In case we end up reusing it in a single read later.
-				zlibBufferFrame = frame;
+			decompressJobs(0, (int)jobs.size());
+		}
+	}
+
+	bool success = true;
+	for (FrameJob &job : jobs) {
+		if (!job.ok) {
+			success = false;
+			memset(job.dest, 0, frameSize);
+			// Don't keep the garbage around.
+			for (CachedFrame &entry : frameCache_) {
+				if (entry.frame == job.frame)
+					entry.frame = 0xFFFFFFFF;
 			}
+		}
+		if (job.partial)
+			copyOut(job.frame, job.ok ? job.dest : nullptr);
+	}
+	if (!success)
+		NotifyReadError();
+
+	return success;
+}
 
-			inflateReset(&z);
+// Numbers from the zstd seekable format spec.
+static const u32 ZSTD_FRAME_MAGIC = 0xFD2FB528;
+static const u32 ZSTD_SKIPPABLE_SEEK_TABLE_MAGIC = 0x184D2A5E;
+static const u32 ZSTD_SEEKABLE_MAGIC = 0x8F92EAB1;
+static const u32 ZSTD_SEEK_TABLE_FOOTER_SIZE = 9;
+static const u8 ZSTD_SEEK_TABLE_CHECKSUM_FLAG = 0x80;
+
+static bool IsZstdSeekable(FileLoader *fileLoader) {
+	u32_le magic = 0;
+	u8 footerMagic[4]{};
+	s64 fileSize = fileLoader->FileSize();
+	if (fileSize < 4 + ZSTD_SEEK_TABLE_FOOTER_SIZE)
+		return false;
+	if (fileLoader->ReadAt(0, 4, 1, &magic) != 1 || fileLoader->ReadAt(fileSize - 4, 4, footerMagic) != 4)
+		return false;
+	u32_le footer;
+	memcpy(&footer, footerMagic, 4);
+	return magic == ZSTD_FRAME_MAGIC && footer == ZSTD_SEEKABLE_MAGIC;
+}
+
+ZstdSeekableBlockDevice::ZstdSeekableBlockDevice(FileLoader *fileLoader)
+	: fileLoader_(fileLoader)
+{
+	const u64 fileSize = fileLoader->FileSize();
+	u8 footer[ZSTD_SEEK_TABLE_FOOTER_SIZE];
+	if (fileLoader->ReadAt(fileSize - sizeof(footer), sizeof(footer), footer) != sizeof(footer)) {
+		ERROR_LOG(LOADER, "Unable to read zstd seek table");
+		NotifyReadError();
+		return;
+	}
+
+	u32_le numFrames;
+	memcpy(&numFrames, footer, 4);
+	const u8 descriptor = footer[4];
+	const u32 entrySize = (descriptor & ZSTD_SEEK_TABLE_CHECKSUM_FLAG) ? 12 : 8;
+	const u64 tableSize = 8 + (u64)numFrames * entrySize + sizeof(footer);
+	if (numFrames == 0 || tableSize > fileSize) {
+		ERROR_LOG(LOADER, "Invalid zstd seek table, %d frames", (u32)numFrames);
+		NotifyReadError();
+		return;
+	}
+
+	std::vector<u8> table((size_t)tableSize);
+	if (fileLoader->ReadAt(fileSize - tableSize, 1, (size_t)tableSize, &table[0]) != tableSize) {
+		ERROR_LOG(LOADER, "Unable to read zstd seek table");
+		NotifyReadError();
+		return;
+	}
+	u32_le tableMagic, tableFrameSize;
+	memcpy(&tableMagic, &table[0], 4);
+	memcpy(&tableFrameSize, &table[4], 4);
+	if (tableMagic != ZSTD_SKIPPABLE_SEEK_TABLE_MAGIC || tableFrameSize != tableSize - 8) {
+		ERROR_LOG(LOADER, "Invalid zstd seek table header");
+		NotifyReadError();
+		return;
+	}
+
+	frameOffsets_.resize(numFrames + 1);
+	u64 compressedPos = 0;
+	for (u32 i = 0; i < numFrames; ++i) {
+		u32_le compressedSize, decompressedSize;
+		memcpy(&compressedSize, &table[8 + i * entrySize], 4);
+		memcpy(&decompressedSize, &table[8 + i * entrySize + 4], 4);
+		if (i == 0)
+			frameSize_ = decompressedSize;
+
+		// We find frames by block number, so they must all be the same size (except the last.)
+		bool sizeOk = i == numFrames - 1 ? decompressedSize <= frameSize_ : decompressedSize == frameSize_;
+		if (!sizeOk) {
+			ERROR_LOG(LOADER, "zstd frame %d has size %d, all frames must be %d bytes", i, (u32)decompressedSize, frameSize_);
+			NotifyReadError();
+			frameOffsets_.clear();
+			return;
 		}
+		frameOffsets_[i] = compressedPos;
+		compressedPos += compressedSize;
+		totalSize_ += decompressedSize;
+	}
+	frameOffsets_[numFrames] = compressedPos;
 
-		block += frameBlocks;
-		outPtr += frameBlocks * GetBlockSize();
+	if (frameSize_ == 0 || (frameSize_ % GetBlockSize()) != 0 || compressedPos > fileSize - tableSize) {
+		ERROR_LOG(LOADER, "zstd frame size %d unsupported, must be a multiple of the sector size", frameSize_);
+		NotifyReadError();
+		frameOffsets_.clear();
+		return;
 	}
 
-	inflateEnd(&z);
+	numFrames_ = numFrames;
+	blocksPerFrame_ = frameSize_ / GetBlockSize();
+	numBlocks_ = (u32)(totalSize_ / GetBlockSize());
+	frameBuffer_.resize(frameSize_);
+	VERBOSE_LOG(LOADER, "zstd numBlocks=%i numFrames=%i frameSize=%i", numBlocks_, numFrames_, frameSize_);
+}
+
+ZstdSeekableBlockDevice::~ZstdSeekableBlockDevice() {
+}
+
+u32 ZstdSeekableBlockDevice::FrameDecompressedSize(u32 frame) const {
+	return (u32)std::min((u64)frameSize_, totalSize_ - (u64)frame * frameSize_);
+}
+
+bool ZstdSeekableBlockDevice::DecompressFrame(u32 frame, const u8 *src, u8 *dest) const {
+	const size_t srcSize = (size_t)(frameOffsets_[frame + 1] - frameOffsets_[frame]);
+	const u32 expected = FrameDecompressedSize(frame);
+	size_t outSize = ZSTD_decompress(dest, frameSize_, src, srcSize);
+	if (ZSTD_isError(outSize) || outSize != expected) {
+		ERROR_LOG(LOADER, "zstd frame %d: decompression failed - %s", frame, ZSTD_isError(outSize) ? ZSTD_getErrorName(outSize) : "wrong size");
+		return false;
+	}
+	if (outSize < frameSize_)
+		memset(dest + outSize, 0, frameSize_ - outSize);
 	return true;
 }
 
+bool ZstdSeekableBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached) {
+	return ReadBlocks((u32)blockNumber, 1, outPtr);
+}
+
+bool ZstdSeekableBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
+	const u32 blockSize = GetBlockSize();
+	if (minBlock >= numBlocks_) {
+		memset(outPtr, 0, blockSize * count);
+		return false;
+	}
+	const u32 lastBlock = std::min(minBlock + count, numBlocks_) - 1;
+	const u32 missingBlocks = count - (lastBlock + 1 - minBlock);
+	if (missingBlocks != 0) {
+		memset(outPtr + blockSize * (count - missingBlocks), 0, blockSize * missingBlocks);
+	}
+
+	std::lock_guard<std::mutex> guard(readLock_);
+
+	const u32 minFrame = minBlock / blocksPerFrame_;
+	const u32 lastFrame = lastBlock / blocksPerFrame_;
+
+	// Copies the part of a frame's blocks that was asked for.
+	auto copyOut = [&](u32 frame, const u8 *frameData) {
+		const u32 frameFirstBlock = frame * blocksPerFrame_;
+		const u32 copyFirst = std::max(frameFirstBlock, minBlock);
+		const u32 copyLast = std::min(frameFirstBlock + blocksPerFrame_ - 1, lastBlock);
+		u8 *dest = outPtr + (copyFirst - minBlock) * blockSize;
+		if (frameData)
+			memcpy(dest, frameData + (copyFirst - frameFirstBlock) * blockSize, (copyLast - copyFirst + 1) * blockSize);
+		else
+			memset(dest, 0, (copyLast - copyFirst + 1) * blockSize);
+	};
+
+	// Whole frames go straight to outPtr.  The partial ones at either end need a buffer.
+	struct FrameJob {
+		u32 frame;
+		u8 *dest;
+		bool partial;
+		bool ok;
+	};
+	std::vector<FrameJob> jobs;
+	std::vector<u8> firstFrame;
+	for (u32 frame = minFrame; frame <= lastFrame; ++frame) {
+		const u32 frameFirstBlock = frame * blocksPerFrame_;
+		const u32 frameLastBlock = frameFirstBlock + blocksPerFrame_ - 1;
+		if (frame == bufferedFrame_) {
+			// Copy it now, the last frame might be decompressed into the same buffer.
+			copyOut(frame, &frameBuffer_[0]);
+			continue;
+		}
+		if (frameFirstBlock >= minBlock && frameLastBlock <= lastBlock) {
+			jobs.push_back({ frame, outPtr + (frameFirstBlock - minBlock) * blockSize, false, true });
+		} else if (frame == lastFrame) {
+			// The next read most likely continues in this one, so keep it around.
+			bufferedFrame_ = 0xFFFFFFFF;
+			jobs.push_back({ frame, &frameBuffer_[0], true, true });
+		} else {
+			firstFrame.resize(frameSize_);
+			jobs.push_back({ frame, &firstFrame[0], true, true });
+		}
+	}
+
+	if (!jobs.empty()) {
+		// One read for all of them, skipping over the buffered frame if it's in between.
+		const u64 readPos = frameOffsets_[jobs.front().frame];
+		const u64 readEnd = frameOffsets_[jobs.back().frame + 1];
+		const size_t readSize = (size_t)(readEnd - readPos);
+		const u8 *readData = fileLoader_->GetPointer(readPos, readSize);
+		if (!readData) {
+			readBuffer_.resize(readSize);
+			const size_t bytesRead = fileLoader_->ReadAt(readPos, 1, readSize, readBuffer_.data());
+			if (bytesRead < readSize)
+				memset(readBuffer_.data() + bytesRead, 0, readSize - bytesRead);
+			readData = readBuffer_.data();
+		}
+
+		auto decompressJobs = [&](int l, int h) {
+			for (int i = l; i < h; ++i) {
+				FrameJob &job = jobs[i];
+				job.ok = DecompressFrame(job.frame, readData + (frameOffsets_[job.frame] - readPos), job.dest);
+			}
+		};
+		if ((int)jobs.size() >= CSO_PARALLEL_MIN_FRAMES) {
+			ParallelRangeLoop(&g_threadManager, decompressJobs, 0, (int)jobs.size(), CSO_PARALLEL_MIN_FRAMES / 2);
+		} else {
+			decompressJobs(0, (int)jobs.size());
+		}
+	}
+
+	bool success = true;
+	for (FrameJob &job : jobs) {
+		if (!job.ok) {
+			success = false;
+			memset(job.dest, 0, frameSize_);
+		} else if (job.dest == &frameBuffer_[0]) {
+			bufferedFrame_ = job.frame;
+		}
+		if (job.partial)
+			copyOut(job.frame, job.ok ? job.dest : nullptr);
+	}
+	if (!success)
+		NotifyReadError();
+
+	return success;
+}
+
+bool CompressToZstdSeekable(BlockDevice *source, const Path &dest, u32 frameSize, int level, std::string *errorString) {
+	const u32 blockSize = source->GetBlockSize();
+	const u32 blocksPerFrame = frameSize / blockSize;
+	const u32 numBlocks = source->GetNumBlocks();
+	const u32 numFrames = (numBlocks + blocksPerFrame - 1) / blocksPerFrame;
+	if (frameSize == 0 || (frameSize % blockSize) != 0) {
+		*errorString = "Frame size must be a multiple of 2048";
+		return false;
+	}
+
+	FILE *f = File::OpenCFile(dest, "wb");
+	if (!f) {
+		*errorString = "Unable to open " + dest.ToVisualString() + " for writing";
+		return false;
+	}
+
+	// Batches of frames are read, then compressed in parallel, then written in order.
+	const u32 BATCH_FRAMES = 256;
+	const size_t compressBound = ZSTD_compressBound(frameSize);
+	std::vector<u8> input((size_t)BATCH_FRAMES * frameSize);
+	std::vector<u8> output(BATCH_FRAMES * compressBound);
+	std::vector<size_t> outputSizes(BATCH_FRAMES);
+	std::vector<u32_le> seekTable;
+	seekTable.reserve(numFrames * 2);
+
+	bool success = true;
+	for (u32 batchStart = 0; success && batchStart < numFrames; batchStart += BATCH_FRAMES) {
+		const u32 batchFrames = std::min(BATCH_FRAMES, numFrames - batchStart);
+		const u32 firstBlock = batchStart * blocksPerFrame;
+		const u32 batchBlocks = std::min(batchFrames * blocksPerFrame, numBlocks - firstBlock);
+		if (!source->ReadBlocks(firstBlock, batchBlocks, &input[0])) {
+			*errorString = StringFromFormat("Unable to read blocks %d-%d", firstBlock, firstBlock + batchBlocks - 1);
+			success = false;
+			break;
+		}
+
+		ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+			for (int i = l; i < h; ++i) {
+				const u32 frameBlocks = std::min(blocksPerFrame, batchBlocks - i * blocksPerFrame);
+				outputSizes[i] = ZSTD_compress(&output[i * compressBound], compressBound, &input[(size_t)i * frameSize], frameBlocks * blockSize, level);
+			}
+		}, 0, (int)batchFrames, 1);
+
+		for (u32 i = 0; i < batchFrames; ++i) {
+			if (ZSTD_isError(outputSizes[i])) {
+				*errorString = StringFromFormat("Compression failed: %s", ZSTD_getErrorName(outputSizes[i]));
+				success = false;
+				break;
+			}
+			const u32 frameBlocks = std::min(blocksPerFrame, batchBlocks - i * blocksPerFrame);
+			seekTable.push_back((u32)outputSizes[i]);
+			seekTable.push_back(frameBlocks * blockSize);
+			if (fwrite(&output[i * compressBound], 1, outputSizes[i], f) != outputSizes[i]) {
+				*errorString = "Write failed";
+				success = false;
+				break;
+			}
+		}
+	}
+
+	if (success) {
+		// The seek table goes at the end, in a skippable frame so plain zstd can still decompress the file.
+		const u32 entriesSize = (u32)(seekTable.size() * sizeof(u32_le));
+		u32_le header[2];
+		header[0] = ZSTD_SKIPPABLE_SEEK_TABLE_MAGIC;
+		header[1] = entriesSize + ZSTD_SEEK_TABLE_FOOTER_SIZE;
+		u8 footer[ZSTD_SEEK_TABLE_FOOTER_SIZE];
+		u32_le footerFrames = numFrames;
+		u32_le footerMagic = ZSTD_SEEKABLE_MAGIC;
+		memcpy(footer, &footerFrames, 4);
+		footer[4] = 0;
+		memcpy(footer + 5, &footerMagic, 4);
+
+		success = fwrite(header, sizeof(header), 1, f) == 1;
+		success = success && (seekTable.empty() || fwrite(&seekTable[0], entriesSize, 1, f) == 1);
+		success = success && fwrite(footer, sizeof(footer), 1, f) == 1;
+		if (!success)
+			*errorString = "Write failed";
+	}
+
+	fclose(f);
+	return success;
+}
+
 NPDRMDemoBlockDevice::NPDRMDemoBlockDevice(FileLoader *fileLoader)
 	: fileLoader_(fileLoader)
 {
@@ -418,8 +928,13 @@ NPDRMDemoBlockDevice::NPDRMDemoBlockDevice(FileLoader *fileLoader)
 	blockSize = blockLBAs*2048;
 	numBlocks = (lbaSize+blockLBAs-1)/blockLBAs; // total blocks;
 
-	blockBuf = new u8[blockSize];
-	tempBuf  = new u8[blockSize];
+	blockCache_.resize(NPDRM_READ_AHEAD_BLOCKS + NPDRM_BLOCK_CACHE_EXTRA);
+	blockCacheData_ = new u8[blockCache_.size() * blockSize];
+	for (size_t i = 0; i < blockCache_.size(); ++i) {
+		blockCache_[i].block = 0xFFFFFFFF;
+		blockCache_[i].lastUse = 0;
+		blockCache_[i].data = blockCacheData_ + i * blockSize;
+	}
 
 	tableOffset = *(u32*)(np_header+0x6c); // table offset
 
@@ -444,58 +959,43 @@ NPDRMDemoBlockDevice::NPDRMDemoBlockDevice(FileLoader *fileLoader)
 		p[7] ^= k0;
 		p += 8;
 	}
-
-	currentBlock = -1;
-
 }
 
 NPDRMDemoBlockDevice::~NPDRMDemoBlockDevice()
 {
 	std::lock_guard<std::mutex> guard(mutex_);
 	delete [] table;
-	delete [] tempBuf;
-	delete [] blockBuf;
+	delete [] blockCacheData_;
 }
 
 int lzrc_decompress(void *out, int out_len, void *in, int in_len);
 
-bool NPDRMDemoBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
-{
-	FileLoader::Flags flags = uncached ? FileLoader::Flags::HINT_UNCACHED : FileLoader::Flags::NONE;
-	std::lock_guard<std::mutex> guard(mutex_);
-	CIPHER_KEY ckey;
-	int block, lba, lzsize;
-	size_t readSize;
-	u8 *readBuf;
-
-	lba = blockNumber-currentBlock;
-	if(lba>=0 && lba<blockLBAs){
-		memcpy(outPtr, blockBuf+lba*2048, 2048);
-		return true;
+u8 *NPDRMDemoBlockDevice::FindCachedBlock(u32 block) {
+	for (CachedBlock &entry : blockCache_) {
+		if (entry.block == block) {
+			entry.lastUse = ++blockCacheUse_;
+			return entry.data;
+		}
 	}
+	return nullptr;
+}
 
-	block = blockNumber/blockLBAs;
-	lba = blockNumber%blockLBAs;
-	currentBlock = block*blockLBAs;
-
-	if(table[block].unk_1c!=0){
-		if((u32)block==(numBlocks-1))
-			return true; // demos make by fake_np
-		else
-			return false;
+u8 *NPDRMDemoBlockDevice::AllocCachedBlock(u32 block) {
+	CachedBlock *oldest = &blockCache_[0];
+	for (CachedBlock &entry : blockCache_) {
+		if (entry.lastUse < oldest->lastUse)
+			oldest = &entry;
 	}
+	oldest->block = block;
+	oldest->lastUse = ++blockCacheUse_;
+	return oldest->data;
+}
 
-	if(table[block].size<blockSize)
-		readBuf = tempBuf;
-	else
-		readBuf = blockBuf;
-
-	readSize = fileLoader_->ReadAt(psarOffset+table[block].offset, 1, table[block].size, readBuf, flags);
-	if(readSize != (size_t)table[block].size){
-		if((u32)block==(numBlocks-1))
-			return true;
-		else
-			return false;
+bool NPDRMDemoBlockDevice::DecodeBlock(u32 block, u8 *raw, size_t rawSize, u8 *out) const {
+	if (table[block].unk_1c != 0 || rawSize != (size_t)table[block].size) {
+		// Demos made by fake_np have a bogus last block.
+		memset(out, 0, blockSize);
+		return block == numBlocks - 1;
 	}
 
 	if((table[block].flag&1)==0){
@@ -503,21 +1003,133 @@ bool NPDRMDemoBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
 	}
 
 	if((table[block].flag&4)==0){
-		sceDrmBBCipherInit(&ckey, 1, 2, hkey, vkey, table[block].offset>>4);
-		sceDrmBBCipherUpdate(&ckey, readBuf, table[block].size);
+		CIPHER_KEY ckey;
+		sceDrmBBCipherInit(&ckey, 1, 2, (u8 *)hkey, (u8 *)vkey, table[block].offset>>4);
+		sceDrmBBCipherUpdate(&ckey, raw, table[block].size);
 		sceDrmBBCipherFinal(&ckey);
 	}
 
 	if(table[block].size<blockSize){
-		lzsize = lzrc_decompress(blockBuf, 0x00100000, readBuf, table[block].size);
+		int lzsize = lzrc_decompress(out, blockSize, raw, table[block].size);
 		if(lzsize!=blockSize){
 			ERROR_LOG(LOADER, "LZRC decompress error! lzsize=%d\n", lzsize);
-			NotifyReadError();
 			return false;
 		}
+	} else {
+		memcpy(out, raw, blockSize);
 	}
+	return true;
+}
 
-	memcpy(outPtr, blockBuf+lba*2048, 2048);
+bool NPDRMDemoBlockDevice::ReadSectors(u32 minSector, u32 count, u8 *outPtr, u32 readAheadBlocks, bool uncached) {
+	FileLoader::Flags flags = uncached ? FileLoader::Flags::HINT_UNCACHED : FileLoader::Flags::NONE;
+	const u32 lastSector = minSector + count - 1;
+	const u32 minBlock = minSector / blockLBAs;
+	const u32 lastBlock = lastSector / blockLBAs;
+	const u32 endBlock = std::min(lastBlock + readAheadBlocks, numBlocks - 1);
+
+	auto copyOut = [&](u32 block, const u8 *data) {
+		const u32 blockFirstSector = block * blockLBAs;
+		const u32 copyFirst = std::max(blockFirstSector, minSector);
+		const u32 copyLast = std::min(blockFirstSector + blockLBAs - 1, lastSector);
+		memcpy(outPtr + (copyFirst - minSector) * 2048, data + (copyFirst - blockFirstSector) * 2048, (copyLast - copyFirst + 1) * 2048);
+	};
+
+	// Whole blocks inside the read are decoded straight to outPtr, the rest go via the cache.
+	struct BlockJob {
+		u32 block;
+		u8 *dest;
+		size_t rawOffset;
+		size_t rawSize;
+		bool partial;
+		bool ok;
+	};
+	std::vector<BlockJob> jobs;
+	size_t rawTotal = 0;
+	for (u32 block = minBlock; block <= endBlock; ++block) {
+		const u8 *cached = FindCachedBlock(block);
+		if (cached) {
+			if (block <= lastBlock)
+				copyOut(block, cached);
+			continue;
+		}
+		const u32 blockFirstSector = block * blockLBAs;
+		const size_t rawSize = std::max(table[block].size, 0);
+		if (blockFirstSector >= minSector && blockFirstSector + blockLBAs - 1 <= lastSector) {
+			jobs.push_back({ block, outPtr + (blockFirstSector - minSector) * 2048, rawTotal, rawSize, false, true });
+		} else {
+			jobs.push_back({ block, AllocCachedBlock(block), rawTotal, rawSize, block <= lastBlock, true });
+		}
+		rawTotal += rawSize;
+	}
+
+	// Reading stays on this thread, only the decryption and decompression is spread out.
+	rawBuffer_.resize(rawTotal);
+	for (BlockJob &job : jobs) {
+		job.rawSize = fileLoader_->ReadAt(psarOffset + table[job.block].offset, 1, job.rawSize, rawBuffer_.data() + job.rawOffset, flags);
+	}
 
+	auto decodeJobs = [&](int l, int h) {
+		for (int i = l; i < h; ++i) {
+			BlockJob &job = jobs[i];
+			job.ok = DecodeBlock(job.block, rawBuffer_.data() + job.rawOffset, job.rawSize, job.dest);
+		}
+	};
+	if (jobs.size() >= 2) {
+		ParallelRangeLoop(&g_threadManager, decodeJobs, 0, (int)jobs.size(), 1);
+	} else {
+		decodeJobs(0, (int)jobs.size());
+	}
+
+	bool success = true;
+	for (BlockJob &job : jobs) {
+		if (!job.ok) {
+			// Don't keep the garbage around.
+			for (CachedBlock &entry : blockCache_) {
+				if (entry.block == job.block)
+					entry.block = 0xFFFFFFFF;
+			}
+			// Read-ahead failures don't matter until someone asks for them.
+			if (job.block <= lastBlock)
+				success = false;
+		}
+		if (job.partial)
+			copyOut(job.block, job.dest);
+	}
+	lastReadBlock_ = lastBlock;
+	return success;
+}
+
+bool NPDRMDemoBlockDevice::ReadBlock(int blockNumber, u8 *outPtr, bool uncached)
+{
+	std::lock_guard<std::mutex> guard(mutex_);
+	if ((u32)blockNumber >= lbaSize) {
+		memset(outPtr, 0, 2048);
+		return false;
+	}
+	if (!ReadSectors(blockNumber, 1, outPtr, 0, uncached)) {
+		NotifyReadError();
+		return false;
+	}
+	return true;
+}
+
+bool NPDRMDemoBlockDevice::ReadBlocks(u32 minBlock, int count, u8 *outPtr) {
+	std::lock_guard<std::mutex> guard(mutex_);
+	if (minBlock >= lbaSize) {
+		memset(outPtr, 0, 2048 * count);
+		return false;
+	}
+	const u32 readCount = std::min((u32)count, lbaSize - minBlock);
+	if (readCount < (u32)count)
+		memset(outPtr + readCount * 2048, 0, (count - readCount) * 2048);
+
+	// Read ahead when continuing on from the last read.
+	const u32 firstBlock = minBlock / blockLBAs;
+	const bool sequential = firstBlock == lastReadBlock_ || firstBlock == lastReadBlock_ + 1;
+	if (!ReadSectors(minBlock, readCount, outPtr, sequential ? NPDRM_READ_AHEAD_BLOCKS : 0, false)) {
+		NotifyReadError();
+		return false;
+	}
 	return true;
 }
@@ -18,17 +18,22 @@
 #pragma once
 
 // Abstractions around read-only blockdevices, such as PSP UMD discs.
-// CISOFileBlockDevice implements compressed iso images, CISO format.
+// CISOFileBlockDevice implements compressed iso images, CISO format (zlib, or LZ4 for ZSO and CSO v2.)
+// ZstdSeekableBlockDevice implements the zstd seekable format, independent zstd frames plus a seek table.
 //
 // The ISOFileSystemReader reads from a BlockDevice, so it automatically works
 // with CISO images.
 
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Core/ELF/PBPReader.h"
 
 class FileLoader;
+class Path;
+class SharedFrameCache;
 
 class BlockDevice {
 public:
@@ -64,6 +69,13 @@ class CISOFileBlockDevice : public BlockDevice {
 	bool IsDisc() override { return true; }
 
 private:
+	// Decompresses (or copies) one whole frame.  Safe to call from several threads at once.
+	bool DecompressFrame(u32 frame, const u8 *src, u32 srcSize, u8 *dest) const;
+	bool IsFramePlain(u32 frame) const;
+	bool ReadFramesCached(u32 minBlock, u32 lastBlock, u32 readAheadFrames, u8 *outPtr);
+	u8 *FindCachedFrame(u32 frame);
+	u8 *AllocCachedFrame(u32 frame);
+
 	FileLoader *fileLoader_;
 	u32 *index;
 	u8 *readBuffer;
@@ -75,9 +87,60 @@ class CISOFileBlockDevice : public BlockDevice {
 	u32 numBlocks;
 	u32 numFrames;
 	int ver_;
+	bool lz4_ = false;
+	u32 readAheadFrames_;
+	// Protects readBuffer, zlibBuffer and nextSequentialFrame_.
+	std::mutex readLock_;
+
+	// Small LRU of decompressed frames, filled by sequential read-ahead.
+	struct CachedFrame {
+		u32 frame;
+		u32 lastUse;
+		u8 *data;
+	};
+	std::mutex cacheLock_;
+	std::vector<CachedFrame> frameCache_;
+	u8 *frameCacheData_ = nullptr;
+	u32 frameCacheUse_ = 0;
+	u32 nextSequentialFrame_ = 0xFFFFFFFF;
+	std::vector<u8> readAheadBuffer_;
+	// Decompressed frames shared with other instances, if enabled.
+	SharedFrameCache *sharedCache_ = nullptr;
 };
 
 
+// The zstd seekable format (see contrib/seekable_format in zstd), with every frame but the last
+// the same whole number of blocks.  That's how CompressToZstdSeekable and the usual tools write it.
+class ZstdSeekableBlockDevice : public BlockDevice {
+public:
+	ZstdSeekableBlockDevice(FileLoader *fileLoader);
+	~ZstdSeekableBlockDevice();
+	bool ReadBlock(int blockNumber, u8 *outPtr, bool uncached = false) override;
+	bool ReadBlocks(u32 minBlock, int count, u8 *outPtr) override;
+	u32 GetNumBlocks() override { return numBlocks_; }
+	bool IsDisc() override { return true; }
+
+private:
+	bool DecompressFrame(u32 frame, const u8 *src, u8 *dest) const;
+	u32 FrameDecompressedSize(u32 frame) const;
+
+	FileLoader *fileLoader_;
+	// Compressed offset of each frame, plus the end of the last one.
+	std::vector<u64> frameOffsets_;
+	u32 frameSize_ = 0;
+	u32 blocksPerFrame_ = 1;
+	u32 numFrames_ = 0;
+	u32 numBlocks_ = 0;
+	u64 totalSize_ = 0;
+
+	// Protects everything below.
+	std::mutex readLock_;
+	std::vector<u8> readBuffer_;
+	// The last partially read frame, sequential reads usually continue in it.
+	std::vector<u8> frameBuffer_;
+	u32 bufferedFrame_ = 0xFFFFFFFF;
+};
+
 class FileBlockDevice : public BlockDevice {
 public:
 	FileBlockDevice(FileLoader *fileLoader);
@@ -109,10 +172,18 @@ class NPDRMDemoBlockDevice : public BlockDevice {
 	~NPDRMDemoBlockDevice();
 
 	bool ReadBlock(int blockNumber, u8 *outPtr, bool uncached = false) override;
+	bool ReadBlocks(u32 minBlock, int count, u8 *outPtr) override;
 	u32 GetNumBlocks() override {return (u32)lbaSize;}
 	bool IsDisc() override { return false; }
 
 private:
+	// Callers must hold mutex_.  Read-ahead is counted in NPDRM blocks (blockLBAs sectors each.)
+	bool ReadSectors(u32 minSector, u32 count, u8 *outPtr, u32 readAheadBlocks, bool uncached);
+	// Decrypts and decompresses one NPDRM block read by ReadSectors.  Safe to call from several threads at once.
+	bool DecodeBlock(u32 block, u8 *raw, size_t rawSize, u8 *out) const;
+	u8 *FindCachedBlock(u32 block);
+	u8 *AllocCachedBlock(u32 block);
+
 	FileLoader *fileLoader_;
 	static std::mutex mutex_;
 	u32 lbaSize;
@@ -126,10 +197,21 @@ class NPDRMDemoBlockDevice : public BlockDevice {
 	u8 hkey[16];
 	struct table_info *table;
 
-	int currentBlock;
-	u8 *blockBuf;
-	u8 *tempBuf;
+	// Small LRU of decoded blocks, filled by sequential read-ahead.
+	struct CachedBlock {
+		u32 block;
+		u32 lastUse;
+		u8 *data;
+	};
+	std::vector<CachedBlock> blockCache_;
+	u8 *blockCacheData_ = nullptr;
+	u32 blockCacheUse_ = 0;
+	u32 lastReadBlock_ = 0xFFFFFFFF;
+	std::vector<u8> rawBuffer_;
 };
 
 
 BlockDevice *constructBlockDevice(FileLoader *fileLoader);
+
+// Writes all of source to dest in the zstd seekable format, compressing frames in parallel.
+bool CompressToZstdSeekable(BlockDevice *source, const Path &dest, u32 frameSize, int level, std::string *errorString);
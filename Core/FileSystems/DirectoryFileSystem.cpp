@@ -286,12 +286,18 @@ bool DirectoryFileHandle::Open(const Path &basePath, std::string &fileName, File
 	}
 #endif
 
+#if HOST_IS_CASE_SENSITIVE
+	if (success && (access & FILEACCESS_CREATE))
+		FixPathCaseNotifyCreated(fullName);
+#endif
+
 	// Try to detect reads/writes to PSP/GAME to avoid them in replays.
 	if (fullName.FilePathContainsNoCase("PSP/GAME/")) {
 		inGameDir_ = true;
 	}
 	if (access & (FILEACCESS_APPEND | FILEACCESS_CREATE | FILEACCESS_WRITE)) {
-		MemoryStick_NotifyWrite();
+		writePath_ = fullName;
+		MemoryStick_NotifyWrite(fullName);
 	}
 
 	return success;
@@ -349,7 +355,7 @@ size_t DirectoryFileHandle::Write(const u8* pointer, s64 size)
 		bytesWritten = ReplayApplyDiskWrite(pointer, (uint64_t)bytesWritten, (uint64_t)size, &diskFull, inGameDir_, CoreTiming::GetGlobalTimeUs());
 	}
 
-	MemoryStick_NotifyWrite();
+	MemoryStick_NotifyWrite(writePath_);
 
 	if (diskFull) {
 		ERROR_LOG(FILESYS, "Disk full");
@@ -447,10 +453,12 @@ bool DirectoryFileSystem::MkDir(const std::string &dirname) {
 		result = false;
 	else
 		result = File::CreateFullPath(GetLocalPath(fixedCase));
+	if (result)
+		FixPathCaseNotifyCreated(GetLocalPath(fixedCase));
 #else
 	result = File::CreateFullPath(GetLocalPath(dirname));
 #endif
-	MemoryStick_NotifyWrite();
+	MemoryStick_NotifyWrite(GetLocalPath(dirname));
 	return ReplayApplyDisk(ReplayAction::MKDIR, result, CoreTiming::GetGlobalTimeUs()) != 0;
 }
 
@@ -460,7 +468,8 @@ bool DirectoryFileSystem::RmDir(const std::string &dirname) {
 #if HOST_IS_CASE_SENSITIVE
 	// Maybe we're lucky?
 	if (File::DeleteDirRecursively(fullName)) {
-		MemoryStick_NotifyWrite();
+		FixPathCaseNotifyRemoved(fullName);
+		MemoryStick_NotifyWrite(fullName);
 		return (bool)ReplayApplyDisk(ReplayAction::RMDIR, true, CoreTiming::GetGlobalTimeUs());
 	}
 
@@ -473,7 +482,11 @@ bool DirectoryFileSystem::RmDir(const std::string &dirname) {
 #endif
 
 	bool result = File::DeleteDirRecursively(fullName);
-	MemoryStick_NotifyWrite();
+#if HOST_IS_CASE_SENSITIVE
+	if (result)
+		FixPathCaseNotifyRemoved(fullName);
+#endif
+	MemoryStick_NotifyWrite(fullName);
 	return ReplayApplyDisk(ReplayAction::RMDIR, result, CoreTiming::GetGlobalTimeUs()) != 0;
 }
 
@@ -517,11 +530,17 @@ int DirectoryFileSystem::RenameFile(const std::string &from, const std::string &
 
 		retValue = File::Rename(fullFrom, fullToPath);
 	}
+
+	if (retValue) {
+		FixPathCaseNotifyRemoved(fullFrom);
+		FixPathCaseNotifyCreated(fullToPath);
+	}
 #endif
 
 	// TODO: Better error codes.
 	int result = retValue ? 0 : (int)SCE_KERNEL_ERROR_ERRNO_FILE_ALREADY_EXISTS;
-	MemoryStick_NotifyWrite();
+	MemoryStick_NotifyWrite(fullFrom);
+	MemoryStick_NotifyWrite(fullToPath);
 	return ReplayApplyDisk(ReplayAction::FILE_RENAME, result, CoreTiming::GetGlobalTimeUs());
 }
 
@@ -541,9 +560,12 @@ bool DirectoryFileSystem::RemoveFile(const std::string &filename) {
 
 		retValue = File::Delete(localPath);
 	}
+
+	if (retValue)
+		FixPathCaseNotifyRemoved(localPath);
 #endif
 
-	MemoryStick_NotifyWrite();
+	MemoryStick_NotifyWrite(localPath);
 	return ReplayApplyDisk(ReplayAction::FILE_REMOVE, retValue, CoreTiming::GetGlobalTimeUs()) != 0;
 }
 
@@ -42,6 +42,7 @@ struct DirectoryFileHandle {
 	s64 needsTrunc_ = -1;
 	bool replay_ = true;
 	bool inGameDir_ = false;
+	Path writePath_;
 	FileSystemFlags fileSystemFlags_ = (FileSystemFlags)0;
 
 	DirectoryFileHandle() {}
@@ -64,6 +64,8 @@ enum class FileSystemFlags {
 	CARD = 4,
 	FLASH = 8,
 	STRIP_PSP = 16,
+	// ReadFile is safe to call from several threads at once, also while other calls are made.
+	CONCURRENT_READS = 32,
 };
 ENUM_CLASS_BITOPS(FileSystemFlags);
 
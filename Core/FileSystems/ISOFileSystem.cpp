@@ -178,6 +178,11 @@ ISOFileSystem::~ISOFileSystem() {
 }
 
 void ISOFileSystem::ReadDirectory(TreeEntry *root) {
+	std::string pathPrefix = EntryFullPath(root);
+	// Without the leading slash.
+	if (!pathPrefix.empty())
+		pathPrefix = pathPrefix.substr(1) + "/";
+
 	for (u32 secnum = root->startsector, endsector = root->startsector + (root->dirsize + 2047) / 2048; secnum < endsector; ++secnum) {
 		u8 theSector[2048];
 		if (!blockDevice->ReadBlock(secnum, theSector)) {
@@ -186,7 +191,10 @@ void ISOFileSystem::ReadDirectory(TreeEntry *root) {
 			root->valid = true;  // Prevents re-reading
 			return;
 		}
-		lastReadBlock_ = secnum;  // Hm, this could affect timing... but lazy loading is probably more realistic.
+		{
+			std::lock_guard<std::mutex> guard(entriesLock_);
+			lastReadBlock_ = secnum;  // Hm, this could affect timing... but lazy loading is probably more realistic.
+		}
 
 		for (int offset = 0; offset < 2048; ) {
 			DirectoryEntry &dir = *(DirectoryEntry *)&theSector[offset];
@@ -237,6 +245,8 @@ void ISOFileSystem::ReadDirectory(TreeEntry *root) {
 				}
 			}
 			root->children.push_back(entry);
+			// The first entry wins if there are duplicate names.
+			pathIndex_.emplace(pathPrefix + entry->name, entry);
 		}
 	}
 	root->valid = true;
@@ -263,47 +273,35 @@ ISOFileSystem::TreeEntry *ISOFileSystem::GetFromPath(const std::string &path, bo
 	if (pathLength <= pathIndex)
 		return treeroot;
 
-	TreeEntry *entry = treeroot;
-	while (true) {
-		if (!entry->valid) {
-			ReadDirectory(entry);
-		}
-		TreeEntry *nextEntry = nullptr;
-		std::string name = "";
-		if (pathLength > pathIndex) {
-			size_t nextSlashIndex = path.find_first_of('/', pathIndex);
-			if (nextSlashIndex == std::string::npos)
-				nextSlashIndex = pathLength;
-
-			const std::string firstPathComponent = path.substr(pathIndex, nextSlashIndex - pathIndex);
-			for (size_t i = 0; i < entry->children.size(); i++) {
-				const std::string &n = entry->children[i]->name;
-				if (firstPathComponent == n) {
-					//yay we got it
-					nextEntry = entry->children[i];
-					name = n;
-					break;
-				}
-			}
-		}
-		
-		if (nextEntry) {
-			entry = nextEntry;
-			if (!entry->valid)
-				ReadDirectory(entry);
-			pathIndex += name.length();
-			if (pathIndex < pathLength && path[pathIndex] == '/')
-				++pathIndex;
-
-			if (pathLength <= pathIndex)
-				return entry;
-		} else {
-			if (catchError)
-				ERROR_LOG(FILESYS, "File '%s' not found", path.c_str());
+	std::string fullPath = path.substr(pathIndex);
+	// A single trailing slash is allowed, even after a file.
+	if (fullPath.back() == '/')
+		fullPath.pop_back();
 
-			return 0;
-		}
+	TreeEntry *entry = LookupPath(fullPath);
+	if (!entry && catchError)
+		ERROR_LOG(FILESYS, "File '%s' not found", path.c_str());
+	return entry;
+}
+
+ISOFileSystem::TreeEntry *ISOFileSystem::LookupPath(const std::string &path) {
+	auto it = pathIndex_.find(path);
+	if (it == pathIndex_.end()) {
+		// Not indexed yet, unless it doesn't exist. Read the parent directory, if we haven't already.
+		size_t slash = path.find_last_of('/');
+		TreeEntry *parent = slash == path.npos ? treeroot : LookupPath(path.substr(0, slash));
+		if (!parent || parent->valid)
+			return nullptr;
+		ReadDirectory(parent);
+		it = pathIndex_.find(path);
+		if (it == pathIndex_.end())
+			return nullptr;
 	}
+
+	TreeEntry *entry = it->second;
+	if (!entry->valid)
+		ReadDirectory(entry);
+	return entry;
 }
 
 int ISOFileSystem::OpenFile(std::string filename, FileAccess access, const char *devicename) {
@@ -341,6 +339,7 @@ int ISOFileSystem::OpenFile(std::string filename, FileAccess access, const char
 		if (strncmp(devicename, "umd0:", 5) == 0 || strncmp(devicename, "umd1:", 5) == 0)
 			entry.isBlockSectorMode = true;
 
+		std::lock_guard<std::mutex> guard(entriesLock_);
 		entries[newHandle] = entry;
 		return newHandle;
 	}
@@ -357,11 +356,13 @@ int ISOFileSystem::OpenFile(std::string filename, FileAccess access, const char
 	entry.seekPos = 0;
 
 	u32 newHandle = hAlloc->GetNewHandle();
+	std::lock_guard<std::mutex> guard(entriesLock_);
 	entries[newHandle] = entry;
 	return newHandle;
 }
 
 void ISOFileSystem::CloseFile(u32 handle) {
+	std::lock_guard<std::mutex> guard(entriesLock_);
 	EntryMap::iterator iter = entries.find(handle);
 	if (iter != entries.end()) {
 		//CloseHandle((*iter).second.hFile);
@@ -374,11 +375,13 @@ void ISOFileSystem::CloseFile(u32 handle) {
 }
 
 bool ISOFileSystem::OwnsHandle(u32 handle) {
+	std::lock_guard<std::mutex> guard(entriesLock_);
 	EntryMap::iterator iter = entries.find(handle);
 	return (iter != entries.end());
 }
 
 int ISOFileSystem::Ioctl(u32 handle, u32 cmd, u32 indataPtr, u32 inlen, u32 outdataPtr, u32 outlen, int &usec) {
+	std::unique_lock<std::mutex> guard(entriesLock_);
 	EntryMap::iterator iter = entries.find(handle);
 	if (iter == entries.end()) {
 		ERROR_LOG(FILESYS, "Ioctl on a bad file handle");
@@ -386,6 +389,7 @@ int ISOFileSystem::Ioctl(u32 handle, u32 cmd, u32 indataPtr, u32 inlen, u32 outd
 	}
 
 	OpenFileEntry &e = iter->second;
+	guard.unlock();
 
 	switch (cmd) {
 	// Get ISO9660 volume descriptor (from open ISO9660 file.)
@@ -438,6 +442,7 @@ int ISOFileSystem::Ioctl(u32 handle, u32 cmd, u32 indataPtr, u32 inlen, u32 outd
 }
 
 PSPDevType ISOFileSystem::DevType(u32 handle) {
+	std::lock_guard<std::mutex> guard(entriesLock_);
 	EntryMap::iterator iter = entries.find(handle);
 	if (iter == entries.end())
 		return PSPDevType::FILE;
@@ -450,7 +455,8 @@ PSPDevType ISOFileSystem::DevType(u32 handle) {
 FileSystemFlags ISOFileSystem::Flags() {
 	// TODO: Here may be a good place to force things, in case users recompress games
 	// as PBP or CSO when they were originally the other type.
-	return blockDevice->IsDisc() ? FileSystemFlags::UMD : FileSystemFlags::CARD;
+	FileSystemFlags flags = blockDevice->IsDisc() ? FileSystemFlags::UMD : FileSystemFlags::CARD;
+	return flags | FileSystemFlags::CONCURRENT_READS;
 }
 
 size_t ISOFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size)
@@ -460,6 +466,9 @@ size_t ISOFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size)
 }
 
 size_t ISOFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &usec) {
+	// Only the handle bookkeeping is locked, so reads on different handles can overlap.
+	// The entry itself stays put: only this handle's own CloseFile removes it.
+	std::unique_lock<std::mutex> guard(entriesLock_);
 	EntryMap::iterator iter = entries.find(handle);
 	if (iter != entries.end()) {
 		OpenFileEntry &e = iter->second;
@@ -471,13 +480,16 @@ size_t ISOFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &usec) {
 		
 		if (e.isBlockSectorMode) {
 			// Whole sectors! Shortcut to this simple code.
-			blockDevice->ReadBlocks(e.seekPos, (int)size, pointer);
-			if (abs((int)lastReadBlock_ - (int)e.seekPos) > 100) {
+			const u32 seekPos = e.seekPos;
+			if (abs((int)lastReadBlock_ - (int)seekPos) > 100) {
 				// This is an estimate, sometimes it takes 1+ seconds, but it definitely takes time.
 				usec = 100000;
 			}
+			lastReadBlock_ = seekPos + (int)size;
+			guard.unlock();
+
+			blockDevice->ReadBlocks(seekPos, (int)size, pointer);
 			e.seekPos += (int)size;
-			lastReadBlock_ = e.seekPos;
 			return (int)size;
 		}
 
@@ -523,30 +535,44 @@ size_t ISOFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &usec) {
 			ERROR_LOG(FILESYS, "Remaining size should be aligned");
 		}
 
-		const u8 *const start = pointer;
-		if (firstBlockSize > 0) {
-			blockDevice->ReadBlock(secNum++, theSector);
-			memcpy(pointer, theSector + firstBlockOffset, firstBlockSize);
-			pointer += firstBlockSize;
-		}
-		if (middleSize > 0) {
-			const u32 sectors = (u32)(middleSize / 2048);
-			blockDevice->ReadBlocks(secNum, sectors, pointer);
-			secNum += sectors;
-			pointer += middleSize;
+		const u32 endSecNum = secNum + (firstBlockSize > 0 ? 1 : 0) + (u32)(middleSize / 2048) + (lastBlockSize > 0 ? 1 : 0);
+		if (abs((int)lastReadBlock_ - (int)endSecNum) > 100) {
+			// This is an estimate, sometimes it takes 1+ seconds, but it definitely takes time.
+			usec = 100000;
 		}
-		if (lastBlockSize > 0) {
-			blockDevice->ReadBlock(secNum++, theSector);
-			memcpy(pointer, theSector, lastBlockSize);
-			pointer += lastBlockSize;
+		lastReadBlock_ = endSecNum;
+		guard.unlock();
+
+		// Whole sectors go straight to the destination, only the partial ones at the ends are bounced.
+		// Those use ReadBlocks too, so small sequential reads still count as sequential for read-ahead.
+		const u8 *const start = pointer;
+		if (firstBlockSize > 0 && middleSize == 0 && lastBlockSize > 0) {
+			// Straddles two sectors, get both in one go.
+			u8 twoSectors[4096];
+			blockDevice->ReadBlocks(secNum, 2, twoSectors);
+			memcpy(pointer, twoSectors + firstBlockOffset, (size_t)size);
+			secNum += 2;
+			pointer += size;
+		} else {
+			if (firstBlockSize > 0) {
+				blockDevice->ReadBlocks(secNum++, 1, theSector);
+				memcpy(pointer, theSector + firstBlockOffset, firstBlockSize);
+				pointer += firstBlockSize;
+			}
+			if (middleSize > 0) {
+				const u32 sectors = (u32)(middleSize / 2048);
+				blockDevice->ReadBlocks(secNum, sectors, pointer);
+				secNum += sectors;
+				pointer += middleSize;
+			}
+			if (lastBlockSize > 0) {
+				blockDevice->ReadBlocks(secNum++, 1, theSector);
+				memcpy(pointer, theSector, lastBlockSize);
+				pointer += lastBlockSize;
+			}
 		}
 
 		size_t totalBytes = pointer - start;
-		if (abs((int)lastReadBlock_ - (int)secNum) > 100) {
-			// This is an estimate, sometimes it takes 1+ seconds, but it definitely takes time.
-			usec = 100000;
-		}
-		lastReadBlock_ = secNum;
 		e.seekPos += (unsigned int)totalBytes;
 		return (size_t)totalBytes;
 	} else {
@@ -567,6 +593,7 @@ size_t ISOFileSystem::WriteFile(u32 handle, const u8 *pointer, s64 size, int &us
 }
 
 size_t ISOFileSystem::SeekFile(u32 handle, s32 position, FileMove type) {
+	std::lock_guard<std::mutex> guard(entriesLock_);
 	EntryMap::iterator iter = entries.find(handle);
 	if (iter != entries.end()) {
 		OpenFileEntry &e = iter->second;
@@ -693,11 +720,14 @@ void ISOFileSystem::DoState(PointerWrap &p) {
 	if (!s)
 		return;
 
+	std::unique_lock<std::mutex> guard(entriesLock_);
 	int n = (int) entries.size();
 	Do(p, n);
 
 	if (p.mode == p.MODE_READ) {
-		entries.clear();
+		// GetFromPath might read directories, which takes the lock.
+		guard.unlock();
+		EntryMap loaded;
 		for (int i = 0; i < n; ++i) {
 			u32 fd = 0;
 			OpenFileEntry of;
@@ -719,8 +749,10 @@ void ISOFileSystem::DoState(PointerWrap &p) {
 				of.file = NULL;
 			}
 
-			entries[fd] = of;
+			loaded[fd] = of;
 		}
+		guard.lock();
+		entries.swap(loaded);
 	} else {
 		for (EntryMap::iterator it = entries.begin(), end = entries.end(); it != end; ++it) {
 			OpenFileEntry &of = it->second;
@@ -20,6 +20,8 @@
 #include <map>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include "FileSystem.h"
 
@@ -85,6 +87,8 @@ class ISOFileSystem : public IFileSystem {
 	};
 
 	typedef std::map<u32,OpenFileEntry> EntryMap;
+	// Protects entries and lastReadBlock_, since ReadFile can run without the MetaFileSystem lock.
+	std::mutex entriesLock_;
 	EntryMap entries;
 	IHandleAllocator *hAlloc;
 	TreeEntry *treeroot;
@@ -92,9 +96,13 @@ class ISOFileSystem : public IFileSystem {
 	u32 lastReadBlock_;
 
 	TreeEntry entireISO;
+	// Full paths (like "PSP_GAME/USRDIR/DATA.BIN") of every entry in the directories read so far.
+	// Directories are still only read when first needed.
+	std::unordered_map<std::string, TreeEntry *> pathIndex_;
 
 	void ReadDirectory(TreeEntry *root);
 	TreeEntry *GetFromPath(const std::string &path, bool catchError = true);
+	TreeEntry *LookupPath(const std::string &path);
 	std::string EntryFullPath(TreeEntry *e);
 };
 
@@ -169,10 +169,20 @@ static bool RealPath(const std::string &currentDirectory, const std::string &inP
 IFileSystem *MetaFileSystem::GetHandleOwner(u32 handle)
 {
 	std::lock_guard<std::recursive_mutex> guard(lock);
+	auto cached = handleOwners_.find(handle);
+	if (cached != handleOwners_.end()) {
+		// Handles can be closed behind our back (directly on the filesystem), so double check.
+		if (cached->second->OwnsHandle(handle))
+			return cached->second;
+		handleOwners_.erase(cached);
+	}
+
 	for (size_t i = 0; i < fileSystems.size(); i++)
 	{
-		if (fileSystems[i].system->OwnsHandle(handle))
+		if (fileSystems[i].system->OwnsHandle(handle)) {
+			handleOwners_[handle] = fileSystems[i].system.get();
 			return fileSystems[i].system.get();
+		}
 	}
 
 	// Not found
@@ -185,6 +195,19 @@ int MetaFileSystem::MapFilePath(const std::string &_inpath, std::string &outpath
 	std::lock_guard<std::recursive_mutex> guard(lock);
 	std::string realpath;
 
+	// Absolute paths don't depend on the thread's current directory, so their mapping can be reused.
+	const bool cacheable = _inpath.find(':') != _inpath.npos;
+	if (cacheable) {
+		auto cached = mappedPathIndex_.find(_inpath);
+		if (cached != mappedPathIndex_.end()) {
+			// Move to the front, it's the most recently used now.
+			mappedPaths_.splice(mappedPaths_.begin(), mappedPaths_, cached->second);
+			outpath = cached->second->outpath;
+			*system = &fileSystems[cached->second->mountIndex];
+			return 0;
+		}
+	}
+
 	std::string inpath = _inpath;
 
 	// "ms0:/file.txt" is equivalent to "   ms0:/file.txt".  Yes, really.
@@ -246,6 +269,15 @@ int MetaFileSystem::MapFilePath(const std::string &_inpath, std::string &outpath
 
 				VERBOSE_LOG(FILESYS, "MapFilePath: mapped \"%s\" to prefix: \"%s\", path: \"%s\"", inpath.c_str(), fileSystems[i].prefix.c_str(), outpath.c_str());
 
+				if (cacheable && error != SCE_KERNEL_ERROR_NOCWD) {
+					if (mappedPaths_.size() >= MAPPED_PATH_CACHE_SIZE) {
+						mappedPathIndex_.erase(mappedPaths_.back().inpath);
+						mappedPaths_.pop_back();
+					}
+					mappedPaths_.push_front({ _inpath, outpath, i });
+					mappedPathIndex_[_inpath] = mappedPaths_.begin();
+				}
+
 				return error == SCE_KERNEL_ERROR_NOCWD ? error : 0;
 			}
 		}
@@ -277,6 +309,7 @@ std::string MetaFileSystem::NormalizePrefix(std::string prefix) const {
 
 void MetaFileSystem::Mount(std::string prefix, std::shared_ptr<IFileSystem> system) {
 	std::lock_guard<std::recursive_mutex> guard(lock);
+	InvalidateMountCaches();
 
 	MountPoint x;
 	x.prefix = prefix;
@@ -294,11 +327,15 @@ void MetaFileSystem::Mount(std::string prefix, std::shared_ptr<IFileSystem> syst
 }
 
 void MetaFileSystem::UnmountAll() {
+	std::lock_guard<std::recursive_mutex> guard(lock);
+	InvalidateMountCaches();
 	fileSystems.clear();
 	currentDir.clear();
 }
 
 void MetaFileSystem::Unmount(std::string prefix) {
+	std::lock_guard<std::recursive_mutex> guard(lock);
+	InvalidateMountCaches();
 	for (auto iter = fileSystems.begin(); iter != fileSystems.end(); iter++) {
 		if (iter->prefix == prefix) {
 			fileSystems.erase(iter);
@@ -309,6 +346,7 @@ void MetaFileSystem::Unmount(std::string prefix) {
 
 bool MetaFileSystem::Remount(std::string prefix, std::shared_ptr<IFileSystem> system) {
 	std::lock_guard<std::recursive_mutex> guard(lock);
+	InvalidateMountCaches();
 	for (auto &it : fileSystems) {
 		if (it.prefix == prefix) {
 			it.system = system;
@@ -346,10 +384,12 @@ int MetaFileSystem::OpenFile(std::string filename, FileAccess access, const char
 	std::string of;
 	MountPoint *mount;
 	int error = MapFilePath(filename, of, &mount);
-	if (error == 0)
-		return mount->system->OpenFile(of, access, mount->prefix.c_str());
-	else
+	if (error != 0)
 		return error;
+	int handle = mount->system->OpenFile(of, access, mount->prefix.c_str());
+	if (handle > 0)
+		handleOwners_[handle] = mount->system.get();
+	return handle;
 }
 
 PSPFileInfo MetaFileSystem::GetFileInfo(std::string filename)
@@ -531,16 +571,19 @@ void MetaFileSystem::CloseFile(u32 handle)
 	IFileSystem *sys = GetHandleOwner(handle);
 	if (sys)
 		sys->CloseFile(handle);
+	handleOwners_.erase(handle);
 }
 
 size_t MetaFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size)
 {
-	std::lock_guard<std::recursive_mutex> guard(lock);
+	std::unique_lock<std::recursive_mutex> guard(lock);
 	IFileSystem *sys = GetHandleOwner(handle);
-	if (sys)
-		return sys->ReadFile(handle, pointer, size);
-	else
+	if (!sys)
 		return 0;
+	// Let reads from other threads (like async reads on other files) overlap.
+	if (sys->Flags() & FileSystemFlags::CONCURRENT_READS)
+		guard.unlock();
+	return sys->ReadFile(handle, pointer, size);
 }
 
 size_t MetaFileSystem::WriteFile(u32 handle, const u8 *pointer, s64 size)
@@ -555,12 +598,13 @@ size_t MetaFileSystem::WriteFile(u32 handle, const u8 *pointer, s64 size)
 
 size_t MetaFileSystem::ReadFile(u32 handle, u8 *pointer, s64 size, int &usec)
 {
-	std::lock_guard<std::recursive_mutex> guard(lock);
+	std::unique_lock<std::recursive_mutex> guard(lock);
 	IFileSystem *sys = GetHandleOwner(handle);
-	if (sys)
-		return sys->ReadFile(handle, pointer, size, usec);
-	else
+	if (!sys)
 		return 0;
+	if (sys->Flags() & FileSystemFlags::CONCURRENT_READS)
+		guard.unlock();
+	return sys->ReadFile(handle, pointer, size, usec);
 }
 
 size_t MetaFileSystem::WriteFile(u32 handle, const u8 *pointer, s64 size, int &usec)
@@ -623,6 +667,8 @@ void MetaFileSystem::DoState(PointerWrap &p)
 		return;
 
 	Do(p, current);
+	// Handles come back from the state, re-learn their owners on use.
+	handleOwners_.clear();
 
 	// Save/load per-thread current directory map
 	Do(p, currentDir);
@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include <list>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <mutex>
 #include <memory>
@@ -45,6 +47,25 @@ class MetaFileSystem : public IHandleAllocator, public IFileSystem {
 	std::string startingDirectory;
 	std::recursive_mutex lock;  // must be recursive
 
+	// Which filesystem owns each handle, filled on open and on first use.  Cleared on mount changes.
+	std::unordered_map<u32, IFileSystem *> handleOwners_;
+
+	// Small LRU of absolute paths to their mount index and path within it.  Cleared on mount changes.
+	struct MappedPath {
+		std::string inpath;
+		std::string outpath;
+		size_t mountIndex;
+	};
+	static const size_t MAPPED_PATH_CACHE_SIZE = 64;
+	std::list<MappedPath> mappedPaths_;
+	std::unordered_map<std::string, std::list<MappedPath>::iterator> mappedPathIndex_;
+
+	void InvalidateMountCaches() {
+		handleOwners_.clear();
+		mappedPaths_.clear();
+		mappedPathIndex_.clear();
+	}
+
 	void Reset() {
 		// This used to be 6, probably an attempt to replicate PSP handles.
 		// However, that's an artifact of using psplink anyway...
@@ -31,6 +31,17 @@
 #include "GPU/GPUInterface.h"
 #include "GPU/GPUState.h"
 
+#ifdef _M_SSE
+#include <emmintrin.h>
+#endif
+#if PPSSPP_ARCH(ARM_NEON)
+#if defined(_MSC_VER) && PPSSPP_ARCH(ARM64)
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
 // These fonts, created by ttf2pgf, don't have complete glyph info and need to be identified.
 static bool isJPCSPFont(const char *fontName) {
 	return !strcmp(fontName, "Liberation Sans") || !strcmp(fontName, "Liberation Serif") || !strcmp(fontName, "Sazanami") || !strcmp(fontName, "UnDotum") || !strcmp(fontName, "Microsoft YaHei");
@@ -177,6 +188,9 @@ void PGF::DoState(PointerWrap &p) {
 		Do(p, shadowGlyphs);
 	}
 	Do(p, firstGlyph);
+
+	if (p.mode == p.MODE_READ)
+		decodedGlyphs.clear();
 }
 
 bool PGF::ReadPtr(const u8 *ptr, size_t dataSize) {
@@ -191,6 +205,7 @@ bool PGF::ReadPtr(const u8 *ptr, size_t dataSize) {
 	ptr += sizeof(header);
 
 	fileName = header.fontName;
+	decodedGlyphs.clear();
 
 	if (header.revision == 3) {
 		memcpy(&rev3extra, ptr, sizeof(rev3extra));
@@ -580,10 +595,6 @@ void PGF::DrawCharacter(const GlyphImage *image, int clipX, int clipY, int clipW
 		return;
 	}
 
-	size_t bitPtr = glyph.ptr * 8;
-	int numberPixels = glyph.w * glyph.h;
-	int pixelIndex = 0;
-
 	int x = image->xPos64 >> 6;
 	int y = image->yPos64 >> 6;
 	u8 xFrac = image->xPos64 & 0x3F;
@@ -599,8 +610,107 @@ void PGF::DrawCharacter(const GlyphImage *image, int clipX, int clipY, int clipW
 	if (clipHeight < 0)
 		clipHeight = 8192;
 
-	// Use a buffer so we can apply subpixel rendering.
-	// TODO: Cache this buffer per glyph?  Maybe even transpose it first?
+	// Decoded once and kept, so we can apply subpixel rendering cheaply.
+	const u8 *decodedPixels = GetDecodedGlyph(glyph);
+
+	auto samplePixel = [&](int xx, int yy) -> u8 {
+		if (xx < 0 || yy < 0 || xx >= glyph.w || yy >= glyph.h) {
+			return 0;
+		}
+		return decodedPixels[yy * glyph.w + xx];
+	};
+
+	const FontPixelFormat pixelFormat = (FontPixelFormat)(u32)image->pixelFormat;
+	static const u8 fontPixelSizeInBytes[] = { 0, 0, 1, 3, 4 }; // 0 means 2 pixels per byte
+	if ((u32)pixelFormat >= ARRAY_SIZE(fontPixelSizeInBytes)) {
+		return;
+	}
+	const int bpl = image->bytesPerLine;
+	const int pixelBytes = fontPixelSizeInBytes[pixelFormat];
+	const int bufMaxWidth = std::min((int)image->bufWidth, pixelBytes == 0 ? bpl * 2 : bpl / pixelBytes);
+
+	int renderX1 = std::max(clipX, x) - x;
+	int renderY1 = std::max(clipY, y) - y;
+	// We can render up to frac beyond the glyph w/h, so add 1px if necessary.
+	int renderX2 = std::min(clipX + clipWidth - x, glyph.w + (xFrac > 0 ? 1 : 0));
+	int renderY2 = std::min(clipY + clipHeight - y, glyph.h + (yFrac > 0 ? 1 : 0));
+
+	// Anything outside the buffer would be dropped pixel by pixel anyway.
+	renderX1 = std::max(renderX1, -x);
+	renderY1 = std::max(renderY1, -y);
+	renderX2 = std::min(renderX2, bufMaxWidth - x);
+	renderY2 = std::min(renderY2, (int)image->bufHeight - y);
+	if (renderX1 >= renderX2 || renderY1 >= renderY2) {
+		return;
+	}
+
+	const int count = renderX2 - renderX1;
+	if ((int)pixelRow.size() < count)
+		pixelRow.resize(count);
+	u8 *row = pixelRow.data();
+
+	for (int yy = renderY1; yy < renderY2; ++yy) {
+		if (xFrac == 0 && yFrac == 0) {
+			if (yy < glyph.h) {
+				// Only the part inside the glyph can be copied directly.
+				int copyEnd = std::min(renderX2, glyph.w);
+				int copied = std::max(copyEnd - renderX1, 0);
+				if (copied > 0)
+					memcpy(row, decodedPixels + yy * glyph.w + renderX1, copied);
+				if (copied < count)
+					memset(row + copied, 0, count - copied);
+			} else {
+				memset(row, 0, count);
+			}
+		} else {
+			for (int xx = renderX1; xx < renderX2; ++xx) {
+				// First, blend horizontally.  Tests show we blend swizzled to 8 bit.
+				u32 horiz1 = samplePixel(xx - 1, yy - 1) * xFrac + samplePixel(xx, yy - 1) * (64 - xFrac);
+				u32 horiz2 = samplePixel(xx - 1, yy + 0) * xFrac + samplePixel(xx, yy + 0) * (64 - xFrac);
+				// Now blend those together vertically.
+				u32 blended = horiz1 * yFrac + horiz2 * (64 - yFrac);
+
+				// We multiplied an 8 bit value by 64 twice, so now we have a 20 bit value.
+				row[xx - renderX1] = blended >> 12;
+			}
+		}
+		SetFontPixelRow(image->bufferPtr, bpl, x + renderX1, y + yy, row, count, pixelFormat);
+	}
+
+	gpu->InvalidateCache(image->bufferPtr, image->bytesPerLine * image->bufHeight, GPU_INVALIDATE_SAFE);
+}
+
+const u8 *PGF::GetDecodedGlyph(const Glyph &glyph) const {
+	// Plenty for a screen of CJK text, a few hundred KB at most.
+	static const size_t MAX_DECODED_GLYPHS = 1024;
+
+	u32 now = ++decodedGlyphsUseCounter;
+	auto it = decodedGlyphs.find(glyph.ptr);
+	if (it != decodedGlyphs.end() && it->second.pixels.size() == (size_t)(glyph.w * glyph.h)) {
+		it->second.lastUsed = now;
+		return it->second.pixels.data();
+	}
+
+	if (decodedGlyphs.size() >= MAX_DECODED_GLYPHS) {
+		// Throw out the least recently used half, so this stays rare.
+		std::vector<u32> ages;
+		ages.reserve(decodedGlyphs.size());
+		for (const auto &entry : decodedGlyphs)
+			ages.push_back(entry.second.lastUsed);
+		std::nth_element(ages.begin(), ages.begin() + ages.size() / 2, ages.end());
+		u32 cutoff = ages[ages.size() / 2];
+		for (auto iter = decodedGlyphs.begin(); iter != decodedGlyphs.end(); ) {
+			if (iter->second.lastUsed < cutoff)
+				iter = decodedGlyphs.erase(iter);
+			else
+				++iter;
+		}
+	}
+
+	size_t bitPtr = glyph.ptr * 8;
+	int numberPixels = glyph.w * glyph.h;
+	int pixelIndex = 0;
+
 	std::vector<u8> decodedPixels;
 	decodedPixels.resize(numberPixels);
 
@@ -626,51 +736,99 @@ void PGF::DrawCharacter(const GlyphImage *image, int clipX, int clipY, int clipW
 		}
 	}
 
-	auto samplePixel = [&](int xx, int yy) -> u8 {
-		if (xx < 0 || yy < 0 || xx >= glyph.w || yy >= glyph.h) {
-			return 0;
+	DecodedGlyph &decoded = decodedGlyphs[glyph.ptr];
+	decoded.lastUsed = now;
+	if ((glyph.flags & FONT_PGF_BMP_OVERLAY) == FONT_PGF_BMP_H_ROWS) {
+		decoded.pixels = std::move(decodedPixels);
+	} else {
+		// Transpose columns into rows so drawing can copy whole rows.
+		decoded.pixels.resize(numberPixels);
+		for (int xx = 0; xx < glyph.w; ++xx) {
+			for (int yy = 0; yy < glyph.h; ++yy) {
+				decoded.pixels[yy * glyph.w + xx] = decodedPixels[xx * glyph.h + yy];
+			}
 		}
+	}
+	return decoded.pixels.data();
+}
 
-		int index;
-		if ((glyph.flags & FONT_PGF_BMP_OVERLAY) == FONT_PGF_BMP_H_ROWS) {
-			index = yy * glyph.w + xx;
-		} else {
-			index = xx * glyph.h + yy;
+void PGF::SetFontPixelRow(u32 base, int bpl, int x, int y, const u8 *pixels, int count, FontPixelFormat pixelformat) const {
+	static const u8 fontPixelSizeInBytes[] = { 0, 0, 1, 3, 4 }; // 0 means 2 pixels per byte
+	int pixelBytes = fontPixelSizeInBytes[pixelformat];
+	u32 rowAddr = base + (y * bpl) + (pixelBytes == 0 ? x / 2 : x * pixelBytes);
+	u32 rowBytes = pixelBytes == 0 ? ((x + count + 1) / 2 - x / 2) : count * pixelBytes;
+
+	if (!Memory::IsValidRange(rowAddr, rowBytes)) {
+		// Let the slow path deal with (and complain about) bad addresses.
+		for (int i = 0; i < count; ++i) {
+			SetFontPixel(base, bpl, x + count, y + 1, x + i, y, pixels[i], pixelformat);
 		}
+		return;
+	}
 
-		return decodedPixels[index];
-	};
+	u8 *dst = Memory::GetPointerUnchecked(rowAddr);
+	switch (pixelformat) {
+	case PSP_FONT_PIXELFORMAT_4:
+	case PSP_FONT_PIXELFORMAT_4_REV:
+		for (int i = 0; i < count; ++i) {
+			// We always get a 8-bit value, so take only the top 4 bits.
+			const u8 pix4 = pixels[i] >> 4;
+			u8 &p = dst[(x + i) / 2 - x / 2];
+			if (((x + i) & 1) != pixelformat) {
+				p = (pix4 << 4) | (p & 0xF);
+			} else {
+				p = (p & 0xF0) | pix4;
+			}
+		}
+		break;
 
-	int renderX1 = std::max(clipX, x) - x;
-	int renderY1 = std::max(clipY, y) - y;
-	// We can render up to frac beyond the glyph w/h, so add 1px if necessary.
-	int renderX2 = std::min(clipX + clipWidth - x, glyph.w + (xFrac > 0 ? 1 : 0));
-	int renderY2 = std::min(clipY + clipHeight - y, glyph.h + (yFrac > 0 ? 1 : 0));
+	case PSP_FONT_PIXELFORMAT_8:
+		memcpy(dst, pixels, count);
+		break;
 
-	if (xFrac == 0 && yFrac == 0) {
-		for (int yy = renderY1; yy < renderY2; ++yy) {
-			for (int xx = renderX1; xx < renderX2; ++xx) {
-				u8 pixelColor = samplePixel(xx, yy);
-				SetFontPixel(image->bufferPtr, image->bytesPerLine, image->bufWidth, image->bufHeight, x + xx, y + yy, pixelColor, (FontPixelFormat)(u32)image->pixelFormat);
-			}
+	case PSP_FONT_PIXELFORMAT_24:
+		for (int i = 0; i < count; ++i) {
+			// Each channel has the same value.
+			dst[i * 3 + 0] = pixels[i];
+			dst[i * 3 + 1] = pixels[i];
+			dst[i * 3 + 2] = pixels[i];
 		}
-	} else {
-		for (int yy = renderY1; yy < renderY2; ++yy) {
-			for (int xx = renderX1; xx < renderX2; ++xx) {
-				// First, blend horizontally.  Tests show we blend swizzled to 8 bit.
-				u32 horiz1 = samplePixel(xx - 1, yy - 1) * xFrac + samplePixel(xx, yy - 1) * (64 - xFrac);
-				u32 horiz2 = samplePixel(xx - 1, yy + 0) * xFrac + samplePixel(xx, yy + 0) * (64 - xFrac);
-				// Now blend those together vertically.
-				u32 blended = horiz1 * yFrac + horiz2 * (64 - yFrac);
+		break;
 
-				// We multiplied an 8 bit value by 64 twice, so now we have a 20 bit value.
-				u8 pixelColor = blended >> 12;
-				SetFontPixel(image->bufferPtr, image->bytesPerLine, image->bufWidth, image->bufHeight, x + xx, y + yy, pixelColor, (FontPixelFormat)(u32)image->pixelFormat);
+	case PSP_FONT_PIXELFORMAT_32:
+		{
+			int i = 0;
+#if defined(_M_SSE)
+			for (; i + 16 <= count; i += 16) {
+				// Spread each byte out to all four channels.
+				__m128i pix8 = _mm_loadu_si128((const __m128i *)(pixels + i));
+				__m128i lo16 = _mm_unpacklo_epi8(pix8, pix8);
+				__m128i hi16 = _mm_unpackhi_epi8(pix8, pix8);
+				_mm_storeu_si128((__m128i *)(dst + i * 4 + 0), _mm_unpacklo_epi16(lo16, lo16));
+				_mm_storeu_si128((__m128i *)(dst + i * 4 + 16), _mm_unpackhi_epi16(lo16, lo16));
+				_mm_storeu_si128((__m128i *)(dst + i * 4 + 32), _mm_unpacklo_epi16(hi16, hi16));
+				_mm_storeu_si128((__m128i *)(dst + i * 4 + 48), _mm_unpackhi_epi16(hi16, hi16));
+			}
+#elif PPSSPP_ARCH(ARM_NEON)
+			for (; i + 16 <= count; i += 16) {
+				uint8x16x4_t pix;
+				pix.val[0] = vld1q_u8(pixels + i);
+				pix.val[1] = pix.val[0];
+				pix.val[2] = pix.val[0];
+				pix.val[3] = pix.val[0];
+				vst4q_u8(dst + i * 4, pix);
+			}
+#endif
+			for (; i < count; ++i) {
+				// Spread the 8 bits out into one write of 32 bits.
+				u32 pix32 = pixels[i];
+				pix32 |= pix32 << 8;
+				pix32 |= pix32 << 16;
+				memcpy(dst + i * 4, &pix32, 4);
 			}
 		}
+		break;
 	}
-
-	gpu->InvalidateCache(image->bufferPtr, image->bytesPerLine * image->bufHeight, GPU_INVALIDATE_SAFE);
 }
 
 void PGF::SetFontPixel(u32 base, int bpl, int bufWidth, int bufHeight, int x, int y, u8 pixelColor, FontPixelFormat pixelformat) const {
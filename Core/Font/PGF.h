@@ -20,6 +20,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -280,7 +281,9 @@ class PGF {
 	// Unused
 	int GetCharIndex(int charCode, const std::vector<int> &charmapCompressed);
 
+	const u8 *GetDecodedGlyph(const Glyph &glyph) const;
 	void SetFontPixel(u32 base, int bpl, int bufWidth, int bufHeight, int x, int y, u8 pixelColor, FontPixelFormat pixelformat) const;
+	void SetFontPixelRow(u32 base, int bpl, int x, int y, const u8 *pixels, int count, FontPixelFormat pixelformat) const;
 
 	PGFHeaderRev3Extra rev3extra;
 
@@ -305,4 +308,15 @@ class PGF {
 	std::vector<Glyph> glyphs;
 	std::vector<Glyph> shadowGlyphs;
 	int firstGlyph;
+
+	struct DecodedGlyph {
+		// Always row major (H_ROWS), one byte per pixel.
+		std::vector<u8> pixels;
+		u32 lastUsed;
+	};
+
+	// Decoded bitmaps by glyph.ptr.  Not savestated, rebuilt on demand.
+	mutable std::unordered_map<u32, DecodedGlyph> decodedGlyphs;
+	mutable u32 decodedGlyphsUseCounter = 0;
+	mutable std::vector<u8> pixelRow;
 };
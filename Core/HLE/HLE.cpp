@@ -15,8 +15,11 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
 #include <cstdarg>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
@@ -24,6 +27,8 @@
 
 #include "Common/Log.h"
 #include "Common/Serialize/SerializeFuncs.h"
+#include "Common/Serialize/SerializeMap.h"
+#include "Common/Thread/Promise.h"
 #include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/Core.h"
@@ -42,6 +47,9 @@
 #include "Core/HLE/sceKernelThread.h"
 #include "Core/HLE/sceKernelInterrupt.h"
 #include "Core/HLE/HLE.h"
+#include "Core/HLE/HLETrace.h"
+#include "GPU/GPU.h"
+#include "GPU/GPUInterface.h"
 
 enum
 {
@@ -65,6 +73,7 @@ enum
 
 static std::vector<HLEModule> moduleDB;
 static int delayedResultEvent = -1;
+static int asyncResultEvent = -1;
 static int hleAfterSyscall = HLE_AFTER_NOTHING;
 static const char *hleAfterSyscallReschedReason;
 static const HLEFunction *latestSyscall = nullptr;
@@ -98,6 +107,12 @@ static std::vector<HLEMipsCallInfo> enqueuedMipsCalls;
 // Does need to be saved, referenced by the stack and owned.
 static std::vector<PSPAction *> mipsCallActions;
 
+// Host work still running, by job id. Never saved, finished early instead.
+static std::map<int, Promise<HLEAsyncWork *> *> asyncJobs;
+// Results of work finished early for a savestate, waiting for their event.
+static std::map<int, u32> asyncResults;
+static int nextAsyncJobID = 1;
+
 void hleDelayResultFinish(u64 userdata, int cycleslate)
 {
 	u32 error;
@@ -116,14 +131,75 @@ void hleDelayResultFinish(u64 userdata, int cycleslate)
 		WARN_LOG(HLE, "Someone else woke up HLE-blocked thread %d?", threadID);
 }
 
+static u32 FinishAsyncJob(int jobID) {
+	auto resultIter = asyncResults.find(jobID);
+	if (resultIter != asyncResults.end()) {
+		u32 result = resultIter->second;
+		asyncResults.erase(resultIter);
+		return result;
+	}
+
+	auto jobIter = asyncJobs.find(jobID);
+	if (jobIter == asyncJobs.end()) {
+		ERROR_LOG(HLE, "Missing HLE async job %d", jobID);
+		return 0;
+	}
+
+	// Usually already done, the worker had the whole delay to run it.
+	Promise<HLEAsyncWork *> *promise = jobIter->second;
+	asyncJobs.erase(jobIter);
+	u32 result = promise->BlockUntilReady()->Apply();
+	delete promise;
+	return result;
+}
+
+// Applies all running work now, so the state can be saved without it.
+static void FlushAsyncJobs() {
+	while (!asyncJobs.empty()) {
+		int jobID = asyncJobs.begin()->first;
+		asyncResults[jobID] = FinishAsyncJob(jobID);
+	}
+}
+
+static void DiscardAsyncJobs() {
+	for (auto &it : asyncJobs) {
+		it.second->BlockUntilReady();
+		delete it.second;
+	}
+	asyncJobs.clear();
+	asyncResults.clear();
+}
+
+static void hleAsyncResultFinish(u64 userdata, int cycleslate) {
+	int jobID = (int)(userdata >> 32);
+	SceUID threadID = (SceUID)(userdata & 0xFFFFFFFF);
+	// Applied even if the thread went away, the hardware would've finished too.
+	u32 result = FinishAsyncJob(jobID);
+
+	u32 error;
+	SceUID verify = __KernelGetWaitID(threadID, WAITTYPE_HLEDELAY, error);
+	if (error == 0 && verify == 1) {
+		__KernelResumeThreadFromWait(threadID, result);
+		__KernelReSchedule("woke from hle async");
+	} else {
+		WARN_LOG(HLE, "Someone else woke up HLE-blocked thread %d?", threadID);
+	}
+}
+
 void HLEInit() {
 	RegisterAllModules();
 	delayedResultEvent = CoreTiming::RegisterEvent("HLEDelayedResult", hleDelayResultFinish);
+	asyncResultEvent = CoreTiming::RegisterEvent("HLEAsyncResult", hleAsyncResultFinish);
+	nextAsyncJobID = 1;
 	idleOp = GetSyscallOp("FakeSysCalls", NID_IDLE);
+
+	// Stays running across HLEShutdown/HLEInit on loadexec, the tables don't change.
+	if (g_Config.bHLETrace && !hleTraceActive)
+		HLETraceStart(GetSysDirectory(DIRECTORY_DUMP) / "hletrace.bin", g_Config.iHLETraceEntries, moduleDB);
 }
 
 void HLEDoState(PointerWrap &p) {
-	auto s = p.Section("HLE", 1, 2);
+	auto s = p.Section("HLE", 1, 3);
 	if (!s)
 		return;
 
@@ -150,6 +226,21 @@ void HLEDoState(PointerWrap &p) {
 			}
 		}
 	}
+
+	if (p.mode == p.MODE_READ)
+		DiscardAsyncJobs();
+	else
+		FlushAsyncJobs();
+
+	if (s >= 3) {
+		Do(p, asyncResultEvent);
+		Do(p, nextAsyncJobID);
+		Do(p, asyncResults);
+	} else {
+		asyncResultEvent = -1;
+		nextAsyncJobID = 1;
+	}
+	CoreTiming::RestoreRegisterEvent(asyncResultEvent, "HLEAsyncResult", hleAsyncResultFinish);
 }
 
 void HLEShutdown() {
@@ -158,6 +249,7 @@ void HLEShutdown() {
 	latestSyscallPC = 0;
 	moduleDB.clear();
 	enqueuedMipsCalls.clear();
+	DiscardAsyncJobs();
 	for (auto p : mipsCallActions) {
 		delete p;
 	}
@@ -394,6 +486,32 @@ u64 hleDelayResult(u64 result, const char *reason, int usec) {
 	return result;
 }
 
+u32 hleDelayResultAsync(HLEAsyncWork *work, const char *reason, int usec) {
+	if (!__KernelIsDispatchEnabled()) {
+		WARN_LOG(HLE, "%s: Dispatch disabled, running HLE work synchronously", latestSyscall ? latestSyscall->name : "?");
+		work->Run();
+		u32 result = work->Apply();
+		delete work;
+		return result;
+	}
+
+	SceUID thread = __KernelGetCurThread();
+	if (KernelIsThreadWaiting(thread))
+		ERROR_LOG(HLE, "%s: Delaying a thread that's already waiting", latestSyscall ? latestSyscall->name : "?");
+
+	int jobID = nextAsyncJobID++;
+	asyncJobs[jobID] = Promise<HLEAsyncWork *>::Spawn(&g_threadManager, [work]() {
+		work->Run();
+		return work;
+	}, TaskType::CPU_COMPUTE);
+
+	u64 param = ((u64)(u32)jobID << 32) | (u32)thread;
+	CoreTiming::ScheduleEvent(usToCycles(usec), asyncResultEvent, param);
+	__KernelWaitCurThread(WAITTYPE_HLEDELAY, 1, 0, 0, false, reason);
+	// The real result is set when the thread wakes up.
+	return 0;
+}
+
 void hleEatCycles(int cycles) {
 	// Maybe this should Idle, at least for larger delays?  Could that cause issues?
 	currentMIPS->downcount -= cycles;
@@ -628,6 +746,9 @@ inline void CallSyscallWithFlags(const HLEFunction *info)
 {
 	latestSyscall = info;
 	latestSyscallPC = currentMIPS->pc;
+	// HLE may read memory or GE state the threaded GE writes, so it must catch up first.
+	if (gpu)
+		gpu->SyncThread();
 	const u32 flags = info->flags;
 
 	if (flags & HLE_CLEAR_STACK_BYTES) {
@@ -637,6 +758,7 @@ inline void CallSyscallWithFlags(const HLEFunction *info)
 		}
 	}
 
+	HLETraceRecord *traceRecord = hleTraceActive ? HLETraceCall(info, latestSyscallPC) : nullptr;
 	if ((flags & HLE_NOT_DISPATCH_SUSPENDED) && !__KernelIsDispatchEnabled()) {
 		RETURN(hleLogDebug(HLE, SCE_KERNEL_ERROR_CAN_NOT_WAIT, "dispatch suspended"));
 	} else if ((flags & HLE_NOT_IN_INTERRUPT) && __IsInInterrupt()) {
@@ -644,6 +766,9 @@ inline void CallSyscallWithFlags(const HLEFunction *info)
 	} else {
 		info->func();
 	}
+	// Before rescheduling, which would switch the registers to another thread.
+	if (traceRecord)
+		HLETraceReturn(traceRecord);
 
 	if (hleAfterSyscall != HLE_AFTER_NOTHING)
 		hleFinishSyscall(*info);
@@ -655,7 +780,17 @@ inline void CallSyscallWithoutFlags(const HLEFunction *info)
 {
 	latestSyscall = info;
 	latestSyscallPC = currentMIPS->pc;
-	info->func();
+	// HLE may read memory or GE state the threaded GE writes, so it must catch up first.
+	if (gpu)
+		gpu->SyncThread();
+	if (hleTraceActive) {
+		HLETraceRecord *traceRecord = HLETraceCall(info, latestSyscallPC);
+		info->func();
+		if (traceRecord)
+			HLETraceReturn(traceRecord);
+	} else {
+		info->func();
+	}
 
 	if (hleAfterSyscall != HLE_AFTER_NOTHING)
 		hleFinishSyscall(*info);
@@ -684,6 +819,7 @@ const HLEFunction *GetSyscallFuncPointer(MIPSOpcode op)
 }
 
 void *GetQuickSyscallFunc(MIPSOpcode op) {
+	// Function stats also enable debug stats, so this covers both.
 	if (coreCollectDebugStats)
 		return nullptr;
 
@@ -700,6 +836,56 @@ void *GetQuickSyscallFunc(MIPSOpcode op) {
 	return (void *)&CallSyscallWithoutFlags;
 }
 
+static bool functionStatsEnabled = false;
+static std::mutex functionStatsLock;
+static std::unordered_map<const HLEFunction *, HLEFunctionStats> functionStats;
+
+void hleSetFunctionStatsEnabled(bool enabled) {
+	if (functionStatsEnabled == enabled)
+		return;
+	if (enabled)
+		hleResetFunctionStats();
+	functionStatsEnabled = enabled;
+	// This makes sure the jit stops skipping CallSyscall.
+	Core_ForceDebugStats(enabled);
+}
+
+bool hleFunctionStatsEnabled() {
+	return functionStatsEnabled;
+}
+
+void hleResetFunctionStats() {
+	std::lock_guard<std::mutex> guard(functionStatsLock);
+	functionStats.clear();
+}
+
+std::vector<HLEFunctionStats> hleGetFunctionStats() {
+	std::vector<HLEFunctionStats> stats;
+	std::unique_lock<std::mutex> guard(functionStatsLock);
+	stats.reserve(functionStats.size());
+	for (const auto &it : functionStats)
+		stats.push_back(it.second);
+	guard.unlock();
+
+	std::sort(stats.begin(), stats.end(), [](const HLEFunctionStats &a, const HLEFunctionStats &b) {
+		return a.totalTime > b.totalTime;
+	});
+	return stats;
+}
+
+static void updateFunctionStats(int modulenum, const HLEFunction *info, double total, s64 cycles) {
+	std::lock_guard<std::mutex> guard(functionStatsLock);
+	HLEFunctionStats &stats = functionStats[info];
+	if (stats.calls == 0) {
+		stats.moduleName = moduleDB[modulenum].name;
+		stats.func = info;
+	}
+	stats.calls++;
+	stats.totalTime += total;
+	stats.maxTime = std::max(stats.maxTime, total);
+	stats.cycles += cycles;
+}
+
 static double hleSteppingTime = 0.0;
 void hleSetSteppingTime(double t) {
 	hleSteppingTime += t;
@@ -714,8 +900,10 @@ void CallSyscall(MIPSOpcode op)
 {
 	PROFILE_THIS_SCOPE("syscall");
 	double start = 0.0;  // need to initialize to fix the race condition where coreCollectDebugStats is enabled in the middle of this func.
+	s64 startTicks = 0;
 	if (coreCollectDebugStats) {
 		start = time_now_d();
+		startTicks = CoreTiming::GetTicks();
 	}
 
 	const HLEFunction *info = GetSyscallFuncPointer(op);
@@ -748,6 +936,8 @@ void CallSyscall(MIPSOpcode op)
 		hleSteppingTime = 0.0;
 		hleFlipTime = 0.0;
 		updateSyscallStats(modulenum, funcnum, total);
+		if (functionStatsEnabled && op != idleOp)
+			updateFunctionStats(modulenum, info, total, CoreTiming::GetTicks() - startTicks);
 	}
 }
 
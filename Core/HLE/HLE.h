@@ -20,6 +20,7 @@
 #include <cstdio>
 #include <cstdarg>
 #include <type_traits>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/Log.h"
@@ -81,6 +82,18 @@ struct HLEModule
 
 typedef char SyscallModuleName[32];
 
+struct HLEFunctionStats
+{
+	const char *moduleName;
+	const HLEFunction *func;
+	u64 calls;
+	// Host time in seconds, not counting time spent stepping or in the frame limiter.
+	double totalTime;
+	double maxTime;
+	// Emulated cycles eaten during the call (delayed results are not included.)
+	s64 cycles;
+};
+
 struct Syscall
 {
 	SyscallModuleName moduleName;
@@ -130,6 +143,29 @@ u64 hleDelayResult(u64 result, const char *reason, int usec);
 void hleEatCycles(int cycles);
 void hleEatMicro(int usec);
 
+// Host side work for a call the PSP ran on the Media Engine, like a decode.
+class HLEAsyncWork {
+public:
+	virtual ~HLEAsyncWork() {}
+	// Runs on a worker thread. Must not touch emulated state, copy the input when creating the work.
+	virtual void Run() = 0;
+	// Runs on the emu thread when the delay is over. Writes the output and returns the syscall result.
+	virtual u32 Apply() = 0;
+};
+
+// Like hleDelayResult, but the result comes from work run on a worker thread meanwhile.
+// The work is always applied when usec has passed in emulated time, so it's deterministic
+// (it's waited for if still running.) Takes ownership of work.
+u32 hleDelayResultAsync(HLEAsyncWork *work, const char *reason, int usec);
+
+// Per-function call counters. These force every syscall through CallSyscall, so they're off by default.
+// Counting starts with the next frame after enabling.
+void hleSetFunctionStatsEnabled(bool enabled);
+bool hleFunctionStatsEnabled();
+void hleResetFunctionStats();
+// Sorted by total host time, slowest first.
+std::vector<HLEFunctionStats> hleGetFunctionStats();
+
 inline int hleDelayResult(int result, const char *reason, int usec)
 {
 	return hleDelayResult((u32) result, reason, usec);
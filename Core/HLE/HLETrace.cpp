@@ -0,0 +1,205 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include "Common/CommonWindows.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "Common/Log.h"
+#include "Common/File/FileUtil.h"
+#include "Core/CoreTiming.h"
+#include "Core/MIPS/MIPS.h"
+#include "Core/HLE/HLE.h"
+#include "Core/HLE/HLETrace.h"
+#include "Core/HLE/sceKernelThread.h"
+
+bool hleTraceActive = false;
+
+static u8 *traceBase;
+static size_t traceSize;
+static HLETraceHeader *traceHeader;
+static HLETraceRecord *traceRecords;
+// Module and function index of each function, packed, for the records.
+static std::unordered_map<const HLEFunction *, u32> traceFuncIndex;
+
+#ifdef _WIN32
+static HANDLE traceFile = INVALID_HANDLE_VALUE;
+static HANDLE traceMapping = nullptr;
+#else
+static int traceFd = -1;
+#endif
+
+static void AppendString(std::string &table, const char *str) {
+	size_t len = std::min(strlen(str ? str : ""), (size_t)255);
+	table.push_back((char)len);
+	table.append(str ? str : "", len);
+}
+
+template <typename T>
+static void AppendValue(std::string &table, T value) {
+	table.append((const char *)&value, sizeof(value));
+}
+
+static bool MapTraceFile(const Path &filename, size_t size) {
+#if PPSSPP_PLATFORM(UWP)
+	return false;
+#elif defined(_WIN32)
+	traceFile = CreateFileW(filename.ToWString().c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (traceFile == INVALID_HANDLE_VALUE)
+		return false;
+	traceMapping = CreateFileMappingW(traceFile, nullptr, PAGE_READWRITE, (DWORD)((u64)size >> 32), (DWORD)size, nullptr);
+	if (traceMapping)
+		traceBase = (u8 *)MapViewOfFile(traceMapping, FILE_MAP_WRITE, 0, 0, size);
+	return traceBase != nullptr;
+#else
+	traceFd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (traceFd == -1)
+		return false;
+	if (ftruncate(traceFd, size) != 0)
+		return false;
+	void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, traceFd, 0);
+	if (base != MAP_FAILED)
+		traceBase = (u8 *)base;
+	return traceBase != nullptr;
+#endif
+}
+
+static void UnmapTraceFile() {
+#ifdef _WIN32
+	if (traceBase)
+		UnmapViewOfFile(traceBase);
+	if (traceMapping)
+		CloseHandle(traceMapping);
+	if (traceFile != INVALID_HANDLE_VALUE)
+		CloseHandle(traceFile);
+	traceMapping = nullptr;
+	traceFile = INVALID_HANDLE_VALUE;
+#else
+	if (traceBase)
+		munmap(traceBase, traceSize);
+	if (traceFd != -1)
+		close(traceFd);
+	traceFd = -1;
+#endif
+	traceBase = nullptr;
+}
+
+bool HLETraceStart(const Path &filename, int capacity, const std::vector<HLEModule> &modules) {
+	if (hleTraceActive)
+		return true;
+	// Content URIs can't be mapped.
+	if (filename.Type() != PathType::NATIVE || capacity <= 0)
+		return false;
+
+	std::string table;
+	traceFuncIndex.clear();
+	for (size_t m = 0; m < modules.size(); ++m) {
+		const HLEModule &module = modules[m];
+		AppendValue(table, (u16)module.numFunctions);
+		AppendString(table, module.name);
+		for (int f = 0; f < module.numFunctions; ++f) {
+			const HLEFunction &func = module.funcTable[f];
+			AppendValue(table, func.ID);
+			AppendString(table, func.name);
+			table.push_back(func.retmask);
+			AppendString(table, func.argmask);
+			traceFuncIndex[&func] = ((u32)m << 16) | (u32)f;
+		}
+	}
+
+	File::CreateFullPath(filename.NavigateUp());
+	// Keep the previous trace, it's likely the one with the crash.
+	if (File::Exists(filename)) {
+		Path previous = filename.WithReplacedExtension(".prev.bin");
+		File::Delete(previous);
+		File::Rename(filename, previous);
+	}
+
+	u32 tableOffset = (u32)sizeof(HLETraceHeader);
+	u32 recordsOffset = (tableOffset + (u32)table.size() + 63) & ~63;
+	traceSize = recordsOffset + (size_t)capacity * sizeof(HLETraceRecord);
+	if (!MapTraceFile(filename, traceSize)) {
+		ERROR_LOG(HLE, "Unable to create HLE trace file %s", filename.c_str());
+		UnmapTraceFile();
+		return false;
+	}
+
+	traceHeader = (HLETraceHeader *)traceBase;
+	memset(traceHeader, 0, sizeof(HLETraceHeader));
+	memcpy(traceHeader->magic, "PHLT", 4);
+	traceHeader->version = 1;
+	traceHeader->recordSize = (u32)sizeof(HLETraceRecord);
+	traceHeader->capacity = (u32)capacity;
+	traceHeader->tableOffset = tableOffset;
+	traceHeader->tableSize = (u32)table.size();
+	traceHeader->recordsOffset = recordsOffset;
+	traceHeader->startTime = (u64)time(nullptr);
+	memcpy(traceBase + tableOffset, table.data(), table.size());
+	traceRecords = (HLETraceRecord *)(traceBase + recordsOffset);
+
+	INFO_LOG(HLE, "Tracing syscalls to %s (%d entries)", filename.c_str(), capacity);
+	hleTraceActive = true;
+	return true;
+}
+
+void HLETraceStop() {
+	if (!hleTraceActive)
+		return;
+	hleTraceActive = false;
+	UnmapTraceFile();
+	traceHeader = nullptr;
+	traceRecords = nullptr;
+	traceFuncIndex.clear();
+}
+
+HLETraceRecord *HLETraceCall(const HLEFunction *func, u32 pc) {
+	auto index = traceFuncIndex.find(func);
+	if (index == traceFuncIndex.end())
+		return nullptr;
+
+	u64 written = traceHeader->written;
+	HLETraceRecord *record = &traceRecords[written % traceHeader->capacity];
+	record->ticks = (u64)CoreTiming::GetTicks();
+	record->pc = pc;
+	record->threadID = (u32)__KernelGetCurThread();
+	record->module = (u16)(index->second >> 16);
+	record->func = (u16)(index->second & 0xFFFF);
+	record->flags = 0;
+	memcpy(record->args, &currentMIPS->r[MIPS_REG_A0], sizeof(record->args));
+	record->v0 = 0;
+	record->v1 = 0;
+	traceHeader->written = written + 1;
+	return record;
+}
+
+void HLETraceReturn(HLETraceRecord *record) {
+	record->v0 = currentMIPS->r[MIPS_REG_V0];
+	record->v1 = currentMIPS->r[MIPS_REG_V1];
+	record->flags |= HLE_TRACE_RETURNED;
+}
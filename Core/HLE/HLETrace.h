@@ -0,0 +1,82 @@
+// Copyright (c) 2012- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File/Path.h"
+
+struct HLEFunction;
+struct HLEModule;
+
+// Binary trace of the most recent syscalls, in a memory mapped ring file. Cheap enough to leave on,
+// and since the OS owns the mapping, the file survives a crash of the emulator. Each call is written
+// on entry and marked complete on return, so after a hang the calls still pending are visible.
+// Decode with Tools/hletrace.
+
+// Only changes at the start and end of emulation.
+extern bool hleTraceActive;
+
+#pragma pack(push, 1)
+struct HLETraceHeader {
+	char magic[4];  // "PHLT"
+	u32 version;
+	u32 recordSize;
+	u32 capacity;
+	// Function table: per module, u16 function count, then the name. Per function, u32 nid, then
+	// the name, the return type char, and the argmask. Strings are a u8 length and the characters.
+	u32 tableOffset;
+	u32 tableSize;
+	u32 recordsOffset;
+	u32 reserved;
+	// Total records ever written. The newest is at (written - 1) % capacity.
+	u64 written;
+	// Unix time when the trace started.
+	u64 startTime;
+	u8 padding[16];
+};
+
+enum {
+	HLE_TRACE_RETURNED = 1,
+};
+
+struct HLETraceRecord {
+	// Emulated time (CoreTiming ticks) at the call.
+	u64 ticks;
+	u32 pc;
+	u32 threadID;
+	u16 module;
+	u16 func;
+	u32 flags;
+	// a0-a7, as passed.
+	u32 args[8];
+	u32 v0;
+	u32 v1;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(HLETraceHeader) == 64, "HLETraceHeader should stay 64 bytes");
+static_assert(sizeof(HLETraceRecord) == 64, "HLETraceRecord should stay 64 bytes");
+
+bool HLETraceStart(const Path &filename, int capacity, const std::vector<HLEModule> &modules);
+void HLETraceStop();
+
+// Returns the record to complete with HLETraceReturn, or nullptr.
+HLETraceRecord *HLETraceCall(const HLEFunction *func, u32 pc);
+void HLETraceReturn(HLETraceRecord *record);
@@ -116,6 +116,16 @@ static int Replace_ceilf() {
 	return 30;  // guess number of cycles
 }
 
+// It's pretty common that games will copy video data.  Only frame sized copies need the tag looked up.
+static void NotifyMemcpyVideo(u32 destPtr, u32 srcPtr, u32 bytes) {
+	if (bytes == 512 * 272 * 4) {
+		const std::string srcTag = GetMemWriteTagAt(srcPtr, bytes);
+		if (srcTag == "VideoDecode" || srcTag == "VideoDecodeRange") {
+			gpu->NotifyVideoUpload(destPtr, bytes, 512, GE_FORMAT_8888);
+		}
+	}
+}
+
 // Should probably do JIT versions of this, possibly ones that only delegate
 // large copies to a C function.
 static int Replace_memcpy() {
@@ -135,7 +145,8 @@ static int Replace_memcpy() {
 			skip = gpu->PerformMemoryCopy(destPtr, srcPtr, bytes);
 		}
 	}
-	if (!skip && bytes != 0) {
+	// Copying onto itself changes nothing, only the GPU might have cared above.
+	if (!skip && bytes != 0 && destPtr != srcPtr) {
 		u8 *dst = Memory::GetPointer(destPtr);
 		const u8 *src = Memory::GetPointer(srcPtr);
 
@@ -156,16 +167,8 @@ static int Replace_memcpy() {
 	}
 	RETURN(destPtr);
 
-	const std::string tag = "ReplaceMemcpy/" + GetMemWriteTagAt(srcPtr, bytes);
-	NotifyMemInfo(MemBlockFlags::READ, srcPtr, bytes, tag.c_str(), tag.size());
-	NotifyMemInfo(MemBlockFlags::WRITE, destPtr, bytes, tag.c_str(), tag.size());
-
-	// It's pretty common that games will copy video data.
-	if (tag == "ReplaceMemcpy/VideoDecode" || tag == "ReplaceMemcpy/VideoDecodeRange") {
-		if (bytes == 512 * 272 * 4) {
-			gpu->NotifyVideoUpload(destPtr, bytes, 512, GE_FORMAT_8888);
-		}
-	}
+	NotifyMemcpyVideo(destPtr, srcPtr, bytes);
+	NotifyMemInfoCopy(destPtr, srcPtr, bytes, "ReplaceMemcpy");
 
 	return 10 + bytes / 4;  // approximation
 }
@@ -185,7 +188,7 @@ static int Replace_memcpy_jak() {
 			skip = gpu->PerformMemoryCopy(destPtr, srcPtr, bytes);
 		}
 	}
-	if (!skip && bytes != 0) {
+	if (!skip && bytes != 0 && destPtr != srcPtr) {
 		u8 *dst = Memory::GetPointer(destPtr);
 		const u8 *src = Memory::GetPointer(srcPtr);
 
@@ -206,16 +209,8 @@ static int Replace_memcpy_jak() {
 	currentMIPS->r[MIPS_REG_A3] = destPtr + bytes;
 	RETURN(destPtr);
 
-	const std::string tag = "ReplaceMemcpy/" + GetMemWriteTagAt(srcPtr, bytes);
-	NotifyMemInfo(MemBlockFlags::READ, srcPtr, bytes, tag.c_str(), tag.size());
-	NotifyMemInfo(MemBlockFlags::WRITE, destPtr, bytes, tag.c_str(), tag.size());
-
-	// It's pretty common that games will copy video data.
-	if (tag == "ReplaceMemcpy/VideoDecode" || tag == "ReplaceMemcpy/VideoDecodeRange") {
-		if (bytes == 512 * 272 * 4) {
-			gpu->NotifyVideoUpload(destPtr, bytes, 512, GE_FORMAT_8888);
-		}
-	}
+	NotifyMemcpyVideo(destPtr, srcPtr, bytes);
+	NotifyMemInfoCopy(destPtr, srcPtr, bytes, "ReplaceMemcpy");
 
 	return 5 + bytes * 8 + 2;  // approximation. This is a slow memcpy - a byte copy loop..
 }
@@ -233,7 +228,7 @@ static int Replace_memcpy16() {
 			skip = gpu->PerformMemoryCopy(destPtr, srcPtr, bytes);
 		}
 	}
-	if (!skip && bytes != 0) {
+	if (!skip && bytes != 0 && destPtr != srcPtr) {
 		u8 *dst = Memory::GetPointer(destPtr);
 		const u8 *src = Memory::GetPointer(srcPtr);
 		if (dst && src) {
@@ -242,9 +237,7 @@ static int Replace_memcpy16() {
 	}
 	RETURN(destPtr);
 
-	const std::string tag = "ReplaceMemcpy16/" + GetMemWriteTagAt(srcPtr, bytes);
-	NotifyMemInfo(MemBlockFlags::READ, srcPtr, bytes, tag.c_str(), tag.size());
-	NotifyMemInfo(MemBlockFlags::WRITE, destPtr, bytes, tag.c_str(), tag.size());
+	NotifyMemInfoCopy(destPtr, srcPtr, bytes, "ReplaceMemcpy16");
 
 	return 10 + bytes / 4;  // approximation
 }
@@ -281,9 +274,7 @@ static int Replace_memcpy_swizzled() {
 
 	RETURN(0);
 
-	const std::string tag = "ReplaceMemcpySwizzle/" + GetMemWriteTagAt(srcPtr, pitch * h);
-	NotifyMemInfo(MemBlockFlags::READ, srcPtr, pitch * h, tag.c_str(), tag.size());
-	NotifyMemInfo(MemBlockFlags::WRITE, destPtr, pitch * h, tag.c_str(), tag.size());
+	NotifyMemInfoCopy(destPtr, srcPtr, pitch * h, "ReplaceMemcpySwizzle");
 
 	return 10 + (pitch * h) / 4;  // approximation
 }
@@ -301,7 +292,7 @@ static int Replace_memmove() {
 			skip = gpu->PerformMemoryCopy(destPtr, srcPtr, bytes);
 		}
 	}
-	if (!skip && bytes != 0) {
+	if (!skip && bytes != 0 && destPtr != srcPtr) {
 		u8 *dst = Memory::GetPointer(destPtr);
 		const u8 *src = Memory::GetPointer(srcPtr);
 		if (dst && src) {
@@ -310,9 +301,7 @@ static int Replace_memmove() {
 	}
 	RETURN(destPtr);
 
-	const std::string tag = "ReplaceMemmove/" + GetMemWriteTagAt(srcPtr, bytes);
-	NotifyMemInfo(MemBlockFlags::READ, srcPtr, bytes, tag.c_str(), tag.size());
-	NotifyMemInfo(MemBlockFlags::WRITE, destPtr, bytes, tag.c_str(), tag.size());
+	NotifyMemInfoCopy(destPtr, srcPtr, bytes, "ReplaceMemmove");
 
 	return 10 + bytes / 4;  // approximation
 }
@@ -369,10 +358,35 @@ static int Replace_memset_jak() {
 	return 5 + bytes * 6 + 2;  // approximation (hm, inspecting the disasm this should be 5 + 6 * bytes + 2, but this is what works..)
 }
 
+// These stop at the end of valid memory, where the game would've crashed anyway.
+static u32 GuestStrnlen(u32 ptr, u32 maxLen) {
+	const char *str = (const char *)Memory::GetPointer(ptr);
+	if (!str)
+		return 0;
+	return (u32)strnlen(str, Memory::ValidSize(ptr, maxLen));
+}
+
+// Like newlib, returns the difference of the first differing bytes, as unsigned chars.
+static int GuestStrncmp(u32 aPtr, u32 bPtr, u32 maxLen, u32 *compared) {
+	const u8 *a = Memory::GetPointer(aPtr);
+	const u8 *b = Memory::GetPointer(bPtr);
+	*compared = 0;
+	if (!a || !b)
+		return 0;
+
+	u32 len = std::min(Memory::ValidSize(aPtr, maxLen), Memory::ValidSize(bPtr, maxLen));
+	for (u32 i = 0; i < len; ++i) {
+		if (a[i] != b[i] || a[i] == 0) {
+			*compared = i + 1;
+			return (int)a[i] - (int)b[i];
+		}
+	}
+	*compared = len;
+	return 0;
+}
+
 static int Replace_strlen() {
-	u32 srcPtr = PARAM(0);
-	const char *src = (const char *)Memory::GetPointer(srcPtr);
-	u32 len = src ? (u32)strlen(src) : 0UL;
+	u32 len = GuestStrnlen(PARAM(0), 0xFFFFFFFF);
 	RETURN(len);
 	return 7 + len * 4;  // approximation
 }
@@ -401,26 +415,15 @@ static int Replace_strncpy() {
 }
 
 static int Replace_strcmp() {
-	const char *a = (const char *)Memory::GetPointer(PARAM(0));
-	const char *b = (const char *)Memory::GetPointer(PARAM(1));
-	if (a && b) {
-		RETURN(strcmp(a, b));
-	} else {
-		RETURN(0);
-	}
-	return 10;  // approximation
+	u32 compared;
+	RETURN(GuestStrncmp(PARAM(0), PARAM(1), 0xFFFFFFFF, &compared));
+	return 10 + compared * 4;  // approximation
 }
 
 static int Replace_strncmp() {
-	const char *a = (const char *)Memory::GetPointer(PARAM(0));
-	const char *b = (const char *)Memory::GetPointer(PARAM(1));
-	u32 bytes = PARAM(2);
-	if (a && b && bytes != 0) {
-		RETURN(strncmp(a, b, bytes));
-	} else {
-		RETURN(0);
-	}
-	return 10 + bytes / 4;  // approximation
+	u32 compared;
+	RETURN(GuestStrncmp(PARAM(0), PARAM(1), PARAM(2), &compared));
+	return 10 + compared * 4;  // approximation
 }
 
 static int Replace_fabsf() {
@@ -1332,7 +1335,8 @@ static const ReplacementTableEntry entries[] = {
 	{ "cosf", &Replace_cosf, 0, REPFLAG_DISABLED },
 	{ "tanf", &Replace_tanf, 0, REPFLAG_DISABLED },
 	{ "atanf", &Replace_atanf, 0, REPFLAG_DISABLED },
-	{ "sqrtf", &Replace_sqrtf, 0, REPFLAG_DISABLED },
+	// Correctly rounded both in libc and on the host, so unlike the others only NaN bits can differ.
+	{ "sqrtf", &Replace_sqrtf, 0, 0 },
 	{ "atan2f", &Replace_atan2f, 0, REPFLAG_DISABLED },
 	{ "floorf", &Replace_floorf, 0, REPFLAG_DISABLED },
 	{ "ceilf", &Replace_ceilf, 0, REPFLAG_DISABLED },
@@ -1344,11 +1348,11 @@ static const ReplacementTableEntry entries[] = {
 	{ "memmove", &Replace_memmove, 0, 0 },
 	{ "memset", &Replace_memset, 0, 0 },
 	{ "memset_jak", &Replace_memset_jak, 0, 0 },
-	{ "strlen", &Replace_strlen, 0, REPFLAG_DISABLED },
+	{ "strlen", &Replace_strlen, 0, 0 },
 	{ "strcpy", &Replace_strcpy, 0, REPFLAG_DISABLED },
 	{ "strncpy", &Replace_strncpy, 0, REPFLAG_DISABLED },
-	{ "strcmp", &Replace_strcmp, 0, REPFLAG_DISABLED },
-	{ "strncmp", &Replace_strncmp, 0, REPFLAG_DISABLED },
+	{ "strcmp", &Replace_strcmp, 0, 0 },
+	{ "strncmp", &Replace_strncmp, 0, 0 },
 	{ "fabsf", &Replace_fabsf, JITFUNC(Replace_fabsf), REPFLAG_ALLOWINLINE | REPFLAG_DISABLED },
 	{ "dl_write_matrix", &Replace_dl_write_matrix, 0, REPFLAG_DISABLED }, // &MIPSComp::Jit::Replace_dl_write_matrix, REPFLAG_DISABLED },
 	{ "dl_write_matrix_2", &Replace_dl_write_matrix, 0, REPFLAG_DISABLED },
@@ -33,6 +33,7 @@
 #include "Core/Host.h"
 #include "Core/MemMapHelpers.h"
 #include "Core/Reporting.h"
+#include "Core/SaveState.h"
 #include "Core/System.h"
 #ifndef MOBILE_DEVICE
 #include "Core/WaveFile.h"
@@ -154,7 +155,9 @@ void __AudioDoState(PointerWrap &p) {
 
 	// TODO: This never happens because maxVer=1.
 	if (s >= 2) {
-		resampler.DoState(p);
+		// Run-ahead snapshots would otherwise drop the queued output every frame.
+		if (!SaveState::IsSnapshotting())
+			resampler.DoState(p);
 	} else {
 		// Only to preserve the previous file format. Might cause a slight audio glitch on upgrades?
 		FixedSizeQueue<s16, 512 * 16> outAudioQueue;
@@ -424,7 +427,8 @@ void __AudioUpdate(bool resetRecording) {
 		memset(mixBuffer, 0, hwBlockSize * 2 * sizeof(s32));
 	}
 
-	if (g_Config.bEnableSound) {
+	// Frames that run-ahead throws away again mustn't be heard.
+	if (g_Config.bEnableSound && !PSP_CoreParameter().runAheadSpeculative) {
 		resampler.PushSamples(mixBuffer, hwBlockSize);
 #ifndef MOBILE_DEVICE
 		if (g_Config.bSaveLoadResetsAVdumping && resetRecording) {
@@ -469,6 +473,10 @@ int __AudioMix(short *outstereo, int numFrames, int sampleRate) {
 	return resampler.Mix(outstereo, numFrames, false, sampleRate);
 }
 
+void __AudioNotifyOutputUnderruns(int count) {
+	resampler.NotifyOutputUnderruns(count);
+}
+
 void __AudioGetDebugStats(char *buf, size_t bufSize) {
 	resampler.GetAudioDebugStats(buf, bufSize);
 }
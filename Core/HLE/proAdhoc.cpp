@@ -51,6 +51,9 @@
 #define TCP_MAXSEG 2
 #endif // defined(HAVE_LIBNX) || PPSSPP_PLATFORM(SWITCH)
 
+#include <algorithm>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <cstring>
 
@@ -403,8 +406,10 @@ void deleteAllAdhocSockets() {
 
 			if (sock->type == SOCK_PTP)
 				fd = sock->data.ptp.id;
-			else if (sock->type == SOCK_PDP)
+			else if (sock->type == SOCK_PDP) {
 				fd = sock->data.pdp.id;
+				stopPdpReceiver(fd);
+			}
 
 			if (fd > 0) {
 				// Close Socket
@@ -2423,3 +2428,287 @@ const char* getMatchingOpcodeStr(int code) {
 	return buf;
 }
 
+// PDP receiving.  A thread moves datagrams from the sockets into a queue per socket, so HLE calls can
+// receive, peek and poll without syscalls or being held up by the network.
+
+// Single producer (the receiver thread), single consumer (the emu thread) queue of whole datagrams.
+class PdpRecvRing {
+public:
+	struct Header {
+		u32 size;
+		u32 padding;
+		sockaddr_in from;
+		double time;
+	};
+
+	explicit PdpRecvRing(size_t capacity) : buf_((capacity + 7) & ~(size_t)7) {}
+
+	bool Push(const sockaddr_in &from, const u8 *data, u32 size, double time) {
+		const size_t cap = buf_.size();
+		const size_t need = RecordSize(size);
+		size_t head = head_.load(std::memory_order_relaxed);
+		const size_t tail = tail_.load(std::memory_order_acquire);
+		size_t offset = head % cap;
+		// Records are never split, the rest of the buffer is skipped instead.
+		const size_t skip = cap - offset < need ? cap - offset : 0;
+		if (need > cap || cap - (head - tail) < skip + need)
+			return false;
+
+		if (skip != 0) {
+			((Header *)&buf_[offset])->size = WRAP_MARKER;
+			head += skip;
+			offset = 0;
+		}
+		Header *header = (Header *)&buf_[offset];
+		header->size = size;
+		header->from = from;
+		header->time = time;
+		memcpy(header + 1, data, size);
+		head_.store(head + need, std::memory_order_release);
+		return true;
+	}
+
+	// Returns nullptr if empty.
+	const Header *Front() {
+		const size_t cap = buf_.size();
+		size_t tail = tail_.load(std::memory_order_relaxed);
+		while (tail != head_.load(std::memory_order_acquire)) {
+			const Header *header = (const Header *)&buf_[tail % cap];
+			if (header->size != WRAP_MARKER)
+				return header;
+			tail += cap - tail % cap;
+			tail_.store(tail, std::memory_order_release);
+		}
+		return nullptr;
+	}
+
+	// Front() must not have returned nullptr.
+	void Pop() {
+		const Header *header = Front();
+		tail_.store(tail_.load(std::memory_order_relaxed) + RecordSize(header->size), std::memory_order_release);
+	}
+
+	u32 Avail(u32 limit) {
+		const size_t cap = buf_.size();
+		size_t tail = tail_.load(std::memory_order_relaxed);
+		const size_t head = head_.load(std::memory_order_acquire);
+		u32 total = 0;
+		while (tail != head) {
+			const Header *header = (const Header *)&buf_[tail % cap];
+			if (header->size == WRAP_MARKER) {
+				tail += cap - tail % cap;
+				continue;
+			}
+			if (total != 0 && total + header->size > limit)
+				break;
+			total += header->size;
+			tail += RecordSize(header->size);
+		}
+		return total;
+	}
+
+private:
+	static const u32 WRAP_MARKER = 0xFFFFFFFF;
+	static_assert(sizeof(Header) % 8 == 0, "Records must stay 8 byte aligned");
+
+	static size_t RecordSize(u32 size) {
+		return sizeof(Header) + ((size + 7) & ~7);
+	}
+
+	std::vector<u8> buf_;
+	// Total bytes ever written and read, the position is this mod the size.
+	std::atomic<size_t> head_{ 0 };
+	std::atomic<size_t> tail_{ 0 };
+};
+
+struct PdpReceiver {
+	PdpReceiver(int s, size_t capacity) : sock(s), ring(capacity) {}
+
+	int sock;
+	PdpRecvRing ring;
+	// Held by the thread while reading, so the socket can be closed safely after stopPdpReceiver.
+	std::mutex ioLock;
+	bool closed = false;
+
+	std::atomic<u64> received{ 0 };
+	std::atomic<u64> dropped{ 0 };
+	// Only touched by the consumer.
+	u64 taken = 0;
+	double waitTotal = 0.0;
+	double waitMax = 0.0;
+};
+
+// Enough for bursts while the game is busy, or the game's own buffer if that's larger.
+static const size_t PDP_RING_MIN_SIZE = 256 * 1024;
+static std::mutex pdpReceiversLock;
+static std::map<int, std::shared_ptr<PdpReceiver>> pdpReceivers;
+static std::mutex pdpReceiverThreadLock;
+static std::thread pdpReceiverThread;
+static std::atomic<bool> pdpReceiverRunning(false);
+
+static void pdpReceiverLoop() {
+	SetCurrentThreadName("AdhocPdpRecv");
+
+	std::vector<std::shared_ptr<PdpReceiver>> receivers;
+	std::vector<u8> datagram(65536);
+	while (pdpReceiverRunning) {
+		receivers.clear();
+		{
+			std::lock_guard<std::mutex> guard(pdpReceiversLock);
+			for (auto &it : pdpReceivers)
+				receivers.push_back(it.second);
+		}
+
+		fd_set readfds;
+		FD_ZERO(&readfds);
+		int maxfd = -1;
+		for (auto &receiver : receivers) {
+			FD_SET(receiver->sock, &readfds);
+			maxfd = std::max(maxfd, receiver->sock);
+		}
+		if (maxfd < 0) {
+			sleep_ms(10);
+			continue;
+		}
+
+		// The timeout is only how quickly new sockets get picked up.
+		timeval tval{ 0, 10000 };
+		int ready = select(maxfd + 1, &readfds, nullptr, nullptr, &tval);
+		if (ready < 0) {
+			// Most likely a socket was just closed.
+			sleep_ms(1);
+			continue;
+		}
+		if (ready == 0)
+			continue;
+
+		double now = time_now_d();
+		for (auto &receiver : receivers) {
+			if (!FD_ISSET(receiver->sock, &readfds))
+				continue;
+			std::lock_guard<std::mutex> guard(receiver->ioLock);
+			if (receiver->closed)
+				continue;
+
+			while (true) {
+				struct sockaddr_in sin;
+				socklen_t sinlen = sizeof(sin);
+				memset(&sin, 0, sinlen);
+				int received = recvfrom(receiver->sock, (char *)&datagram[0], (int)datagram.size(), MSG_NOSIGNAL, (struct sockaddr *)&sin, &sinlen);
+				// Would block, or a harmless ECONNRESET on Windows.
+				if (received < 0)
+					break;
+				receiver->received++;
+				if (!receiver->ring.Push(sin, &datagram[0], received, now))
+					receiver->dropped++;
+			}
+		}
+	}
+}
+
+static std::shared_ptr<PdpReceiver> findPdpReceiver(int sock) {
+	std::lock_guard<std::mutex> guard(pdpReceiversLock);
+	auto it = pdpReceivers.find(sock);
+	return it == pdpReceivers.end() ? nullptr : it->second;
+}
+
+static PdpRecvStats getPdpRecvStats(PdpReceiver *receiver) {
+	PdpRecvStats stats{};
+	stats.received = receiver->received;
+	stats.dropped = receiver->dropped;
+	stats.avgWaitMs = receiver->taken != 0 ? receiver->waitTotal / receiver->taken : 0.0;
+	stats.maxWaitMs = receiver->waitMax;
+	return stats;
+}
+
+void startPdpReceiver(int sock, u32 bufferSize) {
+	std::lock_guard<std::mutex> threadGuard(pdpReceiverThreadLock);
+	{
+		std::lock_guard<std::mutex> guard(pdpReceiversLock);
+		pdpReceivers[sock] = std::make_shared<PdpReceiver>(sock, std::max(PDP_RING_MIN_SIZE, (size_t)bufferSize * 4));
+	}
+	if (!pdpReceiverRunning) {
+		pdpReceiverRunning = true;
+		pdpReceiverThread = std::thread(pdpReceiverLoop);
+	}
+}
+
+void stopPdpReceiver(int sock) {
+	std::lock_guard<std::mutex> threadGuard(pdpReceiverThreadLock);
+	std::shared_ptr<PdpReceiver> receiver;
+	bool empty;
+	{
+		std::lock_guard<std::mutex> guard(pdpReceiversLock);
+		auto it = pdpReceivers.find(sock);
+		if (it != pdpReceivers.end()) {
+			receiver = it->second;
+			pdpReceivers.erase(it);
+		}
+		empty = pdpReceivers.empty();
+	}
+
+	if (receiver) {
+		std::lock_guard<std::mutex> guard(receiver->ioLock);
+		receiver->closed = true;
+
+		PdpRecvStats stats = getPdpRecvStats(receiver.get());
+		INFO_LOG(SCENET, "PDP socket %d: %llu received, %llu dropped, waited %0.2fms on average (max %0.2fms)", sock, (unsigned long long)stats.received, (unsigned long long)stats.dropped, stats.avgWaitMs, stats.maxWaitMs);
+	}
+
+	if (empty && pdpReceiverRunning) {
+		pdpReceiverRunning = false;
+		if (pdpReceiverThread.joinable())
+			pdpReceiverThread.join();
+	}
+}
+
+int recvFromPdp(int sock, void *buf, int len, bool peek, struct sockaddr_in *from, int *error) {
+	std::shared_ptr<PdpReceiver> receiver = findPdpReceiver(sock);
+	if (!receiver) {
+		socklen_t sinlen = sizeof(*from);
+		int received = recvfrom(sock, (char *)buf, len, (peek ? MSG_PEEK : 0) | MSG_NOSIGNAL, (struct sockaddr *)from, &sinlen);
+		*error = errno;
+		return received;
+	}
+
+	const PdpRecvRing::Header *header = receiver->ring.Front();
+	if (!header) {
+		*error = EAGAIN;
+		return SOCKET_ERROR;
+	}
+
+	// Like recvfrom, anything that doesn't fit is lost unless peeking.
+	int size = std::min(std::max(len, 0), (int)header->size);
+	memcpy(buf, header + 1, size);
+	*from = header->from;
+	if (!peek) {
+		double waitMs = (time_now_d() - header->time) * 1000.0;
+		receiver->taken++;
+		receiver->waitTotal += waitMs;
+		receiver->waitMax = std::max(receiver->waitMax, waitMs);
+		receiver->ring.Pop();
+	}
+	*error = 0;
+	return size;
+}
+
+u32 getPdpAvailToRecv(int sock, u32 limit) {
+	std::shared_ptr<PdpReceiver> receiver = findPdpReceiver(sock);
+	if (!receiver)
+		return (u32)getAvailToRecv(sock, limit);
+	return receiver->ring.Avail(limit);
+}
+
+bool isPdpReadable(int sock) {
+	std::shared_ptr<PdpReceiver> receiver = findPdpReceiver(sock);
+	if (!receiver)
+		return IsSocketReady(sock, true, false) > 0;
+	return receiver->ring.Front() != nullptr;
+}
+
+PdpRecvStats getPdpRecvStats(int sock) {
+	std::shared_ptr<PdpReceiver> receiver = findPdpReceiver(sock);
+	if (!receiver)
+		return PdpRecvStats{};
+	return getPdpRecvStats(receiver.get());
+}
@@ -1316,6 +1316,42 @@ u_long getAvailToRecv(int sock, int udpBufferSize = 0);
  */
 int getSockMaxSize(int udpsock);
 
+// Receive statistics of a PDP socket, see startPdpReceiver.
+struct PdpRecvStats {
+	u64 received;
+	// Lost because the game didn't empty the queue fast enough.
+	u64 dropped;
+	// Time datagrams spent queued before the game took them.
+	double avgWaitMs;
+	double maxWaitMs;
+};
+
+/*
+ * Let the PDP receiver thread read this socket into a queue, so the recvFromPdp family doesn't need syscalls.
+ * @param sock fd, must be non-blocking
+ * @param bufferSize PDP buffer size, the queue holds at least this much
+ */
+void startPdpReceiver(int sock, u32 bufferSize);
+
+/*
+ * Stop reading the socket, must be called before closing it.
+ */
+void stopPdpReceiver(int sock);
+
+/*
+ * Works like recvfrom (with MSG_PEEK when peek is set) on a socket passed to startPdpReceiver
+ * @return Received size or SOCKET_ERROR, with error set to EAGAIN when nothing is queued
+ */
+int recvFromPdp(int sock, void *buf, int len, bool peek, struct sockaddr_in *from, int *error);
+
+/*
+ * Get Number of bytes in whole datagrams queued to be Received, up to limit (at least the first one)
+ */
+u32 getPdpAvailToRecv(int sock, u32 limit);
+
+bool isPdpReadable(int sock);
+PdpRecvStats getPdpRecvStats(int sock);
+
 /*
  * Get Socket Buffer Size (opt = SO_RCVBUF/SO_SNDBUF)
  */
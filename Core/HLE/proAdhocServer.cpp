@@ -50,8 +50,21 @@ extern "C" struct hostent *gethostbyname(const char *name);
 #include <netinet/tcp.h>
 #endif
 
+#if PPSSPP_PLATFORM(LINUX)
+#include <sys/epoll.h>
+#elif PPSSPP_PLATFORM(MAC) || PPSSPP_PLATFORM(IOS) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+#define ADHOC_SERVER_KQUEUE 1
+#include <sys/event.h>
+#include <sys/time.h>
+#elif !defined(_WIN32)
+#include <poll.h>
+#endif
+
 #include <fcntl.h>
 #include <errno.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
 //#include <sqlite3.h>
 
 #ifndef MSG_NOSIGNAL
@@ -500,10 +513,198 @@ void change_blocking_mode(int fd, int nonblocking);
 int create_listen_socket(uint16_t port);
 int server_loop(int server);
 
+// Readiness notification for the server sockets, so a tick only touches the users that actually sent something.
+// Uses epoll on Linux / Android, kqueue on Apple and BSD, and (WSA)poll everywhere else.
+class AdhocServerPoller {
+public:
+	~AdhocServerPoller() {
+		Shutdown();
+	}
+
+	bool Init() {
+#if PPSSPP_PLATFORM(LINUX)
+		epfd_ = epoll_create1(EPOLL_CLOEXEC);
+		return epfd_ != -1;
+#elif defined(ADHOC_SERVER_KQUEUE)
+		kq_ = kqueue();
+		return kq_ != -1;
+#else
+		return true;
+#endif
+	}
+
+	void Shutdown() {
+#if PPSSPP_PLATFORM(LINUX)
+		if (epfd_ != -1)
+			close(epfd_);
+		epfd_ = -1;
+#elif defined(ADHOC_SERVER_KQUEUE)
+		if (kq_ != -1)
+			close(kq_);
+		kq_ = -1;
+#else
+		fds_.clear();
+		index_.clear();
+#endif
+	}
+
+	bool Add(int fd) {
+#if PPSSPP_PLATFORM(LINUX)
+		epoll_event ev{};
+		ev.events = EPOLLIN;
+		ev.data.fd = fd;
+		return epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+#elif defined(ADHOC_SERVER_KQUEUE)
+		struct kevent ev;
+		EV_SET(&ev, fd, EVFILT_READ, EV_ADD, 0, 0, NULL);
+		return kevent(kq_, &ev, 1, NULL, 0, NULL) == 0;
+#else
+		if (index_.count(fd))
+			return false;
+		pollfd pfd{};
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		index_[fd] = fds_.size();
+		fds_.push_back(pfd);
+		return true;
+#endif
+	}
+
+	// Must be called before the socket is closed.
+	void Remove(int fd) {
+#if PPSSPP_PLATFORM(LINUX)
+		epoll_event ev{};
+		epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, &ev);
+#elif defined(ADHOC_SERVER_KQUEUE)
+		struct kevent ev;
+		EV_SET(&ev, fd, EVFILT_READ, EV_DELETE, 0, 0, NULL);
+		kevent(kq_, &ev, 1, NULL, 0, NULL);
+#else
+		auto it = index_.find(fd);
+		if (it == index_.end())
+			return;
+		size_t pos = it->second;
+		index_.erase(it);
+		if (pos != fds_.size() - 1) {
+			fds_[pos] = fds_.back();
+			index_[(int)fds_[pos].fd] = pos;
+		}
+		fds_.pop_back();
+#endif
+	}
+
+	// Collects the readable (or closed / errored) sockets, waiting at most timeoutMs for the first one.
+	int Wait(std::vector<int> &ready, int timeoutMs) {
+		ready.clear();
+#if PPSSPP_PLATFORM(LINUX)
+		epoll_event events[256];
+		int count = epoll_wait(epfd_, events, ARRAY_SIZE(events), timeoutMs);
+		for (int i = 0; i < count; i++)
+			ready.push_back(events[i].data.fd);
+#elif defined(ADHOC_SERVER_KQUEUE)
+		struct kevent events[256];
+		struct timespec timeout;
+		timeout.tv_sec = timeoutMs / 1000;
+		timeout.tv_nsec = (timeoutMs % 1000) * 1000000;
+		int count = kevent(kq_, NULL, 0, events, ARRAY_SIZE(events), &timeout);
+		for (int i = 0; i < count; i++)
+			ready.push_back((int)events[i].ident);
+#else
+		if (fds_.empty()) {
+			sleep_ms(timeoutMs);
+			return 0;
+		}
+#ifdef _WIN32
+		int count = WSAPoll(&fds_[0], (ULONG)fds_.size(), timeoutMs);
+#else
+		int count = poll(&fds_[0], fds_.size(), timeoutMs);
+#endif
+		for (size_t i = 0; i < fds_.size() && (int)ready.size() < count; i++) {
+			if (fds_[i].revents != 0)
+				ready.push_back((int)fds_[i].fd);
+		}
+#endif
+		return (int)ready.size();
+	}
+
+private:
+#if PPSSPP_PLATFORM(LINUX)
+	int epfd_ = -1;
+#elif defined(ADHOC_SERVER_KQUEUE)
+	int kq_ = -1;
+#else
+	std::vector<pollfd> fds_;
+	std::unordered_map<int, size_t> index_;
+#endif
+};
+
+static AdhocServerPoller serverPoller;
+
+// Hash indexes over the linked list databases, so logins and group joins don't scan every user / game / group.
+static std::unordered_map<int, SceNetAdhocctlUserNode *> usersByStream;
+static std::unordered_map<uint32_t, SceNetAdhocctlUserNode *> usersByIP;
+static std::unordered_multimap<uint64_t, SceNetAdhocctlUserNode *> usersByMAC;
+static std::unordered_map<std::string, SceNetAdhocctlGameNode *> gamesByProduct;
+static std::unordered_map<std::string, SceNetAdhocctlGroupNode *> groupsByName;
+static std::unordered_map<std::string, size_t> productidIndex;
+static std::unordered_map<std::string, size_t> crosslinkIndex;
+
+// Per tick metrics, exported in the status logfile.
+static struct {
+	uint32_t connections;
+	uint32_t peakConnections;
+	uint32_t acceptsPerSecond;
+	uint32_t messagesPerSecond;
+	uint32_t peakReadyPerTick;
+	uint32_t acceptedThisSecond;
+	uint32_t messagesThisSecond;
+	uint32_t peakReadyThisSecond;
+} serverMetrics;
+
+// The status logfile is rewritten by the server loop at most once per second.
+static bool statusDirty = false;
+
+static void write_status();
+
+static uint64_t mac_key(const SceNetEtherAddr &mac) {
+	uint64_t key = 0;
+	memcpy(&key, mac.data, sizeof(mac.data));
+	return key;
+}
+
+static std::string product_key(const SceNetAdhocctlProductCode &product) {
+	return std::string(product.data, strnlen(product.data, PRODUCT_CODE_LENGTH));
+}
+
+// Groups are unique per game, matching the strncmp() semantics of the group name.
+static std::string group_key(const SceNetAdhocctlGameNode *game, const SceNetAdhocctlGroupName &group) {
+	return product_key(game->game) + std::string((const char *)group.data, strnlen((const char *)group.data, ADHOCCTL_GROUPNAME_LEN));
+}
+
+static void unindex_user_mac(SceNetAdhocctlUserNode *user) {
+	auto range = usersByMAC.equal_range(mac_key(user->resolver.mac));
+	for (auto it = range.first; it != range.second; ++it) {
+		if (it->second == user) {
+			usersByMAC.erase(it);
+			break;
+		}
+	}
+}
+
+static void rebuild_product_indexes() {
+	productidIndex.clear();
+	for (size_t i = 0; i < productids.size(); i++)
+		productidIndex.emplace(productids[i].id, i);
+	crosslinkIndex.clear();
+	for (size_t i = 0; i < crosslinks.size(); i++)
+		crosslinkIndex.emplace(crosslinks[i].id_from, i);
+}
+
 void __AdhocServerInit() {
 	// Database Product name will update if new game region played on my server to list possible crosslinks
 	productids = std::vector<db_productid>(default_productids, default_productids + ARRAY_SIZE(default_productids));
 	crosslinks = std::vector<db_crosslink>(default_crosslinks, default_crosslinks + ARRAY_SIZE(default_crosslinks));
+	rebuild_product_indexes();
 }
 
 /**
@@ -517,8 +718,8 @@ void login_user_stream(int fd, uint32_t ip)
 	if(_db_user_count < SERVER_USER_MAXIMUM)
 	{
 		// Check IP Duplication
-		SceNetAdhocctlUserNode * u = _db_user;
-		while(u != NULL && u->resolver.ip != ip) u = u->next;
+		auto existing = usersByIP.find(ip);
+		SceNetAdhocctlUserNode * u = existing != usersByIP.end() ? existing->second : NULL;
 
 		if (u != NULL) { // IP Already existed
 			WARN_LOG(SCENET, "AdhocServer: Already Existing IP: %s\n", ip2str(*(in_addr*)&u->resolver.ip).c_str());
@@ -530,6 +731,14 @@ void login_user_stream(int fd, uint32_t ip)
 			// Allocate User Node Memory
 			SceNetAdhocctlUserNode * user = (SceNetAdhocctlUserNode *)malloc(sizeof(SceNetAdhocctlUserNode));
 
+			// Allocated User Node Memory
+			if(user != NULL && !serverPoller.Add(fd))
+			{
+				ERROR_LOG(SCENET, "AdhocServer: Failed to watch socket of %s (Socket error %d)", ip2str(*(in_addr*)&ip).c_str(), errno);
+				free(user);
+				user = NULL;
+			}
+
 			// Allocated User Node Memory
 			if(user != NULL)
 			{
@@ -547,6 +756,10 @@ void login_user_stream(int fd, uint32_t ip)
 				if(_db_user != NULL) _db_user->prev = user;
 				_db_user = user;
 
+				// Index User
+				usersByStream[fd] = user;
+				usersByIP[ip] = user;
+
 				// Initialize Death Clock
 				user->last_recv = time(NULL);
 
@@ -590,8 +803,8 @@ void login_user_data(SceNetAdhocctlUserNode * user, SceNetAdhocctlLoginPacketC2S
 	if(valid_product_code == 1 && memcmp(&data->mac, "\xFF\xFF\xFF\xFF\xFF\xFF", sizeof(data->mac)) != 0 && memcmp(&data->mac, "\x00\x00\x00\x00\x00\x00", sizeof(data->mac)) != 0 && data->name.data[0] != 0)
 	{
 		// Check for duplicated MAC as most games identify Players by MAC
-		SceNetAdhocctlUserNode* u = _db_user;
-		while (u != NULL && !IsMatch(u->resolver.mac, data->mac)) u = u->next;
+		auto existing = usersByMAC.find(mac_key(data->mac));
+		SceNetAdhocctlUserNode* u = existing != usersByMAC.end() ? existing->second : NULL;
 
 		if (u != NULL) { // MAC Already existed
 			WARN_LOG(SCENET, "AdhocServer: Already Existing MAC: %s [%s]\n", mac2str(&data->mac).c_str(), ip2str(*(in_addr*)&u->resolver.ip).c_str());
@@ -601,8 +814,8 @@ void login_user_data(SceNetAdhocctlUserNode * user, SceNetAdhocctlLoginPacketC2S
 		game_product_override(&data->game);
 
 		// Find existing Game
-		SceNetAdhocctlGameNode * game = _db_game;
-		while(game != NULL && strncmp(game->game.data, data->game.data, PRODUCT_CODE_LENGTH) != 0) game = game->next;
+		auto found = gamesByProduct.find(product_key(data->game));
+		SceNetAdhocctlGameNode * game = found != gamesByProduct.end() ? found->second : NULL;
 
 		// Game not found
 		if(game == NULL)
@@ -623,6 +836,9 @@ void login_user_data(SceNetAdhocctlUserNode * user, SceNetAdhocctlLoginPacketC2S
 				game->next = _db_game;
 				if(_db_game != NULL) _db_game->prev = game;
 				_db_game = game;
+
+				// Index Game
+				gamesByProduct[product_key(game->game)] = game;
 			}
 		}
 
@@ -631,6 +847,7 @@ void login_user_data(SceNetAdhocctlUserNode * user, SceNetAdhocctlLoginPacketC2S
 		{
 			// Save MAC
 			user->resolver.mac = data->mac;
+			usersByMAC.emplace(mac_key(user->resolver.mac), user);
 
 			// Save Nickname
 			user->resolver.name = data->name;
@@ -684,7 +901,13 @@ void logout_user(SceNetAdhocctlUserNode * user)
 	// Unlink Rightside
 	if(user->next != NULL) user->next->prev = user->prev;
 
+	// Unindex User
+	usersByStream.erase(user->stream);
+	usersByIP.erase(user->resolver.ip);
+	if(user->game != NULL) unindex_user_mac(user);
+
 	// Close Stream
+	serverPoller.Remove(user->stream);
 	closesocket(user->stream);
 
 	// Playing User
@@ -711,6 +934,9 @@ void logout_user(SceNetAdhocctlUserNode * user)
 			// Unlink Rightside
 			if(user->game->next != NULL) user->game->next->prev = user->game->prev;
 
+			// Unindex Game
+			gamesByProduct.erase(product_key(user->game->game));
+
 			// Free Game Node Memory
 			free(user->game);
 		}
@@ -797,8 +1023,8 @@ void connect_user(SceNetAdhocctlUserNode * user, SceNetAdhocctlGroupName * group
 		if(user->group == NULL)
 		{
 			// Find Group in Game Node
-			SceNetAdhocctlGroupNode * g = user->game->group;
-			while(g != NULL && strncmp((char *)g->group.data, (char *)group->data, ADHOCCTL_GROUPNAME_LEN) != 0) g = g->next;
+			auto found = groupsByName.find(group_key(user->game, *group));
+			SceNetAdhocctlGroupNode * g = found != groupsByName.end() ? found->second : NULL;
 
 			// BSSID Packet
 			SceNetAdhocctlConnectBSSIDPacketS2C bssid;
@@ -832,6 +1058,9 @@ void connect_user(SceNetAdhocctlUserNode * user, SceNetAdhocctlGroupName * group
 					// Copy Group Name
 					g->group = *group;
 
+					// Index Group
+					groupsByName[group_key(g->game, g->group)] = g;
+
 					// Increase Group Counter for Game
 					g->game->groupcount++;
 				}
@@ -1018,6 +1247,9 @@ void disconnect_user(SceNetAdhocctlUserNode * user)
 			// Unlink Rightside
 			if(user->group->next != NULL) user->group->next->prev = user->group->prev;
 
+			// Unindex Group
+			groupsByName.erase(group_key(user->game, user->group->group));
+
 			// Free Group Memory
 			free(user->group);
 
@@ -1341,23 +1573,23 @@ void game_product_override(SceNetAdhocctlProductCode * product)
 			// Destroy Prepared SQL Statement
 			sqlite3_finalize(statement);
 		}*/
-		for (std::vector<db_crosslink>::iterator it = crosslinks.begin(); it != crosslinks.end(); it++) {
-			if (IsMatch(it->id_from, productid)) {
-				// Grab Crosslink ID
-				char crosslink[PRODUCT_CODE_LENGTH + 1];
-				strncpy(crosslink, it->id_to, PRODUCT_CODE_LENGTH);
-				crosslink[PRODUCT_CODE_LENGTH] = 0; // null terminated
-
-				// Crosslink Product Code
-				strncpy(product->data, it->id_to, PRODUCT_CODE_LENGTH);
-
-				// Log Crosslink
-				INFO_LOG(SCENET, "AdhocServer: Crosslinked %s to %s", productid, crosslink);
-
-				// Set Crosslinked Flag
-				crosslinked = 1;
-				break;
-			}
+		auto link = crosslinkIndex.find(productid);
+		if (link != crosslinkIndex.end()) {
+			const db_crosslink &it = crosslinks[link->second];
+
+			// Grab Crosslink ID
+			char crosslink[PRODUCT_CODE_LENGTH + 1];
+			strncpy(crosslink, it.id_to, PRODUCT_CODE_LENGTH);
+			crosslink[PRODUCT_CODE_LENGTH] = 0; // null terminated
+
+			// Crosslink Product Code
+			strncpy(product->data, it.id_to, PRODUCT_CODE_LENGTH);
+
+			// Log Crosslink
+			INFO_LOG(SCENET, "AdhocServer: Crosslinked %s to %s", productid, crosslink);
+
+			// Set Crosslinked Flag
+			crosslinked = 1;
 		}
 
 		// Not Crosslinked
@@ -1380,12 +1612,9 @@ void game_product_override(SceNetAdhocctlProductCode * product)
 				// Destroy Prepare SQL Statement
 				sqlite3_finalize(statement);
 			}*/
-			for (std::vector<db_productid>::iterator it = productids.begin(); it != productids.end(); it++) {
-				if (IsMatch(it->id, productid)) {
-					// Set Exists Flag
-					exists = 1;
-					break;
-				}
+			if (productidIndex.count(productid)) {
+				// Set Exists Flag
+				exists = 1;
 			}
 
 			// Game doesn't exist in Database
@@ -1412,6 +1641,7 @@ void game_product_override(SceNetAdhocctlProductCode * product)
 				strncpy(unkproduct.id, productid, sizeof(unkproduct.id));
 				strncpy(unkproduct.name, productid, sizeof(productid));
 				productids.push_back(unkproduct); //productids[productids.size()] = unkproduct;
+				productidIndex.emplace(productid, productids.size() - 1);
 				// Log Addition
 				INFO_LOG(SCENET, "AdhocServer: Added Unknown Product ID %s to Database", productid);
 			}
@@ -1423,10 +1653,20 @@ void game_product_override(SceNetAdhocctlProductCode * product)
 }
 
 /**
- * Update Status Logfile
+ * Update Status Logfile (deferred to the next metrics tick of the server loop)
  */
 void update_status()
 {
+	statusDirty = true;
+}
+
+/**
+ * Write Status Logfile
+ */
+static void write_status()
+{
+	statusDirty = false;
+
 	// Open Logfile
 	FILE * log = File::OpenCFile(Path(SERVER_STATUS_XMLOUT), "w");
 
@@ -1442,6 +1682,9 @@ void update_status()
 		// Output Root Tag + User Count
 		fprintf(log, "<prometheus usercount=\"%u\">\n", _db_user_count);
 
+		// Output Server Metrics
+		fprintf(log, "\t<metrics connections=\"%u\" peakconnections=\"%u\" acceptspersec=\"%u\" messagespersec=\"%u\" readypertick=\"%u\" />\n", serverMetrics.connections, serverMetrics.peakConnections, serverMetrics.acceptsPerSecond, serverMetrics.messagesPerSecond, serverMetrics.peakReadyPerTick);
+
 		// Database Handle
 		//sqlite3 * db = NULL;
 
@@ -1494,17 +1737,11 @@ void update_status()
 					sqlite3_finalize(statement);
 				}*/
 				//db_productid *foundid = NULL;
-				bool found = false;
-				for (std::vector<db_productid>::iterator it = productids.begin(); it != productids.end(); it++) {
-					if (IsMatch(it->id, productid)) {
-						// Copy Game Name
-						strcpyxml(displayname, it->name, sizeof(displayname));
-						found = true;
-						break;
-					}
-				}
-
-				if (!found) {
+				auto found = productidIndex.find(productid);
+				if (found != productidIndex.end()) {
+					// Copy Game Name
+					strcpyxml(displayname, productids[found->second].name, sizeof(displayname));
+				} else {
 					// Use Product Code as Name
 					strcpyxml(displayname, productid, sizeof(displayname));
 				}
@@ -1877,215 +2114,307 @@ int create_listen_socket(uint16_t port)
 }
 
 /**
- * Server Main Loop
- * @param server Server Listening Socket
- * @return OS Error Code
+ * Handle one Packet from the RX Buffer
+ * @param user User Node
+ * @return true if a Packet was consumed and the User is still logged in
  */
-int server_loop(int server)
+static bool handle_user_packet(SceNetAdhocctlUserNode * user)
 {
-	// Set Running Status
-	//_status = 1;
-	adhocServerRunning = true;
+	// Stream and Buffer State (to detect Logouts and incomplete Packets)
+	int stream = user->stream;
+	uint32_t rxpos = user->rxpos;
 
-	// Create Empty Status Logfile
-	update_status();
+	// Waiting for Login Packet
+	if(get_user_state(user) == USER_STATE_WAITING)
+	{
+		// Valid Opcode
+		if(user->rx[0] == OPCODE_LOGIN)
+		{
+			// Enough Data available
+			if(user->rxpos >= sizeof(SceNetAdhocctlLoginPacketC2S))
+			{
+				// Clone Packet
+				SceNetAdhocctlLoginPacketC2S packet = *(SceNetAdhocctlLoginPacketC2S *)user->rx;
 
-	// Handling Loop
-	while (adhocServerRunning) //(_status == 1)
+				// Remove Packet from RX Buffer
+				clear_user_rxbuf(user, sizeof(SceNetAdhocctlLoginPacketC2S));
+
+				// Login User (Data)
+				login_user_data(user, &packet);
+			}
+		}
+
+		// Invalid Opcode
+		else
+		{
+			// Notify User
+			WARN_LOG(SCENET, "AdhocServer: Invalid Opcode 0x%02X in Waiting State from %s", user->rx[0], ip2str(*(in_addr*)&user->resolver.ip).c_str());
+
+			// Logout User
+			logout_user(user);
+		}
+	}
+
+	// Logged-In User
+	else if(get_user_state(user) == USER_STATE_LOGGED_IN)
 	{
-		// Login Block
+		// Ping Packet
+		if(user->rx[0] == OPCODE_PING)
 		{
-			// Login Result
-			int loginresult = 0;
+			// Delete Packet from RX Buffer
+			clear_user_rxbuf(user, 1);
+		}
 
-			// Login Processing Loop
-			do
+		// Group Connect Packet
+		else if(user->rx[0] == OPCODE_CONNECT)
+		{
+			// Enough Data available
+			if(user->rxpos >= sizeof(SceNetAdhocctlConnectPacketC2S))
 			{
-				// Prepare Address Structure
-				struct sockaddr_in addr;
-				socklen_t addrlen = sizeof(addr);
-				memset(&addr, 0, sizeof(addr));
+				// Cast Packet
+				SceNetAdhocctlConnectPacketC2S * packet = (SceNetAdhocctlConnectPacketC2S *)user->rx;
 
-				// Accept Login Requests
-				// loginresult = accept4(server, (struct sockaddr *)&addr, &addrlen, SOCK_NONBLOCK);
+				// Clone Group Name
+				SceNetAdhocctlGroupName group = packet->group;
 
-				// Alternative Accept Approach (some Linux Kernel don't support the accept4 Syscall... wtf?)
-				loginresult = accept(server, (struct sockaddr *)&addr, &addrlen);
-				if(loginresult != -1)
-				{
-					// Switch Socket into Non-Blocking Mode
-					change_blocking_mode(loginresult, 1);
-				}
+				// Remove Packet from RX Buffer
+				clear_user_rxbuf(user, sizeof(SceNetAdhocctlConnectPacketC2S));
 
-				// Login User (Stream)
-				if (loginresult != -1) {
-					u32_le sip = addr.sin_addr.s_addr;
-					/* // Replacing 127.0.0.x with Ethernet IP will cause issue with multiple-instance of localhost (127.0.0.x)
-					if (sip == 0x0100007f) { //127.0.0.1 should be replaced with LAN/WAN IP whenever available
-						char str[100];
-						gethostname(str, 100);
-						u8 *pip = (u8*)&sip;
-						if (gethostbyname(str)->h_addrtype == AF_INET && gethostbyname(str)->h_addr_list[0] != NULL) pip = (u8*)gethostbyname(str)->h_addr_list[0];
-						sip = *(u32_le*)pip;
-						WARN_LOG(SCENET, "AdhocServer: Replacing IP %s with %s", inet_ntoa(addr.sin_addr), inet_ntoa(*(in_addr*)&pip));
-					}
-					*/
-					login_user_stream(loginresult, sip);
-				}
-			} while(loginresult != -1);
+				// Change Game Group
+				connect_user(user, &group);
+			}
 		}
 
-		// Receive Data from Users
-		SceNetAdhocctlUserNode * user = _db_user;
-		while(user != NULL)
+		// Group Disconnect Packet
+		else if(user->rx[0] == OPCODE_DISCONNECT)
 		{
-			// Next User (for safe delete)
-			SceNetAdhocctlUserNode * next = user->next;
+			// Remove Packet from RX Buffer
+			clear_user_rxbuf(user, 1);
 
-			// Receive Data from User
-			int recvresult = recv(user->stream, (char*)user->rx + user->rxpos, sizeof(user->rx) - user->rxpos, MSG_NOSIGNAL);
+			// Leave Game Group
+			disconnect_user(user);
+		}
+
+		// Network Scan Packet
+		else if(user->rx[0] == OPCODE_SCAN)
+		{
+			// Remove Packet from RX Buffer
+			clear_user_rxbuf(user, 1);
 
-			// Connection Closed or Timed Out
-			if(recvresult == 0 || (recvresult == -1 && errno != EAGAIN && errno != EWOULDBLOCK) || get_user_state(user) == USER_STATE_TIMED_OUT)
+			// Send Network List
+			send_scan_results(user);
+		}
+
+		// Chat Text Packet
+		else if(user->rx[0] == OPCODE_CHAT)
+		{
+			// Enough Data available
+			if(user->rxpos >= sizeof(SceNetAdhocctlChatPacketC2S))
 			{
-				// Logout User
-				logout_user(user);
+				// Cast Packet
+				SceNetAdhocctlChatPacketC2S * packet = (SceNetAdhocctlChatPacketC2S *)user->rx;
+
+				// Clone Buffer for Message
+				char message[64];
+				memset(message, 0, sizeof(message));
+				strncpy(message, packet->message, sizeof(message) - 1);
+
+				// Remove Packet from RX Buffer
+				clear_user_rxbuf(user, sizeof(SceNetAdhocctlChatPacketC2S));
+
+				// Spread Chat Message
+				spread_message(user, message);
 			}
+		}
 
-			// Received Data (or leftovers in RX-Buffer)
-			else if(recvresult > 0 || user->rxpos > 0)
-			{
-				// New Incoming Data
-				if(recvresult > 0)
-				{
-					// Move RX Pointer
-					user->rxpos += recvresult;
+		// Invalid Opcode
+		else
+		{
+			// Notify User
+			WARN_LOG(SCENET, "AdhocServer: Invalid Opcode 0x%02X in Logged-In State from %s (MAC: %s - IP: %s)", user->rx[0], (char *)user->resolver.name.data, mac2str(&user->resolver.mac).c_str(), ip2str(*(in_addr*)&user->resolver.ip).c_str());
 
-					// Update Death Clock
-					user->last_recv = time(NULL);
-				}
+			// Logout User
+			logout_user(user);
+		}
+	}
 
-				// Waiting for Login Packet
-				if(get_user_state(user) == USER_STATE_WAITING)
-				{
-					// Valid Opcode
-					if(user->rx[0] == OPCODE_LOGIN)
-					{
-						// Enough Data available
-						if(user->rxpos >= sizeof(SceNetAdhocctlLoginPacketC2S))
-						{
-							// Clone Packet
-							SceNetAdhocctlLoginPacketC2S packet = *(SceNetAdhocctlLoginPacketC2S *)user->rx;
+	// Logged out while handling the Packet
+	auto it = usersByStream.find(stream);
+	if(it == usersByStream.end() || it->second != user) return false;
 
-							// Remove Packet from RX Buffer
-							clear_user_rxbuf(user, sizeof(SceNetAdhocctlLoginPacketC2S));
+	// Incomplete Packet (wait for more Data)
+	if(user->rxpos == rxpos) return false;
 
-							// Login User (Data)
-							login_user_data(user, &packet);
-						}
-					}
+	// Count Message
+	serverMetrics.messagesThisSecond++;
+	return true;
+}
 
-					// Invalid Opcode
-					else
-					{
-						// Notify User
-						WARN_LOG(SCENET, "AdhocServer: Invalid Opcode 0x%02X in Waiting State from %s", user->rx[0], ip2str(*(in_addr*)&user->resolver.ip).c_str());
+/**
+ * Receive Data from a readable User Stream
+ * @param user User Node
+ */
+static void receive_user_data(SceNetAdhocctlUserNode * user)
+{
+	// Receive Data from User
+	int recvresult = recv(user->stream, (char*)user->rx + user->rxpos, sizeof(user->rx) - user->rxpos, MSG_NOSIGNAL);
 
-						// Logout User
-						logout_user(user);
-					}
-				}
+	// Connection Closed
+	if(recvresult == 0 || (recvresult == -1 && errno != EAGAIN && errno != EWOULDBLOCK))
+	{
+		// Logout User
+		logout_user(user);
+		return;
+	}
 
-				// Logged-In User
-				else if(get_user_state(user) == USER_STATE_LOGGED_IN)
-				{
-					// Ping Packet
-					if(user->rx[0] == OPCODE_PING)
-					{
-						// Delete Packet from RX Buffer
-						clear_user_rxbuf(user, 1);
-					}
+	// New Incoming Data
+	if(recvresult > 0)
+	{
+		// Move RX Pointer
+		user->rxpos += recvresult;
 
-					// Group Connect Packet
-					else if(user->rx[0] == OPCODE_CONNECT)
-					{
-						// Enough Data available
-						if(user->rxpos >= sizeof(SceNetAdhocctlConnectPacketC2S))
-						{
-							// Cast Packet
-							SceNetAdhocctlConnectPacketC2S * packet = (SceNetAdhocctlConnectPacketC2S *)user->rx;
+		// Update Death Clock
+		user->last_recv = time(NULL);
+	}
 
-							// Clone Group Name
-							SceNetAdhocctlGroupName group = packet->group;
+	// Handle every complete Packet
+	while(user->rxpos > 0 && handle_user_packet(user));
+}
 
-							// Remove Packet from RX Buffer
-							clear_user_rxbuf(user, sizeof(SceNetAdhocctlConnectPacketC2S));
+/**
+ * Logout timed out Users and publish the Metrics of the last Second
+ */
+static void server_metrics_tick()
+{
+	// Logout timed out Users
+	SceNetAdhocctlUserNode * user = _db_user;
+	while(user != NULL)
+	{
+		// Next User (for safe delete)
+		SceNetAdhocctlUserNode * next = user->next;
 
-							// Change Game Group
-							connect_user(user, &group);
-						}
-					}
+		// Timed Out
+		if(get_user_state(user) == USER_STATE_TIMED_OUT) logout_user(user);
 
-					// Group Disconnect Packet
-					else if(user->rx[0] == OPCODE_DISCONNECT)
-					{
-						// Remove Packet from RX Buffer
-						clear_user_rxbuf(user, 1);
+		// Move Pointer
+		user = next;
+	}
 
-						// Leave Game Group
-						disconnect_user(user);
-					}
+	// Publish Metrics
+	bool changed = serverMetrics.connections != _db_user_count || serverMetrics.acceptsPerSecond != serverMetrics.acceptedThisSecond || serverMetrics.messagesPerSecond != serverMetrics.messagesThisSecond || serverMetrics.peakReadyPerTick != serverMetrics.peakReadyThisSecond;
+	serverMetrics.connections = _db_user_count;
+	if(serverMetrics.connections > serverMetrics.peakConnections) serverMetrics.peakConnections = serverMetrics.connections;
+	serverMetrics.acceptsPerSecond = serverMetrics.acceptedThisSecond;
+	serverMetrics.messagesPerSecond = serverMetrics.messagesThisSecond;
+	serverMetrics.peakReadyPerTick = serverMetrics.peakReadyThisSecond;
+	serverMetrics.acceptedThisSecond = 0;
+	serverMetrics.messagesThisSecond = 0;
+	serverMetrics.peakReadyThisSecond = 0;
+
+	if(changed && serverMetrics.connections > 0) DEBUG_LOG(SCENET, "AdhocServer: %u connections, %u accepts/s, %u messages/s, %u ready per tick", serverMetrics.connections, serverMetrics.acceptsPerSecond, serverMetrics.messagesPerSecond, serverMetrics.peakReadyPerTick);
+
+	// Update Status Logfile
+	if(changed || statusDirty) write_status();
+}
 
-					// Network Scan Packet
-					else if(user->rx[0] == OPCODE_SCAN)
-					{
-						// Remove Packet from RX Buffer
-						clear_user_rxbuf(user, 1);
+/**
+ * Server Main Loop
+ * @param server Server Listening Socket
+ * @return OS Error Code
+ */
+int server_loop(int server)
+{
+	// Set Running Status
+	//_status = 1;
+	adhocServerRunning = true;
 
-						// Send Network List
-						send_scan_results(user);
-					}
+	// Watch the Listening Socket
+	if(!serverPoller.Init() || !serverPoller.Add(server))
+	{
+		ERROR_LOG(SCENET, "AdhocServer: Failed to create socket poller (Socket error %d)", errno);
+		serverPoller.Shutdown();
+		closesocket(server);
+		return -1;
+	}
 
-					// Chat Text Packet
-					else if(user->rx[0] == OPCODE_CHAT)
-					{
-						// Enough Data available
-						if(user->rxpos >= sizeof(SceNetAdhocctlChatPacketC2S))
-						{
-							// Cast Packet
-							SceNetAdhocctlChatPacketC2S * packet = (SceNetAdhocctlChatPacketC2S *)user->rx;
+	// Reset Metrics
+	memset(&serverMetrics, 0, sizeof(serverMetrics));
 
-							// Clone Buffer for Message
-							char message[64];
-							memset(message, 0, sizeof(message));
-							strncpy(message, packet->message, sizeof(message) - 1);
+	// Create Empty Status Logfile
+	write_status();
 
-							// Remove Packet from RX Buffer
-							clear_user_rxbuf(user, sizeof(SceNetAdhocctlChatPacketC2S));
+	// Ready Sockets
+	std::vector<int> ready;
+	double lastMetricsTick = time_now_d();
 
-							// Spread Chat Message
-							spread_message(user, message);
-						}
-					}
+	// Handling Loop
+	while (adhocServerRunning) //(_status == 1)
+	{
+		// Wait for Activity (at most 10ms, so shutdown and timeouts stay responsive)
+		int readycount = serverPoller.Wait(ready, 10);
+		if(readycount > (int)serverMetrics.peakReadyThisSecond) serverMetrics.peakReadyThisSecond = readycount;
 
-					// Invalid Opcode
-					else
+		for(int fd : ready)
+		{
+			if(fd == server)
+			{
+				// Login Block
+				{
+					// Login Result
+					int loginresult = 0;
+
+					// Login Processing Loop
+					do
 					{
-						// Notify User
-						WARN_LOG(SCENET, "AdhocServer: Invalid Opcode 0x%02X in Logged-In State from %s (MAC: %s - IP: %s)", user->rx[0], (char *)user->resolver.name.data, mac2str(&user->resolver.mac).c_str(), ip2str(*(in_addr*)&user->resolver.ip).c_str());
+						// Prepare Address Structure
+						struct sockaddr_in addr;
+						socklen_t addrlen = sizeof(addr);
+						memset(&addr, 0, sizeof(addr));
 
-						// Logout User
-						logout_user(user);
-					}
+						// Accept Login Requests
+						// loginresult = accept4(server, (struct sockaddr *)&addr, &addrlen, SOCK_NONBLOCK);
+
+						// Alternative Accept Approach (some Linux Kernel don't support the accept4 Syscall... wtf?)
+						loginresult = accept(server, (struct sockaddr *)&addr, &addrlen);
+						if(loginresult != -1)
+						{
+							// Switch Socket into Non-Blocking Mode
+							change_blocking_mode(loginresult, 1);
+						}
+
+						// Login User (Stream)
+						if (loginresult != -1) {
+							u32_le sip = addr.sin_addr.s_addr;
+							/* // Replacing 127.0.0.x with Ethernet IP will cause issue with multiple-instance of localhost (127.0.0.x)
+							if (sip == 0x0100007f) { //127.0.0.1 should be replaced with LAN/WAN IP whenever available
+								char str[100];
+								gethostname(str, 100);
+								u8 *pip = (u8*)&sip;
+								if (gethostbyname(str)->h_addrtype == AF_INET && gethostbyname(str)->h_addr_list[0] != NULL) pip = (u8*)gethostbyname(str)->h_addr_list[0];
+								sip = *(u32_le*)pip;
+								WARN_LOG(SCENET, "AdhocServer: Replacing IP %s with %s", inet_ntoa(addr.sin_addr), inet_ntoa(*(in_addr*)&pip));
+							}
+							*/
+							serverMetrics.acceptedThisSecond++;
+							login_user_stream(loginresult, sip);
+						}
+					} while(loginresult != -1);
 				}
+				continue;
 			}
 
-			// Move Pointer
-			user = next;
+			// Receive Data from User (may have been logged out by an earlier Socket in this Batch)
+			auto it = usersByStream.find(fd);
+			if(it != usersByStream.end()) receive_user_data(it->second);
 		}
 
-		// Prevent needless CPU Overload (1ms Sleep)
-		sleep_ms(10);
+		// Once per Second
+		double now = time_now_d();
+		if(now - lastMetricsTick >= 1.0)
+		{
+			lastMetricsTick = now;
+			server_metrics_tick();
+		}
 
 		// Don't do anything if it's paused, otherwise the log will be flooded
 		while (adhocServerRunning && Core_IsStepping() && coreState != CORE_POWERDOWN) sleep_ms(10);
@@ -2094,7 +2423,12 @@ int server_loop(int server)
 	// Free User Database Memory
 	free_database();
 
+	// Write final Status Logfile
+	if(statusDirty) write_status();
+
 	// Close Server Socket
+	serverPoller.Remove(server);
+	serverPoller.Shutdown();
 	closesocket(server);
 
 	// Return Success
@@ -356,7 +356,7 @@ void game_product_override(SceNetAdhocctlProductCode * product);
 /* STATUS */
 
 /**
- * Update Status Logfile
+ * Update Status Logfile (written by the server loop at most once per second)
  */
 void update_status();
 
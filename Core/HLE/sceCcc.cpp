@@ -15,6 +15,8 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
+
 #include "Common/Data/Encoding/Utf8.h"
 #include "Common/Data/Encoding/Utf16.h"
 #include "Common/Data/Encoding/Shiftjis.h"
@@ -105,11 +107,24 @@ static int sceCccUTF8toUTF16(u32 dstAddr, u32 dstSize, u32 srcAddr)
 	const auto dstEnd = PSPWCharPointer::Create(dstAddr + (dstSize & ~1));
 
 	DEBUG_LOG(SCEMISC, "sceCccUTF8toUTF16(%08x, %d, %08x)", dstAddr, dstSize, srcAddr);
-	UTF8 utf(src);
+	const char *srcPtr = src;
+	int index = 0;
 	int n = 0;
-	while (u32 c = utf.next())
+	while (true)
 	{
-		if (dst + UTF16LE::encodeUnits(c) >= dstEnd)
+		// Runs of ASCII need no decoding, just widen them.  Always leave room for the terminator.
+		int run = std::min(u8_ascii_prefix(srcPtr + index), std::max(0, (int)(dstEnd.ptr - dst.ptr) / 2 - 1));
+		char16_t *dstPtr = dst;
+		for (int i = 0; i < run; ++i)
+			dstPtr[i] = (u8)srcPtr[index + i];
+		dst += run;
+		index += run;
+		n += run;
+
+		UTF8 utf(srcPtr, index);
+		u32 c = utf.next();
+		index = utf.byteIndex();
+		if (c == 0 || dst + UTF16LE::encodeUnits(c) >= dstEnd)
 			break;
 		dst += UTF16LE::encode(dst, c);
 		n++;
@@ -118,7 +133,7 @@ static int sceCccUTF8toUTF16(u32 dstAddr, u32 dstSize, u32 srcAddr)
 	if (dst < dstEnd)
 		*dst++ = 0;
 
-	NotifyMemInfo(MemBlockFlags::READ, srcAddr, utf.byteIndex(), "sceCcc");
+	NotifyMemInfo(MemBlockFlags::READ, srcAddr, index, "sceCcc");
 	NotifyMemInfo(MemBlockFlags::WRITE, dstAddr, dst.ptr - dstAddr, "sceCcc");
 	return n;
 }
@@ -172,11 +187,27 @@ static int sceCccUTF16toUTF8(u32 dstAddr, u32 dstSize, u32 srcAddr)
 	const auto dstEnd = PSPCharPointer::Create(dstAddr + dstSize);
 
 	DEBUG_LOG(SCEMISC, "sceCccUTF16toUTF8(%08x, %d, %08x)", dstAddr, dstSize, srcAddr);
-	UTF16LE utf(src);
+	const char16_t *srcPtr = src;
+	int index = 0;
 	int n = 0;
-	while (u32 c = utf.next())
+	while (true)
 	{
-		if (dst + UTF8::encodeUnits(c) >= dstEnd)
+		// Runs of ASCII need no encoding, just narrow them.  Always leave room for the terminator.
+		const int room = std::max(0, (int)(dstEnd.ptr - dst.ptr) - 1);
+		char *dstPtr = dst;
+		int run = 0;
+		while (run < room && (u16)(srcPtr[index + run] - 1) < 0x7F) {
+			dstPtr[run] = (char)srcPtr[index + run];
+			run++;
+		}
+		dst += run;
+		index += run;
+		n += run;
+
+		UTF16LE utf(srcPtr + index);
+		u32 c = utf.next();
+		index += utf.shortIndex();
+		if (c == 0 || dst + UTF8::encodeUnits(c) >= dstEnd)
 			break;
 		dst += UTF8::encode(dst, c);
 		n++;
@@ -185,7 +216,7 @@ static int sceCccUTF16toUTF8(u32 dstAddr, u32 dstSize, u32 srcAddr)
 	if (dst < dstEnd)
 		*dst++ = 0;
 
-	NotifyMemInfo(MemBlockFlags::READ, srcAddr, utf.shortIndex() * sizeof(uint16_t), "sceCcc");
+	NotifyMemInfo(MemBlockFlags::READ, srcAddr, index * sizeof(uint16_t), "sceCcc");
 	NotifyMemInfo(MemBlockFlags::WRITE, dstAddr, dst.ptr - dstAddr, "sceCcc");
 	return n;
 }
@@ -280,11 +311,31 @@ static int sceCccSJIStoUTF16(u32 dstAddr, u32 dstSize, u32 srcAddr)
 	const auto dstEnd = PSPWCharPointer::Create(dstAddr + (dstSize & ~1));
 
 	DEBUG_LOG(SCEMISC, "sceCccSJIStoUTF16(%08x, %d, %08x)", dstAddr, dstSize, srcAddr);
-	ShiftJIS sjis(src);
+	const u8 *srcPtr = (const u8 *)(const char *)src;
+	int index = 0;
 	int n = 0;
-	while (u32 c = sjis.next())
+	while (true)
 	{
-		if (dst + UTF16LE::encodeUnits(c) >= dstEnd)
+		// Single byte codes (ASCII and half-width katakana) go straight through the table.
+		const int room = std::max(0, (int)(dstEnd.ptr - dst.ptr) / 2 - 1);
+		char16_t *dstPtr = dst;
+		int run = 0;
+		while (run < room) {
+			u8 b = srcPtr[index + run];
+			if (!((u8)(b - 1) < 0x7F || (b >= 0xA0 && b < 0xE0)))
+				break;
+			u16 ucs = jis2ucsTable[b];
+			dstPtr[run] = ucs == 0 ? (char16_t)errorUTF16 : (char16_t)ucs;
+			run++;
+		}
+		dst += run;
+		index += run;
+		n += run;
+
+		ShiftJIS sjis((const char *)srcPtr + index);
+		u32 c = sjis.next();
+		index += sjis.byteIndex();
+		if (c == 0 || dst + UTF16LE::encodeUnits(c) >= dstEnd)
 			break;
 		dst += UTF16LE::encode(dst, __CccJIStoUCS(c, errorUTF16));
 		n++;
@@ -293,7 +344,7 @@ static int sceCccSJIStoUTF16(u32 dstAddr, u32 dstSize, u32 srcAddr)
 	if (dst < dstEnd)
 		*dst++ = 0;
 
-	NotifyMemInfo(MemBlockFlags::READ, srcAddr, sjis.byteIndex(), "sceCcc");
+	NotifyMemInfo(MemBlockFlags::READ, srcAddr, index, "sceCcc");
 	NotifyMemInfo(MemBlockFlags::WRITE, dstAddr, dst.ptr - dstAddr, "sceCcc");
 	return n;
 }
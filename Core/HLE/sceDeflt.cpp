@@ -18,6 +18,7 @@
 #include "zlib.h"
 
 #include "Common/CommonTypes.h"
+#include "Common/Data/Encoding/Compression.h"
 #include "Core/Debugger/MemBlockInfo.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HLE/FunctionWrappers.h"
@@ -35,34 +36,32 @@ static int CommonDecompress(int windowBits, u32 OutBuffer, int OutBufferLength,
 		return hleLogError(HLE, 0, "bad crc32 address");
 	}
 
-	z_stream stream{};
 	u8 *outBufferPtr = Memory::GetPointer(OutBuffer);
-	stream.next_in = (Bytef*)Memory::GetPointer(InBuffer);
+	const u8 *inBufferPtr = Memory::GetPointer(InBuffer);
 	// We don't know the available length, just let it use as much as it wants.
-	stream.avail_in = (uInt)Memory::ValidSize(InBuffer, Memory::g_MemorySize);
-	stream.next_out = outBufferPtr;
-	stream.avail_out = (uInt)OutBufferLength;
+	const u32 inSize = Memory::ValidSize(InBuffer, Memory::g_MemorySize);
+	const u32 outSize = OutBufferLength < 0 ? 0 : Memory::ValidSize(OutBuffer, OutBufferLength);
 
-	int err = inflateInit2(&stream, windowBits);
-	if (err != Z_OK) {
-		return hleLogError(HLE, 0, "inflateInit2 failed %08x", err);
-	}
-	err = inflate(&stream, Z_FINISH);
-	inflateEnd(&stream);
-
-	if (err != Z_STREAM_END) {
-		return hleLogError(HLE, 0, "inflate failed %08x", err);
+	size_t totalIn = 0, totalOut = 0;
+	uint32_t check = 0;
+	if (!inflate_buffer(inBufferPtr, inSize, outBufferPtr, outSize, windowBits, &totalIn, &totalOut, &check)) {
+		return hleLogError(HLE, 0, "inflate failed");
 	}
 	if (crc32Addr.IsValid()) {
-		uLong crc = crc32(0L, Z_NULL, 0);
-		*crc32Addr = crc32(crc, outBufferPtr, stream.total_out);
+		// Gzip streams carry (and zlib already verified) the CRC of the output, no need for another pass.
+		if (windowBits > MAX_WBITS) {
+			*crc32Addr = check;
+		} else {
+			uLong crc = crc32(0L, Z_NULL, 0);
+			*crc32Addr = crc32(crc, outBufferPtr, (uInt)totalOut);
+		}
 	}
 
-	const std::string tag = "sceDeflt/" + GetMemWriteTagAt(InBuffer, stream.total_in);
-	NotifyMemInfo(MemBlockFlags::READ, InBuffer, stream.total_in, tag.c_str(), tag.size());
-	NotifyMemInfo(MemBlockFlags::WRITE, OutBuffer, stream.total_out, tag.c_str(), tag.size());
+	const std::string tag = "sceDeflt/" + GetMemWriteTagAt(InBuffer, (u32)totalIn);
+	NotifyMemInfo(MemBlockFlags::READ, InBuffer, (u32)totalIn, tag.c_str(), tag.size());
+	NotifyMemInfo(MemBlockFlags::WRITE, OutBuffer, (u32)totalOut, tag.c_str(), tag.size());
 
-	return hleLogSuccessI(HLE, stream.total_out);
+	return hleLogSuccessI(HLE, (int)totalOut);
 }
 
 static int sceDeflateDecompress(u32 OutBuffer, int OutBufferLength, u32 InBuffer, u32 Crc32Addr) {
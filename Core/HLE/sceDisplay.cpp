@@ -28,6 +28,7 @@
 #endif
 
 #include "Common/Data/Text/I18n.h"
+#include "Common/Profiler/FrameTimeline.h"
 #include "Common/Profiler/Profiler.h"
 #include "Common/System/System.h"
 #include "Common/Serialize/Serializer.h"
@@ -41,6 +42,8 @@
 #include "Core/Reporting.h"
 #include "Core/Core.h"
 #include "Core/System.h"
+#include "Core/Debugger/MemBlockInfo.h"
+#include "Core/FileLoaders/RamCachingFileLoader.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HLE/FunctionWrappers.h"
 #include "Core/HLE/sceDisplay.h"
@@ -119,6 +122,10 @@ static int numVBlanks;
 static int numVBlanksSinceFlip;
 
 static u64 frameStartTicks;
+// Cycles CoreTiming::Idle() skipped during the previous frame, for the debug stats.
+static u64 frameStartIdleTicks;
+static u64 lastFrameIdleTicks;
+static u64 lastFrameTicks;
 const int hCountPerVblank = 286;
 
 const int PSP_DISPLAY_MODE_LCD = 0;
@@ -171,6 +178,17 @@ static int lastFlipsTooFrequent = 0;
 static u64 lastFlipCycles = 0;
 static u64 nextFlipCycles = 0;
 
+// Performance governor state.  Drops resolution first, then adds frameskip, until the target speed holds.
+// Steps down after 2 slow seconds, but only back up after 5 seconds with lots of spare time.
+static const int GOVERNOR_SLOW_SECONDS = 2;
+static const int GOVERNOR_FAST_SECONDS = 5;
+static const double GOVERNOR_SPARE_FRACTION = 0.35;
+static const int GOVERNOR_MAX_FRAMESKIP = 3;
+static int governorFrameSkip = 0;
+static int governorSlowSeconds = 0;
+static int governorFastSeconds = 0;
+static double governorSleepTime = 0.0;
+
 void hleEnterVblank(u64 userdata, int cyclesLate);
 void hleLeaveVblank(u64 userdata, int cyclesLate);
 void hleAfterFlip(u64 userdata, int cyclesLate);
@@ -229,6 +247,9 @@ void __DisplayInit() {
 	CoreTiming::ScheduleEvent(msToCycles(frameMs - vblankMs), enterVblankEvent, 0);
 	isVblank = 0;
 	frameStartTicks = 0;
+	frameStartIdleTicks = CoreTiming::GetIdleTicks();
+	lastFrameIdleTicks = 0;
+	lastFrameTicks = 0;
 	vCount = 0;
 	hCountBase = 0;
 	curFrameTime = 0.0;
@@ -246,6 +267,12 @@ void __DisplayInit() {
 	frameTimeHistoryPos = 0;
 	lastFrameTimeHistory = 0.0;
 
+	governorFrameSkip = 0;
+	governorSlowSeconds = 0;
+	governorFastSeconds = 0;
+	governorSleepTime = 0.0;
+	PSP_CoreParameter().renderScaleDrop = 0;
+
 	__KernelRegisterWaitTypeFuncs(WAITTYPE_VBLANK, __DisplayVblankBeginCallback, __DisplayVblankEndCallback);
 }
 
@@ -464,6 +491,83 @@ void __DisplayGetAveragedFPS(float *out_vps, float *out_fps) {
 	*out_vps = *out_fps = avg;
 }
 
+static int FrameTimingLimit();
+
+static void SetTurboFrame(bool elide) {
+	const bool wasTurbo = (gstate_c.skipDrawReason & SKIPDRAW_TURBO_FRAME) != 0;
+	if (elide == wasTurbo)
+		return;
+	if (elide)
+		gstate_c.skipDrawReason |= SKIPDRAW_TURBO_FRAME;
+	else
+		gstate_c.skipDrawReason &= ~(SKIPDRAW_TURBO_FRAME | SKIPDRAW_TURBO_DISPLAY_FB);
+	// Make the next draw re-check its target.
+	gstate_c.Dirty(DIRTY_FRAMEBUF);
+}
+
+static void GovernorStep(bool down) {
+	if (down) {
+		if (PSP_CoreParameter().renderScaleFactor > 1) {
+			PSP_CoreParameter().renderScaleDrop++;
+			gpu->Resized();
+		} else if (!g_Config.bAutoFrameSkip && governorFrameSkip < GOVERNOR_MAX_FRAMESKIP) {
+			governorFrameSkip++;
+		}
+	} else {
+		if (governorFrameSkip > 0) {
+			governorFrameSkip--;
+		} else if (PSP_CoreParameter().renderScaleDrop > 0) {
+			PSP_CoreParameter().renderScaleDrop--;
+			gpu->Resized();
+		}
+	}
+	governorSlowSeconds = 0;
+	governorFastSeconds = 0;
+}
+
+// Called once per second with the speed over that second.
+static void UpdateGovernor(double elapsed) {
+	const double sleepFraction = governorSleepTime / elapsed;
+	governorSleepTime = 0.0;
+
+	if (!g_Config.bPerformanceGovernor) {
+		if (governorFrameSkip != 0 || PSP_CoreParameter().renderScaleDrop != 0) {
+			governorFrameSkip = 0;
+			PSP_CoreParameter().renderScaleDrop = 0;
+			gpu->Resized();
+		}
+		return;
+	}
+
+	// No target to hold when unthrottled.
+	const int limit = FrameTimingLimit();
+	if (limit == 0 || wasPaused) {
+		governorSlowSeconds = 0;
+		governorFastSeconds = 0;
+		return;
+	}
+
+	const double target = 59.94 * limit / 60.0;
+	if (fps < target * 0.95) {
+		governorFastSeconds = 0;
+		if (++governorSlowSeconds >= GOVERNOR_SLOW_SECONDS)
+			GovernorStep(true);
+	} else if (sleepFraction > GOVERNOR_SPARE_FRACTION && (governorFrameSkip > 0 || PSP_CoreParameter().renderScaleDrop > 0)) {
+		governorSlowSeconds = 0;
+		if (++governorFastSeconds >= GOVERNOR_FAST_SECONDS)
+			GovernorStep(false);
+	} else {
+		governorSlowSeconds = 0;
+		governorFastSeconds = 0;
+	}
+}
+
+bool __DisplayGetGovernorState(int *renderScaleDrop, int *frameSkip) {
+	*renderScaleDrop = PSP_CoreParameter().renderScaleDrop;
+	*frameSkip = governorFrameSkip;
+	return g_Config.bPerformanceGovernor;
+}
+
 static bool IsRunningSlow() {
 	// Allow for some startup turbulence for 8 seconds before assuming things are bad.
 	if (fpsHistoryValid >= 8) {
@@ -485,6 +589,7 @@ static bool IsRunningSlow() {
 
 static void CalculateFPS() {
 	double now = time_now_d();
+	Reporting::NotePerfFlip(now);
 
 	if (now >= lastFpsTime + 1.0) {
 		double frames = (numVBlanks - lastFpsFrame);
@@ -492,6 +597,7 @@ static void CalculateFPS() {
 
 		fps = frames / (now - lastFpsTime);
 		flips = 60.0 * (double) (gpuStats.numFlips - lastNumFlips) / frames;
+		UpdateGovernor(now - lastFpsTime);
 
 		lastFpsFrame = numVBlanks;
 		lastNumFlips = gpuStats.numFlips;
@@ -526,17 +632,22 @@ double *__DisplayGetFrameTimes(int *out_valid, int *out_pos, double **out_sleep)
 void __DisplayGetDebugStats(char *stats, size_t bufsize) {
 	char statbuf[4096];
 	gpu->GetStats(statbuf, sizeof(statbuf));
+	char cachebuf[256];
+	RamCachingFileLoader::GetDebugStats(cachebuf, sizeof(cachebuf));
 
 	snprintf(stats, bufsize,
 		"Kernel processing time: %0.2f ms\n"
 		"Slowest syscall: %s : %0.2f ms\n"
-		"Most active syscall: %s : %0.2f ms\n%s",
+		"Most active syscall: %s : %0.2f ms\n"
+		"Idle skipped: %lld cycles (%0.1f%% of frame)\n%s%s",
 		kernelStats.msInSyscalls * 1000.0f,
 		kernelStats.slowestSyscallName ? kernelStats.slowestSyscallName : "(none)",
 		kernelStats.slowestSyscallTime * 1000.0f,
 		kernelStats.summedSlowestSyscallName ? kernelStats.summedSlowestSyscallName : "(none)",
 		kernelStats.summedSlowestSyscallTime * 1000.0f,
-		statbuf);
+		(long long)lastFrameIdleTicks,
+		lastFrameTicks == 0 ? 0.0 : lastFrameIdleTicks * 100.0 / lastFrameTicks,
+		cachebuf, statbuf);
 }
 
 
@@ -578,7 +689,7 @@ static int CalculateFrameSkip() {
 		// Use the set number of frames to skip
 		frameSkipNum = g_Config.iFrameSkip;
 	}
-	return frameSkipNum;
+	return std::max(frameSkipNum, governorFrameSkip);
 }
 
 // Let's collect all the throttling and frameskipping logic here.
@@ -590,7 +701,7 @@ static void DoFrameTiming(bool &throttle, bool &skipFrame, float timestep) {
 
 	// Check if the frameskipping code should be enabled. If neither throttling or frameskipping is on,
 	// we have nothing to do here.
-	bool doFrameSkip = g_Config.iFrameSkip != 0;
+	bool doFrameSkip = g_Config.iFrameSkip != 0 || governorFrameSkip != 0;
 	if (!throttle && !doFrameSkip)
 		return;
 
@@ -648,7 +759,9 @@ static void DoFrameTiming(bool &throttle, bool &skipFrame, float timestep) {
 #endif
 			}
 		}
-		curFrameTime = time_now_d();
+		double waited = time_now_d() - curFrameTime;
+		governorSleepTime += waited;
+		curFrameTime += waited;
 	}
 
 	lastFrameTime = nextFrameTime;
@@ -657,7 +770,7 @@ static void DoFrameTiming(bool &throttle, bool &skipFrame, float timestep) {
 
 static void DoFrameIdleTiming() {
 	PROFILE_THIS_SCOPE("timing");
-	if (!FrameTimingThrottled() || !g_Config.bEnableSound || wasPaused) {
+	if (!FrameTimingThrottled() || !g_Config.bEnableSound || wasPaused || PSP_CoreParameter().runAheadSpeculative) {
 		return;
 	}
 
@@ -690,6 +803,7 @@ static void DoFrameIdleTiming() {
 #endif
 		}
 
+		governorSleepTime += time_now_d() - before;
 		if (g_Config.bDrawFrameGraph || coreCollectDebugStats) {
 			frameSleepHistory[frameTimeHistoryPos] += time_now_d() - before;
 		}
@@ -708,6 +822,10 @@ void hleEnterVblank(u64 userdata, int cyclesLate) {
 	if (hCountBase > 0x7FFFFFFF) {
 		hCountBase -= 0x80000000;
 	}
+	u64 idleTicks = CoreTiming::GetIdleTicks();
+	lastFrameIdleTicks = idleTicks - frameStartIdleTicks;
+	lastFrameTicks = CoreTiming::GetTicks() - frameStartTicks;
+	frameStartIdleTicks = idleTicks;
 	frameStartTicks = CoreTiming::GetTicks();
 
 	CoreTiming::ScheduleEvent(msToCycles(vblankMs) - cyclesLate, leaveVblankEvent, vbCount + 1);
@@ -775,7 +893,9 @@ void __DisplayFlip(int cyclesLate) {
 
 	if (fbDirty || noRecentFlip || postEffectRequiresFlip) {
 		int frameSleepPos = frameTimeHistoryPos;
-		CalculateFPS();
+		const bool speculative = PSP_CoreParameter().runAheadSpeculative;
+		if (!speculative)
+			CalculateFPS();
 		DisplayFireFlip();
 
 		// Let the user know if we're running slow, so they know to adjust settings.
@@ -805,18 +925,28 @@ void __DisplayFlip(int cyclesLate) {
 		if (fastForwardSkipFlip && (!FrameTimingThrottled() || refreshRateNeedsSkip)) {
 			static double lastFlip = 0;
 			double now = time_now_d();
-			if ((now - lastFlip) < 1.0f / refreshRate) {
+			if ((gstate_c.skipDrawReason & SKIPDRAW_TURBO_FRAME) || (now - lastFlip) < 1.0f / refreshRate) {
 				forceNoFlip = true;
 			} else {
 				lastFlip = now;
 			}
+
+			// Turbo: if the next frame won't be shown either, don't bother drawing its display buffer.
+			const bool turbo = g_Config.iFastForwardMode == (int)FastForwardMode::TURBO && !FrameTimingThrottled() && g_Config.iRenderingMode != FB_NON_BUFFERED_MODE;
+			const bool elideNext = turbo && !GPURecord::IsActivePending() && (time_now_d() - lastFlip) < 1.0f / refreshRate;
+			SetTurboFrame(elideNext);
+		} else {
+			SetTurboFrame(false);
 		}
 
+		FrameTimeline_End(FrameTimelineLane::EMU);
+
 		// Setting CORE_NEXTFRAME causes a swap.
 		const bool fbReallyDirty = gpu->FramebufferReallyDirty();
 		if (fbReallyDirty || noRecentFlip || postEffectRequiresFlip) {
 			// Check first though, might've just quit / been paused.
-			if (!forceNoFlip && Core_NextFrame()) {
+			if (!forceNoFlip && Core_NextFrame() && !PSP_CoreParameter().runAheadHidden) {
+				FrameTimeline_Mark(FrameTimelineLane::FLIP);
 				gpu->CopyDisplayToOutput(fbReallyDirty);
 				if (fbReallyDirty) {
 					actualFlips++;
@@ -828,8 +958,11 @@ void __DisplayFlip(int cyclesLate) {
 			gpuStats.numFlips++;
 		}
 
-		bool throttle, skipFrame;
-		DoFrameTiming(throttle, skipFrame, (float)numVBlanksSinceFlip * timePerVblank);
+		// Run-ahead already waited for the frame that counts.
+		bool throttle = false, skipFrame = false;
+		if (!speculative)
+			DoFrameTiming(throttle, skipFrame, (float)numVBlanksSinceFlip * timePerVblank);
+		FrameTimeline_Begin(FrameTimelineLane::EMU);
 
 		int maxFrameskip = 8;
 		int frameSkipNum = CalculateFrameSkip();
@@ -869,6 +1002,7 @@ void __DisplayFlip(int cyclesLate) {
 void hleAfterFlip(u64 userdata, int cyclesLate) {
 	gpu->BeginFrame();  // doesn't really matter if begin or end of frame.
 	PPGeNotifyFrame();
+	FlushPendingMemInfo();
 
 	// This seems like as good a time as any to check if the config changed.
 	if (lagSyncScheduled != g_Config.bForceLagSync) {
@@ -906,9 +1040,9 @@ void hleLagSync(u64 userdata, int cyclesLate) {
 
 	const double goal = lastLagSync + (scale / 1000.0f);
 	double before = time_now_d();
-	// Don't lag too long ever, if they leave it paused.
+	// Don't lag too long ever, if they leave it paused.  Run-ahead's extra frames should run flat out.
 	double now = before;
-	while (now < goal && goal < now + 0.01) {
+	while (now < goal && goal < now + 0.01 && !PSP_CoreParameter().runAheadSpeculative) {
 		// Tight loop on win32 - intentionally, as timing is otherwise not precise enough.
 #ifndef _WIN32
 		const double left = goal - now;
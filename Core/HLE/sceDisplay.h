@@ -40,6 +40,8 @@ void __DisplayGetDebugStats(char stats[], size_t bufsize);
 void __DisplayGetFPS(float *out_vps, float *out_fps, float *out_actual_fps);
 void __DisplayGetVPS(float *out_vps);
 void __DisplayGetAveragedFPS(float *out_vps, float *out_fps);
+// Returns true if the performance governor is on, with how far it has currently stepped down.
+bool __DisplayGetGovernorState(int *renderScaleDrop, int *frameSkip);
 double *__DisplayGetFrameTimes(int *out_valid, int *out_pos, double **out_sleep);
 int __DisplayGetNumVblanks();
 int __DisplayGetVCount();
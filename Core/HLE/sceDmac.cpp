@@ -49,10 +49,15 @@ static int __DmacMemcpy(u32 dst, u32 src, u32 size) {
 	if (Memory::IsVRAMAddress(src) || Memory::IsVRAMAddress(dst)) {
 		skip = gpu->PerformMemoryCopy(dst, src, size);
 	}
-	if (!skip) {
+	// A copy onto itself changes nothing in memory, but the GPU might still care about it above.
+	if (!skip && dst != src) {
 		currentMIPS->InvalidateICache(src, size);
-		const std::string tag = "DmacMemcpy/" + GetMemWriteTagAt(src, size);
-		Memory::Memcpy(dst, src, size, tag.c_str(), tag.size());
+		u8 *to = Memory::GetPointer(dst);
+		const u8 *from = Memory::GetPointer(src);
+		if (to && from) {
+			memcpy(to, from, size);
+			NotifyMemInfoCopy(dst, src, size, "DmacMemcpy");
+		}
 		currentMIPS->InvalidateICache(dst, size);
 	}
 
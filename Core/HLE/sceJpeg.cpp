@@ -16,6 +16,8 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <algorithm>
+#include <cstring>
+#include <vector>
 #include "ext/jpge/jpgd.h"
 
 #include "Common/Common.h"
@@ -27,12 +29,24 @@
 #include "Core/HLE/sceMpeg.h"
 #include "GPU/GPUCommon.h"
 #include "Core/MemMap.h"
+#include "Core/MemMapHelpers.h"
 #include "Core/Reporting.h"
 
 // Uncomment if you want to dump JPEGs loaded through sceJpeg to a file
 // #define JPEG_DEBUG
 #ifdef JPEG_DEBUG
 #include "ext/xxhash.h"
+
+#ifdef _M_SSE
+#include <emmintrin.h>
+#endif
+#if PPSSPP_ARCH(ARM_NEON)
+#if defined(_MSC_VER) && PPSSPP_ARCH(ARM64)
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
 #endif
 
 struct u24_be {
@@ -92,7 +106,53 @@ static void __JpegCsc(u32 imageAddr, u32 yCbCrAddr, int widthHeight, int bufferW
 	u8 *Cr = Cb + sizeCb;
 
 	for (int y = 0; y < height; ++y) {
-		for (int x = 0; x < width; x += 4) {
+		int x = 0;
+		// Same math as convertYCbCrToABGR, 8 pixels (two chroma samples) at a time.
+#if defined(_M_SSE)
+		const __m128i c128 = _mm_set1_epi16(128);
+		const __m128i alpha = _mm_set1_epi8(-1);
+		for (; x + 8 <= width; x += 8) {
+			__m128i y16 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(Y + x)), _mm_setzero_si128());
+			__m128i cb = _mm_sub_epi16(_mm_set_epi16(Cb[1], Cb[1], Cb[1], Cb[1], Cb[0], Cb[0], Cb[0], Cb[0]), c128);
+			__m128i cr = _mm_sub_epi16(_mm_set_epi16(Cr[1], Cr[1], Cr[1], Cr[1], Cr[0], Cr[0], Cr[0], Cr[0]), c128);
+			Cb += 2;
+			Cr += 2;
+
+			__m128i r = _mm_add_epi16(_mm_add_epi16(y16, cr), _mm_add_epi16(_mm_srai_epi16(cr, 2), _mm_add_epi16(_mm_srai_epi16(cr, 3), _mm_srai_epi16(cr, 5))));
+			__m128i gcb = _mm_add_epi16(_mm_srai_epi16(cb, 2), _mm_add_epi16(_mm_srai_epi16(cb, 4), _mm_srai_epi16(cb, 5)));
+			__m128i gcr = _mm_add_epi16(_mm_add_epi16(_mm_srai_epi16(cr, 1), _mm_srai_epi16(cr, 3)), _mm_add_epi16(_mm_srai_epi16(cr, 4), _mm_srai_epi16(cr, 5)));
+			__m128i g = _mm_sub_epi16(_mm_sub_epi16(y16, gcb), gcr);
+			__m128i b = _mm_add_epi16(_mm_add_epi16(y16, cb), _mm_add_epi16(_mm_srai_epi16(cb, 1), _mm_add_epi16(_mm_srai_epi16(cb, 2), _mm_srai_epi16(cb, 6))));
+
+			// Saturating packs do the clamping.
+			__m128i rg = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), _mm_packus_epi16(g, g));
+			__m128i ba = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), alpha);
+			_mm_storeu_si128((__m128i *)(imageBuffer + x), _mm_unpacklo_epi16(rg, ba));
+			_mm_storeu_si128((__m128i *)(imageBuffer + x + 4), _mm_unpackhi_epi16(rg, ba));
+		}
+#elif PPSSPP_ARCH(ARM_NEON)
+		for (; x + 8 <= width; x += 8) {
+			int16x8_t y16 = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(Y + x)));
+			int16x8_t cb = vcombine_s16(vdup_n_s16(Cb[0] - 128), vdup_n_s16(Cb[1] - 128));
+			int16x8_t cr = vcombine_s16(vdup_n_s16(Cr[0] - 128), vdup_n_s16(Cr[1] - 128));
+			Cb += 2;
+			Cr += 2;
+
+			int16x8_t r = vaddq_s16(vaddq_s16(y16, cr), vaddq_s16(vshrq_n_s16(cr, 2), vaddq_s16(vshrq_n_s16(cr, 3), vshrq_n_s16(cr, 5))));
+			int16x8_t gcb = vaddq_s16(vshrq_n_s16(cb, 2), vaddq_s16(vshrq_n_s16(cb, 4), vshrq_n_s16(cb, 5)));
+			int16x8_t gcr = vaddq_s16(vaddq_s16(vshrq_n_s16(cr, 1), vshrq_n_s16(cr, 3)), vaddq_s16(vshrq_n_s16(cr, 4), vshrq_n_s16(cr, 5)));
+			int16x8_t g = vsubq_s16(vsubq_s16(y16, gcb), gcr);
+			int16x8_t b = vaddq_s16(vaddq_s16(y16, cb), vaddq_s16(vshrq_n_s16(cb, 1), vaddq_s16(vshrq_n_s16(cb, 2), vshrq_n_s16(cb, 6))));
+
+			uint8x8x4_t abgr;
+			abgr.val[0] = vqmovun_s16(r);
+			abgr.val[1] = vqmovun_s16(g);
+			abgr.val[2] = vqmovun_s16(b);
+			abgr.val[3] = vdup_n_u8(0xFF);
+			vst4_u8((u8 *)(imageBuffer + x), abgr);
+		}
+#endif
+		for (; x < width; x += 4) {
 			u8 y0 =  Y[x + 0];
 			u8 y1 =  Y[x + 1];
 			u8 y2 =  Y[x + 2];
@@ -128,47 +188,102 @@ static int sceJpegMJpegCsc(u32 imageAddr, u32 yCbCrAddr, int widthHeight, int bu
 	return 0;
 }
 
-static u32 convertARGBtoABGR(u32 argb) {
-	return ((argb & 0xFF00FF00)) | ((argb & 0x000000FF) << 16) | ((argb & 0x00FF0000) >> 16);
-}
-
-static int __DecodeJpeg(u32 jpegAddr, int jpegSize, u32 imageAddr) {
-	u8 *buf = Memory::GetPointer(jpegAddr);
-	int width, height, actual_components;
-	unsigned char *jpegBuf = jpgd::decompress_jpeg_image_from_memory(buf, jpegSize, &width, &height, &actual_components, 3);
+static unsigned char *__JpegDecompress(const u8 *buf, int jpegSize, int *width, int *height, int *actual_components) {
+	// Box chroma upsampling: we either subsample it right back down for YCbCr output, or it's video.
+	const uint32_t flags = jpgd::jpeg_decoder::cFlagBoxChromaFiltering;
+	unsigned char *jpegBuf = jpgd::decompress_jpeg_image_from_memory(buf, jpegSize, width, height, actual_components, 3, flags);
 
-	if (actual_components != 3) {
+	if (*actual_components != 3) {
 		// The assumption that the image was RGB was wrong...
 		// Try again.
-		int components = actual_components;
-		jpegBuf = jpgd::decompress_jpeg_image_from_memory(buf, jpegSize, &width, &height, &actual_components, components);
+		int components = *actual_components;
+		free(jpegBuf);
+		jpegBuf = jpgd::decompress_jpeg_image_from_memory(buf, jpegSize, width, height, actual_components, components, flags);
 	}
+	return jpegBuf;
+}
 
-	if (jpegBuf == NULL) {
-		return getWidthHeight(0, 0);
+static int __JpegConvertRGBToYCbCr(const void *data, u8 *output, int width, int height);
+
+// Decodes on a worker, like the ME would, and writes the output when the delay is over.
+class JpegDecodeWork : public HLEAsyncWork {
+public:
+	JpegDecodeWork(u32 jpegAddr, int jpegSize, u32 outAddr, bool yCbCr)
+		: outAddr_(outAddr), yCbCr_(yCbCr) {
+		u32 size = jpegSize < 0 ? 0 : Memory::ValidSize(jpegAddr, jpegSize);
+		const u8 *buf = Memory::GetPointer(jpegAddr);
+		jpeg_.assign(buf, buf + size);
+	}
+
+	void Run() override {
+		int actual_components = 0;
+		unsigned char *jpegBuf = __JpegDecompress(jpeg_.data(), (int)jpeg_.size(), &width_, &height_, &actual_components);
+		if (jpegBuf == nullptr) {
+			width_ = 0;
+			height_ = 0;
+			return;
+		}
+
+		if (actual_components == 3 && yCbCr_) {
+			output_.resize(width_ * height_ + ((width_ * height_) >> 2) * 2);
+			__JpegConvertRGBToYCbCr(jpegBuf, output_.data(), width_, height_);
+		} else if (actual_components == 3) {
+			// RGB to ABGR, alpha is left at zero.
+			output_.resize(width_ * height_ * 4);
+			const u8 *src = jpegBuf;
+			u8 *dst = output_.data();
+			for (int i = 0; i < width_ * height_; ++i) {
+				dst[0] = src[0];
+				dst[1] = src[1];
+				dst[2] = src[2];
+				dst[3] = 0;
+				src += 3;
+				dst += 4;
+			}
+		}
+		free(jpegBuf);
 	}
 
-	if (actual_components == 3) {
-			u24_be *imageBuffer = (u24_be*)jpegBuf;
-			u32_le *abgr = (u32_le *)Memory::GetPointer(imageAddr);
+	u32 Apply() override {
+		if (output_.empty()) {
+			return getWidthHeight(width_, height_);
+		}
+
+		if (yCbCr_) {
+			Memory::Memcpy(outAddr_, output_.data(), (u32)output_.size(), "JpegDecodeYCbCr");
+		} else {
 			int pspWidth = 0;
 			for (int w = 2; w <= 4096; w *= 2) {
-				if (w >= width && w >= height) {
+				if (w >= width_ && w >= height_) {
 					pspWidth = w;
 					break;
 				}
 			}
-			for (int y = 0; y < height; ++y) {
-				for (int x = 0; x < width; x++)	{
-					abgr[x] = convertARGBtoABGR(imageBuffer[x]);
-				}
-				imageBuffer += width;
-				abgr += pspWidth; // Smallest value power of 2 fitting width and height(needs to be square!)
+			// Smallest value power of 2 fitting width and height (needs to be square!)
+			for (int y = 0; y < height_; ++y) {
+				u32 dest = outAddr_ + y * pspWidth * 4;
+				Memory::Memcpy(dest, output_.data() + y * width_ * 4, width_ * 4, "JpegDecode");
 			}
+		}
+		return getWidthHeight(width_, height_);
 	}
 
-	free(jpegBuf);
-	return getWidthHeight(width, height);
+private:
+	std::vector<u8> jpeg_;
+	std::vector<u8> output_;
+	u32 outAddr_;
+	bool yCbCr_;
+	int width_ = 0;
+	int height_ = 0;
+};
+
+static int __JpegDecodeDelay() {
+	// Rough guess at the ME's speed, scaled by the size given to sceJpegCreateMJpeg.
+	return 300 + (mjpegWidth * mjpegHeight) / 100;
+}
+
+static int __DecodeJpeg(u32 jpegAddr, int jpegSize, u32 imageAddr) {
+	return hleDelayResultAsync(new JpegDecodeWork(jpegAddr, jpegSize, imageAddr, false), "jpeg decode", __JpegDecodeDelay());
 }
 
 static int sceJpegDecodeMJpeg(u32 jpegAddr, int jpegSize, u32 imageAddr, int dhtMode) {
@@ -220,22 +335,17 @@ static int getYCbCrBufferSize(int w, int h) {
 
 static int __JpegGetOutputInfo(u32 jpegAddr, int jpegSize, u32 colourInfoAddr) {
 	u8 *buf = Memory::GetPointer(jpegAddr);
-	int width, height, actual_components;
-	unsigned char *jpegBuf = jpgd::decompress_jpeg_image_from_memory(buf, jpegSize, &width, &height, &actual_components, 3);
-
-	if (actual_components != 3) {
-	// The assumption that the image was RGB was wrong...
-	// Try again.
-		int components = actual_components;
-		jpegBuf = jpgd::decompress_jpeg_image_from_memory(buf, jpegSize, &width, &height, &actual_components, components);
-	}
+	u32 size = jpegSize < 0 ? 0 : Memory::ValidSize(jpegAddr, jpegSize);
 
-	if (jpegBuf == NULL) {
+	// Only the header is needed for the size, no need to decode the whole image.
+	jpgd::jpeg_decoder_mem_stream stream(buf, size);
+	jpgd::jpeg_decoder decoder(&stream);
+	if (decoder.get_error_code() != jpgd::JPGD_SUCCESS) {
 		ERROR_LOG(ME, "sceJpegGetOutputInfo: Bad JPEG data");
 		return getYCbCrBufferSize(0, 0);
 	}
-
-	free(jpegBuf);
+	int width = decoder.get_width();
+	int height = decoder.get_height();
 	
 	// Buffer to store info about the color space in use.
 	// - Bits 24 to 32 (Always empty): 0x00
@@ -273,82 +383,37 @@ static int sceJpegGetOutputInfo(u32 jpegAddr, int jpegSize, u32 colourInfoAddr,
 	return __JpegGetOutputInfo(jpegAddr, jpegSize, colourInfoAddr);
 }
 
-static u32 convertRGBToYCbCr(u32 rgb) {
-	//see http://en.wikipedia.org/wiki/Yuv#Y.27UV444_to_RGB888_conversion for more information.
-	u8  r = (rgb >> 16) & 0xFF;
-	u8  g = (rgb >>  8) & 0xFF;
-	u8  b = (rgb >>  0) & 0xFF;
-	int  y = 0.299f * r + 0.587f * g + 0.114f * b + 0;
-	int cb = -0.169f * r - 0.331f * g + 0.499f * b + 128.0f;
-	int cr = 0.499f * r - 0.418f * g - 0.0813f * b + 128.0f;
-
-	// check yCbCr value
-	if ( y > 0xFF)  y = 0xFF; if ( y < 0)  y = 0;
-	if (cb > 0xFF) cb = 0xFF; if (cb < 0) cb = 0;
-	if (cr > 0xFF) cr = 0xFF; if (cr < 0) cr = 0;
-
-	return (y << 16) | (cb << 8) | cr;
+static inline u8 clampYCbCr(int v) {
+	return v > 0xFF ? 0xFF : (v < 0 ? 0 : (u8)v);
 }
 
-static int __JpegConvertRGBToYCbCr (const void *data, u32 bufferOutputAddr, int width, int height) {
-	u24_be *imageBuffer = (u24_be*)data;
+static int __JpegConvertRGBToYCbCr(const void *data, u8 *output, int width, int height) {
+	const u8 *rgb = (const u8 *)data;
 	int sizeY = width * height;
 	int sizeCb = sizeY >> 2;
-	u8 *Y = (u8*)Memory::GetPointer(bufferOutputAddr);
+	u8 *Y = output;
 	u8 *Cb = Y + sizeY;
 	u8 *Cr = Cb + sizeCb;
 
-	for (int y = 0; y < height; ++y) {
-		for (int x = 0; x < width; x += 4) {
-			u32 abgr0 = imageBuffer[x + 0];
-			u32 abgr1 = imageBuffer[x + 1];
-			u32 abgr2 = imageBuffer[x + 2];
-			u32 abgr3 = imageBuffer[x + 3];
-
-			u32 yCbCr0 = convertRGBToYCbCr(abgr0);
-			u32 yCbCr1 = convertRGBToYCbCr(abgr1);
-			u32 yCbCr2 = convertRGBToYCbCr(abgr2);
-			u32 yCbCr3 = convertRGBToYCbCr(abgr3);
-			
-			Y[x + 0] = (yCbCr0 >> 16) & 0xFF;
-			Y[x + 1] = (yCbCr1 >> 16) & 0xFF;
-			Y[x + 2] = (yCbCr2 >> 16) & 0xFF;
-			Y[x + 3] = (yCbCr3 >> 16) & 0xFF;
-
-			*Cb++ = (yCbCr0 >> 8) & 0xFF;
-			*Cr++ = yCbCr0 & 0xFF;
-		}
-		imageBuffer += width;
-		Y += width ;
+	// See http://en.wikipedia.org/wiki/Yuv#Y.27UV444_to_RGB888_conversion for more information.
+	// 16.16 fixed point versions of 0.299, 0.587, 0.114 and friends, so the compiler can vectorize.
+	// Luma is needed for every pixel, chroma only for the first of each 4.
+	for (int i = 0; i < sizeY; ++i) {
+		const u8 *p = rgb + i * 3;
+		Y[i] = clampYCbCr((19595 * p[0] + 38470 * p[1] + 7471 * p[2]) >> 16);
+	}
+	for (int i = 0; i < sizeY; i += 4) {
+		const u8 *p = rgb + i * 3;
+		int r = p[0], g = p[1], b = p[2];
+		*Cb++ = clampYCbCr((-11076 * r - 21692 * g + 32702 * b + (128 << 16)) >> 16);
+		*Cr++ = clampYCbCr((32702 * r - 27394 * g - 5328 * b + (128 << 16)) >> 16);
 	}
 	return getWidthHeight(width, height);
 }
 
 static int __JpegDecodeMJpegYCbCr(u32 jpegAddr, int jpegSize, u32 yCbCrAddr) {
-	u8 *buf = Memory::GetPointer(jpegAddr);
-	int width, height, actual_components;
-	unsigned char *jpegBuf = jpgd::decompress_jpeg_image_from_memory(buf, jpegSize, &width, &height, &actual_components, 3);
-
-	if (actual_components != 3) {
-		// The assumption that the image was RGB was wrong...
-		// Try again.
-		int components = actual_components;
-		jpegBuf = jpgd::decompress_jpeg_image_from_memory(buf, jpegSize, &width, &height, &actual_components, components);
-	}
-
-	if (jpegBuf == NULL) {
-		return getWidthHeight(0, 0);
-	}
-
-	if (actual_components == 3) {
-		__JpegConvertRGBToYCbCr(jpegBuf, yCbCrAddr, width, height);
-	}
-
-	free(jpegBuf);
-
 	// TODO: There's more...
-
-	return getWidthHeight(width, height);
+	return hleDelayResultAsync(new JpegDecodeWork(jpegAddr, jpegSize, yCbCrAddr, true), "jpeg decode", __JpegDecodeDelay());
 }
 
 static int sceJpegDecodeMJpegYCbCr(u32 jpegAddr, int jpegSize, u32 yCbCrAddr, int yCbCrSize, int dhtMode) {
@@ -15,6 +15,8 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
+
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/LogManager.h"
 #include "Core/Core.h"
@@ -491,6 +493,7 @@ SceUID KernelObjectPool::Create(KernelObject *obj, int rangeBottom, int rangeTop
 			occupied[i] = true;
 			pool[i] = obj;
 			pool[i]->uid = i + handleOffset;
+			AddToType(obj->GetIDType(), i);
 			return i + handleOffset;
 		}
 	}
@@ -499,6 +502,18 @@ SceUID KernelObjectPool::Create(KernelObject *obj, int rangeBottom, int rangeTop
 	return 0;
 }
 
+void KernelObjectPool::AddToType(int type, int slot) {
+	std::vector<int> &slots = slotsByType_[type];
+	slots.insert(std::lower_bound(slots.begin(), slots.end(), slot), slot);
+}
+
+void KernelObjectPool::RemoveFromType(int type, int slot) {
+	std::vector<int> &slots = slotsByType_[type];
+	auto it = std::lower_bound(slots.begin(), slots.end(), slot);
+	if (it != slots.end() && *it == slot)
+		slots.erase(it);
+}
+
 bool KernelObjectPool::IsValid(SceUID handle) const {
 	int index = handle - handleOffset;
 	if (index < 0 || index >= maxCount)
@@ -515,6 +530,7 @@ void KernelObjectPool::Clear() {
 		pool[i] = nullptr;
 		occupied[i] = false;
 	}
+	slotsByType_.clear();
 	nextID = initialNextID;
 }
 
@@ -576,6 +592,7 @@ void KernelObjectPool::DoState(PointerWrap &p) {
 				return;
 
 			pool[i]->uid = i + handleOffset;
+			AddToType(pool[i]->GetIDType(), i);
 		} else {
 			type = pool[i]->GetIDType();
 			Do(p, type);
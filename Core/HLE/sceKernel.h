@@ -19,6 +19,8 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "Common/Common.h"
 #include "Common/Log.h"
@@ -444,6 +446,7 @@ class KernelObjectPool {
 	u32 Destroy(SceUID handle) {
 		u32 error;
 		if (Get<T>(handle, error)) {
+			RemoveFromType(T::GetStaticIDType(), handle - handleOffset);
 			occupied[handle-handleOffset] = false;
 			delete pool[handle-handleOffset];
 			// Why weren't we zeroing before?
@@ -488,32 +491,26 @@ class KernelObjectPool {
 
 	template <class T, typename ArgT>
 	void Iterate(bool func(T *, ArgT), ArgT arg) {
-		int type = T::GetStaticIDType();
-		for (int i = 0; i < maxCount; i++) {
-			if (!occupied[i])
-				continue;
-			T *t = static_cast<T *>(pool[i]);
-			if (t->GetIDType() == type) {
-				if (!func(t, arg))
-					break;
-			}
+		const std::vector<int> &slots = slotsByType_[T::GetStaticIDType()];
+		for (size_t i = 0; i < slots.size(); ) {
+			int slot = slots[i];
+			if (!func(static_cast<T *>(pool[slot]), arg))
+				break;
+			// Only advance if func didn't destroy it.
+			if (i < slots.size() && slots[i] == slot)
+				++i;
 		}
 	}
 
 	int ListIDType(int type, SceUID_le *uids, int count) const {
-		int total = 0;
-		for (int i = 0; i < maxCount; i++) {
-			if (!occupied[i]) {
-				continue;
-			}
-			if (pool[i]->GetIDType() == type) {
-				if (total < count) {
-					*uids++ = pool[i]->GetUID();
-				}
-				++total;
-			}
+		auto it = slotsByType_.find(type);
+		if (it == slotsByType_.end())
+			return 0;
+		const std::vector<int> &slots = it->second;
+		for (int i = 0; i < count && i < (int)slots.size(); i++) {
+			*uids++ = slots[i] + handleOffset;
 		}
-		return total;
+		return (int)slots.size();
 	}
 
 	bool GetIDType(SceUID handle, int *type) const {
@@ -531,6 +528,9 @@ class KernelObjectPool {
 	int GetCount() const;
 
 private:
+	void AddToType(int type, int slot);
+	void RemoveFromType(int type, int slot);
+
 	enum {
 		maxCount = 4096,
 		handleOffset = 0x100,
@@ -539,6 +539,8 @@ class KernelObjectPool {
 	KernelObject *pool[maxCount];
 	bool occupied[maxCount];
 	int nextID;
+	// Occupied slots of each ID type, in slot order, so iterating one type doesn't scan the whole pool.
+	std::unordered_map<int, std::vector<int>> slotsByType_;
 };
 
 extern KernelObjectPool kernelObjects;
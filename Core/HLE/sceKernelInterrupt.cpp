@@ -655,9 +655,7 @@ static u32 sceKernelMemcpy(u32 dst, u32 src, u32 size)
 		}
 	}
 
-	const std::string tag = "KernelMemcpy/" + GetMemWriteTagAt(src, size);
-	NotifyMemInfo(MemBlockFlags::READ, src, size, tag.c_str(), tag.size());
-	NotifyMemInfo(MemBlockFlags::WRITE, dst, size, tag.c_str(), tag.size());
+	NotifyMemInfoCopy(dst, src, size, "KernelMemcpy");
 
 	return dst;
 }
@@ -688,9 +686,7 @@ static u32 sysclib_memcpy(u32 dst, u32 src, u32 size) {
 	if (Memory::IsValidRange(dst, size) && Memory::IsValidRange(src, size)) {
 		memcpy(Memory::GetPointer(dst), Memory::GetPointer(src), size);
 	}
-	const std::string tag = "KernelMemcpy/" + GetMemWriteTagAt(src, size);
-	NotifyMemInfo(MemBlockFlags::READ, src, size, tag.c_str(), tag.size());
-	NotifyMemInfo(MemBlockFlags::WRITE, dst, size, tag.c_str(), tag.size());
+	NotifyMemInfoCopy(dst, src, size, "KernelMemcpy");
 	return dst;
 }
 
@@ -789,9 +785,7 @@ static u32 sysclib_memmove(u32 dst, u32 src, u32 size) {
 	if (Memory::IsValidRange(dst, size) && Memory::IsValidRange(src, size)) {
 		memmove(Memory::GetPointer(dst), Memory::GetPointer(src), size);
 	}
-	const std::string tag = "KernelMemmove/" + GetMemWriteTagAt(src, size);
-	NotifyMemInfo(MemBlockFlags::READ, src, size, tag.c_str(), tag.size());
-	NotifyMemInfo(MemBlockFlags::WRITE, dst, size, tag.c_str(), tag.size());
+	NotifyMemInfoCopy(dst, src, size, "KernelMemmove");
 	return 0;
 }
 
@@ -24,6 +24,8 @@
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/Serialize/SerializeSet.h"
+#include "Common/Crypto/sha1.h"
+#include "Common/File/DirListing.h"
 #include "Common/File/FileUtil.h"
 #include "Common/StringUtils.h"
 #include "Core/Config.h"
@@ -40,6 +42,7 @@
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSAnalyst.h"
 #include "Core/MIPS/MIPSCodeUtils.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/ELF/ElfReader.h"
 #include "Core/ELF/PBPReader.h"
 #include "Core/ELF/PrxDecrypter.h"
@@ -849,6 +852,11 @@ void UnexportFuncSymbol(const FuncSymbolExport &func) {
 }
 
 void PSPModule::Cleanup() {
+	if (textEnd > textStart) {
+		std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
+		if (MIPSComp::jit)
+			MIPSComp::jit->SaveModuleCache(textStart, textEnd - textStart + 4);
+	}
 	MIPSAnalyst::ForgetFunctions(textStart, textEnd);
 
 	loadedModules.erase(GetUID());
@@ -874,6 +882,96 @@ void PSPModule::Cleanup() {
 	}
 }
 
+// Decrypted (and decompressed) modules, keyed on the SHA-1 of the encrypted file, so later boots skip KIRK.
+static const u32 PRX_CACHE_MAGIC = 0x43585250;  // PRXC
+static const u32 PRX_CACHE_VERSION = 1;
+static const u64 PRX_CACHE_MAX_BYTES = 64 * 1024 * 1024;
+
+struct PrxCacheHeader {
+	u32_le magic;
+	u32_le version;
+	s32_le decryptedSize;
+	u32_le dataSize;
+};
+
+static Path PrxCacheDirectory() {
+	return GetSysDirectory(DIRECTORY_CACHE) / "prx";
+}
+
+static std::string PrxCacheFilename(const u8 *encrypted, u32 size) {
+	unsigned char digest[20];
+	sha1((unsigned char *)encrypted, (int)size, digest);
+	std::string name;
+	for (int i = 0; i < 20; ++i)
+		name += StringFromFormat("%02x", digest[i]);
+	return name + ".prx";
+}
+
+static bool LoadCachedPrx(const std::string &filename, u8 *out, u32 outSize, int *decryptedSize) {
+	FILE *f = File::OpenCFile(PrxCacheDirectory() / filename, "rb");
+	if (!f)
+		return false;
+	PrxCacheHeader header;
+	bool success = fread(&header, sizeof(header), 1, f) == 1;
+	success = success && header.magic == PRX_CACHE_MAGIC && header.version == PRX_CACHE_VERSION;
+	success = success && header.dataSize <= outSize && header.decryptedSize > 0;
+	success = success && fread(out, 1, header.dataSize, f) == header.dataSize;
+	fclose(f);
+	if (success) {
+		*decryptedSize = header.decryptedSize;
+		DEBUG_LOG(SCEMODULE, "Using cached decrypted module %s", filename.c_str());
+	}
+	return success;
+}
+
+// Drops the oldest entries once the cache grows past its limit.
+static void TrimPrxCache(const Path &dir) {
+	std::vector<File::FileInfo> files;
+	File::GetFilesInDir(dir, &files, "prx");
+	u64 total = 0;
+	for (const auto &file : files)
+		total += file.size;
+	if (total <= PRX_CACHE_MAX_BYTES)
+		return;
+
+	std::sort(files.begin(), files.end(), [](const File::FileInfo &a, const File::FileInfo &b) {
+		return a.mtime < b.mtime;
+	});
+	// Leave some room, so we don't do this for every module.
+	for (const auto &file : files) {
+		if (total <= PRX_CACHE_MAX_BYTES * 3 / 4)
+			break;
+		if (File::Delete(file.fullName))
+			total -= file.size;
+	}
+}
+
+static void SaveCachedPrx(const std::string &filename, const u8 *data, u32 dataSize, int decryptedSize) {
+	const Path dir = PrxCacheDirectory();
+	if (!File::Exists(dir) && !File::CreateFullPath(dir))
+		return;
+
+	// Write under a temporary name first, so a crash can't leave a truncated entry.
+	const Path tempPath = dir / (filename + ".tmp");
+	FILE *f = File::OpenCFile(tempPath, "wb");
+	if (!f)
+		return;
+	PrxCacheHeader header;
+	header.magic = PRX_CACHE_MAGIC;
+	header.version = PRX_CACHE_VERSION;
+	header.decryptedSize = decryptedSize;
+	header.dataSize = dataSize;
+	bool success = fwrite(&header, sizeof(header), 1, f) == 1;
+	success = success && fwrite(data, 1, dataSize, f) == dataSize;
+	fclose(f);
+	if (!success || !File::Rename(tempPath, dir / filename)) {
+		File::Delete(tempPath);
+		return;
+	}
+
+	TrimPrxCache(dir);
+}
+
 static void __SaveDecryptedEbootToStorageMedia(const u8 *decryptedEbootDataPtr, const u32 length) {
 	if (!decryptedEbootDataPtr) {
 		ERROR_LOG(SCEMODULE, "Error saving decrypted EBOOT.BIN: invalid pointer");
@@ -1193,7 +1291,16 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 		newptr = new u8[maxElfSize];
 		ptr = newptr;
 		magicPtr = (u32_le *)ptr;
-		int ret = pspDecryptPRX(in, (u8*)ptr, head->psp_size);
+
+		std::string cacheFilename;
+		bool fromCache = false;
+		int ret = 0;
+		if (g_Config.bCacheDecryptedModules && !reportedModule) {
+			cacheFilename = PrxCacheFilename(in, head->psp_size);
+			fromCache = LoadCachedPrx(cacheFilename, (u8 *)ptr, maxElfSize, &ret);
+		}
+		if (!fromCache)
+			ret = pspDecryptPRX(in, (u8*)ptr, head->psp_size);
 		if (reportedModule) {
 			// This should happen for all "kernel" modules.
 			*error_string = "Missing key";
@@ -1236,7 +1343,7 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 			module->nm.bss_size = head->bss_size;
 
 			// decompress if required
-			if (isGzip)
+			if (isGzip && !fromCache)
 			{
 				auto temp = new u8[ret];
 				memcpy(temp, ptr, ret);
@@ -1244,6 +1351,10 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 				delete[] temp;
 			}
 
+			if (!fromCache && !cacheFilename.empty() && *magicPtr == 0x464c457f) {
+				SaveCachedPrx(cacheFilename, ptr, isGzip ? maxElfSize : ret, ret);
+			}
+
 			// If we've made it this far, it should be safe to dump.
 			if (g_Config.bDumpDecryptedEboot) {
 				INFO_LOG(SCEMODULE, "Dumping decrypted EBOOT.BIN to file.");
@@ -1577,6 +1688,11 @@ static PSPModule *__KernelLoadELFFromPtr(const u8 *ptr, size_t elfSize, u32 load
 		if (module->nm.entry_addr == 0)
 			module->nm.entry_addr = module->nm.module_start_func;
 
+		if (module->textEnd > module->textStart) {
+			std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
+			if (MIPSComp::jit)
+				MIPSComp::jit->LoadModuleCache(module->textStart, module->textEnd - module->textStart + 4);
+		}
 		MIPSAnalyst::PrecompileFunctions();
 
 	} else {
@@ -1906,7 +2022,7 @@ void __KernelGPUReplay() {
 		Core_Stop();
 	}
 
-	if (PSP_CoreParameter().headLess && !PSP_CoreParameter().startBreak) {
+	if (PSP_CoreParameter().headLess && !PSP_CoreParameter().startBreak && !PSP_CoreParameter().benchmark) {
 		PSPPointer<u8> topaddr;
 		u32 linesize = 512;
 		__DisplayGetFramebuf(&topaddr, &linesize, nullptr, 0);
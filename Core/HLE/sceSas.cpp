@@ -38,6 +38,7 @@
 #include "Common/Log.h"
 #include "Core/Config.h"
 #include "Core/CoreTiming.h"
+#include "Core/Debugger/MemBlockInfo.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HLE/FunctionWrappers.h"
 #include "Core/MIPS/MIPS.h"
@@ -89,6 +90,9 @@ struct SasThreadParams {
 	u32 inAddr;
 	int leftVol;
 	int rightVol;
+	int outSamples;
+	// Set while sasThreadOut holds a grain that hasn't been copied to outAddr yet.
+	bool pending;
 };
 
 static std::thread *sasThread;
@@ -98,6 +102,10 @@ static std::condition_variable sasWake;
 static std::condition_variable sasDone;
 static volatile int sasThreadState = SasThreadState::DISABLED;
 static SasThreadParams sasThreadParams;
+// The SAS thread never touches the game's in/out buffers directly.  The input is captured when the mix
+// is queued, and the output is copied back on the emu thread when the game's sceSasCore wait ends.
+static s16 sasThreadIn[PSP_SAS_MAX_GRAIN * 2];
+static s16 sasThreadOut[PSP_SAS_MAX_GRAIN * 4];
 static int sasMixEvent = -1;
 
 int __SasThread() {
@@ -107,7 +115,8 @@ int __SasThread() {
 	while (sasThreadState != SasThreadState::DISABLED) {
 		sasWake.wait(guard);
 		if (sasThreadState == SasThreadState::QUEUED) {
-			sas->Mix(sasThreadParams.outAddr, sasThreadParams.inAddr, sasThreadParams.leftVol, sasThreadParams.rightVol);
+			const s16 *inp = sasThreadParams.inAddr ? sasThreadIn : nullptr;
+			sas->MixToBuffer(sasThreadOut, inp, sasThreadParams.leftVol, sasThreadParams.rightVol);
 
 			std::lock_guard<std::mutex> doneGuard(sasDoneMutex);
 			sasThreadState = SasThreadState::READY;
@@ -117,10 +126,27 @@ int __SasThread() {
 	return 0;
 }
 
+static void __SasCommitMix() {
+	if (!sasThreadParams.pending)
+		return;
+	sasThreadParams.pending = false;
+
+	u32 outAddr = sasThreadParams.outAddr;
+	u32 outBytes = sasThreadParams.outSamples * sizeof(s16);
+	if (Memory::IsValidRange(outAddr, outBytes)) {
+		memcpy(Memory::GetPointer(outAddr), sasThreadOut, outBytes);
+		NotifyMemInfo(MemBlockFlags::WRITE, outAddr, outBytes, "SasMix");
+	}
+}
+
+// Waits for the SAS thread and makes its output visible.  Anything that reads or changes SAS state must call this first.
 static void __SasDrain() {
-	std::unique_lock<std::mutex> guard(sasDoneMutex);
-	while (sasThreadState == SasThreadState::QUEUED)
-		sasDone.wait(guard);
+	{
+		std::unique_lock<std::mutex> guard(sasDoneMutex);
+		while (sasThreadState == SasThreadState::QUEUED)
+			sasDone.wait(guard);
+	}
+	__SasCommitMix();
 }
 
 static void __SasEnqueueMix(u32 outAddr, u32 inAddr = 0, int leftVol = 0, int rightVol = 0) {
@@ -130,10 +156,8 @@ static void __SasEnqueueMix(u32 outAddr, u32 inAddr = 0, int leftVol = 0, int ri
 		return;
 	}
 
-	if (sasThreadState == SasThreadState::QUEUED) {
-		// Wait for the queue to drain.
-		__SasDrain();
-	}
+	// Wait for the queue to drain, and flush out the previous grain if it's still pending.
+	__SasDrain();
 
 	// We're safe to write, since it can't be processing now anymore.
 	// No other thread enqueues.
@@ -141,6 +165,18 @@ static void __SasEnqueueMix(u32 outAddr, u32 inAddr = 0, int leftVol = 0, int ri
 	sasThreadParams.inAddr = inAddr;
 	sasThreadParams.leftVol = leftVol;
 	sasThreadParams.rightVol = rightVol;
+	sasThreadParams.outSamples = sas->GetOutputSamples();
+	sasThreadParams.pending = true;
+
+	if (inAddr) {
+		u32 inBytes = sas->GetGrainSize() * 2 * sizeof(s16);
+		if (Memory::IsValidRange(inAddr, inBytes)) {
+			memcpy(sasThreadIn, Memory::GetPointer(inAddr), inBytes);
+			NotifyMemInfo(MemBlockFlags::READ, inAddr, inBytes, "SasMix");
+		} else {
+			memset(sasThreadIn, 0, inBytes);
+		}
+	}
 
 	// And now, notify.
 	sasWakeMutex.lock();
@@ -151,6 +187,7 @@ static void __SasEnqueueMix(u32 outAddr, u32 inAddr = 0, int leftVol = 0, int ri
 
 static void __SasDisableThread() {
 	if (sasThreadState != SasThreadState::DISABLED) {
+		__SasDrain();
 		sasWakeMutex.lock();
 		sasThreadState = SasThreadState::DISABLED;
 		sasWake.notify_one();
@@ -169,9 +206,10 @@ static void sasMixFinish(u64 userdata, int cycleslate) {
 	SceUID verify = __KernelGetWaitID(threadID, WAITTYPE_HLEDELAY, error);
 	u64 result = __KernelGetWaitValue(threadID, error);
 
+	// Wait until it's actually complete, and the output is in place, before waking the thread.
+	__SasDrain();
+
 	if (error == 0 && verify == 1) {
-		// Wait until it's actually complete before waking the thread.
-		__SasDrain();
 
 		__KernelResumeThreadFromWait(threadID, result);
 		__KernelReSchedule("woke from sas mix");
@@ -184,6 +222,7 @@ void __SasInit() {
 	sas = new SasInstance();
 
 	sasMixEvent = CoreTiming::RegisterEvent("SasMix", sasMixFinish);
+	sasThreadParams.pending = false;
 
 	if (g_Config.bSeparateSASThread) {
 		sasThreadState = SasThreadState::READY;
@@ -198,10 +237,8 @@ void __SasDoState(PointerWrap &p) {
 	if (!s)
 		return;
 
-	if (sasThreadState == SasThreadState::QUEUED) {
-		// Wait for the queue to drain.  Don't want to save the wrong stuff.
-		__SasDrain();
-	}
+	// Wait for the queue to drain.  Don't want to save the wrong stuff, or lose a grain that isn't written yet.
+	__SasDrain();
 
 	DoClass(p, sas);
 
@@ -40,20 +40,28 @@
 
 Camera::Config *config;
 
-unsigned int videoBufferLength = 0;
-unsigned int nextVideoFrame = 0;
-uint8_t *videoBuffer;
-std::mutex videoBufferMutex;
-
 enum {
 	VIDEO_BUFFER_SIZE = 40 * 1000,
 };
 
+// The latest frame is read from videoFrames[readyFrame] under the lock. The capture thread encodes
+// into the other one without it, and then swaps them, so neither side waits on the conversion.
+// These are never freed, since a capture thread may still be finishing a frame after shutdown.
+static uint8_t videoFrames[2][VIDEO_BUFFER_SIZE];
+static unsigned int videoFrameLength[2];
+static int readyFrame = 0;
+static bool videoFramesActive = false;
+unsigned int nextVideoFrame = 0;
+std::mutex videoBufferMutex;
+
 void __UsbCamInit() {
 	config       = new Camera::Config();
 	config->mode = Camera::Mode::Unused;
 	config->type = Camera::ConfigType::CfNone;
-	videoBuffer  = new uint8_t[VIDEO_BUFFER_SIZE];
+	std::lock_guard<std::mutex> lock(videoBufferMutex);
+	videoFrameLength[0] = 0;
+	videoFrameLength[1] = 0;
+	videoFramesActive = true;
 }
 
 void __UsbCamDoState(PointerWrap &p) {
@@ -73,13 +81,15 @@ void __UsbCamShutdown() {
 	if (config->mode == Camera::Mode::Video) { // stillImage? TBD
 		Camera::stopCapture();
 	}
-	delete[] videoBuffer;
-	videoBuffer = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(videoBufferMutex);
+		videoFramesActive = false;
+	}
 	delete config;
 	config = nullptr;
 }
 
-// TODO: Technically, we should store the videoBuffer into the savestate, if this
+// TODO: Technically, we should store the current video frame into the savestate, if this
 // module has been initialized.
 
 static int getCameraResolution(Camera::ConfigType type, int *width, int *height) {
@@ -176,16 +186,8 @@ static int sceUsbCamStartVideo() {
 	int width, height;
 	getCameraResolution(config->type, &width, &height);
 
-	unsigned char* jpegData = nullptr;
-	int jpegLen = 0;
-	__cameraDummyImage(width, height, &jpegData, &jpegLen);
-	videoBufferLength = jpegLen;
-	memset(videoBuffer, 0, VIDEO_BUFFER_SIZE);
-	if (jpegData) {
-		memcpy(videoBuffer, jpegData, jpegLen);
-		free(jpegData);
-		jpegData = nullptr;
-	}
+	// Shown until the first real frame arrives.
+	videoFrameLength[readyFrame] = __cameraDummyImage(width, height, videoFrames[readyFrame], VIDEO_BUFFER_SIZE);
 
 	Camera::startCapture();
 	return 0;
@@ -196,22 +198,21 @@ static int sceUsbCamStopVideo() {
 	return 0;
 }
 
-static int sceUsbCamReadVideoFrameBlocking(u32 bufAddr, u32 size) {
+static u32 copyVideoFrame(u32 bufAddr, u32 size) {
 	std::lock_guard<std::mutex> lock(videoBufferMutex);
-	u32 transferSize = std::min(videoBufferLength, size);
+	u32 transferSize = std::min(videoFrameLength[readyFrame], size);
 	if (Memory::IsValidRange(bufAddr, size)) {
-		Memory::Memcpy(bufAddr, videoBuffer, transferSize);
+		Memory::Memcpy(bufAddr, videoFrames[readyFrame], transferSize);
 	}
 	return transferSize;
 }
 
+static int sceUsbCamReadVideoFrameBlocking(u32 bufAddr, u32 size) {
+	return copyVideoFrame(bufAddr, size);
+}
+
 static int sceUsbCamReadVideoFrame(u32 bufAddr, u32 size) {
-	std::lock_guard<std::mutex> lock(videoBufferMutex);
-	u32 transferSize = std::min(videoBufferLength, size);
-	if (Memory::IsValidRange(bufAddr, size)) {
-		Memory::Memcpy(bufAddr, videoBuffer, transferSize);
-	}
-	nextVideoFrame = transferSize;
+	nextVideoFrame = copyVideoFrame(bufAddr, size);
 	return 0;
 }
 
@@ -386,15 +387,31 @@ void Camera::onCameraDeviceChange() {
 
 void Camera::pushCameraImage(long long length, unsigned char* image) {
 	std::lock_guard<std::mutex> lock(videoBufferMutex);
-	if (!videoBuffer) {
+	if (!videoFramesActive) {
 		return;
 	}
-	memset(videoBuffer, 0, VIDEO_BUFFER_SIZE);
+	// Straight into the ready frame, the reader can't see it until we let go of the lock anyway.
 	if (length > VIDEO_BUFFER_SIZE) {
-		videoBufferLength = 0;
+		videoFrameLength[readyFrame] = 0;
 		ERROR_LOG(HLE, "pushCameraImage: length error: %lld > %d", length, VIDEO_BUFFER_SIZE);
 	} else {
-		videoBufferLength = length;
-		memcpy(videoBuffer, image, length);
+		videoFrameLength[readyFrame] = (unsigned int)length;
+		memcpy(videoFrames[readyFrame], image, length);
+	}
+}
+
+unsigned char *Camera::acquireCameraImageBuffer(int *maxLength) {
+	// Only the capture thread uses the other frame, and readyFrame only changes in publishCameraImage().
+	std::lock_guard<std::mutex> lock(videoBufferMutex);
+	*maxLength = VIDEO_BUFFER_SIZE;
+	return videoFrames[readyFrame ^ 1];
+}
+
+void Camera::publishCameraImage(int length) {
+	std::lock_guard<std::mutex> lock(videoBufferMutex);
+	if (!videoFramesActive || length <= 0 || length > VIDEO_BUFFER_SIZE) {
+		return;
 	}
+	videoFrameLength[readyFrame ^ 1] = length;
+	readyFrame ^= 1;
 }
@@ -121,4 +121,9 @@ namespace Camera {
 	int startCapture();
 	int stopCapture();
 	void pushCameraImage(long long length, unsigned char *image);
+
+	// Lets a capture thread encode straight into the frame buffers, instead of pushCameraImage().
+	// Only one thread may do this at a time. The buffer stays valid until publishCameraImage().
+	unsigned char *acquireCameraImageBuffer(int *maxLength);
+	void publishCameraImage(int length);
 }
@@ -22,12 +22,38 @@
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/Serialize/SerializeMap.h"
 #include "Common/Serialize/SerializeSet.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Core/MIPS/MIPS.h"
 #include "Core/Reporting.h"
 #include "Core/System.h"
 #include "Core/HW/AsyncIOManager.h"
 #include "Core/FileSystems/MetaFileSystem.h"
 
+// Reads on different files can overlap, so with the IO thread they run as tasks, up to this many at once.
+// The IO thread still takes events in order, so the emulated timing is the same.
+static const int MAX_READS_IN_FLIGHT = 4;
+
+class AsyncIOReadTask : public Task {
+public:
+	AsyncIOReadTask(AsyncIOManager *manager, const AsyncIOEvent &ev) : manager_(manager), ev_(ev) {}
+
+	TaskType Type() const override {
+		return TaskType::IO_BLOCKING;
+	}
+
+	void Run() override {
+		manager_->Read(ev_.handle, ev_.buf, ev_.bytes, ev_.invalidateAddr);
+
+		std::lock_guard<std::mutex> guard(manager_->readsLock_);
+		manager_->readsInFlight_--;
+		manager_->readsWait_.notify_all();
+	}
+
+private:
+	AsyncIOManager *manager_;
+	AsyncIOEvent ev_;
+};
+
 bool AsyncIOManager::HasOperation(u32 handle) {
 	if (resultsPending_.find(handle) != resultsPending_.end()) {
 		return true;
@@ -49,6 +75,7 @@ void AsyncIOManager::ScheduleOperation(AsyncIOEvent ev) {
 }
 
 void AsyncIOManager::Shutdown() {
+	WaitForHandedOffEvents();
 	std::lock_guard<std::mutex> guard(resultsLock_);
 	resultsPending_.clear();
 	results_.clear();
@@ -116,7 +143,16 @@ u64 AsyncIOManager::ResultFinishTicks(u32 handle) {
 void AsyncIOManager::ProcessEvent(AsyncIOEvent ev) {
 	switch (ev.type) {
 	case IO_EVENT_READ:
-		Read(ev.handle, ev.buf, ev.bytes, ev.invalidateAddr);
+		if (ThreadEnabled()) {
+			{
+				std::unique_lock<std::mutex> guard(readsLock_);
+				readsWait_.wait(guard, [&] { return readsInFlight_ < MAX_READS_IN_FLIGHT; });
+				readsInFlight_++;
+			}
+			g_threadManager.EnqueueTask(new AsyncIOReadTask(this, ev));
+		} else {
+			Read(ev.handle, ev.buf, ev.bytes, ev.invalidateAddr);
+		}
 		break;
 
 	case IO_EVENT_WRITE:
@@ -128,6 +164,11 @@ void AsyncIOManager::ProcessEvent(AsyncIOEvent ev) {
 	}
 }
 
+void AsyncIOManager::WaitForHandedOffEvents() {
+	std::unique_lock<std::mutex> guard(readsLock_);
+	readsWait_.wait(guard, [&] { return readsInFlight_ == 0; });
+}
+
 void AsyncIOManager::Read(u32 handle, u8 *buf, size_t bytes, u32 invalidateAddr) {
 	int usec = 0;
 	s64 result = pspFileSystem.ReadFile(handle, buf, bytes, usec);
@@ -155,6 +196,8 @@ void AsyncIOManager::DoState(PointerWrap &p) {
 		return;
 
 	SyncThread();
+	// SyncThread() returns early when the core isn't running.
+	WaitForHandedOffEvents();
 	std::lock_guard<std::mutex> guard(resultsLock_);
 	Do(p, resultsPending_);
 	if (s >= 2) {
@@ -15,6 +15,7 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <condition_variable>
 #include <map>
 #include <set>
 #include <mutex>
@@ -93,8 +94,11 @@ class AsyncIOManager : public IOThreadEventQueue {
 	bool ShouldExitEventLoop() override {
 		return coreState == CORE_BOOT_ERROR || coreState == CORE_RUNTIME_ERROR || coreState == CORE_POWERDOWN;
 	}
+	void WaitForHandedOffEvents() override;
 
 private:
+	friend class AsyncIOReadTask;
+
 	bool PopResult(u32 handle, AsyncIOResult &result);
 	bool ReadResult(u32 handle, AsyncIOResult &result);
 	void Read(u32 handle, u8 *buf, size_t bytes, u32 invalidateAddr);
@@ -106,4 +110,9 @@ class AsyncIOManager : public IOThreadEventQueue {
 	std::condition_variable resultsWait_;
 	std::set<u32> resultsPending_;
 	std::map<u32, AsyncIOResult> results_;
+
+	// Reads running on the thread manager's I/O threads.
+	std::mutex readsLock_;
+	std::condition_variable readsWait_;
+	int readsInFlight_ = 0;
 };
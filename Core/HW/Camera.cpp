@@ -16,49 +16,61 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include "ppsspp_config.h"
+#include <vector>
+
 #include "Camera.h"
 #include "Core/Config.h"
 
-void convert_frame(int inw, int inh, unsigned char *inData, AVPixelFormat inFormat,
-					int outw, int outh, unsigned char **outData, int *outLen) {
+static int encode_jpeg(const unsigned char *rgbData, int width, int height, unsigned char *outData, int maxLen) {
+	jpge::params params;
+	params.m_quality = 60;
+	params.m_subsampling = jpge::H2V2;
+	params.m_two_pass_flag = false;
+	int outLen = maxLen;
+	if (!jpge::compress_image_to_jpeg_file_in_memory(outData, outLen, width, height, 3, rgbData, params))
+		return 0;
+	return outLen;
+}
+
+// Scales and converts a host frame on the capture thread, and encodes it straight into the
+// frame buffer sceUsbCam reads from. The scaler and RGB buffer are kept between frames, only
+// one capture thread runs at a time.
+static void convert_frame(int inw, int inh, unsigned char *inData, AVPixelFormat inFormat, int outw, int outh) {
+	static struct SwsContext *sws_context = nullptr;
+	static std::vector<unsigned char> rgbData;
 
-	struct SwsContext *sws_context = sws_getContext(
+	sws_context = sws_getCachedContext(sws_context,
 				inw, inh, inFormat,
 				outw, outh, AV_PIX_FMT_RGB24,
 				SWS_BICUBIC, NULL, NULL, NULL);
+	if (!sws_context)
+		return;
 
 	// resize
 	uint8_t *src[4] = {0};
 	uint8_t *dst[4] = {0};
 	int srcStride[4], dstStride[4];
 
-	unsigned char *rgbData = (unsigned char*)malloc(outw * outh * 4);
+	rgbData.resize(outw * outh * 4);
 
 	av_image_fill_linesizes(srcStride, inFormat,         inw);
 	av_image_fill_linesizes(dstStride, AV_PIX_FMT_RGB24, outw);
 
 	av_image_fill_pointers(src, inFormat,         inh,  inData,  srcStride);
-	av_image_fill_pointers(dst, AV_PIX_FMT_RGB24, outh, rgbData, dstStride);
+	av_image_fill_pointers(dst, AV_PIX_FMT_RGB24, outh, rgbData.data(), dstStride);
 
 	sws_scale(sws_context,
 		src, srcStride, 0, inh,
 		dst, dstStride);
 
 	// compress jpeg
-	*outLen = outw * outh * 2;
-	*outData = (unsigned char*)malloc(*outLen);
-
-	jpge::params params;
-	params.m_quality = 60;
-	params.m_subsampling = jpge::H2V2;
-	params.m_two_pass_flag = false;
-	jpge::compress_image_to_jpeg_file_in_memory(
-		*outData, *outLen, outw, outh, 3, rgbData, params);
-	free(rgbData);
+	int maxLen = 0;
+	unsigned char *outData = Camera::acquireCameraImageBuffer(&maxLen);
+	Camera::publishCameraImage(encode_jpeg(rgbData.data(), outw, outh, outData, maxLen));
 }
 
-void __cameraDummyImage(int width, int height, unsigned char** outData, int* outLen) {
-	unsigned char* rgbData = (unsigned char*)malloc(3 * width * height);
+int __cameraDummyImage(int width, int height, unsigned char *outData, int maxLen) {
+	std::vector<unsigned char> rgbData(3 * width * height);
 	for (int y = 0; y < height; y++) {
 		for (int x = 0; x < width; x++) {
 			rgbData[3 * (y * width + x) + 0] = x*255/width;
@@ -67,16 +79,7 @@ void __cameraDummyImage(int width, int height, unsigned char** outData, int* out
 		}
 	}
 
-	*outLen = width * height * 2;
-	*outData = (unsigned char*)malloc(*outLen);
-
-	jpge::params params;
-	params.m_quality = 60;
-	params.m_subsampling = jpge::H2V2;
-	params.m_two_pass_flag = false;
-	jpge::compress_image_to_jpeg_file_in_memory(
-		*outData, *outLen, width, height, 3, rgbData, params);
-	free(rgbData);
+	return encode_jpeg(rgbData.data(), width, height, outData, maxLen);
 }
 
 
@@ -106,25 +109,16 @@ bool MyViewfinder::present(const QVideoFrame &frame) {
 		QVideoFrame cloneFrame(frame);
 		cloneFrame.map(QAbstractVideoBuffer::ReadOnly);
 
-		unsigned char *jpegData = nullptr;
-		int jpegLen = 0;
-
 		QVideoFrame::PixelFormat frameFormat = cloneFrame.pixelFormat();
 		if (frameFormat == QVideoFrame::Format_RGB24) {
 			convert_frame(cloneFrame.size().width(), cloneFrame.size().height(),
 				(unsigned char*)cloneFrame.bits(), AV_PIX_FMT_RGB24,
-				qtc_ideal_width, qtc_ideal_height, &jpegData, &jpegLen);
+				qtc_ideal_width, qtc_ideal_height);
 
 		} else if (frameFormat == QVideoFrame::Format_YUYV) {
 			convert_frame(cloneFrame.size().width(), cloneFrame.size().height(),
 				(unsigned char*)cloneFrame.bits(), AV_PIX_FMT_YUYV422,
-				qtc_ideal_width, qtc_ideal_height, &jpegData, &jpegLen);
-		}
-
-		if (jpegData) {
-			Camera::pushCameraImage(jpegLen, jpegData);
-			free(jpegData);
-			jpegData = nullptr;
+				qtc_ideal_width, qtc_ideal_height);
 		}
 
 		cloneFrame.unmap();
@@ -240,12 +234,9 @@ void *v4l_loop(void *data) {
 			}
 		}
 
-		unsigned char *jpegData = nullptr;
-		int jpegLen = 0;
-
 		if (v4l_format == V4L2_PIX_FMT_YUYV) {
 			convert_frame(v4l_hw_width, v4l_hw_height, (unsigned char*)v4l_buffers[buf.index].start, AV_PIX_FMT_YUYV422,
-				v4l_ideal_width, v4l_ideal_height, &jpegData, &jpegLen);
+				v4l_ideal_width, v4l_ideal_height);
 		} else if (v4l_format == V4L2_PIX_FMT_JPEG
 				|| v4l_format == V4L2_PIX_FMT_MJPEG) {
 			// decompress jpeg
@@ -254,16 +245,10 @@ void *v4l_loop(void *data) {
 				(unsigned char*)v4l_buffers[buf.index].start, buf.bytesused, &width, &height, &req_comps, 3);
 
 			convert_frame(v4l_hw_width, v4l_hw_height, (unsigned char*)rgbData, AV_PIX_FMT_RGB24,
-				v4l_ideal_width, v4l_ideal_height, &jpegData, &jpegLen);
+				v4l_ideal_width, v4l_ideal_height);
 			free(rgbData);
 		}
 
-		if (jpegData) {
-			Camera::pushCameraImage(jpegLen, jpegData);
-			free(jpegData);
-			jpegData = nullptr;
-		}
-
 		buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 		buf.memory = V4L2_MEMORY_MMAP;
 		if (ioctl(v4l_fd, VIDIOC_QBUF, &buf) == -1) {
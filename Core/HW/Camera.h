@@ -29,7 +29,8 @@ extern "C" {
 #include "libavutil/imgutils.h"
 }
 
-void __cameraDummyImage(int width, int height, unsigned char** outData, int* outLen);
+// Encodes a placeholder JPEG into outData, returns the length (0 if it didn't fit.)
+int __cameraDummyImage(int width, int height, unsigned char *outData, int maxLen);
 
 #if defined(USING_QT_UI)
 #include <QAbstractVideoSurface>
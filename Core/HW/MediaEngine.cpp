@@ -15,6 +15,7 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include "ppsspp_config.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Core/Config.h"
 #include "Core/Debugger/MemBlockInfo.h"
@@ -39,6 +40,15 @@ extern "C" {
 #include "libswscale/swscale.h"
 
 }
+
+// Needs avcodec_get_hw_config() and friends, FFmpeg 4.0.
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(58, 18, 100)
+#define MEDIAENGINE_HW_DECODE
+extern "C" {
+#include "libavutil/hwcontext.h"
+#include "libavutil/pixdesc.h"
+}
+#endif
 #endif // USE_FFMPEG
 
 #ifdef USE_FFMPEG
@@ -60,6 +70,63 @@ static AVPixelFormat getSwsFormat(int pspFormat)
 	}
 }
 
+#ifdef MEDIAENGINE_HW_DECODE
+// In order of preference.  Android uses a separate decoder instead, see setVideoStream().
+static const AVHWDeviceType hwDeviceTypes[] = {
+#if PPSSPP_PLATFORM(WINDOWS)
+	AV_HWDEVICE_TYPE_D3D11VA,
+	AV_HWDEVICE_TYPE_DXVA2,
+#elif PPSSPP_PLATFORM(MAC) || PPSSPP_PLATFORM(IOS)
+	AV_HWDEVICE_TYPE_VIDEOTOOLBOX,
+#elif PPSSPP_PLATFORM(LINUX) && !PPSSPP_PLATFORM(ANDROID)
+	AV_HWDEVICE_TYPE_VAAPI,
+#endif
+	AV_HWDEVICE_TYPE_NONE,
+};
+
+static AVPixelFormat getHardwareFormat(AVCodecContext *ctx, const AVPixelFormat *fmts) {
+	// setupHardwareDecode() stashes the format it wants in opaque.
+	AVPixelFormat hwFmt = (AVPixelFormat)(intptr_t)ctx->opaque;
+	for (const AVPixelFormat *p = fmts; *p != AV_PIX_FMT_NONE; ++p) {
+		if (*p == hwFmt)
+			return *p;
+	}
+
+	// Not supported for this stream (profile, size...), take the first software format instead.
+	WARN_LOG(ME, "Hardware video decode not available for this stream, using software");
+	for (const AVPixelFormat *p = fmts; *p != AV_PIX_FMT_NONE; ++p) {
+		const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(*p);
+		if (desc && (desc->flags & AV_PIX_FMT_FLAG_HWACCEL) == 0)
+			return *p;
+	}
+	return AV_PIX_FMT_NONE;
+}
+
+static bool setupHardwareDecode(AVCodecContext *ctx, const AVCodec *codec) {
+	for (const AVHWDeviceType *type = hwDeviceTypes; *type != AV_HWDEVICE_TYPE_NONE; ++type) {
+		for (int i = 0; ; ++i) {
+			const AVCodecHWConfig *config = avcodec_get_hw_config(codec, i);
+			if (!config)
+				break;
+			if ((config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX) == 0 || config->device_type != *type)
+				continue;
+
+			AVBufferRef *device = nullptr;
+			if (av_hwdevice_ctx_create(&device, *type, nullptr, nullptr, 0) < 0)
+				break;
+
+			ctx->hw_device_ctx = av_buffer_ref(device);
+			av_buffer_unref(&device);
+			ctx->opaque = (void *)(intptr_t)config->pix_fmt;
+			ctx->get_format = &getHardwareFormat;
+			INFO_LOG(ME, "Using %s for video decode", av_hwdevice_get_type_name(*type));
+			return true;
+		}
+	}
+	return false;
+}
+#endif
+
 void ffmpeg_logger(void *, int level, const char *format, va_list va_args) {
 	// We're still called even if the level doesn't match.
 	if (level > av_log_get_level())
@@ -123,10 +190,13 @@ MediaEngine::MediaEngine(): m_pdata(0) {
 	m_pCodecCtxs.clear();
 	m_pFrame = 0;
 	m_pFrameRGB = 0;
+	m_pFrameSW = 0;
 	m_pIOContext = 0;
 	m_sws_ctx = 0;
 #endif
 	m_sws_fmt = 0;
+	m_sws_src_fmt = -1;
+	m_frame_fmt = -1;
 	m_buffer = 0;
 
 	m_videoStream = -1;
@@ -368,6 +438,8 @@ void MediaEngine::closeContext()
 		av_frame_free(&m_pFrameRGB);
 	if (m_pFrame)
 		av_frame_free(&m_pFrame);
+	if (m_pFrameSW)
+		av_frame_free(&m_pFrameSW);
 	if (m_pIOContext && m_pIOContext->buffer)
 		av_free(m_pIOContext->buffer);
 	if (m_pIOContext)
@@ -387,6 +459,8 @@ void MediaEngine::closeContext()
 	m_pIOContext = 0;
 #endif
 	m_buffer = 0;
+	m_sws_src_fmt = -1;
+	m_frame_fmt = -1;
 }
 
 bool MediaEngine::loadStream(const u8 *buffer, int readSize, int RingbufferSize)
@@ -543,9 +617,31 @@ bool MediaEngine::setVideoStream(int streamNum, bool force) {
 
 		m_pCodecCtx->flags |= AV_CODEC_FLAG_OUTPUT_CORRUPT | AV_CODEC_FLAG_LOW_DELAY;
 
+#if defined(MEDIAENGINE_HW_DECODE) && PPSSPP_PLATFORM(ANDROID)
+		// MediaCodec is wrapped as its own decoder, not a hwaccel.  It needs FFmpeg built with JNI support.
+		if (g_Config.bHardwareVideoDecode && pCodec->id == AV_CODEC_ID_H264) {
+			const AVCodec *mediaCodec = avcodec_find_decoder_by_name("h264_mediacodec");
+			AVCodecContext *hwCtx = mediaCodec ? avcodec_alloc_context3(mediaCodec) : nullptr;
+			if (hwCtx && avcodec_parameters_to_context(hwCtx, stream->codecpar) >= 0 && avcodec_open2(hwCtx, mediaCodec, nullptr) >= 0) {
+				INFO_LOG(ME, "Using MediaCodec for video decode");
+				avcodec_free_context(&m_pCodecCtx);
+				m_pCodecCtxs[streamNum] = hwCtx;
+				m_videoStream = streamNum;
+				return true;
+			}
+			avcodec_free_context(&hwCtx);
+		}
+#endif
+
 		AVDictionary *opt = nullptr;
+		bool hwDecode = false;
+#ifdef MEDIAENGINE_HW_DECODE
+		if (g_Config.bHardwareVideoDecode)
+			hwDecode = setupHardwareDecode(m_pCodecCtx, pCodec);
+#endif
 		// Allow ffmpeg to use any number of threads it wants.  Without this, it doesn't use threads.
-		av_dict_set(&opt, "threads", "0", 0);
+		// When the GPU decodes, extra threads only cost surfaces.
+		av_dict_set(&opt, "threads", hwDecode ? "1" : "0", 0);
 		int openResult = avcodec_open2(m_pCodecCtx, pCodec, &opt);
 		av_dict_free(&opt);
 		if (openResult < 0) {
@@ -588,6 +684,7 @@ bool MediaEngine::setVideoDim(int width, int height)
 	sws_freeContext(m_sws_ctx);
 	m_sws_ctx = NULL;
 	m_sws_fmt = -1;
+	m_sws_src_fmt = -1;
 
 	if (m_desWidth == 0 || m_desHeight == 0) {
 		// Can't setup SWS yet, so stop for now.
@@ -621,14 +718,17 @@ void MediaEngine::updateSwsFormat(int videoPixelMode) {
 	AVCodecContext *m_pCodecCtx = codecIter == m_pCodecCtxs.end() ? 0 : codecIter->second;
 
 	AVPixelFormat swsDesired = getSwsFormat(videoPixelMode);
-	if (swsDesired != m_sws_fmt && m_pCodecCtx != 0) {
+	// Hardware decoded frames come back as something like NV12, not the codec's format.
+	int srcFmt = m_frame_fmt != -1 ? m_frame_fmt : (m_pCodecCtx ? (int)m_pCodecCtx->pix_fmt : -1);
+	if ((swsDesired != m_sws_fmt || srcFmt != m_sws_src_fmt) && m_pCodecCtx != 0) {
 		m_sws_fmt = swsDesired;
+		m_sws_src_fmt = srcFmt;
 		m_sws_ctx = sws_getCachedContext
 			(
 				m_sws_ctx,
 				m_pCodecCtx->width,
 				m_pCodecCtx->height,
-				m_pCodecCtx->pix_fmt,
+				(AVPixelFormat)srcFmt,
 				m_desWidth,
 				m_desHeight,
 				(AVPixelFormat)m_sws_fmt,
@@ -702,13 +802,28 @@ bool MediaEngine::stepVideo(int videoPixelMode, bool skipFrame) {
 				if (!m_pFrameRGB) {
 					setVideoDim();
 				}
-				if (m_pFrameRGB && !skipFrame) {
+				AVFrame *decoded = m_pFrame;
+#ifdef MEDIAENGINE_HW_DECODE
+				if (m_pFrame->hw_frames_ctx && m_pFrameRGB && !skipFrame) {
+					if (!m_pFrameSW)
+						m_pFrameSW = av_frame_alloc();
+					av_frame_unref(m_pFrameSW);
+					if (av_hwframe_transfer_data(m_pFrameSW, m_pFrame, 0) < 0) {
+						WARN_LOG_REPORT_ONCE(hwtransfer, ME, "Failed to download hardware decoded video frame");
+						decoded = nullptr;
+					} else {
+						decoded = m_pFrameSW;
+					}
+				}
+#endif
+				if (m_pFrameRGB && !skipFrame && decoded) {
+					m_frame_fmt = decoded->format;
 					updateSwsFormat(videoPixelMode);
 					// TODO: Technically we could set this to frameWidth instead of m_desWidth for better perf.
 					// Update the linesize for the new format too.  We started with the largest size, so it should fit.
 					m_pFrameRGB->linesize[0] = getPixelFormatBytes(videoPixelMode) * m_desWidth;
 
-					sws_scale(m_sws_ctx, m_pFrame->data, m_pFrame->linesize, 0,
+					sws_scale(m_sws_ctx, decoded->data, decoded->linesize, 0,
 						m_pCodecCtx->height, m_pFrameRGB->data, m_pFrameRGB->linesize);
 				}
 
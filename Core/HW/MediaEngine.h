@@ -108,11 +108,16 @@ class MediaEngine
 	std::map<int, AVCodecContext *> m_pCodecCtxs;
 	AVFrame *m_pFrame;
 	AVFrame *m_pFrameRGB;
+	// Hardware decoded frames are downloaded into this before conversion.
+	AVFrame *m_pFrameSW;
 	AVIOContext *m_pIOContext;
 	SwsContext *m_sws_ctx;
 #endif
 
 	int m_sws_fmt;
+	// Pixel format sws converts from, and of the last decoded frame.  -1 if unknown.
+	int m_sws_src_fmt;
+	int m_frame_fmt;
 	u8 *m_buffer;
 	int m_videoStream;
 	int m_expectedVideoStreams;
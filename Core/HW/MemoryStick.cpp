@@ -16,9 +16,16 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <cstdio>
+#include <map>
 #include <mutex>
 #include <thread>
+#include "Common/File/DirListing.h"
+#include "Common/File/FileUtil.h"
+#include "Common/File/Path.h"
+#include "Common/Log.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Core/CoreTiming.h"
@@ -34,7 +41,7 @@ static bool memStickNeedsAssign = false;
 static u64 memStickInsertedAt = 0;
 static uint64_t memstickInitialFree = 0;
 static uint64_t memstickCurrentUse = 0;
-static bool memstickCurrentUseValid = false;
+static std::atomic<bool> memstickCurrentUseValid;
 
 enum FreeCalcStatus {
 	NONE,
@@ -51,6 +58,135 @@ static FreeCalcStatus freeCalcStatus = FreeCalcStatus::NONE;
 static const u64 normalMemstickSize = 9ULL * 1024 * 1024 * 1024;
 static const u64 smallMemstickSize = 1ULL * 1024 * 1024 * 1024;
 
+// Size of each save directory, so a change only rescans that directory instead of all of SAVEDATA.
+// Kept on disk between runs, and trusted while the directory's mtime is unchanged and we haven't
+// written to it ourselves since it was scanned.
+struct SaveDirSize {
+	uint64_t mtime = 0;
+	uint64_t size = 0;
+	uint32_t writes = 0;
+	uint32_t scannedWrites = 0;
+	bool seen = false;
+};
+
+static std::mutex saveDirSizesLock;
+// Held for a whole scan, so two scans don't mix up the seen flags.
+static std::mutex saveDirScanLock;
+static std::map<std::string, SaveDirSize> saveDirSizes;
+static bool saveDirSizesLoaded = false;
+static const char *const SAVE_DIR_SIZES_HEADER = "PPSSPP savedata sizes v1";
+
+static Path SaveDirSizesFilename() {
+	return GetSysDirectory(DIRECTORY_CACHE) / "savedata_sizes.txt";
+}
+
+static void LoadSaveDirSizes(const Path &savedataDir) {
+	FILE *f = File::OpenCFile(SaveDirSizesFilename(), "rb");
+	if (!f)
+		return;
+
+	char line[2048];
+	// The index is only good for the memstick it was made from.
+	bool valid = fgets(line, sizeof(line), f) && std::string(line) == std::string(SAVE_DIR_SIZES_HEADER) + "\n";
+	valid = valid && fgets(line, sizeof(line), f) && std::string(line) == savedataDir.ToString() + "\n";
+	while (valid && fgets(line, sizeof(line), f)) {
+		unsigned long long mtime, size;
+		int nameOffset = 0;
+		if (sscanf(line, "%llu %llu %n", &mtime, &size, &nameOffset) != 2 || nameOffset == 0)
+			break;
+		std::string name = line + nameOffset;
+		while (!name.empty() && (name.back() == '\n' || name.back() == '\r'))
+			name.pop_back();
+		SaveDirSize &entry = saveDirSizes[name];
+		entry.mtime = mtime;
+		entry.size = size;
+	}
+	fclose(f);
+}
+
+static void SaveSaveDirSizes(const Path &savedataDir) {
+	const Path filename = SaveDirSizesFilename();
+	const Path tempFilename = filename.WithExtraExtension(".tmp");
+	FILE *f = File::OpenCFile(tempFilename, "wb");
+	if (!f)
+		return;
+
+	bool success = fprintf(f, "%s\n%s\n", SAVE_DIR_SIZES_HEADER, savedataDir.c_str()) > 0;
+	for (const auto &it : saveDirSizes) {
+		// Don't save anything we know is stale.
+		if (it.second.writes != it.second.scannedWrites)
+			continue;
+		success = success && fprintf(f, "%llu %llu %s\n", (unsigned long long)it.second.mtime, (unsigned long long)it.second.size, it.first.c_str()) > 0;
+	}
+	fclose(f);
+	if (!success || !File::Rename(tempFilename, filename))
+		File::Delete(tempFilename);
+}
+
+// Assume the memory stick is only used to store savedata.
+static u64 ComputeSavedataUse() {
+	std::lock_guard<std::mutex> scanGuard(saveDirScanLock);
+	const Path savedataDir = GetSysDirectory(DIRECTORY_SAVEDATA);
+
+	std::vector<File::FileInfo> entries;
+	File::GetFilesInDir(savedataDir, &entries, nullptr, File::GETFILES_GETHIDDEN);
+
+	std::unique_lock<std::mutex> guard(saveDirSizesLock);
+	if (!saveDirSizesLoaded) {
+		LoadSaveDirSizes(savedataDir);
+		saveDirSizesLoaded = true;
+	}
+	for (auto &it : saveDirSizes)
+		it.second.seen = false;
+
+	u64 total = 0;
+	int rescanned = 0;
+	for (const auto &info : entries) {
+		if (!info.isDirectory) {
+			total += info.size;
+			continue;
+		}
+
+		SaveDirSize &entry = saveDirSizes[info.name];
+		entry.seen = true;
+		if (entry.mtime == info.mtime && entry.writes == entry.scannedWrites) {
+			total += entry.size;
+			continue;
+		}
+
+		// Don't hold the lock during the walk, writes shouldn't wait for it.
+		const uint32_t writes = entry.writes;
+		guard.unlock();
+		u64 size = File::ComputeRecursiveDirectorySize(info.fullName);
+		guard.lock();
+
+		SaveDirSize &updated = saveDirSizes[info.name];
+		updated.mtime = info.mtime;
+		updated.size = size;
+		updated.scannedWrites = writes;
+		updated.seen = true;
+		total += size;
+		rescanned++;
+	}
+
+	// Forget deleted directories.
+	bool removed = false;
+	for (auto it = saveDirSizes.begin(); it != saveDirSizes.end(); ) {
+		if (!it->second.seen) {
+			it = saveDirSizes.erase(it);
+			removed = true;
+		} else {
+			++it;
+		}
+	}
+
+	if (rescanned != 0 || removed) {
+		DEBUG_LOG(IO, "Savedata size: %d of %d directories rescanned", rescanned, (int)saveDirSizes.size());
+		SaveSaveDirSizes(savedataDir);
+	}
+	return total;
+}
+
 void MemoryStick_DoState(PointerWrap &p) {
 	auto s = p.Section("MemoryStick", 1, 5);
 	if (!s)
@@ -96,7 +232,8 @@ static void MemoryStick_CalcInitialFree() {
 	std::unique_lock<std::mutex> guard(freeCalcMutex);
 	freeCalcStatus = FreeCalcStatus::RUNNING;
 	freeCalcThread = std::thread([] {
-		memstickInitialFree = pspFileSystem.FreeSpace("ms0:/") + pspFileSystem.ComputeRecursiveDirectorySize("ms0:/PSP/SAVEDATA/");
+		// This also warms up the size index, so the first real query is quick.
+		memstickInitialFree = pspFileSystem.FreeSpace("ms0:/") + ComputeSavedataUse();
 
 		std::unique_lock<std::mutex> guard(freeCalcMutex);
 		freeCalcStatus = FreeCalcStatus::DONE;
@@ -125,10 +262,10 @@ u64 MemoryStick_FreeSpace() {
 	// We have a compat setting to make it even smaller for Harry Potter : Goblet of Fire, see #13266.
 	const u64 memStickSize = flags.ReportSmallMemstick ? smallMemstickSize : (u64)g_Config.iMemStickSizeGB * 1024 * 1024 * 1024;
 
-	// Assume the memory stick is only used to store savedata.
 	if (!memstickCurrentUseValid) {
-		memstickCurrentUse = pspFileSystem.ComputeRecursiveDirectorySize("ms0:/PSP/SAVEDATA/");
+		// Set first, so a write during the scan makes us scan again next time.
 		memstickCurrentUseValid = true;
+		memstickCurrentUse = ComputeSavedataUse();
 	}
 
 	u64 simulatedFreeSpace = 0;
@@ -150,6 +287,25 @@ u64 MemoryStick_FreeSpace() {
 	return std::min(simulatedFreeSpace, realFreeSpace);
 }
 
+void MemoryStick_NotifyWrite(const Path &path) {
+	const Path savedataDir = GetSysDirectory(DIRECTORY_SAVEDATA);
+	std::string relative;
+	if (savedataDir.ComputePathTo(path, relative)) {
+		size_t slash = relative.find('/');
+		// A file right in SAVEDATA is picked up by the listing anyway.
+		if (slash != relative.npos) {
+			std::lock_guard<std::mutex> guard(saveDirSizesLock);
+			saveDirSizes[relative.substr(0, slash)].writes++;
+		}
+	} else if (path.FilePathContainsNoCase("PSP/SAVEDATA")) {
+		// Probably a different case or form of the same path, play it safe.
+		std::lock_guard<std::mutex> guard(saveDirSizesLock);
+		for (auto &it : saveDirSizes)
+			it.second.writes++;
+	}
+	memstickCurrentUseValid = false;
+}
+
 void MemoryStick_NotifyWrite() {
 	memstickCurrentUseValid = false;
 }
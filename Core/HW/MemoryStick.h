@@ -20,6 +20,7 @@
 #include "Common/CommonTypes.h"
 
 class PointerWrap;
+class Path;
 
 // mscmhc0 states (status of the card.)
 enum MemStickState {
@@ -51,4 +52,7 @@ void MemoryStick_SetFatState(MemStickFatState state);
 
 u64 MemoryStick_SectorSize();
 u64 MemoryStick_FreeSpace();
+// Call with the host path of anything created, written, renamed or removed on the memstick.
+void MemoryStick_NotifyWrite(const Path &path);
+// Something outside our control may have changed the memstick, recheck directory times.
 void MemoryStick_NotifyWrite();
@@ -16,7 +16,9 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <algorithm>
+#include <cstdlib>
 
+#include "ppsspp_config.h"
 #include "Common/Profiler/Profiler.h"
 
 #include "Common/Serialize/SerializeFuncs.h"
@@ -27,6 +29,17 @@
 #include "Core/Util/AudioFormat.h"
 #include "SasAudio.h"
 
+#ifdef _M_SSE
+#include <emmintrin.h>
+#endif
+#if PPSSPP_ARCH(ARM_NEON)
+#if defined(_MSC_VER) && PPSSPP_ARCH(ARM64)
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
 // #define AUDIO_TO_FILE
 
 static const u8 f[16][2] = {
@@ -470,6 +483,73 @@ bool SasVoice::HaveSamplesEnded() const {
 	}
 }
 
+// We mix into 32-bit temp buffers (interleaved stereo) and clip in a second loop.
+// Ideally, the shift right should be there too but for now I'm concerned about
+// not overflowing.
+static void MixSamplesToBuffers(int *mix, int *send, const s16 *samples, int count, int volumeLeft, int volumeRight, int effectLeft, int effectRight) {
+	int i = 0;
+
+	// sceSasSetVolume limits these to PSP_SAS_VOL_MAX, but let's not trust savestates.
+	const bool volumesFit = std::max(std::max(abs(volumeLeft), abs(volumeRight)), std::max(abs(effectLeft), abs(effectRight))) <= 0x7FFF;
+#ifdef _M_SSE
+	if (volumesFit) {
+		const __m128i vol = _mm_set_epi16(volumeRight, volumeLeft, volumeRight, volumeLeft, volumeRight, volumeLeft, volumeRight, volumeLeft);
+		const __m128i eff = _mm_set_epi16(effectRight, effectLeft, effectRight, effectLeft, effectRight, effectLeft, effectRight, effectLeft);
+		// Duplicates each sample into a left/right pair, multiplies out to 32 bits and accumulates.
+		auto mixPairs = [](int *dst, __m128i pairs, __m128i v) {
+			__m128i lo = _mm_mullo_epi16(pairs, v);
+			__m128i hi = _mm_mulhi_epi16(pairs, v);
+			__m128i dst0 = _mm_loadu_si128((const __m128i *)dst);
+			__m128i dst1 = _mm_loadu_si128((const __m128i *)(dst + 4));
+			dst0 = _mm_add_epi32(dst0, _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 12));
+			dst1 = _mm_add_epi32(dst1, _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 12));
+			_mm_storeu_si128((__m128i *)dst, dst0);
+			_mm_storeu_si128((__m128i *)(dst + 4), dst1);
+		};
+		for (; i + 8 <= count; i += 8) {
+			__m128i s = _mm_loadu_si128((const __m128i *)(samples + i));
+			__m128i pairs0 = _mm_unpacklo_epi16(s, s);
+			__m128i pairs1 = _mm_unpackhi_epi16(s, s);
+			mixPairs(mix + i * 2, pairs0, vol);
+			mixPairs(mix + i * 2 + 8, pairs1, vol);
+			mixPairs(send + i * 2, pairs0, eff);
+			mixPairs(send + i * 2 + 8, pairs1, eff);
+		}
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	if (volumesFit) {
+		const int16_t volArray[4] = { (int16_t)volumeLeft, (int16_t)volumeRight, (int16_t)volumeLeft, (int16_t)volumeRight };
+		const int16_t effArray[4] = { (int16_t)effectLeft, (int16_t)effectRight, (int16_t)effectLeft, (int16_t)effectRight };
+		const int16x4_t vol = vld1_s16(volArray);
+		const int16x4_t eff = vld1_s16(effArray);
+		auto mixPairs = [](int *dst, int16x4_t pairs, int16x4_t v) {
+			int32x4_t prod = vshrq_n_s32(vmull_s16(pairs, v), 12);
+			vst1q_s32(dst, vaddq_s32(vld1q_s32(dst), prod));
+		};
+		for (; i + 8 <= count; i += 8) {
+			int16x8_t s = vld1q_s16(samples + i);
+			int16x8x2_t pairs = vzipq_s16(s, s);
+			mixPairs(mix + i * 2, vget_low_s16(pairs.val[0]), vol);
+			mixPairs(mix + i * 2 + 4, vget_high_s16(pairs.val[0]), vol);
+			mixPairs(mix + i * 2 + 8, vget_low_s16(pairs.val[1]), vol);
+			mixPairs(mix + i * 2 + 12, vget_high_s16(pairs.val[1]), vol);
+			mixPairs(send + i * 2, vget_low_s16(pairs.val[0]), eff);
+			mixPairs(send + i * 2 + 4, vget_high_s16(pairs.val[0]), eff);
+			mixPairs(send + i * 2 + 8, vget_low_s16(pairs.val[1]), eff);
+			mixPairs(send + i * 2 + 12, vget_high_s16(pairs.val[1]), eff);
+		}
+	}
+#endif
+
+	for (; i < count; i++) {
+		int sample = samples[i];
+		mix[i * 2] += (sample * volumeLeft) >> 12;
+		mix[i * 2 + 1] += (sample * volumeRight) >> 12;
+		send[i * 2] += sample * effectLeft >> 12;
+		send[i * 2 + 1] += sample * effectRight >> 12;
+	}
+}
+
 void SasInstance::MixVoice(SasVoice &voice) {
 	switch (voice.type) {
 	case VOICETYPE_VAG:
@@ -520,6 +600,8 @@ void SasInstance::MixVoice(SasVoice &voice) {
 			voice.envelope.Step();
 		}
 
+		// The envelope has to be walked one sample at a time, so do that (and the resampling) first.
+		// The volumes are then applied to the whole grain at once, see MixSamplesToBuffers().
 		const bool needsInterp = voicePitch != PSP_SAS_PITCH_BASE || (sampleFrac & PSP_SAS_PITCH_MASK) != 0;
 		for (int i = delay; i < grainSize; i++) {
 			const int16_t *s = mixTemp_ + (sampleFrac >> PSP_SAS_PITCH_BASE_SHIFT);
@@ -540,15 +622,13 @@ void SasInstance::MixVoice(SasVoice &voice) {
 
 			// We just scale by the envelope before we scale by volumes.
 			// Again, we round up by adding (1 << 14) first (*after* multiplying.)
-			sample = ((sample * envelopeValue) + (1 << 14)) >> 15;
-
-			// We mix into this 32-bit temp buffer and clip in a second loop
-			// Ideally, the shift right should be there too but for now I'm concerned about
-			// not overflowing.
-			mixBuffer[i * 2] += (sample * voice.volumeLeft) >> 12;
-			mixBuffer[i * 2 + 1] += (sample * voice.volumeRight) >> 12;
-			sendBuffer[i * 2] += sample * voice.effectLeft >> 12;
-			sendBuffer[i * 2 + 1] += sample * voice.effectRight >> 12;
+			// The envelope is at most 1 << 15, so this still fits in 16 bits.
+			mixScaled_[i] = (s16)(((sample * envelopeValue) + (1 << 14)) >> 15);
+		}
+
+		if (delay < grainSize) {
+			MixSamplesToBuffers(mixBuffer + delay * 2, sendBuffer + delay * 2, mixScaled_ + delay, grainSize - delay,
+				voice.volumeLeft, voice.volumeRight, voice.effectLeft, voice.effectRight);
 		}
 
 		voice.resampleHist[0] = mixTemp_[tempPos - 2];
@@ -567,6 +647,26 @@ void SasInstance::MixVoice(SasVoice &voice) {
 }
 
 void SasInstance::Mix(u32 outAddr, u32 inAddr, int leftVol, int rightVol) {
+	s16 *outp = (s16 *)Memory::GetPointer(outAddr);
+	const s16 *inp = inAddr ? (s16*)Memory::GetPointer(inAddr) : 0;
+	MixToBuffer(outp, inp, leftVol, rightVol);
+
+	if (outputMode == PSP_SAS_OUTPUTMODE_MIXED) {
+		if (MemBlockInfoDetailed()) {
+			if (inp)
+				NotifyMemInfo(MemBlockFlags::READ, inAddr, grainSize * sizeof(u16) * 2, "SasMix");
+			NotifyMemInfo(MemBlockFlags::WRITE, outAddr, grainSize * sizeof(u16) * 2, "SasMix");
+		}
+	} else {
+		NotifyMemInfo(MemBlockFlags::WRITE, outAddr, grainSize * sizeof(u16) * 4, "SasMix");
+	}
+
+#ifdef AUDIO_TO_FILE
+	fwrite(Memory::GetPointer(outAddr), 1, grainSize * 2 * 2, audioDump);
+#endif
+}
+
+void SasInstance::MixToBuffer(s16 *outp, const s16 *inp, int leftVol, int rightVol) {
 	for (int v = 0; v < PSP_SAS_VOICES_MAX; v++) {
 		SasVoice &voice = voices[v];
 		if (!voice.playing || voice.paused)
@@ -577,16 +677,9 @@ void SasInstance::Mix(u32 outAddr, u32 inAddr, int leftVol, int rightVol) {
 	// Then mix the send buffer in with the rest.
 
 	// Alright, all voices mixed. Let's convert and clip, and at the same time, wipe mixBuffer for next time. Could also dither.
-	s16 *outp = (s16 *)Memory::GetPointer(outAddr);
-	const s16 *inp = inAddr ? (s16*)Memory::GetPointer(inAddr) : 0;
 	if (outputMode == PSP_SAS_OUTPUTMODE_MIXED) {
 		// Okay, apply effects processing to the Send buffer.
 		WriteMixedOutput(outp, inp, leftVol, rightVol);
-		if (MemBlockInfoDetailed()) {
-			if (inp)
-				NotifyMemInfo(MemBlockFlags::READ, inAddr, grainSize * sizeof(u16) * 2, "SasMix");
-			NotifyMemInfo(MemBlockFlags::WRITE, outAddr, grainSize * sizeof(u16) * 2, "SasMix");
-		}
 	} else {
 		s16 *outpL = outp + grainSize * 0;
 		s16 *outpR = outp + grainSize * 1;
@@ -599,14 +692,9 @@ void SasInstance::Mix(u32 outAddr, u32 inAddr, int leftVol, int rightVol) {
 			*outpSendL++ = clamp_s16(sendBuffer[i + 0]);
 			*outpSendR++ = clamp_s16(sendBuffer[i + 1]);
 		}
-		NotifyMemInfo(MemBlockFlags::WRITE, outAddr, grainSize * sizeof(u16) * 4, "SasMix");
 	}
 	memset(mixBuffer, 0, grainSize * sizeof(int) * 2);
 	memset(sendBuffer, 0, grainSize * sizeof(int) * 2);
-
-#ifdef AUDIO_TO_FILE
-	fwrite(Memory::GetPointer(outAddr), 1, grainSize * 2 * 2, audioDump);
-#endif
 }
 
 void SasInstance::WriteMixedOutput(s16 *outp, const s16 *inp, int leftVol, int rightVol) {
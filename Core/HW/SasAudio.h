@@ -294,6 +294,9 @@ class SasInstance {
 	FILE *audioDump = nullptr;
 
 	void Mix(u32 outAddr, u32 inAddr = 0, int leftVol = 0, int rightVol = 0);
+	// Same as Mix, but into host memory.  outp needs room for GetOutputSamples() samples.
+	void MixToBuffer(s16 *outp, const s16 *inp, int leftVol, int rightVol);
+	int GetOutputSamples() const { return outputMode == PSP_SAS_OUTPUTMODE_MIXED ? grainSize * 2 : grainSize * 4; }
 	void MixVoice(SasVoice &voice);
 
 	// Applies reverb to send buffer, according to waveformEffect.
@@ -312,4 +315,5 @@ class SasInstance {
 	SasReverb reverb_;
 	int grainSize = 0;
 	int16_t mixTemp_[PSP_SAS_MAX_GRAIN * 4 + 2 + 8];  // some extra margin for very high pitches.
+	int16_t mixScaled_[PSP_SAS_MAX_GRAIN];  // resampled and enveloped, before volume
 };
@@ -18,6 +18,7 @@
 #include <algorithm>
 
 #include "Common/Serialize/SerializeFuncs.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Core/Config.h"
 #include "Core/Debugger/MemBlockInfo.h"
 #include "Core/HLE/FunctionWrappers.h"
@@ -312,6 +313,11 @@ bool IsValidCodec(int codec){
 
 // sceAu module starts from here
 
+// How many frames to keep decoded ahead of the game, when AudioDecodeAhead is on.
+static const size_t AU_LOOKAHEAD_FRAMES = 4;
+// Only decode ahead when the whole frame is surely in sourcebuff (this is the max MP3 frame size plus some.)
+static const size_t AU_LOOKAHEAD_MIN_BYTES = 0x05c0;
+
 AuCtx::AuCtx() {
 	decoder = NULL;
 	startPos = 0;
@@ -329,25 +335,93 @@ AuCtx::AuCtx() {
 };
 
 AuCtx::~AuCtx(){
+	WaitLookahead();
 	if (decoder){
 		AudioClose(&decoder);
 		decoder = NULL;
 	}
 };
 
-size_t AuCtx::FindNextMp3Sync() {
+// Returns the offset from start.
+size_t AuCtx::FindNextMp3Sync(size_t start) {
 	if (audioType != PSP_CODEC_MP3) {
 		return 0;
 	}
 
-	for (size_t i = 0; i < sourcebuff.size() - 2; ++i) {
+	for (size_t i = start; i + 2 < sourcebuff.size(); ++i) {
 		if ((sourcebuff[i] & 0xFF) == 0xFF && (sourcebuff[i + 1] & 0xC0) == 0xC0) {
-			return i;
+			return i - start;
 		}
 	}
 	return 0;
 }
 
+class AuLookaheadTask : public Task {
+public:
+	AuLookaheadTask(AuCtx *ctx) : ctx_(ctx) {
+	}
+
+	TaskType Type() const override {
+		return TaskType::CPU_COMPUTE;
+	}
+
+	void Run() override {
+		ctx_->RunLookahead();
+	}
+
+private:
+	AuCtx *ctx_;
+};
+
+void AuCtx::StartLookahead() {
+	if (!g_Config.bAudioDecodeAhead || !decoder || lookaheadFailed_ || lookahead_.size() >= AU_LOOKAHEAD_FRAMES)
+		return;
+	if (sourcebuff.size() < lookaheadSrcBytes_ + AU_LOOKAHEAD_MIN_BYTES)
+		return;
+
+	lookaheadBusy_ = true;
+	g_threadManager.EnqueueTask(new AuLookaheadTask(this));
+}
+
+// Runs on a worker.  The emu thread won't touch decoder, sourcebuff or lookahead_ until we're done.
+void AuCtx::RunLookahead() {
+	while (lookahead_.size() < AU_LOOKAHEAD_FRAMES && sourcebuff.size() >= lookaheadSrcBytes_ + AU_LOOKAHEAD_MIN_BYTES) {
+		size_t nextSync = FindNextMp3Sync(lookaheadSrcBytes_);
+		size_t start = lookaheadSrcBytes_ + nextSync;
+
+		DecodedFrame frame;
+		frame.pcm.resize(std::max(PCMBufSize, (u32)(MaxOutputSample * 4)));
+		frame.pcmBytes = 0;
+		decoder->Decode(&sourcebuff[start], (int)(sourcebuff.size() - start), &frame.pcm[0], &frame.pcmBytes);
+		if (frame.pcmBytes <= 0 || frame.pcmBytes > (int)frame.pcm.size()) {
+			// Let AuDecode handle the end of the stream (or whatever this is) the normal way.
+			lookaheadFailed_ = true;
+			break;
+		}
+		frame.outSamples = decoder->GetOutSamples();
+		frame.srcPos = decoder->GetSourcePos() + (int)nextSync;
+		lookaheadSrcBytes_ += frame.srcPos;
+		lookahead_.push_back(std::move(frame));
+	}
+
+	std::lock_guard<std::mutex> guard(lookaheadLock_);
+	lookaheadBusy_ = false;
+	lookaheadCond_.notify_all();
+}
+
+void AuCtx::WaitLookahead() {
+	std::unique_lock<std::mutex> guard(lookaheadLock_);
+	lookaheadCond_.wait(guard, [&] { return !lookaheadBusy_; });
+}
+
+// Call when sourcebuff is changed other than appended to.
+void AuCtx::DiscardLookahead() {
+	WaitLookahead();
+	lookahead_.clear();
+	lookaheadSrcBytes_ = 0;
+	lookaheadFailed_ = false;
+}
+
 // return output pcm size, <0 error
 u32 AuCtx::AuDecode(u32 pcmAddr) {
 	if (!Memory::GetPointer(PCMBuf)) {
@@ -357,8 +431,20 @@ u32 AuCtx::AuDecode(u32 pcmAddr) {
 	auto outbuf = Memory::GetPointer(PCMBuf);
 	int outpcmbufsize = 0;
 
-	// Decode a single frame in sourcebuff and output into PCMBuf.
-	if (!sourcebuff.empty()) {
+	WaitLookahead();
+	if (!lookahead_.empty()) {
+		// Already decoded on a worker, just consume it like the code below would have.
+		DecodedFrame &frame = lookahead_.front();
+		outpcmbufsize = std::min(frame.pcmBytes, (int)PCMBufSize);
+		memcpy(outbuf, &frame.pcm[0], outpcmbufsize);
+		SumDecodedSamples += frame.outSamples / 2;
+		sourcebuff.erase(sourcebuff.begin(), sourcebuff.begin() + frame.srcPos);
+		AuBufAvailable -= frame.srcPos;
+		lookaheadSrcBytes_ -= frame.srcPos;
+		lookahead_.pop_front();
+	} else if (!sourcebuff.empty()) {
+		// Decode a single frame in sourcebuff and output into PCMBuf.
+		lookaheadFailed_ = false;
 		// FFmpeg doesn't seem to search for a sync for us, so let's do that.
 		int nextSync = (int)FindNextMp3Sync();
 		decoder->Decode(&sourcebuff[nextSync], (int)sourcebuff.size() - nextSync, outbuf, &outpcmbufsize);
@@ -401,6 +487,9 @@ u32 AuCtx::AuDecode(u32 pcmAddr) {
 	NotifyMemInfo(MemBlockFlags::WRITE, pcmAddr, outpcmbufsize, "AuDecode");
 	if (pcmAddr)
 		Memory::Write_U32(PCMBuf, pcmAddr);
+
+	// Get the next frames going while the game plays this one.
+	StartLookahead();
 	return outpcmbufsize;
 }
 
@@ -448,6 +537,9 @@ int AuCtx::AuStreamWorkareaSize() {
 // check how many bytes we have read from source file
 u32 AuCtx::AuNotifyAddStreamData(int size) {
 	int offset = AuStreamWorkareaSize();
+	// Appending keeps decoded frames valid, but the buffer may move.
+	WaitLookahead();
+	lookaheadFailed_ = false;
 
 	if (askedReadSize != 0) {
 		// Old save state, numbers already adjusted.
@@ -508,6 +600,7 @@ u32 AuCtx::AuResetPlayPositionByFrame(int frame) {
 		readPos -= 1;
 	SumDecodedSamples = frame * MaxOutputSample;
 	AuBufAvailable = 0;
+	DiscardLookahead();
 	sourcebuff.clear();
 	return 0;
 }
@@ -516,6 +609,7 @@ u32 AuCtx::AuResetPlayPosition() {
 	readPos = startPos;
 	SumDecodedSamples = 0;
 	AuBufAvailable = 0;
+	DiscardLookahead();
 	sourcebuff.clear();
 	return 0;
 }
@@ -525,6 +619,12 @@ void AuCtx::DoState(PointerWrap &p) {
 	if (!s)
 		return;
 
+	// Decoded frames aren't saved, the source they came from is still in sourcebuff.
+	if (p.mode == p.MODE_READ)
+		DiscardLookahead();
+	else
+		WaitLookahead();
+
 	Do(p, startPos);
 	Do(p, endPos);
 	Do(p, AuBuf);
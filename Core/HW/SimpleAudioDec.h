@@ -18,6 +18,10 @@
 #pragma once
 
 #include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
 
 #include "Core/HW/MediaEngine.h"
 #include "Core/HLE/sceAudio.h"
@@ -118,6 +122,7 @@ class AuCtx {
 	void DoState(PointerWrap &p);
 
 	void EatSourceBuff(int amount) {
+		DiscardLookahead();
 		if (amount > (int)sourcebuff.size()) {
 			amount = (int)sourcebuff.size();
 		}
@@ -155,10 +160,30 @@ class AuCtx {
 	int readPos; // read position in audio source file
 	int askedReadSize; // the size of data requied to be read from file by the game
 
+	// Decode ahead.  The worker may use decoder and sourcebuff until WaitLookahead() returns.
+	void WaitLookahead();
+	void DiscardLookahead();
+	void RunLookahead();
+
 private:
-	size_t FindNextMp3Sync();
+	size_t FindNextMp3Sync(size_t start = 0);
+	void StartLookahead();
 
 	std::vector<u8> sourcebuff; // source buffer
+
+	struct DecodedFrame {
+		std::vector<u8> pcm;
+		int pcmBytes;
+		int outSamples;
+		int srcPos;  // bytes of sourcebuff consumed, including any skipped to find sync
+	};
+	std::deque<DecodedFrame> lookahead_;
+	// How much of the start of sourcebuff the frames in lookahead_ were decoded from.
+	size_t lookaheadSrcBytes_ = 0;
+	bool lookaheadFailed_ = false;
+	bool lookaheadBusy_ = false;
+	std::mutex lookaheadLock_;
+	std::condition_variable lookaheadCond_;
 };
 
 
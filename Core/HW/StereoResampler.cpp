@@ -28,11 +28,25 @@
 #define TARGET_BUFSIZE_DEFAULT 1680 // 40 ms
 #define TARGET_BUFSIZE_EXTRA 3360 // 80 ms
 
+// Low latency mode keeps the target between these, depending on callback size and jitter.
+#define TARGET_BUFSIZE_LOW_MIN    256 // ~6 ms
+#define TARGET_BUFSIZE_LOW_MARGIN 128
+#define UNDERRUN_MARGIN_STEP      64
+#define UNDERRUN_MARGIN_MAX       1024
+
 #define MAX_FREQ_SHIFT  600.0f  // how far off can we be from 44100 Hz
 #define CONTROL_FACTOR  0.2f // in freq_shift per fifo size offset
 #define CONTROL_AVG     32.0f
 
+// Polyphase sinc resampler.  SINC_TAPS input frames are read for every output frame, picking
+// one of SINC_PHASES precomputed filters by the fractional position.  Coefficients are 2.14 fixed point.
+#define SINC_TAPS        16
+#define SINC_PHASE_BITS  8
+#define SINC_PHASES      (1 << SINC_PHASE_BITS)
+#define SINC_COEF_SHIFT  14
+
 #include "ppsspp_config.h"
+#include <cmath>
 #include <cstring>
 #include <atomic>
 
@@ -61,7 +75,9 @@
 
 StereoResampler::StereoResampler()
 		: m_maxBufsize(MAX_BUFSIZE_DEFAULT)
-	  , m_targetBufsize(TARGET_BUFSIZE_DEFAULT) {
+	  , m_targetBufsize(TARGET_BUFSIZE_DEFAULT)
+	  , outputUnderrunsPending_(0)
+	  , lowLatencyTarget_(TARGET_BUFSIZE_DEFAULT) {
 	// Need to have space for the worst case in case it changes.
 	m_buffer = new int16_t[MAX_BUFSIZE_EXTRA * 2]();
 
@@ -85,7 +101,11 @@ StereoResampler::~StereoResampler() {
 }
 
 void StereoResampler::UpdateBufferSize() {
-	if (g_Config.bExtraAudioBuffering) {
+	if (g_Config.bLowLatencyAudio && !g_Config.bExtraAudioBuffering) {
+		// Keep the ring size fixed, changing it would scramble the read/write positions.
+		m_maxBufsize = MAX_BUFSIZE_DEFAULT;
+		m_targetBufsize = lowLatencyTarget_.load();
+	} else if (g_Config.bExtraAudioBuffering) {
 		m_maxBufsize = MAX_BUFSIZE_EXTRA;
 		m_targetBufsize = TARGET_BUFSIZE_EXTRA;
 	} else {
@@ -101,6 +121,34 @@ void StereoResampler::UpdateBufferSize() {
 	}
 }
 
+// Runs on the audio thread.  Aims for one callback's worth of samples, plus what the callbacks have
+// recently been late by, plus extra that grows on underruns and slowly decays again.
+void StereoResampler::UpdateLowLatencyTarget(unsigned int numSamples, int sampleRate, bool underrun) {
+	double now = time_now_d();
+	if (lastMixTime_ != 0.0) {
+		double interval = now - lastMixTime_;
+		if (mixIntervalAvg_ == 0.0)
+			mixIntervalAvg_ = interval;
+		mixIntervalAvg_ = mixIntervalAvg_ * 0.95 + interval * 0.05;
+		// Peak hold with a slow decay, a single late callback should keep us cautious for a while.
+		double deviation = fabs(interval - mixIntervalAvg_);
+		mixJitter_ = std::max(deviation, mixJitter_ * 0.995);
+	}
+	lastMixTime_ = now;
+
+	if (underrun) {
+		underrunMargin_ = std::min(underrunMargin_ + UNDERRUN_MARGIN_STEP, UNDERRUN_MARGIN_MAX);
+	} else if (underrunMargin_ > 0) {
+		underrunMargin_--;
+	}
+
+	// The buffer holds input rate samples.
+	int callbackSize = (int)((int64_t)numSamples * m_input_sample_rate / sampleRate);
+	int jitterSize = (int)(mixJitter_ * m_input_sample_rate);
+	int target = callbackSize + jitterSize + TARGET_BUFSIZE_LOW_MARGIN + underrunMargin_;
+	lowLatencyTarget_ = clamp_value(target, TARGET_BUFSIZE_LOW_MIN, TARGET_BUFSIZE_DEFAULT);
+}
+
 template<bool useShift>
 inline void ClampBufferToS16(s16 *out, const s32 *in, size_t size, s8 volShift) {
 #ifdef _M_SSE
@@ -167,6 +215,142 @@ inline int16_t MixSingleSample(int16_t s1, int16_t s2, uint16_t frac) {
 	return s1 + (((s2 - s1) * frac) >> 16);
 }
 
+// On SSE, each phase is stored as c0 c1 c0 c1 c2 c3 c2 c3 ... so pmaddwd can do two taps per channel at once.
+// Elsewhere it's just c0 c1 c2 ...
+#ifdef _M_SSE
+static const int SINC_PHASE_STRIDE = SINC_TAPS * 2;
+#else
+static const int SINC_PHASE_STRIDE = SINC_TAPS;
+#endif
+
+void StereoResampler::BuildSincTable(int sampleRate) {
+	// Cut off a bit below the input Nyquist frequency, or the output one if we're downsampling.
+	double cutoff = 0.9 * std::min(1.0, (double)sampleRate / (double)m_input_sample_rate);
+
+	sincTable_.resize(SINC_PHASES * SINC_PHASE_STRIDE);
+	for (int p = 0; p < SINC_PHASES; p++) {
+		// The output frame sits between taps SINC_TAPS / 2 - 1 and SINC_TAPS / 2.
+		double center = SINC_TAPS / 2 - 1 + (double)p / SINC_PHASES;
+		double coefs[SINC_TAPS];
+		double sum = 0.0;
+		for (int k = 0; k < SINC_TAPS; k++) {
+			double x = k - center;
+			double t = cutoff * x;
+			double sinc = t == 0.0 ? 1.0 : sin(M_PI * t) / (M_PI * t);
+			// Blackman window centered on the output frame, spanning all taps.
+			double w = 0.42 + 0.5 * cos(2.0 * M_PI * x / SINC_TAPS) + 0.08 * cos(4.0 * M_PI * x / SINC_TAPS);
+			coefs[k] = sinc * w;
+			sum += coefs[k];
+		}
+
+		// Normalize so each phase has unity gain, and put the rounding error on the biggest tap.
+		int16_t fixed[SINC_TAPS];
+		int fixedSum = 0;
+		int biggest = 0;
+		for (int k = 0; k < SINC_TAPS; k++) {
+			fixed[k] = (int16_t)floor(coefs[k] / sum * (1 << SINC_COEF_SHIFT) + 0.5);
+			fixedSum += fixed[k];
+			if (coefs[k] > coefs[biggest])
+				biggest = k;
+		}
+		fixed[biggest] += (1 << SINC_COEF_SHIFT) - fixedSum;
+
+		int16_t *dest = &sincTable_[p * SINC_PHASE_STRIDE];
+#ifdef _M_SSE
+		for (int k = 0; k < SINC_TAPS; k += 2) {
+			dest[k * 2 + 0] = fixed[k];
+			dest[k * 2 + 1] = fixed[k + 1];
+			dest[k * 2 + 2] = fixed[k];
+			dest[k * 2 + 3] = fixed[k + 1];
+		}
+#else
+		memcpy(dest, fixed, sizeof(fixed));
+#endif
+	}
+	sincTableRate_ = sampleRate;
+}
+
+// Filters SINC_TAPS interleaved stereo frames from in to a single stereo frame.
+static inline void SincFilterFrame(const int16_t *in, const int16_t *coefs, short *out) {
+#ifdef _M_SSE
+	__m128i acc = _mm_setzero_si128();
+	for (int k = 0; k < SINC_TAPS; k += 4) {
+		// L0 R0 L1 R1 L2 R2 L3 R3 -> L0 L1 R0 R1 L2 L3 R2 R3.
+		__m128i s = _mm_loadu_si128((const __m128i *)(in + k * 2));
+		s = _mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 1, 2, 0));
+		s = _mm_shufflehi_epi16(s, _MM_SHUFFLE(3, 1, 2, 0));
+		__m128i c = _mm_loadu_si128((const __m128i *)(coefs + k * 2));
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(s, c));
+	}
+	// Lanes are L R L R, fold them down to one L R pair.
+	acc = _mm_add_epi32(acc, _mm_srli_si128(acc, 8));
+	acc = _mm_add_epi32(acc, _mm_set1_epi32(1 << (SINC_COEF_SHIFT - 1)));
+	acc = _mm_srai_epi32(acc, SINC_COEF_SHIFT);
+	int lr = _mm_cvtsi128_si32(_mm_packs_epi32(acc, acc));
+	memcpy(out, &lr, sizeof(lr));
+#elif PPSSPP_ARCH(ARM_NEON)
+	int32x4_t accL = vdupq_n_s32(0);
+	int32x4_t accR = vdupq_n_s32(0);
+	for (int k = 0; k < SINC_TAPS; k += 8) {
+		int16x8x2_t s = vld2q_s16(in + k * 2);
+		int16x8_t c = vld1q_s16(coefs + k);
+		accL = vmlal_s16(accL, vget_low_s16(s.val[0]), vget_low_s16(c));
+		accL = vmlal_s16(accL, vget_high_s16(s.val[0]), vget_high_s16(c));
+		accR = vmlal_s16(accR, vget_low_s16(s.val[1]), vget_low_s16(c));
+		accR = vmlal_s16(accR, vget_high_s16(s.val[1]), vget_high_s16(c));
+	}
+	int32x2_t sumL = vadd_s32(vget_low_s32(accL), vget_high_s32(accL));
+	int32x2_t sumR = vadd_s32(vget_low_s32(accR), vget_high_s32(accR));
+	int32x2_t lr = vpadd_s32(sumL, sumR);
+	int16x4_t packed = vqrshrn_n_s32(vcombine_s32(lr, lr), SINC_COEF_SHIFT);
+	vst1_lane_s32((int32_t *)out, vreinterpret_s32_s16(packed), 0);
+#else
+	int accL = 0;
+	int accR = 0;
+	for (int k = 0; k < SINC_TAPS; k++) {
+		accL += in[k * 2 + 0] * coefs[k];
+		accR += in[k * 2 + 1] * coefs[k];
+	}
+	const int round = 1 << (SINC_COEF_SHIFT - 1);
+	out[0] = clamp_s16((accL + round) >> SINC_COEF_SHIFT);
+	out[1] = clamp_s16((accR + round) >> SINC_COEF_SHIFT);
+#endif
+}
+
+// Same contract as the linear loop in Mix, returns how many shorts of samples were written.
+// indexR points at the first frame of the filter window, so this runs SINC_TAPS / 2 frames behind the linear path.
+unsigned int StereoResampler::MixSinc(short *samples, unsigned int numSamples, u32 &indexR, u32 indexW, u32 ratio) {
+	const u32 INDEX_MASK = (m_maxBufsize * 2 - 1);
+	const u32 ringSize = m_maxBufsize * 2;
+	int16_t wrapped[SINC_TAPS * 2];
+
+	u32 frac = m_frac;
+	unsigned int currentSample;
+	for (currentSample = 0; currentSample < numSamples * 2; currentSample += 2) {
+		if (((indexW - indexR) & INDEX_MASK) <= SINC_TAPS * 2) {
+			underrunCount_++;
+			break;
+		}
+
+		u32 start = indexR & INDEX_MASK;
+		const int16_t *window = &m_buffer[start];
+		if (start + SINC_TAPS * 2 > ringSize) {
+			for (int i = 0; i < SINC_TAPS * 2; i++)
+				wrapped[i] = m_buffer[(start + i) & INDEX_MASK];
+			window = wrapped;
+		}
+
+		const int16_t *coefs = &sincTable_[(frac >> (16 - SINC_PHASE_BITS)) * SINC_PHASE_STRIDE];
+		SincFilterFrame(window, coefs, &samples[currentSample]);
+
+		frac += ratio;
+		indexR += 2 * (frac >> 16);
+		frac &= 0xffff;
+	}
+	m_frac = frac;
+	return currentSample;
+}
+
 // Executed from sound stream thread, pulling sound out of the buffer.
 unsigned int StereoResampler::Mix(short* samples, unsigned int numSamples, bool consider_framelimit, int sample_rate) {
 	if (!samples)
@@ -212,33 +396,50 @@ unsigned int StereoResampler::Mix(short* samples, unsigned int numSamples, bool
 	output_sample_rate_ = (float)(m_input_sample_rate + offset);
 	const u32 ratio = (u32)(65536.0 * output_sample_rate_ / (double)sample_rate);
 	ratio_ = ratio;
-	// TODO: consider a higher-quality resampling algorithm.
 	// TODO: Add a fast path for 1:1.
-	u32 frac = m_frac;
-	for (currentSample = 0; currentSample < numSamples * 2; currentSample += 2) {
-		if (((indexW - indexR) & INDEX_MASK) <= 2) {
-			// Ran out!
-			// int missing = numSamples * 2 - currentSample;
-			// ILOG("Resampler underrun: %d (numSamples: %d, currentSample: %d)", missing, numSamples, currentSample / 2);
-			underrunCount_++;
-			break;
+	if (g_Config.bSincAudioResampler) {
+		if (sincTableRate_ != sample_rate)
+			BuildSincTable(sample_rate);
+		currentSample = MixSinc(samples, numSamples, indexR, indexW, ratio);
+	} else {
+		u32 frac = m_frac;
+		for (currentSample = 0; currentSample < numSamples * 2; currentSample += 2) {
+			if (((indexW - indexR) & INDEX_MASK) <= 2) {
+				// Ran out!
+				// int missing = numSamples * 2 - currentSample;
+				// ILOG("Resampler underrun: %d (numSamples: %d, currentSample: %d)", missing, numSamples, currentSample / 2);
+				underrunCount_++;
+				break;
+			}
+			u32 indexR2 = indexR + 2; //next sample
+			s16 l1 = m_buffer[indexR & INDEX_MASK]; //current
+			s16 r1 = m_buffer[(indexR + 1) & INDEX_MASK]; //current
+			s16 l2 = m_buffer[indexR2 & INDEX_MASK]; //next
+			s16 r2 = m_buffer[(indexR2 + 1) & INDEX_MASK]; //next
+			samples[currentSample] = MixSingleSample(l1, l2, (u16)frac);
+			samples[currentSample + 1] = MixSingleSample(r1, r2, (u16)frac);
+			frac += ratio;
+			indexR += 2 * (frac >> 16);
+			frac &= 0xffff;
 		}
-		u32 indexR2 = indexR + 2; //next sample
-		s16 l1 = m_buffer[indexR & INDEX_MASK]; //current
-		s16 r1 = m_buffer[(indexR + 1) & INDEX_MASK]; //current
-		s16 l2 = m_buffer[indexR2 & INDEX_MASK]; //next
-		s16 r2 = m_buffer[(indexR2 + 1) & INDEX_MASK]; //next
-		samples[currentSample] = MixSingleSample(l1, l2, (u16)frac);
-		samples[currentSample + 1] = MixSingleSample(r1, r2, (u16)frac);
-		frac += ratio;
-		indexR += 2 * (frac >> 16);
-		frac &= 0xffff;
+		m_frac = frac;
 	}
-	m_frac = frac;
 
 	// Let's not count the underrun padding here.
 	outputSampleCount_ += currentSample / 2;
 
+	// If the device itself glitched, we were too slow to refill it even if we had samples.
+	int outputUnderruns = outputUnderrunsPending_.exchange(0);
+	outputUnderrunCountTotal_ += outputUnderruns;
+	if (g_Config.bLowLatencyAudio)
+		UpdateLowLatencyTarget(numSamples, sample_rate, currentSample < numSamples * 2 || outputUnderruns != 0);
+
+	// What's queued now plays after this callback's samples, and the host's own buffer, are out.
+	// This is the audio side of audio to display latency: samples pushed now will be heard in this long.
+	int hostBufsize = std::max(System_GetPropertyInt(SYSPROP_AUDIO_FRAMES_PER_BUFFER), 0);
+	latencyMs_ = 1000.0f * ((float)lastBufSize_ / m_input_sample_rate + (float)(numSamples + hostBufsize) / sample_rate);
+	lastMixSize_ = numSamples;
+
 	// Padding with the last value to reduce clicking
 	short s[2];
 	s[0] = clamp_s16(m_buffer[(indexR - 1) & INDEX_MASK]);
@@ -270,6 +471,9 @@ void StereoResampler::PushSamples(const s32 *samples, unsigned int numSamples) {
 	// If fast-forwarding, no need to fill up the entire buffer, just screws up timing after releasing the fast-forward button.
 	if (PSP_CoreParameter().fastForward) {
 		cap = m_targetBufsize * 2;
+	} else if (g_Config.bLowLatencyAudio) {
+		// Drop rather than let latency build up, the rate control alone is too slow to bring it back down.
+		cap = std::min(cap, (u32)(m_targetBufsize * 2 + numSamples * 2) * 2);
 	}
 
 	// Check if we have enough free space
@@ -295,6 +499,11 @@ void StereoResampler::PushSamples(const s32 *samples, unsigned int numSamples) {
 	lastPushSize_ = numSamples;
 }
 
+void StereoResampler::NotifyOutputUnderruns(int count) {
+	if (count > 0)
+		outputUnderrunsPending_ += count;
+}
+
 void StereoResampler::GetAudioDebugStats(char *buf, size_t bufSize) {
 	double elapsed = time_now_d() - startTime_;
 
@@ -303,25 +512,32 @@ void StereoResampler::GetAudioDebugStats(char *buf, size_t bufSize) {
 	snprintf(buf, bufSize,
 		"Audio buffer: %d/%d (target: %d)\n"
 		"Filtered: %0.2f\n"
-		"Underruns: %d\n"
+		"Underruns: %d (device: %d)\n"
 		"Overruns: %d\n"
 		"Sample rate: %d (input: %d)\n"
 		"Effective input sample rate: %0.2f\n"
 		"Effective output sample rate: %0.2f\n"
 		"Push size: %d\n"
-		"Ratio: %0.6f\n",
+		"Ratio: %0.6f\n"
+		"Low latency: %s (mix size: %d, jitter: %0.2f ms)\n"
+		"Latency estimate: %0.1f ms\n",
 		lastBufSize_,
 		m_maxBufsize,
 		m_targetBufsize,
 		m_numLeftI,
 		underrunCountTotal_,
+		outputUnderrunCountTotal_,
 		overrunCountTotal_,
 		(int)output_sample_rate_,
 		m_input_sample_rate,
 		effective_input_sample_rate,
 		effective_output_sample_rate,
 		lastPushSize_,
-		(float)ratio_ / 65536.0f);
+		(float)ratio_ / 65536.0f,
+		g_Config.bLowLatencyAudio ? "on" : "off",
+		lastMixSize_,
+		mixJitter_ * 1000.0,
+		latencyMs_);
 	underrunCountTotal_ += underrunCount_;
 	overrunCountTotal_ += overrunCount_;
 	underrunCount_ = 0;
@@ -338,6 +554,7 @@ void StereoResampler::ResetStatCounters() {
 	overrunCount_ = 0;
 	underrunCountTotal_ = 0;
 	overrunCountTotal_ = 0;
+	outputUnderrunCountTotal_ = 0;
 	inputSampleCount_ = 0;
 	outputSampleCount_ = 0;
 	startTime_ = time_now_d();
@@ -21,6 +21,7 @@
 
 #include <cstdint>
 #include <atomic>
+#include <vector>
 
 #include "Common/Serialize/Serializer.h"
 #include "Common/CommonTypes.h"
@@ -43,11 +44,17 @@ class StereoResampler {
 
 	void DoState(PointerWrap &p);
 
+	// Called from audio threads, when the host audio device reports it ran dry (AAudio xruns etc.)
+	void NotifyOutputUnderruns(int count);
+
 	void GetAudioDebugStats(char *buf, size_t bufSize);
 	void ResetStatCounters();
 
 private:
 	void UpdateBufferSize();
+	void UpdateLowLatencyTarget(unsigned int numSamples, int sampleRate, bool underrun);
+	void BuildSincTable(int sampleRate);
+	unsigned int MixSinc(short *samples, unsigned int numSamples, u32 &indexR, u32 indexW, u32 ratio);
 
 	int m_maxBufsize;
 	int m_targetBufsize;
@@ -64,13 +71,29 @@ class StereoResampler {
 	int lastPushSize_ = 0;
 	u32 ratio_ = 0;
 
+	// Polyphase windowed sinc filter, see BuildSincTable().
+	std::vector<int16_t> sincTable_;
+	int sincTableRate_ = 0;
+
 	int underrunCount_ = 0;
 	int overrunCount_ = 0;
 	int underrunCountTotal_ = 0;
 	int overrunCountTotal_ = 0;
+	// Reported by the output device, as opposed to us running out of samples.
+	std::atomic<int> outputUnderrunsPending_;
+	int outputUnderrunCountTotal_ = 0;
 
 	int droppedSamples_ = 0;
 
+	// Low latency mode, the target follows the measured audio callback timing.
+	std::atomic<int> lowLatencyTarget_;
+	double lastMixTime_ = 0.0;
+	double mixIntervalAvg_ = 0.0;
+	double mixJitter_ = 0.0;
+	int underrunMargin_ = 0;
+	int lastMixSize_ = 0;
+	float latencyMs_ = 0.0f;
+
 	int64_t inputSampleCount_ = 0;
 	int64_t outputSampleCount_ = 0;
 
@@ -18,7 +18,12 @@
 #include "ppsspp_config.h"
 #include "Core/Instance.h"
 
-#if !PPSSPP_PLATFORM(WINDOWS) && !PPSSPP_PLATFORM(ANDROID) && !defined(__LIBRETRO__) && !PPSSPP_PLATFORM(SWITCH)
+#if (PPSSPP_PLATFORM(LINUX) && !PPSSPP_PLATFORM(ANDROID)) || PPSSPP_PLATFORM(MAC)
+// Also for libretro, where many instances in one host is the common case.
+#define HAVE_SHARED_FRAME_CACHE 1
+#endif
+
+#if (!PPSSPP_PLATFORM(WINDOWS) && !PPSSPP_PLATFORM(ANDROID) && !defined(__LIBRETRO__) && !PPSSPP_PLATFORM(SWITCH)) || defined(HAVE_SHARED_FRAME_CACHE)
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/mman.h>
@@ -33,7 +38,12 @@
 #include "Common/Log.h"
 #include "Common/SysError.h"
 
+#include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <thread>
 
 uint8_t PPSSPP_ID = 0;
 
@@ -189,3 +199,132 @@ void ShutdownInstanceCounter() {
 	}
 #endif
 }
+
+struct SharedFrameCacheHeader {
+	uint32_t magic;
+	uint32_t frameSize;
+	uint32_t numFrames;
+	std::atomic<uint32_t> users;
+	std::atomic<uint32_t> ready;
+};
+
+enum : uint32_t {
+	SHARED_FRAME_MAGIC = 0x46535050,  // PPSF
+	SHARED_FRAME_EMPTY = 0,
+	SHARED_FRAME_FILLING = 1,
+	SHARED_FRAME_VALID = 2,
+};
+
+SharedFrameCache *SharedFrameCache::Open(const std::string &key, uint32_t frameSize, uint32_t numFrames) {
+#ifdef HAVE_SHARED_FRAME_CACHE
+	static_assert(std::atomic<uint32_t>::is_always_lock_free, "Shared memory atomics must be lock free");
+
+	// One state word per frame after the header, then the frames page aligned.
+	const size_t pageSize = (size_t)sysconf(_SC_PAGE_SIZE);
+	const size_t statesEnd = sizeof(SharedFrameCacheHeader) + numFrames * sizeof(std::atomic<uint32_t>);
+	const size_t dataOffset = (statesEnd + pageSize - 1) & ~(pageSize - 1);
+	const size_t size = dataOffset + (size_t)frameSize * numFrames;
+
+	std::string name = "/PPSSPP_FRAMES_" + key;
+	// Only pages that get touched are backed by memory, so sizing for the whole image is fine.
+	bool created = true;
+	int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+	if (fd < 0 && errno == EEXIST) {
+		created = false;
+		fd = shm_open(name.c_str(), O_RDWR, S_IRUSR | S_IWUSR);
+	}
+	if (fd < 0) {
+		WARN_LOG(LOADER, "shm_open(%s) failure: %s", name.c_str(), GetLastErrorMsg().c_str());
+		return nullptr;
+	}
+	if (created && ftruncate(fd, size) == -1) {
+		WARN_LOG(LOADER, "ftruncate(%s) failure: %s", name.c_str(), GetLastErrorMsg().c_str());
+		close(fd);
+		shm_unlink(name.c_str());
+		return nullptr;
+	}
+	if (!created) {
+		// The creator might not have sized it yet.
+		struct stat st{};
+		for (int i = 0; i < 100 && fstat(fd, &st) == 0 && (size_t)st.st_size < size; ++i)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		if ((size_t)st.st_size != size) {
+			WARN_LOG(LOADER, "Shared frame cache %s has unexpected size", name.c_str());
+			close(fd);
+			return nullptr;
+		}
+	}
+
+	void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	// The mapping keeps the object alive, the fd isn't needed anymore.
+	close(fd);
+	if (base == MAP_FAILED) {
+		WARN_LOG(LOADER, "mmap(%s) failure: %s", name.c_str(), GetLastErrorMsg().c_str());
+		if (created)
+			shm_unlink(name.c_str());
+		return nullptr;
+	}
+
+	SharedFrameCacheHeader *header = (SharedFrameCacheHeader *)base;
+	if (created) {
+		// Fresh objects are zero filled, which is also SHARED_FRAME_EMPTY for every frame.
+		header->magic = SHARED_FRAME_MAGIC;
+		header->frameSize = frameSize;
+		header->numFrames = numFrames;
+		header->users.store(1);
+		header->ready.store(1, std::memory_order_release);
+	} else {
+		for (int i = 0; i < 100 && header->ready.load(std::memory_order_acquire) == 0; ++i)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		if (header->ready.load(std::memory_order_acquire) == 0 || header->magic != SHARED_FRAME_MAGIC || header->frameSize != frameSize || header->numFrames != numFrames) {
+			WARN_LOG(LOADER, "Shared frame cache %s doesn't match, not using it", name.c_str());
+			munmap(base, size);
+			return nullptr;
+		}
+		header->users++;
+	}
+
+	SharedFrameCache *cache = new SharedFrameCache();
+	cache->name_ = name;
+	cache->base_ = (uint8_t *)base;
+	cache->size_ = size;
+	cache->frameSize_ = frameSize;
+	cache->numFrames_ = numFrames;
+	cache->dataOffset_ = dataOffset;
+	INFO_LOG(LOADER, "%s shared frame cache %s", created ? "Created" : "Joined", name.c_str());
+	return cache;
+#else
+	return nullptr;
+#endif
+}
+
+SharedFrameCache::~SharedFrameCache() {
+#ifdef HAVE_SHARED_FRAME_CACHE
+	SharedFrameCacheHeader *header = (SharedFrameCacheHeader *)base_;
+	// If an instance crashed the name lingers until reboot, but later users still share it fine.
+	if (header->users.fetch_sub(1) == 1)
+		shm_unlink(name_.c_str());
+	munmap(base_, size_);
+#endif
+}
+
+bool SharedFrameCache::Read(uint32_t frame, uint8_t *dest) {
+	if (frame >= numFrames_)
+		return false;
+	std::atomic<uint32_t> *states = (std::atomic<uint32_t> *)(base_ + sizeof(SharedFrameCacheHeader));
+	if (states[frame].load(std::memory_order_acquire) != SHARED_FRAME_VALID)
+		return false;
+	memcpy(dest, base_ + dataOffset_ + (size_t)frame * frameSize_, frameSize_);
+	return true;
+}
+
+void SharedFrameCache::Write(uint32_t frame, const uint8_t *src) {
+	if (frame >= numFrames_)
+		return;
+	std::atomic<uint32_t> *states = (std::atomic<uint32_t> *)(base_ + sizeof(SharedFrameCacheHeader));
+	uint32_t expected = SHARED_FRAME_EMPTY;
+	if (!states[frame].compare_exchange_strong(expected, SHARED_FRAME_FILLING, std::memory_order_acquire))
+		return;
+	memcpy(base_ + dataOffset_ + (size_t)frame * frameSize_, src, frameSize_);
+	states[frame].store(SHARED_FRAME_VALID, std::memory_order_release);
+}
@@ -20,6 +20,7 @@
 #include "ppsspp_config.h"
 
 #include <cstdint>
+#include <string>
 
 extern uint8_t PPSSPP_ID;
 
@@ -30,3 +31,28 @@ int GetInstancePeerCount();
 inline bool IsFirstInstance() {
 	return PPSSPP_ID == 1;
 }
+
+// Decompressed disc frames shared between PPSSPP processes running the same image, through
+// named shared memory.  Each frame is filled by whichever instance decodes it first and then
+// only read, so hosts running many instances of one game decode and keep it in RAM only once.
+class SharedFrameCache {
+public:
+	// Returns nullptr if not supported on this platform or the mapping fails.
+	static SharedFrameCache *Open(const std::string &key, uint32_t frameSize, uint32_t numFrames);
+	~SharedFrameCache();
+
+	// Copies out a frame if some instance already stored it.
+	bool Read(uint32_t frame, uint8_t *dest);
+	// Stores a decoded frame, unless someone else got there first.
+	void Write(uint32_t frame, const uint8_t *src);
+
+private:
+	SharedFrameCache() {}
+
+	std::string name_;
+	uint8_t *base_ = nullptr;
+	size_t size_ = 0;
+	uint32_t frameSize_ = 0;
+	uint32_t numFrames_ = 0;
+	size_t dataOffset_ = 0;
+};
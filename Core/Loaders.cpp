@@ -21,11 +21,13 @@
 #include "Common/File/FileUtil.h"
 #include "Common/File/Path.h"
 #include "Common/StringUtils.h"
+#include "Core/Config.h"
 #include "Core/FileLoaders/CachingFileLoader.h"
 #include "Core/FileLoaders/DiskCachingFileLoader.h"
 #include "Core/FileLoaders/HTTPFileLoader.h"
 #include "Core/FileLoaders/LocalFileLoader.h"
 #include "Core/FileLoaders/RetryingFileLoader.h"
+#include "Core/FileLoaders/ZipFileLoader.h"
 #include "Core/FileSystems/MetaFileSystem.h"
 #include "Core/PSPLoaders.h"
 #include "Core/MemMap.h"
@@ -55,7 +57,16 @@ FileLoader *ConstructFileLoader(const Path &filename) {
 			return iter.second->ConstructFileLoader(filename);
 		}
 	}
-	return new LocalFileLoader(filename);
+
+	if (filename.GetFileExtension() == ".zip") {
+		// Zipped ISOs are played from inside the zip, anything else still gets installed.
+		ZipFileLoader *zipLoader = new ZipFileLoader(new LocalFileLoader(filename, g_Config.bMemoryMapIso));
+		if (zipLoader->HasGame()) {
+			return zipLoader;
+		}
+		delete zipLoader;
+	}
+	return new LocalFileLoader(filename, g_Config.bMemoryMapIso);
 }
 
 // TODO : improve, look in the file more
@@ -91,7 +102,7 @@ IdentifiedFileType Identify_File(FileLoader *fileLoader, std::string *errorStrin
 			// maybe it also just happened to have that size, let's assume it's a PSP ISO and error out later if it's not.
 		}
 		return IdentifiedFileType::PSP_ISO;
-	} else if (extension == ".cso") {
+	} else if (extension == ".cso" || extension == ".zso" || extension == ".zst") {
 		return IdentifiedFileType::PSP_ISO;
 	} else if (extension == ".ppst") {
 		return IdentifiedFileType::PPSSPP_SAVESTATE;
@@ -190,6 +201,13 @@ IdentifiedFileType Identify_File(FileLoader *fileLoader, std::string *errorStrin
 	} else if (extension == ".bin") {
 		return IdentifiedFileType::UNKNOWN_BIN;
 	} else if (extension == ".zip") {
+		// A ZipFileLoader reads the game image inside, see ConstructFileLoader().
+		char volumeId[5]{};
+		if (!memcmp(&_id, "CISO", 4) || !memcmp(&_id, "ZISO", 4)) {
+			return IdentifiedFileType::PSP_ISO;
+		} else if (fileLoader->ReadAt(0x8001, 5, volumeId) == 5 && !memcmp(volumeId, "CD001", 5)) {
+			return IdentifiedFileType::PSP_ISO;
+		}
 		return IdentifiedFileType::ARCHIVE_ZIP;
 	} else if (extension == ".rar") {
 		return IdentifiedFileType::ARCHIVE_RAR;
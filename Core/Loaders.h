@@ -82,6 +82,13 @@ class FileLoader {
 		return ReadAt(absolutePos, 1, bytes, data, flags);
 	}
 
+	// Direct access to the file data, for loaders that have it all in memory (or mapped.)
+	// Returns nullptr if not supported or out of range, callers must then use ReadAt().
+	// The pointer stays valid as long as the loader does.
+	virtual const u8 *GetPointer(s64 absolutePos, size_t bytes) {
+		return nullptr;
+	}
+
 	// Cancel any operations that might block, if possible.
 	virtual void Cancel() {}
 
@@ -128,6 +135,9 @@ class ProxiedFileLoader : public FileLoader {
 	size_t ReadAt(s64 absolutePos, size_t bytes, void *data, Flags flags = Flags::NONE) override {
 		return backend_->ReadAt(absolutePos, bytes, data, flags);
 	}
+	const u8 *GetPointer(s64 absolutePos, size_t bytes) override {
+		return backend_->GetPointer(absolutePos, bytes);
+	}
 
 protected:
 	FileLoader *backend_;
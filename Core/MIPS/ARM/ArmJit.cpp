@@ -766,7 +766,7 @@ bool ArmJit::CheckJitBreakpoint(u32 addr, int downcountOffset) {
 }
 
 bool ArmJit::CheckMemoryBreakpoint(int instructionOffset) {
-	if (CBreakPoints::HasMemChecks()) {
+	if (CBreakPoints::HasJitMemChecks()) {
 		int off = instructionOffset + (js.inDelaySlot ? 1 : 0);
 
 		MRS(R8);
@@ -493,7 +493,9 @@ void Arm64Jit::Comp_Jump(MIPSOpcode op) {
 		gpr.SetRegImm(SCRATCH1, GetCompilerPC() + 8);
 		MovToPC(SCRATCH1);
 		MOVI2R(W0, targetAddr);
+		gpr.FlushBeforeCall();
 		QuickCallFunction(SCRATCH1, (const void *)&HitInvalidJump);
+		gpr.ReloadAfterCall();
 		WriteSyscallExit();
 		return;
 	}
@@ -528,6 +530,7 @@ void Arm64Jit::Comp_Jump(MIPSOpcode op) {
 			return;
 		}
 		FlushAll();
+		WriteReturnStackPush(GetCompilerPC() + 8);
 		WriteExit(targetAddr, js.nextExit++);
 		break;
 
@@ -615,6 +618,10 @@ void Arm64Jit::Comp_JumpReg(MIPSOpcode op)
 		break;
 	}
 
+	if (andLink && rd == MIPS_REG_RA)
+		WriteReturnStackPush(GetCompilerPC() + 8);
+	else if (!andLink && rs == MIPS_REG_RA)
+		WriteReturnStackJump(destReg);
 	WriteExitDestInR(destReg);
 	js.compiling = false;
 }
@@ -1942,13 +1942,15 @@ namespace MIPSComp {
 		gpr.FlushBeforeCall();
 		fpr.FlushAll();
 
-		// Don't need to SaveStaticRegs here as long as they are all in callee-save regs - this callee won't read them.
+		// Don't need to SaveStaticRegs here, this callee won't read them.  FlushBeforeCall() took care of
+		// the ones in caller-saved regs.
 
 		bool negSin1 = (imm & 0x10) ? true : false;
 
 		fpr.MapRegV(sreg);
 		fp.FMOV(S0, fpr.V(sreg));
 		QuickCallFunction(SCRATCH2_64, negSin1 ? (void *)&SinCosNegSin : (void *)&SinCos);
+		gpr.ReloadAfterCall();
 		// Here, sin and cos are stored together in Q0.d. On ARM32 we could use it directly
 		// but with ARM64's register organization, we need to split it up.
 		fp.INS(32, Q1, 0, Q0, 1);
@@ -1965,7 +1967,58 @@ namespace MIPSComp {
 	}
 
 	void Arm64Jit::Comp_Vsgn(MIPSOpcode op) {
-		DISABLE;
+		CONDITIONAL_DISABLE(VFPU_VEC);
+		// The T prefix (which is compared against) is rarely used, leave that to the interpreter.
+		if (js.HasUnknownPrefix() || js.HasTPrefix()) {
+			DISABLE;
+		}
+
+		VectorSize sz = GetVecSize(op);
+		int n = GetNumVectorElements(sz);
+
+		// Swizzling out of bounds compares against T, so those also go to the interpreter.
+		for (int i = 0; i < n; ++i) {
+			int regnum = (js.prefixS >> (i * 2)) & 3;
+			bool constant = ((js.prefixS >> (12 + i)) & 1) != 0;
+			if (!constant && regnum >= n) {
+				DISABLE;
+			}
+		}
+
+		u8 sregs[4], dregs[4];
+		GetVectorRegsPrefixS(sregs, sz, _VS);
+		GetVectorRegsPrefixD(dregs, sz, _VD);
+
+		MIPSReg tempregs[4];
+		for (int i = 0; i < n; ++i) {
+			if (!IsOverlapSafe(dregs[i], i, n, sregs)) {
+				tempregs[i] = fpr.GetTempV();
+			} else {
+				tempregs[i] = dregs[i];
+			}
+		}
+
+		for (int i = 0; i < n; ++i) {
+			fpr.MapDirtyInV(tempregs[i], sregs[i]);
+			// Like the interpreter, work on the bits so NaNs keep their sign and -0.0 becomes 0.
+			fp.FMOV(SCRATCH1, fpr.V(sregs[i]));
+			ANDI2R(SCRATCH2, SCRATCH1, 0x80000000);
+			ORRI2R(SCRATCH2, SCRATCH2, 0x3F800000);
+			TSTI2R(SCRATCH1, 0x7FFFFFFF);
+			CSEL(SCRATCH1, WZR, SCRATCH2, CC_EQ);
+			fp.FMOV(fpr.V(tempregs[i]), SCRATCH1);
+		}
+
+		for (int i = 0; i < n; ++i) {
+			if (dregs[i] != tempregs[i]) {
+				fpr.MapDirtyInV(dregs[i], tempregs[i]);
+				fp.FMOV(fpr.V(dregs[i]), fpr.V(tempregs[i]));
+			}
+		}
+
+		ApplyPrefixD(dregs, sz);
+
+		fpr.ReleaseSpillLocksAndDiscardTemps();
 	}
 
 	void Arm64Jit::Comp_Vocp(MIPSOpcode op) {
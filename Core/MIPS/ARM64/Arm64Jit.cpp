@@ -18,6 +18,8 @@
 #include "ppsspp_config.h"
 #if PPSSPP_ARCH(ARM64)
 
+#include <cstring>
+
 #include "Common/Profiler/Profiler.h"
 #include "Common/Log.h"
 #include "Common/Serialize/Serializer.h"
@@ -111,6 +113,9 @@ Arm64Jit::Arm64Jit(MIPSState *mipsState) : blocks(mipsState, this), gpr(mipsStat
 	fpr.SetEmitter(this, &fp);
 	AllocCodeSpace(1024 * 1024 * 16);  // 32MB is the absolute max because that's what an ARM branch instruction can reach, backwards and forwards.
 	GenerateFixedCode(jo);
+	ResetCodeSegments();
+	mips_->returnStackFallback = dispatcher;
+	mips_->ClearReturnStack();
 	js.startDefaultPrefix = mips_->HasDefaultPrefix();
 	js.currentRoundingFunc = convertS0ToSCRATCH1[mips_->fcr31 & 3];
 
@@ -177,6 +182,31 @@ void Arm64Jit::ClearCache() {
 	blocks.Clear();
 	ClearCodeSpace(jitStartOffset);
 	FlushIcacheSection(region + jitStartOffset, region + region_size - jitStartOffset);
+	ResetCodeSegments();
+}
+
+void Arm64Jit::ResetCodeSegments() {
+	// Keep the segments on page boundaries, so their protection can change separately.
+	const uintptr_t SEGMENT_ALIGN = 0x10000;
+	const u8 *start = (const u8 *)(((uintptr_t)GetCodePtr() + SEGMENT_ALIGN - 1) & ~(SEGMENT_ALIGN - 1));
+	codeSegmentSize_ = (size_t)((region + region_size - start) / JIT_CODE_SEGMENTS) & ~(SEGMENT_ALIGN - 1);
+	codeSegmentsStart_ = start;
+	codeSegmentEnd_ = start + codeSegmentSize_;
+	codeSegment_ = 0;
+	SetCodePtr((u8 *)start);
+}
+
+void Arm64Jit::MoveToNextCodeSegment() {
+	codeSegment_ = (codeSegment_ + 1) % JIT_CODE_SEGMENTS;
+	u8 *start = (u8 *)codeSegmentsStart_ + codeSegment_ * codeSegmentSize_;
+	codeSegmentEnd_ = start + codeSegmentSize_;
+
+	// The first time around, these are still empty.
+	blocks.EvictCodeRange(start, codeSegmentEnd_);
+	if (NeedsProtectionChanges()) {
+		ProtectMemoryPages(start, codeSegmentSize_, MEM_PROT_READ | MEM_PROT_WRITE);
+	}
+	SetCodePtr(start);
 }
 
 void Arm64Jit::InvalidateCacheAt(u32 em_address, int length) {
@@ -222,9 +252,11 @@ void Arm64Jit::CompileDelaySlot(int flags) {
 
 void Arm64Jit::Compile(u32 em_address) {
 	PROFILE_THIS_SCOPE("jitc");
-	if (GetSpaceLeft() < 0x10000 || blocks.IsFull()) {
-		INFO_LOG(JIT, "Space left: %d", (int)GetSpaceLeft());
+	if (blocks.IsFull()) {
+		INFO_LOG(JIT, "Out of blocks, clearing");
 		ClearCache();
+	} else if (GetCodeSegmentSpaceLeft() < 0x10000) {
+		MoveToNextCodeSegment();
 	}
 
 	BeginWrite(4);
@@ -321,6 +353,12 @@ const u8 *Arm64Jit::DoJit(u32 em_address, JitBlock *b) {
 	}
 
 	b->normalEntry = GetCodePtr();
+	if (jitBlockProfiling) {
+		MOVP2R(SCRATCH1_64, blocks.GetExecCounter(b));
+		LDR(INDEX_UNSIGNED, SCRATCH2_64, SCRATCH1_64, 0);
+		ADD(SCRATCH2_64, SCRATCH2_64, 1);
+		STR(INDEX_UNSIGNED, SCRATCH2_64, SCRATCH1_64, 0);
+	}
 	// TODO: this needs work
 	MIPSAnalyst::AnalysisResults analysis; // = MIPSAnalyst::Analyze(em_address);
 
@@ -350,7 +388,7 @@ const u8 *Arm64Jit::DoJit(u32 em_address, JitBlock *b) {
 		}
 
 		// Safety check, in case we get a bunch of really large jit ops without a lot of branching.
-		if (GetSpaceLeft() < 0x800 || js.numInstructions >= JitBlockCache::MAX_BLOCK_INSTRUCTIONS) {
+		if (GetCodeSegmentSpaceLeft() < 0x800 || js.numInstructions >= JitBlockCache::MAX_BLOCK_INSTRUCTIONS) {
 			FlushAll();
 			WriteExit(GetCompilerPC(), js.nextExit++);
 			js.compiling = false;
@@ -444,14 +482,14 @@ void Arm64Jit::Comp_RunBlock(MIPSOpcode op) {
 }
 
 void Arm64Jit::LinkBlock(u8 *exitPoint, const u8 *checkedEntry) {
-	if (PlatformIsWXExclusive()) {
+	if (NeedsProtectionChanges()) {
 		ProtectMemoryPages(exitPoint, 32, MEM_PROT_READ | MEM_PROT_WRITE);
 	}
 	ARM64XEmitter emit(GetCodePtrFromWritablePtr(exitPoint), exitPoint);
 	emit.B(checkedEntry);
 	// TODO: Write stuff after, convering up the now-unused instructions.
 	emit.FlushIcache();
-	if (PlatformIsWXExclusive()) {
+	if (NeedsProtectionChanges()) {
 		ProtectMemoryPages(exitPoint, 32, MEM_PROT_READ | MEM_PROT_EXEC);
 	}
 }
@@ -460,7 +498,7 @@ void Arm64Jit::UnlinkBlock(u8 *checkedEntry, u32 originalAddress) {
 	// Send anyone who tries to run this block back to the dispatcher.
 	// Not entirely ideal, but .. works.
 	// Spurious entrances from previously linked blocks can only come through checkedEntry
-	if (PlatformIsWXExclusive()) {
+	if (NeedsProtectionChanges()) {
 		ProtectMemoryPages(checkedEntry, 16, MEM_PROT_READ | MEM_PROT_WRITE);
 	}
 
@@ -470,11 +508,36 @@ void Arm64Jit::UnlinkBlock(u8 *checkedEntry, u32 originalAddress) {
 	emit.B(MIPSComp::jit->GetDispatcher());
 	emit.FlushIcache();
 
-	if (PlatformIsWXExclusive()) {
+	if (NeedsProtectionChanges()) {
 		ProtectMemoryPages(checkedEntry, 16, MEM_PROT_READ | MEM_PROT_EXEC);
 	}
 }
 
+const u8 *Arm64Jit::GetLinkedExitTarget(const u8 *exitPoint) {
+	u32 inst;
+	memcpy(&inst, exitPoint, sizeof(inst));
+	// Linked exits are a B, unlinked ones start by loading the destination.
+	if ((inst & 0xFC000000) != 0x14000000)
+		return nullptr;
+	// Sign extend imm26, times 4.
+	s32 offset = (s32)(inst << 6) >> 4;
+	return GetCodePtrFromWritablePtr((u8 *)exitPoint) + offset;
+}
+
+void Arm64Jit::UnlinkExit(u8 *exitPoint, u32 destination) {
+	if (NeedsProtectionChanges()) {
+		ProtectMemoryPages(exitPoint, 32, MEM_PROT_READ | MEM_PROT_WRITE);
+	}
+	// Same as an exit that was never linked, WriteExit leaves room for it.
+	ARM64XEmitter emit(GetCodePtrFromWritablePtr(exitPoint), exitPoint);
+	emit.MOVI2R(SCRATCH1, destination);
+	emit.B((const void *)dispatcherPCInSCRATCH1);
+	emit.FlushIcache();
+	if (NeedsProtectionChanges()) {
+		ProtectMemoryPages(exitPoint, 32, MEM_PROT_READ | MEM_PROT_EXEC);
+	}
+}
+
 bool Arm64Jit::ReplaceJalTo(u32 dest) {
 #if PPSSPP_ARCH(ARM64)
 	const ReplacementTableEntry *entry = nullptr;
@@ -587,7 +650,14 @@ void Arm64Jit::Comp_ReplacementFunc(MIPSOpcode op)
 
 void Arm64Jit::Comp_Generic(MIPSOpcode op) {
 	FlushAll();
+	const MIPSInfo info = MIPSGetInfo(op);
 	MIPSInterpretFunc func = MIPSGetInterpretFunc(op);
+	if (func && jitBlockProfiling && (info & IS_VFPU) != 0) {
+		MOVP2R(SCRATCH1_64, GetVFPUFallbackCounter(op));
+		LDR(INDEX_UNSIGNED, SCRATCH2_64, SCRATCH1_64, 0);
+		ADD(SCRATCH2_64, SCRATCH2_64, 1);
+		STR(INDEX_UNSIGNED, SCRATCH2_64, SCRATCH1_64, 0);
+	}
 	if (func) {
 		SaveStaticRegisters();
 		// TODO: Perhaps keep the rounding mode for interp? Should probably, right?
@@ -600,7 +670,6 @@ void Arm64Jit::Comp_Generic(MIPSOpcode op) {
 		LoadStaticRegisters();
 	}
 
-	const MIPSInfo info = MIPSGetInfo(op);
 	if ((info & IS_VFPU) != 0 && (info & VFPU_NO_PREFIX) == 0) {
 		// If it does eat them, it'll happen in MIPSCompileOp().
 		if ((info & OUT_EAT_PREFIX) == 0)
@@ -694,6 +763,9 @@ void Arm64Jit::WriteExit(u32 destination, int exit_num) {
 	if (block >= 0 && jo.enableBlocklink) {
 		// The target block exists! Directly link to its checked entrypoint.
 		B(blocks.GetBlock(block)->checkedEntry);
+		// Leave room for UnlinkExit. MOVI2R takes at most two instructions for a 32-bit value.
+		BRK(0);
+		BRK(0);
 		b->linkStatus[exit_num] = true;
 	} else {
 		MOVI2R(SCRATCH1, destination);
@@ -709,6 +781,63 @@ void Arm64Jit::WriteExitDestInR(ARM64Reg Reg) {
 	B((const void *)dispatcher);
 }
 
+void Arm64Jit::WriteReturnStackPush(u32 returnAddress) {
+	static_assert(sizeof(MIPSState::ReturnStackEntry) == 16, "Entries are indexed with a shift");
+	if (!jo.enableBlocklink)
+		return;
+	const int stackOffset = (int)offsetof(MIPSState, returnStack);
+
+	// Only push once the return address has been compiled. Look it up the same way the dispatcher does.
+	u32 fetchAddress = returnAddress;
+#ifdef MASKED_PSP_MEMORY
+	fetchAddress &= 0x3FFFFFFF;
+#endif
+	MOVI2R(SCRATCH1, fetchAddress);
+	LDR(SCRATCH1, MEMBASEREG, SCRATCH1_64);
+	LSR(SCRATCH2, SCRATCH1, 24);
+	CMP(SCRATCH2, MIPS_EMUHACK_OPCODE >> 24);
+	FixupBranch notCompiled = B(CC_NEQ);
+	ANDI2R(SCRATCH1, SCRATCH1, 0x00FFFFFF);
+	ADD(SCRATCH1_64, JITBASEREG, SCRATCH1_64);
+
+	LDR(INDEX_UNSIGNED, SCRATCH2, CTXREG, offsetof(MIPSState, returnStackTop));
+	ADD(SCRATCH2, SCRATCH2, 1);
+	ANDI2R(SCRATCH2, SCRATCH2, MIPSState::RETURN_STACK_SIZE - 1);
+	STR(INDEX_UNSIGNED, SCRATCH2, CTXREG, offsetof(MIPSState, returnStackTop));
+	ADD(SCRATCH2_64, CTXREG, SCRATCH2_64, ArithOption(SCRATCH2_64, ST_LSL, 4));
+	STR(INDEX_UNSIGNED, SCRATCH1_64, SCRATCH2_64, stackOffset + offsetof(MIPSState::ReturnStackEntry, code));
+	MOVI2R(SCRATCH1, returnAddress);
+	STR(INDEX_UNSIGNED, SCRATCH1, SCRATCH2_64, stackOffset + offsetof(MIPSState::ReturnStackEntry, address));
+	SetJumpTarget(notCompiled);
+}
+
+void Arm64Jit::WriteReturnStackJump(ARM64Reg Reg) {
+	if (!jo.enableBlocklink)
+		return;
+	const int stackOffset = (int)offsetof(MIPSState, returnStack);
+
+	LDR(INDEX_UNSIGNED, SCRATCH1, CTXREG, offsetof(MIPSState, returnStackTop));
+	ADD(SCRATCH2_64, CTXREG, SCRATCH1_64, ArithOption(SCRATCH1_64, ST_LSL, 4));
+	LDR(INDEX_UNSIGNED, SCRATCH1, SCRATCH2_64, stackOffset + offsetof(MIPSState::ReturnStackEntry, address));
+	CMP(SCRATCH1, Reg);
+	FixupBranch mismatch = B(CC_NEQ);
+
+	LDR(INDEX_UNSIGNED, SCRATCH2_64, SCRATCH2_64, stackOffset + offsetof(MIPSState::ReturnStackEntry, code));
+	LDR(INDEX_UNSIGNED, SCRATCH1, CTXREG, offsetof(MIPSState, returnStackTop));
+	SUB(SCRATCH1, SCRATCH1, 1);
+	ANDI2R(SCRATCH1, SCRATCH1, MIPSState::RETURN_STACK_SIZE - 1);
+	STR(INDEX_UNSIGNED, SCRATCH1, CTXREG, offsetof(MIPSState, returnStackTop));
+	MovToPC(Reg);
+	WriteDownCount();
+	// The code is a normal entry, so the dispatcher has to take care of an expired downcount.
+	FixupBranch expired = B(CC_MI);
+	BR(SCRATCH2_64);
+	SetJumpTarget(expired);
+	B((const void *)dispatcher);
+
+	SetJumpTarget(mismatch);
+}
+
 void Arm64Jit::WriteSyscallExit() {
 	WriteDownCount();
 	B((const void *)dispatcherCheckCoreState);
@@ -744,7 +873,7 @@ bool Arm64Jit::CheckJitBreakpoint(u32 addr, int downcountOffset) {
 }
 
 bool Arm64Jit::CheckMemoryBreakpoint(int instructionOffset) {
-	if (CBreakPoints::HasMemChecks()) {
+	if (CBreakPoints::HasJitMemChecks()) {
 		int off = instructionOffset + (js.inDelaySlot ? 1 : 0);
 
 		MRS(FLAGTEMPREG, FIELD_NZCV);
@@ -754,7 +883,9 @@ bool Arm64Jit::CheckMemoryBreakpoint(int instructionOffset) {
 		MovToPC(W0);
 		if (off != 0)
 			ADDI2R(W0, W0, off * 4);
+		gpr.FlushBeforeCall();
 		QuickCallFunction(SCRATCH2_64, &JitMemCheck);
+		gpr.ReloadAfterCall();
 
 		// If 0, the breakpoint wasn't tripped.
 		CMPI2R(W0, 0);
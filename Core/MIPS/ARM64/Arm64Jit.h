@@ -191,9 +191,16 @@ class Arm64Jit : public Arm64Gen::ARM64CodeBlock, public JitInterface, public MI
 
 	void LinkBlock(u8 *exitPoint, const u8 *checkedEntry) override;
 	void UnlinkBlock(u8 *checkedEntry, u32 originalAddress) override;
+	const u8 *GetLinkedExitTarget(const u8 *exitPoint) override;
+	void UnlinkExit(u8 *exitPoint, u32 destination) override;
 
 private:
 	void GenerateFixedCode(const JitOptions &jo);
+	void ResetCodeSegments();
+	void MoveToNextCodeSegment();
+	size_t GetCodeSegmentSpaceLeft() const {
+		return codeSegmentEnd_ - GetCodePtr();
+	}
 	void FlushAll();
 	void FlushPrefixV();
 
@@ -218,6 +225,9 @@ class Arm64Jit : public Arm64Gen::ARM64CodeBlock, public JitInterface, public MI
 
 	void WriteExit(u32 destination, int exit_num);
 	void WriteExitDestInR(Arm64Gen::ARM64Reg Reg);
+	// See MIPSState::returnStack. Both only use SCRATCH1 and SCRATCH2, and emit nothing without block linking.
+	void WriteReturnStackPush(u32 returnAddress);
+	void WriteReturnStackJump(Arm64Gen::ARM64Reg Reg);
 	void WriteSyscallExit();
 	bool CheckJitBreakpoint(u32 addr, int downcountOffset);
 	bool CheckMemoryBreakpoint(int instructionOffset = 0);
@@ -258,6 +268,13 @@ class Arm64Jit : public Arm64Gen::ARM64CodeBlock, public JitInterface, public MI
 	JitOptions jo;
 	JitState js;
 
+	// Blocks are written to the segments in turn. Once they've all been used, the oldest one is
+	// evicted to make room, instead of clearing the whole cache.
+	const u8 *codeSegmentsStart_ = nullptr;
+	const u8 *codeSegmentEnd_ = nullptr;
+	size_t codeSegmentSize_ = 0;
+	int codeSegment_ = 0;
+
 	Arm64RegCache gpr;
 	Arm64RegCacheFPU fpr;
 
@@ -75,7 +75,7 @@ const ARM64Reg *Arm64RegCache::GetMIPSAllocationOrder(int &count) {
 		W19, W20, W21, W22, W23, W0, W1, W2, W3, W4, W5, W6, W7, W8, W9, W10, W11, W12, W13, W14, W15,
 	};
 	static const ARM64Reg allocationOrderStaticAlloc[] = {
-		W0, W1, W2, W3, W4, W5, W6, W7, W8, W9, W10, W11, W12, W13, W14, W15,
+		W0, W1, W2, W3, W4, W5, W6, W7, W8, W9, W10, W11, W12, W13,
 	};
 
 	if (jo_->useStaticAlloc) {
@@ -94,6 +94,10 @@ const Arm64RegCache::StaticAllocation *Arm64RegCache::GetStaticAllocations(int &
 		{MIPS_REG_V1, W22},
 		{MIPS_REG_A0, W21},
 		{MIPS_REG_RA, W23},
+		// We're out of callee-save registers, so these are saved around calls (see FlushBeforeCall.)
+		// Still much cheaper than loading and storing them in every block.
+		{MIPS_REG_GP, W15},
+		{MIPS_REG_A1, W14},
 	};
 
 	if (jo_->useStaticAlloc) {
@@ -132,9 +136,38 @@ void Arm64RegCache::EmitSaveStaticRegisters() {
 void Arm64RegCache::FlushBeforeCall() {
 	// These registers are not preserved by function calls.
 	for (int i = 0; i < 19; ++i) {
-		FlushArmReg(ARM64Reg(W0 + i));
+		ARM64Reg r = ARM64Reg(W0 + i);
+		if (ar[r].mipsReg != MIPS_REG_INVALID && mr[ar[r].mipsReg].isStatic)
+			continue;
+		FlushArmReg(r);
 	}
 	FlushArmReg(W30);
+
+	// Statics here would be lost, so store them and have ReloadAfterCall() get them back.
+	int count;
+	const StaticAllocation *allocs = GetStaticAllocations(count);
+	for (int i = 0; i < count; i++) {
+		if (allocs[i].ar >= W19)
+			continue;
+		RegMIPS &mreg = mr[allocs[i].mr];
+		if (mreg.loc == ML_IMM)
+			continue;
+		if (mreg.loc == ML_ARMREG_AS_PTR)
+			emit_->SUB(EncodeRegTo64(allocs[i].ar), EncodeRegTo64(allocs[i].ar), MEMBASEREG);
+		mreg.loc = ML_ARMREG;
+		ar[allocs[i].ar].pointerified = false;
+		emit_->STR(INDEX_UNSIGNED, allocs[i].ar, CTXREG, GetMipsRegOffset(allocs[i].mr));
+	}
+}
+
+void Arm64RegCache::ReloadAfterCall() {
+	int count;
+	const StaticAllocation *allocs = GetStaticAllocations(count);
+	for (int i = 0; i < count; i++) {
+		// If it's still an imm, FlushBeforeCall() didn't store it and it's materialized later.
+		if (allocs[i].ar < W19 && mr[allocs[i].mr].loc == ML_ARMREG)
+			emit_->LDR(INDEX_UNSIGNED, allocs[i].ar, CTXREG, GetMipsRegOffset(allocs[i].mr));
+	}
 }
 
 bool Arm64RegCache::IsInRAM(MIPSGPReg reg) {
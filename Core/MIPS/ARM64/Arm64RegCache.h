@@ -121,6 +121,8 @@ class Arm64RegCache {
 	void MapDirtyDirtyInIn(MIPSGPReg rd1, MIPSGPReg rd2, MIPSGPReg rs, MIPSGPReg rt, bool avoidLoad = true);
 	void FlushArmReg(Arm64Gen::ARM64Reg r);
 	void FlushBeforeCall();
+	// Reloads the statics in caller-saved registers, which FlushBeforeCall() stored.
+	void ReloadAfterCall();
 	void FlushAll();
 	void FlushR(MIPSGPReg r);
 	void DiscardR(MIPSGPReg r);
@@ -54,6 +54,41 @@ using namespace MIPSAnalyst;
 namespace MIPSComp
 {
 
+bool IRFrontend::CanContinueTo(u32 targetAddr) {
+	if (js.numInstructions >= opts.continueMaxInstructions || !Memory::IsValidAddress(targetAddr))
+		return false;
+	// Only forward past the delay slot, so the block still covers one contiguous range.
+	// That keeps hashing and invalidation simple (any skipped code is just included.)
+	if (targetAddr <= GetCompilerPC() + 4)
+		return false;
+	return targetAddr - js.blockStart < (u32)opts.continueMaxInstructions * 4;
+}
+
+// Called after the delay slot and downcount, instead of writing the exits.
+// Either continues at the target of an always taken branch, or along the fallthrough
+// with a side exit for the taken case.
+bool IRFrontend::ContinueBranch(IRComparison cc, u32 targetAddr, int lhs, int rhs, bool alwaysTaken) {
+	// Don't continue if the delay slot ended the block (i.e. a syscall.)
+	if (!opts.continueBranches || !js.compiling)
+		return false;
+
+	if (alwaysTaken) {
+		if (!CanContinueTo(targetAddr))
+			return false;
+		// Account for the increment in the loop.
+		js.compilerPC = targetAddr - 4;
+	} else {
+		if (!CanContinueTo(GetCompilerPC() + 8))
+			return false;
+		// cc is the not taken condition, so exit on the opposite.
+		ir.Write(ComparisonToExit(Invert(cc)), ir.AddConstant(targetAddr), lhs, rhs);
+		// Account for the delay slot.
+		js.compilerPC += 4;
+	}
+	js.compiling = true;
+	return true;
+}
+
 void IRFrontend::BranchRSRTComp(MIPSOpcode op, IRComparison cc, bool likely) {
 	if (js.inDelaySlot) {
 		ERROR_LOG_REPORT(JIT, "Branch in RSRTComp delay slot at %08x in block starting at %08x", GetCompilerPC(), js.blockStart);
@@ -99,6 +134,9 @@ void IRFrontend::BranchRSRTComp(MIPSOpcode op, IRComparison cc, bool likely) {
 	js.downcountAmount = 0;
 
 	FlushAll();
+	// beq with the same register (the b pseudo-op) is always taken.
+	if (!likely && ContinueBranch(cc, targetAddr, lhs, rhs, rs == rt && cc == IRComparison::NotEqual))
+		return;
 	ir.Write(ComparisonToExit(cc), ir.AddConstant(GetCompilerPC() + 8), lhs, rhs);
 	// This makes the block "impure" :(
 	if (likely)
@@ -141,6 +179,10 @@ void IRFrontend::BranchRSZeroComp(MIPSOpcode op, IRComparison cc, bool andLink,
 	js.downcountAmount = 0;
 
 	FlushAll();
+	// Against zero, gtz and ltz never exit as not taken (blez/bgez zero, also known as b/bal.)
+	bool alwaysTaken = rs == MIPS_REG_ZERO && (cc == IRComparison::Greater || cc == IRComparison::Less);
+	if (!likely && ContinueBranch(cc, targetAddr, lhs, 0, alwaysTaken))
+		return;
 	ir.Write(ComparisonToExit(cc), ir.AddConstant(GetCompilerPC() + 8), lhs);
 	if (likely)
 		CompileDelaySlot();
@@ -208,6 +250,8 @@ void IRFrontend::BranchFPFlag(MIPSOpcode op, IRComparison cc, bool likely) {
 	js.downcountAmount = 0;
 
 	FlushAll();
+	if (!likely && ContinueBranch(cc, targetAddr, IRTEMP_LHS, 0, false))
+		return;
 	// Not taken
 	ir.Write(ComparisonToExit(cc), ir.AddConstant(GetCompilerPC() + 8), IRTEMP_LHS, 0);
 	// Taken
@@ -324,6 +368,15 @@ void IRFrontend::Comp_Jump(MIPSOpcode op) {
 		break;
 	}
 
+	// Don't continue if the delay slot ended the block (i.e. a syscall.)
+	if (opts.continueJumps && js.compiling && CanContinueTo(targetAddr)) {
+		// Keep going at the target, the downcount just accumulates.
+		FlushAll();
+		// Account for the increment in the loop.
+		js.compilerPC = targetAddr - 4;
+		return;
+	}
+
 	int dcAmount = js.downcountAmount;
 	ir.Write(IROp::Downcount, 0, ir.AddConstant(dcAmount));
 	js.downcountAmount = 0;
@@ -23,6 +23,7 @@
 #include "Core/Reporting.h"
 #include "Core/HLE/ReplaceTables.h"
 #include "Core/MemMap.h"
+#include "Core/MIPS/MIPSDebugInterface.h"
 #include "Core/MIPS/MIPSTables.h"
 #include "Core/MIPS/IR/IRFrontend.h"
 #include "Core/MIPS/IR/IRRegCache.h"
@@ -258,17 +259,8 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 
 	IRWriter simplified;
 	IRWriter *code = &ir;
-	if (!js.hadBreakpoints) {
-		static const IRPassFunc passes[] = {
-			&RemoveLoadStoreLeftRight,
-			&OptimizeFPMoves,
-			&PropagateConstants,
-			&PurgeTemps,
-			// &ReorderLoadStore,
-			// &MergeLoadStore,
-			// &ThreeOpToTwoOp,
-		};
-		if (IRApplyPasses(passes, ARRAY_SIZE(passes), ir, simplified, opts))
+	if (!js.hadBreakpoints && !opts.deferOptimization) {
+		if (OptimizeBlock(ir, simplified, opts))
 			logBlocks = 1;
 		code = &simplified;
 		//if (ir.GetInstructions().size() >= 24)
@@ -313,11 +305,162 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 		dontLogBlocks--;
 }
 
+bool IRFrontend::OptimizeBlock(const IRWriter &in, IRWriter &out, const IROptions &opts) {
+	static const IRPassFunc passes[] = {
+		&RemoveLoadStoreLeftRight,
+		&OptimizeFPMoves,
+		&PropagateConstants,
+		&EliminateCommonSubexpressions,
+		&EliminateDeadStores,
+		&PurgeTemps,
+		// &ReorderLoadStore,
+		// &MergeLoadStore,
+		// &ThreeOpToTwoOp,
+	};
+	return IRApplyPasses(passes, ARRAY_SIZE(passes), in, out, opts);
+}
+
 void IRFrontend::Comp_RunBlock(MIPSOpcode op) {
 	// This shouldn't be necessary, the dispatcher should catch us before we get here.
 	ERROR_LOG(JIT, "Comp_RunBlock should never be reached!");
 }
 
+// Translates a breakpoint condition into IR, so false conditions don't leave the block.
+// Only handles integer math on registers and constants, returns false for anything else
+// (memory, floats, division, etc.) and the debugger will evaluate those instead.
+static bool CompileBreakpointCondition(IRWriter &ir, u32 addr, const PostfixExpression &exp, u8 &result) {
+	// Each stack slot gets its own temp.  These are all free between instructions.
+	static const u8 slotTemps[] = {
+		IRTEMP_0, IRTEMP_1, IRTEMP_2, IRTEMP_3,
+		IRTEMP_LR_ADDR, IRTEMP_LR_VALUE, IRTEMP_LR_MASK, IRTEMP_LR_SHIFT,
+	};
+	static const int MAX_SLOTS = (int)ARRAY_SIZE(slotTemps);
+	// GPRs are used directly, without copying them to the temp.
+	u8 stack[MAX_SLOTS];
+	int depth = 0;
+
+	for (const ExpressionPair &item : exp) {
+		switch (item.first) {
+		case EXCOMM_CONST:
+			if (depth >= MAX_SLOTS)
+				return false;
+			ir.WriteSetConstant(slotTemps[depth], item.second);
+			stack[depth] = slotTemps[depth];
+			depth++;
+			break;
+
+		case EXCOMM_REF:
+			if (depth >= MAX_SLOTS)
+				return false;
+			if (item.second < 32) {
+				stack[depth] = (u8)item.second;
+			} else if (item.second == REF_INDEX_PC) {
+				ir.WriteSetConstant(slotTemps[depth], addr);
+				stack[depth] = slotTemps[depth];
+			} else if (item.second == REF_INDEX_HI || item.second == REF_INDEX_LO) {
+				ir.Write(item.second == REF_INDEX_HI ? IROp::MfHi : IROp::MfLo, slotTemps[depth]);
+				stack[depth] = slotTemps[depth];
+			} else {
+				return false;
+			}
+			depth++;
+			break;
+
+		case EXCOMM_OP:
+		{
+			const u8 zero = MIPS_REG_ZERO;
+			switch (item.second) {
+			case EXOP_SIGNPLUS:
+				if (depth < 1)
+					return false;
+				continue;
+			case EXOP_SIGNMINUS:
+			case EXOP_BITNOT:
+			case EXOP_LOGNOT:
+			{
+				if (depth < 1)
+					return false;
+				u8 a = stack[depth - 1];
+				u8 d = slotTemps[depth - 1];
+				if (item.second == EXOP_SIGNMINUS)
+					ir.Write(IROp::Neg, d, a);
+				else if (item.second == EXOP_BITNOT)
+					ir.Write(IROp::Not, d, a);
+				else
+					ir.Write(IROp::SltUConst, d, a, ir.AddConstant(1));
+				stack[depth - 1] = d;
+				continue;
+			}
+			default:
+				break;
+			}
+
+			if (depth < 2)
+				return false;
+			// Same order as parsePostfixExpression: a is the left side.
+			u8 a = stack[depth - 2];
+			u8 b = stack[depth - 1];
+			u8 d = slotTemps[depth - 2];
+			switch (item.second) {
+			case EXOP_ADD: ir.Write(IROp::Add, d, a, b); break;
+			case EXOP_SUB: ir.Write(IROp::Sub, d, a, b); break;
+			case EXOP_SHL: ir.Write(IROp::Shl, d, a, b); break;
+			case EXOP_SHR: ir.Write(IROp::Shr, d, a, b); break;
+			case EXOP_BITAND: ir.Write(IROp::And, d, a, b); break;
+			case EXOP_BITOR: ir.Write(IROp::Or, d, a, b); break;
+			case EXOP_XOR: ir.Write(IROp::Xor, d, a, b); break;
+			case EXOP_LOWER: ir.Write(IROp::SltU, d, a, b); break;
+			case EXOP_GREATER: ir.Write(IROp::SltU, d, b, a); break;
+			case EXOP_LOWEREQUAL:
+				ir.Write(IROp::SltU, d, b, a);
+				ir.Write(IROp::XorConst, d, d, ir.AddConstant(1));
+				break;
+			case EXOP_GREATEREQUAL:
+				ir.Write(IROp::SltU, d, a, b);
+				ir.Write(IROp::XorConst, d, d, ir.AddConstant(1));
+				break;
+			case EXOP_EQUAL:
+				ir.Write(IROp::Xor, d, a, b);
+				ir.Write(IROp::SltUConst, d, d, ir.AddConstant(1));
+				break;
+			case EXOP_NOTEQUAL:
+				ir.Write(IROp::Xor, d, a, b);
+				ir.Write(IROp::SltU, d, zero, d);
+				break;
+			case EXOP_LOGAND:
+			{
+				// b's slot is free after this, so it can hold b != 0.
+				u8 t = slotTemps[depth - 1];
+				ir.Write(IROp::SltU, d, zero, a);
+				ir.Write(IROp::SltU, t, zero, b);
+				ir.Write(IROp::And, d, d, t);
+				break;
+			}
+			case EXOP_LOGOR:
+				ir.Write(IROp::Or, d, a, b);
+				ir.Write(IROp::SltU, d, zero, d);
+				break;
+			default:
+				// Memory reads, division, ternaries, etc.
+				return false;
+			}
+			stack[depth - 2] = d;
+			depth--;
+			break;
+		}
+
+		default:
+			// Float constants.
+			return false;
+		}
+	}
+
+	if (depth != 1)
+		return false;
+	result = stack[0];
+	return true;
+}
+
 void IRFrontend::CheckBreakpoint(u32 addr) {
 	if (CBreakPoints::IsAddressBreakPoint(addr)) {
 		FlushAll();
@@ -331,7 +474,18 @@ void IRFrontend::CheckBreakpoint(u32 addr) {
 		ir.Write(IROp::Downcount, 0, ir.AddConstant(downcountAmount));
 		// Note that this means downcount can't be metadata on the block.
 		js.downcountAmount = -downcountOffset;
-		ir.Write(IROp::Breakpoint);
+
+		// If the condition is simple enough, check it here rather than in the debugger each time.
+		BreakPointCond cond;
+		IRWriter condIR;
+		u8 condReg;
+		if (CBreakPoints::GetBreakPointCondition(addr, cond) && CompileBreakpointCondition(condIR, addr, cond.expression, condReg)) {
+			for (const IRInst &inst : condIR.GetInstructions())
+				ir.Write(inst);
+			ir.Write(IROp::BreakpointIf, 0, condReg);
+		} else {
+			ir.Write(IROp::Breakpoint);
+		}
 		ApplyRoundingMode();
 
 		js.hadBreakpoints = true;
@@ -339,7 +493,7 @@ void IRFrontend::CheckBreakpoint(u32 addr) {
 }
 
 void IRFrontend::CheckMemoryBreakpoint(int rs, int offset) {
-	if (CBreakPoints::HasMemChecks()) {
+	if (CBreakPoints::HasJitMemChecks()) {
 		FlushAll();
 
 		RestoreRoundingMode();
@@ -89,6 +89,13 @@ class IRFrontend : public MIPSFrontendInterface {
 	bool CheckRounding(u32 blockAddress);  // returns true if we need a do-over
 
 	void DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload);
+	// True if the last block from DoJit can be optimized later (see IROptions::deferOptimization.)
+	bool CanOptimizeLater() const {
+		return opts.deferOptimization && !js.hadBreakpoints;
+	}
+
+	// Runs the optimization passes.  Doesn't touch any state, so it's safe from any thread.
+	static bool OptimizeBlock(const IRWriter &in, IRWriter &out, const IROptions &opts);
 
 	void EatPrefix() override {
 		js.EatPrefix();
@@ -114,6 +121,10 @@ class IRFrontend : public MIPSFrontendInterface {
 	void CheckBreakpoint(u32 addr);
 	void CheckMemoryBreakpoint(int rs, int offset);
 
+	// Trace mode helpers.
+	bool CanContinueTo(u32 targetAddr);
+	bool ContinueBranch(IRComparison cc, u32 targetAddr, int lhs, int rhs, bool alwaysTaken);
+
 	// Utility compilation functions
 	void BranchFPFlag(MIPSOpcode op, IRComparison cc, bool likely);
 	void BranchVFPUFlag(MIPSOpcode op, IRComparison cc, bool likely);
@@ -161,6 +161,7 @@ static const IRMeta irMeta[] = {
 	{ IROp::SetPCConst, "SetPC", "_C" },
 	{ IROp::CallReplacement, "CallRepl", "_C" },
 	{ IROp::Breakpoint, "Breakpoint", "", IRFLAG_EXIT },
+	{ IROp::BreakpointIf, "BreakpointIf", "_G", IRFLAG_EXIT },
 	{ IROp::MemoryCheck, "MemoryCheck", "_GC", IRFLAG_EXIT },
 
 	{ IROp::RestoreRoundingMode, "RestoreRoundingMode", "" },
@@ -214,6 +214,8 @@ enum class IROp : u8 {
 	CallReplacement,
 	Break,
 	Breakpoint,
+	// Like Breakpoint, but only if src1 is non-zero.
+	BreakpointIf,
 	MemoryCheck,
 };
 
@@ -238,7 +240,6 @@ enum class Vec4Init {
 	Set_0001,
 };
 
-// Hm, unused
 inline IRComparison Invert(IRComparison comp) {
 	switch (comp) {
 	case IRComparison::Equal: return IRComparison::NotEqual;
@@ -339,6 +340,9 @@ u32 IRInterpret(MIPSState *ms, const IRInst *inst, int count);
 // Each IR block gets a constant pool.
 class IRWriter {
 public:
+	IRWriter() {}
+	explicit IRWriter(const std::vector<IRInst> &insts) : insts_(insts) {}
+
 	IRWriter &operator =(const IRWriter &w) {
 		insts_ = w.insts_;
 		return *this;
@@ -371,6 +375,12 @@ class IRWriter {
 struct IROptions {
 	uint32_t disableFlags;
 	bool unalignedLoadStore;
+	// Skip the passes in DoJit, so they can instead be run later for hot blocks.
+	bool deferOptimization;
+	// Trace mode: follow forward jumps and branch fallthroughs to build larger blocks.
+	bool continueBranches;
+	bool continueJumps;
+	int continueMaxInstructions;
 };
 
 const IRMeta *GetIRMeta(IROp op);
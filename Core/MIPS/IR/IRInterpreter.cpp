@@ -61,6 +61,36 @@ alignas(16) static const uint32_t lowBytesMask[4] = {
 	0x000000FF, 0x000000FF, 0x000000FF, 0x000000FF,
 };
 
+#if defined(_M_SSE) || PPSSPP_ARCH(ARM64)
+// The SIMD shuffles only take immediates, so we instantiate all 256 of them (4^4) and index by src2.
+template <int shuffle>
+static void Vec4ShuffleSIMD(float *dest, const float *src) {
+#if defined(_M_SSE)
+	__m128 v = _mm_load_ps(src);
+	_mm_store_ps(dest, _mm_shuffle_ps(v, v, shuffle));
+#else
+	float32x4_t v = vld1q_f32(src);
+	float32x4_t r = vdupq_laneq_f32(v, shuffle & 3);
+	r = vcopyq_laneq_f32(r, 1, v, (shuffle >> 2) & 3);
+	r = vcopyq_laneq_f32(r, 2, v, (shuffle >> 4) & 3);
+	r = vcopyq_laneq_f32(r, 3, v, (shuffle >> 6) & 3);
+	vst1q_f32(dest, r);
+#endif
+}
+
+typedef void (*Vec4ShuffleFunc)(float *dest, const float *src);
+
+#define VEC4_SHUFFLE4(n) &Vec4ShuffleSIMD<n>, &Vec4ShuffleSIMD<n + 1>, &Vec4ShuffleSIMD<n + 2>, &Vec4ShuffleSIMD<n + 3>
+#define VEC4_SHUFFLE16(n) VEC4_SHUFFLE4(n), VEC4_SHUFFLE4(n + 4), VEC4_SHUFFLE4(n + 8), VEC4_SHUFFLE4(n + 12)
+#define VEC4_SHUFFLE64(n) VEC4_SHUFFLE16(n), VEC4_SHUFFLE16(n + 16), VEC4_SHUFFLE16(n + 32), VEC4_SHUFFLE16(n + 48)
+static const Vec4ShuffleFunc vec4Shuffles[256] = {
+	VEC4_SHUFFLE64(0), VEC4_SHUFFLE64(64), VEC4_SHUFFLE64(128), VEC4_SHUFFLE64(192),
+};
+#undef VEC4_SHUFFLE4
+#undef VEC4_SHUFFLE16
+#undef VEC4_SHUFFLE64
+#endif
+
 u32 RunBreakpoint(u32 pc) {
 	// Should we skip this breakpoint?
 	if (CBreakPoints::CheckSkipFirst() == pc)
@@ -79,116 +109,179 @@ u32 RunMemCheck(u32 pc, u32 addr) {
 	return coreState != CORE_RUNNING ? 1 : 0;
 }
 
+// With GCC and Clang, each handler jumps straight to the next instruction's handler through a
+// table (threaded dispatch), instead of all of them sharing the switch's single indirect branch,
+// which predicts much worse. The operands stay in the compact IRInst encoding.
+// MSVC doesn't support labels as values, so it (and debug builds) just use the switch.
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(_DEBUG)
+#define IR_THREADED_DISPATCH 1
+#define IR_CASE(name) case IROp::name: op_##name:
+#define IR_NEXT { inst++; goto *dispatch[(int)inst->op]; }
+#else
+#define IR_THREADED_DISPATCH 0
+#define IR_CASE(name) case IROp::name:
+#define IR_NEXT break
+#endif
+
 // We cannot use NEON on ARM32 here until we make it a hard dependency. We can, however, on ARM64.
 u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 	const IRInst *end = inst + count;
+#if IR_THREADED_DISPATCH
+	// Filled once, the label addresses are only known inside this function.
+	static const void *dispatch[256];
+	static bool dispatchReady = false;
+	if (!dispatchReady) {
+		// Anything not listed goes through the switch, which is always correct, just slower.
+		for (const void *&target : dispatch)
+			target = &&op_switch;
+#define IR_HANDLER(name) dispatch[(int)IROp::name] = &&op_##name;
+		IR_HANDLER(Nop) IR_HANDLER(SetConst) IR_HANDLER(SetConstF) IR_HANDLER(Add) IR_HANDLER(Sub) IR_HANDLER(And)
+		IR_HANDLER(Or) IR_HANDLER(Xor) IR_HANDLER(Mov) IR_HANDLER(AddConst) IR_HANDLER(SubConst)
+		IR_HANDLER(AndConst) IR_HANDLER(OrConst) IR_HANDLER(XorConst) IR_HANDLER(Neg) IR_HANDLER(Not)
+		IR_HANDLER(Ext8to32) IR_HANDLER(Ext16to32) IR_HANDLER(ReverseBits) IR_HANDLER(Load8) IR_HANDLER(Load8Ext)
+		IR_HANDLER(Load16) IR_HANDLER(Load16Ext) IR_HANDLER(Load32) IR_HANDLER(Load32Left) IR_HANDLER(Load32Right)
+		IR_HANDLER(LoadFloat) IR_HANDLER(Store8) IR_HANDLER(Store16) IR_HANDLER(Store32) IR_HANDLER(Store32Left)
+		IR_HANDLER(Store32Right) IR_HANDLER(StoreFloat) IR_HANDLER(LoadVec4) IR_HANDLER(StoreVec4)
+		IR_HANDLER(Vec4Init) IR_HANDLER(Vec4Shuffle) IR_HANDLER(Vec4Mov) IR_HANDLER(Vec4Add) IR_HANDLER(Vec4Sub)
+		IR_HANDLER(Vec4Mul) IR_HANDLER(Vec4Div) IR_HANDLER(Vec4Scale) IR_HANDLER(Vec4Neg) IR_HANDLER(Vec4Abs)
+		IR_HANDLER(Vec2Unpack16To31) IR_HANDLER(Vec2Unpack16To32) IR_HANDLER(Vec4Unpack8To32)
+		IR_HANDLER(Vec2Pack32To16) IR_HANDLER(Vec2Pack31To16) IR_HANDLER(Vec4Pack32To8) IR_HANDLER(Vec4Pack31To8)
+		IR_HANDLER(Vec2ClampToZero) IR_HANDLER(Vec4ClampToZero) IR_HANDLER(Vec4DuplicateUpperBitsAndShift1)
+		IR_HANDLER(FCmpVfpuBit) IR_HANDLER(FCmpVfpuAggregate) IR_HANDLER(FCmovVfpuCC) IR_HANDLER(Vec4Dot)
+		IR_HANDLER(FSin) IR_HANDLER(FCos) IR_HANDLER(FRSqrt) IR_HANDLER(FRecip) IR_HANDLER(FAsin)
+		IR_HANDLER(ShlImm) IR_HANDLER(ShrImm) IR_HANDLER(SarImm) IR_HANDLER(RorImm) IR_HANDLER(Shl) IR_HANDLER(Shr)
+		IR_HANDLER(Sar) IR_HANDLER(Ror) IR_HANDLER(Clz) IR_HANDLER(Slt) IR_HANDLER(SltU) IR_HANDLER(SltConst)
+		IR_HANDLER(SltUConst) IR_HANDLER(MovZ) IR_HANDLER(MovNZ) IR_HANDLER(Max) IR_HANDLER(Min) IR_HANDLER(MtLo)
+		IR_HANDLER(MtHi) IR_HANDLER(MfLo) IR_HANDLER(MfHi) IR_HANDLER(Mult) IR_HANDLER(MultU) IR_HANDLER(Madd)
+		IR_HANDLER(MaddU) IR_HANDLER(Msub) IR_HANDLER(MsubU) IR_HANDLER(Div) IR_HANDLER(DivU) IR_HANDLER(BSwap16)
+		IR_HANDLER(BSwap32) IR_HANDLER(FAdd) IR_HANDLER(FSub) IR_HANDLER(FMul) IR_HANDLER(FDiv) IR_HANDLER(FMin)
+		IR_HANDLER(FMax) IR_HANDLER(FMov) IR_HANDLER(FAbs) IR_HANDLER(FSqrt) IR_HANDLER(FNeg) IR_HANDLER(FSat0_1)
+		IR_HANDLER(FSatMinus1_1) IR_HANDLER(FSign) IR_HANDLER(FpCondToReg) IR_HANDLER(VfpuCtrlToReg)
+		IR_HANDLER(FRound) IR_HANDLER(FTrunc) IR_HANDLER(FCeil) IR_HANDLER(FFloor) IR_HANDLER(FCmp)
+		IR_HANDLER(FCvtSW) IR_HANDLER(FCvtWS) IR_HANDLER(ZeroFpCond) IR_HANDLER(FMovFromGPR) IR_HANDLER(FMovToGPR)
+		IR_HANDLER(ExitToConst) IR_HANDLER(ExitToReg) IR_HANDLER(ExitToConstIfEq) IR_HANDLER(ExitToConstIfNeq)
+		IR_HANDLER(ExitToConstIfGtZ) IR_HANDLER(ExitToConstIfGeZ) IR_HANDLER(ExitToConstIfLtZ)
+		IR_HANDLER(ExitToConstIfLeZ) IR_HANDLER(Downcount) IR_HANDLER(SetPC) IR_HANDLER(SetPCConst)
+		IR_HANDLER(Syscall) IR_HANDLER(ExitToPC) IR_HANDLER(Interpret) IR_HANDLER(CallReplacement)
+		IR_HANDLER(Break) IR_HANDLER(SetCtrlVFPU) IR_HANDLER(SetCtrlVFPUReg) IR_HANDLER(SetCtrlVFPUFReg)
+		IR_HANDLER(Breakpoint) IR_HANDLER(BreakpointIf) IR_HANDLER(MemoryCheck) IR_HANDLER(ApplyRoundingMode)
+		IR_HANDLER(RestoreRoundingMode) IR_HANDLER(UpdateRoundingMode)
+#undef IR_HANDLER
+		dispatchReady = true;
+	}
+	goto *dispatch[(int)inst->op];
+#endif
+
 	while (inst != end) {
+#if IR_THREADED_DISPATCH
+	op_switch:
+#endif
 		switch (inst->op) {
-		case IROp::Nop:
+		IR_CASE(Nop)
 			_assert_(false);
-			break;
-		case IROp::SetConst:
+			IR_NEXT;
+		IR_CASE(SetConst)
 			mips->r[inst->dest] = inst->constant;
-			break;
-		case IROp::SetConstF:
+			IR_NEXT;
+		IR_CASE(SetConstF)
 			memcpy(&mips->f[inst->dest], &inst->constant, 4);
-			break;
-		case IROp::Add:
+			IR_NEXT;
+		IR_CASE(Add)
 			mips->r[inst->dest] = mips->r[inst->src1] + mips->r[inst->src2];
-			break;
-		case IROp::Sub:
+			IR_NEXT;
+		IR_CASE(Sub)
 			mips->r[inst->dest] = mips->r[inst->src1] - mips->r[inst->src2];
-			break;
-		case IROp::And:
+			IR_NEXT;
+		IR_CASE(And)
 			mips->r[inst->dest] = mips->r[inst->src1] & mips->r[inst->src2];
-			break;
-		case IROp::Or:
+			IR_NEXT;
+		IR_CASE(Or)
 			mips->r[inst->dest] = mips->r[inst->src1] | mips->r[inst->src2];
-			break;
-		case IROp::Xor:
+			IR_NEXT;
+		IR_CASE(Xor)
 			mips->r[inst->dest] = mips->r[inst->src1] ^ mips->r[inst->src2];
-			break;
-		case IROp::Mov:
+			IR_NEXT;
+		IR_CASE(Mov)
 			mips->r[inst->dest] = mips->r[inst->src1];
-			break;
-		case IROp::AddConst:
+			IR_NEXT;
+		IR_CASE(AddConst)
 			mips->r[inst->dest] = mips->r[inst->src1] + inst->constant;
-			break;
-		case IROp::SubConst:
+			IR_NEXT;
+		IR_CASE(SubConst)
 			mips->r[inst->dest] = mips->r[inst->src1] - inst->constant;
-			break;
-		case IROp::AndConst:
+			IR_NEXT;
+		IR_CASE(AndConst)
 			mips->r[inst->dest] = mips->r[inst->src1] & inst->constant;
-			break;
-		case IROp::OrConst:
+			IR_NEXT;
+		IR_CASE(OrConst)
 			mips->r[inst->dest] = mips->r[inst->src1] | inst->constant;
-			break;
-		case IROp::XorConst:
+			IR_NEXT;
+		IR_CASE(XorConst)
 			mips->r[inst->dest] = mips->r[inst->src1] ^ inst->constant;
-			break;
-		case IROp::Neg:
+			IR_NEXT;
+		IR_CASE(Neg)
 			mips->r[inst->dest] = -(s32)mips->r[inst->src1];
-			break;
-		case IROp::Not:
+			IR_NEXT;
+		IR_CASE(Not)
 			mips->r[inst->dest] = ~mips->r[inst->src1];
-			break;
-		case IROp::Ext8to32:
+			IR_NEXT;
+		IR_CASE(Ext8to32)
 			mips->r[inst->dest] = SignExtend8ToU32(mips->r[inst->src1]);
-			break;
-		case IROp::Ext16to32:
+			IR_NEXT;
+		IR_CASE(Ext16to32)
 			mips->r[inst->dest] = SignExtend16ToU32(mips->r[inst->src1]);
-			break;
-		case IROp::ReverseBits:
+			IR_NEXT;
+		IR_CASE(ReverseBits)
 			mips->r[inst->dest] = ReverseBits32(mips->r[inst->src1]);
-			break;
+			IR_NEXT;
 
-		case IROp::Load8:
+		IR_CASE(Load8)
 			mips->r[inst->dest] = Memory::ReadUnchecked_U8(mips->r[inst->src1] + inst->constant);
-			break;
-		case IROp::Load8Ext:
+			IR_NEXT;
+		IR_CASE(Load8Ext)
 			mips->r[inst->dest] = SignExtend8ToU32(Memory::ReadUnchecked_U8(mips->r[inst->src1] + inst->constant));
-			break;
-		case IROp::Load16:
+			IR_NEXT;
+		IR_CASE(Load16)
 			mips->r[inst->dest] = Memory::ReadUnchecked_U16(mips->r[inst->src1] + inst->constant);
-			break;
-		case IROp::Load16Ext:
+			IR_NEXT;
+		IR_CASE(Load16Ext)
 			mips->r[inst->dest] = SignExtend16ToU32(Memory::ReadUnchecked_U16(mips->r[inst->src1] + inst->constant));
-			break;
-		case IROp::Load32:
+			IR_NEXT;
+		IR_CASE(Load32)
 			mips->r[inst->dest] = Memory::ReadUnchecked_U32(mips->r[inst->src1] + inst->constant);
-			break;
-		case IROp::Load32Left:
+			IR_NEXT;
+		IR_CASE(Load32Left)
 		{
 			u32 addr = mips->r[inst->src1] + inst->constant;
 			u32 shift = (addr & 3) * 8;
 			u32 mem = Memory::ReadUnchecked_U32(addr & 0xfffffffc);
 			u32 destMask = 0x00ffffff >> shift;
 			mips->r[inst->dest] = (mips->r[inst->dest] & destMask) | (mem << (24 - shift));
-			break;
+			IR_NEXT;
 		}
-		case IROp::Load32Right:
+		IR_CASE(Load32Right)
 		{
 			u32 addr = mips->r[inst->src1] + inst->constant;
 			u32 shift = (addr & 3) * 8;
 			u32 mem = Memory::ReadUnchecked_U32(addr & 0xfffffffc);
 			u32 destMask = 0xffffff00 << (24 - shift);
 			mips->r[inst->dest] = (mips->r[inst->dest] & destMask) | (mem >> shift);
-			break;
+			IR_NEXT;
 		}
-		case IROp::LoadFloat:
+		IR_CASE(LoadFloat)
 			mips->f[inst->dest] = Memory::ReadUnchecked_Float(mips->r[inst->src1] + inst->constant);
-			break;
+			IR_NEXT;
 
-		case IROp::Store8:
+		IR_CASE(Store8)
 			Memory::WriteUnchecked_U8(mips->r[inst->src3], mips->r[inst->src1] + inst->constant);
-			break;
-		case IROp::Store16:
+			IR_NEXT;
+		IR_CASE(Store16)
 			Memory::WriteUnchecked_U16(mips->r[inst->src3], mips->r[inst->src1] + inst->constant);
-			break;
-		case IROp::Store32:
+			IR_NEXT;
+		IR_CASE(Store32)
 			Memory::WriteUnchecked_U32(mips->r[inst->src3], mips->r[inst->src1] + inst->constant);
-			break;
-		case IROp::Store32Left:
+			IR_NEXT;
+		IR_CASE(Store32Left)
 		{
 			u32 addr = mips->r[inst->src1] + inst->constant;
 			u32 shift = (addr & 3) * 8;
@@ -196,9 +289,9 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			u32 memMask = 0xffffff00 << shift;
 			u32 result = (mips->r[inst->src3] >> (24 - shift)) | (mem & memMask);
 			Memory::WriteUnchecked_U32(result, addr & 0xfffffffc);
-			break;
+			IR_NEXT;
 		}
-		case IROp::Store32Right:
+		IR_CASE(Store32Right)
 		{
 			u32 addr = mips->r[inst->src1] + inst->constant;
 			u32 shift = (addr & 3) * 8;
@@ -206,13 +299,13 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			u32 memMask = 0x00ffffff >> (24 - shift);
 			u32 result = (mips->r[inst->src3] << shift) | (mem & memMask);
 			Memory::WriteUnchecked_U32(result, addr & 0xfffffffc);
-			break;
+			IR_NEXT;
 		}
-		case IROp::StoreFloat:
+		IR_CASE(StoreFloat)
 			Memory::WriteUnchecked_Float(mips->f[inst->src3], mips->r[inst->src1] + inst->constant);
-			break;
+			IR_NEXT;
 
-		case IROp::LoadVec4:
+		IR_CASE(LoadVec4)
 		{
 			u32 base = mips->r[inst->src1] + inst->constant;
 #if defined(_M_SSE)
@@ -221,9 +314,9 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			for (int i = 0; i < 4; i++)
 				mips->f[inst->dest + i] = Memory::ReadUnchecked_Float(base + 4 * i);
 #endif
-			break;
+			IR_NEXT;
 		}
-		case IROp::StoreVec4:
+		IR_CASE(StoreVec4)
 		{
 			u32 base = mips->r[inst->src1] + inst->constant;
 #if defined(_M_SSE)
@@ -232,29 +325,36 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			for (int i = 0; i < 4; i++)
 				Memory::WriteUnchecked_Float(mips->f[inst->dest + i], base + 4 * i);
 #endif
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec4Init:
+		IR_CASE(Vec4Init)
 		{
 #if defined(_M_SSE)
 			_mm_store_ps(&mips->f[inst->dest], _mm_load_ps(vec4InitValues[inst->src1]));
+#elif PPSSPP_ARCH(ARM64)
+			vst1q_f32(&mips->f[inst->dest], vld1q_f32(vec4InitValues[inst->src1]));
 #else
 			memcpy(&mips->f[inst->dest], vec4InitValues[inst->src1], 4 * sizeof(float));
 #endif
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec4Shuffle:
+		IR_CASE(Vec4Shuffle)
 		{
-			// Can't use the SSE shuffle here because it takes an immediate. pshufb with a table would work though,
-			// or a big switch - there are only 256 shuffles possible (4^4)
+#if defined(_M_SSE) || PPSSPP_ARCH(ARM64)
+			vec4Shuffles[inst->src2](&mips->f[inst->dest], &mips->f[inst->src1]);
+#else
+			// Copy first, dest may overlap src1.
+			float temp[4];
 			for (int i = 0; i < 4; i++)
-				mips->f[inst->dest + i] = mips->f[inst->src1 + ((inst->src2 >> (i * 2)) & 3)];
-			break;
+				temp[i] = mips->f[inst->src1 + ((inst->src2 >> (i * 2)) & 3)];
+			memcpy(&mips->f[inst->dest], temp, sizeof(temp));
+#endif
+			IR_NEXT;
 		}
 
-		case IROp::Vec4Mov:
+		IR_CASE(Vec4Mov)
 		{
 #if defined(_M_SSE)
 			_mm_store_ps(&mips->f[inst->dest], _mm_load_ps(&mips->f[inst->src1]));
@@ -263,10 +363,10 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 #else
 			memcpy(&mips->f[inst->dest], &mips->f[inst->src1], 4 * sizeof(float));
 #endif
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec4Add:
+		IR_CASE(Vec4Add)
 		{
 #if defined(_M_SSE)
 			_mm_store_ps(&mips->f[inst->dest], _mm_add_ps(_mm_load_ps(&mips->f[inst->src1]), _mm_load_ps(&mips->f[inst->src2])));
@@ -276,10 +376,10 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			for (int i = 0; i < 4; i++)
 				mips->f[inst->dest + i] = mips->f[inst->src1 + i] + mips->f[inst->src2 + i];
 #endif
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec4Sub:
+		IR_CASE(Vec4Sub)
 		{
 #if defined(_M_SSE)
 			_mm_store_ps(&mips->f[inst->dest], _mm_sub_ps(_mm_load_ps(&mips->f[inst->src1]), _mm_load_ps(&mips->f[inst->src2])));
@@ -289,10 +389,10 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			for (int i = 0; i < 4; i++)
 				mips->f[inst->dest + i] = mips->f[inst->src1 + i] - mips->f[inst->src2 + i];
 #endif
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec4Mul:
+		IR_CASE(Vec4Mul)
 		{
 #if defined(_M_SSE)
 			_mm_store_ps(&mips->f[inst->dest], _mm_mul_ps(_mm_load_ps(&mips->f[inst->src1]), _mm_load_ps(&mips->f[inst->src2])));
@@ -302,32 +402,36 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			for (int i = 0; i < 4; i++)
 				mips->f[inst->dest + i] = mips->f[inst->src1 + i] * mips->f[inst->src2 + i];
 #endif
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec4Div:
+		IR_CASE(Vec4Div)
 		{
 #if defined(_M_SSE)
 			_mm_store_ps(&mips->f[inst->dest], _mm_div_ps(_mm_load_ps(&mips->f[inst->src1]), _mm_load_ps(&mips->f[inst->src2])));
+#elif PPSSPP_ARCH(ARM64)
+			vst1q_f32(&mips->f[inst->dest], vdivq_f32(vld1q_f32(&mips->f[inst->src1]), vld1q_f32(&mips->f[inst->src2])));
 #else
 			for (int i = 0; i < 4; i++)
 				mips->f[inst->dest + i] = mips->f[inst->src1 + i] / mips->f[inst->src2 + i];
 #endif
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec4Scale:
+		IR_CASE(Vec4Scale)
 		{
 #if defined(_M_SSE)
 			_mm_store_ps(&mips->f[inst->dest], _mm_mul_ps(_mm_load_ps(&mips->f[inst->src1]), _mm_set1_ps(mips->f[inst->src2])));
+#elif PPSSPP_ARCH(ARM64)
+			vst1q_f32(&mips->f[inst->dest], vmulq_n_f32(vld1q_f32(&mips->f[inst->src1]), mips->f[inst->src2]));
 #else
 			for (int i = 0; i < 4; i++)
 				mips->f[inst->dest + i] = mips->f[inst->src1 + i] * mips->f[inst->src2];
 #endif
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec4Neg:
+		IR_CASE(Vec4Neg)
 		{
 #if defined(_M_SSE)
 			_mm_store_ps(&mips->f[inst->dest], _mm_xor_ps(_mm_load_ps(&mips->f[inst->src1]), _mm_load_ps((const float *)signBits)));
@@ -337,10 +441,10 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			for (int i = 0; i < 4; i++)
 				mips->f[inst->dest + i] = -mips->f[inst->src1 + i];
 #endif
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec4Abs:
+		IR_CASE(Vec4Abs)
 		{
 #if defined(_M_SSE)
 			_mm_store_ps(&mips->f[inst->dest], _mm_and_ps(_mm_load_ps(&mips->f[inst->src1]), _mm_load_ps((const float *)noSignMask)));
@@ -350,24 +454,24 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			for (int i = 0; i < 4; i++)
 				mips->f[inst->dest + i] = fabsf(mips->f[inst->src1 + i]);
 #endif
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec2Unpack16To31:
+		IR_CASE(Vec2Unpack16To31)
 		{
 			mips->fi[inst->dest] = (mips->fi[inst->src1] << 16) >> 1;
 			mips->fi[inst->dest + 1] = (mips->fi[inst->src1] & 0xFFFF0000) >> 1;
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec2Unpack16To32:
+		IR_CASE(Vec2Unpack16To32)
 		{
 			mips->fi[inst->dest] = (mips->fi[inst->src1] << 16);
 			mips->fi[inst->dest + 1] = (mips->fi[inst->src1] & 0xFFFF0000);
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec4Unpack8To32:
+		IR_CASE(Vec4Unpack8To32)
 		{
 #if defined(_M_SSE)
 			__m128i src = _mm_cvtsi32_si128(mips->fi[inst->src1]);
@@ -380,25 +484,25 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			mips->fi[inst->dest + 2] = (mips->fi[inst->src1] << 8) & 0xFF000000;
 			mips->fi[inst->dest + 3] = (mips->fi[inst->src1]) & 0xFF000000;
 #endif
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec2Pack32To16:
+		IR_CASE(Vec2Pack32To16)
 		{
 			u32 val = mips->fi[inst->src1] >> 16;
 			mips->fi[inst->dest] = (mips->fi[inst->src1 + 1] & 0xFFFF0000) | val;
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec2Pack31To16:
+		IR_CASE(Vec2Pack31To16)
 		{
 			u32 val = (mips->fi[inst->src1] >> 15) & 0xFFFF;
 			val |= (mips->fi[inst->src1 + 1] << 1) & 0xFFFF0000;
 			mips->fi[inst->dest] = val;
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec4Pack32To8:
+		IR_CASE(Vec4Pack32To8)
 		{
 			// Removed previous SSE code due to the need for unsigned 16-bit pack, which I'm too lazy to work around the lack of in SSE2.
 			// pshufb or SSE4 instructions can be used instead.
@@ -407,10 +511,10 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			val |= (mips->fi[inst->src1 + 2] >> 8) & 0xFF0000;
 			val |= (mips->fi[inst->src1 + 3]) & 0xFF000000;
 			mips->fi[inst->dest] = val;
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec4Pack31To8:
+		IR_CASE(Vec4Pack31To8)
 		{
 			// Removed previous SSE code due to the need for unsigned 16-bit pack, which I'm too lazy to work around the lack of in SSE2.
 			// pshufb or SSE4 instructions can be used instead.
@@ -419,19 +523,19 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			val |= (mips->fi[inst->src1 + 2] >> 7) & 0xFF0000;
 			val |= (mips->fi[inst->src1 + 3] << 1) & 0xFF000000;
 			mips->fi[inst->dest] = val;
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec2ClampToZero:
+		IR_CASE(Vec2ClampToZero)
 		{
 			for (int i = 0; i < 2; i++) {
 				u32 val = mips->fi[inst->src1 + i];
 				mips->fi[inst->dest + i] = (int)val >= 0 ? val : 0;
 			}
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec4ClampToZero:
+		IR_CASE(Vec4ClampToZero)
 		{
 #if defined(_M_SSE)
 			// Trickery: Expand the sign bit, and use andnot to zero negative values.
@@ -445,10 +549,10 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 				mips->fi[inst->dest + i] = (int)val >= 0 ? val : 0;
 			}
 #endif
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Vec4DuplicateUpperBitsAndShift1:  // For vuc2i, the weird one.
+		IR_CASE(Vec4DuplicateUpperBitsAndShift1)  // For vuc2i, the weird one.
 		{
 			for (int i = 0; i < 4; i++) {
 				u32 val = mips->fi[inst->src1 + i];
@@ -457,10 +561,10 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 				val >>= 1;
 				mips->fi[inst->dest + i] = val;
 			}
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::FCmpVfpuBit:
+		IR_CASE(FCmpVfpuBit)
 		{
 			int op = inst->dest & 0xF;
 			int bit = inst->dest >> 4;
@@ -490,61 +594,75 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			} else {
 				mips->vfpuCtrl[VFPU_CTRL_CC] &= ~(1 << bit);
 			}
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::FCmpVfpuAggregate:
+		IR_CASE(FCmpVfpuAggregate)
 		{
 			u32 mask = inst->dest;
 			u32 cc = mips->vfpuCtrl[VFPU_CTRL_CC];
 			int anyBit = (cc & mask) ? 0x10 : 0x00;
 			int allBit = (cc & mask) == mask ? 0x20 : 0x00;
 			mips->vfpuCtrl[VFPU_CTRL_CC] = (cc & ~0x30) | anyBit | allBit;
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::FCmovVfpuCC:
+		IR_CASE(FCmovVfpuCC)
 			if (((mips->vfpuCtrl[VFPU_CTRL_CC] >> (inst->src2 & 0xf)) & 1) == ((u32)inst->src2 >> 7)) {
 				mips->f[inst->dest] = mips->f[inst->src1];
 			}
-			break;
+			IR_NEXT;
 
-		// Not quickly implementable on all platforms, unfortunately.
-		case IROp::Vec4Dot:
+		// The multiplies are SIMD, but we keep the scalar order of the adds so results don't change.
+		IR_CASE(Vec4Dot)
 		{
+#if defined(_M_SSE)
+			__m128 m = _mm_mul_ps(_mm_load_ps(&mips->f[inst->src1]), _mm_load_ps(&mips->f[inst->src2]));
+			__m128 dot = _mm_add_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1)));
+			dot = _mm_add_ss(dot, _mm_movehl_ps(m, m));
+			dot = _mm_add_ss(dot, _mm_shuffle_ps(m, m, _MM_SHUFFLE(3, 3, 3, 3)));
+			_mm_store_ss(&mips->f[inst->dest], dot);
+#elif PPSSPP_ARCH(ARM64)
+			float32x4_t m = vmulq_f32(vld1q_f32(&mips->f[inst->src1]), vld1q_f32(&mips->f[inst->src2]));
+			float dot = vgetq_lane_f32(m, 0) + vgetq_lane_f32(m, 1);
+			dot += vgetq_lane_f32(m, 2);
+			dot += vgetq_lane_f32(m, 3);
+			mips->f[inst->dest] = dot;
+#else
 			float dot = mips->f[inst->src1] * mips->f[inst->src2];
 			for (int i = 1; i < 4; i++)
 				dot += mips->f[inst->src1 + i] * mips->f[inst->src2 + i];
 			mips->f[inst->dest] = dot;
-			break;
+#endif
+			IR_NEXT;
 		}
 
-		case IROp::FSin:
+		IR_CASE(FSin)
 			mips->f[inst->dest] = vfpu_sin(mips->f[inst->src1]);
-			break;
-		case IROp::FCos:
+			IR_NEXT;
+		IR_CASE(FCos)
 			mips->f[inst->dest] = vfpu_cos(mips->f[inst->src1]);
-			break;
-		case IROp::FRSqrt:
+			IR_NEXT;
+		IR_CASE(FRSqrt)
 			mips->f[inst->dest] = 1.0f / sqrtf(mips->f[inst->src1]);
-			break;
-		case IROp::FRecip:
+			IR_NEXT;
+		IR_CASE(FRecip)
 			mips->f[inst->dest] = 1.0f / mips->f[inst->src1];
-			break;
-		case IROp::FAsin:
+			IR_NEXT;
+		IR_CASE(FAsin)
 			mips->f[inst->dest] = vfpu_asin(mips->f[inst->src1]);
-			break;
+			IR_NEXT;
 
-		case IROp::ShlImm:
+		IR_CASE(ShlImm)
 			mips->r[inst->dest] = mips->r[inst->src1] << (int)inst->src2;
-			break;
-		case IROp::ShrImm:
+			IR_NEXT;
+		IR_CASE(ShrImm)
 			mips->r[inst->dest] = mips->r[inst->src1] >> (int)inst->src2;
-			break;
-		case IROp::SarImm:
+			IR_NEXT;
+		IR_CASE(SarImm)
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] >> (int)inst->src2;
-			break;
-		case IROp::RorImm:
+			IR_NEXT;
+		IR_CASE(RorImm)
 		{
 			u32 x = mips->r[inst->src1];
 			int sa = inst->src2;
@@ -552,120 +670,120 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 		}
 		break;
 
-		case IROp::Shl:
+		IR_CASE(Shl)
 			mips->r[inst->dest] = mips->r[inst->src1] << (mips->r[inst->src2] & 31);
-			break;
-		case IROp::Shr:
+			IR_NEXT;
+		IR_CASE(Shr)
 			mips->r[inst->dest] = mips->r[inst->src1] >> (mips->r[inst->src2] & 31);
-			break;
-		case IROp::Sar:
+			IR_NEXT;
+		IR_CASE(Sar)
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] >> (mips->r[inst->src2] & 31);
-			break;
-		case IROp::Ror:
+			IR_NEXT;
+		IR_CASE(Ror)
 		{
 			u32 x = mips->r[inst->src1];
 			int sa = mips->r[inst->src2] & 31;
 			mips->r[inst->dest] = (x >> sa) | (x << (32 - sa));
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Clz:
+		IR_CASE(Clz)
 		{
 			mips->r[inst->dest] = clz32(mips->r[inst->src1]);
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Slt:
+		IR_CASE(Slt)
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] < (s32)mips->r[inst->src2];
-			break;
+			IR_NEXT;
 
-		case IROp::SltU:
+		IR_CASE(SltU)
 			mips->r[inst->dest] = mips->r[inst->src1] < mips->r[inst->src2];
-			break;
+			IR_NEXT;
 
-		case IROp::SltConst:
+		IR_CASE(SltConst)
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] < (s32)inst->constant;
-			break;
+			IR_NEXT;
 
-		case IROp::SltUConst:
+		IR_CASE(SltUConst)
 			mips->r[inst->dest] = mips->r[inst->src1] < inst->constant;
-			break;
+			IR_NEXT;
 
-		case IROp::MovZ:
+		IR_CASE(MovZ)
 			if (mips->r[inst->src1] == 0)
 				mips->r[inst->dest] = mips->r[inst->src2];
-			break;
-		case IROp::MovNZ:
+			IR_NEXT;
+		IR_CASE(MovNZ)
 			if (mips->r[inst->src1] != 0)
 				mips->r[inst->dest] = mips->r[inst->src2];
-			break;
+			IR_NEXT;
 
-		case IROp::Max:
+		IR_CASE(Max)
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] > (s32)mips->r[inst->src2] ? mips->r[inst->src1] : mips->r[inst->src2];
-			break;
-		case IROp::Min:
+			IR_NEXT;
+		IR_CASE(Min)
 			mips->r[inst->dest] = (s32)mips->r[inst->src1] < (s32)mips->r[inst->src2] ? mips->r[inst->src1] : mips->r[inst->src2];
-			break;
+			IR_NEXT;
 
-		case IROp::MtLo:
+		IR_CASE(MtLo)
 			mips->lo = mips->r[inst->src1];
-			break;
-		case IROp::MtHi:
+			IR_NEXT;
+		IR_CASE(MtHi)
 			mips->hi = mips->r[inst->src1];
-			break;
-		case IROp::MfLo:
+			IR_NEXT;
+		IR_CASE(MfLo)
 			mips->r[inst->dest] = mips->lo;
-			break;
-		case IROp::MfHi:
+			IR_NEXT;
+		IR_CASE(MfHi)
 			mips->r[inst->dest] = mips->hi;
-			break;
+			IR_NEXT;
 
-		case IROp::Mult:
+		IR_CASE(Mult)
 		{
 			s64 result = (s64)(s32)mips->r[inst->src1] * (s64)(s32)mips->r[inst->src2];
 			memcpy(&mips->lo, &result, 8);
-			break;
+			IR_NEXT;
 		}
-		case IROp::MultU:
+		IR_CASE(MultU)
 		{
 			u64 result = (u64)mips->r[inst->src1] * (u64)mips->r[inst->src2];
 			memcpy(&mips->lo, &result, 8);
-			break;
+			IR_NEXT;
 		}
-		case IROp::Madd:
+		IR_CASE(Madd)
 		{
 			s64 result;
 			memcpy(&result, &mips->lo, 8);
 			result += (s64)(s32)mips->r[inst->src1] * (s64)(s32)mips->r[inst->src2];
 			memcpy(&mips->lo, &result, 8);
-			break;
+			IR_NEXT;
 		}
-		case IROp::MaddU:
+		IR_CASE(MaddU)
 		{
 			s64 result;
 			memcpy(&result, &mips->lo, 8);
 			result += (u64)mips->r[inst->src1] * (u64)mips->r[inst->src2];
 			memcpy(&mips->lo, &result, 8);
-			break;
+			IR_NEXT;
 		}
-		case IROp::Msub:
+		IR_CASE(Msub)
 		{
 			s64 result;
 			memcpy(&result, &mips->lo, 8);
 			result -= (s64)(s32)mips->r[inst->src1] * (s64)(s32)mips->r[inst->src2];
 			memcpy(&mips->lo, &result, 8);
-			break;
+			IR_NEXT;
 		}
-		case IROp::MsubU:
+		IR_CASE(MsubU)
 		{
 			s64 result;
 			memcpy(&result, &mips->lo, 8);
 			result -= (u64)mips->r[inst->src1] * (u64)mips->r[inst->src2];
 			memcpy(&mips->lo, &result, 8);
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Div:
+		IR_CASE(Div)
 		{
 			s32 numerator = (s32)mips->r[inst->src1];
 			s32 denominator = (s32)mips->r[inst->src2];
@@ -679,9 +797,9 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 				mips->lo = numerator < 0 ? 1 : -1;
 				mips->hi = numerator;
 			}
-			break;
+			IR_NEXT;
 		}
-		case IROp::DivU:
+		IR_CASE(DivU)
 		{
 			u32 numerator = mips->r[inst->src1];
 			u32 denominator = mips->r[inst->src2];
@@ -692,67 +810,67 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 				mips->lo = numerator <= 0xFFFF ? 0xFFFF : -1;
 				mips->hi = numerator;
 			}
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::BSwap16:
+		IR_CASE(BSwap16)
 		{
 			u32 x = mips->r[inst->src1];
 			mips->r[inst->dest] = ((x & 0xFF00FF00) >> 8) | ((x & 0x00FF00FF) << 8);
-			break;
+			IR_NEXT;
 		}
-		case IROp::BSwap32:
+		IR_CASE(BSwap32)
 		{
 			u32 x = mips->r[inst->src1];
 			mips->r[inst->dest] = ((x & 0xFF000000) >> 24) | ((x & 0x00FF0000) >> 8) | ((x & 0x0000FF00) << 8) | ((x & 0x000000FF) << 24);
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::FAdd:
+		IR_CASE(FAdd)
 			mips->f[inst->dest] = mips->f[inst->src1] + mips->f[inst->src2];
-			break;
-		case IROp::FSub:
+			IR_NEXT;
+		IR_CASE(FSub)
 			mips->f[inst->dest] = mips->f[inst->src1] - mips->f[inst->src2];
-			break;
-		case IROp::FMul:
+			IR_NEXT;
+		IR_CASE(FMul)
 			if ((my_isinf(mips->f[inst->src1]) && mips->f[inst->src2] == 0.0f) || (my_isinf(mips->f[inst->src2]) && mips->f[inst->src1] == 0.0f)) {
 				mips->fi[inst->dest] = 0x7fc00000;
 			} else {
 				mips->f[inst->dest] = mips->f[inst->src1] * mips->f[inst->src2];
 			}
-			break;
-		case IROp::FDiv:
+			IR_NEXT;
+		IR_CASE(FDiv)
 			mips->f[inst->dest] = mips->f[inst->src1] / mips->f[inst->src2];
-			break;
-		case IROp::FMin:
+			IR_NEXT;
+		IR_CASE(FMin)
 			mips->f[inst->dest] = std::min(mips->f[inst->src1], mips->f[inst->src2]);
-			break;
-		case IROp::FMax:
+			IR_NEXT;
+		IR_CASE(FMax)
 			mips->f[inst->dest] = std::max(mips->f[inst->src1], mips->f[inst->src2]);
-			break;
+			IR_NEXT;
 
-		case IROp::FMov:
+		IR_CASE(FMov)
 			mips->f[inst->dest] = mips->f[inst->src1];
-			break;
-		case IROp::FAbs:
+			IR_NEXT;
+		IR_CASE(FAbs)
 			mips->f[inst->dest] = fabsf(mips->f[inst->src1]);
-			break;
-		case IROp::FSqrt:
+			IR_NEXT;
+		IR_CASE(FSqrt)
 			mips->f[inst->dest] = sqrtf(mips->f[inst->src1]);
-			break;
-		case IROp::FNeg:
+			IR_NEXT;
+		IR_CASE(FNeg)
 			mips->f[inst->dest] = -mips->f[inst->src1];
-			break;
-		case IROp::FSat0_1:
+			IR_NEXT;
+		IR_CASE(FSat0_1)
 			// We have to do this carefully to handle NAN and -0.0f.
 			mips->f[inst->dest] = vfpu_clamp(mips->f[inst->src1], 0.0f, 1.0f);
-			break;
-		case IROp::FSatMinus1_1:
+			IR_NEXT;
+		IR_CASE(FSatMinus1_1)
 			mips->f[inst->dest] = vfpu_clamp(mips->f[inst->src1], -1.0f, 1.0f);
-			break;
+			IR_NEXT;
 
 		// Bitwise trickery
-		case IROp::FSign:
+		IR_CASE(FSign)
 		{
 			u32 val;
 			memcpy(&val, &mips->f[inst->src1], sizeof(u32));
@@ -762,16 +880,16 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 				mips->f[inst->dest] = 1.0f;
 			else
 				mips->f[inst->dest] = -1.0f;
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::FpCondToReg:
+		IR_CASE(FpCondToReg)
 			mips->r[inst->dest] = mips->fpcond;
-			break;
-		case IROp::VfpuCtrlToReg:
+			IR_NEXT;
+		IR_CASE(VfpuCtrlToReg)
 			mips->r[inst->dest] = mips->vfpuCtrl[inst->src1];
-			break;
-		case IROp::FRound:
+			IR_NEXT;
+		IR_CASE(FRound)
 		{
 			float value = mips->f[inst->src1];
 			if (my_isnanorinf(value)) {
@@ -780,9 +898,9 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			} else {
 				mips->fs[inst->dest] = (int)floorf(value + 0.5f);
 			}
-			break;
+			IR_NEXT;
 		}
-		case IROp::FTrunc:
+		IR_CASE(FTrunc)
 		{
 			float value = mips->f[inst->src1];
 			if (my_isnanorinf(value)) {
@@ -802,7 +920,7 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 				break;
 			}
 		}
-		case IROp::FCeil:
+		IR_CASE(FCeil)
 		{
 			float value = mips->f[inst->src1];
 			if (my_isnanorinf(value)) {
@@ -811,9 +929,9 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			} else {
 				mips->fs[inst->dest] = (int)ceilf(value);
 			}
-			break;
+			IR_NEXT;
 		}
-		case IROp::FFloor:
+		IR_CASE(FFloor)
 		{
 			float value = mips->f[inst->src1];
 			if (my_isnanorinf(value)) {
@@ -822,9 +940,9 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			} else {
 				mips->fs[inst->dest] = (int)floorf(value);
 			}
-			break;
+			IR_NEXT;
 		}
-		case IROp::FCmp:
+		IR_CASE(FCmp)
 			switch (inst->dest) {
 			case IRFpCompareMode::False:
 				mips->fpcond = 0;
@@ -849,12 +967,12 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 				mips->fpcond = mips->f[inst->src1] < mips->f[inst->src2];
 				break;
 			}
-			break;
+			IR_NEXT;
 
-		case IROp::FCvtSW:
+		IR_CASE(FCvtSW)
 			mips->f[inst->dest] = (float)mips->fs[inst->src1];
-			break;
-		case IROp::FCvtWS:
+			IR_NEXT;
+		IR_CASE(FCvtWS)
 		{
 			float src = mips->f[inst->src1];
 			if (my_isnanorinf(src)) {
@@ -870,128 +988,135 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 			break; //cvt.w.s
 		}
 
-		case IROp::ZeroFpCond:
+		IR_CASE(ZeroFpCond)
 			mips->fpcond = 0;
-			break;
+			IR_NEXT;
 
-		case IROp::FMovFromGPR:
+		IR_CASE(FMovFromGPR)
 			memcpy(&mips->f[inst->dest], &mips->r[inst->src1], 4);
-			break;
-		case IROp::FMovToGPR:
+			IR_NEXT;
+		IR_CASE(FMovToGPR)
 			memcpy(&mips->r[inst->dest], &mips->f[inst->src1], 4);
-			break;
+			IR_NEXT;
 
-		case IROp::ExitToConst:
+		IR_CASE(ExitToConst)
 			return inst->constant;
 
-		case IROp::ExitToReg:
+		IR_CASE(ExitToReg)
 			return mips->r[inst->src1];
 
-		case IROp::ExitToConstIfEq:
+		IR_CASE(ExitToConstIfEq)
 			if (mips->r[inst->src1] == mips->r[inst->src2])
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfNeq:
+			IR_NEXT;
+		IR_CASE(ExitToConstIfNeq)
 			if (mips->r[inst->src1] != mips->r[inst->src2])
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfGtZ:
+			IR_NEXT;
+		IR_CASE(ExitToConstIfGtZ)
 			if ((s32)mips->r[inst->src1] > 0)
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfGeZ:
+			IR_NEXT;
+		IR_CASE(ExitToConstIfGeZ)
 			if ((s32)mips->r[inst->src1] >= 0)
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfLtZ:
+			IR_NEXT;
+		IR_CASE(ExitToConstIfLtZ)
 			if ((s32)mips->r[inst->src1] < 0)
 				return inst->constant;
-			break;
-		case IROp::ExitToConstIfLeZ:
+			IR_NEXT;
+		IR_CASE(ExitToConstIfLeZ)
 			if ((s32)mips->r[inst->src1] <= 0)
 				return inst->constant;
-			break;
+			IR_NEXT;
 
-		case IROp::Downcount:
+		IR_CASE(Downcount)
 			mips->downcount -= inst->constant;
-			break;
+			IR_NEXT;
 
-		case IROp::SetPC:
+		IR_CASE(SetPC)
 			mips->pc = mips->r[inst->src1];
-			break;
+			IR_NEXT;
 
-		case IROp::SetPCConst:
+		IR_CASE(SetPCConst)
 			mips->pc = inst->constant;
-			break;
+			IR_NEXT;
 
-		case IROp::Syscall:
+		IR_CASE(Syscall)
 			// IROp::SetPC was (hopefully) executed before.
 		{
 			MIPSOpcode op(inst->constant);
 			CallSyscall(op);
 			if (coreState != CORE_RUNNING)
 				CoreTiming::ForceCheck();
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::ExitToPC:
+		IR_CASE(ExitToPC)
 			return mips->pc;
 
-		case IROp::Interpret:  // SLOW fallback. Can be made faster. Ideally should be removed but may be useful for debugging.
+		IR_CASE(Interpret)  // SLOW fallback. Can be made faster. Ideally should be removed but may be useful for debugging.
 		{
 			MIPSOpcode op(inst->constant);
 			MIPSInterpret(op);
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::CallReplacement:
+		IR_CASE(CallReplacement)
 		{
 			int funcIndex = inst->constant;
 			const ReplacementTableEntry *f = GetReplacementFunc(funcIndex);
 			int cycles = f->replaceFunc();
 			mips->downcount -= cycles;
-			break;
+			IR_NEXT;
 		}
 
-		case IROp::Break:
+		IR_CASE(Break)
 			Core_Break();
 			return mips->pc + 4;
 
-		case IROp::SetCtrlVFPU:
+		IR_CASE(SetCtrlVFPU)
 			mips->vfpuCtrl[inst->dest] = inst->constant;
-			break;
+			IR_NEXT;
 
-		case IROp::SetCtrlVFPUReg:
+		IR_CASE(SetCtrlVFPUReg)
 			mips->vfpuCtrl[inst->dest] = mips->r[inst->src1];
-			break;
+			IR_NEXT;
 
-		case IROp::SetCtrlVFPUFReg:
+		IR_CASE(SetCtrlVFPUFReg)
 			memcpy(&mips->vfpuCtrl[inst->dest], &mips->f[inst->src1], 4);
-			break;
+			IR_NEXT;
 
-		case IROp::Breakpoint:
+		IR_CASE(Breakpoint)
 			if (RunBreakpoint(mips->pc)) {
 				CoreTiming::ForceCheck();
 				return mips->pc;
 			}
-			break;
+			IR_NEXT;
+
+		IR_CASE(BreakpointIf)
+			if (mips->r[inst->src1] != 0 && RunBreakpoint(mips->pc)) {
+				CoreTiming::ForceCheck();
+				return mips->pc;
+			}
+			IR_NEXT;
 
-		case IROp::MemoryCheck:
+		IR_CASE(MemoryCheck)
 			if (RunMemCheck(mips->pc, mips->r[inst->src1] + inst->constant)) {
 				CoreTiming::ForceCheck();
 				return mips->pc;
 			}
-			break;
+			IR_NEXT;
 
-		case IROp::ApplyRoundingMode:
+		IR_CASE(ApplyRoundingMode)
 			// TODO: Implement
-			break;
-		case IROp::RestoreRoundingMode:
+			IR_NEXT;
+		IR_CASE(RestoreRoundingMode)
 			// TODO: Implement
-			break;
-		case IROp::UpdateRoundingMode:
+			IR_NEXT;
+		IR_CASE(UpdateRoundingMode)
 			// TODO: Implement
-			break;
+			IR_NEXT;
 
 		default:
 			// Unimplemented IR op. Bad.
@@ -20,9 +20,13 @@
 #include "ext/xxhash.h"
 #include "Common/Profiler/Profiler.h"
 
+#include "Common/File/FileUtil.h"
 #include "Common/Log.h"
+#include "Common/MemoryUtil.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/StringUtils.h"
+#include "Common/Thread/ThreadManager.h"
+#include "Common/TimeUtil.h"
 
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
@@ -37,7 +41,9 @@
 #include "Core/MIPS/IR/IRPassSimplify.h"
 #include "Core/MIPS/IR/IRInterpreter.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
+#include "Core/MIPS/x86/IRToX86.h"
 #include "Core/Reporting.h"
+#include "Core/System.h"
 
 namespace MIPSComp {
 
@@ -49,7 +55,23 @@ IRJit::IRJit(MIPSState *mipsState) : frontend_(mipsState->HasDefaultPrefix()), m
 	IROptions opts{};
 	opts.disableFlags = g_Config.uJitDisableFlags;
 	opts.unalignedLoadStore = opts.disableFlags & (uint32_t)JitDisable::LSU_UNALIGNED;
+	opts.deferOptimization = g_Config.bIRTieredCompile;
+	jo.continueBranches = g_Config.bIRTraceBlocks;
+	jo.continueJumps = g_Config.bIRTraceBlocks;
+	opts.continueBranches = jo.continueBranches;
+	opts.continueJumps = jo.continueJumps;
+	opts.continueMaxInstructions = jo.continueMaxInstructions;
 	frontend_.SetOptions(opts);
+	irOptions_ = opts;
+	IRResetPassStats();
+	optimizeQueue_ = std::make_shared<OptimizeQueue>();
+#if PPSSPP_ARCH(AMD64)
+	if (g_Config.bIRNativeJit)
+		native_.reset(new IRToX86());
+#endif
+	// With W^X, the worker would have to flip protection on pages that may be running.
+	if (native_ && g_threadManager.IsInitialized() && !PlatformIsWXExclusive())
+		nativeQueue_ = std::make_shared<NativeQueue>();
 }
 
 IRJit::~IRJit() {
@@ -65,6 +87,13 @@ void IRJit::UpdateFCR31() {
 void IRJit::ClearCache() {
 	INFO_LOG(JIT, "IRJit: Clearing the cache!");
 	blocks_.Clear();
+	if (nativeQueue_) {
+		std::lock_guard<std::mutex> guard(nativeQueue_->compileLock);
+		native_->ClearNativeCode();
+	} else if (native_) {
+		native_->ClearNativeCode();
+	}
+	cacheGeneration_++;
 }
 
 void IRJit::InvalidateCacheAt(u32 em_address, int length) {
@@ -74,7 +103,7 @@ void IRJit::InvalidateCacheAt(u32 em_address, int length) {
 void IRJit::Compile(u32 em_address) {
 	PROFILE_THIS_SCOPE("jitc");
 
-	if (g_Config.bPreloadFunctions) {
+	if (g_Config.bPreloadFunctions || g_Config.bIRBlockCache) {
 		// Look to see if we've preloaded this block.
 		int block_num = blocks_.FindPreloadBlock(em_address);
 		if (block_num != -1) {
@@ -121,11 +150,15 @@ bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32
 	IRBlock *b = blocks_.GetBlock(block_num);
 	b->SetInstructions(instructions);
 	b->SetOriginalSize(mipsBytes);
+	b->SetPromotable(frontend_.CanOptimizeLater());
 	if (preload) {
 		// Hash, then only update page stats, don't link yet.
 		b->UpdateHash();
 		blocks_.FinalizeBlock(block_num, true);
 	} else {
+		// The persistent cache needs the hash at compile time, to catch modified code when saving.
+		if (g_Config.bIRBlockCache)
+			b->UpdateHash();
 		// Overwrites the first instruction, and also updates stats.
 		// TODO: Should we always hash?  Then we can reuse blocks.
 		blocks_.FinalizeBlock(block_num);
@@ -154,6 +187,10 @@ void IRJit::CompileFunction(u32 start_address, u32 length) {
 			// Already compiled this address.
 			continue;
 		}
+		if (g_Config.bIRBlockCache && blocks_.FindPreloadBlock(em_address) != -1) {
+			// Loaded from the persistent cache, no need to compile it again.
+			continue;
+		}
 
 		std::vector<IRInst> instructions;
 		u32 mipsBytes;
@@ -207,6 +244,249 @@ void IRJit::CompileFunction(u32 start_address, u32 length) {
 	}
 }
 
+// The persistent block cache stores the optimized IR of every block in a module's text, so the
+// next boot of the same game can skip the frontend and passes entirely.  Files are keyed by a
+// hash of the text (and its load address), and each block is validated by its own hash on load.
+// Bump this whenever IROp, IRInst, the frontend, or the passes change output.
+#define IR_CACHE_MAGIC 0x43425249  // IRBC
+#define IR_CACHE_VERSION 1
+
+struct IRCacheHeader {
+	u32 magic;
+	u32 version;
+	u32 instSize;
+	u32 disableFlags;
+	u32 start;
+	u32 length;
+	u64 moduleHash;
+	u32 numBlocks;
+	u32 reserved;
+};
+
+struct IRCacheBlockHeader {
+	u32 start;
+	u32 mipsBytes;
+	u64 hash;
+	u32 numInstructions;
+	u32 reserved;
+};
+
+static u64 HashModuleText(u32 start, u32 length) {
+	// Like IRBlock::CalculateHash, we hash replacements but not our own emuhacks.
+	std::vector<u32> buffer;
+	buffer.resize(length / 4);
+	for (u32 off = 0; off < length; off += 4) {
+		buffer[off / 4] = Memory::ReadUnchecked_Instruction(start + off, false).encoding;
+	}
+	return XXH3_64bits(buffer.data(), buffer.size() * sizeof(u32));
+}
+
+Path IRJit::ModuleCachePath(const ModuleCacheInfo &info) const {
+	return GetSysDirectory(DIRECTORY_APP_CACHE) / "IR" / StringFromFormat("%016llx_%08x.irblocks", (unsigned long long)info.hash, info.start);
+}
+
+void IRJit::LoadModuleCache(u32 start_address, u32 length) {
+	if (!g_Config.bIRBlockCache || length == 0 || !Memory::IsValidRange(start_address, length))
+		return;
+
+	ModuleCacheInfo info{ start_address, length & ~3, 0 };
+	info.hash = HashModuleText(info.start, info.length);
+	cachedModules_.push_back(info);
+
+	Path filename = ModuleCachePath(info);
+	FILE *f = File::OpenCFile(filename, "rb");
+	if (!f)
+		return;
+
+	double st = time_now_d();
+	IRCacheHeader header{};
+	bool valid = fread(&header, sizeof(header), 1, f) == 1;
+	valid = valid && header.magic == IR_CACHE_MAGIC && header.version == IR_CACHE_VERSION;
+	valid = valid && header.instSize == sizeof(IRInst) && header.disableFlags == g_Config.uJitDisableFlags;
+	valid = valid && header.start == info.start && header.length == info.length && header.moduleHash == info.hash;
+
+	int loaded = 0;
+	std::vector<IRInst> instructions;
+	for (u32 i = 0; valid && i < header.numBlocks; ++i) {
+		IRCacheBlockHeader blockHeader{};
+		if (fread(&blockHeader, sizeof(blockHeader), 1, f) != 1 || blockHeader.numInstructions == 0 || blockHeader.numInstructions > 0xFFFF) {
+			valid = false;
+			break;
+		}
+		instructions.resize(blockHeader.numInstructions);
+		if (fread(&instructions[0], sizeof(IRInst), instructions.size(), f) != instructions.size()) {
+			valid = false;
+			break;
+		}
+
+		// Blocks outside the module or with other code in memory now are simply skipped.
+		if (blockHeader.start < info.start || blockHeader.start + blockHeader.mipsBytes > info.start + info.length)
+			continue;
+		u32 inst = Memory::ReadUnchecked_U32(blockHeader.start);
+		if (MIPS_IS_RUNBLOCK(inst) || blocks_.FindPreloadBlock(blockHeader.start) != -1)
+			continue;
+
+		int block_num = blocks_.AllocateBlock(blockHeader.start);
+		if ((block_num & ~MIPS_EMUHACK_VALUE_MASK) != 0) {
+			// Out of block numbers, the rest will just compile normally (after a clear.)
+			break;
+		}
+		IRBlock *b = blocks_.GetBlock(block_num);
+		b->SetInstructions(instructions);
+		b->SetOriginalSize(blockHeader.mipsBytes);
+		b->UpdateHash();
+		if (b->GetHash() != blockHeader.hash) {
+			b->Destroy(block_num);
+			continue;
+		}
+		// Same as a preload: don't write emuhacks until it's actually run.
+		blocks_.FinalizeBlock(block_num, true);
+		loaded++;
+	}
+	fclose(f);
+
+	if (!valid) {
+		WARN_LOG(JIT, "Incompatible or corrupt IR block cache %s - rebuilding.", filename.c_str());
+		File::Delete(filename);
+	} else {
+		NOTICE_LOG(JIT, "Loaded %d cached IR blocks for %08x in %0.2f milliseconds", loaded, info.start, (time_now_d() - st) * 1000.0);
+	}
+}
+
+void IRJit::SaveModuleCache(const ModuleCacheInfo &info) {
+	std::vector<int> toSave;
+	for (int i = 0; i < blocks_.GetNumBlocks(); ++i) {
+		const IRBlock *b = blocks_.GetBlock(i);
+		u32 start, mipsBytes;
+		b->GetRange(start, mipsBytes);
+		if (start < info.start || start + mipsBytes > info.start + info.length)
+			continue;
+		// Skip blocks that were not hashed or were modified without an icache invalidate.
+		if (b->GetHash() == 0 || !b->HashMatches())
+			continue;
+		// Let's only save fully optimized blocks, or they'd stay unoptimized next time.
+		if (b->IsPromotable())
+			continue;
+		toSave.push_back(i);
+	}
+	if (toSave.empty())
+		return;
+
+	Path filename = ModuleCachePath(info);
+	File::CreateFullPath(filename.NavigateUp());
+	FILE *f = File::OpenCFile(filename, "wb");
+	if (!f)
+		return;
+
+	IRCacheHeader header{};
+	header.magic = IR_CACHE_MAGIC;
+	header.version = IR_CACHE_VERSION;
+	header.instSize = sizeof(IRInst);
+	header.disableFlags = g_Config.uJitDisableFlags;
+	header.start = info.start;
+	header.length = info.length;
+	header.moduleHash = info.hash;
+	header.numBlocks = (u32)toSave.size();
+	bool writeFailed = fwrite(&header, sizeof(header), 1, f) != 1;
+	for (int i : toSave) {
+		const IRBlock *b = blocks_.GetBlock(i);
+		IRCacheBlockHeader blockHeader{};
+		b->GetRange(blockHeader.start, blockHeader.mipsBytes);
+		blockHeader.hash = b->GetHash();
+		blockHeader.numInstructions = b->GetNumInstructions();
+		writeFailed = writeFailed || fwrite(&blockHeader, sizeof(blockHeader), 1, f) != 1;
+		writeFailed = writeFailed || fwrite(b->GetInstructions(), sizeof(IRInst), blockHeader.numInstructions, f) != blockHeader.numInstructions;
+	}
+	fclose(f);
+
+	if (writeFailed) {
+		ERROR_LOG(JIT, "Failed to write IR block cache, disk full?");
+		File::Delete(filename);
+	} else {
+		NOTICE_LOG(JIT, "Saved %d IR blocks for %08x", (int)toSave.size(), info.start);
+	}
+}
+
+void IRJit::SaveModuleCache(u32 start_address, u32 length) {
+	for (auto it = cachedModules_.begin(); it != cachedModules_.end(); ++it) {
+		if (it->start == start_address && it->length == (length & ~3)) {
+			SaveModuleCache(*it);
+			cachedModules_.erase(it);
+			return;
+		}
+	}
+}
+
+void IRJit::SaveAllModuleCaches() {
+	for (const ModuleCacheInfo &info : cachedModules_) {
+		SaveModuleCache(info);
+	}
+	cachedModules_.clear();
+}
+
+// Number of runs before an unoptimized block is queued for optimization in tiered mode.
+static const u32 IR_OPTIMIZE_THRESHOLD = 128;
+
+class IROptimizeTask : public Task {
+public:
+	IROptimizeTask(std::shared_ptr<IRJit::OptimizeQueue> queue, IRJit::OptimizedBlock &&block, const IROptions &opts)
+		: queue_(queue), block_(std::move(block)), opts_(opts) {
+	}
+
+	TaskType Type() const override {
+		return TaskType::CPU_COMPUTE;
+	}
+
+	void Run() override {
+		IRWriter in(block_.instructions);
+		IRWriter out;
+		IRFrontend::OptimizeBlock(in, out, opts_);
+		block_.instructions = out.GetInstructions();
+
+		std::lock_guard<std::mutex> guard(queue_->lock);
+		queue_->done.push_back(std::move(block_));
+		queue_->count++;
+	}
+
+private:
+	std::shared_ptr<IRJit::OptimizeQueue> queue_;
+	IRJit::OptimizedBlock block_;
+	IROptions opts_;
+};
+
+void IRJit::QueueOptimize(int block_num) {
+	IRBlock *b = blocks_.GetBlock(block_num);
+	OptimizedBlock block{ block_num, cacheGeneration_ };
+	block.instructions.assign(b->GetInstructions(), b->GetInstructions() + b->GetNumInstructions());
+
+	IROptimizeTask *task = new IROptimizeTask(optimizeQueue_, std::move(block), irOptions_);
+	if (g_threadManager.IsInitialized()) {
+		g_threadManager.EnqueueTask(task);
+	} else {
+		task->Run();
+		delete task;
+	}
+}
+
+void IRJit::PublishOptimizedBlocks() {
+	std::vector<OptimizedBlock> done;
+	{
+		std::lock_guard<std::mutex> guard(optimizeQueue_->lock);
+		done = std::move(optimizeQueue_->done);
+		optimizeQueue_->done.clear();
+		optimizeQueue_->count = 0;
+	}
+
+	for (const OptimizedBlock &block : done) {
+		IRBlock *b = blocks_.GetBlock(block.number);
+		// The block may have been invalidated or the cache cleared while we were busy.
+		if (block.generation != cacheGeneration_ || !b || !b->IsValid() || !b->IsPromotable())
+			continue;
+		b->SetInstructions(block.instructions);
+		b->SetPromotable(false);
+	}
+}
+
 void IRJit::RunLoopUntil(u64 globalticks) {
 	PROFILE_THIS_SCOPE("jit");
 
@@ -220,20 +500,60 @@ void IRJit::RunLoopUntil(u64 globalticks) {
 		if (coreState != 0) {
 			break;
 		}
+		// Safe point: no block is running, so we can swap in optimized instructions.
+		if (optimizeQueue_->count != 0) {
+			PublishOptimizedBlocks();
+		}
+		if (nativeQueue_ && nativeQueue_->count != 0) {
+			PublishNativeBlocks();
+		}
+		// Block that just ran, to follow or create its exit links.  Anything can happen in Advance().
+		int lastBlock = -1;
 		while (mips_->downcount >= 0) {
-			u32 inst = Memory::ReadUnchecked_U32(mips_->pc);
+			// GetBlock() checks the range, the cache may have been cleared by a syscall.
+			const IRBlock *last = blocks_.GetBlock(lastBlock);
+			int linked = last ? last->FindLink(mips_->pc) : -1;
+			u32 inst = linked != -1 ? (MIPS_EMUHACK_OPCODE | linked) : Memory::ReadUnchecked_U32(mips_->pc);
 			u32 opcode = inst & 0xFF000000;
 			if (opcode == MIPS_EMUHACK_OPCODE) {
 				u32 data = inst & 0xFFFFFF;
+				if (last && linked == -1)
+					blocks_.LinkBlock(lastBlock, mips_->pc, data);
+				lastBlock = data;
 				IRBlock *block = blocks_.GetBlock(data);
-				mips_->pc = IRInterpret(mips_, block->GetInstructions(), block->GetNumInstructions());
+				if (jitBlockProfiling)
+					block->CountExec();
+				if (block->CountRun(IR_OPTIMIZE_THRESHOLD)) {
+					QueueOptimize(data);
+				}
+				const u8 *entry = native_ ? block->GetNativeEntry() : nullptr;
+				if (native_ && !entry) {
+					if (nativeQueue_) {
+						// Keep interpreting until the worker is done.
+						if (!block->IsNativePending())
+							QueueNativeCompile(data);
+					} else if ((entry = CompileNative(block)) == nullptr) {
+						// Out of code space.  Nothing native is running now, so it's safe to start over.
+						ERROR_LOG(JIT, "Ran out of native code space, clearing cache");
+						ClearCache();
+						lastBlock = -1;
+						continue;
+					}
+				}
+				if (entry) {
+					mips_->pc = IRToNativeInterface::RunNative(entry, mips_);
+				} else {
+					mips_->pc = IRInterpret(mips_, block->GetInstructions(), block->GetNumInstructions());
+				}
 				if (!Memory::IsValidAddress(mips_->pc)) {
 					Core_ExecException(mips_->pc, mips_->pc, ExecExceptionType::JUMP);
 					break;
 				}
 			} else {
+				lastBlock = -1;
 				// RestoreRoundingMode(true);
-				Compile(mips_->pc);
+				// Same as Compile(mips_->pc), but keeps the compile time stats.
+				JitAt();
 				// ApplyRoundingMode(true);
 			}
 		}
@@ -242,6 +562,77 @@ void IRJit::RunLoopUntil(u64 globalticks) {
 	// RestoreRoundingMode(true);
 }
 
+const u8 *IRJit::CompileNative(IRBlock *block) {
+	const u8 *entry = native_->ConvertIRToNative(block->GetInstructions(), block->GetNumInstructions());
+	block->SetNativeEntry(entry);
+	return entry;
+}
+
+class IRNativeCompileTask : public Task {
+public:
+	IRNativeCompileTask(std::shared_ptr<IRJit::NativeQueue> queue, std::shared_ptr<IRToNativeInterface> native, IRJit::NativeBlock &&block)
+		: queue_(queue), native_(native), block_(std::move(block)) {
+	}
+
+	TaskType Type() const override {
+		return TaskType::CPU_COMPUTE;
+	}
+
+	void Run() override {
+		{
+			std::lock_guard<std::mutex> guard(queue_->compileLock);
+			block_.entry = native_->ConvertIRToNative(block_.instructions.data(), (int)block_.instructions.size());
+		}
+		block_.instructions.clear();
+
+		std::lock_guard<std::mutex> guard(queue_->lock);
+		queue_->done.push_back(std::move(block_));
+		queue_->count++;
+	}
+
+private:
+	std::shared_ptr<IRJit::NativeQueue> queue_;
+	std::shared_ptr<IRToNativeInterface> native_;
+	IRJit::NativeBlock block_;
+};
+
+void IRJit::QueueNativeCompile(int block_num) {
+	IRBlock *b = blocks_.GetBlock(block_num);
+	NativeBlock block{ block_num, cacheGeneration_, b->GetVersion() };
+	block.instructions.assign(b->GetInstructions(), b->GetInstructions() + b->GetNumInstructions());
+	block.entry = nullptr;
+	b->SetNativePending();
+
+	g_threadManager.EnqueueTask(new IRNativeCompileTask(nativeQueue_, native_, std::move(block)));
+}
+
+void IRJit::PublishNativeBlocks() {
+	std::vector<NativeBlock> done;
+	{
+		std::lock_guard<std::mutex> guard(nativeQueue_->lock);
+		done = std::move(nativeQueue_->done);
+		nativeQueue_->done.clear();
+		nativeQueue_->count = 0;
+	}
+
+	for (const NativeBlock &block : done) {
+		IRBlock *b = blocks_.GetBlock(block.number);
+		// Skip blocks that were cleared, invalidated, or changed by an optimization since.
+		if (block.generation != cacheGeneration_ || !b || !b->IsValid() || b->GetVersion() != block.version)
+			continue;
+		if (!block.entry) {
+			ERROR_LOG(JIT, "Ran out of native code space, clearing cache");
+			ClearCache();
+			return;
+		}
+		b->SetNativeEntry(block.entry);
+	}
+}
+
+bool IRJit::CodeInRange(const u8 *ptr) const {
+	return native_ && native_->CodeInRange(ptr);
+}
+
 bool IRJit::DescribeCodePtr(const u8 *ptr, std::string &name) {
 	// Used in target disassembly viewer.
 	return false;
@@ -261,11 +652,14 @@ bool IRJit::ReplaceJalTo(u32 dest) {
 }
 
 void IRBlockCache::Clear() {
+	if (!blocks_.empty())
+		Reporting::NotePerfEvent(Reporting::PerfEvent::JIT_CACHE_CLEAR);
 	for (int i = 0; i < (int)blocks_.size(); ++i) {
 		blocks_[i].Destroy(i);
 	}
 	blocks_.clear();
 	byPage_.clear();
+	linkedFrom_.clear();
 }
 
 void IRBlockCache::InvalidateICache(u32 address, u32 length) {
@@ -282,6 +676,7 @@ void IRBlockCache::InvalidateICache(u32 address, u32 length) {
 			if (blocks_[i].OverlapsRange(address, length)) {
 				// Not removing from the page, hopefully doesn't build up with small recompiles.
 				blocks_[i].Destroy(i);
+				UnlinkBlock(i);
 			}
 		}
 	}
@@ -290,6 +685,7 @@ void IRBlockCache::InvalidateICache(u32 address, u32 length) {
 void IRBlockCache::FinalizeBlock(int i, bool preload) {
 	if (!preload) {
 		blocks_[i].Finalize(i);
+		Reporting::NotePerfEvent(Reporting::PerfEvent::JIT_BLOCK_COMPILED);
 	}
 
 	u32 startAddr, size;
@@ -303,6 +699,31 @@ void IRBlockCache::FinalizeBlock(int i, bool preload) {
 	}
 }
 
+void IRBlockCache::LinkBlock(int src, u32 pc, int dest) {
+	IRBlock *b = GetBlock(src);
+	IRBlock *target = GetBlock(dest);
+	if (!b || !target || !b->IsValid() || !target->IsValid())
+		return;
+	int old = b->AddLink(pc, dest);
+	if (old != -1) {
+		auto range = linkedFrom_.equal_range(old);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (it->second == src) {
+				linkedFrom_.erase(it);
+				break;
+			}
+		}
+	}
+	linkedFrom_.emplace(dest, src);
+}
+
+void IRBlockCache::UnlinkBlock(int dest) {
+	auto range = linkedFrom_.equal_range(dest);
+	for (auto it = range.first; it != range.second; ++it)
+		blocks_[it->second].UnlinkExitsTo(dest);
+	linkedFrom_.erase(dest);
+}
+
 u32 IRBlockCache::AddressToPage(u32 addr) const {
 	// Use relatively small pages since basic blocks are typically small.
 	return (addr & 0x3FFFFFFF) >> 10;
@@ -366,6 +787,7 @@ JitBlockDebugInfo IRBlockCache::GetBlockDebugInfo(int blockNum) const {
 	uint32_t start, size;
 	ir.GetRange(start, size);
 	debugInfo.originalAddress = start;  // TODO
+	debugInfo.codeSize = ir.GetNumInstructions() * (uint32_t)sizeof(IRInst);
 
 	for (u32 addr = start; addr < start + size; addr += 4) {
 		char temp[256];
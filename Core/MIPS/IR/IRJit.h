@@ -17,11 +17,15 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #include "Common/Common.h"
 #include "Common/CPUDetect.h"
+#include "Common/File/Path.h"
 #include "Core/MIPS/JitCommon/JitBlockCache.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/IR/IRRegCache.h"
@@ -35,6 +39,8 @@
 
 namespace MIPSComp {
 
+class IRToNativeInterface;
+
 // TODO : Use arena allocators. For now let's just malloc.
 class IRBlock {
 public:
@@ -47,6 +53,14 @@ class IRBlock {
 		origSize_ = b.origSize_;
 		origFirstOpcode_ = b.origFirstOpcode_;
 		hash_ = b.hash_;
+		runCount_ = b.runCount_;
+		execCount_ = b.execCount_;
+		promotable_ = b.promotable_;
+		nativeEntry_ = b.nativeEntry_;
+		nativePending_ = b.nativePending_;
+		version_ = b.version_;
+		memcpy(links_, b.links_, sizeof(links_));
+		nextLink_ = b.nextLink_;
 		b.instr_ = nullptr;
 	}
 
@@ -55,11 +69,16 @@ class IRBlock {
 	}
 
 	void SetInstructions(const std::vector<IRInst> &inst) {
+		delete[] instr_;
 		instr_ = new IRInst[inst.size()];
 		numInstructions_ = (u16)inst.size();
 		if (!inst.empty()) {
 			memcpy(instr_, &inst[0], sizeof(IRInst) * inst.size());
 		}
+		// Any native code is for the old instructions.
+		nativeEntry_ = nullptr;
+		nativePending_ = false;
+		version_++;
 	}
 
 	const IRInst *GetInstructions() const { return instr_; }
@@ -77,13 +96,81 @@ class IRBlock {
 	bool HashMatches() const {
 		return origAddr_ && hash_ == CalculateHash();
 	}
+	u64 GetHash() const {
+		return hash_;
+	}
 	bool OverlapsRange(u32 addr, u32 size) const;
 
+	// Tiered compile: blocks start unoptimized, and get optimized once they've run enough.
+	void SetPromotable(bool p) {
+		promotable_ = p;
+	}
+	bool IsPromotable() const {
+		return promotable_;
+	}
+	// Returns true exactly once, when a promotable block becomes hot.
+	bool CountRun(u32 threshold) {
+		return promotable_ && ++runCount_ == threshold;
+	}
+
+	// Block profiling, see MIPSComp::jitBlockProfiling.
+	void CountExec() {
+		execCount_++;
+	}
+	u64 GetExecCount() const {
+		return execCount_;
+	}
+
+	const u8 *GetNativeEntry() const {
+		return nativeEntry_;
+	}
+	void SetNativeEntry(const u8 *entry) {
+		nativeEntry_ = entry;
+		nativePending_ = false;
+	}
+	// Set while native code is being compiled on a worker, we interpret until it's ready.
+	bool IsNativePending() const {
+		return nativePending_;
+	}
+	void SetNativePending() {
+		nativePending_ = true;
+	}
+	// Changes whenever the instructions do.
+	u32 GetVersion() const {
+		return version_;
+	}
+
 	void GetRange(u32 &start, u32 &size) const {
 		start = origAddr_;
 		size = origSize_;
 	}
 
+	// Exits linked to the block at that PC, see IRBlockCache::LinkBlock().  -1 if not linked.
+	int FindLink(u32 pc) const {
+		for (const ExitLink &link : links_) {
+			if (link.pc == pc)
+				return link.block;
+		}
+		return -1;
+	}
+	// Returns the block the replaced link pointed to, or -1.
+	int AddLink(u32 pc, int block) {
+		ExitLink &link = links_[nextLink_];
+		nextLink_ = (nextLink_ + 1) % MAX_LINKS;
+		int old = link.block;
+		link.pc = pc;
+		link.block = block;
+		return old;
+	}
+	void UnlinkExitsTo(int block) {
+		for (ExitLink &link : links_) {
+			if (link.block == block) {
+				link.pc = 0;
+				link.block = -1;
+			}
+		}
+	}
+
 	void Finalize(int number);
 	void Destroy(int number);
 
@@ -95,7 +182,22 @@ class IRBlock {
 	u32 origAddr_;
 	u32 origSize_;
 	u64 hash_ = 0;
+	u32 runCount_ = 0;
+	u64 execCount_ = 0;
+	bool promotable_ = false;
+	const u8 *nativeEntry_ = nullptr;
+	bool nativePending_ = false;
+	u32 version_ = 0;
 	MIPSOpcode origFirstOpcode_ = MIPSOpcode(0x68FFFFFF);
+
+	// Enough for both sides of a conditional branch.
+	static const int MAX_LINKS = 2;
+	struct ExitLink {
+		u32 pc;
+		int block;
+	};
+	ExitLink links_[MAX_LINKS]{ { 0, -1 }, { 0, -1 } };
+	u8 nextLink_ = 0;
 };
 
 class IRBlockCache : public JitBlockCacheDebugInterface {
@@ -119,18 +221,28 @@ class IRBlockCache : public JitBlockCacheDebugInterface {
 
 	int FindPreloadBlock(u32 em_address);
 
+	// Lets the dispatcher go from block src straight to block dest when src exits to pc,
+	// without looking at the emuhack in memory.  Undone when dest is invalidated.
+	void LinkBlock(int src, u32 pc, int dest);
+
 	std::vector<u32> SaveAndClearEmuHackOps();
 	void RestoreSavedEmuHackOps(std::vector<u32> saved);
 
 	JitBlockDebugInfo GetBlockDebugInfo(int blockNum) const override;
 	void ComputeStats(BlockCacheStats &bcStats) const override;
 	int GetBlockNumberFromStartAddress(u32 em_address, bool realBlocksOnly = true) const override;
+	u64 GetBlockExecCount(int blockNum) const override {
+		return blocks_[blockNum].GetExecCount();
+	}
 
 private:
 	u32 AddressToPage(u32 addr) const;
+	void UnlinkBlock(int dest);
 
 	std::vector<IRBlock> blocks_;
 	std::unordered_map<u32, std::vector<int>> byPage_;
+	// Target block number -> blocks with an exit linked to it.
+	std::unordered_multimap<int, int> linkedFrom_;
 };
 
 class IRJit : public JitInterface {
@@ -146,6 +258,9 @@ class IRJit : public JitInterface {
 
 	void Compile(u32 em_address) override;	// Compiles a block at current MIPS PC
 	void CompileFunction(u32 start_address, u32 length) override;
+	void LoadModuleCache(u32 start_address, u32 length) override;
+	void SaveModuleCache(u32 start_address, u32 length) override;
+	void SaveAllModuleCaches() override;
 
 	bool DescribeCodePtr(const u8 *ptr, std::string &name) override;
 	// Not using a regular block cache.
@@ -160,9 +275,7 @@ class IRJit : public JitInterface {
 	void InvalidateCacheAt(u32 em_address, int length = 4) override;
 	void UpdateFCR31() override;
 
-	bool CodeInRange(const u8 *ptr) const override {
-		return false;
-	}
+	bool CodeInRange(const u8 *ptr) const override;
 
 	const u8 *GetDispatcher() const override { return nullptr; }
 	const u8 *GetCrashHandler() const override { return nullptr; }
@@ -174,10 +287,64 @@ class IRJit : public JitInterface {
 	bool CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload);
 	bool ReplaceJalTo(u32 dest);
 
+	struct ModuleCacheInfo {
+		u32 start;
+		u32 length;
+		u64 hash;
+	};
+	Path ModuleCachePath(const ModuleCacheInfo &info) const;
+	void SaveModuleCache(const ModuleCacheInfo &info);
+
+	friend class IROptimizeTask;
+	friend class IRNativeCompileTask;
+
+	// Hot blocks are optimized on a worker thread, then published between blocks on the emu thread.
+	struct OptimizedBlock {
+		int number;
+		u32 generation;
+		std::vector<IRInst> instructions;
+	};
+	struct OptimizeQueue {
+		std::mutex lock;
+		std::vector<OptimizedBlock> done;
+		std::atomic<int> count{};
+	};
+	void QueueOptimize(int block_num);
+	void PublishOptimizedBlocks();
+	const u8 *CompileNative(IRBlock *block);
+
+	// Same idea for native code: compiled on a worker, and used once published at a safe point.
+	struct NativeBlock {
+		int number;
+		u32 generation;
+		u32 version;
+		std::vector<IRInst> instructions;
+		const u8 *entry;
+	};
+	struct NativeQueue {
+		std::mutex lock;
+		std::vector<NativeBlock> done;
+		std::atomic<int> count{};
+		// Held while using the native backend, since the worker and ClearCache() share it.
+		std::mutex compileLock;
+	};
+	void QueueNativeCompile(int block_num);
+	void PublishNativeBlocks();
+
 	JitOptions jo;
+	IROptions irOptions_{};
 
 	IRFrontend frontend_;
 	IRBlockCache blocks_;
+	// Modules that have been registered with the persistent block cache.
+	std::vector<ModuleCacheInfo> cachedModules_;
+	std::shared_ptr<OptimizeQueue> optimizeQueue_;
+	// Optional backend turning IR blocks into host code, nullptr to only interpret.
+	std::shared_ptr<IRToNativeInterface> native_;
+	// Only used when native code can be compiled off thread.
+	std::shared_ptr<NativeQueue> nativeQueue_;
+	// Incremented on clear, to throw away optimizations of blocks that are gone.
+	u32 cacheGeneration_ = 0;
 
 	MIPSState *mips_;
 
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <cstring>
+#include <mutex>
 #include <utility>
 
 #include "Common/BitSet.h"
@@ -79,9 +80,63 @@ IROp ShiftToShiftImm(IROp op) {
 	}
 }
 
+struct IRPassName {
+	IRPassFunc func;
+	const char *name;
+};
+
+static const IRPassName passNames[] = {
+	{ &RemoveLoadStoreLeftRight, "RemoveLoadStoreLeftRight" },
+	{ &PropagateConstants, "PropagateConstants" },
+	{ &PurgeTemps, "PurgeTemps" },
+	{ &ReduceLoads, "ReduceLoads" },
+	{ &ThreeOpToTwoOp, "ThreeOpToTwoOp" },
+	{ &OptimizeFPMoves, "OptimizeFPMoves" },
+	{ &ReorderLoadStore, "ReorderLoadStore" },
+	{ &MergeLoadStore, "MergeLoadStore" },
+	{ &EliminateCommonSubexpressions, "EliminateCommonSubexpressions" },
+	{ &EliminateDeadStores, "EliminateDeadStores" },
+};
+
+// Passes may also run on the tiered compile worker, so this is locked.
+static std::mutex passStatsLock;
+static std::vector<IRPassStats> passStats;
+
+static void RecordPassStats(IRPassFunc pass, const IRWriter &in, const IRWriter &out) {
+	const char *name = "Unknown";
+	for (const IRPassName &entry : passNames) {
+		if (entry.func == pass)
+			name = entry.name;
+	}
+
+	std::lock_guard<std::mutex> guard(passStatsLock);
+	auto it = std::find_if(passStats.begin(), passStats.end(), [&](const IRPassStats &stat) {
+		return stat.name == name;
+	});
+	if (it == passStats.end()) {
+		passStats.push_back(IRPassStats{ name });
+		it = passStats.end() - 1;
+	}
+	it->runs++;
+	it->instructionsIn += in.GetInstructions().size();
+	it->instructionsOut += out.GetInstructions().size();
+}
+
+std::vector<IRPassStats> IRGetPassStats() {
+	std::lock_guard<std::mutex> guard(passStatsLock);
+	return passStats;
+}
+
+void IRResetPassStats() {
+	std::lock_guard<std::mutex> guard(passStatsLock);
+	passStats.clear();
+}
+
 bool IRApplyPasses(const IRPassFunc *passes, size_t c, const IRWriter &in, IRWriter &out, const IROptions &opts) {
 	if (c == 1) {
-		return passes[0](in, out, opts);
+		bool logBlocks = passes[0](in, out, opts);
+		RecordPassStats(passes[0], in, out);
+		return logBlocks;
 	}
 
 	bool logBlocks = false;
@@ -93,6 +148,7 @@ bool IRApplyPasses(const IRPassFunc *passes, size_t c, const IRWriter &in, IRWri
 		if (passes[i](*nextIn, *nextOut, opts)) {
 			logBlocks = true;
 		}
+		RecordPassStats(passes[i], *nextIn, *nextOut);
 
 		temp[0] = std::move(temp[1]);
 		nextIn = &temp[0];
@@ -101,6 +157,7 @@ bool IRApplyPasses(const IRPassFunc *passes, size_t c, const IRWriter &in, IRWri
 	if (passes[c - 1](*nextIn, out, opts)) {
 		logBlocks = true;
 	}
+	RecordPassStats(passes[c - 1], *nextIn, out);
 
 	return logBlocks;
 }
@@ -724,6 +781,7 @@ bool PropagateConstants(const IRWriter &in, IRWriter &out, const IROptions &opts
 		case IROp::ExitToConstIfLeZ:
 		case IROp::ExitToConstIfLtZ:
 		case IROp::Breakpoint:
+		case IROp::BreakpointIf:
 		case IROp::MemoryCheck:
 		default:
 		{
@@ -1385,3 +1443,168 @@ bool MergeLoadStore(const IRWriter &in, IRWriter &out, const IROptions &opts) {
 	}
 	return logBlocks;
 }
+
+// Ops that only compute their GPR dest from their explicit operands, with no other effects.
+static bool IsPureGPROp(IROp op) {
+	switch (op) {
+	case IROp::SetConst:
+	case IROp::Mov:
+	case IROp::Add:
+	case IROp::Sub:
+	case IROp::And:
+	case IROp::Or:
+	case IROp::Xor:
+	case IROp::AddConst:
+	case IROp::SubConst:
+	case IROp::AndConst:
+	case IROp::OrConst:
+	case IROp::XorConst:
+	case IROp::Neg:
+	case IROp::Not:
+	case IROp::Ext8to32:
+	case IROp::Ext16to32:
+	case IROp::ReverseBits:
+	case IROp::BSwap16:
+	case IROp::BSwap32:
+	case IROp::Clz:
+	case IROp::Shl:
+	case IROp::Shr:
+	case IROp::Sar:
+	case IROp::Ror:
+	case IROp::ShlImm:
+	case IROp::ShrImm:
+	case IROp::SarImm:
+	case IROp::RorImm:
+	case IROp::Slt:
+	case IROp::SltU:
+	case IROp::SltConst:
+	case IROp::SltUConst:
+	case IROp::Max:
+	case IROp::Min:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Registers above the temps (lo/hi, vfpu ctrl, etc.) may be implicitly read or written by other ops.
+static bool IsTrackedGPR(int reg) {
+	return reg > 0 && reg <= IRTEMP_LR_SHIFT;
+}
+
+bool EliminateCommonSubexpressions(const IRWriter &in, IRWriter &out, const IROptions &opts) {
+	CONDITIONAL_DISABLE;
+
+	struct Available {
+		IRInst expr;
+		int reg;
+	};
+	// These are usually short lived, a small list is plenty.
+	static const size_t MAX_AVAILABLE = 16;
+	std::vector<Available> available;
+
+	for (const IRInst &orig : in.GetInstructions()) {
+		IRInst inst = orig;
+		const IRMeta *m = GetIRMeta(inst.op);
+		bool exitsOnly = inst.op >= IROp::ExitToConstIfEq && inst.op <= IROp::ExitToConstIfLeZ;
+		if (inst.op == IROp::Interpret || inst.op == IROp::CallReplacement || ((m->flags & IRFLAG_EXIT) != 0 && !exitsOnly)) {
+			// Anything might have changed.
+			available.clear();
+			out.Write(inst);
+			continue;
+		}
+
+		int dest = IRDestGPR(inst);
+		auto trackedSrc = [](int reg) {
+			return reg == 0 || IsTrackedGPR(reg);
+		};
+		bool candidate = IsPureGPROp(inst.op) && inst.op != IROp::SetConst && inst.op != IROp::Mov && IsTrackedGPR(dest);
+		if (m->types[1] == 'G' && !trackedSrc(inst.src1))
+			candidate = false;
+		if (m->types[2] == 'G' && !trackedSrc(inst.src2))
+			candidate = false;
+
+		if (candidate) {
+			auto it = std::find_if(available.begin(), available.end(), [&](const Available &a) {
+				return a.expr.op == inst.op && a.expr.src1 == inst.src1 && a.expr.src2 == inst.src2 && a.expr.constant == inst.constant;
+			});
+			if (it != available.end()) {
+				if (it->reg == dest) {
+					// Already holds this exact value.
+					continue;
+				}
+				inst.op = IROp::Mov;
+				inst.src1 = it->reg;
+				inst.src2 = 0;
+				inst.constant = 0;
+			}
+		}
+
+		if (dest >= 0) {
+			available.erase(std::remove_if(available.begin(), available.end(), [&](const Available &a) {
+				return a.reg == dest || IRReadsFromGPR(a.expr, dest);
+			}), available.end());
+		}
+
+		// Only if the value still holds, i.e. it didn't overwrite its own source.
+		if (candidate && inst.op == orig.op && !IRReadsFromGPR(inst, dest)) {
+			if (available.size() >= MAX_AVAILABLE)
+				available.erase(available.begin());
+			available.push_back(Available{ inst, dest });
+		}
+
+		out.Write(inst);
+	}
+
+	return false;
+}
+
+bool EliminateDeadStores(const IRWriter &in, IRWriter &out, const IROptions &opts) {
+	CONDITIONAL_DISABLE;
+
+	const std::vector<IRInst> &insts = in.GetInstructions();
+	std::vector<bool> keep(insts.size(), true);
+
+	// Working backwards from the block end, where only the temps are dead.
+	bool live[IRTEMP_LR_SHIFT + 1];
+	for (int r = 0; r <= IRTEMP_LR_SHIFT; r++)
+		live[r] = r < IRTEMP_0;
+
+	for (int i = (int)insts.size() - 1; i >= 0; i--) {
+		const IRInst &inst = insts[i];
+		const IRMeta *m = GetIRMeta(inst.op);
+
+		int dest = IRDestGPR(inst);
+		if (IsTrackedGPR(dest)) {
+			if (!live[dest] && IsPureGPROp(inst.op)) {
+				// Overwritten or dropped before anything reads it.
+				keep[i] = false;
+				continue;
+			}
+			if (!IRMutatesDestGPR(inst, dest))
+				live[dest] = false;
+		}
+
+		if (inst.op == IROp::Interpret || inst.op == IROp::CallReplacement) {
+			for (int r = 0; r <= IRTEMP_LR_SHIFT; r++)
+				live[r] = true;
+		} else if ((m->flags & IRFLAG_EXIT) != 0) {
+			for (int r = 0; r < IRTEMP_0; r++)
+				live[r] = true;
+		}
+
+		if (m->types[1] == 'G' && inst.src1 <= IRTEMP_LR_SHIFT)
+			live[inst.src1] = true;
+		if (m->types[2] == 'G' && inst.src2 <= IRTEMP_LR_SHIFT)
+			live[inst.src2] = true;
+		if ((m->flags & (IRFLAG_SRC3 | IRFLAG_SRC3DST)) != 0 && m->types[0] == 'G' && inst.src3 <= IRTEMP_LR_SHIFT)
+			live[inst.src3] = true;
+	}
+
+	for (size_t i = 0; i < insts.size(); i++) {
+		if (keep[i])
+			out.Write(insts[i]);
+	}
+
+	return false;
+}
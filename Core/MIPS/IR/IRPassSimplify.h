@@ -1,10 +1,23 @@
 #pragma once
 
+#include <vector>
+
 #include "Core/MIPS/IR/IRInst.h"
 
 typedef bool (*IRPassFunc)(const IRWriter &in, IRWriter &out, const IROptions &opts);
 bool IRApplyPasses(const IRPassFunc *passes, size_t c, const IRWriter &in, IRWriter &out, const IROptions &opts);
 
+struct IRPassStats {
+	const char *name;
+	u64 runs;
+	u64 instructionsIn;
+	u64 instructionsOut;
+};
+
+// Totals for every pass run through IRApplyPasses, for the JIT stats.
+std::vector<IRPassStats> IRGetPassStats();
+void IRResetPassStats();
+
 // Block optimizer passes of varying usefulness.
 bool RemoveLoadStoreLeftRight(const IRWriter &in, IRWriter &out, const IROptions &opts);
 bool PropagateConstants(const IRWriter &in, IRWriter &out, const IROptions &opts);
@@ -14,3 +27,5 @@ bool ThreeOpToTwoOp(const IRWriter &in, IRWriter &out, const IROptions &opts);
 bool OptimizeFPMoves(const IRWriter &in, IRWriter &out, const IROptions &opts);
 bool ReorderLoadStore(const IRWriter &in, IRWriter &out, const IROptions &opts);
 bool MergeLoadStore(const IRWriter &in, IRWriter &out, const IROptions &opts);
+bool EliminateCommonSubexpressions(const IRWriter &in, IRWriter &out, const IROptions &opts);
+bool EliminateDeadStores(const IRWriter &in, IRWriter &out, const IROptions &opts);
@@ -21,6 +21,7 @@
 
 #include "ext/xxhash.h"
 #include "Common.h"
+#include "Common/Profiler/MemoryUsage.h"
 #include "Common/Profiler/Profiler.h"
 
 #ifdef _WIN32
@@ -71,7 +72,7 @@ static uint64_t HashJitBlock(const JitBlock &b) {
 }
 
 JitBlockCache::JitBlockCache(MIPSState *mipsState, CodeBlockCommon *codeBlock) :
-	codeBlock_(codeBlock), blocks_(nullptr), num_blocks_(0) {
+	mips_(mipsState), codeBlock_(codeBlock), blocks_(nullptr), num_blocks_(0) {
 }
 
 JitBlockCache::~JitBlockCache() {
@@ -85,7 +86,7 @@ bool JitBlock::ContainsAddress(u32 em_address) {
 }
 
 bool JitBlockCache::IsFull() const {
-	return num_blocks_ >= MAX_NUM_BLOCKS - 1;
+	return num_blocks_ >= MAX_NUM_BLOCKS - 1 && freeBlocks_.empty();
 }
 
 void JitBlockCache::Init() {
@@ -93,6 +94,7 @@ void JitBlockCache::Init() {
 	agent = op_open_agent();
 #endif
 	blocks_ = new JitBlock[MAX_NUM_BLOCKS];
+	execCounts_ = new u64[MAX_NUM_BLOCKS];
 	Clear();
 }
 
@@ -100,6 +102,8 @@ void JitBlockCache::Shutdown() {
 	Clear(); // Make sure proxy block links are deleted
 	delete [] blocks_;
 	blocks_ = 0;
+	delete [] execCounts_;
+	execCounts_ = nullptr;
 	num_blocks_ = 0;
 #if defined USE_OPROFILE && USE_OPROFILE
 	op_close_agent(agent);
@@ -113,12 +117,18 @@ void JitBlockCache::Shutdown() {
 // This clears the JIT cache. It's called from JitCache.cpp when the JIT cache
 // is full and when saving and loading states.
 void JitBlockCache::Clear() {
-	block_map_.clear();
+	if (num_blocks_ != 0)
+		Reporting::NotePerfEvent(Reporting::PerfEvent::JIT_CACHE_CLEAR);
+	blocksByPage_.clear();
 	proxyBlockMap_.clear();
 	for (int i = 0; i < num_blocks_; i++)
 		DestroyBlock(i, DestroyType::CLEAR);
 	links_to_.clear();
 	num_blocks_ = 0;
+	freeBlocks_.clear();
+	blocksByEntry_.clear();
+	mips_->ClearReturnStack();
+	MemoryUsage_Set(MemoryCategory::JIT_CODE, 0);
 
 	blockMemRanges_[JITBLOCK_RANGE_SCRATCH] = std::make_pair(0xFFFFFFFF, 0x00000000);
 	blockMemRanges_[JITBLOCK_RANGE_RAMBOTTOM] = std::make_pair(0xFFFFFFFF, 0x00000000);
@@ -138,8 +148,18 @@ const JitBlock *JitBlockCache::GetBlock(int no) const {
 	return &blocks_[no];
 }
 
+int JitBlockCache::NextBlockNumber() {
+	if (!freeBlocks_.empty()) {
+		int block_num = freeBlocks_.back();
+		freeBlocks_.pop_back();
+		return block_num;
+	}
+	return num_blocks_++;
+}
+
 int JitBlockCache::AllocateBlock(u32 startAddress) {
-	JitBlock &b = blocks_[num_blocks_];
+	const int block_num = NextBlockNumber();
+	JitBlock &b = blocks_[block_num];
 
 	b.proxyFor = 0;
 	// If there's an existing pure proxy block at the address, we need to ditch it and create a new one,
@@ -164,9 +184,9 @@ int JitBlockCache::AllocateBlock(u32 startAddress) {
 		b.exitPtrs[i] = 0;
 		b.linkStatus[i] = false;
 	}
-	b.blockNum = num_blocks_;
-	num_blocks_++; //commit the current block
-	return num_blocks_ - 1;
+	b.blockNum = block_num;
+	execCounts_[block_num] = 0;
+	return block_num;
 }
 
 void JitBlockCache::ProxyBlock(u32 rootAddress, u32 startAddress, u32 size, const u8 *codePtr) {
@@ -181,7 +201,8 @@ void JitBlockCache::ProxyBlock(u32 rootAddress, u32 startAddress, u32 size, cons
 		blocks_[num].proxyFor->push_back(rootAddress);
 	}
 
-	JitBlock &b = blocks_[num_blocks_];
+	const int block_num = NextBlockNumber();
+	JitBlock &b = blocks_[block_num];
 	b.invalid = false;
 	b.originalAddress = startAddress;
 	b.originalSize = size;
@@ -191,25 +212,27 @@ void JitBlockCache::ProxyBlock(u32 rootAddress, u32 startAddress, u32 size, cons
 		b.linkStatus[i] = false;
 	}
 	b.exitAddress[0] = rootAddress;
-	b.blockNum = num_blocks_;
+	b.blockNum = block_num;
+	execCounts_[block_num] = 0;
 	b.proxyFor = new std::vector<u32>();
 	b.SetPureProxy();  // flag as pure proxy block.
 
 	// Make binary searches and stuff work ok
 	b.normalEntry = codePtr;
 	b.checkedEntry = codePtr;
-	proxyBlockMap_.insert(std::make_pair(startAddress, num_blocks_));
-	AddBlockMap(num_blocks_);
-
-	num_blocks_++; //commit the current block
+	proxyBlockMap_.insert(std::make_pair(startAddress, block_num));
+	AddBlockMap(block_num);
 }
 
 void JitBlockCache::AddBlockMap(int block_num) {
 	const JitBlock &b = blocks_[block_num];
 	// Convert the logical address to a physical address for the block map
 	// Yeah, this'll work fine for PSP too I think.
-	u32 pAddr = b.originalAddress & 0x1FFFFFFF;
-	block_map_[std::make_pair(pAddr + 4 * b.originalSize, pAddr)] = block_num;
+	const u32 pAddr = b.originalAddress & 0x1FFFFFFF;
+	const u32 pLast = pAddr + (b.originalSize == 0 ? 0 : 4 * b.originalSize - 4);
+	for (u32 page = pAddr >> BLOCK_PAGE_SHIFT; page <= (pLast >> BLOCK_PAGE_SHIFT); ++page) {
+		blocksByPage_[page].push_back(block_num);
+	}
 }
 
 void JitBlockCache::RemoveBlockMap(int block_num) {
@@ -219,17 +242,31 @@ void JitBlockCache::RemoveBlockMap(int block_num) {
 	}
 
 	const u32 pAddr = b.originalAddress & 0x1FFFFFFF;
-	auto it = block_map_.find(std::make_pair(pAddr + 4 * b.originalSize, pAddr));
-	if (it != block_map_.end() && it->second == (u32)block_num) {
-		block_map_.erase(it);
-	} else {
-		// It wasn't in there, or it has the wrong key.  Let's search...
-		for (auto it = block_map_.begin(); it != block_map_.end(); ++it) {
-			if (it->second == (u32)block_num) {
-				block_map_.erase(it);
-				break;
-			}
+	const u32 pLast = pAddr + (b.originalSize == 0 ? 0 : 4 * b.originalSize - 4);
+	for (u32 page = pAddr >> BLOCK_PAGE_SHIFT; page <= (pLast >> BLOCK_PAGE_SHIFT); ++page) {
+		auto it = blocksByPage_.find(page);
+		if (it == blocksByPage_.end())
+			continue;
+
+		std::vector<int> &blocksInPage = it->second;
+		auto found = std::find(blocksInPage.begin(), blocksInPage.end(), block_num);
+		if (found != blocksInPage.end()) {
+			// Order doesn't matter, so just swap with the last.
+			*found = blocksInPage.back();
+			blocksInPage.pop_back();
 		}
+		if (blocksInPage.empty())
+			blocksByPage_.erase(it);
+	}
+}
+
+void JitBlockCache::GetBlocksInPages(u32 pAddr, u32 pEnd, std::vector<int> &block_numbers) const {
+	// Even an empty range touches the page it's in.
+	const u32 pLast = pEnd > pAddr ? pEnd - 1 : pAddr;
+	for (u32 page = pAddr >> BLOCK_PAGE_SHIFT; page <= (pLast >> BLOCK_PAGE_SHIFT); ++page) {
+		auto it = blocksByPage_.find(page);
+		if (it != blocksByPage_.end())
+			block_numbers.insert(block_numbers.end(), it->second.begin(), it->second.end());
 	}
 }
 
@@ -240,13 +277,18 @@ static void ExpandRange(std::pair<u32, u32> &range, u32 newStart, u32 newEnd) {
 
 void JitBlockCache::FinalizeBlock(int block_num, bool block_link) {
 	JitBlock &b = blocks_[block_num];
+	Reporting::NotePerfEvent(Reporting::PerfEvent::JIT_BLOCK_COMPILED);
 
 	b.originalFirstOpcode = Memory::Read_Opcode_JIT(b.originalAddress);
 	MIPSOpcode opcode = GetEmuHackOpForBlock(block_num);
 	Memory::Write_Opcode_JIT(b.originalAddress, opcode);
 
+	blocksByEntry_[(u32)codeBlock_->GetOffset(b.normalEntry)] = block_num;
+
 	// Note that this hashes the emuhack too, which is intentional.
 	b.compiledHash = HashJitBlock(b);
+	// Subtracted again by EvictCodeRange, or reset when clearing the whole cache.
+	MemoryUsage_Add(MemoryCategory::JIT_CODE, (b.normalEntry - b.checkedEntry) + b.codeSize);
 
 	AddBlockMap(block_num);
 
@@ -304,39 +346,20 @@ bool JitBlockCache::RangeMayHaveEmuHacks(u32 start, u32 end) const {
 	return false;
 }
 
-static int binary_search(JitBlock blocks_[], const u8 *baseoff, int imin, int imax) {
-	while (imin < imax) {
-		int imid = (imin + imax) / 2;
-		if (blocks_[imid].normalEntry < baseoff)
-			imin = imid + 1;
-		else
-			imax = imid;
-	}
-	if ((imax == imin) && (blocks_[imin].normalEntry == baseoff))
-		return imin;
-	else
-		return -1;
-}
-
 int JitBlockCache::GetBlockNumberFromEmuHackOp(MIPSOpcode inst, bool ignoreBad) const {
 	if (!num_blocks_ || !MIPS_IS_EMUHACK(inst)) // definitely not a JIT block
 		return -1;
-	int off = (inst & MIPS_EMUHACK_VALUE_MASK);
+	u32 off = (inst & MIPS_EMUHACK_VALUE_MASK);
 
-	const u8 *baseoff = codeBlock_->GetBasePtr() + off;
-	if (baseoff < codeBlock_->GetBasePtr() || baseoff >= codeBlock_->GetCodePtr()) {
-		if (!ignoreBad) {
+	// Only valid blocks are in the map.
+	auto found = blocksByEntry_.find(off);
+	if (found == blocksByEntry_.end()) {
+		if (!ignoreBad && !codeBlock_->IsInSpace(codeBlock_->GetBasePtr() + off)) {
 			ERROR_LOG(JIT, "JitBlockCache: Invalid Emuhack Op %08x", inst.encoding);
 		}
 		return -1;
 	}
-
-	int bl = binary_search(blocks_, baseoff, 0, num_blocks_ - 1);
-	if (bl >= 0 && blocks_[bl].invalid) {
-		return -1;
-	} else {
-		return bl;
-	}
+	return found->second;
 }
 
 MIPSOpcode JitBlockCache::GetEmuHackOpForBlock(int blockNum) const {
@@ -370,9 +393,14 @@ int JitBlockCache::GetBlockNumberFromStartAddress(u32 addr, bool realBlocksOnly)
 }
 
 void JitBlockCache::GetBlockNumbersFromAddress(u32 em_address, std::vector<int> *block_numbers) {
-	for (int i = 0; i < num_blocks_; i++)
+	std::vector<int> candidates;
+	const u32 pAddr = em_address & 0x1FFFFFFF;
+	GetBlocksInPages(pAddr, pAddr + 4, candidates);
+	std::sort(candidates.begin(), candidates.end());
+	for (int i : candidates) {
 		if (blocks_[i].ContainsAddress(em_address))
 			block_numbers->push_back(i);
+	}
 }
 
 u32 JitBlockCache::GetAddressFromBlockPtr(const u8 *ptr) const {
@@ -537,9 +565,15 @@ void JitBlockCache::DestroyBlock(int block_num, DestroyType type) {
 	}
 
 	b->invalid = true;
+	// The return stack may point into this block, or at code that's about to be reused.
+	if (type != DestroyType::CLEAR)
+		mips_->ClearReturnStack();
 	if (!b->IsPureProxy()) {
 		if (Memory::ReadUnchecked_U32(b->originalAddress) == GetEmuHackOpForBlock(block_num).encoding)
 			Memory::Write_Opcode_JIT(b->originalAddress, b->originalFirstOpcode);
+		auto entry = blocksByEntry_.find((u32)codeBlock_->GetOffset(b->normalEntry));
+		if (entry != blocksByEntry_.end() && entry->second == block_num)
+			blocksByEntry_.erase(entry);
 	}
 
 	// It's not safe to set normalEntry to 0 here, since we use a binary search
@@ -563,6 +597,71 @@ void JitBlockCache::DestroyBlock(int block_num, DestroyType type) {
 	}
 }
 
+void JitBlockCache::EvictCodeRange(const u8 *start, const u8 *end) {
+	auto inRange = [=](const u8 *ptr) {
+		return ptr >= start && ptr < end;
+	};
+
+	int64_t evictedSize = 0;
+	for (int block_num = 0; block_num < num_blocks_; ++block_num) {
+		const JitBlock &b = blocks_[block_num];
+		// checkedEntry isn't always set, but normalEntry is.
+		if (b.invalid || !inRange(b.normalEntry))
+			continue;
+		if (!b.IsPureProxy())
+			evictedSize += (b.normalEntry - b.checkedEntry) + b.codeSize;
+		DestroyBlock(block_num, DestroyType::DESTROY);
+	}
+
+	// Destroying only marks the incoming links as unlinked, their jumps still go to the old entries
+	// (and so do jumps to blocks destroyed earlier.) That code is about to be overwritten.
+	for (int block_num = 0; block_num < num_blocks_; ++block_num) {
+		JitBlock &b = blocks_[block_num];
+		if (b.invalid || b.IsPureProxy())
+			continue;
+		for (int e = 0; e < MAX_JIT_BLOCK_EXITS; ++e) {
+			if (b.exitAddress[e] == INVALID_EXIT || !b.exitPtrs[e])
+				continue;
+			const u8 *target = MIPSComp::jit->GetLinkedExitTarget(b.exitPtrs[e]);
+			if (target && inRange(target)) {
+				MIPSComp::jit->UnlinkExit(b.exitPtrs[e], b.exitAddress[e]);
+				b.linkStatus[e] = false;
+			}
+		}
+	}
+
+	// Now nothing refers to the blocks in the range (including ones invalidated before), so reuse their numbers.
+	for (int block_num = 0; block_num < num_blocks_; ++block_num) {
+		JitBlock &b = blocks_[block_num];
+		if (!b.invalid || !b.normalEntry || !inRange(b.normalEntry))
+			continue;
+
+		for (int e = 0; e < MAX_JIT_BLOCK_EXITS; ++e) {
+			if (b.exitAddress[e] == INVALID_EXIT)
+				continue;
+			auto range = links_to_.equal_range(b.exitAddress[e]);
+			for (auto it = range.first; it != range.second; ++it) {
+				if (it->second == block_num) {
+					links_to_.erase(it);
+					break;
+				}
+			}
+			b.exitAddress[e] = INVALID_EXIT;
+			b.exitPtrs[e] = nullptr;
+		}
+		delete b.proxyFor;
+		b.proxyFor = nullptr;
+		b.checkedEntry = nullptr;
+		b.normalEntry = nullptr;
+		b.codeSize = 0;
+		b.originalSize = 0;
+		execCounts_[block_num] = 0;
+		freeBlocks_.push_back(block_num);
+	}
+
+	MemoryUsage_Add(MemoryCategory::JIT_CODE, -evictedSize);
+}
+
 void JitBlockCache::InvalidateICache(u32 address, const u32 length) {
 	// Convert the logical address to a physical address for the block map
 	const u32 pAddr = address & 0x1FFFFFFF;
@@ -578,25 +677,26 @@ void JitBlockCache::InvalidateICache(u32 address, const u32 length) {
 		return;
 	}
 
-	// Blocks may start and end in overlapping ways, and destroying one invalidates iterators.
-	// So after destroying one, we start over.
-	do {
-	restart:
-		auto next = block_map_.lower_bound(std::make_pair(pAddr, 0));
-		auto last = block_map_.upper_bound(std::make_pair(pEnd + MAX_BLOCK_INSTRUCTIONS, 0));
-		// Note that if next is end(), last will be end() too (equal.)
-		for (; next != last; ++next) {
-			const u32 blockStart = next->first.second;
-			const u32 blockEnd = next->first.first;
-			if (blockStart < pEnd && blockEnd > pAddr) {
-				DestroyBlock(next->second, DestroyType::INVALIDATE);
-				// Our iterator is now invalid.  Break and search again.
-				// Most of the time there shouldn't be a bunch of matching blocks.
-				goto restart;
-			}
+	// Only blocks in the touched pages are candidates, so the cost depends on the range size.
+	// Destroying a block changes the page lists, so work from a copy.
+	std::vector<int> candidates;
+	GetBlocksInPages(pAddr, pEnd, candidates);
+	if (candidates.empty())
+		return;
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+	for (int block_num : candidates) {
+		const JitBlock &b = blocks_[block_num];
+		// Might've been destroyed already, i.e. as a proxy of a previous block.
+		if (b.invalid)
+			continue;
+		const u32 blockStart = b.originalAddress & 0x1FFFFFFF;
+		const u32 blockEnd = blockStart + 4 * b.originalSize;
+		if (blockStart < pEnd && blockEnd > pAddr) {
+			DestroyBlock(block_num, DestroyType::INVALIDATE);
 		}
-		// We got here - it wasn't in the map at all (or anymore.)
-	} while (false);
+	}
 }
 
 void JitBlockCache::InvalidateChangedBlocks() {
@@ -668,6 +768,7 @@ JitBlockDebugInfo JitBlockCache::GetBlockDebugInfo(int blockNum) const {
 	JitBlockDebugInfo debugInfo{};
 	const JitBlock *block = GetBlock(blockNum);
 	debugInfo.originalAddress = block->originalAddress;
+	debugInfo.codeSize = block->codeSize;
 	for (u32 addr = block->originalAddress; addr <= block->originalAddress + block->originalSize * 4; addr += 4) {
 		char temp[256];
 		MIPSDisAsm(Memory::Read_Instruction(addr), addr, temp, true);
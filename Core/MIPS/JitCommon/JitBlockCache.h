@@ -35,6 +35,8 @@ const int MAX_JIT_BLOCK_EXITS = 2;
 const int MAX_JIT_BLOCK_EXITS = 8;
 #endif
 constexpr bool JIT_USE_COMPILEDHASH = true;
+// Jits that support it fill their code space in this many segments, evicting the oldest when full.
+const int JIT_CODE_SEGMENTS = 4;
 
 struct BlockCacheStats {
 	int numBlocks;
@@ -99,6 +101,7 @@ typedef void (*CompiledCode)();
 
 struct JitBlockDebugInfo {
 	uint32_t originalAddress;
+	uint32_t codeSize;  // Bytes of generated code (or IR.)
 	std::vector<std::string> origDisasm;
 	std::vector<std::string> irDisasm;  // if any
 	std::vector<std::string> targetDisasm;
@@ -110,6 +113,8 @@ class JitBlockCacheDebugInterface {
 	virtual int GetBlockNumberFromStartAddress(u32 em_address, bool realBlocksOnly = true) const = 0;
 	virtual JitBlockDebugInfo GetBlockDebugInfo(int blockNum) const = 0;
 	virtual void ComputeStats(BlockCacheStats &bcStats) const = 0;
+	// Only counted while MIPSComp::jitBlockProfiling is on.
+	virtual u64 GetBlockExecCount(int blockNum) const { return 0; }
 
 	virtual ~JitBlockCacheDebugInterface() {}
 };
@@ -141,8 +146,8 @@ class JitBlockCache : public JitBlockCacheDebugInterface {
 
 	// slower, but can get numbers from within blocks, not just the first instruction.
 	// WARNING! WILL NOT WORK WITH JIT INLINING ENABLED (not yet a feature but will be soon)
-	// Returns a list of block numbers - only one block can start at a particular address, but they CAN overlap.
-	// This one is slow so should only be used for one-shots from the debugger UI, not for anything during runtime.
+	// Returns a list of valid block numbers - only one block can start at a particular address, but they CAN overlap.
+	// This one is slower so should only be used for one-shots from the debugger UI, not for anything during runtime.
 	void GetBlockNumbersFromAddress(u32 em_address, std::vector<int> *block_numbers);
 	int GetBlockNumberFromEmuHackOp(MIPSOpcode inst, bool ignoreBad = false) const;
 
@@ -156,6 +161,9 @@ class JitBlockCache : public JitBlockCacheDebugInterface {
 	void InvalidateICache(u32 address, const u32 length);
 	void InvalidateChangedBlocks();
 	void DestroyBlock(int block_num, DestroyType type);
+	// Destroys every block with code in [start, end) and frees their numbers, so the jit can reuse
+	// that part of the code space. Exits of other blocks that jump into it go back to the dispatcher.
+	void EvictCodeRange(const u8 *start, const u8 *end);
 
 	// No jit operations may be run between these calls.
 	// Meant to be used to make memory safe for savestates, memcpy, etc.
@@ -164,6 +172,14 @@ class JitBlockCache : public JitBlockCacheDebugInterface {
 
 	int GetNumBlocks() const override { return num_blocks_; }
 
+	// For block profiling, generated code increments this on entry.
+	u64 *GetExecCounter(const JitBlock *b) {
+		return &execCounts_[b - blocks_];
+	}
+	u64 GetBlockExecCount(int blockNum) const override {
+		return execCounts_[blockNum];
+	}
+
 	static int GetBlockExitSize();
 
 	JitBlockDebugInfo GetBlockDebugInfo(int blockNum) const override;
@@ -179,16 +195,31 @@ class JitBlockCache : public JitBlockCacheDebugInterface {
 
 	void AddBlockMap(int block_num);
 	void RemoveBlockMap(int block_num);
+	// Collects (possibly duplicate) block numbers from all pages overlapping the physical range.
+	void GetBlocksInPages(u32 pAddr, u32 pEnd, std::vector<int> &block_numbers) const;
 
 	MIPSOpcode GetEmuHackOpForBlock(int block_num) const;
+	// Reuses a block number freed by EvictCodeRange, if any.
+	int NextBlockNumber();
 
+	MIPSState *mips_;
 	CodeBlockCommon *codeBlock_;
 	JitBlock *blocks_;
+	u64 *execCounts_ = nullptr;
 	std::unordered_multimap<u32, int> proxyBlockMap_;
 
 	int num_blocks_;
+	// Numbers below num_blocks_ that are free again.
+	std::vector<int> freeBlocks_;
+	// Code offset of normalEntry -> real block, to find blocks from emuhack ops. Blocks aren't in
+	// code order once code space is reused.
+	std::unordered_map<u32, int> blocksByEntry_;
 	std::unordered_multimap<u32, int> links_to_;
-	std::map<std::pair<u32,u32>, u32> block_map_; // (end_addr, start_addr) -> number
+	// Physical page -> numbers of blocks overlapping it, so invalidation only looks at nearby blocks.
+	std::unordered_map<u32, std::vector<int>> blocksByPage_;
+	enum {
+		BLOCK_PAGE_SHIFT = 12,
+	};
 
 	enum {
 		JITBLOCK_RANGE_SCRATCH = 0,
@@ -16,8 +16,11 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include "ppsspp_config.h"
+#include <algorithm>
 #include <cstdlib>
+#include <functional>
 #include <mutex>
+#include <unordered_map>
 
 #include "ext/disarm.h"
 #include "ext/udis86/udis86.h"
@@ -25,13 +28,17 @@
 #include "Common/StringUtils.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
+#include "Common/TimeUtil.h"
 
 #include "Core/Util/DisArm64.h"
 #include "Core/Config.h"
+#include "Core/Core.h"
+#include "Core/System.h"
 
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/JitCommon/JitState.h"
 #include "Core/MIPS/IR/IRJit.h"
+#include "Core/MIPS/MIPSTables.h"
 
 #if PPSSPP_ARCH(ARM)
 #include "../ARM/ArmJit.h"
@@ -49,8 +56,94 @@ namespace MIPSComp {
 	JitInterface *jit;
 	std::recursive_mutex jitLock;
 
+	JitCompileStats jitCompileStats;
+	bool jitBlockProfiling = false;
+	// By name from the tables.  Jit code points at the counts, so only cleared along with the jit cache.
+	static std::unordered_map<const char *, u64> vfpuFallbackCounts;
+
 	void JitAt() {
-		jit->Compile(currentMIPS->pc);
+		if (coreCollectDebugStats) {
+			double start = time_now_d();
+			jit->Compile(currentMIPS->pc);
+			jitCompileStats.seconds += time_now_d() - start;
+			jitCompileStats.blocks++;
+		} else {
+			jit->Compile(currentMIPS->pc);
+		}
+	}
+
+	void SetJitBlockProfiling(bool enable) {
+		if (!jit) {
+			jitBlockProfiling = enable;
+			return;
+		}
+
+		// The counters are compiled into the blocks, so we need to stop and recompile.
+		bool resume = false;
+		if (!Core_IsStepping()) {
+			Core_EnableStepping(true, "jit.profile", 0);
+			Core_WaitInactive(200);
+			resume = true;
+		}
+
+		{
+			std::lock_guard<std::recursive_mutex> guard(jitLock);
+			jitBlockProfiling = enable;
+			if (jit)
+				jit->ClearCache();
+			vfpuFallbackCounts.clear();
+		}
+
+		if (resume)
+			Core_EnableStepping(false);
+	}
+
+	std::vector<JitBlockProfileEntry> GetJitBlockProfile(int maxBlocks) {
+		std::vector<JitBlockProfileEntry> entries;
+		std::lock_guard<std::recursive_mutex> guard(jitLock);
+		if (!jit)
+			return entries;
+
+		JitBlockCacheDebugInterface *blocks = jit->GetBlockCacheDebugInterface();
+		int numBlocks = blocks->GetNumBlocks();
+		std::vector<std::pair<u64, int>> counts;
+		for (int i = 0; i < numBlocks; ++i) {
+			u64 count = blocks->GetBlockExecCount(i);
+			if (count != 0)
+				counts.push_back(std::make_pair(count, i));
+		}
+
+		size_t n = std::min(counts.size(), (size_t)std::max(maxBlocks, 0));
+		std::partial_sort(counts.begin(), counts.begin() + n, counts.end(), std::greater<std::pair<u64, int>>());
+		for (size_t i = 0; i < n; ++i) {
+			JitBlockDebugInfo info = blocks->GetBlockDebugInfo(counts[i].second);
+			JitBlockProfileEntry entry;
+			entry.blockNum = counts[i].second;
+			entry.address = info.originalAddress;
+			entry.count = counts[i].first;
+			entry.codeSize = info.codeSize;
+			entry.disasm = std::move(info.origDisasm);
+			entries.push_back(std::move(entry));
+		}
+		return entries;
+	}
+
+	u64 *GetVFPUFallbackCounter(MIPSOpcode op) {
+		std::lock_guard<std::recursive_mutex> guard(jitLock);
+		return &vfpuFallbackCounts[MIPSGetName(op)];
+	}
+
+	std::vector<std::pair<std::string, u64>> GetVFPUFallbackProfile() {
+		std::vector<std::pair<std::string, u64>> entries;
+		std::lock_guard<std::recursive_mutex> guard(jitLock);
+		for (const auto &it : vfpuFallbackCounts) {
+			if (it.second != 0)
+				entries.push_back(std::make_pair(std::string(it.first), it.second));
+		}
+		std::sort(entries.begin(), entries.end(), [](const std::pair<std::string, u64> &a, const std::pair<std::string, u64> &b) {
+			return a.second > b.second;
+		});
+		return entries;
 	}
 
 	void DoDummyJitState(PointerWrap &p) {
@@ -44,6 +44,35 @@ class MIPSState;
 namespace MIPSComp {
 	void JitAt();
 
+	// Host time spent compiling blocks. Only counted while debug stats are collected.
+	struct JitCompileStats {
+		int blocks;
+		double seconds;
+	};
+	extern JitCompileStats jitCompileStats;
+
+	// Makes every block count how often it's entered.  This costs a bit on each block, so it's off by default.
+	// Supported by the x86 and ARM64 jits and the IR interpreter.
+	extern bool jitBlockProfiling;
+	// Recompiles everything, which also resets the counts.
+	void SetJitBlockProfiling(bool enable);
+
+	struct JitBlockProfileEntry {
+		int blockNum;
+		u32 address;
+		u64 count;
+		u32 codeSize;
+		std::vector<std::string> disasm;
+	};
+	// The most executed blocks, most first.
+	std::vector<JitBlockProfileEntry> GetJitBlockProfile(int maxBlocks);
+
+	// Counter for VFPU ops run through the interpreter from jit code, to find what's left to implement.
+	// Jits increment these while jitBlockProfiling is on (only ARM64 for now.)
+	u64 *GetVFPUFallbackCounter(MIPSOpcode op);
+	// Op names and fallback counts, most first.
+	std::vector<std::pair<std::string, u64>> GetVFPUFallbackProfile();
+
 	class MIPSFrontendInterface {
 	public:
 		virtual ~MIPSFrontendInterface() {}
@@ -136,6 +165,10 @@ namespace MIPSComp {
 		virtual void RunLoopUntil(u64 globalticks) = 0;
 		virtual void Compile(u32 em_address) = 0;
 		virtual void CompileFunction(u32 start_address, u32 length) { }
+		// Persistent on-disk code cache for a module's text range.  Optional, most jits ignore these.
+		virtual void LoadModuleCache(u32 start_address, u32 length) { }
+		virtual void SaveModuleCache(u32 start_address, u32 length) { }
+		virtual void SaveAllModuleCaches() { }
 		virtual void ClearCache() = 0;
 		virtual void UpdateFCR31() = 0;
 		virtual MIPSOpcode GetOriginalOp(MIPSOpcode op) = 0;
@@ -149,6 +182,11 @@ namespace MIPSComp {
 		// like that.
 		virtual void LinkBlock(u8 *exitPoint, const u8 *entryPoint) = 0;
 		virtual void UnlinkBlock(u8 *checkedEntry, u32 originalAddress) = 0;
+		// Only needed by jits that reuse code space with JitBlockCache::EvictCodeRange.
+		// Returns where a block exit jumps to, or nullptr if it goes through the dispatcher.
+		virtual const u8 *GetLinkedExitTarget(const u8 *exitPoint) { return nullptr; }
+		// Rewrites a linked block exit to go through the dispatcher again.
+		virtual void UnlinkExit(u8 *exitPoint, u32 destination) {}
 	};
 
 	typedef void (MIPSFrontendInterface::*MIPSCompileFunc)(MIPSOpcode opcode);
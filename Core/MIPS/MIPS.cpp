@@ -170,6 +170,7 @@ void MIPSState::Shutdown() {
 		MIPSComp::jit = nullptr;
 		delete oldjit;
 	}
+	MIPSInterpret_ClearCache();
 }
 
 void MIPSState::Reset() {
@@ -345,14 +346,25 @@ int MIPSState::RunLoopUntil(u64 globalTicks) {
 }
 
 void MIPSState::InvalidateICache(u32 address, int length) {
-	// Only really applies to jit.
 	std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
 	if (MIPSComp::jit)
 		MIPSComp::jit->InvalidateCacheAt(address, length);
+	else
+		MIPSInterpret_InvalidateCache(address, length);
 }
 
 void MIPSState::ClearJitCache() {
 	std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
 	if (MIPSComp::jit)
 		MIPSComp::jit->ClearCache();
+	MIPSInterpret_ClearCache();
+}
+
+void MIPSState::ClearReturnStack() {
+	// A jr to a cleared entry's address just ends up in the dispatcher, like it would anyway.
+	for (ReturnStackEntry &entry : returnStack) {
+		entry.address = 0;
+		entry.code = returnStackFallback;
+	}
+	returnStackTop = 0;
 }
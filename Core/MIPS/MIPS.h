@@ -246,6 +246,20 @@ class MIPSState
 
 	float sincostemp[2];
 
+	// Shadow return stack for the JITs. jal pushes the return address with the host code compiled
+	// for it, so jr ra can jump straight there on a match instead of going through the dispatcher.
+	// The JitBlockCache clears it whenever a block is destroyed, so the code pointers stay valid.
+	struct ReturnStackEntry {
+		u32 address;
+		u32 padding;
+		const u8 *code;
+	};
+	enum { RETURN_STACK_SIZE = 16 };
+	ReturnStackEntry returnStack[RETURN_STACK_SIZE]{};
+	u32 returnStackTop = 0;
+	// Cleared entries point here, the JIT sets it to its dispatcher.
+	const u8 *returnStackFallback = nullptr;
+
 	static const u32 FCR0_VALUE = 0x00003351;
 
 #if PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
@@ -268,6 +282,7 @@ class MIPSState
 	void InvalidateICache(u32 address, int length = 4);
 
 	void ClearJitCache();
+	void ClearReturnStack();
 };
 
 
@@ -16,6 +16,8 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include "ppsspp_config.h"
+#include <algorithm>
+#include <climits>
 #include <map>
 #include <set>
 #include <unordered_map>
@@ -27,6 +29,8 @@
 
 #include "Common/File/FileUtil.h"
 #include "Common/Log.h"
+#include "Common/StringUtils.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/MemMap.h"
@@ -36,6 +40,7 @@
 #include "Core/MIPS/MIPSTables.h"
 #include "Core/MIPS/MIPSAnalyst.h"
 #include "Core/MIPS/MIPSCodeUtils.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/Debugger/SymbolMap.h"
 #include "Core/Debugger/DebugInterface.h"
 #include "Core/HLE/ReplaceTables.h"
@@ -879,40 +884,44 @@ namespace MIPSAnalyst {
 		return DetermineRegisterUsage(reg, addr, instrs) == USAGE_CLOBBERED;
 	}
 
-	void HashFunctions() {
-		std::lock_guard<std::recursive_mutex> guard(functions_lock);
-		std::vector<u32> buffer;
+	static void HashFunction(AnalyzedFunction &f, std::vector<u32> &buffer) {
+		if (!Memory::IsValidRange(f.start, f.end - f.start + 4)) {
+			return;
+		}
 
-		for (auto iter = functions.begin(), end = functions.end(); iter != end; iter++) {
-			AnalyzedFunction &f = *iter;
-			if (!Memory::IsValidRange(f.start, f.end - f.start + 4)) {
-				continue;
+		// This is unfortunate.  In case of emuhacks or relocs, we have to make a copy.
+		buffer.resize((f.end - f.start + 4) / 4);
+		size_t pos = 0;
+		for (u32 addr = f.start; addr <= f.end; addr += 4) {
+			u32 validbits = 0xFFFFFFFF;
+			MIPSOpcode instr = Memory::ReadUnchecked_Instruction(addr, true);
+			if (MIPS_IS_EMUHACK(instr)) {
+				f.hasHash = false;
+				return;
 			}
 
-			// This is unfortunate.  In case of emuhacks or relocs, we have to make a copy.
-			buffer.resize((f.end - f.start + 4) / 4);
-			size_t pos = 0;
-			for (u32 addr = f.start; addr <= f.end; addr += 4) {
-				u32 validbits = 0xFFFFFFFF;
-				MIPSOpcode instr = Memory::ReadUnchecked_Instruction(addr, true);
-				if (MIPS_IS_EMUHACK(instr)) {
-					f.hasHash = false;
-					goto skip;
-				}
+			MIPSInfo flags = MIPSGetInfo(instr);
+			if (flags & IN_IMM16)
+				validbits &= ~0xFFFF;
+			if (flags & IN_IMM26)
+				validbits &= ~0x03FFFFFF;
+			buffer[pos++] = instr & validbits;
+		}
 
-				MIPSInfo flags = MIPSGetInfo(instr);
-				if (flags & IN_IMM16)
-					validbits &= ~0xFFFF;
-				if (flags & IN_IMM26)
-					validbits &= ~0x03FFFFFF;
-				buffer[pos++] = instr & validbits;
-			}
+		f.hash = CityHash64((const char *) &buffer[0], buffer.size() * sizeof(u32));
+		f.hasHash = true;
+	}
 
-			f.hash = CityHash64((const char *) &buffer[0], buffer.size() * sizeof(u32));
-			f.hasHash = true;
-skip:
-			;
-		}
+	void HashFunctions() {
+		std::lock_guard<std::recursive_mutex> guard(functions_lock);
+
+		// Each function only reads its own code, so big modules are hashed in parallel.
+		ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+			std::vector<u32> buffer;
+			for (int i = l; i < h; ++i) {
+				HashFunction(functions[i], buffer);
+			}
+		}, 0, (int)functions.size(), 1024);
 	}
 
 	void PrecompileFunction(u32 startAddr, u32 length) {
@@ -1027,12 +1036,18 @@ namespace MIPSAnalyst {
 		return furthestJumpbackAddr;
 	}
 
-	bool ScanForFunctions(u32 startAddr, u32 endAddr, bool insertSymbols) {
-		std::lock_guard<std::recursive_mutex> guard(functions_lock);
-
-		FunctionsVector new_functions;
+	struct ScannedRange {
+		FunctionsVector functions;
+		// Where the scan of each function started, before skipping nop padding.
+		std::vector<u32> begins;
+		// Where the function after the last one starts, or 0 if the scan reached the end.
+		u32 next = 0;
+	};
 
-		AnalyzedFunction currentFunction = {startAddr};
+	// Finds the functions from begin on, until one ends past stopAddr.  Only reads memory, so ranges can run in parallel.
+	static void ScanFunctionRange(u32 begin, u32 stopAddr, u32 endAddr, ScannedRange &result) {
+		AnalyzedFunction currentFunction = {begin};
+		u32 currentBegin = begin;
 
 		u32 furthestBranch = 0;
 		bool looking = false;
@@ -1041,7 +1056,7 @@ namespace MIPSAnalyst {
 		bool decreasedSp = false;
 
 		u32 addr;
-		for (addr = startAddr; addr <= endAddr; addr += 4) {
+		for (addr = begin; addr <= endAddr; addr += 4) {
 			MIPSOpcode op = Memory::Read_Instruction(addr, true);
 			u32 target = GetBranchTargetNoRA(addr, op);
 			if (target != INVALIDTARGET) {
@@ -1136,23 +1151,8 @@ namespace MIPSAnalyst {
 			if (end) {
 				currentFunction.end = addr + 4;
 				currentFunction.isStraightLeaf = isStraightLeaf;
-
-				// Check if we already have symbol info starting here.  If so, skip insertion.
-				// We used to use the symbols to find the functions, but sometimes we'd find
-				// wrong ones due to two modules with the same name.
-				u32 existingSize = g_symbolMap->GetFunctionSize(currentFunction.start);
-				if (existingSize != SymbolMap::INVALID_ADDRESS) {
-					currentFunction.foundInSymbolMap = true;
-
-					// If we run into a func with a different size, skip updating the hash map.
-					// This will prevent us saving incorrectly named funcs with wrong hashes.
-					u32 detectedSize = currentFunction.end - currentFunction.start + 4;
-					if (existingSize != detectedSize) {
-						insertSymbols = false;
-					}
-				}
-
-				new_functions.push_back(currentFunction);
+				result.functions.push_back(currentFunction);
+				result.begins.push_back(currentBegin);
 
 				furthestBranch = 0;
 				addr += 4;
@@ -1161,17 +1161,203 @@ namespace MIPSAnalyst {
 				isStraightLeaf = true;
 				decreasedSp = false;
 				currentFunction.start = addr + 4;
-				currentFunction.foundInSymbolMap = false;
+				currentBegin = currentFunction.start;
+				if (currentFunction.start > stopAddr) {
+					result.next = currentFunction.start <= endAddr ? currentFunction.start : 0;
+					return;
+				}
 			}
 		}
 
 		if (addr <= endAddr) {
 			currentFunction.end = addr + 4;
-			new_functions.push_back(currentFunction);
+			result.functions.push_back(currentFunction);
+			result.begins.push_back(currentBegin);
+		}
+	}
+
+	static FunctionsVector ScanFunctionsParallel(u32 startAddr, u32 endAddr) {
+		// Split big modules into chunks, and scan each from its start as if a function began there.
+		// Once a chunk's guess lines up with where the previous chunk's last function really ended,
+		// the rest of it is the same as a serial scan.  If it never does, that chunk is scanned again.
+		static const u32 MIN_CHUNK_SIZE = 256 * 1024;
+		int numChunks = 1;
+		if (endAddr > startAddr) {
+			u32 maxChunks = std::max(1, g_threadManager.GetNumLooperThreads()) * 2;
+			numChunks = (int)std::min((endAddr - startAddr) / MIN_CHUNK_SIZE + 1, maxChunks);
+		}
+		auto chunkBegin = [&](int i) {
+			return startAddr + (u32)(((u64)(endAddr - startAddr) * i / numChunks) & ~3ULL);
+		};
+		auto chunkStop = [&](int i) {
+			return i + 1 < numChunks ? chunkBegin(i + 1) - 4 : endAddr;
+		};
+
+		std::vector<ScannedRange> ranges(numChunks);
+		if (numChunks == 1) {
+			ScanFunctionRange(startAddr, endAddr, endAddr, ranges[0]);
+		} else {
+			ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+				for (int i = l; i < h; ++i) {
+					ScanFunctionRange(chunkBegin(i), chunkStop(i), endAddr, ranges[i]);
+				}
+			}, 0, numChunks, 1);
+		}
+
+		FunctionsVector new_functions = std::move(ranges[0].functions);
+		u32 next = ranges[0].next;
+		for (int i = 1; i < numChunks && next != 0; ++i) {
+			ScannedRange &range = ranges[i];
+			auto it = std::find(range.begins.begin(), range.begins.end(), next);
+			if (it == range.begins.end()) {
+				range = ScannedRange();
+				ScanFunctionRange(next, chunkStop(i), endAddr, range);
+				it = range.begins.begin();
+			}
+			new_functions.insert(new_functions.end(), range.functions.begin() + (it - range.begins.begin()), range.functions.end());
+			next = range.next;
+		}
+		return new_functions;
+	}
+
+	static const u32 SCAN_CACHE_MAGIC = 0x46534350;  // PCSF
+	static const u32 SCAN_CACHE_VERSION = 1;
+	// Smaller ranges scan quickly enough, not worth a file each.
+	static const u32 SCAN_CACHE_MIN_SIZE = 64 * 1024;
+
+	struct ScanCacheHeader {
+		u32 magic;
+		u32 version;
+		u32 startAddr;
+		u32 endAddr;
+		u64 textHash;
+		u32 count;
+		u32 reserved;
+	};
+
+	struct ScanCacheFunction {
+		u32 start;
+		u32 end;
+		u32 isStraightLeaf;
+	};
+
+	// Covers what the scan reads, so replacements from earlier modules are included like there.
+	static u64 HashScanRange(u32 startAddr, u32 endAddr) {
+		std::vector<u32> buffer((endAddr - startAddr) / 4 + 1);
+		for (size_t i = 0; i < buffer.size(); ++i) {
+			buffer[i] = Memory::ReadUnchecked_Instruction(startAddr + (u32)i * 4, true).encoding;
+		}
+		return XXH3_64bits(buffer.data(), buffer.size() * sizeof(u32));
+	}
+
+	static Path ScanCachePath(u32 startAddr, u64 textHash) {
+		return GetSysDirectory(DIRECTORY_APP_CACHE) / "Analysis" / StringFromFormat("%016llx_%08x.funcs", (unsigned long long)textHash, startAddr);
+	}
+
+	static bool LoadScanCache(u32 startAddr, u32 endAddr, u64 textHash, FunctionsVector &result) {
+		FILE *f = File::OpenCFile(ScanCachePath(startAddr, textHash), "rb");
+		if (!f)
+			return false;
+
+		ScanCacheHeader header{};
+		bool valid = fread(&header, sizeof(header), 1, f) == 1;
+		valid = valid && header.magic == SCAN_CACHE_MAGIC && header.version == SCAN_CACHE_VERSION;
+		valid = valid && header.startAddr == startAddr && header.endAddr == endAddr && header.textHash == textHash;
+		valid = valid && header.count <= (endAddr - startAddr) / 4 + 1;
+
+		std::vector<ScanCacheFunction> entries(valid ? header.count : 0);
+		valid = valid && (entries.empty() || fread(&entries[0], sizeof(ScanCacheFunction), entries.size(), f) == entries.size());
+		fclose(f);
+
+		FunctionsVector funcs;
+		for (size_t i = 0; valid && i < entries.size(); ++i) {
+			const ScanCacheFunction &entry = entries[i];
+			if (entry.start < startAddr || entry.end < entry.start || entry.end > endAddr + 8) {
+				valid = false;
+				break;
+			}
+			AnalyzedFunction func = { entry.start };
+			func.end = entry.end;
+			func.isStraightLeaf = entry.isStraightLeaf != 0;
+			funcs.push_back(func);
+		}
+
+		if (!valid) {
+			WARN_LOG(LOADER, "Ignoring invalid function scan cache for %08x", startAddr);
+			return false;
+		}
+		result = std::move(funcs);
+		return true;
+	}
+
+	static void SaveScanCache(u32 startAddr, u32 endAddr, u64 textHash, const FunctionsVector &funcs) {
+		Path filename = ScanCachePath(startAddr, textHash);
+		File::CreateFullPath(filename.NavigateUp());
+		// Write to a temp file first, so a crash doesn't leave half a cache.
+		Path tempFilename = filename.WithExtraExtension(".tmp");
+		FILE *f = File::OpenCFile(tempFilename, "wb");
+		if (!f) {
+			WARN_LOG(LOADER, "Unable to save function scan cache");
+			return;
+		}
+
+		ScanCacheHeader header{};
+		header.magic = SCAN_CACHE_MAGIC;
+		header.version = SCAN_CACHE_VERSION;
+		header.startAddr = startAddr;
+		header.endAddr = endAddr;
+		header.textHash = textHash;
+		header.count = (u32)funcs.size();
+		bool success = fwrite(&header, sizeof(header), 1, f) == 1;
+
+		std::vector<ScanCacheFunction> entries;
+		entries.reserve(funcs.size());
+		for (const AnalyzedFunction &func : funcs) {
+			entries.push_back(ScanCacheFunction{ func.start, func.end, func.isStraightLeaf ? 1U : 0U });
+		}
+		success = success && (entries.empty() || fwrite(&entries[0], sizeof(ScanCacheFunction), entries.size(), f) == entries.size());
+		fclose(f);
+
+		if (!success || !File::Rename(tempFilename, filename)) {
+			WARN_LOG(LOADER, "Unable to save function scan cache");
+			File::Delete(tempFilename);
+		}
+	}
+
+	bool ScanForFunctions(u32 startAddr, u32 endAddr, bool insertSymbols) {
+		std::lock_guard<std::recursive_mutex> guard(functions_lock);
+
+		// The scan only depends on the code, so big modules keep their results, keyed by a hash of it.
+		// On a warm boot, that skips the scan and the jit can precompile the same ranges right away.
+		bool useCache = endAddr > startAddr && endAddr - startAddr >= SCAN_CACHE_MIN_SIZE && Memory::IsValidRange(startAddr, endAddr - startAddr + 4);
+		u64 textHash = useCache ? HashScanRange(startAddr, endAddr) : 0;
+
+		FunctionsVector new_functions;
+		if (!useCache || !LoadScanCache(startAddr, endAddr, textHash, new_functions)) {
+			new_functions = ScanFunctionsParallel(startAddr, endAddr);
+			if (useCache)
+				SaveScanCache(startAddr, endAddr, textHash, new_functions);
+		}
+
+		for (auto &f : new_functions) {
+			f.size = f.end - f.start + 4;
+
+			// Check if we already have symbol info starting here.  If so, skip insertion.
+			// We used to use the symbols to find the functions, but sometimes we'd find
+			// wrong ones due to two modules with the same name.
+			u32 existingSize = g_symbolMap->GetFunctionSize(f.start);
+			if (existingSize != SymbolMap::INVALID_ADDRESS) {
+				f.foundInSymbolMap = true;
+
+				// If we run into a func with a different size, skip updating the hash map.
+				// This will prevent us saving incorrectly named funcs with wrong hashes.
+				if (existingSize != f.size) {
+					insertSymbols = false;
+				}
+			}
 		}
 
 		for (auto iter = new_functions.begin(); iter != new_functions.end(); iter++) {
-			iter->size = iter->end - iter->start + 4;
 			if (insertSymbols && !iter->foundInSymbolMap) {
 				char temp[256];
 				g_symbolMap->AddFunction(DefaultFunctionName(temp, iter->start), iter->start, iter->end - iter->start + 4);
@@ -1310,6 +1496,54 @@ namespace MIPSAnalyst {
 		return 0;
 	}
 
+	std::vector<HotFunction> RankUnknownHotFunctions(int maxFunctions) {
+		std::vector<HotFunction> ranked;
+		std::vector<MIPSComp::JitBlockProfileEntry> blocks = MIPSComp::GetJitBlockProfile(INT_MAX);
+		if (blocks.empty()) {
+			return ranked;
+		}
+
+		std::lock_guard<std::recursive_mutex> guard(functions_lock);
+		// Modules are scanned one at a time, so the list isn't necessarily in address order.
+		std::vector<size_t> byStart(functions.size());
+		for (size_t i = 0; i < byStart.size(); ++i) {
+			byStart[i] = i;
+		}
+		std::sort(byStart.begin(), byStart.end(), [](size_t a, size_t b) {
+			return functions[a].start < functions[b].start;
+		});
+
+		std::unordered_map<size_t, u64> counts;
+		for (const auto &block : blocks) {
+			auto it = std::upper_bound(byStart.begin(), byStart.end(), block.address, [](u32 addr, size_t i) {
+				return addr < functions[i].start;
+			});
+			if (it == byStart.begin()) {
+				continue;
+			}
+			const AnalyzedFunction &f = functions[*(it - 1)];
+			if (block.address <= f.end) {
+				counts[*(it - 1)] += block.count;
+			}
+		}
+
+		for (const auto &count : counts) {
+			const AnalyzedFunction &f = functions[count.first];
+			// Without a hash it can't go in the table, and with a name it's already there.
+			if (!f.hasHash || LookupHash(f.hash, f.size) != nullptr) {
+				continue;
+			}
+			ranked.push_back(HotFunction{ f.start, f.size, f.hash, count.second });
+		}
+
+		size_t n = std::min(ranked.size(), (size_t)std::max(maxFunctions, 0));
+		std::partial_sort(ranked.begin(), ranked.begin() + n, ranked.end(), [](const HotFunction &a, const HotFunction &b) {
+			return a.count > b.count;
+		});
+		ranked.resize(n);
+		return ranked;
+	}
+
 	void SetHashMapFilename(const std::string& filename) {
 		if (filename.empty())
 			hashmapFileName = GetSysDirectory(DIRECTORY_SYSTEM) / "knownfuncs.ini";
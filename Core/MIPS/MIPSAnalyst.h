@@ -119,6 +119,17 @@ namespace MIPSAnalyst
 	void StoreHashMap(Path filename = Path());
 
 	const char *LookupHash(u64 hash, u32 funcSize);
+
+	struct HotFunction {
+		u32 start;
+		u32 size;
+		u64 hash;
+		// Total entries into the function's jit blocks.
+		u64 count;
+	};
+	// Ranks the functions the hash map doesn't know by how often their blocks ran, most first.
+	// Needs MIPSComp::jitBlockProfiling, and finds candidates for new entries in the replacement table.
+	std::vector<HotFunction> RankUnknownHotFunctions(int maxFunctions);
 	void ReplaceFunctions();
 
 	void UpdateHashMap();
@@ -23,6 +23,22 @@
 #include "Core/MIPS/MIPS.h"
 #include "Core/Debugger/DebugInterface.h"
 
+// Values for EXCOMM_REF in expressions parsed by MIPSDebugInterface.
+// GPRs are simply their index.
+enum ReferenceIndexType {
+	REF_INDEX_PC       = 32,
+	REF_INDEX_HI       = 33,
+	REF_INDEX_LO       = 34,
+	REF_INDEX_FPU      = 0x1000,
+	REF_INDEX_FPU_INT  = 0x2000,
+	REF_INDEX_VFPU     = 0x4000,
+	REF_INDEX_VFPU_INT = 0x8000,
+	REF_INDEX_IS_FLOAT = REF_INDEX_FPU | REF_INDEX_VFPU,
+	REF_INDEX_HLE      = 0x10000,
+	REF_INDEX_THREAD   = REF_INDEX_HLE | 0,
+	REF_INDEX_MODULE   = REF_INDEX_HLE | 1,
+};
+
 class MIPSDebugInterface : public DebugInterface
 {
 	MIPSState *cpu;
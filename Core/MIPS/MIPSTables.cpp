@@ -15,6 +15,11 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
 #include "Core/Core.h"
 #include "Core/System.h"
 #include "Core/MemMap.h"
@@ -958,6 +963,73 @@ void MIPSInterpret(MIPSOpcode op) {
 #define R(i)   (curMips->r[i])
 
 
+// Interpreter functions and cycles, decoded once per instruction of RAM instead of walking the tables each time.
+// Entries are still checked against the opcode, so code written without an icache invalidate is seen too.
+struct InterpretCacheEntry {
+	u32 encoding;
+	int cycles;
+	MIPSInterpretFunc func;
+};
+
+static const u32 INTERPRET_CACHE_PAGE_SHIFT = 12;
+static const u32 INTERPRET_CACHE_PAGE_ENTRIES = 1 << (INTERPRET_CACHE_PAGE_SHIFT - 2);
+// Allocated as code runs, by page of RAM.
+static std::vector<std::unique_ptr<InterpretCacheEntry[]>> interpretCache;
+
+static inline u32 InterpretCacheOffset(u32 address) {
+	// Works for the uncached and kernel mirrors too. Anything not in RAM is out of range.
+	return (address & 0x1FFFFFFF) - 0x08000000;
+}
+
+static const InterpretCacheEntry *InterpretCacheLookup(u32 pc, MIPSOpcode op) {
+	u32 offset = InterpretCacheOffset(pc);
+	if (offset >= Memory::g_MemorySize)
+		return nullptr;
+
+	size_t page = offset >> INTERPRET_CACHE_PAGE_SHIFT;
+	if (page >= interpretCache.size())
+		interpretCache.resize((Memory::g_MemorySize + (1 << INTERPRET_CACHE_PAGE_SHIFT) - 1) >> INTERPRET_CACHE_PAGE_SHIFT);
+	std::unique_ptr<InterpretCacheEntry[]> &entries = interpretCache[page];
+	if (!entries) {
+		entries.reset(new InterpretCacheEntry[INTERPRET_CACHE_PAGE_ENTRIES]);
+		memset(entries.get(), 0, sizeof(InterpretCacheEntry) * INTERPRET_CACHE_PAGE_ENTRIES);
+	}
+
+	InterpretCacheEntry &entry = entries[(offset >> 2) & (INTERPRET_CACHE_PAGE_ENTRIES - 1)];
+	if (!entry.func || entry.encoding != op.encoding) {
+		const MIPSInstruction *instr = MIPSGetInstruction(op);
+		// Bad instructions go the slow way, which reports them.
+		if (!instr || !instr->interpret)
+			return nullptr;
+		entry.encoding = op.encoding;
+		entry.cycles = (int)instr->flags.cycles;
+		entry.func = instr->interpret;
+	}
+	return &entry;
+}
+
+void MIPSInterpret_InvalidateCache(u32 address, int length) {
+	u32 start = InterpretCacheOffset(address);
+	if (start >= Memory::g_MemorySize || length <= 0)
+		return;
+	u32 end = std::min(start + (u32)length, Memory::g_MemorySize);
+
+	for (u32 offset = start & ~3; offset < end; ) {
+		size_t page = offset >> INTERPRET_CACHE_PAGE_SHIFT;
+		u32 pageEnd = std::min((u32)(page + 1) << INTERPRET_CACHE_PAGE_SHIFT, end);
+		if (page < interpretCache.size() && interpretCache[page]) {
+			InterpretCacheEntry *entries = interpretCache[page].get();
+			for (u32 i = offset; i < pageEnd; i += 4)
+				entries[(i >> 2) & (INTERPRET_CACHE_PAGE_ENTRIES - 1)].func = nullptr;
+		}
+		offset = (u32)(page + 1) << INTERPRET_CACHE_PAGE_SHIFT;
+	}
+}
+
+void MIPSInterpret_ClearCache() {
+	interpretCache.clear();
+}
+
 int MIPSInterpret_RunUntil(u64 globalTicks)
 {
 	MIPSState *curMips = currentMIPS;
@@ -990,8 +1062,16 @@ int MIPSInterpret_RunUntil(u64 globalTicks)
 #endif
 
 				bool wasInDelaySlot = curMips->inDelaySlot;
-				MIPSInterpret(op);
-				curMips->downcount -= MIPSGetInstructionCycleEstimate(op);
+				const InterpretCacheEntry *entry = InterpretCacheLookup(curMips->pc, op);
+				if (entry) {
+					// The instruction might invalidate its own entry, so grab the cycles first.
+					int cycles = entry->cycles;
+					entry->func(op);
+					curMips->downcount -= cycles;
+				} else {
+					MIPSInterpret(op);
+					curMips->downcount -= MIPSGetInstructionCycleEstimate(op);
+				}
 
 				if (curMips->inDelaySlot)
 				{
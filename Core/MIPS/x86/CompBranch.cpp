@@ -667,6 +667,7 @@ void Jit::Comp_Jump(MIPSOpcode op) {
 		}
 		FlushAll();
 		CONDITIONAL_LOG_EXIT(targetAddr);
+		WriteReturnStackPush(GetCompilerPC() + 8, INVALID_REG);
 		WriteExit(targetAddr, js.nextExit++);
 		break;
 
@@ -765,6 +766,10 @@ void Jit::Comp_JumpReg(MIPSOpcode op)
 	}
 
 	CONDITIONAL_LOG_EXIT_EAX();
+	if (andLink && rd == MIPS_REG_RA)
+		WriteReturnStackPush(GetCompilerPC() + 8, destReg);
+	else if (!andLink && rs == MIPS_REG_RA)
+		WriteReturnStackJump(destReg);
 	WriteExitDestInReg(destReg);
 	js.compiling = false;
 }
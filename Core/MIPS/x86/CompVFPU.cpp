@@ -2798,6 +2798,19 @@ void Jit::Comp_VScl(MIPSOpcode op) {
 	fpr.ReleaseSpillLocks();
 }
 
+void Jit::CompVBroadcast(X64Reg dest, const OpArg &src) {
+	if (cpu_info.bAVX) {
+		// VBROADCASTSS only takes a register source from AVX2 on.
+		if (src.IsSimpleReg())
+			VPERMILPS(128, dest, src, _MM_SHUFFLE(0, 0, 0, 0));
+		else
+			VBROADCASTSS(128, dest, src);
+	} else {
+		MOVSS(dest, src);
+		SHUFPS(dest, R(dest), _MM_SHUFFLE(0, 0, 0, 0));
+	}
+}
+
 void Jit::Comp_Vmmul(MIPSOpcode op) {
 	CONDITIONAL_DISABLE(VFPU_MTX_VMMUL);
 	if (!js.HasNoPrefix()) {
@@ -2891,19 +2904,58 @@ void Jit::Comp_Vmmul(MIPSOpcode op) {
 			transposeInPlace(scol);
 		}
 
+		// With AVX, a 4x4 can do two columns of D at a time in 256-bit registers, if pairs of T's
+		// columns are contiguous in memory (not transposed.)  The sums are done in the same order.
+		bool useAVX256 = false;
+#if PPSSPP_ARCH(AMD64)
+		if (cpu_info.bAVX && sz == M_4x4) {
+			useAVX256 = true;
+			for (int i = 0; i < 16; i++) {
+				if (voffset[tregs[i]] != voffset[tregs[0]] + i)
+					useAVX256 = false;
+			}
+		}
+#endif
+
+		if (useAVX256) {
+			// Duplicate each S column into the upper half of its register, the cache only sees the lower.
+			for (int j = 0; j < 4; j++) {
+				X64Reg sreg = fpr.VSX(scol[j]);
+				VINSERTF128(sreg, sreg, R(sreg), 1);
+			}
+			for (int i = 0; i < 4; i += 2) {
+				u8 dcol[2][4];
+				GetVectorRegs(dcol[0], vsz, dcols[i]);
+				GetVectorRegs(dcol[1], vsz, dcols[i + 1]);
+				fpr.MapRegsVS(dcol[0], vsz, MAP_DIRTY | MAP_NOINIT);
+				fpr.MapRegsVS(dcol[1], vsz, MAP_DIRTY | MAP_NOINIT);
+				X64Reg sum = fpr.VSX(dcol[0]);
+
+				// T column i in the lower half, i + 1 in the upper.
+				VMOVUPS(256, XMM0, fpr.V(tregs[4 * i]));
+				VPERMILPS(256, sum, R(XMM0), _MM_SHUFFLE(0, 0, 0, 0));
+				VMULPS(256, sum, sum, fpr.VS(scol[0]));
+				for (int j = 1; j < 4; j++) {
+					VPERMILPS(256, XMM1, R(XMM0), _MM_SHUFFLE(j, j, j, j));
+					VMULPS(256, XMM1, XMM1, fpr.VS(scol[j]));
+					VADDPS(256, sum, sum, R(XMM1));
+				}
+				VEXTRACTF128(fpr.VS(dcol[1]), sum, 1);
+			}
+			// Avoid the AVX to SSE transition penalty in the code that follows.
+			VZEROUPPER();
+		}
+
 		// Now, work our way through the matrix, loading things as we go.
 		// TODO: With more temp registers, can generate much more efficient code.
-		for (int i = 0; i < n; i++) {
-			MOVSS(XMM1, fpr.V(tregs[4 * i]));  // TODO: AVX broadcastss to replace this and the SHUFPS
-			MOVSS(XMM0, fpr.V(tregs[4 * i + 1]));
-			SHUFPS(XMM1, R(XMM1), _MM_SHUFFLE(0, 0, 0, 0));
-			SHUFPS(XMM0, R(XMM0), _MM_SHUFFLE(0, 0, 0, 0));
+		for (int i = 0; i < n && !useAVX256; i++) {
+			CompVBroadcast(XMM1, fpr.V(tregs[4 * i]));
+			CompVBroadcast(XMM0, fpr.V(tregs[4 * i + 1]));
 			MULPS(XMM1, fpr.VS(scol[0]));
 			MULPS(XMM0, fpr.VS(scol[1]));
 			ADDPS(XMM1, R(XMM0));
 			for (int j = 2; j < n; j++) {
-				MOVSS(XMM0, fpr.V(tregs[4 * i + j]));
-				SHUFPS(XMM0, R(XMM0), _MM_SHUFFLE(0, 0, 0, 0));
+				CompVBroadcast(XMM0, fpr.V(tregs[4 * i + j]));
 				MULPS(XMM0, fpr.VS(scol[j]));
 				ADDPS(XMM1, R(XMM0));
 			}
@@ -3111,13 +3163,11 @@ void Jit::Comp_Vtfm(MIPSOpcode op) {
 
 		// Now, work our way through the matrix, loading things as we go.
 		// TODO: With more temp registers, can generate much more efficient code.
-		MOVSS(XMM1, fpr.V(tregs[0]));  // TODO: AVX broadcastss to replace this and the SHUFPS (but take care of temps, unless we force store them.)
-		SHUFPS(XMM1, R(XMM1), _MM_SHUFFLE(0, 0, 0, 0));
+		CompVBroadcast(XMM1, fpr.V(tregs[0]));
 		MULPS(XMM1, fpr.VS(scol[0]));
 		for (int j = 1; j < n; j++) {
 			if (!homogenous || j != n - 1) {
-				MOVSS(XMM0, fpr.V(tregs[j]));
-				SHUFPS(XMM0, R(XMM0), _MM_SHUFFLE(0, 0, 0, 0));
+				CompVBroadcast(XMM0, fpr.V(tregs[j]));
 				MULPS(XMM0, fpr.VS(scol[j]));
 				ADDPS(XMM1, R(XMM0));
 			} else {
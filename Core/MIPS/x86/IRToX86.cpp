@@ -1,299 +1,574 @@
 #include "ppsspp_config.h"
-#if PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
+#if PPSSPP_ARCH(AMD64)
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "Common/ABI.h"
+#include "Common/Log.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/x86/IRToX86.h"
 
 namespace MIPSComp {
 
-// Initial attempt at converting IR directly to x86.
-// This is intended to be an easy way to benefit from the IR with the current infrastructure.
+using namespace Gen;
+
+// Converts IR blocks directly to x86-64, as an easy way to benefit from the IR with the current infrastructure.
+// Integer ALU ops, loads/stores and all control flow are compiled natively.  Anything else calls back into the
+// IR interpreter for that one instruction, so every block can be compiled.
 // Later tries may go across multiple blocks and a different representation.
 
-struct GPRMapping {
-	Gen::OpArg dest;
-	Gen::OpArg src1;
-	Gen::OpArg src2;
+static const X64Reg CTXREG = RBX;
+static const X64Reg MEMBASEREG = R15;
+static const X64Reg SCRATCH1 = RAX;
+static const X64Reg SCRATCH2 = R11;
+
+// Only caller-saved registers, since everything's flushed around fallback calls anyway.
+static const X64Reg allocationOrder[] = {
+#ifndef _WIN32
+	RSI, RDI,
+#endif
+	RCX, RDX, R8, R9, R10,
 };
 
-struct FPRMapping {
-	Gen::OpArg dest;
-	Gen::OpArg src1;
-	Gen::OpArg src2;
-};
+// Shadow space for Win64, and keeps the stack 16-byte aligned after the two pushes.
+static const int STACK_SPACE = 0x28;
 
+// A generous upper bound of the bytes we emit per IR instruction, including flushes.
+static const int MAX_BYTES_PER_INST = 192;
 
-class GreedyRegallocGPR {
-public:
-	GPRMapping Map(IRInst inst, const IRMeta &meta);
+static int RegOffset(int reg) {
+	return (int)offsetof(MIPSState, r) + reg * 4;
+}
 
-private:
-	
-};
+// Runs a single IR instruction.  Returns the exit PC, or 0 to keep going.
+static u32 IRNativeInterpretOne(MIPSState *mips, u64 packed) {
+	static_assert(sizeof(IRInst) == sizeof(u64), "IRInst must fit in a register");
+	IRInst insts[2];
+	memcpy(&insts[0], &packed, sizeof(IRInst));
+	memset(&insts[1], 0, sizeof(IRInst));
+	insts[1].op = IROp::ExitToConst;
+	return IRInterpret(mips, insts, 2);
+}
+
+static bool IsNativeOp(IROp op) {
+	switch (op) {
+	case IROp::SetConst:
+	case IROp::Mov:
+	case IROp::Add:
+	case IROp::Sub:
+	case IROp::And:
+	case IROp::Or:
+	case IROp::Xor:
+	case IROp::AddConst:
+	case IROp::SubConst:
+	case IROp::AndConst:
+	case IROp::OrConst:
+	case IROp::XorConst:
+	case IROp::Neg:
+	case IROp::Not:
+	case IROp::Ext8to32:
+	case IROp::Ext16to32:
+	case IROp::ShlImm:
+	case IROp::ShrImm:
+	case IROp::SarImm:
+	case IROp::RorImm:
+	case IROp::Slt:
+	case IROp::SltU:
+	case IROp::SltConst:
+	case IROp::SltUConst:
+	case IROp::MovZ:
+	case IROp::MovNZ:
+	case IROp::Load8:
+	case IROp::Load8Ext:
+	case IROp::Load16:
+	case IROp::Load16Ext:
+	case IROp::Load32:
+	case IROp::Store8:
+	case IROp::Store16:
+	case IROp::Store32:
+	case IROp::Downcount:
+	case IROp::SetPC:
+	case IROp::SetPCConst:
+	case IROp::ExitToConst:
+	case IROp::ExitToReg:
+	case IROp::ExitToPC:
+	case IROp::ExitToConstIfEq:
+	case IROp::ExitToConstIfNeq:
+	case IROp::ExitToConstIfGtZ:
+	case IROp::ExitToConstIfGeZ:
+	case IROp::ExitToConstIfLtZ:
+	case IROp::ExitToConstIfLeZ:
+		return true;
+	default:
+		return false;
+	}
+}
 
+IRToX86::IRToX86() {
+	AllocCodeSpace(1024 * 1024 * 16);
+}
 
-GPRMapping GreedyRegallocGPR::Map(IRInst inst, const IRMeta &meta) {
-	GPRMapping mapping;
-	if (meta.types[0] == 'G') {
+void IRToX86::ClearNativeCode() {
+	ClearCodeSpace(0);
+}
 
+// Linear scan over the block.  Each IR register used by native ops gets one interval, from its first
+// to its last use, and either keeps a host register for all of it or lives in the context.
+void IRToX86::AllocateRegs(const IRInst *instructions, int count) {
+	int start[256];
+	for (int r = 0; r < 256; r++) {
+		host_[r] = INVALID_REG;
+		start[r] = -1;
+		end_[r] = -1;
+		live_[r] = false;
+		dirty_[r] = false;
+	}
+
+	auto use = [&](int reg, int i) {
+		if (start[reg] == -1)
+			start[reg] = i;
+		end_[reg] = i;
+	};
+	for (int i = 0; i < count; i++) {
+		const IRInst &inst = instructions[i];
+		if (!IsNativeOp(inst.op))
+			continue;
+		const IRMeta *meta = GetIRMeta(inst.op);
+		if (meta->types[0] == 'G')
+			use(inst.dest, i);
+		if (meta->types[1] == 'G')
+			use(inst.src1, i);
+		if (meta->types[2] == 'G')
+			use(inst.src2, i);
+	}
+
+	struct Interval {
+		int reg;
+		int start;
+		int end;
+	};
+	std::vector<Interval> intervals;
+	for (int r = 0; r < 256; r++) {
+		if (start[r] != -1)
+			intervals.push_back({ r, start[r], end_[r] });
+	}
+	std::sort(intervals.begin(), intervals.end(), [](const Interval &a, const Interval &b) {
+		return a.start < b.start;
+	});
+
+	std::vector<X64Reg> freeRegs(std::begin(allocationOrder), std::end(allocationOrder));
+	std::reverse(freeRegs.begin(), freeRegs.end());
+	// Kept sorted by end.
+	std::vector<Interval> active;
+	for (const Interval &iv : intervals) {
+		// Intervals ending at this instruction still count, so sources and dests never share a register.
+		while (!active.empty() && active.front().end < iv.start) {
+			freeRegs.push_back(host_[active.front().reg]);
+			active.erase(active.begin());
+		}
+
+		auto insertActive = [&](const Interval &a) {
+			auto it = std::upper_bound(active.begin(), active.end(), a, [](const Interval &x, const Interval &y) {
+				return x.end < y.end;
+			});
+			active.insert(it, a);
+		};
+
+		if (!freeRegs.empty()) {
+			host_[iv.reg] = freeRegs.back();
+			freeRegs.pop_back();
+			insertActive(iv);
+		} else if (active.back().end > iv.end) {
+			// Steal from the one that lives longest, it stays in memory instead.
+			Interval spill = active.back();
+			active.pop_back();
+			host_[iv.reg] = host_[spill.reg];
+			host_[spill.reg] = INVALID_REG;
+			insertActive(iv);
+		}
+	}
+
+	endsAt_.clear();
+	endsAt_.resize(count);
+	for (int r = 0; r < 256; r++) {
+		if (host_[r] != INVALID_REG)
+			endsAt_[end_[r]].push_back((u8)r);
 	}
-	// etc..
-	return mapping;
 }
 
-// Every 4 registers can also be mapped into an SSE register.
-// When changing from single to vec4 mapping, we'll just flush, for now.
-class GreedyRegallocFPR {
-public:
-	FPRMapping Map(IRInst inst, const IRMeta &meta);
-};
+OpArg IRToX86::GPR(int reg) const {
+	if (host_[reg] != INVALID_REG)
+		return R(host_[reg]);
+	return MDisp(CTXREG, RegOffset(reg));
+}
 
-FPRMapping GreedyRegallocFPR::Map(IRInst inst, const IRMeta &meta) {
-	FPRMapping mapping;
+void IRToX86::MapIn(int reg) {
+	if (host_[reg] != INVALID_REG && !live_[reg]) {
+		MOV(32, R(host_[reg]), MDisp(CTXREG, RegOffset(reg)));
+		live_[reg] = true;
+	}
+}
 
-	return mapping;
+void IRToX86::MapOut(int reg) {
+	if (host_[reg] != INVALID_REG) {
+		live_[reg] = true;
+		dirty_[reg] = true;
+	}
 }
 
+void IRToX86::ReleaseEnding(int index) {
+	for (u8 reg : endsAt_[index]) {
+		if (dirty_[reg])
+			MOV(32, MDisp(CTXREG, RegOffset(reg)), R(host_[reg]));
+		live_[reg] = false;
+		dirty_[reg] = false;
+	}
+}
 
-// This requires that ThreeOpToTwoOp has been run as the last pass.
-void IRToX86::ConvertIRToNative(const IRInst *instructions, int count, const u32 *constants) {
-	// Set up regcaches
-	using namespace Gen;
+// Emits stores for all dirty registers, without changing state.  Used on exit paths.
+void IRToX86::StoreDirty() {
+	for (int r = 0; r < 256; r++) {
+		if (dirty_[r])
+			MOV(32, MDisp(CTXREG, RegOffset(r)), R(host_[r]));
+	}
+}
 
-	GreedyRegallocGPR gprAlloc;
-	GreedyRegallocFPR fprAlloc;
+void IRToX86::ReloadLive(int index) {
+	for (int r = 0; r < 256; r++) {
+		dirty_[r] = false;
+		if (live_[r]) {
+			if (end_[r] > index)
+				MOV(32, R(host_[r]), MDisp(CTXREG, RegOffset(r)));
+			else
+				live_[r] = false;
+		}
+	}
+}
 
-	// Loop through all the instructions, emitting code as we go.
-	// Note that we do need to implement them all - fallbacks are not permitted.
-	for (int i = 0; i < count; i++) {
-		const IRInst *inst = &instructions[i];
-		const IRMeta &meta = *GetIRMeta(inst->op);
-		GPRMapping gpr = gprAlloc.Map(*inst, meta);
-		FPRMapping fpr = fprAlloc.Map(*inst, meta);
-
-		bool symmetric = false;
-		switch (inst->op) {
-		case IROp::Nop:
-			_assert_(false);
-			break;
+void IRToX86::WriteEpilogue() {
+	ADD(64, R(RSP), Imm8(STACK_SPACE));
+	POP(MEMBASEREG);
+	POP(CTXREG);
+	RET();
+}
 
-			// Output-only
-		case IROp::SetConst:
-			code_->MOV(32, gpr.dest, Imm32(constants[inst->src1]));
-			break;
-		case IROp::SetConstF:
-			code_->MOV(32, gpr.dest, Imm32(constants[inst->src1]));
-			break;
+void IRToX86::CompileExit(OpArg pc) {
+	// Might be a register we're about to store, so grab it first.
+	MOV(32, R(SCRATCH1), pc);
+	StoreDirty();
+	WriteEpilogue();
+}
 
-			// Add gets to be special cased because we have LEA.
-		case IROp::Add:
-			if (gpr.dest.IsSimpleReg() && gpr.src1.IsSimpleReg() && gpr.src2.IsSimpleReg()) {
-				code_->LEA(32, gpr.dest.GetSimpleReg(), MRegSum(gpr.src1.GetSimpleReg(), gpr.src2.GetSimpleReg()));
-				break;
-			}
-			// Else fall through.
-			// 3-op arithmetic that directly corresponds to x86
-			// (often 2-op in practice if src1 == dst). x86 only does 2-op though so some of these will need splitting.
-		case IROp::Sub:
-		case IROp::And:
-		case IROp::Or:
-		case IROp::Xor:
-			if (inst->src1 != inst->dest) {
-				code_->MOV(32, gpr.dest, gpr.src1);
-			}
-			// Emit directly
-			switch (inst->op) {
-			case IROp::Add: code_->ADD(32, gpr.dest, gpr.src2); break;
-			case IROp::Sub: code_->SUB(32, gpr.dest, gpr.src2); break;
-			case IROp::And: code_->AND(32, gpr.dest, gpr.src2); break;
-			case IROp::Or: code_->OR(32, gpr.dest, gpr.src2); break;
-			case IROp::Xor: code_->XOR(32, gpr.dest, gpr.src2); break;
-			}
-			break;
+void IRToX86::CompileCondExit(CCFlags skipCond, u32 pc) {
+	FixupBranch skip = J_CC(skipCond, true);
+	StoreDirty();
+	MOV(32, R(SCRATCH1), Imm32(pc));
+	WriteEpilogue();
+	SetJumpTarget(skip);
+}
 
-			// Variable shifts.
-		case IROp::Shl:
-		case IROp::Shr:
-		case IROp::Sar:
-		case IROp::Ror:
-
-		case IROp::Slt:
-		case IROp::SltU:
-		case IROp::MovZ:
-		case IROp::MovNZ:
-		case IROp::Max:
-		case IROp::Min:
-			break;
+void IRToX86::CompileFallback(const IRInst &inst, int index) {
+	u64 packed;
+	memcpy(&packed, &inst, sizeof(packed));
+
+	StoreDirty();
+	MOV(64, R(ABI_PARAM1), R(CTXREG));
+	MOV(64, R(ABI_PARAM2), Imm64(packed));
+	ABI_CallFunction((const void *)&IRNativeInterpretOne);
+	TEST(32, R(SCRATCH1), R(SCRATCH1));
+	FixupBranch keepGoing = J_CC(CC_Z);
+	WriteEpilogue();
+	SetJumpTarget(keepGoing);
+	ReloadLive(index);
+}
 
-			// 2-op arithmetic with constant
-		case IROp::AddConst:
-		case IROp::SubConst:
-		case IROp::AndConst:
-		case IROp::OrConst:
-		case IROp::XorConst:
-		case IROp::SltConst:
-		case IROp::SltUConst:
-
-			// 2-op arithmetic with immediate
-		case IROp::ShlImm:
-		case IROp::ShrImm:
-		case IROp::SarImm:
-		case IROp::RorImm:
-
-			// 2-op arithmetic
-		case IROp::Mov:
-			code_->MOV(32, gpr.dest, gpr.src1);
-			break;
+bool IRToX86::CompileGPRArith(const IRInst &inst) {
+	OpArg src2;
+	bool src2IsDest = false;
+
+	switch (inst.op) {
+	case IROp::SetConst:
+		MapOut(inst.dest);
+		MOV(32, GPR(inst.dest), Imm32(inst.constant));
+		return true;
+
+	case IROp::Mov:
+		if (inst.dest == inst.src1)
+			return true;
+		MapIn(inst.src1);
+		MapOut(inst.dest);
+		if (GPR(inst.dest).IsSimpleReg() || GPR(inst.src1).IsSimpleReg()) {
+			MOV(32, GPR(inst.dest), GPR(inst.src1));
+		} else {
+			MOV(32, R(SCRATCH1), GPR(inst.src1));
+			MOV(32, GPR(inst.dest), R(SCRATCH1));
+		}
+		return true;
+
+	case IROp::Add:
+	case IROp::Sub:
+	case IROp::And:
+	case IROp::Or:
+	case IROp::Xor:
+		MapIn(inst.src2);
+		src2 = GPR(inst.src2);
+		src2IsDest = inst.src2 == inst.dest;
+		break;
+
+	case IROp::AddConst:
+	case IROp::SubConst:
+	case IROp::AndConst:
+	case IROp::OrConst:
+	case IROp::XorConst:
+		src2 = Imm32(inst.constant);
+		break;
+
+	case IROp::Neg:
+	case IROp::Not:
+	case IROp::ShlImm:
+	case IROp::ShrImm:
+	case IROp::SarImm:
+	case IROp::RorImm:
+		src2 = Imm8(inst.src2);
+		break;
+
+	case IROp::Ext8to32:
+	case IROp::Ext16to32:
+	{
+		MapIn(inst.src1);
+		MapOut(inst.dest);
+		OpArg dest = GPR(inst.dest);
+		X64Reg target = dest.IsSimpleReg() ? dest.GetSimpleReg() : SCRATCH1;
+		MOVSX(32, inst.op == IROp::Ext8to32 ? 8 : 16, target, GPR(inst.src1));
+		if (target == SCRATCH1)
+			MOV(32, dest, R(SCRATCH1));
+		return true;
+	}
 
-		case IROp::Neg:
-		case IROp::Not:
-		case IROp::Ext8to32:
-		case IROp::Ext16to32:
-		case IROp::ReverseBits:
-		case IROp::BSwap16:
-		case IROp::BSwap32:
-		case IROp::Clz:
-			if (inst->dest != inst->src1) {
-				code_->NEG(32, gpr.dest); break;
-			}
-			break;
-				// Multiplier control
-		case IROp::MtLo:
-		case IROp::MtHi:
-		case IROp::MfLo:
-		case IROp::MfHi:
-		case IROp::Mult:
-		case IROp::MultU:
-		case IROp::Madd:
-		case IROp::MaddU:
-		case IROp::Msub:
-		case IROp::MsubU:
-		case IROp::Div:
-		case IROp::DivU:
-
-			// Memory access
+	case IROp::Slt:
+	case IROp::SltU:
+	case IROp::SltConst:
+	case IROp::SltUConst:
+	{
+		bool isConst = inst.op == IROp::SltConst || inst.op == IROp::SltUConst;
+		bool isSigned = inst.op == IROp::Slt || inst.op == IROp::SltConst;
+		MapIn(inst.src1);
+		if (!isConst)
+			MapIn(inst.src2);
+		MOV(32, R(SCRATCH1), GPR(inst.src1));
+		CMP(32, R(SCRATCH1), isConst ? Imm32(inst.constant) : GPR(inst.src2));
+		SETcc(isSigned ? CC_L : CC_B, R(SCRATCH1));
+		MOVZX(32, 8, SCRATCH1, R(SCRATCH1));
+		MapOut(inst.dest);
+		MOV(32, GPR(inst.dest), R(SCRATCH1));
+		return true;
+	}
+
+	case IROp::MovZ:
+	case IROp::MovNZ:
+	{
+		// The dest is also a source here.
+		MapIn(inst.dest);
+		MapIn(inst.src1);
+		MapIn(inst.src2);
+		MapOut(inst.dest);
+		OpArg dest = GPR(inst.dest);
+		X64Reg target = dest.IsSimpleReg() ? dest.GetSimpleReg() : SCRATCH1;
+		if (target == SCRATCH1)
+			MOV(32, R(SCRATCH1), dest);
+		CMP(32, GPR(inst.src1), Imm8(0));
+		CMOVcc(32, target, GPR(inst.src2), inst.op == IROp::MovZ ? CC_Z : CC_NZ);
+		if (target == SCRATCH1)
+			MOV(32, dest, R(SCRATCH1));
+		return true;
+	}
+
+	default:
+		return false;
+	}
+
+	MapIn(inst.src1);
+	MapOut(inst.dest);
+	OpArg dest = GPR(inst.dest);
+	X64Reg target = INVALID_REG;
+	if (inst.dest == inst.src1 && (dest.IsSimpleReg() || src2.IsSimpleReg() || src2.IsImm())) {
+		// Can operate in place, even in memory.
+	} else if (dest.IsSimpleReg() && !src2IsDest) {
+		target = dest.GetSimpleReg();
+		MOV(32, dest, GPR(inst.src1));
+	} else {
+		target = SCRATCH1;
+		MOV(32, R(SCRATCH1), GPR(inst.src1));
+	}
+	OpArg d = target == INVALID_REG ? dest : R(target);
+
+	switch (inst.op) {
+	case IROp::Add: case IROp::AddConst: ADD(32, d, src2); break;
+	case IROp::Sub: case IROp::SubConst: SUB(32, d, src2); break;
+	case IROp::And: case IROp::AndConst: AND(32, d, src2); break;
+	case IROp::Or: case IROp::OrConst: OR(32, d, src2); break;
+	case IROp::Xor: case IROp::XorConst: XOR(32, d, src2); break;
+	case IROp::Neg: NEG(32, d); break;
+	case IROp::Not: NOT(32, d); break;
+	case IROp::ShlImm: SHL(32, d, src2); break;
+	case IROp::ShrImm: SHR(32, d, src2); break;
+	case IROp::SarImm: SAR(32, d, src2); break;
+	case IROp::RorImm: ROR(32, d, src2); break;
+	default: break;
+	}
+
+	if (target == SCRATCH1)
+		MOV(32, dest, R(SCRATCH1));
+	return true;
+}
+
+bool IRToX86::CompileLoadStore(const IRInst &inst) {
+	bool isStore = inst.op == IROp::Store8 || inst.op == IROp::Store16 || inst.op == IROp::Store32;
+
+	MapIn(inst.src1);
+	if (isStore)
+		MapIn(inst.src3);
+
+	MOV(32, R(SCRATCH1), GPR(inst.src1));
+	if (inst.constant != 0)
+		ADD(32, R(SCRATCH1), Imm32(inst.constant));
+#ifdef MASKED_PSP_MEMORY
+	AND(32, R(SCRATCH1), Imm32(Memory::MEMVIEW32_MASK));
+#endif
+	// 32-bit ops clear the top of RAX, so this is base + the 32-bit address.
+	OpArg mem = MComplex(MEMBASEREG, SCRATCH1, SCALE_1, 0);
+
+	if (isStore) {
+		OpArg value = GPR(inst.src3);
+		if (!value.IsSimpleReg()) {
+			MOV(32, R(SCRATCH2), value);
+			value = R(SCRATCH2);
+		}
+		switch (inst.op) {
+		case IROp::Store8: MOV(8, mem, value); break;
+		case IROp::Store16: MOV(16, mem, value); break;
+		default: MOV(32, mem, value); break;
+		}
+		return true;
+	}
+
+	switch (inst.op) {
+	case IROp::Load8: MOVZX(32, 8, SCRATCH1, mem); break;
+	case IROp::Load8Ext: MOVSX(32, 8, SCRATCH1, mem); break;
+	case IROp::Load16: MOVZX(32, 16, SCRATCH1, mem); break;
+	case IROp::Load16Ext: MOVSX(32, 16, SCRATCH1, mem); break;
+	default: MOV(32, R(SCRATCH1), mem); break;
+	}
+	MapOut(inst.dest);
+	MOV(32, GPR(inst.dest), R(SCRATCH1));
+	return true;
+}
+
+const u8 *IRToX86::ConvertIRToNative(const IRInst *instructions, int count) {
+	if (count <= 0 || GetSpaceLeft() < (size_t)(count + 4) * MAX_BYTES_PER_INST)
+		return nullptr;
+
+	BeginWrite((count + 4) * MAX_BYTES_PER_INST);
+	AlignCode16();
+	const u8 *start = GetCodePtr();
+
+	AllocateRegs(instructions, count);
+
+	PUSH(CTXREG);
+	PUSH(MEMBASEREG);
+	SUB(64, R(RSP), Imm8(STACK_SPACE));
+	MOV(64, R(CTXREG), R(ABI_PARAM1));
+	MOV(64, R(MEMBASEREG), ImmPtr(Memory::base));
+
+	for (int i = 0; i < count; i++) {
+		const IRInst &inst = instructions[i];
+		if (!IsNativeOp(inst.op)) {
+			CompileFallback(inst, i);
+			continue;
+		}
+
+		switch (inst.op) {
 		case IROp::Load8:
 		case IROp::Load8Ext:
 		case IROp::Load16:
 		case IROp::Load16Ext:
 		case IROp::Load32:
-		case IROp::LoadFloat:
 		case IROp::Store8:
 		case IROp::Store16:
 		case IROp::Store32:
-		case IROp::StoreFloat:
-		case IROp::LoadVec4:
-		case IROp::StoreVec4:
-
-			// Output-only SIMD functions
-		case IROp::Vec4Init:
-		case IROp::Vec4Shuffle:
+			CompileLoadStore(inst);
+			break;
 
-			// 2-op SIMD functions
-		case IROp::Vec4Mov:
-			code_->MOVAPS(fpr.dest.GetSimpleReg(), fpr.src1);
+		case IROp::Downcount:
+			SUB(32, MDisp(CTXREG, offsetof(MIPSState, downcount)), Imm32(inst.constant));
 			break;
-		case IROp::Vec4Neg:
-		case IROp::Vec4Abs:
+
+		case IROp::SetPC:
+			MapIn(inst.src1);
+			if (GPR(inst.src1).IsSimpleReg()) {
+				MOV(32, MDisp(CTXREG, offsetof(MIPSState, pc)), GPR(inst.src1));
+			} else {
+				MOV(32, R(SCRATCH1), GPR(inst.src1));
+				MOV(32, MDisp(CTXREG, offsetof(MIPSState, pc)), R(SCRATCH1));
+			}
 			break;
-		case IROp::Vec4ClampToZero:
-			code_->PXOR(XMM0, R(XMM0));
-			code_->PMAXSW(XMM0, fpr.src1);
-			code_->MOVAPD(fpr.dest, XMM0);
+
+		case IROp::SetPCConst:
+			MOV(32, MDisp(CTXREG, offsetof(MIPSState, pc)), Imm32(inst.constant));
 			break;
-		case IROp::Vec4DuplicateUpperBitsAndShift1:
-		case IROp::Vec2ClampToZero:
-
-			// 3-op SIMD functions
-		case IROp::Vec4Add:
-		case IROp::Vec4Sub:
-		case IROp::Vec4Mul:
-		case IROp::Vec4Div:
-
-		case IROp::Vec4Scale:
-		case IROp::Vec4Dot:
-
-			// Pack-unpack
-		case IROp::Vec2Unpack16To31:
-		case IROp::Vec2Unpack16To32:
-		case IROp::Vec4Unpack8To32:
-		case IROp::Vec2Pack32To16:
-		case IROp::Vec2Pack31To16:
-		case IROp::Vec4Pack32To8:
-		case IROp::Vec4Pack31To8:
-
-		case IROp::FCmpVfpuBit:
-		case IROp::FCmpVfpuAggregate:
-		case IROp::FCmovVfpuCC:
-
-			// Trancendental functions (non-simd)
-		case IROp::FSin:
-		case IROp::FCos:
-		case IROp::FRSqrt:
-		case IROp::FRecip:
-		case IROp::FAsin:
-
-			// 3-Op FP
-		case IROp::FAdd:
-		case IROp::FSub:
-		case IROp::FMul:
-		case IROp::FDiv:
-		case IROp::FMin:
-		case IROp::FMax:
-
-			// 2-Op FP
-		case IROp::FMov:
-		case IROp::FAbs:
-		case IROp::FSqrt:
-		case IROp::FNeg:
-		case IROp::FSat0_1:
-		case IROp::FSatMinus1_1:
-		case IROp::FSign:
-		case IROp::FCeil:
-		case IROp::FFloor:
-		case IROp::FCmp:
-		case IROp::FCvtSW:
-		case IROp::FCvtWS:
-		case IROp::FRound:
-		case IROp::FTrunc:
-
-			// Cross moves
-		case IROp::FMovFromGPR:
-		case IROp::FMovToGPR:
-		case IROp::FpCondToReg:
-		case IROp::VfpuCtrlToReg:
-
-			// VFPU flag/control
-		case IROp::SetCtrlVFPU:
-		case IROp::SetCtrlVFPUReg:
-		case IROp::SetCtrlVFPUFReg:
-		case IROp::ZeroFpCond:
-
-			// Block Exits
+
 		case IROp::ExitToConst:
+			CompileExit(Imm32(inst.constant));
+			break;
+
 		case IROp::ExitToReg:
+			MapIn(inst.src1);
+			CompileExit(GPR(inst.src1));
+			break;
+
+		case IROp::ExitToPC:
+			CompileExit(MDisp(CTXREG, offsetof(MIPSState, pc)));
+			break;
+
 		case IROp::ExitToConstIfEq:
 		case IROp::ExitToConstIfNeq:
+			MapIn(inst.src1);
+			MapIn(inst.src2);
+			MOV(32, R(SCRATCH1), GPR(inst.src1));
+			CMP(32, R(SCRATCH1), GPR(inst.src2));
+			CompileCondExit(inst.op == IROp::ExitToConstIfEq ? CC_NE : CC_E, inst.constant);
+			break;
+
 		case IROp::ExitToConstIfGtZ:
 		case IROp::ExitToConstIfGeZ:
 		case IROp::ExitToConstIfLtZ:
 		case IROp::ExitToConstIfLeZ:
-		case IROp::ExitToPC:
+		{
+			static const CCFlags skipConds[] = { CC_LE, CC_L, CC_GE, CC_G };
+			MapIn(inst.src1);
+			CMP(32, GPR(inst.src1), Imm8(0));
+			CompileCondExit(skipConds[(int)inst.op - (int)IROp::ExitToConstIfGtZ], inst.constant);
+			break;
+		}
 
-			// Utilities
-		case IROp::Downcount:
-		case IROp::SetPC:
-		case IROp::SetPCConst:
-		case IROp::Syscall:
-		case IROp::Interpret:  // SLOW fallback. Can be made faster.
-		case IROp::CallReplacement:
-		case IROp::Break:
 		default:
+			CompileGPRArith(inst);
 			break;
-			}
 		}
+
+		ReleaseEnding(i);
 	}
 
+	// Blocks always end in an exit, so we should never get here.
+	INT3();
+
+	EndWrite();
+	return start;
+}
 
 }  // namespace
 
-#endif // PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
+#endif // PPSSPP_ARCH(AMD64)
@@ -1,23 +1,72 @@
+#pragma once
+
+#include <vector>
+
+#include "ppsspp_config.h"
 #include "Core/MIPS/IR/IRInst.h"
+#if PPSSPP_ARCH(AMD64)
 #include "Common/x64Emitter.h"
+#endif
+
+class MIPSState;
 
 namespace MIPSComp {
 
+// Native code produced from IR.  Takes the MIPS context and returns the new PC, exactly like IRInterpret.
+typedef u32 (*IRNativeFunc)(MIPSState *mips);
+
 class IRToNativeInterface {
 public:
 	virtual ~IRToNativeInterface() {}
 
-	virtual void ConvertIRToNative(const IRInst *instructions, int count, const u32 *constants) = 0;
+	// Returns nullptr if the block can't be compiled, for example when the code space is full.
+	virtual const u8 *ConvertIRToNative(const IRInst *instructions, int count) = 0;
+	virtual void ClearNativeCode() = 0;
+	virtual bool CodeInRange(const u8 *ptr) const = 0;
+
+	static u32 RunNative(const u8 *entry, MIPSState *mips) {
+		return ((IRNativeFunc)entry)(mips);
+	}
 };
 
+#if PPSSPP_ARCH(AMD64)
 
-class IRToX86 : public IRToNativeInterface {
+class IRToX86 : public Gen::XCodeBlock, public IRToNativeInterface {
 public:
-	void SetCodeBlock(Gen::XCodeBlock *code) { code_ = code; }
-	virtual void ConvertIRToNative(const IRInst *instructions, int count, const u32 *constants) override;
+	IRToX86();
+
+	const u8 *ConvertIRToNative(const IRInst *instructions, int count) override;
+	void ClearNativeCode() override;
+	bool CodeInRange(const u8 *ptr) const override {
+		return IsInSpace(ptr);
+	}
 
 private:
-	Gen::XCodeBlock *code_;
+	// Per block register allocation, see AllocateRegs().
+	void AllocateRegs(const IRInst *instructions, int count);
+	Gen::OpArg GPR(int reg) const;
+	void MapIn(int reg);
+	void MapOut(int reg);
+	void ReleaseEnding(int index);
+	void StoreDirty();
+	void ReloadLive(int index);
+
+	void CompileFallback(const IRInst &inst, int index);
+	void CompileExit(Gen::OpArg pc);
+	void CompileCondExit(Gen::CCFlags skipCond, u32 pc);
+	void WriteEpilogue();
+
+	bool CompileGPRArith(const IRInst &inst);
+	bool CompileLoadStore(const IRInst &inst);
+
+	// Indexed by IR register.  The whole live interval of an IR register shares one host register.
+	Gen::X64Reg host_[256];
+	int end_[256];
+	bool live_[256];
+	bool dirty_[256];
+	std::vector<std::vector<u8>> endsAt_;
 };
 
+#endif
+
 }  // namespace
@@ -19,6 +19,7 @@
 #if PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
 
 #include <algorithm>
+#include <cstring>
 #include <iterator>
 
 #include "Common/Math/math_util.h"
@@ -113,6 +114,9 @@ Jit::Jit(MIPSState *mipsState)
 	fpr.SetEmitter(this);
 	AllocCodeSpace(1024 * 1024 * 16);
 	GenerateFixedCode(jo);
+	ResetCodeSegments();
+	mips_->returnStackFallback = dispatcher;
+	mips_->ClearReturnStack();
 
 	safeMemFuncs.Init(&thunks);
 
@@ -213,6 +217,33 @@ void Jit::ClearCache()
 	blocks.Clear();
 	ClearCodeSpace(0);
 	GenerateFixedCode(jo);
+	ResetCodeSegments();
+	mips_->returnStackFallback = dispatcher;
+	mips_->ClearReturnStack();
+}
+
+void Jit::ResetCodeSegments() {
+	// Keep the segments on page boundaries, so their protection can change separately.
+	const uintptr_t SEGMENT_ALIGN = 0x10000;
+	const u8 *start = (const u8 *)(((uintptr_t)GetCodePtr() + SEGMENT_ALIGN - 1) & ~(SEGMENT_ALIGN - 1));
+	codeSegmentSize_ = (size_t)((region + region_size - start) / JIT_CODE_SEGMENTS) & ~(SEGMENT_ALIGN - 1);
+	codeSegmentsStart_ = start;
+	codeSegmentEnd_ = start + codeSegmentSize_;
+	codeSegment_ = 0;
+	SetCodePtr((u8 *)start);
+}
+
+void Jit::MoveToNextCodeSegment() {
+	codeSegment_ = (codeSegment_ + 1) % JIT_CODE_SEGMENTS;
+	u8 *start = (u8 *)codeSegmentsStart_ + codeSegment_ * codeSegmentSize_;
+	codeSegmentEnd_ = start + codeSegmentSize_;
+
+	// The first time around, these are still empty.
+	blocks.EvictCodeRange(start, codeSegmentEnd_);
+	if (NeedsProtectionChanges()) {
+		ProtectMemoryPages(start, codeSegmentSize_, MEM_PROT_READ | MEM_PROT_WRITE);
+	}
+	SetCodePtr(start);
 }
 
 void Jit::SaveFlags() {
@@ -271,8 +302,10 @@ void Jit::EatInstruction(MIPSOpcode op) {
 
 void Jit::Compile(u32 em_address) {
 	PROFILE_THIS_SCOPE("jitc");
-	if (GetSpaceLeft() < 0x10000 || blocks.IsFull()) {
+	if (blocks.IsFull()) {
 		ClearCache();
+	} else if (GetCodeSegmentSpaceLeft() < 0x10000) {
+		MoveToNextCodeSegment();
 	}
 
 	if (!Memory::IsValidAddress(em_address)) {
@@ -351,6 +384,17 @@ const u8 *Jit::DoJit(u32 em_address, JitBlock *b) {
 
 	b->normalEntry = GetCodePtr();
 
+	if (jitBlockProfiling) {
+		u64 *counter = blocks.GetExecCounter(b);
+#if PPSSPP_ARCH(AMD64)
+		MOV(PTRBITS, R(RAX), ImmPtr(counter));
+		ADD(64, MatR(RAX), Imm8(1));
+#else
+		ADD(32, M(counter), Imm8(1));
+		ADC(32, M((u32 *)counter + 1), Imm8(0));
+#endif
+	}
+
 	MIPSAnalyst::AnalysisResults analysis = MIPSAnalyst::Analyze(em_address);
 
 	gpr.Start(mips_, &js, &jo, analysis);
@@ -405,7 +449,7 @@ const u8 *Jit::DoJit(u32 em_address, JitBlock *b) {
 		}
 
 		// Safety check, in case we get a bunch of really large jit ops without a lot of branching.
-		if (GetSpaceLeft() < 0x800 || js.numInstructions >= JitBlockCache::MAX_BLOCK_INSTRUCTIONS) {
+		if (GetCodeSegmentSpaceLeft() < 0x800 || js.numInstructions >= JitBlockCache::MAX_BLOCK_INSTRUCTIONS) {
 			FlushAll();
 			WriteExit(GetCompilerPC(), js.nextExit++);
 			js.compiling = false;
@@ -525,6 +569,33 @@ void Jit::UnlinkBlock(u8 *checkedEntry, u32 originalAddress) {
 	}
 }
 
+const u8 *Jit::GetLinkedExitTarget(const u8 *exitPoint) {
+	// Linked exits are a JMP rel32, unlinked ones start with the MOV to pc.
+	if (exitPoint[0] != 0xE9)
+		return nullptr;
+	s32 rel;
+	memcpy(&rel, exitPoint + 1, sizeof(rel));
+	return GetCodePtrFromWritablePtr((u8 *)exitPoint) + 5 + rel;
+}
+
+void Jit::UnlinkExit(u8 *exitPoint, u32 destination) {
+	if (PlatformIsWXExclusive()) {
+		ProtectMemoryPages(exitPoint, 32, MEM_PROT_READ | MEM_PROT_WRITE);
+	}
+	// Same as an exit that was never linked.
+	XEmitter emit(exitPoint);
+	emit.MOV(32, MIPSSTATE_VAR(pc), Imm32(destination));
+	emit.JMP(dispatcher, true);
+	ptrdiff_t actualSize = emit.GetWritableCodePtr() - exitPoint;
+	int pad = JitBlockCache::GetBlockExitSize() - (int)actualSize;
+	for (int i = 0; i < pad; ++i) {
+		emit.INT3();
+	}
+	if (PlatformIsWXExclusive()) {
+		ProtectMemoryPages(exitPoint, 32, MEM_PROT_READ | MEM_PROT_EXEC);
+	}
+}
+
 bool Jit::ReplaceJalTo(u32 dest) {
 	const ReplacementTableEntry *entry = nullptr;
 	u32 funcSize = 0;
@@ -710,14 +781,14 @@ void Jit::WriteExit(u32 destination, int exit_num) {
 		// No blocklinking.
 		MOV(32, MIPSSTATE_VAR(pc), Imm32(destination));
 		JMP(dispatcher, true);
+	}
 
-		// Normally, exits are 15 bytes (MOV + &pc + dest + JMP + dest) on 64 or 32 bit.
-		// But just in case we somehow optimized, pad.
-		ptrdiff_t actualSize = GetWritableCodePtr() - b->exitPtrs[exit_num];
-		int pad = JitBlockCache::GetBlockExitSize() - (int)actualSize;
-		for (int i = 0; i < pad; ++i) {
-			INT3();
-		}
+	// Normally, exits are 15 bytes (MOV + &pc + dest + JMP + dest) on 64 or 32 bit.
+	// But just in case we somehow optimized, pad. Linked ones too, so UnlinkExit has room.
+	ptrdiff_t actualSize = GetWritableCodePtr() - b->exitPtrs[exit_num];
+	int pad = JitBlockCache::GetBlockExitSize() - (int)actualSize;
+	for (int i = 0; i < pad; ++i) {
+		INT3();
 	}
 }
 
@@ -780,6 +851,88 @@ void Jit::WriteExitDestInReg(X64Reg reg) {
 	}
 }
 
+// Picks two of EAX, ECX, EDX (free after FlushAll) that aren't keepReg.
+static void PickReturnStackTemps(X64Reg keepReg, X64Reg &temp1, X64Reg &temp2) {
+	static const X64Reg temps[] = { EAX, ECX, EDX };
+	int found = 0;
+	for (X64Reg reg : temps) {
+		if (reg == keepReg)
+			continue;
+		(found++ == 0 ? temp1 : temp2) = reg;
+		if (found == 2)
+			break;
+	}
+}
+
+void Jit::WriteReturnStackPush(u32 returnAddress, X64Reg keepReg) {
+#if PPSSPP_ARCH(AMD64)
+	using namespace X64JitConstants;
+	static_assert(sizeof(MIPSState::ReturnStackEntry) == 16, "Entries are indexed with a shift");
+	if (!jo.enableBlocklink)
+		return;
+
+	X64Reg temp1, temp2;
+	PickReturnStackTemps(keepReg, temp1, temp2);
+	const int stackOffset = (int)(offsetof(MIPSState, returnStack) - offsetof(MIPSState, f[0]));
+
+	// Only push once the return address has been compiled. Look it up the same way the dispatcher does.
+	u32 fetchAddress = returnAddress;
+#ifdef MASKED_PSP_MEMORY
+	fetchAddress &= Memory::MEMVIEW32_MASK;
+#endif
+	MOV(32, R(temp1), Imm32(fetchAddress));
+	MOV(32, R(temp1), MComplex(MEMBASEREG, temp1, SCALE_1, 0));
+	MOV(32, R(temp2), R(temp1));
+	SHR(32, R(temp2), Imm8(24));
+	CMP(32, R(temp2), Imm8(MIPS_EMUHACK_OPCODE >> 24));
+	FixupBranch notCompiled = J_CC(CC_NE);
+	AND(32, R(temp1), Imm32(MIPS_EMUHACK_VALUE_MASK));
+	if (jo.reserveR15ForAsm)
+		ADD(64, R(temp1), R(JITBASEREG));
+	else
+		ADD(64, R(temp1), Imm32((u32)(uintptr_t)GetBasePtr()));
+
+	MOV(32, R(temp2), MIPSSTATE_VAR(returnStackTop));
+	ADD(32, R(temp2), Imm8(1));
+	AND(32, R(temp2), Imm8(MIPSState::RETURN_STACK_SIZE - 1));
+	MOV(32, MIPSSTATE_VAR(returnStackTop), R(temp2));
+	SHL(32, R(temp2), Imm8(4));
+	MOV(32, MComplex(CTXREG, temp2, SCALE_1, stackOffset + (int)offsetof(MIPSState::ReturnStackEntry, address)), Imm32(returnAddress));
+	MOV(64, MComplex(CTXREG, temp2, SCALE_1, stackOffset + (int)offsetof(MIPSState::ReturnStackEntry, code)), R(temp1));
+	SetJumpTarget(notCompiled);
+#endif
+}
+
+void Jit::WriteReturnStackJump(X64Reg reg) {
+#if PPSSPP_ARCH(AMD64)
+	using namespace X64JitConstants;
+	// If coreState needs checking, leave it to WriteExitDestInReg.
+	if (!jo.enableBlocklink || (js.afterOp & (JitState::AFTER_CORE_STATE | JitState::AFTER_REWIND_PC_BAD_STATE)))
+		return;
+
+	X64Reg temp1, temp2;
+	PickReturnStackTemps(reg, temp1, temp2);
+	const int stackOffset = (int)(offsetof(MIPSState, returnStack) - offsetof(MIPSState, f[0]));
+
+	MOV(32, R(temp1), MIPSSTATE_VAR(returnStackTop));
+	MOV(32, R(temp2), R(temp1));
+	SHL(32, R(temp2), Imm8(4));
+	CMP(32, R(reg), MComplex(CTXREG, temp2, SCALE_1, stackOffset + (int)offsetof(MIPSState::ReturnStackEntry, address)));
+	FixupBranch mismatch = J_CC(CC_NE);
+
+	SUB(32, R(temp1), Imm8(1));
+	AND(32, R(temp1), Imm8(MIPSState::RETURN_STACK_SIZE - 1));
+	MOV(32, MIPSSTATE_VAR(returnStackTop), R(temp1));
+	MOV(32, MIPSSTATE_VAR(pc), R(reg));
+	WriteDowncount();
+	// The code is a normal entry, so the dispatcher has to take care of an expired downcount.
+	J_CC(CC_S, dispatcher, true);
+	JMPptr(MComplex(CTXREG, temp2, SCALE_1, stackOffset + (int)offsetof(MIPSState::ReturnStackEntry, code)));
+
+	SetJumpTarget(mismatch);
+#endif
+}
+
 void Jit::WriteSyscallExit() {
 	WriteDowncount();
 	if (js.afterOp & JitState::AFTER_MEMCHECK_CLEANUP) {
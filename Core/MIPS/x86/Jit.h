@@ -178,9 +178,16 @@ class Jit : public Gen::XCodeBlock, public JitInterface, public MIPSFrontendInte
 
 	void LinkBlock(u8 *exitPoint, const u8 *checkedEntry) override;
 	void UnlinkBlock(u8 *checkedEntry, u32 originalAddress) override;
+	const u8 *GetLinkedExitTarget(const u8 *exitPoint) override;
+	void UnlinkExit(u8 *exitPoint, u32 destination) override;
 
 private:
 	void GenerateFixedCode(JitOptions &jo);
+	void ResetCodeSegments();
+	void MoveToNextCodeSegment();
+	size_t GetCodeSegmentSpaceLeft() const {
+		return codeSegmentEnd_ - GetCodePtr();
+	}
 	void GetStateAndFlushAll(RegCacheState &state);
 	void RestoreState(const RegCacheState& state);
 	void FlushAll();
@@ -200,6 +207,9 @@ class Jit : public Gen::XCodeBlock, public JitInterface, public MIPSFrontendInte
 
 	void WriteExit(u32 destination, int exit_num);
 	void WriteExitDestInReg(Gen::X64Reg reg);
+	// See MIPSState::returnStack. Both only emit anything on x64, when block linking is on.
+	void WriteReturnStackPush(u32 returnAddress, Gen::X64Reg keepReg);
+	void WriteReturnStackJump(Gen::X64Reg reg);
 
 //	void WriteRfiExitDestInEAX();
 	void WriteSyscallExit();
@@ -239,6 +249,8 @@ class Jit : public Gen::XCodeBlock, public JitInterface, public MIPSFrontendInte
 	void CompFPTriArith(MIPSOpcode op, void (XEmitter::*arith)(Gen::X64Reg reg, Gen::OpArg), bool orderMatters);
 	void CompFPComp(int lhs, int rhs, u8 compare, bool allowNaN = false);
 	void CompVrotShuffle(u8 *dregs, int imm, int n, bool negSin);
+	// Copies the single float in src to all four lanes of dest.
+	void CompVBroadcast(Gen::X64Reg dest, const Gen::OpArg &src);
 
 	void CallProtectedFunction(const void *func, const Gen::OpArg &arg1);
 	void CallProtectedFunction(const void *func, const Gen::OpArg &arg1, const Gen::OpArg &arg2);
@@ -307,6 +319,13 @@ class Jit : public Gen::XCodeBlock, public JitInterface, public MIPSFrontendInte
 	JitOptions jo;
 	JitState js;
 
+	// Blocks are written to the segments in turn. Once they've all been used, the oldest one is
+	// evicted to make room, instead of clearing the whole cache.
+	const u8 *codeSegmentsStart_ = nullptr;
+	const u8 *codeSegmentEnd_ = nullptr;
+	size_t codeSegmentSize_ = 0;
+	int codeSegment_ = 0;
+
 	GPRRegCache gpr;
 	FPURegCache fpr;
 
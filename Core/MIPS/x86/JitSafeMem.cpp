@@ -347,6 +347,9 @@ void JitSafeMem::Finish()
 }
 
 void JitSafeMem::MemCheckImm(MemoryOpType type) {
+	if (!CBreakPoints::HasJitMemChecks())
+		return;
+
 	MemCheck check;
 	if (CBreakPoints::GetMemCheckInRange(iaddr_, size_, &check)) {
 		if (!(check.cond & MEMCHECK_READ) && type == MEM_READ)
@@ -374,6 +377,9 @@ void JitSafeMem::MemCheckImm(MemoryOpType type) {
 
 void JitSafeMem::MemCheckAsm(MemoryOpType type)
 {
+	if (!CBreakPoints::HasJitMemChecks())
+		return;
+
 	const auto memchecks = CBreakPoints::GetMemCheckRanges(type == MEM_WRITE);
 	bool possible = !memchecks.empty();
 	for (auto it = memchecks.begin(), end = memchecks.end(); it != end; ++it)
@@ -17,9 +17,14 @@
 
 #include "ppsspp_config.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstring>
+#include <map>
 #include <unordered_set>
 #include <mutex>
+#include <thread>
 
 #include "Common/MachineContext.h"
 
@@ -32,12 +37,20 @@
 #include "ext/disarm.h"
 #endif
 
+#include "Common/Common.h"
 #include "Common/Log.h"
+#include "Common/MemoryUtil.h"
 #include "Core/Core.h"
+#include "Core/Debugger/Breakpoints.h"
 #include "Core/MemFault.h"
 #include "Core/MemMap.h"
+#include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 
+#if defined(MACHINE_CONTEXT_SUPPORTED) && !defined(MASKED_PSP_MEMORY)
+#define MEMFAULT_WATCH_SUPPORTED
+#endif
+
 namespace Memory {
 
 static int64_t g_numReportedBadAccesses = 0;
@@ -46,11 +59,193 @@ MemoryExceptionType g_lastMemoryExceptionType;
 
 std::unordered_set<const uint8_t *> g_ignoredAddresses;
 
+#ifdef MEMFAULT_WATCH_SUPPORTED
+
+// RAM is mapped at each of these, and every mirror needs protecting.
+static const uint32_t g_ramMirrors[] = { 0x08000000, 0x48000000, 0x88000000, 0xC0000000 };
+
+struct WatchedPage {
+	uint32_t offset;  // From the start of RAM.
+	bool read;
+};
+
+struct WatchHit {
+	uint32_t addr;
+	uint32_t pc;
+	int size;
+	int compareSize;
+	bool write;
+	bool onChangeOnly;
+	uint8_t before[16];
+};
+
+static std::mutex g_watchLock;
+static std::vector<MemFaultWatch> g_watches;
+static std::vector<WatchedPage> g_watchedPages;
+// Pages let through after a fault, until the next MemFault_ProcessWatches().
+static std::vector<uint32_t> g_openPages;
+// Fixed size, since this is filled from the fault handler.
+static WatchHit g_watchHits[64];
+static int g_numWatchHits;
+static std::atomic<bool> g_watchesChanged;
+static std::atomic<bool> g_watchesPending;
+static std::atomic<bool> g_watchesArmed;
+static bool g_processingWatches;
+static std::thread::id g_watchThread;
+
+static bool RAMOffset(uint32_t guestAddress, uint32_t ramSize, uint32_t *offset) {
+	for (uint32_t mirror : g_ramMirrors) {
+		if (guestAddress - mirror < ramSize) {
+			*offset = guestAddress - mirror;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool WatchOffsets(const MemFaultWatch &watch, uint32_t ramSize, uint32_t *first, uint32_t *last) {
+	// An end of 0 means just the one address, same as MemCheck.
+	uint32_t end = watch.end == 0 ? watch.start + 1 : watch.end;
+	if (end <= watch.start)
+		return false;
+	return RAMOffset(watch.start, ramSize, first) && RAMOffset(end - 1, ramSize, last) && *first <= *last;
+}
+
+static void ProtectRAMPage(uint32_t offset, uint32_t flags) {
+	size_t pageSize = GetMemoryProtectPageSize();
+	for (uint32_t mirror : g_ramMirrors)
+		ProtectMemoryPages(base + mirror + offset, pageSize, flags);
+}
+
+static uint32_t WatchedPageFlags(const WatchedPage &page) {
+	// Pages with only write watches stay readable, so reads run at full speed.
+	return page.read ? 0 : MEM_PROT_READ;
+}
+
+static WatchedPage *FindWatchedPage(uint32_t pageOffset) {
+	auto page = std::lower_bound(g_watchedPages.begin(), g_watchedPages.end(), pageOffset, [](const WatchedPage &p, uint32_t offset) {
+		return p.offset < offset;
+	});
+	if (page == g_watchedPages.end() || page->offset != pageOffset)
+		return nullptr;
+	return &*page;
+}
+
+static void RebuildWatchedPages() {
+	for (const WatchedPage &page : g_watchedPages)
+		ProtectRAMPage(page.offset, MEM_PROT_READ | MEM_PROT_WRITE);
+	g_watchedPages.clear();
+	g_openPages.clear();
+
+	const uint32_t pageSize = (uint32_t)GetMemoryProtectPageSize();
+	std::map<uint32_t, bool> pages;
+	for (const MemFaultWatch &watch : g_watches) {
+		uint32_t first, last;
+		if ((!watch.read && !watch.write) || !WatchOffsets(watch, g_MemorySize, &first, &last))
+			continue;
+		for (uint32_t offset = first & ~(pageSize - 1); offset <= last; offset += pageSize) {
+			bool &read = pages[offset];
+			read = read || watch.read;
+		}
+	}
+
+	for (const auto &it : pages) {
+		WatchedPage page{ it.first, it.second };
+		g_watchedPages.push_back(page);
+		ProtectRAMPage(page.offset, WatchedPageFlags(page));
+	}
+}
+
+bool MemFault_SetWatches(const std::vector<MemFaultWatch> &watches) {
+	bool supported = true;
+	for (const MemFaultWatch &watch : watches) {
+		// Scratchpad and VRAM aren't handled, those still need checks on each access.
+		uint32_t first, last;
+		if (!WatchOffsets(watch, RAM_DOUBLE_SIZE, &first, &last))
+			supported = false;
+	}
+
+	std::lock_guard<std::mutex> guard(g_watchLock);
+	if (supported)
+		g_watches = watches;
+	else
+		g_watches.clear();
+	// The pages are protected from the CPU thread, once emulation is running with the handler installed.
+	g_watchesChanged = true;
+	return supported;
+}
+
+void MemFault_ProcessWatches() {
+	if (!g_watchesChanged && !g_watchesPending)
+		return;
+
+	WatchHit hits[ARRAY_SIZE(g_watchHits)];
+	bool changed[ARRAY_SIZE(g_watchHits)];
+	int numHits;
+	{
+		std::lock_guard<std::mutex> guard(g_watchLock);
+		numHits = g_numWatchHits;
+		g_numWatchHits = 0;
+		for (int i = 0; i < numHits; ++i) {
+			hits[i] = g_watchHits[i];
+			// The page is still open, so this can't fault.
+			changed[i] = memcmp(base + hits[i].addr, hits[i].before, hits[i].compareSize) != 0;
+		}
+	}
+
+	// Anything these touch (like a log format reading memory) shouldn't count as a hit.
+	g_processingWatches = true;
+	for (int i = 0; i < numHits; ++i) {
+		const WatchHit &hit = hits[i];
+		if (hit.write && hit.onChangeOnly && !changed[i])
+			continue;
+		CBreakPoints::ExecMemCheck(hit.addr, hit.write, hit.size, hit.pc, "CPU");
+	}
+	g_processingWatches = false;
+
+	std::lock_guard<std::mutex> guard(g_watchLock);
+	if (g_watchesChanged) {
+		RebuildWatchedPages();
+		g_watchesChanged = false;
+	} else {
+		for (uint32_t offset : g_openPages) {
+			const WatchedPage *page = FindWatchedPage(offset);
+			if (page)
+				ProtectRAMPage(page->offset, WatchedPageFlags(*page));
+		}
+		g_openPages.clear();
+	}
+	g_watchThread = std::this_thread::get_id();
+	g_watchesArmed = !g_watchedPages.empty();
+	g_watchesPending = g_numWatchHits != 0;
+}
+
+#else
+
+bool MemFault_SetWatches(const std::vector<MemFaultWatch> &watches) {
+	return false;
+}
+
+void MemFault_ProcessWatches() {
+}
+
+#endif
+
 void MemFault_Init() {
 	g_numReportedBadAccesses = 0;
 	g_lastCrashAddress = nullptr;
 	g_lastMemoryExceptionType = MemoryExceptionType::NONE;
 	g_ignoredAddresses.clear();
+
+#ifdef MEMFAULT_WATCH_SUPPORTED
+	// Memory was just mapped again, so nothing is protected yet.
+	std::lock_guard<std::mutex> guard(g_watchLock);
+	g_watchesArmed = false;
+	g_watchedPages.clear();
+	g_openPages.clear();
+	g_numWatchHits = 0;
+	g_watchesChanged = true;
+#endif
 }
 
 bool MemFault_MayBeResumable() {
@@ -86,10 +281,98 @@ static bool DisassembleNativeAt(const uint8_t *codePtr, int instructionSize, std
 	return false;
 }
 
+#ifdef MEMFAULT_WATCH_SUPPORTED
+static void AnalyzeWatchedAccess(const uint8_t *codePtr, bool *write, int *size) {
+#if PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(X86)
+	LSInstructionInfo info{};
+	if (X86AnalyzeMOV(codePtr, info)) {
+		*write = info.isMemoryWrite;
+		*size = info.operandSize;
+	}
+#elif PPSSPP_ARCH(ARM64)
+	uint32_t word;
+	memcpy(&word, codePtr, 4);
+	Arm64LSInstructionInfo info{};
+	if (Arm64AnalyzeLoadStore((uint64_t)codePtr, word, &info)) {
+		*write = info.isMemoryWrite;
+		*size = (1 << info.size) * (info.isPairLoadStore ? 2 : 1);
+	}
+#endif
+}
+
+// Handles faults on pages protected for memchecks, from the JIT or anywhere else (HLE, DMA.)
+static bool HandleWatchFault(uintptr_t hostAddress, const uint8_t *codePtr) {
+	if (!g_watchesArmed)
+		return false;
+
+	uintptr_t baseAddress = (uintptr_t)base;
+	if (hostAddress < baseAddress || hostAddress >= baseAddress + 0x100000000ULL)
+		return false;
+	uint32_t guestAddress = (uint32_t)(hostAddress - baseAddress);
+	uint32_t offset;
+	if (!RAMOffset(guestAddress, g_MemorySize, &offset))
+		return false;
+
+	std::lock_guard<std::mutex> guard(g_watchLock);
+	const uint32_t pageSize = (uint32_t)GetMemoryProtectPageSize();
+	const uint32_t pageOffset = offset & ~(pageSize - 1);
+	const WatchedPage *page = FindWatchedPage(pageOffset);
+	if (!page)
+		return false;
+
+	// A fault on a page that's still readable can only be a write.
+	bool write = !page->read;
+	int size = 1;
+	AnalyzeWatchedAccess(codePtr, &write, &size);
+
+	// Let this access, and others to the same page, through until the next MemFault_ProcessWatches().
+	// That's when the hits are reported, too, since it's not safe to pause from in here.
+	ProtectRAMPage(pageOffset, MEM_PROT_READ | MEM_PROT_WRITE);
+	if (std::find(g_openPages.begin(), g_openPages.end(), pageOffset) == g_openPages.end())
+		g_openPages.push_back(pageOffset);
+	g_watchesPending = true;
+
+	// Only the CPU thread counts, not the debugger UI peeking at memory, for example.
+	if (g_processingWatches || std::this_thread::get_id() != g_watchThread)
+		return true;
+
+	// The page may hold other data too, so check it's in a watched range.
+	bool hit = false;
+	bool onChangeOnly = true;
+	for (const MemFaultWatch &watch : g_watches) {
+		uint32_t first, last;
+		if (!(write ? watch.write : watch.read) || !WatchOffsets(watch, g_MemorySize, &first, &last))
+			continue;
+		if (offset + size > first && offset <= last) {
+			hit = true;
+			onChangeOnly = onChangeOnly && watch.onChange;
+		}
+	}
+	if (!hit || g_numWatchHits >= (int)ARRAY_SIZE(g_watchHits))
+		return true;
+
+	WatchHit &watchHit = g_watchHits[g_numWatchHits++];
+	watchHit.addr = guestAddress;
+	watchHit.pc = currentMIPS->pc;
+	watchHit.size = size;
+	watchHit.write = write;
+	watchHit.onChangeOnly = onChangeOnly;
+	// Stay within the page we just opened.
+	watchHit.compareSize = std::min(std::min(size, (int)sizeof(watchHit.before)), (int)(pageOffset + pageSize - offset));
+	memcpy(watchHit.before, base + guestAddress, watchHit.compareSize);
+	return true;
+}
+#endif
+
 bool HandleFault(uintptr_t hostAddress, void *ctx) {
 	SContext *context = (SContext *)ctx;
 	const uint8_t *codePtr = (uint8_t *)(context->CTX_PC);
 
+#ifdef MEMFAULT_WATCH_SUPPORTED
+	if (HandleWatchFault(hostAddress, codePtr))
+		return true;
+#endif
+
 	std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
 
 	// We set this later if we think it can be resumed from.
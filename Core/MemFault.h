@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
 namespace Memory {
 
@@ -14,6 +15,21 @@ void MemFault_Init();
 bool MemFault_MayBeResumable();
 void MemFault_IgnoreLastCrash();
 
+struct MemFaultWatch {
+	uint32_t start;
+	uint32_t end;
+	bool read;
+	bool write;
+	bool onChange;
+};
+
+// Watches ranges of RAM by protecting the host pages that hold them, so accesses to them
+// fault into HandleFault and everything else runs at full speed.  Returns false if that
+// can't be done here (or for these ranges), then accesses need to be checked some other way.
+bool MemFault_SetWatches(const std::vector<MemFaultWatch> &watches);
+// Reports watch hits to CBreakPoints and protects the pages again.  Must be on the CPU thread.
+void MemFault_ProcessWatches();
+
 // Called by exception handlers. We simply filter out accesses to PSP RAM and otherwise
 // just leave it as-is.
 bool HandleFault(uintptr_t hostAddress, void *context);
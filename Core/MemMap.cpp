@@ -278,9 +278,10 @@ void MemoryMap_Shutdown(u32 flags) {
 #endif
 }
 
+// On some 32 bit platforms (like Android, iOS, etc.), you can only map < 32 megs at a time.
+static const int MAX_MMAP_SIZE = 31 * 1024 * 1024;
+
 bool Init() {
-	// On some 32 bit platforms (like Android, iOS, etc.), you can only map < 32 megs at a time.
-	const static int MAX_MMAP_SIZE = 31 * 1024 * 1024;
 	_dbg_assert_msg_(g_MemorySize <= MAX_MMAP_SIZE * 3, "ACK - too much memory for three mmap views.");
 	for (size_t i = 0; i < ARRAY_SIZE(views); i++) {
 		if (views[i].flags & MV_IS_PRIMARY_RAM)
@@ -319,6 +320,10 @@ static void DoMemoryVoid(PointerWrap &p, uint32_t start, uint32_t size) {
 	if ((size & 0x3F) != 0 || ((uintptr_t)d & 0x3F) != 0)
 		return p.DoVoid(d, size);
 
+	// When saving to a file, this is compressed straight from memory.
+	if (p.gather && (p.mode == PointerWrap::MODE_WRITE || p.mode == PointerWrap::MODE_MEASURE))
+		return p.DoExternalVoid(d, size);
+
 	switch (p.mode) {
 	case PointerWrap::MODE_READ:
 		ParallelMemcpy(&g_threadManager, d, storage, size);
@@ -339,7 +344,7 @@ static void DoMemoryVoid(PointerWrap &p, uint32_t start, uint32_t size) {
 	storage += size;
 }
 
-void DoState(PointerWrap &p) {
+void DoState(PointerWrap &p, bool includeRamAndVram) {
 	auto s = p.Section("Memory", 1, 3);
 	if (!s)
 		return;
@@ -371,20 +376,170 @@ void DoState(PointerWrap &p) {
 		}
 	}
 
-	DoMemoryVoid(p, PSP_GetKernelMemoryBase(), g_MemorySize);
-	p.DoMarker("RAM");
+	if (includeRamAndVram) {
+		DoMemoryVoid(p, PSP_GetKernelMemoryBase(), g_MemorySize);
+		p.DoMarker("RAM");
 
-	DoMemoryVoid(p, PSP_GetVidMemBase(), VRAM_SIZE);
-	p.DoMarker("VRAM");
+		DoMemoryVoid(p, PSP_GetVidMemBase(), VRAM_SIZE);
+		p.DoMarker("VRAM");
+	}
 	DoArray(p, m_pPhysicalScratchPad, SCRATCHPAD_SIZE);
 	p.DoMarker("ScratchPad");
 }
 
+// The kernel side bits are shared by the whole process, so each tracker keeps the pages that were
+// written but reset by another tracker before it looked.  Page granular, RAM and then VRAM.
+static std::mutex g_dirtyLock;
+static bool g_dirtyActive[(int)DirtyTracker::COUNT];
+static std::vector<u8> g_dirtyCarry[(int)DirtyTracker::COUNT];
+
+u32 DirtyTrackingPageCount() {
+	const u32 pageSize = (u32)GetMemoryProtectPageSize();
+	return (g_MemorySize + pageSize - 1) / pageSize + VRAM_SIZE / pageSize;
+}
+
+int DirtyTrackingPage(u32 address) {
+	const u32 pageSize = (u32)GetMemoryProtectPageSize();
+	const u32 physical = address & 0x3FFFFFFF;
+	if (physical >= PSP_GetKernelMemoryBase() && physical < PSP_GetKernelMemoryBase() + g_MemorySize)
+		return (physical - PSP_GetKernelMemoryBase()) / pageSize;
+	if (physical >= PSP_GetVidMemBase() && physical < PSP_GetVidMemEnd())
+		return (g_MemorySize + pageSize - 1) / pageSize + (physical & (VRAM_SIZE - 1)) / pageSize;
+	return -1;
+}
+
+// Reads the kernel bits for the pages set in wanted (or all pages), ORing them into dirty.
+static bool ReadDirtyPages(std::vector<u8> &dirty, const std::vector<u8> *wanted) {
+	const u32 pageSize = (u32)GetMemoryProtectPageSize();
+	const u32 ramPages = (g_MemorySize + pageSize - 1) / pageSize;
+	const u32 totalPages = DirtyTrackingPageCount();
+	dirty.resize(totalPages, 0);
+
+	// The tracking is per mapping, so every mirror has to be checked.
+	std::vector<u8> pages;
+	for (const MemoryView &view : views) {
+		if (view.size == 0 || !*view.out_ptr)
+			continue;
+#ifdef MASKED_PSP_MEMORY
+		if (CanIgnoreView(view))
+			continue;
+#endif
+		const u32 physical = view.virtual_address & 0x3FFFFFFF;
+		u32 firstPage, endPage;
+		if (view.flags & (MV_IS_PRIMARY_RAM | MV_IS_EXTRA1_RAM | MV_IS_EXTRA2_RAM)) {
+			// Go by the flags, the uncached kernel mirror's address doesn't mask down to RAM.
+			u32 offset = 0;
+			if (view.flags & MV_IS_EXTRA1_RAM)
+				offset = MAX_MMAP_SIZE;
+			else if (view.flags & MV_IS_EXTRA2_RAM)
+				offset = MAX_MMAP_SIZE * 2;
+			firstPage = offset / pageSize;
+			endPage = std::min(ramPages, firstPage + (view.size + pageSize - 1) / pageSize);
+		} else if (physical >= PSP_GetVidMemBase() && physical < PSP_GetVidMemEnd()) {
+			// All the VRAM views are mirrors of the same 2MB.
+			firstPage = ramPages;
+			endPage = totalPages;
+		} else {
+			continue;
+		}
+
+		// Only read runs of wanted pages, the kernel walks the page tables for each one.
+		for (u32 page = firstPage; page < endPage; ) {
+			if (wanted && !(*wanted)[page]) {
+				++page;
+				continue;
+			}
+			u32 runEnd = page + 1;
+			while (runEnd < endPage && (!wanted || (*wanted)[runEnd]))
+				++runEnd;
+			pages.assign(runEnd - page, 0);
+			const u8 *ptr = *view.out_ptr + (size_t)(page - firstPage) * pageSize;
+			if (!GetDirtyPages(ptr, pages.size() * pageSize, pages.data()))
+				return false;
+			for (size_t i = 0; i < pages.size(); ++i)
+				dirty[page + i] |= pages[i];
+			page = runEnd;
+		}
+	}
+	return true;
+}
+
+bool GetWrittenPages(DirtyTracker who, std::vector<u8> &dirty, const std::vector<u8> *wanted) {
+	std::lock_guard<std::mutex> guard(g_dirtyLock);
+	dirty.assign(DirtyTrackingPageCount(), 0);
+	// Until the first reset, we don't know what happened before.
+	if (!DirtyPageTrackingSupported() || !g_dirtyActive[(int)who])
+		return false;
+	if (!ReadDirtyPages(dirty, wanted))
+		return false;
+
+	const std::vector<u8> &carry = g_dirtyCarry[(int)who];
+	for (size_t i = 0; i < carry.size() && i < dirty.size(); ++i)
+		dirty[i] |= carry[i];
+	return true;
+}
+
+bool GetDirtyBlocks(DirtyTracker who, u32 blockSize, std::vector<u8> &ramDirty, std::vector<u8> &vramDirty) {
+	std::vector<u8> pages;
+	if (!GetWrittenPages(who, pages, nullptr))
+		return false;
+
+	const u32 pageSize = (u32)GetMemoryProtectPageSize();
+	const u32 ramPages = (g_MemorySize + pageSize - 1) / pageSize;
+	ramDirty.assign(g_MemorySize / blockSize, 0);
+	vramDirty.assign(VRAM_SIZE / blockSize, 0);
+	for (size_t i = 0; i < pages.size(); ++i) {
+		if (!pages[i])
+			continue;
+		std::vector<u8> &dirty = i < ramPages ? ramDirty : vramDirty;
+		const u32 pageStart = (u32)(i < ramPages ? i : i - ramPages) * pageSize;
+		const u32 pageEnd = std::min(pageStart + pageSize, (u32)dirty.size() * blockSize);
+		for (u32 pos = pageStart; pos < pageEnd; pos += blockSize)
+			dirty[pos / blockSize] = 1;
+	}
+	return true;
+}
+
+void ResetDirtyTracking(DirtyTracker who) {
+	std::lock_guard<std::mutex> guard(g_dirtyLock);
+	if (!DirtyPageTrackingSupported())
+		return;
+
+	// Hand what's been written so far to the other trackers, before the bits are gone.
+	bool othersActive = false;
+	for (int i = 0; i < (int)DirtyTracker::COUNT; ++i)
+		othersActive = othersActive || (i != (int)who && g_dirtyActive[i]);
+	if (othersActive) {
+		std::vector<u8> pages;
+		bool known = ReadDirtyPages(pages, nullptr);
+		for (int i = 0; i < (int)DirtyTracker::COUNT; ++i) {
+			if (i == (int)who || !g_dirtyActive[i])
+				continue;
+			std::vector<u8> &carry = g_dirtyCarry[i];
+			carry.resize(pages.size(), 0);
+			for (size_t j = 0; j < pages.size(); ++j)
+				carry[j] |= known ? pages[j] : 1;
+		}
+	}
+
+	g_dirtyCarry[(int)who].clear();
+	g_dirtyActive[(int)who] = true;
+	ResetDirtyPageTracking();
+}
+
+void StopDirtyTracking(DirtyTracker who) {
+	std::lock_guard<std::mutex> guard(g_dirtyLock);
+	g_dirtyActive[(int)who] = false;
+	g_dirtyCarry[(int)who].clear();
+}
+
 void Shutdown() {
 	std::lock_guard<std::recursive_mutex> guard(g_shutdownLock);
 	u32 flags = 0;
 	MemoryMap_Shutdown(flags);
 	base = nullptr;
+	for (int i = 0; i < (int)DirtyTracker::COUNT; ++i)
+		StopDirtyTracking((DirtyTracker)i);
 	DEBUG_LOG(MEMMAP, "Memory system shut down.");
 }
 
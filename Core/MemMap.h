@@ -21,6 +21,7 @@
 
 #include <cstring>
 #include <cstdint>
+#include <vector>
 #ifndef offsetof
 #include <stddef.h>
 #endif
@@ -113,8 +114,30 @@ void MemoryMap_Shutdown(u32 flags);
 // Init and Shutdown
 bool Init();
 void Shutdown();
-void DoState(PointerWrap &p);
+// With includeRamAndVram false, only the bookkeeping and scratchpad is saved (rewind keeps those separately.)
+void DoState(PointerWrap &p, bool includeRamAndVram = true);
 void Clear();
+
+// Users of the kernel dirty page tracking.  Each sees the writes since its own last reset.
+enum class DirtyTracker {
+	REWIND,
+	TEXTURES,
+	RUNAHEAD,
+	LIBRETRO_SERIALIZE,
+	COUNT,
+};
+
+// Marks each blockSize piece of RAM and VRAM that may have been written since the last
+// ResetDirtyTracking().  Returns false if that can't be known, then everything must be assumed dirty.
+bool GetDirtyBlocks(DirtyTracker who, u32 blockSize, std::vector<u8> &ramDirty, std::vector<u8> &vramDirty);
+// The same per page, indexed by DirtyTrackingPage().  Only pages set in wanted are checked, if given.
+bool GetWrittenPages(DirtyTracker who, std::vector<u8> &dirty, const std::vector<u8> *wanted);
+// Also starts tracking for who.  Before that, the getters return false.
+void ResetDirtyTracking(DirtyTracker who);
+void StopDirtyTracking(DirtyTracker who);
+// Pages of RAM, then VRAM (mirrors share pages.)  DirtyTrackingPage returns -1 outside of those.
+u32 DirtyTrackingPageCount();
+int DirtyTrackingPage(u32 address);
 // False when shutdown has already been called.
 bool IsActive();
 
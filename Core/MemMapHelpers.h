@@ -62,11 +62,9 @@ inline void Memcpy(const u32 to_address, const u32 from_address, const u32 len,
 		const u8 *from = GetPointer(from_address);
 		if (from) {
 			memcpy(to, from, len);
-			char tagData[128];
 			if (!tag) {
-				const std::string srcTag = GetMemWriteTagAt(from_address, len);
-				tag = tagData;
-				tagLen = snprintf(tagData, sizeof(tagData), "Memcpy/%s", srcTag.c_str());
+				NotifyMemInfoCopy(to_address, from_address, len, "Memcpy");
+				return;
 			}
 			NotifyMemInfo(MemBlockFlags::READ, from_address, len, tag, tagLen);
 			NotifyMemInfo(MemBlockFlags::WRITE, to_address, len, tag, tagLen);
@@ -16,6 +16,8 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include "ppsspp_config.h"
+#include <algorithm>
+#include <atomic>
 #include <deque>
 #include <thread>
 #include <mutex>
@@ -27,7 +29,10 @@
 #include "Core/Reporting.h"
 #include "Common/File/VFS/VFS.h"
 #include "Common/CPUDetect.h"
+#include "Common/Data/Encoding/Compression.h"
+#include "Common/Data/Format/JSONWriter.h"
 #include "Common/File/FileUtil.h"
+#include "Common/Profiler/MemoryUsage.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/StringUtils.h"
 #include "Core/Core.h"
@@ -104,6 +109,26 @@ namespace Reporting
 	static volatile bool crcCancel = false;
 	static std::thread crcThread;
 
+	// Frame times are bucketed per millisecond, the last bucket has everything slower.
+	const int PERF_HISTOGRAM_BUCKETS = 101;
+	// Sessions shorter than this aren't worth keeping (just booted and quit, etc.)
+	const u32 PERF_MIN_FRAMES = 600;
+	// Pending sessions are uploaded this far into a game, rather than at shutdown.
+	const u32 PERF_UPLOAD_FRAMES = 3600;
+	// Stop appending sessions if the uploads keep failing.
+	const uint64_t PERF_MAX_FILE_SIZE = 256 * 1024;
+
+	static bool perfEnabled = false;
+	static std::atomic<int> perfEvents[(int)PerfEvent::COUNT];
+	static u32 perfFrameHistogram[PERF_HISTOGRAM_BUCKETS];
+	static u32 perfFrames = 0;
+	static double perfLastFlip = 0.0;
+	static int perfLastCompiles = 0;
+	static u32 perfStallFrames = 0;
+	static double perfStallTime = 0.0;
+	static int64_t perfTextureCachePeak = 0;
+	static std::thread perfThread;
+
 	static int CalculateCRCThread() {
 		SetCurrentThreadName("ReportCRC");
 
@@ -340,6 +365,8 @@ namespace Reporting
 
 	bool MessageAllowed();
 	void SendReportMessage(const char *message, const char *formatted);
+	static void ResetPerfStats();
+	static void SavePerfSession();
 
 	void Init()
 	{
@@ -350,6 +377,7 @@ namespace Reporting
 		currentSupported = IsSupported();
 		pendingMessagesDone = false;
 		Reporting::SetupCallbacks(&MessageAllowed, &SendReportMessage);
+		ResetPerfStats();
 	}
 
 	void Shutdown()
@@ -362,7 +390,11 @@ namespace Reporting
 			compatThread.join();
 		if (messageThread.joinable())
 			messageThread.join();
+		if (perfThread.joinable())
+			perfThread.join();
 		PurgeCRC();
+		// Only after the upload thread is gone, since it deletes the file.
+		SavePerfSession();
 
 		// Just so it can be enabled in the menu again.
 		Init();
@@ -386,6 +418,7 @@ namespace Reporting
 		currentSupported = IsSupported();
 		if (!currentSupported && PSP_IsInited())
 			everUnsupported = true;
+		perfEnabled = g_Config.bReportPerfStats && IsEnabled();
 	}
 
 	std::string CurrentGameID()
@@ -676,4 +709,107 @@ namespace Reporting
 	std::vector<std::string> CompatibilitySuggestions() {
 		return lastCompatResult;
 	}
+
+	static Path PerfStatsFilename() {
+		return GetSysDirectory(DIRECTORY_SYSTEM) / "perf_stats.jsonl";
+	}
+
+	static void ResetPerfStats() {
+		perfEnabled = g_Config.bReportPerfStats && IsEnabled();
+		for (auto &count : perfEvents)
+			count = 0;
+		memset(perfFrameHistogram, 0, sizeof(perfFrameHistogram));
+		perfFrames = 0;
+		perfLastFlip = 0.0;
+		perfLastCompiles = 0;
+		perfStallFrames = 0;
+		perfStallTime = 0.0;
+		perfTextureCachePeak = 0;
+	}
+
+	void NotePerfEvent(PerfEvent ev) {
+		perfEvents[(int)ev].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static int ProcessPerfUpload() {
+		SetCurrentThreadName("ReportPerf");
+
+		const Path filename = PerfStatsFilename();
+		std::string stats;
+		if (!File::ReadFileToString(false, filename, stats) || stats.empty())
+			return 0;
+		std::string compressed;
+		if (!compress_string(stats, &compressed))
+			return 0;
+
+		// One line per session, the system info is the same for all of them.
+		MultipartFormDataEncoder postdata;
+		AddSystemInfo(postdata);
+		postdata.Add("stats", compressed, "perf_stats.jsonl.z", "application/zlib");
+		postdata.Finish();
+		if (SendReportRequest("/report/perf", postdata.ToString(), postdata.GetMimeType()))
+			File::Delete(filename);
+		return 0;
+	}
+
+	void NotePerfFlip(double now) {
+		if (!perfEnabled)
+			return;
+
+		double frameTime = now - perfLastFlip;
+		int compiles = perfEvents[(int)PerfEvent::SHADER_GENERATED].load(std::memory_order_relaxed) + perfEvents[(int)PerfEvent::PIPELINE_CREATED].load(std::memory_order_relaxed);
+		// Anything over a second is a pause or a load, not a frame.
+		if (perfLastFlip != 0.0 && frameTime < 1.0) {
+			int bucket = std::min((int)(frameTime * 1000.0), PERF_HISTOGRAM_BUCKETS - 1);
+			perfFrameHistogram[bucket]++;
+			perfFrames++;
+
+			// Frames where we had to compile something, to compare against the rest.
+			if (compiles != perfLastCompiles) {
+				perfStallFrames++;
+				perfStallTime += frameTime;
+			}
+			perfTextureCachePeak = std::max(perfTextureCachePeak, MemoryUsage_Get(MemoryCategory::TEXTURE_CACHE));
+
+			// Upload what previous sessions left behind, well into the game so it doesn't compete with loading.
+			if (perfFrames == PERF_UPLOAD_FRAMES && !perfThread.joinable() && File::Exists(PerfStatsFilename()))
+				perfThread = std::thread(ProcessPerfUpload);
+		}
+		perfLastCompiles = compiles;
+		perfLastFlip = now;
+	}
+
+	static void SavePerfSession() {
+		if (!perfEnabled || perfFrames < PERF_MIN_FRAMES)
+			return;
+
+		const Path filename = PerfStatsFilename();
+		if (File::Exists(filename) && File::GetFileSize(filename) > PERF_MAX_FILE_SIZE)
+			return;
+
+		json::JsonWriter writer;
+		writer.begin();
+		writer.writeString("game", CurrentGameID());
+		writer.writeString("version", PPSSPP_GIT_VERSION);
+		writer.writeUint("frames", perfFrames);
+		writer.pushArray("frame_ms");
+		for (u32 count : perfFrameHistogram)
+			writer.writeUint(count);
+		writer.pop();
+		writer.writeInt("jit_clears", perfEvents[(int)PerfEvent::JIT_CACHE_CLEAR]);
+		writer.writeInt("jit_blocks", perfEvents[(int)PerfEvent::JIT_BLOCK_COMPILED]);
+		writer.writeInt("shaders", perfEvents[(int)PerfEvent::SHADER_GENERATED]);
+		writer.writeInt("pipelines", perfEvents[(int)PerfEvent::PIPELINE_CREATED]);
+		writer.writeUint("stall_frames", perfStallFrames);
+		writer.writeFloat("stall_ms", perfStallTime * 1000.0);
+		writer.writeUint("texcache_peak_kb", (u32)(perfTextureCachePeak / 1024));
+		writer.end();
+
+		FILE *f = File::OpenCFile(filename, "ab");
+		if (!f)
+			return;
+		std::string line = writer.str() + "\n";
+		fwrite(line.data(), 1, line.size(), f);
+		fclose(f);
+	}
 }
@@ -83,4 +83,19 @@ namespace Reporting
 
 	// Return the current game id.
 	std::string CurrentGameID();
+
+	// Events counted for the opt-in aggregated performance stats (bReportPerfStats.)
+	enum class PerfEvent {
+		JIT_CACHE_CLEAR,
+		JIT_BLOCK_COMPILED,
+		SHADER_GENERATED,
+		PIPELINE_CREATED,
+
+		COUNT,
+	};
+
+	// Just an atomic increment, safe from any thread.
+	void NotePerfEvent(PerfEvent ev);
+	// Called on each flip, adds the time since the previous one to the frame time histogram.
+	void NotePerfFlip(double now);
 }
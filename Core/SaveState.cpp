@@ -16,11 +16,19 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <algorithm>
+#include <functional>
+#include <memory>
+#include <unordered_set>
 #include <vector>
-#include <thread>
 #include <mutex>
+#include <thread>
+#include <zstd.h>
 
 #include "Common/Data/Text/I18n.h"
+#include "Common/MemoryUtil.h"
+#include "Common/Profiler/MemoryUsage.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Common/Thread/ThreadUtil.h"
 #include "Common/Data/Text/Parsers.h"
 
@@ -89,6 +97,9 @@ namespace SaveState
 		void *cbUserData;
 	};
 
+	// While set, SaveStart leaves RAM and VRAM to this instead of serializing them (see StateRingbuffer, SaveSnapshot.)
+	static std::function<void(PointerWrap &p)> rewindMemoryHandler;
+
 	CChunkFileReader::Error SaveToRam(std::vector<u8> &data) {
 		SaveStart state;
 		size_t sz = CChunkFileReader::MeasurePtr(state);
@@ -102,24 +113,97 @@ namespace SaveState
 		return CChunkFileReader::LoadPtr(&data[0], state, errorString);
 	}
 
+	class RewindCompressTask : public Task {
+	public:
+		RewindCompressTask(WaitableCounter *counter, std::function<void()> work) : counter_(counter), work_(work) {
+		}
+
+		TaskType Type() const override {
+			return TaskType::CPU_COMPUTE;
+		}
+
+		TaskPriority Priority() const override {
+			return TaskPriority::BACKGROUND;
+		}
+
+		void Run() override {
+			work_();
+			counter_->Count();
+		}
+
+	private:
+		WaitableCounter *counter_;
+		std::function<void()> work_;
+	};
+
 	struct StateRingbuffer
 	{
+		// RAM and VRAM in BLOCK_SIZE pieces, shared between states for as long as they don't change.
+		typedef std::shared_ptr<const std::vector<u8>> MemoryBlock;
+		struct MemoryImage {
+			std::vector<MemoryBlock> ram;
+			std::vector<MemoryBlock> vram;
+		};
+
+		// Each state is split into chunks, which are delta encoded against a base and zstd compressed in parallel.
+		struct CompressedState {
+			std::vector<std::vector<u8>> chunks;
+			size_t size = 0;
+			size_t compressedSize = 0;
+
+			bool empty() const {
+				return size == 0;
+			}
+			void clear() {
+				size = 0;
+				compressedSize = 0;
+			}
+		};
+
+		// One per compress task, kept between saves.
+		struct CompressScratch {
+			ZSTD_CCtx *ctx = nullptr;
+			std::vector<u8> delta;
+			std::vector<u8> packed;
+		};
+
 		StateRingbuffer(int size) : first_(0), next_(0), size_(size), base_(-1)
 		{
 			states_.resize(size);
 			baseMapping_.resize(size);
+			images_.resize(size);
+		}
+
+		~StateRingbuffer()
+		{
+			WaitCompress();
+			for (CompressScratch &scratch : scratch_)
+				ZSTD_freeCCtx(scratch.ctx);
 		}
 
 		CChunkFileReader::Error Save()
 		{
 			std::lock_guard<std::mutex> guard(lock_);
+			// The buffers below may still be in use.
+			WaitCompress();
+			TrimToBudget();
+			ReportMemoryUsage();
 
 			int n = next_++ % size_;
 			if ((next_ % size_) == first_)
 				++first_;
 
-			static std::vector<u8> buffer;
-			std::vector<u8> *compressBuffer = &buffer;
+			// When the OS can tell us which pages were written, only those need looking at.
+			// Then RAM and VRAM are kept as shared blocks, and the rest is small enough to diff as usual.
+			images_[n] = MemoryImage();
+			if (DirtyPageTrackingSupported()) {
+				rewindMemoryHandler = [&](PointerWrap &p) {
+					if (p.mode == PointerWrap::MODE_WRITE)
+						CaptureMemory(images_[n]);
+				};
+			}
+
+			std::vector<u8> *compressBuffer = &saveBuffer_;
 			CChunkFileReader::Error err;
 
 			if (base_ == -1 || ++baseUsage_ > BASE_USAGE_INTERVAL)
@@ -131,12 +215,16 @@ namespace SaveState
 				compressBuffer = &bases_[base_];
 			}
 			else
-				err = SaveToRam(buffer);
+				err = SaveToRam(saveBuffer_);
+			rewindMemoryHandler = nullptr;
 
-			if (err == CChunkFileReader::ERROR_NONE)
+			if (err == CChunkFileReader::ERROR_NONE) {
 				ScheduleCompress(&states_[n], compressBuffer, &bases_[base_]);
-			else
+			} else {
 				states_[n].clear();
+				images_[n] = MemoryImage();
+				latest_ = MemoryImage();
+			}
 			baseMapping_[n] = base_;
 			return err;
 		}
@@ -144,6 +232,8 @@ namespace SaveState
 		CChunkFileReader::Error Restore(std::string *errorString)
 		{
 			std::lock_guard<std::mutex> guard(lock_);
+			// The newest state might not be compressed yet.
+			WaitCompress();
 
 			// No valid states left.
 			if (Empty())
@@ -153,76 +243,239 @@ namespace SaveState
 			if (states_[n].empty())
 				return CChunkFileReader::ERROR_BAD_FILE;
 
-			static std::vector<u8> buffer;
-			LockedDecompress(buffer, states_[n], bases_[baseMapping_[n]]);
-			return LoadFromRam(buffer, errorString);
+			std::vector<u8> &buffer = saveBuffer_;
+			if (!LockedDecompress(buffer, states_[n], bases_[baseMapping_[n]]))
+				return CChunkFileReader::ERROR_BROKEN_STATE;
+
+			const MemoryImage &image = images_[n];
+			if (!image.ram.empty()) {
+				rewindMemoryHandler = [&](PointerWrap &p) {
+					if (p.mode == PointerWrap::MODE_READ)
+						RestoreMemory(p, image);
+				};
+			}
+			CChunkFileReader::Error err = LoadFromRam(buffer, errorString);
+			rewindMemoryHandler = nullptr;
+			return err;
+		}
+
+		void CaptureMemory(MemoryImage &image)
+		{
+			// Check everything now and then anyway, in case a write slipped in between checking and resetting.
+			std::vector<u8> ramDirty, vramDirty;
+			bool known = ++capturesSinceCheck_ <= BASE_USAGE_INTERVAL && Memory::GetDirtyBlocks(Memory::DirtyTracker::REWIND, BLOCK_SIZE, ramDirty, vramDirty);
+			Memory::ResetDirtyTracking(Memory::DirtyTracker::REWIND);
+			if (!known)
+				capturesSinceCheck_ = 0;
+
+			CaptureBlocks(image.ram, latest_.ram, Memory::GetPointerUnchecked(PSP_GetKernelMemoryBase()), Memory::g_MemorySize, known ? &ramDirty[0] : nullptr);
+			CaptureBlocks(image.vram, latest_.vram, Memory::GetPointerUnchecked(PSP_GetVidMemBase()), Memory::VRAM_SIZE, known ? &vramDirty[0] : nullptr);
+			latest_ = image;
 		}
 
-		void ScheduleCompress(std::vector<u8> *result, const std::vector<u8> *state, const std::vector<u8> *base)
+		static void CaptureBlocks(std::vector<MemoryBlock> &blocks, const std::vector<MemoryBlock> &prev, const u8 *src, u32 size, const u8 *dirty)
 		{
-			if (compressThread_.joinable())
-				compressThread_.join();
-			compressThread_ = std::thread([=]{
-				SetCurrentThreadName("SaveStateCompress");
-				Compress(*result, *state, *base);
-			});
+			const size_t count = size / BLOCK_SIZE;
+			const bool havePrev = prev.size() == count;
+			blocks.resize(count);
+			for (size_t i = 0; i < count; ++i, src += BLOCK_SIZE) {
+				// Dirty only means written, it may well have been the same data (e.g. jit emuhacks.)
+				if (havePrev && ((dirty && !dirty[i]) || memcmp(prev[i]->data(), src, BLOCK_SIZE) == 0)) {
+					blocks[i] = prev[i];
+				} else {
+					blocks[i] = std::make_shared<std::vector<u8>>(src, src + BLOCK_SIZE);
+				}
+			}
 		}
 
-		void Compress(std::vector<u8> &result, const std::vector<u8> &state, const std::vector<u8> &base)
+		void RestoreMemory(PointerWrap &p, const MemoryImage &image)
 		{
-			std::lock_guard<std::mutex> guard(lock_);
-			// Bail if we were cleared before locking.
-			if (first_ == 0 && next_ == 0)
+			if (image.ram.size() != Memory::g_MemorySize / BLOCK_SIZE || image.vram.size() != Memory::VRAM_SIZE / BLOCK_SIZE) {
+				p.SetError(PointerWrap::ERROR_FAILURE);
+				latest_ = MemoryImage();
 				return;
+			}
 
-			result.clear();
-			for (size_t i = 0; i < state.size(); i += BLOCK_SIZE)
-			{
-				int blockSize = std::min(BLOCK_SIZE, (int)(state.size() - i));
-				if (i + blockSize > base.size() || memcmp(&state[i], &base[i], blockSize) != 0)
+			u8 *ram = Memory::GetPointerUnchecked(PSP_GetKernelMemoryBase());
+			for (size_t i = 0; i < image.ram.size(); ++i)
+				memcpy(ram + i * BLOCK_SIZE, image.ram[i]->data(), BLOCK_SIZE);
+			u8 *vram = Memory::GetPointerUnchecked(PSP_GetVidMemBase());
+			for (size_t i = 0; i < image.vram.size(); ++i)
+				memcpy(vram + i * BLOCK_SIZE, image.vram[i]->data(), BLOCK_SIZE);
+
+			// Memory matches this image again, so the next capture can start from it.
+			Memory::ResetDirtyTracking(Memory::DirtyTracker::REWIND);
+			latest_ = image;
+		}
+
+		void ScheduleCompress(CompressedState *result, const std::vector<u8> *state, const std::vector<u8> *base)
+		{
+			const int numChunks = (int)((state->size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+			result->chunks.resize(numChunks);
+			result->size = state->size();
+			result->compressedSize = 0;
+
+			const int numTasks = std::max(1, std::min(numChunks, g_threadManager.GetNumLooperThreads()));
+			if ((int)scratch_.size() < numTasks)
+				scratch_.resize(numTasks);
+
+			compressCounter_ = new WaitableCounter(numTasks);
+			for (int i = 0; i < numTasks; ++i) {
+				const int lower = numChunks * i / numTasks;
+				const int upper = numChunks * (i + 1) / numTasks;
+				g_threadManager.EnqueueTask(new RewindCompressTask(compressCounter_, [=] {
+					CompressChunks(*result, *state, *base, scratch_[i], lower, upper);
+				}));
+			}
+		}
+
+		void WaitCompress()
+		{
+			if (compressCounter_) {
+				compressCounter_->WaitAndRelease();
+				compressCounter_ = nullptr;
+			}
+		}
+
+		void CompressChunks(CompressedState &result, const std::vector<u8> &state, const std::vector<u8> &base, CompressScratch &scratch, int lower, int upper)
+		{
+			if (!scratch.ctx)
+				scratch.ctx = ZSTD_createCCtx();
+
+			size_t compressedSize = 0;
+			for (int c = lower; c < upper; ++c) {
+				const size_t chunkStart = (size_t)c * CHUNK_SIZE;
+				const size_t chunkEnd = std::min(chunkStart + CHUNK_SIZE, state.size());
+
+				std::vector<u8> &delta = scratch.delta;
+				delta.clear();
+				for (size_t i = chunkStart; i < chunkEnd; i += BLOCK_SIZE)
 				{
-					result.push_back(1);
-					result.insert(result.end(), state.begin() + i, state.begin() +i + blockSize);
+					int blockSize = std::min(BLOCK_SIZE, (int)(chunkEnd - i));
+					if (i + blockSize > base.size() || memcmp(&state[i], &base[i], blockSize) != 0)
+					{
+						delta.push_back(1);
+						delta.insert(delta.end(), state.begin() + i, state.begin() + i + blockSize);
+					}
+					else
+						delta.push_back(0);
 				}
-				else
-					result.push_back(0);
+
+				scratch.packed.resize(ZSTD_compressBound(delta.size()));
+				size_t packedSize = ZSTD_compressCCtx(scratch.ctx, &scratch.packed[0], scratch.packed.size(), &delta[0], delta.size(), 1);
+				std::vector<u8> &chunk = result.chunks[c];
+				if (ZSTD_isError(packedSize)) {
+					// Decompression will notice and call the state broken.
+					chunk.clear();
+					continue;
+				}
+				// Reuses the chunk's old allocation when it's big enough.
+				chunk.assign(scratch.packed.begin(), scratch.packed.begin() + packedSize);
+				compressedSize += packedSize;
 			}
+
+			std::lock_guard<std::mutex> guard(compressSizeLock_);
+			result.compressedSize += compressedSize;
 		}
 
-		void LockedDecompress(std::vector<u8> &result, const std::vector<u8> &compressed, const std::vector<u8> &base)
+		bool LockedDecompress(std::vector<u8> &result, const CompressedState &compressed, const std::vector<u8> &base)
 		{
-			result.clear();
-			result.reserve(base.size());
-			auto basePos = base.begin();
-			for (size_t i = 0; i < compressed.size(); )
-			{
-				if (compressed[i] == 0)
+			result.resize(compressed.size);
+			std::vector<u8> delta;
+			for (size_t c = 0; c < compressed.chunks.size(); ++c) {
+				const std::vector<u8> &chunk = compressed.chunks[c];
+				if (chunk.empty())
+					return false;
+				unsigned long long deltaSize = ZSTD_getFrameContentSize(&chunk[0], chunk.size());
+				if (deltaSize == ZSTD_CONTENTSIZE_ERROR || deltaSize == ZSTD_CONTENTSIZE_UNKNOWN)
+					return false;
+				delta.resize((size_t)deltaSize);
+				if (ZSTD_isError(ZSTD_decompress(&delta[0], delta.size(), &chunk[0], chunk.size())))
+					return false;
+
+				size_t pos = c * CHUNK_SIZE;
+				const size_t chunkEnd = std::min(pos + CHUNK_SIZE, compressed.size);
+				for (size_t i = 0; i < delta.size() && pos < chunkEnd; )
 				{
-					++i;
-					int blockSize = std::min(BLOCK_SIZE, (int)(base.size() - result.size()));
-					result.insert(result.end(), basePos, basePos + blockSize);
-					basePos += blockSize;
+					int blockSize = std::min(BLOCK_SIZE, (int)(chunkEnd - pos));
+					if (delta[i++] == 0)
+					{
+						if (pos + blockSize > base.size())
+							return false;
+						memcpy(&result[pos], &base[pos], blockSize);
+					}
+					else
+					{
+						if (i + blockSize > delta.size())
+							return false;
+						memcpy(&result[pos], &delta[i], blockSize);
+						i += blockSize;
+					}
+					pos += blockSize;
 				}
-				else
+				if (pos != chunkEnd)
+					return false;
+			}
+			return true;
+		}
+
+		// Drops the oldest states that don't fit in the budget.  Call with no compression pending.
+		void TrimToBudget()
+		{
+			size_t total = 0;
+			for (int k = 1; k <= size_ && k <= next_; ++k)
+			{
+				const int n = (next_ - k) % size_;
+				CompressedState &state = states_[n];
+				if (state.empty())
+					continue;
+				total += state.compressedSize;
+				if (total > MAX_COMPRESSED_BYTES && k > 1)
 				{
-					++i;
-					int blockSize = std::min(BLOCK_SIZE, (int)(compressed.size() - i));
-					result.insert(result.end(), compressed.begin() + i, compressed.begin() + i + blockSize);
-					i += blockSize;
-					basePos += blockSize;
+					// Actually give the memory back, that's the point.
+					std::vector<std::vector<u8>>().swap(state.chunks);
+					state.clear();
+					images_[n] = MemoryImage();
 				}
 			}
 		}
 
-		void Clear()
+		// Counts what's actually held, including buffers kept around for reuse.  Call with no compression pending.
+		void ReportMemoryUsage()
 		{
-			if (compressThread_.joinable())
-				compressThread_.join();
+			int64_t total = bases_[0].capacity() + bases_[1].capacity() + saveBuffer_.capacity();
+			for (const CompressedState &state : states_) {
+				for (const std::vector<u8> &chunk : state.chunks)
+					total += chunk.capacity();
+			}
 
+			// Blocks are shared between images, so only count each once.
+			std::unordered_set<const std::vector<u8> *> blocks;
+			auto addBlocks = [&](const MemoryImage &image) {
+				for (const MemoryBlock &block : image.ram)
+					blocks.insert(block.get());
+				for (const MemoryBlock &block : image.vram)
+					blocks.insert(block.get());
+			};
+			for (const MemoryImage &image : images_)
+				addBlocks(image);
+			addBlocks(latest_);
+			total += (int64_t)blocks.size() * BLOCK_SIZE;
+
+			MemoryUsage_Set(MemoryCategory::REWIND_STATES, total);
+		}
+
+		void Clear()
+		{
 			// This lock is mainly for shutdown.
 			std::lock_guard<std::mutex> guard(lock_);
+			WaitCompress();
 			first_ = 0;
 			next_ = 0;
+			for (MemoryImage &image : images_)
+				image = MemoryImage();
+			latest_ = MemoryImage();
+			ReportMemoryUsage();
 		}
 
 		bool Empty() const
@@ -233,6 +486,8 @@ namespace SaveState
 		static const int BLOCK_SIZE;
 		// TODO: Instead, based on size of compressed state?
 		static const int BASE_USAGE_INTERVAL;
+		static const size_t CHUNK_SIZE;
+		static const size_t MAX_COMPRESSED_BYTES;
 
 		typedef std::vector<u8> StateBuffer;
 
@@ -240,11 +495,19 @@ namespace SaveState
 		int next_;
 		int size_;
 
-		std::vector<StateBuffer> states_;
+		std::vector<CompressedState> states_;
 		StateBuffer bases_[2];
+		StateBuffer saveBuffer_;
 		std::vector<int> baseMapping_;
+		// Empty when the state was saved with RAM and VRAM included.
+		std::vector<MemoryImage> images_;
+		// What memory looked like at the last capture or restore.
+		MemoryImage latest_;
+		int capturesSinceCheck_ = 0;
 		std::mutex lock_;
-		std::thread compressThread_;
+		std::vector<CompressScratch> scratch_;
+		WaitableCounter *compressCounter_ = nullptr;
+		std::mutex compressSizeLock_;
 
 		int base_;
 		int baseUsage_;
@@ -263,6 +526,8 @@ namespace SaveState
 	static int saveDataGeneration = 0;
 	static int lastSaveDataGeneration = 0;
 	static std::string saveStateInitialGitVersion = "";
+	// Compresses and writes the last save when bAsyncSaveState is on.  Only one runs at a time.
+	static std::thread asyncSaveThread;
 
 	// TODO: Should this be configurable?
 	static const int REWIND_NUM_STATES = 20;
@@ -273,6 +538,8 @@ namespace SaveState
 	static double rewindLastTime = 0.0f;
 	const int StateRingbuffer::BLOCK_SIZE = 8192;
 	const int StateRingbuffer::BASE_USAGE_INTERVAL = 15;
+	const size_t StateRingbuffer::CHUNK_SIZE = 64 * StateRingbuffer::BLOCK_SIZE;
+	const size_t StateRingbuffer::MAX_COMPRESSED_BYTES = 256 * 1024 * 1024;
 
 	void SaveStart::DoState(PointerWrap &p)
 	{
@@ -301,6 +568,12 @@ namespace SaveState
 		// Gotta do CoreTiming first since we'll restore into it.
 		CoreTiming::DoState(p);
 
+		auto doMemory = [&]() {
+			Memory::DoState(p, !rewindMemoryHandler);
+			if (rewindMemoryHandler)
+				rewindMemoryHandler(p);
+		};
+
 		// Memory is a bit tricky when jit is enabled, since there's emuhacks in it.
 		auto savedReplacements = SaveAndClearReplacements();
 		if (MIPSComp::jit && p.mode == p.MODE_WRITE) {
@@ -308,13 +581,13 @@ namespace SaveState
 			if (MIPSComp::jit) {
 				std::vector<u32> savedBlocks;
 				savedBlocks = MIPSComp::jit->SaveAndClearEmuHackOps();
-				Memory::DoState(p);
+				doMemory();
 				MIPSComp::jit->RestoreSavedEmuHackOps(savedBlocks);
 			} else {
-				Memory::DoState(p);
+				doMemory();
 			}
 		} else {
-			Memory::DoState(p);
+			doMemory();
 		}
 		RestoreSavedReplacements(savedReplacements);
 
@@ -326,6 +599,150 @@ namespace SaveState
 		pspFileSystem.DoState(p);
 	}
 
+	// See SaveSnapshot().  ram and vram match memory as of the last save or load when memoryValid.
+	struct RamSnapshot {
+		std::vector<u8> state;
+		std::vector<u8> ram;
+		std::vector<u8> vram;
+		std::vector<u8> ramDirty;
+		std::vector<u8> vramDirty;
+		bool memoryValid = false;
+	};
+	static RamSnapshot snapshot;
+	static bool snapshotting = false;
+	static const u32 SNAPSHOT_BLOCK_SIZE = 4096;
+
+	static void CopySnapshotBlocks(u8 *dst, const u8 *src, u32 size, const std::vector<u8> *dirty) {
+		if (!dirty) {
+			memcpy(dst, src, size);
+			return;
+		}
+		for (u32 i = 0; i < size / SNAPSHOT_BLOCK_SIZE; ++i) {
+			if ((*dirty)[i])
+				memcpy(dst + i * SNAPSHOT_BLOCK_SIZE, src + i * SNAPSHOT_BLOCK_SIZE, SNAPSHOT_BLOCK_SIZE);
+		}
+	}
+
+	static void DoSnapshotMemory(PointerWrap &p) {
+		if (p.mode != PointerWrap::MODE_WRITE && p.mode != PointerWrap::MODE_READ)
+			return;
+
+		const bool sizeMatches = snapshot.ram.size() == Memory::g_MemorySize && snapshot.vram.size() == Memory::VRAM_SIZE;
+		if (p.mode == PointerWrap::MODE_READ && (!snapshot.memoryValid || !sizeMatches)) {
+			p.SetError(PointerWrap::ERROR_FAILURE);
+			return;
+		}
+
+		// Whatever was written since the last save or load is what differs between memory and the snapshot.
+		bool known = snapshot.memoryValid && sizeMatches && Memory::GetDirtyBlocks(Memory::DirtyTracker::RUNAHEAD, SNAPSHOT_BLOCK_SIZE, snapshot.ramDirty, snapshot.vramDirty);
+		u8 *ram = Memory::GetPointerUnchecked(PSP_GetKernelMemoryBase());
+		u8 *vram = Memory::GetPointerUnchecked(PSP_GetVidMemBase());
+		if (p.mode == PointerWrap::MODE_WRITE) {
+			snapshot.ram.resize(Memory::g_MemorySize);
+			snapshot.vram.resize(Memory::VRAM_SIZE);
+			CopySnapshotBlocks(&snapshot.ram[0], ram, Memory::g_MemorySize, known ? &snapshot.ramDirty : nullptr);
+			CopySnapshotBlocks(&snapshot.vram[0], vram, Memory::VRAM_SIZE, known ? &snapshot.vramDirty : nullptr);
+		} else {
+			CopySnapshotBlocks(ram, &snapshot.ram[0], Memory::g_MemorySize, known ? &snapshot.ramDirty : nullptr);
+			CopySnapshotBlocks(vram, &snapshot.vram[0], Memory::VRAM_SIZE, known ? &snapshot.vramDirty : nullptr);
+		}
+		Memory::ResetDirtyTracking(Memory::DirtyTracker::RUNAHEAD);
+		snapshot.memoryValid = true;
+	}
+
+	size_t MeasureWithoutMemory() {
+		SaveStart state;
+		// Only checked for being set.
+		rewindMemoryHandler = [](PointerWrap &p) {};
+		size_t sz = CChunkFileReader::MeasurePtr(state);
+		rewindMemoryHandler = nullptr;
+		return sz;
+	}
+
+	CChunkFileReader::Error SaveWithoutMemory(u8 *ptr, size_t size, const MemoryHandler &memoryHandler) {
+		SaveStart state;
+		// Not real saves, so they shouldn't count as one.
+		int generation = saveStateGeneration;
+		snapshotting = true;
+		rewindMemoryHandler = memoryHandler;
+		CChunkFileReader::Error err = CChunkFileReader::SavePtr(ptr, state, size);
+		rewindMemoryHandler = nullptr;
+		snapshotting = false;
+		saveStateGeneration = generation;
+		return err;
+	}
+
+	CChunkFileReader::Error LoadWithoutMemory(u8 *ptr, const MemoryHandler &memoryHandler, std::string *errorString) {
+		SaveStart state;
+		int generation = saveStateGeneration;
+		snapshotting = true;
+		rewindMemoryHandler = memoryHandler;
+		CChunkFileReader::Error err = CChunkFileReader::LoadPtr(ptr, state, errorString);
+		rewindMemoryHandler = nullptr;
+		snapshotting = false;
+		saveStateGeneration = generation;
+		return err;
+	}
+
+	CChunkFileReader::Error SaveSnapshot() {
+		size_t sz = MeasureWithoutMemory();
+		if (snapshot.state.size() < sz)
+			snapshot.state.resize(sz);
+		CChunkFileReader::Error err = SaveWithoutMemory(&snapshot.state[0], sz, &DoSnapshotMemory);
+		if (err != CChunkFileReader::ERROR_NONE)
+			snapshot.memoryValid = false;
+		return err;
+	}
+
+	CChunkFileReader::Error LoadSnapshot(std::string *errorString) {
+		if (snapshot.state.empty())
+			return CChunkFileReader::ERROR_BAD_FILE;
+		return LoadWithoutMemory(&snapshot.state[0], &DoSnapshotMemory, errorString);
+	}
+
+	void ClearSnapshot() {
+		// Give the memory back, a snapshot is quite big.
+		snapshot = RamSnapshot();
+		Memory::StopDirtyTracking(Memory::DirtyTracker::RUNAHEAD);
+	}
+
+	bool IsSnapshotting() {
+		return snapshotting;
+	}
+
+	static void WaitAsyncSave() {
+		if (asyncSaveThread.joinable())
+			asyncSaveThread.join();
+	}
+
+	// Takes a snapshot right away, the slow part happens on asyncSaveThread which also calls the callback.
+	static CChunkFileReader::Error SaveAsync(const Operation &op, SaveStart &state, const std::string &title, const std::string &successMessage, const std::string &failureMessage) {
+		WaitAsyncSave();
+
+		size_t sz = CChunkFileReader::MeasurePtr(state);
+		u8 *buffer = (u8 *)malloc(sz);
+		if (!buffer)
+			return CChunkFileReader::ERROR_BAD_ALLOC;
+		CChunkFileReader::Error result = CChunkFileReader::SavePtr(buffer, state, sz);
+		if (result != CChunkFileReader::ERROR_NONE) {
+			free(buffer);
+			return result;
+		}
+
+		Path filename = op.filename;
+		Callback callback = op.callback;
+		void *cbUserData = op.cbUserData;
+		asyncSaveThread = std::thread([=] {
+			SetCurrentThreadName("SaveStateWrite");
+			CChunkFileReader::Error result = CChunkFileReader::SaveFile(filename, title, PPSSPP_GIT_VERSION, buffer, sz);
+			if (result != CChunkFileReader::ERROR_NONE)
+				ERROR_LOG(SAVESTATE, "Save state failure writing %s", filename.c_str());
+			if (callback)
+				callback(result == CChunkFileReader::ERROR_NONE ? Status::SUCCESS : Status::FAILURE, result == CChunkFileReader::ERROR_NONE ? successMessage : failureMessage, cbUserData);
+		});
+		return result;
+	}
+
 	void Enqueue(SaveState::Operation op)
 	{
 		std::lock_guard<std::mutex> guard(mutex);
@@ -832,6 +1249,10 @@ namespace SaveState
 
 	void Process()
 	{
+		// Frames run-ahead throws away again shouldn't end up in any state.
+		if (PSP_CoreParameter().runAheadSpeculative)
+			return;
+
 		if (g_Config.iRewindFlipFrequency != 0 && gpuStats.numFlips != 0)
 			CheckRewindState();
 
@@ -872,6 +1293,8 @@ namespace SaveState
 			{
 			case SAVESTATE_LOAD:
 				INFO_LOG(SAVESTATE, "Loading state from '%s'", op.filename.c_str());
+				// It might still be getting written.
+				WaitAsyncSave();
 				// Use the state's latest version as a guess for saveStateInitialGitVersion.
 				result = CChunkFileReader::Load(op.filename, &saveStateInitialGitVersion, state, &errorString);
 				if (result == CChunkFileReader::ERROR_NONE) {
@@ -914,7 +1337,14 @@ namespace SaveState
 					std::size_t lslash = title.find_last_of("/");
 					title = title.substr(lslash + 1);
 				}
-				result = CChunkFileReader::Save(op.filename, title, PPSSPP_GIT_VERSION, state);
+				if (g_Config.bAsyncSaveState) {
+					result = SaveAsync(op, state, title, slot_prefix + sc->T("Saved State"), i18nSaveFailure);
+					// The write thread reports back instead.
+					if (result == CChunkFileReader::ERROR_NONE)
+						op.callback = Callback();
+				} else {
+					result = CChunkFileReader::Save(op.filename, title, PPSSPP_GIT_VERSION, state);
+				}
 				if (result == CChunkFileReader::ERROR_NONE) {
 					callbackMessage = slot_prefix + sc->T("Saved State");
 					callbackResult = Status::SUCCESS;
@@ -979,7 +1409,11 @@ namespace SaveState
 			case SAVESTATE_SAVE_SCREENSHOT:
 			{
 				int maxRes = g_Config.iInternalResolution > 2 ? 2 : -1;
-				tempResult = TakeGameScreenshot(op.filename, ScreenshotFormat::JPG, SCREENSHOT_DISPLAY, nullptr, nullptr, maxRes);
+				// Nothing waits on the file itself, so don't hitch on the JPEG encode.
+				if (op.callback)
+					tempResult = TakeGameScreenshot(op.filename, ScreenshotFormat::JPG, SCREENSHOT_DISPLAY, nullptr, nullptr, maxRes);
+				else
+					tempResult = TakeGameScreenshotAsync(op.filename, ScreenshotFormat::JPG, SCREENSHOT_DISPLAY, maxRes);
 				callbackResult = tempResult ? Status::SUCCESS : Status::FAILURE;
 				if (!tempResult) {
 					ERROR_LOG(SAVESTATE, "Failed to take a screenshot for the savestate! %s", op.filename.c_str());
@@ -1035,6 +1469,7 @@ namespace SaveState
 
 		std::lock_guard<std::mutex> guard(mutex);
 		rewindStates.Clear();
+		ClearSnapshot();
 
 		hasLoadedState = false;
 		saveStateGeneration = 0;
@@ -1045,7 +1480,9 @@ namespace SaveState
 
 	void Shutdown()
 	{
+		WaitAsyncSave();
 		std::lock_guard<std::mutex> guard(mutex);
 		rewindStates.Clear();
+		ClearSnapshot();
 	}
 }
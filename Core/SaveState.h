@@ -79,6 +79,23 @@ namespace SaveState
 	CChunkFileReader::Error SaveToRam(std::vector<u8> &state);
 	CChunkFileReader::Error LoadFromRam(std::vector<u8> &state, std::string *errorString);
 
+	// A single uncompressed snapshot kept in RAM, for run-ahead.  Buffers are kept between uses, and RAM and VRAM
+	// are only copied where they were written since the last save or load, if dirty page tracking works.
+	// Host side state (queued audio output, framebuffers, caches) is left alone.
+	CChunkFileReader::Error SaveSnapshot();
+	CChunkFileReader::Error LoadSnapshot(std::string *errorString);
+	void ClearSnapshot();
+	// True during SaveSnapshot() and LoadSnapshot().
+	bool IsSnapshotting();
+
+	// The building blocks of the above, for callers that keep RAM and VRAM themselves (e.g. libretro.)
+	// memoryHandler is called where RAM and VRAM would be, with jit emuhacks removed when saving.
+	// Like snapshots, these don't count as real saves, and leave host side state alone.
+	typedef std::function<void(PointerWrap &p)> MemoryHandler;
+	size_t MeasureWithoutMemory();
+	CChunkFileReader::Error SaveWithoutMemory(u8 *ptr, size_t size, const MemoryHandler &memoryHandler);
+	CChunkFileReader::Error LoadWithoutMemory(u8 *ptr, const MemoryHandler &memoryHandler, std::string *errorString);
+
 	// For testing / automated tests.  Runs a save state verification pass (async.)
 	// Warning: callback will be called on a different thread.
 	void Verify(Callback callback = Callback(), void *cbUserData = 0);
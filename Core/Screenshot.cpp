@@ -26,6 +26,7 @@
 #include "Common/File/Path.h"
 #include "Common/Log.h"
 #include "Common/System/Display.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Core/Config.h"
 #include "Core/Screenshot.h"
 #include "Core/Core.h"
@@ -328,15 +329,14 @@ static GPUDebugBuffer ApplyRotation(const GPUDebugBuffer &buf, DisplayRotation r
 	return rotated;
 }
 
-bool TakeGameScreenshot(const Path &filename, ScreenshotFormat fmt, ScreenshotType type, int *width, int *height, int maxRes) {
+static bool ReadbackGameScreenshot(GPUDebugBuffer &buf, ScreenshotType type, int maxRes, u32 &w, u32 &h) {
 	if (!gpuDebug) {
 		ERROR_LOG(SYSTEM, "Can't take screenshots when GPU not running");
 		return false;
 	}
-	GPUDebugBuffer buf;
 	bool success = false;
-	u32 w = (u32)-1;
-	u32 h = (u32)-1;
+	w = (u32)-1;
+	h = (u32)-1;
 
 	if (type == SCREENSHOT_DISPLAY || type == SCREENSHOT_RENDER) {
 		success = gpuDebug->GetCurrentFramebuffer(buf, type == SCREENSHOT_RENDER ? GPU_DBG_FRAMEBUF_RENDER : GPU_DBG_FRAMEBUF_DISPLAY, maxRes);
@@ -356,21 +356,16 @@ bool TakeGameScreenshot(const Path &filename, ScreenshotFormat fmt, ScreenshotTy
 
 	if (!success) {
 		ERROR_LOG(G3D, "Failed to obtain screenshot data.");
-		return false;
 	}
+	return success;
+}
 
+static bool EncodeGameScreenshot(const GPUDebugBuffer &buf, const Path &filename, ScreenshotFormat fmt, u32 &w, u32 &h) {
 	u8 *flipbuffer = nullptr;
+	const u8 *buffer = ConvertBufferToScreenshot(buf, false, flipbuffer, w, h);
+	bool success = buffer != nullptr;
 	if (success) {
-		const u8 *buffer = ConvertBufferToScreenshot(buf, false, flipbuffer, w, h);
-		success = buffer != nullptr;
-		if (success) {
-			if (width)
-				*width = w;
-			if (height)
-				*height = h;
-
-			success = Save888RGBScreenshot(filename, fmt, buffer, w, h);
-		}
+		success = Save888RGBScreenshot(filename, fmt, buffer, w, h);
 	}
 	delete [] flipbuffer;
 
@@ -380,6 +375,70 @@ bool TakeGameScreenshot(const Path &filename, ScreenshotFormat fmt, ScreenshotTy
 	return success;
 }
 
+bool TakeGameScreenshot(const Path &filename, ScreenshotFormat fmt, ScreenshotType type, int *width, int *height, int maxRes) {
+	GPUDebugBuffer buf;
+	u32 w, h;
+	if (!ReadbackGameScreenshot(buf, type, maxRes, w, h)) {
+		return false;
+	}
+
+	bool success = EncodeGameScreenshot(buf, filename, fmt, w, h);
+	if (success) {
+		if (width)
+			*width = w;
+		if (height)
+			*height = h;
+	}
+	return success;
+}
+
+class ScreenshotEncodeTask : public Task {
+public:
+	ScreenshotEncodeTask(GPUDebugBuffer &&buf, const Path &filename, ScreenshotFormat fmt, u32 w, u32 h)
+		: buf_(std::move(buf)), filename_(filename), fmt_(fmt), w_(w), h_(h) {
+	}
+
+	TaskType Type() const override {
+		return TaskType::IO_BLOCKING;
+	}
+
+	TaskPriority Priority() const override {
+		return TaskPriority::BACKGROUND;
+	}
+
+	void Run() override {
+		// Write next to it and rename, so nobody sees a half written file.
+		Path tempFilename = filename_.WithExtraExtension(".tmp");
+		if (EncodeGameScreenshot(buf_, tempFilename, fmt_, w_, h_)) {
+			File::Delete(filename_);
+			File::Rename(tempFilename, filename_);
+		} else {
+			File::Delete(tempFilename);
+		}
+	}
+
+private:
+	GPUDebugBuffer buf_;
+	Path filename_;
+	ScreenshotFormat fmt_;
+	u32 w_;
+	u32 h_;
+};
+
+bool TakeGameScreenshotAsync(const Path &filename, ScreenshotFormat fmt, ScreenshotType type, int maxRes) {
+	GPUDebugBuffer buf;
+	u32 w, h;
+	if (!ReadbackGameScreenshot(buf, type, maxRes, w, h)) {
+		return false;
+	}
+
+	if (!g_threadManager.IsInitialized()) {
+		return EncodeGameScreenshot(buf, filename, fmt, w, h);
+	}
+	g_threadManager.EnqueueTask(new ScreenshotEncodeTask(std::move(buf), filename, fmt, w, h));
+	return true;
+}
+
 bool Save888RGBScreenshot(const Path &filename, ScreenshotFormat fmt, const u8 *bufferRGB888, int w, int h) {
 	if (fmt == ScreenshotFormat::PNG) {
 		png_image png;
@@ -39,5 +39,7 @@ const u8 *ConvertBufferToScreenshot(const GPUDebugBuffer &buf, bool alpha, u8 *&
 
 // Can only be used while in game.
 bool TakeGameScreenshot(const Path &filename, ScreenshotFormat fmt, ScreenshotType type, int *width = nullptr, int *height = nullptr, int maxRes = -1);
+// Reads back now, but converts and writes the file on a background thread.  Only reports readback failure.
+bool TakeGameScreenshotAsync(const Path &filename, ScreenshotFormat fmt, ScreenshotType type, int maxRes = -1);
 bool Save888RGBScreenshot(const Path &filename, ScreenshotFormat fmt, const u8 *bufferRGB888, int w, int h);
 bool Save8888RGBAScreenshot(const Path &filename, const u8 *bufferRGBA8888, int w, int h);
@@ -46,10 +46,12 @@
 #include "Core/MIPS/MIPS.h"
 #include "Core/MIPS/MIPSAnalyst.h"
 #include "Core/MIPS/MIPSVFPUUtils.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/Debugger/SymbolMap.h"
 #include "Core/Host.h"
 #include "Core/System.h"
 #include "Core/HLE/HLE.h"
+#include "Core/HLE/HLETrace.h"
 #include "Core/HLE/Plugins.h"
 #include "Core/HLE/ReplaceTables.h"
 #include "Core/HLE/sceKernel.h"
@@ -352,6 +354,7 @@ void CPU_Shutdown() {
 	CoreTiming::Shutdown();
 	__KernelShutdown();
 	HLEShutdown();
+	HLETraceStop();
 	if (coreParameter.enableSound) {
 		Audio_Shutdown();
 	}
@@ -520,6 +523,12 @@ void PSP_Shutdown() {
 	}
 #endif
 
+	{
+		std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
+		if (MIPSComp::jit)
+			MIPSComp::jit->SaveAllModuleCaches();
+	}
+
 	if (pspIsIniting)
 		Core_NotifyLifecycle(CoreLifecycle::START_COMPLETE);
 	Core_NotifyLifecycle(CoreLifecycle::STOPPING);
@@ -564,6 +573,41 @@ void PSP_RunLoopWhileState() {
 	}
 }
 
+// Emulates the frame with the current input without showing it, and saves a snapshot. Then the
+// next frames run with the same input, the last of them shown, and the snapshot is restored.
+// The game keeps going at the normal pace, but the player sees the result of their input earlier.
+void PSP_RunLoopWhileStateRunAhead(int frames) {
+	CoreParameter &param = PSP_CoreParameter();
+	param.runAheadHidden = true;
+	PSP_RunLoopWhileState();
+	param.runAheadHidden = false;
+	if (coreState != CORE_NEXTFRAME)
+		return;
+
+	if (SaveState::SaveSnapshot() != CChunkFileReader::ERROR_NONE) {
+		ERROR_LOG(SAVESTATE, "Run-ahead: failed to save snapshot");
+		return;
+	}
+
+	param.runAheadSpeculative = true;
+	for (int i = 0; i < frames; ++i) {
+		coreState = CORE_RUNNING;
+		param.runAheadHidden = i + 1 < frames;
+		PSP_RunLoopWhileState();
+		if (coreState != CORE_NEXTFRAME)
+			break;
+	}
+	param.runAheadHidden = false;
+	param.runAheadSpeculative = false;
+
+	// If we stopped for a breakpoint or crash, better to look at it where it happened.
+	if (coreState != CORE_NEXTFRAME)
+		return;
+	std::string errorString;
+	if (SaveState::LoadSnapshot(&errorString) != CChunkFileReader::ERROR_NONE)
+		ERROR_LOG(SAVESTATE, "Run-ahead: failed to load snapshot (%s)", errorString.c_str());
+}
+
 void PSP_RunLoopUntil(u64 globalticks) {
 	SaveState::Process();
 	if (coreState == CORE_POWERDOWN || coreState == CORE_BOOT_ERROR || coreState == CORE_RUNTIME_ERROR) {
@@ -574,6 +618,7 @@ void PSP_RunLoopUntil(u64 globalticks) {
 	}
 
 	mipsr4k.RunLoopUntil(globalticks);
+	gpu->SyncThread();
 	gpu->CleanupBeforeUI();
 }
 
@@ -80,6 +80,8 @@ void PSP_Shutdown();
 void PSP_BeginHostFrame();
 void PSP_EndHostFrame();
 void PSP_RunLoopWhileState();
+// Like PSP_RunLoopWhileState(), but shows the state the given number of frames later, see g_Config.iRunAheadFrames.
+void PSP_RunLoopWhileStateRunAhead(int frames);
 void PSP_RunLoopUntil(u64 globalticks);
 void PSP_RunLoopFor(int cycles);
 
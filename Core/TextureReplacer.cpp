@@ -18,8 +18,11 @@
 #include "ppsspp_config.h"
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <cstring>
 #include <memory>
+#include <mutex>
+#include <unordered_set>
 #include <png.h>
 
 #include "ext/xxhash.h"
@@ -30,27 +33,108 @@
 #include "Common/Data/Text/I18n.h"
 #include "Common/Data/Text/Parsers.h"
 #include "Common/File/FileUtil.h"
+#include "Common/Profiler/MemoryUsage.h"
 #include "Common/StringUtils.h"
 #include "Common/Thread/ParallelLoop.h"
 #include "Common/TimeUtil.h"
 #include "Core/Config.h"
+#include "Core/FileLoaders/LocalFileLoader.h"
 #include "Core/Host.h"
 #include "Core/System.h"
 #include "Core/TextureReplacer.h"
 #include "Core/ThreadPools.h"
 #include "Core/ELF/ParamSFO.h"
 #include "GPU/Common/TextureDecoder.h"
+#include "GPU/GPU.h"
 
 static const std::string INI_FILENAME = "textures.ini";
+static const std::string PACK_FILENAME = "textures.pack";
+static const u32 PACK_VERSION = 1;
 static const std::string NEW_TEXTURE_DIR = "new/";
 static const int VERSION = 1;
 static const int MAX_MIP_LEVELS = 12;  // 12 should be plenty, 8 is the max mip levels supported by the PSP.
 
+// Replacements loaded within this many frames of the one starting a group join the group.
+static const int PRELOAD_GROUP_FRAMES = 30;
+static const size_t MAX_PRELOAD_GROUP_SIZE = 256;
+// Preloading stops when replacements use this much memory.
+#if PPSSPP_ARCH(64BIT)
+static const int64_t PRELOAD_MEMORY_BUDGET = 512 * 1024 * 1024;
+#else
+static const int64_t PRELOAD_MEMORY_BUDGET = 128 * 1024 * 1024;
+#endif
+
+TexturePack::TexturePack() {
+}
+
+TexturePack::~TexturePack() {
+}
+
+bool TexturePack::Open(const Path &filename) {
+	loader_.reset(new LocalFileLoader(filename, true));
+	u32 header[4];
+	if (loader_->ReadAt(0, sizeof(header), header) != sizeof(header) || memcmp(header, "PPTP", 4) != 0) {
+		ERROR_LOG(G3D, "Not a texture pack: %s", filename.c_str());
+		return false;
+	}
+	if (header[1] != PACK_VERSION) {
+		ERROR_LOG(G3D, "Unsupported texture pack version %d: %s", header[1], filename.c_str());
+		return false;
+	}
+
+	count_ = header[2];
+	size_t indexSize = (size_t)count_ * sizeof(TexturePackEntry);
+	if ((u64)indexSize + sizeof(header) > (u64)loader_->FileSize()) {
+		ERROR_LOG(G3D, "Texture pack index truncated: %s", filename.c_str());
+		return false;
+	}
+	entries_ = (const TexturePackEntry *)loader_->GetPointer(sizeof(header), indexSize);
+	if (!entries_) {
+		entryBuf_.resize(count_);
+		if (count_ != 0 && loader_->ReadAt(sizeof(header), sizeof(TexturePackEntry), count_, &entryBuf_[0]) != count_)
+			return false;
+		entries_ = entryBuf_.data();
+	}
+
+	INFO_LOG(G3D, "Loaded texture pack with %d files: %s", count_, filename.c_str());
+	return true;
+}
+
+bool TexturePack::Find(const std::string &name, u64 *offset, u64 *size) const {
+	std::string normalized = name;
+	std::replace(normalized.begin(), normalized.end(), '\\', '/');
+	u64 nameHash = XXH3_64bits(normalized.data(), normalized.size());
+
+	const TexturePackEntry *end = entries_ + count_;
+	const TexturePackEntry *entry = std::lower_bound(entries_, end, nameHash, [](const TexturePackEntry &e, u64 h) {
+		return e.nameHash < h;
+	});
+	if (entry == end || entry->nameHash != nameHash)
+		return false;
+	*offset = entry->offset;
+	*size = entry->size;
+	return true;
+}
+
+const u8 *TexturePack::Read(u64 offset, size_t size, std::vector<u8> &buf) const {
+	const u8 *ptr = loader_->GetPointer(offset, size);
+	if (ptr)
+		return ptr;
+	buf.resize(size);
+	if (size != 0 && loader_->ReadAt(offset, size, &buf[0]) != size)
+		return nullptr;
+	return buf.data();
+}
+
 TextureReplacer::TextureReplacer() {
 	none_.alphaStatus_ = ReplacedTextureAlpha::UNKNOWN;
 }
 
+static void WaitForTextureSaves();
+
 TextureReplacer::~TextureReplacer() {
+	// The save tasks don't reference us, but let's not leave half written dumps behind.
+	WaitForTextureSaves();
 }
 
 void TextureReplacer::Init() {
@@ -95,6 +179,14 @@ bool TextureReplacer::LoadIni() {
 	// Prevents dumping the mipmaps.
 	ignoreMipmap_ = false;
 
+	// Textures in use keep the old pack alive until they're gone.
+	pack_.reset();
+	if (File::Exists(basePath_ / PACK_FILENAME)) {
+		std::shared_ptr<TexturePack> pack = std::make_shared<TexturePack>();
+		if (pack->Open(basePath_ / PACK_FILENAME))
+			pack_ = pack;
+	}
+
 	if (File::Exists(basePath_ / INI_FILENAME)) {
 		IniFile ini;
 		ini.LoadFromVFS((basePath_ / INI_FILENAME).ToString());
@@ -377,6 +469,8 @@ ReplacedTexture &TextureReplacer::FindReplacement(u64 cachekey, u32 hash, int w,
 	ReplacementCacheKey replacementKey(cachekey, hash);
 	auto it = cache_.find(replacementKey);
 	if (it != cache_.end()) {
+		if (it->second.NeedsPrepare())
+			NotifyLoading(replacementKey);
 		return it->second;
 	}
 
@@ -384,9 +478,40 @@ ReplacedTexture &TextureReplacer::FindReplacement(u64 cachekey, u32 hash, int w,
 	ReplacedTexture &result = cache_[replacementKey];
 	result.alphaStatus_ = ReplacedTextureAlpha::UNKNOWN;
 	PopulateReplacement(&result, cachekey, hash, w, h);
+	if (result.NeedsPrepare())
+		NotifyLoading(replacementKey);
 	return result;
 }
 
+void TextureReplacer::NotifyLoading(const ReplacementCacheKey &key) {
+	// Loads shortly after another one are likely the same scene, or area, coming into view.
+	int frame = gpuStats.numFlips;
+	if (!hasGroupStart_ || frame - groupStartFrame_ > PRELOAD_GROUP_FRAMES) {
+		groupStart_ = key;
+		groupStartFrame_ = frame;
+		hasGroupStart_ = true;
+	} else if (!(key == groupStart_)) {
+		std::vector<ReplacementCacheKey> &group = preloadGroups_[groupStart_];
+		if (group.size() < MAX_PRELOAD_GROUP_SIZE && std::find(group.begin(), group.end(), key) == group.end())
+			group.push_back(key);
+	}
+
+	auto group = preloadGroups_.find(key);
+	if (group == preloadGroups_.end())
+		return;
+
+	int64_t budget = PRELOAD_MEMORY_BUDGET - MemoryUsage_Get(MemoryCategory::TEXTURE_REPLACEMENTS);
+	for (const ReplacementCacheKey &member : group->second) {
+		auto it = cache_.find(member);
+		if (it == cache_.end() || !it->second.NeedsPrepare())
+			continue;
+		budget -= it->second.EstimateBytes();
+		if (budget < 0)
+			break;
+		it->second.PrepareAsync();
+	}
+}
+
 void TextureReplacer::PopulateReplacement(ReplacedTexture *result, u64 cachekey, u32 hash, int w, int h) {
 	int newW = w;
 	int newH = h;
@@ -396,18 +521,26 @@ void TextureReplacer::PopulateReplacement(ReplacedTexture *result, u64 cachekey,
 		cachekey = cachekey & 0xFFFFFFFFULL;
 	}
 
+	std::vector<ReplacedTextureLevel> containerMips;
 	for (int i = 0; i < MAX_MIP_LEVELS; ++i) {
 		const std::string hashfile = LookupHashFile(cachekey, hash, i);
-		const Path filename = basePath_ / hashfile;
-		if (hashfile.empty() || !File::Exists(filename)) {
+		ReplacedTextureLevel level;
+		if (hashfile.empty() || !FindFile(hashfile, level)) {
 			// Out of valid mip levels.  Bail out.
 			break;
 		}
 
-		ReplacedTextureLevel level;
 		level.fmt = ReplacedTextureFormat::F_8888;
-		level.file = filename;
-		bool good = PopulateLevel(level);
+		const Path filename = level.file;
+		bool good = PopulateLevel(level, hashfile, i == 0 ? &containerMips : nullptr);
+
+		if (good && ReplacedFormatIsCompressed(level.fmt)) {
+			// Compressed data can't be padded on load, it must already match.
+			if (w != newW || h != newH) {
+				WARN_LOG(G3D, "Compressed replacement can't be used with a hash range: '%s'", filename.c_str());
+				good = false;
+			}
+		}
 
 		// We pad files that have been hashrange'd so they are the same texture size.
 		level.w = (level.w * w) / newW;
@@ -419,6 +552,11 @@ void TextureReplacer::PopulateReplacement(ReplacedTexture *result, u64 cachekey,
 				 WARN_LOG(G3D, "Replacement mipmap invalid: size=%dx%d, expected=%dx%d (level %d, '%s')", level.w, level.h, result->levels_[0].w >> i, result->levels_[0].h >> i, i, filename.c_str());
 				 good = false;
 			}
+			// All levels go into the same texture.
+			if (level.fmt != result->levels_[0].fmt) {
+				WARN_LOG(G3D, "Replacement mipmap invalid: different format than level 0 (level %d, '%s')", i, filename.c_str());
+				good = false;
+			}
 		}
 
 		if (good)
@@ -428,79 +566,398 @@ void TextureReplacer::PopulateReplacement(ReplacedTexture *result, u64 cachekey,
 			break;
 	}
 
+	// Without separate mip files, use any mips stored in a compressed file.
+	if (result->levels_.size() == 1) {
+		for (const ReplacedTextureLevel &level : containerMips)
+			result->levels_.push_back(level);
+	}
+
 	result->alphaStatus_ = ReplacedTextureAlpha::UNKNOWN;
 }
 
 enum class ReplacedImageType {
 	PNG,
 	ZIM,
+	DDS,
+	KTX2,
 	INVALID,
 };
 
-static ReplacedImageType Identify(FILE *fp) {
-	uint8_t magic[4];
-	if (fread(magic, 1, 4, fp) != 4)
+static ReplacedImageType Identify(const u8 *data, size_t size) {
+	if (size < 4)
 		return ReplacedImageType::INVALID;
-	rewind(fp);
 
-	if (strncmp((const char *)magic, "ZIMG", 4) == 0)
+	if (strncmp((const char *)data, "ZIMG", 4) == 0)
 		return ReplacedImageType::ZIM;
-	if (magic[0] == 0x89 && strncmp((const char *)&magic[1], "PNG", 3) == 0)
+	if (data[0] == 0x89 && strncmp((const char *)&data[1], "PNG", 3) == 0)
 		return ReplacedImageType::PNG;
+	if (strncmp((const char *)data, "DDS ", 4) == 0)
+		return ReplacedImageType::DDS;
+	if (data[0] == 0xAB && strncmp((const char *)&data[1], "KTX", 3) == 0)
+		return ReplacedImageType::KTX2;
 	return ReplacedImageType::INVALID;
 }
 
-bool TextureReplacer::PopulateLevel(ReplacedTextureLevel &level) {
-	bool good = false;
+// Enough of the start of a file for any of the headers we read.
+static const size_t HEADER_READ_SIZE = 1024;
+
+// Reads up to maxSize bytes at offset of a replacement file, loose or in the pack.
+// Data in a mapped pack isn't copied, so the result may point there rather than into buf.
+static const u8 *ReadReplacementFile(const ReplacedTextureLevel &level, u64 offset, size_t maxSize, std::vector<u8> &buf, size_t *size, u64 *fileSize) {
+	if (level.pack) {
+		if (fileSize)
+			*fileSize = level.packSize;
+		if (offset > level.packSize)
+			return nullptr;
+		*size = (size_t)std::min((u64)maxSize, level.packSize - offset);
+		return level.pack->Read(level.packOffset + offset, *size, buf);
+	}
 
 	FILE *fp = File::OpenCFile(level.file, "rb");
-	auto imageType = Identify(fp);
+	if (!fp)
+		return nullptr;
+	u64 totalSize = File::GetFileSize(fp);
+	if (fileSize)
+		*fileSize = totalSize;
+	if (offset > totalSize || fseek(fp, (long)offset, SEEK_SET) != 0) {
+		fclose(fp);
+		return nullptr;
+	}
+	buf.resize((size_t)std::min((u64)maxSize, totalSize - offset));
+	*size = buf.empty() ? 0 : fread(&buf[0], 1, buf.size(), fp);
+	fclose(fp);
+	return buf.data();
+}
+
+struct CompressedImageLevel {
+	u32 offset;
+	u32 size;
+};
+
+static bool ReadU32(const u8 *data, size_t size, size_t pos, u32 &value) {
+	if (pos + 4 > size)
+		return false;
+	const u8 *buf = data + pos;
+	value = buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((u32)buf[3] << 24);
+	return true;
+}
+
+static bool ReadU64(const u8 *data, size_t size, size_t pos, u64 &value) {
+	u32 lo, hi;
+	if (!ReadU32(data, size, pos, lo) || !ReadU32(data, size, pos + 4, hi))
+		return false;
+	value = ((u64)hi << 32) | lo;
+	return true;
+}
+
+static bool ReadDDSHeader(const u8 *data, size_t size, ReplacedTextureFormat &fmt, int &w, int &h, std::vector<CompressedImageLevel> &levels) {
+	u32 header[31];
+	for (int i = 0; i < 31; ++i) {
+		if (!ReadU32(data, size, 4 + i * 4, header[i]))
+			return false;
+	}
+	// DDS_HEADER: dwSize, dwFlags, dwHeight, dwWidth, ... dwMipMapCount at 6, DDS_PIXELFORMAT at 18 with the fourCC at 20.
+	if (header[0] != 124)
+		return false;
+	h = (int)header[2];
+	w = (int)header[3];
+	u32 mipCount = std::max(header[6], 1U);
+	u32 fourCC = header[20];
+	u32 offset = 4 + 124;
+
+	auto makeFourCC = [](const char *str) {
+		return (u32)str[0] | ((u32)str[1] << 8) | ((u32)str[2] << 16) | ((u32)str[3] << 24);
+	};
+	if (fourCC == makeFourCC("DXT1")) {
+		fmt = ReplacedTextureFormat::F_BC1;
+	} else if (fourCC == makeFourCC("DXT5")) {
+		fmt = ReplacedTextureFormat::F_BC3;
+	} else if (fourCC == makeFourCC("DX10")) {
+		u32 dxgiFormat;
+		if (!ReadU32(data, size, offset, dxgiFormat))
+			return false;
+		offset += 20;
+		switch (dxgiFormat) {
+		case 71: case 72: fmt = ReplacedTextureFormat::F_BC1; break;  // DXGI_FORMAT_BC1_UNORM(_SRGB)
+		case 77: case 78: fmt = ReplacedTextureFormat::F_BC3; break;  // DXGI_FORMAT_BC3_UNORM(_SRGB)
+		case 98: case 99: fmt = ReplacedTextureFormat::F_BC7; break;  // DXGI_FORMAT_BC7_UNORM(_SRGB)
+		default: return false;
+		}
+	} else {
+		return false;
+	}
+
+	// No size in the file per level, they're just packed.
+	for (u32 i = 0; i < mipCount; ++i) {
+		int mipW = std::max(w >> i, 1);
+		int mipH = std::max(h >> i, 1);
+		u32 levelSize = ReplacedFormatRowBytes(fmt, mipW) * ReplacedFormatRows(fmt, mipH);
+		levels.push_back(CompressedImageLevel{ offset, levelSize });
+		offset += levelSize;
+	}
+	return true;
+}
+
+static bool ReadKTX2Header(const u8 *data, size_t size, ReplacedTextureFormat &fmt, int &w, int &h, std::vector<CompressedImageLevel> &levels) {
+	// vkFormat, typeSize, pixelWidth, pixelHeight, pixelDepth, layerCount, faceCount, levelCount, supercompressionScheme.
+	u32 header[9];
+	for (int i = 0; i < 9; ++i) {
+		if (!ReadU32(data, size, 12 + i * 4, header[i]))
+			return false;
+	}
+	// Supercompressed (Basis, zstd) files would need transcoding, which defeats the purpose.
+	if (header[4] > 1 || header[5] > 1 || header[6] != 1 || header[8] != 0)
+		return false;
+
+	// VkFormat values, both UNORM and SRGB (sampled as UNORM, like PNGs.)
+	switch (header[0]) {
+	case 131: case 132: case 133: case 134: fmt = ReplacedTextureFormat::F_BC1; break;
+	case 137: case 138: fmt = ReplacedTextureFormat::F_BC3; break;
+	case 145: case 146: fmt = ReplacedTextureFormat::F_BC7; break;
+	case 151: case 152: fmt = ReplacedTextureFormat::F_ETC2_RGBA; break;
+	case 157: case 158: fmt = ReplacedTextureFormat::F_ASTC_4x4; break;
+	default: return false;
+	}
+	w = (int)header[2];
+	h = (int)header[3];
+
+	// The level index follows the dfd, kvd and sgd offsets.
+	u32 levelCount = std::max(header[7], 1U);
+	for (u32 i = 0; i < levelCount; ++i) {
+		u64 offset, levelSize;
+		if (!ReadU64(data, size, 80 + i * 24, offset) || !ReadU64(data, size, 80 + i * 24 + 8, levelSize))
+			return false;
+		if (offset + levelSize > 0xFFFFFFFFULL)
+			return false;
+		levels.push_back(CompressedImageLevel{ (u32)offset, (u32)levelSize });
+	}
+	return true;
+}
+
+void TextureReplacer::SetSupportedCompressedFormats(const std::vector<ReplacedTextureFormat> &formats) {
+	compressedFormats_ = 0;
+	for (ReplacedTextureFormat fmt : formats)
+		compressedFormats_ |= 1 << (int)fmt;
+}
+
+bool TextureReplacer::FindFile(const std::string &hashfile, ReplacedTextureLevel &level) {
+	level.file = basePath_ / hashfile;
+	if (pack_ && pack_->Find(hashfile, &level.packOffset, &level.packSize)) {
+		level.pack = pack_;
+		return true;
+	}
+	level.pack = nullptr;
+	return File::Exists(level.file);
+}
+
+bool TextureReplacer::PopulateLevel(ReplacedTextureLevel &level, const std::string &hashfile, std::vector<ReplacedTextureLevel> *containerMips) {
+	bool good = false;
+
+	std::vector<u8> buf;
+	size_t size = 0;
+	u64 fileSize = 0;
+	const u8 *header = ReadReplacementFile(level, 0, HEADER_READ_SIZE, buf, &size, &fileSize);
+	if (!header) {
+		ERROR_LOG(G3D, "Could not open texture replacement: %s", level.file.ToVisualString().c_str());
+		return false;
+	}
+	auto imageType = Identify(header, size);
 	if (imageType == ReplacedImageType::ZIM) {
-		fseek(fp, 4, SEEK_SET);
-		good = fread(&level.w, 4, 1, fp) == 1;
-		good = good && fread(&level.h, 4, 1, fp) == 1;
-		int flags;
-		if (good && fread(&flags, 4, 1, fp) == 1) {
+		u32 w, h, flags;
+		good = ReadU32(header, size, 4, w) && ReadU32(header, size, 8, h) && ReadU32(header, size, 12, flags);
+		if (good) {
+			level.w = (int)w;
+			level.h = (int)h;
 			good = (flags & ZIM_FORMAT_MASK) == ZIM_RGBA8888;
 		}
 	} else if (imageType == ReplacedImageType::PNG) {
-		png_image png = {};
-		png.version = PNG_IMAGE_VERSION;
-		if (png_image_begin_read_from_stdio(&png, fp)) {
+		// The IHDR chunk always comes first, with the big endian size. The full read checks the rest.
+		if (size >= 24 && memcmp(header + 12, "IHDR", 4) == 0) {
 			// We pad files that have been hashrange'd so they are the same texture size.
-			level.w = png.width;
-			level.h = png.height;
+			level.w = (header[16] << 24) | (header[17] << 16) | (header[18] << 8) | header[19];
+			level.h = (header[20] << 24) | (header[21] << 16) | (header[22] << 8) | header[23];
 			good = true;
 		} else {
-			ERROR_LOG(G3D, "Could not load texture replacement info: %s - %s", level.file.ToVisualString().c_str(), png.message);
+			ERROR_LOG(G3D, "Could not load texture replacement info: %s - invalid PNG header", level.file.ToVisualString().c_str());
+		}
+	} else if (imageType == ReplacedImageType::DDS || imageType == ReplacedImageType::KTX2) {
+		std::vector<CompressedImageLevel> levels;
+		ReplacedTextureFormat fmt;
+		int w = 0, h = 0;
+		if (imageType == ReplacedImageType::DDS)
+			good = ReadDDSHeader(header, size, fmt, w, h, levels);
+		else
+			good = ReadKTX2Header(header, size, fmt, w, h, levels);
+
+		if (!good) {
+			ERROR_LOG(G3D, "Could not load texture replacement info: %s - unsupported compressed format", level.file.ToVisualString().c_str());
+		} else if ((compressedFormats_ & (1 << (int)fmt)) == 0) {
+			size_t dot = hashfile.find_last_of('.');
+			std::string fallback = (dot == hashfile.npos ? hashfile : hashfile.substr(0, dot)) + ".png";
+			if (fallback != hashfile && FindFile(fallback, level)) {
+				return PopulateLevel(level, fallback, nullptr);
+			}
+			WARN_LOG(G3D, "Texture replacement format not supported by this GPU and no .png fallback: %s", level.file.ToVisualString().c_str());
+			return false;
+		} else {
+			for (size_t i = 0; i < levels.size() && good; ++i) {
+				int mipW = std::max(w >> i, 1);
+				int mipH = std::max(h >> i, 1);
+				size_t needed = (size_t)ReplacedFormatRowBytes(fmt, mipW) * ReplacedFormatRows(fmt, mipH);
+				if (levels[i].size < needed || (u64)levels[i].offset + levels[i].size > fileSize) {
+					// Truncated or odd file, just use the levels before this one.
+					if (i == 0)
+						good = false;
+					break;
+				}
+
+				ReplacedTextureLevel mip = level;
+				mip.w = mipW;
+				mip.h = mipH;
+				mip.fmt = fmt;
+				mip.dataOffset = levels[i].offset;
+				mip.dataSize = (u32)needed;
+				if (i == 0)
+					level = mip;
+				else if (containerMips)
+					containerMips->push_back(mip);
+			}
+			if (!good)
+				ERROR_LOG(G3D, "Could not load texture replacement info: %s - truncated", level.file.ToVisualString().c_str());
 		}
-		png_image_free(&png);
 	} else {
 		ERROR_LOG(G3D, "Could not load texture replacement info: %s - unsupported format", level.file.ToVisualString().c_str());
 	}
-	fclose(fp);
 
 	return good;
 }
 
-static bool WriteTextureToPNG(png_imagep image, const Path &filename, int convert_to_8bit, const void *buffer, png_int_32 row_stride, const void *colormap) {
+// Dumps are encoded and written on IO threads.  These keep a busy scene from queueing up
+// an unbounded amount of texture data, the GPU thread waits instead once we're over.
+static const int MAX_PENDING_TEXTURE_SAVES = 32;
+static const size_t MAX_PENDING_TEXTURE_SAVE_BYTES = 64 * 1024 * 1024;
+static const size_t MAX_POOLED_SAVE_BUFFERS = 8;
+
+static std::mutex textureSaveLock;
+static std::condition_variable textureSaveCond;
+// By filename, so we don't queue the same texture again while it's being written.
+static std::unordered_set<std::string> textureSavesInFlight;
+static size_t textureSaveBytesInFlight = 0;
+static std::vector<std::vector<u8>> textureSaveBufferPool;
+
+static void WaitForTextureSaves() {
+	std::unique_lock<std::mutex> guard(textureSaveLock);
+	textureSaveCond.wait(guard, [] { return textureSavesInFlight.empty(); });
+}
+
+static bool WriteTextureToPNG(const Path &filename, const u8 *rgba, int w, int h) {
 	FILE *fp = File::OpenCFile(filename, "wb");
 	if (!fp) {
 		ERROR_LOG(IO, "Unable to open texture file for writing.");
 		return false;
 	}
 
-	if (png_image_write_to_stdio(image, fp, convert_to_8bit, buffer, row_stride, colormap)) {
-		fclose(fp);
-		return true;
-	} else {
+	png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+	png_infop info = png ? png_create_info_struct(png) : nullptr;
+	if (!info || setjmp(png_jmpbuf(png))) {
 		ERROR_LOG(SYSTEM, "Texture PNG encode failed.");
+		png_destroy_write_struct(&png, info ? &info : nullptr);
 		fclose(fp);
-		remove(filename.c_str());
+		File::Delete(filename);
 		return false;
 	}
+
+	png_init_io(png, fp);
+	// These are for pack authors to edit, so a quick write matters more than the file size.
+	png_set_compression_level(png, 1);
+	png_set_IHDR(png, info, w, h, 8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+	png_write_info(png, info);
+	for (int y = 0; y < h; ++y) {
+		png_write_row(png, (png_const_bytep)(rgba + (size_t)y * w * 4));
+	}
+	png_write_end(png, nullptr);
+	png_destroy_write_struct(&png, &info);
+	fclose(fp);
+	return true;
 }
 
+class TextureSaveTask : public Task {
+public:
+	TextureSaveTask(std::vector<u8> &&data, ReplacedTextureFormat fmt, int w, int h, u32 hash, const Path &filename, const Path &directory)
+		: data_(std::move(data)), fmt_(fmt), w_(w), h_(h), hash_(hash), filename_(filename), directory_(directory) {
+	}
+
+	TaskType Type() const override {
+		return TaskType::IO_BLOCKING;
+	}
+
+	void Run() override {
+		if (!directory_.empty() && !File::Exists(directory_)) {
+			// Create any directory structure as needed.
+			File::CreateFullPath(directory_);
+			File::CreateEmptyFile(directory_ / ".nomedia");
+		}
+
+		const u8 *rgba = data_.data();
+		std::vector<u8> converted;
+		if (fmt_ != ReplacedTextureFormat::F_8888) {
+			const u32 pixels = (u32)(w_ * h_);
+			converted.resize(pixels * 4);
+			u32 *dst = (u32 *)converted.data();
+			const u16 *src16 = (const u16 *)data_.data();
+			switch (fmt_) {
+			case ReplacedTextureFormat::F_5650:
+				ConvertRGB565ToRGBA8888(dst, src16, pixels);
+				break;
+			case ReplacedTextureFormat::F_5551:
+				ConvertRGBA5551ToRGBA8888(dst, src16, pixels);
+				break;
+			case ReplacedTextureFormat::F_4444:
+				ConvertRGBA4444ToRGBA8888(dst, src16, pixels);
+				break;
+			case ReplacedTextureFormat::F_0565_ABGR:
+				ConvertBGR565ToRGBA8888(dst, src16, pixels);
+				break;
+			case ReplacedTextureFormat::F_1555_ABGR:
+				ConvertABGR1555ToRGBA8888(dst, src16, pixels);
+				break;
+			case ReplacedTextureFormat::F_4444_ABGR:
+				ConvertABGR4444ToRGBA8888(dst, src16, pixels);
+				break;
+			case ReplacedTextureFormat::F_8888_BGRA:
+				ConvertBGRA8888ToRGBA8888(dst, (const u32 *)data_.data(), pixels);
+				break;
+			default:
+				// Other formats are never sent for saving.
+				break;
+			}
+			rgba = converted.data();
+		}
+
+		if (WriteTextureToPNG(filename_, rgba, w_, h_)) {
+			NOTICE_LOG(G3D, "Saving texture for replacement: %08x / %dx%d", hash_, w_, h_);
+		}
+
+		std::lock_guard<std::mutex> guard(textureSaveLock);
+		textureSavesInFlight.erase(filename_.ToString());
+		textureSaveBytesInFlight -= data_.size();
+		if (textureSaveBufferPool.size() < MAX_POOLED_SAVE_BUFFERS) {
+			data_.clear();
+			textureSaveBufferPool.push_back(std::move(data_));
+		}
+		textureSaveCond.notify_all();
+	}
+
+private:
+	std::vector<u8> data_;
+	ReplacedTextureFormat fmt_;
+	int w_;
+	int h_;
+	u32 hash_;
+	Path filename_;
+	Path directory_;
+};
+
 void TextureReplacer::NotifyTextureDecoded(const ReplacedTextureDecodeInfo &replacedInfo, const void *data, int pitch, int level, int w, int h) {
 	_assert_msg_(enabled_, "Replacement not enabled");
 	if (!g_Config.bSaveNewTextures) {
@@ -523,15 +980,24 @@ void TextureReplacer::NotifyTextureDecoded(const ReplacedTextureDecodeInfo &repl
 	}
 
 	std::string hashfile = LookupHashFile(cachekey, replacedInfo.hash, level);
-	const Path filename = basePath_ / hashfile;
 	const Path saveFilename = basePath_ / NEW_TEXTURE_DIR / hashfile;
 
 	// If it's empty, it's an ignored hash, we intentionally don't save.
-	if (hashfile.empty() || File::Exists(filename)) {
+	ReplacedTextureLevel existing;
+	if (hashfile.empty() || FindFile(hashfile, existing)) {
 		// If it exists, must've been decoded and saved as a new texture already.
 		return;
 	}
 
+	const std::string saveKey = saveFilename.ToString();
+	{
+		std::lock_guard<std::mutex> guard(textureSaveLock);
+		if (textureSavesInFlight.count(saveKey)) {
+			// Still being written, no need to check the disk.
+			return;
+		}
+	}
+
 	ReplacementCacheKey replacementKey(cachekey, replacedInfo.hash);
 	auto it = savedCache_.find(replacementKey);
 	if (it != savedCache_.end() && File::Exists(saveFilename)) {
@@ -541,18 +1007,14 @@ void TextureReplacer::NotifyTextureDecoded(const ReplacedTextureDecodeInfo &repl
 		}
 	}
 
+	Path saveDirectory;
 #ifdef _WIN32
 	size_t slash = hashfile.find_last_of("/\\");
 #else
 	size_t slash = hashfile.find_last_of("/");
 #endif
 	if (slash != hashfile.npos) {
-		// Create any directory structure as needed.
-		const Path saveDirectory = basePath_ / NEW_TEXTURE_DIR / hashfile.substr(0, slash);
-		if (!File::Exists(saveDirectory)) {
-			File::CreateFullPath(saveDirectory);
-			File::CreateEmptyFile(saveDirectory / ".nomedia");
-		}
+		saveDirectory = basePath_ / NEW_TEXTURE_DIR / hashfile.substr(0, slash);
 	}
 
 	// Only save the hashed portion of the PNG.
@@ -563,61 +1025,36 @@ void TextureReplacer::NotifyTextureDecoded(const ReplacedTextureDecodeInfo &repl
 		h = lookupH * replacedInfo.scaleFactor;
 	}
 
-	if (replacedInfo.fmt != ReplacedTextureFormat::F_8888) {
-		saveBuf.resize((pitch * h) / sizeof(u16));
-		switch (replacedInfo.fmt) {
-		case ReplacedTextureFormat::F_5650:
-			ConvertRGB565ToRGBA8888(saveBuf.data(), (const u16 *)data, (pitch * h) / sizeof(u16));
-			break;
-		case ReplacedTextureFormat::F_5551:
-			ConvertRGBA5551ToRGBA8888(saveBuf.data(), (const u16 *)data, (pitch * h) / sizeof(u16));
-			break;
-		case ReplacedTextureFormat::F_4444:
-			ConvertRGBA4444ToRGBA8888(saveBuf.data(), (const u16 *)data, (pitch * h) / sizeof(u16));
-			break;
-		case ReplacedTextureFormat::F_0565_ABGR:
-			ConvertBGR565ToRGBA8888(saveBuf.data(), (const u16 *)data, (pitch * h) / sizeof(u16));
-			break;
-		case ReplacedTextureFormat::F_1555_ABGR:
-			ConvertABGR1555ToRGBA8888(saveBuf.data(), (const u16 *)data, (pitch * h) / sizeof(u16));
-			break;
-		case ReplacedTextureFormat::F_4444_ABGR:
-			ConvertABGR4444ToRGBA8888(saveBuf.data(), (const u16 *)data, (pitch * h) / sizeof(u16));
-			break;
-		case ReplacedTextureFormat::F_8888_BGRA:
-			ConvertBGRA8888ToRGBA8888(saveBuf.data(), (const u32 *)data, (pitch * h) / sizeof(u32));
-			break;
-		case ReplacedTextureFormat::F_8888:
-			// Impossible.  Just so we can get warnings on other missed formats.
-			break;
-		}
-
-		data = saveBuf.data();
-		if (replacedInfo.fmt != ReplacedTextureFormat::F_8888_BGRA) {
-			// We doubled our pitch.
-			pitch *= 2;
+	const bool is32bit = replacedInfo.fmt == ReplacedTextureFormat::F_8888 || replacedInfo.fmt == ReplacedTextureFormat::F_8888_BGRA;
+	const size_t rowBytes = (size_t)w * (is32bit ? 4 : 2);
+	const size_t bytes = rowBytes * h;
+
+	std::vector<u8> buffer;
+	{
+		std::unique_lock<std::mutex> guard(textureSaveLock);
+		// Back-pressure: rather than dropping dumps, wait for the writers to catch up.
+		textureSaveCond.wait(guard, [] {
+			return textureSavesInFlight.size() < MAX_PENDING_TEXTURE_SAVES && textureSaveBytesInFlight < MAX_PENDING_TEXTURE_SAVE_BYTES;
+		});
+		textureSavesInFlight.insert(saveKey);
+		textureSaveBytesInFlight += bytes;
+		if (!textureSaveBufferPool.empty()) {
+			buffer = std::move(textureSaveBufferPool.back());
+			textureSaveBufferPool.pop_back();
 		}
 	}
 
-	png_image png;
-	memset(&png, 0, sizeof(png));
-	png.version = PNG_IMAGE_VERSION;
-	png.format = PNG_FORMAT_RGBA;
-	png.width = w;
-	png.height = h;
-	bool success = WriteTextureToPNG(&png, saveFilename, 0, data, pitch, nullptr);
-	png_image_free(&png);
-
-	if (png.warning_or_error >= 2) {
-		ERROR_LOG(COMMON, "Saving screenshot to PNG produced errors.");
-	} else if (success) {
-		NOTICE_LOG(G3D, "Saving texture for replacement: %08x / %dx%d", replacedInfo.hash, w, h);
+	// Conversion and encoding happen on the task, just grab the rows while the data is still valid.
+	buffer.resize(bytes);
+	for (int y = 0; y < h; ++y) {
+		memcpy(&buffer[y * rowBytes], (const u8 *)data + (size_t)y * pitch, rowBytes);
 	}
+	g_threadManager.EnqueueTask(new TextureSaveTask(std::move(buffer), replacedInfo.fmt, w, h, replacedInfo.hash, saveFilename, saveDirectory));
 
 	// Remember that we've saved this for next time.
 	ReplacedTextureLevel saved;
 	saved.fmt = ReplacedTextureFormat::F_8888;
-	saved.file = filename;
+	saved.file = basePath_ / hashfile;
 	saved.w = w;
 	saved.h = h;
 	savedCache_[replacementKey] = saved;
@@ -627,8 +1064,26 @@ void TextureReplacer::Decimate(bool forcePressure) {
 	// Allow replacements to be cached for a long time, although they're large.
 	const double age = forcePressure ? 90.0 : 1800.0;
 	const double threshold = time_now_d() - age;
+
+	// Groups are purged together, so they can be preloaded together again.
+	std::unordered_set<ReplacementCacheKey> keep;
+	for (const auto &group : preloadGroups_) {
+		auto lastUsed = [&](const ReplacementCacheKey &key) {
+			auto it = cache_.find(key);
+			return it != cache_.end() ? it->second.lastUsed_ : 0.0;
+		};
+		double groupLastUsed = lastUsed(group.first);
+		for (const ReplacementCacheKey &member : group.second)
+			groupLastUsed = std::max(groupLastUsed, lastUsed(member));
+		if (groupLastUsed >= threshold) {
+			keep.insert(group.first);
+			keep.insert(group.second.begin(), group.second.end());
+		}
+	}
+
 	for (auto &item : cache_) {
-		item.second.PurgeIfOlder(threshold);
+		if (keep.find(item.first) == keep.end())
+			item.second.PurgeIfOlder(threshold);
 	}
 }
 
@@ -753,7 +1208,7 @@ class LimitedWaitable : public Waitable {
 	void Wait() override {
 		if (!triggered_) {
 			std::unique_lock<std::mutex> lock(mutex_);
-			cond_.wait(lock, [&] { return !triggered_; });
+			cond_.wait(lock, [&] { return triggered_.load(); });
 		}
 	}
 
@@ -763,7 +1218,7 @@ class LimitedWaitable : public Waitable {
 			if (us == 0)
 				return false;
 			std::unique_lock<std::mutex> lock(mutex_);
-			cond_.wait_for(lock, std::chrono::microseconds(us), [&] { return !triggered_; });
+			cond_.wait_for(lock, std::chrono::microseconds(us), [&] { return triggered_.load(); });
 		}
 		return triggered_;
 	}
@@ -802,7 +1257,11 @@ class ReplacedTextureTask : public Task {
 bool ReplacedTexture::IsReady(double budget) {
 	lastUsed_ = time_now_d();
 	if (threadWaitable_) {
-		if (!threadWaitable_->WaitFor(budget)) {
+		if (!g_Config.bReplaceTexturesAllowLate) {
+			// Must've been preloading. Can't show the original texture meanwhile, so wait it out.
+			threadWaitable_->WaitAndRelease();
+			threadWaitable_ = nullptr;
+		} else if (!threadWaitable_->WaitFor(budget)) {
 			return false;
 		} else {
 			threadWaitable_->WaitAndRelease();
@@ -818,8 +1277,7 @@ bool ReplacedTexture::IsReady(double budget) {
 		return false;
 
 	if (g_Config.bReplaceTexturesAllowLate) {
-		threadWaitable_ = new LimitedWaitable();
-		g_threadManager.EnqueueTask(new ReplacedTextureTask(*this, threadWaitable_));
+		PrepareAsync();
 
 		if (threadWaitable_->WaitFor(budget)) {
 			threadWaitable_->WaitAndRelease();
@@ -837,6 +1295,26 @@ bool ReplacedTexture::IsReady(double budget) {
 	return false;
 }
 
+static int64_t LevelDataBytes(const std::vector<std::vector<uint8_t>> &levelData) {
+	int64_t bytes = 0;
+	for (const auto &data : levelData)
+		bytes += data.size();
+	return bytes;
+}
+
+void ReplacedTexture::PrepareAsync() {
+	lastUsed_ = time_now_d();
+	threadWaitable_ = new LimitedWaitable();
+	g_threadManager.EnqueueTask(new ReplacedTextureTask(*this, threadWaitable_));
+}
+
+int64_t ReplacedTexture::EstimateBytes() const {
+	int64_t bytes = 0;
+	for (const ReplacedTextureLevel &level : levels_)
+		bytes += ReplacedFormatIsCompressed(level.fmt) ? level.dataSize : (int64_t)level.w * level.h * 4;
+	return bytes;
+}
+
 void ReplacedTexture::Prepare() {
 	levelData_.resize(MaxLevel() + 1);
 	for (int i = 0; i <= MaxLevel(); ++i) {
@@ -844,6 +1322,7 @@ void ReplacedTexture::Prepare() {
 			break;
 		PrepareData(i);
 	}
+	MemoryUsage_Add(MemoryCategory::TEXTURE_REPLACEMENTS, LevelDataBytes(levelData_));
 }
 
 void ReplacedTexture::PrepareData(int level) {
@@ -852,34 +1331,35 @@ void ReplacedTexture::PrepareData(int level) {
 	const ReplacedTextureLevel &info = levels_[level];
 	std::vector<uint8_t> &out = levelData_[level];
 
-	FILE *fp = File::OpenCFile(info.file, "rb");
-	if (!fp) {
+	std::vector<u8> buf;
+	size_t size = 0;
+	if (ReplacedFormatIsCompressed(info.fmt)) {
+		// Sizes were checked against the file when populating.
+		const u8 *data = ReadReplacementFile(info, info.dataOffset, info.dataSize, buf, &size, nullptr);
+		if (!data || size != info.dataSize) {
+			// Leaving the data sized at zero means failure.
+			ERROR_LOG(G3D, "Could not load texture replacement: %s - failed to read", info.file.c_str());
+			return;
+		}
+		out.assign(data, data + size);
+		// Checking alpha would mean decoding, so we leave it unknown.
+		return;
+	}
+
+	const u8 *data = ReadReplacementFile(info, 0, (size_t)-1, buf, &size, nullptr);
+	if (!data) {
 		// Leaving the data sized at zero means failure.
 		return;
 	}
 
-	auto imageType = Identify(fp);
+	auto imageType = Identify(data, size);
 	if (imageType == ReplacedImageType::ZIM) {
-		size_t zimSize = File::GetFileSize(fp);
-		std::unique_ptr<uint8_t[]> zim(new uint8_t[zimSize]);
-		if (!zim) {
-			ERROR_LOG(G3D, "Failed to allocate memory for texture replacement");
-			fclose(fp);
-			return;
-		}
-
-		if (fread(&zim[0], 1, zimSize, fp) != zimSize) {
-			ERROR_LOG(G3D, "Could not load texture replacement: %s - failed to read ZIM", info.file.c_str());
-			fclose(fp);
-			return;
-		}
-
 		int w, h, f;
 		uint8_t *image;
-		if (LoadZIMPtr(&zim[0], zimSize, &w, &h, &f, &image)) {
+		if (LoadZIMPtr(data, size, &w, &h, &f, &image)) {
 			if (w > info.w || h > info.h) {
 				ERROR_LOG(G3D, "Texture replacement changed since header read: %s", info.file.c_str());
-				fclose(fp);
+				free(image);
 				return;
 			}
 
@@ -892,24 +1372,23 @@ void ReplacedTexture::PrepareData(int level) {
 				}
 			}
 			free(image);
-		}
 
-		CheckAlphaResult res = CheckAlphaRGBA8888Basic((u32 *)&out[0], info.w, w, h);
-		if (res == CHECKALPHA_ANY || level == 0) {
-			alphaStatus_ = ReplacedTextureAlpha(res);
+			CheckAlphaResult res = CheckAlphaRGBA8888Basic((u32 *)&out[0], info.w, w, h);
+			if (res == CHECKALPHA_ANY || level == 0) {
+				alphaStatus_ = ReplacedTextureAlpha(res);
+			}
 		}
 	} else if (imageType == ReplacedImageType::PNG) {
 		png_image png = {};
 		png.version = PNG_IMAGE_VERSION;
 
-		if (!png_image_begin_read_from_stdio(&png, fp)) {
+		if (!png_image_begin_read_from_memory(&png, data, size)) {
 			ERROR_LOG(G3D, "Could not load texture replacement info: %s - %s", info.file.c_str(), png.message);
-			fclose(fp);
 			return;
 		}
 		if (png.width > (uint32_t)info.w || png.height > (uint32_t)info.h) {
 			ERROR_LOG(G3D, "Texture replacement changed since header read: %s", info.file.c_str());
-			fclose(fp);
+			png_image_free(&png);
 			return;
 		}
 
@@ -926,7 +1405,6 @@ void ReplacedTexture::PrepareData(int level) {
 		out.resize(info.w * info.h * 4);
 		if (!png_image_finish_read(&png, nullptr, &out[0], info.w * 4, nullptr)) {
 			ERROR_LOG(G3D, "Could not load texture replacement: %s - %s", info.file.c_str(), png.message);
-			fclose(fp);
 			out.resize(0);
 			return;
 		}
@@ -940,12 +1418,16 @@ void ReplacedTexture::PrepareData(int level) {
 			}
 		}
 	}
-
-	fclose(fp);
 }
 
 void ReplacedTexture::PurgeIfOlder(double t) {
+	// A preload that finished, but was never used.
+	if (threadWaitable_ && threadWaitable_->WaitFor(0.0)) {
+		threadWaitable_->WaitAndRelease();
+		threadWaitable_ = nullptr;
+	}
 	if (lastUsed_ < t && !threadWaitable_) {
+		MemoryUsage_Add(MemoryCategory::TEXTURE_REPLACEMENTS, -LevelDataBytes(levelData_));
 		levelData_.clear();
 	}
 }
@@ -956,6 +1438,7 @@ ReplacedTexture::~ReplacedTexture() {
 		threadWaitable_->WaitAndRelease();
 		threadWaitable_ = nullptr;
 	}
+	MemoryUsage_Add(MemoryCategory::TEXTURE_REPLACEMENTS, -LevelDataBytes(levelData_));
 }
 
 bool ReplacedTexture::Load(int level, void *out, int rowPitch) {
@@ -970,17 +1453,20 @@ bool ReplacedTexture::Load(int level, void *out, int rowPitch) {
 
 	if (data.empty())
 		return false;
-	_assert_msg_(data.size() == info.w * info.h * 4, "Data has wrong size");
+	// For compressed formats, these are rows of blocks.
+	const int rowBytes = ReplacedFormatRowBytes(info.fmt, info.w);
+	const int rows = ReplacedFormatRows(info.fmt, info.h);
+	_assert_msg_(data.size() == (size_t)rowBytes * rows, "Data has wrong size");
 
-	if (rowPitch == info.w * 4) {
-		ParallelMemcpy(&g_threadManager, out, &data[0], info.w * 4 * info.h);
+	if (rowPitch == rowBytes) {
+		ParallelMemcpy(&g_threadManager, out, &data[0], rowBytes * rows);
 	} else {
 		const int MIN_LINES_PER_THREAD = 4;
 		ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
 			for (int y = l; y < h; ++y) {
-				memcpy((uint8_t *)out + rowPitch * y, &data[0] + info.w * 4 * y, info.w * 4);
+				memcpy((uint8_t *)out + rowPitch * y, &data[0] + rowBytes * y, rowBytes);
 			}
-		}, 0, info.h, MIN_LINES_PER_THREAD);
+		}, 0, rows, MIN_LINES_PER_THREAD);
 	}
 
 	return true;
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -29,6 +30,7 @@
 #include "GPU/Common/TextureDecoder.h"
 #include "GPU/ge_constants.h"
 
+class FileLoader;
 class IniFile;
 class TextureCacheCommon;
 class TextureReplacer;
@@ -44,8 +46,31 @@ enum class ReplacedTextureFormat {
 	F_1555_ABGR,
 	F_4444_ABGR,
 	F_8888_BGRA,
+
+	// Block compressed, 4x4 blocks. Only loaded from .dds/.ktx2 replacements, and uploaded as is.
+	F_BC1,
+	F_BC3,
+	F_BC7,
+	F_ETC2_RGBA,
+	F_ASTC_4x4,
 };
 
+inline bool ReplacedFormatIsCompressed(ReplacedTextureFormat fmt) {
+	return fmt >= ReplacedTextureFormat::F_BC1;
+}
+
+// Loaded replacements are either 8888 or block compressed.
+// For block compressed formats, these count rows of blocks rather than pixels.
+inline int ReplacedFormatRowBytes(ReplacedTextureFormat fmt, int w) {
+	if (!ReplacedFormatIsCompressed(fmt))
+		return w * 4;
+	return ((w + 3) / 4) * (fmt == ReplacedTextureFormat::F_BC1 ? 8 : 16);
+}
+
+inline int ReplacedFormatRows(ReplacedTextureFormat fmt, int h) {
+	return ReplacedFormatIsCompressed(fmt) ? (h + 3) / 4 : h;
+}
+
 // These must match the constants in TextureCacheCommon.
 enum class ReplacedTextureAlpha {
 	UNKNOWN = 0x04,
@@ -59,11 +84,47 @@ enum class ReplacedTextureHash {
 	XXH64,
 };
 
+struct TexturePackEntry {
+	// XXH3_64bits of the filename, as in textures.ini (relative, with forward slashes.)
+	u64 nameHash;
+	u64 offset;
+	u64 size;
+};
+
+// All the files of a texture directory in one, so loading doesn't need thousands of file opens.
+// Those are very slow with Android scoped storage. Made by Tools/texturetool pack.
+// A header ("PPTP", version, count, reserved) and the entries sorted by nameHash are followed by the
+// files, each 16-byte aligned. The pack is mapped where possible, so reads don't copy.
+class TexturePack {
+public:
+	TexturePack();
+	~TexturePack();
+
+	bool Open(const Path &filename);
+	bool Find(const std::string &name, u64 *offset, u64 *size) const;
+	// Points into the mapping, or reads into buf if the pack isn't mapped. nullptr on failure.
+	const u8 *Read(u64 offset, size_t size, std::vector<u8> &buf) const;
+
+private:
+	std::unique_ptr<FileLoader> loader_;
+	const TexturePackEntry *entries_ = nullptr;
+	u32 count_ = 0;
+	// The index, when the pack isn't mapped.
+	std::vector<TexturePackEntry> entryBuf_;
+};
+
 struct ReplacedTextureLevel {
 	int w;
 	int h;
 	ReplacedTextureFormat fmt;
 	Path file;
+	// Where the data is in the file, for compressed formats.
+	u32 dataOffset = 0;
+	u32 dataSize = 0;
+	// Set when the file is in the texture pack, rather than loose at file.
+	std::shared_ptr<TexturePack> pack;
+	u64 packOffset = 0;
+	u64 packSize = 0;
 };
 
 struct ReplacementCacheKey {
@@ -163,8 +224,15 @@ struct ReplacedTexture {
 
 protected:
 	void Prepare();
+	// Prepares on a thread, IsReady() picks up the result.
+	void PrepareAsync();
 	void PrepareData(int level);
 	void PurgeIfOlder(double t);
+	bool NeedsPrepare() const {
+		return !threadWaitable_ && levelData_.empty() && !levels_.empty();
+	}
+	// Memory the level data will take once prepared.
+	int64_t EstimateBytes() const;
 
 	std::vector<ReplacedTextureLevel> levels_;
 	std::vector<std::vector<uint8_t>> levelData_;
@@ -213,6 +281,10 @@ class TextureReplacer {
 
 	static bool GenerateIni(const std::string &gameID, Path &generatedFilename);
 
+	// Block compressed formats the backend can upload directly. Replacements in other formats
+	// are skipped in favor of a .png with the same name, if there is one.
+	void SetSupportedCompressedFormats(const std::vector<ReplacedTextureFormat> &formats);
+
 protected:
 	bool LoadIni();
 	bool LoadIniValues(IniFile &ini, bool isOverride = false);
@@ -224,9 +296,12 @@ class TextureReplacer {
 	std::string LookupHashFile(u64 cachekey, u32 hash, int level);
 	std::string HashName(u64 cachekey, u32 hash, int level);
 	void PopulateReplacement(ReplacedTexture *result, u64 cachekey, u32 hash, int w, int h);
-	bool PopulateLevel(ReplacedTextureLevel &level);
+	bool PopulateLevel(ReplacedTextureLevel &level, const std::string &hashfile, std::vector<ReplacedTextureLevel> *containerMips);
+	// Called when a replacement has to be loaded, to record and preload the ones used with it.
+	void NotifyLoading(const ReplacementCacheKey &key);
+	// Looks in the pack first, then for a loose file.
+	bool FindFile(const std::string &hashfile, ReplacedTextureLevel &level);
 
-	SimpleBuf<u32> saveBuf;
 	bool enabled_ = false;
 	bool allowVideo_ = false;
 	bool ignoreAddress_ = false;
@@ -234,8 +309,11 @@ class TextureReplacer {
 	float reduceHashSize = 1.0; // default value with reduceHash to false
 	float reduceHashGlobalValue = 0.5; // Global value for textures dump pngs of all sizes, 0.5 by default but can be set in textures.ini
 	bool ignoreMipmap_ = false;
+	// Bit per ReplacedTextureFormat.
+	uint32_t compressedFormats_ = 0;
 	std::string gameID_;
 	Path basePath_;
+	std::shared_ptr<TexturePack> pack_;
 	ReplacedTextureHash hash_ = ReplacedTextureHash::QUICK;
 	typedef std::pair<int, int> WidthHeightPair;
 	std::unordered_map<u64, WidthHeightPair> hashranges_;
@@ -246,4 +324,11 @@ class TextureReplacer {
 	ReplacedTexture none_;
 	std::unordered_map<ReplacementCacheKey, ReplacedTexture> cache_;
 	std::unordered_map<ReplacementCacheKey, ReplacedTextureLevel> savedCache_;
+
+	// Replacements that had to be loaded within a few frames after each one, so next time they
+	// can be loaded together (before they're needed.) Only the replacement starting a group has one.
+	std::unordered_map<ReplacementCacheKey, std::vector<ReplacementCacheKey>> preloadGroups_;
+	ReplacementCacheKey groupStart_{ 0, 0 };
+	int groupStartFrame_ = 0;
+	bool hasGroupStart_ = false;
 };
@@ -177,6 +177,9 @@ struct ThreadEventQueue : public B {
 protected:
 	virtual void ProcessEvent(Event ev) = 0;
 	virtual bool ShouldExitEventLoop() = 0;
+	// For queues that hand events off to other threads: wait for those to finish, so SyncThread() still
+	// means everything scheduled before it is done.
+	virtual void WaitForHandedOffEvents() {}
 
 	inline void ProcessEventIfApplicable(Event &ev, u64 &globalticks) {
 		switch (EventType(ev)) {
@@ -186,7 +189,8 @@ struct ThreadEventQueue : public B {
 			break;
 
 		case EVENT_SYNC:
-			// Nothing special to do, this event it just to wait on, see SyncThread.
+			// This event is just to wait on, see SyncThread.
+			WaitForHandedOffEvents();
 			break;
 
 		default:
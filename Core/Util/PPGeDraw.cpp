@@ -128,6 +128,32 @@ struct PPGeTextDrawerImage {
 	u32 ptr;
 };
 static std::map<PPGeTextDrawerCacheKey, PPGeTextDrawerImage> textDrawerImages;
+struct PPGeTextMeasureCacheKey {
+	bool operator < (const PPGeTextMeasureCacheKey &other) const {
+		if (align != other.align)
+			return align < other.align;
+		if (scale != other.scale)
+			return scale < other.scale;
+		if (width != other.width)
+			return width < other.width;
+		if (height != other.height)
+			return height < other.height;
+		return text < other.text;
+	}
+	std::string text;
+	int align;
+	float scale;
+	// Negative means measured without a rect.
+	float width;
+	float height;
+};
+struct PPGeTextMeasure {
+	float w;
+	float h;
+	int lastUsedFrame;
+};
+// Dialogs measure the same strings every frame, and that's not cheap on most TextDrawers.
+static std::map<PPGeTextMeasureCacheKey, PPGeTextMeasure> textDrawerMeasures;
 
 void PPGeSetDrawContext(Draw::DrawContext *draw) {
 	g_draw = draw;
@@ -293,6 +319,7 @@ void __PPGeInit() {
 	textDrawerInited = PSP_CoreParameter().headLess;
 	textDrawer = nullptr;
 	textDrawerImages.clear();
+	textDrawerMeasures.clear();
 
 	atlasRequiresReset = false;
 
@@ -371,6 +398,9 @@ void __PPGeDoState(PointerWrap &p)
 
 	Do(p, char_lines);
 	Do(p, char_lines_metrics);
+
+	if (p.mode == PointerWrap::MODE_READ)
+		textDrawerMeasures.clear();
 }
 
 void __PPGeShutdown()
@@ -400,6 +430,7 @@ void __PPGeShutdown()
 	for (auto im : textDrawerImages)
 		kernelMemory.Free(im.second.ptr);
 	textDrawerImages.clear();
+	textDrawerMeasures.clear();
 }
 
 void PPGeBegin()
@@ -758,6 +789,25 @@ static bool HasTextDrawer() {
 	return textDrawer != nullptr;
 }
 
+// Like TextDrawer::MeasureStringRect (or MeasureString without bounds), but remembers the result.
+static void PPGeMeasureTextDrawer(const std::string &text, float scale, const Bounds *bounds, int align, float *w, float *h) {
+	PPGeTextMeasureCacheKey key{ text, align, scale, bounds ? bounds->w : -1.0f, bounds ? bounds->h : -1.0f };
+	auto cacheItem = textDrawerMeasures.find(key);
+	if (cacheItem != textDrawerMeasures.end()) {
+		cacheItem->second.lastUsedFrame = gpuStats.numFlips;
+		*w = cacheItem->second.w;
+		*h = cacheItem->second.h;
+		return;
+	}
+
+	textDrawer->SetFontScale(scale, scale);
+	if (bounds)
+		textDrawer->MeasureStringRect(text.c_str(), text.size(), *bounds, w, h, align);
+	else
+		textDrawer->MeasureString(text.c_str(), text.size(), w, h);
+	textDrawerMeasures[key] = PPGeTextMeasure{ *w, *h, gpuStats.numFlips };
+}
+
 static std::string PPGeSanitizeText(const std::string &text) {
 	return SanitizeUTF8(text);
 }
@@ -769,12 +819,11 @@ void PPGeMeasureText(float *w, float *h, const char *text, float scale, int Wrap
 		std::string s2 = ReplaceAll(s, "&", "&&");
 
 		float mw, mh;
-		textDrawer->SetFontScale(scale, scale);
 		int dtalign = (WrapType & PPGE_LINE_WRAP_WORD) ? FLAG_WRAP_TEXT : 0;
 		if (WrapType & PPGE_LINE_USE_ELLIPSIS)
 			dtalign |= FLAG_ELLIPSIZE_TEXT;
 		Bounds b(0, 0, wrapWidth <= 0 ? 480.0f : wrapWidth, 272.0f);
-		textDrawer->MeasureStringRect(s2.c_str(), s2.size(), b, &mw, &mh, dtalign);
+		PPGeMeasureTextDrawer(s2, scale, &b, dtalign, &mw, &mh);
 
 		if (w)
 			*w = mw;
@@ -961,6 +1010,13 @@ static void PPGeDecimateTextImages(int age) {
 			++it;
 		}
 	}
+	for (auto it = textDrawerMeasures.begin(); it != textDrawerMeasures.end(); ) {
+		if (gpuStats.numFlips - it->second.lastUsedFrame >= age) {
+			it = textDrawerMeasures.erase(it);
+		} else {
+			++it;
+		}
+	}
 }
 
 void PPGeDrawText(const char *text, float x, float y, const PPGeStyle &style) {
@@ -1029,16 +1085,16 @@ void PPGeDrawTextWrapped(const char *text, float x, float y, float wrapWidth, fl
 		float actualWidth, actualHeight;
 		Bounds b(0, 0, wrapWidth <= 0 ? 480.0f - x : wrapWidth, wrapHeight);
 		int tdalign = 0;
-		textDrawer->SetFontScale(style.scale, style.scale);
-		textDrawer->MeasureStringRect(s2.c_str(), s2.size(), b, &actualWidth, &actualHeight, tdalign | FLAG_WRAP_TEXT);
+		PPGeMeasureTextDrawer(s2, style.scale, &b, tdalign | FLAG_WRAP_TEXT, &actualWidth, &actualHeight);
 
 		// Check if we need to scale the text down to fit better.
 		PPGeStyle adjustedStyle = style;
 		if (wrapHeight != 0.0f && actualHeight > wrapHeight) {
 			// Cheap way to get the line height.
 			float oneLine, twoLines;
-			textDrawer->MeasureString("|", 1, &actualWidth, &oneLine);
-			textDrawer->MeasureStringRect("|\n|", 3, Bounds(0, 0, 480, 272), &actualWidth, &twoLines);
+			Bounds twoLineBounds(0, 0, 480, 272);
+			PPGeMeasureTextDrawer("|", style.scale, nullptr, 0, &actualWidth, &oneLine);
+			PPGeMeasureTextDrawer("|\n|", style.scale, &twoLineBounds, 0, &actualWidth, &twoLines);
 
 			float lineHeight = twoLines - oneLine;
 			if (actualHeight > wrapHeight * maxScaleDown) {
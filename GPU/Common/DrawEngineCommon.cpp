@@ -15,8 +15,21 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include "ppsspp_config.h"
+
 #include <algorithm>
 
+#ifdef _M_SSE
+#include <emmintrin.h>
+#endif
+#if PPSSPP_ARCH(ARM_NEON)
+#if defined(_MSC_VER) && PPSSPP_ARCH(ARM64)
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
 #include "Common/Data/Convert/ColorConv.h"
 #include "Common/Profiler/Profiler.h"
 #include "Core/Config.h"
@@ -81,6 +94,8 @@ int DrawEngineCommon::ComputeNumVertsToDecode() const {
 			for (int j = i + 1; j < total; ++j) {
 				if (drawCalls[j].verts != dc.verts)
 					break;
+				if (batchedMaterialColors_ && drawCalls[j].materialColor != dc.materialColor)
+					break;
 
 				indexLowerBound = std::min(indexLowerBound, (int)drawCalls[j].indexLowerBound);
 				indexUpperBound = std::max(indexUpperBound, (int)drawCalls[j].indexUpperBound);
@@ -94,6 +109,7 @@ int DrawEngineCommon::ComputeNumVertsToDecode() const {
 }
 
 void DrawEngineCommon::DecodeVerts(u8 *dest) {
+	GPUStatsTimer timer(&gpuStats.msDecodingVertices);
 	const UVScale origUV = gstate_c.uv;
 	for (; decodeCounter_ < numDrawCalls; decodeCounter_++) {
 		gstate_c.uv = drawCalls[decodeCounter_].uvScale;
@@ -142,6 +158,57 @@ static void PlanesFromMatrix(float mtx[16], Plane planes[6]) {
 	planes[5].Set(mtx[3]-mtx[2], mtx[7]-mtx[6], mtx[11]-mtx[10], mtx[15]-mtx[14]); // Far
 }
 
+// Returns false if all the points are on the outside of any one plane.
+// Note that NaN counts as inside, like in the scalar !(value < 0) test.
+static bool AnyPointsInsidePlanes(const float *verts, int count, const Plane planes[6]) {
+	// Up to 64 points (the max for GE_CMD_BOUNDINGBOX), rearranged so four are tested at once.
+	float xs[64], ys[64], zs[64];
+	int simdCount = std::min(count, 64) & ~3;
+	for (int i = 0; i < simdCount; ++i) {
+		xs[i] = verts[i * 3 + 0];
+		ys[i] = verts[i * 3 + 1];
+		zs[i] = verts[i * 3 + 2];
+	}
+
+	for (int plane = 0; plane < 6; plane++) {
+		const Plane &p = planes[plane];
+		bool anyInside = false;
+		int i = 0;
+#if defined(_M_SSE)
+		const __m128 px = _mm_set1_ps(p.x), py = _mm_set1_ps(p.y), pz = _mm_set1_ps(p.z), pw = _mm_set1_ps(p.w);
+		__m128 inside = _mm_setzero_ps();
+		for (; i < simdCount; i += 4) {
+			__m128 value = _mm_add_ps(_mm_mul_ps(px, _mm_loadu_ps(xs + i)), pw);
+			value = _mm_add_ps(value, _mm_mul_ps(py, _mm_loadu_ps(ys + i)));
+			value = _mm_add_ps(value, _mm_mul_ps(pz, _mm_loadu_ps(zs + i)));
+			inside = _mm_or_ps(inside, _mm_cmpnlt_ps(value, _mm_setzero_ps()));
+		}
+		anyInside = _mm_movemask_ps(inside) != 0;
+#elif PPSSPP_ARCH(ARM_NEON)
+		const float32x4_t pw = vdupq_n_f32(p.w);
+		uint32x4_t outside = vdupq_n_u32(0xFFFFFFFF);
+		for (; i < simdCount; i += 4) {
+			float32x4_t value = vmlaq_n_f32(pw, vld1q_f32(xs + i), p.x);
+			value = vmlaq_n_f32(value, vld1q_f32(ys + i), p.y);
+			value = vmlaq_n_f32(value, vld1q_f32(zs + i), p.z);
+			outside = vandq_u32(outside, vcltq_f32(value, vdupq_n_f32(0.0f)));
+		}
+		uint32x2_t outside2 = vand_u32(vget_low_u32(outside), vget_high_u32(outside));
+		anyInside = (vget_lane_u32(outside2, 0) & vget_lane_u32(outside2, 1)) == 0;
+#endif
+		for (; i < count && !anyInside; i++) {
+			if (!(p.Test((float *)verts + i * 3) < 0))
+				anyInside = true;
+		}
+
+		if (!anyInside) {
+			// All out
+			return false;
+		}
+	}
+	return true;
+}
+
 static Vec3f ClipToScreen(const Vec4f& coords) {
 	float xScale = gstate.getViewportXScale();
 	float xCenter = gstate.getViewportXCenter();
@@ -175,6 +242,7 @@ void DrawEngineCommon::Resized() {
 	});
 	decoderMap_.Clear();
 	ClearTrackedVertexArrays();
+	ClearDecodedVertexCache();
 
 	useHWTransform_ = g_Config.bHardwareTransform;
 	useHWTessellation_ = UpdateUseHWTessellation(g_Config.bHardwareTessellation);
@@ -196,6 +264,49 @@ bool DrawEngineCommon::TestBoundingBox(void* control_points, int vertexCount, u3
 	SimpleVertex *corners = (SimpleVertex *)(decoded + 65536 * 12);
 	float *verts = (float *)(decoded + 65536 * 18);
 
+	// Games often test the same boxes every frame, so results are cached until a matrix changes.
+	if (memcmp(bboxWorldMatrix_, gstate.worldMatrix, sizeof(bboxWorldMatrix_)) != 0 || memcmp(bboxViewMatrix_, gstate.viewMatrix, sizeof(bboxViewMatrix_)) != 0 || memcmp(bboxProjMatrix_, gstate.projMatrix, sizeof(bboxProjMatrix_)) != 0) {
+		memcpy(bboxWorldMatrix_, gstate.worldMatrix, sizeof(bboxWorldMatrix_));
+		memcpy(bboxViewMatrix_, gstate.viewMatrix, sizeof(bboxViewMatrix_));
+		memcpy(bboxProjMatrix_, gstate.projMatrix, sizeof(bboxProjMatrix_));
+		memset(bboxCache_, 0, sizeof(bboxCache_));
+
+		float world[16];
+		float view[16];
+		float worldview[16];
+		float worldviewproj[16];
+		ConvertMatrix4x3To4x4(world, gstate.worldMatrix);
+		ConvertMatrix4x3To4x4(view, gstate.viewMatrix);
+		Matrix4ByMatrix4(worldview, world, view);
+		Matrix4ByMatrix4(worldviewproj, worldview, gstate.projMatrix);
+		PlanesFromMatrix(worldviewproj, (Plane *)bboxPlanes_);
+	}
+
+	// Skinning and morphing depend on even more state, so those aren't cached.
+	BoundingBoxCacheEntry *cached = nullptr;
+	u64 key = 0;
+	if ((vertType & (GE_VTYPE_WEIGHT_MASK | GE_VTYPE_MORPHCOUNT_MASK)) == 0) {
+		int vertexSize;
+		if ((vertType & 0xFFFFFF) == GE_VTYPE_POS_FLOAT) {
+			vertexSize = 3 * sizeof(float);
+		} else if ((vertType & 0xFFFFFF) == GE_VTYPE_POS_8BIT) {
+			vertexSize = 3 * sizeof(s8);
+		} else if ((vertType & 0xFFFFFF) == GE_VTYPE_POS_16BIT) {
+			vertexSize = 3 * sizeof(s16);
+		} else {
+			vertexSize = GetVertexDecoder((vertType & 0xFFFFFF) | (gstate.getUVGenMode() << 24))->VertexSize();
+		}
+
+		key = XXH3_64bits_withSeed(control_points, vertexSize * vertexCount, vertType);
+		// Zero marks an empty slot.
+		key |= 1;
+		cached = &bboxCache_[key % ARRAY_SIZE(bboxCache_)];
+		if (cached->key == key) {
+			*bytesRead = vertexSize * vertexCount;
+			return cached->result;
+		}
+	}
+
 	// Try to skip NormalizeVertices if it's pure positions. No need to bother with a vertex decoder
 	// and a large vertex format.
 	if ((vertType & 0xFFFFFF) == GE_VTYPE_POS_FLOAT) {
@@ -226,38 +337,12 @@ bool DrawEngineCommon::TestBoundingBox(void* control_points, int vertexCount, u3
 		*bytesRead = vertexSize * vertexCount;
 	}
 
-	Plane planes[6];
-
-	float world[16];
-	float view[16];
-	float worldview[16];
-	float worldviewproj[16];
-	ConvertMatrix4x3To4x4(world, gstate.worldMatrix);
-	ConvertMatrix4x3To4x4(view, gstate.viewMatrix);
-	Matrix4ByMatrix4(worldview, world, view);
-	Matrix4ByMatrix4(worldviewproj, worldview, gstate.projMatrix);
-	PlanesFromMatrix(worldviewproj, planes);
-	for (int plane = 0; plane < 6; plane++) {
-		int inside = 0;
-		int out = 0;
-		for (int i = 0; i < vertexCount; i++) {
-			// Here we can test against the frustum planes!
-			float value = planes[plane].Test(verts + i * 3);
-			if (value < 0)
-				out++;
-			else
-				inside++;
-		}
-
-		if (inside == 0) {
-			// All out
-			return false;
-		}
-
-		// Any out. For testing that the planes are in the right locations.
-		// if (out != 0) return false;
+	bool result = AnyPointsInsidePlanes(verts, vertexCount, (const Plane *)bboxPlanes_);
+	if (cached) {
+		cached->key = key;
+		cached->result = result;
 	}
-	return true;
+	return result;
 }
 
 // TODO: This probably is not the best interface.
@@ -516,15 +601,25 @@ void DrawEngineCommon::DecodeVertsStep(u8 *dest, int &i, int &decodedVerts) {
 	PROFILE_THIS_SCOPE("vertdec");
 
 	const DeferredDrawCall &dc = drawCalls[i];
+	const int stride = DecodedVertexStride();
 
 	indexGen.SetIndex(decodedVerts);
 	int indexLowerBound = dc.indexLowerBound;
 	int indexUpperBound = dc.indexUpperBound;
 
+	if (i == 0)
+		numMaterialColorRanges_ = 0;
+	if (batchedMaterialColors_) {
+		if (numMaterialColorRanges_ == 0 || materialColorRanges_[numMaterialColorRanges_ - 1].color != dc.materialColor) {
+			materialColorRanges_[numMaterialColorRanges_].firstVertex = decodedVerts;
+			materialColorRanges_[numMaterialColorRanges_].color = dc.materialColor;
+			numMaterialColorRanges_++;
+		}
+	}
+
 	if (dc.indexType == GE_VTYPE_IDX_NONE >> GE_VTYPE_IDX_SHIFT) {
 		// Decode the verts and apply morphing. Simple.
-		dec_->DecodeVerts(dest + decodedVerts * (int)dec_->GetDecVtxFmt().stride,
-			dc.verts, indexLowerBound, indexUpperBound);
+		DecodeVertsCached(dest + decodedVerts * stride, dc.verts, indexLowerBound, indexUpperBound);
 		decodedVerts += indexUpperBound - indexLowerBound + 1;
 		
 		bool clockwise = true;
@@ -545,6 +640,9 @@ void DrawEngineCommon::DecodeVertsStep(u8 *dest, int &i, int &decodedVerts) {
 		for (int j = i + 1; j < total; ++j) {
 			if (drawCalls[j].verts != dc.verts)
 				break;
+			// Shared vertices can only have one material color.
+			if (batchedMaterialColors_ && drawCalls[j].materialColor != dc.materialColor)
+				break;
 
 			indexLowerBound = std::min(indexLowerBound, (int)drawCalls[j].indexLowerBound);
 			indexUpperBound = std::max(indexUpperBound, (int)drawCalls[j].indexUpperBound);
@@ -590,8 +688,7 @@ void DrawEngineCommon::DecodeVertsStep(u8 *dest, int &i, int &decodedVerts) {
 		}
 
 		// 3. Decode that range of vertex data.
-		dec_->DecodeVerts(dest + decodedVerts * (int)dec_->GetDecVtxFmt().stride,
-			dc.verts, indexLowerBound, indexUpperBound);
+		DecodeVertsCached(dest + decodedVerts * stride, dc.verts, indexLowerBound, indexUpperBound);
 		decodedVerts += vertexCount;
 
 		// 4. Advance indexgen vertex counter.
@@ -600,6 +697,105 @@ void DrawEngineCommon::DecodeVertsStep(u8 *dest, int &i, int &decodedVerts) {
 	}
 }
 
+// Hashing isn't free, tiny draws are cheaper to just decode.
+static const int DECODED_VERTEX_CACHE_MIN_VERTS = 32;
+
+void DrawEngineCommon::DecodeVertsCached(u8 *dest, const void *verts, int indexLowerBound, int indexUpperBound) {
+	if (copyRawVerts_) {
+		// The vertex shader reads these directly. A copy is cheaper than hashing, so skip the cache.
+		const int vertexSize = dec_->VertexSize();
+		memcpy(dest, (const u8 *)verts + indexLowerBound * vertexSize, (indexUpperBound - indexLowerBound + 1) * vertexSize);
+		if (dec_->hasColor()) {
+			// We didn't look at the alpha values.
+			gstate_c.vertexFullAlpha = false;
+		}
+		return;
+	}
+
+	const size_t budget = (size_t)std::max(g_Config.iDecodedVertexCacheSizeMB, 0) * 1024 * 1024;
+	const int count = indexUpperBound - indexLowerBound + 1;
+	if (budget == 0 || count < DECODED_VERTEX_CACHE_MIN_VERTS) {
+		if (!decodedVertexCache_.empty() && budget == 0)
+			ClearDecodedVertexCache();
+		DecodeVertsRange(dest, verts, indexLowerBound, indexUpperBound);
+		return;
+	}
+
+	// The key must cover all the state the decoder reads, not just the raw vertices.
+	const u32 vtype = dec_->VertexType();
+	u64 stateHash = XXH3_64bits(&vtype, sizeof(vtype));
+	stateHash = XXH3_64bits_withSeed(&gstate_c.uv, sizeof(gstate_c.uv), stateHash);
+	if (decodeMorphTargets_) {
+		// Unblended, so the weights don't matter, but the result isn't the same as a blended decode.
+		stateHash = XXH3_64bits_withSeed(&morphFmt_.id, sizeof(morphFmt_.id), stateHash);
+	} else if ((vtype & GE_VTYPE_MORPHCOUNT_MASK) != 0) {
+		stateHash = XXH3_64bits_withSeed(gstate_c.morphWeights, sizeof(gstate_c.morphWeights), stateHash);
+	}
+	if ((vtype & GE_VTYPE_WEIGHT_MASK) != 0 && g_Config.bSoftwareSkinning)
+		stateHash = XXH3_64bits_withSeed(gstate.boneMatrix, sizeof(gstate.boneMatrix), stateHash);
+	const int vertexSize = dec_->VertexSize();
+	const u8 *src = (const u8 *)verts + indexLowerBound * vertexSize;
+	const u64 key = XXH3_64bits_withSeed(src, count * vertexSize, stateHash);
+
+	const size_t decodedSize = (size_t)count * DecodedVertexStride();
+	auto iter = decodedVertexCache_.find(key);
+	if (iter != decodedVertexCache_.end() && iter->second.data.size() == decodedSize) {
+		DecodedVertexCacheEntry &entry = iter->second;
+		memcpy(dest, entry.data.data(), decodedSize);
+		// Apply the side effects the decoder would have had.
+		gstate_c.vertexFullAlpha = gstate_c.vertexFullAlpha && entry.fullAlpha;
+		gstate_c.vertBounds.minU = std::min(gstate_c.vertBounds.minU, entry.bounds.minU);
+		gstate_c.vertBounds.minV = std::min(gstate_c.vertBounds.minV, entry.bounds.minV);
+		gstate_c.vertBounds.maxU = std::max(gstate_c.vertBounds.maxU, entry.bounds.maxU);
+		gstate_c.vertBounds.maxV = std::max(gstate_c.vertBounds.maxV, entry.bounds.maxV);
+		decodedVertexCacheLru_.splice(decodedVertexCacheLru_.begin(), decodedVertexCacheLru_, entry.lruPos);
+		return;
+	}
+
+	// Decode from a clean slate so we know this draw's own alpha and bounds, then merge them in.
+	const bool prevFullAlpha = gstate_c.vertexFullAlpha;
+	const KnownVertexBounds prevBounds = gstate_c.vertBounds;
+	gstate_c.vertexFullAlpha = true;
+	gstate_c.vertBounds.minU = 0xFFFF;
+	gstate_c.vertBounds.minV = 0xFFFF;
+	gstate_c.vertBounds.maxU = 0;
+	gstate_c.vertBounds.maxV = 0;
+	DecodeVertsRange(dest, verts, indexLowerBound, indexUpperBound);
+
+	if (iter != decodedVertexCache_.end()) {
+		// Same hash, different size.  Just replace it.
+		decodedVertexCacheBytes_ -= iter->second.data.size();
+		decodedVertexCacheLru_.erase(iter->second.lruPos);
+		decodedVertexCache_.erase(iter);
+	}
+	DecodedVertexCacheEntry &entry = decodedVertexCache_[key];
+	entry.data.assign(dest, dest + decodedSize);
+	entry.fullAlpha = gstate_c.vertexFullAlpha;
+	entry.bounds = gstate_c.vertBounds;
+	decodedVertexCacheLru_.push_front(key);
+	entry.lruPos = decodedVertexCacheLru_.begin();
+	decodedVertexCacheBytes_ += decodedSize;
+
+	gstate_c.vertexFullAlpha = prevFullAlpha && entry.fullAlpha;
+	gstate_c.vertBounds.minU = std::min(prevBounds.minU, entry.bounds.minU);
+	gstate_c.vertBounds.minV = std::min(prevBounds.minV, entry.bounds.minV);
+	gstate_c.vertBounds.maxU = std::max(prevBounds.maxU, entry.bounds.maxU);
+	gstate_c.vertBounds.maxV = std::max(prevBounds.maxV, entry.bounds.maxV);
+
+	while (decodedVertexCacheBytes_ > budget && decodedVertexCacheLru_.size() > 1) {
+		auto oldest = decodedVertexCache_.find(decodedVertexCacheLru_.back());
+		decodedVertexCacheBytes_ -= oldest->second.data.size();
+		decodedVertexCache_.erase(oldest);
+		decodedVertexCacheLru_.pop_back();
+	}
+}
+
+void DrawEngineCommon::ClearDecodedVertexCache() {
+	decodedVertexCache_.clear();
+	decodedVertexCacheLru_.clear();
+	decodedVertexCacheBytes_ = 0;
+}
+
 inline u32 ComputeMiniHashRange(const void *ptr, size_t sz) {
 	// Switch to u32 units, and round up to avoid unaligned accesses.
 	// Probably doesn't matter if we skip the first few bytes in some cases.
@@ -682,6 +878,73 @@ uint64_t DrawEngineCommon::ComputeHash() {
 	return fullhash;
 }
 
+const DecVtxFormat *DrawEngineCommon::GetRawVtxFmtForDraws() const {
+	if (!g_Config.bGPUVertexDecode || gstate_c.submitType != SubmitType::DRAW || numDrawCalls == 0)
+		return nullptr;
+	const DecVtxFormat *fmt = dec_->GetRawVtxFmt();
+	if (!fmt)
+		return nullptr;
+	if (dec_->hasTexcoord()) {
+		// The scale and offset become a uniform taken from gstate_c.uv, so the whole batch has to match it.
+		const UVScale &uv = gstate_c.uv;
+		for (int i = 0; i < numDrawCalls; i++) {
+			const UVScale &other = drawCalls[i].uvScale;
+			if (other.uScale != uv.uScale || other.vScale != uv.vScale || other.uOff != uv.uOff || other.vOff != uv.vOff)
+				return nullptr;
+		}
+	}
+	return fmt;
+}
+
+void DrawEngineCommon::DecodeVertsRange(u8 *dest, const void *verts, int indexLowerBound, int indexUpperBound) {
+	if (decodeMorphTargets_) {
+		morphTargetDec_->DecodeMorphTargets(dest, verts, indexLowerBound, indexUpperBound, morphFmt_.morphcount);
+		if (morphTargetDec_->hasColor()) {
+			// The targets may be opaque and the blend still not, if the weights don't add up.
+			gstate_c.vertexFullAlpha = false;
+		}
+	} else {
+		dec_->DecodeVerts(dest, verts, indexLowerBound, indexUpperBound);
+	}
+}
+
+// The decode buffer leaves room for 64 bytes per vertex.
+static const int MAX_MORPH_TARGETS_STRIDE = 64;
+
+const DecVtxFormat *DrawEngineCommon::PrepareMorphForDraws(bool useHWTransform) {
+	decodeMorphTargets_ = false;
+	const u32 vtype = lastVType_;
+	const int morphCount = ((vtype & GE_VTYPE_MORPHCOUNT_MASK) >> GE_VTYPE_MORPHCOUNT_SHIFT) + 1;
+	const bool eligible = useHWTransform && morphInShaderSupported_ && g_Config.bGPUVertexDecode && morphCount > 1 &&
+		gstate_c.submitType == SubmitType::DRAW && numDrawCalls != 0 &&
+		(vtype & GE_VTYPE_WEIGHT_MASK) == 0 && (vtype & GE_VTYPE_THROUGH_MASK) == 0;
+
+	int targetsInShader = 0;
+	if (eligible) {
+		VertexDecoder *targetDec = GetVertexDecoder(vtype & ~GE_VTYPE_MORPHCOUNT_MASK);
+		const DecVtxFormat &one = targetDec->GetDecVtxFmt();
+		DecVtxFormat fmt = one;
+		fmt.morphcount = morphCount;
+		fmt.ComputeID();
+		// Pipeline caches recreate the format from the ID, so it must imply the decoder's own offsets.
+		fmt.InitializeFromID(fmt.id);
+		const int attribsPerTarget = 1 + (one.nrmfmt != 0) + (one.uvfmt != 0) + (one.c0fmt != 0);
+		const bool layoutMatches = fmt.uvoff == one.uvoff && fmt.c0off == one.c0off && fmt.nrmoff == one.nrmoff && fmt.posoff == one.posoff && fmt.morphStride == one.stride;
+		if (layoutMatches && one.stride * morphCount <= MAX_MORPH_TARGETS_STRIDE && (morphCount - 1) * attribsPerTarget <= MAX_MORPH_ATTRIBUTES) {
+			morphTargetDec_ = targetDec;
+			morphFmt_ = fmt;
+			decodeMorphTargets_ = true;
+			targetsInShader = morphCount;
+		}
+	}
+
+	if (targetsInShader != gstate_c.morphTargetsInShader) {
+		gstate_c.morphTargetsInShader = targetsInShader;
+		gstate_c.Dirty(DIRTY_VERTEXSHADER_STATE | DIRTY_MORPHWEIGHTS);
+	}
+	return decodeMorphTargets_ ? &morphFmt_ : nullptr;
+}
+
 // vertTypeID is the vertex type but with the UVGen mode smashed into the top bits.
 void DrawEngineCommon::SubmitPrim(void *verts, void *inds, GEPrimitiveType prim, int vertexCount, u32 vertTypeID, int cullMode, int *bytesRead) {
 	if (!indexGen.PrimCompatible(prevPrim_, prim) || numDrawCalls >= MAX_DEFERRED_DRAW_CALLS || vertexCountInDrawCalls_ + vertexCount > VERTEX_BUFFER_MAX) {
@@ -723,8 +986,20 @@ void DrawEngineCommon::SubmitPrim(void *verts, void *inds, GEPrimitiveType prim,
 	dc.prim = prim;
 	dc.vertexCount = vertexCount;
 	dc.uvScale = gstate_c.uv;
+	dc.materialColor = gstate.getMaterialAmbientRGBA();
 	dc.cullMode = cullMode;
 
+	if (numDrawCalls == 0) {
+		batchedMaterialColors_ = false;
+	} else if (dc.materialColor != drawCalls[numDrawCalls - 1].materialColor && !(vertTypeID & GE_VTYPE_COL_MASK)) {
+		// Only the last color is checked for full alpha when flushing, so check the others here.
+		if (!batchedMaterialColors_ && (drawCalls[numDrawCalls - 1].materialColor >> 24) != 0xFF)
+			gstate_c.vertexFullAlpha = false;
+		batchedMaterialColors_ = true;
+	}
+	if (batchedMaterialColors_ && (dc.materialColor >> 24) != 0xFF)
+		gstate_c.vertexFullAlpha = false;
+
 	if (inds) {
 		GetIndexBounds(inds, vertexCount, vertTypeID, &dc.indexLowerBound, &dc.indexUpperBound);
 	} else {
@@ -747,6 +1022,14 @@ void DrawEngineCommon::SubmitPrim(void *verts, void *inds, GEPrimitiveType prim,
 	}
 }
 
+bool DrawEngineCommon::CanBatchMaterialColor() const {
+	if (numDrawCalls == 0)
+		return true;
+	// Through mode is always software transformed, which reads the color per vertex.
+	// Otherwise it's a shader uniform (and lighting input), so it has to flush.
+	return (lastVType_ & GE_VTYPE_THROUGH_MASK) != 0 && (lastVType_ & GE_VTYPE_WEIGHT_MASK) == 0;
+}
+
 bool DrawEngineCommon::CanUseHardwareTransform(int prim) {
 	if (!useHWTransform_)
 		return false;
@@ -760,6 +1043,14 @@ bool DrawEngineCommon::CanUseHardwareTessellation(GEPatchPrimType prim) {
 	return false;
 }
 
+void TessellationDataTransfer::CopyControlPoints(TessData *data, const SimpleVertex *const *points, int size, u32 vertType) {
+	float *pos = data->pos;
+	float *tex = data->uv;
+	float *col = data->color;
+	int stride = sizeof(TessData) / sizeof(float);
+	CopyControlPoints(pos, tex, col, stride, stride, stride, points, size, vertType);
+}
+
 void TessellationDataTransfer::CopyControlPoints(float *pos, float *tex, float *col, int posStride, int texStride, int colStride, const SimpleVertex *const *points, int size, u32 vertType) {
 	bool hasColor = (vertType & GE_VTYPE_COL_MASK) != 0;
 	bool hasTexCoord = (vertType & GE_VTYPE_TC_MASK) != 0;
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <list>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -25,6 +27,7 @@
 #include "GPU/GPUState.h"
 #include "GPU/Common/GPUDebugInterface.h"
 #include "GPU/Common/IndexGenerator.h"
+#include "GPU/Common/SoftwareTransformCommon.h"
 #include "GPU/Common/VertexDecoderCommon.h"
 
 class VertexDecoder;
@@ -42,13 +45,40 @@ inline uint32_t GetVertTypeID(uint32_t vertType, int uvGenMode) {
 }
 
 struct SimpleVertex;
-namespace Spline { struct Weight2D; }
+namespace Spline { struct Weight; struct Weight2D; }
 
 class TessellationDataTransfer {
 public:
 	virtual ~TessellationDataTransfer() {}
 	void CopyControlPoints(float *pos, float *tex, float *col, int posStride, int texStride, int colStride, const SimpleVertex *const *points, int size, u32 vertType);
 	virtual void SendDataToShader(const SimpleVertex *const *points, int size_u, int size_v, u32 vertType, const Spline::Weight2D &weights) = 0;
+
+protected:
+	// Control point layout for the structured buffer backends. Anything that's not simply float1 or
+	// float2 needs to be padded up to a float4 size, and vec3 members need 16-byte alignment.
+	struct TessData {
+		float pos[3]; float pad1;
+		float uv[2]; float pad2[2];
+		float color[4];
+	};
+	void CopyControlPoints(TessData *data, const SimpleVertex *const *points, int size, u32 vertType);
+
+	// Weight tables stay in the weight cache for as long as we run, so the same pointer means
+	// the same tessellation level and contents. Returns true if the table in the slot (0 = u,
+	// 1 = v) needs uploading, and remembers it.
+	bool WeightsChanged(int slot, const Spline::Weight *weights) {
+		if (prevWeights_[slot] == weights)
+			return false;
+		prevWeights_[slot] = weights;
+		return true;
+	}
+	// Call when the weight buffers are recreated or their contents are lost.
+	void InvalidateWeights(int slot) {
+		prevWeights_[slot] = nullptr;
+	}
+
+private:
+	const Spline::Weight *prevWeights_[2]{};
 };
 
 class DrawEngineCommon {
@@ -94,6 +124,8 @@ class DrawEngineCommon {
 	int GetNumDrawCalls() const {
 		return numDrawCalls;
 	}
+	// Whether a material color change can be kept per draw instead of flushing.
+	bool CanBatchMaterialColor() const;
 
 	VertexDecoder *GetVertexDecoder(u32 vtype);
 
@@ -113,6 +145,19 @@ class DrawEngineCommon {
 
 	// Vertex decoding
 	void DecodeVertsStep(u8 *dest, int &i, int &decodedVerts);
+	void DecodeVertsCached(u8 *dest, const void *verts, int indexLowerBound, int indexUpperBound);
+	void DecodeVertsRange(u8 *dest, const void *verts, int indexLowerBound, int indexUpperBound);
+	void ClearDecodedVertexCache();
+	// Returns the raw PSP format if the pending draws can skip decoding and be read by the vertex shader directly.
+	const DecVtxFormat *GetRawVtxFmtForDraws() const;
+	// Decides whether the vertex shader blends the morph targets of the pending draws. If so, they're decoded
+	// unblended and the returned format (with morphcount set) describes them. Call before decoding.
+	const DecVtxFormat *PrepareMorphForDraws(bool useHWTransform);
+	int DecodedVertexStride() const {
+		if (copyRawVerts_)
+			return dec_->VertexSize();
+		return decodeMorphTargets_ ? morphFmt_.stride : dec_->GetDecVtxFmt().stride;
+	}
 
 	bool ApplyFramebufferRead(bool *fboTexNeedsBind);
 
@@ -128,11 +173,38 @@ class DrawEngineCommon {
 
 	bool useHWTransform_ = false;
 	bool useHWTessellation_ = false;
+	// Set by backends whose vertex shaders can blend morph targets (see PrepareMorphForDraws.)
+	bool morphInShaderSupported_ = false;
 
 	// Vertex collector buffers
 	u8 *decoded = nullptr;
 	u16 *decIndex = nullptr;
 
+	// Decoded vertices keyed by a hash of the raw data and everything else the decoder reads.
+	// Unlike the backends' address-keyed vertex caches, this catches identical geometry anywhere in RAM.
+	// Least recently used entries are dropped when over the DecodedVertexCacheSizeMB budget.
+	struct DecodedVertexCacheEntry {
+		std::vector<u8> data;
+		KnownVertexBounds bounds;
+		bool fullAlpha;
+		std::list<u64>::iterator lruPos;
+	};
+	std::unordered_map<u64, DecodedVertexCacheEntry> decodedVertexCache_;
+	std::list<u64> decodedVertexCacheLru_;
+	size_t decodedVertexCacheBytes_ = 0;
+
+	// Results of GE_CMD_BOUNDINGBOX, keyed by a hash of the points and vertex type.
+	// The frustum planes and all entries only stay valid while the matrices stay the same.
+	struct BoundingBoxCacheEntry {
+		u64 key;
+		bool result;
+	};
+	BoundingBoxCacheEntry bboxCache_[256]{};
+	float bboxWorldMatrix_[12]{};
+	float bboxViewMatrix_[12]{};
+	float bboxProjMatrix_[16]{};
+	float bboxPlanes_[6 * 4]{};
+
 	// Cached vertex decoders
 	u32 lastVType_ = -1;
 	DenseHashMap<u32, VertexDecoder *, nullptr> decoderMap_;
@@ -153,6 +225,7 @@ class DrawEngineCommon {
 		u16 indexLowerBound;
 		u16 indexUpperBound;
 		UVScale uvScale;
+		u32 materialColor;
 		int cullMode;
 	};
 
@@ -161,6 +234,12 @@ class DrawEngineCommon {
 	int numDrawCalls = 0;
 	int vertexCountInDrawCalls_ = 0;
 
+	// Set when the pending draws use more than one material color, DecodeVertsStep then
+	// records where each color starts for SoftwareTransform.
+	bool batchedMaterialColors_ = false;
+	MaterialColorRange materialColorRanges_[MAX_DEFERRED_DRAW_CALLS];
+	int numMaterialColorRanges_ = 0;
+
 	int decimationCounter_ = 0;
 	int decodeCounter_ = 0;
 	u32 dcid_ = 0;
@@ -168,6 +247,12 @@ class DrawEngineCommon {
 	// Vertex collector state
 	IndexGenerator indexGen;
 	int decodedVerts_ = 0;
+	// When set, DecodeVerts copies the PSP vertices unchanged (see GetRawVtxFmtForDraws.)
+	bool copyRawVerts_ = false;
+	// When set, DecodeVerts leaves the morph targets unblended, using morphTargetDec_ (see PrepareMorphForDraws.)
+	bool decodeMorphTargets_ = false;
+	VertexDecoder *morphTargetDec_ = nullptr;
+	DecVtxFormat morphFmt_{};
 	GEPrimitiveType prevPrim_ = GE_PRIM_INVALID;
 
 	// Shader blending state
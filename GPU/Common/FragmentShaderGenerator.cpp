@@ -37,6 +37,8 @@
 bool GenerateFragmentShader(const FShaderID &id, char *buffer, const ShaderLanguageDesc &compat, Draw::Bugs bugs, uint64_t *uniformMask, std::string *errorString) {
 	*uniformMask = 0;
 	errorString->clear();
+	gpuStats.numShadersGenerated++;
+	Reporting::NotePerfEvent(Reporting::PerfEvent::SHADER_GENERATED);
 
 	bool highpFog = false;
 	bool highpTexcoord = false;
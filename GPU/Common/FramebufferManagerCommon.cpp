@@ -449,12 +449,22 @@ VirtualFramebuffer *FramebufferManagerCommon::DoSetRenderFrameBuffer(const Frame
 	gstate_c.curRTHeight = vfb->height;
 	gstate_c.curRTRenderWidth = vfb->renderWidth;
 	gstate_c.curRTRenderHeight = vfb->renderHeight;
+
+	// In turbo frames, only draw to buffers that might be read back or textured from.
+	const int turboKeepUsage = FB_USAGE_TEXTURE | FB_USAGE_CLUT | FB_USAGE_DOWNLOAD | FB_USAGE_DOWNLOAD_CLEAR;
+	if ((skipDrawReason & SKIPDRAW_TURBO_FRAME) && (vfb->usageFlags & FB_USAGE_DISPLAYED_FRAMEBUFFER) && (vfb->usageFlags & turboKeepUsage) == 0) {
+		gstate_c.skipDrawReason |= SKIPDRAW_TURBO_DISPLAY_FB;
+	} else {
+		gstate_c.skipDrawReason &= ~SKIPDRAW_TURBO_DISPLAY_FB;
+	}
 	return vfb;
 }
 
 void FramebufferManagerCommon::DestroyFramebuf(VirtualFramebuffer *v) {
 	// Notify the texture cache of both the color and depth buffers.
 	textureCache_->NotifyFramebuffer(v, NOTIFY_FB_DESTROYED);
+	if (selfCopy_.vfb == v)
+		selfCopy_.vfb = nullptr;
 	if (v->fbo) {
 		v->fbo->Release();
 		v->fbo = nullptr;
@@ -569,6 +579,8 @@ void FramebufferManagerCommon::ReinterpretFramebuffer(VirtualFramebuffer *vfb, G
 	_assert_(newFormat != oldFormat);
 	// The caller is responsible for updating the format.
 	_assert_(newFormat == vfb->format);
+	if (selfCopy_.vfb == vfb)
+		selfCopy_.vfb = nullptr;
 
 	ShaderLanguage lang = draw_->GetShaderLanguageDesc().shaderLanguage;
 
@@ -699,7 +711,7 @@ void FramebufferManagerCommon::ReinterpretFramebuffer(VirtualFramebuffer *vfb, G
 
 void FramebufferManagerCommon::NotifyRenderFramebufferSwitched(VirtualFramebuffer *prevVfb, VirtualFramebuffer *vfb, bool isClearingDepth) {
 	if (ShouldDownloadFramebuffer(vfb) && !vfb->memoryUpdated) {
-		ReadFramebufferToMemory(vfb, 0, 0, vfb->width, vfb->height);
+		ReadFramebufferToMemory(vfb, 0, 0, vfb->width, vfb->height, true);
 		vfb->usageFlags = (vfb->usageFlags | FB_USAGE_DOWNLOAD) & ~FB_USAGE_DOWNLOAD_CLEAR;
 		vfb->firstFrameSaved = true;
 	} else {
@@ -875,10 +887,16 @@ bool FramebufferManagerCommon::BindFramebufferAsColorTexture(int stage, VirtualF
 		// TODO: Maybe merge with bvfbs_?  Not sure if those could be packing, and they're created at a different size.
 		Draw::Framebuffer *renderCopy = GetTempFBO(TempFBO::COPY, framebuffer->renderWidth, framebuffer->renderHeight);
 		if (renderCopy) {
-			VirtualFramebuffer copyInfo = *framebuffer;
-			copyInfo.fbo = renderCopy;
-			CopyFramebufferForColorTexture(&copyInfo, framebuffer, flags);
-			RebindFramebuffer("After BindFramebufferAsColorTexture");
+			int x, y, w, h;
+			GetColorTextureCopyRect(framebuffer, flags, &x, &y, &w, &h);
+			// Each copy splits the render pass, so skip it if the last one still has what we need.
+			if (!CanReuseSelfCopy(framebuffer, renderCopy, x, y, w, h) && x < framebuffer->drawnWidth && y < framebuffer->drawnHeight && w > 0 && h > 0) {
+				VirtualFramebuffer copyInfo = *framebuffer;
+				copyInfo.fbo = renderCopy;
+				BlitFramebuffer(&copyInfo, x, y, framebuffer, x, y, w, h, 0, "Blit_CopyFramebufferForColorTexture");
+				RebindFramebuffer("After BindFramebufferAsColorTexture");
+				selfCopy_ = { framebuffer, renderCopy, x, y, x + w, y + h, false };
+			}
 			draw_->BindFramebufferAsTexture(renderCopy, stage, Draw::FB_COLOR_BIT, 0);
 		} else {
 			draw_->BindFramebufferAsTexture(framebuffer->fbo, stage, Draw::FB_COLOR_BIT, 0);
@@ -899,7 +917,7 @@ bool FramebufferManagerCommon::BindFramebufferAsColorTexture(int stage, VirtualF
 	}
 }
 
-void FramebufferManagerCommon::CopyFramebufferForColorTexture(VirtualFramebuffer *dst, VirtualFramebuffer *src, int flags) {
+void FramebufferManagerCommon::GetColorTextureCopyRect(VirtualFramebuffer *src, int flags, int *outX, int *outY, int *outW, int *outH) {
 	int x = 0;
 	int y = 0;
 	int w = src->drawnWidth;
@@ -923,8 +941,40 @@ void FramebufferManagerCommon::CopyFramebufferForColorTexture(VirtualFramebuffer
 		gstate_c.Dirty(DIRTY_TEXTURE_PARAMS);
 	}
 
-	if (x < src->drawnWidth && y < src->drawnHeight && w > 0 && h > 0) {
-		BlitFramebuffer(dst, x, y, src, x, y, w, h, 0, "Blit_CopyFramebufferForColorTexture");
+	*outX = x;
+	*outY = y;
+	*outW = w;
+	*outH = h;
+}
+
+bool FramebufferManagerCommon::CanReuseSelfCopy(VirtualFramebuffer *src, Draw::Framebuffer *copy, int x, int y, int w, int h) const {
+	const SelfCopy &c = selfCopy_;
+	if (c.vfb != src || c.fbo != copy)
+		return false;
+	if (x < c.x1 || y < c.y1 || x + w > c.x2 || y + h > c.y2)
+		return false;
+	if (c.dirty && x < c.dirtyX2 && c.dirtyX1 < x + w && y < c.dirtyY2 && c.dirtyY1 < y + h)
+		return false;
+	return true;
+}
+
+void FramebufferManagerCommon::DirtySelfCopy() {
+	int x1 = gstate.getScissorX1();
+	int y1 = gstate.getScissorY1();
+	int x2 = gstate.getScissorX2() + 1;
+	int y2 = gstate.getScissorY2() + 1;
+	SelfCopy &c = selfCopy_;
+	if (!c.dirty) {
+		c.dirty = true;
+		c.dirtyX1 = x1;
+		c.dirtyY1 = y1;
+		c.dirtyX2 = x2;
+		c.dirtyY2 = y2;
+	} else {
+		c.dirtyX1 = std::min(c.dirtyX1, x1);
+		c.dirtyY1 = std::min(c.dirtyY1, y1);
+		c.dirtyX2 = std::max(c.dirtyX2, x2);
+		c.dirtyY2 = std::max(c.dirtyY2, y2);
 	}
 }
 
@@ -1034,7 +1084,7 @@ void FramebufferManagerCommon::DownloadFramebufferOnSwitch(VirtualFramebuffer *v
 		// To support this, we save the first frame to memory when we have a safe w/h.
 		// Saving each frame would be slow.
 		if (!g_Config.bDisableSlowFramebufEffects && !PSP_CoreParameter().compat.flags().DisableFirstFrameReadback) {
-			ReadFramebufferToMemory(vfb, 0, 0, vfb->safeWidth, vfb->safeHeight);
+			ReadFramebufferToMemory(vfb, 0, 0, vfb->safeWidth, vfb->safeHeight, true);
 			vfb->usageFlags = (vfb->usageFlags | FB_USAGE_DOWNLOAD) & ~FB_USAGE_DOWNLOAD_CLEAR;
 			vfb->firstFrameSaved = true;
 			vfb->safeWidth = 0;
@@ -1189,6 +1239,7 @@ void FramebufferManagerCommon::CopyDisplayToOutput(bool reallyDirty) {
 
 void FramebufferManagerCommon::DecimateFBOs() {
 	currentRenderVfb_ = nullptr;
+	selfCopy_.vfb = nullptr;
 
 	for (auto iter : fbosToDelete_) {
 		iter->Release();
@@ -1200,7 +1251,7 @@ void FramebufferManagerCommon::DecimateFBOs() {
 		int age = frameLastFramebufUsed_ - std::max(vfb->last_frame_render, vfb->last_frame_used);
 
 		if (ShouldDownloadFramebuffer(vfb) && age == 0 && !vfb->memoryUpdated) {
-			ReadFramebufferToMemory(vfb, 0, 0, vfb->width, vfb->height);
+			ReadFramebufferToMemory(vfb, 0, 0, vfb->width, vfb->height, true);
 			vfb->usageFlags = (vfb->usageFlags | FB_USAGE_DOWNLOAD) & ~FB_USAGE_DOWNLOAD_CLEAR;
 			vfb->firstFrameSaved = true;
 		}
@@ -1244,6 +1295,8 @@ void FramebufferManagerCommon::ResizeFramebufFBO(VirtualFramebuffer *vfb, int w,
 	_dbg_assert_(w > 0);
 	_dbg_assert_(h > 0);
 	VirtualFramebuffer old = *vfb;
+	if (selfCopy_.vfb == vfb)
+		selfCopy_.vfb = nullptr;
 
 	int oldWidth = vfb->bufferWidth;
 	int oldHeight = vfb->bufferHeight;
@@ -1452,7 +1505,7 @@ bool FramebufferManagerCommon::NotifyFramebufferCopy(u32 src, u32 dst, int size,
 		if (srcH == 0 || srcY + srcH > srcBuffer->bufferHeight) {
 			WARN_LOG_ONCE(btdcpyheight, G3D, "Memcpy fbo download %08x -> %08x skipped, %d+%d is taller than %d", src, dst, srcY, srcH, srcBuffer->bufferHeight);
 		} else if (g_Config.bBlockTransferGPU && !srcBuffer->memoryUpdated && !PSP_CoreParameter().compat.flags().DisableReadbacks) {
-			ReadFramebufferToMemory(srcBuffer, 0, srcY, srcBuffer->width, srcH);
+			ReadFramebufferToMemory(srcBuffer, 0, srcY, srcBuffer->width, srcH, true);
 			srcBuffer->usageFlags = (srcBuffer->usageFlags | FB_USAGE_DOWNLOAD) & ~FB_USAGE_DOWNLOAD_CLEAR;
 		}
 		return false;
@@ -1544,9 +1597,12 @@ void FramebufferManagerCommon::FindTransferFramebuffers(VirtualFramebuffer *&dst
 	}
 
 	if (srcBuffer && !dstBuffer) {
+		// With BlockTransferDeferDownload, VRAM to VRAM copies of a framebuffer stay on the GPU. The RAM behind the
+		// new framebuffer is only updated when something we track reads it (a memcpy, a transfer out or a display.)
+		const bool deferDownload = g_Config.bBlockTransferGPU && g_Config.bBlockTransferDeferDownload && dstHeight > 1;
+		const bool intraVRAM = Memory::IsVRAMAddress(srcBuffer->fb_address) && Memory::IsVRAMAddress(dstBasePtr);
 		if (PSP_CoreParameter().compat.flags().BlockTransferAllowCreateFB ||
-			(PSP_CoreParameter().compat.flags().IntraVRAMBlockTransferAllowCreateFB &&
-				Memory::IsVRAMAddress(srcBuffer->fb_address) && Memory::IsVRAMAddress(dstBasePtr))) {
+			((PSP_CoreParameter().compat.flags().IntraVRAMBlockTransferAllowCreateFB || deferDownload) && intraVRAM)) {
 			GEBufferFormat ramFormat;
 			// Try to guess the appropriate format. We only know the bpp from the block transfer command (16 or 32 bit).
 			if (bpp == 4) {
@@ -1829,7 +1885,7 @@ bool FramebufferManagerCommon::NotifyBlockTransferBefore(u32 dstBasePtr, int dst
 				if (tooTall) {
 					WARN_LOG_ONCE(btdheight, G3D, "Block transfer download %08x -> %08x dangerous, %d+%d is taller than %d", srcBasePtr, dstBasePtr, srcY, srcHeight, srcBuffer->bufferHeight);
 				}
-				ReadFramebufferToMemory(srcBuffer, static_cast<int>(srcX * srcXFactor), srcY, static_cast<int>(srcWidth * srcXFactor), srcHeight);
+				ReadFramebufferToMemory(srcBuffer, static_cast<int>(srcX * srcXFactor), srcY, static_cast<int>(srcWidth * srcXFactor), srcHeight, true);
 				srcBuffer->usageFlags = (srcBuffer->usageFlags | FB_USAGE_DOWNLOAD) & ~FB_USAGE_DOWNLOAD_CLEAR;
 			}
 		}
@@ -1925,6 +1981,7 @@ void FramebufferManagerCommon::Resized() {
 
 void FramebufferManagerCommon::DestroyAllFBOs() {
 	currentRenderVfb_ = nullptr;
+	selfCopy_.vfb = nullptr;
 	displayFramebuf_ = nullptr;
 	prevDisplayFramebuf_ = nullptr;
 	prevPrevDisplayFramebuf_ = nullptr;
@@ -2039,6 +2096,8 @@ bool FramebufferManagerCommon::GetFramebuffer(u32 fb_address, int fb_stride, GEB
 			h = vfb->height * maxRes;
 
 			Draw::Framebuffer *tempFBO = GetTempFBO(TempFBO::COPY, w, h);
+			// Overwrites it.
+			selfCopy_.vfb = nullptr;
 			VirtualFramebuffer tempVfb = *vfb;
 			tempVfb.fbo = tempFBO;
 			tempVfb.bufferWidth = vfb->width;
@@ -2203,7 +2262,144 @@ void FramebufferManagerCommon::PackFramebufferSync_(VirtualFramebuffer *vfb, int
 	gpuStats.numReadbacks++;
 }
 
-void FramebufferManagerCommon::ReadFramebufferToMemory(VirtualFramebuffer *vfb, int x, int y, int w, int h) {
+bool FramebufferManagerCommon::PackFramebufferAsync_(VirtualFramebuffer *vfb, int x, int y, int w, int h) {
+	if (!vfb->fbo || w <= 0 || h <= 0) {
+		return false;
+	}
+
+	const u32 fb_address = vfb->fb_address & 0x3FFFFFFF;
+	Draw::DataFormat destFormat = GEFormatToThin3D(vfb->format);
+	const int dstBpp = (int)DataFormatSizeInBytes(destFormat);
+	const int dstByteOffset = (y * vfb->fb_stride + x) * dstBpp;
+	const int dstSize = (h * vfb->fb_stride + w - 1) * dstBpp;
+	if (!Memory::IsValidRange(fb_address + dstByteOffset, dstSize)) {
+		// Let the sync path report it.
+		return false;
+	}
+
+	u8 *destPtr = Memory::GetPointer(fb_address + dstByteOffset);
+	if (!draw_->CopyFramebufferToMemoryAsync(vfb->fbo, Draw::FB_COLOR_BIT, x, y, w, h, destFormat, destPtr, vfb->fb_stride, "PackFramebufferAsync_")) {
+		return false;
+	}
+
+	char tag[128];
+	size_t len = snprintf(tag, sizeof(tag), "FramebufferPack/%08x_%08x_%dx%d_%s", vfb->fb_address, vfb->z_address, w, h, GeBufferFormatToString(vfb->format));
+	NotifyMemInfo(MemBlockFlags::WRITE, fb_address + dstByteOffset, dstSize, tag, len);
+	gpuStats.numAsyncReadbacks++;
+	return true;
+}
+
+void FramebufferManagerCommon::PackFramebuffer_(VirtualFramebuffer *vfb, int x, int y, int w, int h, bool allowAsync) {
+	if (allowAsync && g_Config.bAsyncReadbacks && PackFramebufferAsync_(vfb, x, y, w, h)) {
+		return;
+	}
+	PackFramebufferSync_(vfb, x, y, w, h);
+}
+
+bool FramebufferManagerCommon::PackFramebuffer16_(VirtualFramebuffer *vfb, int x, int y, int w, int h, bool allowAsync) {
+	if (!vfb->fbo || w <= 0 || h <= 0 || !IsGeBufferFormat16BitColor(vfb->format))
+		return false;
+	const ShaderLanguageDesc &shaderLanguageDesc = draw_->GetShaderLanguageDesc();
+	ShaderLanguage lang = shaderLanguageDesc.shaderLanguage;
+	if (!shaderLanguageDesc.bitwiseOps || (lang != HLSL_D3D11 && lang != GLSL_VULKAN && lang != GLSL_3xx))
+		return false;
+	// Each packed pixel holds an even/odd pair.
+	if ((vfb->bufferWidth & 1) != 0 || (vfb->fb_stride & 1) != 0)
+		return false;
+
+	// Widen to whole pairs. The extra pixel is framebuffer content too, so writing it is harmless.
+	int x1 = x & ~1;
+	int x2 = std::min((x + w + 1) & ~1, (int)vfb->bufferWidth);
+	if (x2 <= x1)
+		return false;
+
+	const u32 fb_address = vfb->fb_address & 0x3FFFFFFF;
+	const int dstByteOffset = (y * vfb->fb_stride + x1) * 2;
+	const int dstSize = (h * vfb->fb_stride + (x2 - x1) - 1) * 2;
+	if (!Memory::IsValidRange(fb_address + dstByteOffset, dstSize))
+		return false;
+
+	Draw::Pipeline *&pipeline = pack16_[(int)vfb->format];
+	if (!pipeline) {
+		if (!reinterpretVS_) {
+			char *vsCode = new char[4000];
+			GenerateReinterpretVertexShader(vsCode, shaderLanguageDesc);
+			reinterpretVS_ = draw_->CreateShaderModule(ShaderStage::Vertex, lang, (const uint8_t *)vsCode, strlen(vsCode), "reinterpret_vs");
+			delete[] vsCode;
+			_assert_(reinterpretVS_);
+		}
+
+		char *fsCode = new char[4000];
+		GeneratePackFragmentShader(fsCode, vfb->format, shaderLanguageDesc);
+		Draw::ShaderModule *packFS = draw_->CreateShaderModule(ShaderStage::Fragment, lang, (const uint8_t *)fsCode, strlen(fsCode), "pack16_fs");
+		delete[] fsCode;
+		if (!packFS)
+			return false;
+
+		using namespace Draw;
+		DepthStencilState *depth = draw_->CreateDepthStencilState({ false, false, Comparison::LESS });
+		BlendState *blendstateOff = draw_->CreateBlendState({ false, 0xF });
+		RasterState *rasterNoCull = draw_->CreateRasterState({});
+		PipelineDesc pipelineDesc{ Primitive::TRIANGLE_LIST, { reinterpretVS_, packFS }, nullptr, depth, blendstateOff, rasterNoCull, nullptr };
+		pipeline = draw_->CreateGraphicsPipeline(pipelineDesc);
+
+		depth->Release();
+		blendstateOff->Release();
+		rasterNoCull->Release();
+		packFS->Release();
+		if (!pipeline)
+			return false;
+	}
+
+	if (!packSampler_) {
+		// Nearest, so each PSP pixel comes from exactly one upscaled pixel, like the download blit.
+		Draw::SamplerStateDesc samplerDesc{};
+		samplerDesc.magFilter = Draw::TextureFilter::NEAREST;
+		samplerDesc.minFilter = Draw::TextureFilter::NEAREST;
+		packSampler_ = draw_->CreateSamplerState(samplerDesc);
+	}
+	if (!reinterpretVBuf_) {
+		reinterpretVBuf_ = draw_->CreateBuffer(12 * 3, Draw::BufferUsageFlag::DYNAMIC | Draw::BufferUsageFlag::VERTEXDATA);
+	}
+
+	const int packWidth = vfb->bufferWidth / 2;
+	Draw::Framebuffer *temp = GetTempFBO(TempFBO::PACK, packWidth, vfb->bufferHeight);
+	if (!temp)
+		return false;
+
+	draw_->InvalidateCachedState();
+	draw_->BindFramebufferAsRenderTarget(temp, { Draw::RPAction::DONT_CARE, Draw::RPAction::DONT_CARE, Draw::RPAction::DONT_CARE }, "Pack16");
+	draw_->BindPipeline(pipeline);
+	draw_->BindFramebufferAsTexture(vfb->fbo, 0, Draw::FB_COLOR_BIT, 0);
+	draw_->BindSamplerStates(0, 1, &packSampler_);
+	draw_->SetScissorRect(x1 / 2, y, (x2 - x1) / 2, h);
+	Draw::Viewport vp = Draw::Viewport{ 0.0f, 0.0f, (float)packWidth, (float)vfb->bufferHeight, 0.0f, 1.0f };
+	draw_->SetViewports(1, &vp);
+	draw_->BindVertexBuffers(0, 1, &reinterpretVBuf_, nullptr);
+	draw_->Draw(3, 0);
+	draw_->InvalidateCachedState();
+	draw_->BindTexture(0, nullptr);
+
+	gstate_c.Dirty(DIRTY_BLEND_STATE | DIRTY_DEPTHSTENCIL_STATE | DIRTY_RASTER_STATE | DIRTY_VIEWPORTSCISSOR_STATE | DIRTY_VERTEXSHADER_STATE);
+
+	// The packed pixels are exactly the PSP's bytes, so read them back as they are.
+	u8 *destPtr = Memory::GetPointer(fb_address + dstByteOffset);
+	bool async = allowAsync && g_Config.bAsyncReadbacks &&
+		draw_->CopyFramebufferToMemoryAsync(temp, Draw::FB_COLOR_BIT, x1 / 2, y, (x2 - x1) / 2, h, Draw::DataFormat::R8G8B8A8_UNORM, destPtr, vfb->fb_stride / 2, "PackFramebuffer16_");
+	if (!async)
+		draw_->CopyFramebufferToMemorySync(temp, Draw::FB_COLOR_BIT, x1 / 2, y, (x2 - x1) / 2, h, Draw::DataFormat::R8G8B8A8_UNORM, destPtr, vfb->fb_stride / 2, "PackFramebuffer16_");
+
+	char tag[128];
+	size_t len = snprintf(tag, sizeof(tag), "FramebufferPack/%08x_%08x_%dx%d_%s", vfb->fb_address, vfb->z_address, x2 - x1, h, GeBufferFormatToString(vfb->format));
+	NotifyMemInfo(MemBlockFlags::WRITE, fb_address + dstByteOffset, dstSize, tag, len);
+	if (async)
+		gpuStats.numAsyncReadbacks++;
+	else
+		gpuStats.numReadbacks++;
+	return true;
+}
+
+void FramebufferManagerCommon::ReadFramebufferToMemory(VirtualFramebuffer *vfb, int x, int y, int w, int h, bool allowAsync) {
 	// Clamp to bufferWidth. Sometimes block transfers can cause this to hit.
 	if (x + w >= vfb->bufferWidth) {
 		w = vfb->bufferWidth - x;
@@ -2239,14 +2435,16 @@ void FramebufferManagerCommon::ReadFramebufferToMemory(VirtualFramebuffer *vfb,
 			}
 		}
 
-		if (vfb->renderWidth == vfb->width && vfb->renderHeight == vfb->height) {
+		if (PackFramebuffer16_(vfb, x, y, w, h, allowAsync)) {
+			// Already downscaled and converted on the GPU.
+		} else if (vfb->renderWidth == vfb->width && vfb->renderHeight == vfb->height) {
 			// No need to blit
-			PackFramebufferSync_(vfb, x, y, w, h);
+			PackFramebuffer_(vfb, x, y, w, h, allowAsync);
 		} else {
 			VirtualFramebuffer *nvfb = FindDownloadTempBuffer(vfb);
 			if (nvfb) {
 				BlitFramebuffer(nvfb, x, y, vfb, x, y, w, h, 0, "Blit_ReadFramebufferToMemory");
-				PackFramebufferSync_(nvfb, x, y, w, h);
+				PackFramebuffer_(nvfb, x, y, w, h, allowAsync);
 			}
 		}
 
@@ -2291,10 +2489,12 @@ void FramebufferManagerCommon::DownloadFramebufferForClut(u32 fb_address, u32 lo
 			vfb->clutUpdatedBytes = loadBytes;
 
 			// We'll pseudo-blit framebuffers here to get a resized version of vfb.
-			VirtualFramebuffer *nvfb = FindDownloadTempBuffer(vfb);
-			if (nvfb) {
-				BlitFramebuffer(nvfb, x, y, vfb, x, y, w, h, 0, "Blit_DownloadFramebufferForClut");
-				PackFramebufferSync_(nvfb, x, y, w, h);
+			if (!PackFramebuffer16_(vfb, x, y, w, h, true)) {
+				VirtualFramebuffer *nvfb = FindDownloadTempBuffer(vfb);
+				if (nvfb) {
+					BlitFramebuffer(nvfb, x, y, vfb, x, y, w, h, 0, "Blit_DownloadFramebufferForClut");
+					PackFramebuffer_(nvfb, x, y, w, h, true);
+				}
 			}
 
 			textureCache_->ForgetLastTexture();
@@ -2346,8 +2546,12 @@ void FramebufferManagerCommon::DeviceLost() {
 			DoRelease(reinterpretFromTo_[i][j]);
 		}
 	}
+	for (int i = 0; i < 3; i++) {
+		DoRelease(pack16_[i]);
+	}
 	DoRelease(reinterpretVBuf_);
 	DoRelease(reinterpretSampler_);
+	DoRelease(packSampler_);
 	DoRelease(reinterpretVS_);
 	presentation_->DeviceLost();
 	draw_ = nullptr;
@@ -170,6 +170,8 @@ enum class TempFBO {
 	REINTERPRET,
 	// Used to copy stencil data, means we need a stencil backing.
 	STENCIL,
+	// Half width targets for packing 16-bit framebuffers before readback.
+	PACK,
 };
 
 inline Draw::DataFormat GEFormatToThin3D(int geFormat) {
@@ -244,7 +246,8 @@ class FramebufferManagerCommon {
 	void NotifyBlockTransferAfter(u32 dstBasePtr, int dstStride, int dstX, int dstY, u32 srcBasePtr, int srcStride, int srcX, int srcY, int w, int h, int bpp, u32 skipDrawReason);
 
 	bool BindFramebufferAsColorTexture(int stage, VirtualFramebuffer *framebuffer, int flags);
-	void ReadFramebufferToMemory(VirtualFramebuffer *vfb, int x, int y, int w, int h);
+	// With allowAsync (and the setting on), the game may get the contents from a few frames ago instead of stalling.
+	void ReadFramebufferToMemory(VirtualFramebuffer *vfb, int x, int y, int w, int h, bool allowAsync = false);
 
 	void DownloadFramebufferForClut(u32 fb_address, u32 loadBytes);
 	void DrawFramebufferToOutput(const u8 *srcPixels, GEBufferFormat srcPixelFormat, int srcStride);
@@ -307,7 +310,9 @@ class FramebufferManagerCommon {
 	}
 	void SetColorUpdated(int skipDrawReason) {
 		if (currentRenderVfb_) {
-			SetColorUpdated(currentRenderVfb_, skipDrawReason);
+			if (currentRenderVfb_ == selfCopy_.vfb)
+				DirtySelfCopy();
+			MarkColorUpdated(currentRenderVfb_, skipDrawReason);
 		}
 	}
 	void SetRenderSize(VirtualFramebuffer *vfb);
@@ -334,6 +339,12 @@ class FramebufferManagerCommon {
 
 protected:
 	virtual void PackFramebufferSync_(VirtualFramebuffer *vfb, int x, int y, int w, int h);
+	// Returns false if nothing was written, then PackFramebufferSync_ is needed.
+	bool PackFramebufferAsync_(VirtualFramebuffer *vfb, int x, int y, int w, int h);
+	void PackFramebuffer_(VirtualFramebuffer *vfb, int x, int y, int w, int h, bool allowAsync);
+	// Downscales and converts a 16-bit framebuffer on the GPU, so only the PSP's bytes are read back.
+	// Returns false if not possible, then the caller blits and packs as usual.
+	bool PackFramebuffer16_(VirtualFramebuffer *vfb, int x, int y, int w, int h, bool allowAsync);
 	void SetViewport2D(int x, int y, int w, int h);
 	Draw::Texture *MakePixelTexture(const u8 *srcPixels, GEBufferFormat srcPixelFormat, int srcStride, int width, int height, float &u1, float &v1);
 	virtual void DrawActiveTexture(float x, float y, float w, float h, float destW, float destH, float u0, float v0, float u1, float v1, int uvRotation, int flags) = 0;
@@ -346,7 +357,9 @@ class FramebufferManagerCommon {
 
 	// Used by ReadFramebufferToMemory and later framebuffer block copies
 	virtual void BlitFramebuffer(VirtualFramebuffer *dst, int dstX, int dstY, VirtualFramebuffer *src, int srcX, int srcY, int w, int h, int bpp, const char *tag) = 0;
-	void CopyFramebufferForColorTexture(VirtualFramebuffer *dst, VirtualFramebuffer *src, int flags);
+	void GetColorTextureCopyRect(VirtualFramebuffer *src, int flags, int *x, int *y, int *w, int *h);
+	bool CanReuseSelfCopy(VirtualFramebuffer *src, Draw::Framebuffer *copy, int x, int y, int w, int h) const;
+	void DirtySelfCopy();
 
 	void EstimateDrawingSize(u32 fb_address, GEBufferFormat fb_format, int viewport_width, int viewport_height, int region_width, int region_height, int scissor_width, int scissor_height, int fb_stride, int &drawing_width, int &drawing_height);
 	u32 ColorBufferByteSize(const VirtualFramebuffer *vfb) const;
@@ -370,7 +383,12 @@ class FramebufferManagerCommon {
 
 	void UpdateFramebufUsage(VirtualFramebuffer *vfb);
 
-	static void SetColorUpdated(VirtualFramebuffer *dstBuffer, int skipDrawReason) {
+	void SetColorUpdated(VirtualFramebuffer *dstBuffer, int skipDrawReason) {
+		if (dstBuffer == selfCopy_.vfb)
+			selfCopy_.vfb = nullptr;
+		MarkColorUpdated(dstBuffer, skipDrawReason);
+	}
+	static void MarkColorUpdated(VirtualFramebuffer *dstBuffer, int skipDrawReason) {
 		dstBuffer->memoryUpdated = false;
 		dstBuffer->clutUpdatedBytes = 0;
 		dstBuffer->dirtyAfterDisplay = true;
@@ -431,6 +449,18 @@ class FramebufferManagerCommon {
 
 	std::unordered_map<u64, TempFBOInfo> tempFBOs_;
 
+	// The last copy made to texture from the current render target. Draws only reach their scissor rect,
+	// so the copy stays good until a draw's scissor overlaps the area that's needed next time.
+	struct SelfCopy {
+		VirtualFramebuffer *vfb;
+		Draw::Framebuffer *fbo;
+		int x1, y1, x2, y2;
+		// Union of the scissor rects drawn to since the copy.
+		bool dirty;
+		int dirtyX1, dirtyY1, dirtyX2, dirtyY2;
+	};
+	SelfCopy selfCopy_{};
+
 	std::vector<Draw::Framebuffer *> fbosToDelete_;
 
 	// Aggressively delete unused FBOs to save gpu memory.
@@ -446,4 +476,7 @@ class FramebufferManagerCommon {
 	Draw::ShaderModule *reinterpretVS_ = nullptr;
 	Draw::SamplerState *reinterpretSampler_ = nullptr;
 	Draw::Buffer *reinterpretVBuf_ = nullptr;
+
+	Draw::Pipeline *pack16_[3]{};
+	Draw::SamplerState *packSampler_ = nullptr;
 };
@@ -45,6 +45,158 @@ const u8 IndexGenerator::indexedPrimitiveType[7] = {
 	GE_PRIM_RECTANGLES,
 };
 
+alignas(16) static const u16 offsets_ramp[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+alignas(16) static const u16 increment_ramp[8] = { 8, 8, 8, 8, 8, 8, 8, 8 };
+
+// Each line i is (i, i + 1), so 8 indices cover 4 lines.
+alignas(16) static const u16 offsets_line_strip[8] = { 0, 1, 1, 2, 2, 3, 3, 4 };
+alignas(16) static const u16 increment_line_strip[8] = { 4, 4, 4, 4, 4, 4, 4, 4 };
+
+alignas(16) static const u16 offsets_list_counter_clockwise[24] = {
+	0, 2, 1, 3, 5, 4, 6, 8,
+	7, 9, 11, 10, 12, 14, 13, 15,
+	17, 16, 18, 20, 19, 21, 23, 22,
+};
+alignas(16) static const u16 increment_list[24] = {
+	24, 24, 24, 24, 24, 24, 24, 24,
+	24, 24, 24, 24, 24, 24, 24, 24,
+	24, 24, 24, 24, 24, 24, 24, 24,
+};
+
+// The first vertex of each fan triangle stays put, so its lanes don't increment.
+alignas(16) static const u16 offsets_fan_clockwise[24] = {
+	0, 1, 2, 0, 2, 3, 0, 3,
+	4, 0, 4, 5, 0, 5, 6, 0,
+	6, 7, 0, 7, 8, 0, 8, 9,
+};
+alignas(16) static const u16 offsets_fan_counter_clockwise[24] = {
+	0, 2, 1, 0, 3, 2, 0, 4,
+	3, 0, 5, 4, 0, 6, 5, 0,
+	7, 6, 0, 8, 7, 0, 9, 8,
+};
+alignas(16) static const u16 increment_fan[24] = {
+	0, 8, 8, 0, 8, 8, 0, 8,
+	8, 0, 8, 8, 0, 8, 8, 0,
+	8, 8, 0, 8, 8, 0, 8, 8,
+};
+
+// Writes numChunks repetitions of a pattern of N * 8 indices, starting at base + offsets
+// and adding increments to each lane per repetition. Returns the number of indices written.
+template <int N>
+static inline int GeneratePattern(u16 *dst, int numChunks, u16 base, const u16 *offsets, const u16 *increments) {
+#ifdef _M_SSE
+	__m128i ibase = _mm_set1_epi16(base);
+	__m128i values[N];
+	__m128i incs[N];
+	for (int n = 0; n < N; n++) {
+		values[n] = _mm_add_epi16(ibase, _mm_load_si128((const __m128i *)offsets + n));
+		incs[n] = _mm_load_si128((const __m128i *)increments + n);
+	}
+	__m128i *out = (__m128i *)dst;
+	for (int i = 0; i < numChunks; i++) {
+		for (int n = 0; n < N; n++) {
+			_mm_storeu_si128(out++, values[n]);
+			values[n] = _mm_add_epi16(values[n], incs[n]);
+		}
+	}
+	return numChunks * N * 8;
+#elif PPSSPP_ARCH(ARM_NEON)
+	uint16x8_t ibase = vdupq_n_u16(base);
+	uint16x8_t values[N];
+	uint16x8_t incs[N];
+	for (int n = 0; n < N; n++) {
+		values[n] = vaddq_u16(ibase, vld1q_u16(offsets + n * 8));
+		incs[n] = vld1q_u16(increments + n * 8);
+	}
+	for (int i = 0; i < numChunks; i++) {
+		for (int n = 0; n < N; n++) {
+			vst1q_u16(dst, values[n]);
+			values[n] = vaddq_u16(values[n], incs[n]);
+			dst += 8;
+		}
+	}
+	return numChunks * N * 8;
+#else
+	return 0;
+#endif
+}
+
+// Copies indices while adding an offset, 8 at a time. Returns how many were done,
+// the caller finishes the rest.
+static inline int TranslateLinearSIMD(u16 *dst, const u8 *src, int count, u16 offset) {
+	int done = count & ~7;
+#ifdef _M_SSE
+	__m128i off = _mm_set1_epi16(offset);
+	__m128i zero = _mm_setzero_si128();
+	for (int i = 0; i < done; i += 8) {
+		__m128i in = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src + i)), zero);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_add_epi16(in, off));
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	uint16x8_t off = vdupq_n_u16(offset);
+	for (int i = 0; i < done; i += 8) {
+		vst1q_u16(dst + i, vaddq_u16(vmovl_u8(vld1_u8(src + i)), off));
+	}
+#else
+	done = 0;
+#endif
+	return done;
+}
+
+static inline int TranslateLinearSIMD(u16 *dst, const u16_le *src, int count, u16 offset) {
+	int done = count & ~7;
+#ifdef _M_SSE
+	__m128i off = _mm_set1_epi16(offset);
+	for (int i = 0; i < done; i += 8) {
+		__m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_add_epi16(in, off));
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	uint16x8_t off = vdupq_n_u16(offset);
+	for (int i = 0; i < done; i += 8) {
+		vst1q_u16(dst + i, vaddq_u16(vld1q_u16((const u16 *)(src + i)), off));
+	}
+#else
+	done = 0;
+#endif
+	return done;
+}
+
+static inline int TranslateLinearSIMD(u16 *dst, const u32_le *src, int count, u16 offset) {
+	// 32-bit indices are rare, not worth the narrowing.
+	return 0;
+}
+
+// Expands a line strip into line pairs, 8 lines at a time. Returns the number of lines done.
+static inline int TranslateLineStripSIMD(u16 *dst, const u16_le *src, int numLines, u16 offset) {
+	int done = numLines & ~7;
+#ifdef _M_SSE
+	__m128i off = _mm_set1_epi16(offset);
+	for (int i = 0; i < done; i += 8) {
+		__m128i a = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(src + i)), off);
+		__m128i b = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(src + i + 1)), off);
+		_mm_storeu_si128((__m128i *)(dst + i * 2), _mm_unpacklo_epi16(a, b));
+		_mm_storeu_si128((__m128i *)(dst + i * 2 + 8), _mm_unpackhi_epi16(a, b));
+	}
+#elif PPSSPP_ARCH(ARM_NEON)
+	uint16x8_t off = vdupq_n_u16(offset);
+	for (int i = 0; i < done; i += 8) {
+		uint16x8x2_t lines;
+		lines.val[0] = vaddq_u16(vld1q_u16((const u16 *)(src + i)), off);
+		lines.val[1] = vaddq_u16(vld1q_u16((const u16 *)(src + i + 1)), off);
+		vst2q_u16(dst + i * 2, lines);
+	}
+#else
+	done = 0;
+#endif
+	return done;
+}
+
+template <class ITypeLE>
+static inline int TranslateLineStripSIMD(u16 *dst, const ITypeLE *src, int numLines, u16 offset) {
+	return 0;
+}
+
 void IndexGenerator::Setup(u16 *inds) {
 	this->indsBase_ = inds;
 	Reset();
@@ -65,7 +217,9 @@ void IndexGenerator::AddPrim(int prim, int vertexCount, bool clockwise) {
 void IndexGenerator::AddPoints(int numVerts) {
 	u16 *outInds = inds_;
 	const int startIndex = index_;
-	for (int i = 0; i < numVerts; i++)
+	int i = GeneratePattern<1>(outInds, numVerts / 8, startIndex, offsets_ramp, increment_ramp);
+	outInds += i;
+	for (; i < numVerts; i++)
 		*outInds++ = startIndex + i;
 	inds_ = outInds;
 	// ignore overflow verts
@@ -80,7 +234,15 @@ void IndexGenerator::AddList(int numVerts, bool clockwise) {
 	const int startIndex = index_;
 	const int v1 = clockwise ? 1 : 2;
 	const int v2 = clockwise ? 2 : 1;
-	for (int i = 0; i < numVerts; i += 3) {
+	// A clockwise list is just a ramp, 8 triangles per chunk otherwise.
+	int i;
+	if (clockwise) {
+		i = GeneratePattern<1>(outInds, (numVerts / 24) * 3, startIndex, offsets_ramp, increment_ramp);
+	} else {
+		i = GeneratePattern<3>(outInds, numVerts / 24, startIndex, offsets_list_counter_clockwise, increment_list);
+	}
+	outInds += i;
+	for (; i < numVerts; i += 3) {
 		*outInds++ = startIndex + i;
 		*outInds++ = startIndex + i + v1;
 		*outInds++ = startIndex + i + v2;
@@ -210,7 +372,10 @@ void IndexGenerator::AddFan(int numVerts, bool clockwise) {
 	const int startIndex = index_;
 	const int v1 = clockwise ? 1 : 2;
 	const int v2 = clockwise ? 2 : 1;
-	for (int i = 0; i < numTris; i++) {
+	const u16 *offsets = clockwise ? offsets_fan_clockwise : offsets_fan_counter_clockwise;
+	int i = GeneratePattern<3>(outInds, numTris / 8, startIndex, offsets, increment_fan) / 3;
+	outInds += i * 3;
+	for (; i < numTris; i++) {
 		*outInds++ = startIndex;
 		*outInds++ = startIndex + i + v1;
 		*outInds++ = startIndex + i + v2;
@@ -230,7 +395,9 @@ void IndexGenerator::AddFan(int numVerts, bool clockwise) {
 void IndexGenerator::AddLineList(int numVerts) {
 	u16 *outInds = inds_;
 	const int startIndex = index_;
-	for (int i = 0; i < numVerts; i += 2) {
+	int i = GeneratePattern<1>(outInds, numVerts / 8, startIndex, offsets_ramp, increment_ramp);
+	outInds += i;
+	for (; i < numVerts; i += 2) {
 		*outInds++ = startIndex + i;
 		*outInds++ = startIndex + i + 1;
 	}
@@ -245,7 +412,9 @@ void IndexGenerator::AddLineStrip(int numVerts) {
 	const int numLines = numVerts - 1;
 	u16 *outInds = inds_;
 	const int startIndex = index_;
-	for (int i = 0; i < numLines; i++) {
+	int i = GeneratePattern<1>(outInds, numLines > 0 ? numLines / 4 : 0, startIndex, offsets_line_strip, increment_line_strip) / 2;
+	outInds += i * 2;
+	for (; i < numLines; i++) {
 		*outInds++ = startIndex + i;
 		*outInds++ = startIndex + i + 1;
 	}
@@ -261,7 +430,9 @@ void IndexGenerator::AddRectangles(int numVerts) {
 	const int startIndex = index_;
 	//rectangles always need 2 vertices, disregard the last one if there's an odd number
 	numVerts = numVerts & ~1;
-	for (int i = 0; i < numVerts; i += 2) {
+	int i = GeneratePattern<1>(outInds, numVerts / 8, startIndex, offsets_ramp, increment_ramp);
+	outInds += i;
+	for (; i < numVerts; i += 2) {
 		*outInds++ = startIndex + i;
 		*outInds++ = startIndex + i + 1;
 	}
@@ -276,7 +447,9 @@ template <class ITypeLE, int flag>
 void IndexGenerator::TranslatePoints(int numInds, const ITypeLE *inds, int indexOffset) {
 	indexOffset = index_ - indexOffset;
 	u16 *outInds = inds_;
-	for (int i = 0; i < numInds; i++)
+	int i = TranslateLinearSIMD(outInds, inds, numInds, indexOffset);
+	outInds += i;
+	for (; i < numInds; i++)
 		*outInds++ = indexOffset + inds[i];
 	inds_ = outInds;
 	count_ += numInds;
@@ -289,7 +462,9 @@ void IndexGenerator::TranslateLineList(int numInds, const ITypeLE *inds, int ind
 	indexOffset = index_ - indexOffset;
 	u16 *outInds = inds_;
 	numInds = numInds & ~1;
-	for (int i = 0; i < numInds; i += 2) {
+	int i = TranslateLinearSIMD(outInds, inds, numInds, indexOffset);
+	outInds += i;
+	for (; i < numInds; i += 2) {
 		*outInds++ = indexOffset + inds[i];
 		*outInds++ = indexOffset + inds[i + 1];
 	}
@@ -304,7 +479,9 @@ void IndexGenerator::TranslateLineStrip(int numInds, const ITypeLE *inds, int in
 	indexOffset = index_ - indexOffset;
 	int numLines = numInds - 1;
 	u16 *outInds = inds_;
-	for (int i = 0; i < numLines; i++) {
+	int i = numLines > 0 ? TranslateLineStripSIMD(outInds, inds, numLines, indexOffset) : 0;
+	outInds += i * 2;
+	for (; i < numLines; i++) {
 		*outInds++ = indexOffset + inds[i];
 		*outInds++ = indexOffset + inds[i + 1];
 	}
@@ -329,7 +506,12 @@ void IndexGenerator::TranslateList(int numInds, const ITypeLE *inds, int indexOf
 		numInds = numTris * 3;
 		const int v1 = clockwise ? 1 : 2;
 		const int v2 = clockwise ? 2 : 1;
-		for (int i = 0; i < numInds; i += 3) {
+		int i = 0;
+		if (clockwise) {
+			i = TranslateLinearSIMD(outInds, inds, numInds - numInds % 24, indexOffset);
+			outInds += i;
+		}
+		for (; i < numInds; i += 3) {
 			*outInds++ = indexOffset + inds[i];
 			*outInds++ = indexOffset + inds[i + v1];
 			*outInds++ = indexOffset + inds[i + v2];
@@ -384,7 +566,9 @@ inline void IndexGenerator::TranslateRectangles(int numInds, const ITypeLE *inds
 	u16 *outInds = inds_;
 	//rectangles always need 2 vertices, disregard the last one if there's an odd number
 	numInds = numInds & ~1;
-	for (int i = 0; i < numInds; i += 2) {
+	int i = TranslateLinearSIMD(outInds, inds, numInds, indexOffset);
+	outInds += i;
+	for (; i < numInds; i += 2) {
 		*outInds++ = indexOffset + inds[i];
 		*outInds++ = indexOffset + inds[i+1];
 	}
@@ -54,6 +54,7 @@ void LoadPostShaderInfo(Draw::DrawContext *draw, const std::vector<Path> &direct
 	off.visible = true;
 	off.name = "Off";
 	off.section = "Off";
+	off.outputScale = 1.0f;
 	for (size_t i = 0; i < ARRAY_SIZE(off.settings); ++i) {
 		off.settings[i].name = "";
 		off.settings[i].value = 0.0f;
@@ -167,6 +168,8 @@ void LoadPostShaderInfo(Draw::DrawContext *draw, const std::vector<Path> &direct
 					section.Get("OutputResolution", &info.outputResolution, false);
 					section.Get("Upscaling", &info.isUpscalingFilter, false);
 					section.Get("SSAA", &info.SSAAFilterLevel, 0);
+					section.Get("OutputScale", &info.outputScale, 1.0f);
+					info.outputScale = std::max(0.125f, std::min(info.outputScale, 1.0f));
 					section.Get("60fps", &info.requires60fps, false);
 					section.Get("UsePreviousFrame", &info.usePreviousFrame, false);
 
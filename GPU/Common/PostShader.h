@@ -41,6 +41,8 @@ struct ShaderInfo {
 	bool isUpscalingFilter;
 	// Use 2x display resolution for supersampling with blurry shaders.
 	int SSAAFilterLevel;
+	// Scale of this shader's output, relative to what it would normally be. Below 1 for cheap blur/bloom passes.
+	float outputScale;
 	// Force constant/max refresh for animated filters
 	bool requires60fps;
 	// Takes previous frame as input (for blending effects.)
@@ -16,7 +16,9 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <cmath>
+#include <algorithm>
 #include <set>
+#include <string>
 #include <cstdint>
 
 #include "Common/GPU/thin3d.h"
@@ -214,6 +216,13 @@ static std::string ReadShaderSrc(const Path &filename) {
 	return src;
 }
 
+// Each pass gets its own tag, so GPU profiling and debug labels show the cost of each shader separately.
+// Render steps keep the pointer until the frame has run, which can be after the chain is rebuilt, so these are never freed.
+static const char *PostShaderPassTag(const ShaderInfo *shaderInfo) {
+	static std::set<std::string> tags;
+	return tags.insert("PostShader_" + shaderInfo->section).first->c_str();
+}
+
 // Note: called on resize and settings changes.
 bool PresentationCommon::UpdatePostShader() {
 	std::vector<const ShaderInfo *> shaderInfo;
@@ -222,10 +231,28 @@ bool PresentationCommon::UpdatePostShader() {
 		shaderInfo = GetFullPostShadersChain(g_Config.vPostShaderNames);
 	}
 
+	// Keep the old chain's framebuffers around while building, the new chain often needs the same sizes.
+	for (const auto &usage : postShaderFBOUsage_) {
+		usage.fbo->AddRef();
+		spareFramebuffers_.push_back(usage);
+	}
+	for (Draw::Framebuffer *fbo : previousFramebuffers_) {
+		int w, h;
+		draw_->GetFramebufferDimensions(fbo, &w, &h);
+		fbo->AddRef();
+		spareFramebuffers_.push_back({ fbo, w, h });
+	}
+
 	DestroyPostShader();
-	if (shaderInfo.empty())
-		return false;
+	bool success = !shaderInfo.empty() && BuildPostShaderChain(shaderInfo);
+
+	for (const auto &spare : spareFramebuffers_)
+		spare.fbo->Release();
+	spareFramebuffers_.clear();
+	return success;
+}
 
+bool PresentationCommon::BuildPostShaderChain(const std::vector<const ShaderInfo *> &shaderInfo) {
 	bool usePreviousFrame = false;
 	bool usePreviousAtOutputResolution = false;
 	for (int i = 0; i < shaderInfo.size(); ++i) {
@@ -249,7 +276,9 @@ bool PresentationCommon::UpdatePostShader() {
 		previousIndex_ = 0;
 
 		for (int i = 0; i < FRAMES; ++i) {
-			previousFramebuffers_[i] = draw_->CreateFramebuffer({ w, h, 1, 1, false, "inter_presentation" });
+			previousFramebuffers_[i] = TakeSpareFramebuffer(w, h);
+			if (!previousFramebuffers_[i])
+				previousFramebuffers_[i] = draw_->CreateFramebuffer({ w, h, 1, 1, false, "inter_presentation" });
 			if (!previousFramebuffers_[i]) {
 				DestroyPostShader();
 				return false;
@@ -304,8 +333,11 @@ bool PresentationCommon::BuildPostShader(const ShaderInfo *shaderInfo, const Sha
 		int nextHeight = renderHeight_;
 
 		// When chaining, we use the previous resolution as a base, rather than the render resolution.
-		if (!postShaderFramebuffers_.empty())
-			draw_->GetFramebufferDimensions(postShaderFramebuffers_.back(), &nextWidth, &nextHeight);
+		// This is the size before any OutputScale, so a reduced pass doesn't shrink the rest of the chain.
+		if (!postShaderFramebuffers_.empty()) {
+			nextWidth = chainWidth_;
+			nextHeight = chainHeight_;
+		}
 
 		if (next && next->isUpscalingFilter) {
 			// Force 1x for this shader, so the next can upscale.
@@ -325,6 +357,14 @@ bool PresentationCommon::BuildPostShader(const ShaderInfo *shaderInfo, const Sha
 			nextHeight = (int)rc.h;
 		}
 
+		chainWidth_ = nextWidth;
+		chainHeight_ = nextHeight;
+		// Reduced resolution intermediates, for blur/bloom style passes. Not when the next one upscales from 1x.
+		if (shaderInfo->outputScale < 1.0f && !(next && next->isUpscalingFilter)) {
+			nextWidth = std::max(1, (int)(nextWidth * shaderInfo->outputScale));
+			nextHeight = std::max(1, (int)(nextHeight * shaderInfo->outputScale));
+		}
+
 		if (!AllocateFramebuffer(nextWidth, nextHeight)) {
 			pipeline->Release();
 			return false;
@@ -350,8 +390,11 @@ bool PresentationCommon::AllocateFramebuffer(int w, int h) {
 		}
 	}
 
+	// Then one left over from the previous chain, and only after that create a new one.
 	// No depth/stencil for post processing
-	Draw::Framebuffer *fbo = draw_->CreateFramebuffer({ w, h, 1, 1, false, "presentation" });
+	Framebuffer *fbo = TakeSpareFramebuffer(w, h);
+	if (!fbo)
+		fbo = draw_->CreateFramebuffer({ w, h, 1, 1, false, "presentation" });
 	if (!fbo) {
 		return false;
 	}
@@ -361,6 +404,18 @@ bool PresentationCommon::AllocateFramebuffer(int w, int h) {
 	return true;
 }
 
+Draw::Framebuffer *PresentationCommon::TakeSpareFramebuffer(int w, int h) {
+	for (auto it = spareFramebuffers_.begin(); it != spareFramebuffers_.end(); ++it) {
+		if (it->w == w && it->h == h) {
+			// The reference we took in UpdatePostShader now belongs to the caller.
+			Draw::Framebuffer *fbo = it->fbo;
+			spareFramebuffers_.erase(it);
+			return fbo;
+		}
+	}
+	return nullptr;
+}
+
 void PresentationCommon::ShowPostShaderError(const std::string &errorString) {
 	// let's show the first line of the error string as an OSM.
 	std::set<std::string> blacklistedLines;
@@ -498,6 +553,8 @@ void PresentationCommon::DestroyPostShader() {
 	DoReleaseVector(previousFramebuffers_);
 	postShaderInfo_.clear();
 	postShaderFBOUsage_.clear();
+	chainWidth_ = 0;
+	chainHeight_ = 0;
 }
 
 Draw::ShaderModule *PresentationCommon::CompileShaderModule(ShaderStage stage, ShaderLanguage lang, const std::string &src, std::string *errorString) {
@@ -717,7 +774,7 @@ void PresentationCommon::CopyToOutput(OutputFlags flags, int uvRotation, float u
 				postShaderFramebuffer = previousFramebuffers_[previousIndex_];
 			}
 
-			draw_->BindFramebufferAsRenderTarget(postShaderFramebuffer, { Draw::RPAction::DONT_CARE, Draw::RPAction::DONT_CARE, Draw::RPAction::DONT_CARE }, "PostShader");
+			draw_->BindFramebufferAsRenderTarget(postShaderFramebuffer, { Draw::RPAction::DONT_CARE, Draw::RPAction::DONT_CARE, Draw::RPAction::DONT_CARE }, PostShaderPassTag(shaderInfo));
 			performShaderPass(shaderInfo, postShaderFramebuffer, postShaderPipeline);
 		}
 
@@ -830,6 +887,7 @@ void PresentationCommon::CalculateRenderResolution(int *width, int *height, int
 		if (firstSSAAFilterLevel >= 2)
 			zoom *= firstSSAAFilterLevel;
 	}
+	zoom -= PSP_CoreParameter().renderScaleDrop;
 	if (zoom <= 1 || firstIsUpscalingFilter)
 		zoom = 1;
 
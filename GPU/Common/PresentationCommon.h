@@ -112,8 +112,10 @@ class PresentationCommon {
 
 	Draw::ShaderModule *CompileShaderModule(ShaderStage stage, ShaderLanguage lang, const std::string &src, std::string *errorString);
 	Draw::Pipeline *CreatePipeline(std::vector<Draw::ShaderModule *> shaders, bool postShader, const UniformBufferDesc *uniformDesc);
+	bool BuildPostShaderChain(const std::vector<const ShaderInfo *> &shaderInfo);
 	bool BuildPostShader(const ShaderInfo *shaderInfo, const ShaderInfo *next);
 	bool AllocateFramebuffer(int w, int h);
+	Draw::Framebuffer *TakeSpareFramebuffer(int w, int h);
 
 	void BindSource(int binding);
 
@@ -157,4 +159,9 @@ class PresentationCommon {
 		int h;
 	};
 	std::vector<PrevFBO> postShaderFBOUsage_;
+	// Framebuffers of the previous chain, only while UpdatePostShader builds a new one.
+	std::vector<PrevFBO> spareFramebuffers_;
+	// Size of the last intermediate before its OutputScale, the base for the next in the chain.
+	int chainWidth_ = 0;
+	int chainHeight_ = 0;
 };
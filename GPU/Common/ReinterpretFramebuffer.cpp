@@ -8,6 +8,25 @@ static const VaryingDef varyings[1] = {
 	{ "vec2", "v_texcoord", "TEXCOORD0", 0, "highp" },
 };
 
+// Writes "uint <dst>" with the 16-bit color of vec4 <src> in the given format.
+static void WriteTo16Bit(ShaderWriter &writer, GEBufferFormat format, const char *src, const char *dst) {
+	switch (format) {
+	case GE_FORMAT_4444:
+		writer.F("  uint %s = uint(%s.r * 15.99) | (uint(%s.g * 15.99) << 4u) | (uint(%s.b * 15.99) << 8u) | (uint(%s.a * 15.99) << 12u);\n", dst, src, src, src, src);
+		break;
+	case GE_FORMAT_5551:
+		writer.F("  uint %s = uint(%s.r * 31.99) | (uint(%s.g * 31.99) << 5u) | (uint(%s.b * 31.99) << 10u);\n", dst, src, src, src);
+		writer.F("  if (%s.a >= 0.5) %s |= 0x8000U;\n", src, dst);
+		break;
+	case GE_FORMAT_565:
+		writer.F("  uint %s = uint(%s.r * 31.99) | (uint(%s.g * 63.99) << 5u) | (uint(%s.b * 31.99) << 11u);\n", dst, src, src, src);
+		break;
+	default:
+		_assert_(false);
+		break;
+	}
+}
+
 // TODO: We could possibly have an option to preserve any extra color precision? But gonna start without it.
 // Requires full size integer math. It would be possible to make a floating point-only version with lots of
 // modulo and stuff, might do it one day.
@@ -27,21 +46,7 @@ bool GenerateReinterpretFragmentShader(char *buffer, GEBufferFormat from, GEBuff
 
 	writer.C("  vec4 val = ").SampleTexture2D("tex", "samp", "v_texcoord.xy").C(";\n");
 
-	switch (from) {
-	case GE_FORMAT_4444:
-		writer.C("  uint color = uint(val.r * 15.99) | (uint(val.g * 15.99) << 4u) | (uint(val.b * 15.99) << 8u) | (uint(val.a * 15.99) << 12u);\n");
-		break;
-	case GE_FORMAT_5551:
-		writer.C("  uint color = uint(val.r * 31.99) | (uint(val.g * 31.99) << 5u) | (uint(val.b * 31.99) << 10u);\n");
-		writer.C("  if (val.a >= 0.5) color |= 0x8000U;\n");
-		break;
-	case GE_FORMAT_565:
-		writer.C("  uint color = uint(val.r * 31.99) | (uint(val.g * 63.99) << 5u) | (uint(val.b * 31.99) << 11u);\n");
-		break;
-	default:
-		_assert_(false);
-		break;
-	}
+	WriteTo16Bit(writer, from, "val", "color");
 
 	switch (to) {
 	case GE_FORMAT_4444:
@@ -67,6 +72,32 @@ bool GenerateReinterpretFragmentShader(char *buffer, GEBufferFormat from, GEBuff
 	return true;
 }
 
+bool GeneratePackFragmentShader(char *buffer, GEBufferFormat format, const ShaderLanguageDesc &lang) {
+	if (!lang.bitwiseOps) {
+		return false;
+	}
+
+	ShaderWriter writer(buffer, lang, ShaderStage::Fragment, nullptr, 0);
+
+	writer.HighPrecisionFloat();
+
+	writer.DeclareSampler2D("samp", 0);
+	writer.DeclareTexture2D("tex", 0);
+
+	writer.BeginFSMain(Slice<UniformDef>::empty(), varyings);
+
+	// The target is half as wide as the source, so the two source pixels are a quarter of a target pixel to each side.
+	writer.F("  float du = 0.25 * %s(v_texcoord.x);\n", lang.shaderLanguage == HLSL_D3D11 ? "ddx" : "dFdx");
+	writer.C("  vec4 val0 = ").SampleTexture2D("tex", "samp", "v_texcoord.xy - vec2(du, 0.0)").C(";\n");
+	writer.C("  vec4 val1 = ").SampleTexture2D("tex", "samp", "v_texcoord.xy + vec2(du, 0.0)").C(";\n");
+	WriteTo16Bit(writer, format, "val0", "color0");
+	WriteTo16Bit(writer, format, "val1", "color1");
+	writer.C("  vec4 outColor = vec4(float(color0 & 0xFFU), float(color0 >> 8u), float(color1 & 0xFFU), float(color1 >> 8u)) * (1.0 / 255.0);\n");
+
+	writer.EndFSMain("outColor");
+	return true;
+}
+
 bool GenerateReinterpretVertexShader(char *buffer, const ShaderLanguageDesc &lang) {
 	if (!lang.bitwiseOps) {
 		return false;
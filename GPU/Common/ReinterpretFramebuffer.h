@@ -7,6 +7,10 @@
 
 bool GenerateReinterpretFragmentShader(char *buffer, GEBufferFormat from, GEBufferFormat to, const ShaderLanguageDesc &lang);
 
+// Packs two pixels of a 16-bit format into each RGBA8888 pixel of a half width target, to read back as PSP memory.
+// Point sample the (possibly upscaled) source, which also downscales it to 1x.
+bool GeneratePackFragmentShader(char *buffer, GEBufferFormat format, const ShaderLanguageDesc &lang);
+
 // Just a single one. Can probably be shared with a lot of similar use cases.
 // Generates the coordinates for a fullscreen triangle.
 bool GenerateReinterpretVertexShader(char *buffer, const ShaderLanguageDesc &lang);
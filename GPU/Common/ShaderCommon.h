@@ -68,6 +68,7 @@ enum : uint64_t {
 
 	DIRTY_UVSCALEOFFSET = 1ULL << 18,
 	DIRTY_DEPTHRANGE = 1ULL << 19,
+	DIRTY_MORPHWEIGHTS = 1ULL << 20,  // Only when morph targets are blended in the vertex shader.
 
 	DIRTY_WORLDMATRIX = 1ULL << 21,
 	DIRTY_VIEWMATRIX = 1ULL << 22,
@@ -137,10 +138,16 @@ enum class PspAttributeLocation {
 	W2 = 4,
 	COLOR0 = 5,
 	COLOR1 = 6,
+	// Morph targets after the first, when blended in the vertex shader. Target by target,
+	// each with position, normal, texcoord, color as present, up to MAX_MORPH_ATTRIBUTES.
+	MORPH = 7,
 
 	COUNT
 };
 
+// Keeps the total at 16, the least GL 3 / GLES 3 and Vulkan implementations have to support.
+enum { MAX_MORPH_ATTRIBUTES = 9 };
+
 // Pre-fetched attrs and uniforms (used by GL only).
 enum {
 	ATTR_POSITION = 0,
@@ -150,6 +157,7 @@ enum {
 	ATTR_W2 = 4,
 	ATTR_COLOR0 = 5,
 	ATTR_COLOR1 = 6,
+	ATTR_MORPH = 7,
 
 	ATTR_COUNT,
 };
@@ -18,6 +18,7 @@ std::string VertexShaderDesc(const VShaderID &id) {
 	if (id.Bit(VS_BIT_USE_HW_TRANSFORM)) desc << "HWX ";
 	if (id.Bit(VS_BIT_HAS_COLOR)) desc << "C ";
 	if (id.Bit(VS_BIT_HAS_TEXCOORD)) desc << "T ";
+	if (id.Bit(VS_BIT_RAW_TEXCOORD)) desc << "RawT ";
 	if (id.Bit(VS_BIT_HAS_NORMAL)) desc << "N ";
 	if (id.Bit(VS_BIT_LMODE)) desc << "LM ";
 	if (id.Bit(VS_BIT_ENABLE_FOG)) desc << "Fog ";
@@ -35,6 +36,7 @@ std::string VertexShaderDesc(const VShaderID &id) {
 
 	if (uvgMode) desc << uvgModes[uvgMode];
 	if (id.Bit(VS_BIT_ENABLE_BONES)) desc << "Bones:" << (id.Bits(VS_BIT_BONES, 3) + 1) << " ";
+	if (id.Bits(VS_BIT_MORPH_TARGETS, 3)) desc << "Morph:" << (id.Bits(VS_BIT_MORPH_TARGETS, 3) + 1) << " ";
 	// Lights
 	if (id.Bit(VS_BIT_LIGHTING_ENABLE)) {
 		desc << "Light: ";
@@ -136,6 +138,8 @@ void ComputeVertexShaderID(VShaderID *id_out, u32 vertType, bool useHWTransform,
 
 		id.SetBit(VS_BIT_NORM_REVERSE, gstate.areNormalsReversed());
 		id.SetBit(VS_BIT_HAS_TEXCOORD, hasTexcoord);
+		if (gstate_c.morphTargetsInShader > 1)
+			id.SetBits(VS_BIT_MORPH_TARGETS, 3, gstate_c.morphTargetsInShader - 1);
 
 		if (useHWTessellation) {
 			id.SetBit(VS_BIT_BEZIER, doBezier);
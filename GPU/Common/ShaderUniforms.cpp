@@ -105,6 +105,9 @@ void BaseUpdateUniforms(UB_VS_FS_Base *ub, uint64_t dirtyUniforms, bool flipView
 		ub->texClampOffset[0] = gstate_c.curTextureXOffset * invW;
 		ub->texClampOffset[1] = gstate_c.curTextureYOffset * invH;
 	}
+	if (dirtyUniforms & DIRTY_MORPHWEIGHTS) {
+		memcpy(ub->morphWeights, gstate_c.morphWeights, sizeof(ub->morphWeights));
+	}
 
 	if (dirtyUniforms & DIRTY_PROJMATRIX) {
 		Matrix4x4 flippedMatrix;
@@ -207,6 +210,12 @@ void BaseUpdateUniforms(UB_VS_FS_Base *ub, uint64_t dirtyUniforms, bool flipView
 			ub->uvScaleOffset[1] = gstate_c.uv.vScale * heightFactor;
 			ub->uvScaleOffset[2] = gstate_c.uv.uOff * widthFactor;
 			ub->uvScaleOffset[3] = gstate_c.uv.vOff * heightFactor;
+		} else if (gstate_c.rawTexcoordScale != 0.0f) {
+			// The vertex decoder didn't prescale, so the shader has to do all of it.
+			ub->uvScaleOffset[0] = gstate_c.rawTexcoordScale * gstate_c.uv.uScale * widthFactor;
+			ub->uvScaleOffset[1] = gstate_c.rawTexcoordScale * gstate_c.uv.vScale * heightFactor;
+			ub->uvScaleOffset[2] = gstate_c.uv.uOff * widthFactor;
+			ub->uvScaleOffset[3] = gstate_c.uv.vOff * heightFactor;
 		} else {
 			ub->uvScaleOffset[0] = widthFactor;
 			ub->uvScaleOffset[1] = heightFactor;
@@ -149,6 +149,95 @@ static int ColorIndexOffset(int prim, GEShadeMode shadeMode, bool clearMode) {
 	return 0;
 }
 
+// Runs four positions at a time through the world, view and projection matrices, with the
+// vertices spread across the lanes. Outputs world positions (SoA) for lighting, view Z for fog,
+// and the clip coordinates per vertex, ready to copy into TransformedVertex::pos.
+static void TransformPositions4(const float pos[4][3], const float world[12], const float view[12], const float proj[16], float worldOut[3][4], float viewZ[4], float clipOut[4][4]) {
+#if defined(_M_SSE)
+	auto row43 = [](__m128 x, __m128 y, __m128 z, const float *m, int r) {
+		return _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m[r])), _mm_mul_ps(y, _mm_set1_ps(m[r + 3]))),
+			_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(m[r + 6])), _mm_set1_ps(m[r + 9])));
+	};
+	auto row44 = [](__m128 x, __m128 y, __m128 z, const float *m, int r) {
+		return _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(m[r])), _mm_mul_ps(y, _mm_set1_ps(m[r + 4]))),
+			_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(m[r + 8])), _mm_set1_ps(m[r + 12])));
+	};
+
+	__m128 x = _mm_setr_ps(pos[0][0], pos[1][0], pos[2][0], pos[3][0]);
+	__m128 y = _mm_setr_ps(pos[0][1], pos[1][1], pos[2][1], pos[3][1]);
+	__m128 z = _mm_setr_ps(pos[0][2], pos[1][2], pos[2][2], pos[3][2]);
+
+	__m128 wx = row43(x, y, z, world, 0);
+	__m128 wy = row43(x, y, z, world, 1);
+	__m128 wz = row43(x, y, z, world, 2);
+	_mm_storeu_ps(worldOut[0], wx);
+	_mm_storeu_ps(worldOut[1], wy);
+	_mm_storeu_ps(worldOut[2], wz);
+
+	__m128 vx = row43(wx, wy, wz, view, 0);
+	__m128 vy = row43(wx, wy, wz, view, 1);
+	__m128 vz = row43(wx, wy, wz, view, 2);
+	_mm_storeu_ps(viewZ, vz);
+
+	__m128 cx = row44(vx, vy, vz, proj, 0);
+	__m128 cy = row44(vx, vy, vz, proj, 1);
+	__m128 cz = row44(vx, vy, vz, proj, 2);
+	__m128 cw = row44(vx, vy, vz, proj, 3);
+	_MM_TRANSPOSE4_PS(cx, cy, cz, cw);
+	_mm_storeu_ps(clipOut[0], cx);
+	_mm_storeu_ps(clipOut[1], cy);
+	_mm_storeu_ps(clipOut[2], cz);
+	_mm_storeu_ps(clipOut[3], cw);
+#elif PPSSPP_ARCH(ARM_NEON)
+	auto row43 = [](float32x4_t x, float32x4_t y, float32x4_t z, const float *m, int r) {
+		float32x4_t sum = vmlaq_n_f32(vdupq_n_f32(m[r + 9]), x, m[r]);
+		sum = vmlaq_n_f32(sum, y, m[r + 3]);
+		return vmlaq_n_f32(sum, z, m[r + 6]);
+	};
+	auto row44 = [](float32x4_t x, float32x4_t y, float32x4_t z, const float *m, int r) {
+		float32x4_t sum = vmlaq_n_f32(vdupq_n_f32(m[r + 12]), x, m[r]);
+		sum = vmlaq_n_f32(sum, y, m[r + 4]);
+		return vmlaq_n_f32(sum, z, m[r + 8]);
+	};
+
+	// De-interleaves xyz into three registers of four vertices each.
+	float32x4x3_t in = vld3q_f32(&pos[0][0]);
+
+	float32x4_t wx = row43(in.val[0], in.val[1], in.val[2], world, 0);
+	float32x4_t wy = row43(in.val[0], in.val[1], in.val[2], world, 1);
+	float32x4_t wz = row43(in.val[0], in.val[1], in.val[2], world, 2);
+	vst1q_f32(worldOut[0], wx);
+	vst1q_f32(worldOut[1], wy);
+	vst1q_f32(worldOut[2], wz);
+
+	float32x4_t vx = row43(wx, wy, wz, view, 0);
+	float32x4_t vy = row43(wx, wy, wz, view, 1);
+	float32x4_t vz = row43(wx, wy, wz, view, 2);
+	vst1q_f32(viewZ, vz);
+
+	float32x4x4_t clip;
+	clip.val[0] = row44(vx, vy, vz, proj, 0);
+	clip.val[1] = row44(vx, vy, vz, proj, 1);
+	clip.val[2] = row44(vx, vy, vz, proj, 2);
+	clip.val[3] = row44(vx, vy, vz, proj, 3);
+	// Interleaves back into xyzw per vertex.
+	vst4q_f32(&clipOut[0][0], clip);
+#else
+	for (int i = 0; i < 4; i++) {
+		float out[3];
+		float v[3];
+		Vec3ByMatrix43(out, pos[i], world);
+		Vec3ByMatrix43(v, out, view);
+		Vec3ByMatrix44(clipOut[i], v, proj);
+		for (int j = 0; j < 3; j++)
+			worldOut[j][i] = out[j];
+		viewZ[i] = v[2];
+	}
+#endif
+}
+
 void SoftwareTransform::SetProjMatrix(float mtx[14], bool invertedX, bool invertedY, const Lin::Vec3 &trans, const Lin::Vec3 &scale) {
 	memcpy(&projMatrix_.m, mtx, 16 * sizeof(float));
 
@@ -207,7 +296,14 @@ void SoftwareTransform::Decode(int prim, u32 vertType, const DecVtxFormat &decVt
 
 	VertexReader reader(decoded, decVtxFormat, vertType);
 	if (throughmode) {
+		u32 materialColor = gstate.getMaterialAmbientRGBA();
+		int nextMaterialColor = 0;
 		for (int index = 0; index < maxIndex; index++) {
+			while (nextMaterialColor < params_.numMaterialColors && params_.materialColors[nextMaterialColor].firstVertex <= index) {
+				materialColor = params_.materialColors[nextMaterialColor].color;
+				nextMaterialColor++;
+			}
+
 			// Do not touch the coordinates or the colors. No lighting.
 			reader.Goto(index);
 			// TODO: Write to a flexible buffer, we don't always need all four components.
@@ -224,7 +320,7 @@ void SoftwareTransform::Decode(int prim, u32 vertType, const DecVtxFormat &decVt
 					reader.ReadColor0_8888(vert.color0);
 				}
 			} else {
-				vert.color0_32 = gstate.getMaterialAmbientRGBA();
+				vert.color0_32 = materialColor;
 			}
 
 			if (reader.hasUV()) {
@@ -242,8 +338,36 @@ void SoftwareTransform::Decode(int prim, u32 vertType, const DecVtxFormat &decVt
 			// The w of uv is also never used (hardcoded to 1.0.)
 		}
 	} else {
+		// Without skinning, positions go through all three matrices four vertices at a time.
+		// Lighting and texgen stay per vertex below.
+		float batchPos[4][3];
+		float batchWorld[3][4];
+		float batchViewZ[4];
+		float batchClip[4][4];
+		int batchStart = -1;
+
+		// BuildDrawingParams culls triangles against the depth range, flag each vertex while it's hot.
+		float minZValue = 0.0f, maxZValue = 0.0f;
+		s8 *outsideZ = nullptr;
+		if (prim == GE_PRIM_TRIANGLES && !gstate_c.Supports(GPU_SUPPORTS_CULL_DISTANCE)) {
+			CalcCullParams(minZValue, maxZValue);
+			outsideZ_.resize(maxIndex);
+			outsideZ = outsideZ_.data();
+		}
+
 		// Okay, need to actually perform the full transform.
 		for (int index = 0; index < maxIndex; index++) {
+			if (!skinningEnabled && (index & 3) == 0 && index + 4 <= maxIndex) {
+				for (int i = 0; i < 4; i++) {
+					reader.Goto(index + i);
+					reader.ReadPos(batchPos[i]);
+				}
+				TransformPositions4(batchPos, gstate.worldMatrix, gstate.viewMatrix, projMatrix_.m, batchWorld, batchViewZ, batchClip);
+				batchStart = index;
+			}
+			const int lane = index - batchStart;
+			const bool batched = batchStart >= 0 && lane < 4;
+
 			reader.Goto(index);
 
 			float v[3] = {0, 0, 0};
@@ -256,7 +380,11 @@ void SoftwareTransform::Decode(int prim, u32 vertType, const DecVtxFormat &decVt
 			float pos[3];
 			Vec3f normal(0, 0, 1);
 			Vec3f worldnormal(0, 0, 1);
-			reader.ReadPos(pos);
+			if (batched) {
+				memcpy(pos, batchPos[lane], sizeof(pos));
+			} else {
+				reader.ReadPos(pos);
+			}
 
 			float ruv[2] = { 0.0f, 0.0f };
 			if (reader.hasUV())
@@ -274,7 +402,13 @@ void SoftwareTransform::Decode(int prim, u32 vertType, const DecVtxFormat &decVt
 				reader.ReadNrm(normal.AsArray());
 
 			if (!skinningEnabled) {
-				Vec3ByMatrix43(out, pos, gstate.worldMatrix);
+				if (batched) {
+					out[0] = batchWorld[0][lane];
+					out[1] = batchWorld[1][lane];
+					out[2] = batchWorld[2][lane];
+				} else {
+					Vec3ByMatrix43(out, pos, gstate.worldMatrix);
+				}
 				if (reader.hasNormal()) {
 					if (gstate.areNormalsReversed()) {
 						normal = -normal;
@@ -427,11 +561,25 @@ void SoftwareTransform::Decode(int prim, u32 vertType, const DecVtxFormat &decVt
 			uv[1] = uv[1] * heightFactor;
 
 			// Transform the coord by the view matrix.
-			Vec3ByMatrix43(v, out, gstate.viewMatrix);
-			fogCoef = (v[2] + fog_end) * fog_slope;
+			if (batched) {
+				fogCoef = (batchViewZ[lane] + fog_end) * fog_slope;
+				memcpy(transformed[index].pos, batchClip[lane], sizeof(transformed[index].pos));
+			} else {
+				Vec3ByMatrix43(v, out, gstate.viewMatrix);
+				fogCoef = (v[2] + fog_end) * fog_slope;
 
-			// TODO: Write to a flexible buffer, we don't always need all four components.
-			Vec3ByMatrix44(transformed[index].pos, v, projMatrix_.m);
+				// TODO: Write to a flexible buffer, we don't always need all four components.
+				Vec3ByMatrix44(transformed[index].pos, v, projMatrix_.m);
+			}
+			if (outsideZ) {
+				float z = transformed[index].z / transformed[index].pos_w;
+				if (z >= maxZValue)
+					outsideZ[index] = 1;
+				else if (z <= minZValue)
+					outsideZ[index] = -1;
+				else
+					outsideZ[index] = 0;
+			}
 			transformed[index].fog = fogCoef;
 			memcpy(&transformed[index].uv, uv, 3 * sizeof(float));
 			transformed[index].color0_32 = c0.ToRGBA();
@@ -609,21 +757,25 @@ void SoftwareTransform::BuildDrawingParams(int prim, int vertexCount, u32 vertTy
 			u16 *newInds = inds + vertexCount;
 			u16 *indsOut = newInds;
 
-			float minZValue, maxZValue;
-			CalcCullParams(minZValue, maxZValue);
-
-			std::vector<int> outsideZ;
+			// Decode already flagged each vertex as inside or outside, look them up per index.
+			std::vector<s8> outsideZ;
 			outsideZ.resize(vertexCount);
-
-			// First, check inside/outside directions for each index.
-			for (int i = 0; i < vertexCount; ++i) {
-				float z = transformed[indsIn[i]].z / transformed[indsIn[i]].pos_w;
-				if (z >= maxZValue)
-					outsideZ[i] = 1;
-				else if (z <= minZValue)
-					outsideZ[i] = -1;
-				else
-					outsideZ[i] = 0;
+			if (outsideZ_.size() >= (size_t)maxIndex) {
+				for (int i = 0; i < vertexCount; ++i)
+					outsideZ[i] = outsideZ_[indsIn[i]];
+			} else {
+				float minZValue, maxZValue;
+				CalcCullParams(minZValue, maxZValue);
+
+				for (int i = 0; i < vertexCount; ++i) {
+					float z = transformed[indsIn[i]].z / transformed[indsIn[i]].pos_w;
+					if (z >= maxZValue)
+						outsideZ[i] = 1;
+					else if (z <= minZValue)
+						outsideZ[i] = -1;
+					else
+						outsideZ[i] = 0;
+				}
 			}
 
 			// Now, for each primitive type, throw away the indices if:
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "Common/CommonTypes.h"
 #include "Common/Math/lin/matrix4x4.h"
 #include "GPU/Common/VertexDecoderCommon.h"
@@ -47,6 +49,13 @@ struct SoftwareTransformResult {
 	bool drawIndexed;
 };
 
+// Through mode draws with different material colors can share a flush. Each range
+// gives the color for the decoded vertices from firstVertex up to the next range.
+struct MaterialColorRange {
+	int firstVertex;
+	u32 color;
+};
+
 struct SoftwareTransformParams {
 	u8 *decoded;
 	TransformedVertex *transformed;
@@ -58,6 +67,9 @@ struct SoftwareTransformParams {
 	bool provokeFlatFirst;
 	bool flippedY;
 	bool usesHalfZ;
+	// Empty unless the flush batched several material colors.
+	const MaterialColorRange *materialColors;
+	int numMaterialColors;
 };
 
 class SoftwareTransform {
@@ -78,4 +90,6 @@ class SoftwareTransform {
 
 	const SoftwareTransformParams &params_;
 	Lin::Matrix4x4 projMatrix_;
+	// Per decoded vertex: 1 beyond the far depth range, -1 beyond the near one, 0 inside.
+	std::vector<s8> outsideZ_;
 };
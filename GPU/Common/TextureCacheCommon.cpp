@@ -16,13 +16,17 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <algorithm>
+#include <functional>
 
 #include "ppsspp_config.h"
 #include "Common/Data/Convert/ColorConv.h"
+#include "Common/Profiler/MemoryUsage.h"
 #include "Common/Profiler/Profiler.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtils.h"
 #include "Common/TimeUtil.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Core/Config.h"
 #include "Core/Debugger/MemBlockInfo.h"
 #include "Core/Reporting.h"
@@ -66,6 +70,8 @@
 #define TEXCACHE_DECIMATION_INTERVAL 13
 
 #define TEXCACHE_MIN_PRESSURE 16 * 1024 * 1024  // Total in VRAM
+// Never aim lower than this, even if the device says it's very short on memory.
+#define TEXCACHE_MIN_BUDGET 32 * 1024 * 1024
 #define TEXCACHE_SECOND_MIN_PRESSURE 4 * 1024 * 1024
 
 // Just for reference
@@ -129,6 +135,7 @@ TextureCacheCommon::TextureCacheCommon(Draw::DrawContext *draw)
 }
 
 TextureCacheCommon::~TextureCacheCommon() {
+	FinishIdleVerify();
 	FreeAlignedMemory(clutBufConverted_);
 	FreeAlignedMemory(clutBufRaw_);
 }
@@ -305,6 +312,28 @@ SamplerCacheKey TextureCacheCommon::GetFramebufferSamplingParams(u16 bufferWidth
 	return key;
 }
 
+void TextureCacheCommon::SetCurTextureSize(const TexCacheEntry *entry, int w, int h) {
+	if (entry->atlasPage == 0) {
+		if (gstate_c.curTextureWidth != (u32)w || gstate_c.curTextureHeight != (u32)h) {
+			gstate_c.Dirty(DIRTY_UVSCALEOFFSET);
+		}
+		gstate_c.curTextureWidth = w;
+		gstate_c.curTextureHeight = h;
+		return;
+	}
+
+	// Same as a framebuffer texture at an offset: the shader clamps or wraps inside the sub-rect.
+	gstate_c.curTextureWidth = TEXCACHE_ATLAS_PAGE_SIZE;
+	gstate_c.curTextureHeight = TEXCACHE_ATLAS_PAGE_SIZE;
+	if ((gstate_c.curTextureXOffset == 0) != (entry->atlasX == 0) || (gstate_c.curTextureYOffset == 0) != (entry->atlasY == 0)) {
+		gstate_c.Dirty(DIRTY_FRAGMENTSHADER_STATE);
+	}
+	gstate_c.curTextureXOffset = entry->atlasX;
+	gstate_c.curTextureYOffset = entry->atlasY;
+	gstate_c.SetNeedShaderTexclamp(true);
+	gstate_c.Dirty(DIRTY_TEXCLAMP | DIRTY_UVSCALEOFFSET);
+}
+
 void TextureCacheCommon::UpdateMaxSeenV(TexCacheEntry *entry, bool throughMode) {
 	// If the texture is >= 512 pixels tall...
 	if (entry->dim >= 0x900) {
@@ -373,13 +402,15 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 	}
 
 	bool hasClut = gstate.isTextureFormatIndexed();
+	// Index textures are shared by all palettes, so the CLUT isn't part of the key.
+	bool indexed = hasClut && UseIndexTexture(format);
 	u32 cluthash;
 	if (hasClut) {
 		if (clutLastFormat_ != gstate.clutformat) {
 			// We update here because the clut format can be specified after the load.
 			UpdateCurrentClut(gstate.getClutPaletteFormat(), gstate.getClutIndexStartPos(), gstate.isClutIndexSimple());
 		}
-		cluthash = clutHash_ ^ gstate.clutformat;
+		cluthash = indexed ? 0 : clutHash_ ^ gstate.clutformat;
 	} else {
 		cluthash = 0;
 	}
@@ -407,6 +438,10 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 		// Validate the texture still matches the cache entry.
 		bool match = entry->Matches(dim, format, maxLevel);
 		const char *reason = "different params";
+		if (((entry->status & TexCacheEntry::STATUS_INDEXED) != 0) != indexed) {
+			match = false;
+			reason = "index texture";
+		}
 
 		// Check for FBO changes.
 		if (entry->status & TexCacheEntry::STATUS_FRAMEBUFFER_OVERLAP) {
@@ -416,12 +451,15 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 		}
 
 		bool rehash = entry->GetHashStatus() == TexCacheEntry::STATUS_UNRELIABLE;
+		// Set when a sampled hash isn't enough.
+		bool forceFullHash = false;
 
 		// First let's see if another texture with the same address had a hashfail.
-		if (entry->status & TexCacheEntry::STATUS_CLUT_RECHECK) {
+		if (entry->status & (TexCacheEntry::STATUS_CLUT_RECHECK | TexCacheEntry::STATUS_VERIFY_FAILED)) {
 			// Always rehash in this case, if one changed the rest all probably did.
 			rehash = true;
-			entry->status &= ~TexCacheEntry::STATUS_CLUT_RECHECK;
+			forceFullHash = true;
+			entry->status &= ~(TexCacheEntry::STATUS_CLUT_RECHECK | TexCacheEntry::STATUS_VERIFY_FAILED);
 		} else if (!gstate_c.IsDirty(DIRTY_TEXTURE_IMAGE)) {
 			// Okay, just some parameter change - the data didn't change, no need to rehash.
 			rehash = false;
@@ -434,7 +472,8 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 		}
 
 		if (match) {
-			if (entry->lastFrame != gpuStats.numFlips) {
+			const bool firstUseThisFrame = entry->lastFrame != gpuStats.numFlips;
+			if (firstUseThisFrame) {
 				u32 diff = gpuStats.numFlips - entry->lastFrame;
 				entry->numFrames++;
 
@@ -456,6 +495,7 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 			if (entry->invalidHint > 180 || (entry->invalidHint > 15 && (dim >> 8) < 9 && (dim & 0xF) < 9)) {
 				entry->invalidHint = 0;
 				rehash = true;
+				forceFullHash = true;
 			}
 
 			if (minihash != entry->minihash) {
@@ -463,6 +503,8 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 				reason = "minihash";
 			} else if (entry->GetHashStatus() == TexCacheEntry::STATUS_RELIABLE) {
 				rehash = false;
+			} else if (!forceFullHash && g_Config.bTextureBackoffCache && !IsVideo(texaddr)) {
+				rehash = NeedsFullHash(entry, gstate.getTextureHeight(0), rehash, firstUseThisFrame);
 			}
 		}
 
@@ -474,6 +516,11 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 			}
 		}
 
+		if (match && (entry->status & TexCacheEntry::STATUS_TO_UPLOAD) && uploadBytesThisFrame_ < uploadFrameBudget_) {
+			match = false;
+			reason = "mip upload";
+		}
+
 		if (match && (entry->status & TexCacheEntry::STATUS_TO_REPLACE) && replacementTimeThisFrame_ < replacementFrameBudget_) {
 			int w0 = gstate.getTextureWidth(0);
 			int h0 = gstate.getTextureHeight(0);
@@ -486,8 +533,7 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 
 		if (match) {
 			// got one!
-			gstate_c.curTextureWidth = w;
-			gstate_c.curTextureHeight = h;
+			SetCurTextureSize(entry, w, h);
 			if (rehash) {
 				// Update in case any of these changed.
 				entry->sizeInRAM = (textureBitsPerPixel[format] * bufw * h / 2) / 8;
@@ -578,6 +624,11 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 	}
 
 	// We have to decode it, let's setup the cache entry first.
+	if (indexed) {
+		entry->status |= TexCacheEntry::STATUS_INDEXED;
+	} else {
+		entry->status &= ~TexCacheEntry::STATUS_INDEXED;
+	}
 	entry->addr = texaddr;
 	entry->minihash = minihash;
 	entry->dim = dim;
@@ -688,6 +739,9 @@ int TextureCacheCommon::GetBestCandidateIndex(const std::vector<AttachCandidate>
 
 // Removes old textures.
 void TextureCacheCommon::Decimate(bool forcePressure) {
+	// Called every frame, so this is a good place to report, even if we don't decimate this time.
+	MemoryUsage_Set(MemoryCategory::TEXTURE_CACHE, (int64_t)cacheSizeEstimate_ + secondCacheSizeEstimate_);
+
 	if (--decimationCounter_ <= 0) {
 		decimationCounter_ = TEXCACHE_DECIMATION_INTERVAL;
 	} else {
@@ -712,6 +766,11 @@ void TextureCacheCommon::Decimate(bool forcePressure) {
 		VERBOSE_LOG(G3D, "Decimated texture cache, saved %d estimated bytes - now %d bytes", had - cacheSizeEstimate_, cacheSizeEstimate_);
 	}
 
+	u32 budget = TextureMemoryBudget();
+	if (budget != 0 && cacheSizeEstimate_ > budget) {
+		DecimateToBudget(budget);
+	}
+
 	// If enabled, we also need to clear the secondary cache.
 	if (g_Config.bTextureSecondaryCache && (forcePressure || secondCacheSizeEstimate_ >= TEXCACHE_SECOND_MIN_PRESSURE)) {
 		const u32 had = secondCacheSizeEstimate_;
@@ -720,7 +779,7 @@ void TextureCacheCommon::Decimate(bool forcePressure) {
 			// In low memory mode, we kill them all since secondary cache is disabled.
 			if (lowMemoryMode_ || iter->second->lastFrame + TEXTURE_SECOND_KILL_AGE < gpuStats.numFlips) {
 				ReleaseTexture(iter->second.get(), true);
-				secondCacheSizeEstimate_ -= EstimateTexMemoryUsage(iter->second.get());
+				secondCacheSizeEstimate_ -= iter->second->memoryUsage;
 				secondCache_.erase(iter++);
 			} else {
 				++iter;
@@ -734,6 +793,60 @@ void TextureCacheCommon::Decimate(bool forcePressure) {
 	replacer_.Decimate(forcePressure);
 }
 
+u32 TextureCacheCommon::TextureMemoryBudget() {
+	u64 budget = 0;
+	if (g_Config.iTextureCacheBudgetMB > 0) {
+		budget = (u64)g_Config.iTextureCacheBudgetMB * 1024 * 1024;
+	} else {
+		// Whatever we already hold plus what's left, minus some room for framebuffers and such.
+		u64 available = DeviceMemoryBudget();
+		if (available == 0)
+			return 0;
+		budget = cacheSizeEstimate_ + secondCacheSizeEstimate_ + available / 2;
+	}
+	budget = std::max(budget, (u64)TEXCACHE_MIN_BUDGET);
+	return (u32)std::min(budget, (u64)0xFFFFFFFF);
+}
+
+void TextureCacheCommon::DecimateToBudget(u32 budget) {
+	const u32 had = cacheSizeEstimate_;
+	// Go a bit under, so we don't end up back here next time.
+	const u32 target = budget - budget / 8;
+
+	ForgetLastTexture();
+	std::vector<TexCache::iterator> candidates;
+	candidates.reserve(cache_.size());
+	for (TexCache::iterator iter = cache_.begin(); iter != cache_.end(); ++iter) {
+		// Anything used this frame may still be referenced by queued draws.
+		if (iter->second->lastFrame < gpuStats.numFlips)
+			candidates.push_back(iter);
+	}
+
+	// Least recently used first, and among those, the most expensive first.
+	std::sort(candidates.begin(), candidates.end(), [](const TexCache::iterator &a, const TexCache::iterator &b) {
+		if (a->second->lastFrame != b->second->lastFrame)
+			return a->second->lastFrame < b->second->lastFrame;
+		return a->second->memoryUsage > b->second->memoryUsage;
+	});
+
+	for (TexCache::iterator iter : candidates) {
+		if (cacheSizeEstimate_ <= target)
+			break;
+		DeleteTexture(iter);
+	}
+
+	// The secondary cache is only an optimization, so drop it before going over.
+	if (cacheSizeEstimate_ + secondCacheSizeEstimate_ > budget) {
+		for (auto &iter : secondCache_) {
+			ReleaseTexture(iter.second.get(), true);
+		}
+		secondCache_.clear();
+		secondCacheSizeEstimate_ = 0;
+	}
+
+	DEBUG_LOG(G3D, "Texture cache over budget (%d bytes), freed %d estimated bytes - now %d bytes", budget, had - cacheSizeEstimate_, cacheSizeEstimate_);
+}
+
 void TextureCacheCommon::DecimateVideos() {
 	for (auto iter = videos_.begin(); iter != videos_.end(); ) {
 		if (iter->flips + VIDEO_DECIMATE_AGE < gpuStats.numFlips) {
@@ -757,8 +870,20 @@ bool TextureCacheCommon::IsVideo(u32 texaddr) {
 	return false;
 }
 
+u32 TextureCacheCommon::VideoUploadSeq(u32 texaddr) {
+	texaddr &= 0x3FFFFFFF;
+	u32 seq = 0;
+	for (auto info : videos_) {
+		if (texaddr >= info.addr && texaddr < info.addr + info.size) {
+			seq = std::max(seq, info.seq);
+		}
+	}
+	return seq;
+}
+
 void TextureCacheCommon::HandleTextureChange(TexCacheEntry *const entry, const char *reason, bool initialMatch, bool doDelete) {
-	cacheSizeEstimate_ -= EstimateTexMemoryUsage(entry);
+	cacheSizeEstimate_ -= entry->memoryUsage;
+	entry->memoryUsage = 0;
 	entry->numInvalidated++;
 	gpuStats.numTextureInvalidations++;
 	DEBUG_LOG(G3D, "Texture different or overwritten, reloading at %08x: %s", entry->addr, reason);
@@ -1115,7 +1240,10 @@ void TextureCacheCommon::NotifyConfigChanged() {
 
 void TextureCacheCommon::NotifyVideoUpload(u32 addr, int size, int width, GEBufferFormat fmt) {
 	addr &= 0x3FFFFFFF;
-	videos_.push_back({ addr, (u32)size, gpuStats.numFlips });
+	// Zero means not a video.
+	if (++videoUploadSeq_ == 0)
+		videoUploadSeq_ = 1;
+	videos_.push_back({ addr, (u32)size, gpuStats.numFlips, videoUploadSeq_ });
 }
 
 void TextureCacheCommon::LoadClut(u32 clutAddr, u32 loadBytes) {
@@ -1242,7 +1370,7 @@ bool TextureCacheCommon::GetCurrentClutBuffer(GPUDebugBuffer &buffer) {
 }
 
 // Host memory usage, not PSP memory usage.
-u32 TextureCacheCommon::EstimateTexMemoryUsage(const TexCacheEntry *entry) {
+u32 TextureCacheCommon::EstimateTexMemoryUsage(const TexCacheEntry *entry, int scaleFactor) {
 	const u16 dim = entry->dim;
 	// TODO: This does not take into account the HD remaster's larger textures.
 	const u8 dimW = ((dim >> 0) & 0xf);
@@ -1272,7 +1400,25 @@ u32 TextureCacheCommon::EstimateTexMemoryUsage(const TexCacheEntry *entry) {
 	}
 
 	// This in other words multiplies by w and h.
-	return pixelSize << (dimW + dimH);
+	return (pixelSize << (dimW + dimH)) * scaleFactor * scaleFactor;
+}
+
+void TextureCacheCommon::SetTexMemoryUsage(TexCacheEntry *entry, u32 bytes) {
+	cacheSizeEstimate_ += bytes - entry->memoryUsage;
+	entry->memoryUsage = bytes;
+}
+
+void TextureCacheCommon::SetTexMemoryUsage(TexCacheEntry *entry, ReplacedTexture &replaced, int scaleFactor) {
+	int w, h;
+	if (replaced.Valid() && replaced.GetSize(0, w, h)) {
+		// Replacements are always uploaded as 8888, mips add about a third.
+		u32 bytes = (u32)w * (u32)h * 4;
+		if (replaced.MaxLevel() > 0)
+			bytes += bytes / 3;
+		SetTexMemoryUsage(entry, bytes);
+	} else {
+		SetTexMemoryUsage(entry, EstimateTexMemoryUsage(entry, scaleFactor));
+	}
 }
 
 ReplacedTexture &TextureCacheCommon::FindReplacement(TexCacheEntry *entry, int &w, int &h) {
@@ -1344,6 +1490,11 @@ static inline void ConvertFormatToRGBA8888(GEPaletteFormat format, u32 *dst, con
 	ConvertFormatToRGBA8888(GETextureFormat(format), dst, src, numPixels);
 }
 
+// Below this many texels, splitting the decode across threads costs more than it saves.
+static const int TEXTURE_DECODE_PARALLEL_MIN_TEXELS = 256 * 256;
+// A multiple of both the swizzle block height (8) and the DXT block height (4).
+static const int TEXTURE_DECODE_ROWS_PER_TASK = 16;
+
 template <typename DXTBlock, int n>
 static void DecodeDXTBlock(uint8_t *out, int outPitch, uint32_t texaddr, const uint8_t *texptr, int w, int h, int bufw, bool reverseColors, bool useBGRA) {
 	int minw = std::min(bufw, w);
@@ -1378,6 +1529,7 @@ static void DecodeDXTBlock(uint8_t *out, int outPitch, uint32_t texaddr, const u
 }
 
 void TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, GETextureFormat format, GEPaletteFormat clutformat, uint32_t texaddr, int level, int bufw, bool reverseColors, bool useBGRA, bool expandTo32bit) {
+	GPUStatsTimer timer(&gpuStats.msDecodingTextures);
 	bool swizzled = gstate.isTextureSwizzled();
 	if ((texaddr & 0x00600000) != 0 && Memory::IsVRAMAddress(texaddr)) {
 		// This means it's in a mirror, possibly a swizzled mirror.  Let's report.
@@ -1398,6 +1550,39 @@ void TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, GETextureForm
 	size_t len = snprintf(buf, sizeof(buf), "Tex_%08x_%dx%d_%s", texaddr, w, h, GeTextureFormatToString(format, clutformat));
 	NotifyMemInfo(MemBlockFlags::TEXTURE, texaddr, byteSize, buf, len);
 
+	// Do everything that writes shared state up front, so the rows can be decoded on several threads.
+	const bool mipmapShareClut = gstate.isClutSharedForMipmaps();
+	const int clutSharingOffset = mipmapShareClut ? 0 : level * 16;
+	if (expandTo32bit && clutformat != GE_CMODE_32BIT_ABGR8888) {
+		if (format == GE_TFMT_CLUT4 && !reverseColors) {
+			ConvertFormatToRGBA8888(clutformat, expandClut_, GetCurrentClut<u16>() + clutSharingOffset, 16);
+		} else if (format == GE_TFMT_CLUT8 || format == GE_TFMT_CLUT16 || format == GE_TFMT_CLUT32) {
+			ConvertFormatToRGBA8888(clutformat, expandClut_, GetCurrentClut<u16>(), 256);
+		}
+	}
+	u32 *scratch = nullptr;
+	if (swizzled) {
+		tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
+		scratch = tmpTexBuf32_.data();
+	}
+
+	if (w * h < TEXTURE_DECODE_PARALLEL_MIN_TEXELS || h % TEXTURE_DECODE_ROWS_PER_TASK != 0) {
+		DecodeTextureRows(out, outPitch, format, clutformat, texaddr, texptr, level, w, h, bufw, swizzled, scratch, reverseColors, useBGRA, expandTo32bit);
+		return;
+	}
+
+	// Split into bands of whole swizzle (and DXT) blocks. Each band has its own slice of the scratch buffer.
+	const int bitsPerPixel = textureBitsPerPixel[format];
+	ParallelRangeLoop(&g_threadManager, [&](int lower, int upper) {
+		const int y = lower * TEXTURE_DECODE_ROWS_PER_TASK;
+		const int rows = (upper - lower) * TEXTURE_DECODE_ROWS_PER_TASK;
+		const u32 srcOffset = (u32)(y * bufw * bitsPerPixel / 8);
+		DecodeTextureRows(out + outPitch * y, outPitch, format, clutformat, texaddr + srcOffset, texptr + srcOffset, level, w, rows, bufw, swizzled,
+			scratch ? scratch + y * bufw : nullptr, reverseColors, useBGRA, expandTo32bit);
+	}, 0, h / TEXTURE_DECODE_ROWS_PER_TASK, 4);
+}
+
+void TextureCacheCommon::DecodeTextureRows(u8 *out, int outPitch, GETextureFormat format, GEPaletteFormat clutformat, uint32_t texaddr, const u8 *texptr, int level, int w, int h, int bufw, bool swizzled, u32 *scratch, bool reverseColors, bool useBGRA, bool expandTo32bit) {
 	switch (format) {
 	case GE_TFMT_CLUT4:
 	{
@@ -1405,9 +1590,8 @@ void TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, GETextureForm
 		const int clutSharingOffset = mipmapShareClut ? 0 : level * 16;
 
 		if (swizzled) {
-			tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
-			UnswizzleFromMem(tmpTexBuf32_.data(), bufw / 2, texptr, bufw, h, 0);
-			texptr = (u8 *)tmpTexBuf32_.data();
+			UnswizzleFromMem(scratch, bufw / 2, texptr, bufw, h, 0);
+			texptr = (u8 *)scratch;
 		}
 
 		switch (clutformat) {
@@ -1429,8 +1613,7 @@ void TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, GETextureForm
 			} else {
 				const u16 *clut = GetCurrentClut<u16>() + clutSharingOffset;
 				if (expandTo32bit && !reverseColors) {
-					// We simply expand the CLUT to 32-bit, then we deindex as usual. Probably the fastest way.
-					ConvertFormatToRGBA8888(clutformat, expandClut_, clut, 16);
+					// We simply expand the CLUT to 32-bit (already done above), then we deindex as usual. Probably the fastest way.
 					for (int y = 0; y < h; ++y) {
 						DeIndexTexture4((u32 *)(out + outPitch * y), texptr + (bufw * y) / 2, w, expandClut_);
 					}
@@ -1460,15 +1643,15 @@ void TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, GETextureForm
 	break;
 
 	case GE_TFMT_CLUT8:
-		ReadIndexedTex(out, outPitch, level, texptr, 1, bufw, expandTo32bit);
+		ReadIndexedTex(out, outPitch, w, h, texptr, 1, bufw, scratch, expandTo32bit);
 		break;
 
 	case GE_TFMT_CLUT16:
-		ReadIndexedTex(out, outPitch, level, texptr, 2, bufw, expandTo32bit);
+		ReadIndexedTex(out, outPitch, w, h, texptr, 2, bufw, scratch, expandTo32bit);
 		break;
 
 	case GE_TFMT_CLUT32:
-		ReadIndexedTex(out, outPitch, level, texptr, 4, bufw, expandTo32bit);
+		ReadIndexedTex(out, outPitch, w, h, texptr, 4, bufw, scratch, expandTo32bit);
 		break;
 
 	case GE_TFMT_4444:
@@ -1497,9 +1680,8 @@ void TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, GETextureForm
 			}
 		} else {
 			// We don't have enough space for all rows in out, so use a temp buffer.
-			tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
-			UnswizzleFromMem(tmpTexBuf32_.data(), bufw * 2, texptr, bufw, h, 2);
-			const u8 *unswizzled = (u8 *)tmpTexBuf32_.data();
+			UnswizzleFromMem(scratch, bufw * 2, texptr, bufw, h, 2);
+			const u8 *unswizzled = (u8 *)scratch;
 
 			if (reverseColors) {
 				for (int y = 0; y < h; ++y) {
@@ -1535,9 +1717,8 @@ void TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, GETextureForm
 			}
 		} else {
 			// We don't have enough space for all rows in out, so use a temp buffer.
-			tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
-			UnswizzleFromMem(tmpTexBuf32_.data(), bufw * 4, texptr, bufw, h, 4);
-			const u8 *unswizzled = (u8 *)tmpTexBuf32_.data();
+			UnswizzleFromMem(scratch, bufw * 4, texptr, bufw, h, 4);
+			const u8 *unswizzled = (u8 *)scratch;
 
 			if (reverseColors) {
 				for (int y = 0; y < h; ++y) {
@@ -1569,14 +1750,52 @@ void TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, GETextureForm
 	}
 }
 
-void TextureCacheCommon::ReadIndexedTex(u8 *out, int outPitch, int level, const u8 *texptr, int bytesPerIndex, int bufw, bool expandTo32Bit) {
-	int w = gstate.getTextureWidth(level);
-	int h = gstate.getTextureHeight(level);
+bool TextureCacheCommon::UseIndexTexture(GETextureFormat format) {
+	if (!g_Config.bShaderDepalTextures || !SupportsIndexTextures())
+		return false;
+	if (format != GE_TFMT_CLUT4 && format != GE_TFMT_CLUT8)
+		return false;
+	// Mips could have their own CLUT offsets, replacements are keyed on the CLUT, and indices can't be scaled.
+	if (gstate.getTextureMaxLevel() != 0 || replacer_.Enabled() || standardScaleFactor_ != 1)
+		return false;
+	return true;
+}
+
+void TextureCacheCommon::DecodeIndexLevel(u8 *out, int outPitch, GETextureFormat format, uint32_t texaddr, int bufw) {
+	GPUStatsTimer timer(&gpuStats.msDecodingTextures);
+	int w = gstate.getTextureWidth(0);
+	int h = gstate.getTextureHeight(0);
+	const u8 *texptr = Memory::GetPointer(texaddr);
 
 	if (gstate.isTextureSwizzled()) {
 		tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
-		UnswizzleFromMem(tmpTexBuf32_.data(), bufw * bytesPerIndex, texptr, bufw, h, bytesPerIndex);
-		texptr = (u8 *)tmpTexBuf32_.data();
+		if (format == GE_TFMT_CLUT4) {
+			UnswizzleFromMem(tmpTexBuf32_.data(), bufw / 2, texptr, bufw, h, 0);
+		} else {
+			UnswizzleFromMem(tmpTexBuf32_.data(), bufw, texptr, bufw, h, 1);
+		}
+		texptr = (const u8 *)tmpTexBuf32_.data();
+	}
+
+	if (format == GE_TFMT_CLUT4) {
+		for (int y = 0; y < h; ++y) {
+			const u8 *src = texptr + (bufw * y) / 2;
+			u8 *dest = out + outPitch * y;
+			for (int x = 0; x < w; ++x) {
+				dest[x] = (src[x >> 1] >> ((x & 1) * 4)) & 0xF;
+			}
+		}
+	} else {
+		for (int y = 0; y < h; ++y) {
+			memcpy(out + outPitch * y, texptr + bufw * y, w);
+		}
+	}
+}
+
+void TextureCacheCommon::ReadIndexedTex(u8 *out, int outPitch, int w, int h, const u8 *texptr, int bytesPerIndex, int bufw, u32 *scratch, bool expandTo32Bit) {
+	if (gstate.isTextureSwizzled()) {
+		UnswizzleFromMem(scratch, bufw * bytesPerIndex, texptr, bufw, h, bytesPerIndex);
+		texptr = (u8 *)scratch;
 	}
 
 	int palFormat = gstate.getClutPaletteFormat();
@@ -1585,7 +1804,7 @@ void TextureCacheCommon::ReadIndexedTex(u8 *out, int outPitch, int level, const
 	const u32 *clut32 = (const u32 *)clutBuf_;
 
 	if (expandTo32Bit && palFormat != GE_CMODE_32BIT_ABGR8888) {
-		ConvertFormatToRGBA8888(GEPaletteFormat(palFormat), expandClut_, clut16, 256);
+		// DecodeTextureLevel has already expanded it.
 		clut32 = expandClut_;
 		palFormat = GE_CMODE_32BIT_ABGR8888;
 	}
@@ -1678,6 +1897,7 @@ void TextureCacheCommon::ApplyTexture() {
 			int w = gstate.getTextureWidth(0);
 			int h = gstate.getTextureHeight(0);
 			entry->fullhash = QuickTexHash(replacer_, entry->addr, entry->bufw, w, h, GETextureFormat(entry->format), entry);
+			UpdateSampledHash(entry, h);
 
 			// TODO: Here we could check the secondary cache; maybe the texture is in there?
 			// We would need to abort the build if so.
@@ -1705,16 +1925,21 @@ void TextureCacheCommon::ApplyTexture() {
 	// Okay, now actually rebuild the texture if needed.
 	if (nextNeedsRebuild_) {
 		_assert_(!entry->texturePtr);
+		entry->videoSeq = VideoUploadSeq(entry->addr);
 		BuildTexture(entry);
 		InvalidateLastTexture();
 	}
 
+	// The build may have moved it into (or out of) an atlas page, or we picked an entry from the secondary cache.
+	SetCurTextureSize(entry, gstate.getTextureWidth(0), gstate.getTextureHeight(0));
 	entry->lastFrame = gpuStats.numFlips;
 	BindTexture(entry);
 	gstate_c.SetTextureFullAlpha(entry->GetAlphaStatus() == TexCacheEntry::STATUS_ALPHA_FULL);
 }
 
 void TextureCacheCommon::Clear(bool delete_them) {
+	FinishIdleVerify();
+	idleChecks_.clear();
 	ForgetLastTexture();
 	for (TexCache::iterator iter = cache_.begin(); iter != cache_.end(); ++iter) {
 		ReleaseTexture(iter->second.get(), delete_them);
@@ -1730,24 +1955,30 @@ void TextureCacheCommon::Clear(bool delete_them) {
 		cacheSizeEstimate_ = 0;
 		secondCacheSizeEstimate_ = 0;
 	}
+	MemoryUsage_Set(MemoryCategory::TEXTURE_CACHE, 0);
 	videos_.clear();
 }
 
 void TextureCacheCommon::DeleteTexture(TexCache::iterator it) {
 	ReleaseTexture(it->second.get(), true);
-	cacheSizeEstimate_ -= EstimateTexMemoryUsage(it->second.get());
+	cacheSizeEstimate_ -= it->second->memoryUsage;
 	cache_.erase(it);
 }
 
 bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 	int w = gstate.getTextureWidth(0);
 	int h = gstate.getTextureHeight(0);
-	bool isVideo = IsVideo(entry->addr);
-
-	// Don't even check the texture, just assume it has changed.
-	if (isVideo && g_Config.bTextureBackoffCache) {
-		// Attempt to ensure the hash doesn't incorrectly match in if the video stops.
-		entry->fullhash = (entry->fullhash + 0xA535A535) * 11 + (entry->fullhash & 4);
+	u32 videoSeq = VideoUploadSeq(entry->addr);
+	bool isVideo = videoSeq != 0;
+
+	// A new frame was decoded over it, so it has changed.  Otherwise it's the same frame drawn again
+	// (videos often run at half the display rate), and the hash below only has to catch CPU writes.
+	if (isVideo && g_Config.bTextureBackoffCache && videoSeq != entry->videoSeq) {
+		entry->videoSeq = videoSeq;
+		// Keep a real hash so the next check against the same frame can match.
+		PROFILE_THIS_SCOPE("texhash");
+		entry->fullhash = QuickTexHash(replacer_, entry->addr, entry->bufw, w, h, GETextureFormat(entry->format), entry);
+		UpdateSampledHash(entry, h);
 		return false;
 	}
 
@@ -1758,6 +1989,7 @@ bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 	}
 
 	if (fullhash == entry->fullhash) {
+		UpdateSampledHash(entry, h);
 		if (g_Config.bTextureBackoffCache && !isVideo) {
 			if (entry->GetHashStatus() != TexCacheEntry::STATUS_HASHING && entry->numFrames > TexCacheEntry::FRAMES_REGAIN_TRUST) {
 				// Reset to STATUS_HASHING.
@@ -1799,7 +2031,7 @@ bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 				// It wasn't found, so we're about to throw away the entry and rebuild a texture.
 				// Let's save this in the secondary cache in case it gets used again.
 				secondKey = entry->fullhash | ((u64)entry->cluthash << 32);
-				secondCacheSizeEstimate_ += EstimateTexMemoryUsage(entry);
+				secondCacheSizeEstimate_ += entry->memoryUsage;
 
 				// If the entry already exists in the secondary texture cache, drop it nicely.
 				auto oldIter = secondCache_.find(secondKey);
@@ -1820,9 +2052,227 @@ bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 
 	// We know it failed, so update the full hash right away.
 	entry->fullhash = fullhash;
+	UpdateSampledHash(entry, h);
 	return false;
 }
 
+// Tiered hashing, used with backoff: before a full hash, check a sparse sample of the data.  For textures
+// in backoff the sample is also checked on first use each frame, catching most changes before the backoff
+// runs out.  A matching sample replaces the full hash only shortly after a full check (or a background
+// verification) - for unreliable textures, only within the same frame.
+bool TextureCacheCommon::NeedsFullHash(TexCacheEntry *entry, int h, bool rehash, bool firstUseThisFrame) {
+	const bool hashing = entry->GetHashStatus() == TexCacheEntry::STATUS_HASHING;
+	if (!rehash && !(hashing && firstUseThisFrame))
+		return false;
+
+	u32 samplehash;
+	{
+		PROFILE_THIS_SCOPE("texhash");
+		samplehash = QuickSampledHash(entry, h);
+	}
+	if (samplehash != entry->samplehash)
+		return true;
+	if (!rehash)
+		return false;
+
+	int trustFrames = hashing ? TEXCACHE_SAMPLE_TRUST_FRAMES : 0;
+	if (entry->verifiedFrame + trustFrames >= gpuStats.numFlips) {
+		gpuStats.numTextureHashesSkipped++;
+		return false;
+	}
+	return true;
+}
+
+void TextureCacheCommon::UpdateSampledHash(TexCacheEntry *entry, int h) {
+	entry->samplehash = QuickSampledHash(entry, h);
+	entry->verifiedFrame = gpuStats.numFlips;
+	entry->trackEpoch = pageTrackingEpoch_;
+}
+
+class IdleTexHashTask : public Task {
+public:
+	IdleTexHashTask(std::function<void()> func) : func_(func) {
+	}
+
+	TaskType Type() const override {
+		return TaskType::CPU_COMPUTE;
+	}
+
+	TaskPriority Priority() const override {
+		return TaskPriority::BACKGROUND;
+	}
+
+	void Run() override {
+		func_();
+	}
+
+private:
+	std::function<void()> func_;
+};
+
+void TextureCacheCommon::StartHashVerification() {
+	FinishIdleVerify();
+
+	// Apply the results from last frame's background hashing.
+	for (const IdleHashCheck &check : idleChecks_) {
+		auto it = cache_.find(check.cachekey);
+		// Skip it if it was deleted or rehashed on the main thread meanwhile.
+		if (it == cache_.end() || it->second->fullhash != check.expected || it->second->addr != check.addr)
+			continue;
+		TexCacheEntry *entry = it->second.get();
+		if (check.result == check.expected) {
+			entry->verifiedFrame = gpuStats.numFlips;
+			// Any write after the hash was tracked, if there was no reset since.
+			if (check.epoch == pageTrackingEpoch_)
+				entry->trackEpoch = check.epoch;
+		} else {
+			entry->status |= TexCacheEntry::STATUS_VERIFY_FAILED;
+		}
+	}
+	idleChecks_.clear();
+
+	CheckWrittenPages();
+	// Tracked textures were just verified, so this only picks up the rest.
+	StartIdleVerify();
+}
+
+bool TextureCacheCommon::IsPageTracked(const TexCacheEntry *entry, int *firstPage, int *lastPage) const {
+	if ((entry->status & TexCacheEntry::STATUS_MASK) != TexCacheEntry::STATUS_HASHING || entry->trackEpoch != pageTrackingEpoch_)
+		return false;
+	if (entry->numPageWrites >= TEXCACHE_MAX_PAGE_WRITES || (entry->status & TexCacheEntry::STATUS_VERIFY_FAILED))
+		return false;
+
+	int h = 1 << ((entry->dim >> 8) & 0xf);
+	u32 size = TexHashBytes(entry->bufw, h, GETextureFormat(entry->format), entry);
+	if (size == 0)
+		return false;
+	*firstPage = Memory::DirtyTrackingPage(entry->addr);
+	*lastPage = Memory::DirtyTrackingPage(entry->addr + size - 1);
+	return *firstPage >= 0 && *lastPage >= *firstPage;
+}
+
+// With page tracking, the OS tells us which memory was written.  Textures in backoff that weren't written
+// since they were last hashed count as verified every frame, and written ones get a full hash on next use.
+void TextureCacheCommon::CheckWrittenPages() {
+	// Fake mipmaps hash another level than the entry describes.
+	bool enabled = g_Config.bTexturePageTracking && g_Config.bTextureBackoffCache && DirtyPageTrackingSupported();
+	if (!enabled || PSP_CoreParameter().compat.flags().FakeMipmapChange) {
+		if (pageTrackingActive_) {
+			Memory::StopDirtyTracking(Memory::DirtyTracker::TEXTURES);
+			pageTrackingActive_ = false;
+		}
+		return;
+	}
+
+	if (!pageTrackingActive_) {
+		// Only entries hashed after this reset can be tracked.
+		Memory::ResetDirtyTracking(Memory::DirtyTracker::TEXTURES);
+		pageTrackingEpoch_++;
+		pageTrackingActive_ = true;
+		return;
+	}
+
+	trackedPages_.assign(Memory::DirtyTrackingPageCount(), 0);
+	bool anyTracked = false;
+	for (auto &it : cache_) {
+		int firstPage, lastPage;
+		if (!IsPageTracked(it.second.get(), &firstPage, &lastPage))
+			continue;
+		memset(&trackedPages_[firstPage], 1, lastPage - firstPage + 1);
+		anyTracked = true;
+	}
+	if (!anyTracked)
+		return;
+
+	if (!Memory::GetWrittenPages(Memory::DirtyTracker::TEXTURES, writtenPages_, &trackedPages_)) {
+		// Lost track, start over.
+		Memory::ResetDirtyTracking(Memory::DirtyTracker::TEXTURES);
+		pageTrackingEpoch_++;
+		return;
+	}
+
+	std::vector<TexCacheEntry *> clean;
+	bool anyWritten = false;
+	for (auto &it : cache_) {
+		TexCacheEntry *entry = it.second.get();
+		int firstPage, lastPage;
+		if (!IsPageTracked(entry, &firstPage, &lastPage))
+			continue;
+		bool written = false;
+		for (int page = firstPage; page <= lastPage && !written; ++page)
+			written = writtenPages_[page] != 0;
+		if (written) {
+			entry->status |= TexCacheEntry::STATUS_VERIFY_FAILED;
+			entry->numPageWrites++;
+			anyWritten = true;
+		} else {
+			entry->verifiedFrame = gpuStats.numFlips;
+			clean.push_back(entry);
+		}
+	}
+
+	// Once a page is written, the kernel keeps it marked until reset, so rearm.  That's process wide
+	// and makes the next write to every page fault, which is why often written textures are dropped.
+	if (anyWritten) {
+		Memory::ResetDirtyTracking(Memory::DirtyTracker::TEXTURES);
+		pageTrackingEpoch_++;
+		for (TexCacheEntry *entry : clean)
+			entry->trackEpoch = pageTrackingEpoch_;
+	}
+}
+
+// Queues some textures that weren't used in the last frame.  Their results are applied next frame.
+void TextureCacheCommon::StartIdleVerify() {
+	// The replacer's hash can't be computed from the entry alone, and fake mipmaps hash another level.
+	if (!g_Config.bTextureBackoffCache || replacer_.Enabled() || PSP_CoreParameter().compat.flags().FakeMipmapChange)
+		return;
+	if (cache_.empty() || g_threadManager.GetNumLooperThreads() <= 1)
+		return;
+
+	// Continue where we stopped last time, so all idle textures get checked eventually.
+	u32 budget = TEXCACHE_IDLE_VERIFY_BYTES;
+	auto it = cache_.lower_bound(idleVerifyCursor_);
+	for (size_t visited = 0; visited < cache_.size() && budget > 0; ++visited, ++it) {
+		if (it == cache_.end())
+			it = cache_.begin();
+		TexCacheEntry *entry = it->second.get();
+		if (entry->GetHashStatus() != TexCacheEntry::STATUS_HASHING || entry->lastFrame + 1 >= gpuStats.numFlips)
+			continue;
+		if (entry->verifiedFrame + TEXCACHE_SAMPLE_TRUST_FRAMES >= gpuStats.numFlips || IsVideo(entry->addr))
+			continue;
+
+		int h = 1 << ((entry->dim >> 8) & 0xf);
+		u32 size = TexHashBytes(entry->bufw, h, GETextureFormat(entry->format), entry);
+		if (size == 0 || !Memory::IsValidAddress(entry->addr + size))
+			continue;
+		idleChecks_.push_back(IdleHashCheck{ it->first, entry->addr, size, entry->fullhash, pageTrackingEpoch_, 0 });
+		budget -= std::min(budget, size);
+	}
+	idleVerifyCursor_ = it == cache_.end() ? 0 : it->first;
+
+	if (!idleChecks_.empty()) {
+		idleVerifyBusy_ = true;
+		g_threadManager.EnqueueTask(new IdleTexHashTask([this] { RunIdleVerify(); }));
+	}
+}
+
+// Runs on a worker.  Only touches idleChecks_ and PSP memory, which is only read.
+void TextureCacheCommon::RunIdleVerify() {
+	for (IdleHashCheck &check : idleChecks_) {
+		check.result = QuickTexHashXXH3(Memory::GetPointerUnchecked(check.addr), check.size);
+	}
+
+	std::lock_guard<std::mutex> guard(idleVerifyLock_);
+	idleVerifyBusy_ = false;
+	idleVerifyCond_.notify_all();
+}
+
+// Must be called before PSP memory might go away, it's read by the worker.
+void TextureCacheCommon::FinishIdleVerify() {
+	std::unique_lock<std::mutex> guard(idleVerifyLock_);
+	idleVerifyCond_.wait(guard, [&] { return !idleVerifyBusy_; });
+}
+
 void TextureCacheCommon::Invalidate(u32 addr, int size, GPUInvalidationType type) {
 	// They could invalidate inside the texture, let's just give a bit of leeway.
 	// TODO: Keep track of the largest texture size in bytes, and use that instead of this
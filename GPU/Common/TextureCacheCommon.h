@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <memory>
 
@@ -46,6 +48,15 @@ enum FramebufferNotificationChannel {
 
 #define TEXCACHE_MAX_TEXELS_SCALED (256*256)  // Per frame
 
+// With backoff, a matching sampled hash is trusted instead of a full hash this many frames after a full check.
+#define TEXCACHE_SAMPLE_TRUST_FRAMES 8
+// How much data of textures not used in the last frame we verify on a worker, per frame.
+#define TEXCACHE_IDLE_VERIFY_BYTES (2 * 1024 * 1024)
+// With page tracking, stop tracking textures whose pages were written this many times (probably shared with other data.)
+#define TEXCACHE_MAX_PAGE_WRITES 8
+// Size of the shared pages that backends may pack small textures into, see TexCacheEntry::atlasPage.
+#define TEXCACHE_ATLAS_PAGE_SIZE 2048
+
 struct VirtualFramebuffer;
 class TextureReplacer;
 
@@ -134,6 +145,12 @@ struct TexCacheEntry {
 		STATUS_FRAMEBUFFER_OVERLAP = 0x1000,
 
 		STATUS_FORCE_REBUILD = 0x2000,
+
+		STATUS_VERIFY_FAILED = 0x4000, // The background check saw the data change, do a full hash on next use.
+
+		STATUS_TO_UPLOAD = 0x8000,     // Only the smaller mip levels are uploaded, the rest come in a later frame.
+
+		STATUS_INDEXED = 0x10000,      // Holds the raw CLUT indices, the palette is applied in the fragment shader.
 	};
 
 	// Status, but int so we can zero initialize.
@@ -142,6 +159,7 @@ struct TexCacheEntry {
 	u32 addr;
 	u32 minihash;
 	u32 sizeInRAM;  // Could be computed
+	u32 memoryUsage;  // Host bytes this entry is counted as in the cache size, see SetTexMemoryUsage().
 	u8 format;  // GeTextureFormat
 	u8 maxLevel;
 	u16 dim;
@@ -160,8 +178,18 @@ struct TexCacheEntry {
 	int numInvalidated;
 	u32 framesUntilNextFullHash;
 	u32 fullhash;
+	u32 samplehash;  // SampledTexHash of the same data as fullhash.
+	int verifiedFrame;  // Last time fullhash was known to match memory.
+	u32 trackEpoch;  // Page tracking epoch when fullhash was last known to match, see CheckWrittenPages().
+	u8 numPageWrites;
 	u32 cluthash;
+	u32 videoSeq;  // Last NotifyVideoUpload that covered this texture, when it was built.
 	u16 maxSeenV;
+	// Non-zero (page index + 1) when the backend packed this texture into a shared atlas page.
+	// The texture is then sampled at atlasX/atlasY inside the page, like a framebuffer at an offset.
+	u8 atlasPage;
+	u16 atlasX;
+	u16 atlasY;
 
 	TexStatus GetHashStatus() {
 		return TexStatus(status & STATUS_MASK);
@@ -243,6 +271,8 @@ class TextureCacheCommon {
 	virtual void InvalidateLastTexture() = 0;
 	virtual void Clear(bool delete_them);
 	virtual void NotifyConfigChanged();
+	// Waits for the background hash verification, which reads PSP memory.
+	void FinishIdleVerify();
 
 	// FramebufferManager keeps TextureCache updated about what regions of memory are being rendered to,
 	// so that it can invalidate TexCacheEntries pointed at those addresses.
@@ -273,11 +303,29 @@ class TextureCacheCommon {
 	void HandleTextureChange(TexCacheEntry *const entry, const char *reason, bool initialMatch, bool doDelete);
 	virtual void BuildTexture(TexCacheEntry *const entry) = 0;
 	virtual void UpdateCurrentClut(GEPaletteFormat clutFormat, u32 clutBase, bool clutIndexIsSimple) = 0;
+	// Backends that can sample an R8 index texture through the shader depal path return true.
+	virtual bool SupportsIndexTextures() const { return false; }
+	bool UseIndexTexture(GETextureFormat format);
 	bool CheckFullHash(TexCacheEntry *entry, bool &doDelete);
-
+	bool NeedsFullHash(TexCacheEntry *entry, int h, bool rehash, bool firstUseThisFrame);
+	void UpdateSampledHash(TexCacheEntry *entry, int h);
+
+	// Call at the start of each frame.  Uses page tracking and a worker to avoid full hashes on the main thread.
+	void StartHashVerification();
+	void CheckWrittenPages();
+	bool IsPageTracked(const TexCacheEntry *entry, int *firstPage, int *lastPage) const;
+	// Hashes some textures that weren't used last frame on a worker, so their next use can skip the full hash.
+	void StartIdleVerify();
+	void RunIdleVerify();
+
+	// Large levels are decoded in bands on g_threadManager, this returns when all rows are done.
 	void DecodeTextureLevel(u8 *out, int outPitch, GETextureFormat format, GEPaletteFormat clutformat, uint32_t texaddr, int level, int bufw, bool reverseColors, bool useBGRA, bool expandTo32Bit);
+	// Must not touch shared state, may run on several threads at once. scratch is needed when swizzled.
+	void DecodeTextureRows(u8 *out, int outPitch, GETextureFormat format, GEPaletteFormat clutformat, uint32_t texaddr, const u8 *texptr, int level, int w, int h, int bufw, bool swizzled, u32 *scratch, bool reverseColors, bool useBGRA, bool expandTo32Bit);
 	void UnswizzleFromMem(u32 *dest, u32 destPitch, const u8 *texptr, u32 bufw, u32 height, u32 bytesPerPixel);
-	void ReadIndexedTex(u8 *out, int outPitch, int level, const u8 *texptr, int bytesPerIndex, int bufw, bool expandTo32Bit);
+	void ReadIndexedTex(u8 *out, int outPitch, int w, int h, const u8 *texptr, int bytesPerIndex, int bufw, u32 *scratch, bool expandTo32Bit);
+	// Writes the 8-bit indices of level 0 of a CLUT4 or CLUT8 texture, for STATUS_INDEXED entries.
+	void DecodeIndexLevel(u8 *out, int outPitch, GETextureFormat format, uint32_t texaddr, int bufw);
 	ReplacedTexture &FindReplacement(TexCacheEntry *entry, int &w, int &h);
 
 	template <typename T>
@@ -285,11 +333,20 @@ class TextureCacheCommon {
 		return (const T *)clutBuf_;
 	}
 
-	u32 EstimateTexMemoryUsage(const TexCacheEntry *entry);
+	u32 EstimateTexMemoryUsage(const TexCacheEntry *entry, int scaleFactor = 1);
+	// Updates the entry's share of cacheSizeEstimate_, call again once scaling/replacement is known.
+	void SetTexMemoryUsage(TexCacheEntry *entry, u32 bytes);
+	void SetTexMemoryUsage(TexCacheEntry *entry, ReplacedTexture &replaced, int scaleFactor);
+	// Bytes the primary cache should stay under, or 0 for no limit (only age based decimation.)
+	u32 TextureMemoryBudget();
+	// Free memory the device has left for us, or 0 if the backend can't tell.
+	virtual u64 DeviceMemoryBudget() { return 0; }
+	void DecimateToBudget(u32 budget);
 
 	SamplerCacheKey GetSamplingParams(int maxLevel, const TexCacheEntry *entry);
 	SamplerCacheKey GetFramebufferSamplingParams(u16 bufferWidth, u16 bufferHeight);
 	void UpdateMaxSeenV(TexCacheEntry *entry, bool throughMode);
+	void SetCurTextureSize(const TexCacheEntry *entry, int w, int h);
 
 	FramebufferMatchInfo MatchFramebuffer(const TextureDefinition &entry, VirtualFramebuffer *framebuffer, u32 texaddrOffset, FramebufferNotificationChannel channel) const;
 
@@ -300,28 +357,41 @@ class TextureCacheCommon {
 
 	void DecimateVideos();
 	bool IsVideo(u32 texaddr);
+	// Returns 0 if not a video, otherwise a number that changes whenever a new frame is uploaded there.
+	u32 VideoUploadSeq(u32 texaddr);
+
+	static inline u32 TexHashBytes(int bufw, int h, GETextureFormat format, const TexCacheEntry *entry) {
+		if (h == 512 && entry->maxSeenV < 512 && entry->maxSeenV != 0) {
+			h = (int)entry->maxSeenV;
+		}
+		return (textureBitsPerPixel[format] * bufw * h) / 8;
+	}
 
 	inline u32 QuickTexHash(TextureReplacer &replacer, u32 addr, int bufw, int w, int h, GETextureFormat format, TexCacheEntry *entry) const {
 		if (replacer.Enabled()) {
 			return replacer.ComputeHash(addr, bufw, w, h, format, entry->maxSeenV);
 		}
 
-		if (h == 512 && entry->maxSeenV < 512 && entry->maxSeenV != 0) {
-			h = (int)entry->maxSeenV;
-		}
-
-		const u32 sizeInRAM = (textureBitsPerPixel[format] * bufw * h) / 8;
+		const u32 sizeInRAM = TexHashBytes(bufw, h, format, entry);
 		const u32 *checkp = (const u32 *)Memory::GetPointer(addr);
 
 		gpuStats.numTextureDataBytesHashed += sizeInRAM;
 
 		if (Memory::IsValidAddress(addr + sizeInRAM)) {
-			return DoQuickTexHash(checkp, sizeInRAM);
+			return QuickTexHashXXH3(checkp, sizeInRAM);
 		} else {
 			return 0;
 		}
 	}
 
+	inline u32 QuickSampledHash(const TexCacheEntry *entry, int h) const {
+		const u32 sizeInRAM = TexHashBytes(entry->bufw, h, GETextureFormat(entry->format), entry);
+		if (Memory::IsValidAddress(entry->addr + sizeInRAM)) {
+			return SampledTexHash(Memory::GetPointerUnchecked(entry->addr), sizeInRAM);
+		}
+		return 0;
+	}
+
 	static inline u32 MiniHash(const u32 *ptr) {
 		return ptr[0];
 	}
@@ -339,6 +409,9 @@ class TextureCacheCommon {
 	double replacementTimeThisFrame_ = 0;
 	// TODO: Maybe vary by FPS...
 	double replacementFrameBudget_ = 0.5 / 60.0;
+	// Bytes of texture data uploaded this frame. Only backends that set a budget use STATUS_TO_UPLOAD.
+	int64_t uploadBytesThisFrame_ = 0;
+	int64_t uploadFrameBudget_ = 0;
 
 	TexCache cache_;
 	u32 cacheSizeEstimate_ = 0;
@@ -350,8 +423,31 @@ class TextureCacheCommon {
 		u32 addr;
 		u32 size;
 		int flips;
+		u32 seq;
 	};
 	std::vector<VideoInfo> videos_;
+	u32 videoUploadSeq_ = 0;
+
+	struct IdleHashCheck {
+		u64 cachekey;
+		u32 addr;
+		u32 size;
+		u32 expected;  // The entry's fullhash when queued, so we can tell if it was rehashed meanwhile.
+		u32 epoch;
+		u32 result;
+	};
+	// Owned by the worker while idleVerifyBusy_ is set.
+	std::vector<IdleHashCheck> idleChecks_;
+	u64 idleVerifyCursor_ = 0;
+	bool idleVerifyBusy_ = false;
+	std::mutex idleVerifyLock_;
+	std::condition_variable idleVerifyCond_;
+
+	// Incremented whenever the dirty page tracking is reset.
+	u32 pageTrackingEpoch_ = 0;
+	bool pageTrackingActive_ = false;
+	std::vector<u8> trackedPages_;
+	std::vector<u8> writtenPages_;
 
 	SimpleBuf<u32> tmpTexBuf32_;
 	SimpleBuf<u32> tmpTexBufRearrange_;
@@ -375,7 +471,7 @@ class TextureCacheCommon {
 	bool clutAlphaLinear_;
 	u16 clutAlphaLinearColor_;
 
-	int standardScaleFactor_;
+	int standardScaleFactor_ = 1;
 
 	const char *nextChangeReason_;
 	bool nextNeedsRehash_;
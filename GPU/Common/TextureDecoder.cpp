@@ -29,6 +29,7 @@
 
 #ifdef _M_SSE
 #include <emmintrin.h>
+#include <immintrin.h>
 #if _M_SSE >= 0x401
 #include <smmintrin.h>
 #endif
@@ -151,6 +152,30 @@ u32 QuickTexHashNonSSE(const void *checkp, u32 size) {
 	return check;
 }
 
+u32 QuickTexHashXXH3(const void *checkp, u32 size) {
+	return (u32)XXH3_64bits(checkp, size);
+}
+
+static const u32 TEXHASH_SAMPLE_COUNT = 64;
+static const u32 TEXHASH_SAMPLE_SIZE = 16;
+
+u32 SampledTexHash(const void *checkp, u32 size) {
+	const u32 stride = (size / TEXHASH_SAMPLE_COUNT) & ~(TEXHASH_SAMPLE_SIZE - 1);
+	// Small textures are cheap enough to hash completely.
+	if (stride < TEXHASH_SAMPLE_SIZE * 4)
+		return QuickTexHashXXH3(checkp, size);
+
+	const u8 *p = (const u8 *)checkp;
+	u8 samples[TEXHASH_SAMPLE_COUNT * TEXHASH_SAMPLE_SIZE];
+	const u32 piecesPerStride = stride / TEXHASH_SAMPLE_SIZE;
+	for (u32 i = 0; i < TEXHASH_SAMPLE_COUNT; ++i) {
+		// Move around inside each stride, so we don't only look at the same few columns.
+		u32 offset = i * stride + ((i * 37) % piecesPerStride) * TEXHASH_SAMPLE_SIZE;
+		memcpy(samples + i * TEXHASH_SAMPLE_SIZE, p + offset, TEXHASH_SAMPLE_SIZE);
+	}
+	return QuickTexHashXXH3(samples, sizeof(samples));
+}
+
 #if !PPSSPP_ARCH(ARM64) && !defined(_M_SSE)
 static u32 QuickTexHashBasic(const void *checkp, u32 size) {
 #if PPSSPP_ARCH(ARM) && defined(__GNUC__)
@@ -307,6 +332,121 @@ void DoUnswizzleTex16Basic(const u8 *texptr, u32 *ydestp, int bxc, int byc, u32
 	}
 }
 
+void DeIndexTexture4Simple32Basic(u32 *dest, const u8 *indexed, int length, const u32 *clut) {
+	for (int i = 0; i < length; i += 2) {
+		u8 index = *indexed++;
+		dest[i + 0] = clut[(index >> 0) & 0xf];
+		dest[i + 1] = clut[(index >> 4) & 0xf];
+	}
+}
+
+void DeIndexTexture4Simple16Basic(u16 *dest, const u8 *indexed, int length, const u16 *clut) {
+	for (int i = 0; i < length; i += 2) {
+		u8 index = *indexed++;
+		dest[i + 0] = clut[(index >> 0) & 0xf];
+		dest[i + 1] = clut[(index >> 4) & 0xf];
+	}
+}
+
+void DeIndexTexture8Simple32Basic(u32 *dest, const u8 *indexed, int length, const u32 *clut) {
+	for (int i = 0; i < length; ++i) {
+		*dest++ = clut[*indexed++];
+	}
+}
+
+#ifdef _M_SSE
+// Splits a 16 entry palette into one register per byte, so a pshufb can look up one byte of 16 colors.
+template <int bytes>
+static inline void SplitClut4Planes(const void *clut, __m128i planes[bytes]) {
+	alignas(16) u8 split[bytes][16];
+	const u8 *src = (const u8 *)clut;
+	for (int i = 0; i < 16; ++i) {
+		for (int b = 0; b < bytes; ++b)
+			split[b][i] = src[i * bytes + b];
+	}
+	for (int b = 0; b < bytes; ++b)
+		planes[b] = _mm_load_si128((const __m128i *)split[b]);
+}
+
+// Expands 16 bytes of 4-bit indices (32 pixels) into indices in pixel order, pixels 0-15 in the low lane.
+static inline SSE_TARGET_AVX2 __m256i ExpandClut4IndicesAVX2(const u8 *indexed) {
+	const __m128i mask = _mm_set1_epi8(0x0F);
+	const __m128i packed = _mm_loadu_si128((const __m128i *)indexed);
+	const __m128i lo = _mm_and_si128(packed, mask);
+	const __m128i hi = _mm_and_si128(_mm_srli_epi16(packed, 4), mask);
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi8(lo, hi)), _mm_unpackhi_epi8(lo, hi), 1);
+}
+
+static SSE_TARGET_AVX2 void DeIndexTexture4Simple32AVX2(u32 *dest, const u8 *indexed, int length, const u32 *clut) {
+	__m128i planes128[4];
+	SplitClut4Planes<4>(clut, planes128);
+	__m256i planes[4];
+	for (int b = 0; b < 4; ++b)
+		planes[b] = _mm256_broadcastsi128_si256(planes128[b]);
+
+	int i = 0;
+	for (; i + 32 <= length; i += 32) {
+		const __m256i indices = ExpandClut4IndicesAVX2(indexed + i / 2);
+		const __m256i r = _mm256_shuffle_epi8(planes[0], indices);
+		const __m256i g = _mm256_shuffle_epi8(planes[1], indices);
+		const __m256i b = _mm256_shuffle_epi8(planes[2], indices);
+		const __m256i a = _mm256_shuffle_epi8(planes[3], indices);
+
+		// Each lane interleaves separately, so the lanes get swapped into order before storing.
+		const __m256i rgLo = _mm256_unpacklo_epi8(r, g);
+		const __m256i rgHi = _mm256_unpackhi_epi8(r, g);
+		const __m256i baLo = _mm256_unpacklo_epi8(b, a);
+		const __m256i baHi = _mm256_unpackhi_epi8(b, a);
+		const __m256i c0 = _mm256_unpacklo_epi16(rgLo, baLo);
+		const __m256i c1 = _mm256_unpackhi_epi16(rgLo, baLo);
+		const __m256i c2 = _mm256_unpacklo_epi16(rgHi, baHi);
+		const __m256i c3 = _mm256_unpackhi_epi16(rgHi, baHi);
+		__m256i *d = (__m256i *)(dest + i);
+		_mm256_storeu_si256(d + 0, _mm256_permute2x128_si256(c0, c1, 0x20));
+		_mm256_storeu_si256(d + 1, _mm256_permute2x128_si256(c2, c3, 0x20));
+		_mm256_storeu_si256(d + 2, _mm256_permute2x128_si256(c0, c1, 0x31));
+		_mm256_storeu_si256(d + 3, _mm256_permute2x128_si256(c2, c3, 0x31));
+	}
+
+	DeIndexTexture4Simple32Basic(dest + i, indexed + i / 2, length - i, clut);
+}
+
+static SSE_TARGET_AVX2 void DeIndexTexture4Simple16AVX2(u16 *dest, const u8 *indexed, int length, const u16 *clut) {
+	__m128i planes128[2];
+	SplitClut4Planes<2>(clut, planes128);
+	const __m256i planeLo = _mm256_broadcastsi128_si256(planes128[0]);
+	const __m256i planeHi = _mm256_broadcastsi128_si256(planes128[1]);
+
+	int i = 0;
+	for (; i + 32 <= length; i += 32) {
+		const __m256i indices = ExpandClut4IndicesAVX2(indexed + i / 2);
+		const __m256i lo = _mm256_shuffle_epi8(planeLo, indices);
+		const __m256i hi = _mm256_shuffle_epi8(planeHi, indices);
+		const __m256i c0 = _mm256_unpacklo_epi8(lo, hi);
+		const __m256i c1 = _mm256_unpackhi_epi8(lo, hi);
+		__m256i *d = (__m256i *)(dest + i);
+		_mm256_storeu_si256(d + 0, _mm256_permute2x128_si256(c0, c1, 0x20));
+		_mm256_storeu_si256(d + 1, _mm256_permute2x128_si256(c0, c1, 0x31));
+	}
+
+	DeIndexTexture4Simple16Basic(dest + i, indexed + i / 2, length - i, clut);
+}
+
+static SSE_TARGET_AVX2 void DeIndexTexture8Simple32AVX2(u32 *dest, const u8 *indexed, int length, const u32 *clut) {
+	int i = 0;
+	for (; i + 8 <= length; i += 8) {
+		const __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(indexed + i)));
+		_mm256_storeu_si256((__m256i *)(dest + i), _mm256_i32gather_epi32((const int *)clut, indices, 4));
+	}
+
+	DeIndexTexture8Simple32Basic(dest + i, indexed + i, length - i, clut);
+}
+#endif
+
+DeIndexTexture32Func DeIndexTexture4Simple32 = &DeIndexTexture4Simple32Basic;
+DeIndexTexture16Func DeIndexTexture4Simple16 = &DeIndexTexture4Simple16Basic;
+DeIndexTexture32Func DeIndexTexture8Simple32 = &DeIndexTexture8Simple32Basic;
+
 #if !PPSSPP_ARCH(ARM64) && !defined(_M_SSE)
 QuickTexHashFunc DoQuickTexHash = &QuickTexHashBasic;
 QuickTexHashFunc StableQuickTexHash = &QuickTexHashNonSSE;
@@ -322,6 +462,22 @@ void SetupTextureDecoder() {
 		DoUnswizzleTex16 = &DoUnswizzleTex16NEON;
 	}
 #endif
+
+#if PPSSPP_ARCH(ARM64)
+	DeIndexTexture4Simple32 = &DeIndexTexture4Simple32NEON;
+	DeIndexTexture4Simple16 = &DeIndexTexture4Simple16NEON;
+#elif PPSSPP_ARCH(ARM_NEON)
+	if (cpu_info.bNEON) {
+		DeIndexTexture4Simple32 = &DeIndexTexture4Simple32NEON;
+		DeIndexTexture4Simple16 = &DeIndexTexture4Simple16NEON;
+	}
+#elif defined(_M_SSE)
+	if (cpu_info.bAVX2) {
+		DeIndexTexture4Simple32 = &DeIndexTexture4Simple32AVX2;
+		DeIndexTexture4Simple16 = &DeIndexTexture4Simple16AVX2;
+		DeIndexTexture8Simple32 = &DeIndexTexture8Simple32AVX2;
+	}
+#endif
 }
 
 // S3TC / DXT Decoder
@@ -61,6 +61,23 @@ typedef void (*UnswizzleTex16Func)(const u8 *texptr, u32 *ydestp, int bxc, int b
 extern UnswizzleTex16Func DoUnswizzleTex16;
 #endif
 
+// CLUT lookups without any mask, shift, or offset, the common case.  Chosen by SetupTextureDecoder().
+typedef void (*DeIndexTexture32Func)(u32 *dest, const u8 *indexed, int length, const u32 *clut);
+typedef void (*DeIndexTexture16Func)(u16 *dest, const u8 *indexed, int length, const u16 *clut);
+extern DeIndexTexture32Func DeIndexTexture4Simple32;
+extern DeIndexTexture16Func DeIndexTexture4Simple16;
+extern DeIndexTexture32Func DeIndexTexture8Simple32;
+
+void DeIndexTexture4Simple32Basic(u32 *dest, const u8 *indexed, int length, const u32 *clut);
+void DeIndexTexture4Simple16Basic(u16 *dest, const u8 *indexed, int length, const u16 *clut);
+void DeIndexTexture8Simple32Basic(u32 *dest, const u8 *indexed, int length, const u32 *clut);
+
+// Used by the texture cache to detect changes, so it doesn't need to stay stable across versions
+// (texture replacement uses StableQuickTexHash or its own choice of hash instead.)
+u32 QuickTexHashXXH3(const void *checkp, u32 size);
+// Only hashes 64 small pieces spread over the data.  Very cheap, but can miss changes.
+u32 SampledTexHash(const void *checkp, u32 size);
+
 CheckAlphaResult CheckAlphaRGBA8888Basic(const u32 *pixelData, int stride, int w, int h);
 CheckAlphaResult CheckAlphaABGR4444Basic(const u32 *pixelData, int stride, int w, int h);
 CheckAlphaResult CheckAlphaRGBA4444Basic(const u32 *pixelData, int stride, int w, int h);
@@ -117,21 +134,24 @@ static const u8 textureBitsPerPixel[16] = {
 
 u32 GetTextureBufw(int level, u32 texaddr, GETextureFormat format);
 
+template <typename IndexT, typename ClutT>
+inline void DeIndexTextureSimple(ClutT *dest, const IndexT *indexed, int length, const ClutT *clut) {
+	for (int i = 0; i < length; ++i) {
+		*dest++ = clut[(*indexed++) & 0xFF];
+	}
+}
+
+inline void DeIndexTextureSimple(u32 *dest, const u8 *indexed, int length, const u32 *clut) {
+	DeIndexTexture8Simple32(dest, indexed, length, clut);
+}
+
 template <typename IndexT, typename ClutT>
 inline void DeIndexTexture(ClutT *dest, const IndexT *indexed, int length, const ClutT *clut) {
 	// Usually, there is no special offset, mask, or shift.
 	const bool nakedIndex = gstate.isClutIndexSimple();
 
 	if (nakedIndex) {
-		if (sizeof(IndexT) == 1) {
-			for (int i = 0; i < length; ++i) {
-				*dest++ = clut[*indexed++];
-			}
-		} else {
-			for (int i = 0; i < length; ++i) {
-				*dest++ = clut[(*indexed++) & 0xFF];
-			}
-		}
+		DeIndexTextureSimple(dest, indexed, length, clut);
 	} else {
 		for (int i = 0; i < length; ++i) {
 			*dest++ = clut[gstate.transformClutIndex(*indexed++)];
@@ -145,17 +165,21 @@ inline void DeIndexTexture(ClutT *dest, const u32 texaddr, int length, const Clu
 	DeIndexTexture(dest, indexed, length, clut);
 }
 
+inline void DeIndexTexture4Simple(u32 *dest, const u8 *indexed, int length, const u32 *clut) {
+	DeIndexTexture4Simple32(dest, indexed, length, clut);
+}
+
+inline void DeIndexTexture4Simple(u16 *dest, const u8 *indexed, int length, const u16 *clut) {
+	DeIndexTexture4Simple16(dest, indexed, length, clut);
+}
+
 template <typename ClutT>
 inline void DeIndexTexture4(ClutT *dest, const u8 *indexed, int length, const ClutT *clut) {
 	// Usually, there is no special offset, mask, or shift.
 	const bool nakedIndex = gstate.isClutIndexSimple();
 
 	if (nakedIndex) {
-		for (int i = 0; i < length; i += 2) {
-			u8 index = *indexed++;
-			dest[i + 0] = clut[(index >> 0) & 0xf];
-			dest[i + 1] = clut[(index >> 4) & 0xf];
-		}
+		DeIndexTexture4Simple(dest, indexed, length, clut);
 	} else {
 		for (int i = 0; i < length; i += 2) {
 			u8 index = *indexed++;
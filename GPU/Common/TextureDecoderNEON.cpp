@@ -165,6 +165,57 @@ void DoUnswizzleTex16NEON(const u8 *texptr, u32 *ydestp, int bxc, int byc, u32 p
 	}
 }
 
+// Expands 8 bytes of 4-bit indices into 16 indices in pixel order.
+static inline uint8x16_t ExpandClut4IndicesNEON(const u8 *indexed) {
+	const uint8x8_t packed = vld1_u8(indexed);
+	const uint8x8x2_t zipped = vzip_u8(vand_u8(packed, vdup_n_u8(0x0F)), vshr_n_u8(packed, 4));
+	return vcombine_u8(zipped.val[0], zipped.val[1]);
+}
+
+static inline uint8x16_t Lookup16NEON(const uint8x16_t &table, const uint8x16_t &indices) {
+#if PPSSPP_ARCH(ARM64)
+	return vqtbl1q_u8(table, indices);
+#else
+	uint8x8x2_t t;
+	t.val[0] = vget_low_u8(table);
+	t.val[1] = vget_high_u8(table);
+	return vcombine_u8(vtbl2_u8(t, vget_low_u8(indices)), vtbl2_u8(t, vget_high_u8(indices)));
+#endif
+}
+
+void DeIndexTexture4Simple32NEON(u32 *dest, const u8 *indexed, int length, const u32 *clut) {
+	// Deinterleaving gives one register per byte, so a lookup gets the same byte of 16 colors.
+	const uint8x16x4_t planes = vld4q_u8((const u8 *)clut);
+
+	int i = 0;
+	for (; i + 16 <= length; i += 16) {
+		const uint8x16_t indices = ExpandClut4IndicesNEON(indexed + i / 2);
+		uint8x16x4_t result;
+		result.val[0] = Lookup16NEON(planes.val[0], indices);
+		result.val[1] = Lookup16NEON(planes.val[1], indices);
+		result.val[2] = Lookup16NEON(planes.val[2], indices);
+		result.val[3] = Lookup16NEON(planes.val[3], indices);
+		vst4q_u8((u8 *)(dest + i), result);
+	}
+
+	DeIndexTexture4Simple32Basic(dest + i, indexed + i / 2, length - i, clut);
+}
+
+void DeIndexTexture4Simple16NEON(u16 *dest, const u8 *indexed, int length, const u16 *clut) {
+	const uint8x16x2_t planes = vld2q_u8((const u8 *)clut);
+
+	int i = 0;
+	for (; i + 16 <= length; i += 16) {
+		const uint8x16_t indices = ExpandClut4IndicesNEON(indexed + i / 2);
+		uint8x16x2_t result;
+		result.val[0] = Lookup16NEON(planes.val[0], indices);
+		result.val[1] = Lookup16NEON(planes.val[1], indices);
+		vst2q_u8((u8 *)(dest + i), result);
+	}
+
+	DeIndexTexture4Simple16Basic(dest + i, indexed + i / 2, length - i, clut);
+}
+
 static inline bool VectorIsNonZeroNEON(const uint32x4_t &v) {
 	u64 low = vgetq_lane_u64(vreinterpretq_u64_u32(v), 0);
 	u64 high = vgetq_lane_u64(vreinterpretq_u64_u32(v), 1);
@@ -237,23 +237,41 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 		LDRH(INDEX_UNSIGNED, boundsMaxVReg, scratchReg64, offsetof(KnownVertexBounds, maxV));
 	}
 
-	const u8 *loopStart = GetCodePtr();
-	for (int i = 0; i < dec.numSteps_; i++) {
-		if (!CompileStep(dec, i)) {
-			EndWrite();
-			// Reset the code ptr (effectively undoing what we generated) and return zero to indicate that we failed.
-			ResetCodePtr(GetOffset(start));
-			char temp[1024] = {0};
-			dec.ToString(temp);
-			ERROR_LOG(G3D, "Could not compile vertex decoder, failed at step %d: %s", i, temp);
-			return nullptr;
+	const int batch = DecodeBatchSize(dec);
+	FixupBranch skipBatch;
+	bool compiled = true;
+	if (batch > 1) {
+		// Unrolled loop while there are at least batch vertices left.
+		CMP(counterReg, batch);
+		skipBatch = B(CC_LO);
+		const u8 *batchStart = GetCodePtr();
+		for (int v = 0; v < batch && compiled; v++) {
+			compiled = CompileSteps(dec);
 		}
+		SUB(counterReg, counterReg, batch);
+		CMP(counterReg, batch);
+		B(CC_HS, batchStart);
+		SetJumpTarget(skipBatch);
+
+		// The count is never zero on entry, but it can be after the batches.
+		skipBatch = CBZ(counterReg);
 	}
 
-	ADDI2R(srcReg, srcReg, dec.VertexSize(), scratchReg);
-	ADDI2R(dstReg, dstReg, dec.decFmt.stride, scratchReg);
+	const u8 *loopStart = GetCodePtr();
+	compiled = compiled && CompileSteps(dec);
+	if (!compiled) {
+		EndWrite();
+		// Reset the code ptr (effectively undoing what we generated) and return zero to indicate that we failed.
+		ResetCodePtr(GetOffset(start));
+		char temp[1024] = {0};
+		dec.ToString(temp);
+		ERROR_LOG(G3D, "Could not compile vertex decoder: %s", temp);
+		return nullptr;
+	}
 	SUBS(counterReg, counterReg, 1);
 	B(CC_NEQ, loopStart);
+	if (batch > 1)
+		SetJumpTarget(skipBatch);
 
 	if (dec.col) {
 		MOVP2R(tempRegPtr, &gstate_c.vertexFullAlpha);
@@ -294,6 +312,17 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 	return (JittedVertexDecoder)start;
 }
 
+// Decodes one vertex and steps to the next.
+bool VertexDecoderJitCache::CompileSteps(const VertexDecoder &dec) {
+	for (int i = 0; i < dec.numSteps_; i++) {
+		if (!CompileStep(dec, i))
+			return false;
+	}
+	ADDI2R(srcReg, srcReg, dec.VertexSize(), scratchReg);
+	ADDI2R(dstReg, dstReg, dec.decFmt.stride, scratchReg);
+	return true;
+}
+
 bool VertexDecoderJitCache::CompileStep(const VertexDecoder &dec, int step) {
 	// See if we find a matching JIT function
 	for (size_t i = 0; i < ARRAY_SIZE(jitLookup); i++) {
@@ -82,6 +82,8 @@ int DecFmtSize(u8 fmt) {
 
 void DecVtxFormat::ComputeID() {
 	id = w0fmt | (w1fmt << 4) | (uvfmt << 8) | (c0fmt << 12) | (c1fmt << 16) | (nrmfmt << 20) | (posfmt << 24);
+	if (morphcount > 1)
+		id |= (morphcount - 1) << 28;
 }
 
 void DecVtxFormat::InitializeFromID(uint32_t id) {
@@ -100,7 +102,9 @@ void DecVtxFormat::InitializeFromID(uint32_t id) {
 	c1off = c0off + DecFmtSize(c0fmt);
 	nrmoff = c1off + DecFmtSize(c1fmt);
 	posoff = nrmoff + DecFmtSize(nrmfmt);
-	stride = posoff + DecFmtSize(posfmt);
+	morphStride = posoff + DecFmtSize(posfmt);
+	morphcount = 1 + ((id >> 28) & 7);
+	stride = morphStride * morphcount;
 }
 
 void GetIndexBounds(const void *inds, int count, u32 vertType, u16 *indexLowerBound, u16 *indexUpperBound) {
@@ -1263,6 +1267,8 @@ void VertexDecoder::SetVertexType(u32 fmt, const VertexDecoderOptions &options,
 		char temp[256]{};
 		ToString(temp);
 		ERROR_LOG_REPORT(G3D, "Vertices without position found: (%08x) %s", fmt_, temp);
+	} else {
+		ComputeRawVtxFmt(options);
 	}
 
 	// Attempt to JIT as well. But only do that if the main CPU JIT is enabled, in order to aid
@@ -1275,6 +1281,52 @@ void VertexDecoder::SetVertexType(u32 fmt, const VertexDecoderOptions &options,
 	}
 }
 
+void VertexDecoder::ComputeRawVtxFmt(const VertexDecoderOptions &options) {
+	rawFmtValid_ = false;
+	rawTexcoordScale_ = 0.0f;
+
+	// Only formats where decoding is pure copying, apart from the texcoord prescale.
+	// Through mode also tracks UV bounds while decoding, so it's out as well.
+	if (throughmode || morphcount != 1 || weighttype != 0)
+		return;
+	if (pos != (GE_VTYPE_POS_FLOAT >> GE_VTYPE_POS_SHIFT))
+		return;
+	if (col != 0 && col != (GE_VTYPE_COL_8888 >> GE_VTYPE_COL_SHIFT))
+		return;
+	if (nrm == (GE_VTYPE_NRM_8BIT >> GE_VTYPE_NRM_SHIFT) && options.expand8BitNormalsToFloat)
+		return;
+	// Other UV gen modes don't prescale, and expect float UVs.
+	if (tc && gstate.getUVGenMode() != GE_TEXMAP_TEXTURE_COORDS && gstate.getUVGenMode() != GE_TEXMAP_UNKNOWN)
+		return;
+
+	DecVtxFormat raw{};
+	switch (tc) {
+	case GE_VTYPE_TC_8BIT >> GE_VTYPE_TC_SHIFT:
+		raw.uvfmt = DEC_U8_2;
+		rawTexcoordScale_ = 255.0f / 128.0f;
+		break;
+	case GE_VTYPE_TC_16BIT >> GE_VTYPE_TC_SHIFT:
+		raw.uvfmt = DEC_U16_2;
+		rawTexcoordScale_ = g_DoubleTextureCoordinates ? 65535.0f / 16384.0f : 65535.0f / 32768.0f;
+		break;
+	case GE_VTYPE_TC_FLOAT >> GE_VTYPE_TC_SHIFT:
+		raw.uvfmt = DEC_FLOAT_2;
+		rawTexcoordScale_ = 1.0f;
+		break;
+	}
+	raw.c0fmt = col ? DEC_U8_4 : DEC_NONE;
+	raw.nrmfmt = nrm == 0 ? DEC_NONE : (nrm == 1 ? DEC_S8_3 : (nrm == 2 ? DEC_S16_3 : DEC_FLOAT_3));
+	raw.posfmt = DEC_FLOAT_3;
+	raw.ComputeID();
+	// The pipeline cache recreates formats from the ID, so the PSP offsets must be exactly the implied ones.
+	raw.InitializeFromID(raw.id);
+	if ((tc && raw.uvoff != tcoff) || (col && raw.c0off != coloff) || (nrm && raw.nrmoff != nrmoff) || raw.posoff != posoff || raw.stride != size)
+		return;
+
+	rawFmt_ = raw;
+	rawFmtValid_ = true;
+}
+
 void VertexDecoder::DecodeVerts(u8 *decodedptr, const void *verts, int indexLowerBound, int indexUpperBound) const {
 	// Decode the vertices within the found bounds, once each
 	// decoded_ and ptr_ are used in the steps, so can't be turned into locals for speed.
@@ -1306,6 +1358,35 @@ void VertexDecoder::DecodeVerts(u8 *decodedptr, const void *verts, int indexLowe
 	}
 }
 
+void VertexDecoder::DecodeMorphTargets(u8 *decodedptr, const void *verts, int indexLowerBound, int indexUpperBound, int morphTargets) const {
+	const int srcStride = size * morphTargets;
+	const int count = indexUpperBound - indexLowerBound + 1;
+	const int stride = decFmt.stride;
+
+	if (((uintptr_t)verts & (biggest - 1)) != 0) {
+		memset(decodedptr, 0, count * stride * morphTargets);
+		return;
+	}
+
+	const u8 *src = (const u8 *)verts + indexLowerBound * srcStride;
+	for (int i = 0; i < count; i++) {
+		for (int n = 0; n < morphTargets; n++) {
+			// Each target is laid out just like a vertex of this (unmorphed) type.
+			ptr_ = src + n * size;
+			decoded_ = decodedptr + n * stride;
+			if (jitted_) {
+				jitted_(ptr_, decoded_, 1);
+			} else {
+				for (int j = 0; j < numSteps_; j++) {
+					((*this).*steps_[j])();
+				}
+			}
+		}
+		src += srcStride;
+		decodedptr += stride * morphTargets;
+	}
+}
+
 static const char *posnames[4] = { "?", "s8", "s16", "f" };
 static const char *nrmnames[4] = { "", "s8", "s16", "f" };
 static const char *tcnames[4] = { "", "u8", "u16", "f" };
@@ -1394,3 +1475,15 @@ void VertexDecoderJitCache::Clear() {
 		ClearCodeSpace(0);
 	}
 }
+
+#ifdef VERTEXDECODER_JIT_BACKEND
+int VertexDecoderJitCache::DecodeBatchSize(const VertexDecoder &dec) const {
+	// The common formats (pos + uv + color, maybe normal or a few skinning weights) are only a handful
+	// of steps, so we can afford to emit them several times and decode a few vertices per iteration.
+	// That cuts the loop overhead and lets neighbouring vertices' loads and stores overlap.
+	// Morph steps are long and morphing is rare, so those keep the simple loop.
+	if (!batchDecode_ || dec.morphcount != 1 || dec.numSteps_ > 6)
+		return 1;
+	return 4;
+}
+#endif
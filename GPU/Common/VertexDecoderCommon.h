@@ -74,6 +74,10 @@ struct DecVtxFormat {
 	u8 nrmfmt; u8 nrmoff;
 	u8 posfmt; u8 posoff;
 	u8 stride;
+	// When above 1, each vertex holds this many unblended morph targets of morphStride bytes,
+	// all with the layout above, for the vertex shader to blend.
+	u8 morphcount;
+	u8 morphStride;
 
 	uint32_t id;
 	void ComputeID();
@@ -453,6 +457,15 @@ class VertexDecoder {
 	const DecVtxFormat &GetDecVtxFmt() { return decFmt; }
 
 	void DecodeVerts(u8 *decoded, const void *verts, int indexLowerBound, int indexUpperBound) const;
+	// Decodes each of the morph targets separately, without blending, one after another in each
+	// output vertex. Must be called on the decoder for the vertex type without the morph count.
+	void DecodeMorphTargets(u8 *decoded, const void *verts, int indexLowerBound, int indexUpperBound, int morphTargets) const;
+
+	// If the PSP vertex layout can be fed to a hardware transform vertex shader as-is, returns a format
+	// describing it (stride equals VertexSize()). Texcoords are then unscaled, see RawTexcoordScale().
+	const DecVtxFormat *GetRawVtxFmt() const { return rawFmtValid_ ? &rawFmt_ : nullptr; }
+	// Factor from the normalized raw texcoord attribute to what the decoder would have produced before prescaling.
+	float RawTexcoordScale() const { return rawTexcoordScale_; }
 
 	bool hasColor() const { return col != 0; }
 	bool hasTexcoord() const { return tc != 0; }
@@ -548,6 +561,8 @@ class VertexDecoder {
 	// Ugly for speed.
 	int ToString(char *output) const;
 
+	void ComputeRawVtxFmt(const VertexDecoderOptions &options);
+
 	// Mutable decoder state
 	mutable u8 *decoded_;
 	mutable const u8 *ptr_;
@@ -564,6 +579,10 @@ class VertexDecoder {
 	u32 fmt_;
 	DecVtxFormat decFmt;
 
+	DecVtxFormat rawFmt_{};
+	bool rawFmtValid_ = false;
+	float rawTexcoordScale_ = 0.0f;
+
 	bool throughmode;
 	u8 size;
 	u8 onesize_;
@@ -617,6 +636,9 @@ class VertexDecoderJitCache : public VERTEXDECODER_JIT_BACKEND {
 	JittedVertexDecoder Compile(const VertexDecoder &dec, int32_t *jittedSize);
 	void Clear();
 
+	// Allows turning off the multi-vertex loop, mainly for comparing in tests.  Affects later Compile() calls.
+	void SetBatchDecode(bool enable) { batchDecode_ = enable; }
+
 	void Jit_WeightsU8();
 	void Jit_WeightsU16();
 	void Jit_WeightsU8ToFloat();
@@ -686,6 +708,8 @@ class VertexDecoderJitCache : public VERTEXDECODER_JIT_BACKEND {
 
 private:
 	bool CompileStep(const VertexDecoder &dec, int i);
+	bool CompileSteps(const VertexDecoder &dec);
+	int DecodeBatchSize(const VertexDecoder &dec) const;
 	void Jit_ApplyWeights();
 	void Jit_WriteMatrixMul(int outOff, bool pos);
 	void Jit_WriteMorphColor(int outOff, bool checkAlpha = true);
@@ -698,6 +722,7 @@ class VertexDecoderJitCache : public VERTEXDECODER_JIT_BACKEND {
 	void Jit_AnyFloatMorph(int srcoff, int dstoff);
 
 	const VertexDecoder *dec_;
+	bool batchDecode_ = true;
 #if PPSSPP_ARCH(ARM64)
 	Arm64Gen::ARM64FloatEmitter fp;
 #endif
@@ -711,5 +736,6 @@ class VertexDecoderJitCache : public FakeGen::FakeXCodeBlock {
 		return nullptr;
 	}
 	void Clear();
+	void SetBatchDecode(bool enable) {}
 };
 #endif
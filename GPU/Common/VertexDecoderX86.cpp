@@ -257,20 +257,41 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 	}
 
 	// Let's not bother with a proper stack frame. We just grab the arguments and go.
-	JumpTarget loopStart = GetCodePtr();
-	for (int i = 0; i < dec.numSteps_; i++) {
-		if (!CompileStep(dec, i)) {
-			EndWrite();
-			// Reset the code ptr and return zero to indicate that we failed.
-			ResetCodePtr(GetOffset(start));
-			return 0;
+	const int batch = DecodeBatchSize(dec);
+	FixupBranch skipBatch;
+	if (batch > 1) {
+		// Unrolled loop while there are at least batch vertices left.
+		CMP(32, R(counterReg), Imm8(batch));
+		skipBatch = J_CC(CC_B, true);
+		JumpTarget batchStart = GetCodePtr();
+		for (int v = 0; v < batch; v++) {
+			if (!CompileSteps(dec)) {
+				EndWrite();
+				ResetCodePtr(GetOffset(start));
+				return 0;
+			}
 		}
+		SUB(32, R(counterReg), Imm8(batch));
+		CMP(32, R(counterReg), Imm8(batch));
+		J_CC(CC_AE, batchStart, true);
+		SetJumpTarget(skipBatch);
+
+		// The count is never zero on entry, but it can be after the batches.
+		TEST(32, R(counterReg), R(counterReg));
+		skipBatch = J_CC(CC_Z, true);
 	}
 
-	ADD(PTRBITS, R(srcReg), Imm32(dec.VertexSize()));
-	ADD(PTRBITS, R(dstReg), Imm32(dec.decFmt.stride));
+	JumpTarget loopStart = GetCodePtr();
+	if (!CompileSteps(dec)) {
+		EndWrite();
+		// Reset the code ptr and return zero to indicate that we failed.
+		ResetCodePtr(GetOffset(start));
+		return 0;
+	}
 	SUB(32, R(counterReg), Imm8(1));
 	J_CC(CC_NZ, loopStart, true);
+	if (batch > 1)
+		SetJumpTarget(skipBatch);
 
 	MOVUPS(XMM4, MDisp(ESP, 0));
 	MOVUPS(XMM5, MDisp(ESP, 16));
@@ -297,6 +318,17 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 	return (JittedVertexDecoder)start;
 }
 
+// Decodes one vertex and steps to the next.
+bool VertexDecoderJitCache::CompileSteps(const VertexDecoder &dec) {
+	for (int i = 0; i < dec.numSteps_; i++) {
+		if (!CompileStep(dec, i))
+			return false;
+	}
+	ADD(PTRBITS, R(srcReg), Imm32(dec.VertexSize()));
+	ADD(PTRBITS, R(dstReg), Imm32(dec.decFmt.stride));
+	return true;
+}
+
 void VertexDecoderJitCache::Jit_WeightsU8() {
 	switch (dec_->nweights) {
 	case 1:
@@ -24,6 +24,7 @@
 #include "Common/GPU/ShaderWriter.h"
 #include "Common/GPU/thin3d.h"
 #include "Core/Config.h"
+#include "Core/Reporting.h"
 #include "GPU/ge_constants.h"
 #include "GPU/GPUState.h"
 #include "GPU/Common/ShaderId.h"
@@ -129,9 +130,50 @@ static const char * const boneWeightDecl[9] = {
 extern const char *vulkan_glsl_preamble_vs;
 extern const char *hlsl_preamble_vs;
 
+// Per vertex components that get blended when morph targets are left to the shader.
+static const struct {
+	const char *name;
+	const char *morphName;
+	const char *type;
+} morphComponents[4] = {
+	{ "position", "morphpos", "vec3" },
+	{ "normal", "morphnrm", "vec3" },
+	{ "texcoord", "morphtex", "vec2" },
+	{ "color0", "morphcol", "vec4" },
+};
+
+struct MorphAttribute {
+	char name[16];
+	const char *type;
+	int location;
+};
+
+// The attributes for the morph targets after the first. Locations are assigned densely from
+// PspAttributeLocation::MORPH, the same way the draw engines lay them out, whether the shader reads them or not.
+static int GetMorphAttributes(MorphAttribute *attrs, int morphTargets, const bool present[4], const bool used[4]) {
+	int count = 0;
+	int location = (int)PspAttributeLocation::MORPH;
+	for (int n = 1; n < morphTargets; n++) {
+		for (int c = 0; c < 4; c++) {
+			if (!present[c])
+				continue;
+			if (used[c]) {
+				snprintf(attrs[count].name, sizeof(attrs[count].name), "%s%d", morphComponents[c].morphName, n);
+				attrs[count].type = morphComponents[c].type;
+				attrs[count].location = location;
+				count++;
+			}
+			location++;
+		}
+	}
+	return count;
+}
+
 bool GenerateVertexShader(const VShaderID &id, char *buffer, const ShaderLanguageDesc &compat, Draw::Bugs bugs, uint32_t *attrMask, uint64_t *uniformMask, std::string *errorString) {
 	*attrMask = 0;
 	*uniformMask = 0;
+	gpuStats.numShadersGenerated++;
+	Reporting::NotePerfEvent(Reporting::PerfEvent::SHADER_GENERATED);
 
 	bool highpFog = false;
 	bool highpTexcoord = false;
@@ -172,6 +214,8 @@ bool GenerateVertexShader(const VShaderID &id, char *buffer, const ShaderLanguag
 	bool hasColor = id.Bit(VS_BIT_HAS_COLOR) || !useHWTransform;
 	bool hasNormal = id.Bit(VS_BIT_HAS_NORMAL) && useHWTransform;
 	bool hasTexcoord = id.Bit(VS_BIT_HAS_TEXCOORD) || !useHWTransform;
+	// Raw texcoords haven't been prescaled by the vertex decoder.
+	bool rawTexcoord = id.Bit(VS_BIT_RAW_TEXCOORD) && useHWTransform;
 	bool enableFog = id.Bit(VS_BIT_ENABLE_FOG);
 	bool flipNormal = id.Bit(VS_BIT_NORM_REVERSE);
 	int ls0 = id.Bits(VS_BIT_LS0, 2);
@@ -194,6 +238,19 @@ bool GenerateVertexShader(const VShaderID &id, char *buffer, const ShaderLanguag
 			return false;
 		}
 	}
+	// Morph targets left unblended by the vertex decoder.
+	int morphTargets = useHWTransform && !doBezier && !doSpline ? id.Bits(VS_BIT_MORPH_TARGETS, 3) + 1 : 1;
+	if (morphTargets > 1) {
+		bool explicitLocations = compat.shaderLanguage == HLSL_D3D11 || compat.shaderLanguage == GLSL_VULKAN || compat.glslVersionNumber >= (compat.gles ? 300 : 330);
+		if (compat.shaderLanguage == HLSL_D3D9 || !explicitLocations) {
+			*errorString = "Morph targets in the shader not supported on this shader language version";
+			return false;
+		}
+	}
+	const bool morphPresent[4] = { true, hasNormal, hasTexcoord, hasColor };
+	const bool morphUsed[4] = { true, hasNormal, doTexture && hasTexcoord, hasColor };
+	MorphAttribute morphAttrs[7 * 4];
+	int numMorphAttrs = GetMorphAttributes(morphAttrs, morphTargets, morphPresent, morphUsed);
 	bool hasColorTess = id.Bit(VS_BIT_HAS_COLOR_TESS);
 	bool hasTexcoordTess = id.Bit(VS_BIT_HAS_TEXCOORD_TESS);
 	bool hasNormalTess = id.Bit(VS_BIT_HAS_NORMAL_TESS);
@@ -258,6 +315,9 @@ bool GenerateVertexShader(const VShaderID &id, char *buffer, const ShaderLanguag
 			if (lmode && !useHWTransform)  // only software transform supplies color1 as vertex data
 				WRITE(p, "layout (location = %d) in vec3 color1;\n", (int)PspAttributeLocation::COLOR1);
 		}
+		for (int i = 0; i < numMorphAttrs; i++) {
+			WRITE(p, "layout (location = %d) in %s %s;\n", morphAttrs[i].location, morphAttrs[i].type, morphAttrs[i].name);
+		}
 
 		WRITE(p, "layout (location = 1) %sout lowp vec4 v_color0;\n", shading);
 		if (lmode) {
@@ -372,6 +432,9 @@ bool GenerateVertexShader(const VShaderID &id, char *buffer, const ShaderLanguag
 				WRITE(p, "  vec3 normal : NORMAL;\n");
 			}
 			WRITE(p, "  vec3 position : POSITION;\n");
+			for (int i = 0; i < numMorphAttrs; i++) {
+				WRITE(p, "  %s %s : MORPH%d;\n", morphAttrs[i].type, morphAttrs[i].name, morphAttrs[i].location - (int)PspAttributeLocation::MORPH);
+			}
 			WRITE(p, "};\n");
 		} else {
 			WRITE(p, "struct VS_IN {\n");
@@ -464,6 +527,11 @@ bool GenerateVertexShader(const VShaderID &id, char *buffer, const ShaderLanguag
 				*attrMask |= 1 << ATTR_COLOR1;
 			}
 		}
+		// These aren't bound by name, the draw engine only enables this with GLSL 3.30 / ES 3.00.
+		for (int i = 0; i < numMorphAttrs; i++) {
+			WRITE(p, "layout(location = %d) %s %s %s;\n", morphAttrs[i].location, compat.attribute, morphAttrs[i].type, morphAttrs[i].name);
+			*attrMask |= 1 << morphAttrs[i].location;
+		}
 
 		if (isModeThrough) {
 			WRITE(p, "uniform mat4 u_proj_through;\n");
@@ -493,6 +561,11 @@ bool GenerateVertexShader(const VShaderID &id, char *buffer, const ShaderLanguag
 				WRITE(p, "uniform vec4 u_uvscaleoffset;\n");
 				*uniformMask |= DIRTY_UVSCALEOFFSET;
 			}
+			if (morphTargets > 1) {
+				WRITE(p, "uniform vec4 u_morphweights0;\n");
+				WRITE(p, "uniform vec4 u_morphweights1;\n");
+				*uniformMask |= DIRTY_MORPHWEIGHTS;
+			}
 			for (int i = 0; i < 4; i++) {
 				if (doLight[i] != LIGHT_OFF) {
 					// This is needed for shade mapping
@@ -784,6 +857,28 @@ bool GenerateVertexShader(const VShaderID &id, char *buffer, const ShaderLanguag
 		}
 	}
 
+	if (morphTargets > 1) {
+		// Blend the targets like the vertex decoder would have. In GLSL, the locals shadow the attributes.
+		const bool hlsl = compat.shaderLanguage == HLSL_D3D9 || compat.shaderLanguage == HLSL_D3D11;
+		const char *in = hlsl ? "In." : "";
+		for (int c = 0; c < 4; c++) {
+			if (!morphUsed[c])
+				continue;
+			std::string blend = StringFromFormat("%s%s * u_morphweights0.x", in, morphComponents[c].name);
+			for (int n = 1; n < morphTargets; n++) {
+				blend += StringFromFormat(" + %s%s%d * u_morphweights%d.%c", in, morphComponents[c].morphName, n, n / 4, "xyzw"[n & 3]);
+			}
+			if (c == 3) {
+				// The decoder clamps colors too.
+				blend = "clamp(" + blend + ", 0.0, 1.0)";
+			}
+			if (hlsl)
+				WRITE(p, "  %s = %s;\n", morphComponents[c].name, blend.c_str());
+			else
+				WRITE(p, "  %s %s = %s;\n", morphComponents[c].type, morphComponents[c].name, blend.c_str());
+		}
+	}
+
 	if (!useHWTransform) {
 		// Simple pass-through of vertex data to fragment shader
 		if (doTexture) {
@@ -1068,6 +1163,8 @@ bool GenerateVertexShader(const VShaderID &id, char *buffer, const ShaderLanguag
 					if (hasTexcoord) {
 						if (doBezier || doSpline)
 							WRITE(p, "  %sv_texcoord = vec3(tess.tex.xy * u_uvscaleoffset.xy + u_uvscaleoffset.zw, 0.0);\n", compat.vsOutPrefix);
+						else if (rawTexcoord)
+							WRITE(p, "  %sv_texcoord = vec3(texcoord.xy * u_uvscaleoffset.xy + u_uvscaleoffset.zw, 0.0);\n", compat.vsOutPrefix);
 						else
 							WRITE(p, "  %sv_texcoord = vec3(texcoord.xy * u_uvscaleoffset.xy, 0.0);\n", compat.vsOutPrefix);
 					} else {
@@ -39,6 +39,10 @@ class PushBufferD3D11 {
 	ID3D11Buffer *Buf() const {
 		return buffer_;
 	}
+	// Changes every time the buffer is discarded, after which earlier offsets no longer have data.
+	uint32_t Generation() const {
+		return generation_;
+	}
 
 	// Should be done each frame
 	void Reset() {
@@ -56,6 +60,8 @@ class PushBufferD3D11 {
 			nextMapDiscard_ = true;
 		}
 		context->Map(buffer_, 0, nextMapDiscard_ ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &map);
+		if (nextMapDiscard_)
+			generation_++;
 		nextMapDiscard_ = false;
 		*offset = (UINT)pos_;
 		uint8_t *retval = (uint8_t *)map.pData + pos_;
@@ -71,6 +77,7 @@ class PushBufferD3D11 {
 	size_t pos_ = 0;
 	size_t size_;
 	bool nextMapDiscard_ = false;
+	uint32_t generation_ = 0;
 };
 
 std::vector<uint8_t> CompileShaderToBytecodeD3D11(const char *code, size_t codeSize, const char *target, UINT flags);
@@ -19,6 +19,7 @@
 
 #include "Common/Log.h"
 #include "Common/MemoryUtil.h"
+#include "Common/Profiler/MemoryUsage.h"
 #include "Common/TimeUtil.h"
 #include "Core/MemMap.h"
 #include "Core/System.h"
@@ -82,6 +83,7 @@ DrawEngineD3D11::DrawEngineD3D11(Draw::DrawContext *draw, ID3D11Device *device,
 	context1_ = (ID3D11DeviceContext1 *)draw->GetNativeObject(Draw::NativeObject::CONTEXT_EX);
 	decOptions_.expandAllWeightsToFloat = true;
 	decOptions_.expand8BitNormalsToFloat = true;
+	morphInShaderSupported_ = true;
 
 	decimationCounter_ = VERTEXCACHE_DECIMATION_INTERVAL;
 	// Allocate nicely aligned memory. Maybe graphics drivers will
@@ -201,7 +203,7 @@ ID3D11InputLayout *DrawEngineD3D11::SetupDecFmtForDraw(D3D11VertexShader *vshade
 	if (inputLayout) {
 		return inputLayout;
 	} else {
-		D3D11_INPUT_ELEMENT_DESC VertexElements[8];
+		D3D11_INPUT_ELEMENT_DESC VertexElements[16];
 		D3D11_INPUT_ELEMENT_DESC *VertexElement = &VertexElements[0];
 
 		// Vertices Elements orders
@@ -244,6 +246,19 @@ ID3D11InputLayout *DrawEngineD3D11::SetupDecFmtForDraw(D3D11VertexShader *vshade
 		VertexAttribSetup(VertexElement, decFmt.posfmt, decFmt.posoff, "POSITION", 0);
 		VertexElement++;
 
+		// Unblended morph targets, indexed in the order the vertex shader generator expects.
+		u8 morphIndex = 0;
+		for (int n = 1; n < decFmt.morphcount; n++) {
+			const int base = n * decFmt.morphStride;
+			VertexAttribSetup(VertexElement++, decFmt.posfmt, base + decFmt.posoff, "MORPH", morphIndex++);
+			if (decFmt.nrmfmt != 0)
+				VertexAttribSetup(VertexElement++, decFmt.nrmfmt, base + decFmt.nrmoff, "MORPH", morphIndex++);
+			if (decFmt.uvfmt != 0)
+				VertexAttribSetup(VertexElement++, decFmt.uvfmt, base + decFmt.uvoff, "MORPH", morphIndex++);
+			if (decFmt.c0fmt != 0)
+				VertexAttribSetup(VertexElement++, decFmt.c0fmt, base + decFmt.c0off, "MORPH", morphIndex++);
+		}
+
 		// Create declaration
 		HRESULT hr = device_->CreateInputLayout(VertexElements, VertexElement - VertexElements, vshader->bytecode().data(), vshader->bytecode().size(), &inputLayout);
 		if (FAILED(hr)) {
@@ -259,6 +274,8 @@ ID3D11InputLayout *DrawEngineD3D11::SetupDecFmtForDraw(D3D11VertexShader *vshade
 
 void DrawEngineD3D11::MarkUnreliable(VertexArrayInfoD3D11 *vai) {
 	vai->status = VertexArrayInfoD3D11::VAI_UNRELIABLE;
+	MemoryUsage_Add(MemoryCategory::VERTEX_CACHE, -(int64_t)vai->bufferBytes);
+	vai->bufferBytes = 0;
 	if (vai->vbo) {
 		vai->vbo->Release();
 		vai->vbo = nullptr;
@@ -316,10 +333,12 @@ VertexArrayInfoD3D11::~VertexArrayInfoD3D11() {
 		vbo->Release();
 	if (ebo)
 		ebo->Release();
+	MemoryUsage_Add(MemoryCategory::VERTEX_CACHE, -(int64_t)bufferBytes);
 }
 
 // The inline wrapper in the header checks for numDrawCalls == 0
 void DrawEngineD3D11::DoFlush() {
+	GPUStatsTimer timer(&gpuStats.msFlushing);
 	gpuStats.numFlushes++;
 	gpuStats.numTrackedVertexArrays = (int)vai_.size();
 
@@ -340,6 +359,7 @@ void DrawEngineD3D11::DoFlush() {
 	// Always use software for flat shading to fix the provoking index.
 	bool tess = gstate_c.submitType == SubmitType::HW_BEZIER || gstate_c.submitType == SubmitType::HW_SPLINE;
 	bool useHWTransform = CanUseHardwareTransform(prim) && (tess || gstate.getShadeMode() != GE_SHADE_FLAT);
+	const DecVtxFormat *morphFmt = PrepareMorphForDraws(useHWTransform);
 
 	if (useHWTransform) {
 		ID3D11Buffer *vb_ = nullptr;
@@ -440,14 +460,17 @@ void DrawEngineD3D11::DoFlush() {
 						D3D11_BUFFER_DESC desc{ size, D3D11_USAGE_IMMUTABLE, D3D11_BIND_VERTEX_BUFFER, 0 };
 						D3D11_SUBRESOURCE_DATA data{ decoded };
 						ASSERT_SUCCESS(device_->CreateBuffer(&desc, &data, &vai->vbo));
+						vai->bufferBytes = size;
 						if (useElements) {
 							u32 size = sizeof(short) * indexGen.VertexCount();
 							D3D11_BUFFER_DESC desc{ size, D3D11_USAGE_IMMUTABLE, D3D11_BIND_INDEX_BUFFER, 0 };
 							D3D11_SUBRESOURCE_DATA data{ decIndex };
 							ASSERT_SUCCESS(device_->CreateBuffer(&desc, &data, &vai->ebo));
+							vai->bufferBytes += size;
 						} else {
 							vai->ebo = 0;
 						}
+						MemoryUsage_Add(MemoryCategory::VERTEX_CACHE, vai->bufferBytes);
 					} else {
 						gpuStats.numCachedDrawCalls++;
 						useElements = vai->ebo ? true : false;
@@ -521,19 +544,19 @@ void DrawEngineD3D11::DoFlush() {
 		D3D11VertexShader *vshader;
 		D3D11FragmentShader *fshader;
 		shaderManager_->GetShaders(prim, lastVType_, &vshader, &fshader, useHWTransform, useHWTessellation_, decOptions_.expandAllWeightsToFloat);
-		ID3D11InputLayout *inputLayout = SetupDecFmtForDraw(vshader, dec_->GetDecVtxFmt(), dec_->VertexType());
+		ID3D11InputLayout *inputLayout = SetupDecFmtForDraw(vshader, morphFmt ? *morphFmt : dec_->GetDecVtxFmt(), dec_->VertexType());
 		context_->PSSetShader(fshader->GetShader(), nullptr, 0);
 		context_->VSSetShader(vshader->GetShader(), nullptr, 0);
 		shaderManager_->UpdateUniforms(framebufferManager_->UseBufferedRendering());
 		shaderManager_->BindUniforms();
 
 		context_->IASetInputLayout(inputLayout);
-		UINT stride = dec_->GetDecVtxFmt().stride;
+		UINT stride = DecodedVertexStride();
 		context_->IASetPrimitiveTopology(d3d11prim[prim]);
 		if (!vb_) {
 			// Push!
 			UINT vOffset;
-			int vSize = (maxIndex + 1) * dec_->GetDecVtxFmt().stride;
+			int vSize = (maxIndex + 1) * stride;
 			uint8_t *vptr = pushVerts_->BeginPush(context_, &vOffset, vSize);
 			memcpy(vptr, decoded, vSize);
 			pushVerts_->EndPush(context_);
@@ -589,6 +612,8 @@ void DrawEngineD3D11::DoFlush() {
 		params.provokeFlatFirst = true;
 		params.flippedY = false;
 		params.usesHalfZ = true;
+		params.materialColors = materialColorRanges_;
+		params.numMaterialColors = numMaterialColorRanges_;
 
 		// We need correct viewport values in gstate_c already.
 		if (gstate_c.IsDirty(DIRTY_VIEWPORTSCISSOR_STATE)) {
@@ -691,6 +716,7 @@ void DrawEngineD3D11::DoFlush() {
 
 	indexGen.Reset();
 	decodedVerts_ = 0;
+	decodeMorphTargets_ = false;
 	numDrawCalls = 0;
 	vertexCountInDrawCalls_ = 0;
 	decodeCounter_ = 0;
@@ -724,12 +750,6 @@ TessellationDataTransferD3D11::~TessellationDataTransferD3D11() {
 }
 
 void TessellationDataTransferD3D11::SendDataToShader(const SimpleVertex *const *points, int size_u, int size_v, u32 vertType, const Spline::Weight2D &weights) {
-	struct TessData {
-		float pos[3]; float pad1;
-		float uv[2]; float pad2[2];
-		float color[4];
-	};
-
 	int size = size_u * size_v;
 
 	if (prevSize < size) {
@@ -745,15 +765,7 @@ void TessellationDataTransferD3D11::SendDataToShader(const SimpleVertex *const *
 	}
 	D3D11_MAPPED_SUBRESOURCE map;
 	context_->Map(buf[0], 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
-	uint8_t *data = (uint8_t *)map.pData;
-
-	float *pos = (float *)(data);
-	float *tex = (float *)(data + offsetof(TessData, uv));
-	float *col = (float *)(data + offsetof(TessData, color));
-	int stride = sizeof(TessData) / sizeof(float);
-
-	CopyControlPoints(pos, tex, col, stride, stride, stride, points, size, vertType);
-
+	CopyControlPoints((TessData *)map.pData, points, size, vertType);
 	context_->Unmap(buf[0], 0);
 
 	using Spline::Weight;
@@ -769,10 +781,14 @@ void TessellationDataTransferD3D11::SendDataToShader(const SimpleVertex *const *
 		device_->CreateBuffer(&desc, nullptr, &buf[1]);
 		device_->CreateShaderResourceView(buf[1], nullptr, &view[1]);
 		context_->VSSetShaderResources(1, 1, &view[1]);
+		InvalidateWeights(0);
+	}
+	// The buffers keep their contents, so only upload when the tessellation level changed.
+	if (WeightsChanged(0, weights.u)) {
+		context_->Map(buf[1], 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
+		memcpy(map.pData, weights.u, weights.size_u * sizeof(Weight));
+		context_->Unmap(buf[1], 0);
 	}
-	context_->Map(buf[1], 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
-	memcpy(map.pData, weights.u, weights.size_u * sizeof(Weight));
-	context_->Unmap(buf[1], 0);
 
 	// Weights V
 	if (prevSizeWV < weights.size_v) {
@@ -785,8 +801,11 @@ void TessellationDataTransferD3D11::SendDataToShader(const SimpleVertex *const *
 		device_->CreateBuffer(&desc, nullptr, &buf[2]);
 		device_->CreateShaderResourceView(buf[2], nullptr, &view[2]);
 		context_->VSSetShaderResources(2, 1, &view[2]);
+		InvalidateWeights(1);
+	}
+	if (WeightsChanged(1, weights.v)) {
+		context_->Map(buf[2], 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
+		memcpy(map.pData, weights.v, weights.size_v * sizeof(Weight));
+		context_->Unmap(buf[2], 0);
 	}
-	context_->Map(buf[2], 0, D3D11_MAP_WRITE_DISCARD, 0, &map);
-	memcpy(map.pData, weights.v, weights.size_v * sizeof(Weight));
-	context_->Unmap(buf[2], 0);
 }
@@ -68,6 +68,7 @@ class VertexArrayInfoD3D11 {
 		numVerts = 0;
 		drawsUntilNextFullHash = 0;
 		flags = 0;
+		bufferBytes = 0;
 	}
 	~VertexArrayInfoD3D11();
 
@@ -96,6 +97,8 @@ class VertexArrayInfoD3D11 {
 	int lastFrame;  // So that we can forget.
 	u16 drawsUntilNextFullHash;
 	u8 flags;
+	// Size of vbo and ebo, for memory usage stats.
+	u32 bufferBytes;
 };
 
 class TessellationDataTransferD3D11 : public TessellationDataTransfer {
@@ -18,6 +18,7 @@
 #include <set>
 
 #include "Common/Log.h"
+#include "Common/File/FileUtil.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/GraphicsContext.h"
 #include "Common/System/System.h"
@@ -29,6 +30,7 @@
 #include "Core/Config.h"
 #include "Core/Reporting.h"
 #include "Core/System.h"
+#include "Core/ELF/ParamSFO.h"
 
 #include "GPU/GPUState.h"
 #include "GPU/ge_constants.h"
@@ -92,9 +94,59 @@ GPU_D3D11::GPU_D3D11(GraphicsContext *gfxCtx, Draw::DrawContext *draw)
 	// Some of our defaults are different from hw defaults, let's assert them.
 	// We restore each frame anyway, but here is convenient for tests.
 	textureCache_->NotifyConfigChanged();
+
+	// Load shader cache.
+	std::string discID = g_paramSFO.GetDiscID();
+	if (discID.size()) {
+		File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
+		shaderCachePath_ = GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + ".d3d11shadercache");
+		if (g_Config.bShaderCache)
+			SeedShaderCache(shaderCachePath_);
+		LoadCache(shaderCachePath_);
+	}
+}
+
+void GPU_D3D11::LoadCache(const Path &filename) {
+	if (!g_Config.bShaderCache) {
+		INFO_LOG(G3D, "Shader cache disabled. Not loading.");
+		return;
+	}
+
+	FILE *f = File::OpenCFile(filename, "rb");
+	if (!f)
+		return;
+
+	PSP_SetLoading("Loading shader cache...");
+	bool result = shaderManagerD3D11_->LoadCache(f);
+	fclose(f);
+	if (!result) {
+		WARN_LOG(G3D, "Incompatible D3D11 shader cache - rebuilding.");
+		// Bad cache file for this GPU/Driver/etc. Delete it.  Anything valid we loaded is kept
+		// and will be written back out on exit.
+		File::Delete(filename);
+	} else {
+		INFO_LOG(G3D, "Loaded D3D11 shader cache.");
+	}
+}
+
+void GPU_D3D11::SaveCache(const Path &filename) {
+	if (!g_Config.bShaderCache) {
+		INFO_LOG(G3D, "Shader cache disabled. Not saving.");
+		return;
+	}
+	if (!filename.Valid() || shaderManagerD3D11_->GetNumVertexShaders() == 0)
+		return;
+
+	FILE *f = File::OpenCFile(filename, "wb");
+	if (!f)
+		return;
+	shaderManagerD3D11_->SaveCache(f);
+	INFO_LOG(G3D, "Saved D3D11 shader cache");
+	fclose(f);
 }
 
 GPU_D3D11::~GPU_D3D11() {
+	SaveCache(shaderCachePath_);
 	delete depalShaderCache_;
 	framebufferManagerD3D11_->DestroyAllFBOs();
 	delete framebufferManagerD3D11_;
@@ -227,6 +279,7 @@ void GPU_D3D11::ReapplyGfxState() {
 }
 
 void GPU_D3D11::EndHostFrame() {
+	GPUCommon::EndHostFrame();
 	// Probably not really necessary.
 	draw_->InvalidateCachedState();
 }
@@ -240,6 +293,7 @@ void GPU_D3D11::BeginFrame() {
 	// fragmentTestCache_.Decimate();
 
 	shaderManagerD3D11_->DirtyLastShader();
+	shaderManagerD3D11_->BeginFrame();
 
 	framebufferManagerD3D11_->BeginFrame();
 	gstate_c.Dirty(DIRTY_PROJTHROUGHMATRIX);
@@ -21,6 +21,7 @@
 #include <vector>
 #include <d3d11.h>
 
+#include "Common/File/Path.h"
 #include "GPU/GPUCommon.h"
 #include "GPU/D3D11/DrawEngineD3D11.h"
 #include "GPU/D3D11/DepalettizeShaderD3D11.h"
@@ -68,6 +69,8 @@ class GPU_D3D11 : public GPUCommon {
 	// void ApplyDrawState(int prim);
 	void CheckFlushOp(int cmd, u32 diff);
 	void BuildReportingInfo();
+	void LoadCache(const Path &filename);
+	void SaveCache(const Path &filename);
 
 	void InitClear() override;
 	void BeginFrame() override;
@@ -81,4 +84,6 @@ class GPU_D3D11 : public GPUCommon {
 	DepalShaderCacheD3D11 *depalShaderCache_;
 	DrawEngineD3D11 drawEngine_;
 	ShaderManagerD3D11 *shaderManagerD3D11_;
+
+	Path shaderCachePath_;
 };
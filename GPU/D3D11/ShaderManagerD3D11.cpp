@@ -17,7 +17,7 @@
 
 #include "ppsspp_config.h"
 
-#include <d3d11.h>
+#include <d3d11_1.h>
 #include <D3Dcompiler.h>
 
 #include <map>
@@ -29,6 +29,7 @@
 #include "Common/Data/Encoding/Utf8.h"
 #include "Common/Log.h"
 #include "Common/Common.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Core/Config.h"
 #include "Core/Reporting.h"
 #include "GPU/Math3D.h"
@@ -38,13 +39,32 @@
 #include "GPU/D3D11/ShaderManagerD3D11.h"
 #include "GPU/D3D11/D3D11Util.h"
 
+enum {
+	UNIFORM_RING_SIZE = 1024 * 1024,
+	// Constant buffer offsets must be multiples of 16 constants.
+	UNIFORM_RING_ALIGN = 256,
+};
+
 D3D11FragmentShader::D3D11FragmentShader(ID3D11Device *device, D3D_FEATURE_LEVEL featureLevel, FShaderID id, const char *code, bool useHWTransform)
 	: device_(device), useHWTransform_(useHWTransform), id_(id) {
 	source_ = code;
 
-	module_ = CreatePixelShaderD3D11(device, code, strlen(code), featureLevel);
-	if (!module_)
+	const char *profile = featureLevel <= D3D_FEATURE_LEVEL_9_3 ? "ps_4_0_level_9_1" : "ps_4_0";
+	bytecode_ = CompileShaderToBytecodeD3D11(code, strlen(code), profile, 0);
+	if (bytecode_.empty() || FAILED(device->CreatePixelShader(bytecode_.data(), bytecode_.size(), nullptr, &module_))) {
+		module_ = nullptr;
+		failed_ = true;
+	}
+}
+
+D3D11FragmentShader::D3D11FragmentShader(ID3D11Device *device, FShaderID id, const char *code, const std::vector<uint8_t> &bytecode, bool useHWTransform)
+	: device_(device), bytecode_(bytecode), useHWTransform_(useHWTransform), id_(id) {
+	source_ = code;
+
+	if (bytecode_.empty() || FAILED(device->CreatePixelShader(bytecode_.data(), bytecode_.size(), nullptr, &module_))) {
+		module_ = nullptr;
 		failed_ = true;
+	}
 }
 
 D3D11FragmentShader::~D3D11FragmentShader() {
@@ -72,6 +92,16 @@ D3D11VertexShader::D3D11VertexShader(ID3D11Device *device, D3D_FEATURE_LEVEL fea
 		failed_ = true;
 }
 
+D3D11VertexShader::D3D11VertexShader(ID3D11Device *device, VShaderID id, const char *code, const std::vector<uint8_t> &bytecode, bool useHWTransform)
+	: device_(device), bytecode_(bytecode), useHWTransform_(useHWTransform), id_(id) {
+	source_ = code;
+
+	if (bytecode_.empty() || FAILED(device->CreateVertexShader(bytecode_.data(), bytecode_.size(), nullptr, &module_))) {
+		module_ = nullptr;
+		failed_ = true;
+	}
+}
+
 D3D11VertexShader::~D3D11VertexShader() {
 	if (module_)
 		module_->Release();
@@ -99,6 +129,18 @@ ShaderManagerD3D11::ShaderManagerD3D11(Draw::DrawContext *draw, ID3D11Device *de
 	static_assert(sizeof(ub_lights) <= 512, "ub_lights grew too big");
 	static_assert(sizeof(ub_bones) <= 384, "ub_bones grew too big");
 
+	ID3D11DeviceContext1 *context1 = (ID3D11DeviceContext1 *)draw->GetNativeObject(Draw::NativeObject::CONTEXT_EX);
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+	if (context1 && SUCCEEDED(device_->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options)))) {
+		if (options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer)
+			context1_ = context1;
+	}
+
+	if (context1_) {
+		uniformRing_ = new PushBufferD3D11(device_, UNIFORM_RING_SIZE, D3D11_BIND_CONSTANT_BUFFER);
+		return;
+	}
+
 	D3D11_BUFFER_DESC desc{sizeof(ub_base), D3D11_USAGE_DYNAMIC, D3D11_BIND_CONSTANT_BUFFER, D3D11_CPU_ACCESS_WRITE };
 	ASSERT_SUCCESS(device_->CreateBuffer(&desc, nullptr, &push_base));
 	desc.ByteWidth = sizeof(ub_lights);
@@ -108,9 +150,13 @@ ShaderManagerD3D11::ShaderManagerD3D11(Draw::DrawContext *draw, ID3D11Device *de
 }
 
 ShaderManagerD3D11::~ShaderManagerD3D11() {
-	push_base->Release();
-	push_lights->Release();
-	push_bones->Release();
+	if (push_base)
+		push_base->Release();
+	if (push_lights)
+		push_lights->Release();
+	if (push_bones)
+		push_bones->Release();
+	delete uniformRing_;
 	ClearShaders();
 	delete[] codeBuffer_;
 }
@@ -143,9 +189,51 @@ void ShaderManagerD3D11::DirtyLastShader() {
 	gstate_c.Dirty(DIRTY_VERTEXSHADER_STATE | DIRTY_FRAGMENTSHADER_STATE);
 }
 
+void ShaderManagerD3D11::BeginFrame() {
+	if (uniformRing_)
+		uniformRing_->Reset();
+}
+
+// Copies the dirty uniform blocks into the ring.
+void ShaderManagerD3D11::PushUniformRing(uint64_t dirty) {
+	auto push = [&](const void *data, size_t size) {
+		UINT offset;
+		// Reserve the whole bound range, see BindUniforms().
+		size_t reserve = (size + UNIFORM_RING_ALIGN - 1) & ~(UNIFORM_RING_ALIGN - 1);
+		uint8_t *dest = uniformRing_->BeginPush(context_, &offset, reserve, UNIFORM_RING_ALIGN);
+		memcpy(dest, data, size);
+		uniformRing_->EndPush(context_);
+		return offset;
+	};
+
+	bool all = uniformRing_->Generation() != uniformRingGeneration_;
+	while (true) {
+		uint32_t generation = uniformRing_->Generation();
+		if (all || (dirty & DIRTY_BASE_UNIFORMS))
+			baseOffset_ = push(&ub_base, sizeof(ub_base));
+		if (all || (dirty & DIRTY_LIGHT_UNIFORMS))
+			lightsOffset_ = push(&ub_lights, sizeof(ub_lights));
+		if (all || (dirty & DIRTY_BONE_UNIFORMS))
+			bonesOffset_ = push(&ub_bones, sizeof(ub_bones));
+		uniformRingGeneration_ = uniformRing_->Generation();
+		if (uniformRingGeneration_ == generation)
+			break;
+		// The ring was discarded while pushing, taking the blocks we didn't push with it.
+		all = true;
+	}
+}
+
 uint64_t ShaderManagerD3D11::UpdateUniforms(bool useBufferedRendering) {
 	uint64_t dirty = gstate_c.GetDirtyUniforms();
-	if (dirty != 0) {
+	if (dirty != 0 && uniformRing_) {
+		if (dirty & DIRTY_BASE_UNIFORMS)
+			BaseUpdateUniforms(&ub_base, dirty, true, useBufferedRendering);
+		if (dirty & DIRTY_LIGHT_UNIFORMS)
+			LightUpdateUniforms(&ub_lights, dirty);
+		if (dirty & DIRTY_BONE_UNIFORMS)
+			BoneUpdateUniforms(&ub_bones, dirty);
+		PushUniformRing(dirty);
+	} else if (dirty != 0) {
 		D3D11_MAPPED_SUBRESOURCE map;
 		if (dirty & DIRTY_BASE_UNIFORMS) {
 			BaseUpdateUniforms(&ub_base, dirty, true, useBufferedRendering);
@@ -171,6 +259,20 @@ uint64_t ShaderManagerD3D11::UpdateUniforms(bool useBufferedRendering) {
 }
 
 void ShaderManagerD3D11::BindUniforms() {
+	if (uniformRing_) {
+		// Offsets and sizes are in 16-byte constants, and must be multiples of 16 of them.
+		auto constants = [](size_t size) {
+			return (UINT)((size + UNIFORM_RING_ALIGN - 1) & ~(UNIFORM_RING_ALIGN - 1)) / 16;
+		};
+		ID3D11Buffer *buf = uniformRing_->Buf();
+		ID3D11Buffer *vs_cbs[3] = { buf, buf, buf };
+		UINT vs_first[3] = { baseOffset_ / 16, lightsOffset_ / 16, bonesOffset_ / 16 };
+		UINT vs_num[3] = { constants(sizeof(ub_base)), constants(sizeof(ub_lights)), constants(sizeof(ub_bones)) };
+		context1_->VSSetConstantBuffers1(0, 3, vs_cbs, vs_first, vs_num);
+		context1_->PSSetConstantBuffers1(0, 1, vs_cbs, vs_first, vs_num);
+		return;
+	}
+
 	ID3D11Buffer *vs_cbs[3] = { push_base, push_lights, push_bones };
 	ID3D11Buffer *ps_cbs[1] = { push_base };
 	context_->VSSetConstantBuffers(0, 3, vs_cbs);
@@ -291,3 +393,166 @@ std::string ShaderManagerD3D11::DebugGetShaderString(std::string id, DebugShader
 		return "N/A";
 	}
 }
+
+// Unlike the Vulkan cache, we store the compiled DXBC along with the IDs, so a warm boot
+// never calls D3DCompile.  The source is still regenerated (it's cheap) for the debugger.
+// Bump CACHE_VERSION whenever the shader generators change their output.
+
+#define CACHE_HEADER_MAGIC 0x44334443
+#define CACHE_VERSION 1
+struct D3D11CacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t featureFlags;
+	uint32_t featureLevel;
+	int numVertexShaders;
+	int numFragmentShaders;
+};
+
+struct D3D11CacheEntry {
+	ShaderID id;
+	std::string source;
+	std::vector<uint8_t> bytecode;
+};
+
+static bool ReadCacheEntries(FILE *f, int count, std::vector<D3D11CacheEntry> &entries) {
+	entries.resize(count);
+	for (int i = 0; i < count; i++) {
+		uint32_t size = 0;
+		if (fread(&entries[i].id, sizeof(entries[i].id), 1, f) != 1 || fread(&size, sizeof(size), 1, f) != 1) {
+			return false;
+		}
+		// DXBC blobs for our shaders are a few KB.  Anything more is corruption.
+		if (size == 0 || size > 1024 * 1024) {
+			return false;
+		}
+		entries[i].bytecode.resize(size);
+		if (fread(&entries[i].bytecode[0], 1, size, f) != size) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ShaderManagerD3D11::LoadCache(FILE *f) {
+	D3D11CacheHeader header{};
+	bool success = fread(&header, sizeof(header), 1, f) == 1;
+	if (!success || header.magic != CACHE_HEADER_MAGIC)
+		return false;
+	if (header.version != CACHE_VERSION)
+		return false;
+	if (header.featureFlags != gstate_c.featureFlags || header.featureLevel != (uint32_t)featureLevel_)
+		return false;
+	if (header.numVertexShaders < 0 || header.numVertexShaders > 1000 || header.numFragmentShaders < 0 || header.numFragmentShaders > 1000)
+		return false;
+
+	std::vector<D3D11CacheEntry> vert;
+	std::vector<D3D11CacheEntry> frag;
+	if (!ReadCacheEntries(f, header.numVertexShaders, vert) || !ReadCacheEntries(f, header.numFragmentShaders, frag)) {
+		ERROR_LOG(G3D, "D3D11 shader cache truncated or corrupt");
+		return false;
+	}
+
+	// Generating the source is fast, and needs codeBuffer_, so do it here first.
+	for (auto &entry : vert) {
+		std::string genErrorString;
+		uint32_t attrMask = 0;
+		uint64_t uniformMask = 0;
+		if (!GenerateVertexShader(VShaderID(entry.id), codeBuffer_, draw_->GetShaderLanguageDesc(), draw_->GetBugs(), &attrMask, &uniformMask, &genErrorString))
+			return false;
+		entry.source = codeBuffer_;
+	}
+	for (auto &entry : frag) {
+		std::string genErrorString;
+		uint64_t uniformMask = 0;
+		if (!GenerateFragmentShader(FShaderID(entry.id), codeBuffer_, draw_->GetShaderLanguageDesc(), draw_->GetBugs(), &uniformMask, &genErrorString))
+			return false;
+		entry.source = codeBuffer_;
+	}
+
+	// Creating the shader objects is where the driver does its real work.  ID3D11Device is
+	// free-threaded, so spread them out over the worker threads.
+	std::vector<D3D11VertexShader *> vs(vert.size());
+	std::vector<D3D11FragmentShader *> fs(frag.size());
+	int total = (int)(vert.size() + frag.size());
+	ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+		for (int i = l; i < h; i++) {
+			if (i < (int)vert.size()) {
+				D3D11CacheEntry &entry = vert[i];
+				VShaderID id(entry.id);
+				vs[i] = new D3D11VertexShader(device_, id, entry.source.c_str(), entry.bytecode, id.Bit(VS_BIT_USE_HW_TRANSFORM));
+			} else {
+				D3D11CacheEntry &entry = frag[i - vert.size()];
+				fs[i - vert.size()] = new D3D11FragmentShader(device_, FShaderID(entry.id), entry.source.c_str(), entry.bytecode, true);
+			}
+		}
+	}, 0, total, 4);
+
+	int failed = 0;
+	for (size_t i = 0; i < vs.size(); i++) {
+		VShaderID id(vert[i].id);
+		if (vs[i]->Failed() || vsCache_.find(id) != vsCache_.end()) {
+			failed += vs[i]->Failed() ? 1 : 0;
+			delete vs[i];
+			continue;
+		}
+		vsCache_[id] = vs[i];
+	}
+	for (size_t i = 0; i < fs.size(); i++) {
+		FShaderID id(frag[i].id);
+		if (fs[i]->Failed() || fsCache_.find(id) != fsCache_.end()) {
+			failed += fs[i]->Failed() ? 1 : 0;
+			delete fs[i];
+			continue;
+		}
+		fsCache_[id] = fs[i];
+	}
+
+	if (failed != 0) {
+		WARN_LOG(G3D, "%d cached D3D11 shaders were rejected by the device", failed);
+	}
+	NOTICE_LOG(G3D, "Loaded %d vertex and %d fragment shaders", (int)vsCache_.size(), (int)fsCache_.size());
+	return failed == 0;
+}
+
+void ShaderManagerD3D11::SaveCache(FILE *f) {
+	// Shaders that failed to compile are not worth remembering.
+	int numVertexShaders = 0;
+	int numFragmentShaders = 0;
+	for (auto iter : vsCache_) {
+		if (!iter.second->bytecode().empty())
+			numVertexShaders++;
+	}
+	for (auto iter : fsCache_) {
+		if (!iter.second->bytecode().empty())
+			numFragmentShaders++;
+	}
+
+	D3D11CacheHeader header{};
+	header.magic = CACHE_HEADER_MAGIC;
+	header.version = CACHE_VERSION;
+	header.featureFlags = gstate_c.featureFlags;
+	header.featureLevel = (uint32_t)featureLevel_;
+	header.numVertexShaders = numVertexShaders;
+	header.numFragmentShaders = numFragmentShaders;
+	bool writeFailed = fwrite(&header, sizeof(header), 1, f) != 1;
+	auto writeEntry = [&](const ShaderID &id, const std::vector<uint8_t> &bytecode) {
+		if (bytecode.empty())
+			return;
+		uint32_t size = (uint32_t)bytecode.size();
+		writeFailed = writeFailed || fwrite(&id, sizeof(id), 1, f) != 1;
+		writeFailed = writeFailed || fwrite(&size, sizeof(size), 1, f) != 1;
+		writeFailed = writeFailed || fwrite(bytecode.data(), 1, size, f) != size;
+	};
+	for (auto iter : vsCache_) {
+		writeEntry(iter.first, iter.second->bytecode());
+	}
+	for (auto iter : fsCache_) {
+		writeEntry(iter.first, iter.second->bytecode());
+	}
+	if (writeFailed) {
+		ERROR_LOG(G3D, "Failed to write D3D11 shader cache, disk full?");
+	} else {
+		NOTICE_LOG(G3D, "Saved %d vertex and %d fragment shaders", numVertexShaders, numFragmentShaders);
+	}
+}
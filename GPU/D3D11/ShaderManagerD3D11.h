@@ -17,9 +17,10 @@
 
 #pragma once
 
+#include <cstdio>
 #include <map>
 
-#include <d3d11.h>
+#include <d3d11_1.h>
 
 #include "Common/Common.h"
 #include "GPU/Common/ShaderCommon.h"
@@ -29,13 +30,17 @@
 
 class D3D11Context;
 class D3D11PushBuffer;
+class PushBufferD3D11;
 
 class D3D11FragmentShader {
 public:
 	D3D11FragmentShader(ID3D11Device *device, D3D_FEATURE_LEVEL featureLevel, FShaderID id, const char *code, bool useHWTransform);
+	// Creates the shader from previously compiled bytecode, skipping D3DCompile.
+	D3D11FragmentShader(ID3D11Device *device, FShaderID id, const char *code, const std::vector<uint8_t> &bytecode, bool useHWTransform);
 	~D3D11FragmentShader();
 
 	const std::string &source() const { return source_; }
+	const std::vector<uint8_t> &bytecode() const { return bytecode_; }
 
 	bool Failed() const { return failed_; }
 	bool UseHWTransform() const { return useHWTransform_; }
@@ -48,6 +53,7 @@ class D3D11FragmentShader {
 
 	ID3D11Device *device_;
 	std::string source_;
+	std::vector<uint8_t> bytecode_;
 	bool failed_ = false;
 	bool useHWTransform_;
 	FShaderID id_;
@@ -56,6 +62,8 @@ class D3D11FragmentShader {
 class D3D11VertexShader {
 public:
 	D3D11VertexShader(ID3D11Device *device, D3D_FEATURE_LEVEL featureLevel, VShaderID id, const char *code, int vertType, bool useHWTransform);
+	// Creates the shader from previously compiled bytecode, skipping D3DCompile.
+	D3D11VertexShader(ID3D11Device *device, VShaderID id, const char *code, const std::vector<uint8_t> &bytecode, bool useHWTransform);
 	~D3D11VertexShader();
 
 	const std::string &source() const { return source_; }
@@ -95,6 +103,7 @@ class ShaderManagerD3D11 : public ShaderManagerCommon {
 	std::vector<std::string> DebugGetShaderIDs(DebugShaderType type);
 	std::string DebugGetShaderString(std::string id, DebugShaderType type, DebugShaderStringType stringType);
 
+	void BeginFrame();
 	uint64_t UpdateUniforms(bool useBufferedRendering);
 	void BindUniforms();
 
@@ -104,11 +113,17 @@ class ShaderManagerD3D11 : public ShaderManagerCommon {
 	bool IsLightDirty() { return true; }
 	bool IsBoneDirty() { return true; }
 
+	bool LoadCache(FILE *f);
+	void SaveCache(FILE *f);
+
 private:
 	void Clear();
+	void PushUniformRing(uint64_t dirty);
 
 	ID3D11Device *device_;
 	ID3D11DeviceContext *context_;
+	// Only set if constant buffer offsets are supported (D3D11.1.)
+	ID3D11DeviceContext1 *context1_ = nullptr;
 	D3D_FEATURE_LEVEL featureLevel_;
 
 	typedef std::map<FShaderID, D3D11FragmentShader *> FSCache;
@@ -124,10 +139,19 @@ class ShaderManagerD3D11 : public ShaderManagerCommon {
 	UB_VS_Lights ub_lights;
 	UB_VS_Bones ub_bones;
 
-	// Not actual pushbuffers, requires D3D11.1, let's try to live without that first.
-	ID3D11Buffer *push_base;
-	ID3D11Buffer *push_lights;
-	ID3D11Buffer *push_bones;
+	// Not actual pushbuffers, used when D3D11.1 constant buffer offsets aren't available.
+	ID3D11Buffer *push_base = nullptr;
+	ID3D11Buffer *push_lights = nullptr;
+	ID3D11Buffer *push_bones = nullptr;
+
+	// With D3D11.1, all the uniform blocks are streamed into this with NO_OVERWRITE instead,
+	// and bound by offset.  Saves the driver renaming three small buffers all the time.
+	PushBufferD3D11 *uniformRing_ = nullptr;
+	// Generation of uniformRing_ the offsets below point into.
+	uint32_t uniformRingGeneration_ = 0xFFFFFFFF;
+	UINT baseOffset_ = 0;
+	UINT lightsOffset_ = 0;
+	UINT bonesOffset_ = 0;
 
 	D3D11FragmentShader *lastFShader_ = nullptr;
 	D3D11VertexShader *lastVShader_ = nullptr;
@@ -112,6 +112,27 @@ ID3D11SamplerState *SamplerCacheD3D11::GetOrCreateSampler(ID3D11Device *device,
 	return sampler;
 }
 
+ReplacedTextureFormat FromD3D11Format(u32 fmt) {
+	switch (fmt) {
+	case DXGI_FORMAT_B5G6R5_UNORM: return ReplacedTextureFormat::F_5650;
+	case DXGI_FORMAT_B5G5R5A1_UNORM: return ReplacedTextureFormat::F_5551;
+	case DXGI_FORMAT_B4G4R4A4_UNORM: return ReplacedTextureFormat::F_4444;
+	case DXGI_FORMAT_B8G8R8A8_UNORM: default: return ReplacedTextureFormat::F_8888;
+	}
+}
+
+DXGI_FORMAT ToDXGIFormat(ReplacedTextureFormat fmt) {
+	switch (fmt) {
+	case ReplacedTextureFormat::F_5650: return DXGI_FORMAT_B5G6R5_UNORM;
+	case ReplacedTextureFormat::F_5551: return DXGI_FORMAT_B5G5R5A1_UNORM;
+	case ReplacedTextureFormat::F_4444: return DXGI_FORMAT_B4G4R4A4_UNORM;
+	case ReplacedTextureFormat::F_BC1: return DXGI_FORMAT_BC1_UNORM;
+	case ReplacedTextureFormat::F_BC3: return DXGI_FORMAT_BC3_UNORM;
+	case ReplacedTextureFormat::F_BC7: return DXGI_FORMAT_BC7_UNORM;
+	case ReplacedTextureFormat::F_8888: default: return DXGI_FORMAT_B8G8R8A8_UNORM;
+	}
+}
+
 TextureCacheD3D11::TextureCacheD3D11(Draw::DrawContext *draw)
 	: TextureCacheCommon(draw) {
 	device_ = (ID3D11Device *)draw->GetNativeObject(Draw::NativeObject::DEVICE);
@@ -128,6 +149,15 @@ TextureCacheD3D11::TextureCacheD3D11(Draw::DrawContext *draw)
 
 	SetupTextureDecoder();
 
+	// ETC2 and ASTC don't exist in D3D11.
+	std::vector<ReplacedTextureFormat> compressedFormats;
+	for (ReplacedTextureFormat fmt : { ReplacedTextureFormat::F_BC1, ReplacedTextureFormat::F_BC3, ReplacedTextureFormat::F_BC7 }) {
+		UINT support = 0;
+		if (SUCCEEDED(device_->CheckFormatSupport(ToDXGIFormat(fmt), &support)) && (support & D3D11_FORMAT_SUPPORT_TEXTURE2D) != 0)
+			compressedFormats.push_back(fmt);
+	}
+	replacer_.SetSupportedCompressedFormats(compressedFormats);
+
 	nextTexture_ = nullptr;
 }
 
@@ -182,6 +212,7 @@ void TextureCacheD3D11::StartFrame() {
 	} else {
 		Decimate();
 	}
+	StartHashVerification();
 }
 
 void TextureCacheD3D11::UpdateCurrentClut(GEPaletteFormat clutFormat, u32 clutBase, bool clutIndexIsSimple) {
@@ -439,7 +470,7 @@ void TextureCacheD3D11::BuildTexture(TexCacheEntry *const entry) {
 	entry->status &= ~TexCacheEntry::STATUS_ALPHA_MASK;
 
 	// For the estimate, we assume cluts always point to 8888 for simplicity.
-	cacheSizeEstimate_ += EstimateTexMemoryUsage(entry);
+	SetTexMemoryUsage(entry, EstimateTexMemoryUsage(entry));
 
 	if ((entry->bufw == 0 || (gstate.texbufwidth[0] & 0xf800) != 0) && entry->addr >= PSP_GetKernelMemoryEnd()) {
 		ERROR_LOG_REPORT(G3D, "Texture with unexpected bufw (full=%d)", gstate.texbufwidth[0] & 0xffff);
@@ -514,6 +545,7 @@ void TextureCacheD3D11::BuildTexture(TexCacheEntry *const entry) {
 			texelsScaledThisFrame_ += w * h;
 		}
 	}
+	SetTexMemoryUsage(entry, replaced, scaleFactor);
 
 	// Seems to cause problems in Tactics Ogre.
 	if (badMipSizes) {
@@ -614,24 +646,6 @@ TexCacheEntry::TexStatus TextureCacheD3D11::CheckAlpha(const u32 *pixelData, u32
 	return (TexCacheEntry::TexStatus)res;
 }
 
-ReplacedTextureFormat FromD3D11Format(u32 fmt) {
-	switch (fmt) {
-	case DXGI_FORMAT_B5G6R5_UNORM: return ReplacedTextureFormat::F_5650;
-	case DXGI_FORMAT_B5G5R5A1_UNORM: return ReplacedTextureFormat::F_5551;
-	case DXGI_FORMAT_B4G4R4A4_UNORM: return ReplacedTextureFormat::F_4444;
-	case DXGI_FORMAT_B8G8R8A8_UNORM: default: return ReplacedTextureFormat::F_8888;
-	}
-}
-
-DXGI_FORMAT ToDXGIFormat(ReplacedTextureFormat fmt) {
-	switch (fmt) {
-	case ReplacedTextureFormat::F_5650: return DXGI_FORMAT_B5G6R5_UNORM;
-	case ReplacedTextureFormat::F_5551: return DXGI_FORMAT_B5G5R5A1_UNORM;
-	case ReplacedTextureFormat::F_4444: return DXGI_FORMAT_B4G4R4A4_UNORM;
-	case ReplacedTextureFormat::F_8888: default: return DXGI_FORMAT_B8G8R8A8_UNORM;
-	}
-}
-
 void TextureCacheD3D11::LoadTextureLevel(TexCacheEntry &entry, ReplacedTexture &replaced, int level, int maxLevel, int scaleFactor, DXGI_FORMAT dstFmt) {
 	int w = gstate.getTextureWidth(level);
 	int h = gstate.getTextureHeight(level);
@@ -676,8 +690,9 @@ void TextureCacheD3D11::LoadTextureLevel(TexCacheEntry &entry, ReplacedTexture &
 	u32 *mapData = nullptr;
 	int mapRowPitch = 0;
 	if (replaced.GetSize(level, w, h)) {
-		mapData = (u32 *)AllocateAlignedMemory(w * h * sizeof(u32), 16);
-		mapRowPitch = w * 4;
+		// For block compressed formats, this is the pitch of a row of blocks.
+		mapRowPitch = ReplacedFormatRowBytes(replaced.Format(level), w);
+		mapData = (u32 *)AllocateAlignedMemory(mapRowPitch * ReplacedFormatRows(replaced.Format(level), h), 16);
 		double replaceStart = time_now_d();
 		replaced.Load(level, mapData, mapRowPitch);
 		replacementTimeThisFrame_ += time_now_d() - replaceStart;
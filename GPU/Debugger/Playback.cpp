@@ -75,7 +75,7 @@ class BufMapping {
 	}
 
 protected:
-	u32 MapSlab(u32 bufpos, const std::function<void()> &flush);
+	u32 MapSlab(u32 bufpos, u32 sz, const std::function<void()> &flush);
 	u32 MapExtra(u32 bufpos, u32 sz, const std::function<void()> &flush);
 
 	enum {
@@ -95,6 +95,8 @@ class BufMapping {
 	struct SlabInfo {
 		u32 psp_pointer_ = 0;
 		u32 buf_pointer_ = 0;
+		// How much was copied.  Streamed dumps may not have loaded the whole slab yet.
+		u32 size_ = 0;
 		int last_used_ = 0;
 
 		bool Matches(u32 bufpos) {
@@ -102,6 +104,10 @@ class BufMapping {
 			return buf_pointer_ == bufpos && psp_pointer_ != 0;
 		}
 
+		bool Covers(u32 bufpos, u32 sz) const {
+			return bufpos + sz <= buf_pointer_ + size_;
+		}
+
 		// Automatically marks used for LRU purposes.
 		u32 Ptr(u32 bufpos) {
 			last_used_ = slabGeneration_;
@@ -153,20 +159,24 @@ u32 BufMapping::Map(u32 bufpos, u32 sz, const std::function<void()> &flush) {
 
 	if (slab1 == slab2) {
 		// Doesn't straddle, so we can just map to a slab.
-		return MapSlab(bufpos, flush);
+		return MapSlab(bufpos, sz, flush);
 	} else {
 		// We need contiguous, so we'll just allocate separately.
 		return MapExtra(bufpos, sz, flush);
 	}
 }
 
-u32 BufMapping::MapSlab(u32 bufpos, const std::function<void()> &flush) {
+u32 BufMapping::MapSlab(u32 bufpos, u32 sz, const std::function<void()> &flush) {
 	u32 slab_pos = (bufpos / SLAB_SIZE) * SLAB_SIZE;
 
 	int best = 0;
 	for (int i = 0; i < SLAB_COUNT; ++i) {
 		if (slabs_[i].Matches(slab_pos)) {
-			return slabs_[i].Ptr(bufpos);
+			if (slabs_[i].Covers(bufpos, sz))
+				return slabs_[i].Ptr(bufpos);
+			// More has been loaded since it was copied, so refresh this one.
+			best = i;
+			break;
 		}
 
 		if (slabs_[i].Age() > slabs_[best].Age()) {
@@ -224,6 +234,7 @@ void BufMapping::SlabInfo::Free() {
 		userMemory.Free(psp_pointer_);
 		psp_pointer_ = 0;
 		buf_pointer_ = 0;
+		size_ = 0;
 		last_used_ = 0;
 	}
 }
@@ -266,6 +277,7 @@ bool BufMapping::SlabInfo::Setup(u32 bufpos, const std::vector<u8> &pushbuf_) {
 	buf_pointer_ = bufpos;
 	u32 sz = std::min((u32)SLAB_SIZE, (u32)pushbuf_.size() - bufpos);
 	Memory::MemcpyUnchecked(psp_pointer_, pushbuf_.data() + bufpos, sz);
+	size_ = sz;
 
 	slabGeneration_++;
 	last_used_ = slabGeneration_;
@@ -282,6 +294,11 @@ class DumpExecute {
 	~DumpExecute();
 
 	bool Run();
+	// Runs any commands not yet run, streamed dumps call this as each chunk is loaded.
+	bool RunCommands();
+	void Finish() {
+		SubmitListEnd();
+	}
 
 private:
 	void SyncStall();
@@ -311,6 +328,7 @@ class DumpExecute {
 
 	const std::vector<u8> &pushbuf_;
 	const std::vector<Command> &commands_;
+	size_t nextCommand_ = 0;
 	BufMapping mapping_;
 };
 
@@ -564,7 +582,16 @@ DumpExecute::~DumpExecute() {
 }
 
 bool DumpExecute::Run() {
-	for (const Command &cmd : commands_) {
+	if (!RunCommands())
+		return false;
+
+	SubmitListEnd();
+	return true;
+}
+
+bool DumpExecute::RunCommands() {
+	for (; nextCommand_ < commands_.size(); ++nextCommand_) {
+		const Command &cmd = commands_[nextCommand_];
 		switch (cmd.type) {
 		case CommandType::INIT:
 			Init(cmd.ptr, cmd.sz);
@@ -634,7 +661,6 @@ bool DumpExecute::Run() {
 		}
 	}
 
-	SubmitListEnd();
 	return true;
 }
 
@@ -660,6 +686,44 @@ static bool ReadCompressed(u32 fp, void *dest, size_t sz, uint32_t version) {
 	return real_size == sz;
 }
 
+// Loads each chunk and runs it before reading the next, so long dumps start right away.
+static bool RunStreamedReplay(u32 fp, uint32_t version) {
+	lastExecCommands.clear();
+	lastExecPushbuf.clear();
+
+	DumpExecute executor(lastExecPushbuf, lastExecCommands);
+	while (true) {
+		u32 counts[2]{};
+		if (pspFileSystem.ReadFile(fp, (u8 *)counts, sizeof(counts)) != sizeof(counts)) {
+			ERROR_LOG(SYSTEM, "Truncated GE dump");
+			executor.Finish();
+			return false;
+		}
+		if (counts[0] == 0 && counts[1] == 0)
+			break;
+
+		size_t cmdStart = lastExecCommands.size();
+		size_t bufStart = lastExecPushbuf.size();
+		lastExecCommands.resize(cmdStart + counts[0]);
+		lastExecPushbuf.resize(bufStart + counts[1]);
+
+		bool truncated = false;
+		truncated = truncated || !ReadCompressed(fp, lastExecCommands.data() + cmdStart, sizeof(Command) * counts[0], version);
+		truncated = truncated || !ReadCompressed(fp, lastExecPushbuf.data() + bufStart, counts[1], version);
+		if (truncated) {
+			ERROR_LOG(SYSTEM, "Truncated GE dump");
+			executor.Finish();
+			return false;
+		}
+
+		if (!executor.RunCommands())
+			return false;
+	}
+
+	executor.Finish();
+	return true;
+}
+
 static void ReplayStop() {
 	// This can happen from a separate thread.
 	std::lock_guard<std::mutex> guard(executeLock);
@@ -694,6 +758,15 @@ bool RunMountedReplay(const std::string &filename) {
 			g_paramSFO.SetValue("DISC_ID", std::string(header.gameID, gameIDLength), (int)sizeof(header.gameID));
 		}
 
+		if (header.version >= 6 && (header.flags & HEADER_FLAG_STREAMED) != 0) {
+			bool success = RunStreamedReplay(fp, header.version);
+			pspFileSystem.CloseFile(fp);
+			// Once it's all loaded, later runs can use the cached copy.
+			if (success)
+				lastExecFilename = filename;
+			return success;
+		}
+
 		u32 sz = 0;
 		pspFileSystem.ReadFile(fp, (u8 *)&sz, sizeof(sz));
 		u32 bufsz = 0;
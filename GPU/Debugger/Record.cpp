@@ -17,9 +17,13 @@
 
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <functional>
 #include <set>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <mutex>
 #include <zstd.h>
@@ -27,6 +31,7 @@
 #include "Common/Common.h"
 #include "Common/File/FileUtil.h"
 #include "Common/Thread/ParallelLoop.h"
+#include "Common/Thread/ThreadUtil.h"
 #include "Common/Log.h"
 #include "Common/StringUtils.h"
 
@@ -43,6 +48,7 @@
 #include "GPU/Common/VertexDecoderCommon.h"
 #include "GPU/Debugger/Record.h"
 #include "GPU/Debugger/RecordFormat.h"
+#include "ext/xxhash.h"
 
 namespace GPURecord {
 
@@ -57,13 +63,46 @@ static std::vector<u32> lastRegisters;
 static std::vector<u32> lastTextures;
 static std::set<u32> lastRenderTargets;
 
+// Streaming writes chunks out while recording, so pushbuf only holds what hasn't been written yet.
+static int pendingStreamFrames = 0;
+static bool streaming = false;
+static int streamFramesLeft = 0;
+// Position in the dump of pushbuf[0].  Always 0 when not streaming.
+static u32 pushbufBase = 0;
+// Written data can't be searched anymore, so it's found by hash instead.
+static std::unordered_map<u64, u32> streamedData;
+static Path streamFilename;
+static FILE *streamFile = nullptr;
+
+// Start a new chunk after this much new data, even in the middle of a frame.
+static const size_t STREAM_CHUNK_BYTES = 16 * 1024 * 1024;
+// If the writer falls this far behind, recording waits for it rather than using more RAM.
+static const size_t STREAM_MAX_QUEUED = 4;
+
+struct StreamChunk {
+	std::vector<Command> commands;
+	std::vector<u8> pushbuf;
+};
+
+static std::thread streamThread;
+static std::mutex streamLock;
+static std::condition_variable streamCond;
+static std::deque<StreamChunk> streamQueue;
+static bool streamFinishing = false;
+
+// Appends to pushbuf, returning the position in the dump.
+static u32 PushbufAppend(const void *p, u32 sz) {
+	u32 pos = (u32)pushbuf.size();
+	pushbuf.resize(pos + sz);
+	memcpy(pushbuf.data() + pos, p, sz);
+	return pushbufBase + pos;
+}
+
 static void FlushRegisters() {
 	if (!lastRegisters.empty()) {
 		Command last{CommandType::REGISTERS};
-		last.ptr = (u32)pushbuf.size();
 		last.sz = (u32)(lastRegisters.size() * sizeof(u32));
-		pushbuf.resize(pushbuf.size() + last.sz);
-		memcpy(pushbuf.data() + last.ptr, lastRegisters.data(), last.sz);
+		last.ptr = PushbufAppend(lastRegisters.data(), last.sz);
 		lastRegisters.clear();
 
 		commands.push_back(last);
@@ -90,6 +129,101 @@ static Path GenRecordingFilename() {
 	return dumpDir / StringFromFormat("%s_%04d.ppdmp", prefix.c_str(), 9999);
 }
 
+static void WriteHeader(FILE *fp, u8 flags) {
+	Header header{};
+	strncpy(header.magic, HEADER_MAGIC, sizeof(header.magic));
+	header.version = VERSION;
+	strncpy(header.gameID, g_paramSFO.GetDiscID().c_str(), sizeof(header.gameID));
+	header.flags = flags;
+	fwrite(&header, sizeof(header), 1, fp);
+}
+
+static void WriteCompressed(FILE *fp, const void *p, size_t sz);
+
+static void StreamWriterThread() {
+	SetCurrentThreadName("GERecordWriter");
+
+	std::unique_lock<std::mutex> guard(streamLock);
+	while (true) {
+		streamCond.wait(guard, [] { return !streamQueue.empty() || streamFinishing; });
+		if (streamQueue.empty())
+			break;
+
+		StreamChunk chunk = std::move(streamQueue.front());
+		streamQueue.pop_front();
+		guard.unlock();
+		// There's room again, in case recording is waiting.
+		streamCond.notify_all();
+
+		u32 counts[2] = { (u32)chunk.commands.size(), (u32)chunk.pushbuf.size() };
+		fwrite(counts, sizeof(counts), 1, streamFile);
+		WriteCompressed(streamFile, chunk.commands.data(), chunk.commands.size() * sizeof(Command));
+		WriteCompressed(streamFile, chunk.pushbuf.data(), chunk.pushbuf.size());
+
+		guard.lock();
+	}
+}
+
+static bool BeginStreaming(int frames) {
+	streamFilename = GenRecordingFilename();
+	streamFile = File::OpenCFile(streamFilename, "wb");
+	if (!streamFile) {
+		ERROR_LOG(G3D, "Unable to open %s for streaming, recording a single frame", streamFilename.c_str());
+		return false;
+	}
+
+	NOTICE_LOG(G3D, "Streaming %d frames to: %s", frames, streamFilename.c_str());
+	WriteHeader(streamFile, HEADER_FLAG_STREAMED);
+
+	streaming = true;
+	streamFramesLeft = frames;
+	pushbufBase = 0;
+	streamedData.clear();
+	streamFinishing = false;
+	streamThread = std::thread(&StreamWriterThread);
+	return true;
+}
+
+// Hands what's been recorded so far to the writer thread.
+static void FlushStreamChunk() {
+	FlushRegisters();
+	if (commands.empty())
+		return;
+
+	StreamChunk chunk;
+	chunk.commands = std::move(commands);
+	chunk.pushbuf = std::move(pushbuf);
+	commands.clear();
+	pushbuf.clear();
+	pushbufBase += (u32)chunk.pushbuf.size();
+
+	std::unique_lock<std::mutex> guard(streamLock);
+	streamCond.wait(guard, [] { return streamQueue.size() < STREAM_MAX_QUEUED; });
+	streamQueue.push_back(std::move(chunk));
+	streamCond.notify_all();
+}
+
+static Path EndStreaming() {
+	FlushStreamChunk();
+
+	{
+		std::lock_guard<std::mutex> guard(streamLock);
+		streamFinishing = true;
+		streamCond.notify_all();
+	}
+	streamThread.join();
+
+	const u32 endMarker[2]{};
+	fwrite(endMarker, sizeof(endMarker), 1, streamFile);
+	fclose(streamFile);
+	streamFile = nullptr;
+
+	streaming = false;
+	pushbufBase = 0;
+	streamedData.clear();
+	return streamFilename;
+}
+
 static void BeginRecording() {
 	active = true;
 	nextFrame = false;
@@ -97,12 +231,16 @@ static void BeginRecording() {
 	lastRenderTargets.clear();
 	flipLastAction = gpuStats.numFlips;
 
-	u32 ptr = (u32)pushbuf.size();
+	if (pendingStreamFrames > 1)
+		BeginStreaming(pendingStreamFrames);
+	pendingStreamFrames = 0;
+
 	u32 sz = 512 * 4;
-	pushbuf.resize(pushbuf.size() + sz);
-	gstate.Save((u32_le *)(pushbuf.data() + ptr));
+	u32 pos = (u32)pushbuf.size();
+	pushbuf.resize(pos + sz);
+	gstate.Save((u32_le *)(pushbuf.data() + pos));
 
-	commands.push_back({CommandType::INIT, sz, ptr});
+	commands.push_back({CommandType::INIT, sz, pushbufBase + pos});
 }
 
 static void WriteCompressed(FILE *fp, const void *p, size_t sz) {
@@ -125,11 +263,7 @@ static Path WriteRecording() {
 	NOTICE_LOG(G3D, "Recording filename: %s", filename.c_str());
 
 	FILE *fp = File::OpenCFile(filename, "wb");
-	Header header{};
-	strncpy(header.magic, HEADER_MAGIC, sizeof(header.magic));
-	header.version = VERSION;
-	strncpy(header.gameID, g_paramSFO.GetDiscID().c_str(), sizeof(header.gameID));
-	fwrite(&header, sizeof(header), 1, fp);
+	WriteHeader(fp, 0);
 
 	u32 sz = (u32)commands.size();
 	fwrite(&sz, sizeof(sz), 1, fp);
@@ -222,6 +356,25 @@ static Command EmitCommandWithRAM(CommandType t, const void *p, u32 sz, u32 alig
 
 	Command cmd{t, sz, 0};
 
+	if (sz && streaming) {
+		// Most of the data has already been written out, so look it up by hash.
+		u64 hash = XXH3_64bits_withSeed(p, sz, sz);
+		auto prev = streamedData.find(hash);
+		if (prev != streamedData.end() && (prev->second & (align - 1)) == 0) {
+			cmd.ptr = prev->second;
+		} else {
+			u32 pad = (align - ((pushbufBase + (u32)pushbuf.size()) & (align - 1))) & (align - 1);
+			pushbuf.resize(pushbuf.size() + pad, 0);
+			cmd.ptr = PushbufAppend(p, sz);
+			streamedData[hash] = cmd.ptr;
+		}
+
+		commands.push_back(cmd);
+		if (pushbuf.size() >= STREAM_CHUNK_BYTES)
+			FlushStreamChunk();
+		return cmd;
+	}
+
 	if (sz) {
 		// If at all possible, try to find it already in the buffer.
 		const u8 *prev = nullptr;
@@ -291,7 +444,10 @@ static void EmitTextureData(int level, u32 texaddr) {
 		bytes += (u32)sizeof(framebuf);
 	}
 
-	if (bytes > 0) {
+	if (bytes > 0 && streaming) {
+		// Matching textures are found by hash.
+		EmitCommandWithRAM(type, p, bytes, 16);
+	} else if (bytes > 0) {
 		FlushRegisters();
 
 		// Dumps are huge - let's try to find this already emitted.
@@ -413,18 +569,26 @@ bool Activate() {
 	if (!nextFrame) {
 		nextFrame = true;
 		flipLastAction = gpuStats.numFlips;
+		pendingStreamFrames = 0;
 		return true;
 	}
 	return false;
 }
 
+bool ActivateStreaming(int frames) {
+	if (!Activate())
+		return false;
+	pendingStreamFrames = frames;
+	return true;
+}
+
 void SetCallback(const std::function<void(const Path &)> callback) {
 	writeCallback = callback;
 }
 
 static void FinishRecording() {
 	// We're done - this was just to write the result out.
-	Path filename = WriteRecording();
+	Path filename = streaming ? EndStreaming() : WriteRecording();
 	commands.clear();
 	pushbuf.clear();
 
@@ -496,9 +660,8 @@ void NotifyMemcpy(u32 dest, u32 src, u32 sz) {
 	}
 	if (Memory::IsVRAMAddress(dest)) {
 		FlushRegisters();
-		Command cmd{CommandType::MEMCPYDEST, sizeof(dest), (u32)pushbuf.size()};
-		pushbuf.resize(pushbuf.size() + sizeof(dest));
-		memcpy(pushbuf.data() + cmd.ptr, &dest, sizeof(dest));
+		Command cmd{CommandType::MEMCPYDEST, sizeof(dest), PushbufAppend(&dest, sizeof(dest))};
+		commands.push_back(cmd);
 
 		sz = Memory::ValidSize(dest, sz);
 		if (sz != 0) {
@@ -522,9 +685,8 @@ void NotifyMemset(u32 dest, int v, u32 sz) {
 		MemsetCommand data{dest, v, sz};
 
 		FlushRegisters();
-		Command cmd{CommandType::MEMSET, sizeof(data), (u32)pushbuf.size()};
-		pushbuf.resize(pushbuf.size() + sizeof(data));
-		memcpy(pushbuf.data() + cmd.ptr, &data, sizeof(data));
+		Command cmd{CommandType::MEMSET, sizeof(data), PushbufAppend(&data, sizeof(data))};
+		commands.push_back(cmd);
 	}
 }
 
@@ -575,14 +737,15 @@ void NotifyDisplay(u32 framebuf, int stride, int fmt) {
 	DisplayBufData disp{ { framebuf }, stride, fmt };
 
 	FlushRegisters();
-	u32 ptr = (u32)pushbuf.size();
 	u32 sz = (u32)sizeof(disp);
-	pushbuf.resize(pushbuf.size() + sz);
-	memcpy(pushbuf.data() + ptr, &disp, sz);
+	u32 ptr = PushbufAppend(&disp, sz);
 
 	commands.push_back({ CommandType::DISPLAY, sz, ptr });
 
-	if (writePending) {
+	if (writePending && streaming && --streamFramesLeft > 0) {
+		FlushStreamChunk();
+		flipLastAction = gpuStats.numFlips;
+	} else if (writePending) {
 		NOTICE_LOG(SYSTEM, "Recording complete on display");
 		FinishRecording();
 	}
@@ -592,7 +755,9 @@ void NotifyFrame() {
 	const bool noDisplayAction = flipLastAction + 4 < gpuStats.numFlips;
 	// We do this only to catch things that don't call NotifyFrame.
 	if (active && HasDrawCommands() && noDisplayAction) {
-		NOTICE_LOG(SYSTEM, "Recording complete on frame");
+		const bool moreFrames = streaming && --streamFramesLeft > 0;
+		if (!moreFrames)
+			NOTICE_LOG(SYSTEM, "Recording complete on frame");
 
 		struct DisplayBufData {
 			PSPPointer<u8> topaddr;
@@ -603,14 +768,17 @@ void NotifyFrame() {
 		__DisplayGetFramebuf(&disp.topaddr, &disp.linesize, &disp.pixelFormat, 0);
 
 		FlushRegisters();
-		u32 ptr = (u32)pushbuf.size();
 		u32 sz = (u32)sizeof(disp);
-		pushbuf.resize(pushbuf.size() + sz);
-		memcpy(pushbuf.data() + ptr, &disp, sz);
+		u32 ptr = PushbufAppend(&disp, sz);
 
 		commands.push_back({ CommandType::DISPLAY, sz, ptr });
 
-		FinishRecording();
+		if (moreFrames) {
+			FlushStreamChunk();
+			flipLastAction = gpuStats.numFlips;
+		} else {
+			FinishRecording();
+		}
 	}
 	if (nextFrame && (gstate_c.skipDrawReason & SKIPDRAW_SKIPFRAME) == 0 && noDisplayAction) {
 		NOTICE_LOG(SYSTEM, "Recording starting on frame...");
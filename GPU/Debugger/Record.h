@@ -28,6 +28,8 @@ namespace GPURecord {
 bool IsActive();
 bool IsActivePending();
 bool Activate();
+// Records the given number of frames, writing them out as it goes instead of all at the end.
+bool ActivateStreaming(int frames);
 // Call only if Activate() returns true.
 void SetCallback(const std::function<void(const Path &)> callback);
 
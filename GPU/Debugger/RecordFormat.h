@@ -25,7 +25,15 @@ struct Header {
 	char magic[8];
 	uint32_t version;
 	char gameID[9];
-	uint8_t pad[3];
+	uint8_t flags;
+	uint8_t pad[2];
+};
+
+enum HeaderFlags : uint8_t {
+	// Instead of one commands block and one pushbuf block, the file has a list of chunks.
+	// Each is a u32 command count, a u32 pushbuf size, then both compressed, like the regular blocks.
+	// Pushbuf positions are continuous across chunks.  A chunk with zero for both counts ends the list.
+	HEADER_FLAG_STREAMED = 1,
 };
 
 static const char *HEADER_MAGIC = "PPSSPPGE";
@@ -34,7 +42,8 @@ static const char *HEADER_MAGIC = "PPSSPPGE";
 // Version 3: Adds FRAMEBUF0-FRAMEBUF9
 // Version 4: Expanded header with game ID
 // Version 5: Uses zstd
-static const int VERSION = 5;
+// Version 6: Adds flags to the header, for HEADER_FLAG_STREAMED
+static const int VERSION = 6;
 static const int MIN_VERSION = 2;
 
 enum class CommandType : u8 {
@@ -19,6 +19,7 @@
 
 #include "Common/Log.h"
 #include "Common/MemoryUtil.h"
+#include "Common/Profiler/MemoryUsage.h"
 #include "Common/TimeUtil.h"
 #include "Core/MemMap.h"
 #include "Core/System.h"
@@ -237,6 +238,8 @@ IDirect3DVertexDeclaration9 *DrawEngineDX9::SetupDecFmtForDraw(VSShader *vshader
 
 void DrawEngineDX9::MarkUnreliable(VertexArrayInfoDX9 *vai) {
 	vai->status = VertexArrayInfoDX9::VAI_UNRELIABLE;
+	MemoryUsage_Add(MemoryCategory::VERTEX_CACHE, -(int64_t)vai->bufferBytes);
+	vai->bufferBytes = 0;
 	if (vai->vbo) {
 		vai->vbo->Release();
 		vai->vbo = nullptr;
@@ -298,6 +301,7 @@ VertexArrayInfoDX9::~VertexArrayInfoDX9() {
 	if (ebo) {
 		ebo->Release();
 	}
+	MemoryUsage_Add(MemoryCategory::VERTEX_CACHE, -(int64_t)bufferBytes);
 }
 
 static uint32_t SwapRB(uint32_t c) {
@@ -312,6 +316,7 @@ void DrawEngineDX9::BeginFrame() {
 
 // The inline wrapper in the header checks for numDrawCalls == 0
 void DrawEngineDX9::DoFlush() {
+	GPUStatsTimer timer(&gpuStats.msFlushing);
 	gpuStats.numFlushes++;
 	gpuStats.numTrackedVertexArrays = (int)vai_.size();
 
@@ -430,6 +435,7 @@ void DrawEngineDX9::DoFlush() {
 						vai->vbo->Lock(0, size, &pVb, 0);
 						memcpy(pVb, decoded, size);
 						vai->vbo->Unlock();
+						vai->bufferBytes = size;
 						if (useElements) {
 							void * pIb;
 							u32 size = sizeof(short) * indexGen.VertexCount();
@@ -437,9 +443,11 @@ void DrawEngineDX9::DoFlush() {
 							vai->ebo->Lock(0, size, &pIb, 0);
 							memcpy(pIb, decIndex, size);
 							vai->ebo->Unlock();
+							vai->bufferBytes += size;
 						} else {
 							vai->ebo = 0;
 						}
+						MemoryUsage_Add(MemoryCategory::VERTEX_CACHE, vai->bufferBytes);
 					} else {
 						gpuStats.numCachedDrawCalls++;
 						useElements = vai->ebo ? true : false;
@@ -561,6 +569,8 @@ void DrawEngineDX9::DoFlush() {
 		params.provokeFlatFirst = true;
 		params.flippedY = false;
 		params.usesHalfZ = true;
+		params.materialColors = materialColorRanges_;
+		params.numMaterialColors = numMaterialColorRanges_;
 
 		// We need correct viewport values in gstate_c already.
 		if (gstate_c.IsDirty(DIRTY_VIEWPORTSCISSOR_STATE)) {
@@ -66,6 +66,7 @@ class VertexArrayInfoDX9 {
 		numVerts = 0;
 		drawsUntilNextFullHash = 0;
 		flags = 0;
+		bufferBytes = 0;
 	}
 	~VertexArrayInfoDX9();
 
@@ -94,6 +95,8 @@ class VertexArrayInfoDX9 {
 	int lastFrame;  // So that we can forget.
 	u16 drawsUntilNextFullHash;
 	u8 flags;
+	// Size of vbo and ebo, for memory usage stats.
+	u32 bufferBytes;
 };
 
 class TessellationDataTransferDX9 : public TessellationDataTransfer {
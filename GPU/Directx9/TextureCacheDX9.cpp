@@ -147,6 +147,7 @@ void TextureCacheDX9::StartFrame() {
 	} else {
 		Decimate();
 	}
+	StartHashVerification();
 
 	if (gstate_c.Supports(GPU_SUPPORTS_ANISOTROPY)) {
 		DWORD aniso = 1 << g_Config.iAnisotropyLevel;
@@ -394,7 +395,7 @@ void TextureCacheDX9::BuildTexture(TexCacheEntry *const entry) {
 	entry->status &= ~TexCacheEntry::STATUS_ALPHA_MASK;
 
 	// For the estimate, we assume cluts always point to 8888 for simplicity.
-	cacheSizeEstimate_ += EstimateTexMemoryUsage(entry);
+	SetTexMemoryUsage(entry, EstimateTexMemoryUsage(entry));
 
 	if ((entry->bufw == 0 || (gstate.texbufwidth[0] & 0xf800) != 0) && entry->addr >= PSP_GetKernelMemoryEnd()) {
 		ERROR_LOG_REPORT(G3D, "Texture with unexpected bufw (full=%d)", gstate.texbufwidth[0] & 0xffff);
@@ -469,6 +470,7 @@ void TextureCacheDX9::BuildTexture(TexCacheEntry *const entry) {
 			texelsScaledThisFrame_ += w * h;
 		}
 	}
+	SetTexMemoryUsage(entry, replaced, scaleFactor);
 
 	// Seems to cause problems in Tactics Ogre.
 	if (badMipSizes) {
@@ -66,6 +66,8 @@ DrawEngineGLES::DrawEngineGLES(Draw::DrawContext *draw) : inputLayoutMap_(16), d
 
 	decOptions_.expandAllWeightsToFloat = false;
 	decOptions_.expand8BitNormalsToFloat = false;
+	// The extra morph target attributes use explicit locations, and need 16 in total (GLES 2 only guarantees 8.)
+	morphInShaderSupported_ = gl_extensions.IsGLES ? gl_extensions.GLES3 : gl_extensions.VersionGEThan(3, 3);
 
 	// Allocate nicely aligned memory. Maybe graphics drivers will
 	// appreciate it.
@@ -218,6 +220,18 @@ GLRInputLayout *DrawEngineGLES::SetupDecFmtForDraw(LinkedShader *program, const
 	VertexAttribSetup(ATTR_COLOR1, decFmt.c1fmt, decFmt.stride, decFmt.c1off, entries);
 	VertexAttribSetup(ATTR_NORMAL, decFmt.nrmfmt, decFmt.stride, decFmt.nrmoff, entries);
 	VertexAttribSetup(ATTR_POSITION, decFmt.posfmt, decFmt.stride, decFmt.posoff, entries);
+	// Unblended morph targets follow, in the order the vertex shader generator expects.
+	int attrib = ATTR_MORPH;
+	for (int n = 1; n < decFmt.morphcount; n++) {
+		const int base = n * decFmt.morphStride;
+		VertexAttribSetup(attrib++, decFmt.posfmt, decFmt.stride, base + decFmt.posoff, entries);
+		if (decFmt.nrmfmt)
+			VertexAttribSetup(attrib++, decFmt.nrmfmt, decFmt.stride, base + decFmt.nrmoff, entries);
+		if (decFmt.uvfmt)
+			VertexAttribSetup(attrib++, decFmt.uvfmt, decFmt.stride, base + decFmt.uvoff, entries);
+		if (decFmt.c0fmt)
+			VertexAttribSetup(attrib++, decFmt.c0fmt, decFmt.stride, base + decFmt.c0off, entries);
+	}
 
 	inputLayout = render_->CreateInputLayout(entries);
 	inputLayoutMap_.Insert(key, inputLayout);
@@ -230,7 +244,7 @@ void *DrawEngineGLES::DecodeVertsToPushBuffer(GLPushBuffer *push, uint32_t *bind
 	// Figure out how much pushbuffer space we need to allocate.
 	if (push) {
 		int vertsToDecode = ComputeNumVertsToDecode();
-		dest = (u8 *)push->Push(vertsToDecode * dec_->GetDecVtxFmt().stride, bindOffset, buf);
+		dest = (u8 *)push->Push(vertsToDecode * DecodedVertexStride(), bindOffset, buf);
 	}
 	DecodeVerts(dest);
 	return dest;
@@ -238,6 +252,7 @@ void *DrawEngineGLES::DecodeVertsToPushBuffer(GLPushBuffer *push, uint32_t *bind
 
 void DrawEngineGLES::DoFlush() {
 	PROFILE_THIS_SCOPE("flush");
+	GPUStatsTimer timer(&gpuStats.msFlushing);
 
 	FrameData &frameData = frameData_[render_->GetCurFrame()];
 	
@@ -266,8 +281,16 @@ void DrawEngineGLES::DoFlush() {
 
 	GEPrimitiveType prim = prevPrim_;
 
+	// The vertex shader ID depends on whether it blends the morph targets.
+	const bool canUseHWTransform = CanUseHardwareTransform(prim);
+	const DecVtxFormat *morphFmt = PrepareMorphForDraws(canUseHWTransform);
+
 	VShaderID vsid;
-	Shader *vshader = shaderManager_->ApplyVertexShader(CanUseHardwareTransform(prim), useHWTessellation_, lastVType_, decOptions_.expandAllWeightsToFloat, &vsid);
+	Shader *vshader = shaderManager_->ApplyVertexShader(canUseHWTransform, useHWTessellation_, lastVType_, decOptions_.expandAllWeightsToFloat, &vsid);
+	if (morphFmt && !vshader->UseHWTransform()) {
+		// Fell back to software transform, so blend while decoding after all.
+		morphFmt = PrepareMorphForDraws(false);
+	}
 
 	GLRBuffer *vertexBuffer = nullptr;
 	GLRBuffer *indexBuffer = nullptr;
@@ -317,7 +340,7 @@ void DrawEngineGLES::DoFlush() {
 		ApplyDrawStateLate(false, 0);
 		
 		LinkedShader *program = shaderManager_->ApplyFragmentShader(vsid, vshader, lastVType_, framebufferManager_->UseBufferedRendering());
-		GLRInputLayout *inputLayout = SetupDecFmtForDraw(program, dec_->GetDecVtxFmt());
+		GLRInputLayout *inputLayout = SetupDecFmtForDraw(program, morphFmt ? *morphFmt : dec_->GetDecVtxFmt());
 		render_->BindVertexBuffer(inputLayout, vertexBuffer, vertexBufferOffset);
 		if (useElements) {
 			if (!indexBuffer) {
@@ -359,6 +382,8 @@ void DrawEngineGLES::DoFlush() {
 		params.provokeFlatFirst = false;
 		params.flippedY = framebufferManager_->UseBufferedRendering();
 		params.usesHalfZ = false;
+		params.materialColors = materialColorRanges_;
+		params.numMaterialColors = numMaterialColorRanges_;
 
 		// We need correct viewport values in gstate_c already.
 		if (gstate_c.IsDirty(DIRTY_VIEWPORTSCISSOR_STATE)) {
@@ -452,6 +477,7 @@ void DrawEngineGLES::DoFlush() {
 
 	indexGen.Reset();
 	decodedVerts_ = 0;
+	decodeMorphTargets_ = false;
 	numDrawCalls = 0;
 	vertexCountInDrawCalls_ = 0;
 	decodeCounter_ = 0;
@@ -520,9 +546,12 @@ void TessellationDataTransferGLES::SendDataToShader(const SimpleVertex *const *p
 			data_tex[1] = renderManager_->CreateTexture(GL_TEXTURE_2D, weights.size_u * 2, 1, 1);
 		renderManager_->TextureImage(data_tex[1], 0, weights.size_u * 2, 1, Draw::DataFormat::R32G32B32A32_FLOAT, nullptr, GLRAllocType::NONE, false);
 		renderManager_->FinalizeTexture(data_tex[1], 0, false);
+		InvalidateWeights(0);
 	}
 	renderManager_->BindTexture(TEX_SLOT_SPLINE_WEIGHTS_U, data_tex[1]);
-	renderManager_->TextureSubImage(data_tex[1], 0, 0, 0, weights.size_u * 2, 1, Draw::DataFormat::R32G32B32A32_FLOAT, (u8 *)weights.u, GLRAllocType::NONE);
+	// Skip the upload if the tessellation level is the same as last time.
+	if (WeightsChanged(0, weights.u))
+		renderManager_->TextureSubImage(data_tex[1], 0, 0, 0, weights.size_u * 2, 1, Draw::DataFormat::R32G32B32A32_FLOAT, (u8 *)weights.u, GLRAllocType::NONE);
 
 	// Weight V
 	if (prevSizeWV < weights.size_v) {
@@ -531,9 +560,11 @@ void TessellationDataTransferGLES::SendDataToShader(const SimpleVertex *const *p
 			data_tex[2] = renderManager_->CreateTexture(GL_TEXTURE_2D, weights.size_v * 2, 1, 1);
 		renderManager_->TextureImage(data_tex[2], 0, weights.size_v * 2, 1, Draw::DataFormat::R32G32B32A32_FLOAT, nullptr, GLRAllocType::NONE, false);
 		renderManager_->FinalizeTexture(data_tex[2], 0, false);
+		InvalidateWeights(1);
 	}
 	renderManager_->BindTexture(TEX_SLOT_SPLINE_WEIGHTS_V, data_tex[2]);
-	renderManager_->TextureSubImage(data_tex[2], 0, 0, 0, weights.size_v * 2, 1, Draw::DataFormat::R32G32B32A32_FLOAT, (u8 *)weights.v, GLRAllocType::NONE);
+	if (WeightsChanged(1, weights.v))
+		renderManager_->TextureSubImage(data_tex[2], 0, 0, 0, weights.size_v * 2, 1, Draw::DataFormat::R32G32B32A32_FLOAT, (u8 *)weights.v, GLRAllocType::NONE);
 }
 
 void TessellationDataTransferGLES::EndFrame() {
@@ -544,4 +575,6 @@ void TessellationDataTransferGLES::EndFrame() {
 		}
 	}
 	prevSizeU = prevSizeV = prevSizeWU = prevSizeWV = 0;
+	InvalidateWeights(0);
+	InvalidateWeights(1);
 }
@@ -148,6 +148,10 @@ void FramebufferManagerGLES::DestroyDeviceObjects() {
 		render_->DeleteProgram(stencilUploadProgram_);
 		stencilUploadProgram_ = nullptr;
 	}
+	if (stencilExportProgram_) {
+		render_->DeleteProgram(stencilExportProgram_);
+		stencilExportProgram_ = nullptr;
+	}
 	if (depthDownloadProgram_) {
 		render_->DeleteProgram(depthDownloadProgram_);
 		depthDownloadProgram_ = nullptr;
@@ -79,6 +79,9 @@ class FramebufferManagerGLES : public FramebufferManagerCommon {
 	GLRProgram *stencilUploadProgram_ = nullptr;
 	int u_stencilUploadTex = -1;
 	int u_stencilValue = -1;
+	// Only with GL_ARB_shader_stencil_export, writes all stencil bits in one pass.
+	GLRProgram *stencilExportProgram_ = nullptr;
+	int u_stencilExportTex = -1;
 
 	GLRProgram *depthDownloadProgram_ = nullptr;
 	int u_depthDownloadTex = -1;
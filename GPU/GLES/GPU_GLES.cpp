@@ -106,6 +106,7 @@ GPU_GLES::GPU_GLES(GraphicsContext *gfxCtx, Draw::DrawContext *draw)
 		if (g_Config.bShaderCache) {
 			File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
 			shaderCachePath_ = GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + ".glshadercache");
+			SeedShaderCache(shaderCachePath_);
 			// Actually precompiled by IsReady() since we're single-threaded.
 			shaderManagerGL_->Load(shaderCachePath_);
 		} else {
@@ -362,6 +363,7 @@ void GPU_GLES::BeginHostFrame() {
 }
 
 void GPU_GLES::EndHostFrame() {
+	GPUCommon::EndHostFrame();
 	drawEngine_.EndFrame();
 }
 
@@ -71,7 +71,7 @@ Shader::~Shader() {
 	render_->DeleteShader(shader);
 }
 
-LinkedShader::LinkedShader(GLRenderManager *render, VShaderID VSID, Shader *vs, FShaderID FSID, Shader *fs, bool useHWTransform, bool preloading)
+LinkedShader::LinkedShader(GLRenderManager *render, VShaderID VSID, Shader *vs, FShaderID FSID, Shader *fs, bool useHWTransform, bool preloading, const GLRProgramBinary *binary)
 		: render_(render), useHWTransform_(useHWTransform) {
 	PROFILE_THIS_SCOPE("shaderlink");
 
@@ -148,6 +148,8 @@ LinkedShader::LinkedShader(GLRenderManager *render, VShaderID VSID, Shader *vs,
 	queries.push_back({ &u_uvscaleoffset, "u_uvscaleoffset" });
 	queries.push_back({ &u_texclamp, "u_texclamp" });
 	queries.push_back({ &u_texclampoff, "u_texclampoff" });
+	queries.push_back({ &u_morphweights0, "u_morphweights0" });
+	queries.push_back({ &u_morphweights1, "u_morphweights1" });
 
 	for (int i = 0; i < 4; i++) {
 		static const char * const lightPosNames[4] = { "u_lightpos0", "u_lightpos1", "u_lightpos2", "u_lightpos3", };
@@ -189,7 +191,7 @@ LinkedShader::LinkedShader(GLRenderManager *render, VShaderID VSID, Shader *vs,
 
 	bool useDualSource = (gstate_c.featureFlags & GPU_SUPPORTS_DUALSOURCE_BLEND) != 0;
 	bool useClip0 = VSID.Bit(VS_BIT_VERTEX_RANGE_CULLING) && gstate_c.Supports(GPU_SUPPORTS_CLIP_DISTANCE);
-	program = render->CreateProgram(shaders, semantics, queries, initialize, useDualSource, useClip0);
+	program = render->CreateProgram(shaders, semantics, queries, initialize, useDualSource, useClip0, binary, render->SupportsProgramBinary());
 
 	// The rest, use the "dirty" mechanism.
 	dirtyUniforms = DIRTY_ALL_UNIFORMS;
@@ -458,6 +460,11 @@ void LinkedShader::UpdateUniforms(u32 vertType, const ShaderID &vsid, bool useBu
 		}
 	}
 
+	if (dirty & DIRTY_MORPHWEIGHTS) {
+		render_->SetUniformF(&u_morphweights0, 4, &gstate_c.morphWeights[0]);
+		render_->SetUniformF(&u_morphweights1, 4, &gstate_c.morphWeights[4]);
+	}
+
 	// Transform
 	if (dirty & DIRTY_WORLDMATRIX) {
 		SetMatrix4x3(render_, &u_world, gstate.worldMatrix);
@@ -760,6 +767,8 @@ LinkedShader *ShaderManagerGLES::ApplyFragmentShader(VShaderID VSID, Shader *vs,
 
 		// Check if we can link these.
 		ls = new LinkedShader(render_, VSID, vs, FSID, fs, vs->UseHWTransform());
+		gpuStats.numPipelinesCreated++;
+		Reporting::NotePerfEvent(Reporting::PerfEvent::PIPELINE_CREATED);
 		ls->use(VSID);
 		const LinkedShaderCacheEntry entry(vs, fs, ls);
 		linkedShaderCache_.push_back(entry);
@@ -911,6 +920,8 @@ void ShaderManagerGLES::Load(const Path &filename) {
 		diskCachePending_.link.push_back(std::make_pair(vsid, fsid));
 	}
 
+	LoadProgramBinaries(filename.WithExtraExtension(".bin"));
+
 	// Actual compilation happens in ContinuePrecompile(), called by GPU_GLES's IsReady.
 	NOTICE_LOG(G3D, "Precompiling the shader cache from '%s'", filename.c_str());
 	diskCacheDirty_ = false;
@@ -983,7 +994,10 @@ bool ShaderManagerGLES::ContinuePrecompile(float sliceTime) {
 		Shader *vs = vsCache_.Get(vsid);
 		Shader *fs = fsCache_.Get(fsid);
 		if (vs && fs) {
-			LinkedShader *ls = new LinkedShader(render_, vsid, vs, fsid, fs, vs->UseHWTransform(), true);
+			auto binary = diskCacheBinaries_.find(pending.link[i]);
+			const GLRProgramBinary *programBinary = binary != diskCacheBinaries_.end() ? &binary->second : nullptr;
+			LinkedShader *ls = new LinkedShader(render_, vsid, vs, fsid, fs, vs->UseHWTransform(), true, programBinary);
+			gpuStats.numPipelinesCreated++;
 			LinkedShaderCacheEntry entry(vs, fs, ls);
 			linkedShaderCache_.push_back(entry);
 		}
@@ -994,12 +1008,14 @@ bool ShaderManagerGLES::ContinuePrecompile(float sliceTime) {
 
 	NOTICE_LOG(G3D, "Precompile: Compiled and linked %d programs (%d vertex, %d fragment) in %0.1f milliseconds", (int)pending.link.size(), (int)pending.vert.size(), (int)pending.frag.size(), 1000 * (finish - pending.start));
 	pending.Clear();
+	diskCacheBinaries_.clear();
 
 	return true;
 }
 
 void ShaderManagerGLES::CancelPrecompile() {
 	diskCachePending_.Clear();
+	diskCacheBinaries_.clear();
 }
 
 void ShaderManagerGLES::Save(const Path &filename) {
@@ -1045,5 +1061,135 @@ void ShaderManagerGLES::Save(const Path &filename) {
 		fwrite(&fsid, 1, sizeof(fsid), f);
 	}
 	fclose(f);
+
+	SaveProgramBinaries(filename.WithExtraExtension(".bin"));
 	diskCacheDirty_ = false;
 }
+
+// Program binaries live in a separate file next to the ID cache.  They're only valid for the exact
+// driver that produced them, so the vendor/renderer/version strings are stored and compared on load.
+// If the driver rejects a binary anyway, the program is simply linked from source.
+
+#define BINARY_CACHE_HEADER_MAGIC 0x42474c50
+#define BINARY_CACHE_VERSION 1
+struct BinaryCacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t featureFlags;
+	uint32_t driverLength;
+	uint32_t numPrograms;
+};
+
+struct BinaryCacheEntry {
+	ShaderID vsid;
+	ShaderID fsid;
+	uint32_t format;
+	uint32_t size;
+};
+
+std::string ShaderManagerGLES::DriverString() const {
+	return render_->GetGLString(GL_VENDOR) + "|" + render_->GetGLString(GL_RENDERER) + "|" + render_->GetGLString(GL_VERSION);
+}
+
+void ShaderManagerGLES::LoadProgramBinaries(const Path &filename) {
+	diskCacheBinaries_.clear();
+	if (!render_->SupportsProgramBinary()) {
+		return;
+	}
+
+	File::IOFile f(filename, "rb");
+	if (!f.IsOpen()) {
+		return;
+	}
+	BinaryCacheHeader header;
+	if (!f.ReadArray(&header, 1)) {
+		return;
+	}
+	if (header.magic != BINARY_CACHE_HEADER_MAGIC || header.version != BINARY_CACHE_VERSION || header.featureFlags != gstate_c.featureFlags) {
+		return;
+	}
+	if (header.driverLength > 1024 || header.numPrograms > 1000) {
+		ERROR_LOG(G3D, "Corrupt program binary cache header, ignoring.");
+		return;
+	}
+
+	std::string driver;
+	driver.resize(header.driverLength);
+	if (header.driverLength != 0 && !f.ReadArray(&driver[0], header.driverLength)) {
+		return;
+	}
+	if (driver != DriverString()) {
+		NOTICE_LOG(G3D, "GL driver changed, discarding cached program binaries");
+		return;
+	}
+
+	for (uint32_t i = 0; i < header.numPrograms; i++) {
+		BinaryCacheEntry entry;
+		if (!f.ReadArray(&entry, 1)) {
+			break;
+		}
+		// No real program binary is anywhere close to this.
+		if (entry.size == 0 || entry.size > 16 * 1024 * 1024) {
+			ERROR_LOG(G3D, "Corrupt program binary cache entry, ignoring the rest.");
+			break;
+		}
+		auto key = std::make_pair(VShaderID(entry.vsid), FShaderID(entry.fsid));
+		GLRProgramBinary &binary = diskCacheBinaries_[key];
+		binary.format = entry.format;
+		binary.data.resize(entry.size);
+		if (!f.ReadArray(&binary.data[0], entry.size)) {
+			diskCacheBinaries_.erase(key);
+			break;
+		}
+	}
+
+	INFO_LOG(G3D, "Loaded %d program binaries from '%s'", (int)diskCacheBinaries_.size(), filename.c_str());
+}
+
+void ShaderManagerGLES::SaveProgramBinaries(const Path &filename) {
+	if (!render_->SupportsProgramBinary()) {
+		return;
+	}
+
+	std::vector<std::pair<BinaryCacheEntry, GLRProgramBinary>> programs;
+	for (auto iter : linkedShaderCache_) {
+		GLRProgramBinary binary;
+		if (!render_->GetProgramBinary(iter.ls->program, &binary)) {
+			continue;
+		}
+		BinaryCacheEntry entry;
+		vsCache_.Iterate([&](const ShaderID &id, Shader *shader) {
+			if (iter.vs == shader)
+				entry.vsid = id;
+		});
+		fsCache_.Iterate([&](const ShaderID &id, Shader *shader) {
+			if (iter.fs == shader)
+				entry.fsid = id;
+		});
+		entry.format = binary.format;
+		entry.size = (uint32_t)binary.data.size();
+		programs.push_back(std::make_pair(entry, std::move(binary)));
+	}
+	if (programs.empty()) {
+		return;
+	}
+
+	FILE *f = File::OpenCFile(filename, "wb");
+	if (!f) {
+		return;
+	}
+	std::string driver = DriverString();
+	BinaryCacheHeader header;
+	header.magic = BINARY_CACHE_HEADER_MAGIC;
+	header.version = BINARY_CACHE_VERSION;
+	header.featureFlags = gstate_c.featureFlags;
+	header.driverLength = (uint32_t)driver.size();
+	header.numPrograms = (uint32_t)programs.size();
+	fwrite(&header, 1, sizeof(header), f);
+	fwrite(driver.data(), 1, driver.size(), f);
+	for (const auto &program : programs) {
+		fwrite(&program.first, 1, sizeof(program.first), f);
+		fwrite(program.second.data.data(), 1, program.second.data.size(), f);
+	}
+	fclose(f);
+}
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <map>
 #include <vector>
 
 #include "Common/Data/Collections/Hashmaps.h"
@@ -31,7 +32,7 @@ class Shader;
 
 class LinkedShader {
 public:
-	LinkedShader(GLRenderManager *render, VShaderID VSID, Shader *vs, FShaderID FSID, Shader *fs, bool useHWTransform, bool preloading = false);
+	LinkedShader(GLRenderManager *render, VShaderID VSID, Shader *vs, FShaderID FSID, Shader *fs, bool useHWTransform, bool preloading = false, const GLRProgramBinary *binary = nullptr);
 	~LinkedShader();
 
 	void use(const ShaderID &VSID);
@@ -92,6 +93,10 @@ class LinkedShader {
 	int u_texclamp;
 	int u_texclampoff;
 
+	// Morphing
+	int u_morphweights0;
+	int u_morphweights1;
+
 	// Lighting
 	int u_ambient;
 	int u_matambientalpha;
@@ -178,6 +183,9 @@ class ShaderManagerGLES : public ShaderManagerCommon {
 
 private:
 	void Clear();
+	void LoadProgramBinaries(const Path &filename);
+	void SaveProgramBinaries(const Path &filename);
+	std::string DriverString() const;
 	Shader *CompileFragmentShader(FShaderID id);
 	Shader *CompileVertexShader(VShaderID id);
 
@@ -233,4 +241,6 @@ class ShaderManagerGLES : public ShaderManagerCommon {
 			return vertPos >= vert.size() && fragPos >= frag.size() && linkPos >= link.size();
 		}
 	} diskCachePending_;
+	// Driver program binaries read alongside the ID cache, consumed when the pending links are created.
+	std::map<std::pair<VShaderID, FShaderID>, GLRProgramBinary> diskCacheBinaries_;
 };
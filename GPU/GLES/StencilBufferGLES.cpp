@@ -51,6 +51,20 @@ void main() {
 }
 )";
 
+// Only used on desktop core contexts, where the prelude adds a #version. The pixel texture already
+// has alpha expanded to 8 bits, so this matches what the bit loop writes for every format.
+static const char *stencil_export_fs = R"(
+#extension GL_ARB_shader_stencil_export : require
+in vec2 v_texcoord0;
+out vec4 fragColor0;
+uniform sampler2D tex;
+void main() {
+  vec4 index = texture(tex, v_texcoord0);
+  fragColor0 = vec4(index.a);
+  gl_FragStencilRefARB = int(floor(index.a * 255.99));
+}
+)";
+
 static const char *stencil_vs = R"(
 #ifdef GL_ES
 precision highp float;
@@ -154,6 +168,22 @@ bool FramebufferManagerGLES::NotifyStencilUpload(u32 addr, int size, StencilUplo
 		if (!stencilUploadProgram_) {
 			ERROR_LOG_REPORT(G3D, "Failed to compile stencilUploadProgram! This shouldn't happen.\n%s", errorString.c_str());
 		}
+
+		if (gl_extensions.ARB_shader_stencil_export && !gl_extensions.IsGLES && gl_extensions.IsCoreContext) {
+			static std::string export_fs_code;
+			export_fs_code = ApplyGLSLPrelude(stencil_export_fs, GL_FRAGMENT_SHADER);
+			std::vector<GLRShader *> exportShaders;
+			exportShaders.push_back(render_->CreateShader(GL_VERTEX_SHADER, vs_code, "stencil"));
+			exportShaders.push_back(render_->CreateShader(GL_FRAGMENT_SHADER, export_fs_code, "stencil_export"));
+			std::vector<GLRProgram::UniformLocQuery> exportQueries;
+			exportQueries.push_back({ &u_stencilExportTex, "tex" });
+			std::vector<GLRProgram::Initializer> exportInits;
+			exportInits.push_back({ &u_stencilExportTex, 0, TEX_SLOT_PSP_TEXTURE });
+			stencilExportProgram_ = render_->CreateProgram(exportShaders, semantics, exportQueries, exportInits, false, false);
+			for (auto iter : exportShaders) {
+				render_->DeleteShader(iter);
+			}
+		}
 	}
 
 	shaderManager_->DirtyLastShader();
@@ -192,25 +222,32 @@ bool FramebufferManagerGLES::NotifyStencilUpload(u32 addr, int size, StencilUplo
 	render_->Clear(0, 0, 0, GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, 0x8, 0, 0, 0, 0);
 	render_->SetStencilFunc(GL_TRUE, GL_ALWAYS, 0xFF, 0xFF);
 	render_->SetRaster(false, GL_CCW, GL_FRONT, GL_FALSE, GL_FALSE);
-	render_->BindProgram(stencilUploadProgram_);
 	render_->SetNoBlendAndMask(0x8);
 
-	for (int i = 1; i < values; i += i) {
-		if (!(usedBits & i)) {
-			// It's already zero, let's skip it.
-			continue;
-		}
-		if (dstBuffer->format == GE_FORMAT_4444) {
-			render_->SetStencilOp((i << 4) | i, GL_REPLACE, GL_REPLACE, GL_REPLACE);
-			render_->SetUniformF1(&u_stencilValue, i * (16.0f / 255.0f));
-		} else if (dstBuffer->format == GE_FORMAT_5551) {
-			render_->SetStencilOp(0xFF, GL_REPLACE, GL_REPLACE, GL_REPLACE);
-			render_->SetUniformF1(&u_stencilValue, i * (128.0f / 255.0f));
-		} else {
-			render_->SetStencilOp(i, GL_REPLACE, GL_REPLACE, GL_REPLACE);
-			render_->SetUniformF1(&u_stencilValue, i * (1.0f / 255.0f));
-		}
+	if (stencilExportProgram_) {
+		// The shader provides the reference value, so a single draw writes all the bits.
+		render_->BindProgram(stencilExportProgram_);
+		render_->SetStencilOp(0xFF, GL_REPLACE, GL_REPLACE, GL_REPLACE);
 		DrawActiveTexture(0, 0, dstBuffer->width, dstBuffer->height, dstBuffer->bufferWidth, dstBuffer->bufferHeight, 0.0f, 0.0f, u1, v1, ROTATION_LOCKED_HORIZONTAL, DRAWTEX_NEAREST | DRAWTEX_KEEP_STENCIL_ALPHA);
+	} else {
+		render_->BindProgram(stencilUploadProgram_);
+		for (int i = 1; i < values; i += i) {
+			if (!(usedBits & i)) {
+				// It's already zero, let's skip it.
+				continue;
+			}
+			if (dstBuffer->format == GE_FORMAT_4444) {
+				render_->SetStencilOp((i << 4) | i, GL_REPLACE, GL_REPLACE, GL_REPLACE);
+				render_->SetUniformF1(&u_stencilValue, i * (16.0f / 255.0f));
+			} else if (dstBuffer->format == GE_FORMAT_5551) {
+				render_->SetStencilOp(0xFF, GL_REPLACE, GL_REPLACE, GL_REPLACE);
+				render_->SetUniformF1(&u_stencilValue, i * (128.0f / 255.0f));
+			} else {
+				render_->SetStencilOp(i, GL_REPLACE, GL_REPLACE, GL_REPLACE);
+				render_->SetUniformF1(&u_stencilValue, i * (1.0f / 255.0f));
+			}
+			DrawActiveTexture(0, 0, dstBuffer->width, dstBuffer->height, dstBuffer->bufferWidth, dstBuffer->bufferHeight, 0.0f, 0.0f, u1, v1, ROTATION_LOCKED_HORIZONTAL, DRAWTEX_NEAREST | DRAWTEX_KEEP_STENCIL_ALPHA);
+		}
 	}
 
 	if (useBlit) {
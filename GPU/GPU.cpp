@@ -20,6 +20,7 @@
 #include "Common/TimeUtil.h"
 #include "Common/GraphicsContext.h"
 #include "Core/Core.h"
+#include "Core/System.h"
 
 #include "GPU/GPU.h"
 #include "GPU/GPUInterface.h"
@@ -39,6 +40,16 @@
 #endif
 
 GPUStatistics gpuStats;
+
+GPUStatsTimer::GPUStatsTimer(double *target) : target_(coreCollectDebugStats ? target : nullptr), start_(0.0) {
+	if (target_)
+		start_ = time_now_d();
+}
+
+GPUStatsTimer::~GPUStatsTimer() {
+	if (target_)
+		*target_ += time_now_d() - start_;
+}
 GPUInterface *gpu;
 GPUDebugInterface *gpuDebug;
 
@@ -29,6 +29,8 @@ enum SkipDrawReasonFlags {
 	SKIPDRAW_NON_DISPLAYED_FB = 2,   // Skip drawing to FBO:s that have not been displayed.
 	SKIPDRAW_BAD_FB_TEXTURE = 4,
 	SKIPDRAW_WINDOW_MINIMIZED = 8, // Don't draw when the host window is minimized.
+	SKIPDRAW_TURBO_FRAME = 16,  // Turbo fast-forward frame that won't be presented, only offscreen targets matter.
+	SKIPDRAW_TURBO_DISPLAY_FB = 32,  // Set during a turbo frame while rendering to a display-only framebuffer.
 };
 
 // Global GPU-related utility functions. 
@@ -68,14 +70,22 @@ struct GPUStatistics {
 		numTexturesHashed = 0;
 		numTextureSwitches = 0;
 		numTextureDataBytesHashed = 0;
+		numTextureHashesSkipped = 0;
 		numShaderSwitches = 0;
 		numFlushes = 0;
 		numTexturesDecoded = 0;
 		numFramebufferEvaluations = 0;
 		numReadbacks = 0;
+		numAsyncReadbacks = 0;
 		numUploads = 0;
+		numMemoryCopyBytes = 0;
 		numClears = 0;
 		msProcessingDisplayLists = 0;
+		msFlushing = 0;
+		msDecodingVertices = 0;
+		msDecodingTextures = 0;
+		numShadersGenerated = 0;
+		numPipelinesCreated = 0;
 		vertexGPUCycles = 0;
 		otherGPUCycles = 0;
 		memset(gpuCommandsAtCallLevel, 0, sizeof(gpuCommandsAtCallLevel));
@@ -93,14 +103,24 @@ struct GPUStatistics {
 	int numTextureInvalidationsByFramebuffer;
 	int numTexturesHashed;
 	int numTextureDataBytesHashed;
+	int numTextureHashesSkipped;
 	int numTextureSwitches;
 	int numShaderSwitches;
 	int numTexturesDecoded;
 	int numFramebufferEvaluations;
 	int numReadbacks;
+	int numAsyncReadbacks;
 	int numUploads;
+	// Copied to or from VRAM by memcpy replacements, sceDmac and similar.
+	int numMemoryCopyBytes;
 	int numClears;
 	double msProcessingDisplayLists;
+	// Only measured when coreCollectDebugStats is set. Like msProcessingDisplayLists, these are in seconds.
+	double msFlushing;
+	double msDecodingVertices;
+	double msDecodingTextures;
+	int numShadersGenerated;
+	int numPipelinesCreated;
 	int vertexGPUCycles;
 	int otherGPUCycles;
 	int gpuCommandsAtCallLevel[4];
@@ -110,6 +130,17 @@ struct GPUStatistics {
 };
 
 extern GPUStatistics gpuStats;
+
+// Adds the time spent in its scope to one of the gpuStats timers, but only while debug stats are collected.
+class GPUStatsTimer {
+public:
+	explicit GPUStatsTimer(double *target);
+	~GPUStatsTimer();
+
+private:
+	double *target_;
+	double start_;
+};
 extern GPUInterface *gpu;
 extern GPUDebugInterface *gpuDebug;
 
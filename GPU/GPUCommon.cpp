@@ -6,10 +6,14 @@
 #include "Common/Profiler/Profiler.h"
 
 #include "Common/Data/Convert/ColorConv.h"
+#include "Common/File/FileUtil.h"
+#include "Common/File/Path.h"
+#include "Common/File/VFS/VFS.h"
 #include "Common/GraphicsContext.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
 #include "Common/Serialize/SerializeList.h"
+#include "Common/Thread/ThreadUtil.h"
 #include "Common/TimeUtil.h"
 #include "Core/Reporting.h"
 #include "GPU/GeDisasm.h"
@@ -35,6 +39,7 @@
 #include "GPU/Common/TextureCacheCommon.h"
 #include "GPU/Debugger/Debugger.h"
 #include "GPU/Debugger/Record.h"
+#include "ext/xxhash.h"
 
 const CommonCommandTableEntry commonCommandTable[] = {
 	// From Common. No flushing but definitely need execute.
@@ -415,11 +420,15 @@ GPUCommon::GPUCommon(GraphicsContext *gfxCtx, Draw::DrawContext *draw) :
 }
 
 GPUCommon::~GPUCommon() {
+	StopGeThread();
 	// Probably not necessary.
 	PPGeSetDrawContext(nullptr);
 }
 
 void GPUCommon::UpdateCmdInfo() {
+	// Recorded state runs depend on the flags.
+	stateRuns_.clear();
+
 	if (g_Config.bSoftwareSkinning) {
 		cmdInfo_[GE_CMD_VERTEXTYPE].flags &= ~FLAG_FLUSHBEFOREONCHANGE;
 		cmdInfo_[GE_CMD_VERTEXTYPE].func = &GPUCommon::Execute_VertexTypeSkinning;
@@ -428,6 +437,18 @@ void GPUCommon::UpdateCmdInfo() {
 		cmdInfo_[GE_CMD_VERTEXTYPE].func = &GPUCommon::Execute_VertexType;
 	}
 
+	for (u8 cmd : { GE_CMD_MATERIALAMBIENT, GE_CMD_MATERIALALPHA }) {
+		if (g_Config.bBatchMaterialColors) {
+			cmdInfo_[cmd].flags &= ~FLAG_FLUSHBEFOREONCHANGE;
+			cmdInfo_[cmd].flags |= FLAG_EXECUTEONCHANGE;
+			cmdInfo_[cmd].func = &GPUCommon::Execute_MaterialColorBatched;
+		} else {
+			cmdInfo_[cmd].flags |= FLAG_FLUSHBEFOREONCHANGE;
+			cmdInfo_[cmd].flags &= ~FLAG_EXECUTEONCHANGE;
+			cmdInfo_[cmd].func = nullptr;
+		}
+	}
+
 	if (g_Config.bFastMemory) {
 		cmdInfo_[GE_CMD_JUMP].func = &GPUCommon::Execute_JumpFast;
 		cmdInfo_[GE_CMD_CALL].func = &GPUCommon::Execute_CallFast;
@@ -437,6 +458,22 @@ void GPUCommon::UpdateCmdInfo() {
 	}
 }
 
+void GPUCommon::SeedShaderCache(const Path &cachePath) {
+	if (File::Exists(cachePath))
+		return;
+
+	// These are shader caches recorded by playing the game, with the same name and format as the user's own.
+	// They only load if the recorder had the same backend and GPU features, otherwise they're dropped like any stale cache.
+	std::string seedName = "shadercache/" + cachePath.GetFilename();
+	size_t size = 0;
+	uint8_t *data = VFSReadFile(seedName.c_str(), &size);
+	if (!data)
+		return;
+	if (File::WriteDataToFile(false, data, (unsigned int)size, cachePath))
+		INFO_LOG(G3D, "Seeded shader cache from %s", seedName.c_str());
+	delete[] data;
+}
+
 void GPUCommon::BeginHostFrame() {
 	UpdateVsyncInterval(resized_);
 	ReapplyGfxState();
@@ -446,7 +483,9 @@ void GPUCommon::BeginHostFrame() {
 }
 
 void GPUCommon::EndHostFrame() {
-
+	// PSP memory may go away between host frames.
+	if (textureCache_)
+		textureCache_->FinishIdleVerify();
 }
 
 void GPUCommon::Reinitialize() {
@@ -463,6 +502,7 @@ void GPUCommon::Reinitialize() {
 	busyTicks = 0;
 	timeSpentStepping_ = 0.0;
 	interruptsEnabled_ = true;
+	stateRuns_.clear();
 
 	if (textureCache_)
 		textureCache_->Clear(true);
@@ -570,6 +610,7 @@ void GPUCommon::DumpNextFrame() {
 }
 
 u32 GPUCommon::DrawSync(int mode) {
+	SyncThread();
 	if (mode < 0 || mode > 1)
 		return SCE_KERNEL_ERROR_INVALID_MODE;
 
@@ -618,6 +659,7 @@ void GPUCommon::CheckDrawSync() {
 }
 
 int GPUCommon::ListSync(int listid, int mode) {
+	SyncThread();
 	if (listid < 0 || listid >= DisplayListMaxCount)
 		return SCE_KERNEL_ERROR_INVALID_ID;
 
@@ -662,6 +704,7 @@ int GPUCommon::ListSync(int listid, int mode) {
 }
 
 int GPUCommon::GetStack(int index, u32 stackPtr) {
+	SyncThread();
 	if (!currentList) {
 		// Seems like it doesn't return an error code?
 		return 0;
@@ -687,6 +730,8 @@ int GPUCommon::GetStack(int index, u32 stackPtr) {
 }
 
 u32 GPUCommon::EnqueueList(u32 listpc, u32 stall, int subIntrBase, PSPPointer<PspGeListArgs> args, bool head) {
+	SyncThread();
+
 	// TODO Check the stack values in missing arg and ajust the stack depth
 
 	// Check alignment
@@ -801,6 +846,7 @@ u32 GPUCommon::EnqueueList(u32 listpc, u32 stall, int subIntrBase, PSPPointer<Ps
 }
 
 u32 GPUCommon::DequeueList(int listid) {
+	SyncThread();
 	if (listid < 0 || listid >= DisplayListMaxCount || dls[listid].state == PSP_GE_DL_STATE_NONE)
 		return SCE_KERNEL_ERROR_INVALID_ID;
 
@@ -824,6 +870,7 @@ u32 GPUCommon::DequeueList(int listid) {
 }
 
 u32 GPUCommon::UpdateStall(int listid, u32 newstall) {
+	SyncThread();
 	if (listid < 0 || listid >= DisplayListMaxCount || dls[listid].state == PSP_GE_DL_STATE_NONE)
 		return SCE_KERNEL_ERROR_INVALID_ID;
 	auto &dl = dls[listid];
@@ -838,6 +885,7 @@ u32 GPUCommon::UpdateStall(int listid, u32 newstall) {
 }
 
 u32 GPUCommon::Continue() {
+	SyncThread();
 	if (!currentList)
 		return 0;
 
@@ -878,6 +926,7 @@ u32 GPUCommon::Continue() {
 }
 
 u32 GPUCommon::Break(int mode) {
+	SyncThread();
 	if (mode < 0 || mode > 1)
 		return SCE_KERNEL_ERROR_INVALID_MODE;
 
@@ -990,7 +1039,8 @@ bool GPUCommon::InterpretList(DisplayList &list) {
 	gpuState = list.pc == list.stall ? GPUSTATE_STALL : GPUSTATE_RUNNING;
 
 	debugRecording_ = GPURecord::IsActive();
-	const bool useDebugger = GPUDebug::IsActive() || debugRecording_;
+	// If the debugger was enabled while the GE thread was busy, it takes over from the next list.
+	const bool useDebugger = !onGeThread_ && (GPUDebug::IsActive() || debugRecording_);
 	const bool useFastRunLoop = !dumpThisFrame_ && !useDebugger;
 	while (gpuState == GPUSTATE_RUNNING) {
 		{
@@ -1028,7 +1078,9 @@ bool GPUCommon::InterpretList(DisplayList &list) {
 	if (coreCollectDebugStats) {
 		double total = time_now_d() - start - timeSpentStepping_;
 		_dbg_assert_msg_(total >= 0.0, "Time spent DL processing became negative");
-		hleSetSteppingTime(timeSpentStepping_);
+		// The debugger never runs on the GE thread, so there's no stepping time to report from it.
+		if (!onGeThread_)
+			hleSetSteppingTime(timeSpentStepping_);
 		timeSpentStepping_ = 0.0;
 		gpuStats.msProcessingDisplayLists += total;
 	}
@@ -1039,8 +1091,20 @@ bool GPUCommon::InterpretList(DisplayList &list) {
 void GPUCommon::FastRunLoop(DisplayList &list) {
 	PROFILE_THIS_SCOPE("gpuloop");
 	const CommandInfo *cmdInfo = cmdInfo_;
+	const bool useStateRuns = g_Config.bDisplayListCache;
+	// Lists and sublists tend to start with the same state setup every frame, so check for a run after each branch.
+	bool atBranchTarget = useStateRuns;
 	int dc = downcount;
 	for (; dc > 0; --dc) {
+		if (atBranchTarget) {
+			atBranchTarget = false;
+			int count = ReplayStateRun(list.pc, dc);
+			list.pc += count * 4;
+			dc -= count;
+			if (dc <= 0)
+				break;
+		}
+
 		// We know that display list PCs have the upper nibble == 0 - no need to mask the pointer
 		const u32 op = *(const u32_le *)(Memory::base + list.pc);
 		const u32 cmd = op >> 24;
@@ -1051,6 +1115,7 @@ void GPUCommon::FastRunLoop(DisplayList &list) {
 				downcount = dc;
 				(this->*info.func)(op, diff);
 				dc = downcount;
+				atBranchTarget = useStateRuns && (info.flags & FLAG_WRITES_PC) != 0;
 			}
 		} else {
 			uint64_t flags = info.flags;
@@ -1064,6 +1129,7 @@ void GPUCommon::FastRunLoop(DisplayList &list) {
 				downcount = dc;
 				(this->*info.func)(op, diff);
 				dc = downcount;
+				atBranchTarget = useStateRuns && (flags & FLAG_WRITES_PC) != 0;
 			} else {
 				uint64_t dirty = flags >> 8;
 				if (dirty)
@@ -1075,6 +1141,79 @@ void GPUCommon::FastRunLoop(DisplayList &list) {
 	downcount = 0;
 }
 
+// Commands that only set state, so within a run of them just the last value of each matters.
+static inline bool IsPlainStateCommand(uint64_t flags) {
+	return (flags & (FLAG_FLUSHBEFORE | FLAG_EXECUTE | FLAG_EXECUTEONCHANGE | FLAG_READS_PC | FLAG_WRITES_PC)) == 0;
+}
+
+const GPUCommon::StateRun &GPUCommon::RecordStateRun(u32 pc, int maxCount) {
+	// Anything past this just runs through the normal loop.
+	static const int MAX_STATE_RUN = 512;
+	if (stateRuns_.size() > 4096)
+		stateRuns_.clear();
+
+	StateRun &run = stateRuns_[pc];
+	run.ops.clear();
+	int count = 0;
+	u8 seen[256]{};
+	const int limit = std::min(maxCount, MAX_STATE_RUN);
+	while (count < limit && Memory::IsValidAddress(pc + count * 4)) {
+		const u32 op = *(const u32_le *)(Memory::base + pc + count * 4);
+		const u32 cmd = op >> 24;
+		if (!IsPlainStateCommand(cmdInfo_[cmd].flags))
+			break;
+		if (seen[cmd]) {
+			for (u32 &prev : run.ops) {
+				if ((prev >> 24) == cmd)
+					prev = op;
+			}
+		} else {
+			seen[cmd] = 1;
+			run.ops.push_back(op);
+		}
+		count++;
+	}
+
+	run.count = count;
+	run.hash = XXH3_64bits(Memory::base + pc, count * 4);
+	return run;
+}
+
+// Applies a recorded state run at pc, if it still matches memory. Returns the number of commands it covered.
+int GPUCommon::ReplayStateRun(u32 pc, int maxCount) {
+	// Shorter runs aren't worth the hash.
+	static const int MIN_STATE_RUN = 8;
+
+	auto it = stateRuns_.find(pc);
+	const StateRun *run;
+	if (it == stateRuns_.end()) {
+		run = &RecordStateRun(pc, maxCount);
+	} else {
+		run = &it->second;
+		if (run->count > maxCount || XXH3_64bits(Memory::base + pc, run->count * 4) != run->hash)
+			run = &RecordStateRun(pc, maxCount);
+	}
+	if (run->count < MIN_STATE_RUN)
+		return 0;
+
+	// No draws happen inside the run, so flushing at the first change is the same as flushing at the command.
+	uint64_t dirty = 0;
+	for (u32 op : run->ops) {
+		const u32 cmd = op >> 24;
+		if (op == gstate.cmdmem[cmd])
+			continue;
+		const uint64_t flags = cmdInfo_[cmd].flags;
+		if ((flags & FLAG_FLUSHBEFOREONCHANGE) && drawEngineCommon_->GetNumDrawCalls()) {
+			drawEngineCommon_->DispatchFlush();
+		}
+		gstate.cmdmem[cmd] = op;
+		dirty |= flags >> 8;
+	}
+	if (dirty)
+		gstate_c.Dirty(dirty);
+	return run->count;
+}
+
 void GPUCommon::BeginFrame() {
 	immCount_ = 0;
 	if (dumpNextFrame_) {
@@ -1191,6 +1330,8 @@ int GPUCommon::GetNextListIndex() {
 }
 
 void GPUCommon::ProcessDLQueue() {
+	SyncThread();
+
 	startingTicks = CoreTiming::GetTicks();
 	cyclesExecuted = 0;
 
@@ -1200,6 +1341,19 @@ void GPUCommon::ProcessDLQueue() {
 		//return;
 	}
 
+	if (UseGeThread()) {
+		if (!geThread_.joinable())
+			StartGeThread();
+		std::lock_guard<std::mutex> guard(geThreadLock_);
+		geThreadBusy_.store(true, std::memory_order_release);
+		geThreadCond_.notify_all();
+		return;
+	}
+
+	RunDLQueue();
+}
+
+void GPUCommon::RunDLQueue() {
 	for (int listIndex = GetNextListIndex(); listIndex != -1; listIndex = GetNextListIndex()) {
 		DisplayList &l = dls[listIndex];
 		DEBUG_LOG(G3D, "Starting DL execution at %08x - stall = %08x", l.pc, l.stall);
@@ -1218,10 +1372,94 @@ void GPUCommon::ProcessDLQueue() {
 
 	drawCompleteTicks = startingTicks + cyclesExecuted;
 	busyTicks = std::max(busyTicks, drawCompleteTicks);
-	__GeTriggerSync(GPU_SYNC_DRAW, 1, drawCompleteTicks);
+	TriggerSync(GPU_SYNC_DRAW, 1, drawCompleteTicks);
 	// Since the event is in CoreTiming, we're in sync.  Just set 0 now.
 }
 
+bool GPUCommon::UseGeThread() const {
+	// The debugger and recorder step and pause from the emu thread, so they always run lists inline.
+	// The software renderer's memory transfers don't sync, so it also stays inline.
+	if (!g_Config.bThreadedGE || g_Config.bSoftwareRendering)
+		return false;
+	return !dumpThisFrame_ && !GPUDebug::IsActive() && !GPURecord::IsActive();
+}
+
+void GPUCommon::StartGeThread() {
+	geThreadQuit_ = false;
+	geThread_ = std::thread([this] { GeThreadFunc(); });
+}
+
+void GPUCommon::StopGeThread() {
+	if (!geThread_.joinable())
+		return;
+	{
+		std::unique_lock<std::mutex> guard(geThreadLock_);
+		geThreadCond_.wait(guard, [this] { return !geThreadBusy_.load(std::memory_order_acquire); });
+		geThreadQuit_ = true;
+		geThreadCond_.notify_all();
+	}
+	geThread_.join();
+	// Emulation is going away, nothing left to trigger.
+	deferredTriggers_.clear();
+}
+
+void GPUCommon::GeThreadFunc() {
+	SetCurrentThreadName("GeThread");
+
+	std::unique_lock<std::mutex> guard(geThreadLock_);
+	while (true) {
+		geThreadCond_.wait(guard, [this] { return geThreadBusy_.load(std::memory_order_acquire) || geThreadQuit_; });
+		if (geThreadQuit_)
+			break;
+
+		guard.unlock();
+		onGeThread_ = true;
+		RunDLQueue();
+		onGeThread_ = false;
+		guard.lock();
+
+		geThreadBusy_.store(false, std::memory_order_release);
+		geThreadCond_.notify_all();
+	}
+}
+
+void GPUCommon::SyncThreadSlow() {
+	if (geThreadBusy_.load(std::memory_order_acquire)) {
+		// Memory transfers from the list itself land here too.
+		if (std::this_thread::get_id() == geThread_.get_id())
+			return;
+
+		std::unique_lock<std::mutex> guard(geThreadLock_);
+		geThreadCond_.wait(guard, [this] { return !geThreadBusy_.load(std::memory_order_acquire); });
+	}
+
+	// Now we're in sync, schedule what the list raised in the order it happened.
+	std::vector<DeferredTrigger> triggers;
+	triggers.swap(deferredTriggers_);
+	for (const DeferredTrigger &trigger : triggers) {
+		if (trigger.interrupt)
+			__GeTriggerInterrupt(trigger.id, trigger.param, trigger.atTicks);
+		else
+			__GeTriggerSync((GPUSyncType)trigger.param, trigger.id, trigger.atTicks);
+	}
+}
+
+bool GPUCommon::TriggerInterrupt(int listid, u32 pc, u64 atTicks) {
+	if (onGeThread_) {
+		deferredTriggers_.push_back(DeferredTrigger{ true, listid, pc, atTicks });
+		return true;
+	}
+	return __GeTriggerInterrupt(listid, pc, atTicks);
+}
+
+void GPUCommon::TriggerSync(GPUSyncType type, int id, u64 atTicks) {
+	if (onGeThread_) {
+		deferredTriggers_.push_back(DeferredTrigger{ false, id, (u32)type, atTicks });
+		return;
+	}
+	__GeTriggerSync(type, id, atTicks);
+}
+
 void GPUCommon::PreExecuteOp(u32 op, u32 diff) {
 	// Nothing to do
 }
@@ -1454,7 +1692,7 @@ void GPUCommon::Execute_End(u32 op, u32 diff) {
 			}
 			// TODO: Technically, jump/call/ret should generate an interrupt, but before the pc change maybe?
 			if (currentList->interruptsEnabled && trigger) {
-				if (__GeTriggerInterrupt(currentList->id, currentList->pc, startingTicks + cyclesExecuted)) {
+				if (TriggerInterrupt(currentList->id, currentList->pc, startingTicks + cyclesExecuted)) {
 					currentList->pendingInterrupt = true;
 					UpdateState(GPUSTATE_INTERRUPT);
 				}
@@ -1466,7 +1704,7 @@ void GPUCommon::Execute_End(u32 op, u32 diff) {
 		case PSP_GE_SIGNAL_HANDLER_PAUSE:
 			currentList->state = PSP_GE_DL_STATE_PAUSED;
 			if (currentList->interruptsEnabled) {
-				if (__GeTriggerInterrupt(currentList->id, currentList->pc, startingTicks + cyclesExecuted)) {
+				if (TriggerInterrupt(currentList->id, currentList->pc, startingTicks + cyclesExecuted)) {
 					currentList->pendingInterrupt = true;
 					UpdateState(GPUSTATE_INTERRUPT);
 				}
@@ -1489,13 +1727,13 @@ void GPUCommon::Execute_End(u32 op, u32 diff) {
 				currentList->started = false;
 			}
 
-			if (currentList->interruptsEnabled && __GeTriggerInterrupt(currentList->id, currentList->pc, startingTicks + cyclesExecuted)) {
+			if (currentList->interruptsEnabled && TriggerInterrupt(currentList->id, currentList->pc, startingTicks + cyclesExecuted)) {
 				currentList->pendingInterrupt = true;
 			} else {
 				currentList->state = PSP_GE_DL_STATE_COMPLETED;
 				currentList->waitTicks = startingTicks + cyclesExecuted;
 				busyTicks = std::max(busyTicks, currentList->waitTicks);
-				__GeTriggerSync(GPU_SYNC_LIST, currentList->id, currentList->waitTicks);
+				TriggerSync(GPU_SYNC_LIST, currentList->id, currentList->waitTicks);
 			}
 			break;
 		}
@@ -1545,6 +1783,18 @@ void GPUCommon::Execute_LoadClut(u32 op, u32 diff) {
 	textureCache_->LoadClut(gstate.getClutAddress(), gstate.getClutLoadBytes());
 }
 
+void GPUCommon::Execute_MaterialColorBatched(u32 op, u32 diff) {
+	// The draw engine keeps the color per draw when it can, so we only flush when it can't.
+	if (!drawEngineCommon_->CanBatchMaterialColor()) {
+		// Restore and flush
+		const u8 cmd = op >> 24;
+		gstate.cmdmem[cmd] ^= diff;
+		Flush();
+		gstate.cmdmem[cmd] ^= diff;
+	}
+	gstate_c.Dirty(DIRTY_MATAMBIENTALPHA);
+}
+
 void GPUCommon::Execute_VertexTypeSkinning(u32 op, u32 diff) {
 	// Don't flush when weight count changes.
 	if (diff & ~GE_VTYPE_WEIGHTCOUNT_MASK) {
@@ -1593,7 +1843,7 @@ void GPUCommon::Execute_Prim(u32 op, u32 diff) {
 	// This also makes skipping drawing very effective.
 	framebufferManager_->SetRenderFrameBuffer(gstate_c.IsDirty(DIRTY_FRAMEBUF), gstate_c.skipDrawReason);
 
-	if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB)) {
+	if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB | SKIPDRAW_TURBO_DISPLAY_FB)) {
 		// Rough estimate, not sure what's correct.
 		cyclesExecuted += EstimatePerVertexCost() * count;
 		if (gstate.isModeClear()) {
@@ -1804,7 +2054,7 @@ void GPUCommon::Execute_Bezier(u32 op, u32 diff) {
 
 	// This also make skipping drawing very effective.
 	framebufferManager_->SetRenderFrameBuffer(gstate_c.IsDirty(DIRTY_FRAMEBUF), gstate_c.skipDrawReason);
-	if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB)) {
+	if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB | SKIPDRAW_TURBO_DISPLAY_FB)) {
 		// TODO: Should this eat some cycles?  Probably yes.  Not sure if important.
 		return;
 	}
@@ -1872,7 +2122,7 @@ void GPUCommon::Execute_Spline(u32 op, u32 diff) {
 
 	// This also make skipping drawing very effective.
 	framebufferManager_->SetRenderFrameBuffer(gstate_c.IsDirty(DIRTY_FRAMEBUF), gstate_c.skipDrawReason);
-	if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB)) {
+	if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB | SKIPDRAW_TURBO_DISPLAY_FB)) {
 		// TODO: Should this eat some cycles?  Probably yes.  Not sure if important.
 		return;
 	}
@@ -2239,6 +2489,7 @@ void GPUCommon::Execute_BoneMtxData(u32 op, u32 diff) {
 
 void GPUCommon::Execute_MorphWeight(u32 op, u32 diff) {
 	gstate_c.morphWeights[(op >> 24) - GE_CMD_MORPHWEIGHT0] = getFloat24(op);
+	gstate_c.Dirty(DIRTY_MORPHWEIGHTS);
 }
 
 void GPUCommon::Execute_ImmVertexAlphaPrim(u32 op, u32 diff) {
@@ -2285,7 +2536,7 @@ void GPUCommon::Execute_ImmVertexAlphaPrim(u32 op, u32 diff) {
 void GPUCommon::FlushImm() {
 	SetDrawType(DRAW_PRIM, immPrim_);
 	framebufferManager_->SetRenderFrameBuffer(gstate_c.IsDirty(DIRTY_FRAMEBUF), gstate_c.skipDrawReason);
-	if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB)) {
+	if (gstate_c.skipDrawReason & (SKIPDRAW_SKIPFRAME | SKIPDRAW_NON_DISPLAYED_FB | SKIPDRAW_TURBO_DISPLAY_FB)) {
 		// No idea how many cycles to skip, heh.
 		return;
 	}
@@ -2429,6 +2680,7 @@ struct DisplayList_v2 {
 };
 
 void GPUCommon::DoState(PointerWrap &p) {
+	SyncThread();
 	auto s = p.Section("GPUCommon", 1, 4);
 	if (!s)
 		return;
@@ -2504,6 +2756,7 @@ void GPUCommon::DoState(PointerWrap &p) {
 }
 
 void GPUCommon::InterruptStart(int listid) {
+	SyncThread();
 	interruptRunning = true;
 }
 void GPUCommon::InterruptEnd(int listid) {
@@ -2535,6 +2788,7 @@ void GPUCommon::InterruptEnd(int listid) {
 
 // TODO: Maybe cleaner to keep this in GE and trigger the clear directly?
 void GPUCommon::SyncEnd(GPUSyncType waitType, int listid, bool wokeThreads) {
+	SyncThread();
 	if (waitType == GPU_SYNC_DRAW && wokeThreads)
 	{
 		for (int i = 0; i < DisplayListMaxCount; ++i) {
@@ -2742,29 +2996,34 @@ void GPUCommon::DoBlockTransfer(u32 skipDrawReason) {
 }
 
 bool GPUCommon::PerformMemoryCopy(u32 dest, u32 src, int size) {
+	SyncThread();
+	gpuStats.numMemoryCopyBytes += size;
 	// Track stray copies of a framebuffer in RAM. MotoGP does this.
 	if (framebufferManager_->MayIntersectFramebuffer(src) || framebufferManager_->MayIntersectFramebuffer(dest)) {
 		if (!framebufferManager_->NotifyFramebufferCopy(src, dest, size, false, gstate_c.skipDrawReason)) {
 			// We use a little hack for PerformMemoryDownload/PerformMemoryUpload using a VRAM mirror.
 			// Since they're identical we don't need to copy.
 			if (!Memory::IsVRAMAddress(dest) || (dest ^ 0x00400000) != src) {
-				const std::string tag = "GPUMemcpy/" + GetMemWriteTagAt(src, size);
-				Memory::Memcpy(dest, src, size, tag.c_str(), tag.size());
+				u8 *to = Memory::GetPointer(dest);
+				const u8 *from = Memory::GetPointer(src);
+				if (to && from) {
+					memcpy(to, from, size);
+					NotifyMemInfoCopy(dest, src, size, "GPUMemcpy");
+				}
 			}
 		}
 		InvalidateCache(dest, size, GPU_INVALIDATE_HINT);
 		return true;
 	}
 
-	const std::string tag = "GPUMemcpy/" + GetMemWriteTagAt(src, size);
-	NotifyMemInfo(MemBlockFlags::READ, src, size, tag.c_str(), tag.size());
-	NotifyMemInfo(MemBlockFlags::WRITE, dest, size, tag.c_str(), tag.size());
+	NotifyMemInfoCopy(dest, src, size, "GPUMemcpy");
 	InvalidateCache(dest, size, GPU_INVALIDATE_HINT);
 	GPURecord::NotifyMemcpy(dest, src, size);
 	return false;
 }
 
 bool GPUCommon::PerformMemorySet(u32 dest, u8 v, int size) {
+	SyncThread();
 	// This may indicate a memset, usually to 0, of a framebuffer.
 	if (framebufferManager_->MayIntersectFramebuffer(dest)) {
 		Memory::Memset(dest, v, size, "GPUMemset");
@@ -2801,6 +3060,7 @@ bool GPUCommon::PerformMemoryUpload(u32 dest, int size) {
 }
 
 void GPUCommon::InvalidateCache(u32 addr, int size, GPUInvalidationType type) {
+	SyncThread();
 	if (size > 0)
 		textureCache_->Invalidate(addr, size, type);
 	else
@@ -2815,6 +3075,7 @@ void GPUCommon::InvalidateCache(u32 addr, int size, GPUInvalidationType type) {
 }
 
 void GPUCommon::NotifyVideoUpload(u32 addr, int size, int width, int format) {
+	SyncThread();
 	if (Memory::IsVRAMAddress(addr)) {
 		framebufferManager_->NotifyVideoUpload(addr, size, width, (GEBufferFormat)format);
 	}
@@ -2823,6 +3084,7 @@ void GPUCommon::NotifyVideoUpload(u32 addr, int size, int width, int format) {
 }
 
 bool GPUCommon::PerformStencilUpload(u32 dest, int size) {
+	SyncThread();
 	if (framebufferManager_->MayIntersectFramebuffer(dest)) {
 		framebufferManager_->NotifyStencilUpload(dest, size);
 		return true;
@@ -2916,8 +3178,8 @@ size_t GPUCommon::FormatGPUStatsCommon(char *buffer, size_t size) {
 		"Commands per call level: %i %i %i %i\n"
 		"Vertices: %d cached: %d uncached: %d\n"
 		"FBOs active: %d (evaluations: %d)\n"
-		"Textures: %d, dec: %d, invalidated: %d, hashed: %d kB\n"
-		"Readbacks: %d, uploads: %d\n"
+		"Textures: %d, dec: %d, invalidated: %d, hashed: %d kB (skipped: %d)\n"
+		"Readbacks: %d (async: %d), uploads: %d, VRAM copies: %d kB\n"
 		"GPU cycles executed: %d (%f per vertex)\n",
 		gpuStats.msProcessingDisplayLists * 1000.0f,
 		gpuStats.numDrawCalls,
@@ -2935,8 +3197,11 @@ size_t GPUCommon::FormatGPUStatsCommon(char *buffer, size_t size) {
 		gpuStats.numTexturesDecoded,
 		gpuStats.numTextureInvalidations,
 		gpuStats.numTextureDataBytesHashed / 1024,
+		gpuStats.numTextureHashesSkipped,
 		gpuStats.numReadbacks,
+		gpuStats.numAsyncReadbacks,
 		gpuStats.numUploads,
+		gpuStats.numMemoryCopyBytes / 1024,
 		gpuStats.vertexGPUCycles + gpuStats.otherGPUCycles,
 		vertexAverageCycles
 	);
@@ -7,9 +7,12 @@
 #include "GPU/GPUState.h"
 #include "GPU/Common/GPUDebugInterface.h"
 
-#if defined(__ANDROID__)
 #include <atomic>
-#endif
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #if defined(_M_SSE)
 #include <emmintrin.h>
@@ -19,6 +22,7 @@ class FramebufferManagerCommon;
 class TextureCacheCommon;
 class DrawEngineCommon;
 class GraphicsContext;
+class Path;
 namespace Draw {
 	class DrawContext;
 }
@@ -89,6 +93,10 @@ class GPUCommon : public GPUInterface, public GPUDebugInterface {
 	void InterruptStart(int listid) override;
 	void InterruptEnd(int listid) override;
 	void SyncEnd(GPUSyncType waitType, int listid, bool wokeThreads) override;
+	void SyncThread() override {
+		if (geThreadBusy_.load(std::memory_order_acquire) || !deferredTriggers_.empty())
+			SyncThreadSlow();
+	}
 	void EnableInterrupts(bool enable) override {
 		interruptsEnabled_ = enable;
 	}
@@ -138,6 +146,7 @@ class GPUCommon : public GPUInterface, public GPUDebugInterface {
 
 	void Execute_VertexType(u32 op, u32 diff);
 	void Execute_VertexTypeSkinning(u32 op, u32 diff);
+	void Execute_MaterialColorBatched(u32 op, u32 diff);
 
 	void Execute_Prim(u32 op, u32 diff);
 	void Execute_Bezier(u32 op, u32 diff);
@@ -286,8 +295,11 @@ class GPUCommon : public GPUInterface, public GPUDebugInterface {
 
 	void BeginFrame() override;
 	void UpdateVsyncInterval(bool force);
+	// If there's no shader cache at cachePath yet, starts it from a packaged one in assets/shadercache.
+	static void SeedShaderCache(const Path &cachePath);
 
 	virtual void FastRunLoop(DisplayList &list);
+	int ReplayStateRun(u32 pc, int maxCount);
 
 	void SlowRunLoop(DisplayList &list);
 	void UpdatePC(u32 currentPC, u32 newPC);
@@ -300,6 +312,10 @@ class GPUCommon : public GPUInterface, public GPUDebugInterface {
 	// TODO: Unify this.
 	virtual void FinishDeferred() {}
 
+	void RunDLQueue();
+	bool TriggerInterrupt(int listid, u32 pc, u64 atTicks);
+	void TriggerSync(GPUSyncType type, int id, u64 atTicks);
+
 	void DoBlockTransfer(u32 skipDrawReason);
 	void DoExecuteCall(u32 target);
 
@@ -371,6 +387,40 @@ class GPUCommon : public GPUInterface, public GPUDebugInterface {
 
 private:
 	void FlushImm();
+
+	bool UseGeThread() const;
+	void StartGeThread();
+	void StopGeThread();
+	void GeThreadFunc();
+	void SyncThreadSlow();
+
+	// Interrupts and syncs raised by the GE thread, scheduled on the emu thread at the next SyncThread().
+	struct DeferredTrigger {
+		bool interrupt;
+		int id;
+		// The list pc for interrupts, the GPUSyncType for syncs.
+		u32 param;
+		u64 atTicks;
+	};
+
+	std::thread geThread_;
+	std::mutex geThreadLock_;
+	std::condition_variable geThreadCond_;
+	std::atomic<bool> geThreadBusy_{};
+	bool geThreadQuit_ = false;
+	bool onGeThread_ = false;
+	std::vector<DeferredTrigger> deferredTriggers_;
+
+	// A run of plain state commands at a branch target, replayed by ReplayStateRun() while its memory is unchanged.
+	struct StateRun {
+		u64 hash;
+		int count;
+		// The last value of each command set in the run, in first set order. No draw sees the others.
+		std::vector<u32> ops;
+	};
+	const StateRun &RecordStateRun(u32 pc, int maxCount);
+	std::unordered_map<u32, StateRun> stateRuns_;
+
 	// Debug stats.
 	double timeSteppingStarted_;
 	double timeSpentStepping_;
@@ -194,6 +194,8 @@ class GPUInterface {
 	virtual void InterruptStart(int listid) = 0;
 	virtual void InterruptEnd(int listid) = 0;
 	virtual void SyncEnd(GPUSyncType waitType, int listid, bool wokeThreads) = 0;
+	// With the threaded GE, waits for display list processing to finish. Call before touching GE state or PSP memory it may write.
+	virtual void SyncThread() = 0;
 
 	virtual void PreExecuteOp(u32 op, u32 diff) = 0;
 	virtual void ExecuteOp(u32 op, u32 diff) = 0;
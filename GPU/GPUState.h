@@ -611,6 +611,10 @@ struct GPUStateCache {
 
 	// Set if we are doing hardware bezier/spline.
 	SubmitType submitType;
+	// Non-zero while the vertex shader reads undecoded texcoords, these still need this normalization factor.
+	float rawTexcoordScale;
+	// Number of morph targets the vertex shader blends itself, 0 when they're blended while decoding.
+	int morphTargetsInShader;
 	int spline_num_points_u;
 
 	bool useShaderDepal;
@@ -474,6 +474,11 @@ void SOFTRAST_CALL DrawSinglePixel(int x, int y, int z, int fog, Vec4IntArg colo
 	SetPixelColor(fbFormat, x, y, new_color);
 }
 
+JitCacheStats GetJitStats() {
+	std::lock_guard<std::mutex> guard(jitCacheLock);
+	return jitCache->GetStats();
+}
+
 SingleFunc GetSingleFunc(const PixelFuncID &id) {
 	SingleFunc jitted = jitCache->GetSingle(id);
 	if (jitted) {
@@ -536,6 +541,8 @@ void PixelJitCache::Clear() {
 	ClearCodeSpace(0);
 	cache_.clear();
 	addresses_.clear();
+	lastFunc_ = nullptr;
+	stats_.clears++;
 }
 
 void PixelJitCache::Describe(const std::string &message) {
@@ -572,8 +579,16 @@ std::string PixelJitCache::DescribeCodePtr(const u8 *ptr) {
 SingleFunc PixelJitCache::GetSingle(const PixelFuncID &id) {
 	std::lock_guard<std::mutex> guard(jitCacheLock);
 
+	if (lastFunc_ && lastID_ == id) {
+		stats_.hits++;
+		return lastFunc_;
+	}
+
 	auto it = cache_.find(id);
 	if (it != cache_.end()) {
+		stats_.hits++;
+		lastID_ = id;
+		lastFunc_ = it->second;
 		return it->second;
 	}
 
@@ -587,6 +602,11 @@ SingleFunc PixelJitCache::GetSingle(const PixelFuncID &id) {
 		addresses_[id] = GetCodePointer();
 		SingleFunc func = CompileSingle(id);
 		cache_[id] = func;
+		stats_.compiles++;
+		if (!func)
+			stats_.failures++;
+		lastID_ = id;
+		lastFunc_ = func;
 		return func;
 	}
 #endif
@@ -42,6 +42,7 @@ void Init();
 void Shutdown();
 
 bool DescribeCodePtr(const u8 *ptr, std::string &name);
+JitCacheStats GetJitStats();
 
 struct PixelBlendState {
 	bool usesFactors = false;
@@ -62,6 +63,9 @@ class PixelJitCache : public Rasterizer::CodeBlock {
 	void Clear();
 
 	std::string DescribeCodePtr(const u8 *ptr);
+	JitCacheStats GetStats() const {
+		return stats_;
+	}
 
 private:
 	SingleFunc CompileSingle(const PixelFuncID &id);
@@ -108,6 +112,10 @@ class PixelJitCache : public Rasterizer::CodeBlock {
 	std::unordered_map<PixelFuncID, const u8 *> addresses_;
 	std::unordered_map<const u8 *, std::string> descriptions_;
 	RegCache regCache_;
+	JitCacheStats stats_;
+	// Most triangles use the same function as the previous one, this skips the hash lookup.
+	PixelFuncID lastID_;
+	SingleFunc lastFunc_ = nullptr;
 
 #if PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
 	void Discard();
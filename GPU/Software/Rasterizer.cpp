@@ -55,6 +55,19 @@ static inline __m128 Interpolate(const __m128 &c0, const __m128 &c1, const __m12
 static inline __m128i Interpolate(const __m128i &c0, const __m128i &c1, const __m128i &c2, int w0, int w1, int w2, float wsum) {
 	return _mm_cvtps_epi32(Interpolate(_mm_cvtepi32_ps(c0), _mm_cvtepi32_ps(c1), _mm_cvtepi32_ps(c2), w0, w1, w2, wsum));
 }
+#elif PPSSPP_ARCH(ARM_NEON) && PPSSPP_ARCH(ARM64)
+static inline float32x4_t Interpolate(const float32x4_t &c0, const float32x4_t &c1, const float32x4_t &c2, int w0, int w1, int w2, float wsum) {
+	// Not using vmlaq, to round the same way as the SSE path.
+	float32x4_t v = vmulq_f32(c0, vdupq_n_f32((float)w0));
+	v = vaddq_f32(v, vmulq_f32(c1, vdupq_n_f32((float)w1)));
+	v = vaddq_f32(v, vmulq_f32(c2, vdupq_n_f32((float)w2)));
+	return vmulq_f32(v, vdupq_n_f32(wsum));
+}
+
+// Not an overload, MSVC uses the same type for all NEON vectors.
+static inline int32x4_t InterpolateInt(const int32x4_t &c0, const int32x4_t &c1, const int32x4_t &c2, int w0, int w1, int w2, float wsum) {
+	return vcvtnq_s32_f32(Interpolate(vcvtq_f32_s32(c0), vcvtq_f32_s32(c1), vcvtq_f32_s32(c2), w0, w1, w2, wsum));
+}
 #endif
 
 // NOTE: When not casting color0 and color1 to float vectors, this code suffers from severe overflow issues.
@@ -63,6 +76,8 @@ static inline __m128i Interpolate(const __m128i &c0, const __m128i &c1, const __
 static inline Vec4<int> Interpolate(const Vec4<int> &c0, const Vec4<int> &c1, const Vec4<int> &c2, int w0, int w1, int w2, float wsum) {
 #if defined(_M_SSE) && !PPSSPP_ARCH(X86)
 	return Vec4<int>(Interpolate(c0.ivec, c1.ivec, c2.ivec, w0, w1, w2, wsum));
+#elif PPSSPP_ARCH(ARM_NEON) && PPSSPP_ARCH(ARM64)
+	return Vec4<int>(InterpolateInt(c0.ivec, c1.ivec, c2.ivec, w0, w1, w2, wsum));
 #else
 	return ((c0.Cast<float>() * w0 + c1.Cast<float>() * w1 + c2.Cast<float>() * w2) * wsum).Cast<int>();
 #endif
@@ -71,6 +86,8 @@ static inline Vec4<int> Interpolate(const Vec4<int> &c0, const Vec4<int> &c1, co
 static inline Vec3<int> Interpolate(const Vec3<int> &c0, const Vec3<int> &c1, const Vec3<int> &c2, int w0, int w1, int w2, float wsum) {
 #if defined(_M_SSE) && !PPSSPP_ARCH(X86)
 	return Vec3<int>(Interpolate(c0.ivec, c1.ivec, c2.ivec, w0, w1, w2, wsum));
+#elif PPSSPP_ARCH(ARM_NEON) && PPSSPP_ARCH(ARM64)
+	return Vec3<int>(InterpolateInt(c0.ivec, c1.ivec, c2.ivec, w0, w1, w2, wsum));
 #else
 	return ((c0.Cast<float>() * w0 + c1.Cast<float>() * w1 + c2.Cast<float>() * w2) * wsum).Cast<int>();
 #endif
@@ -79,6 +96,8 @@ static inline Vec3<int> Interpolate(const Vec3<int> &c0, const Vec3<int> &c1, co
 static inline Vec2<float> Interpolate(const Vec2<float> &c0, const Vec2<float> &c1, const Vec2<float> &c2, int w0, int w1, int w2, float wsum) {
 #if defined(_M_SSE) && !PPSSPP_ARCH(X86)
 	return Vec2<float>(Interpolate(c0.vec, c1.vec, c2.vec, w0, w1, w2, wsum));
+#elif PPSSPP_ARCH(ARM_NEON) && PPSSPP_ARCH(ARM64)
+	return Vec2<float>(Interpolate(c0.vec, c1.vec, c2.vec, w0, w1, w2, wsum));
 #else
 	return (c0 * w0 + c1 * w1 + c2 * w2) * wsum;
 #endif
@@ -90,6 +109,11 @@ static inline Vec4<float> Interpolate(const float &c0, const float &c1, const fl
 	v = _mm_add_ps(v, _mm_mul_ps(w1.vec, _mm_set1_ps(c1)));
 	v = _mm_add_ps(v, _mm_mul_ps(w2.vec, _mm_set1_ps(c2)));
 	return _mm_mul_ps(v, wsum_recip.vec);
+#elif PPSSPP_ARCH(ARM_NEON) && PPSSPP_ARCH(ARM64)
+	float32x4_t v = vmulq_f32(w0.vec, vdupq_n_f32(c0));
+	v = vaddq_f32(v, vmulq_f32(w1.vec, vdupq_n_f32(c1)));
+	v = vaddq_f32(v, vmulq_f32(w2.vec, vdupq_n_f32(c2)));
+	return vmulq_f32(v, wsum_recip.vec);
 #else
 	return (w0 * c0 + w1 * c1 + w2 * c2) * wsum_recip;
 #endif
@@ -472,7 +496,7 @@ Vec3<int> AlphaBlendingResult(const PixelFuncID &pixelID, const Vec4<int> &sourc
 	}
 }
 
-static inline Vec4IntResult SOFTRAST_CALL ApplyTexturing(float s, float t, int x, int y, Vec4IntArg prim_color, u8 *texptr[], int texbufw[], int texlevel, int frac_texlevel, bool bilinear, Sampler::Funcs sampler) {
+static inline Vec4IntResult SOFTRAST_CALL ApplyTexturing(float s, float t, int x, int y, Vec4IntArg prim_color, u8 *texptr[], int texbufw[], int texlevel, int frac_texlevel, bool bilinear, const Sampler::Funcs &sampler) {
 	const u8 **tptr0 = const_cast<const u8 **>(&texptr[texlevel]);
 	const int *bufw0 = &texbufw[texlevel];
 
@@ -482,7 +506,7 @@ static inline Vec4IntResult SOFTRAST_CALL ApplyTexturing(float s, float t, int x
 	return sampler.linear(s, t, x, y, prim_color, tptr0, bufw0, texlevel, frac_texlevel);
 }
 
-static inline Vec4IntResult SOFTRAST_CALL ApplyTexturingSingle(float s, float t, int x, int y, Vec4IntArg prim_color, u8 *texptr[], int texbufw[], int texlevel, int frac_texlevel, bool bilinear, Sampler::Funcs sampler) {
+static inline Vec4IntResult SOFTRAST_CALL ApplyTexturingSingle(float s, float t, int x, int y, Vec4IntArg prim_color, u8 *texptr[], int texbufw[], int texlevel, int frac_texlevel, bool bilinear, const Sampler::Funcs &sampler) {
 	return ApplyTexturing(s, t, ((x & 15) + 1) / 2, ((y & 15) + 1) / 2, prim_color, texptr, texbufw, texlevel, frac_texlevel, bilinear, sampler);
 }
 
@@ -549,7 +573,7 @@ static inline void CalculateSamplingParams(const float ds, const float dt, const
 	}
 }
 
-static inline void ApplyTexturing(Sampler::Funcs sampler, Vec4<int> *prim_color, const Vec4<int> &mask, const Vec4<float> &s, const Vec4<float> &t, int maxTexLevel, u8 *texptr[], int texbufw[], int x, int y) {
+static inline void ApplyTexturing(const Sampler::Funcs &sampler, Vec4<int> *prim_color, const Vec4<int> &mask, const Vec4<float> &s, const Vec4<float> &t, int maxTexLevel, u8 *texptr[], int texbufw[], int x, int y) {
 	float ds = s[1] - s[0];
 	float dt = t[2] - t[0];
 
@@ -593,6 +617,8 @@ Vec4<int> TriangleEdge::Start(const ScreenCoords &v0, const ScreenCoords &v1, co
 inline Vec4<int> TriangleEdge::StepX(const Vec4<int> &w) {
 #if defined(_M_SSE) && !PPSSPP_ARCH(X86)
 	return _mm_add_epi32(w.ivec, stepX.ivec);
+#elif PPSSPP_ARCH(ARM_NEON) && PPSSPP_ARCH(ARM64)
+	return vaddq_s32(w.ivec, stepX.ivec);
 #else
 	return w + stepX;
 #endif
@@ -601,6 +627,8 @@ inline Vec4<int> TriangleEdge::StepX(const Vec4<int> &w) {
 inline Vec4<int> TriangleEdge::StepY(const Vec4<int> &w) {
 #if defined(_M_SSE) && !PPSSPP_ARCH(X86)
 	return _mm_add_epi32(w.ivec, stepY.ivec);
+#elif PPSSPP_ARCH(ARM_NEON) && PPSSPP_ARCH(ARM64)
+	return vaddq_s32(w.ivec, stepY.ivec);
 #else
 	return w + stepY;
 #endif
@@ -613,6 +641,12 @@ static inline Vec4<int> MakeMask(const Vec4<int> &w0, const Vec4<int> &w1, const
 	__m128i biased2 = _mm_add_epi32(w2.ivec, bias2.ivec);
 
 	return _mm_or_si128(_mm_or_si128(biased0, _mm_or_si128(biased1, biased2)), scissor.ivec);
+#elif PPSSPP_ARCH(ARM_NEON) && PPSSPP_ARCH(ARM64)
+	int32x4_t biased0 = vaddq_s32(w0.ivec, bias0.ivec);
+	int32x4_t biased1 = vaddq_s32(w1.ivec, bias1.ivec);
+	int32x4_t biased2 = vaddq_s32(w2.ivec, bias2.ivec);
+
+	return vorrq_s32(vorrq_s32(biased0, vorrq_s32(biased1, biased2)), scissor.ivec);
 #else
 	return (w0 + bias0) | (w1 + bias1) | (w2 + bias2) | scissor;
 #endif
@@ -625,6 +659,9 @@ static inline bool AnyMask(const Vec4<int> &mask) {
 	__m128i low1 = _mm_and_si128(low2, _mm_shuffle_epi32(low2, _MM_SHUFFLE(1, 1, 1, 1)));
 	// Now we only need to check one sign bit.
 	return _mm_cvtsi128_si32(low1) >= 0;
+#elif PPSSPP_ARCH(ARM_NEON) && PPSSPP_ARCH(ARM64)
+	// Any lane with a clear sign bit is inside.
+	return vmaxvq_s32(mask.ivec) >= 0;
 #else
 	return mask.x >= 0 || mask.y >= 0 || mask.z >= 0 || mask.w >= 0;
 #endif
@@ -635,11 +672,45 @@ static inline Vec4<float> EdgeRecip(const Vec4<int> &w0, const Vec4<int> &w1, co
 	__m128i wsum = _mm_add_epi32(w0.ivec, _mm_add_epi32(w1.ivec, w2.ivec));
 	// _mm_rcp_ps loses too much precision.
 	return _mm_div_ps(_mm_set1_ps(1.0f), _mm_cvtepi32_ps(wsum));
+#elif PPSSPP_ARCH(ARM_NEON) && PPSSPP_ARCH(ARM64)
+	int32x4_t wsum = vaddq_s32(w0.ivec, vaddq_s32(w1.ivec, w2.ivec));
+	return vdivq_f32(vdupq_n_f32(1.0f), vcvtq_f32_s32(wsum));
 #else
 	return (w0 + w1 + w2).Cast<float>().Reciprocal();
 #endif
 }
 
+// Checks whether any pixel of a quad could pass the depth test, given the most favorable z of the triangle.
+static inline bool AnyDepthMayPass(GEComparison func, int bestZ, const Vec4<int> &mask, const DrawingCoords &p) {
+	const int stride = gstate.DepthBufStride();
+	for (int i = 0; i < 4; ++i) {
+		if (mask[i] < 0)
+			continue;
+		int reference_z = depthbuf.Get16(p.x + (i & 1), p.y + (i / 2), stride);
+		switch (func) {
+		case GE_COMP_LESS:
+			if (bestZ < reference_z)
+				return true;
+			break;
+		case GE_COMP_LEQUAL:
+			if (bestZ <= reference_z)
+				return true;
+			break;
+		case GE_COMP_GREATER:
+			if (bestZ > reference_z)
+				return true;
+			break;
+		case GE_COMP_GEQUAL:
+			if (bestZ >= reference_z)
+				return true;
+			break;
+		default:
+			return true;
+		}
+	}
+	return false;
+}
+
 template <bool clearMode>
 void DrawTriangleSlice(
 	const VertexData& v0, const VertexData& v1, const VertexData& v2,
@@ -652,26 +723,16 @@ void DrawTriangleSlice(
 	Vec4<int> bias1 = Vec4<int>::AssignToAll(IsRightSideOrFlatBottomLine(v1.screenpos.xy(), v2.screenpos.xy(), v0.screenpos.xy()) ? -1 : 0);
 	Vec4<int> bias2 = Vec4<int>::AssignToAll(IsRightSideOrFlatBottomLine(v2.screenpos.xy(), v0.screenpos.xy(), v1.screenpos.xy()) ? -1 : 0);
 
-	int texbufw[8]{};
-
 	int maxTexLevel = gstate.getTextureMaxLevel();
-	u8 *texptr[8]{};
-
 	if (!gstate.isMipmapEnabled()) {
 		maxTexLevel = 0;
 	}
 
-	if (gstate.isTextureMapEnabled() && !clearMode) {
-		GETextureFormat texfmt = gstate.getTextureFormat();
-		for (int i = 0; i <= maxTexLevel; i++) {
-			u32 texaddr = gstate.getTextureAddress(i);
-			texbufw[i] = GetTextureBufw(i, texaddr, texfmt);
-			if (Memory::IsValidAddress(texaddr))
-				texptr[i] = Memory::GetPointerUnchecked(texaddr);
-			else
-				texptr[i] = 0;
-		}
-	}
+	// Filled in by Sampler::GetFuncs(), possibly pointing at a decoded copy.
+	int texbufw[8];
+	u8 *texptr[8];
+	memcpy(texbufw, sampler.texbufw, sizeof(texbufw));
+	memcpy(texptr, sampler.texptr, sizeof(texptr));
 
 	TriangleEdge e0;
 	TriangleEdge e1;
@@ -692,6 +753,19 @@ void DrawTriangleSlice(
 	const bool flatColor1 = flatColorAll || (v0.color1 == v1.color1 && v0.color1 == v2.color1);
 	const bool noFog = clearMode || !gstate.isFogEnabled() || (v0.fogdepth >= 1.0f && v1.fogdepth >= 1.0f && v2.fogdepth >= 1.0f);
 
+	// Skip whole quads that are hidden, before spending time on interpolation and texturing.
+	// Without a stencil test, failing the depth test has no side effects, so this is safe.
+	const GEComparison depthFunc = pixelID.DepthTestFunc();
+	const bool earlyDepthTest = !clearMode && !pixelID.stencilTest && depthFunc >= GE_COMP_LESS && depthFunc <= GE_COMP_GEQUAL;
+	int earlyDepthZ = 0;
+	if (earlyDepthTest) {
+		// Interpolated z always stays within the range of the vertices.
+		if (depthFunc == GE_COMP_LESS || depthFunc == GE_COMP_LEQUAL)
+			earlyDepthZ = std::min(std::min(v0.screenpos.z, v1.screenpos.z), v2.screenpos.z);
+		else
+			earlyDepthZ = std::max(std::max(v0.screenpos.z, v1.screenpos.z), v2.screenpos.z);
+	}
+
 #if defined(SOFTGPU_MEMORY_TAGGING_DETAILED) || defined(SOFTGPU_MEMORY_TAGGING_BASIC)
 	uint32_t bpp = gstate.FrameBufFormat() == GE_FORMAT_8888 ? 4 : 2;
 	DisplayList currentList{};
@@ -725,7 +799,7 @@ void DrawTriangleSlice(
 
 			// If p is on or inside all edges, render pixel
 			Vec4<int> mask = MakeMask(w0, w1, w2, bias0, bias1, bias2, scissor_mask);
-			if (AnyMask(mask)) {
+			if (AnyMask(mask) && (!earlyDepthTest || AnyDepthMayPass(depthFunc, earlyDepthZ, mask, p))) {
 				Vec4<float> wsum_recip = EdgeRecip(w0, w1, w2);
 
 				Vec4<int> prim_color[4];
@@ -775,6 +849,9 @@ void DrawTriangleSlice(
 						// TODO: Tried making Vec4 do this, but things got slower.
 						const __m128i sec = _mm_and_si128(sec_color[i].ivec, _mm_set_epi32(0, -1, -1, -1));
 						prim_color[i].ivec = _mm_add_epi32(prim_color[i].ivec, sec);
+#elif PPSSPP_ARCH(ARM_NEON) && PPSSPP_ARCH(ARM64)
+						const int32x4_t sec = vsetq_lane_s32(0, sec_color[i].ivec, 3);
+						prim_color[i].ivec = vaddq_s32(prim_color[i].ivec, sec);
 #else
 						prim_color[i] += Vec4<int>(sec_color[i], 0);
 #endif
@@ -783,8 +860,7 @@ void DrawTriangleSlice(
 
 				Vec4<int> fog = Vec4<int>::AssignToAll(255);
 				if (!noFog) {
-					Vec4<float> fogdepths = w0.Cast<float>() * v0.fogdepth + w1.Cast<float>() * v1.fogdepth + w2.Cast<float>() * v2.fogdepth;
-					fogdepths = fogdepths * wsum_recip;
+					Vec4<float> fogdepths = Interpolate(v0.fogdepth, v1.fogdepth, v2.fogdepth, w0, w1, w2, wsum_recip);
 					for (int i = 0; i < 4; ++i) {
 						fog[i] = ClampFogDepth(fogdepths[i]);
 					}
@@ -795,8 +871,7 @@ void DrawTriangleSlice(
 					z = Vec4<int>::AssignToAll(v2.screenpos.z);
 				} else {
 					// TODO: Is that the correct way to interpolate?
-					Vec4<float> zfloats = w0.Cast<float>() * v0.screenpos.z + w1.Cast<float>() * v1.screenpos.z + w2.Cast<float>() * v2.screenpos.z;
-					z = (zfloats * wsum_recip).Cast<int>();
+					z = Interpolate((float)v0.screenpos.z, (float)v1.screenpos.z, (float)v2.screenpos.z, w0, w1, w2, wsum_recip).Cast<int>();
 				}
 
 				PROFILE_THIS_SCOPE("draw_tri_px");
@@ -838,6 +913,83 @@ void DrawTriangleSlice(
 #endif
 }
 
+// Triangles are queued into horizontal bands and drawn a whole batch at a time, so that many
+// small triangles can be spread over threads without waking them up for each one.
+// The queue only ever holds triangles for the current gstate, see FlushBins().
+static const int BIN_BAND_HEIGHT = 32 * 16;
+static const int MAX_BIN_BANDS = 0x10000 / BIN_BAND_HEIGHT;
+static const size_t MAX_BINNED_TRIANGLES = 1024;
+
+struct BinnedTriangle {
+	VertexData v0;
+	VertexData v1;
+	VertexData v2;
+	int minX, minY, maxX, maxY;
+};
+
+static std::vector<BinnedTriangle> binnedTriangles;
+static std::vector<int> binBands[MAX_BIN_BANDS];
+static PixelFuncID binnedPixelID;
+static Rasterizer::SingleFunc binnedDrawPixel;
+static Sampler::Funcs binnedSampler;
+static bool binnedClearMode;
+
+void FlushBins() {
+	if (binnedTriangles.empty())
+		return;
+	PROFILE_THIS_SCOPE("flush_bins");
+
+	int bands[MAX_BIN_BANDS];
+	int numBands = 0;
+	for (int i = 0; i < MAX_BIN_BANDS; ++i) {
+		if (!binBands[i].empty())
+			bands[numBands++] = i;
+	}
+
+	auto drawSlice = binnedClearMode ? &DrawTriangleSlice<true> : &DrawTriangleSlice<false>;
+	auto drawBands = [&](int a, int b) -> void {
+		for (int i = a; i < b; ++i) {
+			int bandY1 = bands[i] * BIN_BAND_HEIGHT;
+			int bandY2 = bandY1 + BIN_BAND_HEIGHT - 1;
+			// Each band only writes its own rows, so bands can be drawn in any order.
+			for (int index : binBands[bands[i]]) {
+				const BinnedTriangle &tri = binnedTriangles[index];
+				int y1 = std::max(tri.minY, bandY1);
+				int y2 = std::min(tri.maxY, bandY2);
+				drawSlice(tri.v0, tri.v1, tri.v2, tri.minX, y1, tri.maxX, y2, binnedPixelID, binnedDrawPixel, binnedSampler);
+			}
+		}
+	};
+
+	if (numBands > 1)
+		ParallelRangeLoop(&g_threadManager, drawBands, 0, numBands, 1);
+	else
+		drawBands(0, numBands);
+
+	for (int i = 0; i < numBands; ++i)
+		binBands[bands[i]].clear();
+	binnedTriangles.clear();
+}
+
+static void BinTriangle(const VertexData &v0, const VertexData &v1, const VertexData &v2, int minX, int minY, int maxX, int maxY, const PixelFuncID &pixelID, Rasterizer::SingleFunc drawPixel, const Sampler::Funcs &sampler) {
+	bool clearMode = gstate.isModeClear();
+	if (!binnedTriangles.empty()) {
+		bool sameState = binnedPixelID.fullKey == pixelID.fullKey && binnedClearMode == clearMode;
+		if (!sameState || binnedTriangles.size() >= MAX_BINNED_TRIANGLES)
+			FlushBins();
+	}
+
+	int index = (int)binnedTriangles.size();
+	binnedTriangles.push_back(BinnedTriangle{ v0, v1, v2, minX, minY, maxX, maxY });
+	for (int band = minY / BIN_BAND_HEIGHT; band <= maxY / BIN_BAND_HEIGHT; ++band)
+		binBands[band].push_back(index);
+
+	binnedPixelID = pixelID;
+	binnedDrawPixel = drawPixel;
+	binnedSampler = sampler;
+	binnedClearMode = clearMode;
+}
+
 // Draws triangle, vertices specified in counter-clockwise direction
 void DrawTriangle(const VertexData& v0, const VertexData& v1, const VertexData& v2)
 {
@@ -879,6 +1031,11 @@ void DrawTriangle(const VertexData& v0, const VertexData& v1, const VertexData&
 	Rasterizer::SingleFunc drawPixel = Rasterizer::GetSingleFunc(pixelID);
 	Sampler::Funcs sampler = Sampler::GetFuncs();
 
+	if (g_threadManager.GetNumLooperThreads() > 1) {
+		BinTriangle(v0, v1, v2, minX, minY, maxX, maxY, pixelID, drawPixel, sampler);
+		return;
+	}
+
 	auto drawSlice = gstate.isModeClear() ? &DrawTriangleSlice<true> : &DrawTriangleSlice<false>;
 
 	const int MIN_LINES_PER_THREAD = 4;
@@ -904,6 +1061,7 @@ void DrawTriangle(const VertexData& v0, const VertexData& v1, const VertexData&
 
 void DrawPoint(const VertexData &v0)
 {
+	FlushBins();
 	ScreenCoords pos = v0.screenpos;
 	Vec4<int> prim_color = v0.color0;
 	Vec3<int> sec_color = v0.color1;
@@ -923,27 +1081,16 @@ void DrawPoint(const VertexData &v0)
 	Rasterizer::SingleFunc drawPixel = Rasterizer::GetSingleFunc(pixelID);
 
 	if (gstate.isTextureMapEnabled() && !pixelID.clearMode) {
-		int texbufw[8] = {0};
-
 		int maxTexLevel = gstate.getTextureMaxLevel();
-		u8 *texptr[8] = {NULL};
-
 		if (!gstate.isMipmapEnabled()) {
 			// No mipmapping enabled
 			maxTexLevel = 0;
 		}
 
-		if (gstate.isTextureMapEnabled() && !pixelID.clearMode) {
-			GETextureFormat texfmt = gstate.getTextureFormat();
-			for (int i = 0; i <= maxTexLevel; i++) {
-				u32 texaddr = gstate.getTextureAddress(i);
-				texbufw[i] = GetTextureBufw(i, texaddr, texfmt);
-				if (Memory::IsValidAddress(texaddr))
-					texptr[i] = Memory::GetPointerUnchecked(texaddr);
-				else
-					texptr[i] = 0;
-			}
-		}
+		int texbufw[8];
+		u8 *texptr[8];
+		memcpy(texbufw, sampler.texbufw, sizeof(texbufw));
+		memcpy(texptr, sampler.texptr, sizeof(texptr));
 
 		float s = v0.texturecoords.s();
 		float t = v0.texturecoords.t();
@@ -999,6 +1146,7 @@ void DrawPoint(const VertexData &v0)
 
 void ClearRectangle(const VertexData &v0, const VertexData &v1)
 {
+	FlushBins();
 	int minX = std::min(v0.screenpos.x, v1.screenpos.x) & ~0xF;
 	int minY = std::min(v0.screenpos.y, v1.screenpos.y) & ~0xF;
 	int maxX = (std::max(v0.screenpos.x, v1.screenpos.x) + 0xF) & ~0xF;
@@ -1182,6 +1330,7 @@ void ClearRectangle(const VertexData &v0, const VertexData &v1)
 
 void DrawLine(const VertexData &v0, const VertexData &v1)
 {
+	FlushBins();
 	// TODO: Use a proper line drawing algorithm that handles fractional endpoints correctly.
 	Vec3<int> a(v0.screenpos.x, v0.screenpos.y, v0.screenpos.z);
 	Vec3<int> b(v1.screenpos.x, v1.screenpos.y, v0.screenpos.z);
@@ -1215,26 +1364,17 @@ void DrawLine(const VertexData &v0, const VertexData &v1)
 	PixelFuncID pixelID;
 	ComputePixelFuncID(&pixelID);
 
-	int texbufw[8] = {0};
-
 	int maxTexLevel = gstate.getTextureMaxLevel();
-	u8 *texptr[8] = {NULL};
-
 	if (!gstate.isMipmapEnabled()) {
 		// No mipmapping enabled
 		maxTexLevel = 0;
 	}
 
-	if (gstate.isTextureMapEnabled() && !pixelID.clearMode) {
-		GETextureFormat texfmt = gstate.getTextureFormat();
-		for (int i = 0; i <= maxTexLevel; i++) {
-			u32 texaddr = gstate.getTextureAddress(i);
-			texbufw[i] = GetTextureBufw(i, texaddr, texfmt);
-			texptr[i] = Memory::GetPointer(texaddr);
-		}
-	}
-
 	Sampler::Funcs sampler = Sampler::GetFuncs();
+	int texbufw[8];
+	u8 *texptr[8];
+	memcpy(texbufw, sampler.texbufw, sizeof(texbufw));
+	memcpy(texptr, sampler.texptr, sizeof(texptr));
 	Rasterizer::SingleFunc drawPixel = Rasterizer::GetSingleFunc(pixelID);
 
 #if defined(SOFTGPU_MEMORY_TAGGING_DETAILED) || defined(SOFTGPU_MEMORY_TAGGING_BASIC)
@@ -35,6 +35,9 @@ void DrawTriangle(const VertexData& v0, const VertexData& v1, const VertexData&
 void DrawPoint(const VertexData &v0);
 void DrawLine(const VertexData &v0, const VertexData &v1);
 void ClearRectangle(const VertexData &v0, const VertexData &v1);
+// Draws any triangles DrawTriangle() queued up.  Must happen before gstate or the queued
+// triangles' memory (framebuffer, textures, clut) change, or before anything reads the result.
+void FlushBins();
 
 bool GetCurrentStencilbuffer(GPUDebugBuffer &buffer);
 bool GetCurrentTexture(GPUDebugBuffer &buffer, int level);
@@ -77,14 +77,122 @@ static inline Vec4IntResult SOFTRAST_CALL ModulateRGBA(Vec4IntArg prim_in, Vec4I
 	return ToVec4IntResult(out);
 }
 
-void DrawSprite(const VertexData& v0, const VertexData& v1) {
-	const u8 *texptr = nullptr;
+// The state nearly all 2D sprites and fills use: no depth, stencil, or other per pixel tests,
+// and at most SRCALPHA/INVSRCALPHA blending plus an alpha test to drop transparent texels.
+// In that state, 8888 pixels can be written several at a time by BlitRow8888().
+static bool IsSimpleBlit8888(const PixelFuncID &pixelID) {
+	if (pixelID.FBFormat() != GE_FORMAT_8888)
+		return false;
+	if (pixelID.stencilTest || pixelID.DepthTestFunc() != GE_COMP_ALWAYS || pixelID.depthWrite || pixelID.applyDepthRange)
+		return false;
+	if (pixelID.applyLogicOp || pixelID.colorTest || pixelID.dithering || pixelID.applyFog || pixelID.applyColorWriteMask)
+		return false;
+
+	switch (pixelID.AlphaTestFunc()) {
+	case GE_COMP_ALWAYS:
+		break;
+	case GE_COMP_GREATER:
+	case GE_COMP_NOTEQUAL:
+		// With a ref of zero, both just mean "alpha isn't zero."
+		if (pixelID.alphaTestRef != 0 || pixelID.hasAlphaTestMask)
+			return false;
+		break;
+	default:
+		return false;
+	}
+
+	if (pixelID.alphaBlend) {
+		if (pixelID.AlphaBlendEq() != GE_BLENDMODE_MUL_AND_ADD)
+			return false;
+		if (pixelID.AlphaBlendSrc() != PixelBlendFactor::SRCALPHA || pixelID.AlphaBlendDst() != PixelBlendFactor::INVSRCALPHA)
+			return false;
+	}
+	return true;
+}
 
-	GETextureFormat texfmt = gstate.getTextureFormat();
-	u32 texaddr = gstate.getTextureAddress(0);
-	int texbufw = GetTextureBufw(0, texaddr, texfmt);
-	if (Memory::IsValidAddress(texaddr))
-		texptr = Memory::GetPointerUnchecked(texaddr);
+// Same rounding as AlphaBlendingResult(), so the result matches DrawSinglePixel().
+static inline u32 BlendSrcAlpha8888(u32 src, u32 dst) {
+	int sf = (src >> 24) * 2 + 1;
+	int df = (255 - (src >> 24)) * 2 + 1;
+	u32 result = 0;
+	for (int shift = 0; shift < 24; shift += 8) {
+		int s = (src >> shift) & 0xFF;
+		int d = (dst >> shift) & 0xFF;
+		int c = ((s * 2 + 1) * sf) / 1024 + ((d * 2 + 1) * df) / 1024;
+		result |= (u32)std::min(c, 255) << shift;
+	}
+	return result;
+}
+
+#if defined(_M_SSE)
+// Two pixels widened to 16 bits per channel.
+static inline __m128i BlendSrcAlpha16(__m128i src, __m128i dst) {
+	// Like AlphaBlendingResult, 4 bits of decimal make the 16 bit shift of mulhi free.
+	const __m128i half = _mm_set1_epi16(1 << 3);
+	const __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	const __m128i sf = _mm_add_epi16(_mm_slli_epi16(a, 4), half);
+	const __m128i df = _mm_add_epi16(_mm_slli_epi16(_mm_sub_epi16(_mm_set1_epi16(255), a), 4), half);
+	const __m128i s = _mm_mulhi_epi16(_mm_add_epi16(_mm_slli_epi16(src, 4), half), sf);
+	const __m128i d = _mm_mulhi_epi16(_mm_add_epi16(_mm_slli_epi16(dst, 4), half), df);
+	return _mm_adds_epi16(s, d);
+}
+
+static inline __m128i BlendSrcAlpha8888(__m128i src, __m128i dst) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lo = BlendSrcAlpha16(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero));
+	const __m128i hi = BlendSrcAlpha16(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero));
+	// Saturates, just like ToRGB() clamps.
+	return _mm_packus_epi16(lo, hi);
+}
+#endif
+
+// Writes one row of pixels in a state accepted by IsSimpleBlit8888().
+// Reads colors from src (stepping by ds, which may be -1 for mirrored sprites), or uses fill if src is null.
+template <bool alphaBlend, bool alphaTest>
+static void BlitRow8888(u32 *dst, int w, const u32 *src, int ds, u32 fill) {
+	int x = 0;
+#if defined(_M_SSE)
+	const __m128i stencilMask = _mm_set1_epi32(0xFF000000);
+	const __m128i fillv = _mm_set1_epi32(fill);
+	for (; x + 4 <= w; x += 4) {
+		__m128i s = fillv;
+		if (src && ds > 0) {
+			s = _mm_loadu_si128((const __m128i *)(src + x));
+		} else if (src) {
+			s = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(src - x - 3)), _MM_SHUFFLE(0, 1, 2, 3));
+		}
+		const __m128i d = _mm_loadu_si128((const __m128i *)(dst + x));
+
+		__m128i c = alphaBlend ? BlendSrcAlpha8888(s, d) : s;
+		// Without a stencil test, the stencil (alpha) is always kept.
+		c = _mm_or_si128(_mm_andnot_si128(stencilMask, c), _mm_and_si128(stencilMask, d));
+		if (alphaTest) {
+			const __m128i fail = _mm_cmpeq_epi32(_mm_and_si128(s, stencilMask), _mm_setzero_si128());
+			c = _mm_or_si128(_mm_andnot_si128(fail, c), _mm_and_si128(fail, d));
+		}
+		_mm_storeu_si128((__m128i *)(dst + x), c);
+	}
+#endif
+	for (; x < w; ++x) {
+		const u32 s = src ? src[x * ds] : fill;
+		if (alphaTest && (s >> 24) == 0)
+			continue;
+		const u32 c = alphaBlend ? BlendSrcAlpha8888(s, dst[x]) : s;
+		dst[x] = (c & 0x00FFFFFF) | (dst[x] & 0xFF000000);
+	}
+}
+
+typedef void (*BlitRow8888Func)(u32 *dst, int w, const u32 *src, int ds, u32 fill);
+
+static BlitRow8888Func GetBlitRow8888(const PixelFuncID &pixelID) {
+	bool alphaTest = pixelID.AlphaTestFunc() != GE_COMP_ALWAYS;
+	if (pixelID.alphaBlend)
+		return alphaTest ? &BlitRow8888<true, true> : &BlitRow8888<true, false>;
+	return alphaTest ? &BlitRow8888<false, true> : &BlitRow8888<false, false>;
+}
+
+void DrawSprite(const VertexData& v0, const VertexData& v1) {
+	FlushBins();
 
 	// These look at gstate.
 	SamplerID samplerID;
@@ -92,6 +200,14 @@ void DrawSprite(const VertexData& v0, const VertexData& v1) {
 	PixelFuncID pixelID;
 	ComputePixelFuncID(&pixelID);
 
+	// May switch samplerID over to a decoded copy of the texture.
+	u8 *texptrs[8]{};
+	int texbufws[8]{};
+	if (gstate.isTextureMapEnabled() && !pixelID.clearMode)
+		Sampler::PrepareTexture(samplerID, texptrs, texbufws);
+	const u8 *texptr = texptrs[0];
+	int texbufw = texbufws[0];
+
 	ScreenCoords pprime(v0.screenpos.x, v0.screenpos.y, 0);
 	Sampler::FetchFunc fetchFunc = Sampler::GetFetchFunc(samplerID);
 	Sampler::NearestFunc nearestFunc = Sampler::GetNearestFunc(samplerID);
@@ -189,6 +305,19 @@ void DrawSprite(const VertexData& v0, const VertexData& v1) {
 					}
 				}, pos0.y, pos1.y, MIN_LINES_PER_THREAD);
 			}
+		} else if (IsSimpleBlit8888(pixelID) && texptr && samplerID.TexFmt() == GE_TFMT_8888 && !samplerID.swizzle && !samplerID.hasInvalidPtr &&
+			gstate.isTextureAlphaUsed() && !gstate.isColorDoublingEnabled() &&
+			(gstate.getTextureFunction() == GE_TEXFUNC_REPLACE || (gstate.getTextureFunction() == GE_TEXFUNC_MODULATE && isWhite))) {
+			// Texels are used exactly as is (modulating by white changes nothing), so just copy rows.
+			BlitRow8888Func blitRow = GetBlitRow8888(pixelID);
+			ParallelRangeLoop(&g_threadManager, [=](int y1, int y2) {
+				int t = t_start + (y1 - pos0.y) * dt;
+				for (int y = y1; y < y2; y++) {
+					const u32 *src = (const u32 *)texptr + t * texbufw + s_start;
+					blitRow(fb.Get32Ptr(pos0.x, y, gstate.FrameBufStride()), pos1.x - pos0.x, src, ds, 0);
+					t += dt;
+				}
+			}, pos0.y, pos1.y, MIN_LINES_PER_THREAD);
 		} else {
 			int xoff = ((v0.screenpos.x & 15) + 1) / 2;
 			int yoff = ((v0.screenpos.y & 15) + 1) / 2;
@@ -244,6 +373,16 @@ void DrawSprite(const VertexData& v0, const VertexData& v1) {
 					}
 				}
 			}, pos0.y, pos1.y, MIN_LINES_PER_THREAD);
+		} else if (IsSimpleBlit8888(pixelID)) {
+			u32 fill = v1.color0.Clamp(0, 255).ToRGBA();
+			if (pixelID.AlphaTestFunc() != GE_COMP_ALWAYS && (fill >> 24) == 0)
+				return;
+
+			BlitRow8888Func blitRow = GetBlitRow8888(pixelID);
+			ParallelRangeLoop(&g_threadManager, [=](int y1, int y2) {
+				for (int y = y1; y < y2; y++)
+					blitRow(fb.Get32Ptr(pos0.x, y, gstate.FrameBufStride()), pos1.x - pos0.x, nullptr, 1, fill);
+			}, pos0.y, pos1.y, MIN_LINES_PER_THREAD);
 		} else {
 			ParallelRangeLoop(&g_threadManager, [=](int y1, int y2) {
 				for (int y = y1; y < y2; y++) {
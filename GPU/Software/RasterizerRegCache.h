@@ -61,6 +61,15 @@ typedef MIPSGen::MIPSCodeBlock CodeBlock;
 typedef FakeGen::FakeXCodeBlock CodeBlock;
 #endif
 
+// Counters for the pixel and sampler function caches, shown in the debug stats.
+struct JitCacheStats {
+	int hits = 0;
+	int compiles = 0;
+	// Compiles that failed and fall back to the generic C++ path.
+	int failures = 0;
+	int clears = 0;
+};
+
 // We also have the types of things that end up in regs.
 #if PPSSPP_ARCH(ARM64)
 typedef int32x4_t Vec4IntArg;
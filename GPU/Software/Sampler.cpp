@@ -16,12 +16,18 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include "ppsspp_config.h"
+#include <cstring>
 #include <unordered_map>
 #include <mutex>
+#include <vector>
+#include "ext/xxhash.h"
 #include "Common/Data/Convert/ColorConv.h"
 #include "Common/StringUtils.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Core/Config.h"
+#include "Core/MemMap.h"
 #include "Core/Reporting.h"
+#include "Core/ThreadPools.h"
 #include "GPU/Common/TextureDecoder.h"
 #include "GPU/GPUState.h"
 #include "GPU/Software/Rasterizer.h"
@@ -50,9 +56,12 @@ void Init() {
 	jitCache = new SamplerJitCache();
 }
 
+static void ClearTextureCache();
+
 void Shutdown() {
 	delete jitCache;
 	jitCache = nullptr;
+	ClearTextureCache();
 }
 
 bool DescribeCodePtr(const u8 *ptr, std::string &name) {
@@ -64,6 +73,11 @@ bool DescribeCodePtr(const u8 *ptr, std::string &name) {
 	return true;
 }
 
+Rasterizer::JitCacheStats GetJitStats() {
+	std::lock_guard<std::mutex> guard(jitCacheLock);
+	return jitCache->GetStats();
+}
+
 NearestFunc GetNearestFunc(SamplerID id) {
 	id.linear = false;
 	NearestFunc jitted = jitCache->GetNearest(id);
@@ -94,6 +108,217 @@ FetchFunc GetFetchFunc(SamplerID id) {
 	return &SampleFetch;
 }
 
+// Swizzled, CLUT, DXT, and 16-bit textures are decoded to linear RGBA8888 once here, rather
+// than at every sample (four times per pixel when filtering.)  Copies are only trusted until
+// InvalidateTextureCache(), after which the source data is hashed again before use.
+struct DecodedTextureKey {
+	u32 texaddr[8];
+	u32 texbufw[8];
+	u32 texsize[8];
+	u32 texformat;
+	u32 texmode;
+	u32 clutformat;
+	u32 levels;
+
+	bool operator ==(const DecodedTextureKey &other) const {
+		return memcmp(this, &other, sizeof(*this)) == 0;
+	}
+};
+
+struct DecodedTexture {
+	DecodedTextureKey key;
+	u64 dataHash = 0;
+	u32 validGen = 0;
+	int lastFrame = 0;
+	// Textures that keep changing cost more to decode than to sample directly.
+	int changes = 0;
+	std::vector<u32> data;
+	int offsets[8]{};
+	int bufw[8]{};
+};
+
+static const size_t MAX_DECODED_TEXTURE_BYTES = 64 * 1024 * 1024;
+static const int MAX_DECODED_TEXTURE_CHANGES = 8;
+static const int DECODED_TEXTURE_KEEP_FRAMES = 120;
+
+static std::unordered_map<u64, DecodedTexture> decodedTextures;
+static size_t decodedTextureBytes = 0;
+static u32 textureCacheGen = 1;
+static int textureCacheFrame = 0;
+
+static void ClearTextureCache() {
+	decodedTextures.clear();
+	decodedTextureBytes = 0;
+}
+
+void InvalidateTextureCache() {
+	textureCacheGen++;
+}
+
+void DecimateTextureCache() {
+	textureCacheFrame++;
+	// Over budget, keep only what this frame used.
+	int keepFrames = decodedTextureBytes > MAX_DECODED_TEXTURE_BYTES / 2 ? 1 : DECODED_TEXTURE_KEEP_FRAMES;
+	for (auto it = decodedTextures.begin(); it != decodedTextures.end(); ) {
+		if (it->second.lastFrame + keepFrames < textureCacheFrame) {
+			decodedTextureBytes -= it->second.data.size() * sizeof(u32);
+			it = decodedTextures.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+static bool TextureOverlapsRenderTarget(u32 addr, u32 bytes) {
+	// Only VRAM can be rendered to, and we may be drawing to a mirror.
+	if (!Memory::IsVRAMAddress(addr))
+		return false;
+	const u32 vramMask = 0x001FFFFF;
+	const u32 lines = gstate.getRegionY2() + 1;
+	const u32 fbStart = gstate.getFrameBufAddress() & vramMask;
+	const u32 fbBytes = gstate.FrameBufStride() * lines * (gstate.FrameBufFormat() == GE_FORMAT_8888 ? 4 : 2);
+	const u32 zStart = gstate.getDepthBufAddress() & vramMask;
+	const u32 zBytes = gstate.DepthBufStride() * lines * 2;
+	addr &= vramMask;
+	return (addr < fbStart + fbBytes && fbStart < addr + bytes) || (addr < zStart + zBytes && zStart < addr + bytes);
+}
+
+static u64 HashTextureData(int levels, const u32 *bytes) {
+	u64 hash = 0;
+	for (int i = 0; i < levels; ++i)
+		hash = XXH3_64bits_withSeed(Memory::GetPointerUnchecked(gstate.getTextureAddress(i)), bytes[i], hash);
+	if (gstate.isTextureFormatIndexed())
+		hash = XXH3_64bits_withSeed(clut, sizeof(clut), hash);
+	return hash;
+}
+
+static void DecodeTexture(DecodedTexture &tex, const SamplerID &id, int levels, const int *bufw) {
+	FetchFunc fetch = GetFetchFunc(id);
+
+	size_t pixels = 0;
+	for (int i = 0; i < levels; ++i) {
+		// Keep to the 16 byte minimum stride the samplers assume for small textures.
+		tex.bufw[i] = std::max(gstate.getTextureWidth(i), 4);
+		tex.offsets[i] = (int)pixels;
+		pixels += tex.bufw[i] * gstate.getTextureHeight(i);
+	}
+	decodedTextureBytes -= tex.data.size() * sizeof(u32);
+	tex.data.resize(pixels);
+	decodedTextureBytes += tex.data.size() * sizeof(u32);
+
+	for (int i = 0; i < levels; ++i) {
+		const u8 *src = Memory::GetPointerUnchecked(gstate.getTextureAddress(i));
+		u32 *dst = &tex.data[tex.offsets[i]];
+		const int w = tex.bufw[i];
+		const int srcBufw = bufw[i];
+		ParallelRangeLoop(&g_threadManager, [=](int y1, int y2) {
+			for (int y = y1; y < y2; ++y) {
+				u32 *row = dst + y * w;
+				for (int x = 0; x < w; ++x)
+					row[x] = Vec4<int>(fetch(x, y, src, srcBufw, i)).ToRGBA();
+			}
+		}, 0, gstate.getTextureHeight(i), 32);
+	}
+}
+
+void PrepareTexture(SamplerID &id, u8 *texptr[8], int texbufw[8]) {
+	const GETextureFormat texfmt = gstate.getTextureFormat();
+	const int levels = gstate.isMipmapEnabled() ? gstate.getTextureMaxLevel() + 1 : 1;
+	for (int i = 0; i < levels; ++i) {
+		u32 texaddr = gstate.getTextureAddress(i);
+		texbufw[i] = GetTextureBufw(i, texaddr, texfmt);
+		texptr[i] = Memory::IsValidAddress(texaddr) ? Memory::GetPointerUnchecked(texaddr) : nullptr;
+	}
+
+	// Plain 8888 is already what we'd decode to.
+	if (texfmt == GE_TFMT_8888 && !id.swizzle)
+		return;
+	if (id.hasInvalidPtr || !id.overReadSafe || levels > 8)
+		return;
+
+	DecodedTextureKey key{};
+	for (int i = 0; i < levels; ++i) {
+		key.texaddr[i] = gstate.texaddr[i];
+		key.texbufw[i] = gstate.texbufwidth[i];
+		key.texsize[i] = gstate.texsize[i];
+	}
+	key.texformat = gstate.texformat;
+	key.texmode = gstate.texmode;
+	key.clutformat = gstate.isTextureFormatIndexed() ? gstate.clutformat : 0;
+	key.levels = levels;
+
+	u32 bytes[8];
+	for (int i = 0; i < levels; ++i) {
+		bytes[i] = textureBitsPerPixel[texfmt] * texbufw[i] * gstate.getTextureHeight(i) / 8;
+		// Can't trust a copy of something we might be drawing to right now.
+		if (TextureOverlapsRenderTarget(gstate.getTextureAddress(i), bytes[i]))
+			return;
+	}
+
+	const u64 keyHash = XXH3_64bits(&key, sizeof(key));
+	auto it = decodedTextures.find(keyHash);
+	if (it == decodedTextures.end()) {
+		if (decodedTextureBytes >= MAX_DECODED_TEXTURE_BYTES)
+			return;
+		it = decodedTextures.emplace(keyHash, DecodedTexture()).first;
+		it->second.key = key;
+	} else if (!(it->second.key == key)) {
+		// Hash collision, just start over with the new one.
+		FlushBins();
+		decodedTextureBytes -= it->second.data.size() * sizeof(u32);
+		it->second = DecodedTexture();
+		it->second.key = key;
+	}
+
+	DecodedTexture &tex = it->second;
+	tex.lastFrame = textureCacheFrame;
+	if (tex.changes > MAX_DECODED_TEXTURE_CHANGES)
+		return;
+
+	if (tex.validGen != textureCacheGen) {
+		u64 dataHash = HashTextureData(levels, bytes);
+		if (tex.data.empty() || dataHash != tex.dataHash) {
+			if (!tex.data.empty() && ++tex.changes > MAX_DECODED_TEXTURE_CHANGES) {
+				FlushBins();
+				decodedTextureBytes -= tex.data.size() * sizeof(u32);
+				tex.data.clear();
+				tex.data.shrink_to_fit();
+				return;
+			}
+			// Queued triangles might still sample the old copy.
+			FlushBins();
+			DecodeTexture(tex, id, levels, texbufw);
+			tex.dataHash = dataHash;
+		}
+		tex.validGen = textureCacheGen;
+	}
+
+	for (int i = 0; i < levels; ++i) {
+		texptr[i] = (u8 *)&tex.data[tex.offsets[i]];
+		texbufw[i] = tex.bufw[i];
+	}
+
+	id.texfmt = GE_TFMT_8888;
+	id.swizzle = false;
+	id.clutfmt = 0;
+	id.useSharedClut = true;
+	id.hasClutMask = false;
+	id.hasClutShift = false;
+	id.hasClutOffset = false;
+	id.useStandardBufw = true;
+}
+
+Funcs GetFuncs() {
+	Funcs f{};
+	SamplerID id;
+	ComputeSamplerID(&id);
+	if (gstate.isTextureMapEnabled() && !gstate.isModeClear())
+		PrepareTexture(id, f.texptr, f.texbufw);
+	f.nearest = GetNearestFunc(id);
+	f.linear = GetLinearFunc(id);
+	return f;
+}
+
 SamplerJitCache::SamplerJitCache()
 #if PPSSPP_ARCH(ARM64)
  : fp(this)
@@ -120,6 +345,7 @@ void SamplerJitCache::Clear() {
 	ClearCodeSpace(0);
 	cache_.clear();
 	addresses_.clear();
+	stats_.clears++;
 
 	const10All16_ = nullptr;
 	const10Low_ = nullptr;
@@ -175,6 +401,7 @@ NearestFunc SamplerJitCache::GetNearest(const SamplerID &id) {
 
 	auto it = cache_.find(id);
 	if (it != cache_.end()) {
+		stats_.hits++;
 		return (NearestFunc)it->second;
 	}
 
@@ -188,6 +415,9 @@ NearestFunc SamplerJitCache::GetNearest(const SamplerID &id) {
 		addresses_[id] = GetCodePointer();
 		NearestFunc func = CompileNearest(id);
 		cache_[id] = (NearestFunc)func;
+		stats_.compiles++;
+		if (!func)
+			stats_.failures++;
 		return func;
 	}
 #endif
@@ -199,6 +429,7 @@ LinearFunc SamplerJitCache::GetLinear(const SamplerID &id) {
 
 	auto it = cache_.find(id);
 	if (it != cache_.end()) {
+		stats_.hits++;
 		return (LinearFunc)it->second;
 	}
 
@@ -212,6 +443,9 @@ LinearFunc SamplerJitCache::GetLinear(const SamplerID &id) {
 		addresses_[id] = GetCodePointer();
 		LinearFunc func = CompileLinear(id);
 		cache_[id] = (NearestFunc)func;
+		stats_.compiles++;
+		if (!func)
+			stats_.failures++;
 		return func;
 	}
 #endif
@@ -223,6 +457,7 @@ FetchFunc SamplerJitCache::GetFetch(const SamplerID &id) {
 
 	auto it = cache_.find(id);
 	if (it != cache_.end()) {
+		stats_.hits++;
 		return (FetchFunc)it->second;
 	}
 
@@ -236,6 +471,9 @@ FetchFunc SamplerJitCache::GetFetch(const SamplerID &id) {
 		addresses_[id] = GetCodePointer();
 		FetchFunc func = CompileFetch(id);
 		cache_[id] = (NearestFunc)func;
+		stats_.compiles++;
+		if (!func)
+			stats_.failures++;
 		return func;
 	}
 #endif
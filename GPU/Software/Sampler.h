@@ -45,20 +45,25 @@ LinearFunc GetLinearFunc(SamplerID id);
 struct Funcs {
 	NearestFunc nearest;
 	LinearFunc linear;
+	// Where to sample each level from: texture memory, or a decoded copy (see PrepareTexture.)
+	u8 *texptr[8];
+	int texbufw[8];
 };
-static inline Funcs GetFuncs() {
-	Funcs f;
-	SamplerID id;
-	ComputeSamplerID(&id);
-	f.nearest = GetNearestFunc(id);
-	f.linear = GetLinearFunc(id);
-	return f;
-}
+Funcs GetFuncs();
+
+// Fills texptr/texbufw for each level of the current texture.  When a linear RGBA8888 copy
+// is cached (or worth decoding), those point at it instead, and id is changed to sample it.
+void PrepareTexture(SamplerID &id, u8 *texptr[8], int texbufw[8]);
+// Texture memory may have changed, so decoded copies must be checked again before use.
+void InvalidateTextureCache();
+// Drops decoded copies not used in a while.  Must not be called with triangles still queued.
+void DecimateTextureCache();
 
 void Init();
 void Shutdown();
 
 bool DescribeCodePtr(const u8 *ptr, std::string &name);
+Rasterizer::JitCacheStats GetJitStats();
 
 class SamplerJitCache : public Rasterizer::CodeBlock {
 public:
@@ -71,6 +76,9 @@ class SamplerJitCache : public Rasterizer::CodeBlock {
 	void Clear();
 
 	std::string DescribeCodePtr(const u8 *ptr);
+	Rasterizer::JitCacheStats GetStats() const {
+		return stats_;
+	}
 
 private:
 	FetchFunc CompileFetch(const SamplerID &id);
@@ -138,6 +146,7 @@ class SamplerJitCache : public Rasterizer::CodeBlock {
 	std::unordered_map<SamplerID, const u8 *> addresses_;
 	std::unordered_map<const u8 *, std::string> descriptions_;
 	Rasterizer::RegCache regCache_;
+	Rasterizer::JitCacheStats stats_;
 };
 
 #if defined(__clang__) || defined(__GNUC__)
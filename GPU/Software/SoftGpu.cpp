@@ -165,11 +165,6 @@ void SoftGPU::CopyToCurrentFboFromDisplayRam(int srcwidth, int srcheight) {
 	float v0 = 0.0f;
 	float v1 = 1.0f;
 
-	if (fbTex) {
-		fbTex->Release();
-		fbTex = nullptr;
-	}
-
 	// For accuracy, try to handle 0 stride - sometimes used.
 	if (displayStride_ == 0) {
 		srcheight = 1;
@@ -245,15 +240,45 @@ void SoftGPU::CopyToCurrentFboFromDisplayRam(int srcwidth, int srcheight) {
 			desc.initData.push_back(data);
 		}
 	} else {
-		ConvertTextureDescFrom16(desc, srcwidth, srcheight);
-		u1 = 1.0f;
+		// Same as above, but for the other 16-bit formats. The PSP packs red in the low bits.
+		u8 *data = Memory::GetPointer(displayFramebuf_);
+		Draw::DataFormat nativeFormat = displayFormat_ == GE_FORMAT_565 ? Draw::DataFormat::B5G6R5_UNORM_PACK16 : Draw::DataFormat::UNDEFINED;
+		Draw::DataFormat swappedFormat = displayFormat_ == GE_FORMAT_565 ? Draw::DataFormat::R5G6B5_UNORM_PACK16 : Draw::DataFormat::A4R4G4B4_UNORM_PACK16;
+		if (nativeFormat != Draw::DataFormat::UNDEFINED && (draw_->GetDataFormatSupport(nativeFormat) & Draw::FMT_TEXTURE)) {
+			desc.format = nativeFormat;
+		} else if (!hasPostShader && (draw_->GetDataFormatSupport(swappedFormat) & Draw::FMT_TEXTURE)) {
+			desc.format = swappedFormat;
+			outputFlags |= OutputFlags::RB_SWIZZLE;
+		} else {
+			data = nullptr;
+		}
+		if (data) {
+			desc.width = displayStride_ == 0 ? srcwidth : displayStride_;
+			desc.height = srcheight;
+			desc.initData.push_back(data);
+		} else {
+			ConvertTextureDescFrom16(desc, srcwidth, srcheight);
+			u1 = 1.0f;
+		}
 	}
 	if (!hasImage) {
 		draw_->BindFramebufferAsRenderTarget(nullptr, { Draw::RPAction::CLEAR, Draw::RPAction::DONT_CARE, Draw::RPAction::DONT_CARE }, "CopyToCurrentFboFromDisplayRam");
 		return;
 	}
 
-	fbTex = draw_->CreateTexture(desc);
+	// Reuse last frame's texture if we can, this way the backend can stream the data through its
+	// upload buffer instead of creating and destroying a texture every frame.
+	bool updated = fbTex && fbTexFormat_ == desc.format && fbTexWidth_ == desc.width && fbTexHeight_ == desc.height;
+	if (updated)
+		updated = draw_->UpdateTextureRect(fbTex, 0, 0, desc.width, desc.height, desc.initData[0]);
+	if (!updated) {
+		if (fbTex)
+			fbTex->Release();
+		fbTex = draw_->CreateTexture(desc);
+		fbTexFormat_ = desc.format;
+		fbTexWidth_ = desc.width;
+		fbTexHeight_ = desc.height;
+	}
 
 	switch (GetGPUBackend()) {
 	case GPUBackend::OPENGL:
@@ -272,6 +297,8 @@ void SoftGPU::CopyToCurrentFboFromDisplayRam(int srcwidth, int srcheight) {
 }
 
 void SoftGPU::CopyDisplayToOutput(bool reallyDirty) {
+	Rasterizer::FlushBins();
+	Sampler::DecimateTextureCache();
 	// The display always shows 480x272.
 	CopyToCurrentFboFromDisplayRam(FB_WIDTH, FB_HEIGHT);
 	framebufferDirty_ = false;
@@ -293,6 +320,43 @@ void SoftGPU::Resized() {
 	}
 }
 
+// Whether queued triangles must be drawn before this command changes gstate.
+static bool CommandNeedsFlush(u32 cmd, u32 diff) {
+	switch (cmd) {
+	case GE_CMD_LOADCLUT:
+	case GE_CMD_TRANSFERSTART:
+		// These act even if the value is the same.
+		return true;
+
+	case GE_CMD_NOP:
+	case GE_CMD_BASE:
+	case GE_CMD_VADDR:
+	case GE_CMD_IADDR:
+	case GE_CMD_PRIM:
+	case GE_CMD_BEZIER:
+	case GE_CMD_SPLINE:
+	case GE_CMD_JUMP:
+	case GE_CMD_BJUMP:
+	case GE_CMD_CALL:
+	case GE_CMD_RET:
+	case GE_CMD_WORLDMATRIXNUMBER:
+	case GE_CMD_WORLDMATRIXDATA:
+	case GE_CMD_VIEWMATRIXNUMBER:
+	case GE_CMD_VIEWMATRIXDATA:
+	case GE_CMD_PROJMATRIXNUMBER:
+	case GE_CMD_PROJMATRIXDATA:
+	case GE_CMD_TGENMATRIXNUMBER:
+	case GE_CMD_TGENMATRIXDATA:
+	case GE_CMD_BONEMATRIXNUMBER:
+	case GE_CMD_BONEMATRIXDATA:
+		// Only used while transforming vertices, before triangles are queued.
+		return false;
+
+	default:
+		return diff != 0;
+	}
+}
+
 void SoftGPU::FastRunLoop(DisplayList &list) {
 	PROFILE_THIS_SCOPE("soft_runloop");
 	for (; downcount > 0; --downcount) {
@@ -300,6 +364,8 @@ void SoftGPU::FastRunLoop(DisplayList &list) {
 		u32 cmd = op >> 24;
 
 		u32 diff = op ^ gstate.cmdmem[cmd];
+		if (CommandNeedsFlush(cmd, diff))
+			Rasterizer::FlushBins();
 		gstate.cmdmem[cmd] = op;
 		ExecuteOp(op, diff);
 
@@ -307,6 +373,17 @@ void SoftGPU::FastRunLoop(DisplayList &list) {
 	}
 }
 
+void SoftGPU::PreExecuteOp(u32 op, u32 diff) {
+	if (CommandNeedsFlush(op >> 24, diff))
+		Rasterizer::FlushBins();
+}
+
+void SoftGPU::FinishDeferred() {
+	// The CPU may change memory before the next list runs.
+	Rasterizer::FlushBins();
+	Sampler::InvalidateTextureCache();
+}
+
 void SoftGPU::ExecuteOp(u32 op, u32 diff) {
 	u32 cmd = op >> 24;
 	u32 data = op & 0xFFFFFF;
@@ -499,7 +576,12 @@ void SoftGPU::ExecuteOp(u32 op, u32 diff) {
 		break;
 
 	case GE_CMD_REGION1:
+		break;
+
 	case GE_CMD_REGION2:
+		// Changes how much of the framebuffer counts as drawn to, see Sampler::PrepareTexture().
+		if (diff)
+			Sampler::InvalidateTextureCache();
 		break;
 
 	case GE_CMD_DEPTHCLAMPENABLE:
@@ -555,13 +637,20 @@ void SoftGPU::ExecuteOp(u32 op, u32 diff) {
 
 	case GE_CMD_FRAMEBUFPTR:
 		fb.data = Memory::GetPointer(gstate.getFrameBufAddress());
+		// What we drew to before may be used as a texture now.
+		if (diff)
+			Sampler::InvalidateTextureCache();
 		break;
 
 	case GE_CMD_FRAMEBUFWIDTH:
 		fb.data = Memory::GetPointer(gstate.getFrameBufAddress());
+		if (diff)
+			Sampler::InvalidateTextureCache();
 		break;
 
 	case GE_CMD_FRAMEBUFPIXFORMAT:
+		if (diff)
+			Sampler::InvalidateTextureCache();
 		break;
 
 	case GE_CMD_TEXADDR0:
@@ -605,6 +694,7 @@ void SoftGPU::ExecuteOp(u32 op, u32 diff) {
 				DEBUG_LOG(G3D, "Software: Invalid CLUT address, filling with garbage instead of crashing");
 				memset(clut, 0x00, clutTotalBytes);
 			}
+			Sampler::InvalidateTextureCache();
 		}
 		break;
 
@@ -620,6 +710,7 @@ void SoftGPU::ExecuteOp(u32 op, u32 diff) {
 
 	case GE_CMD_TRANSFERSTART:
 		{
+			Sampler::InvalidateTextureCache();
 			u32 srcBasePtr = gstate.getTransferSrcAddress();
 			u32 srcStride = gstate.getTransferSrcStride();
 
@@ -671,10 +762,14 @@ void SoftGPU::ExecuteOp(u32 op, u32 diff) {
 
 	case GE_CMD_ZBUFPTR:
 		depthbuf.data = Memory::GetPointer(gstate.getDepthBufAddress());
+		if (diff)
+			Sampler::InvalidateTextureCache();
 		break;
 
 	case GE_CMD_ZBUFWIDTH:
 		depthbuf.data = Memory::GetPointer(gstate.getDepthBufAddress());
+		if (diff)
+			Sampler::InvalidateTextureCache();
 		break;
 
 	case GE_CMD_AMBIENTCOLOR:
@@ -868,12 +963,19 @@ void SoftGPU::ExecuteOp(u32 op, u32 diff) {
 }
 
 void SoftGPU::GetStats(char *buffer, size_t bufsize) {
-	snprintf(buffer, bufsize, "SoftGPU: (N/A)");
+	Rasterizer::JitCacheStats pixel = Rasterizer::GetJitStats();
+	Rasterizer::JitCacheStats sampler = Sampler::GetJitStats();
+	snprintf(buffer, bufsize,
+		"SoftGPU:\n"
+		"Pixel funcs: %d compiled (%d failed), %d hits, %d clears\n"
+		"Sampler funcs: %d compiled (%d failed), %d hits, %d clears\n",
+		pixel.compiles, pixel.failures, pixel.hits, pixel.clears,
+		sampler.compiles, sampler.failures, sampler.hits, sampler.clears);
 }
 
 void SoftGPU::InvalidateCache(u32 addr, int size, GPUInvalidationType type)
 {
-	// Nothing to invalidate.
+	Sampler::InvalidateTextureCache();
 }
 
 void SoftGPU::NotifyVideoUpload(u32 addr, int size, int width, int format)
@@ -883,6 +985,7 @@ void SoftGPU::NotifyVideoUpload(u32 addr, int size, int width, int format)
 
 bool SoftGPU::PerformMemoryCopy(u32 dest, u32 src, int size)
 {
+	gpuStats.numMemoryCopyBytes += size;
 	// Nothing to update.
 	InvalidateCache(dest, size, GPU_INVALIDATE_HINT);
 	GPURecord::NotifyMemcpy(dest, src, size);
@@ -931,6 +1034,7 @@ bool SoftGPU::FramebufferDirty() {
 }
 
 bool SoftGPU::GetCurrentFramebuffer(GPUDebugBuffer &buffer, GPUDebugFramebufferType type, int maxRes) {
+	Rasterizer::FlushBins();
 	int x1 = gstate.getRegionX1();
 	int y1 = gstate.getRegionY1();
 	int x2 = gstate.getRegionX2() + 1;
@@ -967,6 +1071,7 @@ bool SoftGPU::GetOutputFramebuffer(GPUDebugBuffer &buffer) {
 
 bool SoftGPU::GetCurrentDepthbuffer(GPUDebugBuffer &buffer)
 {
+	Rasterizer::FlushBins();
 	const int w = gstate.getRegionX2() - gstate.getRegionX1() + 1;
 	const int h = gstate.getRegionY2() - gstate.getRegionY1() + 1;
 	buffer.Allocate(w, h, GPU_DBG_FORMAT_16BIT);
@@ -984,6 +1089,7 @@ bool SoftGPU::GetCurrentDepthbuffer(GPUDebugBuffer &buffer)
 
 bool SoftGPU::GetCurrentStencilbuffer(GPUDebugBuffer &buffer)
 {
+	Rasterizer::FlushBins();
 	return Rasterizer::GetCurrentStencilbuffer(buffer);
 }
 
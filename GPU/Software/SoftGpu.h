@@ -64,6 +64,7 @@ class SoftGPU : public GPUCommon {
 
 	void CheckGPUFeatures() override {}
 	void InitClear() override {}
+	void PreExecuteOp(u32 op, u32 diff) override;
 	void ExecuteOp(u32 op, u32 diff) override;
 
 	void SetDisplayFramebuffer(u32 framebuf, u32 stride, GEBufferFormat format) override;
@@ -105,6 +106,7 @@ class SoftGPU : public GPUCommon {
 
 protected:
 	void FastRunLoop(DisplayList &list) override;
+	void FinishDeferred() override;
 	void CopyToCurrentFboFromDisplayRam(int srcwidth, int srcheight);
 	void ConvertTextureDescFrom16(Draw::TextureDesc &desc, int srcwidth, int srcheight, u8 *overrideData = nullptr);
 
@@ -118,6 +120,10 @@ class SoftGPU : public GPUCommon {
 	SoftwareDrawEngine *drawEngine_ = nullptr;
 
 	Draw::Texture *fbTex = nullptr;
+	// What fbTex was created with, so it can be updated in place next frame.
+	Draw::DataFormat fbTexFormat_ = Draw::DataFormat::UNDEFINED;
+	int fbTexWidth_ = 0;
+	int fbTexHeight_ = 0;
 	std::vector<u32> fbTexBuffer_;
 };
 
@@ -22,7 +22,9 @@
 #include "Common/Math/math_util.h"
 #include "Common/MemoryUtil.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Core/Config.h"
+#include "Core/ThreadPools.h"
 #include "GPU/GPUState.h"
 #include "GPU/Common/DrawEngineCommon.h"
 #include "GPU/Common/VertexDecoderCommon.h"
@@ -35,6 +37,9 @@
 
 #define TRANSFORM_BUF_SIZE (65536 * 48)
 
+// Below this, the threads cost more to wake than the transform itself.
+static const int MIN_PRETRANSFORM_VERTS = 256;
+
 TransformUnit::TransformUnit() {
 	decoded_ = (u8 *)AllocateMemoryPages(TRANSFORM_BUF_SIZE, MEM_PROT_READ | MEM_PROT_WRITE);
 }
@@ -326,6 +331,39 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 
 	VertexReader vreader(decoded_, vtxfmt, vertex_type);
 
+	// Larger 3D draws are transformed and lit up front on worker threads, which also avoids
+	// repeating the work for shared vertices.  Clipping and rasterization below still go in order.
+	const int decodedCount = index_upper_bound - index_lower_bound + 1;
+	const bool preTransformed = !gstate.isModeThrough() && decodedCount >= MIN_PRETRANSFORM_VERTS && g_threadManager.GetNumLooperThreads() > 1;
+	if (preTransformed) {
+		PROFILE_THIS_SCOPE("pretransform");
+		if (transformed_.size() < (size_t)decodedCount) {
+			transformed_.resize(decodedCount);
+			transformedOutside_.resize(decodedCount);
+		}
+		ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+			VertexReader reader(decoded_, vtxfmt, vertex_type);
+			for (int i = l; i < h; ++i) {
+				bool outside = false;
+				reader.Goto(i);
+				transformed_[i] = ReadVertex(reader, outside);
+				transformedOutside_[i] = outside;
+			}
+		}, 0, decodedCount, MIN_PRETRANSFORM_VERTS / 4);
+	}
+
+	bool outside_range_flag = false;
+	auto readVertex = [&](int vtx) -> VertexData {
+		int index = indices ? ConvertIndex(vtx) - index_lower_bound : vtx;
+		if (preTransformed) {
+			if (transformedOutside_[index])
+				outside_range_flag = true;
+			return transformed_[index];
+		}
+		vreader.Goto(index);
+		return ReadVertex(vreader, outside_range_flag);
+	};
+
 	static VertexData data[4];  // Normally max verts per prim is 3, but we temporarily need 4 to detect rectangles from strips.
 	// This is the index of the next vert in data (or higher, may need modulus.)
 	static int data_index = 0;
@@ -347,23 +385,13 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 	default: vtcs_per_prim = 0; break;
 	}
 
-	// TODO: Do this in two passes - first process the vertices (before indexing/stripping),
-	// then resolve the indices. This lets us avoid transforming shared vertices twice.
-
-	bool outside_range_flag = false;
 	switch (prim_type) {
 	case GE_PRIM_POINTS:
 	case GE_PRIM_LINES:
 	case GE_PRIM_TRIANGLES:
 		{
 			for (int vtx = 0; vtx < vertex_count; ++vtx) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-				} else {
-					vreader.Goto(vtx);
-				}
-
-				data[data_index++] = ReadVertex(vreader, outside_range_flag);
+				data[data_index++] = readVertex(vtx);
 				if (data_index < vtcs_per_prim) {
 					// Keep reading.  Note: an incomplete prim will stay read for GE_PRIM_KEEP_PREVIOUS.
 					continue;
@@ -408,13 +436,7 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 
 	case GE_PRIM_RECTANGLES:
 		for (int vtx = 0; vtx < vertex_count; ++vtx) {
-			if (indices) {
-				vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-			} else {
-				vreader.Goto(vtx);
-			}
-
-			data[data_index++] = ReadVertex(vreader, outside_range_flag);
+			data[data_index++] = readVertex(vtx);
 			if (outside_range_flag) {
 				outside_range_flag = false;
 				// Note: this is the post increment index.  If odd, we set the first vert.
@@ -454,13 +476,7 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 			// If data_index is 1 or 2, etc., it means we're continuing a line strip.
 			int skip_count = data_index == 0 ? 1 : 0;
 			for (int vtx = 0; vtx < vertex_count; ++vtx) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-				} else {
-					vreader.Goto(vtx);
-				}
-
-				data[(data_index++) & 1] = ReadVertex(vreader, outside_range_flag);
+				data[(data_index++) & 1] = readVertex(vtx);
 				if (outside_range_flag) {
 					// Drop all primitives containing the current vertex
 					skip_count = 2;
@@ -487,13 +503,7 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 			// This is for Darkstalkers (and should speed up many 2D games).
 			if (data_index == 0 && vertex_count == 4 && gstate.isModeThrough()) {
 				for (int vtx = 0; vtx < 4; ++vtx) {
-					if (indices) {
-						vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-					}
-					else {
-						vreader.Goto(vtx);
-					}
-					data[vtx] = ReadVertex(vreader, outside_range_flag);
+					data[vtx] = readVertex(vtx);
 				}
 
 				// If a strip is effectively a rectangle, draw it as such!
@@ -505,14 +515,8 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 
 			outside_range_flag = false;
 			for (int vtx = 0; vtx < vertex_count; ++vtx) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-				} else {
-					vreader.Goto(vtx);
-				}
-
 				int provoking_index = (data_index++) % 3;
-				data[provoking_index] = ReadVertex(vreader, outside_range_flag);
+				data[provoking_index] = readVertex(vtx);
 				if (outside_range_flag) {
 					// Drop all primitives containing the current vertex
 					skip_count = 2;
@@ -548,12 +552,7 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 
 			// Only read the central vertex if we're not continuing.
 			if (data_index == 0) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(0) - index_lower_bound);
-				} else {
-					vreader.Goto(0);
-				}
-				data[0] = ReadVertex(vreader, outside_range_flag);
+				data[0] = readVertex(0);
 				data_index++;
 				start_vtx = 1;
 
@@ -564,12 +563,7 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 
 			if (data_index == 1 && vertex_count == 4 && gstate.isModeThrough()) {
 				for (int vtx = start_vtx; vtx < vertex_count; ++vtx) {
-					if (indices) {
-						vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-					} else {
-						vreader.Goto(vtx);
-					}
-					data[vtx] = ReadVertex(vreader, outside_range_flag);
+					data[vtx] = readVertex(vtx);
 				}
 
 				int tl = -1, br = -1;
@@ -581,14 +575,8 @@ void TransformUnit::SubmitPrimitive(void* vertices, void* indices, GEPrimitiveTy
 
 			outside_range_flag = false;
 			for (int vtx = start_vtx; vtx < vertex_count; ++vtx) {
-				if (indices) {
-					vreader.Goto(ConvertIndex(vtx) - index_lower_bound);
-				} else {
-					vreader.Goto(vtx);
-				}
-
 				int provoking_index = 2 - ((data_index++) % 2);
-				data[provoking_index] = ReadVertex(vreader, outside_range_flag);
+				data[provoking_index] = readVertex(vtx);
 				if (outside_range_flag) {
 					// Drop all primitives containing the current vertex
 					skip_count = 2;
@@ -135,6 +135,11 @@ class TransformUnit {
 	VertexData ReadVertex(VertexReader &vreader, bool &outside_range_flag);
 
 	u8 *decoded_;
+
+private:
+	// Vertices of the current draw, already transformed, for larger draws.
+	std::vector<VertexData> transformed_;
+	std::vector<u8> transformedOutside_;
 };
 
 class SoftwareDrawEngine : public DrawEngineCommon {
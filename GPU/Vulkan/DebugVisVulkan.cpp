@@ -34,25 +34,3 @@
 void DrawAllocatorVis(UIContext *ui, GPUInterface *gpu) {
 	// TODO: Make a new allocator visualizer for VMA.
 }
-
-void DrawGPUProfilerVis(UIContext *ui, GPUInterface *gpu) {
-	if (!gpu) {
-		return;
-	}
-	using namespace Draw;
-	const int padding = 10 + System_GetPropertyFloat(SYSPROP_DISPLAY_SAFE_INSET_LEFT);
-	const int starty = 50 + System_GetPropertyFloat(SYSPROP_DISPLAY_SAFE_INSET_TOP);
-	int x = padding;
-	int y = starty;
-
-	ui->Begin();
-
-	GPU_Vulkan *gpuVulkan = static_cast<GPU_Vulkan *>(gpu);
-
-	std::string text = gpuVulkan->GetGpuProfileString();
-
-	ui->SetFontScale(0.4f, 0.4f);
-	ui->DrawTextShadow(text.c_str(), x, y, 0xFFFFFFFF, FLAG_DYNAMIC_ASCII);
-	ui->SetFontScale(1.0f, 1.0f);
-	ui->Flush();
-}
@@ -17,7 +17,9 @@
 
 #include <algorithm>
 
+#include "Common/BitSet.h"
 #include "Common/Data/Convert/SmallDataConvert.h"
+#include "Common/Profiler/MemoryUsage.h"
 #include "Common/Profiler/Profiler.h"
 #include "Common/GPU/Vulkan/VulkanRenderManager.h"
 
@@ -57,7 +59,8 @@ enum {
 };
 
 #define VERTEXCACHE_DECIMATION_INTERVAL 17
-#define DESCRIPTORSET_DECIMATION_INTERVAL 1  // Temporarily cut to 1. Handle reuse breaks this when textures get deleted.
+// Descriptor sets are also dropped early whenever a buffer, image view or sampler gets deleted, see BeginFrame.
+#define DESCRIPTORSET_DECIMATION_INTERVAL 16
 
 enum { VAI_KILL_AGE = 120, VAI_UNRELIABLE_KILL_AGE = 240, VAI_UNRELIABLE_KILL_MAX = 4 };
 
@@ -81,6 +84,7 @@ DrawEngineVulkan::DrawEngineVulkan(Draw::DrawContext *draw)
 	: draw_(draw), vai_(1024) {
 	decOptions_.expandAllWeightsToFloat = false;
 	decOptions_.expand8BitNormalsToFloat = false;
+	morphInShaderSupported_ = true;
 
 	// Allocate nicely aligned memory. Maybe graphics drivers will appreciate it.
 	// All this is a LOT of memory, need to see if we can cut down somehow.
@@ -301,12 +305,17 @@ void DrawEngineVulkan::BeginFrame() {
 		});
 		vai_.Clear();
 	}
+	MemoryUsage_Set(MemoryCategory::VERTEX_CACHE, vertexCache_->GetTotalSize());
 
 	vertexCache_->BeginNoReset();
 
-	if (--descDecimationCounter_ <= 0) {
+	// Keep this frame's descriptor sets around for the next time it comes up, unless something they
+	// might point to was deleted since. A new object could then have reused the handle.
+	uint32_t descriptorDeletes = vulkan->Delete().DescriptorDeletes();
+	if (--frame->descDecimationCounter <= 0 || frame->descriptorDeletes != descriptorDeletes) {
 		frame->descPool.Reset();
-		descDecimationCounter_ = DESCRIPTORSET_DECIMATION_INTERVAL;
+		frame->descDecimationCounter = DESCRIPTORSET_DECIMATION_INTERVAL;
+		frame->descriptorDeletes = descriptorDeletes;
 	}
 
 	if (--decimationCounter_ <= 0) {
@@ -350,7 +359,8 @@ void DrawEngineVulkan::DecodeVertsToPushBuffer(VulkanPushBuffer *push, uint32_t
 	// Figure out how much pushbuffer space we need to allocate.
 	if (push) {
 		int vertsToDecode = ComputeNumVertsToDecode();
-		dest = (u8 *)push->Push(vertsToDecode * dec_->GetDecVtxFmt().stride, bindOffset, vkbuf);
+		int stride = DecodedVertexStride();
+		dest = (u8 *)push->Push(vertsToDecode * stride, bindOffset, vkbuf);
 	}
 	DecodeVerts(dest);
 }
@@ -507,6 +517,7 @@ void DrawEngineVulkan::DirtyAllUBOs() {
 	baseBuf = VK_NULL_HANDLE;
 	lightBuf = VK_NULL_HANDLE;
 	boneBuf = VK_NULL_HANDLE;
+	bonesPushed_ = 0;
 	dirtyUniforms_ = DIRTY_BASE_UNIFORMS | DIRTY_LIGHT_UNIFORMS | DIRTY_BONE_UNIFORMS;
 	imageView = VK_NULL_HANDLE;
 	sampler = VK_NULL_HANDLE;
@@ -522,6 +533,7 @@ void MarkUnreliable(VertexArrayInfoVulkan *vai) {
 // The inline wrapper in the header checks for numDrawCalls == 0
 void DrawEngineVulkan::DoFlush() {
 	PROFILE_THIS_SCOPE("Flush");
+	GPUStatsTimer timer(&gpuStats.msFlushing);
 	gpuStats.numFlushes++;
 	// TODO: Should be enough to update this once per frame?
 	gpuStats.numTrackedVertexArrays = (int)vai_.size();
@@ -561,6 +573,22 @@ void DrawEngineVulkan::DoFlush() {
 	// Always use software for flat shading to fix the provoking index.
 	bool useHWTransform = CanUseHardwareTransform(prim) && (tess || gstate.getShadeMode() != GE_SHADE_FLAT);
 
+	// With GPU vertex decoding the vertex shader reads suitable PSP formats as they are, instead of us decoding them.
+	const DecVtxFormat *rawFmt = useHWTransform ? GetRawVtxFmtForDraws() : nullptr;
+	const float rawTexcoordScale = rawFmt && dec_->hasTexcoord() ? dec_->RawTexcoordScale() : 0.0f;
+	if (rawTexcoordScale != gstate_c.rawTexcoordScale) {
+		// Switches the vertex shader (and so the pipeline) and how the UV uniform is computed.
+		gstate_c.rawTexcoordScale = rawTexcoordScale;
+		gstate_c.Dirty(DIRTY_VERTEXSHADER_STATE | DIRTY_UVSCALEOFFSET);
+	}
+	if (rawTexcoordScale != 0.0f && memcmp(&gstate_c.uv, &lastRawUV_, sizeof(UVScale)) != 0) {
+		// Normally the decoder applies these, so changing them doesn't dirty the uniform.
+		lastRawUV_ = gstate_c.uv;
+		gstate_c.Dirty(DIRTY_UVSCALEOFFSET);
+	}
+	// Likewise, the vertex shader can blend morph targets instead.
+	const DecVtxFormat *morphFmt = PrepareMorphForDraws(useHWTransform);
+
 	VulkanVertexShader *vshader = nullptr;
 	VulkanFragmentShader *fshader = nullptr;
 
@@ -582,6 +610,11 @@ void DrawEngineVulkan::DoFlush() {
 		if (g_Config.bSoftwareSkinning && (lastVType_ & GE_VTYPE_WEIGHT_MASK)) {
 			useCache = false;
 		}
+		// Copying raw vertices is cheaper than hashing them.
+		if (rawFmt) {
+			useCache = false;
+			copyRawVerts_ = true;
+		}
 
 		if (useCache) {
 			PROFILE_THIS_SCOPE("vcache");
@@ -729,6 +762,7 @@ void DrawEngineVulkan::DoFlush() {
 			} else {
 				// Decode directly into the pushbuffer
 				DecodeVertsToPushBuffer(frame->pushVertex, &vbOffset, &vbuf);
+				copyRawVerts_ = false;
 			}
 
 	rotateVBO:
@@ -764,7 +798,7 @@ void DrawEngineVulkan::DoFlush() {
 				ConvertStateToVulkanKey(*framebufferManager_, shaderManager_, prim, pipelineKey_, dynState_);
 			}
 
-			shaderManager_->GetShaders(prim, lastVType_, &vshader, &fshader, true, useHWTessellation_, decOptions_.expandAllWeightsToFloat);  // usehwtransform
+			shaderManager_->GetShaders(prim, lastVType_, &vshader, &fshader, true, useHWTessellation_, decOptions_.expandAllWeightsToFloat, rawTexcoordScale != 0.0f);  // usehwtransform
 			if (!vshader) {
 				// We're screwed.
 				return;
@@ -773,7 +807,7 @@ void DrawEngineVulkan::DoFlush() {
 
 			Draw::NativeObject object = framebufferManager_->UseBufferedRendering() ? Draw::NativeObject::FRAMEBUFFER_RENDERPASS : Draw::NativeObject::BACKBUFFER_RENDERPASS;
 			VkRenderPass renderPass = (VkRenderPass)draw_->GetNativeObject(object);
-			VulkanPipeline *pipeline = pipelineManager_->GetOrCreatePipeline(renderManager, pipelineLayout_, renderPass, pipelineKey_, &dec_->decFmt, vshader, fshader, true);
+			VulkanPipeline *pipeline = pipelineManager_->GetOrCreatePipeline(renderManager, pipelineLayout_, renderPass, pipelineKey_, rawFmt ? rawFmt : (morphFmt ? morphFmt : &dec_->decFmt), vshader, fshader, true);
 			if (!pipeline || !pipeline->pipeline) {
 				// Already logged, let's bail out.
 				return;
@@ -808,7 +842,8 @@ void DrawEngineVulkan::DoFlush() {
 		lastPrim_ = prim;
 
 		dirtyUniforms_ |= shaderManager_->UpdateUniforms(framebufferManager_->UseBufferedRendering());
-		UpdateUBOs(frame);
+		// The shader reads as many bones as its ID says, which is rounded up.
+		UpdateUBOs(frame, vertTypeIsSkinningEnabled(lastVType_) ? TranslateNumBones(vertTypeGetNumBoneWeights(lastVType_)) : 0);
 
 		VkDescriptorSet ds = GetOrCreateDescriptorSet(imageView, sampler, baseBuf, lightBuf, boneBuf, tess);
 
@@ -857,6 +892,8 @@ void DrawEngineVulkan::DoFlush() {
 		params.provokeFlatFirst = true;
 		params.flippedY = true;
 		params.usesHalfZ = true;
+		params.materialColors = materialColorRanges_;
+		params.numMaterialColors = numMaterialColorRanges_;
 
 		// We need to update the viewport early because it's checked for flipping in SoftwareTransform.
 		// We don't have a "DrawStateEarly" in vulkan, so...
@@ -882,6 +919,10 @@ void DrawEngineVulkan::DoFlush() {
 			swTransform.BuildDrawingParams(prim, indexGen.VertexCount(), dec_->VertexType(), inds, maxIndex, &result);
 		}
 
+		// Applying the texture below can move it into an atlas page, changing the size the UVs were scaled by.
+		const u32 transformTexWidth = gstate_c.curTextureWidth;
+		const u32 transformTexHeight = gstate_c.curTextureHeight;
+
 		if (result.setSafeSize)
 			framebufferManager_->SetSafeSize(result.safeWidth, result.safeHeight);
 
@@ -895,9 +936,18 @@ void DrawEngineVulkan::DoFlush() {
 					imageView = (VkImageView)draw_->GetNativeObject(Draw::NativeObject::NULL_IMAGEVIEW);
 				if (sampler == VK_NULL_HANDLE)
 					sampler = nullSampler_;
+				if (gstate_c.curTextureWidth != transformTexWidth || gstate_c.curTextureHeight != transformTexHeight) {
+					const float uScale = (float)transformTexWidth / (float)gstate_c.curTextureWidth;
+					const float vScale = (float)transformTexHeight / (float)gstate_c.curTextureHeight;
+					const int numVerts = result.drawIndexed ? maxIndex : result.drawNumTrans;
+					for (int i = 0; i < numVerts; ++i) {
+						result.drawBuffer[i].u *= uScale;
+						result.drawBuffer[i].v *= vScale;
+					}
+				}
 			}
 			if (!lastPipeline_ || gstate_c.IsDirty(DIRTY_BLEND_STATE | DIRTY_VIEWPORTSCISSOR_STATE | DIRTY_RASTER_STATE | DIRTY_DEPTHSTENCIL_STATE | DIRTY_VERTEXSHADER_STATE | DIRTY_FRAGMENTSHADER_STATE) || prim != lastPrim_) {
-				shaderManager_->GetShaders(prim, lastVType_, &vshader, &fshader, false, false, decOptions_.expandAllWeightsToFloat);  // usehwtransform
+				shaderManager_->GetShaders(prim, lastVType_, &vshader, &fshader, false, false, decOptions_.expandAllWeightsToFloat, false);  // usehwtransform
 				_dbg_assert_msg_(!vshader->UseHWTransform(), "Bad vshader");
 				if (prim != lastPrim_ || gstate_c.IsDirty(DIRTY_BLEND_STATE | DIRTY_VIEWPORTSCISSOR_STATE | DIRTY_RASTER_STATE | DIRTY_DEPTHSTENCIL_STATE)) {
 					ConvertStateToVulkanKey(*framebufferManager_, shaderManager_, prim, pipelineKey_, dynState_);
@@ -941,7 +991,8 @@ void DrawEngineVulkan::DoFlush() {
 			dirtyUniforms_ |= shaderManager_->UpdateUniforms(framebufferManager_->UseBufferedRendering());
 
 			// Even if the first draw is through-mode, make sure we at least have one copy of these uniforms buffered
-			UpdateUBOs(frame);
+			// Software transform already applied the bones.
+			UpdateUBOs(frame, 0);
 
 			VkDescriptorSet ds = GetOrCreateDescriptorSet(imageView, sampler, baseBuf, lightBuf, boneBuf, tess);
 			const uint32_t dynamicUBOOffsets[3] = {
@@ -982,6 +1033,7 @@ void DrawEngineVulkan::DoFlush() {
 
 	indexGen.Reset();
 	decodedVerts_ = 0;
+	decodeMorphTargets_ = false;
 	numDrawCalls = 0;
 	vertexCountInDrawCalls_ = 0;
 	decodeCounter_ = 0;
@@ -999,7 +1051,7 @@ void DrawEngineVulkan::DoFlush() {
 	GPUDebug::NotifyDraw();
 }
 
-void DrawEngineVulkan::UpdateUBOs(FrameData *frame) {
+void DrawEngineVulkan::UpdateUBOs(FrameData *frame, int numBones) {
 	if ((dirtyUniforms_ & DIRTY_BASE_UNIFORMS) || baseBuf == VK_NULL_HANDLE) {
 		baseUBOOffset = shaderManager_->PushBaseBuffer(frame->pushUBO, &baseBuf);
 		dirtyUniforms_ &= ~DIRTY_BASE_UNIFORMS;
@@ -1008,10 +1060,17 @@ void DrawEngineVulkan::UpdateUBOs(FrameData *frame) {
 		lightUBOOffset = shaderManager_->PushLightBuffer(frame->pushUBO, &lightBuf);
 		dirtyUniforms_ &= ~DIRTY_LIGHT_UNIFORMS;
 	}
-	if ((dirtyUniforms_ & DIRTY_BONE_UNIFORMS) || boneBuf == VK_NULL_HANDLE) {
-		boneUBOOffset = shaderManager_->PushBoneBuffer(frame->pushUBO, &boneBuf);
+	if (dirtyUniforms_ & DIRTY_BONE_UNIFORMS) {
+		// Bones are dirtied one by one, so the pushed ones below the first change are still good.
+		int firstDirty = LeastSignificantSetBit((u32)(dirtyUniforms_ & DIRTY_BONE_UNIFORMS)) - LeastSignificantSetBit((u32)DIRTY_BONEMATRIX0);
+		bonesPushed_ = std::min(bonesPushed_, firstDirty);
 		dirtyUniforms_ &= ~DIRTY_BONE_UNIFORMS;
 	}
+	// Skinned games often change bones for every draw, but most use fewer than 8 of them.
+	if (numBones > bonesPushed_ || boneBuf == VK_NULL_HANDLE) {
+		boneUBOOffset = shaderManager_->PushBoneBuffer(frame->pushUBO, &boneBuf, numBones);
+		bonesPushed_ = numBones;
+	}
 }
 
 DrawEngineVulkan::FrameData &DrawEngineVulkan::GetCurFrame() {
@@ -1020,36 +1079,29 @@ DrawEngineVulkan::FrameData &DrawEngineVulkan::GetCurFrame() {
 }
 
 void TessellationDataTransferVulkan::SendDataToShader(const SimpleVertex *const *points, int size_u, int size_v, u32 vertType, const Spline::Weight2D &weights) {
-	// SSBOs that are not simply float1 or float2 need to be padded up to a float4 size. vec3 members
-	// also need to be 16-byte aligned, hence the padding.
-	struct TessData {
-		float pos[3]; float pad1;
-		float uv[2]; float pad2[2];
-		float color[4];
-	};
-
 	int size = size_u * size_v;
 
 	int ssboAlignment = vulkan_->GetPhysicalDeviceProperties().properties.limits.minStorageBufferOffsetAlignment;
 	uint8_t *data = (uint8_t *)push_->PushAligned(size * sizeof(TessData), (uint32_t *)&bufInfo_[0].offset, &bufInfo_[0].buffer, ssboAlignment);
 	bufInfo_[0].range = size * sizeof(TessData);
 
-	float *pos = (float *)(data);
-	float *tex = (float *)(data + offsetof(TessData, uv));
-	float *col = (float *)(data + offsetof(TessData, color));
-	int stride = sizeof(TessData) / sizeof(float);
-
-	CopyControlPoints(pos, tex, col, stride, stride, stride, points, size, vertType);
+	CopyControlPoints((TessData *)data, points, size, vertType);
 
 	using Spline::Weight;
 
+	// Weights are only pushed again when the tessellation level changes, the previous
+	// copy stays valid until the push buffer is reset for the next frame.
 	// Weights U
-	data = (uint8_t *)push_->PushAligned(weights.size_u * sizeof(Weight), (uint32_t *)&bufInfo_[1].offset, &bufInfo_[1].buffer, ssboAlignment);
-	memcpy(data, weights.u, weights.size_u * sizeof(Weight));
-	bufInfo_[1].range = weights.size_u * sizeof(Weight);
+	if (WeightsChanged(0, weights.u)) {
+		data = (uint8_t *)push_->PushAligned(weights.size_u * sizeof(Weight), (uint32_t *)&bufInfo_[1].offset, &bufInfo_[1].buffer, ssboAlignment);
+		memcpy(data, weights.u, weights.size_u * sizeof(Weight));
+		bufInfo_[1].range = weights.size_u * sizeof(Weight);
+	}
 
 	// Weights V
-	data = (uint8_t *)push_->PushAligned(weights.size_v * sizeof(Weight), (uint32_t *)&bufInfo_[2].offset, &bufInfo_[2].buffer, ssboAlignment);
-	memcpy(data, weights.v, weights.size_v * sizeof(Weight));
-	bufInfo_[2].range = weights.size_v * sizeof(Weight);
+	if (WeightsChanged(1, weights.v)) {
+		data = (uint8_t *)push_->PushAligned(weights.size_v * sizeof(Weight), (uint32_t *)&bufInfo_[2].offset, &bufInfo_[2].buffer, ssboAlignment);
+		memcpy(data, weights.v, weights.size_v * sizeof(Weight));
+		bufInfo_[2].range = weights.size_v * sizeof(Weight);
+	}
 }
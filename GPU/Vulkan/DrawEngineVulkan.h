@@ -111,7 +111,11 @@ class TessellationDataTransferVulkan : public TessellationDataTransfer  {
 public:
 	TessellationDataTransferVulkan(VulkanContext *vulkan) : vulkan_(vulkan) {}
 
-	void SetPushBuffer(VulkanPushBuffer *push) { push_ = push; }
+	void SetPushBuffer(VulkanPushBuffer *push) {
+		push_ = push;
+		InvalidateWeights(0);
+		InvalidateWeights(1);
+	}
 	// Send spline/bezier's control points and weights to vertex shader through structured shader buffer.
 	void SendDataToShader(const SimpleVertex *const *points, int size_u, int size_v, u32 vertType, const Spline::Weight2D &weights) override;
 	const VkDescriptorBufferInfo *GetBufferInfo() { return bufInfo_; }
@@ -202,7 +206,7 @@ class DrawEngineVulkan : public DrawEngineCommon {
 	void DecodeVertsToPushBuffer(VulkanPushBuffer *push, uint32_t *bindOffset, VkBuffer *vkbuf);
 
 	void DoFlush();
-	void UpdateUBOs(FrameData *frame);
+	void UpdateUBOs(FrameData *frame, int numBones);
 	FrameData &GetCurFrame();
 
 	VkDescriptorSet GetOrCreateDescriptorSet(VkImageView imageView, VkSampler sampler, VkBuffer base, VkBuffer light, VkBuffer bone, bool tess);
@@ -222,7 +226,6 @@ class DrawEngineVulkan : public DrawEngineCommon {
 
 	PrehashMap<VertexArrayInfoVulkan *, nullptr> vai_;
 	VulkanPushBuffer *vertexCache_;
-	int descDecimationCounter_ = 0;
 
 	struct DescriptorSetKey {
 		VkImageView imageView_;
@@ -245,8 +248,10 @@ class DrawEngineVulkan : public DrawEngineCommon {
 		VulkanPushBuffer *pushVertex = nullptr;
 		VulkanPushBuffer *pushIndex = nullptr;
 
-		// We do rolling allocation and reset instead of caching across frames. That we might do later.
+		// Cached across frames until decimation, or until any descriptor-visible object gets deleted.
 		DenseHashMap<DescriptorSetKey, VkDescriptorSet, (VkDescriptorSet)VK_NULL_HANDLE> descSets;
+		int descDecimationCounter = 0;
+		uint32_t descriptorDeletes = 0;
 
 		void Destroy(VulkanContext *vulkan);
 	};
@@ -265,6 +270,8 @@ class DrawEngineVulkan : public DrawEngineCommon {
 	uint32_t baseUBOOffset;
 	uint32_t lightUBOOffset;
 	uint32_t boneUBOOffset;
+	// How many bones at boneUBOOffset are still current.
+	int bonesPushed_ = 0;
 	VkBuffer baseBuf, lightBuf, boneBuf;
 	VkImageView imageView = VK_NULL_HANDLE;
 	VkSampler sampler = VK_NULL_HANDLE;
@@ -283,4 +290,7 @@ class DrawEngineVulkan : public DrawEngineCommon {
 	TessellationDataTransferVulkan *tessDataTransferVulkan;
 
 	int lastRenderStepId_ = -1;
+
+	// Texcoord scale/offset last uploaded for raw (undecoded) vertices.
+	UVScale lastRawUV_{};
 };
@@ -138,6 +138,10 @@ void FramebufferManagerVulkan::DestroyDeviceObjects() {
 		vulkan2D_->PurgeFragmentShader(stencilFs_);
 		vulkan->Delete().QueueDeleteShaderModule(stencilFs_);
 	}
+	if (stencilExportFs_ != VK_NULL_HANDLE) {
+		vulkan2D_->PurgeFragmentShader(stencilExportFs_);
+		vulkan->Delete().QueueDeleteShaderModule(stencilExportFs_);
+	}
 	if (stencilVs_ != VK_NULL_HANDLE) {
 		vulkan2D_->PurgeVertexShader(stencilVs_);
 		vulkan->Delete().QueueDeleteShaderModule(stencilVs_);
@@ -84,6 +84,8 @@ class FramebufferManagerVulkan : public FramebufferManagerCommon {
 
 	VkShaderModule stencilVs_ = VK_NULL_HANDLE;
 	VkShaderModule stencilFs_ = VK_NULL_HANDLE;
+	// Only with VK_EXT_shader_stencil_export, writes all stencil bits in one pass.
+	VkShaderModule stencilExportFs_ = VK_NULL_HANDLE;
 
 	VkPipeline cur2DPipeline_ = VK_NULL_HANDLE;
 
@@ -106,6 +106,8 @@ GPU_Vulkan::GPU_Vulkan(GraphicsContext *gfxCtx, Draw::DrawContext *draw)
 		File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
 		shaderCachePath_ = GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + ".vkshadercache");
 		shaderCacheLoaded_ = false;
+		if (g_Config.bShaderCache)
+			SeedShaderCache(shaderCachePath_);
 
 		std::thread th([&] {
 			LoadCache(shaderCachePath_);
@@ -338,6 +340,11 @@ void GPU_Vulkan::BeginHostFrame() {
 	shaderManagerVulkan_->DirtyShader();
 	gstate_c.Dirty(DIRTY_ALL);
 
+	VulkanRenderManager *rm = (VulkanRenderManager *)draw_->GetNativeObject(Draw::NativeObject::RENDER_MANAGER);
+	rm->SetSkipPendingPipelines(g_Config.bSkipPendingPipelines);
+	rm->SetOptimizePipelinesLater(g_Config.bFastPipelineCreation);
+	rm->SetParallelRecording(g_Config.bParallelCmdRecording);
+
 	if (dumpNextFrame_) {
 		NOTICE_LOG(G3D, "DUMPING THIS FRAME");
 		dumpThisFrame_ = true;
@@ -348,6 +355,7 @@ void GPU_Vulkan::BeginHostFrame() {
 }
 
 void GPU_Vulkan::EndHostFrame() {
+	GPUCommon::EndHostFrame();
 	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
 	int curFrame = vulkan->GetCurFrame();
 	FrameData &frame = frameData_[curFrame];
@@ -655,8 +663,3 @@ std::string GPU_Vulkan::DebugGetShaderString(std::string id, DebugShaderType typ
 		return std::string();
 	}
 }
-
-std::string GPU_Vulkan::GetGpuProfileString() {
-	VulkanRenderManager *rm = (VulkanRenderManager *)draw_->GetNativeObject(Draw::NativeObject::RENDER_MANAGER);
-	return rm->GetGpuProfileString();
-}
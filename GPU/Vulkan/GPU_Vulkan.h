@@ -68,8 +68,6 @@ class GPU_Vulkan : public GPUCommon {
 		return textureCacheVulkan_;
 	}
 
-	std::string GetGpuProfileString();
-
 protected:
 	void FinishDeferred() override;
 
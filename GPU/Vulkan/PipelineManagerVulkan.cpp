@@ -15,6 +15,7 @@
 #include "Common/GPU/thin3d.h"
 #include "Common/GPU/Vulkan/VulkanRenderManager.h"
 #include "Common/GPU/Vulkan/VulkanQueueRunner.h"
+#include "Core/Reporting.h"
 
 using namespace PPSSPP_VK;
 
@@ -33,6 +34,9 @@ void PipelineManagerVulkan::Clear() {
 	// This could also be an opportunity to store the whole cache to disk. Will need to also
 	// store the keys.
 
+	if (renderManager_)
+		renderManager_->CancelPipelineOptimization();
+
 	pipelines_.Iterate([&](const VulkanPipelineKey &key, VulkanPipeline *value) {
 		if (value->pipeline) {
 			VkPipeline pipeline = value->pipeline->pipeline;
@@ -53,6 +57,7 @@ void PipelineManagerVulkan::Clear() {
 
 void PipelineManagerVulkan::DeviceLost() {
 	Clear();
+	renderManager_ = nullptr;
 	if (pipelineCache_ != VK_NULL_HANDLE)
 		vulkan_->Delete().QueueDeletePipelineCache(pipelineCache_);
 }
@@ -121,6 +126,18 @@ static int SetupVertexAttribs(VkVertexInputAttributeDescription attrs[], const D
 	}
 	// Position is always there.
 	VertexAttribSetup(&attrs[count++], decFmt.posfmt, decFmt.posoff, PspAttributeLocation::POSITION);
+	// Unblended morph targets follow, in the order the vertex shader generator expects.
+	int location = (int)PspAttributeLocation::MORPH;
+	for (int n = 1; n < decFmt.morphcount; n++) {
+		const int base = n * decFmt.morphStride;
+		VertexAttribSetup(&attrs[count++], decFmt.posfmt, base + decFmt.posoff, (PspAttributeLocation)location++);
+		if (decFmt.nrmfmt != 0)
+			VertexAttribSetup(&attrs[count++], decFmt.nrmfmt, base + decFmt.nrmoff, (PspAttributeLocation)location++);
+		if (decFmt.uvfmt != 0)
+			VertexAttribSetup(&attrs[count++], decFmt.uvfmt, base + decFmt.uvoff, (PspAttributeLocation)location++);
+		if (decFmt.c0fmt != 0)
+			VertexAttribSetup(&attrs[count++], decFmt.c0fmt, base + decFmt.c0off, (PspAttributeLocation)location++);
+	}
 	return count;
 }
 
@@ -258,24 +275,30 @@ static VulkanPipeline *CreateVulkanPipeline(VulkanRenderManager *renderManager,
 	ss[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	ss[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
 	ss[0].pSpecializationInfo = nullptr;
-	ss[0].module = vs->GetModule();
+	// Filled in by prepare, once compiled.
+	ss[0].module = VK_NULL_HANDLE;
 	ss[0].pName = "main";
 	ss[0].flags = 0;
 	ss[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 	ss[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
 	ss[1].pSpecializationInfo = nullptr;
-	ss[1].module = fs->GetModule();
+	ss[1].module = VK_NULL_HANDLE;
 	ss[1].pName = "main";
 	ss[1].flags = 0;
 
-	if (!ss[0].module || !ss[1].module) {
-		ERROR_LOG(G3D, "Failed creating graphics pipeline - bad shaders");
-		// Create a placeholder to avoid creating over and over if shader compiler broken.
-		VulkanPipeline *nullPipeline = new VulkanPipeline();
-		nullPipeline->pipeline = VK_NULL_HANDLE;
-		nullPipeline->flags = 0;
-		return nullPipeline;
-	}
+	// The shader modules may still be compiling on worker threads, so wait for them on the compile thread
+	// instead of here. A failed shader fails the pipeline, which the queue runner then skips draws with.
+	std::shared_ptr<PendingShaderModule> vsModule = vs->GetPendingModule();
+	std::shared_ptr<PendingShaderModule> fsModule = fs->GetPendingModule();
+	desc->prepare = [vsModule, fsModule](VKRGraphicsPipelineDesc *desc) {
+		desc->shaderStageInfo[0].module = vsModule->Get();
+		desc->shaderStageInfo[1].module = fsModule->Get();
+		if (!desc->shaderStageInfo[0].module || !desc->shaderStageInfo[1].module) {
+			ERROR_LOG(G3D, "Failed creating graphics pipeline - bad shaders");
+			return false;
+		}
+		return true;
+	};
 
 	VkPipelineInputAssemblyStateCreateInfo &inputAssembly = desc->inputAssembly;
 	inputAssembly.flags = 0;
@@ -340,6 +363,8 @@ static VulkanPipeline *CreateVulkanPipeline(VulkanRenderManager *renderManager,
 	pipe.subpass = 0;
 
 	VKRGraphicsPipeline *pipeline = renderManager->CreateGraphicsPipeline(desc);
+	gpuStats.numPipelinesCreated++;
+	Reporting::NotePerfEvent(Reporting::PerfEvent::PIPELINE_CREATED);
 
 	VulkanPipeline *vulkanPipeline = new VulkanPipeline();
 	vulkanPipeline->pipeline = pipeline;
@@ -361,14 +386,16 @@ VulkanPipeline *PipelineManagerVulkan::GetOrCreatePipeline(VulkanRenderManager *
 		_assert_(VK_SUCCESS == res);
 	}
 
+	renderManager_ = renderManager;
+
 	VulkanPipelineKey key{};
 	_assert_msg_(renderPass, "Can't create a pipeline with a null renderpass");
 
 	key.raster = rasterKey;
 	key.renderPass = renderPass;
 	key.useHWTransform = useHwTransform;
-	key.vShader = vs->GetModule();
-	key.fShader = fs->GetModule();
+	key.vShader = vs;
+	key.fShader = fs;
 	key.vtxFmtId = useHwTransform ? decFmt->id : 0;
 
 	auto iter = pipelines_.Get(key);
@@ -631,9 +658,9 @@ void PipelineManagerVulkan::SaveCache(FILE *file, bool saveRawPipelineCache, Sha
 	pipelines_.Iterate([&](const VulkanPipelineKey &pkey, VulkanPipeline *value) {
 		if (failed)
 			return;
-		VulkanVertexShader *vshader = shaderManager->GetVertexShaderFromModule(pkey.vShader);
-		VulkanFragmentShader *fshader = shaderManager->GetFragmentShaderFromModule(pkey.fShader);
-		if (!vshader || !fshader) {
+		VulkanVertexShader *vshader = pkey.vShader;
+		VulkanFragmentShader *fshader = pkey.fShader;
+		if (!shaderManager->HasVertexShader(vshader) || !shaderManager->HasFragmentShader(fshader)) {
 			failed = true;
 			return;
 		}
@@ -28,13 +28,15 @@
 #include "GPU/Vulkan/VulkanQueueRunner.h"
 
 struct VKRGraphicsPipeline;
+class VulkanVertexShader;
+class VulkanFragmentShader;
 class VulkanRenderManager;
 
 struct VulkanPipelineKey {
 	VulkanPipelineRasterStateKey raster;  // prim is included here
 	VkRenderPass renderPass;
-	VkShaderModule vShader;
-	VkShaderModule fShader;
+	VulkanVertexShader *vShader;
+	VulkanFragmentShader *fShader;
 	uint32_t vtxFmtId;
 	bool useHWTransform;
 
@@ -89,5 +91,7 @@ class PipelineManagerVulkan {
 	DenseHashMap<VulkanPipelineKey, VulkanPipeline *, nullptr> pipelines_;
 	VkPipelineCache pipelineCache_ = VK_NULL_HANDLE;
 	VulkanContext *vulkan_;
+	// Set on first use, to cancel optimized rebuilds before deleting pipelines.
+	VulkanRenderManager *renderManager_ = nullptr;
 	bool cancelCache_ = false;
 };
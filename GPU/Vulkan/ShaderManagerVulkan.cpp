@@ -23,6 +23,7 @@
 #include "Common/Math/math_util.h"
 #include "Common/Data/Convert/SmallDataConvert.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Common/GPU/thin3d.h"
 #include "Common/Data/Encoding/Utf8.h"
 
@@ -82,22 +83,70 @@ VkShaderModule CompileShaderModule(VulkanContext *vulkan, VkShaderStageFlagBits
 	return shaderModule;
 }
 
+void PendingShaderModule::Compile() {
+	int expected = PENDING;
+	if (!state_.compare_exchange_strong(expected, COMPILING))
+		return;
+
+	VkShaderModule module = CompileShaderModule(vulkan_, stage_, code_.c_str());
+	if (module != VK_NULL_HANDLE)
+		VERBOSE_LOG(G3D, "Compiled %s shader:\n%s\n", stage_ == VK_SHADER_STAGE_VERTEX_BIT ? "vertex" : "fragment", code_.c_str());
+
+	std::lock_guard<std::mutex> guard(lock_);
+	module_ = module;
+	state_ = DONE;
+	done_.notify_all();
+}
+
+VkShaderModule PendingShaderModule::Get() {
+	if (state_ == DONE)
+		return module_;
+	// Not started yet, faster to just do it here than to wait for a worker.
+	Compile();
+
+	std::unique_lock<std::mutex> guard(lock_);
+	done_.wait(guard, [&] { return state_ == DONE; });
+	return module_;
+}
+
+class ShaderModuleTask : public Task {
+public:
+	ShaderModuleTask(std::shared_ptr<PendingShaderModule> module) : module_(module) {
+	}
+
+	TaskType Type() const override {
+		return TaskType::CPU_COMPUTE;
+	}
+
+	// A draw may be waiting for this pipeline.
+	TaskPriority Priority() const override {
+		return TaskPriority::CRITICAL;
+	}
+
+	void Run() override {
+		module_->Compile();
+	}
+
+private:
+	std::shared_ptr<PendingShaderModule> module_;
+};
+
+static std::shared_ptr<PendingShaderModule> StartShaderModule(VulkanContext *vulkan, VkShaderStageFlagBits stage, const std::string &code) {
+	auto module = std::make_shared<PendingShaderModule>(vulkan, stage, code);
+	g_threadManager.EnqueueTask(new ShaderModuleTask(module));
+	return module;
+}
 
 VulkanFragmentShader::VulkanFragmentShader(VulkanContext *vulkan, FShaderID id, const char *code)
 	: vulkan_(vulkan), id_(id) {
 	source_ = code;
-	module_ = CompileShaderModule(vulkan, VK_SHADER_STAGE_FRAGMENT_BIT, source_.c_str());
-	if (!module_) {
-		failed_ = true;
-		return;
-	} else {
-		VERBOSE_LOG(G3D, "Compiled fragment shader:\n%s\n", (const char *)code);
-	}
+	module_ = StartShaderModule(vulkan, VK_SHADER_STAGE_FRAGMENT_BIT, source_);
 }
 
 VulkanFragmentShader::~VulkanFragmentShader() {
-	if (module_ != VK_NULL_HANDLE) {
-		vulkan_->Delete().QueueDeleteShaderModule(module_);
+	VkShaderModule module = module_->Get();
+	if (module != VK_NULL_HANDLE) {
+		vulkan_->Delete().QueueDeleteShaderModule(module);
 	}
 }
 
@@ -115,18 +164,13 @@ std::string VulkanFragmentShader::GetShaderString(DebugShaderStringType type) co
 VulkanVertexShader::VulkanVertexShader(VulkanContext *vulkan, VShaderID id, const char *code, bool useHWTransform)
 	: vulkan_(vulkan), useHWTransform_(useHWTransform), id_(id) {
 	source_ = code;
-	module_ = CompileShaderModule(vulkan, VK_SHADER_STAGE_VERTEX_BIT, source_.c_str());
-	if (!module_) {
-		failed_ = true;
-		return;
-	} else {
-		VERBOSE_LOG(G3D, "Compiled vertex shader:\n%s\n", (const char *)code);
-	}
+	module_ = StartShaderModule(vulkan, VK_SHADER_STAGE_VERTEX_BIT, source_);
 }
 
 VulkanVertexShader::~VulkanVertexShader() {
-	if (module_ != VK_NULL_HANDLE) {
-		vulkan_->Delete().QueueDeleteShaderModule(module_);
+	VkShaderModule module = module_->Get();
+	if (module != VK_NULL_HANDLE) {
+		vulkan_->Delete().QueueDeleteShaderModule(module);
 	}
 }
 
@@ -213,11 +257,12 @@ uint64_t ShaderManagerVulkan::UpdateUniforms(bool useBufferedRendering) {
 	return dirty;
 }
 
-void ShaderManagerVulkan::GetShaders(int prim, u32 vertType, VulkanVertexShader **vshader, VulkanFragmentShader **fshader, bool useHWTransform, bool useHWTessellation, bool weightsAsFloat) {
+void ShaderManagerVulkan::GetShaders(int prim, u32 vertType, VulkanVertexShader **vshader, VulkanFragmentShader **fshader, bool useHWTransform, bool useHWTessellation, bool weightsAsFloat, bool rawTexcoords) {
 	VShaderID VSID;
 	if (gstate_c.IsDirty(DIRTY_VERTEXSHADER_STATE)) {
 		gstate_c.Clean(DIRTY_VERTEXSHADER_STATE);
 		ComputeVertexShaderID(&VSID, vertType, useHWTransform, useHWTessellation, weightsAsFloat);
+		VSID.SetBit(VS_BIT_RAW_TEXCOORD, useHWTransform && rawTexcoords);
 	} else {
 		VSID = lastVSID_;
 	}
@@ -327,22 +372,22 @@ std::string ShaderManagerVulkan::DebugGetShaderString(std::string id, DebugShade
 	}
 }
 
-VulkanVertexShader *ShaderManagerVulkan::GetVertexShaderFromModule(VkShaderModule module) {
-	VulkanVertexShader *vs = nullptr;
+bool ShaderManagerVulkan::HasVertexShader(const VulkanVertexShader *vs) {
+	bool found = false;
 	vsCache_.Iterate([&](const VShaderID &id, VulkanVertexShader *shader) {
-		if (shader->GetModule() == module)
-			vs = shader;
+		if (shader == vs)
+			found = true;
 	});
-	return vs;
+	return found;
 }
 
-VulkanFragmentShader *ShaderManagerVulkan::GetFragmentShaderFromModule(VkShaderModule module) {
-	VulkanFragmentShader *fs = nullptr;
+bool ShaderManagerVulkan::HasFragmentShader(const VulkanFragmentShader *fs) {
+	bool found = false;
 	fsCache_.Iterate([&](const FShaderID &id, VulkanFragmentShader *shader) {
-		if (shader->GetModule() == module)
-			fs = shader;
+		if (shader == fs)
+			found = true;
 	});
-	return fs;
+	return found;
 }
 
 // Shader cache.
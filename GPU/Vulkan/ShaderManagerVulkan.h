@@ -17,8 +17,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 
 #include "Common/Data/Collections/Hashmaps.h"
 #include "Common/GPU/Vulkan/VulkanMemory.h"
@@ -33,6 +37,34 @@
 class VulkanContext;
 class VulkanPushBuffer;
 
+// A shader module being compiled on a worker thread. Whoever needs it first does the compile, the task or a
+// waiter, so pipeline creation on the same workers can wait for it without starving the pool.
+class PendingShaderModule {
+public:
+	PendingShaderModule(VulkanContext *vulkan, VkShaderStageFlagBits stage, const std::string &code)
+		: vulkan_(vulkan), stage_(stage), code_(code) {}
+
+	// Does nothing if someone else already started.
+	void Compile();
+	// Blocks until compiled. VK_NULL_HANDLE if compilation failed.
+	VkShaderModule Get();
+
+private:
+	enum State {
+		PENDING,
+		COMPILING,
+		DONE,
+	};
+
+	VulkanContext *vulkan_;
+	VkShaderStageFlagBits stage_;
+	std::string code_;
+	std::atomic<int> state_{ PENDING };
+	std::mutex lock_;
+	std::condition_variable done_;
+	VkShaderModule module_ = VK_NULL_HANDLE;
+};
+
 class VulkanFragmentShader {
 public:
 	VulkanFragmentShader(VulkanContext *vulkan, FShaderID id, const char *code);
@@ -40,18 +72,19 @@ class VulkanFragmentShader {
 
 	const std::string &source() const { return source_; }
 
-	bool Failed() const { return failed_; }
+	bool Failed() const { return module_->Get() == VK_NULL_HANDLE; }
 
 	std::string GetShaderString(DebugShaderStringType type) const;
-	VkShaderModule GetModule() const { return module_; }
+	// Blocks until the module is compiled, pipelines should use GetPendingModule() instead.
+	VkShaderModule GetModule() const { return module_->Get(); }
+	std::shared_ptr<PendingShaderModule> GetPendingModule() const { return module_; }
 	const FShaderID &GetID() { return id_; }
 
 protected:	
-	VkShaderModule module_ = VK_NULL_HANDLE;
+	std::shared_ptr<PendingShaderModule> module_;
 
 	VulkanContext *vulkan_;
 	std::string source_;
-	bool failed_ = false;
 	FShaderID id_;
 };
 
@@ -62,19 +95,20 @@ class VulkanVertexShader {
 
 	const std::string &source() const { return source_; }
 
-	bool Failed() const { return failed_; }
+	bool Failed() const { return module_->Get() == VK_NULL_HANDLE; }
 	bool UseHWTransform() const { return useHWTransform_; }
 
 	std::string GetShaderString(DebugShaderStringType type) const;
-	VkShaderModule GetModule() const { return module_; }
+	// Blocks until the module is compiled, pipelines should use GetPendingModule() instead.
+	VkShaderModule GetModule() const { return module_->Get(); }
+	std::shared_ptr<PendingShaderModule> GetPendingModule() const { return module_; }
 	const VShaderID &GetID() { return id_; }
 
 protected:
-	VkShaderModule module_ = VK_NULL_HANDLE;
+	std::shared_ptr<PendingShaderModule> module_;
 
 	VulkanContext *vulkan_;
 	std::string source_;
-	bool failed_ = false;
 	bool useHWTransform_;
 	VShaderID id_;
 };
@@ -88,7 +122,7 @@ class ShaderManagerVulkan : public ShaderManagerCommon {
 
 	void DeviceRestore(Draw::DrawContext *draw);
 
-	void GetShaders(int prim, u32 vertType, VulkanVertexShader **vshader, VulkanFragmentShader **fshader, bool useHWTransform, bool useHWTessellation, bool weightsAsFloat);
+	void GetShaders(int prim, u32 vertType, VulkanVertexShader **vshader, VulkanFragmentShader **fshader, bool useHWTransform, bool useHWTessellation, bool weightsAsFloat, bool rawTexcoords);
 	void ClearShaders();
 	void DirtyShader();
 	void DirtyLastShader() override;
@@ -99,8 +133,9 @@ class ShaderManagerVulkan : public ShaderManagerCommon {
 	// Used for saving/loading the cache. Don't need to be particularly fast.
 	VulkanVertexShader *GetVertexShaderFromID(VShaderID id) { return vsCache_.Get(id); }
 	VulkanFragmentShader *GetFragmentShaderFromID(FShaderID id) { return fsCache_.Get(id); }
-	VulkanVertexShader *GetVertexShaderFromModule(VkShaderModule module);
-	VulkanFragmentShader *GetFragmentShaderFromModule(VkShaderModule module);
+	// Pipeline keys can outlive the shaders, this checks they're still around.
+	bool HasVertexShader(const VulkanVertexShader *vs);
+	bool HasFragmentShader(const VulkanFragmentShader *fs);
 
 	std::vector<std::string> DebugGetShaderIDs(DebugShaderType type);
 	std::string DebugGetShaderString(std::string id, DebugShaderType type, DebugShaderStringType stringType);
@@ -119,9 +154,12 @@ class ShaderManagerVulkan : public ShaderManagerCommon {
 	uint32_t PushLightBuffer(VulkanPushBuffer *dest, VkBuffer *buf) {
 		return dest->PushAligned(&ub_lights, sizeof(ub_lights), uboAlignment_, buf);
 	}
-	// TODO: Only push half the bone buffer if we only have four bones.
-	uint32_t PushBoneBuffer(VulkanPushBuffer *dest, VkBuffer *buf) {
-		return dest->PushAligned(&ub_bones, sizeof(ub_bones), uboAlignment_, buf);
+	// The whole block is reserved since that's the bound range, but only the first numBones are copied.
+	uint32_t PushBoneBuffer(VulkanPushBuffer *dest, VkBuffer *buf, int numBones) {
+		uint32_t offset;
+		void *data = dest->PushAligned(sizeof(ub_bones), &offset, buf, uboAlignment_);
+		memcpy(data, &ub_bones, numBones * sizeof(ub_bones.bones[0]));
+		return offset;
 	}
 
 	bool LoadCache(FILE *f);
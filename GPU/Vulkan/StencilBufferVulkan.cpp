@@ -80,6 +80,22 @@ void main() {
 }
 )";
 
+// With VK_EXT_shader_stencil_export, we can write the stencil value directly, no need to loop over the bits.
+// The pixel texture already has alpha expanded to 8 bits, which matches what the bit loop would write for every format.
+static const char *stencil_export_fs = R"(#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+#extension GL_ARB_shader_stencil_export : require
+layout (binding = 0) uniform sampler2D tex;
+layout (location = 0) in vec2 v_texcoord0;
+layout (location = 0) out vec4 fragColor0;
+
+void main() {
+	vec4 index = texture(tex, v_texcoord0);
+	gl_FragStencilRefARB = int(floor(index.a * 255.99)) & 0xFF;
+	fragColor0 = index.aaaa;
+}
+)";
 
 static const char stencil_vs[] = R"(#version 450
 #extension GL_ARB_separate_shader_objects : enable
@@ -146,9 +162,8 @@ bool FramebufferManagerVulkan::NotifyStencilUpload(u32 addr, int size, StencilUp
 	}
 
 	std::string error;
+	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
 	if (!stencilVs_) {
-		VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
-
 		const char *stencil_fs_source = stencil_fs;
 		// See comment above the stencil_fs_adreno definition.
 		u32 vendorID = vulkan->GetPhysicalDeviceProperties().properties.vendorID;
@@ -157,7 +172,11 @@ bool FramebufferManagerVulkan::NotifyStencilUpload(u32 addr, int size, StencilUp
 
 		stencilVs_ = CompileShaderModule(vulkan, VK_SHADER_STAGE_VERTEX_BIT, stencil_vs, &error);
 		stencilFs_ = CompileShaderModule(vulkan, VK_SHADER_STAGE_FRAGMENT_BIT, stencil_fs_source, &error);
+		if (vulkan->Extensions().EXT_shader_stencil_export) {
+			stencilExportFs_ = CompileShaderModule(vulkan, VK_SHADER_STAGE_FRAGMENT_BIT, stencil_export_fs, &error);
+		}
 	}
+	const bool useExport = stencilExportFs_ != VK_NULL_HANDLE;
 	VkRenderPass rp = (VkRenderPass)draw_->GetNativeObject(Draw::NativeObject::FRAMEBUFFER_RENDERPASS);
 
 	VulkanRenderManager *renderManager = (VulkanRenderManager *)draw_->GetNativeObject(Draw::NativeObject::RENDER_MANAGER);
@@ -180,7 +199,7 @@ bool FramebufferManagerVulkan::NotifyStencilUpload(u32 addr, int size, StencilUp
 		// something is wrong...
 	}
 
-	VkPipeline pipeline = vulkan2D_->GetPipeline(rp, stencilVs_, stencilFs_, false, Vulkan2D::VK2DDepthStencilMode::STENCIL_REPLACE_ALWAYS);
+	VkPipeline pipeline = vulkan2D_->GetPipeline(rp, stencilVs_, useExport ? stencilExportFs_ : stencilFs_, false, Vulkan2D::VK2DDepthStencilMode::STENCIL_REPLACE_ALWAYS);
 	renderManager->BindPipeline(pipeline, PIPELINE_FLAG_USES_DEPTH_STENCIL);
 	renderManager->SetViewport({ 0.0f, 0.0f, (float)w, (float)h, 0.0f, 1.0f });
 	renderManager->SetScissor(0, 0, (int)w, (int)h);
@@ -189,38 +208,44 @@ bool FramebufferManagerVulkan::NotifyStencilUpload(u32 addr, int size, StencilUp
 	VkImageView drawPixelsImageView = (VkImageView)draw_->GetNativeObject(Draw::NativeObject::BOUND_TEXTURE0_IMAGEVIEW);
 	VkDescriptorSet descSet = vulkan2D_->GetDescriptorSet(drawPixelsImageView, nearestSampler_, VK_NULL_HANDLE, VK_NULL_HANDLE);
 
-	// Note: Even with skipZero, we don't necessarily start framebuffers at 0 in Vulkan.  Clear anyway.
-	// Not an actual clear, because we need to draw to alpha only as well.
-	uint32_t value = 0;
-	renderManager->PushConstants(vulkan2D_->GetPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT|VK_SHADER_STAGE_FRAGMENT_BIT, 0, 4, &value);
-	renderManager->SetStencilParams(0xFF, 0xFF, 0x00);
-	renderManager->Draw(vulkan2D_->GetPipelineLayout(), descSet, 0, nullptr, VK_NULL_HANDLE, 0, 3);  // full screen triangle
-
-	for (int i = 1; i < values; i += i) {
-		if (!(usedBits & i)) {
-			// It's already zero, let's skip it.
-			continue;
-		}
-
-		// These are the stencil bits that will be written.  We discard when the bit doesn't match.
-		uint8_t writeMask = 0;
-		// This is the value to test the texture alpha against in the shader.
+	if (useExport) {
+		// The shader provides the reference value, so this single draw replaces the clear and all the bit passes.
+		renderManager->SetStencilParams(0xFF, 0xFF, 0xFF);
+		renderManager->Draw(vulkan2D_->GetPipelineLayout(), descSet, 0, nullptr, VK_NULL_HANDLE, 0, 3);  // full screen triangle
+	} else {
+		// Note: Even with skipZero, we don't necessarily start framebuffers at 0 in Vulkan.  Clear anyway.
+		// Not an actual clear, because we need to draw to alpha only as well.
 		uint32_t value = 0;
-		if (dstBuffer->format == GE_FORMAT_4444) {
-			writeMask = i | (i << 4);
-			value = i * 16;
-		} else if (dstBuffer->format == GE_FORMAT_5551) {
-			writeMask = 0xFF;
-			value = i * 128;
-		} else {
-			writeMask = i;
-			value = i;
-		}
-		renderManager->SetStencilParams(writeMask, 0xFF, 0xFF);
-		// Need to specify both VERTEX and FRAGMENT bits here since that's what we set up in the pipeline layout, and we need
-		// that for the post shaders. There's probably not really a cost to this.
 		renderManager->PushConstants(vulkan2D_->GetPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT|VK_SHADER_STAGE_FRAGMENT_BIT, 0, 4, &value);
+		renderManager->SetStencilParams(0xFF, 0xFF, 0x00);
 		renderManager->Draw(vulkan2D_->GetPipelineLayout(), descSet, 0, nullptr, VK_NULL_HANDLE, 0, 3);  // full screen triangle
+
+		for (int i = 1; i < values; i += i) {
+			if (!(usedBits & i)) {
+				// It's already zero, let's skip it.
+				continue;
+			}
+
+			// These are the stencil bits that will be written.  We discard when the bit doesn't match.
+			uint8_t writeMask = 0;
+			// This is the value to test the texture alpha against in the shader.
+			uint32_t value = 0;
+			if (dstBuffer->format == GE_FORMAT_4444) {
+				writeMask = i | (i << 4);
+				value = i * 16;
+			} else if (dstBuffer->format == GE_FORMAT_5551) {
+				writeMask = 0xFF;
+				value = i * 128;
+			} else {
+				writeMask = i;
+				value = i;
+			}
+			renderManager->SetStencilParams(writeMask, 0xFF, 0xFF);
+			// Need to specify both VERTEX and FRAGMENT bits here since that's what we set up in the pipeline layout, and we need
+			// that for the post shaders. There's probably not really a cost to this.
+			renderManager->PushConstants(vulkan2D_->GetPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT|VK_SHADER_STAGE_FRAGMENT_BIT, 0, 4, &value);
+			renderManager->Draw(vulkan2D_->GetPipelineLayout(), descSet, 0, nullptr, VK_NULL_HANDLE, 0, 3);  // full screen triangle
+		}
 	}
 
 	tex->Release();
@@ -56,6 +56,15 @@ using namespace PPSSPP_VK;
 #define TEXCACHE_MIN_SLAB_SIZE (8 * 1024 * 1024)
 #define TEXCACHE_MAX_SLAB_SIZE (32 * 1024 * 1024)
 #define TEXCACHE_SLAB_PRESSURE 4
+// Per frame. Past this, textures with mips are first uploaded with only their smallest levels.
+#define TEXCACHE_UPLOAD_BUDGET (4 * 1024 * 1024)
+
+// Textures in this size range can share atlas pages. Each cell has a border texel around the texture.
+#define TEXCACHE_ATLAS_MIN_SIZE 8
+#define TEXCACHE_ATLAS_MAX_SIZE 64
+#define TEXCACHE_ATLAS_CELL_SIZE (TEXCACHE_ATLAS_MAX_SIZE + 2)
+#define TEXCACHE_ATLAS_CELLS_PER_ROW (TEXCACHE_ATLAS_PAGE_SIZE / TEXCACHE_ATLAS_CELL_SIZE)
+#define TEXCACHE_ATLAS_MAX_PAGES 4
 
 const char *uploadShader = R"(
 #version 450
@@ -76,6 +85,8 @@ layout(push_constant) uniform Params {
 	int height;
 } params;
 
+#define SCALE_FACTOR %d
+
 uint readColoru(uvec2 p) {
 	return buf.data[p.y * params.width + p.x];
 }
@@ -178,10 +189,34 @@ std::vector<std::string> SamplerCache::DebugGetSamplerIDs() const {
 	return ids;
 }
 
+ReplacedTextureFormat FromVulkanFormat(VkFormat fmt) {
+	switch (fmt) {
+	case VULKAN_565_FORMAT: return ReplacedTextureFormat::F_5650;
+	case VULKAN_1555_FORMAT: return ReplacedTextureFormat::F_5551;
+	case VULKAN_4444_FORMAT: return ReplacedTextureFormat::F_4444;
+	case VULKAN_8888_FORMAT: default: return ReplacedTextureFormat::F_8888;
+	}
+}
+
+VkFormat ToVulkanFormat(ReplacedTextureFormat fmt) {
+	switch (fmt) {
+	case ReplacedTextureFormat::F_5650: return VULKAN_565_FORMAT;
+	case ReplacedTextureFormat::F_5551: return VULKAN_1555_FORMAT;
+	case ReplacedTextureFormat::F_4444: return VULKAN_4444_FORMAT;
+	case ReplacedTextureFormat::F_BC1: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+	case ReplacedTextureFormat::F_BC3: return VK_FORMAT_BC3_UNORM_BLOCK;
+	case ReplacedTextureFormat::F_BC7: return VK_FORMAT_BC7_UNORM_BLOCK;
+	case ReplacedTextureFormat::F_ETC2_RGBA: return VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK;
+	case ReplacedTextureFormat::F_ASTC_4x4: return VK_FORMAT_ASTC_4x4_UNORM_BLOCK;
+	case ReplacedTextureFormat::F_8888: default: return VULKAN_8888_FORMAT;
+	}
+}
+
 TextureCacheVulkan::TextureCacheVulkan(Draw::DrawContext *draw, VulkanContext *vulkan)
 	: TextureCacheCommon(draw),
 		computeShaderManager_(vulkan),
 		samplerCache_(vulkan) {
+	uploadFrameBudget_ = TEXCACHE_UPLOAD_BUDGET;
 	DeviceRestore(draw);
 	SetupTextureDecoder();
 }
@@ -203,6 +238,7 @@ void TextureCacheVulkan::DeviceLost() {
 	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
 
 	Clear(true);
+	DestroyAtlasPages();
 
 	samplerCache_.DeviceLost();
 
@@ -237,6 +273,15 @@ void TextureCacheVulkan::DeviceRestore(Draw::DrawContext *draw) {
 
 	CompileScalingShader();
 
+	std::vector<ReplacedTextureFormat> compressedFormats;
+	for (ReplacedTextureFormat fmt : { ReplacedTextureFormat::F_BC1, ReplacedTextureFormat::F_BC3, ReplacedTextureFormat::F_BC7, ReplacedTextureFormat::F_ETC2_RGBA, ReplacedTextureFormat::F_ASTC_4x4 }) {
+		VkFormatProperties props;
+		vkGetPhysicalDeviceFormatProperties(vulkan->GetCurrentPhysicalDevice(), ToVulkanFormat(fmt), &props);
+		if (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)
+			compressedFormats.push_back(fmt);
+	}
+	replacer_.SetSupportedCompressedFormats(compressedFormats);
+
 	computeShaderManager_.DeviceRestore(vulkan);
 }
 
@@ -256,10 +301,58 @@ static std::string ReadShaderSrc(const Path &filename) {
 	return src;
 }
 
+// Builds a compute shader doing what the CPU scaler would with the current upscale settings, so that
+// textures get scaled on the GPU on upload. Returns false if there's no GPU version of the settings,
+// those are left to the CPU scaler.
+static bool GetBuiltinScalingShader(int factor, std::string *source) {
+	if (factor < 2 || factor > 5 || g_Config.bTexDeposterize)
+		return false;
+
+	std::string xbrzFile;
+	if (factor == 2 || factor == 4)
+		xbrzFile = StringFromFormat("tex_%dxbrz.csh", factor);
+
+	const Path shaders("shaders");
+	switch (g_Config.iTexScalingType) {
+	case TextureScalerCommon::XBRZ:
+		if (xbrzFile.empty())
+			return false;
+		*source = ReadShaderSrc(shaders / xbrzFile);
+		break;
+	case TextureScalerCommon::BICUBIC:
+		*source = ReadShaderSrc(shaders / "tex_bicubic.csh");
+		break;
+	case TextureScalerCommon::HYBRID:
+	case TextureScalerCommon::HYBRID_BICUBIC:
+	{
+		if (xbrzFile.empty())
+			return false;
+		std::string hybrid = ReadShaderSrc(shaders / "tex_hybrid.csh");
+		std::string xbrz = ReadShaderSrc(shaders / xbrzFile);
+		if (hybrid.empty() || xbrz.empty())
+			return false;
+		std::string defines = g_Config.iTexScalingType == TextureScalerCommon::HYBRID_BICUBIC ? "#define HYBRID_BICUBIC\n" : "";
+		*source = defines + "#define HYBRID_PART 1\n" + hybrid + "\n" + xbrz + "\n#undef HYBRID_PART\n#define HYBRID_PART 2\n" + hybrid;
+		break;
+	}
+	default:
+		return false;
+	}
+	return !source->empty();
+}
+
 void TextureCacheVulkan::CompileScalingShader() {
 	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
 
-	if (!g_Config.bTexHardwareScaling || g_Config.sTextureShaderName != textureShader_) {
+	// A chosen texture shader wins, otherwise try to do the regular upscaling on the GPU.
+	std::string wantedShader;
+	if (g_Config.bTexHardwareScaling) {
+		wantedShader = g_Config.sTextureShaderName;
+	} else if (g_Config.bTexScalingGPU && standardScaleFactor_ > 1) {
+		wantedShader = StringFromFormat("builtin:%d:%d:%d", g_Config.iTexScalingType, standardScaleFactor_, (int)g_Config.bTexDeposterize);
+	}
+
+	if (wantedShader != textureShader_) {
 		if (uploadCS_ != VK_NULL_HANDLE)
 			vulkan->Delete().QueueDeleteShaderModule(uploadCS_);
 		textureShader_.clear();
@@ -269,28 +362,133 @@ void TextureCacheVulkan::CompileScalingShader() {
 		return;
 	}
 
-	if (!g_Config.bTexHardwareScaling)
+	if (wantedShader.empty())
 		return;
 
-	ReloadAllPostShaderInfo(draw_);
-	const TextureShaderInfo *shaderInfo = GetTextureShaderInfo(g_Config.sTextureShaderName);
-	if (!shaderInfo || shaderInfo->computeShaderFile.empty())
-		return;
+	std::string shaderSource;
+	int scaleFactor;
+	if (g_Config.bTexHardwareScaling) {
+		ReloadAllPostShaderInfo(draw_);
+		const TextureShaderInfo *shaderInfo = GetTextureShaderInfo(g_Config.sTextureShaderName);
+		if (!shaderInfo || shaderInfo->computeShaderFile.empty())
+			return;
+		shaderSource = ReadShaderSrc(shaderInfo->computeShaderFile);
+		scaleFactor = shaderInfo->scaleFactor;
+	} else {
+		// If there's no GPU version, the CPU scaler takes it from here.
+		if (!GetBuiltinScalingShader(standardScaleFactor_, &shaderSource))
+			return;
+		scaleFactor = standardScaleFactor_;
+	}
 
-	std::string shaderSource = ReadShaderSrc(shaderInfo->computeShaderFile);
-	std::string fullUploadShader = StringFromFormat(uploadShader, shaderSource.c_str());
+	std::string fullUploadShader = StringFromFormat(uploadShader, scaleFactor, shaderSource.c_str());
 
 	std::string error;
 	uploadCS_ = CompileShaderModule(vulkan, VK_SHADER_STAGE_COMPUTE_BIT, fullUploadShader.c_str(), &error);
 	_dbg_assert_msg_(uploadCS_ != VK_NULL_HANDLE, "failed to compile upload shader");
 
-	textureShader_ = g_Config.sTextureShaderName;
-	shaderScaleFactor_ = shaderInfo->scaleFactor;
+	textureShader_ = wantedShader;
+	shaderScaleFactor_ = scaleFactor;
 }
 
 void TextureCacheVulkan::ReleaseTexture(TexCacheEntry *entry, bool delete_them) {
+	if (entry->atlasPage != 0 && entry->vkTex) {
+		FreeAtlasCell(entry);
+		return;
+	}
 	delete entry->vkTex;
 	entry->vkTex = nullptr;
+	entry->atlasPage = 0;
+}
+
+bool TextureCacheVulkan::AllocateAtlasCell(TexCacheEntry *entry, VkCommandBuffer cmdInit) {
+	const int cellsPerPage = TEXCACHE_ATLAS_CELLS_PER_ROW * TEXCACHE_ATLAS_CELLS_PER_ROW;
+	int cell = -1;
+	size_t pageIndex = 0;
+	for (; pageIndex < atlasPages_.size(); ++pageIndex) {
+		AtlasPage &page = atlasPages_[pageIndex];
+		// Draws earlier in the frame a cell was released in may still sample the old texture.
+		if (!page.freeCells.empty() && page.freeCells.front().second != gpuStats.numFlips) {
+			cell = page.freeCells.front().first;
+			page.freeCells.pop_front();
+			break;
+		}
+		if (page.nextCell < cellsPerPage) {
+			cell = page.nextCell++;
+			break;
+		}
+	}
+
+	if (cell == -1) {
+		if (atlasPages_.size() >= TEXCACHE_ATLAS_MAX_PAGES || lowMemoryMode_)
+			return false;
+
+		VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
+		AtlasPage page;
+		page.tex = new VulkanTexture(vulkan);
+		char texName[64];
+		snprintf(texName, sizeof(texName), "tex_atlas_%d", (int)atlasPages_.size());
+		page.tex->SetTag(texName);
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		if (!page.tex->CreateDirect(cmdInit, TEXCACHE_ATLAS_PAGE_SIZE, TEXCACHE_ATLAS_PAGE_SIZE, 1, VULKAN_8888_FORMAT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, usage, &VULKAN_8888_SWIZZLE)) {
+			WARN_LOG(G3D, "Failed to create texture atlas page");
+			delete page.tex;
+			return false;
+		}
+		page.tex->ClearMip(cmdInit, 0, 0);
+		page.tex->EndCreate(cmdInit, false, VK_PIPELINE_STAGE_TRANSFER_BIT);
+		cell = page.nextCell++;
+		atlasPages_.push_back(std::move(page));
+	}
+
+	entry->vkTex = atlasPages_[pageIndex].tex;
+	entry->atlasPage = (u8)(pageIndex + 1);
+	entry->atlasX = (u16)((cell % TEXCACHE_ATLAS_CELLS_PER_ROW) * TEXCACHE_ATLAS_CELL_SIZE + 1);
+	entry->atlasY = (u16)((cell / TEXCACHE_ATLAS_CELLS_PER_ROW) * TEXCACHE_ATLAS_CELL_SIZE + 1);
+	return true;
+}
+
+void TextureCacheVulkan::UploadAtlasCell(TexCacheEntry *entry, VkCommandBuffer cmdInit, VkFormat dstFmt, int w, int h) {
+	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
+
+	tmpTexBufRearrange_.resize(w * h);
+	const u32 *pixels = tmpTexBufRearrange_.data();
+	LoadTextureLevel(*entry, (uint8_t *)tmpTexBufRearrange_.data(), w * sizeof(u32), 0, 1, dstFmt);
+
+	// The border repeats the opposite edges, so filtering matches a wrapping sampler.
+	// When clamping, the shader never samples past the texel centers at the edges.
+	const int paddedW = w + 2;
+	const int paddedH = h + 2;
+	const int size = paddedW * paddedH * sizeof(u32);
+	int pushAlignment = std::max(16, (int)vulkan->GetPhysicalDeviceProperties().properties.limits.optimalBufferCopyOffsetAlignment);
+	uint32_t bufferOffset;
+	VkBuffer texBuf;
+	u32 *data = (u32 *)drawEngine_->GetPushBufferForTextureData()->PushAligned(size, &bufferOffset, &texBuf, pushAlignment);
+	for (int y = 0; y < paddedH; ++y) {
+		const u32 *src = pixels + ((y + h - 1) % h) * w;
+		u32 *dst = data + y * paddedW;
+		dst[0] = src[w - 1];
+		memcpy(dst + 1, src, w * sizeof(u32));
+		dst[w + 1] = src[0];
+	}
+	uploadBytesThisFrame_ += size;
+
+	entry->vkTex->UpdateRect(cmdInit, entry->atlasX - 1, entry->atlasY - 1, paddedW, paddedH, texBuf, bufferOffset);
+}
+
+void TextureCacheVulkan::FreeAtlasCell(TexCacheEntry *entry) {
+	AtlasPage &page = atlasPages_[entry->atlasPage - 1];
+	int cell = (entry->atlasY / TEXCACHE_ATLAS_CELL_SIZE) * TEXCACHE_ATLAS_CELLS_PER_ROW + entry->atlasX / TEXCACHE_ATLAS_CELL_SIZE;
+	page.freeCells.push_back(std::make_pair(cell, gpuStats.numFlips));
+	entry->vkTex = nullptr;
+	entry->atlasPage = 0;
+}
+
+void TextureCacheVulkan::DestroyAtlasPages() {
+	for (AtlasPage &page : atlasPages_) {
+		delete page.tex;
+	}
+	atlasPages_.clear();
 }
 
 VkFormat getClutDestFormatVulkan(GEPaletteFormat format) {
@@ -319,6 +517,7 @@ void TextureCacheVulkan::StartFrame() {
 	timesInvalidatedAllThisFrame_ = 0;
 	texelsScaledThisFrame_ = 0;
 	replacementTimeThisFrame_ = 0.0;
+	uploadBytesThisFrame_ = 0;
 
 	if (clearCacheNextFrame_) {
 		Clear(true);
@@ -333,6 +532,7 @@ void TextureCacheVulkan::StartFrame() {
 		// Maybe see https://gpuopen-librariesandsdks.github.io/VulkanMemoryAllocator/html/staying_within_budget.html#staying_within_budget_querying_for_budget .
 		Decimate(false);
 	}
+	StartHashVerification();
 
 	computeShaderManager_.BeginFrame();
 }
@@ -389,6 +589,33 @@ void TextureCacheVulkan::BindTexture(TexCacheEntry *entry) {
 	imageView_ = entry->vkTex->GetImageView();
 	int maxLevel = (entry->status & TexCacheEntry::STATUS_BAD_MIPS) ? 0 : entry->maxLevel;
 	SamplerCacheKey samplerKey = GetSamplingParams(maxLevel, entry);
+	if (entry->atlasPage != 0) {
+		// The shader wraps or clamps inside the cell, like with framebuffer textures.
+		samplerKey.sClamp = true;
+		samplerKey.tClamp = true;
+	}
+
+	if (entry->status & TexCacheEntry::STATUS_INDEXED) {
+		// Same as the framebuffer shader depal below, the index is in red and the rest reads as zero.
+		const GEPaletteFormat clutFormat = gstate.getClutPaletteFormat();
+		depalShaderCache_->SetPushBuffer(drawEngine_->GetPushBufferForTextureData());
+		VulkanTexture *clutTexture = depalShaderCache_->GetClutTexture(clutFormat, clutHash_, clutBuf_, !gstate_c.Supports(GPU_SUPPORTS_16BIT_FORMATS));
+		drawEngine_->SetDepalTexture(clutTexture ? clutTexture->GetImageView() : VK_NULL_HANDLE);
+		// The shader filters after the lookup.
+		samplerKey.magFilt = false;
+		samplerKey.minFilt = false;
+		samplerKey.mipFilt = false;
+		curSampler_ = samplerCache_.GetOrCreateSampler(samplerKey);
+		gstate_c.Dirty(DIRTY_DEPAL);
+		gstate_c.SetUseShaderDepal(true);
+		gstate_c.depalFramebufferFormat = GE_FORMAT_8888;
+		const u32 bytesPerColor = clutFormat == GE_CMODE_32BIT_ABGR8888 ? sizeof(u32) : sizeof(u16);
+		const u32 clutTotalColors = clutMaxBytes_ / bytesPerColor;
+		// ApplyTexture sets full alpha from this.
+		entry->SetAlphaStatus(CheckAlpha(clutBuf_, getClutDestFormatVulkan(clutFormat), clutTotalColors, clutTotalColors, 1));
+		return;
+	}
+
 	curSampler_ = samplerCache_.GetOrCreateSampler(samplerKey);
 	drawEngine_->SetDepalTexture(VK_NULL_HANDLE);
 	gstate_c.SetUseShaderDepal(false);
@@ -559,29 +786,17 @@ void TextureCacheVulkan::ApplyTextureFramebuffer(VirtualFramebuffer *framebuffer
 	curSampler_ = samplerCache_.GetOrCreateSampler(samplerKey);
 }
 
-ReplacedTextureFormat FromVulkanFormat(VkFormat fmt) {
-	switch (fmt) {
-	case VULKAN_565_FORMAT: return ReplacedTextureFormat::F_5650;
-	case VULKAN_1555_FORMAT: return ReplacedTextureFormat::F_5551;
-	case VULKAN_4444_FORMAT: return ReplacedTextureFormat::F_4444;
-	case VULKAN_8888_FORMAT: default: return ReplacedTextureFormat::F_8888;
-	}
-}
-
-VkFormat ToVulkanFormat(ReplacedTextureFormat fmt) {
-	switch (fmt) {
-	case ReplacedTextureFormat::F_5650: return VULKAN_565_FORMAT;
-	case ReplacedTextureFormat::F_5551: return VULKAN_1555_FORMAT;
-	case ReplacedTextureFormat::F_4444: return VULKAN_4444_FORMAT;
-	case ReplacedTextureFormat::F_8888: default: return VULKAN_8888_FORMAT;
-	}
+u64 TextureCacheVulkan::DeviceMemoryBudget() {
+	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
+	return vulkan ? vulkan->GetDeviceLocalMemoryAvailable() : 0;
 }
 
 void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 	entry->status &= ~TexCacheEntry::STATUS_ALPHA_MASK;
+	entry->atlasPage = 0;
 
 	// For the estimate, we assume cluts always point to 8888 for simplicity.
-	cacheSizeEstimate_ += EstimateTexMemoryUsage(entry);
+	SetTexMemoryUsage(entry, EstimateTexMemoryUsage(entry));
 
 	if ((entry->bufw == 0 || (gstate.texbufwidth[0] & 0xf800) != 0) && entry->addr >= PSP_GetKernelMemoryEnd()) {
 		ERROR_LOG_REPORT(G3D, "Texture with unexpected bufw (full=%d)", gstate.texbufwidth[0] & 0xffff);
@@ -589,6 +804,11 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		return;
 	}
 
+	if (entry->status & TexCacheEntry::STATUS_INDEXED) {
+		BuildIndexTexture(entry);
+		return;
+	}
+
 	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
 
 	// Adjust maxLevel to actually present levels..
@@ -633,7 +853,8 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 	VkFormat dstFmt = GetDestFormat(GETextureFormat(entry->format), gstate.getClutPaletteFormat());
 
 	int scaleFactor = standardScaleFactor_;
-	bool hardwareScaling = g_Config.bTexHardwareScaling && uploadCS_ != VK_NULL_HANDLE;
+	// Either a texture shader, or the GPU version of the regular upscaling (see CompileScalingShader).
+	bool hardwareScaling = uploadCS_ != VK_NULL_HANDLE;
 	if (hardwareScaling) {
 		scaleFactor = shaderScaleFactor_;
 		dstFmt = VK_FORMAT_R8G8B8A8_UNORM;
@@ -680,6 +901,7 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 			texelsScaledThisFrame_ += w * h;
 		}
 	}
+	SetTexMemoryUsage(entry, replaced, scaleFactor);
 
 	bool isVideo = IsVideo(entry->addr);
 
@@ -716,11 +938,76 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 	VkFormat actualFmt = scaleFactor > 1 ? VULKAN_8888_FORMAT : dstFmt;
 	if (replaced.Valid()) {
 		actualFmt = ToVulkanFormat(replaced.Format(0));
+		// Block compressed images can't be blitted to generate mips, so we only use the levels we have.
+		if (ReplacedFormatIsCompressed(replaced.Format(0)))
+			maxLevelToGenerate = maxLevel;
+	}
+
+	// NOTE: Since the level is not part of the cache key, we assume it never changes.
+	u8 level = std::max(0, gstate.getTexLevelOffset16() / 16);
+	bool fakeMipmap = IsFakeMipmapChange() && level > 0;
+
+	struct LevelLayout {
+		int width;
+		int height;
+		int stride;
+		int size;
+		// In texels, as the copy wants it.
+		int rowLength;
+	};
+	auto getLevelLayout = [&](int i) {
+		LevelLayout layout;
+		layout.width = gstate.getTextureWidth(i) * scaleFactor;
+		layout.height = gstate.getTextureHeight(i) * scaleFactor;
+		if (replaced.Valid()) {
+			replaced.GetSize(i, layout.width, layout.height);
+		}
+		int bpp = actualFmt == VULKAN_8888_FORMAT ? 4 : 2;
+		layout.stride = (layout.width * bpp + 15) & ~15;
+		layout.size = layout.stride * layout.height;
+		layout.rowLength = layout.stride / bpp;
+		if (replaced.Valid() && ReplacedFormatIsCompressed(replaced.Format(i))) {
+			// Tightly packed rows of blocks.
+			layout.stride = ReplacedFormatRowBytes(replaced.Format(i), layout.width);
+			layout.size = layout.stride * ReplacedFormatRows(replaced.Format(i), layout.height);
+			layout.rowLength = (layout.width + 3) & ~3;
+		}
+		return layout;
+	};
+
+	// If this frame has already uploaded a lot, start with only the smallest mips that fit and leave
+	// the larger ones for later frames (see STATUS_TO_UPLOAD.) The image then starts at firstLevel.
+	// The first upload of a frame always goes through whole, or a big texture might never fit.
+	int firstLevel = 0;
+	if (maxLevel > 0 && !fakeMipmap && !isVideo && (entry->status & TexCacheEntry::STATUS_CHANGE_FREQUENT) == 0 && uploadBytesThisFrame_ != 0) {
+		int64_t bytes = 0;
+		for (int i = maxLevel; i >= 0; i--) {
+			bytes += getLevelLayout(i).size;
+			if (i < maxLevel && uploadBytesThisFrame_ + bytes > uploadFrameBudget_) {
+				firstLevel = i + 1;
+				break;
+			}
+		}
+	}
+	if (firstLevel > 0) {
+		entry->status |= TexCacheEntry::STATUS_TO_UPLOAD;
+	} else {
+		entry->status &= ~TexCacheEntry::STATUS_TO_UPLOAD;
 	}
 
 	bool computeUpload = false;
 	VkCommandBuffer cmdInit = (VkCommandBuffer)draw_->GetNativeObject(Draw::NativeObject::INIT_COMMANDBUFFER);
 
+	// Small textures without mips share atlas pages, so runs of draws using different ones can keep the same binding.
+	// Scaled and replaced textures don't fit the cells, and frequently changing ones would just churn them.
+	bool atlasSize = w >= TEXCACHE_ATLAS_MIN_SIZE && h >= TEXCACHE_ATLAS_MIN_SIZE && w <= TEXCACHE_ATLAS_MAX_SIZE && h <= TEXCACHE_ATLAS_MAX_SIZE;
+	bool useAtlas = atlasSize && maxLevelToGenerate == 0 && scaleFactor == 1 && dstFmt == VULKAN_8888_FORMAT && !replaced.Valid() && !replacer_.Enabled();
+	if (useAtlas && !isVideo && !fakeMipmap && (entry->status & TexCacheEntry::STATUS_CHANGE_FREQUENT) == 0 && AllocateAtlasCell(entry, cmdInit)) {
+		UploadAtlasCell(entry, cmdInit, dstFmt, w, h);
+		entry->status |= TexCacheEntry::STATUS_BAD_MIPS;
+		return;
+	}
+
 	{
 		delete entry->vkTex;
 		entry->vkTex = new VulkanTexture(vulkan);
@@ -765,7 +1052,14 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		snprintf(texName, sizeof(texName), "tex_%08x_%s", entry->addr, GeTextureFormatToString((GETextureFormat)entry->format, gstate.getClutPaletteFormat()));
 		image->SetTag(texName);
 
-		bool allocSuccess = image->CreateDirect(cmdInit, w * scaleFactor, h * scaleFactor, maxLevelToGenerate + 1, actualFmt, imageLayout, usage, mapping);
+		int imageWidth = w * scaleFactor;
+		int imageHeight = h * scaleFactor;
+		if (firstLevel > 0) {
+			LevelLayout first = getLevelLayout(firstLevel);
+			imageWidth = first.width;
+			imageHeight = first.height;
+		}
+		bool allocSuccess = image->CreateDirect(cmdInit, imageWidth, imageHeight, maxLevelToGenerate + 1 - firstLevel, actualFmt, imageLayout, usage, mapping);
 		if (!allocSuccess && !lowMemoryMode_) {
 			WARN_LOG_REPORT(G3D, "Texture cache ran out of GPU memory; switching to low memory mode");
 			lowMemoryMode_ = true;
@@ -783,8 +1077,12 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 
 			scaleFactor = 1;
 			actualFmt = dstFmt;
+			if (firstLevel == 0) {
+				imageWidth = w;
+				imageHeight = h;
+			}
 
-			allocSuccess = image->CreateDirect(cmdInit, w * scaleFactor, h * scaleFactor, maxLevelToGenerate + 1, actualFmt, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, mapping);
+			allocSuccess = image->CreateDirect(cmdInit, imageWidth, imageHeight, maxLevelToGenerate + 1 - firstLevel, actualFmt, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, mapping);
 		}
 
 		if (!allocSuccess) {
@@ -809,22 +1107,19 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		VK_PROFILE_BEGIN(vulkan, cmdInit, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
 			"Texture Upload (%08x) video=%d", entry->addr, isVideo);
 
-		// NOTE: Since the level is not part of the cache key, we assume it never changes.
-		u8 level = std::max(0, gstate.getTexLevelOffset16() / 16);
-		bool fakeMipmap = IsFakeMipmapChange() && level > 0;
 		// Upload the texture data.
-		for (int i = 0; i <= maxLevel; i++) {
+		for (int i = firstLevel; i <= maxLevel; i++) {
 			int mipUnscaledWidth = gstate.getTextureWidth(i);
 			int mipUnscaledHeight = gstate.getTextureHeight(i);
 
-			int mipWidth = mipUnscaledWidth * scaleFactor;
-			int mipHeight = mipUnscaledHeight * scaleFactor;
-			if (replaced.Valid()) {
-				replaced.GetSize(i, mipWidth, mipHeight);
-			}
+			LevelLayout mip = getLevelLayout(i);
+			int mipWidth = mip.width;
+			int mipHeight = mip.height;
 			int bpp = actualFmt == VULKAN_8888_FORMAT ? 4 : 2;
-			int stride = (mipWidth * bpp + 15) & ~15;
-			int size = stride * mipHeight;
+			int stride = mip.stride;
+			int size = mip.size;
+			int rowLength = mip.rowLength;
+			uploadBytesThisFrame_ += size;
 			uint32_t bufferOffset;
 			VkBuffer texBuf;
 			// NVIDIA reports a min alignment of 1 but that can't be healthy... let's align by 16 as a minimum.
@@ -839,7 +1134,7 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 				replacementTimeThisFrame_ += time_now_d() - replaceStart;
 				VK_PROFILE_BEGIN(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT,
 					"Copy Upload (replaced): %dx%d", mipWidth, mipHeight);
-				entry->vkTex->UploadMip(cmdInit, i, mipWidth, mipHeight, texBuf, bufferOffset, stride / bpp);
+				entry->vkTex->UploadMip(cmdInit, i - firstLevel, mipWidth, mipHeight, texBuf, bufferOffset, rowLength);
 				VK_PROFILE_END(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT);
 			} else {
 				if (fakeMipmap) {
@@ -873,7 +1168,7 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 						LoadTextureLevel(*entry, (uint8_t *)data, stride, i, scaleFactor, dstFmt);
 						VK_PROFILE_BEGIN(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT,
 							"Copy Upload: %dx%d", mipWidth, mipHeight);
-						entry->vkTex->UploadMip(cmdInit, i, mipWidth, mipHeight, texBuf, bufferOffset, stride / bpp);
+						entry->vkTex->UploadMip(cmdInit, i - firstLevel, mipWidth, mipHeight, texBuf, bufferOffset, stride / bpp);
 						VK_PROFILE_END(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT);
 					}
 				}
@@ -893,7 +1188,7 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		// This will transition the whole stack to GENERAL if it wasn't already.
 		if (maxLevel != maxLevelToGenerate) {
 			VK_PROFILE_BEGIN(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT, "Mipgen up to level %d", maxLevelToGenerate);
-			entry->vkTex->GenerateMips(cmdInit, maxLevel + 1, computeUpload);
+			entry->vkTex->GenerateMips(cmdInit, maxLevel + 1 - firstLevel, computeUpload);
 			layout = VK_IMAGE_LAYOUT_GENERAL;
 			prevStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
 			VK_PROFILE_END(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT);
@@ -906,12 +1201,55 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		}
 		if (replaced.Valid()) {
 			entry->SetAlphaStatus(TexCacheEntry::TexStatus(replaced.AlphaStatus()));
+		} else if (firstLevel > 0) {
+			// Level 0 wasn't checked.
+			entry->SetAlphaStatus(TexCacheEntry::STATUS_ALPHA_UNKNOWN);
 		}
 		entry->vkTex->EndCreate(cmdInit, false, prevStage, layout);
 		VK_PROFILE_END(vulkan, cmdInit, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
 	}
 }
 
+void TextureCacheVulkan::BuildIndexTexture(TexCacheEntry *const entry) {
+	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
+	VkCommandBuffer cmdInit = (VkCommandBuffer)draw_->GetNativeObject(Draw::NativeObject::INIT_COMMANDBUFFER);
+
+	int w = gstate.getTextureWidth(0);
+	int h = gstate.getTextureHeight(0);
+	// Zero the other channels, so the shader's 8888 index decode sees only the index.
+	static const VkComponentMapping indexMapping = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_ZERO, VK_COMPONENT_SWIZZLE_ZERO, VK_COMPONENT_SWIZZLE_ZERO };
+
+	delete entry->vkTex;
+	entry->vkTex = new VulkanTexture(vulkan);
+	char texName[128]{};
+	snprintf(texName, sizeof(texName), "idx_%08x_%s", entry->addr, GeTextureFormatToString((GETextureFormat)entry->format));
+	entry->vkTex->SetTag(texName);
+	if (!entry->vkTex->CreateDirect(cmdInit, w, h, 1, VK_FORMAT_R8_UNORM, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, &indexMapping)) {
+		ERROR_LOG(G3D, "Failed to create index texture (%dx%d)", w, h);
+		delete entry->vkTex;
+		entry->vkTex = nullptr;
+		return;
+	}
+
+	int stride = (w + 15) & ~15;
+	int pushAlignment = std::max(16, (int)vulkan->GetPhysicalDeviceProperties().properties.limits.optimalBufferCopyOffsetAlignment);
+	uint32_t bufferOffset;
+	VkBuffer texBuf;
+	void *data = drawEngine_->GetPushBufferForTextureData()->PushAligned(stride * h, &bufferOffset, &texBuf, pushAlignment);
+	u32 texaddr = gstate.getTextureAddress(0);
+	int bufw = GetTextureBufw(0, texaddr, GETextureFormat(entry->format));
+	DecodeIndexLevel((u8 *)data, stride, GETextureFormat(entry->format), texaddr, bufw);
+	gpuStats.numTexturesDecoded++;
+	uploadBytesThisFrame_ += stride * h;
+
+	entry->vkTex->UploadMip(cmdInit, 0, w, h, texBuf, bufferOffset, stride);
+	entry->vkTex->EndCreate(cmdInit, false, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	entry->status |= TexCacheEntry::STATUS_BAD_MIPS;
+	entry->status &= ~TexCacheEntry::STATUS_TO_UPLOAD;
+	// Depends on the palette, BindTexture checks it.
+	entry->SetAlphaStatus(TexCacheEntry::STATUS_ALPHA_UNKNOWN);
+}
+
 VkFormat TextureCacheVulkan::GetDestFormat(GETextureFormat format, GEPaletteFormat clutFormat) const {
 	if (!gstate_c.Supports(GPU_SUPPORTS_16BIT_FORMATS)) {
 		return VK_FORMAT_R8G8B8A8_UNORM;
@@ -1070,11 +1408,19 @@ bool TextureCacheVulkan::GetCurrentTextureDebug(GPUDebugBuffer &buffer, int leve
 		break;
 	}
 
+	int x = 0;
+	int y = 0;
 	int w = texture->GetWidth();
 	int h = texture->GetHeight();
+	if (entry->atlasPage != 0) {
+		x = entry->atlasX;
+		y = entry->atlasY;
+		w = gstate.getTextureWidth(0);
+		h = gstate.getTextureHeight(0);
+	}
 	buffer.Allocate(w, h, bufferFormat);
 
-	renderManager->CopyImageToMemorySync(texture->GetImage(), level, 0, 0, w, h, drawFormat, (uint8_t *)buffer.GetData(), w, "GetCurrentTextureDebug");
+	renderManager->CopyImageToMemorySync(texture->GetImage(), level, x, y, w, h, drawFormat, (uint8_t *)buffer.GetData(), w, "GetCurrentTextureDebug");
 
 	// Vulkan requires us to re-apply all dynamic state for each command buffer, and the above will cause us to start a new cmdbuf.
 	// So let's dirty the things that are involved in Vulkan dynamic state. Readbacks are not frequent so this won't hurt other backends.
@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include <deque>
 #include <map>
+#include <vector>
 
 #include "Common/Data/Collections/Hashmaps.h"
 #include "GPU/GPUInterface.h"
@@ -105,18 +107,26 @@ class TextureCacheVulkan : public TextureCacheCommon {
 	void BindTexture(TexCacheEntry *entry) override;
 	void Unbind() override;
 	void ReleaseTexture(TexCacheEntry *entry, bool delete_them) override;
+	u64 DeviceMemoryBudget() override;
 
 private:
 	void LoadTextureLevel(TexCacheEntry &entry, uint8_t *writePtr, int rowPitch,  int level, int scaleFactor, VkFormat dstFmt);
 	VkFormat GetDestFormat(GETextureFormat format, GEPaletteFormat clutFormat) const;
 	static TexCacheEntry::TexStatus CheckAlpha(const u32 *pixelData, VkFormat dstFmt, int stride, int w, int h);
 	void UpdateCurrentClut(GEPaletteFormat clutFormat, u32 clutBase, bool clutIndexIsSimple) override;
+	bool SupportsIndexTextures() const override { return true; }
 
 	void ApplyTextureFramebuffer(VirtualFramebuffer *framebuffer, GETextureFormat texFormat, FramebufferNotificationChannel channel) override;
 	void BuildTexture(TexCacheEntry *const entry) override;
+	void BuildIndexTexture(TexCacheEntry *const entry);
 
 	void CompileScalingShader();
 
+	bool AllocateAtlasCell(TexCacheEntry *entry, VkCommandBuffer cmdInit);
+	void UploadAtlasCell(TexCacheEntry *entry, VkCommandBuffer cmdInit, VkFormat dstFmt, int w, int h);
+	void FreeAtlasCell(TexCacheEntry *entry);
+	void DestroyAtlasPages();
+
 	VulkanDeviceAllocator *allocator_ = nullptr;
 	VulkanPushBuffer *push_ = nullptr;
 
@@ -140,6 +150,16 @@ class TextureCacheVulkan : public TextureCacheCommon {
 	VkSampler curSampler_ = VK_NULL_HANDLE;
 
 	VkSampler samplerNearest_ = VK_NULL_HANDLE;
+
+	// Small textures are packed into these, see AllocateAtlasCell().
+	struct AtlasPage {
+		VulkanTexture *tex = nullptr;
+		// Cells from here on were never handed out.
+		int nextCell = 0;
+		// Released cells and the frame they were released in, oldest first.
+		std::deque<std::pair<int, int>> freeCells;
+	};
+	std::vector<AtlasPage> atlasPages_;
 };
 
 VkFormat getClutDestFormatVulkan(GEPaletteFormat format);
@@ -0,0 +1,210 @@
+// Decodes the binary syscall trace written by Core/HLE/HLETrace.cpp.
+
+use std::convert::TryInto;
+use std::env;
+use std::fs;
+use std::process;
+
+const HEADER_SIZE: usize = 64;
+const RECORD_SIZE: usize = 64;
+const TRACE_RETURNED: u32 = 1;
+
+struct Func {
+    nid: u32,
+    name: String,
+    retmask: u8,
+    argmask: Vec<u8>,
+}
+
+struct Module {
+    name: String,
+    funcs: Vec<Func>,
+}
+
+fn u16_at(data: &[u8], pos: usize) -> u16 {
+    u16::from_le_bytes(data[pos..pos + 2].try_into().unwrap())
+}
+
+fn u32_at(data: &[u8], pos: usize) -> u32 {
+    u32::from_le_bytes(data[pos..pos + 4].try_into().unwrap())
+}
+
+fn u64_at(data: &[u8], pos: usize) -> u64 {
+    u64::from_le_bytes(data[pos..pos + 8].try_into().unwrap())
+}
+
+fn read_string(data: &[u8], pos: &mut usize) -> Result<Vec<u8>, String> {
+    let len = *data.get(*pos).ok_or("Function table is truncated")? as usize;
+    let s = data.get(*pos + 1..*pos + 1 + len).ok_or("Function table is truncated")?;
+    *pos += 1 + len;
+    Ok(s.to_vec())
+}
+
+fn read_table(table: &[u8]) -> Result<Vec<Module>, String> {
+    let mut modules = Vec::new();
+    let mut pos = 0;
+    while pos < table.len() {
+        if pos + 2 > table.len() {
+            return Err("Function table is truncated".to_string());
+        }
+        let count = u16_at(table, pos) as usize;
+        pos += 2;
+        let name = String::from_utf8_lossy(&read_string(table, &mut pos)?).to_string();
+        let mut funcs = Vec::with_capacity(count);
+        for _ in 0..count {
+            if pos + 4 > table.len() {
+                return Err("Function table is truncated".to_string());
+            }
+            let nid = u32_at(table, pos);
+            pos += 4;
+            let name = String::from_utf8_lossy(&read_string(table, &mut pos)?).to_string();
+            let retmask = *table.get(pos).ok_or("Function table is truncated")?;
+            pos += 1;
+            let argmask = read_string(table, &mut pos)?;
+            funcs.push(Func { nid, name, retmask, argmask });
+        }
+        modules.push(Module { name, funcs });
+    }
+    Ok(modules)
+}
+
+// Same register assignment as hleFormatLogArgs, but only the 8 argument registers are recorded.
+fn format_args(argmask: &[u8], args: &[u32; 8]) -> String {
+    let mut parts = Vec::new();
+    let mut reg = 0;
+    for &c in argmask {
+        if reg >= 8 {
+            parts.push("?".to_string());
+            continue;
+        }
+        match c {
+            b'i' => parts.push(format!("{}", args[reg] as i32)),
+            b'X' | b'I' => {
+                // 64-bit args are always in an aligned pair.
+                reg += reg & 1;
+                if reg + 1 < 8 {
+                    let v = args[reg] as u64 | ((args[reg + 1] as u64) << 32);
+                    parts.push(format!("{:016x}", v));
+                } else {
+                    parts.push("?".to_string());
+                }
+                reg += 1;
+            }
+            // Float args are in FPU registers, which aren't recorded.
+            b'f' | b'F' => {
+                parts.push("?".to_string());
+                continue;
+            }
+            _ => parts.push(format!("{:08x}", args[reg])),
+        }
+        reg += 1;
+    }
+    parts.join(", ")
+}
+
+fn format_return(retmask: u8, v0: u32, v1: u32) -> String {
+    match retmask {
+        b'v' => String::new(),
+        // Negative results are almost always error codes, which are easier to read in hex.
+        b'i' if (v0 as i32) >= 0 => format!(" = {}", v0),
+        b'X' | b'I' => format!(" = {:016x}", v0 as u64 | ((v1 as u64) << 32)),
+        _ => format!(" = {:08x}", v0),
+    }
+}
+
+fn parse_number(s: &str) -> Option<u64> {
+    if let Some(hex) = s.strip_prefix("0x") {
+        u64::from_str_radix(hex, 16).ok()
+    } else {
+        s.parse().ok()
+    }
+}
+
+fn usage() -> ! {
+    eprintln!("Usage: hletrace [--last N] [--thread ID] path/to/hletrace.bin");
+    process::exit(1);
+}
+
+fn main() {
+    let mut last = None;
+    let mut thread = None;
+    let mut path = None;
+    let mut args = env::args().skip(1);
+    while let Some(arg) = args.next() {
+        match arg.as_str() {
+            "--last" => last = Some(args.next().and_then(|s| parse_number(&s)).unwrap_or_else(|| usage())),
+            "--thread" => thread = Some(args.next().and_then(|s| parse_number(&s)).unwrap_or_else(|| usage()) as u32),
+            _ if path.is_none() => path = Some(arg),
+            _ => usage(),
+        }
+    }
+    let path = path.unwrap_or_else(|| usage());
+
+    let data = fs::read(&path).unwrap_or_else(|e| {
+        eprintln!("Unable to read {}: {}", path, e);
+        process::exit(1);
+    });
+    if data.len() < HEADER_SIZE || &data[0..4] != b"PHLT" {
+        eprintln!("{} is not an HLE trace", path);
+        process::exit(1);
+    }
+    let version = u32_at(&data, 4);
+    let record_size = u32_at(&data, 8) as usize;
+    let capacity = u32_at(&data, 12) as u64;
+    let table_offset = u32_at(&data, 16) as usize;
+    let table_size = u32_at(&data, 20) as usize;
+    let records_offset = u32_at(&data, 24) as usize;
+    let written = u64_at(&data, 32);
+    if version != 1 || record_size != RECORD_SIZE || capacity == 0 {
+        eprintln!("Unsupported trace version {}", version);
+        process::exit(1);
+    }
+    if data.len() < records_offset + capacity as usize * RECORD_SIZE || table_offset + table_size > records_offset {
+        eprintln!("{} is truncated", path);
+        process::exit(1);
+    }
+
+    let modules = read_table(&data[table_offset..table_offset + table_size]).unwrap_or_else(|e| {
+        eprintln!("{}", e);
+        process::exit(1);
+    });
+
+    let count = written.min(capacity);
+    let count = last.map_or(count, |n| n.min(count));
+    println!("{} calls recorded, showing the last {}", written, count);
+
+    for i in written - count..written {
+        let pos = records_offset + (i % capacity) as usize * RECORD_SIZE;
+        let r = &data[pos..pos + RECORD_SIZE];
+        let ticks = u64_at(r, 0);
+        let pc = u32_at(r, 8);
+        let thread_id = u32_at(r, 12);
+        let module_index = u16_at(r, 16) as usize;
+        let func_index = u16_at(r, 18) as usize;
+        let flags = u32_at(r, 20);
+        let mut regs = [0u32; 8];
+        for (j, reg) in regs.iter_mut().enumerate() {
+            *reg = u32_at(r, 24 + j * 4);
+        }
+        let v0 = u32_at(r, 56);
+        let v1 = u32_at(r, 60);
+
+        if thread.map_or(false, |t| t != thread_id) {
+            continue;
+        }
+
+        let call = match modules.get(module_index).and_then(|m| m.funcs.get(func_index).map(|f| (m, f))) {
+            Some((module, func)) => {
+                let name = if func.name.is_empty() { format!("{:08x}", func.nid) } else { func.name.clone() };
+                let result = if flags & TRACE_RETURNED != 0 {
+                    format_return(func.retmask, v0, v1)
+                } else {
+                    " (no return)".to_string()
+                };
+                format!("{}::{}({}){}", module.name, name, format_args(&func.argmask, &regs), result)
+            }
+            None => format!("unknown function {}:{}", module_index, func_index),
+        };
+        println!("{:>14} thread {:08x} pc {:08x}  {}", ticks, thread_id, pc, call);
+    }
+}
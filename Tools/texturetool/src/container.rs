@@ -0,0 +1,146 @@
+// Writers for the compressed containers TextureReplacer reads: DDS for BCn and KTX2 for ASTC.
+
+use std::fs;
+use std::io;
+use std::path::Path;
+
+use crate::encode::Format;
+
+fn put_u32(out: &mut Vec<u8>, v: u32) {
+    out.extend_from_slice(&v.to_le_bytes());
+}
+
+fn put_u64(out: &mut Vec<u8>, v: u64) {
+    out.extend_from_slice(&v.to_le_bytes());
+}
+
+pub fn write_dds(path: &Path, format: Format, width: u32, height: u32, levels: &[Vec<u8>]) -> io::Result<()> {
+    let (fourcc, dxgi_format): (&[u8; 4], Option<u32>) = match format {
+        Format::Bc1 => (b"DXT1", None),
+        Format::Bc3 => (b"DXT5", None),
+        // DXGI_FORMAT_BC7_UNORM, which needs the DX10 extended header.
+        Format::Bc7 => (b"DX10", Some(98)),
+        Format::Astc => panic!("ASTC goes in KTX2"),
+    };
+
+    let mut out = Vec::new();
+    out.extend_from_slice(b"DDS ");
+    put_u32(&mut out, 124);
+    // CAPS | HEIGHT | WIDTH | PIXELFORMAT | MIPMAPCOUNT | LINEARSIZE
+    put_u32(&mut out, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000);
+    put_u32(&mut out, height);
+    put_u32(&mut out, width);
+    put_u32(&mut out, levels[0].len() as u32);
+    put_u32(&mut out, 0);
+    put_u32(&mut out, levels.len() as u32);
+    for _ in 0..11 {
+        put_u32(&mut out, 0);
+    }
+
+    // DDS_PIXELFORMAT, with DDPF_FOURCC.
+    put_u32(&mut out, 32);
+    put_u32(&mut out, 0x4);
+    out.extend_from_slice(fourcc);
+    for _ in 0..5 {
+        put_u32(&mut out, 0);
+    }
+
+    // DDSCAPS_TEXTURE, plus COMPLEX | MIPMAP with mips.
+    let caps = if levels.len() > 1 { 0x1000 | 0x8 | 0x400000 } else { 0x1000 };
+    put_u32(&mut out, caps);
+    for _ in 0..4 {
+        put_u32(&mut out, 0);
+    }
+
+    if let Some(dxgi_format) = dxgi_format {
+        put_u32(&mut out, dxgi_format);
+        // D3D10_RESOURCE_DIMENSION_TEXTURE2D, no flags, one array element.
+        put_u32(&mut out, 3);
+        put_u32(&mut out, 0);
+        put_u32(&mut out, 1);
+        put_u32(&mut out, 0);
+    }
+
+    for level in levels {
+        out.extend_from_slice(level);
+    }
+    fs::write(path, out)
+}
+
+// Basic data format descriptor for 4x4 ASTC, required by the KTX2 spec (PPSSPP doesn't read it.)
+fn astc_4x4_dfd() -> Vec<u8> {
+    let mut dfd = Vec::new();
+    put_u32(&mut dfd, 44);
+    // Khronos vendor, basic descriptor type, version 2, block size 40.
+    put_u32(&mut dfd, 0);
+    put_u32(&mut dfd, 2 | (40 << 16));
+    // KHR_DF_MODEL_ASTC, BT709 primaries, linear transfer, no flags.
+    dfd.extend_from_slice(&[162, 1, 1, 0]);
+    // Block dimensions minus one, then 16 bytes in plane 0.
+    dfd.extend_from_slice(&[3, 3, 0, 0]);
+    dfd.extend_from_slice(&[16, 0, 0, 0, 0, 0, 0, 0]);
+    // One sample covering all 128 bits.
+    put_u32(&mut dfd, 127 << 16);
+    put_u32(&mut dfd, 0);
+    put_u32(&mut dfd, 0);
+    put_u32(&mut dfd, 0xFFFFFFFF);
+    dfd
+}
+
+fn align(offset: usize, alignment: usize) -> usize {
+    (offset + alignment - 1) / alignment * alignment
+}
+
+pub fn write_ktx2(path: &Path, format: Format, width: u32, height: u32, levels: &[Vec<u8>]) -> io::Result<()> {
+    let vk_format = match format {
+        // VK_FORMAT_ASTC_4x4_UNORM_BLOCK
+        Format::Astc => 157,
+        _ => panic!("BCn goes in DDS"),
+    };
+
+    let dfd = astc_4x4_dfd();
+    let dfd_offset = 80 + 24 * levels.len();
+
+    // The spec wants the smallest level first in the file, aligned to the block size.
+    let mut offsets = vec![0; levels.len()];
+    let mut offset = dfd_offset + dfd.len();
+    for i in (0..levels.len()).rev() {
+        offset = align(offset, 16);
+        offsets[i] = offset;
+        offset += levels[i].len();
+    }
+
+    let mut out = Vec::new();
+    out.extend_from_slice(&[0xAB, b'K', b'T', b'X', b' ', b'2', b'0', 0xBB, b'\r', b'\n', 0x1A, b'\n']);
+    put_u32(&mut out, vk_format);
+    // typeSize, then width, height, depth, layers, faces, levels, and no supercompression.
+    put_u32(&mut out, 1);
+    put_u32(&mut out, width);
+    put_u32(&mut out, height);
+    put_u32(&mut out, 0);
+    put_u32(&mut out, 0);
+    put_u32(&mut out, 1);
+    put_u32(&mut out, levels.len() as u32);
+    put_u32(&mut out, 0);
+
+    put_u32(&mut out, dfd_offset as u32);
+    put_u32(&mut out, dfd.len() as u32);
+    // No key/value data or supercompression global data.
+    put_u32(&mut out, 0);
+    put_u32(&mut out, 0);
+    put_u64(&mut out, 0);
+    put_u64(&mut out, 0);
+
+    for (i, level) in levels.iter().enumerate() {
+        put_u64(&mut out, offsets[i] as u64);
+        put_u64(&mut out, level.len() as u64);
+        put_u64(&mut out, level.len() as u64);
+    }
+    out.extend_from_slice(&dfd);
+
+    for i in (0..levels.len()).rev() {
+        out.resize(offsets[i], 0);
+        out.extend_from_slice(&levels[i]);
+    }
+    fs::write(path, out)
+}
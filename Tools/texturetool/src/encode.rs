@@ -0,0 +1,79 @@
+use std::str::FromStr;
+
+use image::imageops::{self, FilterType};
+use image::RgbaImage;
+use intel_tex_2::{astc, bc1, bc3, bc7, RgbaSurface};
+
+#[derive(Clone, Copy, Debug, PartialEq)]
+pub enum Format {
+    Bc1,
+    Bc3,
+    Bc7,
+    Astc,
+}
+
+impl FromStr for Format {
+    type Err = String;
+
+    fn from_str(s: &str) -> Result<Self, Self::Err> {
+        match s.to_ascii_lowercase().as_str() {
+            "bc1" => Ok(Format::Bc1),
+            "bc3" => Ok(Format::Bc3),
+            "bc7" => Ok(Format::Bc7),
+            "astc" => Ok(Format::Astc),
+            _ => Err(format!("Unknown format {}, expected bc1, bc3, bc7 or astc", s)),
+        }
+    }
+}
+
+impl Format {
+    pub fn extension(self) -> &'static str {
+        match self {
+            Format::Astc => "ktx2",
+            _ => "dds",
+        }
+    }
+}
+
+fn encode_level(img: &RgbaImage, format: Format) -> Vec<u8> {
+    // The encoders work on whole 4x4 blocks, so repeat the edge pixels to fill them.
+    let (w, h) = img.dimensions();
+    let bw = (w + 3) & !3;
+    let bh = (h + 3) & !3;
+    let mut padded = vec![0u8; (bw * bh * 4) as usize];
+    for y in 0..bh {
+        for x in 0..bw {
+            let pixel = img.get_pixel(x.min(w - 1), y.min(h - 1));
+            let i = ((y * bw + x) * 4) as usize;
+            padded[i..i + 4].copy_from_slice(&pixel.0);
+        }
+    }
+
+    let surface = RgbaSurface {
+        data: &padded,
+        width: bw,
+        height: bh,
+        stride: bw * 4,
+    };
+    match format {
+        Format::Bc1 => bc1::compress_blocks(&surface),
+        Format::Bc3 => bc3::compress_blocks(&surface),
+        Format::Bc7 => bc7::compress_blocks(&bc7::alpha_basic_settings(), &surface),
+        Format::Astc => astc::compress_blocks(&astc::alpha_slow_settings(4, 4), &surface),
+    }
+}
+
+// Returns the compressed data of each level, starting with the full size image.
+pub fn encode(img: &RgbaImage, format: Format, mipmaps: bool) -> Vec<Vec<u8>> {
+    let mut levels = vec![encode_level(img, format)];
+    if mipmaps {
+        let mut mip = img.clone();
+        while mip.width() > 1 || mip.height() > 1 {
+            let w = (mip.width() / 2).max(1);
+            let h = (mip.height() / 2).max(1);
+            mip = imageops::resize(&mip, w, h, FilterType::Triangle);
+            levels.push(encode_level(&mip, format));
+        }
+    }
+    levels
+}
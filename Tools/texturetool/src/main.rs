@@ -0,0 +1,206 @@
+use std::collections::{BTreeMap, HashSet};
+use std::fs;
+use std::io;
+use std::path::{Path, PathBuf};
+
+mod container;
+mod encode;
+mod pack;
+use encode::Format;
+
+use structopt::StructOpt;
+
+#[derive(StructOpt, Debug)]
+struct Opt {
+    #[structopt(subcommand)]
+    cmd: Command,
+}
+
+#[derive(StructOpt, Debug)]
+enum Command {
+    /// Compresses the PNGs of a texture pack to a GPU format and points textures.ini at them.
+    /// The PNGs are kept, as a fallback for GPUs without support for the format.
+    Transcode {
+        /// bc1, bc3, bc7 (written as .dds) or astc (4x4, written as .ktx2.)
+        #[structopt(long, default_value = "bc7")]
+        format: Format,
+        /// Store a full mip chain in each file.
+        #[structopt(long)]
+        mipmaps: bool,
+        /// The texture pack directory, containing textures.ini.
+        #[structopt(parse(from_os_str))]
+        dir: PathBuf,
+    },
+    /// Puts all the textures of a texture pack directory into textures.pack, which loads faster
+    /// than loose files. textures.ini stays a separate file.
+    Pack {
+        /// Where to write the pack, by default textures.pack in the directory.
+        #[structopt(long, parse(from_os_str))]
+        output: Option<PathBuf>,
+        /// The texture pack directory, containing textures.ini.
+        #[structopt(parse(from_os_str))]
+        dir: PathBuf,
+    },
+}
+
+fn is_hashes_section(line: &str) -> bool {
+    line.trim().eq_ignore_ascii_case("[hashes]")
+}
+
+fn is_section(line: &str) -> bool {
+    line.trim_start().starts_with('[')
+}
+
+// Level 0 keys only. Separate mip files of a compressed texture are skipped, so the file's own mips get used.
+fn is_level_zero_key(key: &str) -> bool {
+    !key.contains('_') || key.ends_with("_0")
+}
+
+// Files named by hash work without being listed in textures.ini, e.g. 0000000012345678abcdef01.png.
+fn is_hash_name(stem: &str) -> bool {
+    stem.len() >= 24 && stem.chars().all(|c| c.is_ascii_hexdigit())
+}
+
+// Returns the PNGs to convert, by the textures.ini keys that use them, and all keys already listed.
+fn find_textures(dir: &Path, ini_lines: &[String]) -> io::Result<(BTreeMap<String, Vec<String>>, HashSet<String>)> {
+    let mut textures: BTreeMap<String, Vec<String>> = BTreeMap::new();
+    let mut keys = HashSet::new();
+
+    let mut in_hashes = false;
+    for line in ini_lines {
+        if is_section(line) {
+            in_hashes = is_hashes_section(line);
+            continue;
+        }
+        if !in_hashes || line.trim_start().starts_with('#') {
+            continue;
+        }
+        if let Some(pos) = line.find('=') {
+            let key = line[..pos].trim().to_ascii_lowercase();
+            let value = line[pos + 1..].trim();
+            keys.insert(key.clone());
+            if is_level_zero_key(&key) && value.to_ascii_lowercase().ends_with(".png") {
+                textures.entry(value.to_string()).or_default().push(key);
+            }
+        }
+    }
+
+    for entry in fs::read_dir(dir)? {
+        let path = entry?.path();
+        let is_png = path.extension().map_or(false, |ext| ext.eq_ignore_ascii_case("png"));
+        let stem = path.file_stem().unwrap_or_default().to_string_lossy().to_ascii_lowercase();
+        if is_png && is_hash_name(&stem) && !keys.contains(&stem) {
+            let filename = path.file_name().unwrap().to_string_lossy().to_string();
+            textures.entry(filename).or_default().push(stem);
+        }
+    }
+    Ok((textures, keys))
+}
+
+fn transcode_file(dir: &Path, filename: &str, format: Format, mipmaps: bool) -> Result<String, String> {
+    let png = dir.join(filename);
+    let img = image::open(&png).map_err(|e| e.to_string())?.to_rgba8();
+    let levels = encode::encode(&img, format, mipmaps);
+
+    let out_filename = Path::new(filename).with_extension(format.extension());
+    let out = dir.join(&out_filename);
+    let result = match format {
+        Format::Astc => container::write_ktx2(&out, format, img.width(), img.height(), &levels),
+        _ => container::write_dds(&out, format, img.width(), img.height(), &levels),
+    };
+    result.map_err(|e| e.to_string())?;
+    // textures.ini always uses forward slashes.
+    Ok(out_filename.to_string_lossy().replace('\\', "/"))
+}
+
+// Points the converted keys at the new files, and adds keys for converted files that weren't listed.
+fn update_ini(ini_lines: &mut Vec<String>, renamed: &BTreeMap<String, String>, added: &[(String, String)]) {
+    let mut in_hashes = false;
+    let mut hashes_end = None;
+    for (i, line) in ini_lines.iter_mut().enumerate() {
+        if is_section(line) {
+            in_hashes = is_hashes_section(line);
+            if in_hashes {
+                hashes_end = Some(i + 1);
+            }
+            continue;
+        }
+        if !in_hashes || line.trim_start().starts_with('#') {
+            continue;
+        }
+        if !line.trim().is_empty() {
+            hashes_end = Some(i + 1);
+        }
+        if let Some(pos) = line.find('=') {
+            let key = line[..pos].trim().to_ascii_lowercase();
+            if let Some(new_value) = renamed.get(&key) {
+                *line = format!("{} = {}", line[..pos].trim(), new_value);
+            }
+        }
+    }
+
+    if added.is_empty() {
+        return;
+    }
+    let insert_pos = match hashes_end {
+        Some(pos) => pos,
+        None => {
+            ini_lines.push(String::new());
+            ini_lines.push("[hashes]".to_string());
+            ini_lines.len()
+        }
+    };
+    let new_lines = added.iter().map(|(key, value)| format!("{} = {}", key, value));
+    ini_lines.splice(insert_pos..insert_pos, new_lines);
+}
+
+fn transcode(dir: &Path, format: Format, mipmaps: bool) -> io::Result<()> {
+    let ini_path = dir.join("textures.ini");
+    let ini_text = fs::read_to_string(&ini_path).unwrap_or_default();
+    let mut ini_lines: Vec<String> = ini_text.lines().map(|s| s.to_string()).collect();
+
+    let (textures, listed_keys) = find_textures(dir, &ini_lines)?;
+
+    let mut renamed = BTreeMap::new();
+    let mut added = Vec::new();
+    for (filename, keys) in &textures {
+        println!("Transcoding {}", filename);
+        match transcode_file(dir, filename, format, mipmaps) {
+            Ok(new_filename) => {
+                for key in keys {
+                    if listed_keys.contains(key) {
+                        renamed.insert(key.clone(), new_filename.clone());
+                    } else {
+                        added.push((key.clone(), new_filename.clone()));
+                    }
+                }
+            }
+            Err(err) => println!("  Skipped: {}", err),
+        }
+    }
+
+    update_ini(&mut ini_lines, &renamed, &added);
+    let mut text = ini_lines.join("\n");
+    text.push('\n');
+    fs::write(&ini_path, text)?;
+
+    println!(
+        "Updated {} textures.ini entries. Textures used with [hashranges] must stay as PNG, change those back.",
+        renamed.len() + added.len()
+    );
+    Ok(())
+}
+
+fn main() {
+    let opt = Opt::from_args();
+
+    match opt.cmd {
+        Command::Transcode { format, mipmaps, dir } => {
+            transcode(&dir, format, mipmaps).unwrap();
+        }
+        Command::Pack { output, dir } => {
+            let output = output.unwrap_or_else(|| dir.join("textures.pack"));
+            pack::pack(&dir, &output).unwrap();
+        }
+    }
+}
@@ -0,0 +1,107 @@
+// Writes textures.pack, the single file texture pack TextureReplacer reads before loose files.
+// Layout: "PPTP", version, entry count, reserved (u32 each), then the index of
+// (xxh3 of the filename, offset, size) as u64s sorted by hash, then the files, 16-byte aligned.
+
+use std::collections::HashMap;
+use std::fs;
+use std::io::{self, BufWriter, Write};
+use std::path::{Path, PathBuf};
+
+use xxhash_rust::xxh3::xxh3_64;
+
+const VERSION: u32 = 1;
+const HEADER_SIZE: u64 = 16;
+const ENTRY_SIZE: u64 = 24;
+const ALIGNMENT: u64 = 16;
+
+struct PackFile {
+    // Relative to the texture directory with forward slashes, like in textures.ini.
+    name: String,
+    path: PathBuf,
+    size: u64,
+}
+
+fn is_texture(path: &Path) -> bool {
+    match path.extension().and_then(|ext| ext.to_str()) {
+        Some(ext) => ["png", "zim", "dds", "ktx2"].contains(&ext.to_ascii_lowercase().as_str()),
+        None => false,
+    }
+}
+
+fn collect_files(root: &Path, dir: &Path, files: &mut Vec<PackFile>) -> io::Result<()> {
+    for entry in fs::read_dir(dir)? {
+        let entry = entry?;
+        let path = entry.path();
+        let name = path
+            .strip_prefix(root)
+            .unwrap()
+            .to_string_lossy()
+            .replace('\\', "/");
+        if entry.file_type()?.is_dir() {
+            // Newly dumped textures aren't part of the pack.
+            if name != "new" {
+                collect_files(root, &path, files)?;
+            }
+        } else if is_texture(&path) {
+            let size = entry.metadata()?.len();
+            files.push(PackFile { name, path, size });
+        }
+    }
+    Ok(())
+}
+
+fn align(offset: u64) -> u64 {
+    (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT
+}
+
+pub fn pack(dir: &Path, output: &Path) -> io::Result<()> {
+    let mut files = Vec::new();
+    collect_files(dir, dir, &mut files)?;
+    // Files in the same directory, and the mips of a texture, stay close together.
+    files.sort_by(|a, b| a.name.cmp(&b.name));
+
+    // (hash, offset, size), in file order for now.
+    let mut index = Vec::new();
+    let mut seen = HashMap::new();
+    let mut offset = align(HEADER_SIZE + ENTRY_SIZE * files.len() as u64);
+    for file in &files {
+        let hash = xxh3_64(file.name.as_bytes());
+        if let Some(other) = seen.insert(hash, file.name.clone()) {
+            return Err(io::Error::new(
+                io::ErrorKind::Other,
+                format!("Filename hash collision: {} and {}, rename one", other, file.name),
+            ));
+        }
+        index.push((hash, offset, file.size));
+        offset = align(offset + file.size);
+    }
+
+    let mut out = BufWriter::new(fs::File::create(output)?);
+    out.write_all(b"PPTP")?;
+    out.write_all(&VERSION.to_le_bytes())?;
+    out.write_all(&(files.len() as u32).to_le_bytes())?;
+    out.write_all(&0u32.to_le_bytes())?;
+
+    let mut sorted_index = index.clone();
+    sorted_index.sort_by_key(|entry| entry.0);
+    for (hash, offset, size) in &sorted_index {
+        out.write_all(&hash.to_le_bytes())?;
+        out.write_all(&offset.to_le_bytes())?;
+        out.write_all(&size.to_le_bytes())?;
+    }
+
+    let mut pos = HEADER_SIZE + ENTRY_SIZE * files.len() as u64;
+    for (file, (_, offset, size)) in files.iter().zip(&index) {
+        out.write_all(&vec![0u8; (offset - pos) as usize])?;
+        let data = fs::read(&file.path)?;
+        if data.len() as u64 != *size {
+            return Err(io::Error::new(io::ErrorKind::Other, format!("{} changed while packing", file.name)));
+        }
+        out.write_all(&data)?;
+        pos = offset + size;
+    }
+    out.flush()?;
+
+    println!("Packed {} files into {}", files.len(), output.display());
+    Ok(())
+}
@@ -26,15 +26,19 @@
 #include "Common/GPU/OpenGL/GLFeatures.h"
 #include "Common/File/AndroidStorage.h"
 #include "Common/Data/Text/I18n.h"
+#include "Common/Data/Text/Parsers.h"
 #include "Common/Net/HTTPClient.h"
 #include "Common/UI/Context.h"
 #include "Common/UI/View.h"
 #include "Common/UI/ViewGroup.h"
 #include "Common/UI/UI.h"
+#include "Common/Profiler/FrameTimeline.h"
+#include "Common/Profiler/MemoryUsage.h"
 #include "Common/Profiler/Profiler.h"
 
 #include "Common/LogManager.h"
 #include "Common/CPUDetect.h"
+#include "Common/File/FileUtil.h"
 #include "Common/StringUtils.h"
 
 #include "Core/MemMap.h"
@@ -43,13 +47,16 @@
 #include "Core/System.h"
 #include "Core/Reporting.h"
 #include "Core/CoreParameter.h"
+#include "Core/HLE/HLE.h"
 #include "Core/MIPS/MIPSTables.h"
+#include "Core/MIPS/IR/IRPassSimplify.h"
 #include "Core/MIPS/JitCommon/JitBlockCache.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/JitCommon/JitState.h"
 #include "GPU/GPUInterface.h"
 #include "GPU/GPUState.h"
 #include "UI/MiscScreens.h"
+#include "UI/OnScreenDisplay.h"
 #include "UI/DevScreens.h"
 #include "UI/MainScreen.h"
 #include "UI/ControlMappingScreen.h"
@@ -86,10 +93,15 @@ void DevMenu::CreatePopupContents(UI::ViewGroup *parent) {
 	items->Add(new Choice(dev->T("Logging Channels")))->OnClick.Handle(this, &DevMenu::OnLogConfig);
 	items->Add(new Choice(sy->T("Developer Tools")))->OnClick.Handle(this, &DevMenu::OnDeveloperTools);
 	items->Add(new Choice(dev->T("Jit Compare")))->OnClick.Handle(this, &DevMenu::OnJitCompare);
+	items->Add(new Choice(dev->T("JIT Block Profile")))->OnClick.Handle(this, &DevMenu::OnJitProfile);
+	items->Add(new Choice(dev->T("HLE Function Stats")))->OnClick.Handle(this, &DevMenu::OnHLEStats);
+	items->Add(new Choice(dev->T("Memory Usage")))->OnClick.Handle(this, &DevMenu::OnMemoryUsage);
 	items->Add(new Choice(dev->T("Shader Viewer")))->OnClick.Handle(this, &DevMenu::OnShaderView);
 	if (g_Config.iGPUBackend == (int)GPUBackend::VULKAN) {
 		// TODO: Make a new allocator visualizer for VMA.
 		// items->Add(new CheckBox(&g_Config.bShowAllocatorDebug, dev->T("Allocator Viewer")));
+	}
+	if (screenManager()->getDrawContext()->GetDeviceCaps().timestampQueriesSupported) {
 		items->Add(new CheckBox(&g_Config.bShowGpuProfile, dev->T("GPU Profile")));
 	}
 	items->Add(new Choice(dev->T("Toggle Freeze")))->OnClick.Handle(this, &DevMenu::OnFreezeFrame);
@@ -98,7 +110,12 @@ void DevMenu::CreatePopupContents(UI::ViewGroup *parent) {
 #ifdef USE_PROFILER
 	items->Add(new CheckBox(&g_Config.bShowFrameProfiler, dev->T("Frame Profiler"), ""));
 #endif
+	tracing_ = Profiler_IsTracing();
+	items->Add(new CheckBox(&tracing_, dev->T("Record Profiler Trace")))->OnClick.Handle(this, &DevMenu::OnToggleTrace);
+	items->Add(new Choice(dev->T("Save Profiler Trace")))->OnClick.Handle(this, &DevMenu::OnSaveTrace);
 	items->Add(new CheckBox(&g_Config.bDrawFrameGraph, dev->T("Draw Frametimes Graph")));
+	items->Add(new CheckBox(&g_Config.bShowFrameTimeline, dev->T("Frame Timeline")));
+	items->Add(new Choice(dev->T("Save Frame Timeline")))->OnClick.Handle(this, &DevMenu::OnSaveFrameTimeline);
 	items->Add(new Choice(dev->T("Reset limited logging")))->OnClick.Handle(this, &DevMenu::OnResetLimitedLogging);
 
 	scroll->Add(items);
@@ -144,6 +161,24 @@ UI::EventReturn DevMenu::OnJitCompare(UI::EventParams &e) {
 	return UI::EVENT_DONE;
 }
 
+UI::EventReturn DevMenu::OnJitProfile(UI::EventParams &e) {
+	UpdateUIState(UISTATE_PAUSEMENU);
+	screenManager()->push(new JitProfileScreen());
+	return UI::EVENT_DONE;
+}
+
+UI::EventReturn DevMenu::OnHLEStats(UI::EventParams &e) {
+	UpdateUIState(UISTATE_PAUSEMENU);
+	screenManager()->push(new HLEStatsScreen());
+	return UI::EVENT_DONE;
+}
+
+UI::EventReturn DevMenu::OnMemoryUsage(UI::EventParams &e) {
+	UpdateUIState(UISTATE_PAUSEMENU);
+	screenManager()->push(new MemoryUsageScreen());
+	return UI::EVENT_DONE;
+}
+
 UI::EventReturn DevMenu::OnShaderView(UI::EventParams &e) {
 	UpdateUIState(UISTATE_PAUSEMENU);
 	if (gpu)  // Avoid crashing if chosen while the game is being loaded.
@@ -165,6 +200,55 @@ UI::EventReturn DevMenu::OnDumpFrame(UI::EventParams &e) {
 	return UI::EVENT_DONE;
 }
 
+UI::EventReturn DevMenu::OnToggleTrace(UI::EventParams &e) {
+	if (tracing_)
+		Profiler_ClearTrace();
+	Profiler_SetTracing(tracing_);
+	return UI::EVENT_DONE;
+}
+
+UI::EventReturn DevMenu::OnSaveTrace(UI::EventParams &e) {
+	const Path dumpDir = GetSysDirectory(DIRECTORY_DUMP);
+	File::CreateFullPath(dumpDir);
+
+	Path filename;
+	for (int n = 1; n < 10000; ++n) {
+		filename = dumpDir / StringFromFormat("trace_%04d.json", n);
+		if (!File::Exists(filename))
+			break;
+	}
+
+	auto dev = GetI18NCategory("Developer");
+	if (File::WriteStringToFile(true, Profiler_ExportChromeTrace(), filename)) {
+		NOTICE_LOG(SYSTEM, "Saved profiler trace to %s", filename.c_str());
+		osm.Show(dev->T("Saved profiler trace"), 2.0f);
+	} else {
+		osm.Show(dev->T("Failed to save profiler trace"), 2.0f, 0xFF3030FF);
+	}
+	return UI::EVENT_DONE;
+}
+
+UI::EventReturn DevMenu::OnSaveFrameTimeline(UI::EventParams &e) {
+	const Path dumpDir = GetSysDirectory(DIRECTORY_DUMP);
+	File::CreateFullPath(dumpDir);
+
+	Path filename;
+	for (int n = 1; n < 10000; ++n) {
+		filename = dumpDir / StringFromFormat("timeline_%04d.json", n);
+		if (!File::Exists(filename))
+			break;
+	}
+
+	auto dev = GetI18NCategory("Developer");
+	if (File::WriteStringToFile(true, FrameTimeline_ExportChromeTrace(), filename)) {
+		NOTICE_LOG(SYSTEM, "Saved frame timeline to %s", filename.c_str());
+		osm.Show(dev->T("Saved frame timeline"), 2.0f);
+	} else {
+		osm.Show(dev->T("Failed to save frame timeline"), 2.0f, 0xFF3030FF);
+	}
+	return UI::EVENT_DONE;
+}
+
 void DevMenu::dialogFinished(const Screen *dialog, DialogResult result) {
 	UpdateUIState(UISTATE_INGAME);
 	// Close when a subscreen got closed.
@@ -411,6 +495,141 @@ UI::EventReturn JitDebugScreen::OnDisableAll(UI::EventParams &e) {
 	return UI::EVENT_DONE;
 }
 
+void JitProfileScreen::CreateViews() {
+	using namespace UI;
+
+	auto di = GetI18NCategory("Dialog");
+	auto dev = GetI18NCategory("Developer");
+
+	root_ = new ScrollView(ORIENT_VERTICAL);
+
+	LinearLayout *vert = root_->Add(new LinearLayout(ORIENT_VERTICAL, new LinearLayoutParams(FILL_PARENT, WRAP_CONTENT)));
+	vert->SetSpacing(0);
+
+	LinearLayout *topbar = new LinearLayout(ORIENT_HORIZONTAL);
+	topbar->Add(new Choice(di->T("Back")))->OnClick.Handle<UIScreen>(this, &UIScreen::OnBack);
+	topbar->Add(new Choice(dev->T("Refresh")))->OnClick.Handle(this, &JitProfileScreen::OnRefresh);
+	vert->Add(topbar);
+
+	enabled_ = MIPSComp::jitBlockProfiling;
+	vert->Add(new CheckBox(&enabled_, dev->T("Count JIT block executions")))->OnClick.Handle(this, &JitProfileScreen::OnToggleEnabled);
+	vert->Add(new ItemHeader(dev->T("Hottest JIT blocks")));
+
+	std::vector<MIPSComp::JitBlockProfileEntry> entries = MIPSComp::GetJitBlockProfile(30);
+	for (const auto &entry : entries) {
+		// Do not add translation of these.
+		vert->Add(new TextView(StringFromFormat("%08x: %llu runs, %d instructions, %d bytes", entry.address, (unsigned long long)entry.count, (int)entry.disasm.size(), entry.codeSize), new LayoutParams(FILL_PARENT, WRAP_CONTENT)));
+		std::string disasm;
+		for (const std::string &line : entry.disasm)
+			disasm += line + "\n";
+		vert->Add(new TextView(disasm, FLAG_DYNAMIC_ASCII, true, new LayoutParams(FILL_PARENT, WRAP_CONTENT)))->SetFocusable(true);
+	}
+
+	std::vector<std::pair<std::string, u64>> fallbacks = MIPSComp::GetVFPUFallbackProfile();
+	if (!fallbacks.empty()) {
+		vert->Add(new ItemHeader(dev->T("VFPU interpreter fallbacks")));
+		for (const auto &fallback : fallbacks) {
+			vert->Add(new TextView(StringFromFormat("%s: %llu runs", fallback.first.c_str(), (unsigned long long)fallback.second), new LayoutParams(FILL_PARENT, WRAP_CONTENT)));
+		}
+	}
+}
+
+UI::EventReturn JitProfileScreen::OnToggleEnabled(UI::EventParams &e) {
+	MIPSComp::SetJitBlockProfiling(enabled_);
+	RecreateViews();
+	return UI::EVENT_DONE;
+}
+
+UI::EventReturn JitProfileScreen::OnRefresh(UI::EventParams &e) {
+	RecreateViews();
+	return UI::EVENT_DONE;
+}
+
+void HLEStatsScreen::CreateViews() {
+	using namespace UI;
+
+	auto di = GetI18NCategory("Dialog");
+	auto dev = GetI18NCategory("Developer");
+
+	root_ = new ScrollView(ORIENT_VERTICAL);
+
+	LinearLayout *vert = root_->Add(new LinearLayout(ORIENT_VERTICAL, new LinearLayoutParams(FILL_PARENT, WRAP_CONTENT)));
+	vert->SetSpacing(0);
+
+	LinearLayout *topbar = new LinearLayout(ORIENT_HORIZONTAL);
+	topbar->Add(new Choice(di->T("Back")))->OnClick.Handle<UIScreen>(this, &UIScreen::OnBack);
+	topbar->Add(new Choice(dev->T("Refresh")))->OnClick.Handle(this, &HLEStatsScreen::OnRefresh);
+	topbar->Add(new Choice(dev->T("Reset")))->OnClick.Handle(this, &HLEStatsScreen::OnReset);
+	vert->Add(topbar);
+
+	enabled_ = hleFunctionStatsEnabled();
+	vert->Add(new CheckBox(&enabled_, dev->T("Collect HLE function stats")))->OnClick.Handle(this, &HLEStatsScreen::OnToggleEnabled);
+	vert->Add(new ItemHeader(dev->T("Slowest HLE functions")));
+
+	// Plenty to find the heavy ones, without making a huge list.
+	std::vector<HLEFunctionStats> stats = hleGetFunctionStats();
+	if (stats.size() > 100)
+		stats.resize(100);
+	for (const HLEFunctionStats &s : stats) {
+		// Do not add translation of these.
+		std::string text = StringFromFormat("%s::%s: %llu calls, %0.1f us total, %0.1f us max, %lld cycles",
+			s.moduleName, s.func->name, (unsigned long long)s.calls, s.totalTime * 1000000.0, s.maxTime * 1000000.0, (long long)s.cycles);
+		vert->Add(new TextView(text, FLAG_DYNAMIC_ASCII, true, new LayoutParams(FILL_PARENT, WRAP_CONTENT)))->SetFocusable(true);
+	}
+}
+
+UI::EventReturn HLEStatsScreen::OnToggleEnabled(UI::EventParams &e) {
+	hleSetFunctionStatsEnabled(enabled_);
+	return UI::EVENT_DONE;
+}
+
+UI::EventReturn HLEStatsScreen::OnRefresh(UI::EventParams &e) {
+	RecreateViews();
+	return UI::EVENT_DONE;
+}
+
+UI::EventReturn HLEStatsScreen::OnReset(UI::EventParams &e) {
+	hleResetFunctionStats();
+	RecreateViews();
+	return UI::EVENT_DONE;
+}
+
+void MemoryUsageScreen::CreateViews() {
+	using namespace UI;
+
+	auto di = GetI18NCategory("Dialog");
+	auto dev = GetI18NCategory("Developer");
+
+	root_ = new ScrollView(ORIENT_VERTICAL);
+
+	LinearLayout *vert = root_->Add(new LinearLayout(ORIENT_VERTICAL, new LinearLayoutParams(FILL_PARENT, WRAP_CONTENT)));
+	vert->SetSpacing(0);
+
+	LinearLayout *topbar = new LinearLayout(ORIENT_HORIZONTAL);
+	topbar->Add(new Choice(di->T("Back")))->OnClick.Handle<UIScreen>(this, &UIScreen::OnBack);
+	topbar->Add(new Choice(dev->T("Refresh")))->OnClick.Handle(this, &MemoryUsageScreen::OnRefresh);
+	topbar->Add(new Choice(dev->T("Reset peaks")))->OnClick.Handle(this, &MemoryUsageScreen::OnResetPeaks);
+	vert->Add(topbar);
+
+	vert->Add(new ItemHeader(dev->T("Memory Usage")));
+	for (const MemoryUsageStat &stat : MemoryUsage_GetStats()) {
+		// Do not add translation of these.
+		std::string text = StringFromFormat("%s: %s (peak %s)", stat.name, NiceSizeFormat(std::max(stat.current, (int64_t)0)).c_str(), NiceSizeFormat(std::max(stat.peak, (int64_t)0)).c_str());
+		vert->Add(new TextView(text, FLAG_DYNAMIC_ASCII, true, new LayoutParams(FILL_PARENT, WRAP_CONTENT)))->SetFocusable(true);
+	}
+}
+
+UI::EventReturn MemoryUsageScreen::OnRefresh(UI::EventParams &e) {
+	RecreateViews();
+	return UI::EVENT_DONE;
+}
+
+UI::EventReturn MemoryUsageScreen::OnResetPeaks(UI::EventParams &e) {
+	MemoryUsage_ResetPeaks();
+	RecreateViews();
+	return UI::EVENT_DONE;
+}
+
 const char *GetCompilerABI() {
 #if PPSSPP_ARCH(ARMV7)
 	return "armeabi-v7a";
@@ -952,6 +1171,11 @@ UI::EventReturn JitCompareScreen::OnShowStats(UI::EventParams &e) {
 		}
 		ctr++;
 	}
+
+	for (const IRPassStats &stat : IRGetPassStats()) {
+		double removed = stat.instructionsIn == 0 ? 0.0 : 1.0 - (double)stat.instructionsOut / (double)stat.instructionsIn;
+		NOTICE_LOG(JIT, "IR pass %s: %llu -> %llu instructions in %llu runs (%0.2f%% removed)", stat.name, (unsigned long long)stat.instructionsIn, (unsigned long long)stat.instructionsOut, (unsigned long long)stat.runs, 100 * removed);
+	}
 	return UI::EVENT_DONE;
 }
 
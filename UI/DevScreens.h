@@ -41,12 +41,20 @@ class DevMenu : public PopupScreen {
 	UI::EventReturn OnLogView(UI::EventParams &e);
 	UI::EventReturn OnLogConfig(UI::EventParams &e);
 	UI::EventReturn OnJitCompare(UI::EventParams &e);
+	UI::EventReturn OnHLEStats(UI::EventParams &e);
+	UI::EventReturn OnJitProfile(UI::EventParams &e);
+	UI::EventReturn OnMemoryUsage(UI::EventParams &e);
 	UI::EventReturn OnShaderView(UI::EventParams &e);
 	UI::EventReturn OnFreezeFrame(UI::EventParams &e);
 	UI::EventReturn OnDumpFrame(UI::EventParams &e);
 	UI::EventReturn OnDeveloperTools(UI::EventParams &e);
 	UI::EventReturn OnToggleAudioDebug(UI::EventParams &e);
 	UI::EventReturn OnResetLimitedLogging(UI::EventParams &e);
+	UI::EventReturn OnToggleTrace(UI::EventParams &e);
+	UI::EventReturn OnSaveTrace(UI::EventParams &e);
+	UI::EventReturn OnSaveFrameTimeline(UI::EventParams &e);
+
+	bool tracing_ = false;
 };
 
 class JitDebugScreen : public UIDialogScreenWithBackground {
@@ -59,6 +67,41 @@ class JitDebugScreen : public UIDialogScreenWithBackground {
 	UI::EventReturn OnDisableAll(UI::EventParams &e);
 };
 
+class JitProfileScreen : public UIDialogScreenWithBackground {
+public:
+	JitProfileScreen() {}
+	void CreateViews() override;
+
+private:
+	UI::EventReturn OnToggleEnabled(UI::EventParams &e);
+	UI::EventReturn OnRefresh(UI::EventParams &e);
+
+	bool enabled_ = false;
+};
+
+class HLEStatsScreen : public UIDialogScreenWithBackground {
+public:
+	HLEStatsScreen() {}
+	void CreateViews() override;
+
+private:
+	UI::EventReturn OnToggleEnabled(UI::EventParams &e);
+	UI::EventReturn OnRefresh(UI::EventParams &e);
+	UI::EventReturn OnReset(UI::EventParams &e);
+
+	bool enabled_ = false;
+};
+
+class MemoryUsageScreen : public UIDialogScreenWithBackground {
+public:
+	MemoryUsageScreen() {}
+	void CreateViews() override;
+
+private:
+	UI::EventReturn OnRefresh(UI::EventParams &e);
+	UI::EventReturn OnResetPeaks(UI::EventParams &e);
+};
+
 class LogConfigScreen : public UIDialogScreenWithBackground {
 public:
 	LogConfigScreen() {}
@@ -38,6 +38,7 @@ using namespace std::placeholders;
 #include "Common/System/Display.h"
 #include "Common/System/System.h"
 #include "Common/System/NativeApp.h"
+#include "Common/Profiler/FrameTimeline.h"
 #include "Common/Profiler/Profiler.h"
 #include "Common/Math/curves.h"
 #include "Common/TimeUtil.h"
@@ -1255,6 +1256,18 @@ static void DrawFPS(UIContext *ctx, const Bounds &bounds) {
 		return;
 	}
 
+	double latencyMs = ctx->GetDrawContext()->GetPresentLatencyMs();
+	if (latencyMs > 0.0) {
+		size_t len = strlen(fpsbuf);
+		snprintf(fpsbuf + len, sizeof(fpsbuf) - len, " (%0.1f ms)", latencyMs);
+	}
+
+	int renderScaleDrop, governorFrameSkip;
+	if (__DisplayGetGovernorState(&renderScaleDrop, &governorFrameSkip) && (renderScaleDrop != 0 || governorFrameSkip != 0)) {
+		size_t len = strlen(fpsbuf);
+		snprintf(fpsbuf + len, sizeof(fpsbuf) - len, " [%dx, skip %d]", PSP_CoreParameter().renderScaleFactor, governorFrameSkip);
+	}
+
 	ctx->Flush();
 	ctx->BindFontTexture();
 	ctx->Draw()->SetFontScale(0.7f, 0.7f);
@@ -1300,6 +1313,9 @@ static void DrawFrameTimes(UIContext *ctx, const Bounds &bounds) {
 void EmuScreen::preRender() {
 	using namespace Draw;
 	DrawContext *draw = screenManager()->getDrawContext();
+	draw->SetGPUTimingEnabled(g_Config.bShowGpuProfile);
+	draw->SetLowLatencyPresent(g_Config.bLowLatencyPresent);
+	FrameTimeline_SetEnabled(g_Config.bShowFrameTimeline);
 	draw->BeginFrame();
 	// Here we do NOT bind the backbuffer or clear the screen, unless non-buffered.
 	// The emuscreen is different than the others - we really want to allow the game to render to framebuffers
@@ -1375,7 +1391,11 @@ void EmuScreen::render() {
 
 	PSP_BeginHostFrame();
 
-	PSP_RunLoopWhileState();
+	// Not while frozen, that's already loading a state every frame.
+	if (g_Config.iRunAheadFrames > 0 && !PSP_CoreParameter().frozen && coreState == CORE_RUNNING)
+		PSP_RunLoopWhileStateRunAhead(g_Config.iRunAheadFrames);
+	else
+		PSP_RunLoopWhileState();
 
 	// Hopefully coreState is now CORE_NEXTFRAME
 	switch (coreState) {
@@ -1469,7 +1489,7 @@ void EmuScreen::renderUI() {
 	thin3d->SetViewports(1, &viewport);
 
 	if (root_) {
-		UI::LayoutViewHierarchy(*ctx, root_, false);
+		LayoutViews();
 		root_->Draw(*ctx);
 	}
 
@@ -1494,11 +1514,15 @@ void EmuScreen::renderUI() {
 		DrawAllocatorVis(ctx, gpu);
 	}
 
-	if (g_Config.iGPUBackend == (int)GPUBackend::VULKAN && g_Config.bShowGpuProfile) {
-		DrawGPUProfilerVis(ctx, gpu);
+#endif
+
+	if (g_Config.bShowGpuProfile && !invalid_) {
+		DrawGPUProfile(*ctx, thin3d);
 	}
 
-#endif
+	if (g_Config.bShowFrameTimeline && !invalid_) {
+		DrawFrameTimeline(*ctx);
+	}
 
 #ifdef USE_PROFILER
 	if (g_Config.bShowFrameProfiler && !invalid_) {
@@ -21,12 +21,15 @@
 #include <map>
 #include <memory>
 #include <algorithm>
+#include <deque>
+#include <unordered_map>
 
 #include "Common/GPU/thin3d.h"
 #include "Common/Thread/ThreadManager.h"
 #include "Common/File/VFS/VFS.h"
 #include "Common/File/FileUtil.h"
 #include "Common/File/Path.h"
+#include "Common/Profiler/MemoryUsage.h"
 #include "Common/StringUtils.h"
 #include "Common/TimeUtil.h"
 #include "Core/FileSystems/ISOFileSystem.h"
@@ -40,9 +43,228 @@
 #include "Core/Config.h"
 #include "UI/GameInfoCache.h"
 #include "UI/TextureUtil.h"
+#include "ext/xxhash.h"
 
 GameInfoCache *g_gameInfoCache;
 
+// Remembers the PARAM.SFO and icon of ISOs and PBPs across launches, so a big library doesn't
+// have to open every file again. Entries are only used while the file's size and mtime still match.
+class GameInfoDiskCache {
+public:
+	bool Lookup(const Path &gamePath, GameInfo *info);
+	// Call with the icon data read, before setting icon.dataLoaded (after that it can get cleared.)
+	void Store(const Path &gamePath, GameInfo *info);
+	void Remove(const Path &gamePath);
+	void Save();
+
+private:
+	struct Entry {
+		uint64_t size;
+		uint64_t mtime;
+		IdentifiedFileType fileType;
+		std::string sfo;
+	};
+
+	static bool IsCacheable(const Path &gamePath, File::FileInfo *fileInfo);
+	static Path Directory();
+	static Path IconPath(const std::string &pathStr);
+	void Load();
+
+	std::mutex lock_;
+	std::unordered_map<std::string, Entry> entries_;
+	bool loaded_ = false;
+	bool dirty_ = false;
+};
+
+static GameInfoDiskCache g_gameInfoDiskCache;
+
+static const uint32_t GAMEINFO_CACHE_MAGIC = 0x43494750;  // PGIC
+static const uint32_t GAMEINFO_CACHE_VERSION = 1;
+
+bool GameInfoDiskCache::IsCacheable(const Path &gamePath, File::FileInfo *fileInfo) {
+	if (gamePath.Type() != PathType::NATIVE && gamePath.Type() != PathType::CONTENT_URI)
+		return false;
+	return File::GetFileInfo(gamePath, fileInfo) && fileInfo->exists && !fileInfo->isDirectory;
+}
+
+Path GameInfoDiskCache::Directory() {
+	return GetSysDirectory(DIRECTORY_APP_CACHE) / "gameinfo";
+}
+
+Path GameInfoDiskCache::IconPath(const std::string &pathStr) {
+	char filename[32];
+	snprintf(filename, sizeof(filename), "%016llx.png", (unsigned long long)XXH3_64bits(pathStr.data(), pathStr.size()));
+	return Directory() / filename;
+}
+
+bool GameInfoDiskCache::Lookup(const Path &gamePath, GameInfo *info) {
+	File::FileInfo fileInfo;
+	if (!IsCacheable(gamePath, &fileInfo))
+		return false;
+
+	std::string pathStr = gamePath.ToString();
+	std::string sfo;
+	IdentifiedFileType fileType;
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		if (!loaded_)
+			Load();
+		auto iter = entries_.find(pathStr);
+		if (iter == entries_.end() || iter->second.size != fileInfo.size || iter->second.mtime != fileInfo.mtime)
+			return false;
+		sfo = iter->second.sfo;
+		fileType = iter->second.fileType;
+	}
+
+	std::string iconData;
+	if (!File::ReadFileToString(false, IconPath(pathStr), iconData) || iconData.empty())
+		return false;
+
+	std::lock_guard<std::mutex> guard(info->lock);
+	if (!info->paramSFO.ReadSFO((const u8 *)sfo.data(), sfo.size()))
+		return false;
+	info->ParseParamSFO();
+	info->fileType = fileType;
+	info->icon.data = std::move(iconData);
+	info->icon.dataLoaded = true;
+	return true;
+}
+
+void GameInfoDiskCache::Store(const Path &gamePath, GameInfo *info) {
+	File::FileInfo fileInfo;
+	if (!IsCacheable(gamePath, &fileInfo))
+		return;
+
+	Entry entry;
+	entry.size = fileInfo.size;
+	entry.mtime = fileInfo.mtime;
+	std::string iconData;
+	{
+		std::lock_guard<std::mutex> guard(info->lock);
+		if (!info->paramSFOLoaded || info->icon.data.empty())
+			return;
+		u8 *sfoData = nullptr;
+		size_t sfoSize = 0;
+		if (!info->paramSFO.WriteSFO(&sfoData, &sfoSize))
+			return;
+		entry.sfo.assign((const char *)sfoData, sfoSize);
+		delete[] sfoData;
+		entry.fileType = info->fileType;
+		iconData = info->icon.data;
+	}
+
+	std::string pathStr = gamePath.ToString();
+	File::CreateFullPath(Directory());
+	if (!File::WriteDataToFile(false, iconData.data(), (unsigned int)iconData.size(), IconPath(pathStr)))
+		return;
+
+	std::lock_guard<std::mutex> guard(lock_);
+	if (!loaded_)
+		Load();
+	entries_[pathStr] = std::move(entry);
+	dirty_ = true;
+}
+
+void GameInfoDiskCache::Remove(const Path &gamePath) {
+	std::string pathStr = gamePath.ToString();
+	std::lock_guard<std::mutex> guard(lock_);
+	if (!loaded_)
+		Load();
+	if (entries_.erase(pathStr)) {
+		File::Delete(IconPath(pathStr));
+		dirty_ = true;
+	}
+}
+
+void GameInfoDiskCache::Load() {
+	loaded_ = true;
+	std::string data;
+	if (!File::ReadFileToString(false, Directory() / "index.dat", data))
+		return;
+
+	size_t pos = 0;
+	auto readU32 = [&](uint32_t *v) {
+		if (pos + sizeof(*v) > data.size())
+			return false;
+		memcpy(v, data.data() + pos, sizeof(*v));
+		pos += sizeof(*v);
+		return true;
+	};
+	auto readU64 = [&](uint64_t *v) {
+		if (pos + sizeof(*v) > data.size())
+			return false;
+		memcpy(v, data.data() + pos, sizeof(*v));
+		pos += sizeof(*v);
+		return true;
+	};
+	auto readString = [&](std::string *s) {
+		uint32_t len;
+		if (!readU32(&len) || len > data.size() - pos)
+			return false;
+		s->assign(data.data() + pos, len);
+		pos += len;
+		return true;
+	};
+
+	uint32_t magic, version, count;
+	if (!readU32(&magic) || !readU32(&version) || !readU32(&count))
+		return;
+	if (magic != GAMEINFO_CACHE_MAGIC || version != GAMEINFO_CACHE_VERSION) {
+		INFO_LOG(LOADER, "Ignoring game info cache with a different version");
+		return;
+	}
+	for (uint32_t i = 0; i < count; ++i) {
+		std::string pathStr;
+		Entry entry;
+		uint32_t fileType;
+		if (!readString(&pathStr) || !readU64(&entry.size) || !readU64(&entry.mtime) || !readU32(&fileType) || !readString(&entry.sfo)) {
+			WARN_LOG(LOADER, "Game info cache is truncated, read %d of %d entries", i, count);
+			break;
+		}
+		entry.fileType = (IdentifiedFileType)fileType;
+		entries_[pathStr] = std::move(entry);
+	}
+}
+
+void GameInfoDiskCache::Save() {
+	std::lock_guard<std::mutex> guard(lock_);
+	if (!dirty_)
+		return;
+
+	std::string data;
+	auto writeU32 = [&](uint32_t v) {
+		data.append((const char *)&v, sizeof(v));
+	};
+	auto writeU64 = [&](uint64_t v) {
+		data.append((const char *)&v, sizeof(v));
+	};
+	auto writeString = [&](const std::string &s) {
+		writeU32((uint32_t)s.size());
+		data.append(s);
+	};
+
+	writeU32(GAMEINFO_CACHE_MAGIC);
+	writeU32(GAMEINFO_CACHE_VERSION);
+	writeU32((uint32_t)entries_.size());
+	for (const auto &iter : entries_) {
+		writeString(iter.first);
+		writeU64(iter.second.size);
+		writeU64(iter.second.mtime);
+		writeU32((uint32_t)iter.second.fileType);
+		writeString(iter.second.sfo);
+	}
+
+	// Write to a temp file first, so a crash halfway doesn't lose the whole index.
+	Path dir = Directory();
+	File::CreateFullPath(dir);
+	Path tempPath = dir / "index.dat.tmp";
+	if (File::WriteDataToFile(false, data.data(), (unsigned int)data.size(), tempPath)) {
+		File::Delete(dir / "index.dat");
+		if (File::Rename(tempPath, dir / "index.dat"))
+			dirty_ = false;
+	}
+}
+
 GameInfo::GameInfo() : fileType(IdentifiedFileType::UNKNOWN) {
 	pending = true;
 }
@@ -64,6 +286,7 @@ bool GameInfo::Delete() {
 			// Just delete the one file (TODO: handle two-disk games as well somehow).
 			Path fileToRemove = filePath_;
 			File::Delete(fileToRemove);
+			g_gameInfoDiskCache.Remove(filePath_);
 			g_Config.RemoveRecent(filePath_.ToString());
 			return true;
 		}
@@ -208,6 +431,14 @@ bool GameInfo::LoadFromPath(const Path &gamePath) {
 	return true;
 }
 
+void GameInfo::SetPath(const Path &gamePath) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (filePath_ != gamePath) {
+		fileLoader.reset();
+		filePath_ = gamePath;
+	}
+}
+
 std::shared_ptr<FileLoader> GameInfo::GetFileLoader() {
 	if (filePath_.empty()) {
 		// Happens when workqueue tries to figure out priorities,
@@ -326,6 +557,14 @@ static bool ReadVFSToString(const char *filename, std::string *contents, std::mu
 	return data != nullptr;
 }
 
+class GameInfoWorkItem;
+
+// Full scans open the file and read the ISO directory, which is slow on network storage. Only this many
+// run at once so they don't tie up all the I/O threads, the rest wait in line. Disk cache hits don't count.
+static const int MAX_CONCURRENT_SCANS = 4;
+static std::mutex scanLock;
+static int runningScans = 0;
+static std::deque<GameInfoWorkItem *> waitingScans;
 
 class GameInfoWorkItem : public Task {
 public:
@@ -334,19 +573,40 @@ class GameInfoWorkItem : public Task {
 	}
 
 	~GameInfoWorkItem() override {
+		// Deferred items live on as a copy in waitingScans.
+		if (deferred_)
+			return;
 		info_->pending.store(false);
 		info_->working.store(false);
 		info_->DisposeFileLoader();
 		info_->readyEvent.Notify();
+		if (hasScanSlot_)
+			ReleaseScanSlot();
 	}
 
 	TaskType Type() const override {
 		return TaskType::IO_BLOCKING;
 	}
 
+	TaskPriority Priority() const override {
+		return TaskPriority::BACKGROUND;
+	}
+
 	void Run() override {
 		// An early-return will result in the destructor running, where we can set
 		// flags like working and pending.
+		if (!hasScanSlot_) {
+			// The disk cache only has the icon, not the big stuff.
+			if ((info_->wantFlags & (GAMEINFO_WANTBG | GAMEINFO_WANTSND)) == 0 && g_gameInfoDiskCache.Lookup(gamePath_, info_.get())) {
+				info_->SetPath(gamePath_);
+				FinishInfo();
+				return;
+			}
+			if (!AcquireScanSlot()) {
+				return;
+			}
+		}
+
 		if (!info_->LoadFromPath(gamePath_)) {
 			return;
 		}
@@ -414,6 +674,9 @@ class GameInfoWorkItem : public Task {
 						// Read standard icon
 						ReadVFSToString("unknown.png", &info_->icon.data, &info_->lock);
 				}
+				if (info_->fileType == IdentifiedFileType::PSP_PBP) {
+					g_gameInfoDiskCache.Store(gamePath_, info_.get());
+				}
 				info_->icon.dataLoaded = true;
 
 				if (info_->wantFlags & GAMEINFO_WANTBG) {
@@ -586,6 +849,7 @@ class GameInfoWorkItem : public Task {
 						ReadVFSToString("unknown.png", &info_->icon.data, &info_->lock);
 					}
 				}
+				g_gameInfoDiskCache.Store(gamePath_, info_.get());
 				info_->icon.dataLoaded = true;
 				break;
 			}
@@ -620,6 +884,24 @@ class GameInfoWorkItem : public Task {
 				break;
 		}
 
+		FinishInfo();
+		// INFO_LOG(SYSTEM, "Completed writing info for %s", info_->GetTitle().c_str());
+	}
+
+	static void CancelWaiting() {
+		std::deque<GameInfoWorkItem *> waiting;
+		{
+			std::lock_guard<std::mutex> guard(scanLock);
+			waiting.swap(waitingScans);
+		}
+		// Deleting them marks the infos as done, like a failed scan.
+		for (GameInfoWorkItem *item : waiting) {
+			delete item;
+		}
+	}
+
+private:
+	void FinishInfo() {
 		info_->hasConfig = g_Config.hasGameConfig(info_->id);
 
 		if (info_->wantFlags & GAMEINFO_WANTSIZE) {
@@ -628,13 +910,48 @@ class GameInfoWorkItem : public Task {
 			info_->saveDataSize = info_->GetSaveDataSizeInBytes();
 			info_->installDataSize = info_->GetInstallDataSizeInBytes();
 		}
+	}
 
-		// INFO_LOG(SYSTEM, "Completed writing info for %s", info_->GetTitle().c_str());
+	// If all slots are taken, queues a copy of this item to run when one frees up, and returns false.
+	bool AcquireScanSlot() {
+		std::lock_guard<std::mutex> guard(scanLock);
+		if (runningScans >= MAX_CONCURRENT_SCANS) {
+			waitingScans.push_back(new GameInfoWorkItem(gamePath_, info_));
+			deferred_ = true;
+			return false;
+		}
+		runningScans++;
+		hasScanSlot_ = true;
+		return true;
+	}
+
+	// Hands the slot straight to the next waiting scan, if any.
+	static void ReleaseScanSlot() {
+		GameInfoWorkItem *next = nullptr;
+		bool idle = false;
+		{
+			std::lock_guard<std::mutex> guard(scanLock);
+			if (!waitingScans.empty()) {
+				next = waitingScans.front();
+				waitingScans.pop_front();
+				next->hasScanSlot_ = true;
+			} else {
+				runningScans--;
+				idle = runningScans == 0;
+			}
+		}
+		if (next) {
+			g_threadManager.EnqueueTask(next);
+		} else if (idle) {
+			// Done scanning for now, good time to write down what we found.
+			g_gameInfoDiskCache.Save();
+		}
 	}
 
-private:
 	Path gamePath_;
 	std::shared_ptr<GameInfo> info_;
+	bool hasScanSlot_ = false;
+	bool deferred_ = false;
 	DISALLOW_COPY_AND_ASSIGN(GameInfoWorkItem);
 };
 
@@ -651,12 +968,15 @@ void GameInfoCache::Init() {}
 
 void GameInfoCache::Shutdown() {
 	CancelAll();
+	GameInfoWorkItem::CancelWaiting();
+	g_gameInfoDiskCache.Save();
 }
 
 void GameInfoCache::Clear() {
 	CancelAll();
 
 	info_.clear();
+	ReportMemoryUsage();
 }
 
 void GameInfoCache::CancelAll() {
@@ -679,6 +999,7 @@ void GameInfoCache::FlushBGs() {
 		}
 		iter->second->wantFlags &= ~(GAMEINFO_WANTBG | GAMEINFO_WANTSND | GAMEINFO_WANTBGDATA);
 	}
+	ReportMemoryUsage();
 }
 
 void GameInfoCache::PurgeType(IdentifiedFileType fileType) {
@@ -691,6 +1012,22 @@ void GameInfoCache::PurgeType(IdentifiedFileType fileType) {
 			iter++;
 		}
 	}
+	ReportMemoryUsage();
+}
+
+// Data loaded in the background only shows up here on the next call, but textures are set up soon after.
+void GameInfoCache::ReportMemoryUsage() {
+	int64_t total = 0;
+	auto texBytes = [](const GameInfoTex &tex) {
+		return (int64_t)tex.data.size() + (tex.texture ? (int64_t)tex.texture->MemoryBytes() : 0);
+	};
+	for (auto &iter : info_) {
+		GameInfo *info = iter.second.get();
+		std::lock_guard<std::mutex> lock(info->lock);
+		total += texBytes(info->icon) + texBytes(info->pic0) + texBytes(info->pic1);
+		total += info->sndFileData.size();
+	}
+	MemoryUsage_Set(MemoryCategory::GAME_INFO, total);
 }
 
 void GameInfoCache::WaitUntilDone(std::shared_ptr<GameInfo> &info) {
@@ -765,5 +1102,6 @@ void GameInfoCache::SetupTexture(std::shared_ptr<GameInfo> &info, Draw::DrawCont
 			tex.data.clear();
 			tex.dataLoaded = false;
 		}
+		ReportMemoryUsage();
 	}
 }
@@ -86,6 +86,8 @@ class GameInfo {
 	bool Delete();  // Better be sure what you're doing when calling this.
 	bool DeleteAllSaveData();
 	bool LoadFromPath(const Path &gamePath);
+	// Like LoadFromPath, but doesn't open the file or set a title. For info that came from the disk cache.
+	void SetPath(const Path &gamePath);
 
 	std::shared_ptr<FileLoader> GetFileLoader();
 	void DisposeFileLoader();
@@ -181,6 +183,7 @@ class GameInfoCache {
 	void Init();
 	void Shutdown();
 	void SetupTexture(std::shared_ptr<GameInfo> &info, Draw::DrawContext *draw, GameInfoTex &tex);
+	void ReportMemoryUsage();
 
 	// Maps ISO path to info. Need to use shared_ptr as we can return these pointers - 
 	// and if they get destructed while being in use, that's bad.
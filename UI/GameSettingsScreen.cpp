@@ -53,6 +53,7 @@
 #include "UI/MemStickScreen.h"
 
 #include "Common/File/FileUtil.h"
+#include "Common/MemoryUtil.h"
 #include "Common/OSVersion.h"
 #include "Common/TimeUtil.h"
 #include "Common/StringUtils.h"
@@ -310,6 +311,13 @@ void GameSettingsScreen::CreateViews() {
 		return UI::EVENT_CONTINUE;
 	});
 	blockTransfer->SetDisabledPtr(&g_Config.bSoftwareRendering);
+	CheckBox *asyncReadbacks = graphicsSettings->Add(new CheckBox(&g_Config.bAsyncReadbacks, gr->T("Async framebuffer readback (speedup)")));
+	asyncReadbacks->OnClick.Add([=](EventParams &e) {
+		if (g_Config.bAsyncReadbacks)
+			settingInfo_->Show(gr->T("AsyncReadbacks Tip", "Game sees framebuffer copies a few frames late, can cause flicker"), e.v);
+		return UI::EVENT_CONTINUE;
+	});
+	asyncReadbacks->SetDisabledPtr(&g_Config.bSoftwareRendering);
 
 	bool showSoftGPU = true;
 #ifdef MOBILE_DEVICE
@@ -335,6 +343,10 @@ void GameSettingsScreen::CreateViews() {
 	graphicsSettings->Add(new PopupMultiChoice(&g_Config.iFrameSkipType, gr->T("Frame Skipping Type"), frameSkipType, 0, ARRAY_SIZE(frameSkipType), gr->GetName(), screenManager()));
 	frameSkipAuto_ = graphicsSettings->Add(new CheckBox(&g_Config.bAutoFrameSkip, gr->T("Auto FrameSkip")));
 	frameSkipAuto_->OnClick.Handle(this, &GameSettingsScreen::OnAutoFrameskip);
+	CheckBox *governor = graphicsSettings->Add(new CheckBox(&g_Config.bPerformanceGovernor, gr->T("Performance governor", "Lower resolution and frameskip automatically when slow")));
+	governor->SetEnabledFunc([] {
+		return g_Config.iRenderingMode != FB_NON_BUFFERED_MODE;
+	});
 
 	PopupSliderChoice *altSpeed1 = graphicsSettings->Add(new PopupSliderChoice(&iAlternateSpeedPercent1_, 0, 1000, gr->T("Alternative Speed", "Alternative speed"), 5, screenManager(), gr->T("%, 0:unlimited")));
 	altSpeed1->SetFormat("%i%%");
@@ -467,6 +479,14 @@ void GameSettingsScreen::CreateViews() {
 		inflightChoice->OnChoice.Handle(this, &GameSettingsScreen::OnInflightFramesChoice);
 	}
 
+	if (GetGPUBackend() == GPUBackend::VULKAN || GetGPUBackend() == GPUBackend::DIRECT3D11) {
+		CheckBox *lowLatency = graphicsSettings->Add(new CheckBox(&g_Config.bLowLatencyPresent, gr->T("Low latency presentation")));
+		lowLatency->OnClick.Add([=](EventParams &e) {
+			settingInfo_->Show(gr->T("LowLatencyPresent Tip", "Reduces input lag by waiting for each frame to be displayed. Direct3D 11 needs a restart."), e.v);
+			return UI::EVENT_CONTINUE;
+		});
+	}
+
 	CheckBox *hwTransform = graphicsSettings->Add(new CheckBox(&g_Config.bHardwareTransform, gr->T("Hardware Transform")));
 	hwTransform->OnClick.Handle(this, &GameSettingsScreen::OnHardwareTransform);
 	hwTransform->SetDisabledPtr(&g_Config.bSoftwareRendering);
@@ -478,6 +498,13 @@ void GameSettingsScreen::CreateViews() {
 	});
 	swSkin->SetDisabledPtr(&g_Config.bSoftwareRendering);
 
+	CheckBox *batchColors = graphicsSettings->Add(new CheckBox(&g_Config.bBatchMaterialColors, gr->T("Batch draws across color changes")));
+	batchColors->OnClick.Add([=](EventParams &e) {
+		settingInfo_->Show(gr->T("BatchMaterialColors Tip", "Fewer draw calls in menus and 2D games"), e.v);
+		return UI::EVENT_CONTINUE;
+	});
+	batchColors->SetDisabledPtr(&g_Config.bSoftwareRendering);
+
 	CheckBox *vtxCache = graphicsSettings->Add(new CheckBox(&g_Config.bVertexCache, gr->T("Vertex Cache")));
 	vtxCache->OnClick.Add([=](EventParams &e) {
 		settingInfo_->Show(gr->T("VertexCache Tip", "Faster, but may cause temporary flicker"), e.v);
@@ -494,6 +521,17 @@ void GameSettingsScreen::CreateViews() {
 		return UI::EVENT_CONTINUE;
 	});
 
+	if (DirtyPageTrackingSupported()) {
+		CheckBox *texPageTracking = graphicsSettings->Add(new CheckBox(&g_Config.bTexturePageTracking, gr->T("Track texture writes")));
+		texPageTracking->OnClick.Add([=](EventParams &e) {
+			settingInfo_->Show(gr->T("TexturePageTracking Tip", "Lets the OS tell which textures were written to, instead of hashing them"), e.v);
+			return UI::EVENT_CONTINUE;
+		});
+		texPageTracking->SetEnabledFunc([] {
+			return !g_Config.bSoftwareRendering && g_Config.bTextureBackoffCache;
+		});
+	}
+
 	CheckBox *texSecondary_ = graphicsSettings->Add(new CheckBox(&g_Config.bTextureSecondaryCache, gr->T("Retain changed textures", "Retain changed textures (speedup, mem hog)")));
 	texSecondary_->OnClick.Add([=](EventParams &e) {
 		settingInfo_->Show(gr->T("RetainChangedTextures Tip", "Makes many games slower, but some games a lot faster"), e.v);
@@ -558,6 +596,16 @@ void GameSettingsScreen::CreateViews() {
 		return !g_Config.bSoftwareRendering && !UsingHardwareTextureScaling();
 	});
 
+	CheckBox *scalingGPU = graphicsSettings->Add(new CheckBox(&g_Config.bTexScalingGPU, gr->T("Upscale on GPU")));
+	scalingGPU->OnClick.Add([=](EventParams &e) {
+		if (g_Config.bTexScalingGPU)
+			settingInfo_->Show(gr->T("UpscaleGPU Tip", "xBRZ 3x/5x and Deposterize still upscale on the CPU"), e.v);
+		return UI::EVENT_CONTINUE;
+	});
+	scalingGPU->SetEnabledFunc([]() {
+		return GetGPUBackend() == GPUBackend::VULKAN && !g_Config.bSoftwareRendering && !UsingHardwareTextureScaling();
+	});
+
 	CheckBox *deposterize = graphicsSettings->Add(new CheckBox(&g_Config.bTexDeposterize, gr->T("Deposterize")));
 	deposterize->OnClick.Add([=](EventParams &e) {
 		if (g_Config.bTexDeposterize == true) {
@@ -990,6 +1038,8 @@ void GameSettingsScreen::CreateViews() {
 	lockedMhz->SetZeroLabel(sy->T("Auto"));
 	PopupSliderChoice *rewindFreq = systemSettings->Add(new PopupSliderChoice(&g_Config.iRewindFlipFrequency, 0, 1800, sy->T("Rewind Snapshot Frequency", "Rewind Snapshot Frequency (mem hog)"), screenManager(), sy->T("frames, 0:off")));
 	rewindFreq->SetZeroLabel(sy->T("Off"));
+	PopupSliderChoice *runAhead = systemSettings->Add(new PopupSliderChoice(&g_Config.iRunAheadFrames, 0, 4, sy->T("Run-ahead", "Run-ahead (less input lag, slower)"), screenManager(), sy->T("frames, 0:off")));
+	runAhead->SetZeroLabel(sy->T("Off"));
 
 	systemSettings->Add(new ItemHeader(sy->T("General")));
 
@@ -1008,6 +1058,7 @@ void GameSettingsScreen::CreateViews() {
 
 	systemSettings->Add(new Choice(sy->T("Restore Default Settings")))->OnClick.Handle(this, &GameSettingsScreen::OnRestoreDefaultSettings);
 	systemSettings->Add(new CheckBox(&g_Config.bEnableStateUndo, sy->T("Savestate slot backups")));
+	systemSettings->Add(new CheckBox(&g_Config.bAsyncSaveState, sy->T("Write savestates in the background")));
 	static const char *autoLoadSaveStateChoices[] = { "Off", "Oldest Save", "Newest Save", "Slot 1", "Slot 2", "Slot 3", "Slot 4", "Slot 5" };
 	systemSettings->Add(new PopupMultiChoice(&g_Config.iAutoLoadSaveState, sy->T("Auto Load Savestate"), autoLoadSaveStateChoices, 0, ARRAY_SIZE(autoLoadSaveStateChoices), sy->GetName(), screenManager()));
 	if (System_GetPropertyBool(SYSPROP_HAS_KEYBOARD))
@@ -1015,6 +1066,11 @@ void GameSettingsScreen::CreateViews() {
 
 #if PPSSPP_ARCH(AMD64)
 	systemSettings->Add(new CheckBox(&g_Config.bCacheFullIsoInRam, sy->T("Cache ISO in RAM", "Cache full ISO in RAM")))->SetEnabled(!PSP_IsInited());
+	PopupSliderChoice *fillRate = systemSettings->Add(new PopupSliderChoice(&g_Config.iRamCacheFillRate, 0, 200, sy->T("RAM cache fill rate"), 5, screenManager(), sy->T("MB/s, 0:unlimited")));
+	fillRate->SetEnabledPtr(&g_Config.bCacheFullIsoInRam);
+#endif
+#if PPSSPP_ARCH(64BIT)
+	systemSettings->Add(new CheckBox(&g_Config.bMemoryMapIso, sy->T("Memory-map ISO files")))->SetEnabled(!PSP_IsInited());
 #endif
 
 	systemSettings->Add(new ItemHeader(sy->T("Cheats", "Cheats")));
@@ -107,6 +107,7 @@ void AsyncImageFileView::SetFilename(const Path &filename) {
 		textureFailed_ = false;
 		filename_ = filename;
 		texture_.reset(nullptr);
+		UI::InvalidateLayout();
 	}
 }
 
@@ -126,6 +127,8 @@ void AsyncImageFileView::Draw(UIContext &dc) {
 		texture_ = CreateTextureFromFile(dc.GetDrawContext(), filename_.c_str(), DETECT, true);
 		if (!texture_.get())
 			textureFailed_ = true;
+		// Our size depends on the image.
+		UI::InvalidateLayout();
 	}
 
 	if (HasFocus()) {
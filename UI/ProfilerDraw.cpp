@@ -18,10 +18,16 @@
 #include <algorithm>
 #include <inttypes.h>
 
+#include "Common/GPU/thin3d.h"
 #include "Common/Render/DrawBuffer.h"
+#include "Common/System/Display.h"
+#include "Common/System/System.h"
+#include "Common/TimeUtil.h"
 #include "Common/UI/Context.h"
 #include "Common/UI/View.h"
+#include "Common/Profiler/FrameTimeline.h"
 #include "Common/Profiler/Profiler.h"
+#include "UI/ProfilerDraw.h"
 
 #ifdef USE_PROFILER
 static const uint32_t nice_colors[] = {
@@ -203,3 +209,111 @@ void DrawProfile(UIContext &ui) {
 	lastMaxVal = lastMaxVal * 0.95f + maxVal * 0.05f;
 #endif
 }
+
+void DrawGPUProfile(UIContext &ui, Draw::DrawContext *draw) {
+	const float x = 10 + System_GetPropertyFloat(SYSPROP_DISPLAY_SAFE_INSET_LEFT);
+	float y = 50 + System_GetPropertyFloat(SYSPROP_DISPLAY_SAFE_INSET_TOP);
+
+	ui.Begin();
+	ui.SetFontScale(0.4f, 0.4f);
+
+	float lineW = 0.0f, lineH = 0.0f;
+	ui.MeasureText(ui.GetFontStyle(), 0.4f, 0.4f, "W", &lineW, &lineH);
+	lineH += 2.0f;
+
+	Draw::GPUFrameTimings timings;
+	if (!draw->GetGPUTimings(&timings)) {
+		const char *text = draw->GetDeviceCaps().timestampQueriesSupported ? "(no GPU profile data collected yet)" : "(GPU timestamps not supported)";
+		ui.DrawTextShadow(text, x, y, 0xFFFFFFFF, FLAG_DYNAMIC_ASCII);
+		ui.SetFontScale(1.0f, 1.0f);
+		ui.Flush();
+		return;
+	}
+
+	char line[256];
+	snprintf(line, sizeof(line), "Total GPU time: %0.3f ms", timings.totalMs);
+	ui.DrawTextShadow(line, x, y, 0xFFFFFFFF, FLAG_DYNAMIC_ASCII);
+	y += lineH;
+	if (timings.cpuMs > 0.0) {
+		snprintf(line, sizeof(line), "Render CPU time: %0.3f ms", timings.cpuMs);
+		ui.DrawTextShadow(line, x, y, 0xFFFFFFFF, FLAG_DYNAMIC_ASCII);
+		y += lineH;
+	}
+
+	// Bars are relative to a 60 fps frame, unless the GPU is slower than that.
+	const float barWidth = 150.0f;
+	double scale = barWidth / std::max(timings.totalMs, 1000.0 / 60.0);
+	for (const auto &pass : timings.passes) {
+		if (y > ui.GetBounds().y2() - lineH)
+			break;
+		// Anything over a quarter of the frame is worth a look.
+		uint32_t color = pass.ms > timings.totalMs * 0.25 ? 0xC04040FF : 0xC0FFC040;
+		ui.FillRect(UI::Drawable(color), Bounds(x, y + 1.0f, std::max(1.0f, (float)(pass.ms * scale)), lineH - 2.0f));
+		snprintf(line, sizeof(line), "%0.3f ms: %s", pass.ms, pass.name.c_str());
+		ui.DrawTextShadow(line, x + barWidth + 5.0f, y, 0xFFFFFFFF, FLAG_DYNAMIC_ASCII);
+		y += lineH;
+	}
+
+	ui.SetFontScale(1.0f, 1.0f);
+	ui.Flush();
+}
+
+void DrawFrameTimeline(UIContext &ui) {
+	static const uint32_t laneColors[] = {
+		0xC04080FF,  // Emu
+		0xFFFFFFFF,  // Flip
+		0xC040FF80,  // Render
+		0xFF40C0FF,  // GPU
+		0xC0FF8040,  // Present
+	};
+	// Enough to see a few frames next to each other, even at 30 fps.
+	const double window = 0.25;
+	const double now = time_now_d();
+
+	const Bounds &bounds = ui.GetBounds();
+	const float left = 10 + System_GetPropertyFloat(SYSPROP_DISPLAY_SAFE_INSET_LEFT);
+	const float labelW = 60.0f;
+	const float graphX = left + labelW;
+	const float graphW = bounds.x2() - System_GetPropertyFloat(SYSPROP_DISPLAY_SAFE_INSET_RIGHT) - 10.0f - graphX;
+	const float laneH = 14.0f;
+	const int laneCount = (int)FrameTimelineLane::COUNT;
+	float y = bounds.y2() - System_GetPropertyFloat(SYSPROP_DISPLAY_SAFE_INSET_BOTTOM) - 10.0f - laneH * (laneCount + 1);
+	const float scale = (float)(graphW / window);
+
+	ui.Begin();
+	ui.SetFontScale(0.4f, 0.4f);
+	ui.FillRect(UI::Drawable(0x80000000), Bounds(left, y, labelW + graphW, laneH * (laneCount + 1)));
+
+	// A line at every 60 fps vblank boundary, counting back from now.
+	for (double t = 0.0; t < window; t += 1.0 / 60.0) {
+		ui.FillRect(UI::Drawable(0x40FFFFFF), Bounds(graphX + graphW - (float)(t * scale), y, 1.0f, laneH * laneCount));
+	}
+
+	char line[256];
+	double lastFlip = 0.0;
+	double worstFlipGap = 0.0;
+	int flips = 0;
+	for (int i = 0; i < laneCount; ++i) {
+		FrameTimelineLane lane = (FrameTimelineLane)i;
+		ui.DrawTextShadow(FrameTimeline_GetLaneName(lane), left + 2.0f, y, 0xFFFFFFFF, FLAG_DYNAMIC_ASCII);
+		for (const FrameTimelineSpan &span : FrameTimeline_GetSpans(lane, now - window)) {
+			float x1 = graphX + graphW - (float)((now - std::max(span.start, now - window)) * scale);
+			float x2 = graphX + graphW - (float)((now - span.end) * scale);
+			ui.FillRect(UI::Drawable(laneColors[i]), Bounds(x1, y + 2.0f, std::max(1.0f, x2 - x1), laneH - 4.0f));
+
+			if (lane == FrameTimelineLane::FLIP) {
+				if (lastFlip != 0.0)
+					worstFlipGap = std::max(worstFlipGap, span.start - lastFlip);
+				lastFlip = span.start;
+				flips++;
+			}
+		}
+		y += laneH;
+	}
+
+	snprintf(line, sizeof(line), "%d flips in %0.0f ms, longest gap %0.2f ms", flips, window * 1000.0, worstFlipGap * 1000.0);
+	ui.DrawTextShadow(line, graphX, y, 0xFFFFFFFF, FLAG_DYNAMIC_ASCII);
+
+	ui.SetFontScale(1.0f, 1.0f);
+	ui.Flush();
+}
@@ -2,6 +2,15 @@
 
 class UIContext;
 
+namespace Draw {
+class DrawContext;
+}
+
+// Per-pass GPU timings, from DrawContext::GetGPUTimings().
+void DrawGPUProfile(UIContext &ui, Draw::DrawContext *draw);
+// The last few frames of the emu thread, render thread, GPU and present, from FrameTimeline.
+void DrawFrameTimeline(UIContext &ui);
+
 #ifdef USE_PROFILER
 
 void DrawProfile(UIContext &ui);
@@ -208,7 +208,7 @@ bool RemoteISOConnectScreen::FindServer(std::string &resultHost, int &resultPort
 
 	using namespace json;
 
-	JsonReader reader(json.c_str(), json.size());
+	JsonReader reader(std::move(json), InPlace());
 	if (!reader.ok()) {
 		SetStatus("Could not load peers, retrying soon...", "", 0);
 		return false;
@@ -246,7 +246,7 @@ bool RemoteISOConnectScreen::FindServer(std::string &resultHost, int &resultPort
 static bool LoadGameList(const Path &url, std::vector<Path> &games) {
 	PathBrowser browser(url);
 	std::vector<File::FileInfo> files;
-	browser.GetListing(files, "iso:cso:pbp:elf:prx:ppdmp:", &scanCancelled);
+	browser.GetListing(files, "iso:cso:zso:zst:pbp:elf:prx:ppdmp:", &scanCancelled);
 	if (scanCancelled) {
 		return false;
 	}
@@ -116,6 +116,7 @@ void HttpImageFileView::SetFilename(std::string filename) {
 		textureFailed_ = false;
 		path_ = filename;
 		texture_.reset(nullptr);
+		UI::InvalidateLayout();
 	}
 }
 
@@ -146,6 +147,8 @@ void HttpImageFileView::Draw(UIContext &dc) {
 			textureFailed_ = true;
 		textureData_.clear();
 		download_.reset();
+		// Our size depends on the image.
+		UI::InvalidateLayout();
 	}
 
 	if (HasFocus()) {
@@ -421,7 +424,7 @@ void StoreScreen::update() {
 
 void StoreScreen::ParseListing(std::string json) {
 	using namespace json;
-	JsonReader reader(json.c_str(), json.size());
+	JsonReader reader(std::move(json), InPlace());
 	if (!reader.ok() || !reader.root()) {
 		ERROR_LOG(IO, "Error parsing JSON from store");
 		connectionError_ = true;
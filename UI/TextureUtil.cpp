@@ -231,8 +231,14 @@ void GameIconView::Draw(UIContext &dc) {
 		return;
 	}
 
-	textureWidth_ = info->icon.texture->Width() * scale_;
-	textureHeight_ = info->icon.texture->Height() * scale_;
+	int textureWidth = info->icon.texture->Width() * scale_;
+	int textureHeight = info->icon.texture->Height() * scale_;
+	if (textureWidth != textureWidth_ || textureHeight != textureHeight_) {
+		// Our size depends on the icon, which loads in the background.
+		textureWidth_ = textureWidth;
+		textureHeight_ = textureHeight;
+		InvalidateLayout();
+	}
 
 	// Fade icon with the backgrounds.
 	double loadTime = info->icon.timeLoaded;
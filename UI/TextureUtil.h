@@ -28,6 +28,8 @@ class ManagedTexture {
 	Draw::Texture *GetTexture();  // For immediate use, don't store.
 	int Width() const { return texture_->Width(); }
 	int Height() const { return texture_->Height(); }
+	// Rough, assumes 32-bit pixels. 0 when not loaded.
+	size_t MemoryBytes() const { return texture_ ? (size_t)texture_->Width() * texture_->Height() * 4 : 0; }
 
 	void DeviceLost();
 	void DeviceRestored(Draw::DrawContext *draw);
@@ -2,9 +2,12 @@
 
 #include "Common/CommonWindows.h"
 #include <d3d11.h>
+#include <dxgi1_3.h>
 #include <WinError.h>
 
 #include "Common/Log.h"
+#include "Common/Profiler/FrameTimeline.h"
+#include "Common/TimeUtil.h"
 #include "Common/System/Display.h"
 #include "Common/Data/Encoding/Utf8.h"
 #include "Common/Data/Text/I18n.h"
@@ -41,8 +44,19 @@ D3D11Context::~D3D11Context() {
 }
 
 void D3D11Context::SwapBuffers() {
+	FrameTimeline_Begin(FrameTimelineLane::PRESENT);
 	swapChain_->Present(swapInterval_, 0);
+	FrameTimeline_End(FrameTimelineLane::PRESENT);
 	draw_->HandleEvent(Draw::Event::PRESENTED, 0, 0, nullptr, nullptr);
+
+	if (frameLatencyWaitableObject_) {
+		// Start the next frame only once this one has been picked up for display.
+		WaitForSingleObjectEx(frameLatencyWaitableObject_, 100, TRUE);
+		double now = time_now_d();
+		if (frameStartTime_ != 0.0)
+			draw_->SetPresentLatencyMs((now - frameStartTime_) * 1000.0);
+		frameStartTime_ = now;
+	}
 }
 
 void D3D11Context::SwapInterval(int interval) {
@@ -204,22 +218,27 @@ bool D3D11Context::Init(HINSTANCE hInst, HWND wnd, std::string *error_message) {
 		dxgiDevice->Release();
 	}
 
-	// DirectX 11.0 systems
-	DXGI_SWAP_CHAIN_DESC sd;
-	ZeroMemory(&sd, sizeof(sd));
-	sd.BufferCount = 1;
-	sd.BufferDesc.Width = width;
-	sd.BufferDesc.Height = height;
-	sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-	sd.BufferDesc.RefreshRate.Numerator = 60;
-	sd.BufferDesc.RefreshRate.Denominator = 1;
-	sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-	sd.OutputWindow = hWnd_;
-	sd.SampleDesc.Count = 1;
-	sd.SampleDesc.Quality = 0;
-	sd.Windowed = TRUE;
-
-	hr = dxgiFactory->CreateSwapChain(device_, &sd, &swapChain_);
+	if (g_Config.bLowLatencyPresent)
+		CreateWaitableSwapChain(dxgiFactory, width, height);
+
+	if (!swapChain_) {
+		// DirectX 11.0 systems
+		DXGI_SWAP_CHAIN_DESC sd;
+		ZeroMemory(&sd, sizeof(sd));
+		sd.BufferCount = 1;
+		sd.BufferDesc.Width = width;
+		sd.BufferDesc.Height = height;
+		sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		sd.BufferDesc.RefreshRate.Numerator = 60;
+		sd.BufferDesc.RefreshRate.Denominator = 1;
+		sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+		sd.OutputWindow = hWnd_;
+		sd.SampleDesc.Count = 1;
+		sd.SampleDesc.Quality = 0;
+		sd.Windowed = TRUE;
+
+		hr = dxgiFactory->CreateSwapChain(device_, &sd, &swapChain_);
+	}
 	dxgiFactory->MakeWindowAssociation(hWnd_, DXGI_MWA_NO_ALT_ENTER);
 	dxgiFactory->Release();
 
@@ -227,6 +246,46 @@ bool D3D11Context::Init(HINSTANCE hInst, HWND wnd, std::string *error_message) {
 	return true;
 }
 
+// Flip model swap chain with a frame latency of one, needs Windows 8.1.
+// Presents no longer block, instead we wait on the latency object after each present.
+bool D3D11Context::CreateWaitableSwapChain(IDXGIFactory1 *dxgiFactory, int width, int height) {
+	IDXGIFactory2 *dxgiFactory2 = nullptr;
+	if (FAILED(dxgiFactory->QueryInterface(__uuidof(IDXGIFactory2), (void **)&dxgiFactory2)))
+		return false;
+
+	DXGI_SWAP_CHAIN_DESC1 sd{};
+	sd.Width = width;
+	sd.Height = height;
+	sd.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	sd.SampleDesc.Count = 1;
+	sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+	sd.BufferCount = 2;
+	sd.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
+	sd.Flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+
+	IDXGISwapChain1 *swapChain1 = nullptr;
+	HRESULT hr = dxgiFactory2->CreateSwapChainForHwnd(device_, hWnd_, &sd, nullptr, nullptr, &swapChain1);
+	dxgiFactory2->Release();
+	if (FAILED(hr))
+		return false;
+
+	IDXGISwapChain2 *swapChain2 = nullptr;
+	if (FAILED(swapChain1->QueryInterface(__uuidof(IDXGISwapChain2), (void **)&swapChain2))) {
+		swapChain1->Release();
+		return false;
+	}
+	swapChain2->SetMaximumFrameLatency(1);
+	frameLatencyWaitableObject_ = swapChain2->GetFrameLatencyWaitableObject();
+	swapChain2->Release();
+
+	swapChain_ = swapChain1;
+	swapChainFlags_ = sd.Flags;
+	// The object starts out signaled, take that so the first frame doesn't run ahead.
+	WaitForSingleObjectEx(frameLatencyWaitableObject_, 100, TRUE);
+	INFO_LOG(G3D, "Created waitable flip model swap chain");
+	return true;
+}
+
 void D3D11Context::LostBackbuffer() {
 	draw_->HandleEvent(Draw::Event::LOST_BACKBUFFER, width, height, nullptr);
 	bbRenderTargetTex_->Release();
@@ -258,7 +317,7 @@ void D3D11Context::Resize() {
 	int width;
 	int height;
 	GetRes(hWnd_, width, height);
-	swapChain_->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, 0);
+	swapChain_->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, swapChainFlags_);
 	GotBackbuffer();
 }
 
@@ -270,6 +329,12 @@ void D3D11Context::Shutdown() {
 
 	swapChain_->Release();
 	swapChain_ = nullptr;
+	if (frameLatencyWaitableObject_) {
+		CloseHandle(frameLatencyWaitableObject_);
+		frameLatencyWaitableObject_ = nullptr;
+	}
+	swapChainFlags_ = 0;
+	frameStartTime_ = 0.0;
 	if (context1_)
 		context1_->Release();
 	if (device1_)
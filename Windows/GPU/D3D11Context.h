@@ -41,12 +41,17 @@ class D3D11Context : public WindowsGraphicsContext {
 
 private:
 	HRESULT CreateTheDevice(IDXGIAdapter *adapter);
+	bool CreateWaitableSwapChain(IDXGIFactory1 *dxgiFactory, int width, int height);
 
 	void LostBackbuffer();
 	void GotBackbuffer();
 
 	Draw::DrawContext *draw_ = nullptr;
 	IDXGISwapChain *swapChain_ = nullptr;
+	UINT swapChainFlags_ = 0;
+	// Only with bLowLatencyPresent, decided at creation since the flag can't be added later.
+	HANDLE frameLatencyWaitableObject_ = nullptr;
+	double frameStartTime_ = 0.0;
 	ID3D11Device *device_ = nullptr;
 	ID3D11Device1 *device1_ = nullptr;
 	ID3D11DeviceContext *context_ = nullptr;
@@ -9,6 +9,7 @@
 #include "Common/Data/Encoding/Utf8.h"
 #include "Common/Data/Text/I18n.h"
 #include "Common/Log.h"
+#include "Common/Profiler/FrameTimeline.h"
 #include "Common/OSVersion.h"
 
 #include "Core/Config.h"
@@ -23,6 +24,7 @@
 #include "Common/GPU/D3D9/D3DCompilerLoader.h"
 
 void D3D9Context::SwapBuffers() {
+	FrameTimeline_Begin(FrameTimelineLane::PRESENT);
 	if (has9Ex_) {
 		deviceEx_->EndScene();
 		deviceEx_->PresentEx(NULL, NULL, NULL, NULL, 0);
@@ -32,6 +34,7 @@ void D3D9Context::SwapBuffers() {
 		device_->Present(NULL, NULL, NULL, NULL);
 		device_->BeginScene();
 	}
+	FrameTimeline_End(FrameTimelineLane::PRESENT);
 }
 
 typedef HRESULT (__stdcall *DIRECT3DCREATE9EX)(UINT, IDirect3D9Ex**);
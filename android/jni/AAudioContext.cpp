@@ -0,0 +1,268 @@
+// Low latency audio output through AAudio.
+//
+// libaaudio.so only exists on Android 8.0+, so it's loaded with dlopen() rather than linked,
+// and the handful of types and constants we need are declared here (their values are ABI.)
+
+#include <cstring>
+#include <dlfcn.h>
+
+#include "Common/Log.h"
+#include "Common/StringUtils.h"
+#include "Core/HLE/__sceAudio.h"
+#include "Core/HLE/sceUsbMic.h"
+#include "AAudioContext.h"
+
+struct AAudioStreamBuilderStruct;
+typedef struct AAudioStreamBuilderStruct AAudioStreamBuilder;
+
+typedef int32_t aaudio_result_t;
+typedef int32_t (*AAudioDataCallback)(AAudioStream *stream, void *userData, void *audioData, int32_t numFrames);
+typedef void (*AAudioErrorCallback)(AAudioStream *stream, void *userData, aaudio_result_t error);
+
+enum {
+	AAUDIO_OK = 0,
+	AAUDIO_ERROR_DISCONNECTED = -899,
+
+	AAUDIO_DIRECTION_OUTPUT = 0,
+	AAUDIO_DIRECTION_INPUT = 1,
+
+	AAUDIO_FORMAT_PCM_I16 = 1,
+
+	AAUDIO_SHARING_MODE_EXCLUSIVE = 0,
+	AAUDIO_SHARING_MODE_SHARED = 1,
+
+	AAUDIO_PERFORMANCE_MODE_LOW_LATENCY = 12,
+
+	AAUDIO_CALLBACK_RESULT_CONTINUE = 0,
+};
+
+static struct {
+	aaudio_result_t (*createStreamBuilder)(AAudioStreamBuilder **builder);
+	const char *(*convertResultToText)(aaudio_result_t result);
+	void (*builderSetDirection)(AAudioStreamBuilder *builder, int32_t direction);
+	void (*builderSetSharingMode)(AAudioStreamBuilder *builder, int32_t sharingMode);
+	void (*builderSetPerformanceMode)(AAudioStreamBuilder *builder, int32_t mode);
+	void (*builderSetFormat)(AAudioStreamBuilder *builder, int32_t format);
+	void (*builderSetChannelCount)(AAudioStreamBuilder *builder, int32_t channelCount);
+	void (*builderSetSampleRate)(AAudioStreamBuilder *builder, int32_t sampleRate);
+	void (*builderSetDataCallback)(AAudioStreamBuilder *builder, AAudioDataCallback callback, void *userData);
+	void (*builderSetErrorCallback)(AAudioStreamBuilder *builder, AAudioErrorCallback callback, void *userData);
+	aaudio_result_t (*builderOpenStream)(AAudioStreamBuilder *builder, AAudioStream **stream);
+	aaudio_result_t (*builderDelete)(AAudioStreamBuilder *builder);
+	aaudio_result_t (*streamRequestStart)(AAudioStream *stream);
+	aaudio_result_t (*streamRequestStop)(AAudioStream *stream);
+	aaudio_result_t (*streamClose)(AAudioStream *stream);
+	int32_t (*streamGetFramesPerBurst)(AAudioStream *stream);
+	aaudio_result_t (*streamSetBufferSizeInFrames)(AAudioStream *stream, int32_t numFrames);
+	int32_t (*streamGetXRunCount)(AAudioStream *stream);
+	int32_t (*streamGetSampleRate)(AAudioStream *stream);
+	int32_t (*streamGetSharingMode)(AAudioStream *stream);
+} aaudio;
+
+static bool LoadAAudio() {
+	static void *lib = dlopen("libaaudio.so", RTLD_NOW | RTLD_LOCAL);
+	static bool loaded = false;
+	if (loaded || !lib)
+		return loaded;
+
+	bool ok = true;
+#define LOAD_AAUDIO_FUNC(field, name) \
+	aaudio.field = reinterpret_cast<decltype(aaudio.field)>(dlsym(lib, name)); \
+	ok = ok && aaudio.field != nullptr;
+
+	LOAD_AAUDIO_FUNC(createStreamBuilder, "AAudio_createStreamBuilder");
+	LOAD_AAUDIO_FUNC(convertResultToText, "AAudio_convertResultToText");
+	LOAD_AAUDIO_FUNC(builderSetDirection, "AAudioStreamBuilder_setDirection");
+	LOAD_AAUDIO_FUNC(builderSetSharingMode, "AAudioStreamBuilder_setSharingMode");
+	LOAD_AAUDIO_FUNC(builderSetPerformanceMode, "AAudioStreamBuilder_setPerformanceMode");
+	LOAD_AAUDIO_FUNC(builderSetFormat, "AAudioStreamBuilder_setFormat");
+	LOAD_AAUDIO_FUNC(builderSetChannelCount, "AAudioStreamBuilder_setChannelCount");
+	LOAD_AAUDIO_FUNC(builderSetSampleRate, "AAudioStreamBuilder_setSampleRate");
+	LOAD_AAUDIO_FUNC(builderSetDataCallback, "AAudioStreamBuilder_setDataCallback");
+	LOAD_AAUDIO_FUNC(builderSetErrorCallback, "AAudioStreamBuilder_setErrorCallback");
+	LOAD_AAUDIO_FUNC(builderOpenStream, "AAudioStreamBuilder_openStream");
+	LOAD_AAUDIO_FUNC(builderDelete, "AAudioStreamBuilder_delete");
+	LOAD_AAUDIO_FUNC(streamRequestStart, "AAudioStream_requestStart");
+	LOAD_AAUDIO_FUNC(streamRequestStop, "AAudioStream_requestStop");
+	LOAD_AAUDIO_FUNC(streamClose, "AAudioStream_close");
+	LOAD_AAUDIO_FUNC(streamGetFramesPerBurst, "AAudioStream_getFramesPerBurst");
+	LOAD_AAUDIO_FUNC(streamSetBufferSizeInFrames, "AAudioStream_setBufferSizeInFrames");
+	LOAD_AAUDIO_FUNC(streamGetXRunCount, "AAudioStream_getXRunCount");
+	LOAD_AAUDIO_FUNC(streamGetSampleRate, "AAudioStream_getSampleRate");
+	LOAD_AAUDIO_FUNC(streamGetSharingMode, "AAudioStream_getSharingMode");
+#undef LOAD_AAUDIO_FUNC
+
+	if (!ok)
+		WARN_LOG(AUDIO, "AAudio: libaaudio.so is missing functions, not using it");
+	loaded = ok;
+	return loaded;
+}
+
+static AAudioStream *OpenStream(int32_t direction, int channels, int sampleRate, AAudioDataCallback dataCallback, AAudioErrorCallback errorCallback, void *userData, std::string *error) {
+	AAudioStreamBuilder *builder = nullptr;
+	aaudio_result_t result = aaudio.createStreamBuilder(&builder);
+	if (result != AAUDIO_OK) {
+		*error = StringFromFormat("AAudio_createStreamBuilder: %s", aaudio.convertResultToText(result));
+		return nullptr;
+	}
+
+	aaudio.builderSetDirection(builder, direction);
+	// AAudio quietly falls back to a shared stream if exclusive isn't possible.
+	aaudio.builderSetSharingMode(builder, AAUDIO_SHARING_MODE_EXCLUSIVE);
+	aaudio.builderSetPerformanceMode(builder, AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
+	aaudio.builderSetFormat(builder, AAUDIO_FORMAT_PCM_I16);
+	aaudio.builderSetChannelCount(builder, channels);
+	aaudio.builderSetSampleRate(builder, sampleRate);
+	// Not setting a callback size, so callbacks come in the device's burst size.
+	aaudio.builderSetDataCallback(builder, dataCallback, userData);
+	if (errorCallback)
+		aaudio.builderSetErrorCallback(builder, errorCallback, userData);
+
+	AAudioStream *stream = nullptr;
+	result = aaudio.builderOpenStream(builder, &stream);
+	aaudio.builderDelete(builder);
+	if (result != AAUDIO_OK) {
+		*error = StringFromFormat("AAudioStreamBuilder_openStream: %s", aaudio.convertResultToText(result));
+		return nullptr;
+	}
+	return stream;
+}
+
+AAudioContext::AAudioContext(AndroidAudioCallback cb, int _FramesPerBuffer, int _SampleRate)
+	: AudioContext(cb, _FramesPerBuffer, _SampleRate) {}
+
+bool AAudioContext::IsAvailable() {
+	return LoadAAudio();
+}
+
+bool AAudioContext::Init() {
+	if (!LoadAAudio()) {
+		SetErrorString("AAudio not available");
+		return false;
+	}
+	std::lock_guard<std::mutex> guard(streamLock_);
+	return OpenOutput();
+}
+
+bool AAudioContext::OpenOutput() {
+	std::string error;
+	outputStream_ = OpenStream(AAUDIO_DIRECTION_OUTPUT, 2, sampleRate, &OutputCallbackWrap, &ErrorCallbackWrap, this, &error);
+	if (!outputStream_) {
+		ERROR_LOG(AUDIO, "AAudio: %s", error.c_str());
+		SetErrorString(error);
+		return false;
+	}
+
+	// Two bursts is the usual sweet spot: one playing, one being filled.
+	framesPerBurst_ = aaudio.streamGetFramesPerBurst(outputStream_);
+	if (framesPerBurst_ > 0)
+		aaudio.streamSetBufferSizeInFrames(outputStream_, framesPerBurst_ * 2);
+	lastXRunCount_ = 0;
+
+	INFO_LOG(AUDIO, "AAudio: Opened output, %d Hz, burst %d frames, %s", aaudio.streamGetSampleRate(outputStream_), framesPerBurst_,
+		aaudio.streamGetSharingMode(outputStream_) == AAUDIO_SHARING_MODE_EXCLUSIVE ? "exclusive" : "shared");
+
+	aaudio_result_t result = aaudio.streamRequestStart(outputStream_);
+	if (result != AAUDIO_OK) {
+		error = StringFromFormat("AAudioStream_requestStart: %s", aaudio.convertResultToText(result));
+		ERROR_LOG(AUDIO, "AAudio: %s", error.c_str());
+		SetErrorString(error);
+		CloseOutput();
+		return false;
+	}
+	return true;
+}
+
+void AAudioContext::CloseOutput() {
+	if (outputStream_) {
+		aaudio.streamRequestStop(outputStream_);
+		aaudio.streamClose(outputStream_);
+		outputStream_ = nullptr;
+	}
+}
+
+int32_t AAudioContext::OutputCallbackWrap(AAudioStream *stream, void *userData, void *audioData, int32_t numFrames) {
+	AAudioContext *ctx = (AAudioContext *)userData;
+	return ctx->OutputCallback(stream, audioData, numFrames);
+}
+
+int32_t AAudioContext::OutputCallback(AAudioStream *stream, void *audioData, int32_t numFrames) {
+	short *buffer = (short *)audioData;
+	int renderedFrames = audioCallback(buffer, numFrames);
+	if (renderedFrames < numFrames)
+		memset(buffer + renderedFrames * 2, 0, (numFrames - renderedFrames) * 2 * sizeof(short));
+
+	// Feed device glitches back into the resampler, so low latency mode backs off.
+	int32_t xruns = aaudio.streamGetXRunCount(stream);
+	if (xruns > lastXRunCount_) {
+		__AudioNotifyOutputUnderruns(xruns - lastXRunCount_);
+		lastXRunCount_ = xruns;
+	}
+	return AAUDIO_CALLBACK_RESULT_CONTINUE;
+}
+
+void AAudioContext::ErrorCallbackWrap(AAudioStream *stream, void *userData, int32_t error) {
+	AAudioContext *ctx = (AAudioContext *)userData;
+	WARN_LOG(AUDIO, "AAudio: Stream error: %s", aaudio.convertResultToText(error));
+	// Typically headphones unplugged or similar, we need a new stream for the new device.
+	if (error != AAUDIO_ERROR_DISCONNECTED || stream != ctx->outputStream_ || ctx->restartPending_.exchange(true))
+		return;
+
+	if (ctx->restartThread_.joinable())
+		ctx->restartThread_.join();
+	ctx->restartThread_ = std::thread([ctx] {
+		std::lock_guard<std::mutex> guard(ctx->streamLock_);
+		ctx->CloseOutput();
+		if (!ctx->OpenOutput())
+			ERROR_LOG(AUDIO, "AAudio: Failed to reopen output after disconnect");
+		ctx->restartPending_ = false;
+	});
+}
+
+int32_t AAudioContext::InputCallbackWrap(AAudioStream *stream, void *userData, void *audioData, int32_t numFrames) {
+	Microphone::addAudioData((u8 *)audioData, numFrames * sizeof(short));
+	return AAUDIO_CALLBACK_RESULT_CONTINUE;
+}
+
+bool AAudioContext::AudioRecord_Start(int sampleRate) {
+	std::lock_guard<std::mutex> guard(streamLock_);
+	if (inputStream_)
+		return true;
+
+	std::string error;
+	inputStream_ = OpenStream(AAUDIO_DIRECTION_INPUT, 1, sampleRate, &InputCallbackWrap, nullptr, this, &error);
+	if (!inputStream_) {
+		ERROR_LOG(AUDIO, "AAudio: %s", error.c_str());
+		SetErrorString(error);
+		return false;
+	}
+
+	aaudio_result_t result = aaudio.streamRequestStart(inputStream_);
+	if (result != AAUDIO_OK) {
+		ERROR_LOG(AUDIO, "AAudio: Failed to start recording: %s", aaudio.convertResultToText(result));
+		SetErrorString("AudioRecord_Start: requestStart failed");
+		aaudio.streamClose(inputStream_);
+		inputStream_ = nullptr;
+		return false;
+	}
+	return true;
+}
+
+bool AAudioContext::AudioRecord_Stop() {
+	std::lock_guard<std::mutex> guard(streamLock_);
+	if (inputStream_) {
+		aaudio.streamRequestStop(inputStream_);
+		aaudio.streamClose(inputStream_);
+		inputStream_ = nullptr;
+	}
+	return true;
+}
+
+AAudioContext::~AAudioContext() {
+	if (restartThread_.joinable())
+		restartThread_.join();
+	AudioRecord_Stop();
+	std::lock_guard<std::mutex> guard(streamLock_);
+	INFO_LOG(AUDIO, "AAudio: Shutdown");
+	CloseOutput();
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "AndroidAudio.h"
+
+struct AAudioStreamStruct;
+typedef struct AAudioStreamStruct AAudioStream;
+
+// Low latency output through AAudio (Android 8.1+). The library is loaded at runtime,
+// so the same build still runs on older devices, which use OpenSLContext instead.
+class AAudioContext : public AudioContext {
+public:
+	AAudioContext(AndroidAudioCallback cb, int framesPerBuffer, int sampleRate);
+
+	static bool IsAvailable();
+
+	bool Init() override;
+	bool AudioRecord_Start(int sampleRate) override;
+	bool AudioRecord_Stop() override;
+
+	~AAudioContext();
+
+private:
+	bool OpenOutput();
+	void CloseOutput();
+
+	static int32_t OutputCallbackWrap(AAudioStream *stream, void *userData, void *audioData, int32_t numFrames);
+	static int32_t InputCallbackWrap(AAudioStream *stream, void *userData, void *audioData, int32_t numFrames);
+	static void ErrorCallbackWrap(AAudioStream *stream, void *userData, int32_t error);
+	int32_t OutputCallback(AAudioStream *stream, void *audioData, int32_t numFrames);
+
+	// Protects the streams against a restart after a device change.
+	std::mutex streamLock_;
+	AAudioStream *outputStream_ = nullptr;
+	AAudioStream *inputStream_ = nullptr;
+	int32_t framesPerBurst_ = 0;
+	int32_t lastXRunCount_ = 0;
+
+	// AAudio doesn't allow reopening from its own callbacks, so a disconnect restarts from here.
+	std::thread restartThread_;
+	std::atomic<bool> restartPending_{};
+};
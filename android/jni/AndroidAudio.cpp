@@ -1,6 +1,8 @@
 #include "Common/Log.h"
+#include "Common/System/System.h"
 
 #include "android/jni/AndroidAudio.h"
+#include "android/jni/AAudioContext.h"
 #include "android/jni/OpenSLContext.h"
 
 std::string g_error;
@@ -97,18 +99,30 @@ bool AndroidAudio_Resume(AndroidAudioState *state) {
 		return false;
 	}
 	if (!state->ctx) {
-		INFO_LOG(AUDIO, "Calling OpenSLWrap_Init_T...");
-		state->ctx = new OpenSLContext(state->callback, state->frames_per_buffer, state->sample_rate);
-		INFO_LOG(AUDIO, "Returned from OpenSLWrap_Init_T");
-		bool init_retval = state->ctx->Init();
-		if (!init_retval) {
-			delete state->ctx;
-			state->ctx = nullptr;
+		// AAudio in 8.0 had enough bugs that it's not worth it, same cutoff as Oboe.
+		if (System_GetPropertyInt(SYSPROP_SYSTEMVERSION) >= 27 && AAudioContext::IsAvailable()) {
+			INFO_LOG(AUDIO, "Initializing AAudio...");
+			state->ctx = new AAudioContext(state->callback, state->frames_per_buffer, state->sample_rate);
+			if (!state->ctx->Init()) {
+				WARN_LOG(AUDIO, "AAudio failed to initialize, falling back to OpenSL");
+				delete state->ctx;
+				state->ctx = nullptr;
+			}
+		}
+		if (!state->ctx) {
+			INFO_LOG(AUDIO, "Calling OpenSLWrap_Init_T...");
+			state->ctx = new OpenSLContext(state->callback, state->frames_per_buffer, state->sample_rate);
+			INFO_LOG(AUDIO, "Returned from OpenSLWrap_Init_T");
+			if (!state->ctx->Init()) {
+				delete state->ctx;
+				state->ctx = nullptr;
+				return false;
+			}
 		}
 		if (state->input_enable) {
 			state->ctx->AudioRecord_Start(state->input_sample_rate);
 		}
-		return init_retval;
+		return true;
 	}
 	return false;
 }
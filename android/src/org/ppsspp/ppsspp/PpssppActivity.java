@@ -252,36 +252,33 @@ public long computeRecursiveDirectorySize(String uriString) {
 		}
 	}
 
-	// TODO: Maybe add a cheaper version that doesn't extract all the file information?
-	// TODO: Replace with a proper query:
-	// * https://stackoverflow.com/questions/42186820/documentfile-is-very-slow
-	public String[] listContentUriDir(String uriString) {
+	// Returns the whole listing as one string, one line per file, so the native side only
+	// has to make a single JNI call instead of one per file.
+	public String listContentUriDir(String uriString) {
 		Cursor c = null;
 		try {
 			Uri uri = Uri.parse(uriString);
 			final ContentResolver resolver = getContentResolver();
 			final Uri childrenUri = DocumentsContract.buildChildDocumentsUriUsingTree(
 					uri, DocumentsContract.getDocumentId(uri));
-			final ArrayList<String> listing = new ArrayList<>();
+			final StringBuilder listing = new StringBuilder();
 			c = resolver.query(childrenUri, columns, null, null, null);
 			while (c.moveToNext()) {
 				String str = cursorToString(c);
 				if (str != null) {
-					listing.add(str);
+					listing.append(str).append('\n');
 				}
 			}
-			// Is ArrayList weird or what?
-			String[] strings = new String[listing.size()];
-			return listing.toArray(strings);
+			return listing.toString();
 		}
 		catch (IllegalArgumentException e) {
 			// Due to sloppy exception handling in resolver.query, we get this wrapping
 			// a FileNotFoundException if the directory doesn't exist.
-			return new String[]{};
+			return "";
 		}
 		catch (Exception e) {
 			Log.e(TAG, "listContentUriDir exception: " + e.toString());
-			return new String[]{};
+			return "";
 		} finally {
 			if (c != null) {
 				c.close();
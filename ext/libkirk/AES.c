@@ -1279,6 +1279,269 @@ rijndael_encrypt(rijndael_ctx *ctx, const u8 *src, u8 *dst)
 	rijndaelEncrypt(ctx->ek, ctx->Nr, src, dst);
 }
 
+/*
+ * Hardware AES (AES-NI on x86, the ARMv8 crypto extensions on ARM64), picked at runtime.
+ * Both use the same "equivalent inverse cipher" decrypt schedule as dk above, so the
+ * round keys only need to be put back in byte order.
+ */
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define AES_HW_X86 1
+#include <wmmintrin.h>
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define AES_HW_TARGET
+#else
+#include <cpuid.h>
+#define AES_HW_TARGET __attribute__((target("aes,sse2")))
+#endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define AES_HW_ARM64 1
+#include <arm_neon.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <windows.h>
+#define AES_HW_TARGET
+#elif defined(__clang__)
+#define AES_HW_TARGET __attribute__((target("crypto")))
+#else
+#define AES_HW_TARGET __attribute__((target("+crypto")))
+#endif
+#if defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_AES
+#define HWCAP_AES (1 << 3)
+#endif
+#endif
+#endif
+
+#if defined(AES_HW_X86) || defined(AES_HW_ARM64)
+static int aes_hw_state = -1;
+
+static int aes_hw_available(void)
+{
+	if (aes_hw_state < 0) {
+		int supported = 0;
+#if defined(AES_HW_X86) && defined(_MSC_VER)
+		int regs[4];
+		__cpuid(regs, 1);
+		supported = (regs[2] >> 25) & 1;
+#elif defined(AES_HW_X86)
+		unsigned int eax, ebx, ecx, edx;
+		if (__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+			supported = (ecx >> 25) & 1;
+#elif defined(__APPLE__)
+		supported = 1;
+#elif defined(_WIN32)
+		supported = IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE) != 0;
+#elif defined(__linux__)
+		supported = (getauxval(AT_HWCAP) & HWCAP_AES) != 0;
+#endif
+		aes_hw_state = supported;
+	}
+	return aes_hw_state;
+}
+
+static void aes_hw_round_keys(const u32 *rk, int Nr, u8 *out)
+{
+	int i;
+	for (i = 0; i < 4 * (Nr + 1); i++)
+		PUTU32(out + i * 4, rk[i]);
+}
+#else
+static int aes_hw_available(void)
+{
+	return 0;
+}
+#endif
+
+#if defined(AES_HW_X86)
+AES_HW_TARGET static __m128i aes_hw_encrypt_block(const __m128i *k, int Nr, __m128i b)
+{
+	int r;
+	b = _mm_xor_si128(b, k[0]);
+	for (r = 1; r < Nr; r++)
+		b = _mm_aesenc_si128(b, k[r]);
+	return _mm_aesenclast_si128(b, k[Nr]);
+}
+
+AES_HW_TARGET static __m128i aes_hw_decrypt_block(const __m128i *k, int Nr, __m128i b)
+{
+	int r;
+	b = _mm_xor_si128(b, k[0]);
+	for (r = 1; r < Nr; r++)
+		b = _mm_aesdec_si128(b, k[r]);
+	return _mm_aesdeclast_si128(b, k[Nr]);
+}
+
+AES_HW_TARGET static void aes_hw_load_keys(const u32 *rk, int Nr, __m128i *k)
+{
+	u8 bytes[16 * (AES_MAXROUNDS + 1)];
+	int r;
+	aes_hw_round_keys(rk, Nr, bytes);
+	for (r = 0; r <= Nr; r++)
+		k[r] = _mm_loadu_si128((const __m128i *)(bytes + r * 16));
+}
+
+AES_HW_TARGET static void aes_hw_cbc_encrypt(AES_ctx *ctx, const u8 *src, u8 *dst, int size)
+{
+	__m128i k[AES_MAXROUNDS + 1];
+	__m128i prev = _mm_setzero_si128();
+	int i;
+	aes_hw_load_keys(ctx->ek, ctx->Nr, k);
+	for (i = 0; i < size; i += 16) {
+		prev = aes_hw_encrypt_block(k, ctx->Nr, _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src + i)), prev));
+		_mm_storeu_si128((__m128i *)(dst + i), prev);
+	}
+}
+
+AES_HW_TARGET static void aes_hw_cbc_decrypt(AES_ctx *ctx, const u8 *src, u8 *dst, int size)
+{
+	__m128i k[AES_MAXROUNDS + 1];
+	__m128i prev = _mm_setzero_si128();
+	const int Nr = ctx->Nr;
+	int i = 0, r;
+	aes_hw_load_keys(ctx->dk, Nr, k);
+	/* Unlike encryption, CBC decryption has no dependency between blocks, so keep four in flight. */
+	for (; i + 64 <= size; i += 64) {
+		__m128i c0 = _mm_loadu_si128((const __m128i *)(src + i));
+		__m128i c1 = _mm_loadu_si128((const __m128i *)(src + i + 16));
+		__m128i c2 = _mm_loadu_si128((const __m128i *)(src + i + 32));
+		__m128i c3 = _mm_loadu_si128((const __m128i *)(src + i + 48));
+		__m128i b0 = _mm_xor_si128(c0, k[0]);
+		__m128i b1 = _mm_xor_si128(c1, k[0]);
+		__m128i b2 = _mm_xor_si128(c2, k[0]);
+		__m128i b3 = _mm_xor_si128(c3, k[0]);
+		for (r = 1; r < Nr; r++) {
+			b0 = _mm_aesdec_si128(b0, k[r]);
+			b1 = _mm_aesdec_si128(b1, k[r]);
+			b2 = _mm_aesdec_si128(b2, k[r]);
+			b3 = _mm_aesdec_si128(b3, k[r]);
+		}
+		b0 = _mm_xor_si128(_mm_aesdeclast_si128(b0, k[Nr]), prev);
+		b1 = _mm_xor_si128(_mm_aesdeclast_si128(b1, k[Nr]), c0);
+		b2 = _mm_xor_si128(_mm_aesdeclast_si128(b2, k[Nr]), c1);
+		b3 = _mm_xor_si128(_mm_aesdeclast_si128(b3, k[Nr]), c2);
+		_mm_storeu_si128((__m128i *)(dst + i), b0);
+		_mm_storeu_si128((__m128i *)(dst + i + 16), b1);
+		_mm_storeu_si128((__m128i *)(dst + i + 32), b2);
+		_mm_storeu_si128((__m128i *)(dst + i + 48), b3);
+		prev = c3;
+	}
+	for (; i < size; i += 16) {
+		__m128i c = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(aes_hw_decrypt_block(k, Nr, c), prev));
+		prev = c;
+	}
+}
+
+AES_HW_TARGET static void aes_hw_encrypt(AES_ctx *ctx, const u8 *src, u8 *dst)
+{
+	__m128i k[AES_MAXROUNDS + 1];
+	aes_hw_load_keys(ctx->ek, ctx->Nr, k);
+	_mm_storeu_si128((__m128i *)dst, aes_hw_encrypt_block(k, ctx->Nr, _mm_loadu_si128((const __m128i *)src)));
+}
+
+AES_HW_TARGET static void aes_hw_decrypt(AES_ctx *ctx, const u8 *src, u8 *dst)
+{
+	__m128i k[AES_MAXROUNDS + 1];
+	aes_hw_load_keys(ctx->dk, ctx->Nr, k);
+	_mm_storeu_si128((__m128i *)dst, aes_hw_decrypt_block(k, ctx->Nr, _mm_loadu_si128((const __m128i *)src)));
+}
+#elif defined(AES_HW_ARM64)
+AES_HW_TARGET static uint8x16_t aes_hw_encrypt_block(const uint8x16_t *k, int Nr, uint8x16_t b)
+{
+	int r;
+	for (r = 0; r < Nr - 1; r++)
+		b = vaesmcq_u8(vaeseq_u8(b, k[r]));
+	return veorq_u8(vaeseq_u8(b, k[Nr - 1]), k[Nr]);
+}
+
+AES_HW_TARGET static uint8x16_t aes_hw_decrypt_block(const uint8x16_t *k, int Nr, uint8x16_t b)
+{
+	int r;
+	for (r = 0; r < Nr - 1; r++)
+		b = vaesimcq_u8(vaesdq_u8(b, k[r]));
+	return veorq_u8(vaesdq_u8(b, k[Nr - 1]), k[Nr]);
+}
+
+AES_HW_TARGET static void aes_hw_load_keys(const u32 *rk, int Nr, uint8x16_t *k)
+{
+	u8 bytes[16 * (AES_MAXROUNDS + 1)];
+	int r;
+	aes_hw_round_keys(rk, Nr, bytes);
+	for (r = 0; r <= Nr; r++)
+		k[r] = vld1q_u8(bytes + r * 16);
+}
+
+AES_HW_TARGET static void aes_hw_cbc_encrypt(AES_ctx *ctx, const u8 *src, u8 *dst, int size)
+{
+	uint8x16_t k[AES_MAXROUNDS + 1];
+	uint8x16_t prev = vdupq_n_u8(0);
+	int i;
+	aes_hw_load_keys(ctx->ek, ctx->Nr, k);
+	for (i = 0; i < size; i += 16) {
+		prev = aes_hw_encrypt_block(k, ctx->Nr, veorq_u8(vld1q_u8(src + i), prev));
+		vst1q_u8(dst + i, prev);
+	}
+}
+
+AES_HW_TARGET static void aes_hw_cbc_decrypt(AES_ctx *ctx, const u8 *src, u8 *dst, int size)
+{
+	uint8x16_t k[AES_MAXROUNDS + 1];
+	uint8x16_t prev = vdupq_n_u8(0);
+	const int Nr = ctx->Nr;
+	int i = 0, r;
+	aes_hw_load_keys(ctx->dk, Nr, k);
+	/* Unlike encryption, CBC decryption has no dependency between blocks, so keep four in flight. */
+	for (; i + 64 <= size; i += 64) {
+		uint8x16_t c0 = vld1q_u8(src + i);
+		uint8x16_t c1 = vld1q_u8(src + i + 16);
+		uint8x16_t c2 = vld1q_u8(src + i + 32);
+		uint8x16_t c3 = vld1q_u8(src + i + 48);
+		uint8x16_t b0 = c0, b1 = c1, b2 = c2, b3 = c3;
+		for (r = 0; r < Nr - 1; r++) {
+			b0 = vaesimcq_u8(vaesdq_u8(b0, k[r]));
+			b1 = vaesimcq_u8(vaesdq_u8(b1, k[r]));
+			b2 = vaesimcq_u8(vaesdq_u8(b2, k[r]));
+			b3 = vaesimcq_u8(vaesdq_u8(b3, k[r]));
+		}
+		b0 = veorq_u8(veorq_u8(vaesdq_u8(b0, k[Nr - 1]), k[Nr]), prev);
+		b1 = veorq_u8(veorq_u8(vaesdq_u8(b1, k[Nr - 1]), k[Nr]), c0);
+		b2 = veorq_u8(veorq_u8(vaesdq_u8(b2, k[Nr - 1]), k[Nr]), c1);
+		b3 = veorq_u8(veorq_u8(vaesdq_u8(b3, k[Nr - 1]), k[Nr]), c2);
+		vst1q_u8(dst + i, b0);
+		vst1q_u8(dst + i + 16, b1);
+		vst1q_u8(dst + i + 32, b2);
+		vst1q_u8(dst + i + 48, b3);
+		prev = c3;
+	}
+	for (; i < size; i += 16) {
+		uint8x16_t c = vld1q_u8(src + i);
+		vst1q_u8(dst + i, veorq_u8(aes_hw_decrypt_block(k, Nr, c), prev));
+		prev = c;
+	}
+}
+
+AES_HW_TARGET static void aes_hw_encrypt(AES_ctx *ctx, const u8 *src, u8 *dst)
+{
+	uint8x16_t k[AES_MAXROUNDS + 1];
+	aes_hw_load_keys(ctx->ek, ctx->Nr, k);
+	vst1q_u8(dst, aes_hw_encrypt_block(k, ctx->Nr, vld1q_u8(src)));
+}
+
+AES_HW_TARGET static void aes_hw_decrypt(AES_ctx *ctx, const u8 *src, u8 *dst)
+{
+	uint8x16_t k[AES_MAXROUNDS + 1];
+	aes_hw_load_keys(ctx->dk, ctx->Nr, k);
+	vst1q_u8(dst, aes_hw_decrypt_block(k, ctx->Nr, vld1q_u8(src)));
+}
+#else
+static void aes_hw_cbc_encrypt(AES_ctx *ctx, const u8 *src, u8 *dst, int size) {}
+static void aes_hw_cbc_decrypt(AES_ctx *ctx, const u8 *src, u8 *dst, int size) {}
+static void aes_hw_encrypt(AES_ctx *ctx, const u8 *src, u8 *dst) {}
+static void aes_hw_decrypt(AES_ctx *ctx, const u8 *src, u8 *dst) {}
+#endif
+
 int AES_set_key(AES_ctx *ctx, const u8 *key, int bits)
 {
 	return rijndael_set_key((rijndael_ctx *)ctx, key, bits);
@@ -1286,11 +1549,19 @@ int AES_set_key(AES_ctx *ctx, const u8 *key, int bits)
 
 void AES_decrypt(AES_ctx *ctx, const u8 *src, u8 *dst)
 {
+	if (aes_hw_available()) {
+		aes_hw_decrypt(ctx, src, dst);
+		return;
+	}
 	rijndaelDecrypt(ctx->dk, ctx->Nr, src, dst);
 }
 
 void AES_encrypt(AES_ctx *ctx, const u8 *src, u8 *dst)
 {
+	if (aes_hw_available()) {
+		aes_hw_encrypt(ctx, src, dst);
+		return;
+	}
 	rijndaelEncrypt(ctx->ek, ctx->Nr, src, dst);
 }
 
@@ -1309,6 +1580,10 @@ void AES_cbc_encrypt(AES_ctx *ctx, const u8 *src, u8 *dst, int size)
 	u8 block_buff[16];
 	
 	int i;
+	if (aes_hw_available()) {
+		aes_hw_cbc_encrypt(ctx, src, dst, size);
+		return;
+	}
 	for(i = 0; i < size; i+=16)
 	{
 		//step 1: copy block to dst
@@ -1331,6 +1606,11 @@ void AES_cbc_decrypt(AES_ctx *ctx, const u8 *src, u8 *dst, int size)
 	u8 block_buff_previous[16];
 	int i;
 	
+	if (aes_hw_available()) {
+		aes_hw_cbc_decrypt(ctx, src, dst, size);
+		return;
+	}
+
 	memcpy(block_buff, src, 16);
 	memcpy(block_buff_previous, src, 16);
 	AES_decrypt(ctx, src, dst);
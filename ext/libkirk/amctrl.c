@@ -514,16 +514,18 @@ int sceDrmBBCipherInit(CIPHER_KEY *ckey, int type, int mode, u8 *header_key, u8
 	return retv;
 }
 
+// Uses its own kirk buffer, so different keys can be updated from several threads at once.
 int sceDrmBBCipherUpdate(CIPHER_KEY *ckey, u8 *data, int size)
 {
 	int p, retv, dsize;
+	u8 local_kirk_buf[0x0814];
 
 	retv = 0;
 	p = 0;
 
 	while(size>0){
 		dsize = (size>=0x0800)? 0x0800 : size;
-		retv = sub_428(kirk_buf, data+p, dsize, ckey);
+		retv = sub_428(local_kirk_buf, data+p, dsize, ckey);
 		if(retv)
 			break;
 		size -= dsize;
@@ -3,22 +3,29 @@
 // To build on non-windows systems, just run CMake in the SDL directory, it will build both a normal ppsspp and the headless version.
 
 #include "ppsspp_config.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <limits>
 #if PPSSPP_PLATFORM(ANDROID)
 #include <jni.h>
 #endif
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #include "Common/Profiler/Profiler.h"
 #include "Common/System/NativeApp.h"
 #include "Common/System/System.h"
 
 #include "Common/CPUDetect.h"
+#include "Common/Data/Format/JSONWriter.h"
 #include "Common/File/VFS/VFS.h"
 #include "Common/File/VFS/AssetReader.h"
 #include "Common/File/FileUtil.h"
 #include "Common/GraphicsContext.h"
+#include "Common/StringUtils.h"
 #include "Common/TimeUtil.h"
 #include "Common/Thread/ThreadManager.h"
 #include "Core/Config.h"
@@ -27,14 +34,23 @@
 #include "Core/CoreTiming.h"
 #include "Core/System.h"
 #include "Core/WebServer.h"
+#include "Core/FileSystems/BlockDevices.h"
 #include "Core/HLE/sceUtility.h"
+#include "Core/Loaders.h"
+#include "Core/MemMap.h"
+#include "Core/Replay.h"
 #include "Core/Host.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
+#include "Core/MIPS/MIPSAnalyst.h"
 #include "Core/SaveState.h"
 #include "GPU/Common/FramebufferManagerCommon.h"
+#include "GPU/GPU.h"
+#include "GPU/Common/GPUDebugInterface.h"
 #include "Log.h"
 #include "LogManager.h"
 
 #include "Compare.h"
+#include "ext/xxhash.h"
 #include "StubHost.h"
 #if defined(_WIN32)
 #include "WindowsHeadlessHost.h"
@@ -126,6 +142,14 @@ int printUsage(const char *progname, const char *reason)
 	}
 #endif
 	fprintf(stderr, "  --timeout=SECONDS     abort test it if takes longer than SECONDS\n");
+	fprintf(stderr, "  --workers=N           split the tests over N processes run in parallel\n");
+	fprintf(stderr, "  --bench=FRAMES        run FRAMES emulated frames and report timings as JSON\n");
+	fprintf(stderr, "  --bench-output=FILE   write the benchmark JSON to FILE instead of stdout\n");
+	fprintf(stderr, "  --replay=FILE         feed input from a replay file, stopping when it runs out\n");
+	fprintf(stderr, "  --replay-hashes=FILE  check RAM and framebuffer hashes at the end against FILE\n");
+	fprintf(stderr, "                        (written instead if FILE doesn't exist yet)\n");
+	fprintf(stderr, "  --compress-iso=FILE   convert an ISO or CSO to seekable zstd (.zst) and exit\n");
+	fprintf(stderr, "  --hot-functions=FILE  write the most run functions without a known hash to FILE\n");
 
 	fprintf(stderr, "  -v, --verbose         show the full passed/failed result\n");
 	fprintf(stderr, "  -i                    use the interpreter\n");
@@ -151,7 +175,238 @@ static HeadlessHost *getHost(GPUCore gpuCore) {
 	}
 }
 
-bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool autoCompare, bool verbose, double timeout)
+// For --compress-iso.  The output goes next to the input, as a .zst.
+static int CompressISO(const Path &filename) {
+	// 64 KB frames are still quick to decode for single sector reads, and compress much better than CSO's 2 KB.
+	static const u32 FRAME_SIZE = 64 * 1024;
+	static const int LEVEL = 19;
+
+	FileLoader *fileLoader = ConstructFileLoader(filename);
+	BlockDevice *blockDevice = fileLoader ? constructBlockDevice(fileLoader) : nullptr;
+	if (!blockDevice) {
+		fprintf(stderr, "Unable to open %s\n", filename.c_str());
+		delete fileLoader;
+		return 1;
+	}
+
+	Path output = filename.WithReplacedExtension(".zst");
+	std::string errorString;
+	double startTime = time_now_d();
+	bool success = CompressToZstdSeekable(blockDevice, output, FRAME_SIZE, LEVEL, &errorString);
+	if (success) {
+		printf("Wrote %s in %0.1f seconds (%lld -> %lld bytes)\n", output.c_str(), time_now_d() - startTime,
+			(long long)blockDevice->GetNumBlocks() * blockDevice->GetBlockSize(), (long long)File::GetFileSize(output));
+	} else {
+		fprintf(stderr, "Unable to compress %s: %s\n", filename.c_str(), errorString.c_str());
+		File::Delete(output);
+	}
+
+	delete blockDevice;
+	delete fileLoader;
+	return success ? 0 : 1;
+}
+
+// Collects host frame times and the per-frame GPU counters for --bench.
+struct BenchStats {
+	std::vector<double> frameTimes;
+	double lastFrameTime = 0.0;
+	double startTime = 0.0;
+
+	int64_t flushes = 0;
+	int64_t drawCalls = 0;
+	int64_t cachedDrawCalls = 0;
+	int64_t vertsSubmitted = 0;
+	int64_t texturesDecoded = 0;
+	int64_t texturesHashed = 0;
+	int64_t textureInvalidations = 0;
+	int64_t shaderSwitches = 0;
+	int64_t framebufferEvaluations = 0;
+	int64_t readbacks = 0;
+	int64_t uploads = 0;
+	int64_t memoryCopyBytes = 0;
+	int64_t clears = 0;
+	int64_t shadersGenerated = 0;
+	int64_t pipelinesCreated = 0;
+	// These are in seconds, like gpuStats.
+	double displayListTime = 0.0;
+	double flushTime = 0.0;
+	double vertexDecodeTime = 0.0;
+	double textureDecodeTime = 0.0;
+
+	// From --replay-hashes, empty if not checked.
+	std::string finalHashes;
+	bool hashesMatched = true;
+
+	void Begin() {
+		frameTimes.clear();
+		MIPSComp::jitCompileStats = {};
+		// Also resets the per-frame counters.
+		Core_UpdateDebugStats(true);
+		startTime = time_now_d();
+		lastFrameTime = startTime;
+	}
+
+	void EndFrame() {
+		double now = time_now_d();
+		frameTimes.push_back(now - lastFrameTime);
+		lastFrameTime = now;
+
+		flushes += gpuStats.numFlushes;
+		drawCalls += gpuStats.numDrawCalls;
+		cachedDrawCalls += gpuStats.numCachedDrawCalls;
+		vertsSubmitted += gpuStats.numVertsSubmitted;
+		texturesDecoded += gpuStats.numTexturesDecoded;
+		texturesHashed += gpuStats.numTexturesHashed;
+		textureInvalidations += gpuStats.numTextureInvalidations;
+		shaderSwitches += gpuStats.numShaderSwitches;
+		framebufferEvaluations += gpuStats.numFramebufferEvaluations;
+		readbacks += gpuStats.numReadbacks;
+		uploads += gpuStats.numUploads;
+		memoryCopyBytes += gpuStats.numMemoryCopyBytes;
+		clears += gpuStats.numClears;
+		shadersGenerated += gpuStats.numShadersGenerated;
+		pipelinesCreated += gpuStats.numPipelinesCreated;
+		displayListTime += gpuStats.msProcessingDisplayLists;
+		flushTime += gpuStats.msFlushing;
+		vertexDecodeTime += gpuStats.msDecodingVertices;
+		textureDecodeTime += gpuStats.msDecodingTextures;
+		Core_UpdateDebugStats(true);
+	}
+
+	std::string ToJSON(const std::string &name) const {
+		std::vector<double> sorted = frameTimes;
+		std::sort(sorted.begin(), sorted.end());
+		auto percentileMs = [&](double p) {
+			if (sorted.empty())
+				return 0.0;
+			size_t index = std::min(sorted.size() - 1, (size_t)(p * sorted.size()));
+			return sorted[index] * 1000.0;
+		};
+		double total = lastFrameTime - startTime;
+
+		json::JsonWriter writer(json::JsonWriter::PRETTY);
+		writer.begin();
+		writer.writeString("name", name);
+		writer.writeInt("frames", (int)frameTimes.size());
+		writer.writeFloat("totalSeconds", total);
+		writer.pushDict("frameTimeMs");
+		writer.writeFloat("mean", frameTimes.empty() ? 0.0 : total * 1000.0 / frameTimes.size());
+		writer.writeFloat("min", sorted.empty() ? 0.0 : sorted.front() * 1000.0);
+		writer.writeFloat("p50", percentileMs(0.50));
+		writer.writeFloat("p95", percentileMs(0.95));
+		writer.writeFloat("p99", percentileMs(0.99));
+		writer.writeFloat("max", sorted.empty() ? 0.0 : sorted.back() * 1000.0);
+		writer.pop();
+		// Display list processing runs inline in headless, so the rest is roughly the CPU side.
+		writer.pushDict("split");
+		writer.writeFloat("cpuMs", std::max(0.0, total - displayListTime) * 1000.0);
+		writer.writeFloat("gpuMs", displayListTime * 1000.0);
+		writer.writeFloat("gpuFraction", total > 0.0 ? displayListTime / total : 0.0);
+		writer.pop();
+		writer.pushDict("jit");
+		writer.writeInt("blocksCompiled", MIPSComp::jitCompileStats.blocks);
+		writer.writeFloat("compileMs", MIPSComp::jitCompileStats.seconds * 1000.0);
+		writer.pop();
+		// Totals over all frames.
+		writer.pushDict("gpu");
+		writer.writeFloat("flushes", (double)flushes);
+		writer.writeFloat("drawCalls", (double)drawCalls);
+		writer.writeFloat("cachedDrawCalls", (double)cachedDrawCalls);
+		writer.writeFloat("vertsSubmitted", (double)vertsSubmitted);
+		writer.writeFloat("texturesDecoded", (double)texturesDecoded);
+		writer.writeFloat("texturesHashed", (double)texturesHashed);
+		writer.writeFloat("textureInvalidations", (double)textureInvalidations);
+		writer.writeFloat("shaderSwitches", (double)shaderSwitches);
+		writer.writeFloat("framebufferEvaluations", (double)framebufferEvaluations);
+		writer.writeFloat("readbacks", (double)readbacks);
+		writer.writeFloat("uploads", (double)uploads);
+		writer.writeFloat("vramCopyBytes", (double)memoryCopyBytes);
+		writer.writeFloat("clears", (double)clears);
+		writer.writeFloat("shadersGenerated", (double)shadersGenerated);
+		writer.writeFloat("pipelinesCreated", (double)pipelinesCreated);
+		writer.writeFloat("msProcessingDisplayLists", displayListTime * 1000.0);
+		writer.writeFloat("msFlushing", flushTime * 1000.0);
+		writer.writeFloat("msPerFlush", flushes > 0 ? flushTime * 1000.0 / flushes : 0.0);
+		writer.writeFloat("msDecodingVertices", vertexDecodeTime * 1000.0);
+		writer.writeFloat("msDecodingTextures", textureDecodeTime * 1000.0);
+		writer.pop();
+		if (!finalHashes.empty()) {
+			writer.pushDict("replay");
+			writer.writeString("hashes", finalHashes);
+			writer.writeBool("matched", hashesMatched);
+			writer.pop();
+		}
+		writer.end();
+		return writer.str();
+	}
+};
+
+static bool WriteBenchResults(const BenchStats &bench, const Path &filename, const std::string &name) {
+	std::string json = bench.ToJSON(name);
+	if (filename.empty()) {
+		printf("%s", json.c_str());
+		return true;
+	}
+	if (!File::WriteStringToFile(true, json, filename)) {
+		fprintf(stderr, "Failed to write benchmark results to %s\n", filename.c_str());
+		return false;
+	}
+	return true;
+}
+
+// For --replay-hashes.  Everything that should be identical between two runs of the same replay.
+static std::string ComputeFinalHashes() {
+	u64 ramHash = 0;
+	if (Memory::IsValidRange(PSP_GetKernelMemoryBase(), Memory::g_MemorySize))
+		ramHash = XXH3_64bits(Memory::GetPointerUnchecked(PSP_GetKernelMemoryBase()), Memory::g_MemorySize);
+
+	u64 framebufferHash = 0;
+	GPUDebugBuffer buffer;
+	if (gpuDebug && gpuDebug->GetCurrentFramebuffer(buffer, GPU_DBG_FRAMEBUF_DISPLAY, 1) && buffer.GetData()) {
+		size_t size = (size_t)buffer.GetStride() * buffer.GetHeight() * buffer.PixelSize();
+		framebufferHash = XXH3_64bits(buffer.GetData(), size);
+	}
+
+	return StringFromFormat("ram %016llx\nframebuffer %016llx\n", (unsigned long long)ramHash, (unsigned long long)framebufferHash);
+}
+
+static bool CheckFinalHashes(const std::string &hashes, const Path &filename) {
+	std::string expected;
+	if (!File::Exists(filename)) {
+		if (!File::WriteStringToFile(true, hashes, filename)) {
+			fprintf(stderr, "Failed to write replay hashes to %s\n", filename.c_str());
+			return false;
+		}
+		return true;
+	}
+	if (!File::ReadFileToString(true, filename, expected)) {
+		fprintf(stderr, "Failed to read replay hashes from %s\n", filename.c_str());
+		return false;
+	}
+	if (expected != hashes) {
+		fprintf(stderr, "Replay diverged, expected:\n%sgot:\n%s", expected.c_str(), hashes.c_str());
+		return false;
+	}
+	return true;
+}
+
+// For --hot-functions.  Written as hardcodedHashes entries, ready to name and paste into MIPSAnalyst.cpp.
+static bool WriteHotFunctions(const Path &filename) {
+	static const int MAX_FUNCTIONS = 100;
+
+	std::vector<MIPSAnalyst::HotFunction> hot = MIPSAnalyst::RankUnknownHotFunctions(MAX_FUNCTIONS);
+	std::string text;
+	for (const auto &f : hot) {
+		text += StringFromFormat("\t{ 0x%016llx, %d, \"z_un_%08x\", }, // %llu block runs\n", (unsigned long long)f.hash, (int)f.size, f.start, (unsigned long long)f.count);
+	}
+	if (!File::WriteStringToFile(true, text, filename)) {
+		fprintf(stderr, "Failed to write hot functions to %s\n", filename.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool autoCompare, bool verbose, double timeout, int benchFrames, const Path &benchOutput, const Path &hotFunctionsOutput, const Path &replayFile, const Path &replayHashes)
 {
 	// Kinda ugly, trying to guesstimate the test name from filename...
 	currentTestName = GetTestName(coreParameter.fileToStart);
@@ -173,6 +428,17 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool
 
 	host->BootDone();
 
+	bool replaying = false;
+	if (!replayFile.empty()) {
+		replaying = ReplayExecuteFile(replayFile);
+		if (!replaying) {
+			fprintf(stderr, "Failed to load replay '%s'\n", replayFile.c_str());
+			PSP_Shutdown();
+			return false;
+		}
+	}
+	bool benchmarking = benchFrames > 0 || replaying;
+
 	if (autoCompare)
 		headlessHost->SetComparisonScreenshot(ExpectedScreenshotFromFilename(coreParameter.fileToStart));
 
@@ -184,6 +450,10 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool
 
 	Core_UpdateDebugStats(g_Config.bShowDebugStats || g_Config.bLogFrameDrops);
 
+	BenchStats bench;
+	if (benchmarking)
+		bench.Begin();
+
 	PSP_BeginHostFrame();
 	if (coreParameter.graphicsContext && coreParameter.graphicsContext->GetDrawContext())
 		coreParameter.graphicsContext->GetDrawContext()->BeginFrame();
@@ -198,6 +468,14 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool
 		if (coreState == CORE_NEXTFRAME) {
 			coreState = CORE_RUNNING;
 			headlessHost->SwapBuffers();
+
+			if (benchmarking) {
+				bench.EndFrame();
+				if (benchFrames > 0 && (int)bench.frameTimes.size() >= benchFrames)
+					Core_Stop();
+				else if (replaying && !ReplayHasMoreEvents())
+					Core_Stop();
+			}
 		}
 		if (coreState == CORE_STEPPING && !coreParameter.startBreak) {
 			break;
@@ -218,10 +496,31 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool
 	if (coreParameter.graphicsContext && coreParameter.graphicsContext->GetDrawContext())
 		coreParameter.graphicsContext->GetDrawContext()->EndFrame();
 
+	if (!hotFunctionsOutput.empty() && !WriteHotFunctions(hotFunctionsOutput))
+		passed = false;
+
+	if (!replayHashes.empty()) {
+		bench.finalHashes = ComputeFinalHashes();
+		bench.hashesMatched = CheckFinalHashes(bench.finalHashes, replayHashes);
+		if (!bench.hashesMatched)
+			passed = false;
+	}
+	if (replaying)
+		ReplayAbort();
+
 	PSP_Shutdown();
 
 	headlessHost->FlushDebugOutput();
 
+	if (benchmarking) {
+		if (benchFrames > 0 && (int)bench.frameTimes.size() < benchFrames) {
+			fprintf(stderr, "Benchmark stopped after %d of %d frames\n", (int)bench.frameTimes.size(), benchFrames);
+			passed = false;
+		}
+		if (!WriteBenchResults(bench, benchOutput, currentTestName))
+			passed = false;
+	}
+
 	if (autoCompare && passed)
 		passed = CompareOutput(coreParameter.fileToStart, output, verbose);
 
@@ -230,6 +529,103 @@ bool RunAutoTest(HeadlessHost *headlessHost, CoreParameter &coreParameter, bool
 	return passed;
 }
 
+#if !defined(_WIN32)
+struct TestWorker {
+	pid_t pid;
+	FILE *output;
+	FILE *results;
+	size_t first;
+	size_t count;
+};
+
+// Forks a process per slice of the tests. In a worker, narrows testFilenames to its slice, points
+// *resultsFile at where results should be reported and returns false.  In the parent, waits for
+// everything, prints the output of each worker in test order and then the overall results.
+static bool RunTestWorkers(std::vector<std::string> &testFilenames, int workerCount, bool autoCompare, FILE **resultsFile) {
+	workerCount = std::min(workerCount, (int)testFilenames.size());
+	std::vector<TestWorker> workers;
+
+	// Don't want anything buffered to get printed by every worker.
+	fflush(stdout);
+	fflush(stderr);
+
+	size_t first = 0;
+	for (int i = 0; i < workerCount; ++i) {
+		TestWorker worker{};
+		worker.first = first;
+		worker.count = (testFilenames.size() - first) / (workerCount - i);
+		worker.output = tmpfile();
+		worker.results = tmpfile();
+		if (!worker.output || !worker.results) {
+			fprintf(stderr, "Failed to create temporary files for test workers\n");
+			exit(1);
+		}
+		first += worker.count;
+
+		worker.pid = fork();
+		if (worker.pid == 0) {
+			// Keep stderr too, so logs stay next to the test they're from.
+			dup2(fileno(worker.output), STDOUT_FILENO);
+			dup2(fileno(worker.output), STDERR_FILENO);
+			testFilenames = std::vector<std::string>(testFilenames.begin() + worker.first, testFilenames.begin() + worker.first + worker.count);
+			*resultsFile = worker.results;
+			return false;
+		} else if (worker.pid < 0) {
+			fprintf(stderr, "Failed to start test worker %d\n", i);
+			exit(1);
+		}
+		workers.push_back(worker);
+	}
+
+	std::vector<std::string> failedTests;
+	int passedCount = 0;
+	char line[2048];
+	for (TestWorker &worker : workers) {
+		int status = 0;
+		waitpid(worker.pid, &status, 0);
+
+		rewind(worker.output);
+		size_t len;
+		while ((len = fread(line, 1, sizeof(line), worker.output)) > 0)
+			fwrite(line, 1, len, stdout);
+		fclose(worker.output);
+
+		// Each line is P or F, then the test name.
+		size_t reported = 0;
+		rewind(worker.results);
+		while (fgets(line, sizeof(line), worker.results)) {
+			std::string name = line + 1;
+			if (!name.empty() && name.back() == '\n')
+				name.pop_back();
+			if (line[0] == 'P')
+				passedCount++;
+			else
+				failedTests.push_back(name);
+			reported++;
+		}
+		fclose(worker.results);
+
+		// If it crashed, the rest of its tests never ran.
+		if (reported < worker.count) {
+			fprintf(stderr, "Test worker %d exited with status %d\n", (int)worker.pid, status);
+			for (size_t i = worker.first + reported; i < worker.first + worker.count; ++i)
+				failedTests.push_back(GetTestName(Path(testFilenames[i])));
+		}
+	}
+
+	if (autoCompare) {
+		printf("%d tests passed, %d tests failed.\n", passedCount, (int)failedTests.size());
+		if (!failedTests.empty()) {
+			printf("Failed tests:\n");
+			for (size_t i = 0; i < failedTests.size(); ++i) {
+				printf("  %s\n", failedTests[i].c_str());
+			}
+		}
+	}
+	return true;
+}
+#endif
+
 int main(int argc, const char* argv[])
 {
 	PROFILE_INIT();
@@ -251,6 +647,15 @@ int main(int argc, const char* argv[])
 	const char *mountRoot = nullptr;
 	const char *screenshotFilename = nullptr;
 	float timeout = std::numeric_limits<float>::infinity();
+	int benchFrames = 0;
+	const char *benchOutput = nullptr;
+	const char *replayFile = nullptr;
+	const char *replayHashes = nullptr;
+	int workerCount = 1;
+	const char *compressIso = nullptr;
+	const char *hotFunctionsOutput = nullptr;
+	// Where a worker process reports which tests passed.
+	FILE *resultsFile = nullptr;
 
 	for (int i = 1; i < argc; i++)
 	{
@@ -306,6 +711,20 @@ int main(int argc, const char* argv[])
 			screenshotFilename = argv[i] + strlen("--screenshot=");
 		else if (!strncmp(argv[i], "--timeout=", strlen("--timeout=")) && strlen(argv[i]) > strlen("--timeout="))
 			timeout = strtod(argv[i] + strlen("--timeout="), NULL);
+		else if (!strncmp(argv[i], "--bench=", strlen("--bench=")) && strlen(argv[i]) > strlen("--bench="))
+			benchFrames = (int)strtoul(argv[i] + strlen("--bench="), NULL, 10);
+		else if (!strncmp(argv[i], "--bench-output=", strlen("--bench-output=")) && strlen(argv[i]) > strlen("--bench-output="))
+			benchOutput = argv[i] + strlen("--bench-output=");
+		else if (!strncmp(argv[i], "--replay=", strlen("--replay=")) && strlen(argv[i]) > strlen("--replay="))
+			replayFile = argv[i] + strlen("--replay=");
+		else if (!strncmp(argv[i], "--replay-hashes=", strlen("--replay-hashes=")) && strlen(argv[i]) > strlen("--replay-hashes="))
+			replayHashes = argv[i] + strlen("--replay-hashes=");
+		else if (!strncmp(argv[i], "--compress-iso=", strlen("--compress-iso=")) && strlen(argv[i]) > strlen("--compress-iso="))
+			compressIso = argv[i] + strlen("--compress-iso=");
+		else if (!strncmp(argv[i], "--hot-functions=", strlen("--hot-functions=")) && strlen(argv[i]) > strlen("--hot-functions="))
+			hotFunctionsOutput = argv[i] + strlen("--hot-functions=");
+		else if (!strncmp(argv[i], "--workers=", strlen("--workers=")) && strlen(argv[i]) > strlen("--workers="))
+			workerCount = std::max(1, (int)strtoul(argv[i] + strlen("--workers="), NULL, 10));
 		else if (!strncmp(argv[i], "--debugger=", strlen("--debugger=")) && strlen(argv[i]) > strlen("--debugger="))
 			debuggerPort = (int)strtoul(argv[i] + strlen("--debugger="), NULL, 10);
 		else if (!strcmp(argv[i], "--teamcity"))
@@ -329,9 +748,33 @@ int main(int argc, const char* argv[])
 			testFilenames.push_back(temp);
 	}
 
+	if (compressIso) {
+		g_threadManager.Init(cpu_info.num_cores, cpu_info.logical_cpu_count);
+		return CompressISO(Path(compressIso));
+	}
+
 	if (testFilenames.empty())
 		return printUsage(argv[0], argc <= 1 ? NULL : "No executables specified");
 
+	if (hotFunctionsOutput) {
+		if (cpuCore == CPUCore::INTERPRETER)
+			return printUsage(argv[0], "--hot-functions needs the jit or the IR interpreter");
+		// Blocks only count their runs when compiled with this on.
+		MIPSComp::jitBlockProfiling = true;
+	}
+
+	if (workerCount > 1 && testFilenames.size() > 1) {
+		if (debuggerPort > 0 || benchFrames > 0 || hotFunctionsOutput || replayFile)
+			return printUsage(argv[0], "--workers can't be combined with --debugger, --bench, --replay or --hot-functions");
+#if defined(_WIN32)
+		fprintf(stderr, "--workers is not supported on Windows, running tests one at a time\n");
+#else
+		// Must happen before any threads are started.
+		if (RunTestWorkers(testFilenames, workerCount, autoCompare, &resultsFile))
+			return 0;
+#endif
+	}
+
 	LogManager::Init(&g_Config.bEnableLogging);
 	LogManager *logman = LogManager::GetInstance();
 
@@ -365,6 +808,7 @@ int main(int argc, const char* argv[])
 	coreParameter.startBreak = false;
 	coreParameter.printfEmuLog = !autoCompare;
 	coreParameter.headLess = true;
+	coreParameter.benchmark = benchFrames > 0;
 	coreParameter.renderScaleFactor = 1;
 	coreParameter.renderWidth = 480;
 	coreParameter.renderHeight = 272;
@@ -460,7 +904,8 @@ int main(int argc, const char* argv[])
 		coreParameter.fileToStart = Path(testFilenames[i]);
 		if (autoCompare)
 			printf("%s:\n", coreParameter.fileToStart.c_str());
-		bool passed = RunAutoTest(headlessHost, coreParameter, autoCompare, verbose, timeout);
+		bool passed = RunAutoTest(headlessHost, coreParameter, autoCompare, verbose, timeout, benchFrames, benchOutput ? Path(std::string(benchOutput)) : Path(), hotFunctionsOutput ? Path(std::string(hotFunctionsOutput)) : Path(),
+			replayFile ? Path(std::string(replayFile)) : Path(), replayHashes ? Path(std::string(replayHashes)) : Path());
 		if (autoCompare)
 		{
 			std::string testName = GetTestName(coreParameter.fileToStart);
@@ -472,9 +917,16 @@ int main(int argc, const char* argv[])
 			else
 				failedTests.push_back(testName);
 		}
+		if (resultsFile) {
+			fprintf(resultsFile, "%c%s\n", passed ? 'P' : 'F', GetTestName(coreParameter.fileToStart).c_str());
+			fflush(resultsFile);
+			// Otherwise what got printed is lost if we crash on the next test.
+			fflush(stdout);
+		}
 	}
 
-	if (autoCompare)
+	// Workers leave the summary to the parent.
+	if (autoCompare && !resultsFile)
 	{
 		printf("%d tests passed, %d tests failed.\n", (int)passedTests.size(), (int)failedTests.size());
 		if (!failedTests.empty())
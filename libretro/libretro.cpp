@@ -33,6 +33,7 @@
 #include "Core/HW/MemoryStick.h"
 #include "Core/Host.h"
 #include "Core/MemMap.h"
+#include "Core/SaveState.h"
 #include "Core/System.h"
 
 #include "GPU/GPUState.h"
@@ -782,6 +783,195 @@ namespace Libretro
 
 } // namespace Libretro
 
+namespace Libretro
+{
+   // retro_serialize is called every frame for rollback netplay and run-ahead, so it uses a fixed
+   // layout: a header, the rest of the state (padded to a fixed capacity), then raw RAM and VRAM.
+   // Each save or load is a sync point with a generation number. Every memory block remembers the
+   // generation it was last written in, so a buffer we wrote ourselves (tagged with its generation)
+   // only needs the blocks written since then copied, in either direction.
+   class RawSerializer
+   {
+   public:
+      void Reset()
+      {
+         size_ = 0;
+         generation_ = 0;
+         blockGeneration_.clear();
+         // Buffers from before a reset mustn't be trusted.
+         token_ = (uint64_t)(time_now_d() * 1000000.0) ^ ((uint64_t)(uintptr_t)this << 16);
+         Memory::StopDirtyTracking(Memory::DirtyTracker::LIBRETRO_SERIALIZE);
+      }
+
+      // Stays the same for the whole game, as frontends expect.
+      size_t Size()
+      {
+         if (size_ == 0)
+         {
+            stateCapacity_ = (u32)((SaveState::MeasureWithoutMemory() + STATE_SLACK) & ~(size_t)(STATE_SLACK - 1));
+            size_ = sizeof(Header) + stateCapacity_ + Memory::g_MemorySize + Memory::VRAM_SIZE;
+         }
+         return size_;
+      }
+
+      bool Save(u8 *data, size_t size)
+      {
+         if (size < Size())
+            return false;
+
+         Header *header = (Header *)data;
+         uint64_t since = IsOurs(*header) ? header->generation : 0;
+         // In case we fail halfway, it shouldn't look current.
+         header->magic = 0;
+
+         size_t stateSize = SaveState::MeasureWithoutMemory();
+         if (stateSize > stateCapacity_)
+         {
+            ERROR_LOG(SAVESTATE, "State too large for retro_serialize_size: %d > %d", (int)stateSize, (int)stateCapacity_);
+            return false;
+         }
+
+         u8 *ram = data + sizeof(Header) + stateCapacity_;
+         u8 *vram = ram + Memory::g_MemorySize;
+         auto err = SaveState::SaveWithoutMemory(data + sizeof(Header), stateSize, [&](PointerWrap &p) {
+            if (p.mode != PointerWrap::MODE_WRITE)
+               return;
+            Sync();
+            CopyBlocks(ram, RamBase(), 0, Memory::g_MemorySize, since);
+            CopyBlocks(vram, VramBase(), RamBlocks(), Memory::VRAM_SIZE, since);
+         });
+         if (err != CChunkFileReader::ERROR_NONE)
+            return false;
+
+         header->version = VERSION;
+         header->token = token_;
+         header->generation = generation_;
+         header->stateCapacity = stateCapacity_;
+         header->ramSize = Memory::g_MemorySize;
+         header->vramSize = Memory::VRAM_SIZE;
+         header->magic = MAGIC;
+         return true;
+      }
+
+      // Returns false if the data isn't in our format, see LoadLegacy.
+      bool IsRaw(const u8 *data, size_t size) const
+      {
+         const Header *header = (const Header *)data;
+         return size >= sizeof(Header) && header->magic == MAGIC && header->version == VERSION;
+      }
+
+      bool Load(const u8 *data, size_t size)
+      {
+         const Header *header = (const Header *)data;
+         if (header->ramSize != Memory::g_MemorySize || header->vramSize != Memory::VRAM_SIZE)
+            return false;
+         if (size < sizeof(Header) + header->stateCapacity + header->ramSize + header->vramSize)
+            return false;
+
+         uint64_t since = IsOurs(*header) ? header->generation : 0;
+         const u8 *ram = data + sizeof(Header) + header->stateCapacity;
+         const u8 *vram = ram + Memory::g_MemorySize;
+         std::string errorString;
+         auto err = SaveState::LoadWithoutMemory((u8 *)data + sizeof(Header), [&](PointerWrap &p) {
+            if (p.mode != PointerWrap::MODE_READ)
+               return;
+            Sync();
+            RestoreBlocks(RamBase(), ram, 0, Memory::g_MemorySize, since);
+            RestoreBlocks(VramBase(), vram, RamBlocks(), Memory::VRAM_SIZE, since);
+            // We know about those writes already.
+            Memory::ResetDirtyTracking(Memory::DirtyTracker::LIBRETRO_SERIALIZE);
+         }, &errorString);
+         if (err != CChunkFileReader::ERROR_NONE)
+         {
+            ERROR_LOG(SAVESTATE, "Failed to load state: %s", errorString.c_str());
+            // Memory is in an unknown state relative to any buffer.
+            blockGeneration_.clear();
+            return false;
+         }
+         return true;
+      }
+
+   private:
+      struct Header
+      {
+         u32 magic;
+         u32 version;
+         uint64_t token;
+         uint64_t generation;
+         u32 stateCapacity;
+         u32 ramSize;
+         u32 vramSize;
+         u32 padding;
+      };
+
+      static const u32 MAGIC = 0x57415250;  // PRAW
+      static const u32 VERSION = 1;
+      static const u32 BLOCK_SIZE = 4096;
+      static const size_t STATE_SLACK = 0x400000;
+
+      bool IsOurs(const Header &header) const
+      {
+         return header.magic == MAGIC && header.version == VERSION && header.token == token_ && header.generation <= generation_ &&
+            header.stateCapacity == stateCapacity_ && header.ramSize == Memory::g_MemorySize && header.vramSize == Memory::VRAM_SIZE;
+      }
+
+      static u8 *RamBase() { return Memory::GetPointerUnchecked(PSP_GetKernelMemoryBase()); }
+      static u8 *VramBase() { return Memory::GetPointerUnchecked(PSP_GetVidMemBase()); }
+      static size_t RamBlocks() { return Memory::g_MemorySize / BLOCK_SIZE; }
+
+      // Starts a new generation, and gives it to every block written since the last one.
+      void Sync()
+      {
+         generation_++;
+         const size_t ramBlocks = RamBlocks();
+         const size_t totalBlocks = ramBlocks + Memory::VRAM_SIZE / BLOCK_SIZE;
+         bool known = blockGeneration_.size() == totalBlocks && Memory::GetDirtyBlocks(Memory::DirtyTracker::LIBRETRO_SERIALIZE, BLOCK_SIZE, ramDirty_, vramDirty_);
+         Memory::ResetDirtyTracking(Memory::DirtyTracker::LIBRETRO_SERIALIZE);
+         if (!known)
+         {
+            blockGeneration_.assign(totalBlocks, generation_);
+            return;
+         }
+         for (size_t i = 0; i < ramDirty_.size(); ++i)
+            if (ramDirty_[i])
+               blockGeneration_[i] = generation_;
+         for (size_t i = 0; i < vramDirty_.size(); ++i)
+            if (vramDirty_[i])
+               blockGeneration_[ramBlocks + i] = generation_;
+      }
+
+      void CopyBlocks(u8 *dst, const u8 *src, size_t firstBlock, u32 size, uint64_t since)
+      {
+         for (size_t i = 0; i < size / BLOCK_SIZE; ++i)
+            if (blockGeneration_[firstBlock + i] > since)
+               memcpy(dst + i * BLOCK_SIZE, src + i * BLOCK_SIZE, BLOCK_SIZE);
+      }
+
+      // Like CopyBlocks, but the copied blocks now differ from every other buffer's.
+      void RestoreBlocks(u8 *dst, const u8 *src, size_t firstBlock, u32 size, uint64_t since)
+      {
+         for (size_t i = 0; i < size / BLOCK_SIZE; ++i)
+         {
+            if (blockGeneration_[firstBlock + i] > since)
+            {
+               memcpy(dst + i * BLOCK_SIZE, src + i * BLOCK_SIZE, BLOCK_SIZE);
+               blockGeneration_[firstBlock + i] = generation_;
+            }
+         }
+      }
+
+      size_t size_ = 0;
+      u32 stateCapacity_ = 0;
+      uint64_t token_ = 0;
+      uint64_t generation_ = 0;
+      std::vector<uint64_t> blockGeneration_;
+      std::vector<u8> ramDirty_;
+      std::vector<u8> vramDirty_;
+   };
+
+   static RawSerializer rawSerializer;
+} // namespace Libretro
+
 bool retro_load_game(const struct retro_game_info *game)
 {
    retro_pixel_format fmt = retro_pixel_format::RETRO_PIXEL_FORMAT_XRGB8888;
@@ -819,6 +1009,7 @@ bool retro_load_game(const struct retro_game_info *game)
       return false;
    }
 
+   rawSerializer.Reset();
    return true;
 }
 
@@ -829,6 +1020,7 @@ void retro_unload_game(void)
 
 	PSP_Shutdown();
 	VFSShutdown();
+	rawSerializer.Reset();
 
 	delete ctx;
 	ctx = nullptr;
@@ -971,13 +1163,11 @@ size_t retro_serialize_size(void)
       return 134217728; // 128MB ought to be enough for anybody.
    }
 
-   SaveState::SaveStart state;
    // TODO: Libretro API extension to use the savestate queue
    if (useEmuThread)
       EmuThreadPause();
 
-   return (CChunkFileReader::MeasurePtr(state) + 0x800000)
-      & ~0x7FFFFF; // We don't unpause intentionally
+   return rawSerializer.Size(); // We don't unpause intentionally
 }
 
 bool retro_serialize(void *data, size_t size)
@@ -986,16 +1176,11 @@ bool retro_serialize(void *data, size_t size)
       return false;
    }
 
-   bool retVal;
-   SaveState::SaveStart state;
    // TODO: Libretro API extension to use the savestate queue
    if (useEmuThread)
       EmuThreadPause(); // Does nothing if already paused
 
-   size_t measured = CChunkFileReader::MeasurePtr(state);
-   assert(measured <= size);
-   auto err = CChunkFileReader::SavePtr((u8 *)data, state, measured);
-   retVal = err == CChunkFileReader::ERROR_NONE;
+   bool retVal = rawSerializer.Save((u8 *)data, size);
 
    if (useEmuThread)
    {
@@ -1011,14 +1196,22 @@ bool retro_serialize(void *data, size_t size)
 bool retro_unserialize(const void *data, size_t size)
 {
    bool retVal;
-   SaveState::SaveStart state;
    // TODO: Libretro API extension to use the savestate queue
    if (useEmuThread)
       EmuThreadPause(); // Does nothing if already paused
 
-   std::string errorString;
-   retVal = CChunkFileReader::LoadPtr((u8 *)data, state, &errorString)
-      == CChunkFileReader::ERROR_NONE;
+   if (rawSerializer.IsRaw((const u8 *)data, size))
+   {
+      retVal = rawSerializer.Load((const u8 *)data, size);
+   }
+   else
+   {
+      // Older states were a plain full savestate.
+      SaveState::SaveStart state;
+      std::string errorString;
+      retVal = CChunkFileReader::LoadPtr((u8 *)data, state, &errorString)
+         == CChunkFileReader::ERROR_NONE;
+   }
 
    if (useEmuThread)
    {
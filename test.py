@@ -5,6 +5,7 @@ import sys
 import os
 import subprocess
 import threading
+import multiprocessing
 import glob
 
 
@@ -392,6 +393,8 @@ def run_tests(test_list, args):
     # TODO: Maybe --compare should detect --graphics?
     cmdline = [PPSSPP_EXE, '--root', TEST_ROOT + '../', '--compare', '--timeout=' + str(TIMEOUT), '@-']
     cmdline.extend([i for i in args if i not in ['-g', '-m']])
+    if os.name != 'nt' and not [i for i in args if i.startswith('--workers=')]:
+      cmdline.append('--workers=' + str(multiprocessing.cpu_count()))
 
     c = Command(cmdline, '\n'.join(test_filenames))
     c.run(TIMEOUT * len(test_filenames))
@@ -0,0 +1,295 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+// Timings of the kernels that dominate emulation profiles, to measure SIMD and other work on them.
+// Run with "unitTest bench", optionally followed by part of a benchmark name to only run those.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/Data/Convert/ColorConv.h"
+#include "Common/Data/Encoding/Utf8.h"
+#include "Common/File/FileUtil.h"
+#include "Common/File/Path.h"
+#include "Common/MemoryUtil.h"
+#include "Common/Serialize/Serializer.h"
+#include "Common/TimeUtil.h"
+#include "Core/Config.h"
+#include "Core/ConfigValues.h"
+#include "Core/HW/SasAudio.h"
+#include "GPU/Common/IndexGenerator.h"
+#include "GPU/Common/TextureDecoder.h"
+#include "GPU/Common/VertexDecoderCommon.h"
+#include "GPU/GPUState.h"
+#include "GPU/ge_constants.h"
+
+// Each sample should be long enough that timer resolution and one-off hiccups don't matter.
+static const double SAMPLE_SECONDS = 0.05;
+static const double WARMUP_SECONDS = 0.1;
+static const int SAMPLES = 9;
+
+static const char *benchFilter = nullptr;
+
+// Calls func until timings settle, then prints the median and fastest time per item.
+// func must process itemsPerCall items each time it's called.
+static void Benchmark(const char *name, int itemsPerCall, const char *itemName, const std::function<void()> &func) {
+	if (benchFilter && !strstr(name, benchFilter))
+		return;
+
+	// Warm up caches and clocks, and find out how many calls fill a sample.
+	int calls = 0;
+	double st = time_now_d();
+	do {
+		func();
+		++calls;
+	} while (time_now_d() - st < WARMUP_SECONDS);
+	int callsPerSample = std::max(1, (int)(calls * SAMPLE_SECONDS / (time_now_d() - st)));
+
+	std::vector<double> nsPerItem;
+	for (int s = 0; s < SAMPLES; ++s) {
+		st = time_now_d();
+		for (int i = 0; i < callsPerSample; ++i)
+			func();
+		double elapsed = time_now_d() - st;
+		nsPerItem.push_back(elapsed * 1000000000.0 / ((double)callsPerSample * itemsPerCall));
+	}
+	std::sort(nsPerItem.begin(), nsPerItem.end());
+
+	printf("%-44s %10.3f ns/%s (min %.3f, %d x %d %ss)\n", name, nsPerItem[SAMPLES / 2], itemName, nsPerItem[0], callsPerSample, itemsPerCall, itemName);
+}
+
+static void BenchVertexDecoder() {
+	static const int VERTS = 4096;
+	u8 *src = (u8 *)AllocateAlignedMemory(VERTS * 64, 16);
+	u8 *dst = (u8 *)AllocateAlignedMemory(VERTS * 64, 16);
+	// Not quite zero, but no denormals or NaNs as floats either.
+	memset(src, 0x3C, VERTS * 64);
+
+	g_Config.bVertexDecoderJit = true;
+	// Required for jit to be enabled.
+	g_Config.iCpuCore = (int)CPUCore::JIT;
+	gstate_c.uv.uScale = 1.0f;
+	gstate_c.uv.vScale = 1.0f;
+
+	struct Format {
+		const char *name;
+		u32 vtype;
+	};
+	static const Format formats[] = {
+		{ "VertexDecoder tc16 col8888 pos float", GE_VTYPE_TC_16BIT | GE_VTYPE_COL_8888 | GE_VTYPE_POS_FLOAT },
+		{ "VertexDecoder tc float pos float", GE_VTYPE_TC_FLOAT | GE_VTYPE_POS_FLOAT },
+		{ "VertexDecoder tc8 nrm8 pos16", GE_VTYPE_TC_8BIT | GE_VTYPE_NRM_8BIT | GE_VTYPE_POS_16BIT },
+		{ "VertexDecoder col565 pos16", GE_VTYPE_COL_565 | GE_VTYPE_POS_16BIT },
+		{ "VertexDecoder through tc16 col8888 pos16", GE_VTYPE_THROUGH | GE_VTYPE_TC_16BIT | GE_VTYPE_COL_8888 | GE_VTYPE_POS_16BIT },
+	};
+
+	VertexDecoderJitCache *cache = new VertexDecoderJitCache();
+	VertexDecoderOptions options{};
+	for (const Format &format : formats) {
+		VertexDecoder dec;
+		dec.SetVertexType(format.vtype, options, cache);
+		Benchmark(format.name, VERTS, "vert", [&] {
+			dec.DecodeVerts(dst, src, 0, VERTS - 1);
+		});
+	}
+	delete cache;
+
+	FreeAlignedMemory(src);
+	FreeAlignedMemory(dst);
+}
+
+static void BenchIndexGenerator() {
+	u16 *buffer = new u16[65536 * 4];
+	std::vector<u16_le> inds(1024);
+	for (size_t i = 0; i < inds.size(); ++i)
+		inds[i] = (u16)((i * 37) & 1023);
+
+	IndexGenerator gen;
+	gen.Setup(buffer);
+	Benchmark("IndexGenerator AddPrim strip 4", 4, "vert", [&] {
+		gen.Reset();
+		gen.AddPrim(GE_PRIM_TRIANGLE_STRIP, 4, true);
+	});
+	Benchmark("IndexGenerator AddPrim strip 512", 512, "vert", [&] {
+		gen.Reset();
+		gen.AddPrim(GE_PRIM_TRIANGLE_STRIP, 512, true);
+	});
+	Benchmark("IndexGenerator AddPrim rectangles 512", 512, "vert", [&] {
+		gen.Reset();
+		gen.AddPrim(GE_PRIM_RECTANGLES, 512, true);
+	});
+	Benchmark("IndexGenerator TranslatePrim u16 triangles", 1023, "index", [&] {
+		gen.Reset();
+		gen.TranslatePrim(GE_PRIM_TRIANGLES, 1023, inds.data(), 0, true);
+	});
+
+	delete[] buffer;
+}
+
+static void BenchTextureDecoding() {
+	// A full 512x272 screen, the most common texture size from render-to-texture.
+	static const int W = 512;
+	static const int H = 272;
+	u8 *src = (u8 *)AllocateAlignedMemory(W * H * 4, 16);
+	u32 *dst = (u32 *)AllocateAlignedMemory(W * H * 4, 16);
+	for (int i = 0; i < W * H * 4; ++i)
+		src[i] = (u8)(i * 7 + (i >> 8));
+
+	// Bytes per row / 16 and rows / 8, each block is 16 bytes by 8 rows.
+	Benchmark("DoUnswizzleTex16 512x272 32-bit", W * H, "pixel", [&] {
+		DoUnswizzleTex16(src, dst, W * 4 / 16, H / 8, W * 4);
+	});
+
+	u32 clut[256];
+	for (int i = 0; i < 256; ++i)
+		clut[i] = i * 0x01010101;
+	// No mask, shift or offset, the common case.
+	gstate.clutformat = 0xC500FF00 | GE_CMODE_32BIT_ABGR8888;
+	Benchmark("DeIndexTexture 8-bit to 32-bit", W * H, "pixel", [&] {
+		DeIndexTexture<u8, u32>(dst, src, W * H, clut);
+	});
+	Benchmark("DeIndexTexture4 4-bit to 32-bit", W * H, "pixel", [&] {
+		DeIndexTexture4<u32>(dst, src, W * H, clut);
+	});
+	u16 clut16[16];
+	for (int i = 0; i < 16; ++i)
+		clut16[i] = (u16)(i * 0x1111);
+	Benchmark("DeIndexTexture4 4-bit to 16-bit", W * H, "pixel", [&] {
+		DeIndexTexture4<u16>((u16 *)dst, src, W * H, clut16);
+	});
+
+	Benchmark("DoQuickTexHash 512x272 32-bit", W * H * 4, "byte", [&] {
+		DoQuickTexHash(src, W * H * 4);
+	});
+
+	Benchmark("ConvertRGB565ToRGBA8888", W * H, "pixel", [&] {
+		ConvertRGB565ToRGBA8888(dst, (const u16 *)src, W * H);
+	});
+	Benchmark("ConvertRGBA5551ToRGBA8888", W * H, "pixel", [&] {
+		ConvertRGBA5551ToRGBA8888(dst, (const u16 *)src, W * H);
+	});
+	Benchmark("ConvertRGBA4444ToRGBA8888", W * H, "pixel", [&] {
+		ConvertRGBA4444ToRGBA8888(dst, (const u16 *)src, W * H);
+	});
+
+	FreeAlignedMemory(src);
+	FreeAlignedMemory(dst);
+}
+
+static void BenchSas() {
+	static const int GRAIN = 256;
+	SasInstance *sas = new SasInstance();
+	sas->SetGrainSize(GRAIN);
+	// Noise voices don't read from PSP memory, but go through the same resampling, envelope and mixing.
+	for (int i = 0; i < PSP_SAS_VOICES_MAX; ++i) {
+		SasVoice &voice = sas->voices[i];
+		voice.type = VOICETYPE_NOISE;
+		// Mostly not the base pitch, so resampling is exercised as usual.
+		voice.pitch = PSP_SAS_PITCH_BASE - 0x100 + i * 0x20;
+		voice.KeyOn();
+	}
+
+	s16 *out = new s16[GRAIN * 4];
+	Benchmark("SasInstance::MixToBuffer 32 voices", GRAIN, "sample", [&] {
+		sas->MixToBuffer(out, nullptr, PSP_SAS_VOL_MAX, PSP_SAS_VOL_MAX);
+		// Keep them all going.
+		for (SasVoice &voice : sas->voices) {
+			if (!voice.playing)
+				voice.KeyOn();
+		}
+	});
+
+	delete[] out;
+	delete sas;
+}
+
+struct BenchSaveState {
+	std::vector<u8> data;
+
+	void DoState(PointerWrap &p) {
+		auto s = p.Section("BenchSaveState", 1);
+		if (!s)
+			return;
+		p.DoVoid(data.data(), (int)data.size());
+	}
+};
+
+static void BenchSerializer() {
+	// About what RAM and VRAM look like in a state: runs of zeroes, repeats, and some noise.
+	static const int SIZE = 32 * 1024 * 1024;
+	BenchSaveState state;
+	state.data.resize(SIZE);
+	u32 seed = 0x1234;
+	for (int i = 0; i < SIZE; i += 64) {
+		seed = seed * 1103515245 + 12345;
+		int kind = (seed >> 16) & 3;
+		for (int j = 0; j < 64; ++j)
+			state.data[i + j] = kind == 0 ? 0 : (kind == 1 ? (u8)j : (u8)(seed >> (j & 15)));
+	}
+
+	Path filename("ppsspp_bench.ppst");
+	std::string gitVersion, failureReason;
+	// Includes the disk write and read, which is only fair since that's what saving a state costs.
+	Benchmark("CChunkFileReader::Save 32 MB", SIZE / 1024, "KB", [&] {
+		CChunkFileReader::Save(filename, "bench", "bench", state);
+	});
+	Benchmark("CChunkFileReader::Load 32 MB", SIZE / 1024, "KB", [&] {
+		CChunkFileReader::Load(filename, &gitVersion, state, &failureReason);
+	});
+	File::Delete(filename);
+}
+
+static void BenchTextEncoding() {
+	// Game text is mostly ASCII, with the odd Japanese word mixed in.
+	static const int SIZE = 64 * 1024;
+	std::string ascii, mixed;
+	while ((int)ascii.size() < SIZE)
+		ascii += "The quick brown fox jumps over the lazy dog. ";
+	while ((int)mixed.size() < SIZE)
+		mixed += "Save data \xe3\x82\xbb\xe3\x83\xbc\xe3\x83\x96 slot 1. ";
+	ascii.resize(SIZE);
+	mixed.resize(SIZE);
+
+	volatile int sink = 0;
+	Benchmark("u8_strlen ASCII", SIZE / 1024, "KB", [&] {
+		sink = u8_strlen(ascii.c_str());
+	});
+	Benchmark("u8_strlen mixed", SIZE / 1024, "KB", [&] {
+		sink = u8_strlen(mixed.c_str());
+	});
+	Benchmark("ConvertUTF8ToWString mixed", SIZE / 1024, "KB", [&] {
+		sink = (int)ConvertUTF8ToWString(mixed).size();
+	});
+	(void)sink;
+}
+
+bool RunBenchmarks(const char *filter) {
+	benchFilter = filter;
+	SetupTextureDecoder();
+
+	BenchVertexDecoder();
+	BenchIndexGenerator();
+	BenchTextureDecoding();
+	BenchSas();
+	BenchSerializer();
+	BenchTextEncoding();
+	return true;
+}
@@ -0,0 +1,203 @@
+// Copyright (c) 2026- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/TimeUtil.h"
+#include "GPU/Common/IndexGenerator.h"
+#include "GPU/ge_constants.h"
+#include "unittest/UnitTest.h"
+
+// Plain scalar versions of what IndexGenerator should output, one prim at a time.
+// Returns the number of indices written.
+template <class IType>
+static int ReferenceIndices(u16 *out, int prim, int count, const IType *inds, int offset, bool clockwise) {
+	const int v1 = clockwise ? 1 : 2;
+	const int v2 = clockwise ? 2 : 1;
+	u16 *start = out;
+	auto idx = [&](int i) -> u16 {
+		return (u16)(offset + (inds ? (int)inds[i] : i));
+	};
+
+	switch (prim) {
+	case GE_PRIM_POINTS:
+		for (int i = 0; i < count; i++)
+			*out++ = idx(i);
+		break;
+	case GE_PRIM_LINES:
+	case GE_PRIM_RECTANGLES:
+		for (int i = 0; i + 1 < count; i += 2) {
+			*out++ = idx(i);
+			*out++ = idx(i + 1);
+		}
+		break;
+	case GE_PRIM_LINE_STRIP:
+		for (int i = 0; i < count - 1; i++) {
+			*out++ = idx(i);
+			*out++ = idx(i + 1);
+		}
+		break;
+	case GE_PRIM_TRIANGLES:
+		for (int i = 0; i + 2 < count; i += 3) {
+			*out++ = idx(i);
+			*out++ = idx(i + v1);
+			*out++ = idx(i + v2);
+		}
+		break;
+	case GE_PRIM_TRIANGLE_STRIP:
+		for (int i = 0; i < count - 2; i++) {
+			int wind = ((i & 1) == 0) == clockwise ? 1 : 2;
+			*out++ = idx(i);
+			*out++ = idx(i + wind);
+			*out++ = idx(i + (wind ^ 3));
+		}
+		break;
+	case GE_PRIM_TRIANGLE_FAN:
+		for (int i = 0; i < count - 2; i++) {
+			*out++ = idx(0);
+			*out++ = idx(i + v1);
+			*out++ = idx(i + v2);
+		}
+		break;
+	}
+	return (int)(out - start);
+}
+
+static const char *const primNames[] = { "points", "lines", "line strip", "triangles", "strip", "fan", "rectangles" };
+
+// Extra room at the end, strips are allowed to write past the last index.
+static const int INDEX_BUFFER_SIZE = 65536 * 4;
+
+static bool CompareIndices(const char *title, int prim, int count, bool clockwise, const u16 *actual, const u16 *expected, int numExpected) {
+	for (int i = 0; i < numExpected; i++) {
+		if (actual[i] != expected[i]) {
+			printf("%s %s (%d verts, %s): index %d is %d, expected %d\n", title, primNames[prim], count, clockwise ? "cw" : "ccw", (int)i, actual[i], expected[i]);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool TestIndexGeneratorPrims(u16 *buffer, u16 *expected) {
+	static const int counts[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 10, 16, 17, 24, 25, 26, 33, 48, 49, 50, 100, 1001 };
+
+	IndexGenerator gen;
+	gen.Setup(buffer);
+	for (int prim = GE_PRIM_POINTS; prim <= GE_PRIM_RECTANGLES; prim++) {
+		for (int count : counts) {
+			for (int cw = 0; cw < 2; cw++) {
+				// Start from an odd index so the base is tested too.
+				int numExpected = ReferenceIndices<u16>(expected, prim, count, nullptr, 13, cw != 0);
+
+				gen.Reset();
+				gen.SetIndex(13);
+				gen.AddPrim(prim, count, cw != 0);
+				if (!CompareIndices("AddPrim", prim, count, cw != 0, buffer, expected, numExpected))
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+template <class IType>
+static bool TestIndexGeneratorTranslate(u16 *buffer, u16 *expected, int maxIndex) {
+	static const int counts[] = { 0, 1, 2, 3, 4, 8, 9, 16, 17, 24, 25, 47, 48, 49, 200, 1001 };
+
+	std::vector<IType> inds;
+	u32 seed = 0x1234;
+	for (int i = 0; i < 1024; i++) {
+		seed = seed * 1103515245 + 12345;
+		inds.push_back((IType)((seed >> 8) % maxIndex));
+	}
+
+	IndexGenerator gen;
+	gen.Setup(buffer);
+	for (int prim = GE_PRIM_POINTS; prim <= GE_PRIM_RECTANGLES; prim++) {
+		for (int count : counts) {
+			for (int cw = 0; cw < 2; cw++) {
+				// TranslatePrim subtracts the offset from the current index.
+				int numExpected = ReferenceIndices<IType>(expected, prim, count, inds.data(), 100 - 3, cw != 0);
+
+				gen.Reset();
+				gen.SetIndex(100);
+				gen.TranslatePrim(prim, count, inds.data(), 3, cw != 0);
+				if (!CompareIndices("TranslatePrim", prim, count, cw != 0, buffer, expected, numExpected))
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+static double TimeAddPrim(IndexGenerator &gen, int prim, int count) {
+	const int perReset = INDEX_BUFFER_SIZE / 4 / (count * 3);
+	int total = 0;
+	double st = time_now_d();
+	do {
+		gen.Reset();
+		for (int j = 0; j < perReset; ++j) {
+			gen.AddPrim(prim, count, true);
+			++total;
+		}
+	} while (time_now_d() - st < 0.25);
+	return total / (time_now_d() - st);
+}
+
+static double TimeReference(u16 *out, int prim, int count) {
+	const int perReset = INDEX_BUFFER_SIZE / 4 / (count * 3);
+	int total = 0;
+	double st = time_now_d();
+	do {
+		u16 *dst = out;
+		for (int j = 0; j < perReset; ++j) {
+			dst += ReferenceIndices<u16>(dst, prim, count, nullptr, j * count, true);
+			++total;
+		}
+	} while (time_now_d() - st < 0.25);
+	return total / (time_now_d() - st);
+}
+
+bool TestIndexGenerator() {
+	u16 *buffer = new u16[INDEX_BUFFER_SIZE];
+	u16 *expected = new u16[INDEX_BUFFER_SIZE];
+
+	bool pass = TestIndexGeneratorPrims(buffer, expected);
+	pass = pass && TestIndexGeneratorTranslate<u8>(buffer, expected, 256);
+	pass = pass && TestIndexGeneratorTranslate<u16_le>(buffer, expected, 65536 - 200);
+	pass = pass && TestIndexGeneratorTranslate<u32_le>(buffer, expected, 65536 - 200);
+
+	if (pass) {
+		// Typical 2D sprite and model batch sizes.
+		static const int prims[] = { GE_PRIM_TRIANGLE_STRIP, GE_PRIM_TRIANGLE_FAN, GE_PRIM_TRIANGLES, GE_PRIM_RECTANGLES };
+		IndexGenerator gen;
+		gen.Setup(buffer);
+		for (int prim : prims) {
+			for (int count : { 4, 32, 512 }) {
+				double simd = TimeAddPrim(gen, prim, count);
+				double scalar = TimeReference(expected, prim, count);
+				printf("IndexGenerator %s, %d verts: %.1f M prims/s, %fx the scalar reference\n", primNames[prim], count, simd / 1000000.0, simd / scalar);
+			}
+		}
+	}
+
+	delete[] buffer;
+	delete[] expected;
+	return pass;
+}
@@ -0,0 +1,158 @@
+#include "Common/RiscVEmitter.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "UnitTest.h"
+
+#undef RET
+
+using namespace RiscVGen;
+
+static u32 LastInstr(RiscVEmitter &emit) {
+	u32 instr;
+	memcpy(&instr, emit.GetCodePointer() - 4, 4);
+	return instr;
+}
+
+#define CHECK_LAST(expected) EXPECT_EQ_HEX(LastInstr(emitter), (u32)(expected))
+
+static s64 SignExtend(u64 value, int bits) {
+	return (s64)(value << (64 - bits)) >> (64 - bits);
+}
+
+// Just enough of RV64 to check that LI produces the requested constant.
+static bool SimulateLI(const u32 *start, const u32 *end, s64 &result) {
+	s64 regs[32]{};
+	for (const u32 *p = start; p < end; ++p) {
+		u32 instr = *p;
+		int rd = (instr >> 7) & 0x1F;
+		int rs1 = (instr >> 15) & 0x1F;
+		int funct3 = (instr >> 12) & 7;
+		s64 imm12 = SignExtend(instr >> 20, 12);
+		switch (instr & 0x7F) {
+		case 0x37:
+			regs[rd] = SignExtend(instr & 0xFFFFF000, 32);
+			break;
+		case 0x13:
+			if (funct3 == 0)
+				regs[rd] = regs[rs1] + imm12;
+			else if (funct3 == 1)
+				regs[rd] = (s64)((u64)regs[rs1] << ((instr >> 20) & 0x3F));
+			else
+				return false;
+			break;
+		case 0x1B:
+			if (funct3 != 0)
+				return false;
+			regs[rd] = SignExtend((u64)(regs[rs1] + imm12), 32);
+			break;
+		default:
+			return false;
+		}
+		regs[0] = 0;
+	}
+	result = regs[10];
+	return true;
+}
+
+static bool CheckLI(s64 value) {
+	u32 code[16];
+	RiscVEmitter emitter((u8 *)code, (u8 *)code);
+	emitter.LI(A0, value);
+	const u32 *end = (const u32 *)emitter.GetCodePointer();
+	s64 result = 0;
+	if (!SimulateLI(code, end, result) || result != value) {
+		printf("LI %016llx produced %016llx in %d instructions\n", (unsigned long long)value, (unsigned long long)result, (int)(end - code));
+		return false;
+	}
+	// 32-bit values should never need more than two instructions.
+	if (value == (s32)value && end - code > 2) {
+		printf("LI %08x took %d instructions\n", (u32)value, (int)(end - code));
+		return false;
+	}
+	return true;
+}
+
+bool TestRiscVEmitter() {
+	u32 code[512];
+	RiscVEmitter emitter((u8 *)code, (u8 *)code);
+
+	emitter.ADDI(A0, A0, 1);
+	CHECK_LAST(0x00150513);
+	emitter.RET();
+	CHECK_LAST(0x00008067);
+	emitter.LUI(A0, 0x12345000);
+	CHECK_LAST(0x12345537);
+	emitter.ADD(A0, A1, A2);
+	CHECK_LAST(0x00C58533);
+	emitter.SUB(A0, A1, A2);
+	CHECK_LAST(0x40C58533);
+	emitter.MUL(A0, A1, A2);
+	CHECK_LAST(0x02C58533);
+	emitter.LD(A0, R_SP, 8);
+	CHECK_LAST(0x00813503);
+	emitter.SD(R_RA, R_SP, 8);
+	CHECK_LAST(0x00113423);
+	emitter.SRAI(A0, A0, 3);
+	CHECK_LAST(0x40355513);
+	emitter.ADDIW(A0, A0, -1);
+	CHECK_LAST(0xFFF5051B);
+	emitter.SLLI(A0, A0, 32);
+	CHECK_LAST(0x02051513);
+	emitter.FADD(32, FA0, FA1, FA2);
+	CHECK_LAST(0x00C5F553);
+	emitter.FL(32, FA0, A1, 4);
+	CHECK_LAST(0x0045A507);
+	emitter.FMV_TO_INT(32, A0, FA0);
+	CHECK_LAST(0xE0050553);
+	emitter.FCVT_TO_INT(32, false, 32, A0, FA0, Round::TOZERO);
+	CHECK_LAST(0xC0051553);
+	emitter.EBREAK();
+	CHECK_LAST(0x00100073);
+	emitter.NOP();
+	CHECK_LAST(0x00000013);
+
+	const u8 *target = emitter.GetCodePointer() + 8;
+	emitter.BEQ(A0, A1, target);
+	CHECK_LAST(0x00B50463);
+	target = emitter.GetCodePointer() + 16;
+	emitter.JAL(R_RA, target);
+	CHECK_LAST(0x010000EF);
+
+	// Forward branches get patched once the target is known.
+	FixupBranch skip = emitter.BEQ(A0, A1);
+	emitter.NOP();
+	FixupBranch call = emitter.JAL(R_RA);
+	emitter.NOP();
+	emitter.NOP();
+	emitter.SetJumpTarget(skip);
+	emitter.SetJumpTarget(call);
+	u32 patched;
+	memcpy(&patched, skip.ptr, 4);
+	EXPECT_EQ_HEX(patched, 0x00B50A63);
+	memcpy(&patched, call.ptr, 4);
+	EXPECT_EQ_HEX(patched, 0x00C000EF);
+
+	static const s64 constants[] = {
+		0, 1, -1, 0x7FF, 0x800, -0x800, -0x801, 0xFFF, 0x1000, 0x12345678,
+		0x7FFFFFFF, (s32)0x80000000, 0x7FFFF800, 0x7FFFF7FF, (s32)0xDEADBEEF,
+		0x80000000LL, 0xFFFFFFFFLL, 0x100000000LL, 0x123456789ABCDEF0LL,
+		(s64)0x8000000000000000ULL, 0x7FFFFFFFFFFFFFFFLL, (s64)0xFFFFFFFF00000000ULL,
+		0x0000000100000800LL, 0x00007FFFFFFFF800LL,
+	};
+	for (s64 value : constants) {
+		if (!CheckLI(value))
+			return false;
+	}
+	u64 x = 0x9E3779B97F4A7C15ULL;
+	for (int i = 0; i < 1000; ++i) {
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+		if (!CheckLI((s64)x) || !CheckLI((s32)x) || !CheckLI((s64)(x >> (i & 63))))
+			return false;
+	}
+
+	return true;
+}
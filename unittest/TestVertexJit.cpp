@@ -15,7 +15,9 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <cstring>
 #include <math.h>
+#include <vector>
 
 #include "Common/Common.h"
 #include "Common/TimeUtil.h"
@@ -71,6 +73,10 @@ class VertexDecoderTestHarness {
 		memcpy(&options_, &opts, sizeof(options_));
 	}
 
+	void SetBatchDecode(bool enable) {
+		cache_->SetBatchDecode(enable);
+	}
+
 	void SetIndexLowerBound(const int lower) {
 		if (needsReset_) {
 			Reset();
@@ -633,6 +639,65 @@ static bool TestVertexFloatSkin() {
 	return !dec.HasFailed();
 }
 
+static void AddBatchVertex(VertexDecoderTestHarness &dec, int i) {
+	dec.Add16(i * 100, i * 200);
+	dec.Add8(i, 2 * i, 3 * i, 255 - i);
+	dec.AddFloat((float)i, -(float)i, 0.5f * i);
+}
+
+// Enough vertices to go through both the unrolled loop and the remainder loop.
+static bool TestVertexBatch() {
+	VertexDecoderTestHarness dec;
+	int vtype = GE_VTYPE_POS_FLOAT | GE_VTYPE_TC_16BIT | GE_VTYPE_COL_8888;
+	const int count = 7;
+
+	for (int i = 0; i < count; ++i) {
+		AddBatchVertex(dec, i);
+	}
+
+	dec.Execute(vtype, count - 1, false);
+	const int size = dec.GetDstStride() * count;
+	std::vector<u8> expected((u8 *)dec.GetData(), (u8 *)dec.GetData() + size);
+
+	dec.Execute(vtype, count - 1, true);
+	if (memcmp(expected.data(), dec.GetData(), size) != 0) {
+		printf("TestVertexBatch: jit output differs from the interpreter\n");
+		return false;
+	}
+	return true;
+}
+
+static bool CheckRawVtxFmt(int vtype, bool expectRaw) {
+	VertexDecoderOptions options{};
+	VertexDecoder dec;
+	dec.SetVertexType(vtype, options, nullptr);
+	const DecVtxFormat *raw = dec.GetRawVtxFmt();
+	if ((raw != nullptr) != expectRaw) {
+		printf("TestVertexRawFormat: vtype %08x should%s have a raw format\n", vtype, expectRaw ? "" : " not");
+		return false;
+	}
+	if (raw && raw->stride != dec.VertexSize()) {
+		printf("TestVertexRawFormat: vtype %08x raw stride %d != vertex size %d\n", vtype, raw->stride, dec.VertexSize());
+		return false;
+	}
+	return true;
+}
+
+static bool TestVertexRawFormat() {
+	bool pass = true;
+	pass = CheckRawVtxFmt(GE_VTYPE_POS_FLOAT, true) && pass;
+	pass = CheckRawVtxFmt(GE_VTYPE_POS_FLOAT | GE_VTYPE_NRM_FLOAT | GE_VTYPE_COL_8888 | GE_VTYPE_TC_FLOAT, true) && pass;
+	pass = CheckRawVtxFmt(GE_VTYPE_POS_FLOAT | GE_VTYPE_NRM_8BIT | GE_VTYPE_TC_16BIT, true) && pass;
+	pass = CheckRawVtxFmt(GE_VTYPE_POS_FLOAT | GE_VTYPE_COL_8888 | GE_VTYPE_TC_8BIT, true) && pass;
+	// The PSP packs the 8-bit normal right after the 8-bit texcoord, we'd expect it 4-aligned.
+	pass = CheckRawVtxFmt(GE_VTYPE_POS_FLOAT | GE_VTYPE_NRM_8BIT | GE_VTYPE_TC_8BIT, false) && pass;
+	pass = CheckRawVtxFmt(GE_VTYPE_POS_16BIT | GE_VTYPE_COL_8888, false) && pass;
+	pass = CheckRawVtxFmt(GE_VTYPE_POS_FLOAT | GE_VTYPE_COL_565, false) && pass;
+	pass = CheckRawVtxFmt(GE_VTYPE_POS_FLOAT | GE_VTYPE_TC_FLOAT | GE_VTYPE_THROUGH, false) && pass;
+	pass = CheckRawVtxFmt(GE_VTYPE_POS_FLOAT | GE_VTYPE_WEIGHT_FLOAT, false) && pass;
+	return pass;
+}
+
 // TODO: Morph (col, pos, nrm), weights (no skin), morph + weights?
 
 typedef bool (*VertexTestFunc)();
@@ -654,6 +719,9 @@ static VertexTestFunc vertdecTestFuncs[] = {
 	&TestVertex8Skin,
 	&TestVertex16Skin,
 	&TestVertexFloatSkin,
+
+	&TestVertexBatch,
+	&TestVertexRawFormat,
 };
 
 bool TestVertexJit() {
@@ -679,6 +747,16 @@ bool TestVertexJit() {
 	printf("Result: %f, %f, %f\n", x, y, z);
 	printf("Jit was %fx faster than steps.\n\n", yesJit / noJit);
 
+	VertexDecoderTestHarness batchDec;
+	for (int i = 0; i < 100; ++i) {
+		AddBatchVertex(batchDec, i);
+	}
+	vtype = GE_VTYPE_POS_FLOAT | GE_VTYPE_TC_16BIT | GE_VTYPE_COL_8888;
+	double batchJit = batchDec.ExecuteTimed(vtype, 100, true);
+	batchDec.SetBatchDecode(false);
+	double singleJit = batchDec.ExecuteTimed(vtype, 100, true);
+	printf("Batched jit was %fx faster than one vertex per loop.\n\n", batchJit / singleJit);
+
 	bool pass = true;
 	for (size_t i = 0; i < ARRAY_SIZE(vertdecTestFuncs); ++i) {
 		if (!vertdecTestFuncs[i]()) {
@@ -25,6 +25,7 @@
 // Or just integrate with an existing testing framework.
 //
 // To use, set command line parameter to one or more of the tests below, or "all".
+// "bench" runs the benchmarks in Benchmarks.cpp instead.
 // Search for "availableTests".
 
 #include "ppsspp_config.h"
@@ -40,6 +41,8 @@
 #include <jni.h>
 #endif
 
+#include "Common/Data/Format/JSONReader.h"
+#include "Common/Data/Format/JSONWriter.h"
 #include "Common/Data/Text/Parsers.h"
 #include "Common/Data/Text/WrapText.h"
 #include "Common/Data/Encoding/Utf8.h"
@@ -740,6 +743,37 @@ static bool TestWrapText() {
 	return true;
 }
 
+static bool TestJson() {
+	json::JsonWriter writer;
+	writer.begin();
+	writer.writeString("text", "a/b\"c\\\n\x01");
+	writer.pushArray("values");
+	writer.writeInt(-5);
+	writer.writeUint(4000000000U);
+	writer.writeFloat(2.5);
+	writer.writeFloat(NAN);
+	writer.writeBool(true);
+	writer.pop();
+	writer.end();
+	const std::string expected = "{\"text\":\"a\\/b\\\"c\\\\\\n\\u0001\",\"values\":[-5,4000000000,2.5,null,true]}";
+	EXPECT_EQ_STR(writer.str(), expected);
+
+	// The writer can be reused.
+	writer.clear();
+	writer.beginArray();
+	writer.writeNull();
+	writer.end();
+	EXPECT_EQ_STR(writer.str(), std::string("[null]"));
+
+	std::string parsed = expected;
+	json::JsonReader reader(std::move(parsed), json::InPlace());
+	EXPECT_TRUE(reader.ok());
+	EXPECT_EQ_STR(std::string(reader.root().getString("text", "")), std::string("a/b\"c\\\n\x01"));
+	EXPECT_EQ_STR(json::json_stringify(reader.root().get("values")), std::string("[-5,4000000000,2.5,null,true]"));
+
+	return true;
+}
+
 typedef bool (*TestFunc)();
 struct TestItem {
 	const char *name;
@@ -751,8 +785,11 @@ struct TestItem {
 bool TestArmEmitter();
 bool TestArm64Emitter();
 bool TestX64Emitter();
+bool TestRiscVEmitter();
 bool TestShaderGenerators();
 bool TestThreadManager();
+bool TestIndexGenerator();
+bool RunBenchmarks(const char *filter);
 
 TestItem availableTests[] = {
 #if PPSSPP_ARCH(ARM64) || PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(X86)
@@ -764,7 +801,9 @@ TestItem availableTests[] = {
 #if PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(X86)
 	TEST_ITEM(X64Emitter),
 #endif
+	TEST_ITEM(RiscVEmitter),
 	TEST_ITEM(VertexJit),
+	TEST_ITEM(IndexGenerator),
 	TEST_ITEM(Asin),
 	TEST_ITEM(SinCos),
 	TEST_ITEM(VFPUSinCos),
@@ -781,6 +820,7 @@ TestItem availableTests[] = {
 	TEST_ITEM(AndroidContentURI),
 	TEST_ITEM(ThreadManager),
 	TEST_ITEM(WrapText),
+	TEST_ITEM(Json),
 };
 
 int main(int argc, const char *argv[]) {
@@ -790,6 +830,10 @@ int main(int argc, const char *argv[]) {
 	cpu_info.bVFPv4 = true;
 	g_Config.bEnableLogging = true;
 
+	if (argc >= 2 && !strcasecmp(argv[1], "bench")) {
+		return RunBenchmarks(argc >= 3 ? argv[2] : nullptr) ? 0 : 2;
+	}
+
 	bool allTests = false;
 	TestFunc testFunc = nullptr;
 	if (argc >= 2) {
@@ -828,6 +872,8 @@ int main(int argc, const char *argv[]) {
 		for (auto f : availableTests) {
 			fprintf(stderr, "  * %s\n", f.name);
 		}
+		fprintf(stderr, "\n");
+		fprintf(stderr, "Or \"bench\" to run benchmarks, followed by part of a name to only run some.\n");
 		return 1;
 	} else {
 		if (!testFunc()) {